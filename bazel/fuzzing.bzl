@@ -0,0 +1,52 @@
+# -*- Python -*-
+# Copyright 2017-2023 The Verible Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Bazel macro for fuzz targets that also run as regression tests
+"""
+
+def verible_fuzzer(name, srcs, corpus, deps = []):
+    """Defines a fuzz target binary and a test running it on its corpus.
+
+    With --config=fuzz, the binary "name" is linked with libFuzzer.
+    Otherwise, it runs the fuzz target on the files and directories passed
+    as arguments, which "name_regression_test" does with "corpus".
+
+    Args:
+        name: name of the fuzz target binary
+        srcs: sources defining LLVMFuzzerTestOneInput()
+        corpus: seed inputs
+        deps: dependencies of srcs
+    """
+    driver = select({
+        "//bazel:libfuzzer_enabled": [],
+        "//conditions:default": ["//verilog/fuzzing:fuzz-driver-main"],
+    })
+    native.cc_binary(
+        name = name,
+        testonly = True,
+        srcs = srcs,
+        linkopts = select({
+            "//bazel:libfuzzer_enabled": ["-fsanitize=fuzzer"],
+            "//conditions:default": [],
+        }),
+        deps = deps + driver,
+    )
+    native.cc_test(
+        name = name + "_regression_test",
+        srcs = srcs,
+        args = ["$(locations %s)" % corpus],
+        data = [corpus],
+        deps = deps + ["//verilog/fuzzing:fuzz-driver-main"],
+    )
@@ -0,0 +1,82 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/analysis/comment_directives.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "common/strings/comment_utils.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+
+namespace verible {
+
+std::optional<CommentDirective> ParseCommentDirective(
+    const TokenInfo &comment, const std::vector<absl::string_view> &triggers) {
+  const absl::string_view text = StripCommentAndSpacePadding(comment.text());
+  for (const absl::string_view trigger : triggers) {
+    absl::string_view args = text;
+    if (trigger.empty() || !absl::ConsumePrefix(&args, trigger)) continue;
+    if (trigger.back() != ':' && !args.empty() && args.front() != ' ' &&
+        args.front() != '\t') {
+      continue;  // Only the start of a longer word.
+    }
+    return CommentDirective{
+        comment, trigger,
+        absl::StrSplit(args, absl::ByAnyChar(" \t"), absl::SkipEmpty())};
+  }
+  return std::nullopt;
+}
+
+CommentDirectiveIndex::CommentDirectiveIndex(
+    const TokenSequence &tokens, const TokenFilterPredicate &is_comment,
+    const std::vector<absl::string_view> &triggers) {
+  for (const TokenInfo &token : tokens) {
+    if (!is_comment(token)) continue;
+    if (auto directive = ParseCommentDirective(token, triggers)) {
+      directives_.push_back(*std::move(directive));
+    }
+  }
+}
+
+const CommentDirective *CommentDirectiveIndex::Find(
+    absl::string_view comment_text) const {
+  // Comments are in text order.
+  const auto found = std::lower_bound(
+      directives_.begin(), directives_.end(), comment_text.data(),
+      [](const CommentDirective &directive, const char *text) {
+        return directive.comment.text().data() < text;
+      });
+  if (found == directives_.end() || found->comment.text() != comment_text ||
+      found->comment.text().data() != comment_text.data()) {
+    return nullptr;
+  }
+  return &*found;
+}
+
+std::vector<const CommentDirective *> CommentDirectiveIndex::WithTrigger(
+    absl::string_view trigger) const {
+  std::vector<const CommentDirective *> result;
+  for (const CommentDirective &directive : directives_) {
+    if (directive.trigger == trigger) result.push_back(&directive);
+  }
+  return result;
+}
+
+}  // namespace verible
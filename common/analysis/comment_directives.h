@@ -0,0 +1,85 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_ANALYSIS_COMMENT_DIRECTIVES_H_
+#define VERIBLE_COMMON_ANALYSIS_COMMENT_DIRECTIVES_H_
+
+#include <optional>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+
+namespace verible {
+
+// A tool directive in a comment, like
+//
+//   // verilog_lint: waive rule-name
+//   /* verilog_format: off */
+//
+// The text of the comment without its delimiters starts with a trigger,
+// usually the name of the tool, which is followed by the arguments, separated
+// by spaces or tabs.  A trigger ending in ':' may be directly followed by its
+// first argument, as in "verilog_format:off"; any other trigger must be
+// followed by a separator or the end of the comment.
+struct CommentDirective {
+  // The comment token.
+  TokenInfo comment;
+  // The trigger that the comment starts with.
+  absl::string_view trigger;
+  // The words after the trigger, e.g. the command and the rule name.
+  std::vector<absl::string_view> args;
+};
+
+// Returns the directive in "comment" if its text starts with one of
+// "triggers", or std::nullopt.
+std::optional<CommentDirective> ParseCommentDirective(
+    const TokenInfo &comment, const std::vector<absl::string_view> &triggers);
+
+// CommentDirectiveIndex holds the tool directives of all comments of a token
+// stream, which are found in a single scan, so that the tools using them, like
+// the linter for waivers and the formatter for disabled ranges, don't each
+// scan and split all comments again.
+class CommentDirectiveIndex {
+ public:
+  CommentDirectiveIndex() = default;
+
+  // Scans the tokens for which "is_comment" is true for directives that
+  // start with one of "triggers".  The index refers to the tokens' text, and
+  // to the text of the triggers.
+  CommentDirectiveIndex(const TokenSequence &tokens,
+                        const TokenFilterPredicate &is_comment,
+                        const std::vector<absl::string_view> &triggers);
+
+  // All directives, in the order of their comments.
+  const std::vector<CommentDirective> &directives() const {
+    return directives_;
+  }
+
+  // Returns the directive in the comment whose text is "comment_text", or
+  // nullptr if that comment has none.  Takes logarithmic time.
+  const CommentDirective *Find(absl::string_view comment_text) const;
+
+  // Returns the directives with the given trigger, in order.
+  std::vector<const CommentDirective *> WithTrigger(
+      absl::string_view trigger) const;
+
+ private:
+  std::vector<CommentDirective> directives_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_ANALYSIS_COMMENT_DIRECTIVES_H_
@@ -0,0 +1,102 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/analysis/comment_directives.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+constexpr int kComment = 1;
+constexpr int kOther = 2;
+
+const std::vector<absl::string_view> kTriggers = {"mylinter", "myformat:"};
+
+TEST(ParseCommentDirectiveTest, NotADirective) {
+  EXPECT_FALSE(
+      ParseCommentDirective(TokenInfo(kComment, "// text"), kTriggers));
+  EXPECT_FALSE(
+      ParseCommentDirective(TokenInfo(kComment, "// mylinterx a"), kTriggers));
+  EXPECT_FALSE(ParseCommentDirective(TokenInfo(kComment, "// a mylinter b"),
+                                     kTriggers));
+}
+
+TEST(ParseCommentDirectiveTest, SplitsArguments) {
+  const auto directive = ParseCommentDirective(
+      TokenInfo(kComment, "//  mylinter waive\t some-rule  "), kTriggers);
+  ASSERT_TRUE(directive);
+  EXPECT_EQ(directive->trigger, "mylinter");
+  EXPECT_THAT(directive->args, ElementsAre("waive", "some-rule"));
+}
+
+TEST(ParseCommentDirectiveTest, TriggerWithColonJoinsArgument) {
+  const auto directive = ParseCommentDirective(
+      TokenInfo(kComment, "/* myformat:off */"), kTriggers);
+  ASSERT_TRUE(directive);
+  EXPECT_EQ(directive->trigger, "myformat:");
+  EXPECT_THAT(directive->args, ElementsAre("off"));
+}
+
+TEST(ParseCommentDirectiveTest, NoArguments) {
+  const auto directive =
+      ParseCommentDirective(TokenInfo(kComment, "// mylinter"), kTriggers);
+  ASSERT_TRUE(directive);
+  EXPECT_THAT(directive->args, IsEmpty());
+}
+
+TEST(CommentDirectiveIndexTest, IndexesOnlyDirectiveComments) {
+  const absl::string_view text =
+      "// mylinter waive a\n"
+      "x // text\n"
+      "// myformat: on\n";
+  const TokenSequence tokens = {
+      TokenInfo(kComment, text.substr(0, 19)),
+      TokenInfo(kOther, text.substr(20, 1)),
+      TokenInfo(kComment, text.substr(22, 7)),
+      TokenInfo(kComment, text.substr(30, 15)),
+      // Not a comment, so not indexed.
+      TokenInfo(kOther, text.substr(0, 19)),
+  };
+  const CommentDirectiveIndex index(
+      tokens, [](const TokenInfo &t) { return t.token_enum() == kComment; },
+      kTriggers);
+  ASSERT_EQ(index.directives().size(), 2);
+  EXPECT_THAT(index.directives()[0].args, ElementsAre("waive", "a"));
+  EXPECT_THAT(index.directives()[1].args, ElementsAre("on"));
+
+  EXPECT_EQ(index.Find(tokens[0].text()), &index.directives()[0]);
+  EXPECT_EQ(index.Find(tokens[2].text()), nullptr);
+  EXPECT_EQ(index.Find(tokens[3].text()), &index.directives()[1]);
+  // Same text, elsewhere.
+  const std::string copy(tokens[0].text());
+  EXPECT_EQ(index.Find(copy), nullptr);
+
+  ASSERT_EQ(index.WithTrigger("myformat:").size(), 1);
+  EXPECT_EQ(index.WithTrigger("myformat:")[0], &index.directives()[1]);
+  EXPECT_THAT(index.WithTrigger("other"), IsEmpty());
+}
+
+}  // namespace
+}  // namespace verible
@@ -0,0 +1,84 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/fused_linter.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/analysis/line_linter.h"
+#include "common/analysis/syntax_tree_linter.h"
+#include "common/analysis/token_stream_linter.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/logging.h"
+#include "common/util/range.h"
+#include "common/util/trace.h"
+
+namespace verible {
+
+void FusedLint(const TextStructureView &text_structure, LineLinter *line_linter,
+               TokenStreamLinter *token_stream_linter,
+               SyntaxTreeLinter *syntax_tree_linter) {
+  const std::vector<absl::string_view> &lines = text_structure.Lines();
+  const TokenSequence &tokens = text_structure.TokenStream();
+  const ConcreteSyntaxTree &syntax_tree = text_structure.SyntaxTree();
+  if (trace::Enabled()) {
+    line_linter->Lint(lines);
+    token_stream_linter->Lint(tokens);
+    if (syntax_tree != nullptr) syntax_tree_linter->Lint(*syntax_tree);
+    return;
+  }
+
+  const absl::string_view contents = text_structure.Contents();
+  auto next_line = lines.begin();
+  auto next_token = tokens.begin();
+  // Hands the lines and tokens that start at or before 'offset' to their
+  // linters.
+  const auto advance_to = [&](size_t offset) {
+    for (; next_line != lines.end() &&
+           static_cast<size_t>(next_line->begin() - contents.begin()) <= offset;
+         ++next_line) {
+      line_linter->HandleLine(*next_line);
+    }
+    for (; next_token != tokens.end() &&
+           static_cast<size_t>(next_token->left(contents)) <= offset;
+         ++next_token) {
+      token_stream_linter->HandleToken(*next_token);
+    }
+  };
+
+  line_linter->Begin(contents);
+  token_stream_linter->Begin();
+  if (syntax_tree != nullptr) {
+    syntax_tree_linter->Lint(*syntax_tree, [&](const SyntaxTreeLeaf &leaf) {
+      // Leaves from outside the text (e.g. from macro expansions) don't
+      // mark progress through it.
+      const absl::string_view text = leaf.get().text();
+      if (IsSubRange(text, contents)) {
+        advance_to(text.begin() - contents.begin());
+      }
+    });
+  }
+  // Everything past the last leaf.
+  advance_to(contents.size());
+  line_linter->End();
+  token_stream_linter->End();
+}
+
+}  // namespace verible
@@ -0,0 +1,44 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// FusedLint drives the line, token stream and syntax tree linters of one
+// file in a single forward scan over its text, instead of three passes.
+
+#ifndef VERIBLE_COMMON_ANALYSIS_FUSED_LINTER_H_
+#define VERIBLE_COMMON_ANALYSIS_FUSED_LINTER_H_
+
+#include "common/analysis/line_linter.h"
+#include "common/analysis/syntax_tree_linter.h"
+#include "common/analysis/token_stream_linter.h"
+#include "common/text/text_structure.h"
+
+namespace verible {
+
+// Lints the lines, tokens and syntax tree of 'text_structure' with the
+// respective linters, with the same results as linting each separately.
+// The syntax tree is traversed as usual; before each leaf, the lines and
+// tokens that start up to that leaf are handed to their linters, so the
+// text is only swept once. Whole-file rules (TextStructureLinter) are not
+// part of the scan, as they look at the text structure all at once.
+//
+// While tracing, the linters run one after the other instead, so that each
+// rule still gets its own trace span.
+void FusedLint(const TextStructureView &text_structure, LineLinter *line_linter,
+               TokenStreamLinter *token_stream_linter,
+               SyntaxTreeLinter *syntax_tree_linter);
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_ANALYSIS_FUSED_LINTER_H_
@@ -0,0 +1,162 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/fused_linter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/line_lint_rule.h"
+#include "common/analysis/line_linter.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/syntax_tree_lint_rule.h"
+#include "common/analysis/syntax_tree_linter.h"
+#include "common/analysis/token_stream_lint_rule.h"
+#include "common/analysis/token_stream_linter.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/text/tree_builder_test_util.h"
+#include "common/util/trace.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using testing::ElementsAre;
+
+// Rules that log what they are handed, in the order they get it.
+class LoggingLineRule : public LineLintRule {
+ public:
+  explicit LoggingLineRule(std::vector<std::string> *log) : log_(log) {}
+
+  void HandleLine(absl::string_view line) final {
+    log_->push_back(absl::StrCat("line:", line));
+  }
+  void Finalize() final { log_->push_back("finalize"); }
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+ private:
+  std::vector<std::string> *log_;
+};
+
+class LoggingTokenRule : public TokenStreamLintRule {
+ public:
+  explicit LoggingTokenRule(std::vector<std::string> *log) : log_(log) {}
+
+  void HandleToken(const TokenInfo &token) final {
+    log_->push_back(absl::StrCat("token:", token.text()));
+  }
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+ private:
+  std::vector<std::string> *log_;
+};
+
+class LoggingLeafRule : public SyntaxTreeLintRule {
+ public:
+  explicit LoggingLeafRule(std::vector<std::string> *log) : log_(log) {}
+
+  void HandleLeaf(const SyntaxTreeLeaf &leaf,
+                  const SyntaxTreeContext &context) final {
+    log_->push_back(absl::StrCat("leaf:", leaf.get().text()));
+  }
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+ private:
+  std::vector<std::string> *log_;
+};
+
+class FusedLintTest : public testing::Test {
+ protected:
+  FusedLintTest() : text_structure_("a b\nc\n") {
+    const absl::string_view text = text_structure_.Contents();
+    TokenSequence &tokens = text_structure_.MutableTokenStream();
+    for (int i = 0; i < 6; ++i) {
+      tokens.push_back(TokenInfo(i % 2 + 1, text.substr(i, 1)));
+    }
+    line_linter_.AddRule(std::make_unique<LoggingLineRule>(&log_));
+    token_stream_linter_.AddRule(std::make_unique<LoggingTokenRule>(&log_));
+    syntax_tree_linter_.AddRule(std::make_unique<LoggingLeafRule>(&log_));
+  }
+
+  // Makes a tree of the "a", "b" and "c" tokens.
+  void MakeSyntaxTree() {
+    const TokenSequence &tokens = text_structure_.TokenStream();
+    text_structure_.MutableSyntaxTree() =
+        Node(Leaf(tokens[0]), Node(Leaf(tokens[2])), Leaf(tokens[4]));
+  }
+
+  void Lint() {
+    FusedLint(text_structure_, &line_linter_, &token_stream_linter_,
+              &syntax_tree_linter_);
+  }
+
+  TextStructureView text_structure_;
+  LineLinter line_linter_;
+  TokenStreamLinter token_stream_linter_;
+  SyntaxTreeLinter syntax_tree_linter_;
+  std::vector<std::string> log_;
+};
+
+TEST_F(FusedLintTest, InterleavesLinesAndTokensWithLeaves) {
+  MakeSyntaxTree();
+  Lint();
+  EXPECT_THAT(log_, ElementsAre("line:a b", "token:a", "leaf:a",  //
+                                "token: ", "token:b", "leaf:b",   //
+                                "line:c", "token:\n", "token:c", "leaf:c",
+                                "line:", "token:\n", "finalize"));
+}
+
+TEST_F(FusedLintTest, NoSyntaxTree) {
+  Lint();
+  EXPECT_THAT(log_, ElementsAre("line:a b", "line:c", "line:", "token:a",
+                                "token: ", "token:b", "token:\n", "token:c",
+                                "token:\n", "finalize"));
+}
+
+TEST_F(FusedLintTest, LeafOutsideOfText) {
+  // A leaf that isn't part of the text doesn't advance the scan.
+  static constexpr absl::string_view kExpanded = "x";
+  const TokenSequence &tokens = text_structure_.TokenStream();
+  text_structure_.MutableSyntaxTree() =
+      Node(Leaf(TokenInfo(1, kExpanded)), Leaf(tokens[2]));
+  Lint();
+  EXPECT_THAT(log_, ElementsAre("leaf:x", "line:a b", "token:a", "token: ",
+                                "token:b", "leaf:b", "line:c", "line:",
+                                "token:\n", "token:c", "token:\n",
+                                "finalize"));
+}
+
+TEST_F(FusedLintTest, SeparatePassesWhileTracing) {
+  MakeSyntaxTree();
+  trace::SetEnabled(true);
+  Lint();
+  trace::SetEnabled(false);
+  trace::Clear();
+  EXPECT_THAT(log_, ElementsAre("line:a b", "line:c", "line:", "finalize",
+                                "token:a", "token: ", "token:b", "token:\n",
+                                "token:c", "token:\n",  //
+                                "leaf:a", "leaf:b", "leaf:c"));
+}
+
+}  // namespace
+}  // namespace verible
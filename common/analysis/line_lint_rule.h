@@ -19,6 +19,8 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_LINE_LINT_RULE_H_
 #define VERIBLE_COMMON_ANALYSIS_LINE_LINT_RULE_H_
 
+#include <cstdint>
+
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule.h"
 
@@ -28,6 +30,19 @@ class LineLintRule : public LintRule {
  public:
   ~LineLintRule() override = default;  // not yet final
 
+  // Features of a line that a rule may look for, as a bit set.
+  enum LineFeature : uint32_t {
+    kTab = 1 << 0,  // Contains a tab.
+    // Ends with whitespace, not counting a final '\r' of a "\r\n" ending.
+    kTrailingSpace = 1 << 1,
+  };
+
+  // Returns the LineFeatures of which a line needs at least one for this rule
+  // to possibly find a violation in it, or 0 if it needs to see every line.
+  // The linter finds these features with a cheap scan over the text, and only
+  // hands such rules the lines that have them.
+  virtual uint32_t CandidateLineFeatures() const { return 0; }
+
   // Scans a single line during analysis.
   virtual void HandleLine(absl::string_view line) = 0;
 
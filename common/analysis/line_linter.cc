@@ -14,26 +14,119 @@
 
 #include "common/analysis/line_linter.h"
 
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "common/analysis/line_lint_rule.h"
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/util/logging.h"
+#include "common/util/range.h"
+#include "common/util/trace.h"
 
 namespace verible {
 
+// Returns true if a rule with 'candidate_features' is to handle a line with
+// 'line_features'.
+static bool IsCandidate(uint32_t candidate_features, uint32_t line_features) {
+  return candidate_features == 0 || (candidate_features & line_features) != 0;
+}
+
 void LineLinter::Lint(const std::vector<absl::string_view> &lines) {
   VLOG(1) << "LineLinter analyzing lines with " << rules_.size() << " rules.";
-  for (const auto &line : lines) {
-    for (const auto &rule : rules_) {
-      ABSL_DIE_IF_NULL(rule)->HandleLine(line);
-    }
+  if (!trace::Enabled()) {
+    Begin();
+    for (const auto &line : lines) HandleLine(line);
+    End();
+    return;
   }
+  // Rules are independent, so running them one at a time gives each its
+  // own trace span without changing the results.
+  LintRuleProfiles profiles(rules_.size());
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    LineLintRule *rule = ABSL_DIE_IF_NULL(rules_[i].get());
+    const uint32_t candidate_features = rule->CandidateLineFeatures();
+    TraceLintRule(*rule, [&] {
+      for (const auto &line : lines) {
+        if (!IsCandidate(candidate_features,
+                         FeaturesOf(line, candidate_features))) {
+          continue;
+        }
+        ProfileLintRuleCall(profiles[i], [&] { rule->HandleLine(line); });
+      }
+      ProfileLintRuleCall(profiles[i], [&] { rule->Finalize(); });
+    });
+  }
+  profiles.Record(rules_);
+}
+
+void LineLinter::Begin(absl::string_view text) {
+  profiles_ = LintRuleProfiles(rules_.size());
+  candidate_features_.clear();
+  wanted_features_ = 0;
   for (const auto &rule : rules_) {
-    rule->Finalize();
+    candidate_features_.push_back(rule->CandidateLineFeatures());
+    wanted_features_ |= candidate_features_.back();
+  }
+  text_ = text;
+  next_tab_ = text_.end();
+  if ((wanted_features_ & LineLintRule::kTab) && !text_.empty()) {
+    // On clean text, this one search is all that is needed to rule out tabs.
+    const void *tab = std::memchr(text_.data(), '\t', text_.size());
+    if (tab != nullptr) next_tab_ = static_cast<const char *>(tab);
+  }
+}
+
+uint32_t LineLinter::FeaturesOf(absl::string_view line, uint32_t wanted) {
+  uint32_t features = 0;
+  if (wanted & LineLintRule::kTrailingSpace) {
+    absl::string_view content = line;
+    absl::ConsumeSuffix(&content, "\r");
+    if (!content.empty() &&
+        std::isspace(static_cast<unsigned char>(content.back()))) {
+      features |= LineLintRule::kTrailingSpace;
+    }
+  }
+  if (wanted & LineLintRule::kTab) {
+    if (!text_.empty() && IsSubRange(line, text_)) {
+      if (next_tab_ < line.begin()) {
+        // Search for the next tab past the previous one.
+        const void *tab =
+            std::memchr(line.data(), '\t', text_.end() - line.begin());
+        next_tab_ =
+            tab != nullptr ? static_cast<const char *>(tab) : text_.end();
+      }
+      if (next_tab_ < line.end()) features |= LineLintRule::kTab;
+    } else if (line.find('\t') != absl::string_view::npos) {
+      features |= LineLintRule::kTab;
+    }
+  }
+  return features;
+}
+
+void LineLinter::HandleLine(absl::string_view line) {
+  const uint32_t features =
+      wanted_features_ == 0 ? 0 : FeaturesOf(line, wanted_features_);
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    if (!IsCandidate(candidate_features_[i], features)) continue;
+    LineLintRule *rule = ABSL_DIE_IF_NULL(rules_[i].get());
+    ProfileLintRuleCall(profiles_[i], [&] { rule->HandleLine(line); });
+  }
+}
+
+void LineLinter::End() {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    ProfileLintRuleCall(profiles_[i], [&] { rules_[i]->Finalize(); });
   }
+  profiles_.Record(rules_);
+  profiles_ = LintRuleProfiles(0);
+  text_ = {};
 }
 
 std::vector<LintRuleStatus> LineLinter::ReportStatus() const {
@@ -19,12 +19,14 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_LINE_LINTER_H_
 #define VERIBLE_COMMON_ANALYSIS_LINE_LINTER_H_
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/line_lint_rule.h"
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 
 namespace verible {
@@ -34,6 +36,14 @@ class LineLinter {
   // Analyzes a sequence of lines.
   void Lint(const std::vector<absl::string_view> &lines);
 
+  // Incremental form of Lint(), for driving this linter from another scan:
+  // call Begin(), then HandleLine() on each line in order, then End().
+  // If all lines are part of 'text', in order, the scan for the features of
+  // candidate lines is done over all of it at once.
+  void Begin(absl::string_view text = {});
+  void HandleLine(absl::string_view line);
+  void End();
+
   // Transfers ownership of rule into this Linter
   void AddRule(std::unique_ptr<LineLintRule> rule) {
     rules_.emplace_back(std::move(rule));
@@ -46,6 +56,22 @@ class LineLinter {
   // List of rules that the linter is using. Rules are responsible for tracking
   // their own internal state.
   std::vector<std::unique_ptr<LineLintRule>> rules_;
+
+  // Returns those of the 'wanted' LineLintRule::LineFeatures that 'line'
+  // has.
+  uint32_t FeaturesOf(absl::string_view line, uint32_t wanted);
+
+  // The CandidateLineFeatures() of each rule, and all of these combined.
+  std::vector<uint32_t> candidate_features_;
+  uint32_t wanted_features_ = 0;
+
+  // Text that the lines come from, if known, and the first tab in it at or
+  // after the last line.
+  absl::string_view text_;
+  const char *next_tab_ = nullptr;
+
+  // Profiles of the rules between Begin() and End().
+  LintRuleProfiles profiles_{0};
 };
 
 }  // namespace verible
@@ -15,20 +15,25 @@
 #include "common/analysis/line_linter.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/line_lint_rule.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/text/token_info.h"
+#include "common/util/trace.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 namespace verible {
 namespace {
 
+using testing::ElementsAre;
 using testing::IsEmpty;
 using testing::SizeIs;
 
@@ -138,5 +143,82 @@ TEST(LineLinterTest, FinalizeRejects) {
   EXPECT_THAT(statuses[0].violations, SizeIs(1));
 }
 
+// Rule that records the lines it is handed, for the given candidate features.
+class CandidateLinesRule : public LineLintRule {
+ public:
+  explicit CandidateLinesRule(uint32_t features) : features_(features) {}
+
+  uint32_t CandidateLineFeatures() const final { return features_; }
+
+  void HandleLine(absl::string_view line) final { lines_.push_back(line); }
+
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+  std::vector<absl::string_view> lines_;
+
+ private:
+  const uint32_t features_;
+};
+
+// The candidate lines handed to rules with the features they look for, for
+// the lines of 'text'.
+struct CandidateLines {
+  std::vector<absl::string_view> all;
+  std::vector<absl::string_view> tab;
+  std::vector<absl::string_view> trailing_space;
+  std::vector<absl::string_view> either;
+};
+
+CandidateLines LintCandidateLines(absl::string_view text, bool whole_text) {
+  std::vector<absl::string_view> lines = absl::StrSplit(text, '\n');
+  LineLinter linter;
+  auto all = std::make_unique<CandidateLinesRule>(0);
+  auto tab = std::make_unique<CandidateLinesRule>(LineLintRule::kTab);
+  auto trailing_space =
+      std::make_unique<CandidateLinesRule>(LineLintRule::kTrailingSpace);
+  auto either = std::make_unique<CandidateLinesRule>(
+      LineLintRule::kTab | LineLintRule::kTrailingSpace);
+  CandidateLines result;
+  const std::vector<absl::string_view> *handled[] = {
+      &all->lines_, &tab->lines_, &trailing_space->lines_, &either->lines_};
+  linter.AddRule(std::move(all));
+  linter.AddRule(std::move(tab));
+  linter.AddRule(std::move(trailing_space));
+  linter.AddRule(std::move(either));
+  if (whole_text) {
+    linter.Begin(text);
+    for (const auto line : lines) linter.HandleLine(line);
+    linter.End();
+  } else {
+    linter.Lint(lines);
+  }
+  result.all = *handled[0];
+  result.tab = *handled[1];
+  result.trailing_space = *handled[2];
+  result.either = *handled[3];
+  return result;
+}
+
+// This test verifies that rules are only handed lines with the features they
+// look for.
+TEST(LineLinterTest, CandidateLines) {
+  constexpr absl::string_view kText =
+      "clean\n\tx\ny \nand\ttrailing\t\nz\r\n \r\n\n";
+  for (const bool whole_text : {false, true}) {
+    for (const bool traced : {false, true}) {
+      trace::SetEnabled(traced);
+      const CandidateLines lines = LintCandidateLines(kText, whole_text);
+      trace::SetEnabled(false);
+      trace::Clear();
+      EXPECT_THAT(lines.all, SizeIs(8));
+      EXPECT_THAT(lines.tab, ElementsAre("\tx", "and\ttrailing\t"));
+      EXPECT_THAT(lines.trailing_space,
+                  ElementsAre("y ", "and\ttrailing\t", " \r"));
+      EXPECT_THAT(lines.either,
+                  ElementsAre("\tx", "y ", "and\ttrailing\t", " \r"));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace verible
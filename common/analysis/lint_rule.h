@@ -18,9 +18,12 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
 #define VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
 
+#include <chrono>
+
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
+#include "common/util/trace.h"
 
 namespace verible {
 
@@ -45,8 +48,24 @@ class LintRule {
   // Report() returns a LintRuleStatus, which summarizes the results so
   // far of running the LintRule.
   virtual LintRuleStatus Report() const = 0;
+
+  // Reset() clears the findings and any other state of analyzing a file,
+  // keeping the configuration, so that this instance can analyze another file.
+  // Returns false if the rule does not support that, then a new instance has
+  // to be created instead.
+  virtual bool Reset() { return false; }
 };
 
+// Runs 'analyze' and records its duration as a "lint" trace span named after
+// 'rule'.  Linters use this only while tracing is enabled.
+template <typename Analyze>
+void TraceLintRule(const LintRule &rule, Analyze &&analyze) {
+  const auto start = std::chrono::steady_clock::now();
+  analyze();
+  const auto duration = std::chrono::steady_clock::now() - start;
+  trace::RecordSpan(rule.Report().lint_rule_name, "lint", start, duration);
+}
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
@@ -0,0 +1,128 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/lint_rule_profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "common/analysis/lint_rule.h"
+#include "common/util/top_n.h"
+
+namespace verible {
+namespace lint_profile {
+
+namespace internal {
+std::atomic<bool> enabled{false};
+}  // namespace internal
+
+namespace {
+// Process-wide totals, shared by the linters on all threads.
+struct Registry {
+  std::mutex mutex;
+  std::map<std::string, LintRuleProfile> totals;
+};
+
+Registry &GetRegistry() {
+  static auto *const registry = new Registry();  // never destroyed
+  return *registry;
+}
+
+std::string Milliseconds(absl::Duration duration) {
+  return absl::StrFormat("%.3fms", absl::ToDoubleMilliseconds(duration));
+}
+}  // namespace
+
+void SetEnabled(bool enabled) {
+  internal::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Record(const LintRule &rule, LintRuleProfile profile) {
+  const LintRuleStatus status = rule.Report();
+  profile.violations = status.violations.size();
+  Record(status.lint_rule_name, profile);
+}
+
+void Record(absl::string_view rule_name, const LintRuleProfile &profile) {
+  Registry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.totals[std::string(rule_name)] += profile;
+}
+
+std::map<std::string, LintRuleProfile> Totals() {
+  Registry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.totals;
+}
+
+void Clear() {
+  Registry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.totals.clear();
+}
+
+void PrintTotals(std::ostream &stream, size_t top_n) {
+  const std::map<std::string, LintRuleProfile> totals = Totals();
+  if (totals.empty()) {
+    stream << "No lint rules were profiled." << std::endl;
+    return;
+  }
+
+  int name_width = 4;
+  absl::Duration total_time;
+  TopN<std::pair<absl::Duration, absl::string_view>> slowest(top_n);
+  for (const auto &rule : totals) {
+    name_width = std::max(name_width, static_cast<int>(rule.first.size()));
+    total_time += rule.second.time;
+    slowest.push({rule.second.time, rule.first});
+  }
+
+  stream << "Lint rule profile:\n"
+         << absl::StrFormat("%-*s %12s %12s %12s\n", name_width, "rule",
+                            "time", "calls", "violations");
+  for (const auto &rule : totals) {
+    stream << absl::StrFormat("%-*s %12s %12d %12d\n", name_width, rule.first,
+                              Milliseconds(rule.second.time),
+                              rule.second.invocations, rule.second.violations);
+  }
+
+  const std::vector<std::pair<absl::Duration, absl::string_view>> top =
+      slowest.Take();
+  stream << "Top " << top.size() << " rules by time, of "
+         << Milliseconds(total_time) << " in total:\n";
+  int rank = 0;
+  for (const auto &rule : top) {
+    const double percent =
+        total_time == absl::ZeroDuration()
+            ? 0.0
+            : 100.0 * absl::FDivDuration(rule.first, total_time);
+    stream << absl::StrFormat("%4d. %-*s %12s %6.1f%%\n", ++rank, name_width,
+                              rule.second, Milliseconds(rule.first), percent);
+  }
+  stream << std::flush;
+}
+
+}  // namespace lint_profile
+}  // namespace verible
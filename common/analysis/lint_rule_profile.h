@@ -0,0 +1,131 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Profiling of lint rules: how much time each rule takes, how often it is
+// invoked and how many violations it finds, summed over all analyzed files.
+// This helps to find the rules that make linting slow.
+
+#ifndef VERIBLE_COMMON_ANALYSIS_LINT_RULE_PROFILE_H_
+#define VERIBLE_COMMON_ANALYSIS_LINT_RULE_PROFILE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "common/analysis/lint_rule.h"
+
+namespace verible {
+
+// Cost of running one lint rule.
+struct LintRuleProfile {
+  // Time spent in the rule's Handle*(), Finalize() or Lint() methods.
+  absl::Duration time;
+  // Number of calls of these methods.
+  int64_t invocations = 0;
+  // Number of violations found.
+  int64_t violations = 0;
+
+  LintRuleProfile &operator+=(const LintRuleProfile &other) {
+    time += other.time;
+    invocations += other.invocations;
+    violations += other.violations;
+    return *this;
+  }
+};
+
+namespace lint_profile {
+
+namespace internal {
+extern std::atomic<bool> enabled;
+}  // namespace internal
+
+// Returns true if linters profile their rules.
+inline bool Enabled() {
+  return internal::enabled.load(std::memory_order_relaxed);
+}
+
+// Starts or stops profiling.  Already recorded totals are kept.
+void SetEnabled(bool enabled);
+
+// Adds 'profile' to the process-wide totals of 'rule'.  The rule is
+// identified by the name in its Report(), which also provides the number of
+// violations.  Thread-safe.
+void Record(const LintRule &rule, LintRuleProfile profile);
+
+// Adds 'profile' to the process-wide totals of the rule named 'rule_name'.
+// Thread-safe.
+void Record(absl::string_view rule_name, const LintRuleProfile &profile);
+
+// Returns the totals, by rule name.
+std::map<std::string, LintRuleProfile> Totals();
+
+// Discards all totals.
+void Clear();
+
+// Prints a table of the totals of all rules, followed by a summary of the
+// 'top_n' rules that took the most time.
+void PrintTotals(std::ostream &stream, size_t top_n);
+
+}  // namespace lint_profile
+
+// Calls 'handler', which invokes one method of a rule.  If 'profile' is not
+// nullptr, adds the invocation and the time it took to it.
+template <typename Handler>
+void ProfileLintRuleCall(LintRuleProfile *profile, Handler &&handler) {
+  if (profile == nullptr) {
+    handler();
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  handler();
+  profile->time += absl::FromChrono(std::chrono::steady_clock::now() - start);
+  ++profile->invocations;
+}
+
+// Profiles of the rules of one linter, while it analyzes one file.
+// Empty unless profiling is enabled.
+class LintRuleProfiles {
+ public:
+  explicit LintRuleProfiles(size_t num_rules)
+      : profiles_(lint_profile::Enabled() ? num_rules : 0) {}
+
+  // Returns the profile of the i-th rule, or nullptr if not profiling.
+  LintRuleProfile *operator[](size_t i) {
+    return profiles_.empty() ? nullptr : &profiles_[i];
+  }
+
+  // Adds the profiles to the totals of the corresponding (pointers to)
+  // 'rules'.
+  template <typename RulePointers>
+  void Record(const RulePointers &rules) const {
+    for (size_t i = 0; i < profiles_.size(); ++i) {
+      lint_profile::Record(*rules[i], profiles_[i]);
+    }
+  }
+
+ private:
+  std::vector<LintRuleProfile> profiles_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_ANALYSIS_LINT_RULE_PROFILE_H_
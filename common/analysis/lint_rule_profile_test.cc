@@ -0,0 +1,133 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/lint_rule_profile.h"
+
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/token_stream_lint_rule.h"
+#include "common/analysis/token_stream_linter.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using testing::HasSubstr;
+
+// Clears the totals before and after each test, and stops profiling.
+class LintRuleProfileTest : public testing::Test {
+ protected:
+  LintRuleProfileTest() { lint_profile::Clear(); }
+  ~LintRuleProfileTest() override {
+    lint_profile::SetEnabled(false);
+    lint_profile::Clear();
+  }
+};
+
+TEST_F(LintRuleProfileTest, RecordAccumulatesByName) {
+  lint_profile::Record("rule-a", {absl::Milliseconds(2), 3, 1});
+  lint_profile::Record("rule-b", {absl::Milliseconds(1), 5, 0});
+  lint_profile::Record("rule-a", {absl::Milliseconds(4), 2, 2});
+
+  const auto totals = lint_profile::Totals();
+  ASSERT_EQ(totals.size(), 2);
+  const LintRuleProfile &a = totals.at("rule-a");
+  EXPECT_EQ(a.time, absl::Milliseconds(6));
+  EXPECT_EQ(a.invocations, 5);
+  EXPECT_EQ(a.violations, 3);
+  const LintRuleProfile &b = totals.at("rule-b");
+  EXPECT_EQ(b.time, absl::Milliseconds(1));
+  EXPECT_EQ(b.invocations, 5);
+  EXPECT_EQ(b.violations, 0);
+
+  lint_profile::Clear();
+  EXPECT_TRUE(lint_profile::Totals().empty());
+}
+
+TEST_F(LintRuleProfileTest, PrintTotalsRanksSlowestRules) {
+  lint_profile::Record("fast-rule", {absl::Milliseconds(1), 10, 0});
+  lint_profile::Record("slow-rule", {absl::Milliseconds(3), 10, 4});
+  lint_profile::Record("slower-rule", {absl::Milliseconds(6), 10, 0});
+
+  std::ostringstream stream;
+  lint_profile::PrintTotals(stream, 2);
+  const std::string output = stream.str();
+  EXPECT_THAT(output, HasSubstr("slow-rule        3.000ms           10"
+                                "            4\n"));
+  EXPECT_THAT(output, HasSubstr("Top 2 rules by time, of 10.000ms in total:\n"
+                                "   1. slower-rule      6.000ms   60.0%\n"
+                                "   2. slow-rule        3.000ms   30.0%\n"));
+  EXPECT_THAT(output, testing::Not(HasSubstr("3. ")));
+}
+
+TEST_F(LintRuleProfileTest, PrintTotalsWithoutProfiles) {
+  std::ostringstream stream;
+  lint_profile::PrintTotals(stream, 10);
+  EXPECT_EQ(stream.str(), "No lint rules were profiled.\n");
+}
+
+// Counts the tokens with a given enum.
+class ForbidTokenRule : public TokenStreamLintRule {
+ public:
+  explicit ForbidTokenRule(int n) : target_(n) {}
+
+  void HandleToken(const TokenInfo &token) final {
+    if (token.token_enum() == target_) {
+      violations_.insert(LintViolation(token, "some reason"));
+    }
+  }
+
+  LintRuleStatus Report() const final {
+    return LintRuleStatus(violations_, "forbid-token", "");
+  }
+
+ private:
+  std::set<LintViolation> violations_;
+  int target_;
+};
+
+TEST_F(LintRuleProfileTest, LinterRecordsProfiles) {
+  constexpr absl::string_view text("abc");
+  const TokenSequence tokens = {TokenInfo(2, text.substr(0, 1)),
+                                TokenInfo(3, text.substr(1, 1)),
+                                TokenInfo(2, text.substr(2, 1))};
+
+  TokenStreamLinter linter;
+  linter.AddRule(std::make_unique<ForbidTokenRule>(2));
+
+  // Nothing is recorded unless profiling is enabled.
+  linter.Lint(tokens);
+  EXPECT_TRUE(lint_profile::Totals().empty());
+
+  lint_profile::SetEnabled(true);
+  linter.Lint(tokens);
+  const auto totals = lint_profile::Totals();
+  ASSERT_EQ(totals.size(), 1);
+  const LintRuleProfile &profile = totals.at("forbid-token");
+  EXPECT_EQ(profile.invocations, 3);
+  EXPECT_EQ(profile.violations, 2);
+}
+
+}  // namespace
+}  // namespace verible
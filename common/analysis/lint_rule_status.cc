@@ -16,15 +16,19 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -39,6 +43,50 @@
 
 namespace verible {
 
+namespace {
+// Storage of interned texts, in blocks that are never freed.
+class LintTextArena {
+ public:
+  absl::string_view Intern(absl::string_view text) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = texts_.find(text);
+    if (found != texts_.end()) return *found;
+    const absl::string_view copy = Copy(text);
+    texts_.insert(copy);
+    return copy;
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 64 << 10;
+
+  absl::string_view Copy(absl::string_view text) {
+    if (text.length() > kBlockSize / 4) {
+      return large_texts_.emplace_back(text);
+    }
+    if (blocks_.empty() || block_used_ + text.length() > kBlockSize) {
+      blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+      block_used_ = 0;
+    }
+    char* const copy = blocks_.back().get() + block_used_;
+    std::copy(text.begin(), text.end(), copy);
+    block_used_ += text.length();
+    return {copy, text.length()};
+  }
+
+  std::mutex mutex_;
+  absl::flat_hash_set<absl::string_view> texts_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t block_used_ = 0;
+  std::deque<std::string> large_texts_;
+};
+}  // namespace
+
+absl::string_view InternLintText(absl::string_view text) {
+  if (text.empty()) return {};
+  static auto* const arena = new LintTextArena();
+  return arena->Intern(text);
+}
+
 std::string AutoFix::Apply(absl::string_view base) const {
   std::string result;
   auto prev_start = base.cbegin();
@@ -83,7 +131,7 @@ LintViolation::LintViolation(const Symbol& root, absl::string_view reason,
                              const std::vector<TokenInfo>& related_tokens)
     : root(&root),
       token(SymbolToToken(root)),
-      reason(reason),
+      reason(InternLintText(reason)),
       context(context),
       autofixes(autofixes),
       related_tokens(related_tokens) {}
@@ -132,24 +180,27 @@ void LintStatusFormatter::FormatLintRuleStatuses(
     std::ostream* stream, const std::vector<LintRuleStatus>& statuses,
     absl::string_view base, absl::string_view path,
     const std::vector<absl::string_view>& lines) const {
-  std::set<LintViolationWithStatus> violations;
-
-  // TODO(fangism): rewrite as a linear time merge of pre-ordered sub-sequences
-  for (const auto& status : statuses) {
-    for (const auto& violation : status.violations) {
-      violations.insert(LintViolationWithStatus(&violation, &status));
-    }
+  const std::vector<LintViolationWithStatus> violations =
+      SortedLintViolations(statuses);
+  // Resolves the start and end of all violations in one pass over the lines.
+  std::vector<int> offsets;
+  offsets.reserve(2 * violations.size());
+  for (const auto& violation : violations) {
+    offsets.push_back(violation.violation->token.left(base));
+    offsets.push_back(violation.violation->token.right(base));
   }
-
-  for (auto violation : violations) {
-    FormatViolation(stream, *violation.violation, base, path,
+  const std::vector<LineColumn> positions =
+      line_column_map_.GetLineColAtOffsets(base, offsets);
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const auto& violation = violations[i];
+    const LineColumnRange range{positions[2 * i], positions[2 * i + 1]};
+    FormatViolation(stream, *violation.violation, range, base, path,
                     violation.status->url, violation.status->lint_rule_name);
     if (!violation.violation->autofixes.empty()) {
       *stream << " (autofix available)";
     }
     *stream << std::endl;
-    auto cursor = line_column_map_.GetLineColAtOffset(
-        base, violation.violation->token.left(base));
+    const LineColumn& cursor = range.start;
     if (cursor.line < static_cast<int>(lines.size())) {
       *stream << lines[cursor.line] << std::endl;
       *stream << verible::Spacer(cursor.column) << "^" << std::endl;
@@ -170,7 +221,14 @@ void LintStatusFormatter::FormatViolation(std::ostream* stream,
   const verible::LineColumnRange range{
       line_column_map_.GetLineColAtOffset(base, violation.token.left(base)),
       line_column_map_.GetLineColAtOffset(base, violation.token.right(base))};
+  FormatViolation(stream, violation, range, base, path, url, rule_name);
+}
 
+void LintStatusFormatter::FormatViolation(
+    std::ostream* stream, const LintViolation& violation,
+    const LineColumnRange& range, absl::string_view base,
+    absl::string_view path, absl::string_view url,
+    absl::string_view rule_name) const {
   (*stream) << path << ':' << range << " "
             << FormatWithRelatedTokens(violation.related_tokens,
                                        violation.reason, path, base)
@@ -186,7 +244,12 @@ void LintStatusFormatter::FormatViolationWaiver(
   const verible::LineColumnRange range{
       line_column_map_.GetLineColAtOffset(base, violation.token.left(base)),
       line_column_map_.GetLineColAtOffset(base, violation.token.right(base))};
+  FormatViolationWaiver(stream, range, path, rule_name);
+}
 
+void LintStatusFormatter::FormatViolationWaiver(
+    std::ostream* stream, const LineColumnRange& range, absl::string_view path,
+    absl::string_view rule_name) const {
   (*stream) << "waive" << ' ' << "--rule=" << rule_name << ' '
             << "--line=" << range.start.line + 1 << ' ' << "--location="
             << "\"" << path << "\"";
@@ -194,12 +257,31 @@ void LintStatusFormatter::FormatViolationWaiver(
 
 void LintRuleStatus::WaiveViolations(
     std::function<bool(const LintViolation&)>&& is_waived) {
-  std::set<LintViolation> filtered_violations;
-  std::remove_copy_if(
-      violations.begin(), violations.end(),
-      std::inserter(filtered_violations, filtered_violations.begin()),
-      is_waived);
-  violations.swap(filtered_violations);
+  for (auto it = violations.begin(); it != violations.end();) {
+    it = is_waived(*it) ? violations.erase(it) : std::next(it);
+  }
+}
+
+std::vector<LintViolationWithStatus> SortedLintViolations(
+    const std::vector<LintRuleStatus>& statuses) {
+  size_t count = 0;
+  for (const auto& status : statuses) count += status.violations.size();
+  std::vector<LintViolationWithStatus> violations;
+  violations.reserve(count);
+  for (const auto& status : statuses) {
+    for (const auto& violation : status.violations) {
+      violations.emplace_back(&violation, &status);
+    }
+  }
+  std::stable_sort(violations.begin(), violations.end());
+  violations.erase(
+      std::unique(violations.begin(), violations.end(),
+                  [](const LintViolationWithStatus& a,
+                     const LintViolationWithStatus& b) {
+                    return !(a < b) && !(b < a);
+                  }),
+      violations.end());
+  return violations;
 }
 
 }  // namespace verible
@@ -20,6 +20,7 @@
 #include <functional>
 #include <initializer_list>
 #include <iosfwd>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -34,6 +35,12 @@
 
 namespace verible {
 
+// Returns a copy of "text" that is shared by all equal texts and lives until
+// the end of the program.  Lint rules report the same few messages and fixes
+// over and over, so violations keep their texts this way instead of each
+// owning a copy.
+absl::string_view InternLintText(absl::string_view text);
+
 // Represents a single replace operation on a text fragment.
 //
 // Either fragment or replacement can be strings with zero width, providing a
@@ -42,11 +49,11 @@ namespace verible {
 // ReplacementEdit differs from editscript's Edit in that it stores a
 // replacement string, so it doesn't need the "after" text to be useful.
 struct ReplacementEdit {
-  ReplacementEdit(absl::string_view fragment, const std::string& replacement)
-      : fragment(fragment), replacement(replacement) {}
+  ReplacementEdit(absl::string_view fragment, absl::string_view replacement)
+      : fragment(fragment), replacement(InternLintText(replacement)) {}
 
-  ReplacementEdit(const TokenInfo& token, const std::string& replacement)
-      : fragment(token.text()), replacement(replacement) {}
+  ReplacementEdit(const TokenInfo& token, absl::string_view replacement)
+      : fragment(token.text()), replacement(InternLintText(replacement)) {}
 
   bool operator<(const ReplacementEdit& other) const {
     // Check that the fragment is located before the other's fragment. When they
@@ -56,7 +63,7 @@ struct ReplacementEdit {
   }
 
   absl::string_view fragment;
-  std::string replacement;
+  absl::string_view replacement;  // See InternLintText().
 };
 
 // Collection of ReplacementEdits performing single violation fix.
@@ -68,7 +75,7 @@ class AutoFix {
 
   AutoFix(absl::string_view description,
           std::initializer_list<ReplacementEdit> edits)
-      : description_(description), edits_(edits) {
+      : description_(InternLintText(description)), edits_(edits) {
     CHECK_EQ(edits_.size(), edits.size()) << "Edits must not overlap.";
   }
 
@@ -81,10 +88,10 @@ class AutoFix {
   bool AddEdits(const std::set<ReplacementEdit>& new_edits);
 
   const std::set<ReplacementEdit>& Edits() const { return edits_; }
-  const std::string& Description() const { return description_; }
+  absl::string_view Description() const { return description_; }
 
  private:
-  std::string description_;
+  absl::string_view description_;  // See InternLintText().
   std::set<ReplacementEdit> edits_;
 };
 
@@ -95,7 +102,7 @@ struct LintViolation {
                 const std::vector<AutoFix>& autofixes = {},
                 const std::vector<TokenInfo>& related_tokens = {})
       : token(token),
-        reason(reason),
+        reason(InternLintText(reason)),
         context(),
         autofixes(autofixes),
         related_tokens(related_tokens) {}
@@ -104,7 +111,10 @@ struct LintViolation {
   // with additional tokens that might be related somehow with vulnerable token
   LintViolation(const TokenInfo& token, absl::string_view reason,
                 const std::vector<TokenInfo>& tokens)
-      : token(token), reason(reason), context(), related_tokens(tokens) {}
+      : token(token),
+        reason(InternLintText(reason)),
+        context(),
+        related_tokens(tokens) {}
 
   // This construct records a syntax tree lint violation.
   // Use this variation when the violation can be localized to a single token.
@@ -113,7 +123,7 @@ struct LintViolation {
                 const std::vector<AutoFix>& autofixes = {},
                 const std::vector<TokenInfo>& related_tokens = {})
       : token(token),
-        reason(reason),
+        reason(InternLintText(reason)),
         context(context),
         autofixes(autofixes),
         related_tokens(related_tokens) {}
@@ -135,8 +145,8 @@ struct LintViolation {
   // The token at which the error occurs, which includes location information.
   const TokenInfo token;
 
-  // The reason why the violation occurs.
-  std::string reason;
+  // The reason why the violation occurs (see InternLintText()).
+  absl::string_view reason;
 
   // The context (list of ancestors) of the offending token.
   // For non-syntax-tree analyses, leave this blank.
@@ -203,6 +213,12 @@ struct LintViolationWithStatus {
   }
 };
 
+// Returns the violations of all "statuses", which must refer to the same text,
+// ordered by their location.  Of several violations at the same location, only
+// the one of the first status is kept.
+std::vector<LintViolationWithStatus> SortedLintViolations(
+    const std::vector<LintRuleStatus>& statuses);
+
 // LintStatusFormatter is a class for printing LintRuleStatus's and
 // LintViolations to an output stream
 // Usage:
@@ -216,7 +232,16 @@ class LintStatusFormatter {
   // Constructor takes a reference to the original text in order to setup
   // line_column_map
   explicit LintStatusFormatter(absl::string_view text)
-      : line_column_map_(text) {}
+      : owned_line_column_map_(std::make_unique<LineColumnMap>(text)),
+        line_column_map_(*owned_line_column_map_) {}
+
+  // Constructor reusing the line_column_map of the original text, e.g. the
+  // one of its TextStructureView, which must outlive this formatter.
+  explicit LintStatusFormatter(const LineColumnMap& line_column_map)
+      : line_column_map_(line_column_map) {}
+
+  LintStatusFormatter(const LintStatusFormatter&) = delete;
+  LintStatusFormatter& operator=(const LintStatusFormatter&) = delete;
 
   // Formats and outputs status to stream.
   // Path is the file path of original file. This is needed because it is not
@@ -250,6 +275,13 @@ class LintStatusFormatter {
                        absl::string_view url,
                        absl::string_view rule_name) const;
 
+  // Same as above, for a violation whose line:column "range" is already
+  // resolved, e.g. for all violations of a file at once.
+  void FormatViolation(std::ostream* stream, const LintViolation& violation,
+                       const LineColumnRange& range, absl::string_view base,
+                       absl::string_view path, absl::string_view url,
+                       absl::string_view rule_name) const;
+
   // Formats and outputs violation to a file stream in a syntax accepted by
   // --waiver_files flag. Path is file path of original file that is being
   // violated. Base is the string_view of the entire contents, used only for
@@ -258,6 +290,13 @@ class LintStatusFormatter {
                              const LintViolation& violation,
                              absl::string_view base, absl::string_view path,
                              absl::string_view rule_name) const;
+
+  // Same as above, for a violation whose line:column "range" is already
+  // resolved.
+  void FormatViolationWaiver(std::ostream* stream, const LineColumnRange& range,
+                             absl::string_view path,
+                             absl::string_view rule_name) const;
+
   // Substitute the markers \@ with tokens location
   // this allows us to create custom reason msg
   // with different token location that are related to found
@@ -267,10 +306,15 @@ class LintStatusFormatter {
       const std::vector<verible::TokenInfo>& tokens, absl::string_view message,
       absl::string_view path, absl::string_view base) const;
 
+  const LineColumnMap& line_column_map() const { return line_column_map_; }
+
  private:
+  // Only set if the map was built by this formatter.
+  std::unique_ptr<const LineColumnMap> owned_line_column_map_;
+
   // Translates byte offsets, which are supplied by LintViolations via
   // locations field, to line:column
-  LineColumnMap line_column_map_;
+  const LineColumnMap& line_column_map_;
 };
 
 }  // namespace verible
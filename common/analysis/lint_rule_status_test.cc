@@ -416,5 +416,54 @@ TEST(LintViolationTest, ViolationWithAutoFix) {
   EXPECT_EQ(multiple_fixes.autofixes.size(), 2);
 }
 
+TEST(InternLintTextTest, EqualTextsShareStorage) {
+  const std::string reason = "Same reason.";
+  const absl::string_view interned = InternLintText(reason);
+  EXPECT_EQ(interned, reason);
+  EXPECT_NE(interned.data(), reason.data());
+  EXPECT_EQ(InternLintText(std::string(reason)).data(), interned.data());
+  EXPECT_NE(InternLintText("Other reason.").data(), interned.data());
+  EXPECT_TRUE(InternLintText("").empty());
+
+  const std::string large(100000, 'x');
+  EXPECT_EQ(InternLintText(large), large);
+  EXPECT_EQ(InternLintText(large).data(), InternLintText(large).data());
+}
+
+TEST(LintViolationTest, ReasonsAndFixesAreInterned) {
+  static constexpr absl::string_view text("abc");
+  const TokenInfo token(0, text.substr(1, 1));
+  const LintViolation first(token, std::string("Reason."),
+                            {AutoFix("Fix", {token, std::string("x")})});
+  const LintViolation second(token, std::string("Reason."),
+                             {AutoFix("Fix", {token, std::string("x")})});
+  EXPECT_EQ(first.reason.data(), second.reason.data());
+  EXPECT_EQ(first.autofixes[0].Description().data(),
+            second.autofixes[0].Description().data());
+  EXPECT_EQ(first.autofixes[0].Edits().begin()->replacement.data(),
+            second.autofixes[0].Edits().begin()->replacement.data());
+}
+
+TEST(SortedLintViolationsTest, OrdersByLocationKeepingFirstStatus) {
+  static constexpr absl::string_view text("abcd");
+  const TokenInfo a(0, text.substr(0, 1));
+  const TokenInfo c(0, text.substr(2, 1));
+  const TokenInfo d(0, text.substr(3, 1));
+  const std::vector<LintRuleStatus> statuses = {
+      LintRuleStatus({LintViolation(d, "d1"), LintViolation(a, "a1")},
+                     "rule-1", ""),
+      LintRuleStatus({LintViolation(c, "c2"), LintViolation(a, "a2")},
+                     "rule-2", ""),
+  };
+  const std::vector<LintViolationWithStatus> sorted =
+      SortedLintViolations(statuses);
+  ASSERT_EQ(sorted.size(), 3);
+  EXPECT_EQ(sorted[0].violation->reason, "a1");
+  EXPECT_EQ(sorted[0].status, &statuses[0]);
+  EXPECT_EQ(sorted[1].violation->reason, "c2");
+  EXPECT_EQ(sorted[1].status, &statuses[1]);
+  EXPECT_EQ(sorted[2].violation->reason, "d1");
+}
+
 }  // namespace
 }  // namespace verible
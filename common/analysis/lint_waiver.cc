@@ -16,10 +16,11 @@
 
 #include <algorithm>
 #include <cstddef>
-#include <functional>
 #include <iterator>
-#include <map>
+#include <limits>
+#include <numeric>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <utility>
@@ -29,11 +30,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/command_file_lexer.h"
-#include "common/strings/comment_utils.h"
+#include "common/analysis/comment_directives.h"
+#include "common/analysis/lint_rule_status.h"
 #include "common/strings/line_column_map.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
@@ -44,6 +46,7 @@
 #include "common/util/iterator_range.h"
 #include "common/util/logging.h"
 #include "re2/re2.h"
+#include "re2/set.h"
 
 namespace verible {
 
@@ -78,22 +81,69 @@ absl::Status LintWaiver::WaiveWithRegex(absl::string_view rule_name,
   }
 
   waiver_re_map_[rule_name].push_back(regex);
+  regex_rules_.clear();
+  regex_set_.reset();
   return absl::OkStatus();
 }
 
-void LintWaiver::RegexToLines(absl::string_view contents,
-                              const LineColumnMap &line_map) {
+void LintWaiver::WaiveWithRegex(absl::string_view rule_name,
+                                const RE2 *regex) {
+  waiver_re_map_[rule_name].push_back(regex);
+  regex_rules_.clear();
+  regex_set_.reset();
+}
+
+void LintWaiver::BuildRegexSet() {
+  absl::flat_hash_map<const RE2 *, size_t> regex_index;
   for (const auto &rule : waiver_re_map_) {
     for (const RE2 *re : rule.second) {
-      absl::string_view walk = contents;
-      absl::string_view match;
-      while (RE2::FindAndConsume(&walk, *re, &match)) {
-        const size_t pos = match.begin() - contents.begin();
-        WaiveOneLine(rule.first, line_map.LineAtOffset(pos));
-        if (match.empty()) {
-          if (match.end() == contents.end()) break;
-          walk = contents.substr(pos + 1);
-        }
+      const auto inserted = regex_index.emplace(re, regex_rules_.size());
+      if (inserted.second) regex_rules_.push_back({re, {}});
+      regex_rules_[inserted.first->second].rules.push_back(rule.first);
+    }
+  }
+
+  regex_set_ = std::make_unique<re2::RE2::Set>(RE2::Options(RE2::Quiet),
+                                               RE2::UNANCHORED);
+  for (const RegexRules &regex_rules : regex_rules_) {
+    // Valid, as checked by WaiveWithRegex().
+    CHECK_GE(regex_set_->Add(regex_rules.regex->pattern(), nullptr), 0);
+  }
+  if (!regex_set_->Compile()) {
+    LOG(WARNING) << "Waiver regexes are too many to be combined, trying them "
+                    "one by one.";
+    regex_set_.reset();
+  }
+}
+
+void LintWaiver::RegexToLines(absl::string_view contents,
+                              const LineColumnMap &line_map) {
+  if (waiver_re_map_.empty()) return;
+  if (regex_rules_.empty()) BuildRegexSet();
+
+  // Only the regexes that match at all are searched for their positions.
+  std::vector<int> matching;
+  re2::RE2::Set::ErrorInfo error_info{re2::RE2::Set::kNoError};
+  if (regex_set_ == nullptr ||
+      (!regex_set_->Match(contents, &matching, &error_info) &&
+       error_info.kind != re2::RE2::Set::kNoError)) {
+    matching.resize(regex_rules_.size());
+    std::iota(matching.begin(), matching.end(), 0);
+  }
+
+  for (const int index : matching) {
+    const RegexRules &regex_rules = regex_rules_[index];
+    absl::string_view walk = contents;
+    absl::string_view match;
+    while (RE2::FindAndConsume(&walk, *regex_rules.regex, &match)) {
+      const size_t pos = match.begin() - contents.begin();
+      const int line = line_map.LineAtOffset(pos);
+      for (const absl::string_view rule : regex_rules.rules) {
+        WaiveOneLine(rule, line);
+      }
+      if (match.empty()) {
+        if (match.end() == contents.end()) break;
+        walk = contents.substr(pos + 1);
       }
     }
   }
@@ -105,6 +155,40 @@ bool LintWaiver::RuleIsWaivedOnLine(absl::string_view rule_name,
   return line_set != nullptr && LineNumberSetContains(*line_set, line_number);
 }
 
+void LintWaiver::WaiveViolations(const LineColumnMap &line_map,
+                                 absl::string_view base,
+                                 LintRuleStatus *status) const {
+  const LineNumberSet *line_set = LookupLineNumberSet(status->lint_rule_name);
+  if (line_set == nullptr || line_set->empty()) return;
+  const std::vector<int> &line_offsets = line_map.GetBeginningOfLineOffsets();
+  const int num_lines = line_offsets.size();
+  constexpr int kEndOfText = std::numeric_limits<int>::max();
+  // Byte offset at which "line" starts; lines beyond the last one start after
+  // the end of the text, so that the last line extends to it.
+  const auto line_start = [&](int line) {
+    return line >= num_lines ? kEndOfText : line_offsets[std::max(line, 0)];
+  };
+
+  auto waived_lines = line_set->begin();
+  auto &violations = status->violations;
+  for (auto violation = violations.begin(); violation != violations.end();) {
+    const int offset = violation->token.left(base);
+    // Skip the waived ranges that end before this violation.
+    while (waived_lines != line_set->end() &&
+           line_start(waived_lines->second) <= offset) {
+      ++waived_lines;
+    }
+    if (waived_lines == line_set->end()) break;
+    if (line_start(waived_lines->first) <= offset) {
+      VLOG(2) << "Violation of " << status->lint_rule_name << " rule at offset "
+              << offset << " is waived.";
+      violation = violations.erase(violation);
+    } else {
+      ++violation;
+    }
+  }
+}
+
 bool LintWaiver::Empty() const {
   for (const auto &rule_waiver : waiver_map_) {
     if (!rule_waiver.second.empty()) {
@@ -115,34 +199,24 @@ bool LintWaiver::Empty() const {
 }
 
 absl::string_view LintWaiverBuilder::ExtractWaivedRuleFromComment(
-    absl::string_view comment_text,
-    std::vector<absl::string_view> *comment_tokens) const {
+    const CommentDirective &directive) const {
   // Look for directives of the form: <tool_name> <directive> <rule_name>
   // Addition text beyond the last argument is ignored, so it could
   // contain more comment text.
-  auto &tokens = *comment_tokens;
-  // TODO(fangism): Stop splitting after 3 tokens, everything after that is
-  // ignored.  Use something like absl::MaxSplits, but works with multi-spaces.
-  tokens = absl::StrSplit(comment_text, ' ', absl::SkipEmpty());
-  if (tokens.size() >= 3) {
-    if (tokens[0] == waiver_trigger_keyword_) {
-      if (tokens[1] == waive_one_line_keyword_ ||
-          tokens[1] == waive_range_start_keyword_ ||
-          tokens[1] == waive_range_stop_keyword_) {
-        // TODO(b/73512873): Support waiving multiple rules in one command.
-        return tokens[2];  // name of waived rule
-      }
+  const auto &args = directive.args;
+  if (directive.trigger == waiver_trigger_keyword_ && args.size() >= 2) {
+    if (args[0] == waive_one_line_keyword_ ||
+        args[0] == waive_range_start_keyword_ ||
+        args[0] == waive_range_stop_keyword_) {
+      // TODO(b/73512873): Support waiving multiple rules in one command.
+      return args[1];  // name of waived rule
     }
   }
   return "";
 }
 
-void LintWaiverBuilder::ProcessLine(const TokenRange &tokens, int line_number) {
-  // TODO(fangism): [optimization] Use a SmallVector, or function-local
-  // static to avoid re-allocation in every call.  This method does not
-  // need to be re-entrant.
-  std::vector<absl::string_view> lint_directives;
-
+void LintWaiverBuilder::ProcessLine(const TokenRange &tokens, int line_number,
+                                    const CommentDirectiveIndex *directives) {
   // Determine whether line is blank, where whitespace still counts as blank.
   const bool line_is_blank =
       std::all_of(tokens.begin(), tokens.end(), is_token_whitespace_);
@@ -166,20 +240,24 @@ void LintWaiverBuilder::ProcessLine(const TokenRange &tokens, int line_number) {
   }
 
   // Find all directives on this line.
-  std::vector<absl::string_view> comment_tokens;  // Re-use in loop.
+  std::optional<CommentDirective> parsed;  // if not given by "directives"
   for (const auto &token : tokens) {
     if (is_token_comment_(token)) {
-      // Lex the comment text.
-      const absl::string_view comment_text =
-          StripCommentAndSpacePadding(token.text());
-      comment_tokens = absl::StrSplit(comment_text, ' ', absl::SkipEmpty());
-      // TODO(fangism): Support different waiver lexers.
+      const CommentDirective *directive = nullptr;
+      if (directives != nullptr) {
+        directive = directives->Find(token.text());
+      } else {
+        // TODO(fangism): Support different waiver lexers.
+        parsed = ParseCommentDirective(token, {waiver_trigger_keyword_});
+        if (parsed) directive = &*parsed;
+      }
+      if (directive == nullptr) continue;
       const absl::string_view waived_rule =
-          ExtractWaivedRuleFromComment(comment_text, &comment_tokens);
+          ExtractWaivedRuleFromComment(*directive);
       if (!waived_rule.empty()) {
         // If there are any significant tokens on this line, apply to this
         // line, otherwise defer until the next line.
-        const auto command = comment_tokens[1];
+        const auto command = directive->args[0];
         if (command == waive_one_line_keyword_) {
           if (line_has_tokens) {
             lint_waiver_.WaiveOneLine(waived_rule, line_number);
@@ -209,7 +287,8 @@ void LintWaiverBuilder::ProcessLine(const TokenRange &tokens, int line_number) {
 }
 
 void LintWaiverBuilder::ProcessTokenRangesByLine(
-    const TextStructureView &text_structure) {
+    const TextStructureView &text_structure,
+    const CommentDirectiveIndex *directives) {
   const int total_lines = text_structure.Lines().size();
   const auto &tokens = text_structure.TokenStream();
   for (int i = 0; i < total_lines; ++i) {
@@ -219,7 +298,7 @@ void LintWaiverBuilder::ProcessTokenRangesByLine(
     CHECK_LE(0, begin_dist);
     CHECK_LE(begin_dist, end_dist);
     CHECK_LE(end_dist, static_cast<int>(tokens.size()));
-    ProcessLine(token_range, i);
+    ProcessLine(token_range, i, directives);
   }
 
   // Apply regex waivers
@@ -253,23 +332,19 @@ static absl::Status WaiveCommandError(LineColumn pos,
       WaiveCommandErrorFmt(pos, filename, msg, args...));
 }
 
-static absl::Status WaiveCommandHandler(
-    const TokenRange &tokens, absl::string_view waive_file,
-    absl::string_view waive_content, absl::string_view lintee_filename,
-    const LineColumnMap &line_map, LintWaiver *waiver,
-    const std::set<absl::string_view> &active_rules) {
-  absl::string_view rule;
-
+ExternalLintWaivers::WaiveCommand ExternalLintWaivers::ParseWaiveCommand(
+    const TokenRange &tokens, absl::string_view waive_content,
+    const LineColumnMap &line_map,
+    const std::set<absl::string_view> &active_rules) const {
+  const absl::string_view waive_file = waiver_filename_;
+  WaiveCommand command;
   absl::string_view option;
   absl::string_view val;
 
-  int line_start = -1;
-  int line_end = -1;
   std::string regex;
 
   bool can_use_regex = false;
   bool can_use_lineno = false;
-  bool location_match = true;
 
   LineColumn token_pos;
   LineColumn regex_token_pos = {};
@@ -280,17 +355,16 @@ static absl::Status WaiveCommandHandler(
 
     switch (token.token_enum()) {
       case CommandFileLexer::ConfigToken::kCommand:
-        // Verify that this command is supported by this handler
-        if (token.text() != "waive") {
-          return absl::InvalidArgumentError("Invalid command handler called");
-        }
         break;
       case CommandFileLexer::ConfigToken::kError:
-        return WaiveCommandError(token_pos, waive_file, "Configuration error");
+        command.error =
+            WaiveCommandError(token_pos, waive_file, "Configuration error");
+        return command;
       case CommandFileLexer::ConfigToken::kParam:
       case CommandFileLexer::ConfigToken::kFlag:
-        return WaiveCommandError(token_pos, waive_file,
-                                 "Unsupported argument: ", token.text());
+        command.error = WaiveCommandError(
+            token_pos, waive_file, "Unsupported argument: ", token.text());
+        return command;
       case CommandFileLexer::ConfigToken::kFlagWithArg:
         option = token.text();
         break;
@@ -301,45 +375,52 @@ static absl::Status WaiveCommandHandler(
         if (option == "rule") {
           for (auto r : active_rules) {
             if (val == r) {
-              rule = r;
+              command.rule = r;
               break;
             }
           }
 
-          if (rule.empty()) {
-            return WaiveCommandError(token_pos, waive_file,
-                                     "Invalid rule: ", val);
+          if (command.rule.empty()) {
+            command.error =
+                WaiveCommandError(token_pos, waive_file, "Invalid rule: ", val);
+            return command;
           }
 
           break;
         }
 
         if (option == "line") {
+          int &line_start = command.line_start;
+          int &line_end = command.line_end;
           size_t range = val.find(':');
           if (range != absl::string_view::npos) {
             // line range
             if (!absl::SimpleAtoi(val.substr(0, range), &line_start) ||
                 !absl::SimpleAtoi(val.substr(range + 1, val.length() - range),
                                   &line_end)) {
-              return WaiveCommandError(token_pos, waive_file,
-                                       "Unable to parse range: ", val);
+              command.error = WaiveCommandError(
+                  token_pos, waive_file, "Unable to parse range: ", val);
+              return command;
             }
           } else {
             // single line
             if (!absl::SimpleAtoi(val, &line_start)) {
-              return WaiveCommandError(token_pos, waive_file,
-                                       "Unable to parse line number: ", val);
+              command.error = WaiveCommandError(
+                  token_pos, waive_file, "Unable to parse line number: ", val);
+              return command;
             }
             line_end = line_start;
           }
 
           if (line_start < 1) {
-            return WaiveCommandError(token_pos, waive_file,
-                                     "Invalid line number: ", val);
+            command.error = WaiveCommandError(token_pos, waive_file,
+                                              "Invalid line number: ", val);
+            return command;
           }
           if (line_start > line_end) {
-            return WaiveCommandError(token_pos, waive_file,
-                                     "Invalid line range: ", val);
+            command.error = WaiveCommandError(token_pos, waive_file,
+                                              "Invalid line range: ", val);
+            return command;
           }
 
           can_use_lineno = true;
@@ -356,99 +437,73 @@ static absl::Status WaiveCommandHandler(
         }
 
         if (option == "location") {
-          const RE2 file_match_regex(val);
-          if (!file_match_regex.ok()) {
-            return WaiveCommandError(token_pos, waive_file,
-                                     "--location regex is invalid");
+          // Only the last --location counts.
+          command.location = std::make_unique<RE2>(val);
+          if (!command.location->ok()) {
+            command.error = WaiveCommandError(token_pos, waive_file,
+                                              "--location regex is invalid");
+            return command;
           }
-          location_match = RE2::PartialMatch(lintee_filename, file_match_regex);
           continue;
         }
 
-        return WaiveCommandError(token_pos, waive_file,
-                                 "Unsupported flag: ", option);
+        command.error = WaiveCommandError(token_pos, waive_file,
+                                          "Unsupported flag: ", option);
+        return command;
 
       case CommandFileLexer::ConfigToken::kNewline:
-        if (!location_match) return absl::OkStatus();
+        command.complete = true;
+        command.end_pos = token_pos;
 
         // Check if everything required has been set
-        if (rule.empty()) {
-          return WaiveCommandError(token_pos, waive_file,
-                                   "Insufficient waiver configuration");
+        if (command.rule.empty()) {
+          command.applied_error = WaiveCommandError(
+              token_pos, waive_file, "Insufficient waiver configuration");
+          return command;
         }
 
         if (can_use_regex && can_use_lineno) {
-          return WaiveCommandError(
+          command.applied_error = WaiveCommandError(
               token_pos, waive_file,
               "Regex and line flags are mutually exclusive");
+          return command;
         }
 
         if (can_use_regex) {
-          if (auto status = waiver->WaiveWithRegex(rule, regex); !status.ok()) {
-            return WaiveCommandError(regex_token_pos, waive_file,
-                                     status.message());
+          command.regex = std::make_unique<RE2>(absl::StrCat("(", regex, ")"),
+                                                RE2::Quiet);
+          if (!command.regex->ok()) {
+            command.applied_error =
+                WaiveCommandError(regex_token_pos, waive_file,
+                                  "Invalid regex: ", command.regex->error());
           }
         }
 
-        if (can_use_lineno) {
-          waiver->WaiveLineRange(rule, line_start - 1, line_end);
-        }
-
-        if (!can_use_regex && !can_use_lineno) {
-          absl::StatusOr<std::string> content_or =
-              verible::file::GetContentAsString(lintee_filename);
-          if (!content_or.ok()) {
-            return WaiveCommandError(token_pos, waive_file,
-                                     content_or.status().ToString());
-          }
-
-          const size_t number_of_lines =
-              std::count(content_or->begin(), content_or->end(), '\n');
-          waiver->WaiveLineRange(rule, 1, number_of_lines);
-        }
-
-        return absl::OkStatus();
+        return command;
       case CommandFileLexer::ConfigToken::kComment:
         /* Ignore comments */
         break;
       default:
-        return WaiveCommandError(token_pos, waive_file, "Expecting arguments");
+        command.error =
+            WaiveCommandError(token_pos, waive_file, "Expecting arguments");
+        return command;
     }
   }
 
-  return absl::OkStatus();
-}
-
-using HandlerFun = std::function<absl::Status(
-    const TokenRange &, absl::string_view waive_file,
-    absl::string_view waive_content, absl::string_view lintee_filename,
-    const LineColumnMap &, LintWaiver *, const std::set<absl::string_view> &)>;
-static const std::map<absl::string_view, HandlerFun> &GetCommandHandlers() {
-  // allocated once, never freed
-  static const auto *handlers = new std::map<absl::string_view, HandlerFun>{
-      // Right now, we only have one handler
-      {"waive", WaiveCommandHandler},
-  };
-  return *handlers;
+  return command;
 }
 
-absl::Status LintWaiverBuilder::ApplyExternalWaivers(
+ExternalLintWaivers::ExternalLintWaivers(
     const std::set<absl::string_view> &active_rules,
-    absl::string_view lintee_filename, absl::string_view waiver_filename,
-    absl::string_view waivers_config_content) {
-  if (waivers_config_content.empty()) {
-    return {absl::StatusCode::kInternal, "Broken waiver config handle"};
-  }
-
+    absl::string_view waiver_filename, absl::string_view waivers_config_content)
+    : waiver_filename_(waiver_filename),
+      empty_(waivers_config_content.empty()) {
   CommandFileLexer lexer(waivers_config_content);
   const LineColumnMap line_map(waivers_config_content);
   LineColumn command_pos;
 
-  const auto &handlers = GetCommandHandlers();
-
   std::vector<TokenRange> commands = lexer.GetCommandsTokenRanges();
 
-  bool all_commands_ok = true;
   for (const auto &c_range : commands) {
     const auto command = make_container_range(c_range.begin(), c_range.end());
 
@@ -462,28 +517,74 @@ absl::Status LintWaiverBuilder::ApplyExternalWaivers(
     // The very first Token in 'command' should be an actual command
     if (command.empty() ||
         command[0].token_enum() != CommandFileLexer::ConfigToken::kCommand) {
-      LOG(ERROR) << WaiveCommandErrorFmt(command_pos, waiver_filename,
-                                         "Not a command: ", command[0].text());
-      all_commands_ok = false;
+      commands_.emplace_back().error = WaiveCommandError(
+          command_pos, waiver_filename, "Not a command: ", command[0].text());
       continue;
     }
 
-    // Check if command is supported
-    auto handler_iter = handlers.find(command[0].text());
-    if (handler_iter == handlers.end()) {
-      LOG(ERROR) << WaiveCommandErrorFmt(
-          command_pos, waiver_filename,
-          "Command not supported: ", command[0].text());
-      all_commands_ok = false;
+    // Check if command is supported.  Right now, there is only "waive".
+    if (command[0].text() != "waive") {
+      commands_.emplace_back().error =
+          WaiveCommandError(command_pos, waiver_filename,
+                            "Command not supported: ", command[0].text());
       continue;
     }
 
-    auto status = handler_iter->second(command, waiver_filename,
-                                       waivers_config_content, lintee_filename,
-                                       line_map, &lint_waiver_, active_rules);
+    commands_.push_back(ParseWaiveCommand(command, waivers_config_content,
+                                          line_map, active_rules));
+  }
+}
+
+absl::Status ExternalLintWaivers::ApplyCommand(
+    const WaiveCommand &command, absl::string_view lintee_filename,
+    LintWaiver *waiver) const {
+  if (command.regex != nullptr) {
+    waiver->WaiveWithRegex(command.rule, command.regex.get());
+  }
+
+  if (command.line_start > 0) {
+    waiver->WaiveLineRange(command.rule, command.line_start - 1,
+                           command.line_end);
+  }
+
+  if (command.regex == nullptr && command.line_start <= 0) {
+    absl::StatusOr<std::unique_ptr<MemBlock>> content_or =
+        verible::file::GetContentAsMemBlock(lintee_filename);
+    if (!content_or.ok()) {
+      return WaiveCommandError(command.end_pos, waiver_filename_,
+                               content_or.status().ToString());
+    }
+
+    const absl::string_view content = (*content_or)->AsStringView();
+    const size_t number_of_lines =
+        std::count(content.begin(), content.end(), '\n');
+    waiver->WaiveLineRange(command.rule, 1, number_of_lines);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ExternalLintWaivers::ApplyTo(absl::string_view lintee_filename,
+                                          LintWaiver *waiver) const {
+  if (empty_) {
+    return {absl::StatusCode::kInternal, "Broken waiver config handle"};
+  }
+
+  bool all_commands_ok = true;
+  for (const WaiveCommand &command : commands_) {
+    absl::Status status = command.error;
+    if (status.ok()) {
+      if (!command.complete ||
+          (command.location != nullptr &&
+           !RE2::PartialMatch(lintee_filename, *command.location))) {
+        continue;  // Does not apply to this file.
+      }
+      status = command.applied_error;
+    }
+    if (status.ok()) status = ApplyCommand(command, lintee_filename, waiver);
+
     if (!status.ok()) {
-      // Mark the return value to be false, but continue parsing the config
-      // file anyway
+      // Mark the return value to be false, but continue with the other
+      // commands anyway
       all_commands_ok = false;
       LOG(ERROR) << status.message();
     }
@@ -495,4 +596,22 @@ absl::Status LintWaiverBuilder::ApplyExternalWaivers(
   return absl::InvalidArgumentError("Errors applying external waivers.");
 }
 
+absl::Status LintWaiverBuilder::ApplyExternalWaivers(
+    const std::set<absl::string_view> &active_rules,
+    absl::string_view lintee_filename, absl::string_view waiver_filename,
+    absl::string_view waivers_config_content) {
+  return ApplyExternalWaivers(
+      std::make_shared<const ExternalLintWaivers>(active_rules, waiver_filename,
+                                                  waivers_config_content),
+      lintee_filename);
+}
+
+absl::Status LintWaiverBuilder::ApplyExternalWaivers(
+    std::shared_ptr<const ExternalLintWaivers> waivers,
+    absl::string_view lintee_filename) {
+  const absl::Status status = waivers->ApplyTo(lintee_filename, &lint_waiver_);
+  external_waivers_.push_back(std::move(waivers));
+  return status;
+}
+
 }  // namespace verible
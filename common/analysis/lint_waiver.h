@@ -25,12 +25,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
+#include "common/analysis/lint_rule_status.h"
 #include "common/strings/line_column_map.h"
 #include "common/strings/position.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_stream_view.h"
 #include "common/util/container_util.h"
 #include "re2/re2.h"
+#include "re2/set.h"
 
 namespace verible {
 
@@ -64,6 +67,10 @@ class LintWaiver {
   absl::Status WaiveWithRegex(absl::string_view rule_name,
                               absl::string_view regex);
 
+  // Adds an already compiled, valid regular expression, which must outlive
+  // this object.
+  void WaiveWithRegex(absl::string_view rule_name, const re2::RE2 *regex);
+
   // Converts the prepared regular expressions to line numbers and applies the
   // waivers.
   void RegexToLines(absl::string_view content, const LineColumnMap &line_map);
@@ -71,6 +78,14 @@ class LintWaiver {
   // Returns true if `line_number` should be waived for a particular rule.
   bool RuleIsWaivedOnLine(absl::string_view rule_name, int line_number) const;
 
+  // Removes the violations of `status` that are on lines waived for its rule.
+  // Violations are ordered by location, so they are matched against the
+  // waived line ranges in one merge pass, without a line lookup or set query
+  // per violation. `line_map` and `base` describe the text the violations
+  // point into.
+  void WaiveViolations(const LineColumnMap &line_map, absl::string_view base,
+                       LintRuleStatus *status) const;
+
   // Returns true if there are no lines waived for any rules.
   bool Empty() const;
 
@@ -88,6 +103,9 @@ class LintWaiver {
  private:
   const RE2 *GetOrCreateCachedRegex(absl::string_view regex_str);
 
+  // Compiles the regexes in waiver_re_map_ into regex_set_.
+  void BuildRegexSet();
+
   // Keys in the maps below are the names of the waived rules. They can be
   // string_view because the static strings for each lint rule class exist,
   // and will outlive all LintWaiver objects. This applies to both waiver_map_
@@ -96,6 +114,72 @@ class LintWaiver {
   absl::flat_hash_map<absl::string_view, RegexVector> waiver_re_map_;
 
   absl::flat_hash_map<std::string, std::unique_ptr<re2::RE2>> regex_cache_;
+
+  // Each distinct regex in waiver_re_map_, with the rules it waives.
+  struct RegexRules {
+    const RE2 *regex;
+    std::vector<absl::string_view> rules;
+  };
+  // Indexed like the patterns in regex_set_.  Empty when outdated.
+  std::vector<RegexRules> regex_rules_;
+  // All regexes combined, to find the ones that match in a single scan.
+  // nullptr if it could not be compiled.
+  std::unique_ptr<re2::RE2::Set> regex_set_;
+};
+
+// ExternalLintWaivers holds the parsed commands of an external waiver file
+// (see --waiver_files), so that they can be applied to many linted files
+// without lexing the file and compiling its regular expressions again.
+class ExternalLintWaivers {
+ public:
+  // Parses "waivers_config_content", and checks the waived rules against
+  // "active_rules".  Errors are only reported by ApplyTo(), as some of them
+  // depend on the linted file.
+  ExternalLintWaivers(const std::set<absl::string_view> &active_rules,
+                      absl::string_view waiver_filename,
+                      absl::string_view waivers_config_content);
+
+  // Adds the waivers that apply to "lintee_filename" to "waiver", which must
+  // not outlive this object.  Logs the errors found in the waiver file.
+  absl::Status ApplyTo(absl::string_view lintee_filename,
+                       LintWaiver *waiver) const;
+
+ private:
+  struct WaiveCommand {
+    // Error in the command, reported for every linted file.
+    absl::Status error;
+    // Error reported only for the linted files that the command applies to.
+    absl::Status applied_error;
+    // Matches the names of the linted files that the command applies to.
+    // nullptr applies it to all files.
+    std::unique_ptr<re2::RE2> location;
+    // Views into the active rules.
+    absl::string_view rule;
+    // 1-based inclusive range of waived lines, if line_start > 0.
+    int line_start = -1;
+    int line_end = -1;
+    // Waives the lines it matches, if not nullptr.
+    // Without regex and lines, the whole file is waived.
+    std::unique_ptr<re2::RE2> regex;
+    // Position of the end of the command, for diagnostics.
+    LineColumn end_pos;
+    // False if the command is not terminated, which leaves it unused.
+    bool complete = false;
+  };
+
+  WaiveCommand ParseWaiveCommand(
+      const TokenRange &tokens, absl::string_view waive_content,
+      const LineColumnMap &line_map,
+      const std::set<absl::string_view> &active_rules) const;
+
+  absl::Status ApplyCommand(const WaiveCommand &command,
+                            absl::string_view lintee_filename,
+                            LintWaiver *waiver) const;
+
+  std::string waiver_filename_;
+  // Applying the waivers of an empty file is an error.
+  bool empty_;
+  std::vector<WaiveCommand> commands_;
 };
 
 // LintWaiverBuilder is a language-agnostic helper class for constructing
@@ -137,12 +221,18 @@ class LintWaiverBuilder {
 
   // Takes a single line's worth of tokens and determines updates to the set of
   // waived lines.  Pass a slice of tokens using make_range.
-  void ProcessLine(const TokenRange &tokens, int line_number);
+  // If 'directives' is not null, it holds the already parsed directives of the
+  // comments, which are then not parsed again.
+  void ProcessLine(const TokenRange &tokens, int line_number,
+                   const CommentDirectiveIndex *directives = nullptr);
 
   // Takes a lexically analyzed text structure and determines the entire set of
   // waived lines.  This can be more easily unit-tested using
   // TextStructureTokenized from text_structure_test_utils.h.
-  void ProcessTokenRangesByLine(const TextStructureView &);
+  // 'directives', if not null, indexes the comments of the text structure.
+  void ProcessTokenRangesByLine(
+      const TextStructureView &,
+      const CommentDirectiveIndex *directives = nullptr);
 
   // Takes a set of active linter rules and the affected filename to be linted,
   // and applies waivers from waiver_filename and its content.
@@ -151,15 +241,20 @@ class LintWaiverBuilder {
       absl::string_view lintee_filename, absl::string_view waiver_filename,
       absl::string_view waivers_config_content);
 
+  // Applies the pre-parsed waivers that match lintee_filename.
+  // This builder keeps "waivers" alive, as the produced LintWaiver refers to
+  // its regular expressions.
+  absl::Status ApplyExternalWaivers(
+      std::shared_ptr<const ExternalLintWaivers> waivers,
+      absl::string_view lintee_filename);
+
   const LintWaiver &GetLintWaiver() const { return lint_waiver_; }
 
  protected:
-  // Parses a comment and extracts a waived rule name.
-  // If text does not match the waived form, then return an empty string.
-  // `comment_tokens` is just re-used memory to avoid re-allocation.
+  // Extracts a waived rule name from a comment directive.
+  // If it does not match the waived form, then return an empty string.
   absl::string_view ExtractWaivedRuleFromComment(
-      absl::string_view comment_text,
-      std::vector<absl::string_view> *comment_tokens) const;
+      const CommentDirective &directive) const;
 
   // Special string that leads a comment that is a waiver directive
   // Typically, name of linter tool is used here.
@@ -189,6 +284,9 @@ class LintWaiverBuilder {
   // string_view keys point to string memory that outlives this builder.
   std::map<absl::string_view, int> waiver_open_ranges_;
 
+  // External waivers whose regexes are referenced by lint_waiver_.
+  std::vector<std::shared_ptr<const ExternalLintWaivers>> external_waivers_;
+
   // Set of waived lines per rule.
   LintWaiver lint_waiver_;
 };
@@ -15,9 +15,13 @@
 #include "common/analysis/lint_waiver.h"
 
 #include <cstddef>
+#include <memory>
 #include <set>
+#include <string>
 
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
+#include "common/analysis/lint_rule_status.h"
 #include "common/strings/line_column_map.h"
 #include "common/text/text_structure_test_utils.h"
 #include "common/text/token_info.h"
@@ -129,6 +133,48 @@ TEST(LintWaiverTest, WaiveFusedRangesOneRule) {
   EXPECT_FALSE(lint_waiver.RuleIsWaivedOnLine(rule_name, 11));
 }
 
+// Tests that waiving in bulk removes the same violations as per-line queries.
+TEST(LintWaiverTest, WaiveViolationsMatchesLineQueries) {
+  // Several violations per line, and a last line without newline.
+  constexpr absl::string_view text = "a b\nc\n\nd e f\ng\nh i\nj";
+  const LineColumnMap line_map(text);
+  std::set<LintViolation> all_violations;
+  for (size_t i = 0; i < text.length(); ++i) {
+    if (text[i] != ' ' && text[i] != '\n') {
+      all_violations.insert(LintViolation(TokenInfo(1, text.substr(i, 1)), ""));
+    }
+  }
+  const auto remaining_letters = [&](const LintRuleStatus &status) {
+    std::string letters;
+    for (const auto &violation : status.violations) {
+      letters.append(violation.token.text().begin(),
+                     violation.token.text().end());
+    }
+    return letters;
+  };
+
+  constexpr absl::string_view kRule = "some-rule";
+  LintWaiver lint_waiver;
+  lint_waiver.WaiveOneLine(kRule, 1);
+  lint_waiver.WaiveLineRange(kRule, 3, 5);
+  lint_waiver.WaiveLineRange(kRule, 6, 100);  // beyond the last line
+
+  LintRuleStatus status(all_violations, kRule, "");
+  lint_waiver.WaiveViolations(line_map, text, &status);
+  EXPECT_EQ(remaining_letters(status), "abhi");
+  for (const auto &violation : all_violations) {
+    const int line = line_map.LineAtOffset(violation.token.left(text));
+    EXPECT_EQ(status.violations.count(violation) == 0,
+              lint_waiver.RuleIsWaivedOnLine(kRule, line))
+        << "line " << line;
+  }
+
+  // Violations of other rules are kept.
+  LintRuleStatus other_status(all_violations, "other-rule", "");
+  lint_waiver.WaiveViolations(line_map, text, &other_status);
+  EXPECT_EQ(remaining_letters(other_status), "abcdefghij");
+}
+
 // Token type enumerations.
 // For convenience, using plain int avoids static_cast-ing everywhere.
 constexpr int kSpace = 0;
@@ -613,6 +659,27 @@ TEST_F(LintWaiverBuilderTest, FromTextStructureOneWaiverRange) {
   EXPECT_FALSE(lint_waiver.RuleIsWaivedOnLine("qq-rule", 3));
 }
 
+// Tests that waivers can come from an index of already parsed directives.
+TEST_F(LintWaiverBuilderTest, FromTextStructureWithDirectiveIndex) {
+  const TextStructureTokenized text_structure({
+      {TokenInfo(kComment, "// mylinter waive-begin qq-rule"), EOL},  // line[0]
+      {TokenInfo(kOther, "text"), EOL},                               // line[1]
+      {TokenInfo(kComment, "// mylinter waive-end qq-rule"), EOL},    // line[2]
+      {TokenInfo(kComment, "// mylinter waive aa-rule"), EOL},        // line[3]
+      {TokenInfo(kOther, "bye"), EOL}                                 // line[4]
+  });
+  const CommentDirectiveIndex directives(
+      text_structure.Data().TokenStream(),
+      [](const TokenInfo &token) { return token.token_enum() == kComment; },
+      {kLinterName, "otherlinter"});
+  ProcessTokenRangesByLine(text_structure.Data(), &directives);
+  const auto &lint_waiver = GetLintWaiver();
+  EXPECT_TRUE(lint_waiver.RuleIsWaivedOnLine("qq-rule", 1));
+  EXPECT_FALSE(lint_waiver.RuleIsWaivedOnLine("qq-rule", 2));
+  EXPECT_FALSE(lint_waiver.RuleIsWaivedOnLine("aa-rule", 3));
+  EXPECT_TRUE(lint_waiver.RuleIsWaivedOnLine("aa-rule", 4));
+}
+
 // Tests that lexical token structure can waive an open range of lines.
 TEST_F(LintWaiverBuilderTest, FromTextStructureOneWaiverRangeOpened) {
   const TextStructureTokenized text_structure({
@@ -765,6 +832,44 @@ TEST_F(LintWaiverBuilderTest, LocationOptionNarrowsTestedFile) {
   EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("abc", 299));   // matching loc
 }
 
+TEST_F(LintWaiverBuilderTest, PreParsedWaiversAppliedToManyFiles) {
+  const std::set<absl::string_view> active_rules{"abc"};
+  const auto waivers = std::make_shared<const ExternalLintWaivers>(
+      active_rules, "waive_file.config",
+      "waive --rule=abc --line=100\n"
+      "waive --rule=abc --line=200 --location=\"other\"\n"
+      "waive --rule=abc --regex=def\n");
+
+  EXPECT_OK(ApplyExternalWaivers(waivers, "some_file.sv"));
+  LintWaiver other_waiver;
+  EXPECT_OK(waivers->ApplyTo("other_file.sv", &other_waiver));
+
+  const absl::string_view file = "abc\ndef\n";
+  const LineColumnMap line_map(file);
+  lint_waiver_.RegexToLines(file, line_map);
+  other_waiver.RegexToLines(file, line_map);
+
+  EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("abc", 99));
+  EXPECT_FALSE(lint_waiver_.RuleIsWaivedOnLine("abc", 199));
+  EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("abc", 1));
+  EXPECT_TRUE(other_waiver.RuleIsWaivedOnLine("abc", 99));
+  EXPECT_TRUE(other_waiver.RuleIsWaivedOnLine("abc", 199));
+  EXPECT_TRUE(other_waiver.RuleIsWaivedOnLine("abc", 1));
+  EXPECT_FALSE(other_waiver.RuleIsWaivedOnLine("abc", 0));
+}
+
+TEST_F(LintWaiverBuilderTest, PreParsedWaiversReportErrorsForEachFile) {
+  const std::set<absl::string_view> active_rules{"abc"};
+  const ExternalLintWaivers waivers(active_rules, "waive_file.config",
+                                    "waive --rule=abc --line=1\n"
+                                    "waive --rule=xyz --line=1\n");
+  LintWaiver first_waiver;
+  LintWaiver second_waiver;
+  EXPECT_NOK(waivers.ApplyTo("filename", &first_waiver));
+  EXPECT_NOK(waivers.ApplyTo("filename", &second_waiver));
+  EXPECT_TRUE(second_waiver.RuleIsWaivedOnLine("abc", 0));
+}
+
 TEST_F(LintWaiverBuilderTest, RegexToLinesSimple) {
   const std::set<absl::string_view> active_rules{"rule-1"};
   const absl::string_view user_file = "filename";
@@ -826,5 +931,43 @@ TEST_F(LintWaiverBuilderTest, RegexToLinesMultipleMatches) {
   EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("rule-1", 2));
 }
 
+TEST_F(LintWaiverBuilderTest, RegexToLinesManyRulesAndRegexes) {
+  const std::set<absl::string_view> active_rules{"rule-1", "rule-2", "rule-3"};
+  const absl::string_view user_file = "filename";
+  const absl::string_view cfg_file = "waive_file.config";
+
+  // rule-1 and rule-2 share a regex; some regexes don't match at all.
+  const absl::string_view cfg_regex =
+      "waive --rule=rule-1 --regex=def\n"
+      "waive --rule=rule-2 --regex=def\n"
+      "waive --rule=rule-2 --regex=xyz\n"
+      "waive --rule=rule-3 --regex=\"g.i\"\n"
+      "waive --rule=rule-3 --regex=nothing\n";
+  EXPECT_OK(ApplyExternalWaivers(active_rules, user_file, cfg_file, cfg_regex));
+
+  const absl::string_view file = "abc\ndef\nghi\ndef\n";
+  const LineColumnMap line_map(file);
+
+  lint_waiver_.RegexToLines(file, line_map);
+
+  for (const absl::string_view rule : {"rule-1", "rule-2"}) {
+    EXPECT_FALSE(lint_waiver_.RuleIsWaivedOnLine(rule, 0)) << rule;
+    EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine(rule, 1)) << rule;
+    EXPECT_FALSE(lint_waiver_.RuleIsWaivedOnLine(rule, 2)) << rule;
+    EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine(rule, 3)) << rule;
+  }
+  EXPECT_FALSE(lint_waiver_.RuleIsWaivedOnLine("rule-3", 1));
+  EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("rule-3", 2));
+
+  // Regexes added later are taken into account for the next file.
+  const absl::string_view cfg_more_regex =
+      "waive --rule=rule-1 --regex=abc\n";
+  EXPECT_OK(
+      ApplyExternalWaivers(active_rules, user_file, cfg_file, cfg_more_regex));
+  lint_waiver_.RegexToLines(file, line_map);
+  EXPECT_TRUE(lint_waiver_.RuleIsWaivedOnLine("rule-1", 0));
+  EXPECT_FALSE(lint_waiver_.RuleIsWaivedOnLine("rule-2", 0));
+}
+
 }  // namespace
 }  // namespace verible
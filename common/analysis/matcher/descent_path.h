@@ -15,9 +15,12 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_MATCHER_DESCENT_PATH_H_
 #define VERIBLE_COMMON_ANALYSIS_MATCHER_DESCENT_PATH_H_
 
+#include <cstddef>
 #include <vector>
 
+#include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
+#include "common/util/casts.h"
 
 namespace verible {
 namespace matcher {
@@ -37,6 +40,24 @@ using DescentPath = std::vector<SymbolTag>;
 std::vector<const Symbol *> GetAllDescendantsFromPath(const Symbol &symbol,
                                                       const DescentPath &path);
 
+// Calls visit(descendant) for every descendant of symbol that
+// GetAllDescendantsFromPath() would return, in the same order, but without
+// collecting them.  'path' points to 'path_length' (> 0) tags.
+template <typename Visitor>
+void ForEachDescendantFromPath(const Symbol &symbol, const SymbolTag *path,
+                               size_t path_length, Visitor &&visit) {
+  if (symbol.Kind() != SymbolKind::kNode) return;
+  for (const auto &child :
+       down_cast<const SyntaxTreeNode *>(&symbol)->children()) {
+    if (!child) continue;
+    if (path_length == 1) {
+      if (child->Tag() == path[0]) visit(*child);
+    } else if (child->Tag() == path[0]) {
+      ForEachDescendantFromPath(*child, path + 1, path_length - 1, visit);
+    }
+  }
+}
+
 }  // namespace matcher
 }  // namespace verible
 
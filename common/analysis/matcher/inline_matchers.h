@@ -0,0 +1,263 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_ANALYSIS_MATCHER_INLINE_MATCHERS_H_
+#define VERIBLE_COMMON_ANALYSIS_MATCHER_INLINE_MATCHERS_H_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "common/analysis/matcher/bound_symbol_manager.h"
+#include "common/analysis/matcher/descent_path.h"
+#include "common/text/symbol.h"
+
+namespace verible {
+namespace matcher {
+
+// Inline matchers are the compile-time counterpart of Matcher (matcher.h).
+// Instead of holding std::function predicates and a vector of inner matchers,
+// each inline matcher is a value type that contains its inner matchers, so a
+// whole matcher expression has one concrete type whose Matches() compiles
+// into direct, inlinable calls, without heap allocation.
+//
+// They match exactly what the corresponding Matcher would, and bind the same
+// symbols:
+//
+//   Matcher                      Inline matcher
+//   Node5(inner...)              Node5.Inline(inner...)
+//   PathLeaf1(inner...)          PathLeaf1.Inline(inner...)
+//   AllOf, AnyOf, EachOf, Unless InlineAllOf, InlineAnyOf, ...
+//
+// where Node5 is a TagMatchBuilder and PathLeaf1 a PathMatchBuilder
+// (matcher_builders.h).  Inner matchers may be inline matchers or Matchers.
+//
+// Usage:
+//   static constexpr auto kMatcher =
+//       Node5.Inline(InlineAnyOf(PathLeaf1.Inline().Bind("leaf"),
+//                                PathNode1.Inline()));
+//   BoundSymbolManager manager;
+//   if (kMatcher.Matches(symbol, &manager)) ...
+//
+// Like Matcher, a matcher that fails to match leaves the manager unchanged,
+// which is what lets the combinators below avoid copying the manager.
+
+namespace internal {
+
+// Returns true if every one of 'inner' matches 'symbol'.  On failure, drops
+// the symbols that the inner matchers bound before one failed.
+template <typename... Inner>
+bool InlineMatchAll(const Symbol &symbol, BoundSymbolManager *manager,
+                    const std::tuple<Inner...> &inner) {
+  if constexpr (sizeof...(Inner) == 0) {
+    return true;
+  } else if constexpr (sizeof...(Inner) == 1) {
+    return std::get<0>(inner).Matches(symbol, manager);
+  } else {
+    const auto match_all = [&symbol, manager](const Inner &...matchers) {
+      return (matchers.Matches(symbol, manager) && ...);
+    };
+    if (manager == nullptr || manager->Size() == 0) {
+      if (std::apply(match_all, inner)) return true;
+      if (manager != nullptr) manager->Clear();
+      return false;
+    }
+    BoundSymbolManager checkpoint(*manager);
+    if (std::apply(match_all, inner)) return true;
+    *manager = std::move(checkpoint);
+    return false;
+  }
+}
+
+// Binds 'symbol' to 'id', unless 'id' is empty.
+inline void InlineBind(absl::string_view id, const Symbol &symbol,
+                       BoundSymbolManager *manager) {
+  if (manager != nullptr && !id.empty()) {
+    manager->BindSymbol(std::string(id), &symbol);
+  }
+}
+
+}  // namespace internal
+
+// Inline counterpart of TagMatchBuilder<Kind, EnumType, Tag>(inner...).
+// Create with TagMatchBuilder::Inline().
+template <SymbolKind Kind, typename EnumType, EnumType Tag, typename... Inner>
+class InlineTagMatcher {
+ public:
+  explicit constexpr InlineTagMatcher(const Inner &...inner)
+      : inner_(inner...) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *manager) const {
+    if (symbol.Tag() != SymbolTag{Kind, static_cast<int>(Tag)}) return false;
+    if (!internal::InlineMatchAll(symbol, manager, inner_)) return false;
+    internal::InlineBind(bind_id_, symbol, manager);
+    return true;
+  }
+
+  // Returns a copy that binds the matched symbol to 'id'.
+  constexpr InlineTagMatcher Bind(absl::string_view id) const {
+    InlineTagMatcher matcher(*this);
+    matcher.bind_id_ = id;
+    return matcher;
+  }
+
+ private:
+  std::tuple<Inner...> inner_;
+  absl::string_view bind_id_;
+};
+
+// Inline counterpart of PathMatchBuilder<N>(inner...): matches if the inner
+// matchers match one of the descendants along the path, and binds every such
+// descendant.  Create with PathMatchBuilder::Inline().
+template <int N, typename... Inner>
+class InlinePathMatcher {
+  static_assert(N > 0, "Path must have at least one element");
+
+ public:
+  constexpr InlinePathMatcher(const std::array<SymbolTag, N> &path,
+                              const Inner &...inner)
+      : path_(path), inner_(inner...) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *manager) const {
+    bool any_target_matches = false;
+    const auto match_target = [this, manager,
+                               &any_target_matches](const Symbol &target) {
+      if (internal::InlineMatchAll(target, manager, inner_)) {
+        internal::InlineBind(bind_id_, target, manager);
+        any_target_matches = true;
+      }
+    };
+    ForEachDescendantFromPath(symbol, path_.data(), N, match_target);
+    return any_target_matches;
+  }
+
+  // Returns a copy that binds the matched descendants to 'id'.
+  constexpr InlinePathMatcher Bind(absl::string_view id) const {
+    InlinePathMatcher matcher(*this);
+    matcher.bind_id_ = id;
+    return matcher;
+  }
+
+ private:
+  std::array<SymbolTag, N> path_;
+  std::tuple<Inner...> inner_;
+  absl::string_view bind_id_;
+};
+
+// Inline counterpart of AllOf (core_matchers.h).
+template <typename... Inner>
+class InlineAllOfMatcher {
+ public:
+  explicit constexpr InlineAllOfMatcher(const Inner &...inner)
+      : inner_(inner...) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *manager) const {
+    return internal::InlineMatchAll(symbol, manager, inner_);
+  }
+
+ private:
+  std::tuple<Inner...> inner_;
+};
+
+template <typename... Inner>
+constexpr InlineAllOfMatcher<Inner...> InlineAllOf(const Inner &...inner) {
+  static_assert(sizeof...(Inner) > 0,
+                "InlineAllOf requires at least one inner matcher");
+  return InlineAllOfMatcher<Inner...>(inner...);
+}
+
+// Inline counterpart of AnyOf (core_matchers.h): only the first matching
+// inner matcher binds symbols.
+template <typename... Inner>
+class InlineAnyOfMatcher {
+ public:
+  explicit constexpr InlineAnyOfMatcher(const Inner &...inner)
+      : inner_(inner...) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *manager) const {
+    return std::apply(
+        [&symbol, manager](const Inner &...matchers) {
+          return (matchers.Matches(symbol, manager) || ...);
+        },
+        inner_);
+  }
+
+ private:
+  std::tuple<Inner...> inner_;
+};
+
+template <typename... Inner>
+constexpr InlineAnyOfMatcher<Inner...> InlineAnyOf(const Inner &...inner) {
+  static_assert(sizeof...(Inner) > 0,
+                "InlineAnyOf requires at least one inner matcher");
+  return InlineAnyOfMatcher<Inner...>(inner...);
+}
+
+// Inline counterpart of EachOf (core_matchers.h): every matching inner
+// matcher binds symbols.
+template <typename... Inner>
+class InlineEachOfMatcher {
+ public:
+  explicit constexpr InlineEachOfMatcher(const Inner &...inner)
+      : inner_(inner...) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *manager) const {
+    return std::apply(
+        [&symbol, manager](const Inner &...matchers) {
+          bool some_inner_matched = false;
+          ((some_inner_matched |= matchers.Matches(symbol, manager)), ...);
+          return some_inner_matched;
+        },
+        inner_);
+  }
+
+ private:
+  std::tuple<Inner...> inner_;
+};
+
+template <typename... Inner>
+constexpr InlineEachOfMatcher<Inner...> InlineEachOf(const Inner &...inner) {
+  static_assert(sizeof...(Inner) > 0,
+                "InlineEachOf requires at least one inner matcher");
+  return InlineEachOfMatcher<Inner...>(inner...);
+}
+
+// Inline counterpart of Unless (core_matchers.h).  The inner matcher does
+// not bind symbols.
+template <typename Inner>
+class InlineUnlessMatcher {
+ public:
+  explicit constexpr InlineUnlessMatcher(const Inner &inner) : inner_(inner) {}
+
+  bool Matches(const Symbol &symbol, BoundSymbolManager *) const {
+    BoundSymbolManager discarded;
+    return !inner_.Matches(symbol, &discarded);
+  }
+
+ private:
+  Inner inner_;
+};
+
+template <typename Inner>
+constexpr InlineUnlessMatcher<Inner> InlineUnless(const Inner &inner) {
+  return InlineUnlessMatcher<Inner>(inner);
+}
+
+}  // namespace matcher
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_ANALYSIS_MATCHER_INLINE_MATCHERS_H_
@@ -0,0 +1,95 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares matching with Matcher and with the equivalent inline matcher, on
+// symbols shaped like the ones lint rules look at: most do not have the
+// tag of interest, some do but lack the inner structure, few match.
+//
+//   bazel run -c opt //common/analysis/matcher:inline-matchers_benchmark
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/analysis/matcher/bound_symbol_manager.h"
+#include "common/analysis/matcher/core_matchers.h"
+#include "common/analysis/matcher/inline_matchers.h"
+#include "common/analysis/matcher/matcher.h"
+#include "common/analysis/matcher/matcher_builders.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/tree_builder_test_util.h"
+
+namespace verible {
+namespace matcher {
+namespace {
+
+constexpr TagMatchBuilder<SymbolKind::kNode, int, 5> Node5;
+constexpr auto PathNode1 = MakePathMatcher(NodeTag(1));
+constexpr auto PathLeaf1 = MakePathMatcher(LeafTag(1));
+constexpr auto PathLeaf2 = MakePathMatcher(LeafTag(2));
+
+static std::vector<SymbolPtr> MakeSymbols() {
+  std::vector<SymbolPtr> symbols;
+  for (int i = 0; i < 1000; ++i) {
+    switch (i % 8) {
+      case 0:
+        symbols.push_back(TNode(5, TNode(1, XLeaf(2)), XLeaf(1)));
+        break;
+      case 1:
+        symbols.push_back(TNode(5, TNode(1, XLeaf(3)), XLeaf(3)));
+        break;
+      default:
+        symbols.push_back(TNode(3, XLeaf(1), TNode(1, XLeaf(2))));
+        break;
+    }
+  }
+  return symbols;
+}
+
+template <typename M>
+static void MatchAll(benchmark::State &state, const M &matcher) {
+  const std::vector<SymbolPtr> symbols = MakeSymbols();
+  for (auto _ : state) {
+    int matches = 0;
+    for (const auto &symbol : symbols) {
+      BoundSymbolManager manager;
+      matches += matcher.Matches(*symbol, &manager);
+    }
+    benchmark::DoNotOptimize(matches);
+  }
+  state.SetItemsProcessed(state.iterations() * symbols.size());
+}
+
+static void BM_Matcher(benchmark::State &state) {
+  static const Matcher matcher(
+      Node5(PathNode1(PathLeaf2().Bind("id")),
+            AnyOf(PathLeaf1().Bind("leaf"), PathNode1().Bind("node"))));
+  MatchAll(state, matcher);
+}
+BENCHMARK(BM_Matcher);
+
+static void BM_InlineMatcher(benchmark::State &state) {
+  static constexpr auto matcher = Node5.Inline(
+      PathNode1.Inline(PathLeaf2.Inline().Bind("id")),
+      InlineAnyOf(PathLeaf1.Inline().Bind("leaf"),
+                  PathNode1.Inline().Bind("node")));
+  MatchAll(state, matcher);
+}
+BENCHMARK(BM_InlineMatcher);
+
+}  // namespace
+}  // namespace matcher
+}  // namespace verible
+
+BENCHMARK_MAIN();
@@ -0,0 +1,151 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/analysis/matcher/inline_matchers.h"
+
+#include "common/analysis/matcher/bound_symbol_manager.h"
+#include "common/analysis/matcher/core_matchers.h"
+#include "common/analysis/matcher/matcher.h"
+#include "common/analysis/matcher/matcher_builders.h"
+#include "common/text/symbol.h"
+#include "common/text/tree_builder_test_util.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace matcher {
+namespace {
+
+constexpr TagMatchBuilder<SymbolKind::kNode, int, 5> Node5;
+constexpr TagMatchBuilder<SymbolKind::kNode, int, 1> Node1;
+constexpr TagMatchBuilder<SymbolKind::kLeaf, int, 1> Leaf1;
+
+constexpr auto PathNode1 = MakePathMatcher(NodeTag(1));
+constexpr auto PathLeaf1 = MakePathMatcher(LeafTag(1));
+constexpr auto PathNode2 = MakePathMatcher(NodeTag(2));
+constexpr auto PathLeaf2 = MakePathMatcher(LeafTag(2));
+constexpr auto PathNode1Leaf2 = MakePathMatcher(NodeTag(1), LeafTag(2));
+
+// Inline matchers are literal types.
+constexpr auto kConstexprMatcher =
+    Node5.Inline(InlineAnyOf(PathLeaf1.Inline().Bind("leaf"),
+                             InlineUnless(PathNode1.Inline())));
+
+// Expects that 'inline_matcher' matches 'tree' like 'matcher' does, and binds
+// the same symbols, starting from the same bound symbols.
+template <typename InlineMatcher>
+void ExpectSameMatch(const Matcher &matcher,
+                     const InlineMatcher &inline_matcher, const Symbol &tree,
+                     const BoundSymbolManager &initial = {}) {
+  BoundSymbolManager expected(initial);
+  BoundSymbolManager actual(initial);
+  EXPECT_EQ(inline_matcher.Matches(tree, &actual),
+            matcher.Matches(tree, &expected));
+  EXPECT_EQ(actual.GetBoundMap(), expected.GetBoundMap());
+}
+
+TEST(InlineMatchersTest, TagMatcher) {
+  const auto trees = {TNode(5), TNode(1), XLeaf(1), TNode(5, XLeaf(1))};
+  for (const auto &tree : trees) {
+    ExpectSameMatch(Node5(), Node5.Inline(), *tree);
+    ExpectSameMatch(Node5().Bind("n"), Node5.Inline().Bind("n"), *tree);
+    ExpectSameMatch(Leaf1().Bind("l"), Leaf1.Inline().Bind("l"), *tree);
+    ExpectSameMatch(Node5(PathLeaf1().Bind("l")),
+                    Node5.Inline(PathLeaf1.Inline().Bind("l")), *tree);
+  }
+}
+
+TEST(InlineMatchersTest, PathMatcher) {
+  const auto trees = {
+      TNode(5),
+      TNode(5, XLeaf(1)),
+      TNode(5, TNode(1, XLeaf(2)), TNode(1, XLeaf(3), XLeaf(2))),
+      TNode(5, TNode(1, XLeaf(1)), nullptr, TNode(2, XLeaf(2))),
+      XLeaf(2),
+  };
+  for (const auto &tree : trees) {
+    ExpectSameMatch(PathLeaf1(), PathLeaf1.Inline(), *tree);
+    ExpectSameMatch(PathNode1Leaf2().Bind("l"),
+                    PathNode1Leaf2.Inline().Bind("l"), *tree);
+    ExpectSameMatch(PathNode1(PathLeaf2().Bind("l")).Bind("n"),
+                    PathNode1.Inline(PathLeaf2.Inline().Bind("l")).Bind("n"),
+                    *tree);
+  }
+}
+
+TEST(InlineMatchersTest, Combinators) {
+  const auto trees = {
+      TNode(5),
+      TNode(5, XLeaf(1)),
+      TNode(5, TNode(1)),
+      TNode(5, TNode(1), XLeaf(1)),
+      TNode(5, TNode(2), XLeaf(2)),
+      TNode(5, XLeaf(1), XLeaf(2), TNode(1)),
+  };
+  BoundSymbolManager initial;
+  const auto bound = TNode(7);
+  initial.BindSymbol("earlier", bound.get());
+  for (const auto &tree : trees) {
+    for (const BoundSymbolManager &start : {BoundSymbolManager(), initial}) {
+      ExpectSameMatch(
+          Node5(AllOf(PathLeaf1().Bind("l"), PathNode1().Bind("n"))),
+          Node5.Inline(InlineAllOf(PathLeaf1.Inline().Bind("l"),
+                                   PathNode1.Inline().Bind("n"))),
+          *tree, start);
+      ExpectSameMatch(
+          Node5(AnyOf(PathNode1().Bind("n"), PathLeaf1().Bind("l"))),
+          Node5.Inline(InlineAnyOf(PathNode1.Inline().Bind("n"),
+                                   PathLeaf1.Inline().Bind("l"))),
+          *tree, start);
+      ExpectSameMatch(
+          Node5(EachOf(PathNode2().Bind("n2"), PathLeaf1().Bind("l"),
+                       PathLeaf2().Bind("l2"), PathNode1().Bind("n"))),
+          Node5.Inline(InlineEachOf(
+              PathNode2.Inline().Bind("n2"), PathLeaf1.Inline().Bind("l"),
+              PathLeaf2.Inline().Bind("l2"), PathNode1.Inline().Bind("n"))),
+          *tree, start);
+      ExpectSameMatch(Node5(Unless(PathNode1().Bind("n"))).Bind("outer"),
+                      Node5.Inline(InlineUnless(PathNode1.Inline().Bind("n")))
+                          .Bind("outer"),
+                      *tree, start);
+      ExpectSameMatch(
+          Node5(Node5().Bind("first"), PathLeaf2().Bind("l2")),
+          Node5.Inline(Node5.Inline().Bind("first"),
+                       PathLeaf2.Inline().Bind("l2")),
+          *tree, start);
+    }
+  }
+}
+
+TEST(InlineMatchersTest, ConstexprMatcher) {
+  BoundSymbolManager manager;
+  EXPECT_TRUE(kConstexprMatcher.Matches(*TNode(5, XLeaf(1)), &manager));
+  EXPECT_NE(manager.FindSymbol("leaf"), nullptr);
+  manager.Clear();
+  EXPECT_TRUE(kConstexprMatcher.Matches(*TNode(5), &manager));
+  EXPECT_FALSE(kConstexprMatcher.Matches(*TNode(5, TNode(1)), &manager));
+  EXPECT_EQ(manager.Size(), 0);
+}
+
+TEST(InlineMatchersTest, MatcherAsInnerMatcher) {
+  const Matcher dynamic_inner = PathLeaf1().Bind("l");
+  const auto trees = {TNode(5), TNode(5, XLeaf(1)), TNode(1, XLeaf(1))};
+  for (const auto &tree : trees) {
+    ExpectSameMatch(Node5(PathLeaf1().Bind("l")), Node5.Inline(dynamic_inner),
+                    *tree);
+  }
+}
+
+}  // namespace
+}  // namespace matcher
+}  // namespace verible
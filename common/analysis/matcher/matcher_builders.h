@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "common/analysis/matcher/descent_path.h"
+#include "common/analysis/matcher/inline_matchers.h"
 #include "common/analysis/matcher/inner_match_handlers.h"
 #include "common/analysis/matcher/matcher.h"
 #include "common/text/symbol.h"
@@ -99,6 +100,13 @@ class PathMatchBuilder {
     return matcher;
   }
 
+  // Returns the inline form of this matcher, see inline_matchers.h.
+  template <typename... Inner>
+  constexpr InlinePathMatcher<N, Inner...> Inline(
+      const Inner &...inner) const {
+    return InlinePathMatcher<N, Inner...>(path_, inner...);
+  }
+
  private:
   std::array<SymbolTag, N> path_;
 };
@@ -154,6 +162,13 @@ class TagMatchBuilder {
     matcher.AddMatchers(std::forward<Args>(args)...);
     return matcher;
   }
+
+  // Returns the inline form of this matcher, see inline_matchers.h.
+  template <typename... Inner>
+  constexpr InlineTagMatcher<Kind, EnumType, Tag, Inner...> Inline(
+      const Inner &...inner) const {
+    return InlineTagMatcher<Kind, EnumType, Tag, Inner...>(inner...);
+  }
 };
 
 // DynamicTagMatchBuilder is a Matcher generator that takes a Kind and Tag
@@ -0,0 +1,94 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/name_style_checker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/util/logging.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace verible {
+
+NameStyleChecker::NameStyleChecker(
+    std::vector<const std::unique_ptr<re2::RE2> *> styles)
+    : styles_(std::move(styles)) {
+  CHECK_LE(styles_.size(), kMaxStyles);
+}
+
+void NameStyleChecker::Build() {
+  built_for_.clear();
+  for (const auto *style : styles_) built_for_.push_back(style->get());
+  matches_.clear();
+
+  regex_set_ = std::make_unique<re2::RE2::Set>(RE2::Options(RE2::Quiet),
+                                               RE2::ANCHOR_BOTH);
+  for (const re2::RE2 *regex : built_for_) {
+    // Invalid regexes match nothing, as with RE2::FullMatch().
+    if (regex == nullptr || !regex->ok() ||
+        regex_set_->Add(regex->pattern(), nullptr) < 0) {
+      regex_set_.reset();
+      return;
+    }
+  }
+  if (!regex_set_->Compile()) {
+    LOG(WARNING) << "Name style regexes are too many to be combined, trying "
+                    "them one by one.";
+    regex_set_.reset();
+  }
+}
+
+uint64_t NameStyleChecker::MatchOneByOne(absl::string_view name) const {
+  uint64_t matches = 0;
+  for (size_t i = 0; i < built_for_.size(); ++i) {
+    if (built_for_[i] != nullptr && RE2::FullMatch(name, *built_for_[i])) {
+      matches |= uint64_t{1} << i;
+    }
+  }
+  return matches;
+}
+
+uint64_t NameStyleChecker::Match(absl::string_view name) {
+  bool outdated = built_for_.size() != styles_.size();
+  for (size_t i = 0; !outdated && i < styles_.size(); ++i) {
+    outdated = styles_[i]->get() != built_for_[i];
+  }
+  if (outdated) Build();
+
+  const auto found = matches_.find(name);
+  if (found != matches_.end()) return found->second;
+
+  uint64_t matches = 0;
+  std::vector<int> matching;
+  re2::RE2::Set::ErrorInfo error_info{re2::RE2::Set::kNoError};
+  if (regex_set_ == nullptr ||
+      (!regex_set_->Match(name, &matching, &error_info) &&
+       error_info.kind != re2::RE2::Set::kNoError)) {
+    matches = MatchOneByOne(name);
+  } else {
+    for (const int index : matching) matches |= uint64_t{1} << index;
+  }
+  matches_.emplace(name, matches);
+  return matches;
+}
+
+}  // namespace verible
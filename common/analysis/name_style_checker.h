@@ -0,0 +1,88 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_COMMON_ANALYSIS_NAME_STYLE_CHECKER_H_
+#define VERIBLE_COMMON_ANALYSIS_NAME_STYLE_CHECKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace verible {
+
+// NameStyleChecker checks names against the style regexes of a lint rule.
+// All styles are evaluated for a name in one RE2::Set match, and the result
+// is remembered for each distinct name, as the same names tend to recur.
+//
+// The checker refers to the rule's RE2 members, so that it follows their
+// reconfiguration without any further ado.
+//
+// Usage:
+//   std::unique_ptr<re2::RE2> style_regex_;  // configurable
+//   NameStyleChecker style_checker_{{&style_regex_}};
+//   ...
+//   if (!style_checker_.Matches(name, 0)) { /* violation */ }
+class NameStyleChecker {
+ public:
+  // The uint64_t result of Match() limits the number of styles.
+  static constexpr size_t kMaxStyles = 64;
+
+  // 'styles' point to the regexes that names are checked against, and must
+  // outlive this checker.
+  explicit NameStyleChecker(
+      std::vector<const std::unique_ptr<re2::RE2> *> styles);
+
+  NameStyleChecker(const NameStyleChecker &) = delete;
+  NameStyleChecker &operator=(const NameStyleChecker &) = delete;
+
+  // Returns true if 'name' fully matches the style with index 'style'.
+  bool Matches(absl::string_view name, size_t style) {
+    return (Match(name) >> style) & 1;
+  }
+
+  // Returns the set of styles that 'name' fully matches, with bit i set for
+  // the style with index i.
+  uint64_t Match(absl::string_view name);
+
+ private:
+  // Compiles the current regexes into regex_set_, and forgets earlier
+  // matches.
+  void Build();
+
+  // Matches each regex separately.
+  uint64_t MatchOneByOne(absl::string_view name) const;
+
+  std::vector<const std::unique_ptr<re2::RE2> *> styles_;
+
+  // The regexes that regex_set_ and matches_ are for.
+  std::vector<const re2::RE2 *> built_for_;
+
+  // All styles, indexed like styles_. Null if they couldn't be combined.
+  std::unique_ptr<re2::RE2::Set> regex_set_;
+
+  // Match() of each name seen so far.
+  absl::flat_hash_map<std::string, uint64_t> matches_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_ANALYSIS_NAME_STYLE_CHECKER_H_
@@ -0,0 +1,72 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/name_style_checker.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace verible {
+namespace {
+
+TEST(NameStyleCheckerTest, NoStyles) {
+  NameStyleChecker checker({});
+  EXPECT_EQ(checker.Match("foo"), 0);
+}
+
+TEST(NameStyleCheckerTest, FullMatches) {
+  auto lower = std::make_unique<re2::RE2>("[a-z_0-9]+", re2::RE2::Quiet);
+  auto upper = std::make_unique<re2::RE2>("[A-Z_0-9]+", re2::RE2::Quiet);
+  auto suffix = std::make_unique<re2::RE2>("[a-z]+_t|[a-z]+_e", RE2::Quiet);
+  NameStyleChecker checker({&lower, &upper, &suffix});
+
+  EXPECT_EQ(checker.Match("foo"), 0b001);
+  EXPECT_EQ(checker.Match("FOO"), 0b010);
+  EXPECT_EQ(checker.Match("foo_t"), 0b101);
+  EXPECT_EQ(checker.Match("foo_e"), 0b101);
+  EXPECT_EQ(checker.Match("_1"), 0b011);
+  EXPECT_EQ(checker.Match("Foo"), 0);
+  // Not a full match of either alternative.
+  EXPECT_EQ(checker.Match("FOO_t"), 0);
+
+  EXPECT_TRUE(checker.Matches("foo", 0));
+  EXPECT_FALSE(checker.Matches("foo", 1));
+  // Repeated names give the same results.
+  EXPECT_EQ(checker.Match("foo_t"), 0b101);
+}
+
+TEST(NameStyleCheckerTest, FollowsReconfiguration) {
+  auto style = std::make_unique<re2::RE2>("[a-z]+", re2::RE2::Quiet);
+  NameStyleChecker checker({&style});
+  EXPECT_TRUE(checker.Matches("foo", 0));
+  EXPECT_FALSE(checker.Matches("FOO", 0));
+
+  style = std::make_unique<re2::RE2>("[A-Z]+", re2::RE2::Quiet);
+  EXPECT_FALSE(checker.Matches("foo", 0));
+  EXPECT_TRUE(checker.Matches("FOO", 0));
+}
+
+TEST(NameStyleCheckerTest, InvalidStyleMatchesNothing) {
+  auto valid = std::make_unique<re2::RE2>("[a-z]+", re2::RE2::Quiet);
+  auto invalid = std::make_unique<re2::RE2>("[a-z", re2::RE2::Quiet);
+  NameStyleChecker checker({&valid, &invalid});
+  EXPECT_EQ(checker.Match("foo"), 0b01);
+  EXPECT_EQ(checker.Match("[a-z"), 0);
+}
+
+}  // namespace
+}  // namespace verible
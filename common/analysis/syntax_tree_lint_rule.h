@@ -15,6 +15,8 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINT_RULE_H_
 #define VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINT_RULE_H_
 
+#include <vector>
+
 #include "common/analysis/lint_rule.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
@@ -26,7 +28,8 @@ namespace verible {
 // SyntaxTreeLintRule is a base class for analyzing syntax trees for lint
 // violations.  Subclasses of this can be added to a SyntaxTreeLinter and can
 // expect to have their HandleLeaf and HandleNode methods called on every
-// leaf/node in the tree that the linter is run on.
+// leaf/node in the tree that the linter is run on, or only on those with the
+// tags returned by HandledSymbolTags().
 //
 // For usage, see linter.h
 //
@@ -40,6 +43,20 @@ class SyntaxTreeLintRule : public LintRule {
  public:
   ~SyntaxTreeLintRule() override = default;  // not yet final
 
+  // Tag that stands for all nodes or all leaves in HandledSymbolTags().
+  static constexpr int kAnyTag = -1;
+
+  // Returns the tags of the nodes and leaves (by token enum) that this rule
+  // handles.  The linter only calls HandleLeaf(), HandleNode() and
+  // HandleSymbol() with symbols that have one of these tags, which spares
+  // rules that only look at a few kinds of symbols from seeing all others.
+  // NodeTag(kAnyTag) and LeafTag(kAnyTag) stand for all nodes and all leaves;
+  // by default, a rule handles all symbols.
+  // This is called once, when the rule is added to the linter.
+  virtual std::vector<SymbolTag> HandledSymbolTags() const {
+    return {NodeTag(kAnyTag), LeafTag(kAnyTag)};
+  }
+
   virtual void HandleLeaf(const SyntaxTreeLeaf &leaf,
                           const SyntaxTreeContext &context) {}
   virtual void HandleNode(const SyntaxTreeNode &node,
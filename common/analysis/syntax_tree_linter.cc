@@ -14,9 +14,12 @@
 
 #include "common/analysis/syntax_tree_linter.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/text/concrete_syntax_leaf.h"
@@ -24,13 +27,83 @@
 #include "common/text/symbol.h"
 #include "common/text/tree_context_visitor.h"
 #include "common/util/logging.h"
+#include "common/util/trace.h"
 
 namespace verible {
 
+void SyntaxTreeLinter::RuleDispatchTable::Add(SyntaxTreeLintRule *rule,
+                                              const std::vector<int> &tags) {
+  if (std::find(tags.begin(), tags.end(), SyntaxTreeLintRule::kAnyTag) !=
+      tags.end()) {
+    any_tag_rules_.push_back(rule);
+    for (auto &tag_rules : rules_by_tag_) tag_rules.second.push_back(rule);
+    return;
+  }
+  for (const int tag : tags) {
+    std::vector<SyntaxTreeLintRule *> &tag_rules =
+        rules_by_tag_.try_emplace(tag, any_tag_rules_).first->second;
+    if (tag_rules.empty() || tag_rules.back() != rule) {
+      tag_rules.push_back(rule);
+    }
+  }
+}
+
+void SyntaxTreeLinter::AddRule(std::unique_ptr<SyntaxTreeLintRule> rule,
+                               bool local) {
+  std::vector<int> node_tags;
+  std::vector<int> leaf_tags;
+  for (const SymbolTag &tag : ABSL_DIE_IF_NULL(rule)->HandledSymbolTags()) {
+    (tag.kind == SymbolKind::kNode ? node_tags : leaf_tags).push_back(tag.tag);
+  }
+  node_rules_.Add(rule.get(), node_tags);
+  leaf_rules_.Add(rule.get(), leaf_tags);
+  if (!local) {
+    nonlocal_node_rules_.Add(rule.get(), node_tags);
+    nonlocal_leaf_rules_.Add(rule.get(), leaf_tags);
+  }
+  rules_.emplace_back(std::move(rule));
+}
+
+void SyntaxTreeLinter::SelectRulesFor(const Symbol &symbol) {
+  const bool known = known_(symbol);
+  active_node_rules_ = known ? &nonlocal_node_rules_ : &node_rules_;
+  active_leaf_rules_ = known ? &nonlocal_leaf_rules_ : &leaf_rules_;
+}
+
 void SyntaxTreeLinter::Lint(const Symbol &root) {
   VLOG(1) << "SyntaxTreeLinter analyzing syntax tree with " << rules_.size()
           << " rules.";
-  root.Accept(this);
+  if (lint_profile::Enabled()) {
+    for (const auto &rule : rules_) profiles_[rule.get()];
+  }
+  if (trace::Enabled()) {
+    // One traversal per rule, so that each rule gets its own trace span.
+    for (const auto &rule : rules_) {
+      traced_rule_ = rule.get();
+      TraceLintRule(*rule, [&] { Walk(root); });
+    }
+    traced_rule_ = nullptr;
+  } else {
+    Walk(root);
+  }
+  active_node_rules_ = &node_rules_;
+  active_leaf_rules_ = &leaf_rules_;
+  for (const auto &profile : profiles_) {
+    lint_profile::Record(*profile.first, profile.second);
+  }
+  profiles_.clear();
+}
+
+void SyntaxTreeLinter::Lint(const Symbol &root,
+                            const LeafObserver &before_leaf) {
+  before_leaf_ = &before_leaf;
+  Lint(root);
+  before_leaf_ = nullptr;
+}
+
+LintRuleProfile *SyntaxTreeLinter::ProfileOf(const SyntaxTreeLintRule *rule) {
+  if (profiles_.empty()) return nullptr;
+  return &profiles_[rule];
 }
 
 std::vector<LintRuleStatus> SyntaxTreeLinter::ReportStatus() const {
@@ -42,27 +115,40 @@ std::vector<LintRuleStatus> SyntaxTreeLinter::ReportStatus() const {
   return status;
 }
 
-// Visits a leaf. Every held rule handles that leaf.
+// Visits a leaf. Every held rule that handles its tag handles that leaf.
 void SyntaxTreeLinter::Visit(const SyntaxTreeLeaf &leaf) {
-  for (const auto &rule : rules_) {
+  if (before_leaf_ != nullptr) (*before_leaf_)(leaf);
+  if (known_ && Context().size() == 1) SelectRulesFor(leaf);
+  for (SyntaxTreeLintRule *rule :
+       active_leaf_rules_->RulesFor(leaf.Tag().tag)) {
+    if (traced_rule_ != nullptr && rule != traced_rule_) continue;
     // Have rule handle the leaf as both a leaf and a symbol.
-    ABSL_DIE_IF_NULL(rule)->HandleLeaf(leaf, Context());
-    rule->HandleSymbol(leaf, Context());
+    ProfileLintRuleCall(ProfileOf(rule), [&] {
+      rule->HandleLeaf(leaf, Context());
+      rule->HandleSymbol(leaf, Context());
+    });
   }
 }
 
-// Visits a node. First, linter has every rule handle that node
-// Second, linter recurses on every non-null child of that node in order
-// to visit the entire tree
 void SyntaxTreeLinter::Visit(const SyntaxTreeNode &node) {
-  for (const auto &rule : rules_) {
+  WalkTree(node, this, &current_context_);
+}
+
+// Enters a node. First, linter has every rule that handles its tag handle
+// that node.  Second, the walk continues with every non-null child of that
+// node in order to visit the entire tree
+bool SyntaxTreeLinter::EnterNode(const SyntaxTreeNode &node) {
+  if (known_ && Context().size() == 1) SelectRulesFor(node);
+  for (SyntaxTreeLintRule *rule :
+       active_node_rules_->RulesFor(node.Tag().tag)) {
+    if (traced_rule_ != nullptr && rule != traced_rule_) continue;
     // Have rule handle the node as both a node and a symbol.
-    ABSL_DIE_IF_NULL(rule)->HandleNode(node, Context());
-    rule->HandleSymbol(node, Context());
+    ProfileLintRuleCall(ProfileOf(rule), [&] {
+      rule->HandleNode(node, Context());
+      rule->HandleSymbol(node, Context());
+    });
   }
-
-  // Visit subtree children.
-  TreeContextVisitor::Visit(node);
+  return true;
 }
 
 }  // namespace verible
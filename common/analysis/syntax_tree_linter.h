@@ -19,10 +19,13 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINTER_H_
 #define VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINTER_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/text/concrete_syntax_leaf.h"
@@ -44,19 +47,32 @@ namespace verible {
 //  linter.Lint(tree)
 //  std::vector<LintRuleStatus> status = linter.ReportStatus();
 //
-// Note that the tree is traversed in a preorder traversal.
+// Note that the tree is traversed in a preorder traversal.  Each node and
+// leaf is only passed to the rules that handle its tag (see
+// SyntaxTreeLintRule::HandledSymbolTags()), in the order they were added.
 //
 class SyntaxTreeLinter : public TreeContextVisitor {
  public:
   SyntaxTreeLinter() = default;
 
   void Visit(const SyntaxTreeLeaf &leaf) final;
+  // Lints the subtree with WalkTree(), so that deep trees don't recurse.
   void Visit(const SyntaxTreeNode &node) final;
+  bool EnterNode(const SyntaxTreeNode &node) final;
 
-  // Transfers ownership of rule into Linter
-  void AddRule(std::unique_ptr<SyntaxTreeLintRule> rule) {
-    rules_.emplace_back(std::move(rule));
-  }
+  // Transfers ownership of rule into Linter.
+  // A 'local' rule's findings within each subtree directly under the root
+  // only depend on that subtree (see SetKnownSubtrees()).
+  void AddRule(std::unique_ptr<SyntaxTreeLintRule> rule, bool local = false);
+
+  // Returns true for the subtrees directly under the root, for which the
+  // findings of local rules are already known.
+  using SubtreeFilter = std::function<bool(const Symbol &)>;
+
+  // In the following Lint()s, local rules do not see the subtrees directly
+  // under the root for which 'known' returns true, while the other rules still
+  // see the whole tree.  An empty 'known' shows every rule the whole tree.
+  void SetKnownSubtrees(SubtreeFilter known) { known_ = std::move(known); }
 
   // Aggregates results of each held LintRule
   std::vector<LintRuleStatus> ReportStatus() const;
@@ -64,10 +80,72 @@ class SyntaxTreeLinter : public TreeContextVisitor {
   // Performs lint analysis on root
   void Lint(const Symbol &root);
 
+  // Called with each leaf of the tree, in order, before the rules see it.
+  using LeafObserver = std::function<void(const SyntaxTreeLeaf &)>;
+
+  // Performs lint analysis on root, calling 'before_leaf' on the way, so that
+  // other per-token work can share the same forward scan over the text.
+  // While tracing, there is one traversal per rule, and 'before_leaf' is
+  // called in each.
+  void Lint(const Symbol &root, const LeafObserver &before_leaf);
+
  private:
+  // Selects the rules that see 'symbol', which is directly under the root.
+  void SelectRulesFor(const Symbol &symbol);
+
+  // Returns the profile of 'rule' in the current Lint(), or nullptr if not
+  // profiling.
+  LintRuleProfile *ProfileOf(const SyntaxTreeLintRule *rule);
+
+  // Rules that handle the symbols of one kind (nodes or leaves), by tag.
+  class RuleDispatchTable {
+   public:
+    // Adds 'rule' for 'tags', or for all tags if these include kAnyTag.
+    void Add(SyntaxTreeLintRule *rule, const std::vector<int> &tags);
+
+    // Returns the rules handling 'tag', in the order they were added.
+    const std::vector<SyntaxTreeLintRule *> &RulesFor(int tag) const {
+      const auto found = rules_by_tag_.find(tag);
+      return found == rules_by_tag_.end() ? any_tag_rules_ : found->second;
+    }
+
+   private:
+    // Rules that handle all tags.
+    std::vector<SyntaxTreeLintRule *> any_tag_rules_;
+
+    // Rules for each tag that some rule specifically handles, including the
+    // any_tag_rules_.
+    absl::flat_hash_map<int, std::vector<SyntaxTreeLintRule *>> rules_by_tag_;
+  };
+
   // List of rules that the linter is using. Rules are responsible for tracking
   // their own internal state.
   std::vector<std::unique_ptr<SyntaxTreeLintRule>> rules_;
+
+  RuleDispatchTable node_rules_;
+  RuleDispatchTable leaf_rules_;
+
+  // Like above, but without the local rules.
+  RuleDispatchTable nonlocal_node_rules_;
+  RuleDispatchTable nonlocal_leaf_rules_;
+
+  // The tables for the symbols currently visited.
+  const RuleDispatchTable *active_node_rules_ = &node_rules_;
+  const RuleDispatchTable *active_leaf_rules_ = &leaf_rules_;
+
+  // Subtrees hidden from local rules, see SetKnownSubtrees().
+  SubtreeFilter known_;
+
+  // While tracing, the only rule that handles symbols in the current
+  // traversal; nullptr dispatches to all rules.
+  const SyntaxTreeLintRule *traced_rule_ = nullptr;
+
+  // Observer of the leaves in the current Lint(), if any.
+  const LeafObserver *before_leaf_ = nullptr;
+
+  // While profiling is enabled, the profile of each rule in the current
+  // Lint(); otherwise empty.
+  absl::flat_hash_map<const SyntaxTreeLintRule *, LintRuleProfile> profiles_;
 };
 
 }  // namespace verible
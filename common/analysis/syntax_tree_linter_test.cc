@@ -17,6 +17,9 @@
 #include <cstddef>
 #include <memory>
 #include <set>
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -29,6 +32,7 @@
 #include "common/text/token_info.h"
 #include "common/text/tree_builder_test_util.h"
 #include "common/util/casts.h"
+#include "common/util/trace.h"
 #include "gtest/gtest.h"
 
 namespace verible {
@@ -112,6 +116,35 @@ TEST(SyntaxTreeLinterTest, MultipleRules) {
   EXPECT_EQ(statuses[1].violations.size(), 4);
 }
 
+TEST(SyntaxTreeLinterTest, MultipleRulesTraced) {
+  constexpr absl::string_view text("abcd");
+  SymbolPtr root =
+      Node(Leaf(2, text.substr(0, 1)), Leaf(2, text.substr(1, 1)),
+           Node(Leaf(2, text.substr(2, 1))), Leaf(3, text.substr(3, 1)));
+
+  SyntaxTreeLinter linter;
+  linter.AddRule(MakeRuleN(2));
+  linter.AddRule(MakeRuleN(3));
+
+  ASSERT_NE(root, nullptr);
+  trace::Clear();
+  trace::SetEnabled(true);
+  linter.Lint(*root);
+  trace::SetEnabled(false);
+
+  // Running the rules one traversal at a time yields the same findings.
+  std::vector<LintRuleStatus> statuses = linter.ReportStatus();
+  ASSERT_EQ(statuses.size(), 2);
+  EXPECT_EQ(statuses[0].violations.size(), 1);
+  EXPECT_EQ(statuses[1].violations.size(), 3);
+
+  std::ostringstream json;
+  trace::WriteChromeTrace(json);
+  EXPECT_NE(json.str().find("\"cat\":\"lint\""), std::string::npos)
+      << json.str();
+  trace::Clear();
+}
+
 // Simple testing rule that verifies that every node's leaf children have tags
 // that are in ascending order
 class ChildrenLeavesAscending : public SyntaxTreeLintRule {
@@ -279,5 +312,84 @@ TEST(SyntaxTreeLinterTest, DepthSuccess) {
   EXPECT_EQ(statuses[0].violations.size(), 0);
 }
 
+// Records the tags of the symbols it handles.
+class TagRecorder : public SyntaxTreeLintRule {
+ public:
+  explicit TagRecorder(std::vector<SymbolTag> tags) : tags_(std::move(tags)) {}
+
+  std::vector<SymbolTag> HandledSymbolTags() const final { return tags_; }
+
+  void HandleSymbol(const Symbol &symbol,
+                    const SyntaxTreeContext &context) final {
+    handled.push_back(symbol.Tag());
+  }
+
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+  std::vector<SymbolTag> handled;
+
+ private:
+  const std::vector<SymbolTag> tags_;
+};
+
+TEST(SyntaxTreeLinterTest, RulesOnlyHandleTheirTags) {
+  SymbolPtr root = TNode(1, XLeaf(2), TNode(3, XLeaf(4), XLeaf(2)), XLeaf(5));
+
+  auto nodes_3_and_leaves_2 =
+      std::make_unique<TagRecorder>(std::vector<SymbolTag>{
+          NodeTag(3), LeafTag(2), LeafTag(2)});
+  auto all_leaves = std::make_unique<TagRecorder>(
+      std::vector<SymbolTag>{LeafTag(SyntaxTreeLintRule::kAnyTag)});
+  auto everything = std::make_unique<TagRecorder>(
+      std::vector<SymbolTag>{NodeTag(SyntaxTreeLintRule::kAnyTag),
+                             LeafTag(SyntaxTreeLintRule::kAnyTag)});
+  const TagRecorder &rule1 = *nodes_3_and_leaves_2;
+  const TagRecorder &rule2 = *all_leaves;
+  const TagRecorder &rule3 = *everything;
+
+  SyntaxTreeLinter linter;
+  linter.AddRule(std::move(nodes_3_and_leaves_2));
+  linter.AddRule(std::move(all_leaves));
+  linter.AddRule(std::move(everything));
+  linter.Lint(*root);
+
+  EXPECT_EQ(rule1.handled, (std::vector<SymbolTag>{LeafTag(2), NodeTag(3),
+                                                   LeafTag(2)}));
+  EXPECT_EQ(rule2.handled, (std::vector<SymbolTag>{LeafTag(2), LeafTag(4),
+                                                   LeafTag(2), LeafTag(5)}));
+  EXPECT_EQ(rule3.handled,
+            (std::vector<SymbolTag>{NodeTag(1), LeafTag(2), NodeTag(3),
+                                    LeafTag(4), LeafTag(2), LeafTag(5)}));
+}
+
+TEST(SyntaxTreeLinterTest, LocalRulesSkipKnownSubtrees) {
+  SymbolPtr root = TNode(1, TNode(3, XLeaf(4)), XLeaf(2), TNode(5, XLeaf(4)));
+  const Symbol *known =
+      down_cast<const SyntaxTreeNode *>(root.get())->front().get();
+
+  auto local = std::make_unique<TagRecorder>(
+      std::vector<SymbolTag>{NodeTag(SyntaxTreeLintRule::kAnyTag),
+                             LeafTag(SyntaxTreeLintRule::kAnyTag)});
+  auto nonlocal = std::make_unique<TagRecorder>(
+      std::vector<SymbolTag>{NodeTag(SyntaxTreeLintRule::kAnyTag),
+                             LeafTag(SyntaxTreeLintRule::kAnyTag)});
+  const TagRecorder &local_rule = *local;
+  const TagRecorder &nonlocal_rule = *nonlocal;
+
+  SyntaxTreeLinter linter;
+  linter.AddRule(std::move(local), /*local=*/true);
+  linter.AddRule(std::move(nonlocal));
+  linter.SetKnownSubtrees(
+      [known](const Symbol &subtree) { return &subtree == known; });
+  linter.Lint(*root);
+
+  EXPECT_EQ(local_rule.handled,
+            (std::vector<SymbolTag>{NodeTag(1), LeafTag(2), NodeTag(5),
+                                    LeafTag(4)}));
+  EXPECT_EQ(nonlocal_rule.handled,
+            (std::vector<SymbolTag>{NodeTag(1), NodeTag(3), LeafTag(4),
+                                    LeafTag(2), NodeTag(5), LeafTag(4)}));
+}
+
 }  // namespace
 }  // namespace verible
@@ -14,16 +14,23 @@
 
 #include "common/analysis/syntax_tree_search.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
+
 #include "common/analysis/matcher/bound_symbol_manager.h"
 #include "common/analysis/matcher/matcher.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/syntax_tree_index.h"
 #include "common/text/tree_context_visitor.h"
+#include "common/util/logging.h"
 
 namespace verible {
 namespace {
@@ -97,4 +104,54 @@ std::vector<TreeSearchMatch> SearchSyntaxTree(
                           [](const SyntaxTreeContext &) { return true; });
 }
 
+std::vector<TreeSearchMatch> SearchSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher,
+    const std::function<bool(const SyntaxTreeContext &)> &context_predicate) {
+  const auto subtree = index.SubtreeRange(root);
+  if (!subtree) return SearchSyntaxTree(root, matcher, context_predicate);
+
+  // Candidates are sorted by position, and the subtree is a range of them.
+  const absl::Span<const uint32_t> candidates = index.Find(tag);
+  std::vector<TreeSearchMatch> matches;
+  for (auto it = std::lower_bound(candidates.begin(), candidates.end(),
+                                  subtree->first);
+       it != candidates.end() && *it < subtree->second; ++it) {
+    const Symbol &symbol = index.SymbolAt(*it);
+    BoundSymbolManager manager;
+    if (!matcher.Matches(symbol, &manager)) continue;
+    SyntaxTreeContext context = index.Context(*it, subtree->first);
+    if (!context_predicate(context)) continue;
+    matches.push_back(TreeSearchMatch{&symbol, std::move(context)});
+  }
+  return matches;
+}
+
+std::vector<TreeSearchMatch> SearchSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher) {
+  return SearchSyntaxTree(index, root, tag, matcher,
+                          [](const SyntaxTreeContext &) { return true; });
+}
+
+std::vector<IndexedTreeSearchMatch> SearchIndexedSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher) {
+  const auto subtree = index.SubtreeRange(root);
+  CHECK(subtree.has_value()) << "root is not in the index";
+
+  const absl::Span<const uint32_t> candidates = index.Find(tag);
+  std::vector<IndexedTreeSearchMatch> matches;
+  for (auto it = std::lower_bound(candidates.begin(), candidates.end(),
+                                  subtree->first);
+       it != candidates.end() && *it < subtree->second; ++it) {
+    const Symbol &symbol = index.SymbolAt(*it);
+    BoundSymbolManager manager;
+    if (!matcher.Matches(symbol, &manager)) continue;
+    matches.push_back(IndexedTreeSearchMatch{
+        &symbol, *it, index.Ancestors(*it, subtree->first)});
+  }
+  return matches;
+}
+
 }  // namespace verible
@@ -15,12 +15,14 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_SEARCH_H_
 #define VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_SEARCH_H_
 
+#include <cstdint>
 #include <functional>
 #include <vector>
 
 #include "common/analysis/matcher/matcher.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/syntax_tree_index.h"
 
 namespace verible {
 
@@ -36,10 +38,22 @@ struct TreeSearchMatch {
   const Symbol *match;
   // A copy of the stack of syntax tree nodes that are ancestors of
   // the match node/leaf.  Note: This is needed because syntax tree nodes
-  // don't have upward links to parents.
+  // don't have upward links to parents.  See IndexedTreeSearchMatch for
+  // matches that look up their ancestors in a SyntaxTreeIndex instead.
   SyntaxTreeContext context;
 };
 
+// Like TreeSearchMatch, for a match found in a SyntaxTreeIndex, whose
+// ancestors are followed through the index's parent links when queried.
+struct IndexedTreeSearchMatch {
+  // Note: The index and its syntax tree must outlive this match.
+  const Symbol *match;
+  // The position of the match in the index.
+  uint32_t position;
+  // The ancestors of the match, up to the searched root.
+  SyntaxTreeAncestors context;
+};
+
 // SearchSyntaxTree collects nodes that match the specified criteria into a
 // vector.  This is useful for analyses that need to look at a collection
 // of related nodes together, rather than as each one is encountered.
@@ -51,6 +65,27 @@ std::vector<TreeSearchMatch> SearchSyntaxTree(
 std::vector<TreeSearchMatch> SearchSyntaxTree(
     const Symbol &root, const verible::matcher::Matcher &matcher);
 
+// Like SearchSyntaxTree() above, but only checks the symbols with 'tag' in
+// 'index' that are in the subtree at 'root', instead of walking all of it.
+// This finds the same matches, if 'matcher' only matches symbols with 'tag'.
+// The context of a match is only built if it matches.
+// Falls back to walking 'root' if it is not in 'index'.
+std::vector<TreeSearchMatch> SearchSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher,
+    const std::function<bool(const SyntaxTreeContext &)> &context_predicate);
+
+// This overload treats the missing context_predicate as always returning true.
+std::vector<TreeSearchMatch> SearchSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher);
+
+// Like the above, but returns matches that refer to their ancestors in
+// 'index' instead of holding a copy of them.  'root' must be in 'index'.
+std::vector<IndexedTreeSearchMatch> SearchIndexedSyntaxTree(
+    const SyntaxTreeIndex &index, const Symbol &root, SymbolTag tag,
+    const verible::matcher::Matcher &matcher);
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_SEARCH_H_
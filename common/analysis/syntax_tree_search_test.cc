@@ -14,12 +14,15 @@
 
 #include "common/analysis/syntax_tree_search.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
 #include "common/analysis/matcher/matcher_builders.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/syntax_tree_index.h"
 #include "common/text/tree_builder_test_util.h"
 #include "common/text/tree_utils.h"
 #include "gtest/gtest.h"
@@ -133,5 +136,82 @@ TEST(SearchSyntaxTreeTest, RootOnlyNodeMatchTruePredicate) {
   EXPECT_EQ(&SymbolCastToNode(*matches.front().match), tree.get());
 }
 
+// Tests that searching the index finds the same matches and contexts as
+// walking the tree, in the whole tree and in subtrees.
+TEST(SearchSyntaxTreeTest, IndexedSearchMatchesTreeWalk) {
+  auto tree = Node(TNode(1, TNode(3), TNode(1, XLeaf(3))),
+                   Node(XLeaf(4), TNode(3, TNode(1))));
+  const SyntaxTreeIndex index(tree.get());
+  auto matcher_builder = NodeMatcher<1>();
+  auto matcher = matcher_builder();
+  const Symbol *const roots[] = {tree.get(), DescendPath(*tree, {0}),
+                                 DescendPath(*tree, {1})};
+  for (const Symbol *root : roots) {
+    const auto walked = SearchSyntaxTree(*root, matcher);
+    const auto indexed = SearchSyntaxTree(index, *root, NodeTag(1), matcher);
+    ASSERT_EQ(indexed.size(), walked.size());
+    for (size_t i = 0; i < walked.size(); ++i) {
+      EXPECT_EQ(indexed[i].match, walked[i].match);
+      EXPECT_TRUE(std::equal(indexed[i].context.begin(),
+                             indexed[i].context.end(),
+                             walked[i].context.begin(),
+                             walked[i].context.end()));
+    }
+  }
+}
+
+// Tests that the predicate filters indexed matches by their context.
+TEST(SearchSyntaxTreeTest, IndexedSearchPredicate) {
+  auto tree = Node(TNode(1, TNode(3)), TNode(3));
+  const SyntaxTreeIndex index(tree.get());
+  auto matcher_builder = NodeMatcher<3>();
+  auto matcher = matcher_builder();
+  auto matches =
+      SearchSyntaxTree(index, *tree, NodeTag(3), matcher,
+                       [](const SyntaxTreeContext &context) {
+                         return context.IsInside(1);
+                       });
+  ASSERT_EQ(matches.size(), 1);
+  EXPECT_EQ(matches.front().match, DescendPath(*tree, {0, 0}));
+}
+
+// Tests that a root that is not in the index is searched by walking it.
+TEST(SearchSyntaxTreeTest, IndexedSearchOutsideOfIndex) {
+  auto tree = Node(XLeaf(2), XLeaf(2));
+  auto other_tree = Node(XLeaf(2));
+  const SyntaxTreeIndex index(tree.get());
+  auto matcher_builder = LeafMatcher<2>();
+  auto matcher = matcher_builder();
+  auto matches = SearchSyntaxTree(index, *other_tree, LeafTag(2), matcher);
+  ASSERT_EQ(matches.size(), 1);
+  EXPECT_EQ(matches.front().match, DescendPath(*other_tree, {0}));
+}
+
+// Tests that indexed matches refer to the same ancestors as the tree walk.
+TEST(SearchSyntaxTreeTest, SearchIndexedSyntaxTree) {
+  auto tree = Node(TNode(1, TNode(3), TNode(1, XLeaf(3))),
+                   Node(XLeaf(4), TNode(3, TNode(1))));
+  const SyntaxTreeIndex index(tree.get());
+  auto matcher_builder = NodeMatcher<1>();
+  auto matcher = matcher_builder();
+  const Symbol *const roots[] = {tree.get(), DescendPath(*tree, {0}),
+                                 DescendPath(*tree, {1})};
+  for (const Symbol *root : roots) {
+    const auto walked = SearchSyntaxTree(*root, matcher);
+    const auto indexed =
+        SearchIndexedSyntaxTree(index, *root, NodeTag(1), matcher);
+    ASSERT_EQ(indexed.size(), walked.size());
+    for (size_t i = 0; i < walked.size(); ++i) {
+      EXPECT_EQ(indexed[i].match, walked[i].match);
+      EXPECT_EQ(&index.SymbolAt(indexed[i].position), walked[i].match);
+      const SyntaxTreeContext context = indexed[i].context.ToContext();
+      EXPECT_TRUE(std::equal(context.begin(), context.end(),
+                             walked[i].context.begin(),
+                             walked[i].context.end()));
+      EXPECT_EQ(indexed[i].context.IsInside(1), walked[i].context.IsInside(1));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace verible
@@ -14,13 +14,16 @@
 
 #include "common/analysis/text_structure_linter.h"
 
+#include <cstddef>
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/text_structure_lint_rule.h"
 #include "common/text/text_structure.h"
 #include "common/util/logging.h"
+#include "common/util/trace.h"
 
 namespace verible {
 
@@ -28,9 +31,20 @@ void TextStructureLinter::Lint(const TextStructureView &text_structure,
                                absl::string_view filename) {
   VLOG(1) << "TextStructureLinter analyzing text with " << rules_.size()
           << " rules.";
-  for (const auto &rule : rules_) {
-    ABSL_DIE_IF_NULL(rule)->Lint(text_structure, filename);
+  LintRuleProfiles profiles(rules_.size());
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    TextStructureLintRule *rule = ABSL_DIE_IF_NULL(rules_[i].get());
+    const auto lint = [&] {
+      ProfileLintRuleCall(profiles[i],
+                          [&] { rule->Lint(text_structure, filename); });
+    };
+    if (trace::Enabled()) {
+      TraceLintRule(*rule, lint);
+    } else {
+      lint();
+    }
   }
+  profiles.Record(rules_);
 }
 
 std::vector<LintRuleStatus> TextStructureLinter::ReportStatus() const {
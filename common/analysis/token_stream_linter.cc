@@ -14,23 +14,54 @@
 
 #include "common/analysis/token_stream_linter.h"
 
+#include <cstddef>
 #include <vector>
 
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/token_stream_lint_rule.h"
+#include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
 #include "common/util/logging.h"
+#include "common/util/trace.h"
 
 namespace verible {
 
 void TokenStreamLinter::Lint(const TokenSequence &tokens) {
   VLOG(1) << "TokenStreamLinter analyzing tokens with " << rules_.size()
           << " rules.";
-  for (const auto &token : tokens) {
-    for (const auto &rule : rules_) {
-      ABSL_DIE_IF_NULL(rule)->HandleToken(token);
-    }
+  if (!trace::Enabled()) {
+    Begin();
+    for (const auto &token : tokens) HandleToken(token);
+    End();
+    return;
   }
+  // Rules are independent, so running them one at a time gives each its
+  // own trace span without changing the results.
+  LintRuleProfiles profiles(rules_.size());
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    TokenStreamLintRule *rule = ABSL_DIE_IF_NULL(rules_[i].get());
+    TraceLintRule(*rule, [&] {
+      for (const auto &token : tokens) {
+        ProfileLintRuleCall(profiles[i], [&] { rule->HandleToken(token); });
+      }
+    });
+  }
+  profiles.Record(rules_);
+}
+
+void TokenStreamLinter::Begin() { profiles_ = LintRuleProfiles(rules_.size()); }
+
+void TokenStreamLinter::HandleToken(const TokenInfo &token) {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    TokenStreamLintRule *rule = ABSL_DIE_IF_NULL(rules_[i].get());
+    ProfileLintRuleCall(profiles_[i], [&] { rule->HandleToken(token); });
+  }
+}
+
+void TokenStreamLinter::End() {
+  profiles_.Record(rules_);
+  profiles_ = LintRuleProfiles(0);
 }
 
 std::vector<LintRuleStatus> TokenStreamLinter::ReportStatus() const {
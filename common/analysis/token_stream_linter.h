@@ -23,8 +23,10 @@
 #include <utility>
 #include <vector>
 
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/token_stream_lint_rule.h"
+#include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
 
 namespace verible {
@@ -34,6 +36,12 @@ class TokenStreamLinter {
   // Analyzes a sequence of tokens.
   void Lint(const TokenSequence &tokens);
 
+  // Incremental form of Lint(), for driving this linter from another scan:
+  // call Begin(), then HandleToken() on each token in order, then End().
+  void Begin();
+  void HandleToken(const TokenInfo &token);
+  void End();
+
   // Transfers ownership of rule into this Linter
   void AddRule(std::unique_ptr<TokenStreamLintRule> rule) {
     rules_.emplace_back(std::move(rule));
@@ -46,6 +54,9 @@ class TokenStreamLinter {
   // List of rules that the linter is using. Rules are responsible for tracking
   // their own internal state.
   std::vector<std::unique_ptr<TokenStreamLintRule>> rules_;
+
+  // Profiles of the rules between Begin() and End().
+  LintRuleProfiles profiles_{0};
 };
 
 }  // namespace verible
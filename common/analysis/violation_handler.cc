@@ -14,12 +14,14 @@
 
 #include "common/analysis/violation_handler.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <ostream>
-#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -27,9 +29,12 @@
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/strings/diff.h"
+#include "common/strings/line_column_map.h"
+#include "common/text/token_info.h"
 #include "common/util/file_util.h"
 #include "common/util/logging.h"
 #include "common/util/user_interaction.h"
+#include "nlohmann/json.hpp"
 
 namespace verible {
 namespace {
@@ -58,34 +63,311 @@ void PrintFixAlternatives(std::ostream& stream, absl::string_view text,
   }
 }
 
+// Returns the line:column range of each of the "violations" in "base".
+// All their start and end offsets are resolved in one forward pass over the
+// lines instead of a search per offset.
+std::vector<LineColumnRange> ResolveViolationRanges(
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, const LineColumnMap& line_column_map) {
+  std::vector<int> offsets;
+  offsets.reserve(2 * violations.size());
+  for (const LintViolationWithStatus& violation : violations) {
+    offsets.push_back(violation.violation->token.left(base));
+    offsets.push_back(violation.violation->token.right(base));
+  }
+  const std::vector<LineColumn> positions =
+      line_column_map.GetLineColAtOffsets(base, offsets);
+
+  std::vector<LineColumnRange> ranges;
+  ranges.reserve(violations.size());
+  for (size_t i = 0; i < positions.size(); i += 2) {
+    ranges.push_back({positions[i], positions[i + 1]});
+  }
+  return ranges;
+}
+
+// Writes "contents" to "stream" in one call, without flushing per line.
+void WriteBuffer(std::ostream* stream, absl::string_view contents) {
+  if (contents.empty()) return;
+  stream->write(contents.data(), contents.size());
+  stream->flush();
+}
+
+constexpr absl::string_view kPreviousFixConflict =
+    "The fix conflicts with previously applied fixes, rejecting.\n";
+
+// Writes "fixed_content" of "source_path" as a unified diff of
+// "source_content" to "patch_stream", or over the file if that is null.
+void CommitFixedContent(std::ostream* patch_stream,
+                        absl::string_view source_content,
+                        absl::string_view source_path,
+                        absl::string_view fixed_content) {
+  if (patch_stream) {
+    verible::LineDiffs diff(source_content, fixed_content);
+    verible::LineDiffsToUnifiedDiff(*patch_stream, diff, 1, source_path);
+  } else {
+    const absl::Status write_status =
+        verible::file::SetContents(source_path, fixed_content);
+    if (!write_status.ok()) {
+      LOG(ERROR) << "Failed to write fixes to file '" << source_path
+                 << "': " << write_status.ToString();
+    }
+  }
+}
+
+// An edit of the first autofix of the violation at index "owner".
+struct OwnedEdit {
+  const ReplacementEdit* edit;
+  size_t owner;
+
+  const char* begin() const { return edit->fragment.data(); }
+  const char* end() const { return begin() + edit->fragment.size(); }
+};
+
+// Returns the edits of the first autofix of each of "violations", in order of
+// position, leaving out those of fixes that overlap with the fix of an
+// earlier violation.  Those violations are marked in "rejected".
+// Overlaps are the same as in AutoFix::AddEdits(): insertions at the same
+// position don't conflict, and are kept in order of their violations.
+std::vector<const ReplacementEdit*> SelectNonConflictingEdits(
+    const std::vector<LintViolationWithStatus>& violations,
+    std::vector<bool>* rejected) {
+  std::vector<OwnedEdit> edits;
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const std::vector<AutoFix>& autofixes = violations[i].violation->autofixes;
+    if (autofixes.empty()) continue;
+    for (const ReplacementEdit& edit : autofixes.front().Edits()) {
+      edits.push_back({&edit, i});
+    }
+  }
+  std::sort(edits.begin(), edits.end(),
+            [](const OwnedEdit& a, const OwnedEdit& b) {
+              return std::make_tuple(a.begin(), a.end(), a.owner) <
+                     std::make_tuple(b.begin(), b.end(), b.owner);
+            });
+
+  // Sweep once over the sorted edits, keeping the ones that are still open
+  // at the current position, and record the earlier violations that each
+  // violation's fix overlaps with.
+  std::vector<std::vector<size_t>> earlier_conflicts(violations.size());
+  std::vector<const OwnedEdit*> open_edits;
+  for (const OwnedEdit& edit : edits) {
+    open_edits.erase(
+        std::remove_if(open_edits.begin(), open_edits.end(),
+                       [&edit](const OwnedEdit* open) {
+                         return open->end() <= edit.begin();
+                       }),
+        open_edits.end());
+    for (const OwnedEdit* open : open_edits) {
+      if (edit.end() <= open->begin() || open->owner == edit.owner) continue;
+      const auto owners = std::minmax(open->owner, edit.owner);
+      earlier_conflicts[owners.second].push_back(owners.first);
+    }
+    open_edits.push_back(&edit);
+  }
+
+  // A fix is accepted unless it overlaps with an accepted earlier one.
+  rejected->assign(violations.size(), false);
+  for (size_t i = 0; i < violations.size(); ++i) {
+    for (const size_t earlier : earlier_conflicts[i]) {
+      if (!(*rejected)[earlier]) {
+        (*rejected)[i] = true;
+        break;
+      }
+    }
+  }
+
+  std::vector<const ReplacementEdit*> accepted;
+  accepted.reserve(edits.size());
+  for (const OwnedEdit& edit : edits) {
+    if (!(*rejected)[edit.owner]) accepted.push_back(edit.edit);
+  }
+  return accepted;
+}
+
+// Returns "base" with the non-overlapping "edits", sorted by position,
+// applied in one pass.
+std::string ApplySortedEdits(absl::string_view base,
+                             const std::vector<const ReplacementEdit*>& edits) {
+  size_t size = base.size();
+  for (const ReplacementEdit* edit : edits) {
+    size = size - edit->fragment.size() + edit->replacement.size();
+  }
+  std::string result;
+  result.reserve(size);
+  const char* prev_end = base.data();
+  for (const ReplacementEdit* edit : edits) {
+    CHECK_LE(base.data(), edit->fragment.data());
+    CHECK_GE(base.data() + base.size(),
+             edit->fragment.data() + edit->fragment.size());
+    result.append(prev_end, edit->fragment.data() - prev_end);
+    result.append(edit->replacement.data(), edit->replacement.size());
+    prev_end = edit->fragment.data() + edit->fragment.size();
+  }
+  result.append(prev_end, base.data() + base.size() - prev_end);
+  return result;
+}
+
+// Serializes "json" compactly; invalid UTF-8 in messages is replaced instead
+// of throwing.
+std::string CompactJson(const nlohmann::json& json) {
+  return json.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
 }  // namespace
 
 void ViolationPrinter::HandleViolations(
-    const std::set<LintViolationWithStatus>& violations, absl::string_view base,
-    absl::string_view path) {
-  verible::LintStatusFormatter formatter(base);
-  for (auto violation : violations) {
-    formatter.FormatViolation(stream_, *violation.violation, base, path,
-                              violation.status->url,
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
+  const verible::LintStatusFormatter formatter(line_map);
+  const std::vector<LineColumnRange> ranges =
+      ResolveViolationRanges(violations, base, line_map);
+  std::ostringstream buffer;
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const LintViolationWithStatus& violation = violations[i];
+    formatter.FormatViolation(&buffer, *violation.violation, ranges[i], base,
+                              path, violation.status->url,
                               violation.status->lint_rule_name);
-    (*stream_) << std::endl;
+    buffer << '\n';
+  }
+  WriteBuffer(stream_, buffer.str());
+}
+
+void ViolationJsonLinesPrinter::HandleViolations(
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
+  const verible::LintStatusFormatter formatter(line_map);
+  const std::vector<LineColumnRange> ranges =
+      ResolveViolationRanges(violations, base, line_map);
+  std::string buffer;
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const LintViolation& violation = *violations[i].violation;
+    const LintRuleStatus& status = *violations[i].status;
+    const nlohmann::json line = {
+        {"path", path},
+        {"line", ranges[i].start.line + 1},
+        {"column", ranges[i].start.column + 1},
+        {"end_line", ranges[i].end.line + 1},
+        {"end_column", ranges[i].end.column + 1},
+        {"rule", status.lint_rule_name},
+        {"message", formatter.FormatWithRelatedTokens(
+                        violation.related_tokens, violation.reason, path,
+                        base)},
+        {"url", status.url},
+        {"autofix", !violation.autofixes.empty()},
+    };
+    absl::StrAppend(&buffer, CompactJson(line), "\n");
   }
+  WriteBuffer(stream_, buffer);
+}
+
+void ViolationSarifPrinter::HandleViolations(
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
+  const verible::LintStatusFormatter formatter(line_map);
+  const std::vector<LineColumnRange> ranges =
+      ResolveViolationRanges(violations, base, line_map);
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const LintViolation& violation = *violations[i].violation;
+    const LintRuleStatus& status = *violations[i].status;
+    const auto inserted =
+        rule_index_.emplace(status.lint_rule_name, rules_.size());
+    if (inserted.second) {
+      rules_.emplace_back(std::string(status.lint_rule_name),
+                          std::string(status.url));
+    }
+    const nlohmann::json result = {
+        {"ruleId", status.lint_rule_name},
+        {"ruleIndex", inserted.first->second},
+        {"level", "warning"},
+        {"message",
+         {{"text", formatter.FormatWithRelatedTokens(violation.related_tokens,
+                                                     violation.reason, path,
+                                                     base)}}},
+        {"locations",
+         {{{"physicalLocation",
+            {{"artifactLocation", {{"uri", path}}},
+             {"region",
+              {{"startLine", ranges[i].start.line + 1},
+               {"startColumn", ranges[i].start.column + 1},
+               {"endLine", ranges[i].end.line + 1},
+               {"endColumn", ranges[i].end.column + 1}}}}}}}},
+    };
+    absl::StrAppend(&results_, results_.empty() ? "" : ",",
+                    CompactJson(result));
+  }
+}
+
+void ViolationSarifPrinter::Finish() {
+  nlohmann::json rules = nlohmann::json::array();
+  for (const auto& rule : rules_) {
+    rules.push_back({{"id", rule.first}, {"helpUri", rule.second}});
+  }
+  const nlohmann::json tool = {
+      {"driver", {{"name", tool_name_}, {"rules", std::move(rules)}}}};
+  // The results are already serialized, so the log is put together around
+  // them instead of building one large JSON value.
+  const std::string log = absl::StrCat(
+      "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",",
+      "\"version\":\"2.1.0\",\"runs\":[{\"tool\":", CompactJson(tool),
+      ",\"results\":[", results_, "]}]}\n");
+  WriteBuffer(stream_, log);
+  rules_.clear();
+  rule_index_.clear();
+  results_.clear();
 }
 
 void ViolationWaiverPrinter::HandleViolations(
-    const std::set<LintViolationWithStatus>& violations, absl::string_view base,
-    absl::string_view path) {
-  verible::LintStatusFormatter formatter(base);
-  for (auto violation : violations) {
-    formatter.FormatViolation(message_stream_, *violation.violation, base, path,
-                              violation.status->url,
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
+  const verible::LintStatusFormatter formatter(line_map);
+  const std::vector<LineColumnRange> ranges =
+      ResolveViolationRanges(violations, base, line_map);
+  std::ostringstream messages;
+  std::ostringstream waivers;
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const LintViolationWithStatus& violation = violations[i];
+    formatter.FormatViolation(&messages, *violation.violation, ranges[i], base,
+                              path, violation.status->url,
                               violation.status->lint_rule_name);
-    (*message_stream_) << std::endl;
+    messages << '\n';
 
-    formatter.FormatViolationWaiver(waiver_stream_, *violation.violation, base,
-                                    path, violation.status->lint_rule_name);
-    (*waiver_stream_) << std::endl;
+    formatter.FormatViolationWaiver(&waivers, ranges[i], path,
+                                    violation.status->lint_rule_name);
+    waivers << '\n';
   }
+  WriteBuffer(message_stream_, messages.str());
+  WriteBuffer(waiver_stream_, waivers.str());
+}
+
+void ViolationBatchFixer::HandleViolations(
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
+  std::vector<bool> rejected;
+  const std::vector<const ReplacementEdit*> edits =
+      SelectNonConflictingEdits(violations, &rejected);
+
+  const verible::LintStatusFormatter formatter(line_map);
+  const std::vector<LineColumnRange> ranges =
+      ResolveViolationRanges(violations, base, line_map);
+  std::ostringstream buffer;
+  for (size_t i = 0; i < violations.size(); ++i) {
+    const LintViolationWithStatus& violation = violations[i];
+    formatter.FormatViolation(&buffer, *violation.violation, ranges[i], base,
+                              path, violation.status->url,
+                              violation.status->lint_rule_name);
+    buffer << '\n';
+    if (rejected[i]) buffer << kPreviousFixConflict;
+  }
+  WriteBuffer(message_stream_, buffer.str());
+
+  if (edits.empty()) return;
+  CommitFixedContent(patch_stream_, base, path, ApplySortedEdits(base, edits));
 }
 
 void ViolationFixer::CommitFixes(absl::string_view source_content,
@@ -94,27 +376,16 @@ void ViolationFixer::CommitFixes(absl::string_view source_content,
   if (fix.Edits().empty()) {
     return;
   }
-  std::string fixed_content = fix.Apply(source_content);
-
-  if (patch_stream_) {
-    verible::LineDiffs diff(source_content, fixed_content);
-    verible::LineDiffsToUnifiedDiff(*patch_stream_, diff, 1, source_path);
-  } else {
-    const absl::Status write_status =
-        verible::file::SetContents(source_path, fixed_content);
-    if (!write_status.ok()) {
-      LOG(ERROR) << "Failed to write fixes to file '" << source_path
-                 << "': " << write_status.ToString();
-      return;
-    }
-  }
+  CommitFixedContent(patch_stream_, source_content, source_path,
+                     fix.Apply(source_content));
 }
 
 void ViolationFixer::HandleViolations(
-    const std::set<LintViolationWithStatus>& violations, absl::string_view base,
-    absl::string_view path) {
+    const std::vector<LintViolationWithStatus>& violations,
+    absl::string_view base, absl::string_view path,
+    const LineColumnMap& line_map) {
   verible::AutoFix fix;
-  verible::LintStatusFormatter formatter(base);
+  const verible::LintStatusFormatter formatter(line_map);
   for (auto violation : violations) {
     HandleViolation(*violation.violation, base, path, violation.status->url,
                     violation.status->lint_rule_name, formatter, &fix);
@@ -136,10 +407,6 @@ void ViolationFixer::HandleViolation(
     return;
   }
 
-  static absl::string_view previous_fix_conflict =
-      "The fix conflicts with "
-      "previously applied fixes, rejecting.\n";
-
   Answer answer;
   for (bool first_round = true; /**/; first_round = false) {
     if (ultimate_answer_.choice != AnswerChoice::kUnknown) {
@@ -170,7 +437,7 @@ void ViolationFixer::HandleViolation(
           continue;  // ask again.
         }
         if (!fix->AddEdits(violation.autofixes[answer.alternative].Edits())) {
-          *message_stream_ << previous_fix_conflict;
+          *message_stream_ << kPreviousFixConflict;
         }
         break;
       case AnswerChoice::kRejectAll:
@@ -19,10 +19,13 @@
 #include <functional>
 #include <map>
 #include <ostream>
-#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
+#include "common/strings/line_column_map.h"
 
 namespace verible {
 
@@ -37,25 +40,91 @@ class ViolationHandler {
 
   // This method is called with a list of sorted violations found in file
   // located at `path`. It can be called multiple times with statuses generated
-  // from different files. `base` contains source code from the file.
+  // from different files. `base` contains source code from the file, and
+  // `line_map` its lines, as already known to the caller (typically from the
+  // file's TextStructureView).
   virtual void HandleViolations(
-      const std::set<verible::LintViolationWithStatus>& violations,
-      absl::string_view base, absl::string_view path) = 0;
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) = 0;
+
+  // Same as above, for callers that have no line map of `base` at hand.
+  void HandleViolations(
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path) {
+    HandleViolations(violations, base, path, LineColumnMap(base));
+  }
+
+  // This method is called once after the violations of all files have been
+  // handled, for handlers that only write their output at the end.
+  virtual void Finish() {}
 };
 
 // ViolationHandler that prints all violations in a form of user-friendly
-// messages.
+// messages. The messages of a file are formatted into one buffer that is
+// written to the stream at once.
 class ViolationPrinter : public ViolationHandler {
  public:
   explicit ViolationPrinter(std::ostream* stream) : stream_(stream) {}
 
+  using ViolationHandler::HandleViolations;
   void HandleViolations(
-      const std::set<verible::LintViolationWithStatus>& violations,
-      absl::string_view base, absl::string_view path) final;
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
 
  protected:
   std::ostream* const stream_;
-  verible::LintStatusFormatter* formatter_ = nullptr;
+};
+
+// ViolationHandler that prints each violation as one compact JSON object on a
+// line of its own (JSON Lines), for consumption by other tools:
+//   {"path":"a.sv","line":3,"column":5,"end_line":3,"end_column":9,
+//    "rule":"rule-name","message":"...","url":"...","autofix":false}
+// Lines and columns are 1-based, the end column is exclusive.
+class ViolationJsonLinesPrinter : public ViolationHandler {
+ public:
+  explicit ViolationJsonLinesPrinter(std::ostream* stream) : stream_(stream) {}
+
+  using ViolationHandler::HandleViolations;
+  void HandleViolations(
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
+
+ private:
+  std::ostream* const stream_;
+};
+
+// ViolationHandler that collects the violations of all files and prints them
+// as one SARIF 2.1.0 log [1] on Finish(), as read by code scanning services.
+// The log names "tool_name" as its driver and lists each violated rule once.
+//
+// [1]: https://docs.oasis-open.org/sarif/sarif/v2.1.0/sarif-v2.1.0.html
+class ViolationSarifPrinter : public ViolationHandler {
+ public:
+  ViolationSarifPrinter(std::ostream* stream, absl::string_view tool_name)
+      : stream_(stream), tool_name_(tool_name) {}
+
+  using ViolationHandler::HandleViolations;
+  void HandleViolations(
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
+
+  void Finish() final;
+
+ private:
+  std::ostream* const stream_;
+  const std::string tool_name_;
+
+  // Rule name and url of each violated rule, in order of first violation.
+  std::vector<std::pair<std::string, std::string>> rules_;
+  std::map<std::string, size_t, std::less<>> rule_index_;
+
+  // Serialized SARIF result objects, each preceded by a comma except the
+  // first.
+  std::string results_;
 };
 
 // ViolationHandler that prints all violations in a format required by
@@ -66,14 +135,40 @@ class ViolationWaiverPrinter : public ViolationHandler {
                                   std::ostream* waiver_stream_)
       : message_stream_(message_stream_), waiver_stream_(waiver_stream_) {}
 
+  using ViolationHandler::HandleViolations;
   void HandleViolations(
-      const std::set<verible::LintViolationWithStatus>& violations,
-      absl::string_view base, absl::string_view path) final;
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
 
  protected:
   std::ostream* const message_stream_;
   std::ostream* const waiver_stream_;
-  verible::LintStatusFormatter* formatter_ = nullptr;
+};
+
+// ViolationHandler that prints all violations and applies the first autofix
+// of each of them, without asking.  The fix of a violation that overlaps with
+// the fix of an earlier violation in the same file is rejected.
+//
+// The edits of a file are sorted and checked for overlaps once, and the fixed
+// content is produced in a single pass over the original.  Like
+// ViolationFixer, it writes a unified diff to patch_stream if that is not
+// null, and modifies the source file otherwise.  It keeps no state between
+// files, so separate instances can fix separate files in parallel.
+class ViolationBatchFixer : public ViolationHandler {
+ public:
+  ViolationBatchFixer(std::ostream* message_stream, std::ostream* patch_stream)
+      : message_stream_(message_stream), patch_stream_(patch_stream) {}
+
+  using ViolationHandler::HandleViolations;
+  void HandleViolations(
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
+
+ private:
+  std::ostream* const message_stream_;
+  std::ostream* const patch_stream_;
 };
 
 // ViolationHandler that prints all violations and gives an option to fix those
@@ -129,9 +224,11 @@ class ViolationFixer : public verible::ViolationHandler {
       : ViolationFixer(message_stream, patch_stream, InteractiveAnswerChooser,
                        true) {}
 
+  using ViolationHandler::HandleViolations;
   void HandleViolations(
-      const std::set<verible::LintViolationWithStatus>& violations,
-      absl::string_view base, absl::string_view path) final;
+      const std::vector<verible::LintViolationWithStatus>& violations,
+      absl::string_view base, absl::string_view path,
+      const LineColumnMap& line_map) final;
 
  private:
   ViolationFixer(std::ostream* message_stream, std::ostream* patch_stream,
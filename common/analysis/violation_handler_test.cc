@@ -0,0 +1,253 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/analysis/violation_handler.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/text/token_info.h"
+#include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
+
+namespace verible {
+namespace {
+
+constexpr absl::string_view kText = "module m;\n  wire Bad_Name;\nendmodule\n";
+
+// Statuses of two rules violated in kText, the second one twice.
+std::vector<LintRuleStatus> ExampleStatuses() {
+  const TokenInfo module_token(1, kText.substr(0, 6));
+  const TokenInfo name_token(1, kText.substr(17, 8));
+  const TokenInfo end_token(1, kText.substr(27, 9));
+  return {
+      LintRuleStatus({LintViolation(name_token, "Bad \"name\".")},
+                     "name-style", "https://example.com/name"),
+      LintRuleStatus({LintViolation(module_token, "first"),
+                      LintViolation(end_token, "last")},
+                     "rule-b", "https://example.com/b"),
+  };
+}
+
+TEST(ViolationPrinterTest, PrintsViolationsOfFileInOrder) {
+  const std::vector<LintRuleStatus> statuses = ExampleStatuses();
+  std::ostringstream stream;
+  ViolationPrinter printer(&stream);
+  printer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_EQ(stream.str(),
+            "m.sv:1:1-6: first https://example.com/b [rule-b]\n"
+            "m.sv:2:8-15: Bad \"name\". https://example.com/name [name-style]\n"
+            "m.sv:3:1-9: last https://example.com/b [rule-b]\n");
+}
+
+TEST(ViolationPrinterTest, NoViolationsPrintNothing) {
+  std::ostringstream stream;
+  ViolationPrinter printer(&stream);
+  printer.HandleViolations({}, kText, "m.sv");
+  EXPECT_TRUE(stream.str().empty());
+}
+
+TEST(ViolationWaiverPrinterTest, PrintsMessagesAndWaivers) {
+  const std::vector<LintRuleStatus> statuses = ExampleStatuses();
+  std::ostringstream messages;
+  std::ostringstream waivers;
+  ViolationWaiverPrinter printer(&messages, &waivers);
+  printer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_EQ(messages.str(),
+            "m.sv:1:1-6: first https://example.com/b [rule-b]\n"
+            "m.sv:2:8-15: Bad \"name\". https://example.com/name [name-style]\n"
+            "m.sv:3:1-9: last https://example.com/b [rule-b]\n");
+  EXPECT_EQ(waivers.str(),
+            "waive --rule=rule-b --line=1 --location=\"m.sv\"\n"
+            "waive --rule=name-style --line=2 --location=\"m.sv\"\n"
+            "waive --rule=rule-b --line=3 --location=\"m.sv\"\n");
+}
+
+TEST(ViolationJsonLinesPrinterTest, PrintsOneObjectPerLine) {
+  const std::vector<LintRuleStatus> statuses = ExampleStatuses();
+  std::ostringstream stream;
+  ViolationJsonLinesPrinter printer(&stream);
+  printer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_EQ(stream.str(),
+            R"({"autofix":false,"column":1,"end_column":7,"end_line":1,)"
+            R"("line":1,"message":"first","path":"m.sv","rule":"rule-b",)"
+            R"("url":"https://example.com/b"})"
+            "\n"
+            R"({"autofix":false,"column":8,"end_column":16,"end_line":2,)"
+            R"("line":2,"message":"Bad \"name\".","path":"m.sv",)"
+            R"("rule":"name-style","url":"https://example.com/name"})"
+            "\n"
+            R"({"autofix":false,"column":1,"end_column":10,"end_line":3,)"
+            R"("line":3,"message":"last","path":"m.sv","rule":"rule-b",)"
+            R"("url":"https://example.com/b"})"
+            "\n");
+}
+
+TEST(ViolationSarifPrinterTest, PrintsOneLogForAllFiles) {
+  const std::vector<LintRuleStatus> statuses = ExampleStatuses();
+  std::ostringstream stream;
+  ViolationSarifPrinter printer(&stream, "linter");
+  printer.HandleViolations(SortedLintViolations(statuses), kText, "a.sv");
+  printer.HandleViolations(SortedLintViolations(statuses), kText, "b.sv");
+  EXPECT_TRUE(stream.str().empty());
+  printer.Finish();
+
+  const nlohmann::json log = nlohmann::json::parse(stream.str());
+  EXPECT_EQ(log["version"], "2.1.0");
+  ASSERT_EQ(log["runs"].size(), 1);
+  const nlohmann::json& run = log["runs"][0];
+  EXPECT_EQ(run["tool"]["driver"]["name"], "linter");
+  const nlohmann::json& rules = run["tool"]["driver"]["rules"];
+  ASSERT_EQ(rules.size(), 2);
+  EXPECT_EQ(rules[0]["id"], "rule-b");
+  EXPECT_EQ(rules[0]["helpUri"], "https://example.com/b");
+  EXPECT_EQ(rules[1]["id"], "name-style");
+
+  const nlohmann::json& results = run["results"];
+  ASSERT_EQ(results.size(), 6);
+  const nlohmann::json& name_result = results[4];
+  EXPECT_EQ(name_result["ruleId"], "name-style");
+  EXPECT_EQ(name_result["ruleIndex"], 1);
+  EXPECT_EQ(name_result["message"]["text"], "Bad \"name\".");
+  const nlohmann::json& location = name_result["locations"][0];
+  EXPECT_EQ(location["physicalLocation"]["artifactLocation"]["uri"], "b.sv");
+  const nlohmann::json& region = location["physicalLocation"]["region"];
+  EXPECT_EQ(region["startLine"], 2);
+  EXPECT_EQ(region["startColumn"], 8);
+  EXPECT_EQ(region["endLine"], 2);
+  EXPECT_EQ(region["endColumn"], 16);
+}
+
+TEST(ViolationSarifPrinterTest, EmptyLog) {
+  std::ostringstream stream;
+  ViolationSarifPrinter printer(&stream, "linter");
+  printer.Finish();
+  const nlohmann::json log = nlohmann::json::parse(stream.str());
+  EXPECT_TRUE(log["runs"][0]["results"].empty());
+  EXPECT_TRUE(log["runs"][0]["tool"]["driver"]["rules"].empty());
+}
+
+// Statuses of violations in kText whose autofixes partly overlap.
+std::vector<LintRuleStatus> FixableStatuses() {
+  const absl::string_view module_text = kText.substr(0, 6);
+  const absl::string_view wire_text = kText.substr(12, 4);
+  const absl::string_view name_text = kText.substr(17, 8);
+  const absl::string_view name_suffix = kText.substr(21, 4);
+  const absl::string_view end_text = kText.substr(27, 9);
+  return {
+      LintRuleStatus(
+          {LintViolation(TokenInfo(1, name_text), "Bad name.",
+                         {AutoFix("Rename", {name_text, "good_name"})}),
+           // Overlaps with the fix above, and is rejected.
+           LintViolation(TokenInfo(1, name_suffix), "Bad suffix.",
+                         {AutoFix("Rename suffix", {name_suffix, "Nom"})})},
+          "name-style", "https://example.com/name"),
+      LintRuleStatus(
+          {LintViolation(TokenInfo(1, module_text), "Unlabeled.",
+                         {AutoFix("Label", {{module_text.substr(0, 0),
+                                             "// labeled\n"},
+                                            {end_text, "endmodule : m"}}),
+                          AutoFix("Not chosen", {module_text, "MODULE"})}),
+           LintViolation(TokenInfo(1, wire_text), "Nettype.",
+                         {AutoFix("Nettype", {kText.substr(kText.size(), 0),
+                                              "`default_nettype wire\n"})})},
+          "rule-b", "https://example.com/b"),
+  };
+}
+
+TEST(ViolationBatchFixerTest, AppliesNonConflictingFirstFixes) {
+  const std::vector<LintRuleStatus> statuses = FixableStatuses();
+  std::ostringstream messages;
+  std::ostringstream patch;
+  ViolationBatchFixer fixer(&messages, &patch);
+  fixer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_EQ(messages.str(),
+            "m.sv:1:1-6: Unlabeled. https://example.com/b [rule-b]\n"
+            "m.sv:2:3-6: Nettype. https://example.com/b [rule-b]\n"
+            "m.sv:2:8-15: Bad name. https://example.com/name [name-style]\n"
+            "m.sv:2:12-15: Bad suffix. https://example.com/name [name-style]\n"
+            "The fix conflicts with previously applied fixes, rejecting.\n");
+  EXPECT_EQ(patch.str(),
+            "--- a/m.sv\n"
+            "+++ b/m.sv\n"
+            "@@ -1,3 +1,5 @@\n"
+            "+// labeled\n"
+            " module m;\n"
+            "-  wire Bad_Name;\n"
+            "-endmodule\n"
+            "+  wire good_name;\n"
+            "+endmodule : m\n"
+            "+`default_nettype wire\n");
+}
+
+TEST(ViolationBatchFixerTest, InsertionsAtSamePositionInViolationOrder) {
+  const absl::string_view start = kText.substr(0, 0);
+  const std::vector<LintRuleStatus> statuses = {
+      LintRuleStatus({LintViolation(TokenInfo(1, kText.substr(0, 6)), "first",
+                                    {AutoFix("First", {start, "// 1\n"})}),
+                      LintViolation(TokenInfo(1, kText.substr(7, 1)), "second",
+                                    {AutoFix("Second", {start, "// 2\n"})})},
+                     "rule-b", "https://example.com/b"),
+  };
+  std::ostringstream messages;
+  std::ostringstream patch;
+  ViolationBatchFixer fixer(&messages, &patch);
+  fixer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_EQ(patch.str(),
+            "--- a/m.sv\n"
+            "+++ b/m.sv\n"
+            "@@ -1 +1,3 @@\n"
+            "+// 1\n"
+            "+// 2\n"
+            " module m;\n");
+}
+
+TEST(ViolationBatchFixerTest, SameAsApplyingAllFixes) {
+  const std::vector<LintRuleStatus> statuses = FixableStatuses();
+  const std::vector<LintViolationWithStatus> violations =
+      SortedLintViolations(statuses);
+  std::ostringstream batch_messages;
+  std::ostringstream batch_patch;
+  ViolationBatchFixer batch_fixer(&batch_messages, &batch_patch);
+  batch_fixer.HandleViolations(violations, kText, "m.sv");
+
+  std::ostringstream messages;
+  std::ostringstream patch;
+  ViolationFixer fixer(&messages, &patch,
+                       [](const LintViolation&, absl::string_view) {
+                         return ViolationFixer::Answer{
+                             ViolationFixer::AnswerChoice::kApplyAll, 0};
+                       });
+  fixer.HandleViolations(violations, kText, "m.sv");
+  EXPECT_EQ(batch_messages.str(), messages.str());
+  EXPECT_EQ(batch_patch.str(), patch.str());
+}
+
+TEST(ViolationBatchFixerTest, NoFixesWriteNoPatch) {
+  const std::vector<LintRuleStatus> statuses = ExampleStatuses();
+  std::ostringstream messages;
+  std::ostringstream patch;
+  ViolationBatchFixer fixer(&messages, &patch);
+  fixer.HandleViolations(SortedLintViolations(statuses), kText, "m.sv");
+  EXPECT_FALSE(messages.str().empty());
+  EXPECT_TRUE(patch.str().empty());
+}
+
+}  // namespace
+}  // namespace verible
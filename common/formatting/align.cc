@@ -21,13 +21,13 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
-#include <map>
 #include <numeric>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -103,6 +103,10 @@ static int EffectiveLeftBorderWidth(const FormatTokenRange& tokens) {
 
 using ColumnsTreePath = SyntaxTreePath;
 
+// Maps the syntax tree path of every column to its path in the columns tree.
+using SyntaxToColumnsPathMap =
+    absl::flat_hash_map<SyntaxTreePath, ColumnsTreePath>;
+
 struct AlignmentCell {
   // Slice of format tokens in this cell (may be empty range).
   FormatTokenRange tokens;
@@ -385,9 +389,7 @@ class ColumnSchemaAggregator {
     for (auto& node : VectorTreePreOrderTraversal(columns_)) {
       if (node.Parent()) {
         // Index the column
-        auto it = syntax_to_columns_map_.emplace_hint(
-            syntax_to_columns_map_.end(), node.Value().path, ColumnsTreePath{});
-        verible::Path(node, it->second);
+        verible::Path(node, syntax_to_columns_map_[node.Value().path]);
       }
       if (!is_leaf(node)) {
         // Sort subcolumns. This puts negative paths (leading non-tree token
@@ -405,7 +407,7 @@ class ColumnSchemaAggregator {
     }
   }
 
-  const std::map<SyntaxTreePath, ColumnsTreePath>& SyntaxToColumnsMap() const {
+  const SyntaxToColumnsPathMap& SyntaxToColumnsMap() const {
     return syntax_to_columns_map_;
   }
 
@@ -449,7 +451,7 @@ class ColumnSchemaAggregator {
   // computed per cell.
   VectorTree<AggregateColumnData> columns_;
   // 1:1 map between syntax tree's path and columns tree's path
-  std::map<SyntaxTreePath, ColumnsTreePath> syntax_to_columns_map_;
+  SyntaxToColumnsPathMap syntax_to_columns_map_;
 };
 
 // CellLabelGetterFunc which creates a label with column's path relative to
@@ -539,7 +541,7 @@ struct AlignmentRowData {
 
 static void FillAlignmentRow(
     const AlignmentRowData& row_data,
-    const std::map<SyntaxTreePath, ColumnsTreePath>& columns_map,
+    const SyntaxToColumnsPathMap& columns_map,
     AlignmentRow* row) {
   const auto& sparse_columns(row_data.sparse_columns);
   FormatTokenRange remaining_tokens_range(row_data.ftoken_range);
@@ -616,49 +618,76 @@ static AlignedFormattingColumnSchema ComputeColumnWidths(
           matrix.front(),
           [](const AlignmentRow&) { return AlignedColumnConfiguration{}; });
 
+  // All rows have the same shape as the columns tree, so columns are numbered
+  // by their preorder position, and their properties looked up only once.
+  std::vector<const AlignmentColumnProperties*> properties;
+  for (const auto& node : VectorTreePreOrderTraversal(column_properties)) {
+    properties.push_back(&node.Value());
+  }
+  const size_t num_columns = properties.size();
+
+  // The cell before the first delimiter column, if any.
+  size_t before_delimiter = num_columns;
+  for (size_t column = 0; column + 1 < num_columns; ++column) {
+    if (properties[column + 1]->contains_delimiter) {
+      before_delimiter = column;
+      break;
+    }
+  }
+
+  // Flatten the cell widths of all rows into one row-major matrix, so that
+  // the column widths are reduced from contiguous arrays below.
+  std::vector<int> widths;
+  std::vector<int> left_borders;
+  widths.reserve(matrix.size() * num_columns);
+  left_borders.reserve(matrix.size() * num_columns);
   // Check which cell before delimiter is the longest
   // If this cell is in the last row, the sizes of column with delimiter
   // must be set to 0
   int longest_cell_before_delimiter = 0;
   bool align_to_last_row = false;
   for (const AlignmentRow& row : matrix) {
-    auto column_prop_iter =
-        VectorTreePreOrderTraversal(column_properties).begin();
-    const auto column_prop_end =
-        VectorTreePreOrderTraversal(column_properties).end();
+    size_t column = 0;
     for (const auto& node : VectorTreePreOrderTraversal(row)) {
-      const auto next_prop = std::next(column_prop_iter, 1);
-      if (next_prop != column_prop_end &&
-          next_prop->Value().contains_delimiter) {
-        if (longest_cell_before_delimiter < node.Value().TotalWidth()) {
-          longest_cell_before_delimiter = node.Value().TotalWidth();
-          if (&row == &matrix.back()) align_to_last_row = true;
-        }
-        break;
+      const AlignmentCell& cell = node.Value();
+      if (column == before_delimiter &&
+          longest_cell_before_delimiter < cell.TotalWidth()) {
+        longest_cell_before_delimiter = cell.TotalWidth();
+        if (&row == &matrix.back()) align_to_last_row = true;
       }
-      ++column_prop_iter;
+      widths.push_back(cell.compact_width);
+      left_borders.push_back(cell.left_border_width);
+      ++column;
     }
+    CHECK_EQ(column, num_columns);
   }
 
-  for (const AlignmentRow& row : matrix) {
-    auto column_iter = VectorTreePreOrderTraversal(column_configs).begin();
-    auto column_prop_iter =
-        VectorTreePreOrderTraversal(column_properties).begin();
+  std::vector<int> max_widths(num_columns, 0);
+  std::vector<int> max_left_borders(num_columns, 0);
+  for (size_t row = 0; row < matrix.size(); ++row) {
+    const int* row_widths = &widths[row * num_columns];
+    const int* row_left_borders = &left_borders[row * num_columns];
+    for (size_t column = 0; column < num_columns; ++column) {
+      max_widths[column] = std::max(max_widths[column], row_widths[column]);
+      max_left_borders[column] =
+          std::max(max_left_borders[column], row_left_borders[column]);
+    }
+  }
 
-    for (const auto& node : VectorTreePreOrderTraversal(row)) {
-      if (column_prop_iter->Value().contains_delimiter && align_to_last_row) {
-        column_iter->Value().width = 0;
-        column_iter->Value().left_border = 0;
-      } else {
-        column_iter->Value().UpdateFromCell(node.Value());
-        if (column_prop_iter->Value().left_border_override !=
-            verible::AlignmentColumnProperties::kNoBorderOverride) {
-          column_iter->Value().left_border =
-              column_prop_iter->Value().left_border_override;
-        }
+  auto column_iter = VectorTreePreOrderTraversal(column_configs).begin();
+  for (size_t column = 0; column < num_columns; ++column, ++column_iter) {
+    const AlignmentColumnProperties& column_props = *properties[column];
+    AlignedColumnConfiguration& config = column_iter->Value();
+    if (column_props.contains_delimiter && align_to_last_row) {
+      config.width = 0;
+      config.left_border = 0;
+    } else {
+      config.width = max_widths[column];
+      config.left_border = max_left_borders[column];
+      if (column_props.left_border_override !=
+          verible::AlignmentColumnProperties::kNoBorderOverride) {
+        config.left_border = column_props.left_border_override;
       }
-      ++column_iter;
-      ++column_prop_iter;
     }
   }
 
@@ -1272,11 +1301,49 @@ void AlignablePartitionGroup::Align(int column_limit) const {
   }
 }
 
+std::vector<std::vector<TokenPartitionIterator>> SplitAlignableRows(
+    const std::vector<TokenPartitionIterator>& rows, size_t max_rows) {
+  std::vector<std::vector<TokenPartitionIterator>> groups;
+  if (rows.empty()) return groups;
+  if (max_rows == 0 || rows.size() <= max_rows) {
+    groups.push_back(rows);
+    return groups;
+  }
+  // Spread the rows evenly, rather than leaving a small remainder group that
+  // would align differently from the rest.
+  const size_t num_groups = (rows.size() + max_rows - 1) / max_rows;
+  const size_t min_size = rows.size() / num_groups;
+  const size_t num_larger_groups = rows.size() % num_groups;
+  auto begin = rows.begin();
+  for (size_t i = 0; i < num_groups; ++i) {
+    const auto end = begin + min_size + (i < num_larger_groups ? 1 : 0);
+    groups.emplace_back(begin, end);
+    begin = end;
+  }
+  return groups;
+}
+
+static AlignmentGroupSummary SummarizeAlignmentGroup(
+    const AlignablePartitionGroup& group) {
+  const TokenPartitionRange partition_range(group.Range());
+  const auto tokens_begin =
+      partition_range.front().Value().TokensRange().begin();
+  const auto tokens_end = partition_range.back().Value().TokensRange().end();
+  AlignmentGroupSummary summary{
+      group.NumRows(),
+      static_cast<size_t>(std::distance(tokens_begin, tokens_end)), {}};
+  if (tokens_begin != tokens_end) {
+    summary.first_token_text = tokens_begin->token->text();
+  }
+  return summary;
+}
+
 void TabularAlignTokens(
     int column_limit, absl::string_view full_text,
     const ByteOffsetSet& disabled_byte_ranges,
     const ExtractAlignmentGroupsFunction& extract_alignment_groups,
-    TokenPartitionTree* partition_ptr) {
+    TokenPartitionTree* partition_ptr,
+    std::vector<AlignmentGroupSummary>* group_summaries) {
   VLOG(1) << __FUNCTION__;
   // Each subpartition is presumed to correspond to a list element or
   // possibly some other ignored element like comments.
@@ -1310,6 +1377,10 @@ void TabularAlignTokens(
       // TODO(b/159824483): attempt to detect and re-use pre-existing alignment
     }
 
+    if (group_summaries != nullptr) {
+      group_summaries->push_back(SummarizeAlignmentGroup(alignment_group));
+    }
+
     // Calculate alignment and possibly apply it depending on alignment policy.
     alignment_group.Align(column_limit);
   }
@@ -268,6 +268,9 @@ class AlignablePartitionGroup {
 
   bool IsEmpty() const { return alignable_rows_.empty(); }
 
+  // Returns the number of partitions that are aligned as rows.
+  size_t NumRows() const { return alignable_rows_.size(); }
+
   TokenPartitionRange Range() const {
     return {alignable_rows_.front(), alignable_rows_.back() + 1};
   }
@@ -296,6 +299,23 @@ class AlignablePartitionGroup {
   const AlignmentPolicy alignment_policy_;
 };
 
+// Splits 'rows' into consecutive groups of at most 'max_rows' rows each, of
+// about the same size, so that the cost of aligning one group stays bounded.
+// A 'max_rows' of 0 means no limit.
+std::vector<std::vector<TokenPartitionIterator>> SplitAlignableRows(
+    const std::vector<TokenPartitionIterator> &rows, size_t max_rows);
+
+// Describes an alignment group handled by TabularAlignTokens(), for
+// diagnostics.
+struct AlignmentGroupSummary {
+  // Number of partitions aligned as rows.
+  size_t rows;
+  // Number of format tokens spanned by the group.
+  size_t tokens;
+  // Text of the first token of the group, in the original text.
+  absl::string_view first_token_text;
+};
+
 // This is the interface used to sub-divide a range of token partitions into
 // a sequence of sub-ranges for the purposes of formatting aligned groups.
 using ExtractAlignmentGroupsFunction =
@@ -537,11 +557,15 @@ void FormatUsingOriginalSpacing(TokenPartitionRange partition_range);
 //    aaa     bb [11]  [22]
 //    ccc[33] dd [444]
 //
+//
+// If 'group_summaries' is not null, every alignment group that is aligned is
+// described there.
 void TabularAlignTokens(
     int column_limit, absl::string_view full_text,
     const ByteOffsetSet &disabled_byte_ranges,
     const ExtractAlignmentGroupsFunction &extract_alignment_groups,
-    TokenPartitionTree *partition_ptr);
+    TokenPartitionTree *partition_ptr,
+    std::vector<AlignmentGroupSummary> *group_summaries = nullptr);
 
 }  // namespace verible
 
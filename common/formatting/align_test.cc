@@ -1631,5 +1631,35 @@ TEST_F(FormatUsingOriginalSpacingTest, OneNLOneSpaceTwoNLTwoSpaces) {
                   .build(pre_format_tokens_));
 }
 
+static std::vector<size_t> SplitAlignableRowsSizes(
+    const std::vector<TokenPartitionIterator>& rows, size_t max_rows) {
+  std::vector<size_t> sizes;
+  std::vector<TokenPartitionIterator> joined;
+  for (const auto& group : SplitAlignableRows(rows, max_rows)) {
+    EXPECT_LE(group.size(), max_rows == 0 ? rows.size() : max_rows);
+    sizes.push_back(group.size());
+    joined.insert(joined.end(), group.begin(), group.end());
+  }
+  EXPECT_EQ(joined, rows);
+  return sizes;
+}
+
+TEST(SplitAlignableRowsTest, Various) {
+  TokenPartitionTree tree{UnwrappedLine()};
+  for (int i = 0; i < 7; ++i) tree.Children().emplace_back(UnwrappedLine());
+  std::vector<TokenPartitionIterator> rows;
+  for (auto it = tree.Children().begin(); it != tree.Children().end(); ++it) {
+    rows.push_back(it);
+  }
+  using Sizes = std::vector<size_t>;
+  EXPECT_EQ(SplitAlignableRowsSizes({}, 2), Sizes());
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 0), Sizes({7}));
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 7), Sizes({7}));
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 6), Sizes({4, 3}));
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 3), Sizes({3, 2, 2}));
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 2), Sizes({2, 2, 2, 1}));
+  EXPECT_EQ(SplitAlignableRowsSizes(rows, 1), Sizes(7, 1));
+}
+
 }  // namespace
 }  // namespace verible
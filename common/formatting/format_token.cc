@@ -161,34 +161,19 @@ absl::string_view FormattedToken::OriginalLeadingSpaces() const {
 }
 
 std::ostream &FormattedToken::FormattedText(std::ostream &stream) const {
-  switch (before.action) {
-    case SpacingDecision::kPreserve: {
-      if (before.preserved_space_start != nullptr) {
-        // Calculate string_view range of pre-existing spaces, and print that.
-        stream << OriginalLeadingSpaces();
-      } else {
-        // During testing, we are less interested in Preserve mode due to lack
-        // of "original spacing", so fall-back to safe behavior.
-        stream << Spacer(before.spaces);
-      }
-      break;
-    }
-    case SpacingDecision::kWrap:
-      // Never print spaces before a newline.
-      stream << '\n';
-      ABSL_FALLTHROUGH_INTENDED;
-    case SpacingDecision::kAlign:
-    case SpacingDecision::kAppend:
-      stream << Spacer(before.spaces);
-      break;
-  }
-  return stream << token->text();
+  StreamTextSink sink(&stream);
+  AppendFormattedText(&sink);
+  return stream;
 }
 
 std::ostream &operator<<(std::ostream &stream, const FormattedToken &token) {
   return token.FormattedText(stream);
 }
 
+void StreamTextSink::Append(absl::string_view text) { *stream_ << text; }
+
+void StreamTextSink::Append(const Spacer &spacer) { *stream_ << spacer; }
+
 absl::string_view PreFormatToken::OriginalLeadingSpaces() const {
   return OriginalLeadingSpacesRange(before.preserved_space_start,
                                     token->text().begin());
@@ -25,6 +25,7 @@
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/token_info.h"
 #include "common/util/container_iterator_range.h"
+#include "common/util/spacer.h"
 
 namespace verible {
 
@@ -223,6 +224,35 @@ struct FormattedToken {
   // Print out formatted result after formatting decision optimization.
   std::ostream &FormattedText(std::ostream &) const;
 
+  // Passes the same text as FormattedText() to "sink", in pieces, as
+  // sink->Append(absl::string_view) and sink->Append(Spacer) calls.
+  // This lets callers measure or write the text without a stream.
+  template <class Sink>
+  void AppendFormattedText(Sink *sink) const {
+    switch (before.action) {
+      case SpacingDecision::kPreserve: {
+        if (before.preserved_space_start != nullptr) {
+          // Calculate string_view range of pre-existing spaces, and print that.
+          sink->Append(OriginalLeadingSpaces());
+        } else {
+          // During testing, we are less interested in Preserve mode due to
+          // lack of "original spacing", so fall-back to safe behavior.
+          sink->Append(Spacer(before.spaces));
+        }
+        break;
+      }
+      case SpacingDecision::kWrap:
+        // Never print spaces before a newline.
+        sink->Append(Spacer(1, '\n'));
+        [[fallthrough]];
+      case SpacingDecision::kAlign:
+      case SpacingDecision::kAppend:
+        sink->Append(Spacer(before.spaces));
+        break;
+    }
+    sink->Append(token->text());
+  }
+
   // The token this PreFormatToken holds. TokenInfo must outlive this object.
   const TokenInfo *token = nullptr;
 
@@ -232,6 +262,18 @@ struct FormattedToken {
 
 std::ostream &operator<<(std::ostream &stream, const FormattedToken &token);
 
+// Sink for AppendFormattedText() functions that writes to a stream.
+class StreamTextSink {
+ public:
+  explicit StreamTextSink(std::ostream *stream) : stream_(stream) {}
+
+  void Append(absl::string_view text);
+  void Append(const Spacer &spacer);
+
+ private:
+  std::ostream *const stream_;
+};
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_FORMATTING_FORMAT_TOKEN_H_
@@ -18,11 +18,13 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "common/formatting/unwrapped_line_test_utils.h"
 #include "common/strings/position.h"
 #include "common/text/token_info.h"
 #include "common/util/range.h"
+#include "common/util/spacer.h"
 #include "gtest/gtest.h"
 
 namespace verible {
@@ -522,6 +524,34 @@ TEST(FormattedTokenTest, FormattedText) {
   }
 }
 
+// Sink for AppendFormattedText() that records each piece.
+struct PieceRecorder {
+  void Append(absl::string_view text) { pieces.emplace_back(text); }
+  void Append(const Spacer &spacer) {
+    pieces.emplace_back(spacer.repeat, spacer.repeated_char);
+  }
+
+  std::vector<std::string> pieces;
+};
+
+TEST(FormattedTokenTest, AppendFormattedText) {
+  TokenInfo token(0, "roobar");
+  PreFormatToken ptoken(&token);
+  for (const SpacingDecision action :
+       {SpacingDecision::kPreserve, SpacingDecision::kAppend,
+        SpacingDecision::kWrap, SpacingDecision::kAlign}) {
+    FormattedToken ftoken(ptoken);
+    ftoken.before.action = action;
+    ftoken.before.spaces = 2;
+    std::ostringstream stream;
+    stream << ftoken;
+    PieceRecorder recorder;
+    ftoken.AppendFormattedText(&recorder);
+    EXPECT_EQ(absl::StrJoin(recorder.pieces, ""), stream.str()) << action;
+    EXPECT_EQ(recorder.pieces.back(), "roobar");
+  }
+}
+
 TEST(FormattedTokenTest, OriginalLeadingSpaces) {
   const absl::string_view text("abcdefgh");
   const TokenInfo tok1(1, text.substr(1, 3)), tok2(2, text.substr(5, 2));
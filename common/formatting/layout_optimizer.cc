@@ -25,11 +25,17 @@
 #include <iomanip>
 #include <ios>
 #include <limits>
+#include <iterator>
+#include <memory>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/layout_optimizer_internal.h"
 #include "common/formatting/token_partition_tree.h"
@@ -42,42 +48,50 @@
 
 namespace verible {
 
-void OptimizeTokenPartitionTree(const BasicFormatStyle& style,
-                                TokenPartitionTree* node) {
+LayoutFunctionCache::LayoutFunctionCache()
+    : entries_(std::make_unique<Entries>()) {}
+
+LayoutFunctionCache::~LayoutFunctionCache() = default;
+
+bool OptimizeTokenPartitionTree(const BasicFormatStyle& style,
+                                TokenPartitionTree* node,
+                                LayoutFunctionCache* cache,
+                                const LayoutOptimizerBudget& budget) {
   CHECK_NOTNULL(node);
   VLOG(4) << __FUNCTION__ << ", before:\n"
           << verible::TokenPartitionTreePrinter(*node);
 
-  const auto optimizer = TokenPartitionsLayoutOptimizer(style);
+  LayoutFunctionCache local_cache;
+  const auto optimizer = TokenPartitionsLayoutOptimizer(
+      style, cache != nullptr ? cache : &local_cache, budget);
   const auto indentation = node->Value().IndentationSpaces();
-  optimizer.Optimize(indentation, node);
+  const bool within_budget = optimizer.Optimize(indentation, node);
 
   VLOG(4) << __FUNCTION__ << ", after:\n"
           << verible::TokenPartitionTreePrinter(*node);
+  return within_budget;
 }
 
 namespace {
 
-// Adopts sublayouts of 'source' into 'destination' if 'source' and
-// 'destination' types are equal and 'source' doesn't have extra indentation.
-// Otherwise adopts whole 'source'.
-void AdoptLayoutAndFlattenIfSameType(const LayoutTree& source,
-                                     LayoutTree* destination) {
-  CHECK_NOTNULL(destination);
+// Appends sublayouts of 'source' to 'sublayouts' of a layout of type
+// 'destination_type' if 'source' has the same type and doesn't have extra
+// indentation. Otherwise appends whole 'source'.
+// Sublayouts are shared, not copied.
+void AdoptLayoutAndFlattenIfSameType(
+    const SharedLayoutTree& source, LayoutType destination_type,
+    SharedLayoutTree::subnodes_type* sublayouts) {
+  CHECK_NOTNULL(sublayouts);
   const auto& src_item = source.Value();
-  const auto& dst_item = destination->Value();
-  if (!verible::is_leaf(source) && src_item.Type() == dst_item.Type() &&
+  if (!verible::is_leaf(source) && src_item.Type() == destination_type &&
       src_item.IndentationSpaces() == 0) {
     const auto& first_subitem = source.Children().front().Value();
     CHECK(src_item.MustWrap() == first_subitem.MustWrap());
     CHECK(src_item.SpacesBefore() == first_subitem.SpacesBefore());
-    destination->Children().reserve(destination->Children().size() +
-                                    source.Children().size());
-    for (const auto& sublayout : source.Children()) {
-      AdoptSubtree(*destination, sublayout);
-    }
+    sublayouts->insert(sublayouts->end(), source.Children().begin(),
+                       source.Children().end());
   } else {
-    AdoptSubtree(*destination, source);
+    sublayouts->push_back(source);
   }
 }
 
@@ -113,6 +127,77 @@ int AlreadyFormattedPartitionLength(const TokenPartitionTree& partition) {
 // Largest possible column value, used as infinity.
 constexpr int kInfinity = std::numeric_limits<int>::max();
 
+// Appends to 'shape' everything about 'node' and its subtree that the layout
+// function of 'node' depends on: partition policies, indentations, and sizes,
+// spacings and break penalties of tokens. Token positions are relative to the
+// first token of 'node', so that identical declarations in different places
+// have equal shapes.
+void AppendPartitionShape(const TokenPartitionTree& node,
+                          std::vector<int>* shape) {
+  const auto& uwline = node.Value();
+  const auto tokens = uwline.TokensRange();
+  shape->push_back(static_cast<int>(uwline.PartitionPolicy()));
+  shape->push_back(uwline.IndentationSpaces());
+  shape->push_back(tokens.size());
+  shape->push_back(node.Children().size());
+  // Tokens of inner partitions are only used by their leaves, except for
+  // (misplaced) kInline partitions, which are laid out as lines.
+  if (is_leaf(node) ||
+      uwline.PartitionPolicy() == PartitionPolicyEnum::kInline) {
+    for (const auto& token : tokens) {
+      const auto line_break_pos = token.Text().find('\n');
+      shape->push_back(token.Length());
+      shape->push_back(line_break_pos == absl::string_view::npos
+                           ? -1
+                           : static_cast<int>(line_break_pos));
+      shape->push_back(token.before.spaces_required);
+      shape->push_back(token.before.break_penalty);
+      shape->push_back(static_cast<int>(token.before.break_decision));
+    }
+  }
+  for (const auto& child : node.Children()) {
+    shape->push_back(
+        std::distance(tokens.begin(), child.Value().TokensRange().begin()));
+    AppendPartitionShape(child, shape);
+  }
+}
+
+// Returns copy of 'layout' with token ranges moved by 'offset' tokens.
+// 'rebased' maps already rebased layout nodes to their copies, so that
+// shared sublayouts stay shared.
+SharedLayoutTree RebaseLayout(
+    const SharedLayoutTree& layout, std::ptrdiff_t offset,
+    absl::flat_hash_map<const LayoutItem*, SharedLayoutTree>* rebased) {
+  if (const auto found = rebased->find(&layout.Value());
+      found != rebased->end()) {
+    return found->second;
+  }
+  LayoutItem item = layout.Value();
+  if (item.Type() == LayoutType::kLine) item.ShiftTokensRange(offset);
+  SharedLayoutTree::subnodes_type sublayouts;
+  sublayouts.reserve(layout.Children().size());
+  for (const auto& sublayout : layout.Children()) {
+    sublayouts.push_back(RebaseLayout(sublayout, offset, rebased));
+  }
+  auto result = SharedLayoutTree(item, std::move(sublayouts));
+  rebased->emplace(&layout.Value(), result);
+  return result;
+}
+
+// Returns copy of 'lf' with token ranges of all layouts moved by 'offset'
+// tokens.
+LayoutFunction RebaseLayoutFunction(const LayoutFunction& lf,
+                                    std::ptrdiff_t offset) {
+  absl::flat_hash_map<const LayoutItem*, SharedLayoutTree> rebased;
+  LayoutFunction result;
+  for (const auto& segment : lf) {
+    auto new_segment = segment;
+    new_segment.layout = RebaseLayout(segment.layout, offset, &rebased);
+    result.push_back(std::move(new_segment));
+  }
+  return result;
+}
+
 }  // namespace
 
 std::ostream& operator<<(std::ostream& stream, LayoutType type) {
@@ -212,7 +297,7 @@ LayoutFunction LayoutFunctionFactory::WrappedLine(
 }
 
 LayoutFunction LayoutFunctionFactory::Line(const UnwrappedLine& uwline) const {
-  auto layout = LayoutTree(LayoutItem(uwline));
+  auto layout = SharedLayoutTree(LayoutItem(uwline));
   const auto span = layout.Value().Length();
 
   if (span < style_.column_limit) {
@@ -250,9 +335,9 @@ LayoutFunction LayoutFunctionFactory::Indent(const LayoutFunction& lf,
         style_.over_column_limit_penalty * std::max(columns_over_limit, 0);
     const int new_gradient = segment->gradient;
 
-    auto new_layout = segment->layout;
-    new_layout.Value().SetIndentationSpaces(
-        new_layout.Value().IndentationSpaces() + indent);
+    LayoutItem new_item = segment->layout.Value();
+    new_item.SetIndentationSpaces(new_item.IndentationSpaces() + indent);
+    auto new_layout = segment->layout.WithValue(new_item);
 
     const int new_span = indent + segment->span;
 
@@ -306,12 +391,15 @@ LayoutFunction LayoutFunctionFactory::Juxtaposition(
 
     const auto& layout_l = segment_l->layout;
     const auto& layout_r = segment_r->layout;
-    auto new_layout = LayoutTree(LayoutItem(LayoutType::kJuxtaposition,
-                                            layout_l.Value().SpacesBefore(),
-                                            layout_l.Value().MustWrap()));
-
-    AdoptLayoutAndFlattenIfSameType(layout_l, &new_layout);
-    AdoptLayoutAndFlattenIfSameType(layout_r, &new_layout);
+    SharedLayoutTree::subnodes_type sublayouts;
+    AdoptLayoutAndFlattenIfSameType(layout_l, LayoutType::kJuxtaposition,
+                                    &sublayouts);
+    AdoptLayoutAndFlattenIfSameType(layout_r, LayoutType::kJuxtaposition,
+                                    &sublayouts);
+    auto new_layout = SharedLayoutTree(
+        LayoutItem(LayoutType::kJuxtaposition, layout_l.Value().SpacesBefore(),
+                   layout_l.Value().MustWrap()),
+        std::move(sublayouts));
 
     const int new_span =
         segment_l->span + segment_r->span + layout_r.Value().SpacesBefore();
@@ -376,18 +464,21 @@ LayoutFunction LayoutFunctionFactory::Stack(
     // any further layout combinations.
     const int span = segments->back()->span;
 
-    auto new_segment = LayoutFunctionSegment{
-        current_column,
-        LayoutTree(
-            LayoutItem(LayoutType::kStack, spaces_before, break_decision)),
-        span, line_breaks_penalty, 0};
-
+    float intercept = line_breaks_penalty;
+    int gradient = 0;
+    SharedLayoutTree::subnodes_type sublayouts;
     for (const auto& segment_it : *segments) {
-      new_segment.intercept += segment_it->CostAt(current_column);
-      new_segment.gradient += segment_it->gradient;
-      AdoptLayoutAndFlattenIfSameType(segment_it->layout, &new_segment.layout);
+      intercept += segment_it->CostAt(current_column);
+      gradient += segment_it->gradient;
+      AdoptLayoutAndFlattenIfSameType(segment_it->layout, LayoutType::kStack,
+                                      &sublayouts);
     }
-    result.push_back(std::move(new_segment));
+    result.push_back(LayoutFunctionSegment{
+        current_column,
+        SharedLayoutTree(
+            LayoutItem(LayoutType::kStack, spaces_before, break_decision),
+            std::move(sublayouts)),
+        span, intercept, gradient});
 
     {
       // Find next column.
@@ -416,6 +507,17 @@ LayoutFunction LayoutFunctionFactory::Choice(
   LayoutFunction::const_iterator last_min_cost_segment =
       segments->front().Container().end();
 
+  // Cost lines of the segments that can still be minimal up to the next knot,
+  // in the order of 'segments'. The loops below run over these arrays instead
+  // of the segments, which also hold the layouts, so that they can be
+  // vectorized.
+  const size_t size = segments->size();
+  absl::FixedArray<float> intercepts(size);
+  absl::FixedArray<int> gradients(size);
+  absl::FixedArray<int> starts(size);
+  absl::FixedArray<size_t> inputs(size);  // Indices into 'segments'.
+  absl::FixedArray<float> costs(size);
+
   int current_column = 0;
   // Iterate (in increasing order) over starting columns (knots) of all
   // segments of every LayoutFunction.
@@ -423,41 +525,67 @@ LayoutFunction LayoutFunctionFactory::Choice(
     // Starting column of the next closest segment.
     int next_knot = kInfinity;
 
-    for (auto& segment_it : *segments) {
+    for (size_t i = 0; i < size; ++i) {
+      auto& segment_it = (*segments)[i];
       segment_it.MoveToKnotAtOrToTheLeftOf(current_column);
 
       const int column =
           (segment_it + 1).IsEnd() ? kInfinity : segment_it[1].column;
       if (column < next_knot) next_knot = column;
+
+      intercepts[i] = segment_it->intercept;
+      gradients[i] = segment_it->gradient;
+      starts[i] = segment_it->column;
+      inputs[i] = i;
     }
+    size_t candidates = size;
 
     do {
-      const LayoutFunction::const_iterator min_cost_segment = *std::min_element(
-          segments->begin(), segments->end(),
-          [current_column](const auto& a, const auto& b) {
-            if (a->CostAt(current_column) != b->CostAt(current_column)) {
-              return (a->CostAt(current_column) < b->CostAt(current_column));
-            }
-            // Sort by gradient when cost is the same. Favor earlier
-            // element when both gradients are equal.
-            return (a->gradient < b->gradient);
-          });
+      // Same as LayoutFunctionSegment::CostAt().
+      for (size_t i = 0; i < candidates; ++i) {
+        costs[i] = intercepts[i] + gradients[i] * (current_column - starts[i]);
+      }
+
+      // Sort by gradient when cost is the same. Favor earlier element when
+      // both gradients are equal.
+      size_t min = 0;
+      for (size_t i = 1; i < candidates; ++i) {
+        if (costs[i] < costs[min] ||
+            (costs[i] == costs[min] && gradients[i] < gradients[min])) {
+          min = i;
+        }
+      }
 
+      const LayoutFunction::const_iterator min_cost_segment =
+          (*segments)[inputs[min]];
       if (min_cost_segment != last_min_cost_segment) {
         result.push_back(LayoutFunctionSegment{
             current_column, min_cost_segment->layout, min_cost_segment->span,
-            min_cost_segment->CostAt(current_column),
-            min_cost_segment->gradient});
+            costs[min], gradients[min]});
         last_min_cost_segment = min_cost_segment;
       }
 
+      // Segments that cost at least as much, and don't get cheaper faster,
+      // stay above the minimum up to the next knot. Drop them.
+      const int min_gradient = gradients[min];
+      const float min_cost = costs[min];
+      size_t kept = 0;
+      for (size_t i = 0; i < candidates; ++i) {
+        if (i != min && gradients[i] >= min_gradient) continue;
+        intercepts[kept] = intercepts[i];
+        gradients[kept] = gradients[i];
+        starts[kept] = starts[i];
+        inputs[kept] = inputs[i];
+        costs[kept] = costs[i];
+        ++kept;
+      }
+      candidates = kept;
+
       // Find closest crossover point located before next knot.
       int next_column = next_knot;
-      for (const auto& segment : *segments) {
-        if (segment->gradient >= min_cost_segment->gradient) continue;
-        float gamma = (segment->CostAt(current_column) -
-                       min_cost_segment->CostAt(current_column)) /
-                      (min_cost_segment->gradient - segment->gradient);
+      for (size_t i = 0; i < candidates; ++i) {
+        if (gradients[i] >= min_gradient) continue;
+        float gamma = (costs[i] - min_cost) / (min_gradient - gradients[i]);
         int column = current_column + std::ceil(gamma);
         if (column > current_column && column < next_column) {
           next_column = column;
@@ -471,11 +599,14 @@ LayoutFunction LayoutFunctionFactory::Choice(
   return result;
 }
 
-void TokenPartitionsLayoutOptimizer::Optimize(int indentation,
+bool TokenPartitionsLayoutOptimizer::Optimize(int indentation,
                                               TokenPartitionTree* node) const {
   CHECK_NOTNULL(node);
   CHECK_GE(indentation, 0);
 
+  knots_ = 0;
+  deadline_ = absl::Now() + budget_.time_limit;
+  budget_exceeded_ = false;
   const LayoutFunction layout_function = CalculateOptimalLayout(*node);
 
   CHECK(!layout_function.empty());
@@ -488,10 +619,65 @@ void TokenPartitionsLayoutOptimizer::Optimize(int indentation,
   TreeReconstructor tree_reconstructor(indentation);
   tree_reconstructor.TraverseTree(iter->layout);
   tree_reconstructor.ReplaceTokenPartitionTreeNode(node);
+  return !budget_exceeded_;
 }
 
 LayoutFunction TokenPartitionsLayoutOptimizer::CalculateOptimalLayout(
     const TokenPartitionTree& node) const {
+  // Single lines are not worth caching.
+  if (cache_ == nullptr ||
+      (is_leaf(node) &&
+       node.Value().PartitionPolicy() != PartitionPolicyEnum::kWrap)) {
+    return WithinBudget(node, ComputeOptimalLayout(node));
+  }
+
+  std::vector<int> shape;
+  AppendPartitionShape(node, &shape);
+  const auto origin = node.Value().TokensRange().begin();
+  auto& entries = cache_->entries_->entries;
+  ++cache_->lookups_;
+  if (const auto found = entries.find(shape); found != entries.end()) {
+    ++cache_->hits_;
+    return WithinBudget(
+        node,
+        RebaseLayoutFunction(found->second.layout_function,
+                             std::distance(found->second.origin, origin)));
+  }
+
+  LayoutFunction lf = ComputeOptimalLayout(node);
+  // Greedy layouts are not reused by partitions that might be within budget.
+  if (!budget_exceeded_) {
+    entries.emplace(std::move(shape),
+                    LayoutFunctionCache::Entries::Entry{origin, lf});
+  }
+  return WithinBudget(node, std::move(lf));
+}
+
+LayoutFunction TokenPartitionsLayoutOptimizer::WithinBudget(
+    const TokenPartitionTree& node, LayoutFunction lf) const {
+  if (!budget_exceeded_) {
+    knots_ += lf.size();
+    budget_exceeded_ =
+        (budget_.max_knots > 0 && knots_ > budget_.max_knots) ||
+        (deadline_ != absl::InfiniteFuture() && absl::Now() >= deadline_);
+    if (budget_exceeded_) {
+      VLOG(1) << "Layout optimizer budget exceeded after " << knots_
+              << " knots, laying out the rest of the partition greedily.";
+    }
+  }
+  if (!budget_exceeded_ || lf.size() <= 1) return lf;
+
+  // The cost at columns other than the chosen one is only an estimate, as
+  // is the indentation for the column where the layout starts.
+  const int column = std::max(node.Value().IndentationSpaces(), 0);
+  LayoutFunctionSegment segment = *lf.AtOrToTheLeftOf(column);
+  segment.intercept -= static_cast<float>(segment.gradient * segment.column);
+  segment.column = 0;
+  return LayoutFunction{segment};
+}
+
+LayoutFunction TokenPartitionsLayoutOptimizer::ComputeOptimalLayout(
+    const TokenPartitionTree& node) const {
   if (is_leaf(node)) {
     // Wrapping complexity is n*(n+1)/2.
     constexpr int kWrapTokensLimit = 25;
@@ -669,7 +855,7 @@ LayoutFunction TokenPartitionsLayoutOptimizer::CalculateOptimalLayout(
   return factory_.Stack(layouts.begin(), layouts.end());
 }
 
-void TreeReconstructor::TraverseTree(const LayoutTree& layout_tree) {
+void TreeReconstructor::TraverseTree(const SharedLayoutTree& layout_tree) {
   const auto& layout = layout_tree.Value();
   const auto relative_indentation = layout.IndentationSpaces();
   const ValueSaver<int> indent_saver(
@@ -20,14 +20,63 @@
 #ifndef VERIBLE_VERILOG_FORMATTING_LAYOUT_OPTIMIZER_H_
 #define VERIBLE_VERILOG_FORMATTING_LAYOUT_OPTIMIZER_H_
 
+#include <memory>
+
+#include "absl/time/time.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/token_partition_tree.h"
 
 namespace verible {
 
+// Reuses layout functions of structurally identical partitions, e.g. repeated
+// declarations or case items in generated code.
+// A cache can be shared by OptimizeTokenPartitionTree() calls that use the
+// same style, and whose partitions span tokens of the same token array.
+class LayoutFunctionCache {
+ public:
+  LayoutFunctionCache();
+  ~LayoutFunctionCache();
+
+  LayoutFunctionCache(const LayoutFunctionCache &) = delete;
+  LayoutFunctionCache &operator=(const LayoutFunctionCache &) = delete;
+
+  // Returns number of partitions looked up in the cache.
+  int Lookups() const { return lookups_; }
+
+  // Returns number of partitions whose layout function was found in the cache.
+  int Hits() const { return hits_; }
+
+ private:
+  friend class TokenPartitionsLayoutOptimizer;
+
+  struct Entries;  // Defined in layout_optimizer_internal.h
+
+  std::unique_ptr<Entries> entries_;
+  int lookups_ = 0;
+  int hits_ = 0;
+};
+
+// Resources that OptimizeTokenPartitionTree() spends on one partition at most.
+// Once they are exhausted, the subpartitions left are laid out greedily: each
+// one keeps the layout that is optimal at its own indentation, so that the
+// layout functions of the enclosing partitions stop growing.
+struct LayoutOptimizerBudget {
+  // Total number of knots (segments) of the computed layout functions.
+  // Not limited unless positive.
+  int max_knots = 0;
+
+  // Time spent on computing layout functions.
+  absl::Duration time_limit = absl::InfiniteDuration();
+};
+
 // Handles formatting of `node` using LayoutOptimizer.
-void OptimizeTokenPartitionTree(const BasicFormatStyle &style,
-                                TokenPartitionTree *node);
+// When 'cache' is null, layout functions are only reused within `node`.
+// Returns false if 'budget' was exceeded, and parts of `node` were laid out
+// greedily instead of optimally.
+bool OptimizeTokenPartitionTree(const BasicFormatStyle &style,
+                                TokenPartitionTree *node,
+                                LayoutFunctionCache *cache = nullptr,
+                                const LayoutOptimizerBudget &budget = {});
 
 }  // namespace verible
 
@@ -21,6 +21,7 @@
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <type_traits>
@@ -28,11 +29,14 @@
 #include <vector>
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/format_token.h"
+#include "common/formatting/layout_optimizer.h"
 #include "common/formatting/token_partition_tree.h"
 #include "common/formatting/unwrapped_line.h"
 #include "common/util/logging.h"
@@ -94,8 +98,8 @@ class LayoutItem {
     CHECK_GE(spaces_before_, 0);
   }
 
-  // Multiple LayoutFunctionSegments can store copies of the same layout.
-  // The objects are copied mostly in LayoutFunctionFactory::* functions.
+  // Items are copied when a layout is derived from another one with a
+  // different root item, e.g. in LayoutFunctionFactory::Indent().
   LayoutItem(const LayoutItem &) = default;
   LayoutItem &operator=(const LayoutItem &) = default;
 
@@ -164,6 +168,15 @@ class LayoutItem {
     return tokens_;
   }
 
+  // Moves the spanned tokens range by 'offset' tokens, e.g. to reuse the item
+  // for an identically shaped partition elsewhere in the same token array.
+  // Can be called only on Line items.
+  void ShiftTokensRange(std::ptrdiff_t offset) {
+    CHECK_EQ(type_, LayoutType::kLine);
+    tokens_ =
+        FormatTokenRange(tokens_.begin() + offset, tokens_.end() + offset);
+  }
+
   friend bool operator==(const LayoutItem &lhs, const LayoutItem &rhs) {
     return (lhs.type_ == rhs.type_ && lhs.indentation_ == rhs.indentation_ &&
             lhs.tokens_ == rhs.tokens_ &&
@@ -205,6 +218,51 @@ std::ostream &operator<<(std::ostream &stream, const LayoutItem &layout);
 // Intermediate partition tree layout
 using LayoutTree = VectorTree<LayoutItem>;
 
+// Immutable layout tree stored in LayoutFunctionSegments.
+//
+// Nodes are reference-counted and shared between all layouts that contain
+// them, so LayoutFunctionFactory combines layouts without copying their
+// subtrees, and copying a SharedLayoutTree only copies a pointer. The optimal
+// layout is turned into partitions directly by TreeReconstructor.
+//
+// Fulfills the (read-only) TreeNode concept from tree_operations.h.
+class SharedLayoutTree {
+ public:
+  using subnodes_type = std::vector<SharedLayoutTree>;
+
+  explicit SharedLayoutTree(const LayoutItem &value,
+                            subnodes_type children = {})
+      : node_(std::make_shared<const Node>(Node{value, std::move(children)})) {
+  }
+
+  // Creates shared copy of 'tree'.
+  SharedLayoutTree(  // NOLINT(google-explicit-constructor)
+      const LayoutTree &tree)
+      : SharedLayoutTree(tree.Value(), CopyChildren(tree)) {}
+
+  const LayoutItem &Value() const { return node_->value; }
+
+  const subnodes_type &Children() const { return node_->children; }
+
+  // Returns layout with 'value' as its root item, sharing children with this
+  // layout.
+  SharedLayoutTree WithValue(const LayoutItem &value) const {
+    return SharedLayoutTree(value, node_->children);
+  }
+
+ private:
+  struct Node {
+    LayoutItem value;
+    subnodes_type children;
+  };
+
+  static subnodes_type CopyChildren(const LayoutTree &tree) {
+    return subnodes_type(tree.Children().begin(), tree.Children().end());
+  }
+
+  std::shared_ptr<const Node> node_;
+};
+
 // Single segment of LayoutFunction
 // Maps starting column to a linear cost function and its optimal layout.
 struct LayoutFunctionSegment {
@@ -214,7 +272,7 @@ struct LayoutFunctionSegment {
 
   // Optimal layout for an interval starting at the column.
   // AKA: layout expression
-  LayoutTree layout;
+  SharedLayoutTree layout;
 
   // Width of the last line of the layout in columns.
   int span;
@@ -329,7 +387,9 @@ class LayoutFunction {
   // Sets whether to force line break just before this layout.
   void SetMustWrap(bool must_wrap) {
     for (auto &segment : segments_) {
-      segment.layout.Value().SetMustWrap(must_wrap);
+      LayoutItem item = segment.layout.Value();
+      item.SetMustWrap(must_wrap);
+      segment.layout = segment.layout.WithValue(item);
     }
   }
 
@@ -726,10 +786,27 @@ class LayoutFunctionFactory {
   const BasicFormatStyle &style_;
 };
 
+// Layout functions cached by TokenPartitionsLayoutOptimizer, keyed by the
+// shape of their partition (see AppendPartitionShape() in
+// layout_optimizer.cc).
+struct LayoutFunctionCache::Entries {
+  struct Entry {
+    // First token of the partition the layout function was calculated for.
+    std::vector<PreFormatToken>::const_iterator origin;
+    LayoutFunction layout_function;
+  };
+
+  absl::flat_hash_map<std::vector<int>, Entry> entries;
+};
+
 class TokenPartitionsLayoutOptimizer {
  public:
-  explicit TokenPartitionsLayoutOptimizer(const BasicFormatStyle &style)
-      : factory_(style) {}
+  // Layout functions are looked up in, and added to 'cache' when it is not
+  // null.  Each Optimize() call spends 'budget' at most.
+  explicit TokenPartitionsLayoutOptimizer(
+      const BasicFormatStyle &style, LayoutFunctionCache *cache = nullptr,
+      const LayoutOptimizerBudget &budget = {})
+      : factory_(style), cache_(cache), budget_(budget) {}
 
   TokenPartitionsLayoutOptimizer(const TokenPartitionsLayoutOptimizer &) =
       delete;
@@ -739,12 +816,33 @@ class TokenPartitionsLayoutOptimizer {
   TokenPartitionsLayoutOptimizer &operator=(TokenPartitionsLayoutOptimizer &&) =
       delete;
 
-  void Optimize(int indentation, TokenPartitionTree *node) const;
+  // Returns false if the budget was exceeded, and parts of 'node' were laid
+  // out greedily.
+  bool Optimize(int indentation, TokenPartitionTree *node) const;
 
   LayoutFunction CalculateOptimalLayout(const TokenPartitionTree &node) const;
 
+  // Returns whether the budget was exceeded since the last Optimize() call.
+  bool BudgetExceeded() const { return budget_exceeded_; }
+
  private:
+  // Calculates layout function of 'node' without looking it up in the cache.
+  LayoutFunction ComputeOptimalLayout(const TokenPartitionTree &node) const;
+
+  // Charges 'lf', the layout function of 'node', to the budget.  Once the
+  // budget is exceeded, returns the layout that 'lf' picks at the indentation
+  // of 'node' as the only segment.
+  LayoutFunction WithinBudget(const TokenPartitionTree &node,
+                              LayoutFunction lf) const;
+
   const LayoutFunctionFactory factory_;
+  LayoutFunctionCache *const cache_;
+  const LayoutOptimizerBudget budget_;
+
+  // Budget spent since the last Optimize() call.
+  mutable int knots_ = 0;
+  mutable absl::Time deadline_ = absl::InfiniteFuture();
+  mutable bool budget_exceeded_ = false;
 };
 
 class TreeReconstructor {
@@ -758,7 +856,7 @@ class TreeReconstructor {
   TreeReconstructor &operator=(const TreeReconstructor &) = delete;
   TreeReconstructor &operator=(TreeReconstructor &&) = delete;
 
-  void TraverseTree(const LayoutTree &layout_tree);
+  void TraverseTree(const SharedLayoutTree &layout_tree);
 
   void ReplaceTokenPartitionTreeNode(TokenPartitionTree *node);
 
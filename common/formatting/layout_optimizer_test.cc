@@ -17,16 +17,19 @@
 #include <algorithm>
 #include <cstddef>
 #include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/format_token.h"
 #include "common/formatting/layout_optimizer_internal.h"
@@ -1463,6 +1466,43 @@ TEST_F(LayoutFunctionFactoryTest, Choice) {
   }
 }
 
+TEST_F(LayoutFunctionFactoryTest, ChoiceIsLowerEnvelope) {
+  using LT = LayoutTree;
+  using LI = LayoutItem;
+
+  // Each function gets its own span, to tell which one was chosen.
+  std::vector<LayoutFunction> choices;
+  for (int f = 0; f < 12; ++f) {
+    const auto layout = LT(LI(LayoutType::kLine, 0, false));
+    LayoutFunction lf;
+    for (int knot = 0; knot < 5; ++knot) {
+      const int column = knot * (7 + f % 5);
+      const auto intercept = static_cast<float>((f * 37 + knot * 11) % 60);
+      lf.push_back({column, layout, f, intercept, (f * 3 + knot) % 7});
+    }
+    choices.push_back(std::move(lf));
+  }
+
+  const LayoutFunction result = factory_.Choice(choices.begin(), choices.end());
+  for (int column = 0; column < 150; ++column) {
+    float min_cost = std::numeric_limits<float>::max();
+    for (const auto& lf : choices) {
+      min_cost = std::min(min_cost, lf.AtOrToTheLeftOf(column)->CostAt(column));
+    }
+    EXPECT_EQ(result.AtOrToTheLeftOf(column)->CostAt(column), min_cost)
+        << "column " << column << ":\n"
+        << result;
+  }
+  // Consecutive segments differ in the chosen segment.
+  for (int i = 1; i < result.size(); ++i) {
+    EXPECT_FALSE(result[i - 1].span == result[i].span &&
+                 result[i - 1].gradient == result[i].gradient &&
+                 result[i - 1].CostAt(result[i].column) == result[i].intercept)
+        << "redundant knot at column " << result[i].column << ":\n"
+        << result;
+  }
+}
+
 TEST_F(LayoutFunctionFactoryTest, Wrap) {
   using LT = LayoutTree;
   using LI = LayoutItem;
@@ -1665,6 +1705,24 @@ TEST_F(LayoutFunctionFactoryTest, Indent) {
   }
 }
 
+TEST_F(LayoutFunctionFactoryTest, CombinatorsShareSublayouts) {
+  const auto short_line = factory_.Line(lines_.Short());
+  const auto long_line = factory_.Line(lines_.Long());
+  const auto stack = factory_.Stack({short_line, long_line});
+  const auto indented = factory_.Indent(stack, 3);
+  const auto lf = factory_.Choice({
+      factory_.Juxtaposition({short_line, indented}),
+      indented,
+  });
+  for (const auto& segment : lf) {
+    const auto& layout = segment.layout;
+    ASSERT_FALSE(layout.Children().empty());
+    const auto& last_line = RightmostDescendant(layout).Value();
+    // The line is not copied into the combined layouts.
+    EXPECT_EQ(&last_line, &long_line.front().layout.Value());
+  }
+}
+
 TEST_F(LayoutFunctionFactoryTest, IndentWithOtherCombinators) {
   using LT = LayoutTree;
   using LI = LayoutItem;
@@ -2383,6 +2441,157 @@ TEST_F(OptimizeTokenPartitionTreeTest, AppendToLineWithInlinePartitions) {
   EXPECT_PRED_FORMAT2(TokenPartitionTreesEqualPredFormat, tree, expected_tree);
 }
 
+TEST_F(OptimizeTokenPartitionTreeTest, GreedyLayoutBeyondBudget) {
+  using TPT = TokenPartitionTreeBuilder;
+  using PP = PartitionPolicyEnum;
+
+  const auto build_tree = [this]() {
+    return TPT(PP::kJuxtapositionOrIndentedStack,
+               {
+                   TPT(0, {0, 2}, PP::kWrap),
+                   TPT(4, {2, 5}, PP::kWrap),
+                   TPT(4, {5, 8}, PP::kWrap),
+                   TPT(4, {8, 13}, PP::kWrap),
+               })
+        .build(pre_format_tokens_);
+  };
+  // Returns the token ranges of the leaves, which have to cover all tokens
+  // in order.
+  const auto leaf_ranges = [this](const TokenPartitionTree& tree) {
+    std::vector<std::pair<int, int>> ranges;
+    ApplyPreOrder(tree, [&](const TokenPartitionTree& node) {
+      if (!is_leaf(node)) return;
+      const auto tokens = node.Value().TokensRange();
+      ranges.emplace_back(
+          std::distance(pre_format_tokens_.cbegin(), tokens.begin()),
+          std::distance(pre_format_tokens_.cbegin(), tokens.end()));
+    });
+    return ranges;
+  };
+  const auto expect_all_tokens = [&](const TokenPartitionTree& tree) {
+    const auto ranges = leaf_ranges(tree);
+    ASSERT_FALSE(ranges.empty());
+    EXPECT_EQ(ranges.front().first, 0);
+    EXPECT_EQ(ranges.back().second, 13);
+    for (size_t i = 1; i < ranges.size(); ++i) {
+      EXPECT_EQ(ranges[i - 1].second, ranges[i].first);
+    }
+  };
+
+  static const BasicFormatStyle style = CreateStyle();
+  auto expected_tree = build_tree();
+  EXPECT_TRUE(OptimizeTokenPartitionTree(style, &expected_tree));
+
+  // A budget that is not exceeded does not change the layout.
+  LayoutOptimizerBudget large_budget;
+  large_budget.max_knots = 1000000;
+  large_budget.time_limit = absl::Hours(1);
+  auto tree = build_tree();
+  EXPECT_TRUE(OptimizeTokenPartitionTree(style, &tree, nullptr, large_budget));
+  EXPECT_PRED_FORMAT2(TokenPartitionTreesEqualPredFormat, tree, expected_tree);
+
+  LayoutOptimizerBudget knot_budget;
+  knot_budget.max_knots = 1;
+  auto greedy_tree = build_tree();
+  EXPECT_FALSE(
+      OptimizeTokenPartitionTree(style, &greedy_tree, nullptr, knot_budget));
+  expect_all_tokens(greedy_tree);
+
+  LayoutOptimizerBudget time_budget;
+  time_budget.time_limit = absl::ZeroDuration();
+  auto timed_tree = build_tree();
+  EXPECT_FALSE(
+      OptimizeTokenPartitionTree(style, &timed_tree, nullptr, time_budget));
+  expect_all_tokens(timed_tree);
+}
+
+TEST_F(OptimizeTokenPartitionTreeTest, GreedyLayoutsAreNotCached) {
+  using TPT = TokenPartitionTreeBuilder;
+  using PP = PartitionPolicyEnum;
+
+  const auto build_tree = [this]() {
+    return TPT(PP::kJuxtapositionOrIndentedStack,
+               {
+                   TPT(0, {0, 2}, PP::kWrap),
+                   TPT(4, {2, 8}, PP::kWrap),
+               })
+        .build(pre_format_tokens_);
+  };
+
+  static const BasicFormatStyle style = CreateStyle();
+  LayoutOptimizerBudget budget;
+  budget.max_knots = 1;
+  LayoutFunctionCache cache;
+  auto greedy_tree = build_tree();
+  EXPECT_FALSE(OptimizeTokenPartitionTree(style, &greedy_tree, &cache, budget));
+
+  // Only layouts computed within the budget are reused.
+  auto expected_tree = build_tree();
+  OptimizeTokenPartitionTree(style, &expected_tree);
+  auto tree = build_tree();
+  EXPECT_TRUE(OptimizeTokenPartitionTree(style, &tree, &cache));
+  EXPECT_PRED_FORMAT2(TokenPartitionTreesEqualPredFormat, tree, expected_tree);
+}
+
+class LayoutFunctionCacheTest : public ::testing::Test,
+                                public UnwrappedLineMemoryHandler {
+ public:
+  LayoutFunctionCacheTest()
+      : sample_(
+            "reg_a_aaaaaaa = value_aaaa_aaaaaaaa + other_a_aaaaaaa ; "
+            "reg_b_bbbbbbb = value_bbbb_bbbbbbbb + other_b_bbbbbbb ;"),
+        tokens_(absl::StrSplit(sample_, ' ')) {
+    for (const auto token : tokens_) {
+      ftokens_.emplace_back(1, token);
+    }
+    CreateTokenInfos(ftokens_);
+    for (auto& token : pre_format_tokens_) {
+      token.before.spaces_required = 1;
+    }
+  }
+
+ protected:
+  // Returns partition of the statement starting at token 'begin'.
+  TokenPartitionTree Statement(int begin) const {
+    using TPT = TokenPartitionTreeBuilder;
+    using PP = PartitionPolicyEnum;
+    return TPT(PP::kJuxtapositionOrIndentedStack,
+               {
+                   TPT(0, {begin, begin + 2}, PP::kAlreadyFormatted),
+                   TPT(4, {begin + 2, begin + 6}, PP::kWrap),
+               })
+        .build(pre_format_tokens_);
+  }
+
+  const std::string sample_;
+  const std::vector<absl::string_view> tokens_;
+  std::vector<TokenInfo> ftokens_;
+};
+
+TEST_F(LayoutFunctionCacheTest, ReusesLayoutsOfIdenticalPartitions) {
+  static const BasicFormatStyle style = CreateStyle();
+
+  auto expected_a = Statement(0);
+  auto expected_b = Statement(6);
+  OptimizeTokenPartitionTree(style, &expected_a);
+  OptimizeTokenPartitionTree(style, &expected_b);
+
+  LayoutFunctionCache cache;
+  auto tree_a = Statement(0);
+  auto tree_b = Statement(6);
+  OptimizeTokenPartitionTree(style, &tree_a, &cache);
+  const int lookups = cache.Lookups();
+  EXPECT_GT(lookups, 0);
+  EXPECT_EQ(cache.Hits(), 0);
+  OptimizeTokenPartitionTree(style, &tree_b, &cache);
+  // The whole statement is found.
+  EXPECT_EQ(cache.Lookups(), lookups + 1);
+  EXPECT_EQ(cache.Hits(), 1);
+
+  EXPECT_PRED_FORMAT2(TokenPartitionTreesEqualPredFormat, tree_a, expected_a);
+  EXPECT_PRED_FORMAT2(TokenPartitionTreesEqualPredFormat, tree_b, expected_b);
+}
+
 class TokenPartitionsLayoutOptimizerTest : public ::testing::Test,
                                            public UnwrappedLineMemoryHandler {
  public:
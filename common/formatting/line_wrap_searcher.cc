@@ -14,11 +14,14 @@
 
 #include "common/formatting/line_wrap_searcher.h"
 
-#include <memory>
+#include <cstddef>
+#include <iterator>
 #include <ostream>
 #include <queue>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/format_token.h"
 #include "common/formatting/state_node.h"
@@ -32,49 +35,112 @@ namespace {
 
 // Wrapped class around StateNode for the sake of adapting to a
 // std::priority_queue interface.
-// TODO(fangism): if performance of memory allocations is an issue,
-// use some sort of pool-allocator.
+// The StateNodes are owned by the StateNodeArena of the search.
 struct SearchState {
-  std::shared_ptr<const StateNode> state;
+  const StateNode *state;
 
-  explicit SearchState(const std::shared_ptr<const StateNode> &s) : state(s) {}
+  explicit SearchState(const StateNode *s) : state(s) {}
 
   // Inverted to min-heap: *lowest* penalty has the highest search priority.
   bool operator<(const SearchState &r) const { return *r.state < *state; }
 };
-}  // namespace
 
-std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
-                                              const BasicFormatStyle &style,
-                                              int max_search_states) {
-  // Dijkstra's algorithm for now: prioritize searching minimum penalty path
-  // until destination is reached.
+// Everything about a StateNode that the decisions on the remaining tokens
+// depend on.  States with equal keys have equally costly continuations, so
+// only the cheapest of them needs to be explored.
+struct ContinuationKey {
+  size_t next_token_index;
+  int current_column;
+  bool wrapped;  // The last decision was a wrap.
+  std::vector<int> wrap_columns;
 
-  VLOG(2) << "SearchLineWraps on: " << uwline;
-  if (uwline.TokensRange().empty()) {
-    std::vector<FormattedExcerpt> result(1);
-    return result;
+  ContinuationKey(const StateNode &state, const UnwrappedLine &uwline)
+      : next_token_index(std::distance(uwline.TokensRange().begin(),
+                                       state.undecided_path.begin())),
+        current_column(state.current_column),
+        wrapped(state.spacing_choice == SpacingDecision::kWrap) {
+    wrap_columns.reserve(state.wrap_column_positions.size());
+    for (auto stack = state.wrap_column_positions; !stack.empty();
+         stack.pop()) {
+      wrap_columns.push_back(stack.top());
+    }
+  }
+
+  bool operator==(const ContinuationKey &r) const {
+    return next_token_index == r.next_token_index &&
+           current_column == r.current_column && wrapped == r.wrapped &&
+           wrap_columns == r.wrap_columns;
   }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const ContinuationKey &key) {
+    return H::combine(std::move(h), key.next_token_index, key.current_column,
+                      key.wrapped, key.wrap_columns);
+  }
+};
+
+// Restrictions of the search space.
+struct SearchPruning {
+  // If true, states that continue like an already explored state (which was
+  // at most as costly) are not explored.  This keeps the optimal cost, but
+  // can drop some of equally good solutions.
+  bool skip_dominated_states = false;
+
+  // If positive, at most this many states are explored before each token.
+  // The result is then no longer guaranteed to be optimal.
+  int beam_width = 0;
+};
+
+struct SearchResult {
+  std::vector<const StateNode *> winning_paths;
+  bool aborted = false;
+};
+
+SearchResult SearchMinimumPenaltyPaths(const UnwrappedLine &uwline,
+                                       const BasicFormatStyle &style,
+                                       int max_search_states,
+                                       const SearchPruning &pruning,
+                                       StateNodeArena *arena) {
+  // Dijkstra's algorithm for now: prioritize searching minimum penalty path
+  // until destination is reached.
+
   // Worklist for decision searching, ordered by cumulative penalty.
   // Note: a heap-based priority-queue will not guarantee stable ordering
   // among equal-valued keys.  If first-come-first-serve tie-breaking is
   // important, consider switching to a std::map.
   std::priority_queue<SearchState> worklist;
 
+  // Continuations of the states explored so far, for skip_dominated_states.
+  absl::flat_hash_set<ContinuationKey> explored_continuations;
+  // Number of states explored before each token, for beam_width.
+  std::vector<int> explored_at_token(
+      pruning.beam_width > 0 ? uwline.Size() : 0, 0);
+
   // Seed worklist with a NodeState that should have 0 penalty.
-  SearchState seed(std::make_shared<StateNode>(uwline, style));
+  SearchState seed(arena->New(uwline, style));
   worklist.push(seed);
 
-  bool aborted_search = false;
-  std::vector<std::shared_ptr<const StateNode>> winning_paths;
+  SearchResult result;
+  std::vector<const StateNode *> &winning_paths = result.winning_paths;
   int state_count = 0;
   while (!worklist.empty()) {
-    ++state_count;
-
     SearchState next(worklist.top());
     worklist.pop();
 
+    if (!next.state->Done()) {
+      if (pruning.skip_dominated_states &&
+          !explored_continuations.emplace(*next.state, uwline).second) {
+        continue;
+      }
+      if (pruning.beam_width > 0 &&
+          ++explored_at_token[std::distance(
+              uwline.TokensRange().begin(),
+              next.state->undecided_path.begin())] > pruning.beam_width) {
+        continue;
+      }
+    }
+    ++state_count;
+
     VLOG(4) << "\n---- line wrapping search state " << state_count << " ----"
             << "\ncurrent cost: " << next.state->cumulative_cost
             << "\ncurrent column: " << next.state->current_column;
@@ -104,8 +170,8 @@ std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
     if (state_count >= max_search_states) {
       // Search limit exceeded, abandon search.
       // Greedily finish formatting this partition, and return it.
-      winning_paths.push_back(StateNode::QuickFinish(next.state, style));
-      aborted_search = true;
+      winning_paths.push_back(StateNode::QuickFinish(next.state, style, arena));
+      result.aborted = true;
       break;
     }
 
@@ -115,8 +181,8 @@ std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
     const auto &token = next.state->GetNextToken();
     if (token.before.break_decision == SpacingOptions::kPreserve) {
       VLOG(4) << "preserving spaces before \'" << token.token->text() << '\'';
-      SearchState preserved(std::make_shared<StateNode>(
-          next.state, style, SpacingDecision::kPreserve));
+      SearchState preserved(
+          arena->New(next.state, style, SpacingDecision::kPreserve));
       worklist.push(preserved);
     } else {
       // Remaining options are: Undecided, MustWrap, MustAppend
@@ -124,8 +190,8 @@ std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
       if (token.before.break_decision != SpacingOptions::kMustWrap) {
         VLOG(4) << "considering appending \'" << token.token->text() << '\'';
         // Consider cost of appending token to current line.
-        SearchState appended(std::make_shared<StateNode>(
-            next.state, style, SpacingDecision::kAppend));
+        SearchState appended(
+            arena->New(next.state, style, SpacingDecision::kAppend));
         worklist.push(appended);
         VLOG(4) << "  cost: " << appended.state->cumulative_cost;
         VLOG(4) << "  column: " << appended.state->current_column;
@@ -133,8 +199,8 @@ std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
       if (token.before.break_decision != SpacingOptions::kMustAppend) {
         VLOG(4) << "considering wrapping \'" << token.token->text() << '\'';
         // Consider cost of line wrapping here.
-        SearchState wrapped(std::make_shared<StateNode>(
-            next.state, style, SpacingDecision::kWrap));
+        SearchState wrapped(
+            arena->New(next.state, style, SpacingDecision::kWrap));
         worklist.push(wrapped);
         VLOG(4) << "  cost: " << wrapped.state->cumulative_cost;
         VLOG(4) << "  column: " << wrapped.state->current_column;
@@ -148,17 +214,50 @@ std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
   }  // while (!worklist.empty())
 
   CHECK_GE(winning_paths.size(), 1);
+  return result;
+}
+}  // namespace
+
+std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
+                                              const BasicFormatStyle &style,
+                                              int max_search_states,
+                                              int beam_width) {
+  VLOG(2) << "SearchLineWraps on: " << uwline;
+  if (uwline.TokensRange().empty()) {
+    std::vector<FormattedExcerpt> result(1);
+    return result;
+  }
+
+  // All states explored in this search, released in bulk upon return.
+  StateNodeArena arena;
+
+  SearchResult search;
+  if (beam_width > 0) {
+    search = SearchMinimumPenaltyPaths(uwline, style, max_search_states,
+                                       {true, beam_width}, &arena);
+  } else {
+    search = SearchMinimumPenaltyPaths(uwline, style, max_search_states, {},
+                                       &arena);
+    if (search.aborted) {
+      // Skipping dominated states finds a solution of the same optimal cost,
+      // but could choose a different one among equally good solutions, so it
+      // is only used once the exhaustive search gives up.
+      VLOG(2) << "Retrying search without dominated states.";
+      search = SearchMinimumPenaltyPaths(uwline, style, max_search_states,
+                                         {true, 0}, &arena);
+    }
+  }
 
   // Reconstruct the unwrapped_line to reflect the decisions made to reach the
   // winning_paths.  Return a modified copy of the original UnwrappedLine.
   std::vector<FormattedExcerpt> results;
-  results.reserve(winning_paths.size());
-  for (const auto &path : winning_paths) {
+  results.reserve(search.winning_paths.size());
+  for (const auto &path : search.winning_paths) {
     results.emplace_back(uwline);
     auto &result = results.back();
     CHECK_EQ(path->Depth(), result.Tokens().size());
     path->ReconstructFormatDecisions(&result);
-    if (aborted_search) {
+    if (search.aborted) {
       result.MarkIncomplete();
     }
   }
@@ -189,7 +288,8 @@ FitResult FitsOnLine(const UnwrappedLine &uwline,
 
   // Initialize on first token.
   // This accounts for space consumed by left-indentation.
-  auto state = std::make_shared<const StateNode>(uwline, style);
+  StateNodeArena arena;
+  const StateNode *state = arena.New(uwline, style);
 
   while (!state->Done()) {
     const auto &token = state->GetNextToken();
@@ -199,7 +299,7 @@ FitResult FitsOnLine(const UnwrappedLine &uwline,
     }
 
     // Append token onto same line while it fits.
-    state = std::make_shared<StateNode>(state, style, SpacingDecision::kAppend);
+    state = arena.New(state, style, SpacingDecision::kAppend);
     if (state->current_column > style.column_limit) {
       return {false, state->current_column};
     }
@@ -29,13 +29,19 @@ namespace verible {
 // This minimizes the numeric penalty during search to yield optimal results,
 // which can result in multiple optimal formattings.
 // max_search_states limits the size of the optimization search.
-// When the number of states evaluated exceeds this, this will abort by
-// returning a greedily formatted result (which can still be rendered)
-// that will be marked as !CompletedFormatting().
+// When the number of states evaluated exceeds this, the search is repeated
+// without the states that can only lead to costlier results than an already
+// explored one, which still finds an optimal result.  If that exceeds the
+// limit too, this will abort by returning a greedily formatted result (which
+// can still be rendered) that will be marked as !CompletedFormatting().
+// If beam_width is positive, only the beam_width cheapest states before each
+// token are explored, which bounds the search to beam_width states per token,
+// but can return a suboptimal result.
 // This is guaranteed to return at least one result.
 std::vector<FormattedExcerpt> SearchLineWraps(const UnwrappedLine &uwline,
                                               const BasicFormatStyle &style,
-                                              int max_search_states);
+                                              int max_search_states,
+                                              int beam_width = 0);
 
 // Diagnostic helper for displaying when multiple optimal wrappings are found
 // by SearchLineWraps.  This aids in development around wrap penalty tuning.
@@ -0,0 +1,91 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the throughput of SearchLineWraps() in explored states per second
+// on long port-list-like partitions, which exhaust the search budget.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "common/formatting/basic_format_style.h"
+#include "common/formatting/format_token.h"
+#include "common/formatting/line_wrap_searcher.h"
+#include "common/formatting/unwrapped_line.h"
+#include "common/formatting/unwrapped_line_test_utils.h"
+#include "common/text/token_info.h"
+
+namespace verible {
+namespace {
+
+// Builds "m( p0 , p1 , ... , pN ) ;" as a single UnwrappedLine.
+class PortListLine : public UnwrappedLineMemoryHandler {
+ public:
+  explicit PortListLine(int num_ports) {
+    std::vector<std::string> texts = {"m", "("};
+    for (int i = 0; i < num_ports; ++i) {
+      if (i > 0) texts.emplace_back(",");
+      texts.push_back(absl::StrCat("port_name_", i));
+    }
+    texts.emplace_back(")");
+    texts.emplace_back(";");
+    std::vector<TokenInfo> tokens;
+    tokens.reserve(texts.size());
+    for (const auto &text : texts) tokens.emplace_back(0, text);
+    CreateTokenInfos(tokens);
+
+    for (auto &ftoken : pre_format_tokens_) {
+      const absl::string_view text = ftoken.token->text();
+      ftoken.before.spaces_required = 1;
+      ftoken.before.break_penalty = (text == ",") ? 10 : 2;
+      if (text == "(") ftoken.balancing = GroupBalancing::kOpen;
+      if (text == ")") ftoken.balancing = GroupBalancing::kClose;
+    }
+    line_ = UnwrappedLine(0, pre_format_tokens_.begin());
+    AddFormatTokens(&line_);
+  }
+
+  const UnwrappedLine &Line() const { return line_; }
+
+ private:
+  UnwrappedLine line_;
+};
+
+static void BM_SearchLineWrapsPortList(benchmark::State &state) {
+  const PortListLine port_list(state.range(0));
+  BasicFormatStyle style;
+  style.column_limit = 40;
+  constexpr int kMaxSearchStates = 100000;
+  bool exhausted_budget = true;
+  for (auto _ : state) {
+    const auto results =
+        SearchLineWraps(port_list.Line(), style, kMaxSearchStates);
+    exhausted_budget &= !results.front().CompletedFormatting();
+    benchmark::DoNotOptimize(results);
+  }
+  if (exhausted_budget) {
+    // Every iteration explored exactly kMaxSearchStates states in both the
+    // exhaustive search and its retry without dominated states.
+    state.counters["states"] = benchmark::Counter(
+        2.0 * kMaxSearchStates * state.iterations(),
+        benchmark::Counter::kIsRate);
+  }
+}
+BENCHMARK(BM_SearchLineWrapsPortList)->Arg(32)->Arg(128)->Arg(512);
+
+}  // namespace
+}  // namespace verible
+
+BENCHMARK_MAIN();
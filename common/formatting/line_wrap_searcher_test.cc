@@ -16,9 +16,12 @@
 
 #include <cstddef>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/format_token.h"
 #include "common/formatting/unwrapped_line.h"
@@ -45,6 +48,31 @@ class SearchLineWrapsTestFixture : public UnwrappedLineMemoryHandler,
     return levels * style_.indentation_spaces;
   }
 
+  // Creates "m ( p0 , p1 , ... , pN ) ;" as a single UnwrappedLine.
+  UnwrappedLine PortListLine(int num_ports) {
+    std::vector<std::string> texts = {"m", "("};
+    for (int i = 0; i < num_ports; ++i) {
+      if (i > 0) texts.emplace_back(",");
+      texts.push_back(absl::StrCat("p", i));
+    }
+    texts.emplace_back(")");
+    texts.emplace_back(";");
+    std::vector<TokenInfo> tokens;
+    tokens.reserve(texts.size());
+    for (const auto &text : texts) tokens.emplace_back(0, text);
+    CreateTokenInfos(tokens);
+    for (auto &ftoken : pre_format_tokens_) {
+      const absl::string_view text = ftoken.token->text();
+      ftoken.before.spaces_required = 1;
+      ftoken.before.break_penalty = (text == ",") ? 10 : 2;
+      if (text == "(") ftoken.balancing = GroupBalancing::kOpen;
+      if (text == ")") ftoken.balancing = GroupBalancing::kClose;
+    }
+    UnwrappedLine uwline(0, pre_format_tokens_.begin());
+    AddFormatTokens(&uwline);
+    return uwline;
+  }
+
   FormattedExcerpt SearchLineWraps(const UnwrappedLine &uwline,
                                    const BasicFormatStyle &style) {
     // Bound the size of search for unit testing.
@@ -427,5 +455,39 @@ TEST_F(SearchLineWrapsTestFixture, AbortedSearch) {
   // So we don't check any other properties of the formatted_line.
 }
 
+// Returns the number of wrapped tokens.
+static int CountWraps(const FormattedExcerpt &line) {
+  int wraps = 0;
+  for (const auto &ftoken : line.Tokens()) {
+    if (ftoken.before.action == SpacingDecision::kWrap) ++wraps;
+  }
+  return wraps;
+}
+
+// Test that a search that exhausts its limit is completed by skipping states
+// that cannot lead to better results.
+TEST_F(SearchLineWrapsTestFixture, SkipsDominatedStatesWhenExhausted) {
+  // Exhaustive search does not finish this even within 1000000 states.
+  const UnwrappedLine uwline_in = PortListLine(40);
+  const auto formatted_lines =
+      verible::SearchLineWraps(uwline_in, style_, 1000);
+  const FormattedExcerpt &formatted_line = formatted_lines.front();
+  EXPECT_TRUE(formatted_line.CompletedFormatting());
+  EXPECT_EQ(formatted_line.Tokens().size(), uwline_in.Size());
+  EXPECT_EQ(CountWraps(formatted_line), 13);
+}
+
+// Test that beam search completes in bounded states.
+TEST_F(SearchLineWrapsTestFixture, BeamSearch) {
+  const UnwrappedLine uwline_in = PortListLine(40);
+  constexpr int kBeamWidth = 4;
+  const auto formatted_lines = verible::SearchLineWraps(
+      uwline_in, style_, kBeamWidth * uwline_in.Size() + 1, kBeamWidth);
+  const FormattedExcerpt &formatted_line = formatted_lines.front();
+  EXPECT_TRUE(formatted_line.CompletedFormatting());
+  EXPECT_EQ(formatted_line.Tokens().size(), uwline_in.Size());
+  EXPECT_GE(CountWraps(formatted_line), 13);
+}
+
 }  // namespace
 }  // namespace verible
@@ -15,9 +15,7 @@
 #include "common/formatting/state_node.h"
 
 #include <cstddef>
-#include <memory>
 #include <ostream>
-#include <stack>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -61,7 +59,7 @@ StateNode::StateNode(const UnwrappedLine &uwline, const BasicFormatStyle &style)
       current_column(uwline.IndentationSpaces()) {
   // The starting column is relative to the current indentation level.
   VLOG(4) << "initial column position: " << current_column;
-  wrap_column_positions.push(current_column + style.wrap_spaces);
+  PushWrapColumn(current_column + style.wrap_spaces);
   if (!uwline.TokensRange().empty()) {
     VLOG(4) << "token.text: \'" << undecided_path.front().token->text() << '\'';
     // Point undecided_path past the first token.
@@ -74,8 +72,7 @@ StateNode::StateNode(const UnwrappedLine &uwline, const BasicFormatStyle &style)
   VLOG(4) << "root: " << *this;
 }
 
-StateNode::StateNode(const std::shared_ptr<const StateNode> &parent,
-                     const BasicFormatStyle &style,
+StateNode::StateNode(const StateNode *parent, const BasicFormatStyle &style,
                      SpacingDecision spacing_choice)
     : prev_state(ABSL_DIE_IF_NULL(parent)),
       undecided_path(prev_state->undecided_path.begin() + 1,  // pop_front()
@@ -279,15 +276,15 @@ void StateNode::OpenGroupBalance(const BasicFormatStyle &style) {
       switch (spacing_choice) {
         case SpacingDecision::kWrap:
           VLOG(4) << "current token is wrapped";
-          wrap_column_positions.push(prev_state->wrap_column_positions.top() +
-                                     style.wrap_spaces);
+          PushWrapColumn(prev_state->wrap_column_positions.top() +
+                         style.wrap_spaces);
           break;
         case SpacingDecision::kAlign:
           LOG(FATAL) << kNotForAlignment;
           break;
         case SpacingDecision::kAppend:
           VLOG(4) << "current token is appended or aligned";
-          wrap_column_positions.push(prev_state->current_column);
+          PushWrapColumn(prev_state->current_column);
           break;
         case SpacingDecision::kPreserve:
           // TODO(b/134711965): calculate column position using original spaces
@@ -298,6 +295,13 @@ void StateNode::OpenGroupBalance(const BasicFormatStyle &style) {
   // TODO(fangism): what if first token on unwrapped line is open-group?
 }
 
+void StateNode::PushWrapColumn(int column) {
+  // Each state opens at most one group, so one entry of storage suffices.
+  CHECK(!pushed_wrap_column_used_);
+  pushed_wrap_column_used_ = true;
+  wrap_column_positions.push(column, &pushed_wrap_column_);
+}
+
 void StateNode::CloseGroupBalance() {
   if (wrap_column_positions.size() > 1) {
     // Always maintain at least one element on column position stack.
@@ -313,33 +317,33 @@ void StateNode::CloseGroupBalance() {
   //     ) <-- aligned with (
 }
 
-std::shared_ptr<const StateNode> StateNode::AppendIfItFits(
-    const std::shared_ptr<const StateNode> &current_state,
-    const verible::BasicFormatStyle &style) {
+const StateNode *StateNode::AppendIfItFits(
+    const StateNode *current_state, const verible::BasicFormatStyle &style,
+    StateNodeArena *arena) {
   if (current_state->Done()) return current_state;
   const auto &token = current_state->GetNextToken();
   // It seems little wasteful to always create both states when only one is
-  // returned, but compiler optimization should be able to leverage this.
+  // returned, but arena allocation makes this cheap.
   // In any case, this is not a critical path operation, so we're not going to
   // worry about it.
-  const auto wrapped =
-      std::make_shared<StateNode>(current_state, style, SpacingDecision::kWrap);
-  const auto appended = std::make_shared<StateNode>(current_state, style,
-                                                    SpacingDecision::kAppend);
+  const StateNode *wrapped =
+      arena->New(current_state, style, SpacingDecision::kWrap);
+  const StateNode *appended =
+      arena->New(current_state, style, SpacingDecision::kAppend);
   return (token.before.break_decision == SpacingOptions::kMustWrap ||
           appended->current_column > style.column_limit)
              ? wrapped
              : appended;
 }
 
-std::shared_ptr<const StateNode> StateNode::QuickFinish(
-    const std::shared_ptr<const StateNode> &current_state,
-    const verible::BasicFormatStyle &style) {
-  std::shared_ptr<const StateNode> latest(current_state);
-  // Construct a chain of reference-counted states where the returned pointer
-  // "holds on" to all of its ancestors like a singly-linked-list.
+const StateNode *StateNode::QuickFinish(const StateNode *current_state,
+                                        const verible::BasicFormatStyle &style,
+                                        StateNodeArena *arena) {
+  const StateNode *latest = current_state;
+  // Construct a chain of states where the returned pointer links to all of
+  // its ancestors like a singly-linked-list.
   while (!latest->Done()) {
-    latest = AppendIfItFits(latest, style);
+    latest = AppendIfItFits(latest, style, arena);
   }
   return latest;
 }
@@ -17,30 +17,64 @@
 
 #include <cstddef>
 #include <iosfwd>
-#include <memory>
-#include <stack>
 #include <vector>
 
 #include "common/formatting/basic_format_style.h"
 #include "common/formatting/format_token.h"
 #include "common/formatting/unwrapped_line.h"
 #include "common/util/container_iterator_range.h"
+#include "common/util/logging.h"
+#include "common/util/object_arena.h"
 
 namespace verible {
 
+// Persistent stack of column positions.  Copying a stack is O(1): copies
+// share all of their entries, and a push links a new entry to the previous
+// top, leaving other copies unchanged.  The storage of each entry is supplied
+// by the caller, and must outlive every stack that refers to it.
+class WrapColumnStack {
+ public:
+  struct Entry {
+    int column = 0;
+    const Entry *below = nullptr;
+    size_t depth = 0;  // number of entries including this one
+  };
+
+  bool empty() const { return top_ == nullptr; }
+
+  size_t size() const { return top_ ? top_->depth : 0; }
+
+  int top() const { return ABSL_DIE_IF_NULL(top_)->column; }
+
+  // Pushes 'column' using 'storage' for the new entry.
+  void push(int column, Entry *storage) {
+    *storage = Entry{column, top_, size() + 1};
+    top_ = storage;
+  }
+
+  void pop() { top_ = ABSL_DIE_IF_NULL(top_)->below; }
+
+ private:
+  const Entry *top_ = nullptr;
+};
+
 // A StateNode is used to keep a formatting state as the tokens of an
 // UnwrappedLine are searched left to right.  Each StateNode represents one
 // formatting decision: wrap or not-wrap.  Each StateNode maintains a pointer
 // to its parent state, which is used for backtracking once a solution
 // is reached.  StateNode is language-agnostic.
 // StateNode is purely an implementation detail of line_wrap_searcher.cc.
+//
+// StateNodes are allocated in a StateNodeArena that is owned by one search,
+// and released all at once when the search is done.  StateNodes must not be
+// copied or moved, because their wrap column stack may refer into themselves.
 struct StateNode {
   using path_type = std::vector<PreFormatToken>;
   using range_type = container_iterator_range<path_type::const_iterator>;
 
   // The StateNode that has an edge to this StateNode, to backtrack once a final
   // state is reached.
-  std::shared_ptr<const StateNode> prev_state;
+  const StateNode *prev_state = nullptr;
 
   // Iterator range marking the unexplored decisions beyond the current token.
   // TODO(fangism): make the iterator type a template parameter.  Might help
@@ -73,9 +107,9 @@ struct StateNode {
   // These column positions correspond to either the current indentation level
   // plus wrapping or the column position of the nearest group-opening
   // delimiter.
-  // TODO(b/135730018): re-implement to minimize copying of stacks.
-  // For example, use pointer or iterator to previous stack update.
-  std::stack<int> wrap_column_positions;
+  // This is shared with the prev_state, except for at most one entry pushed
+  // by this state.
+  WrapColumnStack wrap_column_positions;
 
   // Constructor for the root node of the search path, with no parent.
   // This automatically places the first token at the beginning of a new line
@@ -87,8 +121,13 @@ struct StateNode {
   // Constructor for nodes that represent new wrap decision trees to explore.
   // 'spacing_choice' reflects the decision being explored, e.g. append, wrap,
   // preserve.
-  StateNode(const std::shared_ptr<const StateNode> &parent,
-            const BasicFormatStyle &style, SpacingDecision spacing_choice);
+  StateNode(const StateNode *parent, const BasicFormatStyle &style,
+            SpacingDecision spacing_choice);
+
+  StateNode(const StateNode &) = delete;
+  StateNode(StateNode &&) = delete;
+  StateNode &operator=(const StateNode &) = delete;
+  StateNode &operator=(StateNode &&) = delete;
 
   // Returns true when the undecided_path is empty.
   // The search is over when there are no more decisions to explore.
@@ -109,7 +148,7 @@ struct StateNode {
 
   // Returns pointer to previous state before this decision node.
   // This functions as a forward-iterator going up the state ancestry chain.
-  const StateNode *next() const { return prev_state.get(); }
+  const StateNode *next() const { return prev_state; }
 
   // Returns true if this state was initialized with an unwrapped line and
   // has no parent state.
@@ -122,22 +161,23 @@ struct StateNode {
     const auto *iter = this;
     while (!iter->IsRootState()) {
       ++depth;
-      iter = iter->prev_state.get();
+      iter = iter->prev_state;
     }
     return depth;
   }
 
   // Produce next state by appending a token if the result stays under the
   // column limit, or breaking onto a new line if required.
-  static std::shared_ptr<const StateNode> AppendIfItFits(
-      const std::shared_ptr<const StateNode> &current_state,
-      const BasicFormatStyle &style);
+  // New states are allocated in 'arena'.
+  static const StateNode *AppendIfItFits(const StateNode *current_state,
+                                         const BasicFormatStyle &style,
+                                         ObjectArena<StateNode> *arena);
 
   // Repeatedly apply AppendIfItFits() until Done() with formatting.
   // TODO(b/134711965): We may want a variant that preserves spaces too.
-  static std::shared_ptr<const StateNode> QuickFinish(
-      const std::shared_ptr<const StateNode> &current_state,
-      const BasicFormatStyle &style);
+  static const StateNode *QuickFinish(const StateNode *current_state,
+                                      const BasicFormatStyle &style,
+                                      ObjectArena<StateNode> *arena);
 
   // Comparator provides an ordering of which paths should be explored
   // when maintained in a priority queue.  For Dijsktra-style algorithms,
@@ -167,8 +207,16 @@ struct StateNode {
   void UpdateCumulativeCost(const BasicFormatStyle &, int column_for_penalty);
   void OpenGroupBalance(const BasicFormatStyle &);
   void CloseGroupBalance();
+  void PushWrapColumn(int column);
+
+  // Storage for the one wrap column stack entry this state may push.
+  WrapColumnStack::Entry pushed_wrap_column_;
+  bool pushed_wrap_column_used_ = false;
 };
 
+// Owns all StateNodes of one line wrap search.
+using StateNodeArena = ObjectArena<StateNode>;
+
 // Human-readable representation for debugging only.
 std::ostream &operator<<(std::ostream &, const StateNode &);
 
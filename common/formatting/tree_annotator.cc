@@ -14,6 +14,8 @@
 
 #include "common/formatting/tree_annotator.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <vector>
 
@@ -38,17 +40,25 @@ class TreeAnnotator : public TreeContextVisitor {
   TreeAnnotator(const Symbol *syntax_tree_root, const TokenInfo &eof_token,
                 std::vector<PreFormatToken>::iterator tokens_begin,
                 std::vector<PreFormatToken>::iterator tokens_end,
-                const ContextTokenAnnotatorFunction &annotator)
+                const ContextTokenAnnotatorFunction &annotator,
+                bool skip_leading_leaves = false)
       : eof_token_(eof_token),
         syntax_tree_root_(syntax_tree_root),
         token_annotator_(annotator),
         next_filtered_token_(tokens_begin),
-        end_filtered_token_(tokens_end) {}
+        end_filtered_token_(tokens_end),
+        skip_leaves_before_(skip_leading_leaves && tokens_begin != tokens_end
+                                ? tokens_begin->token->text().begin()
+                                : nullptr) {}
 
   void Annotate();
 
  private:                           // methods
-  using TreeContextVisitor::Visit;  // for SyntaxTreeNode
+  void Visit(const SyntaxTreeNode &node) final {
+    TreeContextVisitor::Visit(node);
+    // 'node' has been popped off of the context.
+    shared_context_depth_ = std::min(shared_context_depth_, Context().size());
+  }
   void Visit(const SyntaxTreeLeaf &leaf) final {
     CatchUpToCurrentLeaf(leaf.get());
   }
@@ -79,9 +89,18 @@ class TreeAnnotator : public TreeContextVisitor {
   // Pointer to end() of preformatted_tokens.
   const std::vector<PreFormatToken>::iterator end_filtered_token_;
 
+  // When annotating a sub-range of the token stream, leaves whose text
+  // starts before this only contribute their context.
+  const char *const skip_leaves_before_;
+
   // Copy of current_context_ that is saved for use as a left-token's context
   // passed into the token_annotator_ function.
   SyntaxTreeContext saved_left_context_;
+
+  // Lowest depth of current_context_ since saved_left_context_ was last
+  // updated.  Ancestors up to this depth are still the same in both, so
+  // only the ones above it need to be re-copied at the next leaf.
+  size_t shared_context_depth_ = 0;
 };
 
 void TreeAnnotator::Annotate() {
@@ -107,9 +126,13 @@ void TreeAnnotator::CatchUpToCurrentLeaf(const TokenInfo &leaf_token) {
   // so we need to compare a unique property instead of address.
   // The very last token (before end_filtered_token) is an EOF token,
   // which doesn't need to be annotated.
-  // TODO(fangism): efficiently compute greatest-common-ancestor between
-  // left- and right- context.  Ideally this should be memo-ized as the
-  // traversal occurs, to avoid any unnecessary (linear) searches.
+  if (std::distance(next_filtered_token_, end_filtered_token_) <= 1) return;
+  if (skip_leaves_before_ != nullptr &&
+      leaf_token.text().begin() < skip_leaves_before_) {
+    saved_left_context_.AssignSharingPrefix(Context(), shared_context_depth_);
+    shared_context_depth_ = Context().size();
+    return;
+  }
   while (std::distance(next_filtered_token_, end_filtered_token_) > 1 &&
          // compare const char* addresses:
          next_filtered_token_->token->text().begin() !=
@@ -120,9 +143,10 @@ void TreeAnnotator::CatchUpToCurrentLeaf(const TokenInfo &leaf_token) {
     token_annotator_(left_token, &right_token, saved_left_context_, Context());
   }
   // next_filtered_token_ now points to leaf_token, now caught up.
-  // TODO(fangism): This costs an entire vector/stack-copy for every leaf token.
-  // May need to choose a different structure for SyntaxTreeContext.
-  saved_left_context_ = Context();
+  // Over the whole traversal, this copies each ancestor once per time it is
+  // pushed, instead of the entire context for every leaf token.
+  saved_left_context_.AssignSharingPrefix(Context(), shared_context_depth_);
+  shared_context_depth_ = Context().size();
 }
 
 }  // namespace
@@ -137,4 +161,22 @@ void AnnotateFormatTokensUsingSyntaxContext(
   t.Annotate();
 }
 
+void AnnotateFormatTokensUsingSyntaxContext(
+    const Symbol *syntax_tree_root, const TokenInfo &eof_token,
+    std::vector<PreFormatToken>::iterator tokens_begin,
+    std::vector<PreFormatToken>::iterator annotate_begin,
+    std::vector<PreFormatToken>::iterator annotate_end,
+    const ContextTokenAnnotatorFunction &annotator) {
+  if (annotate_begin == annotate_end) return;
+  if (annotate_begin == tokens_begin) {
+    // The first token has no left token, and is never annotated.
+    ++annotate_begin;
+    if (annotate_begin == annotate_end) return;
+  }
+  // Start from the left token of the first annotated one.
+  TreeAnnotator t(syntax_tree_root, eof_token, std::prev(annotate_begin),
+                  annotate_end, annotator, /*skip_leading_leaves=*/true);
+  t.Annotate();
+}
+
 }  // namespace verible
@@ -40,6 +40,17 @@ void AnnotateFormatTokensUsingSyntaxContext(
     std::vector<PreFormatToken>::iterator tokens_end,
     const ContextTokenAnnotatorFunction &annotator);
 
+// Same as above, but only annotates the tokens in [annotate_begin,
+// annotate_end), a sub-range of the token stream that starts at
+// 'tokens_begin'.  The tokens are passed the same contexts as when the whole
+// stream is annotated, and all tokens' text must point into the same buffer.
+void AnnotateFormatTokensUsingSyntaxContext(
+    const Symbol *syntax_tree_root, const TokenInfo &eof_token,
+    std::vector<PreFormatToken>::iterator tokens_begin,
+    std::vector<PreFormatToken>::iterator annotate_begin,
+    std::vector<PreFormatToken>::iterator annotate_end,
+    const ContextTokenAnnotatorFunction &annotator);
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_FORMATTING_TREE_ANNOTATOR_H_
@@ -14,6 +14,9 @@
 
 #include "common/formatting/tree_annotator.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -229,5 +232,65 @@ TEST(AnnotateFormatTokensUsingSyntaxContextTest, VerifySlidingContexts) {
                   V({6, 8}), V({6, 8}), V({6, 9}), V()));
 }
 
+TEST(AnnotateFormatTokensUsingSyntaxContextTest, SubRangeSameContexts) {
+  const absl::string_view text("abcdefgh");
+  const TokenInfo tokens[] = {
+      {4, text.substr(0, 1)}, {5, text.substr(1, 1)},
+      {6, text.substr(2, 1)}, {4, text.substr(3, 1)},
+      {5, text.substr(4, 1)}, {6, text.substr(5, 1)},
+      {4, text.substr(6, 1)}, {verible::TK_EOF, text.substr(7, 0)},  // EOF
+  };
+  // tokens[3] and tokens[5] are not in the tree, like comments.
+  const auto tree = TNode(6,                      // synthesized syntax tree
+                          TNode(7,                //
+                                Leaf(tokens[0]),  //
+                                TNode(10,         //
+                                      Leaf(tokens[1])),  //
+                                TNode(11,                //
+                                      Leaf(tokens[2]))   //
+                                ),                       //
+                          TNode(8,                       //
+                                Leaf(tokens[4])),        //
+                          TNode(9, Leaf(tokens[6]))      //
+  );
+  using V = std::vector<int>;
+  using Contexts = std::vector<std::pair<V, V>>;
+  const auto annotate = [&](size_t begin, size_t end) {
+    std::vector<PreFormatToken> ftokens;
+    for (const auto &t : tokens) {
+      ftokens.emplace_back(&t);
+    }
+    Contexts contexts(ftokens.size());
+    auto context_listener = [&](const PreFormatToken &, PreFormatToken *right,
+                                const SyntaxTreeContext &left_context,
+                                const SyntaxTreeContext &right_context) {
+      contexts[right->token - tokens] = {
+          ExtractSyntaxTreeContextEnums(left_context),
+          ExtractSyntaxTreeContextEnums(right_context)};
+      right->before.spaces_required = kForcedSpaces;
+    };
+    AnnotateFormatTokensUsingSyntaxContext(
+        &*tree, tokens[7], ftokens.begin(), ftokens.begin() + begin,
+        ftokens.begin() + end, context_listener);
+    for (size_t i = 0; i < ftokens.size(); ++i) {
+      const bool annotated = i > 0 && i >= begin && i < end;
+      EXPECT_EQ(ftokens[i].before.spaces_required,
+                annotated ? kForcedSpaces : 0)
+          << "token " << i << " of [" << begin << ", " << end << ")";
+    }
+    return contexts;
+  };
+  const Contexts all = annotate(0, 8);
+  for (size_t begin = 0; begin <= 8; ++begin) {
+    for (size_t end = begin; end <= 8; ++end) {
+      const Contexts some = annotate(begin, end);
+      for (size_t i = std::max<size_t>(begin, 1); i < end; ++i) {
+        EXPECT_EQ(some[i], all[i])
+            << "token " << i << " of [" << begin << ", " << end << ")";
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace verible
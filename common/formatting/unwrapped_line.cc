@@ -30,7 +30,6 @@
 #include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
 #include "common/util/container_iterator_range.h"
-#include "common/util/iterator_range.h"
 #include "common/util/logging.h"
 #include "common/util/spacer.h"
 
@@ -120,29 +119,8 @@ FormattedExcerpt::FormattedExcerpt(const UnwrappedLine &uwline)
 std::ostream &FormattedExcerpt::FormattedText(
     std::ostream &stream, bool indent,
     const std::function<bool(const TokenInfo &)> &include_token_p) const {
-  if (tokens_.empty()) return stream;
-  // Let caller print the preceding/trailing newline.
-  if (indent) {
-    if (tokens_.front().before.action != SpacingDecision::kPreserve) {
-      stream << Spacer(IndentationSpaces());
-    }
-  }
-  // We do not want the indentation before the first token, if it was
-  // already handled separately.
-  const auto &front = tokens_.front();
-  if (include_token_p(*front.token)) {
-    VLOG(2) << "action: " << front.before.action;
-    if (indent && front.before.action == SpacingDecision::kAlign) {
-      // When aligning tokens, the first token might be further indented.
-      stream << Spacer(front.before.spaces) << front.token->text();
-    } else {
-      stream << front.token->text();
-    }
-  }
-  for (const auto &ftoken :
-       verible::make_range(tokens_.begin() + 1, tokens_.end())) {
-    if (include_token_p(*ftoken.token)) stream << ftoken;
-  }
+  StreamTextSink sink(&stream);
+  AppendFormattedText(&sink, indent, include_token_p);
   return stream;
 }
 
@@ -233,6 +233,32 @@ class FormattedExcerpt {
       const std::function<bool(const TokenInfo&)>& include_token_p =
           [](const TokenInfo&) { return true; }) const;
 
+  // Passes the same text as FormattedText() to "sink", in pieces, as
+  // FormattedToken::AppendFormattedText() does.  "include_token_p" can be
+  // any callable, so it is not called through a std::function.
+  template <class Sink, class IncludeTokenPredicate>
+  void AppendFormattedText(Sink* sink, bool indent,
+                           IncludeTokenPredicate&& include_token_p) const {
+    if (tokens_.empty()) return;
+    // Let caller print the preceding/trailing newline.
+    const FormattedToken& front = tokens_.front();
+    if (indent && front.before.action != SpacingDecision::kPreserve) {
+      sink->Append(Spacer(IndentationSpaces()));
+    }
+    // We do not want the indentation before the first token, if it was
+    // already handled separately.
+    if (include_token_p(*front.token)) {
+      if (indent && front.before.action == SpacingDecision::kAlign) {
+        // When aligning tokens, the first token might be further indented.
+        sink->Append(Spacer(front.before.spaces));
+      }
+      sink->Append(front.token->text());
+    }
+    for (auto iter = tokens_.begin() + 1; iter != tokens_.end(); ++iter) {
+      if (include_token_p(*iter->token)) iter->AppendFormattedText(sink);
+    }
+  }
+
   // Returns formatted code as a string.
   std::string Render() const;
 
@@ -32,8 +32,12 @@
 #ifndef VERIBLE_COMMON_LEXER_FLEX_LEXER_ADAPTER_H_
 #define VERIBLE_COMMON_LEXER_FLEX_LEXER_ADAPTER_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <sstream>  // IWYU pragma: keep  // for ostringstream
+#include <streambuf>
 #include <string>
 
 #include "absl/log/check.h"
@@ -51,13 +55,22 @@ namespace verible {
 // ordered before "L" in FlexLexerAdaptor's base classes.
 class CodeStreamHolder {
  protected:
-  // The stream object conforms to the FlexLexer input interface.
-  // Even though scanning is done on the stream's internal copy of the input
-  // string, the byte offsets being tracked can be used to construct
-  // string_views based on the original string's start address.
-  // Using the standard istream interface also lets us switch buffers, e.g.
-  // during preprocessing.
-  std::istringstream code_stream_;
+  // Read-only stream buffer over the original text, so that the text is not
+  // copied (which matters for very large inputs).
+  class CodeBuffer : public std::streambuf {
+   public:
+    void Reset(absl::string_view code) {
+      // The get area is never written to.
+      char *begin = const_cast<char *>(code.data());
+      setg(begin, begin, begin + code.size());
+    }
+  };
+
+  CodeBuffer code_buffer_;
+  // The stream object conforms to the FlexLexer input interface.  Flex reads
+  // its input with FlexLexerAdapter::LexerInput(), which copies the original
+  // string directly, but the stream is still what flex's buffers refer to.
+  std::istream code_stream_{&code_buffer_};
 };
 
 // L is a (flex-generated) yyFlexLexer-like class.
@@ -69,8 +82,8 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
         code_(code),
         // last_token_ points to the beginning of the code_ buffer
         last_token_(0 /* enum doesn't matter */, code_.substr(0, 0)) {
-    code_stream_.str(std::string(code));
-    // istringstream copies text into its own internal buffer.
+    code_buffer_.Reset(code_);
+    ReserveInputBuffer(code_);
   }
 
   // Returns the token associated with the last UpdateLocation() call.
@@ -83,8 +96,10 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
       // "fatal flex scanner internal error--end of buffer missed"
       last_token_ = TokenInfo::EOFToken(code_);
     } else {
-      // In normal operation, call yylex() to extract the next token.
-      last_token_.set_token_enum(this->yylex());
+      // In normal operation, call yylex() to extract the next token, unless
+      // a fast path already did.
+      const int fast_token = FastScanToken();
+      last_token_.set_token_enum(fast_token != 0 ? fast_token : this->yylex());
     }
     // yylex has already called UpdateLocation()
     return last_token_;
@@ -94,6 +109,48 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
   // Must be called by subclasses to update location of the current token.
   void UpdateLocation() { last_token_.AdvanceText(this->YYLeng()); }
 
+  // Subclasses may scan common tokens with hand-written code that is faster
+  // than the generated state machine, using BufferedInput() and
+  // ConsumeBufferedInput().  Returns the enum of the token consumed this way,
+  // or 0 to let yylex() scan the next token.
+  virtual int FastScanToken() { return 0; }
+
+  // Returns the position of the next character in flex's input buffer, or
+  // nullptr when a fast path cannot be used: before scanning started, in start
+  // conditions other than INITIAL, and while yymore() is pending.
+  // Flex terminates the buffered input with NUL characters, so fast paths must
+  // leave tokens that reach a NUL character to yylex(), which knows whether
+  // that is the end of the buffer, the end of the input, or part of it.
+  const char *BufferedInput() {
+    // yy_start encodes the start condition, INITIAL is 1 (see BEGIN).
+    if (L::yy_c_buf_p == nullptr || L::yy_start != 1 || L::yy_more_flag) {
+      return nullptr;
+    }
+    // In between tokens, the character after the last token is replaced with
+    // NUL, and saved in yy_hold_char.
+    *L::yy_c_buf_p = L::yy_hold_char;
+    return L::yy_c_buf_p;
+  }
+
+  // Makes the next 'length' characters at BufferedInput() the current token,
+  // as if a rule had matched them and called UpdateLocation().  These must
+  // not include NUL characters.
+  void ConsumeBufferedInput(int length) {
+    L::yytext = L::yy_c_buf_p;
+    L::yyleng = length;
+    L::yy_c_buf_p += length;
+    L::yy_hold_char = *L::yy_c_buf_p;
+    *L::yy_c_buf_p = '\0';
+    UpdateLocation();
+  }
+
+  // Returns true when no start condition is in effect other than INITIAL,
+  // as it is before the first token of the input.
+  bool InInitialStartCondition() const {
+    // yy_start is 0 until the first yylex() call sets it to INITIAL (1).
+    return L::yy_start <= 1 && L::yy_start_stack_ptr == 0;
+  }
+
   // EOF needs special handling because yyleng is set to include a terminating
   // \0 (NUL) character.  Once EOF is encountered it is also not possible to
   // yyless-rewind the window -- doing so messes up the internal state machine,
@@ -108,16 +165,21 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
   }
 
   // Restart lexer by pointing to new input stream, and reset all state.
+  // Restarting a lexer is cheaper than constructing a new one, as flex's
+  // buffers are kept if they are large enough.
   void Restart(absl::string_view code) override {  // not yet final
     at_eof_ = false;
     code_ = code;
-    code_stream_.str(std::string(code_));
+    input_offset_ = 0;
+    code_buffer_.Reset(code_);
+    code_stream_.clear();
     last_token_ = TokenInfo(0, code_.substr(0, 0));
 
     // Reset buffer stack.
     while (L::yy_buffer_stack_top > 1) {  // Keep bottom buffer only.
       L::yypop_buffer_state();
     }
+    ReserveInputBuffer(code_);
 
     // Reset the current buffer to use new stream.
     L::yyrestart(&code_stream_);
@@ -128,6 +190,18 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
     }
   }
 
+  // Overrides yyFlexLexer's implementation, which reads from the input
+  // stream, to copy the next part of the text straight into flex's buffer.
+  // Flex needs a writable buffer with NUL sentinels after the buffered input,
+  // so it cannot scan the (read-only) text in place.
+  int LexerInput(char *buf, int max_size) final {
+    const size_t size =
+        std::min<size_t>(max_size, code_.size() - input_offset_);
+    memcpy(buf, code_.data() + input_offset_, size);
+    input_offset_ += size;
+    return static_cast<int>(size);
+  }
+
   // Overrides yyFlexLexer's implementation to handle unrecognized chars.
   void LexerOutput(const char *buf, int size) final {
     VLOG(1) << "LexerOutput: rejected text: \"" << std::string(buf, size)
@@ -149,9 +223,36 @@ class FlexLexerAdapter : private CodeStreamHolder, protected L, public Lexer {
   }
 
  private:
+  // Flex's default input buffer size (YY_BUF_SIZE).
+  static constexpr int kDefaultInputBufferSize = 16384;
+
+  // Makes sure that flex's input buffer can hold all of "code" if it is
+  // shorter than the default buffer size, and whatever fits otherwise.
+  // Short texts, like macro bodies, get a buffer of their size, so that they
+  // are read in one go without allocating the default buffer; a buffer that
+  // is already large enough is kept.
+  void ReserveInputBuffer(absl::string_view code) {
+    // Room for the input and flex's end-of-input marker.
+    const int size = static_cast<int>(
+        std::min<size_t>(code.size() + 2, kDefaultInputBufferSize));
+    if (input_buffer_size_ >= size) return;
+    auto *const previous = L::yy_buffer_stack != nullptr
+                               ? L::yy_buffer_stack[L::yy_buffer_stack_top]
+                               : nullptr;
+    L::yy_switch_to_buffer(L::yy_create_buffer(&code_stream_, size));
+    if (previous != nullptr) L::yy_delete_buffer(previous);
+    input_buffer_size_ = size;
+  }
+
   // A read-only view of the entire text to be scanned.
   absl::string_view code_;
 
+  // Offset of the text not yet copied to flex's buffer by LexerInput().
+  size_t input_offset_ = 0;
+
+  // Size of the current input buffer, or 0 as long as flex has none.
+  int input_buffer_size_ = 0;
+
   // Contains the enumeration and the substring slice of the last lexed token.
   TokenInfo last_token_;
 
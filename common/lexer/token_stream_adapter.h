@@ -40,15 +40,32 @@ absl::Status MakeTokenSequence(
 
 // Generic container-to-iterator-generator adapter.
 // Once the end is reached, keep returning the end iterator.
+// Unlike the std::function returned by MakeConstIteratorStreamer(), calls
+// can be inlined, so this is preferred in per-token loops.
+// The container has to outlive this object.
+template <class Container>
+class ConstIteratorStreamer {
+ public:
+  using const_iterator = typename Container::const_iterator;
+
+  explicit ConstIteratorStreamer(const Container &c)
+      : iter_(c.begin()), end_(c.end()) {}
+
+  const_iterator operator()() { return (iter_ != end_) ? iter_++ : end_; }
+
+  const_iterator end() const { return end_; }
+
+ private:
+  const_iterator iter_;
+  const_iterator end_;
+};
+
+// Type-erased ConstIteratorStreamer.
 template <class Container>
 std::function<typename Container::const_iterator()> MakeConstIteratorStreamer(
     const Container &c) {
-  auto iter = c.begin();
-  const auto end = c.end();
-  return [=]() mutable {
-    // Retain iterator state between calls (mutable lambda).
-    return (iter != end) ? iter++ : end;
-  };
+  // Retain iterator state between calls.
+  return ConstIteratorStreamer<Container>(c);
 }
 
 // Creates a TokenInfo generator from a sequence of TokenInfo.
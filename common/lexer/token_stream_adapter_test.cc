@@ -15,6 +15,7 @@
 #include "common/lexer/token_stream_adapter.h"
 
 #include <initializer_list>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -60,6 +61,16 @@ TEST(MakeTokenGeneratorTest, Generate) {
   // cannot call this generator any further after an EOF
 }
 
+TEST(ConstIteratorStreamerTest, StreamsThenRepeatsEnd) {
+  const std::vector<int> values{3, 4};
+  ConstIteratorStreamer<std::vector<int>> streamer(values);
+  EXPECT_EQ(streamer(), values.begin());
+  EXPECT_EQ(streamer(), values.begin() + 1);
+  EXPECT_EQ(streamer(), values.end());
+  EXPECT_EQ(streamer(), values.end());
+  EXPECT_EQ(streamer.end(), values.end());
+}
+
 TEST(MakeTokenSequenceTest, Sequencer) {
   FakeTokenSequenceLexer lexer;
   constexpr absl::string_view text("abcxyz");
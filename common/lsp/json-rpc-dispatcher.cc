@@ -15,54 +15,88 @@
 #include "common/lsp/json-rpc-dispatcher.h"
 
 #include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/lsp/latency-histogram.h"
 #include "common/util/logging.h"
+#include "common/util/thread_pool.h"
 #include "nlohmann/json.hpp"
 
 namespace verible {
 namespace lsp {
+// Methods/Notifications without parameters can also send nothing for "params".
+// Make sure we handle that gracefully. (e.g. "shutdown" method call).
+static const nlohmann::json &ExtractParams(const nlohmann::json &request) {
+  static const nlohmann::json empty_params = nlohmann::json::object();
+  auto found = request.find("params");
+  return found != request.end() ? *found : empty_params;
+}
+
 void JsonRpcDispatcher::DispatchMessage(absl::string_view data) {
+  const absl::Time start = absl::Now();
+  for (const auto &[method, handler] : raw_notifications_) {
+    // Cheap pre-filter; the handler checks if it is really the method called.
+    if (!absl::StrContains(data, absl::StrCat("\"", method, "\""))) continue;
+    if (handler(data)) {
+      VLOG(1) << "Got raw notification '" << method
+              << "'; req-size: " << data.size();
+      CountStatistic(method + "  ev");
+      RecordLatency(method, start, nullptr, data);
+      return;
+    }
+  }
+
   nlohmann::json request;
   try {
     request = nlohmann::json::parse(data);
   } catch (const std::exception &e) {
-    ++statistic_counters_[e.what()];
-    ++exception_count_;
+    CountException(e.what());
     SendReply(CreateError(request, kParseError, e.what()));
     return;
   }
 
   if (request.find("method") == request.end()) {
+    // Responses to our own requests are not answered, and not needed.
+    if (request.find("id") != request.end() &&
+        (request.find("result") != request.end() ||
+         request.find("error") != request.end())) {
+      CountStatistic("Response from client");
+      return;
+    }
     SendReply(
         CreateError(request, kMethodNotFound, "Method required in request"));
-    ++statistic_counters_["Request without method"];
+    CountStatistic("Request without method");
     return;
   }
   const std::string &method = request["method"];
 
-  // Direct dispatch, later maybe send to an executor that returns futures ?
   const bool is_notification = (request.find("id") == request.end());
   VLOG(1) << "Got " << (is_notification ? "notification" : "method call")
           << " '" << method << "'; req-size: " << data.size();
   bool handled = false;
-  if (is_notification) {
+  if (is_notification && method == "$/cancelRequest") {
+    handled = CancelRequest(ExtractParams(request));
+  } else if (is_notification) {
     handled = CallNotification(request, method);
   } else {
     handled = CallRequestHandler(request, method);
   }
-  ++statistic_counters_[method + (handled ? "" : " (unhandled)") +
-                        (is_notification ? "  ev" : " RPC")];
+  CountStatistic(method + (handled ? "" : " (unhandled)") +
+                 (is_notification ? "  ev" : " RPC"));
 }
 
-// Methods/Notifications without parameters can also send nothing for "params".
-// Make sure we handle that gracefully. (e.g. "shutdown" method call).
-static const nlohmann::json &ExtractParams(const nlohmann::json &request) {
-  static const nlohmann::json empty_params = nlohmann::json::object();
-  auto found = request.find("params");
-  return found != request.end() ? *found : empty_params;
+void JsonRpcDispatcher::WaitForPendingRequests() {
+  std::unique_lock<std::mutex> l(mutex_);
+  requests_done_.wait(l, [this]() { return active_requests_ == 0; });
 }
 
 bool JsonRpcDispatcher::CallNotification(const nlohmann::json &req,
@@ -73,12 +107,13 @@ bool JsonRpcDispatcher::CallNotification(const nlohmann::json &req,
     return false;
   }
   const auto &fun_to_call = found->second;
+  const absl::Time start = absl::Now();
   try {
     fun_to_call(ExtractParams(req));
+    RecordLatency(method, start, req);
     return true;
   } catch (const std::exception &e) {
-    ++exception_count_;
-    ++statistic_counters_[method + " : " + e.what()];
+    CountException(method + " : " + e.what());
     LOG(ERROR) << "Notification error for '" << method << "' :" << e.what();
   }
   return false;
@@ -88,24 +123,148 @@ bool JsonRpcDispatcher::CallRequestHandler(const nlohmann::json &req,
                                            const std::string &method) {
   const auto &found = handlers_.find(method);
   if (found == handlers_.end()) {
+    const auto &concurrent = concurrent_handlers_.find(method);
+    if (concurrent != concurrent_handlers_.end()) {
+      return CallConcurrentRequestHandler(req, method, concurrent->second);
+    }
     SendReply(CreateError(req, kMethodNotFound,
                           "method '" + method + "' not found."));
     LOG(ERROR) << "Unhandled method '" << method << "'";
     return false;
   }
   const auto &fun_to_call = found->second;
+  const absl::Time start = absl::Now();
   try {
     SendReply(MakeResponse(req, fun_to_call(ExtractParams(req))));
+    RecordLatency(method, start, req);
     return true;
   } catch (const std::exception &e) {
-    ++exception_count_;
-    ++statistic_counters_[method + " : " + e.what()];
+    CountException(method + " : " + e.what());
+    SendReply(CreateError(req, kInternalError, e.what()));
+    LOG(ERROR) << "Method error for '" << method << "' :" << e.what();
+  }
+  return false;
+}
+
+bool JsonRpcDispatcher::CallConcurrentRequestHandler(
+    const nlohmann::json &req, const std::string &method,
+    const RPCConcurrentCallHandler &fun) {
+  const absl::Time start = absl::Now();
+  RPCDeferredCall call;
+  try {
+    call = fun(ExtractParams(req));
+  } catch (const std::exception &e) {
+    CountException(method + " : " + e.what());
     SendReply(CreateError(req, kInternalError, e.what()));
     LOG(ERROR) << "Method error for '" << method << "' :" << e.what();
+    return false;
+  }
+  if (executor_ == nullptr) {
+    const bool success = ComputeAndReply(req, method, call, nullptr);
+    if (success) RecordLatency(method, start, req);
+    return success;
+  }
+
+  const std::string id = req["id"].dump();
+  auto pending = std::make_shared<PendingRequest>();
+  {
+    const std::lock_guard<std::mutex> l(mutex_);
+    pending_requests_[id] = pending;
+    ++active_requests_;
+  }
+  const std::function<bool()> job = [this, req, method, call, id, pending,
+                                     start]() {
+    const bool success = ComputeAndReply(req, method, call, pending.get());
+    if (success) RecordLatency(method, start, req);
+    const std::lock_guard<std::mutex> l(mutex_);
+    auto found = pending_requests_.find(id);
+    // A re-used id might already belong to a newer request.
+    if (found != pending_requests_.end() && found->second == pending) {
+      pending_requests_.erase(found);
+    }
+    if (--active_requests_ == 0) requests_done_.notify_all();
+    return success;
+  };
+  (void)executor_->ExecAsync(job);
+  return true;
+}
+
+bool JsonRpcDispatcher::ComputeAndReply(const nlohmann::json &req,
+                                        const std::string &method,
+                                        const RPCDeferredCall &call,
+                                        const PendingRequest *pending) {
+  const auto is_cancelled = [pending]() {
+    return pending != nullptr && pending->cancelled;
+  };
+  if (!is_cancelled()) {
+    try {
+      nlohmann::json result = call();
+      // Don't send a result the client is not interested in anymore.
+      if (!is_cancelled()) {
+        SendReply(MakeResponse(req, result));
+        return true;
+      }
+    } catch (const std::exception &e) {
+      CountException(method + " : " + e.what());
+      SendReply(CreateError(req, kInternalError, e.what()));
+      LOG(ERROR) << "Method error for '" << method << "' :" << e.what();
+      return false;
+    }
   }
+  CountStatistic(method + " (cancelled)");
+  SendReply(CreateError(req, kRequestCancelled, "Request cancelled"));
   return false;
 }
 
+bool JsonRpcDispatcher::CancelRequest(const nlohmann::json &params) {
+  const auto id = params.find("id");
+  if (id == params.end()) return false;
+  const std::lock_guard<std::mutex> l(mutex_);
+  const auto found = pending_requests_.find(id->dump());
+  if (found == pending_requests_.end()) return false;  // Already answered.
+  found->second->cancelled = true;
+  return true;
+}
+
+void JsonRpcDispatcher::CountStatistic(const std::string &counter) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  ++statistic_counters_[counter];
+}
+
+void JsonRpcDispatcher::RecordLatency(const std::string &method,
+                                      absl::Time start,
+                                      const nlohmann::json &request,
+                                      absl::string_view raw_message) {
+  const absl::Duration duration = absl::Now() - start;
+  {
+    const std::lock_guard<std::mutex> l(mutex_);
+    latencies_[method].Add(duration);
+  }
+  if (!slow_request_fun_ || duration < slow_request_threshold_) return;
+  if (!request.is_null()) {
+    slow_request_fun_(method, ExtractParams(request), duration);
+    return;
+  }
+  // Raw notifications are only parsed when they are reported.
+  const nlohmann::json parsed =
+      nlohmann::json::parse(raw_message, nullptr, /*allow_exceptions=*/false);
+  slow_request_fun_(method,
+                    parsed.is_object() ? ExtractParams(parsed)
+                                       : nlohmann::json::object(),
+                    duration);
+}
+
+JsonRpcDispatcher::LatencyMap JsonRpcDispatcher::GetLatencies() const {
+  const std::lock_guard<std::mutex> l(mutex_);
+  return latencies_;
+}
+
+void JsonRpcDispatcher::CountException(const std::string &counter) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  ++statistic_counters_[counter];
+  ++exception_count_;
+}
+
 void JsonRpcDispatcher::SendNotification(const std::string &method,
                                          const nlohmann::json &notification) {
   nlohmann::json result = {{"jsonrpc", "2.0"}};
@@ -114,6 +273,15 @@ void JsonRpcDispatcher::SendNotification(const std::string &method,
   SendReply(result);
 }
 
+void JsonRpcDispatcher::SendRequest(const std::string &method,
+                                    const nlohmann::json &request_params) {
+  nlohmann::json request = {{"jsonrpc", "2.0"}};
+  request["id"] = ++last_sent_request_id_;
+  request["method"] = method;
+  request["params"] = request_params;
+  SendReply(request);
+}
+
 /*static*/ nlohmann::json JsonRpcDispatcher::CreateError(
     const nlohmann::json &request, int code, absl::string_view message) {
   nlohmann::json result = {
@@ -144,6 +312,7 @@ void JsonRpcDispatcher::SendNotification(const std::string &method,
 void JsonRpcDispatcher::SendReply(const nlohmann::json &response) {
   std::stringstream out_bytes;
   out_bytes << response << "\n";
+  const std::lock_guard<std::mutex> l(write_mutex_);
   write_fun_(out_bytes.str());
 }
 }  // namespace lsp
@@ -15,16 +15,24 @@
 #ifndef VERIBLE_COMMON_LSP_JSON_RPC_DISPATCHER_H
 #define VERIBLE_COMMON_LSP_JSON_RPC_DISPATCHER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "common/lsp/latency-histogram.h"
 #include "nlohmann/json.hpp"
 
 namespace verible {
+class ThreadPool;
+
 namespace lsp {
 // A Dispatcher that is fed JSON as string, parses them to json objects and
 // dispatches the contained method call to pre-registered handlers.
@@ -49,8 +57,16 @@ namespace lsp {
 //                               return doSomething(p);
 //                             });
 //
+// Request handlers that only need a snapshot of some state can be registered
+// with AddConcurrentRequestHandler(); with an executor set (SetExecutor()),
+// their responses are computed on the executor so that slow requests don't
+// hold up the processing of following messages. Requests still pending
+// can then be cancelled by the client with a "$/cancelRequest"
+// notification [3].
+//
 // [1]: https://www.jsonrpc.org/specification
 // [2]: https://github.com/hzeller/jcxxgen
+// [3]: https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#cancelRequest
 class JsonRpcDispatcher {
  public:
   // Magic constants defined in https://www.jsonrpc.org/specification
@@ -58,14 +74,32 @@ class JsonRpcDispatcher {
   static constexpr int kMethodNotFound = -32601;
   static constexpr int kInternalError = -32603;
 
+  // Error code defined by the language server protocol for requests that
+  // were cancelled by the client.
+  static constexpr int kRequestCancelled = -32800;
+
   // A notification receives a request, but does not return anything
   using RPCNotification = std::function<void(const nlohmann::json &r)>;
 
+  // A raw notification handler receives the whole unparsed message. It
+  // returns true if it handled the message, false to leave it to the regular
+  // handling (in which case it must not have had any side effects).
+  using RawNotification = std::function<bool(absl::string_view message)>;
+
   // A RPC call receives a request and returns a response.
   // If we ever have a meaningful set of error conditions to convey, maybe
   // change this to absl::StatusOr<nlohmann::json> as return value.
   using RPCCallHandler = std::function<nlohmann::json(const nlohmann::json &)>;
 
+  // A concurrent RPC call is answered in two steps: the handler receives the
+  // request on the thread calling DispatchMessage() and returns a
+  // RPCDeferredCall that computes the response, possibly on another thread.
+  // So the handler should capture everything the computation needs, e.g.
+  // shared pointers to immutable snapshots of the state to be queried.
+  using RPCDeferredCall = std::function<nlohmann::json()>;
+  using RPCConcurrentCallHandler =
+      std::function<RPCDeferredCall(const nlohmann::json &)>;
+
   // A function of type WriteFun is called by the dispatcher to send the
   // string-formatted json response. The user of the JsonRpcDispatcher then
   // can wire that to the underlying transport.
@@ -74,6 +108,16 @@ class JsonRpcDispatcher {
   // Some statistical counters of method calls or exceptions encountered.
   using StatsMap = std::map<std::string, int>;
 
+  // Durations of the handling of requests and notifications, by method.
+  using LatencyMap = std::map<std::string, LatencyHistogram>;
+
+  // Receives a request or notification that took at least the threshold
+  // given to SetSlowRequestHandler(), with its parameters.  Called on the
+  // thread that handled it.
+  using SlowRequestFun =
+      std::function<void(const std::string &method,
+                         const nlohmann::json &params, absl::Duration)>;
+
   // Responses are written using the "out" write function.
   explicit JsonRpcDispatcher(WriteFun out) : write_fun_(std::move(out)) {}
   JsonRpcDispatcher(const JsonRpcDispatcher &) = delete;
@@ -82,9 +126,19 @@ class JsonRpcDispatcher {
   // Returns successful registration, false if that name is already registered.
   bool AddRequestHandler(const std::string &method_name,
                          const RPCCallHandler &fun) {
+    if (concurrent_handlers_.count(method_name)) return false;
     return handlers_.insert({method_name, fun}).second;
   }
 
+  // Add a request handler for RPC calls whose response is computed by the
+  // returned RPCDeferredCall, on the executor if one is set.
+  // Returns successful registration, false if that name is already registered.
+  bool AddConcurrentRequestHandler(const std::string &method_name,
+                                   const RPCConcurrentCallHandler &fun) {
+    if (handlers_.count(method_name)) return false;
+    return concurrent_handlers_.insert({method_name, fun}).second;
+  }
+
   // Add a request handler for RPC Notifications, that are receive-only events.
   // Returns successful registration, false if that name is already registered.
   bool AddNotificationHandler(const std::string &method_name,
@@ -92,20 +146,62 @@ class JsonRpcDispatcher {
     return notifications_.insert({method_name, fun}).second;
   }
 
+  // Add a handler for RPC Notifications that is offered messages mentioning
+  // "method_name" before they are parsed, e.g. to extract large payloads
+  // without the cost of building a json object first.
+  // Returns successful registration, false if that name is already registered.
+  bool AddRawNotificationHandler(const std::string &method_name,
+                                 const RawNotification &fun) {
+    return raw_notifications_.insert({method_name, fun}).second;
+  }
+
   // Dispatch incoming message, a string view with json data.
   // Call this with the content of exactly one message.
   // If this is an RPC call, response will call WriteFun.
+  // Responses of concurrent request handlers might be written after this
+  // returns if an executor is set.
   void DispatchMessage(absl::string_view data);
 
+  // Compute the responses of concurrent request handlers on "executor"
+  // instead of synchronously in DispatchMessage(). These responses are
+  // written from the executor in the order they are finished; all calls to
+  // the WriteFun are serialized.
+  // With nullptr (the default), all requests are answered synchronously.
+  // The "executor" must outlive all pending requests.
+  void SetExecutor(verible::ThreadPool *executor) { executor_ = executor; }
+
+  // Block until all requests passed to the executor are answered.
+  void WaitForPendingRequests();
+
   // Send a notification to the client side. Parameters will be wrapped
   // in a JSON-RPC message and pushed out to the WriteFun
   void SendNotification(const std::string &method,
                         const nlohmann::json &notification_params);
 
+  // Send a request to the client side, e.g. to create a progress token.
+  // Its response is not of interest: responses from the client are counted
+  // in the statistics but otherwise ignored.
+  void SendRequest(const std::string &method,
+                   const nlohmann::json &request_params);
+
   // Get some human-readable statistical counters of methods called
   // and exception messages encountered.
+  // Only stable while no requests are pending on the executor.
   const StatsMap &GetStatCounters() const { return statistic_counters_; }
 
+  // Returns a copy of the durations of the handled calls by method: from
+  // their dispatch until their handler returned, or for concurrent
+  // requests, until their response was written.
+  LatencyMap GetLatencies() const;
+
+  // Calls "fun" with every call whose handling took at least "threshold".
+  // Set this up before dispatching messages.
+  void SetSlowRequestHandler(absl::Duration threshold,
+                             const SlowRequestFun &fun) {
+    slow_request_threshold_ = threshold;
+    slow_request_fun_ = fun;
+  }
+
   // Number of exceptions that have been dealt with and turned into error
   // messages or ignored depending on the context.
   // The counters returned by GetStatsCounters() will report counts by
@@ -113,8 +209,36 @@ class JsonRpcDispatcher {
   int exception_count() const { return exception_count_; }
 
  private:
+  // A request handed to the executor, which has not been answered yet.
+  struct PendingRequest {
+    std::atomic<bool> cancelled{false};
+  };
+
   bool CallNotification(const nlohmann::json &req, const std::string &method);
   bool CallRequestHandler(const nlohmann::json &req, const std::string &method);
+  bool CallConcurrentRequestHandler(const nlohmann::json &req,
+                                    const std::string &method,
+                                    const RPCConcurrentCallHandler &fun);
+
+  // Compute the response with "call" and send it, unless "pending" (if not
+  // null) was cancelled in the meantime.
+  bool ComputeAndReply(const nlohmann::json &req, const std::string &method,
+                       const RPCDeferredCall &call,
+                       const PendingRequest *pending);
+
+  // Handle a "$/cancelRequest" notification. Returns if the request to be
+  // cancelled was still pending.
+  bool CancelRequest(const nlohmann::json &params);
+
+  void CountStatistic(const std::string &counter);
+
+  // Accounts a call to "method" handled since "start"; "request" is only
+  // used to report it if it was slow.  Takes the unparsed "raw_message"
+  // instead if "request" is null.
+  void RecordLatency(const std::string &method, absl::Time start,
+                     const nlohmann::json &request,
+                     absl::string_view raw_message = {});
+  void CountException(const std::string &counter);
   void SendReply(const nlohmann::json &response);
 
   static nlohmann::json CreateError(const nlohmann::json &request, int code,
@@ -123,11 +247,31 @@ class JsonRpcDispatcher {
                                      const nlohmann::json &call_result);
 
   const WriteFun write_fun_;
+  std::mutex write_mutex_;  // Serializes calls to write_fun_.
 
   std::unordered_map<std::string, RPCCallHandler> handlers_;
+  std::unordered_map<std::string, RPCConcurrentCallHandler>
+      concurrent_handlers_;
   std::unordered_map<std::string, RPCNotification> notifications_;
+  std::map<std::string, RawNotification> raw_notifications_;
+
+  verible::ThreadPool *executor_ = nullptr;
+
+  absl::Duration slow_request_threshold_;
+  SlowRequestFun slow_request_fun_;
+
+  std::atomic<int> last_sent_request_id_{0};  // Of requests to the client.
+
+  // Guards the following fields, which are modified from the executor.
+  mutable std::mutex mutex_;
   int exception_count_ = 0;
   StatsMap statistic_counters_;
+  LatencyMap latencies_;
+  // Requests on the executor by their serialized id.
+  std::unordered_map<std::string, std::shared_ptr<PendingRequest>>
+      pending_requests_;
+  int active_requests_ = 0;
+  std::condition_variable requests_done_;
 };
 }  // namespace lsp
 }  // namespace verible
@@ -14,11 +14,18 @@
 
 #include "common/lsp/json-rpc-dispatcher.h"
 
+#include <future>
 #include <iostream>
+#include <map>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/util/thread_pool.h"
 #include "gtest/gtest.h"
 #include "nlohmann/json.hpp"
 
@@ -146,6 +153,41 @@ TEST(JsonRpcDispatcherTest, CallNotification_MissingMethodImplemented) {
   EXPECT_EQ(dispatcher.exception_count(), 0);
 }
 
+TEST(JsonRpcDispatcherTest, CallRawNotification) {
+  int raw_fun_called = 0;
+  int notification_fun_called = 0;
+  bool raw_fun_accepts = true;
+
+  JsonRpcDispatcher dispatcher([&](absl::string_view s) {
+    ADD_FAILURE() << "Notifications don't send responses " << s;
+  });
+  dispatcher.AddNotificationHandler(
+      "foo", [&](const json &j) { ++notification_fun_called; });
+  EXPECT_TRUE(
+      dispatcher.AddRawNotificationHandler("foo", [&](absl::string_view s) {
+        ++raw_fun_called;
+        return raw_fun_accepts;
+      }));
+
+  static constexpr absl::string_view kFoo =
+      R"({"jsonrpc":"2.0","method":"foo","params":{"hello":"world"}})";
+  dispatcher.DispatchMessage(kFoo);
+  EXPECT_EQ(raw_fun_called, 1);
+  EXPECT_EQ(notification_fun_called, 0);
+
+  // Not accepted raw messages go the regular way.
+  raw_fun_accepts = false;
+  dispatcher.DispatchMessage(kFoo);
+  EXPECT_EQ(raw_fun_called, 2);
+  EXPECT_EQ(notification_fun_called, 1);
+
+  // Messages not mentioning the method are not even offered.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"bar","params":{"hello":"world"}})");
+  EXPECT_EQ(raw_fun_called, 2);
+  EXPECT_EQ(dispatcher.GetStatCounters().at("foo  ev"), 2);
+}
+
 TEST(JsonRpcDispatcherTest, CallRpcHandler) {
   int write_fun_called = 0;
   int rpc_fun_called = 0;
@@ -244,6 +286,152 @@ TEST(JsonRpcDispatcherTest, CallRpcHandler_MissingMethodImplemented) {
   EXPECT_EQ(dispatcher.exception_count(), 0);
 }
 
+TEST(JsonRpcDispatcherTest, CallConcurrentRpcHandler_Synchronous) {
+  int write_fun_called = 0;
+  int rpc_fun_called = 0;
+  int deferred_call_called = 0;
+
+  JsonRpcDispatcher dispatcher([&](absl::string_view s) {
+    const json j = json::parse(s);
+    EXPECT_EQ(std::string(j["result"]["some"]), "world");
+    EXPECT_TRUE(j.find("error") == j.end());
+    ++write_fun_called;
+  });
+  const bool registered = dispatcher.AddConcurrentRequestHandler(
+      "foo", [&](const json &j) -> JsonRpcDispatcher::RPCDeferredCall {
+        ++rpc_fun_called;
+        const std::string captured = j["hello"];
+        return [&, captured]() -> json {
+          ++deferred_call_called;
+          return {{"some", captured}};
+        };
+      });
+  EXPECT_TRUE(registered);
+
+  // The names are shared with regular request handlers.
+  EXPECT_FALSE(dispatcher.AddRequestHandler(
+      "foo", [](const json &j) -> json { return nullptr; }));
+  EXPECT_TRUE(dispatcher.AddRequestHandler(
+      "bar", [](const json &j) -> json { return nullptr; }));
+  EXPECT_FALSE(dispatcher.AddConcurrentRequestHandler(
+      "bar", [](const json &j) -> JsonRpcDispatcher::RPCDeferredCall {
+        return []() -> json { return nullptr; };
+      }));
+
+  // Without executor, the response is sent right away.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","id":1,"method":"foo","params":{"hello":"world"}})");
+
+  EXPECT_EQ(rpc_fun_called, 1);
+  EXPECT_EQ(deferred_call_called, 1);
+  EXPECT_EQ(write_fun_called, 1);
+  EXPECT_EQ(dispatcher.exception_count(), 0);
+}
+
+TEST(JsonRpcDispatcherTest, CallConcurrentRpcHandler_OnExecutor) {
+  static constexpr int kRequests = 20;
+  verible::ThreadPool pool(4);
+  std::map<int, int> responses;  // id -> result
+
+  JsonRpcDispatcher dispatcher([&](absl::string_view s) {
+    const json j = json::parse(s);
+    EXPECT_TRUE(j.find("error") == j.end()) << s;
+    responses[j["id"]] = j["result"];  // Writes are serialized.
+  });
+  dispatcher.SetExecutor(&pool);
+  dispatcher.AddConcurrentRequestHandler(
+      "square", [](const json &j) -> JsonRpcDispatcher::RPCDeferredCall {
+        const int value = j["value"];
+        return [value]() -> json { return value * value; };
+      });
+
+  for (int i = 0; i < kRequests; ++i) {
+    const json request = {{"jsonrpc", "2.0"},
+                          {"id", i},
+                          {"method", "square"},
+                          {"params", {{"value", i}}}};
+    dispatcher.DispatchMessage(request.dump());
+  }
+  dispatcher.WaitForPendingRequests();
+
+  ASSERT_EQ(responses.size(), kRequests);
+  for (int i = 0; i < kRequests; ++i) {
+    EXPECT_EQ(responses[i], i * i);
+  }
+  EXPECT_EQ(dispatcher.exception_count(), 0);
+}
+
+TEST(JsonRpcDispatcherTest, CallConcurrentRpcHandler_ReportInternalError) {
+  verible::ThreadPool pool(2);
+  int write_fun_called = 0;
+
+  JsonRpcDispatcher dispatcher([&](absl::string_view s) {
+    const json j = json::parse(s);
+    EXPECT_EQ(j["error"]["code"], JsonRpcDispatcher::kInternalError) << s;
+    ++write_fun_called;
+  });
+  dispatcher.SetExecutor(&pool);
+  dispatcher.AddConcurrentRequestHandler(
+      "foo", [](const json &j) -> JsonRpcDispatcher::RPCDeferredCall {
+        return []() -> json { throw std::runtime_error("Houston"); };
+      });
+
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"foo"})");
+  dispatcher.WaitForPendingRequests();
+
+  EXPECT_EQ(write_fun_called, 1);
+  EXPECT_EQ(dispatcher.exception_count(), 1);
+}
+
+TEST(JsonRpcDispatcherTest, CancelPendingRequests) {
+  verible::ThreadPool pool(1);  // Requests are answered one at a time.
+  std::map<int, json> responses;
+  int deferred_call_called = 0;
+
+  JsonRpcDispatcher dispatcher([&](absl::string_view s) {
+    const json j = json::parse(s);
+    responses[j["id"]] = j;
+  });
+  dispatcher.SetExecutor(&pool);
+
+  std::promise<void> release_blocker;
+  std::shared_future<void> blocker = release_blocker.get_future().share();
+  dispatcher.AddConcurrentRequestHandler(
+      "block", [&](const json &j) -> JsonRpcDispatcher::RPCDeferredCall {
+        return [&, blocker]() -> json {
+          ++deferred_call_called;
+          blocker.wait();
+          return "done";
+        };
+      });
+
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"block"})");
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":2,"method":"block"})");
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":3,"method":"block"})");
+
+  // Request 2 is still queued behind the first one, never computed.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":2}})");
+  // Cancelling something unknown is benign.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":42}})");
+  release_blocker.set_value();
+  dispatcher.WaitForPendingRequests();
+
+  ASSERT_EQ(responses.size(), 3);
+  EXPECT_EQ(responses[1]["result"], "done");
+  EXPECT_EQ(responses[2]["error"]["code"],
+            JsonRpcDispatcher::kRequestCancelled);
+  EXPECT_EQ(responses[3]["result"], "done");
+  EXPECT_EQ(deferred_call_called, 2);
+  EXPECT_EQ(dispatcher.exception_count(), 0);
+
+  // Already answered requests can't be cancelled anymore.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":1}})");
+  EXPECT_EQ(responses.size(), 3);
+}
+
 TEST(JsonRpcDispatcherTest, SendNotificationToClient) {
   int write_fun_called = 0;
   JsonRpcDispatcher dispatcher([&](absl::string_view s) {
@@ -257,5 +445,65 @@ TEST(JsonRpcDispatcherTest, SendNotificationToClient) {
   dispatcher.SendNotification("greeting_method", params);
   EXPECT_EQ(1, write_fun_called);
 }
+
+TEST(JsonRpcDispatcherTest, SendRequestToClientAndIgnoreResponse) {
+  std::vector<json> written;
+  JsonRpcDispatcher dispatcher(
+      [&](absl::string_view s) { written.push_back(json::parse(s)); });
+
+  dispatcher.SendRequest("window/workDoneProgress/create", {{"token", "t"}});
+  dispatcher.SendRequest("window/workDoneProgress/create", {{"token", "u"}});
+  ASSERT_EQ(written.size(), 2);
+  EXPECT_EQ(written[0]["method"], "window/workDoneProgress/create");
+  EXPECT_EQ(written[0]["params"]["token"], "t");
+  ASSERT_TRUE(written[0].contains("id"));
+  ASSERT_TRUE(written[1].contains("id"));
+  EXPECT_NE(written[0]["id"], written[1]["id"]);
+
+  // The client responses are not answered as erroneous requests.
+  dispatcher.DispatchMessage(
+      absl::StrCat(R"({"jsonrpc":"2.0","result":null,"id":)",
+                   written[0]["id"].dump(), "}"));
+  dispatcher.DispatchMessage(absl::StrCat(
+      R"({"jsonrpc":"2.0","error":{"code":-32603,"message":"no"},"id":)",
+      written[1]["id"].dump(), "}"));
+  EXPECT_EQ(written.size(), 2);
+  EXPECT_EQ(dispatcher.GetStatCounters().at("Response from client"), 2);
+  EXPECT_EQ(dispatcher.exception_count(), 0);
+}
+
+TEST(JsonRpcDispatcherTest, LatenciesAndSlowRequests) {
+  JsonRpcDispatcher dispatcher([](absl::string_view) {});
+  dispatcher.AddRequestHandler("fast", [](const json &) { return json(); });
+  dispatcher.AddRequestHandler("slow", [](const json &) {
+    absl::SleepFor(absl::Milliseconds(20));
+    return json();
+  });
+  dispatcher.AddRawNotificationHandler("raw", [](absl::string_view) {
+    absl::SleepFor(absl::Milliseconds(20));
+    return true;
+  });
+  std::vector<std::string> slow_uris;
+  dispatcher.SetSlowRequestHandler(
+      absl::Milliseconds(10),
+      [&](const std::string &method, const json &params, absl::Duration d) {
+        EXPECT_GE(d, absl::Milliseconds(10));
+        slow_uris.push_back(absl::StrCat(method, " ", params.value("uri", "")));
+      });
+
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"fast"})");
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":2,"method":"fast"})");
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","id":3,"method":"slow","params":{"uri":"a.sv"}})");
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"raw","params":{"uri":"b.sv"}})");
+
+  const JsonRpcDispatcher::LatencyMap latencies = dispatcher.GetLatencies();
+  EXPECT_EQ(latencies.at("fast").count(), 2);
+  EXPECT_EQ(latencies.at("slow").count(), 1);
+  EXPECT_GE(latencies.at("slow").max(), absl::Milliseconds(20));
+  EXPECT_EQ(latencies.at("raw").count(), 1);
+  EXPECT_EQ(slow_uris, (std::vector<std::string>{"slow a.sv", "raw b.sv"}));
+}
 }  // namespace lsp
 }  // namespace verible
@@ -0,0 +1,68 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/lsp/latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+
+namespace verible {
+namespace lsp {
+void LatencyHistogram::Add(absl::Duration duration) {
+  duration = std::max(duration, absl::ZeroDuration());
+  const double micros = absl::ToDoubleMicroseconds(duration);
+  const size_t bucket =
+      micros <= 1.0
+          ? 0
+          : static_cast<size_t>(std::ceil(std::log2(micros) *
+                                          kBucketsPerDoubling));
+  if (bucket >= buckets_.size()) buckets_.resize(bucket + 1);
+  ++buckets_[bucket];
+  ++count_;
+  total_ += duration;
+  max_ = std::max(max_, duration);
+}
+
+absl::Duration LatencyHistogram::Quantile(double quantile) const {
+  if (count_ == 0) return absl::ZeroDuration();
+  // Number of durations at or below the quantile, at least one.
+  const int rank = std::max(1, static_cast<int>(std::ceil(quantile * count_)));
+  int seen = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      const absl::Duration bound = absl::Microseconds(
+          std::exp2(static_cast<double>(i) / kBucketsPerDoubling));
+      return std::min(bound, max_);
+    }
+  }
+  return max_;
+}
+
+nlohmann::json LatencyHistogram::ToJson() const {
+  return {
+      {"count", count_},
+      {"total_ms", absl::ToDoubleMilliseconds(total_)},
+      {"p50_ms", absl::ToDoubleMilliseconds(Quantile(0.5))},
+      {"p90_ms", absl::ToDoubleMilliseconds(Quantile(0.9))},
+      {"p99_ms", absl::ToDoubleMilliseconds(Quantile(0.99))},
+      {"max_ms", absl::ToDoubleMilliseconds(max_)},
+  };
+}
+}  // namespace lsp
+}  // namespace verible
@@ -0,0 +1,57 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_LSP_LATENCY_HISTOGRAM_H
+#define VERIBLE_COMMON_LSP_LATENCY_HISTOGRAM_H
+
+#include <vector>
+
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+
+namespace verible {
+namespace lsp {
+// Distribution of the durations of some operation, like the handling of a
+// request, in logarithmic buckets: quantiles are estimated within a fifth of
+// their value, in constant memory however many durations are added.
+// This class is not thread-safe.
+class LatencyHistogram {
+ public:
+  void Add(absl::Duration duration);
+
+  int count() const { return count_; }
+  absl::Duration total() const { return total_; }
+  absl::Duration max() const { return max_; }
+
+  // Returns an upper bound of the duration below which the fraction
+  // 'quantile' (0..1) of the added durations are, or zero if there are
+  // none.
+  absl::Duration Quantile(double quantile) const;
+
+  // Returns count, total, p50, p90, p99 and max, durations in milliseconds.
+  nlohmann::json ToJson() const;
+
+ private:
+  // Bucket i counts the durations up to 2^(i / kBucketsPerDoubling)
+  // microseconds.
+  static constexpr int kBucketsPerDoubling = 4;
+
+  std::vector<int> buckets_;
+  int count_ = 0;
+  absl::Duration total_;
+  absl::Duration max_;
+};
+}  // namespace lsp
+}  // namespace verible
+#endif  // VERIBLE_COMMON_LSP_LATENCY_HISTOGRAM_H
@@ -0,0 +1,67 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/lsp/latency-histogram.h"
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
+
+namespace verible {
+namespace lsp {
+namespace {
+TEST(LatencyHistogramTest, Empty) {
+  const LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.Quantile(0.5), absl::ZeroDuration());
+  EXPECT_EQ(histogram.ToJson()["count"], 0);
+}
+
+TEST(LatencyHistogramTest, QuantilesWithinBucketWidth) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; ++i) histogram.Add(absl::Milliseconds(i));
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_EQ(histogram.max(), absl::Milliseconds(1000));
+  EXPECT_EQ(histogram.total(), absl::Milliseconds(500500));
+  for (const double quantile : {0.5, 0.9, 0.99}) {
+    const double expected_ms = quantile * 1000;
+    const double estimate_ms =
+        absl::ToDoubleMilliseconds(histogram.Quantile(quantile));
+    EXPECT_GE(estimate_ms, expected_ms) << quantile;
+    EXPECT_LE(estimate_ms, expected_ms * 1.2) << quantile;
+  }
+  // Never above the largest duration.
+  EXPECT_EQ(histogram.Quantile(1.0), absl::Milliseconds(1000));
+}
+
+TEST(LatencyHistogramTest, TinyAndNegativeDurations) {
+  LatencyHistogram histogram;
+  histogram.Add(absl::Nanoseconds(10));
+  histogram.Add(-absl::Seconds(1));
+  EXPECT_EQ(histogram.count(), 2);
+  EXPECT_LE(histogram.Quantile(1.0), absl::Microseconds(1));
+}
+
+TEST(LatencyHistogramTest, ToJson) {
+  LatencyHistogram histogram;
+  histogram.Add(absl::Milliseconds(2));
+  const nlohmann::json json = histogram.ToJson();
+  EXPECT_EQ(json["count"], 1);
+  EXPECT_DOUBLE_EQ(json["total_ms"].get<double>(), 2.0);
+  EXPECT_DOUBLE_EQ(json["p99_ms"].get<double>(), 2.0);
+  EXPECT_DOUBLE_EQ(json["max_ms"].get<double>(), 2.0);
+}
+}  // namespace
+}  // namespace lsp
+}  // namespace verible
@@ -35,6 +35,20 @@ inline constexpr bool operator==(const Position &a, const Position &b) {
   return a.line == b.line && a.character == b.character;
 }
 
+inline constexpr bool operator==(const Range &a, const Range &b) {
+  return a.start == b.start && a.end == b.end;
+}
+
+// Diagnostics are equal if they would be presented the same way.
+inline bool operator==(const Diagnostic &a, const Diagnostic &b) {
+  return a.range == b.range && a.has_severity == b.has_severity &&
+         (!a.has_severity || a.severity == b.severity) &&
+         a.source == b.source && a.message == b.message;
+}
+inline bool operator!=(const Diagnostic &a, const Diagnostic &b) {
+  return !(a == b);
+}
+
 // Ranges overlap if some part of one is inside the other range.
 // Also empty ranges are considered overlapping if their start point is within
 // the other range.
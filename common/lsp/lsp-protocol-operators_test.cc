@@ -165,5 +165,28 @@ TEST(LspPositionTest, CompletelyOutsideRange) {
   EXPECT_FALSE(rangeOverlap(outside_range, large_range));
   EXPECT_FALSE(rangeOverlap(large_range, outside_range));
 }
+
+TEST(LspDiagnosticTest, Equality) {
+  const Diagnostic diagnostic = {
+      .range = {.start = {.line = 1, .character = 2},
+                .end = {.line = 1, .character = 5}},
+      .severity = 1,
+      .has_severity = true,
+      .message = "Bad things",
+  };
+  EXPECT_EQ(diagnostic, diagnostic);
+
+  Diagnostic other_range = diagnostic;
+  other_range.range.end.character = 6;
+  EXPECT_NE(diagnostic, other_range);
+
+  Diagnostic other_severity = diagnostic;
+  other_severity.severity = 2;
+  EXPECT_NE(diagnostic, other_severity);
+
+  Diagnostic other_message = diagnostic;
+  other_message.message = "Good things";
+  EXPECT_NE(diagnostic, other_message);
+}
 }  // namespace lsp
 }  // namespace verible
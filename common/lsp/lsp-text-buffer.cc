@@ -14,16 +14,22 @@
 
 #include "common/lsp/lsp-text-buffer.h"
 
-#include <numeric>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "absl/strings/str_cat.h"
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/lsp/json-rpc-dispatcher.h"
 #include "common/lsp/lsp-protocol.h"
+#include "common/strings/mem_block.h"
+#include "common/strings/text_rope.h"
 #include "common/strings/utf8.h"
+#include "nlohmann/json.hpp"
 
 namespace verible {
 namespace lsp {
@@ -36,100 +42,233 @@ void EditTextBuffer::ApplyChanges(
   for (const auto &c : cc) ApplyChange(c);
 }
 
-bool EditTextBuffer::ApplyChange(const TextDocumentContentChangeEvent &c) {
-  if (!c.has_range) {
-    ReplaceDocument(c.text);
-    return true;
+size_t EditTextBuffer::lines() const {
+  const size_t newlines = content_.newlines();
+  if (content_.empty() || content_.LineStart(newlines) == content_.size()) {
+    return newlines;  // Empty, or ends with a newline.
   }
+  return newlines + 1;
+}
 
-  if (c.range.end.line >= static_cast<int>(lines_.size())) {
-    lines_.emplace_back(new std::string(""));
-  }
+void EditTextBuffer::LineRange(int line, size_t *begin, size_t *end) const {
+  if (line < 0) line = 0;
+  *begin = content_.LineStart(line);
+  // The next line starts after our newline, unless there is none.
+  *end = (static_cast<size_t>(line) < content_.newlines())
+             ? content_.LineStart(line + 1) - 1
+             : content_.size();
+}
 
-  if (c.range.start.line == c.range.end.line &&
-      c.text.find_first_of('\n') == std::string::npos) {
-    return LineEdit(c, lines_[c.range.start.line].get());  // simple case.
-  }
-  return MultiLineEdit(c);
+size_t EditTextBuffer::PositionOffset(const Position &position,
+                                      bool *clipped) const {
+  size_t begin;
+  size_t end;
+  LineRange(position.line, &begin, &end);
+  const int character = std::max(position.character, 0);
+  const std::string line = content_.Substr(begin, end - begin);
+  *clipped = character > utf8_len(line);
+  return begin + line.length() - utf8_substr(line, character).length();
 }
 
-/*static*/ EditTextBuffer::LineVector EditTextBuffer::GenerateLines(
-    absl::string_view content) {
-  LineVector result;
-  for (const absl::string_view s : absl::StrSplit(content, '\n')) {
-    result.emplace_back(new std::string(s));
-    result.back()->append("\n");
+void EditTextBuffer::RangeOffsets(const Range &range, size_t *begin,
+                                  bool *begin_clipped, size_t *end,
+                                  bool *end_clipped) const {
+  if (range.start.line != range.end.line) {
+    *begin = PositionOffset(range.start, begin_clipped);
+    *end = PositionOffset(range.end, end_clipped);
+    return;
   }
+  size_t line_begin;
+  size_t line_end;
+  LineRange(range.start.line, &line_begin, &line_end);
+  const std::string line = content_.Substr(line_begin, line_end - line_begin);
+  const int length = utf8_len(line);
+  const int start = std::max(range.start.character, 0);
+  const int finish = std::max(range.end.character, 0);
+  const bool ordered = start <= finish;
+  const std::vector<size_t> offsets = utf8_byte_offsets(
+      line, {ordered ? start : finish, ordered ? finish : start});
+  *begin = line_begin + offsets[ordered ? 0 : 1];
+  *end = line_begin + offsets[ordered ? 1 : 0];
+  *begin_clipped = start > length;
+  *end_clipped = finish > length;
+}
 
-  // Files that do or do not have a newline file-ending: represent correctly.
-  if (!content.empty() && content.back() == '\n') {
-    result.pop_back();
-  } else {
-    result.back()->pop_back();
+// Return success (might not if input out of range)
+bool EditTextBuffer::ApplyChange(const TextDocumentContentChangeEvent &c) {
+  if (!c.has_range) {
+    ReplaceDocument(c.text);
+    last_edit_line_ = -1;
+    return true;
   }
 
-  return result;
+  size_t begin;
+  size_t end;
+  bool start_clipped;
+  bool end_clipped;
+  RangeOffsets(c.range, &begin, &start_clipped, &end, &end_clipped);
+  const bool single_line_edit = c.range.start.line == c.range.end.line &&
+                                c.text.find_first_of('\n') == std::string::npos;
+  // An edit within a line needs to start within that line, while its end
+  // may be overlong.
+  if (single_line_edit && start_clipped) return false;
+  if (end < begin) return false;
+  Replace(begin, end, c.text);
+  last_edit_line_ = c.range.start.line;
+  return true;
 }
 
 void EditTextBuffer::ReplaceDocument(absl::string_view content) {
-  document_length_ = content.length();
-  if (content.empty()) return;
-  lines_ = GenerateLines(content);
+  Replace(0, content_.size(), content);
 }
 
-// Return success (might not if input out of range)
-bool EditTextBuffer::LineEdit(const TextDocumentContentChangeEvent &c,
-                              std::string *str) {
-  int end_char = c.range.end.character;
-
-  int str_end = utf8_len(*str);
-  if (!str->empty() && str->back() == '\n') --str_end;
-
-  if (c.range.start.character > str_end) return false;
-  if (end_char > str_end) end_char = str_end;
-  if (end_char < c.range.start.character) return false;
-
-  document_length_ -= str->length();
-  const absl::string_view assembly = *str;
-  const auto before = utf8_substr(assembly, 0, c.range.start.character);
-  const auto after = utf8_substr(assembly, end_char);
-  *str = absl::StrCat(before, c.text, after);
-  document_length_ += str->length();
-  return true;
+void EditTextBuffer::Replace(size_t begin, size_t end, absl::string_view text) {
+  content_.Replace(begin, end - begin, text);
+  snapshot_.reset();
 }
 
-// Returns success (always succeeds);
-bool EditTextBuffer::MultiLineEdit(const TextDocumentContentChangeEvent &c) {
-  const absl::string_view start_line = *lines_[c.range.start.line];
-  const auto before = utf8_substr(start_line, 0, c.range.start.character);
-
-  const absl::string_view end_line = *lines_[c.range.end.line];
-  const auto after = utf8_substr(end_line, c.range.end.character);
-
-  // Assemble the full content to replace the range of lines with including
-  // the parts that come from the first and last line to be edited.
-  const std::string new_content = absl::StrCat(before, c.text, after);
-
-  // Content length update: substract all the bytes that were in the old
-  // content and add all in the new content.
-  const auto before_begin = lines_.begin() + c.range.start.line;
-  const auto before_end = lines_.begin() + c.range.end.line + 1;
-  document_length_ -=
-      std::accumulate(before_begin, before_end, 0,
-                      [](int sum, const LineVector::value_type &line) {
-                        return sum + line->length();
-                      });
-  document_length_ += new_content.length();
-
-  // The new content might include newlines, yielding multiple single lines.
-  LineVector regenerated_lines = GenerateLines(new_content);
-
-  // Update the affected lines. Probably not the most optimal but good enough
-  lines_.erase(before_begin, before_end);
-  lines_.insert(lines_.begin() + c.range.start.line, regenerated_lines.begin(),
-                regenerated_lines.end());
-  return true;
-}
+namespace {
+// Extracts the parameters of textDocument/didOpen and didChange notifications
+// from a message while it is parsed, without building a json object first.
+// The document text is moved out of the parser, so it is only copied once
+// when unescaping it from the message.
+class TextDocumentNotificationParser
+    : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  // Parse "message"; returns false if it is not a well-formed notification
+  // of one of the two methods.
+  bool Parse(absl::string_view message) {
+    if (!nlohmann::json::sax_parse(message.begin(), message.end(), this)) {
+      return false;
+    }
+    if (has_id_ || !has_uri_) return false;
+    if (method_ == "textDocument/didOpen") return has_text_;
+    if (method_ != "textDocument/didChange") return false;
+    for (const ChangeFields &fields : change_fields_) {
+      if (!fields.text || (fields.range && fields.positions != 4)) {
+        return false;  // Leave incomplete changes to the regular handler.
+      }
+    }
+    return !change_fields_.empty();
+  }
+
+  const std::string &method() const { return method_; }
+  DidOpenTextDocumentParams &open_params() { return open_; }
+  DidChangeTextDocumentParams &change_params() { return change_; }
+
+  bool null() final { return true; }
+  bool boolean(bool) final { return true; }
+  bool number_integer(number_integer_t value) final {
+    return Integer(value);
+  }
+  bool number_unsigned(number_unsigned_t value) final {
+    return Integer(value);
+  }
+  bool number_float(number_float_t, const string_t &) final {
+    return !At({"params", "contentChanges", "[]", "range", "*", "*"});
+  }
+  bool string(string_t &value) final {
+    if (At({"method"})) {
+      method_ = value;
+    } else if (At({"params", "textDocument", "uri"})) {
+      open_.textDocument.uri = value;
+      change_.textDocument.uri = std::move(value);
+      has_uri_ = true;
+    } else if (At({"params", "textDocument", "text"})) {
+      open_.textDocument.text = std::move(value);
+      has_text_ = true;
+    } else if (At({"params", "contentChanges", "[]", "text"})) {
+      change_.contentChanges.back().text = std::move(value);
+      change_fields_.back().text = true;
+    }
+    return true;
+  }
+  bool binary(binary_t &) final { return true; }
+  bool start_object(std::size_t) final {
+    if (At({"params", "contentChanges", "[]"})) {
+      change_.contentChanges.emplace_back();
+      change_fields_.emplace_back();
+    } else if (At({"params", "contentChanges", "[]", "range"})) {
+      change_.contentChanges.back().has_range = true;
+      change_fields_.back().range = true;
+    }
+    path_.emplace_back();  // Filled in by key()
+    return true;
+  }
+  bool key(string_t &value) final {
+    if (path_.size() == 1 && value == "id") has_id_ = true;
+    path_.back() = std::move(value);
+    return true;
+  }
+  bool end_object() final {
+    path_.pop_back();
+    return true;
+  }
+  bool start_array(std::size_t) final {
+    path_.emplace_back("[]");
+    return true;
+  }
+  bool end_array() final {
+    path_.pop_back();
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &) final {
+    return false;
+  }
+
+ private:
+  // Fields found of the content change event with the same index.
+  struct ChangeFields {
+    bool text = false;
+    bool range = false;
+    int positions = 0;  // line and character values found of the range.
+  };
+
+  // Returns if the current value is found at the given path of keys;
+  // "[]" stands for array elements and "*" for any key.
+  bool At(std::initializer_list<absl::string_view> keys) const {
+    if (keys.size() != path_.size()) return false;
+    auto path_it = path_.begin();
+    for (const absl::string_view key : keys) {
+      if (key != "*" && key != *path_it) return false;
+      ++path_it;
+    }
+    return true;
+  }
+
+  bool Integer(int64_t value) {
+    if (!At({"params", "contentChanges", "[]", "range", "*", "*"})) {
+      return true;
+    }
+    const absl::string_view position = path_[path_.size() - 2];
+    const absl::string_view field = path_.back();
+    Range &range = change_.contentChanges.back().range;
+    Position *const p = position == "start" ? &range.start
+                        : position == "end" ? &range.end
+                                            : nullptr;
+    if (p == nullptr) return true;
+    if (field == "line") {
+      p->line = value;
+    } else if (field == "character") {
+      p->character = value;
+    } else {
+      return true;
+    }
+    ++change_fields_.back().positions;
+    return true;
+  }
+
+  std::vector<std::string> path_;  // Keys from the message root.
+  std::string method_;
+  bool has_id_ = false;
+  bool has_uri_ = false;
+  bool has_text_ = false;
+  DidOpenTextDocumentParams open_;
+  DidChangeTextDocumentParams change_;
+  std::vector<ChangeFields> change_fields_;
+};
+}  // namespace
 
 BufferCollection::BufferCollection(JsonRpcDispatcher *dispatcher) {
   // Route notification events from the dispatcher to the buffer collection
@@ -144,6 +283,25 @@ BufferCollection::BufferCollection(JsonRpcDispatcher *dispatcher) {
   dispatcher->AddNotificationHandler(
       "textDocument/didChange",
       [this](const DidChangeTextDocumentParams &p) { didChangeEvent(p); });
+
+  // Documents are sent in full on open and often on change, so avoid
+  // going through a json object for these.
+  const auto raw_handler = [this](absl::string_view message) {
+    return HandleRawNotification(message);
+  };
+  dispatcher->AddRawNotificationHandler("textDocument/didOpen", raw_handler);
+  dispatcher->AddRawNotificationHandler("textDocument/didChange", raw_handler);
+}
+
+bool BufferCollection::HandleRawNotification(absl::string_view message) {
+  TextDocumentNotificationParser parser;
+  if (!parser.Parse(message)) return false;
+  if (parser.method() == "textDocument/didOpen") {
+    didOpenEvent(parser.open_params());
+  } else {
+    didChangeEvent(parser.change_params());
+  }
+  return true;
 }
 
 void BufferCollection::didOpenEvent(const DidOpenTextDocumentParams &o) {
@@ -176,19 +334,25 @@ void BufferCollection::didChangeEvent(const DidChangeTextDocumentParams &o) {
 }
 
 void EditTextBuffer::RequestContent(const ContentProcessFun &processor) const {
-  std::string flat_view;
-  flat_view.reserve(document_length_);
-  for (const auto &l : lines_) flat_view.append(*l);
-  processor(flat_view);
+  processor(ContentSnapshot()->AsStringView());
+}
+
+std::shared_ptr<MemBlock> EditTextBuffer::ContentSnapshot() const {
+  if (!snapshot_) {
+    snapshot_ = std::make_shared<StringMemBlock>(content_.ToString());
+  }
+  return snapshot_;
 }
 
 void EditTextBuffer::RequestLine(int line,
                                  const ContentProcessFun &processor) const {
-  if (line < 0 || line >= static_cast<int>(lines_.size())) {
+  if (line < 0 || line >= static_cast<int>(lines())) {
     processor("");
-  } else {
-    processor(*lines_[line]);
+    return;
   }
+  // Including the newline, if any.
+  const size_t begin = content_.LineStart(line);
+  processor(content_.Substr(begin, content_.LineStart(line + 1) - begin));
 }
 }  // namespace lsp
 }  // namespace verible
@@ -26,6 +26,8 @@
 #include "absl/strings/string_view.h"
 #include "common/lsp/json-rpc-dispatcher.h"
 #include "common/lsp/lsp-protocol.h"
+#include "common/strings/mem_block.h"
+#include "common/strings/text_rope.h"
 
 namespace verible {
 namespace lsp {
@@ -34,6 +36,10 @@ namespace lsp {
 // change events to keep in sync.
 // It provides ways to pass the current content to a requestor that needs to
 // process it.
+//
+// The content is kept in a rope, so edits take time logarithmic in the size
+// of the document regardless of how many lines they span.  A flat copy is
+// only made once the content is requested, and shared until the next edit.
 class EditTextBuffer {
  public:
   using ContentProcessFun = std::function<void(absl::string_view)>;
@@ -47,6 +53,12 @@ class EditTextBuffer {
   // of the call.
   void RequestContent(const ContentProcessFun &processor) const;
 
+  // Returns an immutable snapshot of the current content.  The snapshot
+  // stays valid after further edits of this buffer, so it can be handed to
+  // a parser without copying.  Consecutive calls without edits in between
+  // return the same block.
+  std::shared_ptr<MemBlock> ContentSnapshot() const;
+
   // Same as RequestContent() for a specific line.
   void RequestLine(int line, const ContentProcessFun &processor) const;
 
@@ -57,10 +69,10 @@ class EditTextBuffer {
   void ApplyChanges(const std::vector<TextDocumentContentChangeEvent> &cc);
 
   // Lines in this document.
-  size_t lines() const { return lines_.size(); }
+  size_t lines() const;
 
   // Length of document in bytes.
-  int64_t document_length() const { return document_length_; }
+  int64_t document_length() const { return content_.size(); }
 
   // Last global version number this buffer has edited from.
   int64_t last_global_version() const { return last_global_version_; }
@@ -68,19 +80,34 @@ class EditTextBuffer {
   // Set global version; this typically will be done by the BufferCollection.
   void set_last_global_version(int64_t v) { last_global_version_ = v; }
 
+  // Line where the last change applied to this buffer started, or -1 if
+  // the whole content has been replaced since (or initially).
+  int last_edit_line() const { return last_edit_line_; }
+
  private:
-  // TODO: this should be unique_ptr, but assignment in the insert() command
-  // will not work. Needs to be formulated with something something std::move ?
-  using LineVector = std::vector<std::shared_ptr<std::string>>;
+  // Returns the byte range [*begin, *end) of the given line, excluding the
+  // newline.  Lines past the end of the document are empty ranges at the
+  // document end.
+  void LineRange(int line, size_t *begin, size_t *end) const;
+
+  // Returns the byte offset of "position", with its character clipped to
+  // the end of the line.  Sets "*clipped" if that was needed.
+  size_t PositionOffset(const Position &position, bool *clipped) const;
+
+  // Like PositionOffset() for the start and end of "range", which are found
+  // in one pass over their line if they are on the same one.
+  void RangeOffsets(const Range &range, size_t *begin, bool *begin_clipped,
+                    size_t *end, bool *end_clipped) const;
 
-  static LineVector GenerateLines(absl::string_view content);
   void ReplaceDocument(absl::string_view content);
-  bool LineEdit(const TextDocumentContentChangeEvent &c, std::string *str);
-  bool MultiLineEdit(const TextDocumentContentChangeEvent &c);
+  void Replace(size_t begin, size_t end, absl::string_view text);
 
   int64_t last_global_version_ = 0;
-  int64_t document_length_ = 0;
-  LineVector lines_;
+  int last_edit_line_ = -1;
+  TextRope content_;
+
+  // Flattened content, created on demand and dropped on each edit.
+  mutable std::shared_ptr<MemBlock> snapshot_;
 };
 
 // A buffer collection keeps track of various open text buffers on the
@@ -127,6 +154,10 @@ class BufferCollection {
   size_t size() const { return buffers_.size(); }
 
  private:
+  // Handle textDocument/didOpen or didChange given as unparsed "message".
+  // Returns false if the message could not be handled this way.
+  bool HandleRawNotification(absl::string_view message);
+
   int64_t global_version_ = 0;
   UriBufferCallback change_listener_ = nullptr;
   absl::flat_hash_map<std::string, std::unique_ptr<EditTextBuffer>> buffers_;
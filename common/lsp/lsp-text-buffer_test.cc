@@ -15,12 +15,14 @@
 #include "common/lsp/lsp-text-buffer.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/lsp/json-rpc-dispatcher.h"
 #include "common/lsp/lsp-protocol.h"
+#include "common/strings/mem_block.h"
 #include "gtest/gtest.h"
 
 namespace verible {
@@ -338,6 +340,102 @@ TEST(TextBufferTest, ChangeApplyMultiLine_RemoveLines) {
   EXPECT_EQ(buffer.document_length(), 8);
 }
 
+TEST(TextBufferTest, ChangeApplyFullContent_EmptyContent) {
+  EditTextBuffer buffer("Foo\nBar\n");
+  const TextDocumentContentChangeEvent change = {
+      .range = {},
+      .has_range = false,
+      .text = "",
+  };
+  EXPECT_TRUE(buffer.ApplyChange(change));
+  EXPECT_EQ(buffer.lines(), 0);
+  EXPECT_EQ(buffer.document_length(), 0);
+}
+
+TEST(TextBufferTest, ChangeApplyMultiLine_LargeDocument) {
+  std::string content;
+  for (int i = 0; i < 10000; ++i) absl::StrAppend(&content, "line ", i, "\n");
+  EditTextBuffer buffer(content);
+  ASSERT_EQ(buffer.lines(), 10000);
+  const TextDocumentContentChangeEvent change = {
+      .range =
+          {
+              .start = {4000, 5},
+              .end = {6000, 5},
+          },
+      .has_range = true,
+      .text = "4000\nnew line\nline ",
+  };
+  EXPECT_TRUE(buffer.ApplyChange(change));
+  EXPECT_EQ(buffer.lines(), 8002);
+  buffer.RequestLine(4000, [](absl::string_view s) {  //
+    EXPECT_EQ(std::string(s), "line 4000\n");
+  });
+  buffer.RequestLine(4001, [](absl::string_view s) {  //
+    EXPECT_EQ(std::string(s), "new line\n");
+  });
+  buffer.RequestLine(4002, [](absl::string_view s) {  //
+    EXPECT_EQ(std::string(s), "line 6000\n");
+  });
+  buffer.RequestLine(8001, [](absl::string_view s) {  //
+    EXPECT_EQ(std::string(s), "line 9999\n");
+  });
+}
+
+TEST(TextBufferTest, ContentSnapshotSurvivesEdits) {
+  EditTextBuffer buffer("Hello World");
+  const std::shared_ptr<MemBlock> snapshot = buffer.ContentSnapshot();
+  EXPECT_EQ(snapshot->AsStringView(), "Hello World");
+  // Without edits, the same snapshot is handed out again.
+  EXPECT_EQ(buffer.ContentSnapshot(), snapshot);
+  buffer.RequestContent([&](absl::string_view s) {  //
+    EXPECT_EQ(s.data(), snapshot->AsStringView().data());
+  });
+
+  const TextDocumentContentChangeEvent change = {
+      .range =
+          {
+              .start = {0, 0},
+              .end = {0, 5},
+          },
+      .has_range = true,
+      .text = "Goodbye",
+  };
+  EXPECT_TRUE(buffer.ApplyChange(change));
+  EXPECT_EQ(snapshot->AsStringView(), "Hello World");
+  EXPECT_EQ(buffer.ContentSnapshot()->AsStringView(), "Goodbye World");
+}
+
+TEST(TextBufferTest, LastEditLine) {
+  EditTextBuffer buffer("Foo\nBar\nBaz\n");
+  EXPECT_EQ(buffer.last_edit_line(), -1);  // Nothing edited yet.
+
+  TextDocumentContentChangeEvent change = {
+      .range =
+          {
+              .start = {2, 1},
+              .end = {2, 2},
+          },
+      .has_range = true,
+      .text = "o",
+  };
+  EXPECT_TRUE(buffer.ApplyChange(change));
+  EXPECT_EQ(buffer.last_edit_line(), 2);
+
+  // Failed edits don't count.
+  change.range = {.start = {0, 10}, .end = {0, 10}};
+  EXPECT_FALSE(buffer.ApplyChange(change));
+  EXPECT_EQ(buffer.last_edit_line(), 2);
+
+  const TextDocumentContentChangeEvent full_change = {
+      .range = {},
+      .has_range = false,
+      .text = "Replaced",
+  };
+  EXPECT_TRUE(buffer.ApplyChange(full_change));
+  EXPECT_EQ(buffer.last_edit_line(), -1);
+}
+
 TEST(BufferCollection, SimulateDocumentLifecycleThroughRPC) {
   // Let's walk a BufferCollection through the lifecycle of a document
   // by sending it the JSON RPC notifications for open, change and close.
@@ -425,5 +523,70 @@ TEST(BufferCollection, SimulateDocumentLifecycleThroughRPC) {
   EXPECT_EQ(change_callback_called, 3);
 }
 
+TEST(BufferCollection, DocumentNotificationsWithoutJsonObject) {
+  // didOpen and didChange are handled without building a json object;
+  // check that the extracted content is the same.
+  JsonRpcDispatcher rpc_dispatcher([](absl::string_view) {});
+  BufferCollection collection(&rpc_dispatcher);
+  std::string content;
+  collection.SetChangeListener(
+      [&](const std::string &uri, const EditTextBuffer *buffer) {
+        EXPECT_EQ(uri, "file:///foo.sv");
+        buffer->RequestContent(
+            [&](absl::string_view s) { content = std::string(s); });
+      });
+
+  // Keys in unusual order, escaped characters in the text.
+  rpc_dispatcher.DispatchMessage(R"({
+    "params":{
+        "textDocument":{
+           "version": 1,
+           "text": "Hello\n\tw\u00f6rld \"quoted\"\n",
+           "uri": "file:///foo.sv"
+         }
+    },
+    "method":"textDocument/didOpen",
+    "jsonrpc":"2.0"})");
+  EXPECT_EQ(collection.size(), 1);
+  EXPECT_EQ(content, "Hello\n\tw\xc3\xb6rld \"quoted\"\n");
+
+  rpc_dispatcher.DispatchMessage(R"({
+    "jsonrpc":"2.0",
+    "method":"textDocument/didChange",
+    "params":{
+        "textDocument": { "uri": "file:///foo.sv", "version": 2 },
+        "contentChanges": [
+          { "range": { "start": {"line": 0, "character": 1},
+                       "end": {"line": 0, "character": 5} },
+            "rangeLength": 4,
+            "text": "ey" },
+          { "range": { "end": {"character": 0, "line": 1},
+                       "start": {"character": 3, "line": 0} },
+            "text": "\n" }
+        ]
+     }})");
+  EXPECT_EQ(content, "Hey\n\tw\xc3\xb6rld \"quoted\"\n");
+
+  const auto &stats = rpc_dispatcher.GetStatCounters();
+  EXPECT_EQ(stats.at("textDocument/didOpen  ev"), 1);
+  EXPECT_EQ(stats.at("textDocument/didChange  ev"), 1);
+  EXPECT_EQ(rpc_dispatcher.exception_count(), 0);
+
+  // An incomplete change is left to the regular handler, which rejects it.
+  rpc_dispatcher.DispatchMessage(R"({
+    "jsonrpc":"2.0",
+    "method":"textDocument/didChange",
+    "params":{
+        "textDocument": { "uri": "file:///foo.sv" },
+        "contentChanges": [
+          { "range": { "start": {"line": 0},
+                       "end": {"line": 0, "character": 1} },
+            "text": "X" }
+        ]
+     }})");
+  EXPECT_EQ(content, "Hey\n\tw\xc3\xb6rld \"quoted\"\n");
+  EXPECT_EQ(rpc_dispatcher.exception_count(), 1);
+}
+
 }  // namespace lsp
 }  // namespace verible
@@ -87,10 +87,14 @@ absl::Status MessageStreamSplitter::ProcessContainedMessages(
                        absl::CEscape(limited_view), "...'"));
     }
 
+    if (body_offset == kIncompleteHeader) return absl::OkStatus();
     const int message_size = body_offset + body_size;
-    if (body_offset == kIncompleteHeader ||
-        message_size > static_cast<int>(data->size())) {
-      return absl::OkStatus();  // Only insufficient partial buffer available.
+    if (message_size > static_cast<int>(data->size())) {
+      // Only insufficient partial buffer available. Remember how much we
+      // need, so that the rest can be read without growing the buffer in
+      // multiple steps.
+      pending_message_size_ = message_size;
+      return absl::OkStatus();
     }
 
     absl::string_view header(data->data(), body_offset);
@@ -110,15 +114,21 @@ absl::Status MessageStreamSplitter::ReadInput(const ReadFun &read_fun) {
   size_t write_offset = 0;
 
   // Move all we had left from last time to the beginning of the buffer.
-  // This is in the same buffer, so we need to memmove()
+  // This is in the same buffer, so we need to memmove(). A large message
+  // arriving in many reads stays at the beginning, so is not moved again.
   if (!pending_data_.empty()) {
-    memmove(read_buffer_.data(), pending_data_.data(), pending_data_.size());
+    if (pending_data_.data() != read_buffer_.data()) {
+      memmove(read_buffer_.data(), pending_data_.data(), pending_data_.size());
+    }
     write_offset = pending_data_.size();
   }
 
-  if (write_offset == read_buffer_.size()) {
+  if (pending_message_size_ > read_buffer_.size()) {
+    read_buffer_.resize(pending_message_size_);
+  } else if (write_offset == read_buffer_.size()) {
     read_buffer_.resize(2 * read_buffer_.size());
   }
+  pending_message_size_ = 0;
 
   const int free_space = read_buffer_.size() - write_offset;
   int bytes_read = read_fun(read_buffer_.data() + write_offset, free_space);
@@ -95,6 +95,7 @@ class MessageStreamSplitter {
 
   std::vector<char> read_buffer_;
   absl::string_view pending_data_;
+  size_t pending_message_size_ = 0;  // Size of incomplete message, if known.
 
   MessageProcessFun message_processor_;
 
@@ -140,6 +140,30 @@ TEST(MessageStreamSplitterTest, BufferSizeReallocated) {
   EXPECT_EQ(processor_call_count, 1);
 }
 
+TEST(MessageStreamSplitterTest, BufferSizedForLargeMessageAtOnce) {
+  const std::string body(100000, 'x');
+  DataStreamSimulator stream(
+      absl::StrCat("Content-Length: ", body.size(), "\r\n\r\n", body));
+  MessageStreamSplitter s(64);
+  int processor_call_count = 0;
+  s.SetMessageProcessor([&](absl::string_view header, absl::string_view b) {
+    EXPECT_EQ(b, body);
+    ++processor_call_count;
+  });
+
+  // Once the header is seen, the buffer is resized to fit the whole message,
+  // so the remaining body is read at once instead of in doubling chunks.
+  int read_call_count = 0;
+  while (processor_call_count == 0) {
+    ++read_call_count;
+    ASSERT_TRUE(s.PullFrom([&](char *buf, int size) {
+                   return stream.read(buf, size);
+                 }).ok());
+  }
+  EXPECT_EQ(read_call_count, 2);
+  EXPECT_EQ(s.StatLargestBodySeen(), body.size());
+}
+
 TEST(MessageStreamSplitterTest, StreamDoesNotContainCompleteData) {
   static constexpr absl::string_view kHeader = "Content-Length: 3\r\n\r\n";
   static constexpr absl::string_view kBody = "fo";  // <- too short
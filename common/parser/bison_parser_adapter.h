@@ -34,6 +34,7 @@
 #include "common/parser/parser_param.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/logging.h"
 
 namespace verible {
@@ -47,6 +48,12 @@ class BisonParserAdapter : public Parser {
                      absl::string_view filename)
       : Parser(), param_(token_generator, filename) {}
 
+  // Parses the tokens of 'token_view' without going through a
+  // TokenGenerator.  'token_view' has to outlive this object.
+  BisonParserAdapter(const TokenStreamView &token_view,
+                     absl::string_view filename)
+      : Parser(), param_(token_view, filename) {}
+
   absl::Status Parse() final {
     int result = ParseFunc(&param_);
     // Results of parsing are stored in param_.
@@ -26,6 +26,7 @@
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/casts.h"
 #include "gtest/gtest.h"
 
@@ -68,5 +69,26 @@ TEST(BisonParserCommonTest, LexTest) {
   EXPECT_EQ(tref.text(), "foo");
 }
 
+// Test that Lex reads the tokens of a TokenStreamView, followed by EOF.
+TEST(BisonParserCommonTest, LexTokenViewTest) {
+  const TokenSequence tokens{TokenInfo(13, "foo"), TokenInfo(14, "bar")};
+  TokenStreamView view;
+  InitTokenStreamView(tokens, &view);
+  ParserParam parser_param(view, "<file>");
+  SymbolPtr value;
+  EXPECT_EQ(verible::LexAdapter(&value, &parser_param), 13);
+  // The last token refers to the viewed token, without a copy.
+  EXPECT_EQ(&parser_param.GetLastToken(), &tokens[0]);
+  EXPECT_EQ(verible::LexAdapter(&value, &parser_param), 14);
+  EXPECT_EQ(&parser_param.GetLastToken(), &tokens[1]);
+  const auto *value_ptr = down_cast<const SyntaxTreeLeaf *>(value.get());
+  ASSERT_NE(value_ptr, nullptr);
+  EXPECT_EQ(value_ptr->get().text(), "bar");
+  for (int i = 0; i < 2; ++i) {
+    verible::LexAdapter(&value, &parser_param);
+    EXPECT_TRUE(parser_param.GetLastToken().isEOF());
+  }
+}
+
 }  // namespace
 }  // namespace verible
@@ -26,6 +26,7 @@
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/casts.h"
 #include "common/util/logging.h"
 
@@ -34,15 +35,35 @@ namespace verible {
 ParserParam::ParserParam(TokenGenerator *token_stream,
                          absl::string_view filename)
     : token_stream_(token_stream),
+      view_iter_(),
+      view_end_(),
       filename_(filename),
-      last_token_(TokenInfo::EOFToken()),
+      last_token_(&eof_token_),
+      generated_token_(TokenInfo::EOFToken()),
+      eof_token_(TokenInfo::EOFToken()),
+      max_used_stack_size_(0) {}
+
+ParserParam::ParserParam(const TokenStreamView &token_view,
+                         absl::string_view filename)
+    : token_stream_(nullptr),
+      view_iter_(token_view.begin()),
+      view_end_(token_view.end()),
+      filename_(filename),
+      last_token_(&eof_token_),
+      generated_token_(TokenInfo::EOFToken()),
+      eof_token_(TokenInfo::EOFToken()),
       max_used_stack_size_(0) {}
 
 ParserParam::~ParserParam() = default;
 
 const TokenInfo &ParserParam::FetchToken() {
-  last_token_ = (*token_stream_)();
-  return last_token_;
+  if (token_stream_ == nullptr) {
+    last_token_ = (view_iter_ != view_end_) ? &**view_iter_++ : &eof_token_;
+  } else {
+    generated_token_ = (*token_stream_)();
+    last_token_ = &generated_token_;
+  }
+  return *last_token_;
 }
 
 void ParserParam::RecordSyntaxError(const SymbolPtr &symbol_ptr) {
@@ -29,6 +29,7 @@
 #include "common/lexer/token_generator.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 
 namespace verible {
 
@@ -48,11 +49,17 @@ class ParserParam {
   // FYI, does not change processing.
   ParserParam(TokenGenerator *token_stream, absl::string_view filename);
 
+  // Reads the tokens of 'token_view' directly, followed by EOF tokens.
+  // This avoids a function call and a TokenInfo copy per token, so it is
+  // preferred when all tokens are available up-front.
+  // 'token_view' and the tokens it points to have to outlive this object.
+  ParserParam(const TokenStreamView &token_view, absl::string_view filename);
+
   ~ParserParam();
 
   const TokenInfo &FetchToken();
 
-  const TokenInfo &GetLastToken() const { return last_token_; }
+  const TokenInfo &GetLastToken() const { return *last_token_; }
 
   // Save a copy of the offending token before bison error-recovery
   // discards it.
@@ -100,10 +107,18 @@ class ParserParam {
   // error-recovery is complete and parsing resumes (for diagnostic purposes).
   std::vector<TokenInfo> recovered_syntax_errors_;
 
+  // Source of tokens, if not reading a TokenStreamView.
   TokenGenerator *const token_stream_;
+  // Remaining tokens of the TokenStreamView, if token_stream_ is nullptr.
+  TokenStreamView::const_iterator view_iter_;
+  const TokenStreamView::const_iterator view_end_;
   const std::string filename_;
 
-  TokenInfo last_token_;
+  // Points into the viewed tokens, or to generated_token_ or eof_token_.
+  const TokenInfo *last_token_;
+  // Most recent token returned by token_stream_.
+  TokenInfo generated_token_;
+  const TokenInfo eof_token_;
   ConcreteSyntaxTree root_;
 
   // Overflow storage for parser's internal symbol and value stack.
@@ -14,10 +14,15 @@
 
 #include "common/strings/diff.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/position.h"
 #include "common/strings/split.h"
@@ -43,13 +48,130 @@ static char EditOperationToLineMarker(Operation op) {
   }
 }
 
-LineDiffs::LineDiffs(absl::string_view before, absl::string_view after)
+using LineIter = std::vector<absl::string_view>::const_iterator;
+
+// Appends 'edits' of a sub-range to 'all_edits', offset by the sub-range
+// starts.
+static void AppendOffsetEdits(const Edits &edits, int64_t before_offset,
+                              int64_t after_offset, Edits *all_edits) {
+  for (const Edit &edit : edits) {
+    const int64_t offset =
+        edit.operation == Operation::INSERT ? after_offset : before_offset;
+    diff::diff_impl::AppendEdit(edit.operation, edit.start + offset,
+                                edit.end + offset, all_edits);
+  }
+}
+
+// Returns the positions (before, after) of lines that occur exactly once in
+// each range, in the longest order common to both ranges.
+static std::vector<std::pair<int64_t, int64_t>> LongestUniqueLineMatches(
+    LineIter before_begin, LineIter before_end, LineIter after_begin,
+    LineIter after_end) {
+  struct Occurrences {
+    int before_count = 0;
+    int after_count = 0;
+    int64_t before_pos = 0;
+    int64_t after_pos = 0;
+  };
+  absl::flat_hash_map<absl::string_view, Occurrences> occurrences;
+  for (auto iter = before_begin; iter != before_end; ++iter) {
+    auto &entry = occurrences[*iter];
+    ++entry.before_count;
+    entry.before_pos = iter - before_begin;
+  }
+  for (auto iter = after_begin; iter != after_end; ++iter) {
+    const auto found = occurrences.find(*iter);
+    if (found == occurrences.end()) continue;
+    ++found->second.after_count;
+    found->second.after_pos = iter - after_begin;
+  }
+  std::vector<std::pair<int64_t, int64_t>> unique;  // ordered by before_pos
+  for (auto iter = before_begin; iter != before_end; ++iter) {
+    const auto &entry = occurrences.find(*iter)->second;
+    if (entry.before_count == 1 && entry.after_count == 1) {
+      unique.emplace_back(entry.before_pos, entry.after_pos);
+    }
+  }
+  if (unique.empty()) return unique;
+
+  // Longest increasing subsequence of after_pos, by patience sorting:
+  // pile_tops[k] is the index into 'unique' of the smallest top of the piles
+  // of length k+1, and 'previous' links back to the previous pile.
+  std::vector<size_t> pile_tops;
+  std::vector<size_t> previous(unique.size());
+  for (size_t i = 0; i < unique.size(); ++i) {
+    const auto pile = std::lower_bound(
+        pile_tops.begin(), pile_tops.end(), unique[i].second,
+        [&](size_t top, int64_t pos) { return unique[top].second < pos; });
+    if (pile != pile_tops.begin()) previous[i] = *std::prev(pile);
+    if (pile == pile_tops.end()) {
+      pile_tops.push_back(i);
+    } else {
+      *pile = i;
+    }
+  }
+  std::vector<std::pair<int64_t, int64_t>> matches(pile_tops.size());
+  size_t i = pile_tops.back();
+  for (auto match = matches.rbegin(); match != matches.rend(); ++match) {
+    *match = unique[i];
+    i = previous[i];
+  }
+  return matches;
+}
+
+// Diffs lines, first anchoring on unique lines, if enabled, and
+// recursively diff-ing the lines between anchors.
+static void ComputeLineEdits(LineIter before_begin, LineIter before_end,
+                             LineIter after_begin, LineIter after_end,
+                             int64_t before_offset, int64_t after_offset,
+                             const LineDiffOptions &options, Edits *edits) {
+  diff::DiffOptions diff_options;
+  diff_options.max_cost = options.max_edit_cost;
+  const auto matches =
+      options.anchor_unique_lines
+          ? LongestUniqueLineMatches(before_begin, before_end, after_begin,
+                                     after_end)
+          : std::vector<std::pair<int64_t, int64_t>>();
+  if (matches.empty()) {
+    AppendOffsetEdits(diff::GetTokenDiffs(before_begin, before_end,
+                                          after_begin, after_end, diff_options),
+                      before_offset, after_offset, edits);
+    return;
+  }
+  int64_t before_pos = 0;
+  int64_t after_pos = 0;
+  for (const auto &match : matches) {
+    ComputeLineEdits(before_begin + before_pos, before_begin + match.first,
+                     after_begin + after_pos, after_begin + match.second,
+                     before_offset + before_pos, after_offset + after_pos,
+                     options, edits);
+    diff::diff_impl::AppendEdit(Operation::EQUALS, before_offset + match.first,
+                                before_offset + match.first + 1, edits);
+    before_pos = match.first + 1;
+    after_pos = match.second + 1;
+  }
+  ComputeLineEdits(before_begin + before_pos, before_end,
+                   after_begin + after_pos, after_end,
+                   before_offset + before_pos, after_offset + after_pos,
+                   options, edits);
+}
+
+static Edits ComputeLineEdits(const std::vector<absl::string_view> &before,
+                              const std::vector<absl::string_view> &after,
+                              const LineDiffOptions &options) {
+  Edits edits;
+  ComputeLineEdits(before.begin(), before.end(), after.begin(), after.end(), 0,
+                   0, options, &edits);
+  return edits;
+}
+
+LineDiffs::LineDiffs(absl::string_view before, absl::string_view after,
+                     const LineDiffOptions &options)
     : before_text(before),
       after_text(after),
       before_lines(SplitLinesKeepLineTerminator(before_text)),
       after_lines(SplitLinesKeepLineTerminator(after_text)),
-      edits(diff::GetTokenDiffs(before_lines.begin(), before_lines.end(),
-                                after_lines.begin(), after_lines.end())) {}
+      edits(ComputeLineEdits(before_lines, after_lines, options)) {}
 
 template <typename Iter>
 static std::ostream &PrintLineRange(std::ostream &stream, char op, Iter start,
@@ -15,6 +15,7 @@
 #ifndef VERIBLE_COMMON_STRINGS_DIFF_H_
 #define VERIBLE_COMMON_STRINGS_DIFF_H_
 
+#include <cstdint>
 #include <iosfwd>
 #include <vector>
 
@@ -24,6 +25,19 @@
 
 namespace verible {
 
+// Options for computing line differences.
+struct LineDiffOptions {
+  // If true, lines that occur exactly once in both texts are matched up first
+  // (in their longest common order), and only the lines between these anchors
+  // are diff'd ("patience diff").  This is much faster on large texts with
+  // many changes, and tends to align on meaningful lines.
+  bool anchor_unique_lines = true;
+
+  // Limits the search for a minimal diff, see diff::DiffOptions::max_cost.
+  // 0 means no limit.
+  int64_t max_edit_cost = 4096;
+};
+
 // The LineDiffs structure holds line-based views of two texts
 // and the edit sequence (diff) to go from 'before_text' to 'after_text'.
 // No string copying is done, and the caller is responsible for ensuring
@@ -40,7 +54,8 @@ struct LineDiffs {
   const diff::Edits edits;  // line difference/edit-sequence between texts.
 
   // Computes the line-difference between before_text and after_text.
-  LineDiffs(absl::string_view before_text, absl::string_view after_text);
+  LineDiffs(absl::string_view before_text, absl::string_view after_text,
+            const LineDiffOptions &options = LineDiffOptions());
 
   std::ostream &PrintEdit(std::ostream &, const diff::Edit &) const;
 };
@@ -130,6 +130,62 @@ TEST(LineDiffsTest, Various) {
   }
 }
 
+TEST(LineDiffsTest, AnchorUniqueLines) {
+  constexpr absl::string_view kBefore = "foo\nx\nx\n";
+  constexpr absl::string_view kAfter = "x\nx\nfoo\n";
+  {
+    LineDiffOptions options;
+    options.anchor_unique_lines = false;
+    std::ostringstream stream;
+    stream << LineDiffs(kBefore, kAfter, options);
+    EXPECT_EQ(stream.str(), "-foo\n x\n x\n+foo\n");
+  }
+  {
+    // Matches up the unique line "foo" instead.
+    std::ostringstream stream;
+    stream << LineDiffs(kBefore, kAfter);
+    EXPECT_EQ(stream.str(), "+x\n+x\n foo\n-x\n-x\n");
+  }
+}
+
+TEST(LineDiffsTest, OptionsYieldValidEdits) {
+  constexpr DiffTestCase kTestCases[] = {
+      {"a\nb\nc\nd\ne\nf\n", "f\ne\nd\nc\nb\na\n", ""},
+      {"a\nb\na\nb\nc\n", "b\na\nc\nb\na\n", ""},
+      {"}\nfoo\n}\nbar\n}\n", "}\nbar\n}\nbaz\n}\nfoo\n}\n", ""},
+      {"1\n2\n3\n4\n5\n6\n7\n8\n", "1\nx\n3\ny\n5\nz\n7\nw\n", ""},
+  };
+  for (const auto &test : kTestCases) {
+    for (const bool anchor : {false, true}) {
+      for (const int64_t max_cost : {0, 1, 2, 4096}) {
+        LineDiffOptions options;
+        options.anchor_unique_lines = anchor;
+        options.max_edit_cost = max_cost;
+        const LineDiffs line_diffs(test.before, test.after, options);
+        std::string before, after;
+        for (const auto &edit : line_diffs.edits) {
+          for (int64_t i = edit.start; i < edit.end; ++i) {
+            if (edit.operation != Operation::INSERT) {
+              before.append(line_diffs.before_lines[i].begin(),
+                            line_diffs.before_lines[i].end());
+            }
+            if (edit.operation != Operation::DELETE) {
+              const auto &lines = edit.operation == Operation::INSERT
+                                      ? line_diffs.after_lines
+                                      : line_diffs.before_lines;
+              after.append(lines[i].begin(), lines[i].end());
+            }
+          }
+        }
+        EXPECT_EQ(before, test.before)
+            << "anchor: " << anchor << ", max_cost: " << max_cost;
+        EXPECT_EQ(after, test.after)
+            << "anchor: " << anchor << ", max_cost: " << max_cost;
+      }
+    }
+  }
+}
+
 struct AddedLineNumbersTestCase {
   Edits edits;
   LineNumberSet expected_line_numbers;
@@ -724,9 +780,9 @@ TEST(LineDiffsToUnifiedDiffTest, Various) {
           " b\n"
           "@@ -6,2 +6,3 @@\n"
           " f\n"
-          "+g\n"
           "-h\n"
           "\\ No newline at end of file\n"
+          "+g\n"
           "+h\n",
       },
       // Missing \n in the last line of "after" text
@@ -744,8 +800,8 @@ TEST(LineDiffsToUnifiedDiffTest, Various) {
           " b\n"
           "@@ -6,2 +6,3 @@\n"
           " f\n"
-          "+g\n"
           "-h\n"
+          "+g\n"
           "+h\n"
           "\\ No newline at end of file\n",
       },
@@ -0,0 +1,42 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/strings/identifier_pool.h"
+
+#include <optional>
+
+#include "absl/strings/string_view.h"
+#include "common/util/logging.h"
+
+namespace verible {
+
+IdentifierPool::Id IdentifierPool::Intern(absl::string_view name) {
+  const auto found = ids_.find(name);
+  if (found != ids_.end()) return found->second;
+  CHECK_LT(names_.size(), static_cast<size_t>(UINT32_MAX));
+  const Id id = names_.size();
+  names_.emplace_back(name);
+  ids_.emplace(names_.back(), id);
+  return id;
+}
+
+std::optional<IdentifierPool::Id> IdentifierPool::Find(
+    absl::string_view name) const {
+  const auto found = ids_.find(name);
+  if (found == ids_.end()) return std::nullopt;
+  return found->second;
+}
+
+}  // namespace verible
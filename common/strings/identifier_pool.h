@@ -0,0 +1,65 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_COMMON_STRINGS_IDENTIFIER_POOL_H_
+#define VERIBLE_COMMON_STRINGS_IDENTIFIER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace verible {
+
+// IdentifierPool interns names: it assigns each distinct name a dense 32-bit
+// id, in the order that names are first seen, so that equal names can be
+// compared and hashed as integers.  The pool keeps its own copy of every
+// name, so ids outlive the text they were interned from.
+// This class is not thread-safe.
+class IdentifierPool {
+ public:
+  using Id = uint32_t;
+
+  IdentifierPool() = default;
+  IdentifierPool(const IdentifierPool &) = delete;
+  IdentifierPool &operator=(const IdentifierPool &) = delete;
+
+  // Returns the id of 'name', assigning the next one if it is new.
+  Id Intern(absl::string_view name);
+
+  // Returns the id of 'name', or nullopt if it was never interned.
+  std::optional<Id> Find(absl::string_view name) const;
+
+  // Returns the name with the given id, which must have been returned by
+  // Intern().  The text is owned by the pool.
+  absl::string_view Name(Id id) const { return names_[id]; }
+
+  // Number of distinct names interned so far.
+  size_t size() const { return names_.size(); }
+
+ private:
+  // Indexed by id.  A deque keeps the addresses of the names stable, as they
+  // are referenced by the keys of ids_.
+  std::deque<std::string> names_;
+  absl::flat_hash_map<absl::string_view, Id> ids_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_STRINGS_IDENTIFIER_POOL_H_
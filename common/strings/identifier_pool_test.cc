@@ -0,0 +1,64 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/strings/identifier_pool.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(IdentifierPoolTest, Empty) {
+  const IdentifierPool pool;
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_FALSE(pool.Find("foo").has_value());
+}
+
+TEST(IdentifierPoolTest, EqualNamesGetTheSameId) {
+  IdentifierPool pool;
+  const IdentifierPool::Id foo = pool.Intern("foo");
+  const IdentifierPool::Id bar = pool.Intern("bar");
+  EXPECT_NE(foo, bar);
+  EXPECT_EQ(pool.Intern(std::string("foo")), foo);
+  EXPECT_EQ(pool.size(), 2);
+  EXPECT_EQ(pool.Find("bar"), bar);
+  EXPECT_FALSE(pool.Find("baz").has_value());
+}
+
+TEST(IdentifierPoolTest, IdsAreDense) {
+  IdentifierPool pool;
+  EXPECT_EQ(pool.Intern("a"), 0);
+  EXPECT_EQ(pool.Intern("b"), 1);
+  EXPECT_EQ(pool.Intern("a"), 0);
+  EXPECT_EQ(pool.Intern("c"), 2);
+}
+
+TEST(IdentifierPoolTest, NamesOutliveInternedText) {
+  IdentifierPool pool;
+  IdentifierPool::Id id;
+  {
+    const std::string temporary("some_long_identifier_not_inlined");
+    id = pool.Intern(temporary);
+  }
+  // Many more names must not move the first one.
+  for (int i = 0; i < 1000; ++i) pool.Intern(std::to_string(i));
+  EXPECT_EQ(pool.Name(id), "some_long_identifier_not_inlined");
+  EXPECT_EQ(pool.Find("some_long_identifier_not_inlined"), id);
+}
+
+}  // namespace
+}  // namespace verible
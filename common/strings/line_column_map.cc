@@ -17,8 +17,10 @@
 
 #include <algorithm>  // for binary search
 #include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <iterator>
+#include <numeric>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -56,13 +58,20 @@ std::ostream &operator<<(std::ostream &out, const LineColumnRange &r) {
 // Offsets are guaranteed to be monotonically increasing (sorted), and
 // thus, are binary-searchable.
 LineColumnMap::LineColumnMap(absl::string_view text) {
+  // Counting first sizes the offsets exactly; both the count and memchr()
+  // below are vectorized scans, unlike a character-by-character split.
+  beginning_of_line_offsets_.reserve(
+      1 + std::count(text.begin(), text.end(), '\n'));
   // The column number after every line break is 0.
   // The first line always starts at offset 0.
   beginning_of_line_offsets_.push_back(0);
-  auto offset = text.find('\n');
-  while (offset != absl::string_view::npos) {
-    beginning_of_line_offsets_.push_back(offset + 1);
-    offset = text.find('\n', offset + 1);
+  const char *const begin = text.data();
+  const char *const end = begin + text.length();
+  for (const char *newline = begin;
+       (newline = static_cast<const char *>(
+            std::memchr(newline, '\n', end - newline))) != nullptr;
+       ++newline) {
+    beginning_of_line_offsets_.push_back(newline - begin + 1);
   }
   // If the text does not end with a \n (POSIX), don't implicitly behave as if
   // there were one.
@@ -90,6 +99,61 @@ LineColumn LineColumnMap::GetLineColAtOffset(absl::string_view base,
   return LineColumn{line_number, utf8_len(line)};
 }
 
+std::vector<LineColumn> LineColumnMap::GetLineColAtSortedOffsets(
+    absl::string_view base, const std::vector<int> &sorted_offsets) const {
+  std::vector<LineColumn> result;
+  result.reserve(sorted_offsets.size());
+  const auto begin = beginning_of_line_offsets_.begin();
+  const auto end = beginning_of_line_offsets_.end();
+  auto line_at_offset = begin;
+  int counted_offset = empty() ? 0 : *begin;  // columns counted up to here
+  int column = 0;
+  for (const int bytes_offset : sorted_offsets) {
+    if (line_at_offset != end && std::next(line_at_offset) != end &&
+        *std::next(line_at_offset) <= bytes_offset) {
+      // Only search the lines following the previous offset.
+      line_at_offset = std::upper_bound(line_at_offset, end, bytes_offset) - 1;
+      counted_offset = *line_at_offset;
+      column = 0;
+    }
+    // Beyond the end of the text, the column stays at the last character.
+    const int bounded_offset =
+        std::min(bytes_offset, static_cast<int>(base.length()));
+    if (bounded_offset > counted_offset) {
+      column += utf8_len(
+          base.substr(counted_offset, bounded_offset - counted_offset));
+      counted_offset = bounded_offset;
+    }
+    result.push_back(
+        LineColumn{static_cast<int>(std::distance(begin, line_at_offset)),
+                   column});
+  }
+  return result;
+}
+
+std::vector<LineColumn> LineColumnMap::GetLineColAtOffsets(
+    absl::string_view base, const std::vector<int> &offsets) const {
+  if (std::is_sorted(offsets.begin(), offsets.end())) {
+    return GetLineColAtSortedOffsets(base, offsets);
+  }
+  // Index into offsets, in the order of the offsets.
+  std::vector<size_t> order(offsets.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&offsets](size_t a, size_t b) {
+    return offsets[a] < offsets[b];
+  });
+  std::vector<int> sorted_offsets;
+  sorted_offsets.reserve(offsets.size());
+  for (const size_t index : order) sorted_offsets.push_back(offsets[index]);
+  const std::vector<LineColumn> sorted_positions =
+      GetLineColAtSortedOffsets(base, sorted_offsets);
+  std::vector<LineColumn> result(offsets.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    result[order[i]] = sorted_positions[i];
+  }
+  return result;
+}
+
 int LineColumnMap::LineAtOffset(int bytes_offset) const {
   const auto begin = beginning_of_line_offsets_.begin();
   const auto end = beginning_of_line_offsets_.end();
@@ -74,10 +74,9 @@ class LineColumnMap {
   // a gap of one character (the splitting '\n' character).
   explicit LineColumnMap(const std::vector<absl::string_view> &lines);
 
-  // This constructor is only used in LintStatusFormatter and
-  // LintWaiverBuilder.
-  // TODO: If these already have access to pre-split lines, then this
-  // constructor is not needed.
+  // Build line column map from a scan of the text for newlines. This is how
+  // TextStructureView builds its map, from which it derives its lines; prefer
+  // reusing that map over building another one of the same text.
   explicit LineColumnMap(absl::string_view);
 
   bool empty() const { return beginning_of_line_offsets_.empty(); }
@@ -102,6 +101,18 @@ class LineColumnMap {
   // been considered.
   LineColumn GetLineColAtOffset(absl::string_view base, int bytes_offset) const;
 
+  // Same as GetLineColAtOffset() for each of the "sorted_offsets", which must
+  // be in ascending order. Walks forward through the lines once, and only
+  // counts the characters between consecutive offsets on the same line.
+  std::vector<LineColumn> GetLineColAtSortedOffsets(
+      absl::string_view base, const std::vector<int> &sorted_offsets) const;
+
+  // Same as GetLineColAtOffset() for each of the "offsets", in any order:
+  // sorts them, then resolves them with GetLineColAtSortedOffsets().  The
+  // result is in the order of "offsets".
+  std::vector<LineColumn> GetLineColAtOffsets(
+      absl::string_view base, const std::vector<int> &offsets) const;
+
   const std::vector<int> &GetBeginningOfLineOffsets() const {
     return beginning_of_line_offsets_;
   }
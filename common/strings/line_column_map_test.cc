@@ -174,6 +174,58 @@ TEST(LineColumnMapTest, Lookup) {
   }
 }
 
+// This test verifies that resolving sorted offsets together matches the
+// lookup of each offset.
+TEST(LineColumnMapTest, SortedLookup) {
+  for (const auto &test_case : map_test_data) {
+    const LineColumnMap line_map(test_case.text);
+    std::vector<int> offsets;
+    for (const auto &q : test_case.queries) offsets.push_back(q.offset);
+    // Repeated offsets resolve to the same position.
+    offsets.push_back(offsets.back());
+    const std::vector<LineColumn> positions =
+        line_map.GetLineColAtSortedOffsets(test_case.text, offsets);
+    ASSERT_EQ(positions.size(), offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      EXPECT_EQ(positions[i],
+                line_map.GetLineColAtOffset(test_case.text, offsets[i]))
+          << "Text: \"" << test_case.text << "\"\n"
+          << "Failed testing offset " << offsets[i];
+    }
+  }
+}
+
+// Every offset of a multi-line text with multi-byte characters.
+TEST(LineColumnMapTest, SortedLookupAllOffsets) {
+  constexpr absl::string_view text = "abc\n\nHeizöl\n😀x😀\nrückstoß";
+  const LineColumnMap line_map(text);
+  std::vector<int> offsets;
+  for (int i = 0; i <= static_cast<int>(text.length()); ++i) {
+    offsets.push_back(i);
+  }
+  const std::vector<LineColumn> positions =
+      line_map.GetLineColAtSortedOffsets(text, offsets);
+  ASSERT_EQ(positions.size(), offsets.size());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    EXPECT_EQ(positions[i], line_map.GetLineColAtOffset(text, offsets[i]))
+        << "Failed testing offset " << offsets[i];
+  }
+}
+
+TEST(LineColumnMapTest, UnsortedLookup) {
+  constexpr absl::string_view text = "abc\n\nHeizöl\nx";
+  const LineColumnMap line_map(text);
+  const std::vector<int> offsets = {13, 0, 11, 5, 5, 2, 100};
+  const std::vector<LineColumn> positions =
+      line_map.GetLineColAtOffsets(text, offsets);
+  ASSERT_EQ(positions.size(), offsets.size());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    EXPECT_EQ(positions[i], line_map.GetLineColAtOffset(text, offsets[i]))
+        << "Failed testing offset " << offsets[i];
+  }
+  EXPECT_TRUE(line_map.GetLineColAtOffsets(text, {}).empty());
+}
+
 TEST(LineColumnTest, LineColumnComparison) {
   constexpr LineColumn before_line{.line = 41, .column = 1};
   constexpr LineColumn before_col{.line = 42, .column = 1};
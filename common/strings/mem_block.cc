@@ -0,0 +1,63 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/strings/mem_block.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "common/util/logging.h"
+#include "common/util/range.h"
+
+namespace verible {
+
+SubMemBlock::SubMemBlock(std::shared_ptr<const MemBlock> parent,
+                         absl::string_view slice)
+    : parent_(std::move(parent)), slice_(slice) {
+  CHECK(parent_ != nullptr);
+  CHECK(IsSubRange(slice_, parent_->AsStringView()));
+}
+
+ChainMemBlock::ChainMemBlock(std::initializer_list<absl::string_view> pieces) {
+  size_t length = 0;
+  for (const absl::string_view piece : pieces) length += piece.length();
+  content_.reserve(length);
+  piece_offsets_.reserve(pieces.size());
+  for (const absl::string_view piece : pieces) {
+    piece_offsets_.push_back(content_.length());
+    content_.append(piece.begin(), piece.end());
+  }
+}
+
+absl::string_view ChainMemBlock::Piece(size_t index) const {
+  const size_t begin = piece_offsets_[index];
+  const size_t end = index + 1 < piece_offsets_.size()
+                         ? piece_offsets_[index + 1]
+                         : content_.length();
+  return absl::string_view(content_).substr(begin, end - begin);
+}
+
+size_t ChainMemBlock::PieceAtOffset(size_t offset) const {
+  // The last piece starting at or before "offset" is the one containing it,
+  // skipping empty pieces, which start where the next one does.
+  const auto next =
+      std::upper_bound(piece_offsets_.begin(), piece_offsets_.end(), offset);
+  return next == piece_offsets_.begin() ? 0 : next - piece_offsets_.begin() - 1;
+}
+
+}  // namespace verible
@@ -15,7 +15,12 @@
 #ifndef COMMON_STRINGS_MEM_BLOCK_H
 #define COMMON_STRINGS_MEM_BLOCK_H
 
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 
@@ -43,7 +48,8 @@ class MemBlock {
 class StringMemBlock final : public MemBlock {
  public:
   StringMemBlock() = default;
-  explicit StringMemBlock(std::string &&move_from) : content_(move_from) {}
+  explicit StringMemBlock(std::string &&move_from)
+      : content_(std::move(move_from)) {}
   explicit StringMemBlock(absl::string_view copy_from)
       : content_(copy_from.begin(), copy_from.end()) {}
 
@@ -57,6 +63,47 @@ class StringMemBlock final : public MemBlock {
   std::string content_;
 };
 
+// A slice of another MemBlock, which it keeps alive by reference count, so
+// that part of e.g. a memory-mapped file can be handed on without copying it.
+class SubMemBlock final : public MemBlock {
+ public:
+  // "slice" must be within parent->AsStringView().
+  SubMemBlock(std::shared_ptr<const MemBlock> parent, absl::string_view slice);
+
+  absl::string_view AsStringView() const final { return slice_; }
+
+  const std::shared_ptr<const MemBlock> &parent() const { return parent_; }
+
+ private:
+  const std::shared_ptr<const MemBlock> parent_;
+  const absl::string_view slice_;
+};
+
+// The concatenation of several pieces of text, e.g. of an excerpt wrapped in
+// a prolog and an epilog.  As AsStringView() is contiguous, the pieces are
+// copied, but only once, into a buffer of the final size.  Remembers where
+// each piece starts.
+class ChainMemBlock final : public MemBlock {
+ public:
+  explicit ChainMemBlock(std::initializer_list<absl::string_view> pieces);
+
+  absl::string_view AsStringView() const final { return content_; }
+
+  size_t NumPieces() const { return piece_offsets_.size(); }
+
+  // Returns the text of piece "index", within AsStringView().
+  absl::string_view Piece(size_t index) const;
+
+  // Returns the index of the piece containing the byte at "offset" of
+  // AsStringView() (or, for the end offset, the last piece).  Empty pieces
+  // contain no bytes.
+  size_t PieceAtOffset(size_t offset) const;
+
+ private:
+  std::string content_;
+  std::vector<size_t> piece_offsets_;  // start of each piece in content_
+};
+
 // FYI common/util:file_util provides a memory mapping implementation.
 
 }  // namespace verible
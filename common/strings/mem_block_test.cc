@@ -0,0 +1,74 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/strings/mem_block.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(SubMemBlockTest, SharesTheMemoryOfItsParent) {
+  std::shared_ptr<MemBlock> sub;
+  absl::string_view parent_text;
+  {
+    auto parent = std::make_shared<StringMemBlock>(std::string("hello world"));
+    parent_text = parent->AsStringView();
+    sub = std::make_shared<SubMemBlock>(parent, parent_text.substr(6, 5));
+  }
+  // The parent is kept alive by the slice.
+  EXPECT_EQ(sub->AsStringView(), "world");
+  EXPECT_EQ(sub->AsStringView().data(), parent_text.data() + 6);
+}
+
+TEST(SubMemBlockTest, SliceOfSlice) {
+  auto parent = std::make_shared<StringMemBlock>(std::string("abcdef"));
+  auto sub =
+      std::make_shared<SubMemBlock>(parent, parent->AsStringView().substr(1));
+  const SubMemBlock sub_sub(sub, sub->AsStringView().substr(1, 2));
+  EXPECT_EQ(sub_sub.AsStringView(), "cd");
+  EXPECT_EQ(sub_sub.parent(), sub);
+}
+
+TEST(ChainMemBlockTest, ConcatenatesPieces) {
+  const std::string excerpt("x = 1;");
+  const ChainMemBlock chain({"module m;\n", excerpt, "", "\nendmodule\n"});
+  EXPECT_EQ(chain.AsStringView(), "module m;\nx = 1;\nendmodule\n");
+  ASSERT_EQ(chain.NumPieces(), 4);
+  EXPECT_EQ(chain.Piece(0), "module m;\n");
+  EXPECT_EQ(chain.Piece(1), excerpt);
+  EXPECT_NE(chain.Piece(1).data(), excerpt.data());  // copied
+  EXPECT_EQ(chain.Piece(2), "");
+  EXPECT_EQ(chain.Piece(3), "\nendmodule\n");
+
+  EXPECT_EQ(chain.PieceAtOffset(0), 0);
+  EXPECT_EQ(chain.PieceAtOffset(9), 0);
+  EXPECT_EQ(chain.PieceAtOffset(10), 1);
+  EXPECT_EQ(chain.PieceAtOffset(15), 1);
+  EXPECT_EQ(chain.PieceAtOffset(16), 3);  // skips the empty piece
+  EXPECT_EQ(chain.PieceAtOffset(chain.AsStringView().length()), 3);
+}
+
+TEST(ChainMemBlockTest, NoPieces) {
+  const ChainMemBlock chain({});
+  EXPECT_TRUE(chain.AsStringView().empty());
+  EXPECT_EQ(chain.NumPieces(), 0);
+}
+
+}  // namespace
+}  // namespace verible
@@ -14,10 +14,16 @@
 
 #include "common/strings/obfuscator.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -51,7 +57,11 @@ std::string Obfuscator::save() const {
   return stream.str();
 }
 
-absl::Status Obfuscator::load(absl::string_view mapping) {
+// Parses a mapping dictionary (see Obfuscator::load()), passing each entry to
+// 'encode'.
+static absl::Status ParseMapping(
+    absl::string_view mapping,
+    const std::function<void(absl::string_view, absl::string_view)> &encode) {
   const std::vector<absl::string_view> lines =
       absl::StrSplit(mapping, '\n', absl::SkipEmpty());
   for (const auto &line : lines) {
@@ -67,10 +77,97 @@ absl::Status Obfuscator::load(absl::string_view mapping) {
   return absl::OkStatus();
 }
 
+absl::Status Obfuscator::load(absl::string_view mapping) {
+  return ParseMapping(mapping,
+                      [this](absl::string_view key, absl::string_view value) {
+                        encode(key, value);
+                      });
+}
+
 bool IdentifierObfuscator::encode(absl::string_view key,
                                   absl::string_view value) {
   CHECK_EQ(key.length(), value.length());
   return parent_type::encode(key, value);
 }
 
+size_t ConcurrentIdentifierObfuscator::ShardIndex(absl::string_view s) {
+  return absl::Hash<absl::string_view>()(s) % kNumShards;
+}
+
+bool ConcurrentIdentifierObfuscator::encode(absl::string_view key,
+                                            absl::string_view value) {
+  CHECK_EQ(key.length(), value.length());
+  // Locks are always taken forward before reverse, to avoid deadlocks.
+  ForwardShard &forward = forward_[ShardIndex(key)];
+  const std::lock_guard<std::mutex> forward_lock(forward.lock);
+  if (forward.map.contains(key)) return false;
+  ReverseShard &reverse = reverse_[ShardIndex(value)];
+  const std::lock_guard<std::mutex> reverse_lock(reverse.lock);
+  if (reverse.map.contains(value)) return false;
+  const auto inserted =
+      forward.map.emplace(std::string(key), std::string(value)).first;
+  reverse.map.emplace(inserted->second, inserted->first);
+  return true;
+}
+
+absl::string_view ConcurrentIdentifierObfuscator::operator()(
+    absl::string_view input) {
+  if (decode_mode_) return decode(input);
+  ForwardShard &forward = forward_[ShardIndex(input)];
+  const std::lock_guard<std::mutex> forward_lock(forward.lock);
+  const auto found = forward.map.find(input);
+  if (found != forward.map.end()) return found->second;
+  // Generate until the obfuscated string is unique.
+  for (;;) {
+    std::string candidate = generator_(input);
+    ReverseShard &reverse = reverse_[ShardIndex(candidate)];
+    const std::lock_guard<std::mutex> reverse_lock(reverse.lock);
+    if (reverse.map.contains(candidate)) continue;
+    const auto inserted =
+        forward.map.emplace(std::string(input), std::move(candidate)).first;
+    reverse.map.emplace(inserted->second, inserted->first);
+    return inserted->second;
+  }
+}
+
+absl::string_view ConcurrentIdentifierObfuscator::decode(
+    absl::string_view input) const {
+  const ReverseShard &reverse = reverse_[ShardIndex(input)];
+  const std::lock_guard<std::mutex> reverse_lock(reverse.lock);
+  const auto found = reverse.map.find(input);
+  return found != reverse.map.end() ? found->second : input;
+}
+
+size_t ConcurrentIdentifierObfuscator::size() const {
+  size_t size = 0;
+  for (const auto &forward : forward_) {
+    const std::lock_guard<std::mutex> forward_lock(forward.lock);
+    size += forward.map.size();
+  }
+  return size;
+}
+
+absl::Status ConcurrentIdentifierObfuscator::load(absl::string_view mapping) {
+  return ParseMapping(mapping,
+                      [this](absl::string_view key, absl::string_view value) {
+                        encode(key, value);
+                      });
+}
+
+std::string ConcurrentIdentifierObfuscator::save() const {
+  std::vector<std::pair<absl::string_view, absl::string_view>> entries;
+  for (const auto &forward : forward_) {
+    const std::lock_guard<std::mutex> forward_lock(forward.lock);
+    for (const auto &pair : forward.map) {
+      entries.emplace_back(pair.first, pair.second);
+    }
+  }
+  std::sort(entries.begin(), entries.end());
+  std::ostringstream stream;
+  for (const auto &entry : entries) {
+    stream << entry.first << kPairSeparator << entry.second << "\n";
+  }
+  return stream.str();
+}
+
 }  // namespace verible
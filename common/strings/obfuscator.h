@@ -15,9 +15,14 @@
 #ifndef VERIBLE_COMMON_STRINGS_OBFUSCATOR_H_
 #define VERIBLE_COMMON_STRINGS_OBFUSCATOR_H_
 
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <mutex>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/compare.h"
@@ -96,6 +101,73 @@ class IdentifierObfuscator : public Obfuscator {
   bool encode(absl::string_view key, absl::string_view value);
 };
 
+// Thread-safe counterpart of IdentifierObfuscator, for obfuscating many texts
+// concurrently with one consistent translation.  The translation map is split
+// into shards by hash, each with its own lock, so that concurrent lookups
+// rarely contend.  A mapping, once established, is never changed, so the
+// returned strings remain valid for the lifetime of this object.
+// The generator may be called concurrently and must be thread-safe.
+class ConcurrentIdentifierObfuscator {
+ public:
+  using generator_type = Obfuscator::generator_type;
+
+  explicit ConcurrentIdentifierObfuscator(const generator_type &g)
+      : generator_(g) {}
+
+  ConcurrentIdentifierObfuscator(const ConcurrentIdentifierObfuscator &) =
+      delete;
+  ConcurrentIdentifierObfuscator &operator=(
+      const ConcurrentIdentifierObfuscator &) = delete;
+
+  // Same as Obfuscator::encode(), and verifies that key and value are equal
+  // length.
+  bool encode(absl::string_view key, absl::string_view value);
+
+  // Set before any concurrent use.
+  void set_decode_mode(bool decode) { decode_mode_ = decode; }
+
+  bool is_decoding() const { return decode_mode_; }
+
+  // Same as Obfuscator::operator().
+  absl::string_view operator()(absl::string_view input);
+
+  // Returns the original of an obfuscated string, or the input itself if it
+  // was not generated.
+  absl::string_view decode(absl::string_view input) const;
+
+  // Returns the number of mappings.
+  size_t size() const;
+
+  // Same as Obfuscator::load().
+  absl::Status load(absl::string_view);
+
+  // Same as Obfuscator::save(), with entries sorted by original string.
+  std::string save() const;
+
+ private:
+  static constexpr size_t kNumShards = 64;
+
+  // Maps original to obfuscated strings, with stable addresses.
+  struct ForwardShard {
+    mutable std::mutex lock;
+    absl::node_hash_map<std::string, std::string> map;
+  };
+
+  // Maps obfuscated strings to their originals, stored in a ForwardShard.
+  // This guarantees uniqueness of obfuscated strings across all shards.
+  struct ReverseShard {
+    mutable std::mutex lock;
+    absl::flat_hash_map<absl::string_view, absl::string_view> map;
+  };
+
+  static size_t ShardIndex(absl::string_view s);
+
+  generator_type generator_;
+  std::array<ForwardShard, kNumShards> forward_;
+  std::array<ReverseShard, kNumShards> reverse_;
+  bool decode_mode_ = false;
+};
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_STRINGS_OBFUSCATOR_H_
@@ -14,9 +14,13 @@
 
 #include "common/strings/obfuscator.h"
 
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/random.h"
 #include "common/util/bijective_map.h"
@@ -215,5 +219,78 @@ TEST(IdentifierObfuscatorTest, EncodeValidTransform) {
   }
 }
 
+TEST(ConcurrentIdentifierObfuscatorTest, Transform) {
+  ConcurrentIdentifierObfuscator ob(RotateGenerator);
+  EXPECT_EQ(ob.size(), 0);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(ob("cat"), "png");
+    EXPECT_EQ(ob.size(), 1);
+    EXPECT_EQ(ob.decode("png"), "cat");
+  }
+  EXPECT_EQ(ob("Dog"), "Qbt");
+  EXPECT_EQ(ob.size(), 2);
+  EXPECT_EQ(ob.decode("Qbt"), "Dog");
+  EXPECT_EQ(ob.decode("unseen"), "unseen");
+}
+
+TEST(ConcurrentIdentifierObfuscatorTest, Encode) {
+  ConcurrentIdentifierObfuscator ob(RotateGenerator);
+  EXPECT_TRUE(ob.encode("cat", "cow"));
+  EXPECT_FALSE(ob.encode("cat", "pig"));  // key already mapped
+  EXPECT_FALSE(ob.encode("dog", "cow"));  // value already mapped
+  EXPECT_EQ(ob("cat"), "cow");
+  EXPECT_EQ(ob.size(), 1);
+  EXPECT_DEATH(ob.encode("cat", "sheep"), "");  // mismatch length
+}
+
+TEST(ConcurrentIdentifierObfuscatorTest, SaveAndLoadSorted) {
+  ConcurrentIdentifierObfuscator ob(RotateGenerator);
+  ob("cat");
+  ob("Dog");
+  ob("bird");
+  const std::string saved = ob.save();
+  EXPECT_EQ(saved, "Dog Qbt\nbird oveq\ncat png\n");
+
+  ConcurrentIdentifierObfuscator loaded(RandomEqualLengthIdentifier);
+  EXPECT_TRUE(loaded.load(saved).ok());
+  EXPECT_EQ(loaded.size(), 3);
+  EXPECT_EQ(loaded("bird"), "oveq");
+  EXPECT_EQ(loaded.save(), saved);
+
+  loaded.set_decode_mode(true);
+  EXPECT_EQ(loaded("png"), "cat");
+  EXPECT_EQ(loaded("unseen"), "unseen");
+  EXPECT_EQ(loaded.size(), 3);
+}
+
+TEST(ConcurrentIdentifierObfuscatorTest, ConsistentAcrossThreads) {
+  ConcurrentIdentifierObfuscator ob(RandomEqualLengthIdentifier);
+  std::vector<std::string> inputs;
+  for (int i = 0; i < 500; ++i) inputs.push_back(absl::StrCat("id", i % 250));
+  constexpr int kNumThreads = 4;
+  std::vector<std::vector<std::string>> outputs(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (const auto &input : inputs) {
+        outputs[t].emplace_back(ob(input));
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_EQ(ob.size(), 250);
+  std::set<std::string> distinct;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    for (int t = 0; t < kNumThreads; ++t) {
+      EXPECT_EQ(outputs[t][i], outputs[0][i]) << inputs[i];
+    }
+    EXPECT_EQ(outputs[0][i].length(), inputs[i].length());
+    EXPECT_EQ(ob.decode(outputs[0][i]), inputs[i]);
+    distinct.insert(outputs[0][i]);
+  }
+  EXPECT_EQ(distinct.size(), 250);
+}
+
 }  // namespace
 }  // namespace verible
@@ -19,6 +19,8 @@
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,10 +31,10 @@
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/strings/split.h"
 #include "common/util/algorithm.h"
@@ -42,6 +44,7 @@
 #include "common/util/iterator_range.h"
 #include "common/util/logging.h"
 #include "common/util/status_macros.h"
+#include "common/util/thread_pool.h"
 #include "common/util/user_interaction.h"
 
 namespace verible {
@@ -405,9 +408,75 @@ absl::Status FilePatch::VerifyAgainstOriginalLines(
 
 absl::Status FilePatch::PickApplyInPlace(std::istream &ins,
                                          std::ostream &outs) const {
-  return PickApply(ins, outs, &file::GetContentAsString, &file::SetContents);
+  return PickApply(ins, outs, &file::GetContentAsMemBlock, &file::SetContents);
 }
 
+namespace {
+// Assembles the contents of a patched file.  Unmodified spans of lines are
+// copied straight from the original text in one piece, rather than line by
+// line.  Every line of the result is terminated by a '\n'.
+class PatchedContentBuilder {
+ public:
+  // 'orig_lines' are views into the original text, without their '\n'.
+  PatchedContentBuilder(absl::string_view orig_text,
+                        const std::vector<absl::string_view> &orig_lines)
+      : orig_lines_(orig_lines) {
+    contents_.reserve(orig_text.size() + 1);
+  }
+
+  // 0-indexed line up to which the original text has been consumed.
+  int ConsumedLines() const { return consumed_lines_; }
+
+  // Copies the original lines [ConsumedLines(), end_line), if any.
+  void CopyOriginalLines(int end_line) {
+    if (end_line <= consumed_lines_) return;
+    CHECK_LE(end_line, static_cast<int>(orig_lines_.size()));
+    const absl::string_view first(orig_lines_[consumed_lines_]);
+    const absl::string_view last(orig_lines_[end_line - 1]);
+    contents_.append(first.data(), last.data() + last.size() - first.data());
+    contents_.push_back('\n');
+    consumed_lines_ = end_line;
+  }
+
+  // Substitutes the original lines covered by 'hunk' with its new lines.
+  void ApplyHunk(const Hunk &hunk) {
+    for (const MarkedLine &marked_line : hunk.MarkedLines()) {
+      if (!marked_line.IsDeleted()) {
+        const absl::string_view line(marked_line.Text());
+        contents_.append(line.data(), line.size());
+        contents_.push_back('\n');
+      }
+    }
+    const auto &old_range = hunk.Header().old_range;
+    consumed_lines_ = old_range.start + old_range.count - 1;
+  }
+
+  // Copies the remaining original lines, and returns the whole result.
+  std::string Finish() {
+    CopyOriginalLines(orig_lines_.size());
+    // Even without any lines, the result is terminated.
+    if (contents_.empty()) contents_.push_back('\n');
+    return std::move(contents_);
+  }
+
+ private:
+  const std::vector<absl::string_view> &orig_lines_;
+  int consumed_lines_ = 0;  // 0-indexed
+  std::string contents_;
+};
+
+absl::Status CheckHunkOrder(const Hunk &hunk, int last_consumed_line) {
+  const auto &old_range = hunk.Header().old_range;
+  if (old_range.start < last_consumed_line) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Hunks are not properly ordered.  last_consumed_line=",
+                     last_consumed_line, ", but current hunk starts at line ",
+                     old_range.start));
+  }
+  return absl::OkStatus();
+}
+}  // namespace
+
 absl::Status FilePatch::PickApply(std::istream &ins, std::ostream &outs,
                                   const FileReaderFunction &file_reader,
                                   const FileWriterFunction &file_writer) const {
@@ -419,8 +488,10 @@ absl::Status FilePatch::PickApply(std::istream &ins, std::ostream &outs,
   // If we had control over diff/patch generation, then we could rely on the
   // original diff structure/stream to provide original contents.
   // Below, we VerifyAgainstOriginalLines for all hunks in this FilePatch.
-  const absl::StatusOr<std::string> orig_file_or = file_reader(old_file_.path);
+  absl::StatusOr<std::unique_ptr<MemBlock>> orig_file_or =
+      file_reader(old_file_.path);
   if (!orig_file_or.ok()) return orig_file_or.status();
+  const absl::string_view orig_text((*orig_file_or)->AsStringView());
 
   if (!hunks_.empty()) {
     // Display the file being processed, if there are any hunks.
@@ -430,33 +501,22 @@ absl::Status FilePatch::PickApply(std::istream &ins, std::ostream &outs,
                   term::Color::kCyan);
   }
 
-  const std::vector<absl::string_view> orig_lines(SplitLines(*orig_file_or));
+  const std::vector<absl::string_view> orig_lines(SplitLines(orig_text));
   RETURN_IF_ERROR(VerifyAgainstOriginalLines(orig_lines));
 
-  // Accumulate lines to write here.
-  // Needs own copy of string due to potential splitting into temporary hunks.
-  std::vector<std::string> output_lines;
+  // Accumulates the contents to write.
+  PatchedContentBuilder output(orig_text, orig_lines);
 
-  int last_consumed_line = 0;                                     // 0-indexed
   std::deque<Hunk> hunks_worklist(hunks_.begin(), hunks_.end());  // copy-fill
   while (!hunks_worklist.empty()) {
     VLOG(1) << "hunks remaining: " << hunks_worklist.size();
     const Hunk &hunk(hunks_worklist.front());
 
     // Copy over unchanged lines before this hunk.
-    const auto &old_range = hunk.Header().old_range;
-    if (old_range.start < last_consumed_line) {
-      return absl::InvalidArgumentError(
-          absl::StrCat("Hunks are not properly ordered.  last_consumed_line=",
-                       last_consumed_line, ", but current hunk starts at line ",
-                       old_range.start));
-    }
-    for (; last_consumed_line < old_range.start - 1; ++last_consumed_line) {
-      CHECK_LT(last_consumed_line, static_cast<int>(orig_lines.size()));
-      const absl::string_view &line(orig_lines[last_consumed_line]);
-      output_lines.emplace_back(line.begin(), line.end());  // copy string
-    }
-    VLOG(1) << "copied up to (!including) line[" << last_consumed_line << "].";
+    RETURN_IF_ERROR(CheckHunkOrder(hunk, output.ConsumedLines()));
+    output.CopyOriginalLines(hunk.Header().old_range.start - 1);
+    VLOG(1) << "copied up to (!including) line[" << output.ConsumedLines()
+            << "].";
 
     // Prompt user to apply or reject patch hunk.
     std::function<char()> prompt = [&hunk, &ins, &outs]() -> char {
@@ -473,13 +533,7 @@ absl::Status FilePatch::PickApply(std::istream &ins, std::ostream &outs,
       }
       case 'y': {
         // accept this hunk, copy lines over
-        for (const MarkedLine &marked_line : hunk.MarkedLines()) {
-          if (!marked_line.IsDeleted()) {
-            const absl::string_view line(marked_line.Text());
-            output_lines.emplace_back(line.begin(), line.end());  // copy string
-          }
-        }
-        last_consumed_line = old_range.start + old_range.count - 1;
+        output.ApplyHunk(hunk);
         break;  // switch
       }
       case 'd': {
@@ -520,15 +574,38 @@ absl::Status FilePatch::PickApply(std::istream &ins, std::ostream &outs,
     hunks_worklist.pop_front();
   }
   // Copy over remaining lines after the last hunk.
-  for (; last_consumed_line < static_cast<int>(orig_lines.size());
-       ++last_consumed_line) {
-    const absl::string_view &line(orig_lines[last_consumed_line]);
-    output_lines.emplace_back(line.begin(), line.end());  // copy string
-  }
-  VLOG(1) << "copied reamining lines up to [" << last_consumed_line << "].";
+  std::string rewrite_contents(output.Finish());
+  VLOG(1) << "copied remaining lines up to [" << orig_lines.size() << "].";
 
-  const std::string rewrite_contents(absl::StrJoin(output_lines, "\n") + "\n");
+  // Release the original before the file is overwritten.
+  orig_file_or->reset();
+  return file_writer(old_file_.path, rewrite_contents);
+}
+
+absl::Status FilePatch::Apply(const FileReaderFunction &file_reader,
+                              const FileWriterFunction &file_writer) const {
+  if (IsDeletedFile()) return absl::OkStatus();  // ignore
+  if (IsNewFile()) return absl::OkStatus();      // ignore
+  if (hunks_.empty()) return absl::OkStatus();   // nothing to change
 
+  absl::StatusOr<std::unique_ptr<MemBlock>> orig_file_or =
+      file_reader(old_file_.path);
+  if (!orig_file_or.ok()) return orig_file_or.status();
+  const absl::string_view orig_text((*orig_file_or)->AsStringView());
+
+  const std::vector<absl::string_view> orig_lines(SplitLines(orig_text));
+  RETURN_IF_ERROR(VerifyAgainstOriginalLines(orig_lines));
+
+  PatchedContentBuilder output(orig_text, orig_lines);
+  for (const Hunk &hunk : hunks_) {
+    RETURN_IF_ERROR(CheckHunkOrder(hunk, output.ConsumedLines()));
+    output.CopyOriginalLines(hunk.Header().old_range.start - 1);
+    output.ApplyHunk(hunk);
+  }
+  std::string rewrite_contents(output.Finish());
+
+  // Release the original before the file is overwritten.
+  orig_file_or->reset();
   return file_writer(old_file_.path, rewrite_contents);
 }
 
@@ -682,7 +759,12 @@ FileLineNumbersMap PatchSet::AddedLinesMap(bool new_file_ranges) const {
 
 absl::Status PatchSet::PickApplyInPlace(std::istream &ins,
                                         std::ostream &outs) const {
-  return PickApply(ins, outs, &file::GetContentAsString, &file::SetContents);
+  return PickApply(ins, outs, &file::GetContentAsMemBlock, &file::SetContents);
+}
+
+absl::Status PatchSet::ApplyInPlace(int jobs) const {
+  return Apply(jobs, &file::GetContentAsMemBlock,
+               &file::SetContentsAtomically);
 }
 
 absl::Status PatchSet::PickApply(
@@ -695,6 +777,38 @@ absl::Status PatchSet::PickApply(
   return absl::OkStatus();
 }
 
+absl::Status PatchSet::Apply(
+    int jobs, const internal::FileReaderFunction &file_reader,
+    const internal::FileWriterFunction &file_writer) const {
+  // Group the file patches by file, in order of first appearance, so that
+  // each file is only ever written by one thread.
+  std::vector<std::vector<size_t>> file_groups;
+  std::map<absl::string_view, size_t> group_of_file;
+  for (size_t i = 0; i < file_patches_.size(); ++i) {
+    const auto inserted = group_of_file.emplace(
+        file_patches_[i].OldFilePath(), file_groups.size());
+    if (inserted.second) file_groups.emplace_back();
+    file_groups[inserted.first->second].push_back(i);
+  }
+
+  std::vector<absl::Status> statuses(file_patches_.size());
+  // The calling thread participates in the work.
+  ThreadPool pool(std::max(jobs - 1, 0));
+  pool.ParallelFor(0, file_groups.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t g = begin; g < end; ++g) {
+      for (const size_t i : file_groups[g]) {
+        statuses[i] = file_patches_[i].Apply(file_reader, file_writer);
+        // Later patches of the same file depend on this one.
+        if (!statuses[i].ok()) break;
+      }
+    }
+  });
+  for (const absl::Status &status : statuses) {
+    RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 std::ostream &operator<<(std::ostream &stream, const PatchSet &patch) {
   return patch.Render(stream);
 }
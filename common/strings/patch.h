@@ -18,6 +18,7 @@
 #include <functional>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/compare.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/util/container_iterator_range.h"
 #include "common/util/logging.h"
@@ -34,9 +36,10 @@ namespace internal {
 // Forward declarations
 class FilePatch;
 
-// function interface like file::GetContentAsString()
+// function interface like file::GetContentAsMemBlock()
 using FileReaderFunction =
-    std::function<absl::StatusOr<std::string>(absl::string_view filename)>;
+    std::function<absl::StatusOr<std::unique_ptr<MemBlock>>(
+        absl::string_view filename)>;
 
 // function interface like file::SetContents()
 using FileWriterFunction = std::function<absl::Status(
@@ -73,12 +76,23 @@ class PatchSet {
   // and 'outs' is the stream that displays text and prompts to the user.
   absl::Status PickApplyInPlace(std::istream &ins, std::ostream &outs) const;
 
+  // Applies all hunks in-place, without prompting.
+  // Files are patched on up to 'jobs' threads (synchronously if 0).
+  // Multiple file patches of the same file are applied in sequence.
+  // Returns the first error in file order, after all files were attempted.
+  absl::Status ApplyInPlace(int jobs) const;
+
  protected:
   // For testing, allow mocking out of file I/O.
   absl::Status PickApply(std::istream &ins, std::ostream &outs,
                          const internal::FileReaderFunction &file_reader,
                          const internal::FileWriterFunction &file_writer) const;
 
+  // For testing, allow mocking out of file I/O.
+  // 'file_reader' and 'file_writer' may be called concurrently.
+  absl::Status Apply(int jobs, const internal::FileReaderFunction &file_reader,
+                     const internal::FileWriterFunction &file_writer) const;
+
  private:
   // Non-patch plain text that could describe the origins of the diff/patch,
   // e.g. from git-format-patch.
@@ -273,6 +287,14 @@ class FilePatch {
                          const FileReaderFunction &file_reader,
                          const FileWriterFunction &file_writer) const;
 
+  // Applies all hunks, without prompting.
+  // Public to allow use by PatchSet::Apply().
+  absl::Status Apply(const FileReaderFunction &file_reader,
+                     const FileWriterFunction &file_writer) const;
+
+  // Path of the file to be patched.
+  const std::string &OldFilePath() const { return old_file_.path; }
+
  private:
   // These are lines of informational text only, such as how the diff was
   // generated.  They do not impact 'patch' behavior.
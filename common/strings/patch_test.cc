@@ -16,6 +16,9 @@
 
 #include <cstddef>
 #include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -27,6 +30,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -1037,9 +1041,9 @@ class FilePatchPickApplyTest : public FilePatch, public ::testing::Test {
     return Parse(range);
   }
 
-  static absl::StatusOr<std::string> NullFileReader(
+  static absl::StatusOr<std::unique_ptr<MemBlock>> NullFileReader(
       absl::string_view filename) {
-    return "";
+    return std::make_unique<StringMemBlock>();
   }
 
   static absl::Status NullFileWriter(absl::string_view filename,
@@ -1076,8 +1080,9 @@ struct ReadStringFileSequence : public StringFileSequence {
   ReadStringFileSequence(std::initializer_list<StringFile> files)
       : StringFileSequence(files) {}
 
-  // like file::GetContentAsString()
-  absl::StatusOr<std::string> operator()(absl::string_view filename) {
+  // like file::GetContentAsMemBlock()
+  absl::StatusOr<std::unique_ptr<MemBlock>> operator()(
+      absl::string_view filename) {
     // ASSERT_LT(i, files_.size());  // can't use ASSERT_* which returns void
     if (index_ >= files_.size()) {
       return absl::OutOfRangeError(
@@ -1086,7 +1091,7 @@ struct ReadStringFileSequence : public StringFileSequence {
     const auto &file = files_[index_];
     EXPECT_EQ(filename, file.path) << " at index " << index_;
     ++index_;
-    return std::string{file.contents};
+    return std::make_unique<StringMemBlock>(file.contents);
   }
 };
 
@@ -1119,7 +1124,8 @@ TEST_F(FilePatchPickApplyTest, ErrorReadingFile) {
   std::ostringstream outs;
   constexpr absl::string_view kErrorMessage = "File not found.";
   auto error_file_reader = [=](absl::string_view filename) {
-    return absl::StatusOr<std::string>(absl::NotFoundError(kErrorMessage));
+    return absl::StatusOr<std::unique_ptr<MemBlock>>(
+        absl::NotFoundError(kErrorMessage));
   };
   const auto status = PickApply(ins, outs, error_file_reader, &NullFileWriter);
   EXPECT_FALSE(status.ok());
@@ -1395,6 +1401,44 @@ TEST_F(FilePatchPickApplyTest, OneReplacementAccepted) {
   EXPECT_FALSE(outs.str().empty());
 }
 
+TEST_F(FilePatchPickApplyTest, ApplyAllHunksWithoutPrompt) {
+  {
+    const std::vector<absl::string_view> kHunkText{
+        "--- foo.txt\t2012-01-01",
+        "+++ foo-formatted.txt\t2012-01-01",
+        "@@ -1,2 +1,1 @@",
+        " aaa",
+        "-bbb",  // patch proposes to delete this line
+        "@@ -4,2 +3,3 @@",
+        " ddd",
+        "+DDD",  // and insert this line
+        " eee",
+    };
+    const auto status = ParseLines(kHunkText);
+    ASSERT_TRUE(status.ok()) << status.message();
+  }
+
+  constexpr absl::string_view kOriginal =
+      "aaa\n"
+      "bbb\n"  // deleted
+      "ccc\n"
+      "ddd\n"
+      "eee\n"
+      "fff";  // not terminated
+  constexpr absl::string_view kExpected =
+      "aaa\n"
+      "ccc\n"
+      "ddd\n"
+      "DDD\n"  // inserted
+      "eee\n"
+      "fff\n";
+
+  const auto status =
+      Apply(ReadStringFileSequence({{"foo.txt", kOriginal}}),
+            ExpectStringFileSequence({{"foo.txt", kExpected}}));
+  EXPECT_TRUE(status.ok()) << "Got: " << status.message();
+}
+
 TEST_F(FilePatchPickApplyTest, HelpFirstThenAcceptHunk) {
   {
     const std::vector<absl::string_view> kHunkText{
@@ -2329,5 +2373,149 @@ TEST_F(PatchSetPickApplyTest, FirstFilePatchOutOfOrder) {
   EXPECT_TRUE(absl::StrContains(status.message(), "not properly ordered"));
 }
 
+// Takes the place of a file system, which can be read and written
+// concurrently.
+class StringFileSystem {
+ public:
+  explicit StringFileSystem(std::map<std::string, std::string> files)
+      : files_(std::move(files)) {}
+
+  // like file::GetContentAsMemBlock()
+  absl::StatusOr<std::unique_ptr<MemBlock>> Read(absl::string_view filename) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = files_.find(std::string(filename));
+    if (found == files_.end()) {
+      return absl::NotFoundError(absl::StrCat("No such file: ", filename));
+    }
+    return std::make_unique<StringMemBlock>(found->second);
+  }
+
+  // like file::SetContents()
+  absl::Status Write(absl::string_view filename, absl::string_view contents) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    files_[std::string(filename)] = std::string(contents);
+    return absl::OkStatus();
+  }
+
+  internal::FileReaderFunction Reader() {
+    return [this](absl::string_view filename) { return Read(filename); };
+  }
+
+  internal::FileWriterFunction Writer() {
+    return [this](absl::string_view filename, absl::string_view contents) {
+      return Write(filename, contents);
+    };
+  }
+
+  const std::map<std::string, std::string> &Files() const { return files_; }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::string> files_;
+};
+
+class PatchSetApplyTest : public PatchSet, public ::testing::Test {};
+
+TEST_F(PatchSetApplyTest, ManyFilesInParallel) {
+  constexpr int kFiles = 50;
+  std::string patch_contents;
+  std::map<std::string, std::string> original_files;
+  std::map<std::string, std::string> expected_files;
+  for (int i = 0; i < kFiles; ++i) {
+    const std::string path = absl::StrCat("dir/file", i, ".txt");
+    absl::StrAppend(&patch_contents,                         //
+                    "--- ", path, "\t2020-03-30\n",          //
+                    "+++ ", path, "-formatted\t2020-03-30\n",  //
+                    "@@ -1,3 +1,3 @@\n",                      //
+                    " you\n",                                 //
+                    "-lose\n",                                //
+                    "+win", i, "\n",                          //
+                    " some\n");
+    original_files[path] = "you\nlose\nsome\nmore\n";
+    expected_files[path] = absl::StrCat("you\nwin", i, "\nsome\nmore\n");
+  }
+  {
+    const auto status = Parse(patch_contents);
+    ASSERT_TRUE(status.ok()) << status.message();
+  }
+
+  for (const int jobs : {0, 1, 4}) {
+    StringFileSystem files(original_files);
+    const auto status = Apply(jobs, files.Reader(), files.Writer());
+    EXPECT_TRUE(status.ok()) << "Got: " << status.message();
+    EXPECT_EQ(files.Files(), expected_files) << "jobs=" << jobs;
+  }
+}
+
+TEST_F(PatchSetApplyTest, SameFileTwiceAppliedInSequence) {
+  {
+    constexpr absl::string_view patch_contents =  //
+        "--- foo/bar.txt\t2020-03-30\n"
+        "+++ foo/bar-formatted.txt\t2020-03-30\n"
+        "@@ -1,3 +1,2 @@\n"
+        " you\n"
+        "-lose\n"
+        " some\n"
+        "--- bar/foo.txt\t2020-03-30\n"
+        "+++ bar/foo-formatted.txt\t2020-03-30\n"
+        "@@ -1,2 +1,3 @@\n"
+        " you\n"
+        "+win\n"
+        " some\n"
+        "--- foo/bar.txt\t2020-03-30\n"  // applies to the patched file
+        "+++ foo/bar-formatted.txt\t2020-03-30\n"
+        "@@ -1,2 +1,3 @@\n"
+        " you\n"
+        "+win\n"
+        " some\n";
+    const auto status = Parse(patch_contents);
+    ASSERT_TRUE(status.ok()) << status.message();
+  }
+
+  StringFileSystem files({
+      {"foo/bar.txt", "you\nlose\nsome\n"},
+      {"bar/foo.txt", "you\nsome\n"},
+  });
+  const auto status = Apply(4, files.Reader(), files.Writer());
+  EXPECT_TRUE(status.ok()) << "Got: " << status.message();
+  EXPECT_EQ(files.Files(), (std::map<std::string, std::string>{
+                               {"foo/bar.txt", "you\nwin\nsome\n"},
+                               {"bar/foo.txt", "you\nwin\nsome\n"},
+                           }));
+}
+
+TEST_F(PatchSetApplyTest, FirstErrorInFileOrder) {
+  {
+    constexpr absl::string_view patch_contents =  //
+        "--- foo/bar.txt\t2020-03-30\n"
+        "+++ foo/bar-formatted.txt\t2020-03-30\n"
+        "@@ -1,3 +1,2 @@\n"
+        " you\n"
+        "-lose\n"
+        " some\n"
+        "--- missing/first.txt\t2020-03-30\n"
+        "+++ missing/first.txt\t2020-03-30\n"
+        "@@ -1,1 +1,1 @@\n"
+        "-a\n"
+        "+b\n"
+        "--- missing/second.txt\t2020-03-30\n"
+        "+++ missing/second.txt\t2020-03-30\n"
+        "@@ -1,1 +1,1 @@\n"
+        "-a\n"
+        "+b\n";
+    const auto status = Parse(patch_contents);
+    ASSERT_TRUE(status.ok()) << status.message();
+  }
+
+  StringFileSystem files(std::map<std::string, std::string>{
+      {"foo/bar.txt", "you\nlose\nsome\n"}});
+  const auto status = Apply(4, files.Reader(), files.Writer());
+  EXPECT_FALSE(status.ok());
+  EXPECT_TRUE(absl::StrContains(status.message(), "missing/first.txt"))
+      << "Got: " << status.message();
+  // Files without errors are still patched.
+  EXPECT_EQ(files.Files().at("foo/bar.txt"), "you\nsome\n");
+}
+
 }  // namespace
 }  // namespace verible
@@ -0,0 +1,274 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/strings/text_rope.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+
+namespace verible {
+
+// Chunks are kept around this size: large enough to keep the tree small,
+// small enough to make edits within a chunk cheap.
+static constexpr size_t kChunkSize = 1024;
+
+// The tree is a treap keyed implicitly by text position: an in-order walk
+// visits the chunks in text order, and node priorities form a max-heap,
+// which keeps the expected depth logarithmic.
+struct TextRope::Node {
+  Node(absl::string_view chunk, uint32_t priority)
+      : text(chunk),
+        priority(priority),
+        text_newlines(std::count(chunk.begin(), chunk.end(), '\n')) {}
+
+  std::string text;
+  uint32_t priority;
+  size_t text_newlines;  // Number of '\n' in text.
+  size_t bytes = 0;      // Total length of this subtree.
+  size_t newlines = 0;   // Number of '\n' in this subtree.
+  NodePtr left;
+  NodePtr right;
+
+  static size_t Bytes(const NodePtr &node) { return node ? node->bytes : 0; }
+  static size_t Newlines(const NodePtr &node) {
+    return node ? node->newlines : 0;
+  }
+
+  // Recomputes the aggregates of this node from its children.
+  void Update() {
+    bytes = Bytes(left) + text.size() + Bytes(right);
+    newlines = Newlines(left) + text_newlines + Newlines(right);
+  }
+
+  static uint32_t NextPriority(uint32_t *state) {
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+  }
+
+  static NodePtr NewLeaf(absl::string_view chunk, uint32_t *state) {
+    NodePtr node = std::make_unique<Node>(chunk, NextPriority(state));
+    node->Update();
+    return node;
+  }
+
+  // Concatenates two trees.
+  static NodePtr Merge(NodePtr left, NodePtr right) {
+    if (!left) return right;
+    if (!right) return left;
+    if (left->priority > right->priority) {
+      left->right = Merge(std::move(left->right), std::move(right));
+      left->Update();
+      return left;
+    }
+    right->left = Merge(std::move(left), std::move(right->left));
+    right->Update();
+    return right;
+  }
+
+  // Splits "node" into the first "offset" bytes and the rest.
+  static void Split(NodePtr node, size_t offset, NodePtr *first,
+                    NodePtr *rest, uint32_t *state) {
+    if (!node) {
+      first->reset();
+      rest->reset();
+      return;
+    }
+    const size_t left_bytes = Bytes(node->left);
+    if (offset <= left_bytes) {
+      NodePtr left_rest;
+      Split(std::move(node->left), offset, first, &left_rest, state);
+      node->left = std::move(left_rest);
+      node->Update();
+      *rest = std::move(node);
+      return;
+    }
+    const size_t chunk_end = left_bytes + node->text.size();
+    if (offset >= chunk_end) {
+      NodePtr right_first;
+      Split(std::move(node->right), offset - chunk_end, &right_first, rest,
+            state);
+      node->right = std::move(right_first);
+      node->Update();
+      *first = std::move(node);
+      return;
+    }
+    // The split point is inside this node's chunk.
+    const size_t cut = offset - left_bytes;
+    NodePtr tail = NewLeaf(absl::string_view(node->text).substr(cut), state);
+    NodePtr right = std::move(node->right);
+    node->text.resize(cut);
+    node->text_newlines -= tail->text_newlines;
+    node->Update();
+    *first = std::move(node);
+    *rest = Merge(std::move(tail), std::move(right));
+  }
+
+  // Removes the last chunk of "tree" and returns its text.
+  static std::string PopBack(NodePtr *tree) {
+    Node *const node = tree->get();
+    if (!node) return "";
+    if (node->right) {
+      std::string result = PopBack(&node->right);
+      node->Update();
+      return result;
+    }
+    std::string result = std::move(node->text);
+    *tree = std::move(node->left);
+    return result;
+  }
+
+  // Removes the first chunk of "tree" and returns its text.
+  static std::string PopFront(NodePtr *tree) {
+    Node *const node = tree->get();
+    if (!node) return "";
+    if (node->left) {
+      std::string result = PopFront(&node->left);
+      node->Update();
+      return result;
+    }
+    std::string result = std::move(node->text);
+    *tree = std::move(node->right);
+    return result;
+  }
+
+  // Builds a tree from "text" cut into "num_chunks" chunks of about equal
+  // length.
+  static NodePtr Build(absl::string_view text, size_t num_chunks,
+                       uint32_t *state) {
+    if (num_chunks == 0) return nullptr;
+    if (num_chunks == 1) return NewLeaf(text, state);
+    const size_t half_chunks = num_chunks / 2;
+    const size_t half_bytes = text.size() * half_chunks / num_chunks;
+    NodePtr first = Build(text.substr(0, half_bytes), half_chunks, state);
+    NodePtr rest =
+        Build(text.substr(half_bytes), num_chunks - half_chunks, state);
+    return Merge(std::move(first), std::move(rest));
+  }
+
+  static NodePtr Build(absl::string_view text, uint32_t *state) {
+    return Build(text, (text.size() + kChunkSize - 1) / kChunkSize, state);
+  }
+
+  static void AppendRange(const Node *node, size_t offset, size_t length,
+                          std::string *out) {
+    while (node && length > 0) {
+      const size_t left_bytes = Bytes(node->left);
+      if (offset < left_bytes) {
+        const size_t from_left = std::min(length, left_bytes - offset);
+        AppendRange(node->left.get(), offset, from_left, out);
+        offset += from_left;
+        length -= from_left;
+        if (length == 0) return;
+      }
+      const size_t in_chunk = offset - left_bytes;
+      if (in_chunk < node->text.size()) {
+        const size_t from_chunk =
+            std::min(length, node->text.size() - in_chunk);
+        out->append(node->text, in_chunk, from_chunk);
+        offset += from_chunk;
+        length -= from_chunk;
+      }
+      offset -= left_bytes + node->text.size();
+      node = node->right.get();
+    }
+  }
+};
+
+TextRope::TextRope() = default;
+
+TextRope::TextRope(absl::string_view text) { Assign(text); }
+
+TextRope::~TextRope() = default;
+
+size_t TextRope::size() const { return Node::Bytes(root_); }
+
+size_t TextRope::newlines() const { return Node::Newlines(root_); }
+
+size_t TextRope::LineStart(size_t line) const {
+  if (line == 0) return 0;
+  if (line > newlines()) return size();
+  // Find the line-th newline.
+  size_t remaining = line;
+  size_t base = 0;
+  const Node *node = root_.get();
+  while (node) {
+    const size_t left_newlines = Node::Newlines(node->left);
+    if (remaining <= left_newlines) {
+      node = node->left.get();
+      continue;
+    }
+    remaining -= left_newlines;
+    base += Node::Bytes(node->left);
+    if (remaining > node->text_newlines) {
+      remaining -= node->text_newlines;
+      base += node->text.size();
+      node = node->right.get();
+      continue;
+    }
+    const std::string &text = node->text;
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+      if (text[pos] == '\n' && --remaining == 0) return base + pos + 1;
+    }
+  }
+  return size();  // not reached
+}
+
+void TextRope::AppendTo(size_t offset, size_t length, std::string *out) const {
+  if (offset >= size()) return;
+  length = std::min(length, size() - offset);
+  out->reserve(out->size() + length);
+  Node::AppendRange(root_.get(), offset, length, out);
+}
+
+std::string TextRope::Substr(size_t offset, size_t length) const {
+  std::string result;
+  AppendTo(offset, length, &result);
+  return result;
+}
+
+void TextRope::Replace(size_t offset, size_t length, absl::string_view text) {
+  offset = std::min(offset, size());
+  length = std::min(length, size() - offset);
+
+  NodePtr first;
+  NodePtr rest;
+  NodePtr replaced;
+  NodePtr last;
+  Node::Split(std::move(root_), offset, &first, &rest, &random_state_);
+  Node::Split(std::move(rest), length, &replaced, &last, &random_state_);
+  replaced.reset();
+
+  // Re-chunk the new text together with the chunks adjacent to the edit, so
+  // that repeated small edits don't leave a trail of tiny chunks behind.
+  std::string assembly = Node::PopBack(&first);
+  assembly.append(text.begin(), text.end());
+  assembly.append(Node::PopFront(&last));
+
+  root_ = Node::Merge(
+      Node::Merge(std::move(first), Node::Build(assembly, &random_state_)),
+      std::move(last));
+}
+
+}  // namespace verible
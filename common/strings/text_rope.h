@@ -0,0 +1,83 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_STRINGS_TEXT_ROPE_H_
+#define VERIBLE_COMMON_STRINGS_TEXT_ROPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace verible {
+
+// TextRope is a mutable text, stored as a balanced tree of chunks of bounded
+// size.  Each subtree knows its length in bytes and the number of newlines
+// it contains, so replacing a range of text and finding the start of a line
+// take time logarithmic in the size of the text (plus the length of the
+// replacement), independent of how many lines the text has.
+class TextRope {
+ public:
+  TextRope();
+  explicit TextRope(absl::string_view text);
+  ~TextRope();
+
+  TextRope(const TextRope &) = delete;
+  TextRope &operator=(const TextRope &) = delete;
+
+  // Length of the text in bytes.
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // Number of '\n' characters in the text.
+  size_t newlines() const;
+
+  // Returns the byte offset of the first character of line "line"
+  // (0-based), which is the position after the line-th newline.
+  // Lines past the end of the text start at size().
+  size_t LineStart(size_t line) const;
+
+  // Appends "length" bytes starting at "offset" to "out".  The range is
+  // clipped to the text.
+  void AppendTo(size_t offset, size_t length, std::string *out) const;
+
+  // Returns the range [offset, offset + length) as a string.
+  std::string Substr(size_t offset, size_t length) const;
+
+  // Returns the whole text as a flat string.
+  std::string ToString() const { return Substr(0, size()); }
+
+  // Replaces "length" bytes starting at "offset" with "text".  The range is
+  // clipped to the text.
+  void Replace(size_t offset, size_t length, absl::string_view text);
+
+  // Replaces the whole text.
+  void Assign(absl::string_view text) { Replace(0, size(), text); }
+
+ private:
+  struct Node;
+  using NodePtr = std::unique_ptr<Node>;
+
+  NodePtr root_;
+
+  // State of the generator for node priorities.  Deterministic, so that the
+  // tree shape only depends on the edit history.
+  uint32_t random_state_ = 0x9e3779b9;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_STRINGS_TEXT_ROPE_H_
@@ -0,0 +1,111 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/strings/text_rope.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(TextRopeTest, Empty) {
+  const TextRope rope;
+  EXPECT_TRUE(rope.empty());
+  EXPECT_EQ(rope.size(), 0);
+  EXPECT_EQ(rope.newlines(), 0);
+  EXPECT_EQ(rope.LineStart(0), 0);
+  EXPECT_EQ(rope.LineStart(3), 0);
+  EXPECT_EQ(rope.ToString(), "");
+}
+
+TEST(TextRopeTest, ConstructFromText) {
+  const TextRope rope("foo\nbar\n\nbaz");
+  EXPECT_EQ(rope.size(), 12);
+  EXPECT_EQ(rope.newlines(), 3);
+  EXPECT_EQ(rope.ToString(), "foo\nbar\n\nbaz");
+  EXPECT_EQ(rope.LineStart(0), 0);
+  EXPECT_EQ(rope.LineStart(1), 4);
+  EXPECT_EQ(rope.LineStart(2), 8);
+  EXPECT_EQ(rope.LineStart(3), 9);
+  EXPECT_EQ(rope.LineStart(4), 12);  // past the end
+}
+
+TEST(TextRopeTest, SubstrIsClipped) {
+  const TextRope rope("Hello World");
+  EXPECT_EQ(rope.Substr(6, 5), "World");
+  EXPECT_EQ(rope.Substr(6, 100), "World");
+  EXPECT_EQ(rope.Substr(100, 5), "");
+}
+
+TEST(TextRopeTest, Replace) {
+  TextRope rope("Hello World\n");
+  rope.Replace(6, 5, "brave\nnew world");
+  EXPECT_EQ(rope.ToString(), "Hello brave\nnew world\n");
+  EXPECT_EQ(rope.newlines(), 2);
+  rope.Replace(0, 6, "");
+  EXPECT_EQ(rope.ToString(), "brave\nnew world\n");
+  rope.Replace(rope.size(), 0, "end");
+  EXPECT_EQ(rope.ToString(), "brave\nnew world\nend");
+  rope.Replace(9, 1000, "");  // clipped
+  EXPECT_EQ(rope.ToString(), "brave\nnew");
+  rope.Assign("");
+  EXPECT_TRUE(rope.empty());
+}
+
+// Compare against a plain std::string with many random edits of a text that
+// spans many chunks.
+TEST(TextRopeTest, RandomEditsMatchString) {
+  std::string reference;
+  for (int i = 0; i < 2000; ++i) {
+    absl::StrAppend(&reference, "line ", i, (i % 7 == 0) ? "\n\n" : "\n");
+  }
+  TextRope rope(reference);
+
+  std::mt19937 rng(42);
+  for (int edit = 0; edit < 2000; ++edit) {
+    const size_t offset = rng() % (reference.size() + 1);
+    const size_t length = std::min<size_t>(rng() % 50, reference.size());
+    std::string text(rng() % 20, 'x');
+    for (char &c : text) {
+      if (rng() % 4 == 0) c = '\n';
+    }
+    rope.Replace(offset, length, text);
+    reference.replace(offset, std::min(length, reference.size() - offset),
+                      text);
+
+    ASSERT_EQ(rope.size(), reference.size());
+    const size_t newlines =
+        std::count(reference.begin(), reference.end(), '\n');
+    ASSERT_EQ(rope.newlines(), newlines);
+    const size_t line = rng() % (newlines + 1);
+    size_t expected_start = 0;
+    for (size_t i = 0; i < line; ++i) {
+      expected_start = reference.find('\n', expected_start) + 1;
+    }
+    ASSERT_EQ(rope.LineStart(line), expected_start);
+    const size_t sub_offset = rng() % (reference.size() + 1);
+    ASSERT_EQ(rope.Substr(sub_offset, 3000),
+              reference.substr(sub_offset, 3000));
+  }
+  EXPECT_EQ(rope.ToString(), reference);
+}
+
+}  // namespace
+}  // namespace verible
@@ -15,27 +15,71 @@
 #ifndef VERIBLE_COMMON_STRINGS_UTF8_H_
 #define VERIBLE_COMMON_STRINGS_UTF8_H_
 
-#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
+#include "absl/numeric/bits.h"
 #include "absl/strings/string_view.h"
 
 namespace verible {
+namespace utf8_internal {
+// The UTF-8 kernels look at eight bytes at a time in a 64 bit word, which
+// every compiler handles well without target specific instructions.
+inline constexpr size_t kWordSize = sizeof(uint64_t);
+inline constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+inline uint64_t LoadWord(const char *p) {
+  uint64_t word;
+  std::memcpy(&word, p, kWordSize);
+  return word;
+}
+
+// Returns the number of bytes of "word" that start a code point, i.e. that
+// are not continuation bytes 0b10xxxxxx.
+inline int CountCodePointStarts(uint64_t word) {
+  if ((word & kHighBits) == 0) return kWordSize;  // All ASCII.
+  // The high bit of each continuation byte is set, and the bit below clear.
+  const uint64_t continuation = word & ~(word << 1) & kHighBits;
+  return kWordSize - absl::popcount(continuation);
+}
+}  // namespace utf8_internal
+
 // Determine length in characters of an UTF8-encoded string.
 inline int utf8_len(absl::string_view str) {
-  return std::count_if(str.begin(), str.end(),
-                       [](char c) { return (c & 0xc0) != 0x80; });
+  using utf8_internal::kWordSize;
+  const char *p = str.data();
+  const char *const end = p + str.size();
+  int count = 0;
+  for (; end - p >= static_cast<ptrdiff_t>(kWordSize); p += kWordSize) {
+    count += utf8_internal::CountCodePointStarts(utf8_internal::LoadWord(p));
+  }
+  for (; p != end; ++p) {
+    if ((*p & 0xc0) != 0x80) ++count;
+  }
+  return count;
 }
 
 // Returns the substring starting from the given character
 // of the UTF8-encoded string.
 inline absl::string_view utf8_substr(absl::string_view str,
                                      size_t character_pos) {
+  using utf8_internal::kWordSize;
   // Strategy: whenever we see a start of a utf8 codepoint bump the expected
-  // remaining by number of expected bytes
+  // remaining by number of expected bytes.  Runs of ASCII are skipped a word
+  // at a time.
   size_t remaining = character_pos;
-  absl::string_view::const_iterator it;
-  for (it = str.begin(); remaining && it != str.end(); ++it, --remaining) {
+  const char *it = str.data();
+  const char *const end = it + str.size();
+  while (remaining != 0 && it != end) {
+    if (remaining >= kWordSize &&
+        end - it >= static_cast<ptrdiff_t>(kWordSize) &&
+        (utf8_internal::LoadWord(it) & utf8_internal::kHighBits) == 0) {
+      it += kWordSize;
+      remaining -= kWordSize;
+      continue;
+    }
     if ((*it & 0xE0) == 0xC0) {
       remaining += 1;
     } else if ((*it & 0xF0) == 0xE0) {
@@ -43,8 +87,10 @@ inline absl::string_view utf8_substr(absl::string_view str,
     } else if ((*it & 0xF8) == 0xF0) {
       remaining += 3;
     }
+    ++it;
+    --remaining;
   }
-  return str.substr(it - str.begin());
+  return str.substr(it - str.data());
 }
 
 inline absl::string_view utf8_substr(absl::string_view str,
@@ -54,6 +100,25 @@ inline absl::string_view utf8_substr(absl::string_view str,
   const absl::string_view chop_end = utf8_substr(prefix, character_len);
   return {prefix.data(), prefix.length() - chop_end.length()};
 }
+
+// Returns the byte offsets of the "sorted_character_positions" in the
+// UTF8-encoded string, in one pass over it.  Positions beyond the end map to
+// the length of the string.
+inline std::vector<size_t> utf8_byte_offsets(
+    absl::string_view str, const std::vector<int> &sorted_character_positions) {
+  std::vector<size_t> result;
+  result.reserve(sorted_character_positions.size());
+  absl::string_view rest = str;
+  int rest_position = 0;  // character position where "rest" starts
+  for (const int position : sorted_character_positions) {
+    if (position > rest_position) {
+      rest = utf8_substr(rest, position - rest_position);
+      rest_position = position;
+    }
+    result.push_back(str.length() - rest.length());
+  }
+  return result;
+}
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_STRINGS_UTF8_H_
@@ -14,6 +14,8 @@
 #include "common/strings/utf8.h"
 
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -95,5 +97,36 @@ TEST(UTF8Util, Utf8SubstrRangeTest) {
   EXPECT_EQ(utf8_substr("Heizölrückstoßabdämpfung", 6, 8), "rückstoß");
   EXPECT_EQ(utf8_substr("Heizölrückstoßabdämpfung", 14, 10), "abdämpfung");
 }
+
+// Texts longer than a word, with ASCII runs and multi-byte characters at all
+// alignments.
+TEST(UTF8Util, LongTextsAcrossWords) {
+  const std::string ascii(37, 'x');
+  for (size_t prefix = 0; prefix < 10; ++prefix) {
+    const std::string text =
+        ascii.substr(0, prefix) + "ä" + ascii + "😀‱" + ascii.substr(prefix);
+    const int characters = 2 * ascii.size() + 3;
+    EXPECT_EQ(utf8_len(text), characters) << prefix;
+    EXPECT_EQ(utf8_substr(text, prefix),
+              "ä" + ascii + "😀‱" + ascii.substr(prefix));
+    EXPECT_EQ(utf8_substr(text, prefix + 1 + ascii.size()),
+              "😀‱" + ascii.substr(prefix));
+    EXPECT_EQ(utf8_substr(text, characters - 3), "xxx");
+    EXPECT_EQ(utf8_substr(text, characters), "");
+    EXPECT_EQ(utf8_substr(text, characters + 20), "");
+  }
+}
+
+TEST(UTF8Util, Utf8ByteOffsetsTest) {
+  EXPECT_TRUE(utf8_byte_offsets("abc", {}).empty());
+  EXPECT_EQ(utf8_byte_offsets("", {0, 3}), (std::vector<size_t>{0, 0}));
+  EXPECT_EQ(utf8_byte_offsets("abc", {0, 1, 1, 3, 42}),
+            (std::vector<size_t>{0, 1, 1, 3, 3}));
+  // "Heiz" "ö" "lr" "ü" "ckstoßabdämpfung"
+  EXPECT_EQ(utf8_byte_offsets("Heizölrückstoßabdämpfung", {4, 5, 7, 8, 24}),
+            (std::vector<size_t>{4, 6, 8, 10, 28}));
+  EXPECT_EQ(utf8_byte_offsets("😀‱ü", {1, 2, 3}),
+            (std::vector<size_t>{4, 7, 9}));
+}
 }  // namespace
 }  // namespace verible
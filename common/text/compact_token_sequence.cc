@@ -0,0 +1,55 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/compact_token_sequence.h"
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/logging.h"
+#include "common/util/range.h"
+
+namespace verible {
+
+static_assert(sizeof(CompactToken) <= 12, "CompactToken grew");
+
+CompactToken::CompactToken(const TokenInfo &token, absl::string_view base)
+    : offset_(token.left(base)),
+      length_(token.text().length()),
+      token_enum_(token.token_enum()) {
+  CHECK(IsSubRange(token.text(), base)) << token;
+  CHECK_LE(base.length(), UINT32_MAX);
+  CHECK_GE(token.token_enum(), 0);
+  CHECK_LE(token.token_enum(), kMaxTokenEnum);
+}
+
+CompactTokenSequence::CompactTokenSequence(absl::string_view base,
+                                           const TokenSequence &tokens)
+    : base_(base) {
+  tokens_.reserve(tokens.size());
+  for (const TokenInfo &token : tokens) push_back(token);
+}
+
+TokenSequence CompactTokenSequence::ToTokenSequence() const {
+  TokenSequence tokens;
+  tokens.reserve(size());
+  for (const CompactToken &token : tokens_) {
+    tokens.push_back(token.ToTokenInfo(base_));
+  }
+  return tokens;
+}
+
+}  // namespace verible
@@ -0,0 +1,162 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_TEXT_COMPACT_TOKEN_SEQUENCE_H_
+#define VERIBLE_COMMON_TEXT_COMPACT_TOKEN_SEQUENCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+
+namespace verible {
+
+// CompactToken is a token that refers to its text by offset and length into
+// a base text, instead of by string_view.  It takes 12 bytes, half the size
+// of a TokenInfo, at the cost of needing the base to recover the text.
+class CompactToken {
+ public:
+  // Largest token enum that can be represented.
+  static constexpr int kMaxTokenEnum = UINT16_MAX;
+
+  // "token" must lie within "base", and its enum be in [0, kMaxTokenEnum].
+  CompactToken(const TokenInfo &token, absl::string_view base);
+
+  int token_enum() const { return token_enum_; }
+
+  // Byte offsets of the token's text relative to the base.
+  int left() const { return offset_; }
+  int right() const { return offset_ + length_; }
+
+  absl::string_view text(absl::string_view base) const {
+    return base.substr(offset_, length_);
+  }
+
+  // Returns the TokenInfo this was made from, given the same "base".
+  TokenInfo ToTokenInfo(absl::string_view base) const {
+    return TokenInfo(token_enum_, text(base));
+  }
+
+ private:
+  uint32_t offset_;
+  uint32_t length_;
+  uint16_t token_enum_;
+};
+
+// CompactTokenSequence stores a token sequence over one text as
+// CompactTokens.  Iterating and indexing yield TokenInfo values, so code that
+// reads tokens through text() and token_enum() works unchanged.  The text
+// must outlive the sequence.
+class CompactTokenSequence {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = TokenInfo;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = TokenInfo;
+
+    const_iterator(std::vector<CompactToken>::const_iterator iter,
+                   absl::string_view base)
+        : iter_(iter), base_(base) {}
+
+    TokenInfo operator*() const { return iter_->ToTokenInfo(base_); }
+    TokenInfo operator[](difference_type n) const {
+      return iter_[n].ToTokenInfo(base_);
+    }
+
+    const_iterator &operator++() {
+      ++iter_;
+      return *this;
+    }
+    const_iterator operator++(int) { return const_iterator(iter_++, base_); }
+    const_iterator &operator--() {
+      --iter_;
+      return *this;
+    }
+    const_iterator operator--(int) { return const_iterator(iter_--, base_); }
+    const_iterator &operator+=(difference_type n) {
+      iter_ += n;
+      return *this;
+    }
+    const_iterator &operator-=(difference_type n) {
+      iter_ -= n;
+      return *this;
+    }
+    const_iterator operator+(difference_type n) const {
+      return const_iterator(iter_ + n, base_);
+    }
+    const_iterator operator-(difference_type n) const {
+      return const_iterator(iter_ - n, base_);
+    }
+    difference_type operator-(const const_iterator &other) const {
+      return iter_ - other.iter_;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return iter_ == other.iter_;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return iter_ != other.iter_;
+    }
+    bool operator<(const const_iterator &other) const {
+      return iter_ < other.iter_;
+    }
+
+    // The underlying compact token.
+    const CompactToken &compact() const { return *iter_; }
+
+   private:
+    std::vector<CompactToken>::const_iterator iter_;
+    absl::string_view base_;
+  };
+
+  explicit CompactTokenSequence(absl::string_view base) : base_(base) {}
+
+  // Converts "tokens", which must all lie within "base".
+  CompactTokenSequence(absl::string_view base, const TokenSequence &tokens);
+
+  absl::string_view base() const { return base_; }
+
+  size_t size() const { return tokens_.size(); }
+  bool empty() const { return tokens_.empty(); }
+  void reserve(size_t n) { tokens_.reserve(n); }
+
+  void push_back(const TokenInfo &token) { tokens_.emplace_back(token, base_); }
+
+  TokenInfo operator[](size_t i) const { return tokens_[i].ToTokenInfo(base_); }
+  TokenInfo front() const { return (*this)[0]; }
+  TokenInfo back() const { return (*this)[size() - 1]; }
+
+  const_iterator begin() const {
+    return const_iterator(tokens_.begin(), base_);
+  }
+  const_iterator end() const { return const_iterator(tokens_.end(), base_); }
+
+  // Returns the equivalent TokenSequence.
+  TokenSequence ToTokenSequence() const;
+
+ private:
+  absl::string_view base_;
+  std::vector<CompactToken> tokens_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_COMPACT_TOKEN_SEQUENCE_H_
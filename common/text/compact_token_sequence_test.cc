@@ -0,0 +1,99 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/compact_token_sequence.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(CompactTokenTest, RoundTrip) {
+  constexpr absl::string_view text("module m;");
+  const TokenInfo token(7, text.substr(7, 1));
+  const CompactToken compact(token, text);
+  EXPECT_EQ(compact.token_enum(), 7);
+  EXPECT_EQ(compact.left(), 7);
+  EXPECT_EQ(compact.right(), 8);
+  EXPECT_EQ(compact.text(text), "m");
+  EXPECT_EQ(compact.ToTokenInfo(text), token);
+}
+
+TEST(CompactTokenTest, OutsideOfBase) {
+  constexpr absl::string_view text("module m;");
+  constexpr absl::string_view other("other");
+  EXPECT_DEATH(CompactToken(TokenInfo(1, other), text), "");
+  EXPECT_DEATH(CompactToken(TokenInfo(CompactToken::kMaxTokenEnum + 1,
+                                      text.substr(0, 1)),
+                            text),
+               "");
+}
+
+TEST(CompactTokenSequenceTest, Empty) {
+  const CompactTokenSequence tokens("");
+  EXPECT_TRUE(tokens.empty());
+  EXPECT_EQ(tokens.begin(), tokens.end());
+  EXPECT_TRUE(tokens.ToTokenSequence().empty());
+}
+
+TEST(CompactTokenSequenceTest, SameTokensAsTokenSequence) {
+  constexpr absl::string_view text("reg [3:0] r;");
+  const TokenSequence expected = {
+      TokenInfo(1, text.substr(0, 3)),  TokenInfo(2, text.substr(3, 1)),
+      TokenInfo(3, text.substr(4, 1)),  TokenInfo(4, text.substr(5, 1)),
+      TokenInfo(3, text.substr(6, 1)),  TokenInfo(4, text.substr(7, 1)),
+      TokenInfo(3, text.substr(8, 1)),  TokenInfo(2, text.substr(9, 1)),
+      TokenInfo(5, text.substr(10, 1)), TokenInfo(3, text.substr(11, 1)),
+      TokenInfo::EOFToken(text),
+  };
+  const CompactTokenSequence tokens(text, expected);
+  ASSERT_EQ(tokens.size(), expected.size());
+  EXPECT_EQ(tokens.base(), text);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(tokens[i], expected[i]) << i;
+  }
+  EXPECT_EQ(tokens.front(), expected.front());
+  EXPECT_EQ(tokens.back(), expected.back());
+  EXPECT_TRUE(tokens.back().isEOF());
+  EXPECT_TRUE(std::equal(tokens.begin(), tokens.end(), expected.begin(),
+                         expected.end()));
+  EXPECT_EQ(tokens.ToTokenSequence(), expected);
+
+  auto iter = tokens.begin();
+  EXPECT_EQ(std::distance(iter, tokens.end()), expected.size());
+  iter += 3;
+  EXPECT_EQ((*iter).text(), "3");
+  EXPECT_EQ(iter.compact().left(), 5);
+  EXPECT_EQ(iter[-1].text(), "[");
+  EXPECT_EQ(iter - 3, tokens.begin());
+}
+
+TEST(CompactTokenSequenceTest, PushBack) {
+  constexpr absl::string_view text("a b");
+  CompactTokenSequence tokens(text);
+  tokens.push_back(TokenInfo(1, text.substr(2, 1)));
+  ASSERT_EQ(tokens.size(), 1);
+  EXPECT_EQ(tokens[0].text(), "b");
+  EXPECT_EQ(tokens[0].text().data(), text.data() + 2);
+}
+
+}  // namespace
+}  // namespace verible
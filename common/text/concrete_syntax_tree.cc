@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "common/text/symbol.h"
 #include "common/text/tree_compare.h"
@@ -26,6 +27,30 @@
 
 namespace verible {
 
+// Moves subtree-node children of "children" onto "pending", leaving leaves
+// in place.
+static void DetachChildNodes(SyntaxTreeNode::ChildContainer *children,
+                             std::vector<SymbolPtr> *pending) {
+  for (auto &child : *children) {
+    if (child != nullptr && child->Kind() == SymbolKind::kNode) {
+      pending->push_back(std::move(child));
+    }
+  }
+}
+
+SyntaxTreeNode::~SyntaxTreeNode() {
+  std::vector<SymbolPtr> pending;
+  DetachChildNodes(&children_, &pending);
+  while (!pending.empty()) {
+    SymbolPtr node = std::move(pending.back());
+    pending.pop_back();
+    // Once its child nodes are detached, destroying "node" only releases
+    // leaves, and the nested destructor call finds nothing to detach.
+    DetachChildNodes(&down_cast<SyntaxTreeNode *>(node.get())->children_,
+                     &pending);
+  }
+}
+
 // Checks if this is equal to SymbolPtr node under compare_token function
 bool SyntaxTreeNode::equals(const Symbol *symbol,
                             const TokenComparator &compare_tokens) const {
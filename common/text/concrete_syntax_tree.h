@@ -81,6 +81,10 @@ class SyntaxTreeNode final : public Symbol {
 
   explicit SyntaxTreeNode(const int tag = kUntagged) : tag_(tag) {}
 
+  // Destroys all descendants iteratively, so that very deep or very large
+  // trees do not recurse once per level (and cannot overflow the stack).
+  ~SyntaxTreeNode() final;
+
   // Transfer ownership of argument to this object.
   // Call MakeNode or ExtendNode instead of calling this directly.
   void AppendChild(SymbolPtr child) {
@@ -97,8 +101,7 @@ class SyntaxTreeNode final : public Symbol {
       return;
     }
     auto *node = down_cast<SyntaxTreeNode *>(forwarded_children.node.get());
-    const auto new_size = children_.size() + node->children_.size();
-    children_.reserve(new_size);
+    ReserveAdditionalChildren(node->children_.size());
     for (auto &child : node->children_) {
       children_.emplace_back(std::move(child));
     }
@@ -106,15 +109,14 @@ class SyntaxTreeNode final : public Symbol {
     node->children_.clear();
   }
 
-  // This no-op case is the base case for the variadic Append.
-  void Append() const {}
-
   // Ownership of all arguments is transferred to this object.
   // Call MakeNode or ExtendNode instead of calling Append directly.
-  template <typename T, typename... Args>
-  void Append(T &&t, Args &&...args) {
-    AppendChild(std::move(t));            // Append the first.
-    Append(std::forward<Args>(args)...);  // Append the rest.
+  // Space for all new children is reserved up front, so that a node built
+  // by MakeNode() is allocated once at its final size.
+  template <typename... Args>
+  void Append(Args &&...args) {
+    ReserveAdditionalChildren((CountAppendedChildren(args) + ... + 0));
+    (AppendChild(std::move(args)), ...);  // in argument order
   }
 
   // Children accessor (mutable).
@@ -133,6 +135,8 @@ class SyntaxTreeNode final : public Symbol {
 
   size_t size() const { return children_.size(); }
   bool empty() const { return children_.empty(); }
+  // Number of children this node has room for without reallocating.
+  size_t capacity() const { return children_.capacity(); }
 
   ConstRange children() const {
     return ConstRange(children_.cbegin(), children_.cend());
@@ -199,6 +203,26 @@ class SyntaxTreeNode final : public Symbol {
   }
 
  private:
+  // Number of children that appending a single argument will add.
+  template <typename T>
+  static size_t CountAppendedChildren(const T &) {
+    return 1;
+  }
+  static size_t CountAppendedChildren(const ForwardChildren &forwarded) {
+    if (forwarded.node == nullptr) return 0;
+    if (forwarded.node->Kind() != SymbolKind::kNode) return 1;
+    return down_cast<const SyntaxTreeNode *>(forwarded.node.get())->size();
+  }
+
+  // Ensures capacity for n more children.  Growth stays geometric, so that
+  // left-recursive list rules that repeatedly ExtendNode() the same node
+  // (possibly with ForwardChildren) remain amortized linear.
+  void ReserveAdditionalChildren(size_t n) {
+    const size_t needed = children_.size() + n;
+    if (needed <= children_.capacity()) return;
+    children_.reserve(std::max(needed, 2 * children_.capacity()));
+  }
+
   // This tag would really prefer to be a language-specific node enumeration
   // type, but that would (IMHO) create unecessary templating.
   // Decision: Keep this a generic int.
@@ -349,6 +349,35 @@ TEST(ExtendNodeTest, AdoptChildrenMixed) {
   }
 }
 
+// Test repeated list extension, like a left-recursive list rule.
+TEST(ExtendNodeTest, ExtendLongListPreservesOrder) {
+  constexpr int kItems = 100;
+  auto list = MakeNode();
+  for (int i = 0; i < kItems; ++i) {
+    auto pair = MakeNode(MakeTaggedNode(2 * i), MakeTaggedNode(2 * i + 1));
+    list = ExtendNode(list, ForwardChildren(pair));
+  }
+  auto listnode = CheckTree(list);
+  ASSERT_THAT(listnode, NotNull());
+  ASSERT_THAT(*listnode, SizeIs(2 * kItems));
+  int expected_tag = 0;
+  for (const auto &child : listnode->children()) {
+    ASSERT_THAT(child, NotNull());
+    EXPECT_EQ(child->Tag().tag, expected_tag++);
+  }
+}
+
+// Test that destroying a very deep tree does not overflow the stack.
+TEST(SyntaxTreeNodeDestructorTest, DeepTree) {
+  constexpr int kDepth = 1 << 20;
+  auto tree = MakeNode();
+  for (int i = 0; i < kDepth; ++i) {
+    tree = MakeNode(tree, MakeNode());
+  }
+  tree.reset();
+  EXPECT_THAT(tree, IsNull());
+}
+
 // Tests setting a placeholder to a single leaf
 TEST(ExtendNodeTest, SetChild0Size1) {
   auto expected = Node(Leaf(4, "z"));
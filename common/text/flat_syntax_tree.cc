@@ -0,0 +1,164 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/flat_syntax_tree.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/text/tree_utils.h"
+#include "common/util/iterator_range.h"
+#include "common/util/logging.h"
+
+namespace verible {
+
+FlatSyntaxTree::SymbolRef FlatSyntaxTree::LeafRef(const TokenInfo &token) {
+  // Tokens are in text order, so the leaf's token is found by the position
+  // of its text.
+  const std::less<const char *> before;
+  const auto found = std::lower_bound(
+      tokens_->begin(), tokens_->end(), token.text().data(),
+      [&before](const TokenInfo &t, const char *text) {
+        return before(t.text().data(), text);
+      });
+  for (auto iter = found;
+       iter != tokens_->end() && iter->text().data() == token.text().data();
+       ++iter) {
+    if (*iter == token) {
+      return SymbolRef::Leaf(std::distance(tokens_->begin(), iter));
+    }
+  }
+  extra_tokens_.push_back(token);
+  const size_t index = tokens_->size() + extra_tokens_.size() - 1;
+  CHECK_LE(index, SymbolRef::kMaxIndex);
+  return SymbolRef::Leaf(index);
+}
+
+FlatSyntaxTree FlatSyntaxTree::FromTree(const Symbol *root,
+                                        const TokenSequence &tokens) {
+  FlatSyntaxTree tree(tokens);
+  if (root == nullptr) return tree;
+
+  // Symbols still to be flattened, with the child slot to fill with their
+  // reference.  The root has no slot.
+  constexpr size_t kRootSlot = ~size_t{0};
+  std::vector<std::pair<const Symbol *, size_t>> to_visit = {{root, kRootSlot}};
+  while (!to_visit.empty()) {
+    const auto [symbol, slot] = to_visit.back();
+    to_visit.pop_back();
+    SymbolRef ref = SymbolRef::Null();
+    if (symbol == nullptr) {
+      // Null child.
+    } else if (symbol->Kind() == SymbolKind::kLeaf) {
+      ref = tree.LeafRef(SymbolCastToLeaf(*symbol).get());
+    } else {
+      const SyntaxTreeNode &node = SymbolCastToNode(*symbol);
+      CHECK_LE(tree.nodes_.size(), SymbolRef::kMaxIndex);
+      ref = SymbolRef::Node(tree.nodes_.size());
+      const uint32_t first_child = tree.children_.size();
+      tree.nodes_.push_back({node.Tag().tag, first_child,
+                             static_cast<uint32_t>(node.size())});
+      tree.children_.resize(first_child + node.size(), SymbolRef::Null());
+      for (size_t i = node.size(); i > 0; --i) {
+        to_visit.emplace_back(node[i - 1].get(), first_child + i - 1);
+      }
+    }
+    if (slot == kRootSlot) {
+      tree.root_ = ref;
+    } else {
+      tree.children_[slot] = ref;
+    }
+  }
+  return tree;
+}
+
+FlatSyntaxTree::ChildRange FlatSyntaxTree::Children(SymbolRef node) const {
+  const NodeRecord &record = nodes_[node.index()];
+  const auto begin = children_.begin() + record.first_child;
+  return ChildRange(begin, begin + record.num_children);
+}
+
+const TokenInfo &FlatSyntaxTree::Token(SymbolRef leaf) const {
+  const uint32_t index = leaf.index();
+  if (index < tokens_->size()) return (*tokens_)[index];
+  return extra_tokens_[index - tokens_->size()];
+}
+
+ConcreteSyntaxTree FlatSyntaxTree::Materialize(SymbolRef ref) const {
+  const auto make_symbol = [this](SymbolRef ref) -> SymbolPtr {
+    if (ref.IsLeaf()) return std::make_unique<SyntaxTreeLeaf>(Token(ref));
+    if (ref.IsNode()) return std::make_unique<SyntaxTreeNode>(Tag(ref));
+    return nullptr;
+  };
+
+  ConcreteSyntaxTree root = make_symbol(ref);
+  if (!ref.IsNode()) return root;
+
+  // Nodes whose children are still to be created.
+  std::vector<std::pair<SymbolRef, SyntaxTreeNode *>> to_expand = {
+      {ref, &SymbolCastToNode(*root)}};
+  while (!to_expand.empty()) {
+    const auto [flat_node, node] = to_expand.back();
+    to_expand.pop_back();
+    const ChildRange children = Children(flat_node);
+    for (const SymbolRef child : children) {
+      node->AppendChild(make_symbol(child));
+      if (child.IsNode()) {
+        to_expand.emplace_back(child, &SymbolCastToNode(*node->back()));
+      }
+    }
+  }
+  return root;
+}
+
+void VisitFlatSyntaxTree(const FlatSyntaxTree &tree,
+                         FlatTreeVisitor *visitor) {
+  using SymbolRef = FlatSyntaxTree::SymbolRef;
+  const SymbolRef root = tree.Root();
+  if (root.IsLeaf()) visitor->VisitLeaf(root);
+  if (!root.IsNode()) return;
+
+  // Nodes entered so far, with the position of the next child to visit.
+  std::vector<std::pair<SymbolRef, FlatSyntaxTree::ChildRange::iterator>>
+      open_nodes;
+  visitor->EnterNode(root);
+  open_nodes.emplace_back(root, tree.Children(root).begin());
+  while (!open_nodes.empty()) {
+    auto &[node, next_child] = open_nodes.back();
+    if (next_child == tree.Children(node).end()) {
+      visitor->LeaveNode(node);
+      open_nodes.pop_back();
+      continue;
+    }
+    const SymbolRef child = *next_child++;
+    if (child.IsLeaf()) {
+      visitor->VisitLeaf(child);
+    } else if (child.IsNode()) {
+      visitor->EnterNode(child);
+      open_nodes.emplace_back(child, tree.Children(child).begin());
+    }
+  }
+}
+
+}  // namespace verible
@@ -0,0 +1,148 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_TEXT_FLAT_SYNTAX_TREE_H_
+#define VERIBLE_COMMON_TEXT_FLAT_SYNTAX_TREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/iterator_range.h"
+
+namespace verible {
+
+// FlatSyntaxTree is a compact, read-only representation of a concrete syntax
+// tree.  Instead of one heap object per symbol, nodes live in one contiguous
+// array, the children of each node occupy a contiguous range of 32-bit
+// references, and leaves are just indices into the token sequence the tree
+// was parsed from.  This takes a fraction of the memory of a
+// ConcreteSyntaxTree and is cache-friendly to traverse.
+//
+// Analyses written against Symbol (SyntaxTreeLinter, SearchSyntaxTree
+// matchers, ...) can run on Materialize()d (sub)trees; see also
+// FlatTreeVisitor for traversals that only need tags and tokens.
+class FlatSyntaxTree {
+ public:
+  // Reference to a null child, a leaf (by token index) or a node (by index).
+  class SymbolRef {
+   public:
+    static SymbolRef Null() { return SymbolRef(kNullBits); }
+    static SymbolRef Leaf(uint32_t token_index) {
+      return SymbolRef(kLeafBits | token_index);
+    }
+    static SymbolRef Node(uint32_t node_index) {
+      return SymbolRef(kNodeBits | node_index);
+    }
+
+    bool IsNull() const { return (bits_ & kKindMask) == kNullBits; }
+    bool IsLeaf() const { return (bits_ & kKindMask) == kLeafBits; }
+    bool IsNode() const { return (bits_ & kKindMask) == kNodeBits; }
+
+    // Index of the token or node.
+    uint32_t index() const { return bits_ & ~kKindMask; }
+
+    bool operator==(const SymbolRef &other) const {
+      return bits_ == other.bits_;
+    }
+    bool operator!=(const SymbolRef &other) const { return !(*this == other); }
+
+    // Largest index that can be referenced.
+    static constexpr uint32_t kMaxIndex = (1u << 30) - 1;
+
+   private:
+    static constexpr uint32_t kKindMask = 3u << 30;
+    static constexpr uint32_t kNullBits = 0;
+    static constexpr uint32_t kLeafBits = 1u << 30;
+    static constexpr uint32_t kNodeBits = 2u << 30;
+
+    explicit SymbolRef(uint32_t bits) : bits_(bits) {}
+
+    uint32_t bits_;
+  };
+
+  using ChildRange = iterator_range<std::vector<SymbolRef>::const_iterator>;
+
+  // Flattens the tree at "root" (may be nullptr).  Leaves are expected to be
+  // copies of tokens in "tokens", which must outlive the returned object.
+  // Leaves that are not (e.g. tokens synthesized after parsing) are kept in
+  // the flat tree itself, and get token indices past tokens.size().
+  static FlatSyntaxTree FromTree(const Symbol *root,
+                                 const TokenSequence &tokens);
+
+  FlatSyntaxTree(FlatSyntaxTree &&) = default;
+  FlatSyntaxTree &operator=(FlatSyntaxTree &&) = default;
+  FlatSyntaxTree(const FlatSyntaxTree &) = delete;
+  FlatSyntaxTree &operator=(const FlatSyntaxTree &) = delete;
+
+  SymbolRef Root() const { return root_; }
+
+  size_t NumNodes() const { return nodes_.size(); }
+
+  // Node tag of "node", which must be a node reference.
+  int Tag(SymbolRef node) const { return nodes_[node.index()].tag; }
+
+  // Children of "node", which must be a node reference.
+  ChildRange Children(SymbolRef node) const;
+
+  // Token of "leaf", which must be a leaf reference.
+  const TokenInfo &Token(SymbolRef leaf) const;
+
+  // Returns a ConcreteSyntaxTree equal to the subtree at "ref", for use with
+  // the Symbol-based analyses.
+  ConcreteSyntaxTree Materialize(SymbolRef ref) const;
+  ConcreteSyntaxTree Materialize() const { return Materialize(root_); }
+
+ private:
+  struct NodeRecord {
+    int tag;
+    uint32_t first_child;  // index into children_
+    uint32_t num_children;
+  };
+
+  explicit FlatSyntaxTree(const TokenSequence &tokens) : tokens_(&tokens) {}
+
+  // Returns a leaf reference for "token".
+  SymbolRef LeafRef(const TokenInfo &token);
+
+  const TokenSequence *tokens_;  // not owned
+  std::vector<TokenInfo> extra_tokens_;
+  std::vector<NodeRecord> nodes_;
+  std::vector<SymbolRef> children_;
+  SymbolRef root_ = SymbolRef::Null();
+};
+
+// Visits the symbols of a FlatSyntaxTree in preorder.  Null children are not
+// visited.
+class FlatTreeVisitor {
+ public:
+  using SymbolRef = FlatSyntaxTree::SymbolRef;
+
+  virtual ~FlatTreeVisitor() = default;
+
+  virtual void EnterNode(SymbolRef node) {}
+  virtual void LeaveNode(SymbolRef node) {}
+  virtual void VisitLeaf(SymbolRef leaf) {}
+};
+
+// Traverses "tree" with "visitor", without recursion.
+void VisitFlatSyntaxTree(const FlatSyntaxTree &tree, FlatTreeVisitor *visitor);
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_FLAT_SYNTAX_TREE_H_
@@ -0,0 +1,168 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/flat_syntax_tree.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/text/tree_builder_test_util.h"
+#include "common/text/tree_compare.h"
+#include "common/text/tree_utils.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using SymbolRef = FlatSyntaxTree::SymbolRef;
+
+constexpr absl::string_view kText = "foo bar baz";
+
+class FlatSyntaxTreeTest : public ::testing::Test {
+ protected:
+  FlatSyntaxTreeTest()
+      : tokens_({
+            TokenInfo(1, kText.substr(0, 3)),
+            TokenInfo(2, kText.substr(3, 1)),  // skipped by the parser
+            TokenInfo(3, kText.substr(4, 3)),
+            TokenInfo(4, kText.substr(7, 1)),
+            TokenInfo(5, kText.substr(8, 3)),
+        }) {}
+
+  SymbolPtr LeafOf(size_t index) const { return Leaf(tokens_[index]); }
+
+  const TokenSequence tokens_;
+};
+
+// Records the traversal as text.
+class RecordingVisitor : public FlatTreeVisitor {
+ public:
+  explicit RecordingVisitor(const FlatSyntaxTree &tree) : tree_(tree) {}
+
+  void EnterNode(SymbolRef node) final {
+    absl::StrAppend(&trace_, "(", tree_.Tag(node), " ");
+  }
+  void LeaveNode(SymbolRef node) final { absl::StrAppend(&trace_, ")"); }
+  void VisitLeaf(SymbolRef leaf) final {
+    absl::StrAppend(&trace_, tree_.Token(leaf).text(), " ");
+  }
+
+  const std::string &trace() const { return trace_; }
+
+ private:
+  const FlatSyntaxTree &tree_;
+  std::string trace_;
+};
+
+TEST_F(FlatSyntaxTreeTest, EmptyTree) {
+  const auto tree = FlatSyntaxTree::FromTree(nullptr, tokens_);
+  EXPECT_TRUE(tree.Root().IsNull());
+  EXPECT_EQ(tree.NumNodes(), 0);
+  EXPECT_EQ(tree.Materialize(), nullptr);
+
+  RecordingVisitor visitor(tree);
+  VisitFlatSyntaxTree(tree, &visitor);
+  EXPECT_EQ(visitor.trace(), "");
+}
+
+TEST_F(FlatSyntaxTreeTest, LeafOnly) {
+  const SymbolPtr original = LeafOf(2);
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  ASSERT_TRUE(tree.Root().IsLeaf());
+  EXPECT_EQ(tree.Root().index(), 2);
+  EXPECT_TRUE(EqualTrees(original.get(), tree.Materialize().get()));
+}
+
+TEST_F(FlatSyntaxTreeTest, LeavesReferToTokens) {
+  const SymbolPtr original =
+      TNode(10, LeafOf(0), nullptr, TNode(11, LeafOf(2), LeafOf(4)));
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  EXPECT_EQ(tree.NumNodes(), 2);
+
+  const SymbolRef root = tree.Root();
+  ASSERT_TRUE(root.IsNode());
+  EXPECT_EQ(tree.Tag(root), 10);
+  const std::vector<SymbolRef> children(tree.Children(root).begin(),
+                                        tree.Children(root).end());
+  ASSERT_EQ(children.size(), 3);
+  EXPECT_EQ(children[0], SymbolRef::Leaf(0));
+  EXPECT_EQ(children[1], SymbolRef::Null());
+  ASSERT_TRUE(children[2].IsNode());
+  EXPECT_EQ(tree.Tag(children[2]), 11);
+  const std::vector<SymbolRef> grandchildren(tree.Children(children[2]).begin(),
+                                             tree.Children(children[2]).end());
+  EXPECT_EQ(grandchildren,
+            (std::vector<SymbolRef>{SymbolRef::Leaf(2), SymbolRef::Leaf(4)}));
+  EXPECT_EQ(&tree.Token(grandchildren[1]), &tokens_[4]);
+}
+
+TEST_F(FlatSyntaxTreeTest, LeavesNotInTokens) {
+  const TokenInfo synthesized(7, kText.substr(4, 3));  // other enum
+  const SymbolPtr original = TNode(10, LeafOf(0), Leaf(synthesized));
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  const SymbolRef leaf = *(tree.Children(tree.Root()).begin() + 1);
+  ASSERT_TRUE(leaf.IsLeaf());
+  EXPECT_GE(leaf.index(), tokens_.size());
+  EXPECT_EQ(tree.Token(leaf), synthesized);
+  EXPECT_TRUE(EqualTrees(original.get(), tree.Materialize().get()));
+}
+
+TEST_F(FlatSyntaxTreeTest, MaterializeRoundTrip) {
+  const SymbolPtr original =
+      TNode(10, TNode(11, LeafOf(0), TNode(12)), nullptr,
+            TNode(13, nullptr, TNode(14, LeafOf(2)), LeafOf(3)), LeafOf(4));
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  EXPECT_EQ(tree.NumNodes(), 5);
+  EXPECT_TRUE(EqualTrees(original.get(), tree.Materialize().get()));
+
+  const SymbolRef subtree = *(tree.Children(tree.Root()).begin() + 2);
+  EXPECT_TRUE(EqualTrees(SymbolCastToNode(*original)[2].get(),
+                         tree.Materialize(subtree).get()));
+}
+
+TEST_F(FlatSyntaxTreeTest, VisitInPreorder) {
+  const SymbolPtr original =
+      TNode(10, TNode(11, LeafOf(0), TNode(12)), nullptr,
+            TNode(13, nullptr, TNode(14, LeafOf(2)), LeafOf(3)), LeafOf(4));
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  RecordingVisitor visitor(tree);
+  VisitFlatSyntaxTree(tree, &visitor);
+  EXPECT_EQ(visitor.trace(), "(10 (11 foo (12 ))(13 (14 bar )  )baz )");
+}
+
+TEST_F(FlatSyntaxTreeTest, DeepTree) {
+  // Deep enough to overflow the stack with recursion.
+  constexpr int kDepth = 100000;
+  SymbolPtr original = LeafOf(0);
+  for (int i = 0; i < kDepth; ++i) original = TNode(i, std::move(original));
+  const auto tree = FlatSyntaxTree::FromTree(original.get(), tokens_);
+  EXPECT_EQ(tree.NumNodes(), kDepth);
+
+  RecordingVisitor visitor(tree);
+  VisitFlatSyntaxTree(tree, &visitor);
+  EXPECT_EQ(visitor.trace().back(), ')');
+
+  // Symbol trees are destroyed recursively; flatten the original first.
+  while (original->Kind() == SymbolKind::kNode) {
+    original = std::move(SymbolCastToNode(*original)[0]);
+  }
+}
+
+}  // namespace
+}  // namespace verible
@@ -93,6 +93,26 @@ absl::Status MacroDefinition::PopulateSubstitutionMap(
   return absl::OkStatus();
 }
 
+absl::Status MacroDefinition::PopulateReplacements(
+    const std::vector<DefaultTokenInfo> &macro_call_args,
+    std::vector<DefaultTokenInfo> *replacements) const {
+  if (macro_call_args.size() != parameter_info_array_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Error calling macro ", name_.text(), " with ",
+                     macro_call_args.size(), " arguments, but definition has ",
+                     parameter_info_array_.size(), " formal parameters."));
+  }
+  replacements->assign(macro_call_args.size(), DefaultTokenInfo());
+  for (size_t i = 0; i < macro_call_args.size(); ++i) {
+    if (!macro_call_args[i].text().empty()) {
+      (*replacements)[i] = macro_call_args[i];
+    } else if (!parameter_info_array_[i].default_value.text().empty()) {
+      (*replacements)[i] = parameter_info_array_[i].default_value;
+    }
+  }
+  return absl::OkStatus();
+}
+
 const TokenInfo &MacroDefinition::SubstituteText(
     const substitution_map_type &substitution_map, const TokenInfo &token_info,
     int actual_token_enum) {
@@ -108,6 +108,11 @@ class MacroDefinition {
   absl::Status PopulateSubstitutionMap(const std::vector<DefaultTokenInfo> &,
                                        substitution_map_type *) const;
 
+  // Like PopulateSubstitutionMap(), but without a map: sets the replacement
+  // of each formal parameter at the same position as in Parameters().
+  absl::Status PopulateReplacements(const std::vector<DefaultTokenInfo> &,
+                                    std::vector<DefaultTokenInfo> *) const;
+
   // Replace formal parameter references with actuals.
   static const TokenInfo &SubstituteText(const substitution_map_type &,
                                          const TokenInfo &,
@@ -309,5 +309,31 @@ TEST(MacroDefinitionTest, PopulateSubstitutionMapOneParamDefault) {
   EXPECT_EQ(*expect_param, param_default);
 }
 
+// Tests that replacements are by position, with defaults for blank actuals.
+TEST(MacroDefinitionTest, PopulateReplacements) {
+  const TokenInfo def_header(FakeDefineEnum, "`define");
+  const TokenInfo macro_name(FakeIdEnum, "FF");
+  MacroDefinition macro(def_header, macro_name);
+  const TokenInfo param_default(FakeIdEnum, "ticker");
+  EXPECT_TRUE(macro.AppendParameter(
+      MacroParameterInfo(TokenInfo(FakeIdEnum, "clk"), param_default)));
+  EXPECT_TRUE(
+      macro.AppendParameter(MacroParameterInfo(TokenInfo(FakeIdEnum, "d"))));
+  EXPECT_TRUE(
+      macro.AppendParameter(MacroParameterInfo(TokenInfo(FakeIdEnum, "q"))));
+  const TokenInfo actual(FakeIntEnum, "99");
+  std::vector<DefaultTokenInfo> call_args(3);
+  call_args[1] = actual;
+  std::vector<DefaultTokenInfo> replacements;
+  EXPECT_TRUE(macro.PopulateReplacements(call_args, &replacements).ok());
+  ASSERT_EQ(replacements.size(), 3);
+  EXPECT_EQ(replacements[0], param_default);
+  EXPECT_EQ(replacements[1], actual);
+  EXPECT_TRUE(replacements[2].text().empty());
+
+  call_args.pop_back();
+  EXPECT_FALSE(macro.PopulateReplacements(call_args, &replacements).ok());
+}
+
 }  // namespace
 }  // namespace verible
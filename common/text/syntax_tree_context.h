@@ -17,9 +17,11 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <vector>
 
 #include "common/text/concrete_syntax_tree.h"
 #include "common/util/auto_pop_stack.h"
@@ -35,23 +37,85 @@ namespace verible {
 // interface that can express AND/OR/NOT.
 // Despite of implementation based on pointers. This class requires
 // that managed elements are non-nullptrs.
+// The number of ancestors of each (small) tag is counted as nodes are pushed
+// and popped, so that IsInside() does not need to search the stack.
 class SyntaxTreeContext : public AutoPopStack<const SyntaxTreeNode *> {
  public:
   using base_type = AutoPopStack<const SyntaxTreeNode *>;
 
   // member class to handle push and pop of stack safely
-  using AutoPop = base_type::AutoPop;
+  class AutoPop {
+   public:
+    AutoPop(SyntaxTreeContext *context, const SyntaxTreeNode *node)
+        : context_(context) {
+      context->Push(node);
+    }
+    ~AutoPop() { context_->Pop(); }
+
+    AutoPop &operator=(const AutoPop &) = delete;
+    AutoPop &operator=(AutoPop &&) = delete;
+    AutoPop(const AutoPop &) = delete;
+    AutoPop(AutoPop &&) = delete;
+
+   private:
+    SyntaxTreeContext *context_;
+  };
+
+  // The non-recursive traversal pushes and pops nodes one at a time.
+  friend void WalkTree(const Symbol &root, SymbolVisitor *visitor,
+                       SyntaxTreeContext *context);
 
  protected:
   // restrict access to AutoPopStack<>::top method only to this class
   using base_type::top;
 
+  // Pushes and pops nodes, keeping the tag counts up to date.
+  void Push(const SyntaxTreeNode *node) {
+    base_type::Push(node);
+    const int tag = node->Tag().tag;
+    if (IsCountedTag(tag)) {
+      if (static_cast<size_t>(tag) >= tag_counts_.size()) {
+        tag_counts_.resize(tag + 1, 0);
+      }
+      ++tag_counts_[tag];
+    }
+  }
+  void Pop() {
+    CHECK(!empty());
+    const int tag = (*rbegin())->Tag().tag;
+    if (IsCountedTag(tag)) --tag_counts_[tag];
+    base_type::Pop();
+  }
+
  public:
+  SyntaxTreeContext() = default;
+
+  // Constructs the context of a symbol with 'ancestors' (non-nullptrs),
+  // from the outermost to its direct parent.
+  explicit SyntaxTreeContext(
+      const std::vector<const SyntaxTreeNode *> &ancestors) {
+    for (const SyntaxTreeNode *node : ancestors) Push(node);
+  }
+
   // returns the top SyntaxTreeNode of the stack
   const SyntaxTreeNode &top() const {
     return *ABSL_DIE_IF_NULL(base_type::top());
   }
 
+  // Makes this a copy of 'other', given that the two already agree on their
+  // first 'common_depth' (outermost) ancestors, so that only the differing
+  // inner ancestors need to be replaced.
+  void AssignSharingPrefix(const SyntaxTreeContext &other,
+                           size_t common_depth) {
+    DCHECK_LE(common_depth, size());
+    DCHECK_LE(common_depth, other.size());
+    while (size() > common_depth) Pop();
+    for (auto iter = other.begin() + common_depth; iter != other.end();
+         ++iter) {
+      Push(*iter);
+    }
+  }
+
   // IsInside returns true if there is a node of the specified
   // tag on the TreeContext stack.  Search traverses from the top of the
   // stack starting with offset and returns on the first match found.
@@ -59,6 +123,10 @@ class SyntaxTreeContext : public AutoPopStack<const SyntaxTreeNode *> {
   template <typename E>
   bool IsInsideStartingFrom(E tag_enum, size_t reverse_offset) const {
     if (size() <= reverse_offset) return false;
+    if (IsCountedTag(static_cast<int>(tag_enum))) {
+      if (!IsInside(tag_enum)) return false;
+      if (reverse_offset == 0) return true;
+    }
     return std::any_of(
         rbegin() + reverse_offset, rend(),
         [=](const SyntaxTreeNode *node) { return node->MatchesTag(tag_enum); });
@@ -70,6 +138,8 @@ class SyntaxTreeContext : public AutoPopStack<const SyntaxTreeNode *> {
   // Type parameter E can be a language-specific enum or plain integer type.
   template <typename E>
   bool IsInside(E tag_enum) const {
+    const int tag = static_cast<int>(tag_enum);
+    if (IsCountedTag(tag)) return TagCount(tag) > 0;
     return IsInsideStartingFrom(tag_enum, 0);
   }
 
@@ -79,6 +149,13 @@ class SyntaxTreeContext : public AutoPopStack<const SyntaxTreeNode *> {
   template <typename E>
   bool IsInsideFirst(std::initializer_list<E> includes,
                      std::initializer_list<E> excludes) const {
+    // Without any of the includes among the ancestors, there is no match.
+    if (std::all_of(includes.begin(), includes.end(), [this](E tag_enum) {
+          const int tag = static_cast<int>(tag_enum);
+          return IsCountedTag(tag) && TagCount(tag) == 0;
+        })) {
+      return false;
+    }
     for (const auto &type : reversed_view(*this)) {
       if (type->MatchesTagAnyOf(includes)) return true;
       if (type->MatchesTagAnyOf(excludes)) return false;
@@ -135,9 +212,26 @@ class SyntaxTreeContext : public AutoPopStack<const SyntaxTreeNode *> {
   // specified node tag (enum).
   template <typename E>
   const SyntaxTreeNode *NearestParentWithTag(E tag) const {
+    if (!IsInside(tag)) return nullptr;
     return NearestParentMatching(
         [tag](const SyntaxTreeNode &node) { return E(node.Tag().tag) == tag; });
   }
+
+ private:
+  // Tags up to this are counted; others are searched for on the stack.
+  static constexpr int kMaxCountedTag = 4095;
+
+  static bool IsCountedTag(int tag) {
+    return tag >= 0 && tag <= kMaxCountedTag;
+  }
+
+  uint32_t TagCount(int tag) const {
+    return static_cast<size_t>(tag) < tag_counts_.size() ? tag_counts_[tag]
+                                                         : 0;
+  }
+
+  // Number of nodes on the stack with each counted tag, indexed by tag.
+  std::vector<uint32_t> tag_counts_;
 };
 
 }  // namespace verible
@@ -48,6 +48,22 @@ TEST(SyntaxTreeContextTest, PushPopTest) {
   EXPECT_EQ(&const_context.top(), &node2);
 }
 
+// Test that only the differing suffix of a context is replaced.
+TEST(SyntaxTreeContextTest, AssignSharingPrefixTest) {
+  SyntaxTreeNode node1(1);
+  SyntaxTreeNode node2(2);
+  SyntaxTreeNode node3(3);
+  SyntaxTreeNode node4(4);
+  SyntaxTreeContext saved({&node1, &node2, &node3});
+  const SyntaxTreeContext current({&node1, &node4});
+  saved.AssignSharingPrefix(current, 1);
+  EXPECT_THAT(saved, ElementsAre(&node1, &node4));
+  saved.AssignSharingPrefix(SyntaxTreeContext(), 0);
+  EXPECT_TRUE(saved.empty());
+  saved.AssignSharingPrefix(current, 0);
+  EXPECT_THAT(saved, ElementsAre(&node1, &node4));
+}
+
 // Test that forward/reverse iterators correctly look down/up the stack.
 TEST(SyntaxTreeContextTest, IteratorsTest) {
   SyntaxTreeContext context;
@@ -110,6 +126,44 @@ TEST(SyntaxTreeContextTest, IsInsideTest) {
   }
 }
 
+// Test that IsInside stays correct with repeated tags, contexts replaced
+// by AssignSharingPrefix and tags too large to be counted.
+TEST(SyntaxTreeContextTest, IsInsideCountsTagsTest) {
+  SyntaxTreeNode node1(1);
+  SyntaxTreeNode other1(1);
+  SyntaxTreeNode node2(2);
+  SyntaxTreeNode large(100000);
+  SyntaxTreeContext context;
+  {
+    SyntaxTreeContext::AutoPop p1(&context, &node1);
+    {
+      SyntaxTreeContext::AutoPop p2(&context, &other1);
+      SyntaxTreeContext::AutoPop p3(&context, &large);
+      EXPECT_TRUE(context.IsInside(1));
+      EXPECT_TRUE(context.IsInside(100000));
+      EXPECT_FALSE(context.IsInside(2));
+      EXPECT_FALSE(context.IsInside(100001));
+      EXPECT_TRUE(context.IsInsideFirst({100000, 2}, {1}));
+      EXPECT_FALSE(context.IsInsideFirst({2}, {1}));
+      EXPECT_EQ(context.NearestParentWithTag(1), &other1);
+      EXPECT_EQ(context.NearestParentWithTag(2), nullptr);
+    }
+    EXPECT_TRUE(context.IsInside(1));
+    EXPECT_FALSE(context.IsInside(100000));
+  }
+  EXPECT_FALSE(context.IsInside(1));
+
+  SyntaxTreeContext saved({&node1, &other1, &large});
+  saved.AssignSharingPrefix(SyntaxTreeContext({&node1, &node2}), 1);
+  EXPECT_TRUE(saved.IsInside(1));
+  EXPECT_TRUE(saved.IsInside(2));
+  EXPECT_FALSE(saved.IsInside(100000));
+  EXPECT_EQ(saved.NearestParentWithTag(1), &node1);
+  saved.AssignSharingPrefix(SyntaxTreeContext(), 0);
+  EXPECT_FALSE(saved.IsInside(1));
+  EXPECT_FALSE(saved.IsInside(2));
+}
+
 // Test that IsInsideFirst correctly reports whether context matches.
 TEST(SyntaxTreeContextTest, IsInsideFirstTest) {
   SyntaxTreeContext context;
@@ -0,0 +1,164 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/text/syntax_tree_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/tree_utils.h"
+#include "common/util/logging.h"
+
+namespace verible {
+
+SyntaxTreeIndex::SyntaxTreeIndex(const Symbol *root) : root_(root) {
+  if (root == nullptr) return;
+
+  // Traverse in preorder, with an explicit stack of the nodes whose children
+  // are yet to be visited, as trees can be very deep.
+  struct PendingNode {
+    uint32_t position;
+    size_t next_child;
+  };
+  std::vector<PendingNode> pending;
+  const auto add = [this, &pending](const Symbol &symbol, uint32_t parent) {
+    const uint32_t position = records_.size();
+    records_.push_back({&symbol, parent, position + 1});
+    positions_.emplace(&symbol, position);
+    const bool is_node = symbol.Kind() == SymbolKind::kNode;
+    (is_node ? node_positions_ : leaf_positions_)[symbol.Tag().tag].push_back(
+        position);
+    if (is_node) pending.push_back({position, 0});
+  };
+
+  add(*root, kNoPosition);
+  while (!pending.empty()) {
+    const uint32_t position = pending.back().position;
+    size_t &next_child = pending.back().next_child;
+    const SyntaxTreeNode &node = SymbolCastToNode(*records_[position].symbol);
+    while (next_child < node.size() && node[next_child] == nullptr) {
+      ++next_child;
+    }
+    if (next_child == node.size()) {
+      records_[position].end = records_.size();
+      pending.pop_back();
+      continue;
+    }
+    add(*node[next_child++], position);
+  }
+}
+
+// Open-addressing hash maps keep one control byte per slot.
+template <typename Map>
+static size_t HashMapMemoryUsage(const Map &map) {
+  return map.capacity() * (sizeof(typename Map::value_type) + 1);
+}
+
+size_t SyntaxTreeIndex::MemoryUsage() const {
+  size_t bytes = records_.capacity() * sizeof(Record) +
+                 HashMapMemoryUsage(positions_) +
+                 HashMapMemoryUsage(node_positions_) +
+                 HashMapMemoryUsage(leaf_positions_);
+  for (const auto *positions : {&node_positions_, &leaf_positions_}) {
+    for (const auto &tag_positions : *positions) {
+      bytes += tag_positions.second.capacity() * sizeof(uint32_t);
+    }
+  }
+  return bytes;
+}
+
+absl::Span<const uint32_t> SyntaxTreeIndex::Find(SymbolTag tag) const {
+  const auto &positions =
+      tag.kind == SymbolKind::kNode ? node_positions_ : leaf_positions_;
+  const auto found = positions.find(tag.tag);
+  if (found == positions.end()) return {};
+  return found->second;
+}
+
+std::optional<uint32_t> SyntaxTreeIndex::PositionOf(
+    const Symbol &symbol) const {
+  const auto found = positions_.find(&symbol);
+  if (found == positions_.end()) return std::nullopt;
+  return found->second;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>> SyntaxTreeIndex::SubtreeRange(
+    const Symbol &symbol) const {
+  const auto found = positions_.find(&symbol);
+  if (found == positions_.end()) return std::nullopt;
+  return std::make_pair(found->second, records_[found->second].end);
+}
+
+SyntaxTreeContext SyntaxTreeIndex::Context(uint32_t position,
+                                           uint32_t ancestor_position) const {
+  return Ancestors(position, ancestor_position).ToContext();
+}
+
+SyntaxTreeAncestors SyntaxTreeIndex::Ancestors(
+    uint32_t position, uint32_t ancestor_position) const {
+  if (position == ancestor_position) {
+    return SyntaxTreeAncestors(this, kNoPosition, kNoPosition);
+  }
+  CHECK_LT(ancestor_position, position) << "not an ancestor";
+  CHECK_LT(position, records_[ancestor_position].end) << "not an ancestor";
+  return SyntaxTreeAncestors(this, records_[position].parent,
+                             ancestor_position);
+}
+
+bool SyntaxTreeAncestors::empty() const {
+  return first_ == SyntaxTreeIndex::kNoPosition;
+}
+
+const SyntaxTreeNode &SyntaxTreeAncestors::top() const {
+  CHECK(!empty());
+  return SymbolCastToNode(index_->SymbolAt(first_));
+}
+
+uint32_t SyntaxTreeAncestors::Next(uint32_t position) const {
+  if (position == last_) return SyntaxTreeIndex::kNoPosition;
+  return index_->ParentPosition(position);
+}
+
+const SyntaxTreeNode *SyntaxTreeAncestors::NearestParentMatching(
+    const std::function<bool(const SyntaxTreeNode &)> &predicate) const {
+  for (uint32_t position = first_; position != SyntaxTreeIndex::kNoPosition;
+       position = Next(position)) {
+    const SyntaxTreeNode &node = SymbolCastToNode(index_->SymbolAt(position));
+    if (predicate(node)) return &node;
+  }
+  return nullptr;
+}
+
+SyntaxTreeContext SyntaxTreeAncestors::ToContext() const {
+  std::vector<const SyntaxTreeNode *> ancestors;
+  for (uint32_t position = first_; position != SyntaxTreeIndex::kNoPosition;
+       position = Next(position)) {
+    ancestors.push_back(&SymbolCastToNode(index_->SymbolAt(position)));
+  }
+  std::reverse(ancestors.begin(), ancestors.end());
+  return SyntaxTreeContext(ancestors);
+}
+
+}  // namespace verible
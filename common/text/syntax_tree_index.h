@@ -0,0 +1,209 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_COMMON_TEXT_SYNTAX_TREE_INDEX_H_
+#define VERIBLE_COMMON_TEXT_SYNTAX_TREE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/util/logging.h"
+
+namespace verible {
+
+class SyntaxTreeIndex;
+
+// SyntaxTreeAncestors is a view of the ancestors of one symbol in a
+// SyntaxTreeIndex, which follows the parent links on every query instead of
+// holding a copy of them.  It answers the same questions as
+// SyntaxTreeContext, and is only valid as long as its index.
+class SyntaxTreeAncestors {
+ public:
+  // Returns true if there are no ancestors.
+  bool empty() const;
+
+  // Returns the direct parent.
+  const SyntaxTreeNode &top() const;
+
+  // Returns the closest ancestor that matches 'predicate', or nullptr.
+  const SyntaxTreeNode *NearestParentMatching(
+      const std::function<bool(const SyntaxTreeNode &)> &predicate) const;
+
+  // Returns the closest ancestor with 'tag', or nullptr.
+  template <typename E>
+  const SyntaxTreeNode *NearestParentWithTag(E tag) const {
+    return NearestParentMatching(
+        [tag](const SyntaxTreeNode &node) { return E(node.Tag().tag) == tag; });
+  }
+
+  // Returns true if any ancestor has 'tag'.
+  template <typename E>
+  bool IsInside(E tag) const {
+    return NearestParentWithTag(tag) != nullptr;
+  }
+
+  // Returns true if the closest ancestor with one of the tags in 'includes'
+  // or 'excludes' has one of 'includes'.
+  template <typename E>
+  bool IsInsideFirst(std::initializer_list<E> includes,
+                     std::initializer_list<E> excludes) const {
+    const SyntaxTreeNode *first = NearestParentMatching(
+        [&](const SyntaxTreeNode &node) {
+          return node.MatchesTagAnyOf(includes) ||
+                 node.MatchesTagAnyOf(excludes);
+        });
+    return first != nullptr && first->MatchesTagAnyOf(includes);
+  }
+
+  // Returns true if the direct parent has 'tag'.
+  template <typename E>
+  bool DirectParentIs(E tag) const {
+    return !empty() && E(top().Tag().tag) == tag;
+  }
+
+  // Returns true if the closest ancestors have 'tags', starting with the
+  // direct parent.
+  template <typename E>
+  bool DirectParentsAre(std::initializer_list<E> tags) const;
+
+  // Returns a copy of the ancestors, outermost first.
+  SyntaxTreeContext ToContext() const;
+
+ private:
+  friend class SyntaxTreeIndex;
+
+  SyntaxTreeAncestors(const SyntaxTreeIndex *index, uint32_t first,
+                      uint32_t last)
+      : index_(index), first_(first), last_(last) {}
+
+  // Returns the position of the ancestor after the one at 'position'.
+  uint32_t Next(uint32_t position) const;
+
+  const SyntaxTreeIndex *index_;
+  // Positions of the direct parent and of the outermost ancestor, or both
+  // SyntaxTreeIndex::kNoPosition if there are no ancestors.
+  uint32_t first_;
+  uint32_t last_;
+};
+
+// SyntaxTreeIndex lists the nodes and leaves of a syntax tree by their tag,
+// so that all symbols of one kind can be found without walking the whole
+// tree.  Symbols are identified by their position in a preorder traversal.
+// Instead of a copy of its ancestors for every symbol, only a link to its
+// parent is kept, from which a SyntaxTreeContext is rebuilt on demand.
+//
+// The index is only valid as long as the tree is neither destroyed nor
+// modified.
+class SyntaxTreeIndex {
+ public:
+  // Indexes the tree at 'root', which may be nullptr.
+  explicit SyntaxTreeIndex(const Symbol *root);
+
+  SyntaxTreeIndex(const SyntaxTreeIndex &) = delete;
+  SyntaxTreeIndex &operator=(const SyntaxTreeIndex &) = delete;
+
+  // Returns the root of the indexed tree.
+  const Symbol *Root() const { return root_; }
+
+  // Returns the number of (non-null) symbols in the tree.
+  uint32_t size() const { return records_.size(); }
+
+  // Returns the estimated number of bytes held by the index.
+  size_t MemoryUsage() const;
+
+  // Stands for no symbol, e.g. as the parent of the root.
+  static constexpr uint32_t kNoPosition = ~uint32_t{0};
+
+  // Returns the positions of all nodes or leaves with 'tag', in preorder.
+  absl::Span<const uint32_t> Find(SymbolTag tag) const;
+
+  // Returns the symbol at 'position'.
+  const Symbol &SymbolAt(uint32_t position) const {
+    return *records_[position].symbol;
+  }
+
+  // Returns the position of 'symbol', or nullopt if it is not in the tree.
+  std::optional<uint32_t> PositionOf(const Symbol &symbol) const;
+
+  // Returns the position of the parent of the symbol at 'position', or
+  // kNoPosition for the root.
+  uint32_t ParentPosition(uint32_t position) const {
+    return records_[position].parent;
+  }
+
+  // Returns the position of 'symbol' and one past the position of its last
+  // descendant, or nullopt if 'symbol' is not in the tree.
+  std::optional<std::pair<uint32_t, uint32_t>> SubtreeRange(
+      const Symbol &symbol) const;
+
+  // Returns the ancestors of the symbol at 'position', up to and including
+  // the one at 'ancestor_position', as TreeContextVisitor would see them on
+  // a traversal from there.  'ancestor_position' must be that of an ancestor
+  // of the symbol, or of the symbol itself, which has an empty context.
+  SyntaxTreeContext Context(uint32_t position,
+                            uint32_t ancestor_position = 0) const;
+
+  // Like Context(), but returns a view that looks up the ancestors when it
+  // is queried, which is cheaper if only a few questions are asked.
+  SyntaxTreeAncestors Ancestors(uint32_t position,
+                                uint32_t ancestor_position = 0) const;
+
+ private:
+  struct Record {
+    const Symbol *symbol;
+    // Position of the parent node, or kNoPosition for the root.
+    uint32_t parent;
+    // One past the position of the last descendant.
+    uint32_t end;
+  };
+
+  const Symbol *const root_;
+
+  // All symbols, in preorder.
+  std::vector<Record> records_;
+
+  // Positions of all symbols.
+  absl::flat_hash_map<const Symbol *, uint32_t> positions_;
+
+  // Positions of the nodes and of the leaves, by tag.
+  absl::flat_hash_map<int, std::vector<uint32_t>> node_positions_;
+  absl::flat_hash_map<int, std::vector<uint32_t>> leaf_positions_;
+};
+
+template <typename E>
+bool SyntaxTreeAncestors::DirectParentsAre(
+    std::initializer_list<E> tags) const {
+  uint32_t position = first_;
+  for (const E tag : tags) {
+    if (position == SyntaxTreeIndex::kNoPosition) return false;
+    if (E(index_->SymbolAt(position).Tag().tag) != tag) return false;
+    position = Next(position);
+  }
+  return true;
+}
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_SYNTAX_TREE_INDEX_H_
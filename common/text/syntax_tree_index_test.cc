@@ -0,0 +1,162 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/text/syntax_tree_index.h"
+
+#include <memory>
+#include <utility>
+
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/tree_builder_test_util.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(SyntaxTreeIndexTest, NullTree) {
+  const SyntaxTreeIndex index(nullptr);
+  EXPECT_EQ(index.Root(), nullptr);
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_TRUE(index.Find(NodeTag(1)).empty());
+}
+
+TEST(SyntaxTreeIndexTest, FindsNodesAndLeavesInPreorder) {
+  auto tree = TNode(1, TNode(2, XLeaf(2), nullptr, TNode(1)), XLeaf(3),
+                    TNode(2));
+  const SyntaxTreeIndex index(tree.get());
+  EXPECT_EQ(index.Root(), tree.get());
+  EXPECT_EQ(index.size(), 6);  // null children are skipped
+
+  const auto nodes_1 = index.Find(NodeTag(1));
+  ASSERT_EQ(nodes_1.size(), 2);
+  EXPECT_EQ(&index.SymbolAt(nodes_1[0]), tree.get());
+  EXPECT_EQ(&index.SymbolAt(nodes_1[1]), DescendPath(*tree, {0, 2}));
+
+  const auto nodes_2 = index.Find(NodeTag(2));
+  ASSERT_EQ(nodes_2.size(), 2);
+  EXPECT_EQ(&index.SymbolAt(nodes_2[0]), DescendPath(*tree, {0}));
+  EXPECT_EQ(&index.SymbolAt(nodes_2[1]), DescendPath(*tree, {2}));
+
+  const auto leaves_2 = index.Find(LeafTag(2));
+  ASSERT_EQ(leaves_2.size(), 1);
+  EXPECT_EQ(&index.SymbolAt(leaves_2[0]), DescendPath(*tree, {0, 0}));
+
+  EXPECT_TRUE(index.Find(LeafTag(1)).empty());
+  EXPECT_TRUE(index.Find(NodeTag(3)).empty());
+}
+
+TEST(SyntaxTreeIndexTest, SubtreeRange) {
+  auto tree = TNode(1, TNode(2, XLeaf(2), TNode(1)), XLeaf(3));
+  auto other_tree = XLeaf(3);
+  const SyntaxTreeIndex index(tree.get());
+
+  const auto whole = index.SubtreeRange(*tree);
+  ASSERT_TRUE(whole.has_value());
+  EXPECT_EQ(whole->first, 0);
+  EXPECT_EQ(whole->second, index.size());
+
+  const auto subtree = index.SubtreeRange(*DescendPath(*tree, {0}));
+  ASSERT_TRUE(subtree.has_value());
+  EXPECT_EQ(subtree->first, 1);
+  EXPECT_EQ(subtree->second, 4);
+
+  const auto leaf = index.SubtreeRange(*DescendPath(*tree, {1}));
+  ASSERT_TRUE(leaf.has_value());
+  EXPECT_EQ(leaf->first, 4);
+  EXPECT_EQ(leaf->second, 5);
+
+  EXPECT_FALSE(index.SubtreeRange(*other_tree).has_value());
+}
+
+TEST(SyntaxTreeIndexTest, Context) {
+  auto tree = TNode(1, TNode(2, XLeaf(2), TNode(3, XLeaf(4))));
+  const SyntaxTreeIndex index(tree.get());
+  const auto leaves = index.Find(LeafTag(4));
+  ASSERT_EQ(leaves.size(), 1);
+
+  const SyntaxTreeContext context = index.Context(leaves[0]);
+  ASSERT_EQ(context.size(), 3);
+  EXPECT_EQ(context.begin()[0], tree.get());
+  EXPECT_EQ(context.begin()[1], DescendPath(*tree, {0}));
+  EXPECT_EQ(context.begin()[2], DescendPath(*tree, {0, 1}));
+  EXPECT_TRUE(context.DirectParentsAre({3, 2, 1}));
+
+  // Relative to a subtree.
+  const auto subtree = index.SubtreeRange(*DescendPath(*tree, {0}));
+  ASSERT_TRUE(subtree.has_value());
+  const SyntaxTreeContext sub_context =
+      index.Context(leaves[0], subtree->first);
+  EXPECT_EQ(sub_context.size(), 2);
+  EXPECT_TRUE(sub_context.DirectParentsAre({3, 2}));
+
+  // Of the root itself.
+  EXPECT_TRUE(index.Context(0).empty());
+}
+
+TEST(SyntaxTreeIndexTest, Ancestors) {
+  auto tree = TNode(1, TNode(2, XLeaf(2), TNode(3, XLeaf(4))));
+  const SyntaxTreeIndex index(tree.get());
+  const auto leaves = index.Find(LeafTag(4));
+  ASSERT_EQ(leaves.size(), 1);
+
+  const SyntaxTreeAncestors ancestors = index.Ancestors(leaves[0]);
+  ASSERT_FALSE(ancestors.empty());
+  EXPECT_EQ(&ancestors.top(), DescendPath(*tree, {0, 1}));
+  EXPECT_TRUE(ancestors.DirectParentIs(3));
+  EXPECT_TRUE(ancestors.DirectParentsAre({3, 2, 1}));
+  EXPECT_FALSE(ancestors.DirectParentsAre({3, 2, 1, 1}));
+  EXPECT_TRUE(ancestors.IsInside(1));
+  EXPECT_FALSE(ancestors.IsInside(4));
+  EXPECT_EQ(ancestors.NearestParentWithTag(2), DescendPath(*tree, {0}));
+  EXPECT_TRUE(ancestors.IsInsideFirst({2}, {1}));
+  EXPECT_FALSE(ancestors.IsInsideFirst({1}, {2}));
+  const SyntaxTreeContext context = ancestors.ToContext();
+  EXPECT_EQ(context.size(), 3);
+  EXPECT_TRUE(context.DirectParentsAre({3, 2, 1}));
+
+  // Relative to a subtree, the ancestors stop at its root.
+  const auto subtree = index.SubtreeRange(*DescendPath(*tree, {0}));
+  ASSERT_TRUE(subtree.has_value());
+  const SyntaxTreeAncestors sub_ancestors =
+      index.Ancestors(leaves[0], subtree->first);
+  EXPECT_TRUE(sub_ancestors.DirectParentsAre({3, 2}));
+  EXPECT_FALSE(sub_ancestors.IsInside(1));
+  EXPECT_EQ(sub_ancestors.ToContext().size(), 2);
+
+  // Of the root itself.
+  EXPECT_TRUE(index.Ancestors(0).empty());
+  EXPECT_FALSE(index.Ancestors(0).DirectParentIs(1));
+  EXPECT_TRUE(index.Ancestors(0).DirectParentsAre<int>({}));
+
+  EXPECT_EQ(index.PositionOf(*DescendPath(*tree, {0, 1})), 3);
+  EXPECT_EQ(index.ParentPosition(3), 1);
+  EXPECT_EQ(index.ParentPosition(0), SyntaxTreeIndex::kNoPosition);
+}
+
+TEST(SyntaxTreeIndexTest, DeepTree) {
+  constexpr int kDepth = 1000;
+  SymbolPtr tree = XLeaf(1);
+  for (int i = 0; i < kDepth; ++i) tree = TNode(2, std::move(tree));
+  const SyntaxTreeIndex index(tree.get());
+  EXPECT_EQ(index.size(), kDepth + 1);
+  const auto leaves = index.Find(LeafTag(1));
+  ASSERT_EQ(leaves.size(), 1);
+  EXPECT_EQ(index.Context(leaves[0]).size(), kDepth);
+}
+
+}  // namespace
+}  // namespace verible
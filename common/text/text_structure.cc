@@ -27,10 +27,10 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/line_column_map.h"
 #include "common/strings/mem_block.h"
+#include "common/strings/utf8.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
@@ -39,6 +39,7 @@
 #include "common/text/tree_utils.h"
 #include "common/util/iterator_range.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
 #include "common/util/range.h"
 #include "common/util/status_macros.h"
 
@@ -62,15 +63,108 @@ TextStructureView::~TextStructureView() {
       << status.message();
 }
 
+TextStructureView::TextStructureView(TextStructureView&& other) noexcept
+    : contents_(other.contents_),
+      lazy_lines_info_(std::move(other.lazy_lines_info_)),
+      tokens_(std::move(other.tokens_)),
+      tokens_view_(std::move(other.tokens_view_)),
+      lazy_line_token_map_(std::move(other.lazy_line_token_map_)),
+      lazy_token_positions_(std::move(other.lazy_token_positions_)),
+      syntax_tree_(std::move(other.syntax_tree_)),
+      lazy_syntax_tree_index_(std::move(other.lazy_syntax_tree_index_)) {
+  other.Clear();
+}
+
+TextStructureView& TextStructureView::operator=(
+    TextStructureView&& other) noexcept {
+  if (this == &other) return *this;
+  contents_ = other.contents_;
+  lazy_lines_info_ = std::move(other.lazy_lines_info_);
+  tokens_ = std::move(other.tokens_);
+  tokens_view_ = std::move(other.tokens_view_);
+  lazy_line_token_map_ = std::move(other.lazy_line_token_map_);
+  lazy_token_positions_ = std::move(other.lazy_token_positions_);
+  syntax_tree_ = std::move(other.syntax_tree_);
+  lazy_syntax_tree_index_ = std::move(other.lazy_syntax_tree_index_);
+  other.Clear();
+  return *this;
+}
+
 void TextStructureView::Clear() {
   syntax_tree_ = nullptr;
+  lazy_syntax_tree_index_.reset();
   lazy_lines_info_.valid = false;
   lazy_line_token_map_.clear();
+  lazy_token_positions_ = TokenPositions();
   tokens_view_.clear();
   tokens_.clear();
   contents_ = contents_.substr(0, 0);  // clear
 }
 
+size_t TextStructureView::TokenStreamMemoryUsage() const {
+  return tokens_.capacity() * sizeof(TokenInfo) +
+         tokens_view_.capacity() * sizeof(TokenStreamView::value_type) +
+         lazy_line_token_map_.capacity() *
+             sizeof(TokenSequence::const_iterator) +
+         lazy_token_positions_.offsets.capacity() * sizeof(int) +
+         lazy_token_positions_.positions.capacity() * sizeof(LineColumn);
+}
+
+// Returns the bytes held by the nodes and leaves of the tree at 'root',
+// without recursion.
+static size_t SyntaxTreeMemoryUsage(const Symbol* root) {
+  size_t bytes = 0;
+  std::vector<const Symbol*> pending;
+  if (root != nullptr) pending.push_back(root);
+  while (!pending.empty()) {
+    const Symbol* symbol = pending.back();
+    pending.pop_back();
+    if (symbol->Kind() == SymbolKind::kLeaf) {
+      bytes += sizeof(SyntaxTreeLeaf);
+      continue;
+    }
+    const auto& node = SymbolCastToNode(*symbol);
+    bytes += sizeof(SyntaxTreeNode) + node.capacity() * sizeof(SymbolPtr);
+    for (const auto& child : node.children()) {
+      if (child != nullptr) pending.push_back(child.get());
+    }
+  }
+  return bytes;
+}
+
+verible::MemoryUsage TextStructureView::MemoryUsage() const {
+  verible::MemoryUsage usage;
+  usage.Add("tokens", VectorMemoryUsage(tokens_));
+  usage.Add("token_view", VectorMemoryUsage(tokens_view_));
+  usage.Add("line_token_map", VectorMemoryUsage(lazy_line_token_map_));
+  usage.Add("token_positions",
+            VectorMemoryUsage(lazy_token_positions_.offsets) +
+                VectorMemoryUsage(lazy_token_positions_.positions));
+  usage.Add("lines", VectorMemoryUsage(lazy_lines_info_.lines));
+  usage.Add("line_widths", VectorMemoryUsage(lazy_lines_info_.widths));
+  if (lazy_lines_info_.line_column_map != nullptr) {
+    usage.Add(
+        "line_column_map",
+        sizeof(LineColumnMap) +
+            VectorMemoryUsage(
+                lazy_lines_info_.line_column_map->GetBeginningOfLineOffsets()));
+  }
+  usage.Add("syntax_tree", SyntaxTreeMemoryUsage(syntax_tree_.get()));
+  if (lazy_syntax_tree_index_ != nullptr) {
+    usage.Add("syntax_tree_index", sizeof(SyntaxTreeIndex) +
+                                       lazy_syntax_tree_index_->MemoryUsage());
+  }
+  return usage;
+}
+
+void TextStructureView::ReleaseTokenStream() {
+  // Swap with empty containers to actually free their memory.
+  TokenStreamView().swap(tokens_view_);
+  TokenSequence().swap(tokens_);
+  std::vector<TokenSequence::const_iterator>().swap(lazy_line_token_map_);
+  lazy_token_positions_ = TokenPositions();
+}
+
 static bool TokenLocationLess(const TokenInfo& token, const char* offset) {
   return token.text().begin() < offset;
 }
@@ -130,6 +224,59 @@ TokenRange TextStructureView::TokenRangeSpanningOffsets(size_t lower,
   return make_range(left, right);
 }
 
+const TextStructureView::TokenPositions& TextStructureView::TokenPositions::Get(
+    absl::string_view contents, const TokenSequence& tokens) {
+  if (contents.data() == this->contents.data() &&
+      contents.length() == this->contents.length() &&
+      offsets.size() == tokens.size()) {
+    return *this;
+  }
+  this->contents = contents;
+  offsets.clear();
+  positions.clear();
+  offsets.reserve(tokens.size());
+  positions.reserve(tokens.size());
+  // Counts lines and characters like LineColumnMap::GetLineColAtOffset().
+  LineColumn position{0, 0};
+  int scanned = 0;
+  for (const TokenInfo& token : tokens) {
+    const int offset = token.left(contents);
+    // Tokens outside of contents, or out of order, keep the previous entry,
+    // which is still a correct position for its offset.
+    if (offset >= scanned && offset <= static_cast<int>(contents.length())) {
+      const absl::string_view skipped =
+          contents.substr(scanned, offset - scanned);
+      const size_t last_newline = skipped.rfind('\n');
+      if (last_newline == absl::string_view::npos) {
+        position.column += utf8_len(skipped);
+      } else {
+        position.line += std::count(skipped.begin(), skipped.end(), '\n');
+        position.column = utf8_len(skipped.substr(last_newline + 1));
+      }
+      scanned = offset;
+    }
+    offsets.push_back(scanned);
+    positions.push_back(position);
+  }
+  return *this;
+}
+
+LineColumn TextStructureView::GetLineColAtTokenOffset(int bytes_offset,
+                                                      size_t index_hint) const {
+  const TokenPositions& token_positions =
+      lazy_token_positions_.Get(contents_, tokens_);
+  const std::vector<int>& offsets = token_positions.offsets;
+  if (index_hint < offsets.size() && offsets[index_hint] == bytes_offset) {
+    return token_positions.positions[index_hint];
+  }
+  const auto found =
+      std::lower_bound(offsets.begin(), offsets.end(), bytes_offset);
+  if (found != offsets.end() && *found == bytes_offset) {
+    return token_positions.positions[std::distance(offsets.begin(), found)];
+  }
+  return GetLineColAtOffset(bytes_offset);
+}
+
 LineColumnRange TextStructureView::GetRangeForToken(
     const TokenInfo& token) const {
   if (token.isEOF()) {
@@ -138,12 +285,20 @@ LineColumnRange TextStructureView::GetRangeForToken(
     const LineColumn eofPos = GetLineColAtOffset(Contents().length());
     return {eofPos, eofPos};
   }
+  // Tokens of the token stream are found without searching, copies of them
+  // (as in the syntax tree) with one binary search.  The end of a token is
+  // usually the start of the next one.
+  size_t index = tokens_.size();
+  if (!tokens_.empty() && &token >= &tokens_.front() &&
+      &token <= &tokens_.back()) {
+    index = std::distance(&tokens_.front(), &token);
+  }
   // TODO(hzeller): This should simply be GetRangeForText(token.text()),
   // but the more thorough error checking in GetRangeForText()
   // exposes a token overrun in verilog_analyzer_test.cc
   // Defer to fix in separate change.
-  return {GetLineColAtOffset(token.left(Contents())),
-          GetLineColAtOffset(token.right(Contents()))};
+  return {GetLineColAtTokenOffset(token.left(Contents()), index),
+          GetLineColAtTokenOffset(token.right(Contents()), index + 1)};
 }
 
 LineColumnRange TextStructureView::GetRangeForText(
@@ -152,7 +307,28 @@ LineColumnRange TextStructureView::GetRangeForText(
   const auto to = std::distance(Contents().begin(), text.end());
   CHECK_GE(from, 0) << '"' << text << '"';
   CHECK_LE(to, static_cast<int64_t>(Contents().length())) << '"' << text << '"';
-  return {GetLineColAtOffset(from), GetLineColAtOffset(to)};
+  return {GetLineColAtTokenOffset(from, tokens_.size()),
+          GetLineColAtTokenOffset(to, tokens_.size())};
+}
+
+std::vector<LineColumnRange> TextStructureView::GetRangesForTexts(
+    const std::vector<absl::string_view>& texts) const {
+  // Start and end offset of each text.
+  std::vector<int> offsets;
+  offsets.reserve(2 * texts.size());
+  for (const absl::string_view text : texts) {
+    CHECK(ContainsText(text)) << '"' << text << '"';
+    offsets.push_back(std::distance(Contents().begin(), text.begin()));
+    offsets.push_back(std::distance(Contents().begin(), text.end()));
+  }
+  const std::vector<LineColumn> positions =
+      GetLineColumnMap().GetLineColAtOffsets(Contents(), offsets);
+  std::vector<LineColumnRange> ranges;
+  ranges.reserve(texts.size());
+  for (size_t i = 0; i < positions.size(); i += 2) {
+    ranges.push_back({positions[i], positions[i + 1]});
+  }
+  return ranges;
 }
 
 bool TextStructureView::ContainsText(absl::string_view text) const {
@@ -167,12 +343,42 @@ TokenRange TextStructureView::TokenRangeOnLine(size_t lineno) const {
   return make_range(tokens_.cend(), tokens_.cend());
 }
 
+TokenSequence::const_iterator TextStructureView::TokenStartingAtOrBefore(
+    const char* pos) const {
+  // Tokens are sorted by location, so this needs no line-token map.
+  auto found = std::upper_bound(tokens_.cbegin(), tokens_.cend(), pos,
+                                [](const char* p, const TokenInfo& token) {
+                                  return p < token.text().begin();
+                                });
+  if (found == tokens_.cbegin()) return tokens_.cend();
+  return --found;
+}
+
+TokenInfo TextStructureView::FindTokenAtOffset(int offset) const {
+  if (offset < 0 || offset > static_cast<int>(contents_.length())) {
+    return EOFToken();
+  }
+  const auto found = TokenStartingAtOrBefore(contents_.begin() + offset);
+  if (found == tokens_.cend() || offset >= found->right(contents_)) {
+    return EOFToken();
+  }
+  return *found;
+}
+
 TokenInfo TextStructureView::FindTokenAt(const LineColumn& pos) const {
   if (pos.line < 0 || pos.column < 0) return EOFToken();
-  // Maybe do binary search here if we have a huge amount tokens per line.
-  for (const TokenInfo& token : TokenRangeOnLine(pos.line)) {
-    if (GetRangeForToken(token).PositionInRange(pos)) return token;
+  const std::vector<absl::string_view>& lines = Lines();
+  if (static_cast<size_t>(pos.line) >= lines.size()) return EOFToken();
+  const absl::string_view line = lines[pos.line];
+  // Columns past the end of the line are looked up at the end of the line,
+  // where a token spanning lines may be.
+  const auto found =
+      TokenStartingAtOrBefore(utf8_substr(line, pos.column).data());
+  // Only tokens starting on the line are found, as before.
+  if (found == tokens_.cend() || found->text().begin() < line.begin()) {
+    return EOFToken();
   }
+  if (GetRangeForToken(*found).PositionInRange(pos)) return *found;
   return EOFToken();
 }
 
@@ -193,6 +399,15 @@ static void TerminateTokenStream(TokenSequence* tokens) {
   tokens->push_back(TokenInfo::EOFToken(tokens->back().text()));
 }
 
+const SyntaxTreeIndex& TextStructureView::GetSyntaxTreeIndex() const {
+  if (lazy_syntax_tree_index_ == nullptr ||
+      lazy_syntax_tree_index_->Root() != syntax_tree_.get()) {
+    lazy_syntax_tree_index_ =
+        std::make_unique<SyntaxTreeIndex>(syntax_tree_.get());
+  }
+  return *lazy_syntax_tree_index_;
+}
+
 void TextStructureView::FocusOnSubtreeSpanningSubstring(int left_offset,
                                                         int length) {
   VLOG(2) << __FUNCTION__ << " at " << left_offset << " +" << length;
@@ -224,6 +439,7 @@ void TextStructureView::TrimSyntaxTree(int first_token_offset,
   const absl::string_view text_range(Contents().substr(
       first_token_offset, last_token_offset - first_token_offset));
   verible::TrimSyntaxTree(&syntax_tree_, text_range);
+  lazy_syntax_tree_index_.reset();
 }
 
 // Reduces the set of tokens to that spanned by [left_offset, right_offset).
@@ -289,15 +505,51 @@ void TextStructureView::TrimContents(int left_offset, int length) {
   contents_ = contents_.substr(left_offset, length);
 }
 
-const TextStructureView::LinesInfo& TextStructureView::LinesInfo::Get(
+const LineColumnMap& TextStructureView::LinesInfo::GetLineColumnMap(
     absl::string_view contents) {
-  if (valid) return *this;
+  if (!valid) {
+    line_column_map = std::make_unique<LineColumnMap>(contents);
+    lines.clear();
+    lines_valid = false;
+    widths.clear();
+    widths_valid = false;
+    valid = true;
+  }
+  return *line_column_map;
+}
 
-  lines = absl::StrSplit(contents, '\n');
-  line_column_map.reset(new LineColumnMap(lines));
-  valid = true;
+const std::vector<absl::string_view>& TextStructureView::LinesInfo::GetLines(
+    absl::string_view contents) {
+  const std::vector<int>& offsets =
+      GetLineColumnMap(contents).GetBeginningOfLineOffsets();
+  if (lines_valid) return lines;
+
+  // Each line ends before the newline that starts the next one; the last one
+  // ends with the contents.
+  lines.reserve(offsets.size());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    const int end =
+        i + 1 < offsets.size() ? offsets[i + 1] - 1 : contents.length();
+    lines.push_back(contents.substr(offsets[i], end - offsets[i]));
+  }
+  lines_valid = true;
+  return lines;
+}
 
-  return *this;
+const std::vector<int>& TextStructureView::LinesInfo::GetLineWidths(
+    absl::string_view contents) {
+  const std::vector<absl::string_view>& all_lines = GetLines(contents);
+  if (widths_valid) return widths;
+
+  widths.reserve(all_lines.size());
+  // Without multi-byte characters, which one scan of all contents rules out,
+  // every line has as many characters as bytes.
+  const bool ascii = utf8_len(contents) == static_cast<int>(contents.length());
+  for (const absl::string_view line : all_lines) {
+    widths.push_back(ascii ? line.length() : utf8_len(line));
+  }
+  widths_valid = true;
+  return widths;
 }
 
 void TextStructureView::RebaseTokensToSuperstring(absl::string_view superstring,
@@ -323,6 +575,7 @@ void TextStructureView::MutateTokens(const LeafMutator& mutator) {
     // The tokens at the leaves of the tree are their own copies, and thus
     // need to re-apply the same transformation.
     MutateLeaves(&syntax_tree_, mutator);
+    lazy_syntax_tree_index_.reset();  // tags may have changed
   }
 }
 
@@ -437,14 +690,20 @@ absl::Status TextStructureView::InternalConsistencyCheck() const {
 //
 // "view_source" is a sequence of iterators pointing to token_source content.
 // The TokenViewRange can be a container reference or iterator range.
+//
+// The destination must have been reserved to its final size beforehand so
+// that the iterators appended to view_destination are never invalidated.
 template <typename TokenRange, typename TokenViewRange>
 static void CopyTokensAndView(TokenSequence* destination,
-                              std::vector<int>* view_indices,
+                              TokenStreamView* view_destination,
                               const TokenRange& token_source,
                               const TokenViewRange& view_source) {
-  // Translate token_view's iterators into array indices, adjusting for the
-  // number of pre-existing tokens.
-  const auto pre_existing_start_index = destination->size();
+  const size_t token_count =
+      std::distance(token_source.begin(), token_source.end());
+  CHECK_LE(destination->size() + token_count, destination->capacity());
+  // Translate token_view's iterators into positions of the destination,
+  // adjusting for the number of pre-existing tokens.
+  const auto pre_existing_start = destination->cend();
   for (const auto& token_iter : view_source) {
     // TODO: something is wrong here, the view should never have iterators
     // pointing outside the range of the source. Needs to be explored.
@@ -452,35 +711,49 @@ static void CopyTokensAndView(TokenSequence* destination,
     CHECK(token_iter >= token_source.begin() &&
           token_iter < token_source.end());
 #endif
-    view_indices->push_back(pre_existing_start_index +
-                            std::distance(token_source.begin(), token_iter));
+    view_destination->push_back(
+        pre_existing_start + std::distance(token_source.begin(), token_iter));
   }
   // Copy tokens up to this expansion point.
-  for (const auto& token : token_source) {
-    destination->push_back(token);
+  destination->insert(destination->end(), token_source.begin(),
+                      token_source.end());
+}
+
+// Like std::lower_bound(), but probes exponentially growing distances from
+// the front first.  Consecutive expansion points are usually near each other,
+// so this costs O(log(distance)) instead of O(log(size)) per expansion.
+template <typename Iter, typename T, typename Compare>
+static Iter GallopingLowerBound(Iter first, Iter last, const T& value,
+                                Compare comp) {
+  typename std::iterator_traits<Iter>::difference_type step = 1;
+  while (step <= std::distance(first, last) && comp(first[step - 1], value)) {
+    first += step;
+    step *= 2;
   }
+  return std::lower_bound(
+      first, first + std::min(step, std::distance(first, last)), value, comp);
 }
 
 // Incrementally copies a slice of tokens and expands a single subtree.
 // This advances the next_token_iter and next_token_view_iter iterators.
 // The subtree from the expansion is transferred into this objects's syntax
-// tree.  Indices into the final token stream view are collected in
-// token_view_indices.  Offset is the location of each expansion point.
+// tree.  Iterators of the final token stream view are collected in
+// combined_view.  Offset is the location of each expansion point.
 void TextStructureView::ConsumeDeferredExpansion(
     TokenSequence::const_iterator* next_token_iter,
     TokenStreamView::const_iterator* next_token_view_iter,
     DeferredExpansion* expansion, TokenSequence* combined_tokens,
-    std::vector<int>* token_view_indices, const char* offset) {
+    TokenStreamView* combined_view, const char* offset) {
   auto token_iter = *next_token_iter;
   auto token_view_iter = *next_token_view_iter;
   // Find the position up to each expansion point.
-  *next_token_iter =
-      std::lower_bound(token_iter, tokens_.cend(), offset,
-                       [](const TokenInfo& token, const char* target) {
-                         return std::distance(target, token.text().begin()) < 0;
-                       });
+  *next_token_iter = GallopingLowerBound(
+      token_iter, tokens_.cend(), offset,
+      [](const TokenInfo& token, const char* target) {
+        return std::distance(target, token.text().begin()) < 0;
+      });
   CHECK(*next_token_iter != tokens_.cend());
-  *next_token_view_iter = std::lower_bound(
+  *next_token_view_iter = GallopingLowerBound(
       token_view_iter, tokens_view_.cend(), offset,
       [](TokenStreamView::const_reference token_ref, const char* target) {
         return std::distance(target, token_ref->text().begin()) < 0;
@@ -488,7 +761,7 @@ void TextStructureView::ConsumeDeferredExpansion(
   CHECK(*next_token_view_iter != tokens_view_.cend());
 
   // Copy tokens and partial view into output.
-  CopyTokensAndView(combined_tokens, token_view_indices,
+  CopyTokensAndView(combined_tokens, combined_view,
                     make_range(token_iter, *next_token_iter),
                     make_range(token_view_iter, *next_token_view_iter));
 
@@ -503,13 +776,12 @@ void TextStructureView::ConsumeDeferredExpansion(
   sub_data.RebaseTokensToSuperstring(contents_, sub_data_text,
                                      std::distance(contents_.begin(), offset));
 
-  // Translate token_view's iterators into array indices.
   if (!sub_data.tokens_.empty() && sub_data.tokens_.back().isEOF()) {
     // Remove auxiliary data's end-token sentinel before copying.
     // Don't want to splice it into result.
     sub_data.tokens_.pop_back();
   }
-  CopyTokensAndView(combined_tokens, token_view_indices, sub_data.tokens_,
+  CopyTokensAndView(combined_tokens, combined_view, sub_data.tokens_,
                     sub_data.tokens_view_);
 
   // Transfer ownership of transformed syntax tree to this object's tree.
@@ -531,39 +803,61 @@ TextStructure::TextStructure(std::shared_ptr<MemBlock> contents)
 TextStructure::TextStructure(absl::string_view contents)
     : TextStructure(std::make_shared<StringMemBlock>(contents)) {}
 
+TextStructure::TextStructure(TextStructure&& other) noexcept
+    : contents_(std::move(other.contents_)), data_(std::move(other.data_)) {}
+
+TextStructure& TextStructure::operator=(TextStructure&& other) noexcept {
+  if (this == &other) return *this;
+  // Release the tree and tokens before the memory that they point into.
+  data_ = std::move(other.data_);
+  contents_ = std::move(other.contents_);
+  return *this;
+}
+
 TextStructure::~TextStructure() {
   const absl::Status status = StringViewConsistencyCheck();
   CHECK(status.ok()) << status.message() << " (in dtor)";
 }
 
 void TextStructureView::ExpandSubtrees(NodeExpansionMap* expansions) {
+  if (expansions->empty()) return;
+  lazy_syntax_tree_index_.reset();
+
+  // Size the combined sequences once, so that the whole splice is a single
+  // merge pass without reallocation.  This over-counts by the expanded
+  // tokens and end-of-file sentinels, which is harmless.
+  size_t token_capacity = tokens_.size();
+  size_t view_capacity = tokens_view_.size();
+  for (const auto& expansion_entry : *expansions) {
+    const TextStructureView& sub_data =
+        ABSL_DIE_IF_NULL(expansion_entry.second.subanalysis)->Data();
+    token_capacity += sub_data.tokens_.size();
+    view_capacity += sub_data.tokens_view_.size();
+  }
   TokenSequence combined_tokens;
-  // Gather indices and reconstruct iterators after there are no more
-  // reallocations due to growing combined_tokens.
-  std::vector<int> combined_token_view_indices;
+  combined_tokens.reserve(token_capacity);
+  // Iterators into combined_tokens remain valid, because it never
+  // reallocates, and after it is swapped into tokens_.
+  TokenStreamView combined_view;
+  combined_view.reserve(view_capacity);
+
   auto token_iter = tokens_.cbegin();
   auto token_view_iter = tokens_view_.cbegin();
   for (auto& expansion_entry : *expansions) {
     const auto offset = Contents().begin() + expansion_entry.first;
     ConsumeDeferredExpansion(&token_iter, &token_view_iter,
                              &expansion_entry.second, &combined_tokens,
-                             &combined_token_view_indices, offset);
+                             &combined_view, offset);
   }
 
   // Copy the remaining tokens beyond the last expansion point.
-  CopyTokensAndView(&combined_tokens, &combined_token_view_indices,
+  CopyTokensAndView(&combined_tokens, &combined_view,
                     make_range(token_iter, tokens_.cend()),
                     make_range(token_view_iter, tokens_view_.cend()));
 
-  // Commit the newly expanded sequence of tokens.
+  // Commit the newly expanded sequence of tokens and its view.
   tokens_.swap(combined_tokens);
-
-  // Reconstruct view iterators from indices into the new sequence.
-  tokens_view_.clear();
-  tokens_view_.reserve(combined_token_view_indices.size());
-  for (const auto index : combined_token_view_indices) {
-    tokens_view_.push_back(tokens_.cbegin() + index);
-  }
+  tokens_view_.swap(combined_view);
 
   // Recalculate line-by-line token ranges.
   // TODO(fangism): Should be possible to update line_token_map_ incrementally
@@ -571,6 +865,14 @@ void TextStructureView::ExpandSubtrees(NodeExpansionMap* expansions) {
   CalculateFirstTokensPerLine();
 }
 
+verible::MemoryUsage TextStructure::MemoryUsage() const {
+  verible::MemoryUsage usage = data_.MemoryUsage();
+  if (contents_ != nullptr) {
+    usage.Add("contents", contents_->AsStringView().size());
+  }
+  return usage;
+}
+
 absl::Status TextStructure::StringViewConsistencyCheck() const {
   const absl::string_view contents = data_.Contents();
   if (!contents.empty() && !IsSubRange(contents, contents_->AsStringView())) {
@@ -37,6 +37,8 @@
 #include "common/strings/mem_block.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
+#include "common/text/syntax_tree_index.h"
+#include "common/util/memory_usage.h"
 #include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
 #include "common/text/tree_utils.h"
@@ -81,15 +83,35 @@ class TextStructureView {
   TextStructureView(const TextStructureView&) = delete;
   TextStructureView& operator=(const TextStructureView&) = delete;
 
+  // Moving transfers the tokens, their view and the syntax tree without
+  // copying them: iterators and string_views remain valid, as they point into
+  // memory that moves along.  The moved-from object is left empty.
+  TextStructureView(TextStructureView&& other) noexcept;
+  TextStructureView& operator=(TextStructureView&& other) noexcept;
+
   absl::string_view Contents() const { return contents_; }
 
   const std::vector<absl::string_view>& Lines() const {
-    return lazy_lines_info_.Get(contents_).lines;
+    return lazy_lines_info_.GetLines(contents_);
+  }
+
+  // Widths of the Lines() in characters, i.e. UTF-8 code points, computed on
+  // the first request.  For ASCII contents, these are the byte lengths.
+  const std::vector<int>& LineWidths() const {
+    return lazy_lines_info_.GetLineWidths(contents_);
   }
 
   const ConcreteSyntaxTree& SyntaxTree() const { return syntax_tree_; }
 
-  ConcreteSyntaxTree& MutableSyntaxTree() { return syntax_tree_; }
+  // Invalidates the syntax tree index.
+  ConcreteSyntaxTree& MutableSyntaxTree() {
+    lazy_syntax_tree_index_.reset();
+    return syntax_tree_;
+  }
+
+  // Returns an index of the syntax tree by node and leaf tags, which is built
+  // on the first request after the tree changes.
+  const SyntaxTreeIndex& GetSyntaxTreeIndex() const;
 
   const TokenSequence& TokenStream() const { return tokens_; }
 
@@ -104,7 +126,7 @@ class TextStructureView {
   TokenStreamReferenceView MakeTokenStreamReferenceView();
 
   const LineColumnMap& GetLineColumnMap() const {
-    return *lazy_lines_info_.Get(contents_).line_column_map;
+    return lazy_lines_info_.GetLineColumnMap(contents_);
   }
 
   // Given a byte offset, return the line/column
@@ -120,15 +142,27 @@ class TextStructureView {
   // of Contents(), return the range it covers.
   LineColumnRange GetRangeForText(absl::string_view text) const;
 
+  // Same as GetRangeForText() for each of the "texts", in any order, with
+  // all their starts and ends resolved in one pass over the lines.
+  std::vector<LineColumnRange> GetRangesForTexts(
+      const std::vector<absl::string_view>& texts) const;
+
   // checks if a given text belongs to the TextStructure
   bool ContainsText(absl::string_view text) const;
 
   const std::vector<TokenSequence::const_iterator>& GetLineTokenMap() const;
 
   // Given line/column, find token that is available there. If this is out of
-  // range, returns EOF.
+  // range, returns EOF.  Only tokens starting on the given line are found.
+  // Takes logarithmic time in the number of tokens, and does not need the
+  // line-token map, so lookups after re-lexing do not rebuild it.
   TokenInfo FindTokenAt(const LineColumn& pos) const;
 
+  // Returns the token whose text contains the byte 'offset' of Contents(),
+  // or EOF if there is none.  Takes logarithmic time in the number of
+  // tokens.
+  TokenInfo FindTokenAtOffset(int offset) const;
+
   // Create the EOF token given the contents.
   TokenInfo EOFToken() const;
 
@@ -172,6 +206,20 @@ class TextStructureView {
   // by this function.
   void ExpandSubtrees(NodeExpansionMap* expansions);
 
+  // Returns the estimated number of bytes held by the token stream, its view
+  // and the indices into them.
+  size_t TokenStreamMemoryUsage() const;
+
+  // Returns the estimated number of bytes held by each of the token stream,
+  // the line and position indices, the syntax tree and its index.  The
+  // contents are not owned by the view and not counted.
+  verible::MemoryUsage MemoryUsage() const;
+
+  // Drops the token stream, its view and the indices into them, keeping the
+  // contents and the syntax tree, whose leaves hold copies of their tokens.
+  // Afterwards, token lookups like FindTokenAt() find nothing.
+  void ReleaseTokenStream();
+
   // All of this class's consistency checks combined.
   absl::Status InternalConsistencyCheck() const;
 
@@ -184,16 +232,25 @@ class TextStructureView {
 
   // TODO(hzeller): These lazily generated elements are good candidates
   // for breaking out into their own abstraction.
+  // The contents are scanned for newlines once, for the line column map;
+  // the lines are derived from its offsets only when they are requested.
   struct LinesInfo {
-    bool valid = false;
+    bool valid = false;        // line_column_map describes the contents.
+    bool lines_valid = false;  // lines are derived from line_column_map.
+    bool widths_valid = false;  // widths are derived from lines.
 
     // Line-by-line view of contents_.
     std::vector<absl::string_view> lines;
 
+    // Characters of each of the lines.
+    std::vector<int> widths;
+
     // Map to translate byte-offsets to line and column for diagnostics.
     std::unique_ptr<LineColumnMap> line_column_map;
 
-    const LinesInfo& Get(absl::string_view contents);
+    const LineColumnMap& GetLineColumnMap(absl::string_view contents);
+    const std::vector<absl::string_view>& GetLines(absl::string_view contents);
+    const std::vector<int>& GetLineWidths(absl::string_view contents);
   };
   // Mutable as we fill it lazily on request; conceptually the data is const.
   mutable LinesInfo lazy_lines_info_;
@@ -209,9 +266,40 @@ class TextStructureView {
   // Lazily calculated on request.
   mutable std::vector<TokenSequence::const_iterator> lazy_line_token_map_;
 
+  // Line and column of where each token of tokens_ starts, computed in a
+  // single pass over the token stream, so that GetRangeForToken() does not
+  // have to search the line map nor count characters on each call.
+  struct TokenPositions {
+    // Text that the positions were computed for.
+    absl::string_view contents;
+
+    // Index: token index in tokens_, Value: byte offset of the token's start
+    // in contents, and its line and column.  Offsets are sorted.
+    std::vector<int> offsets;
+    std::vector<LineColumn> positions;
+
+    const TokenPositions& Get(absl::string_view contents,
+                              const TokenSequence& tokens);
+  };
+  // Mutable as we fill it lazily on request; conceptually the data is const.
+  mutable TokenPositions lazy_token_positions_;
+
+  // Returns the line and column at 'bytes_offset', looking it up in the token
+  // positions first at 'index_hint', then among all token starts.
+  LineColumn GetLineColAtTokenOffset(int bytes_offset,
+                                     size_t index_hint) const;
+
+  // Returns the last token of tokens_ that starts at or before 'pos', or
+  // tokens_.cend() if there is none.
+  TokenSequence::const_iterator TokenStartingAtOrBefore(const char* pos) const;
+
   // Tree representation of file contents.
   ConcreteSyntaxTree syntax_tree_;
 
+  // Index of syntax_tree_, lazily built on request, and reset whenever the
+  // tree may change.
+  mutable std::unique_ptr<SyntaxTreeIndex> lazy_syntax_tree_index_;
+
   void TrimSyntaxTree(int first_token_offset, int last_token_offset);
 
   void TrimTokensToSubstring(int left_offset, int right_offset);
@@ -222,7 +310,7 @@ class TextStructureView {
       TokenSequence::const_iterator* next_token_iter,
       TokenStreamView::const_iterator* next_token_view_iter,
       DeferredExpansion* expansion, TokenSequence* combined_tokens,
-      std::vector<int>* token_view_indices, const char* offset);
+      TokenStreamView* combined_view, const char* offset);
 
   // Resets all fields. Only needed in tests.
   void Clear();
@@ -263,6 +351,7 @@ class TextStructureView {
 // documentation of use currently).
 class TextStructure {
  private:
+  friend class ExpandSubtreesBenchmarkInput;
   friend class FileAnalyzer;
   friend class TextStructureTokenized;
   friend class TextStructureViewPublicTest_ExpandSubtreesOneLeaf_Test;
@@ -277,8 +366,11 @@ class TextStructure {
  public:
   TextStructure(const TextStructure&) = delete;
   TextStructure& operator=(const TextStructure&) = delete;
-  TextStructure(TextStructure&&) = delete;
-  TextStructure& operator=(TextStructure&&) = delete;
+
+  // An analysis can be handed over without copying, e.g. to another thread or
+  // into a cache.  The moved-from object is left empty.
+  TextStructure(TextStructure&& other) noexcept;
+  TextStructure& operator=(TextStructure&& other) noexcept;
 
   // DeferredExpansion::subanalysis requires this destructor to be virtual.
   virtual ~TextStructure();
@@ -289,6 +381,9 @@ class TextStructure {
 
   const ConcreteSyntaxTree& SyntaxTree() const { return data_.SyntaxTree(); }
 
+  // Like TextStructureView::MemoryUsage(), but also counts the contents.
+  verible::MemoryUsage MemoryUsage() const;
+
   // Verify that string_views are inside memory owned by owned_contents_.
   absl::Status StringViewConsistencyCheck() const;
 
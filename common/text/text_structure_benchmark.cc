@@ -0,0 +1,116 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures TextStructureView::ExpandSubtrees() splicing one small
+// subanalysis into every leaf of a flat syntax tree, the way macro call
+// arguments are expanded in files with many macro calls.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/util/casts.h"
+
+namespace verible {
+
+constexpr absl::string_view kWord = "abcd";
+
+// Lexes "abcd abcd ..." into one token per word, and parses them as the
+// leaves of one node.  Every leaf is to be expanded into a small subtree.
+class ExpandSubtreesBenchmarkInput {
+ public:
+  explicit ExpandSubtreesBenchmarkInput(absl::string_view text) : data_(text) {
+    TokenSequence &tokens = data_.MutableTokenStream();
+    for (size_t pos = 0; pos + kWord.length() <= text.length();
+         pos += kWord.length() + 1) {
+      tokens.emplace_back(1, text.substr(pos, kWord.length()));
+    }
+    tokens.push_back(TokenInfo::EOFToken(text));
+    SymbolPtr tree = MakeNode();
+    auto *node = down_cast<SyntaxTreeNode *>(tree.get());
+    for (auto iter = tokens.cbegin(); iter + 1 != tokens.cend(); ++iter) {
+      data_.MutableTokenStreamView().push_back(iter);
+      node->AppendChild(std::make_unique<SyntaxTreeLeaf>(*iter));
+    }
+    data_.MutableSyntaxTree() = std::move(tree);
+
+    auto children = node->mutable_children();
+    auto child_iter = children.begin();
+    for (const auto &token : data_.TokenStream()) {
+      if (token.isEOF()) break;
+      expansions_[token.left(text)] = {&*child_iter++,
+                                       ParseWord(token.text())};
+    }
+  }
+
+  void ExpandSubtrees() { data_.ExpandSubtrees(&expansions_); }
+
+  const TextStructureView &Data() const { return data_; }
+
+ private:
+  // Splits a word into a node with two leaves, as a separate analysis.
+  static std::unique_ptr<TextStructure> ParseWord(absl::string_view word) {
+    std::unique_ptr<TextStructure> analysis(new TextStructure(word));
+    TextStructureView &data = analysis->MutableData();
+    const absl::string_view contents = data.Contents();
+    TokenSequence &tokens = data.MutableTokenStream();
+    tokens.emplace_back(2, contents.substr(0, 2));
+    tokens.emplace_back(3, contents.substr(2));
+    tokens.push_back(TokenInfo::EOFToken(contents));
+    data.MutableTokenStreamView().push_back(tokens.cbegin());
+    data.MutableTokenStreamView().push_back(tokens.cbegin() + 1);
+    data.MutableSyntaxTree() =
+        MakeTaggedNode(4, std::make_unique<SyntaxTreeLeaf>(tokens[0]),
+                       std::make_unique<SyntaxTreeLeaf>(tokens[1]));
+    return analysis;
+  }
+
+  TextStructureView data_;
+  TextStructureView::NodeExpansionMap expansions_;
+};
+
+namespace {
+
+static void BM_ExpandSubtreesEveryLeaf(benchmark::State &state) {
+  const int num_words = state.range(0);
+  std::string text;
+  for (int i = 0; i < num_words; ++i) {
+    text.append(kWord.begin(), kWord.end());
+    text.push_back(' ');
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto input = std::make_unique<ExpandSubtreesBenchmarkInput>(text);
+    state.ResumeTiming();
+    input->ExpandSubtrees();
+    benchmark::DoNotOptimize(input->Data().TokenStream().data());
+    state.PauseTiming();
+    input.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * num_words);
+}
+BENCHMARK(BM_ExpandSubtreesEveryLeaf)->Arg(1000)->Arg(10000)->Arg(100000);
+
+}  // namespace
+}  // namespace verible
+
+BENCHMARK_MAIN();
@@ -0,0 +1,287 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/text_structure_binary.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/range.h"
+
+namespace verible {
+
+static constexpr absl::string_view kMagic = "VTSB";
+static constexpr uint32_t kFormatVersion = 1;
+
+static constexpr size_t kHeaderWords = 6;
+static constexpr size_t kTokenWords = 3;
+static constexpr size_t kViewWords = 1;
+static constexpr size_t kTreeRecordWords = 4;
+
+enum TreeRecordKind : uint32_t {
+  kNullRecord = 0,
+  kLeafRecord = 1,
+  kNodeRecord = 2,
+};
+
+namespace {
+class WordWriter {
+ public:
+  explicit WordWriter(size_t num_words) { out_.reserve(num_words * 4); }
+
+  void Write(uint32_t word) {
+    for (int i = 0; i < 4; ++i) {
+      out_.push_back(static_cast<char>((word >> (8 * i)) & 0xff));
+    }
+  }
+
+  std::string Release() { return std::move(out_); }
+
+ private:
+  std::string out_;
+};
+
+class WordReader {
+ public:
+  explicit WordReader(absl::string_view data) : data_(data) {}
+
+  // Precondition: enough words left, which is checked upfront.
+  uint32_t Read() {
+    uint32_t word = 0;
+    for (int i = 0; i < 4; ++i) {
+      word |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_ + i]))
+              << (8 * i);
+    }
+    pos_ += 4;
+    return word;
+  }
+
+ private:
+  const absl::string_view data_;
+  size_t pos_ = 0;
+};
+}  // namespace
+
+// Returns the byte range of "text" within "contents", or false if "text" is
+// not part of it.
+static bool ByteRange(absl::string_view text, absl::string_view contents,
+                      uint32_t *offset, uint32_t *length) {
+  if (!IsSubRange(text, contents)) return false;
+  *offset = std::distance(contents.begin(), text.begin());
+  *length = text.length();
+  return true;
+}
+
+static absl::Status NotInContents(const TokenInfo &token) {
+  return absl::InvalidArgumentError(
+      absl::StrCat("Token text is not within the contents: ", token.text()));
+}
+
+absl::StatusOr<std::string> SerializeTextStructure(
+    const TextStructureView &view) {
+  const absl::string_view contents = view.Contents();
+  const TokenSequence &tokens = view.TokenStream();
+  const TokenStreamView &tokens_view = view.GetTokenStreamView();
+  if (contents.length() > std::numeric_limits<uint32_t>::max() ||
+      tokens.size() > std::numeric_limits<uint32_t>::max()) {
+    return absl::InvalidArgumentError("Text structure too large.");
+  }
+
+  // Flatten the tree first; its size goes into the header.
+  std::vector<const Symbol *> preorder;
+  std::vector<const Symbol *> to_visit = {view.SyntaxTree().get()};
+  while (!to_visit.empty()) {
+    const Symbol *const symbol = to_visit.back();
+    to_visit.pop_back();
+    preorder.push_back(symbol);
+    if (symbol == nullptr || symbol->Kind() != SymbolKind::kNode) continue;
+    const SyntaxTreeNode &node = SymbolCastToNode(*symbol);
+    for (size_t i = node.size(); i > 0; --i) {
+      to_visit.push_back(node[i - 1].get());
+    }
+  }
+
+  WordWriter writer(kHeaderWords + kTokenWords * tokens.size() +
+                    kViewWords * tokens_view.size() +
+                    kTreeRecordWords * preorder.size());
+  uint32_t magic = 0;
+  for (int i = 0; i < 4; ++i) {
+    magic |= static_cast<uint32_t>(static_cast<uint8_t>(kMagic[i])) << (8 * i);
+  }
+  writer.Write(magic);
+  writer.Write(kFormatVersion);
+  writer.Write(contents.length());
+  writer.Write(tokens.size());
+  writer.Write(tokens_view.size());
+  writer.Write(preorder.size());
+
+  uint32_t offset;
+  uint32_t length;
+  for (const TokenInfo &token : tokens) {
+    if (!ByteRange(token.text(), contents, &offset, &length)) {
+      return NotInContents(token);
+    }
+    writer.Write(token.token_enum());
+    writer.Write(offset);
+    writer.Write(length);
+  }
+
+  for (const auto &token_iter : tokens_view) {
+    writer.Write(std::distance(tokens.begin(), token_iter));
+  }
+
+  for (const Symbol *symbol : preorder) {
+    if (symbol == nullptr) {
+      writer.Write(kNullRecord);
+      writer.Write(0);
+      writer.Write(0);
+      writer.Write(0);
+    } else if (symbol->Kind() == SymbolKind::kLeaf) {
+      const TokenInfo &token = SymbolCastToLeaf(*symbol).get();
+      if (!ByteRange(token.text(), contents, &offset, &length)) {
+        return NotInContents(token);
+      }
+      writer.Write(kLeafRecord);
+      writer.Write(token.token_enum());
+      writer.Write(offset);
+      writer.Write(length);
+    } else {
+      const SyntaxTreeNode &node = SymbolCastToNode(*symbol);
+      writer.Write(kNodeRecord);
+      writer.Write(node.Tag().tag);
+      writer.Write(node.size());
+      writer.Write(0);
+    }
+  }
+  return writer.Release();
+}
+
+static absl::Status Corrupt(absl::string_view what) {
+  return absl::DataLossError(
+      absl::StrCat("Invalid serialized text structure: ", what));
+}
+
+absl::Status DeserializeTextStructure(absl::string_view serialized,
+                                      TextStructureView *view) {
+  const absl::string_view contents = view->Contents();
+  if (serialized.length() < 4 * kHeaderWords) return Corrupt("short header");
+  if (serialized.substr(0, 4) != kMagic) return Corrupt("wrong magic");
+
+  WordReader reader(serialized);
+  reader.Read();  // magic, checked above.
+  if (reader.Read() != kFormatVersion) return Corrupt("unsupported version");
+  if (reader.Read() != contents.length()) return Corrupt("contents differ");
+  const uint64_t num_tokens = reader.Read();
+  const uint64_t num_view = reader.Read();
+  const uint64_t num_records = reader.Read();
+  const uint64_t expected_words = kHeaderWords + kTokenWords * num_tokens +
+                                  kViewWords * num_view +
+                                  kTreeRecordWords * num_records;
+  if (serialized.length() != 4 * expected_words) return Corrupt("size");
+  if (num_records == 0) return Corrupt("missing tree");
+
+  const auto text_at = [contents](uint32_t offset, uint32_t length,
+                                  absl::string_view *text) {
+    if (offset > contents.length() || length > contents.length() - offset) {
+      return false;
+    }
+    *text = contents.substr(offset, length);
+    return true;
+  };
+
+  TokenSequence tokens;
+  tokens.reserve(num_tokens);
+  absl::string_view text;
+  for (uint64_t i = 0; i < num_tokens; ++i) {
+    const int token_enum = static_cast<int32_t>(reader.Read());
+    const uint32_t offset = reader.Read();
+    const uint32_t length = reader.Read();
+    if (!text_at(offset, length, &text)) return Corrupt("token range");
+    tokens.emplace_back(token_enum, text);
+  }
+
+  // Iterators are only taken once the token sequence is complete.
+  std::vector<uint32_t> view_indices;
+  view_indices.reserve(num_view);
+  for (uint64_t i = 0; i < num_view; ++i) {
+    const uint32_t index = reader.Read();
+    if (index >= num_tokens) return Corrupt("view index");
+    view_indices.push_back(index);
+  }
+
+  // Nodes that still wait for some of their children.
+  std::vector<std::pair<SyntaxTreeNode *, uint32_t>> open_nodes;
+  ConcreteSyntaxTree root;
+  for (uint64_t i = 0; i < num_records; ++i) {
+    const uint32_t kind = reader.Read();
+    const int tag = static_cast<int32_t>(reader.Read());
+    const uint32_t a = reader.Read();
+    const uint32_t b = reader.Read();
+    SymbolPtr symbol;
+    SyntaxTreeNode *new_node = nullptr;
+    switch (kind) {
+      case kNullRecord:
+        break;
+      case kLeafRecord:
+        if (!text_at(a, b, &text)) return Corrupt("leaf range");
+        symbol = std::make_unique<SyntaxTreeLeaf>(tag, text);
+        break;
+      case kNodeRecord:
+        if (a > num_records - i - 1) return Corrupt("child count");
+        new_node = new SyntaxTreeNode(tag);
+        symbol.reset(new_node);
+        break;
+      default:
+        return Corrupt("record kind");
+    }
+
+    if (i == 0) {
+      root = std::move(symbol);
+    } else {
+      if (open_nodes.empty()) return Corrupt("extra tree records");
+      open_nodes.back().first->AppendChild(std::move(symbol));
+      if (--open_nodes.back().second == 0) open_nodes.pop_back();
+    }
+    if (new_node != nullptr && a > 0) open_nodes.emplace_back(new_node, a);
+  }
+  if (!open_nodes.empty()) return Corrupt("missing tree records");
+
+  view->MutableTokenStream() = std::move(tokens);
+  TokenStreamView &tokens_view = view->MutableTokenStreamView();
+  tokens_view.clear();
+  tokens_view.reserve(view_indices.size());
+  for (const uint32_t index : view_indices) {
+    tokens_view.push_back(view->TokenStream().begin() + index);
+  }
+  view->MutableSyntaxTree() = std::move(root);
+  view->CalculateFirstTokensPerLine();
+  return absl::OkStatus();
+}
+
+}  // namespace verible
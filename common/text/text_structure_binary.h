@@ -0,0 +1,67 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_TEXT_TEXT_STRUCTURE_BINARY_H_
+#define VERIBLE_COMMON_TEXT_TEXT_STRUCTURE_BINARY_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/text/text_structure.h"
+
+namespace verible {
+
+// Binary serialization of the token stream, token stream view and syntax
+// tree of a TextStructureView.  Token text is not stored; tokens and leaves
+// refer to byte ranges of the view's Contents(), so the serialized form can
+// only be loaded back over the same text.
+//
+// All fields are 32-bit little-endian words:
+//
+//   header: magic "VTSB", format version, content length,
+//           number of tokens, number of view entries, number of tree records
+//   tokens: (token enum, byte offset, byte length) per token
+//   view:   index into tokens per token stream view entry
+//   tree:   the syntax tree in preorder, one record of
+//           (kind, tag, a, b) per symbol:
+//             null:  kind 0
+//             leaf:  kind 1, tag = token enum, a = byte offset, b = length
+//             node:  kind 2, tag = node tag, a = number of children
+//
+// Loading reads the words in place and has no alignment requirements, so
+// the serialized form can be used straight from a memory-mapped file (see
+// file::GetContentAsMemBlock()).  Tokens are restored into one contiguous
+// TokenSequence; only the tree nodes and leaves are allocated individually.
+//
+// The format version is incremented with any incompatible change.  Token
+// enums and node tags are those of the language that produced the view,
+// so consumers also need to match the version of its grammar.
+
+// Returns the serialized form of "view".  Fails if a token or leaf does not
+// point into view.Contents(), e.g. text that came from an included file.
+absl::StatusOr<std::string> SerializeTextStructure(
+    const TextStructureView &view);
+
+// Replaces tokens, token stream view and syntax tree of "view" with the ones
+// stored in "serialized" by SerializeTextStructure() from a view over the
+// same contents.  Validates all sizes, offsets and indices, so corrupt input
+// results in an error; "view" is only modified on success.
+absl::Status DeserializeTextStructure(absl::string_view serialized,
+                                      TextStructureView *view);
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_TEXT_STRUCTURE_BINARY_H_
@@ -0,0 +1,136 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/text_structure_binary.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include "absl/status/status.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/text_structure.h"
+#include "common/text/text_structure_test_utils.h"
+#include "common/text/token_info.h"
+#include "common/text/tree_builder_test_util.h"
+#include "common/text/tree_compare.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+// Tokens of both views are expected to point into the same contents.
+void ExpectSameTextStructure(const TextStructureView &expected,
+                             const TextStructureView &actual) {
+  EXPECT_EQ(expected.TokenStream(), actual.TokenStream());
+  ASSERT_EQ(expected.GetTokenStreamView().size(),
+            actual.GetTokenStreamView().size());
+  for (size_t i = 0; i < expected.GetTokenStreamView().size(); ++i) {
+    EXPECT_EQ(std::distance(expected.TokenStream().begin(),
+                            expected.GetTokenStreamView()[i]),
+              std::distance(actual.TokenStream().begin(),
+                            actual.GetTokenStreamView()[i]));
+  }
+  EXPECT_TRUE(
+      EqualTrees(expected.SyntaxTree().get(), actual.SyntaxTree().get()));
+}
+
+TEST(TextStructureBinaryTest, RoundTrip) {
+  const auto original = MakeTextStructureViewHelloWorld();
+  const auto serialized = SerializeTextStructure(*original);
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+
+  TextStructureView restored(original->Contents());
+  EXPECT_TRUE(DeserializeTextStructure(*serialized, &restored).ok());
+  ExpectSameTextStructure(*original, restored);
+}
+
+TEST(TextStructureBinaryTest, RoundTripNullChildrenAndNoLeaves) {
+  const auto original = MakeTextStructureViewWithNoLeaves();
+  SymbolCastToNode(*original->MutableSyntaxTree()).AppendChild(nullptr);
+  const auto serialized = SerializeTextStructure(*original);
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+
+  TextStructureView restored(original->Contents());
+  EXPECT_TRUE(DeserializeTextStructure(*serialized, &restored).ok());
+  ExpectSameTextStructure(*original, restored);
+}
+
+TEST(TextStructureBinaryTest, RoundTripWithoutTree) {
+  TextStructureView original("");
+  const auto serialized = SerializeTextStructure(original);
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+
+  TextStructureView restored(original.Contents());
+  EXPECT_TRUE(DeserializeTextStructure(*serialized, &restored).ok());
+  EXPECT_EQ(restored.SyntaxTree(), nullptr);
+  EXPECT_TRUE(restored.TokenStream().empty());
+}
+
+TEST(TextStructureBinaryTest, RejectsTextOutsideOfContents) {
+  const auto view = MakeTextStructureViewHelloWorld();
+  view->MutableSyntaxTree() = Node(Leaf(1, "elsewhere"));
+  EXPECT_FALSE(SerializeTextStructure(*view).ok());
+  view->MutableSyntaxTree() = nullptr;  // Would fail the consistency check.
+}
+
+TEST(TextStructureBinaryTest, RejectsOtherContents) {
+  const auto original = MakeTextStructureViewHelloWorld();
+  const auto serialized = SerializeTextStructure(*original);
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+
+  TextStructureView other("hello");
+  EXPECT_EQ(DeserializeTextStructure(*serialized, &other).code(),
+            absl::StatusCode::kDataLoss);
+}
+
+TEST(TextStructureBinaryTest, RejectsCorruptData) {
+  const auto original = MakeTextStructureViewHelloWorld();
+  const auto serialized = SerializeTextStructure(*original);
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+
+  const auto corrupt = [&](size_t pos, char c) {
+    std::string result = *serialized;
+    result[pos] = c;
+    return result;
+  };
+  // Header: magic, version, contents length, number of tokens, view entries
+  // and tree records.  Then 4 tokens of 3 words, and 3 view entries.
+  constexpr size_t kFirstToken = 6 * 4;
+  constexpr size_t kFirstView = kFirstToken + 4 * 3 * 4;
+  constexpr size_t kFirstTreeRecord = kFirstView + 3 * 4;
+  const std::string kCorruptions[] = {
+      serialized->substr(0, serialized->length() - 1),
+      *serialized + "x",
+      corrupt(0, 'X'),                     // magic
+      corrupt(4, 7),                       // version
+      corrupt(kFirstToken + 4, 100),       // token offset
+      corrupt(kFirstToken + 8, 100),       // token length
+      corrupt(kFirstView, 9),              // view index
+      corrupt(kFirstTreeRecord, 7),        // record kind
+      corrupt(kFirstTreeRecord + 8, 2),    // root child count too small
+      corrupt(kFirstTreeRecord + 8, 100),  // root child count too large
+  };
+  for (const std::string &data : kCorruptions) {
+    TextStructureView restored(original->Contents());
+    EXPECT_EQ(DeserializeTextStructure(data, &restored).code(),
+              absl::StatusCode::kDataLoss);
+    // Unchanged on failure.
+    EXPECT_TRUE(restored.TokenStream().empty());
+    EXPECT_EQ(restored.SyntaxTree(), nullptr);
+  }
+}
+
+}  // namespace
+}  // namespace verible
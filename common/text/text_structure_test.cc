@@ -25,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/line_column_map.h"
+#include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/constants.h"
 #include "common/text/symbol.h"
@@ -46,6 +47,7 @@
 
 namespace verible {
 
+using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 using ::testing::IsNull;
 using ::testing::SizeIs;
@@ -63,6 +65,31 @@ TEST(TextStructureViewCtorTest, InitializeContents) {
   }
 }
 
+// Lines are derived from the same offsets as the line column map.
+TEST(TextStructureViewCtorTest, LinesMatchLineColumnMap) {
+  const char *inputs[] = {"", "\n", "foo", "foo\nbar", "foo\n\nbar\n"};
+  for (const auto *input : inputs) {
+    TextStructureView test_view(input);
+    const auto &lines = test_view.Lines();
+    const auto &offsets =
+        test_view.GetLineColumnMap().GetBeginningOfLineOffsets();
+    ASSERT_EQ(lines.size(), offsets.size()) << input;
+    for (size_t i = 0; i < lines.size(); ++i) {
+      EXPECT_EQ(lines[i].data() - test_view.Contents().data(), offsets[i]);
+      EXPECT_EQ(lines[i].find('\n'), absl::string_view::npos);
+    }
+  }
+}
+
+// Line widths count characters, not bytes.
+TEST(TextStructureViewCtorTest, LineWidths) {
+  EXPECT_THAT(TextStructureView("").LineWidths(), ElementsAre(0));
+  EXPECT_THAT(TextStructureView("foo\n\nbar baz\n").LineWidths(),
+              ElementsAre(3, 0, 7, 0));
+  EXPECT_THAT(TextStructureView("f\xc3\xb6\xc3\xb6\nbar").LineWidths(),
+              ElementsAre(3, 3));
+}
+
 // Test that filtering nothing works.
 TEST(FilterTokensTest, EmptyTokens) {
   TextStructureView test_view("blah");
@@ -268,6 +295,50 @@ TEST_F(TokenRangeTest, FindTokenAtPosition) {
   EXPECT_TRUE(data_.FindTokenAt({42, 7}).isEOF());
 }
 
+// Positions are in characters, and tokens spanning lines are found on the
+// line they start on.
+TEST(FindTokenAtTest, MultiByteAndMultiLineTokens) {
+  const TextStructureTokenized text(
+      {{TokenInfo(3, "\xc3\xa4\xc3\xb6"), TokenInfo(2, " "),
+        TokenInfo(5, "/* x\ny */")},
+       {TokenInfo(4, "\n")}});
+  const TextStructureView &data = text.Data();
+  EXPECT_EQ(data.FindTokenAt({0, 0}).text(), "\xc3\xa4\xc3\xb6");
+  EXPECT_EQ(data.FindTokenAt({0, 1}).text(), "\xc3\xa4\xc3\xb6");
+  EXPECT_EQ(data.FindTokenAt({0, 2}).text(), " ");
+  EXPECT_EQ(data.FindTokenAt({0, 3}).text(), "/* x\ny */");
+  EXPECT_EQ(data.FindTokenAt({0, 100}).text(), "/* x\ny */");
+  // Continuation lines of a token do not start it.
+  EXPECT_TRUE(data.FindTokenAt({1, 0}).isEOF());
+  EXPECT_EQ(data.FindTokenAt({1, 4}).text(), "\n");
+}
+
+TEST_F(TokenRangeTest, FindTokenAtOffset) {
+  EXPECT_EQ(data_.FindTokenAtOffset(0).text(), "hello");
+  EXPECT_EQ(data_.FindTokenAtOffset(4).text(), "hello");
+  EXPECT_EQ(data_.FindTokenAtOffset(5).text(), ",");
+  EXPECT_EQ(data_.FindTokenAtOffset(12).text(), "\n");
+  EXPECT_EQ(data_.FindTokenAtOffset(13).text(), "\n");
+  EXPECT_TRUE(data_.FindTokenAtOffset(-1).isEOF());
+  EXPECT_TRUE(data_.FindTokenAtOffset(1000).isEOF());
+}
+
+TEST_F(TokenRangeTest, ReleaseTokenStream) {
+  const TokenInfo token = data_.FindTokenAt({0, 7});
+  EXPECT_GT(data_.TokenStreamMemoryUsage(), 0);
+  data_.ReleaseTokenStream();
+  EXPECT_EQ(data_.TokenStreamMemoryUsage(), 0);
+  EXPECT_TRUE(data_.TokenStream().empty());
+  EXPECT_TRUE(data_.GetTokenStreamView().empty());
+  EXPECT_TRUE(data_.FindTokenAt({0, 7}).isEOF());
+
+  // Text ranges are still found from the contents.
+  const LineColumnRange range = data_.GetRangeForText(token.text());
+  EXPECT_EQ(range.start.line, 0);
+  EXPECT_EQ(range.start.column, 7);
+  EXPECT_EQ(data_.GetRangeForToken(token), range);
+}
+
 // Checks that when lower == upper, returned range is empty.
 TEST_F(TokenRangeTest, TokenRangeSpanningOffsetsEmpty) {
   const size_t test_offsets[] = {0, 1, 4, 12, 18, 22, 26};
@@ -334,6 +405,119 @@ TEST_F(TokenRangeTest, TokenRangeOnLine) {
   }
 }
 
+// Checks that ranges of tokens, whether from the token stream or copies of
+// them, agree with the line column map, also past multi-byte characters.
+TEST(GetRangeForTokenTest, MatchesLineColumnMap) {
+  const TextStructureTokenized text_structure(
+      {{TokenInfo(3, "h\xc3\xa9llo"), TokenInfo(2, " "), TokenInfo(3, "w"),
+        TokenInfo(4, "\n")},
+       {TokenInfo(2, "  "), TokenInfo(3, "\xe2\x82\xac"), TokenInfo(3, "x"),
+        TokenInfo(4, "\n")},
+       {TokenInfo(3, "end"), TokenInfo(4, "\n")}});
+  const TextStructureView &data = text_structure.Data();
+  const absl::string_view contents = data.Contents();
+  for (const TokenInfo &token : data.TokenStream()) {
+    const LineColumnRange expected{
+        data.GetLineColAtOffset(token.left(contents)),
+        data.GetLineColAtOffset(token.right(contents))};
+    EXPECT_EQ(data.GetRangeForToken(token), expected) << token;
+    const TokenInfo copy(token);
+    EXPECT_EQ(data.GetRangeForToken(copy), expected) << token;
+    EXPECT_EQ(data.GetRangeForText(token.text()), expected) << token;
+  }
+  const TokenInfo &x = data.TokenStream()[6];
+  EXPECT_EQ(x.text(), "x");
+  EXPECT_EQ(data.GetRangeForToken(x), (LineColumnRange{{1, 3}, {1, 4}}));
+  // Ranges that do not start or end at a token boundary.
+  EXPECT_EQ(data.GetRangeForText(contents.substr(1, 4)),
+            (LineColumnRange{{0, 1}, {0, 4}}));
+}
+
+// Checks that ranges of many texts at once, in any order and possibly
+// overlapping, agree with the ranges of each text.
+TEST(GetRangesForTextsTest, MatchesRangeOfEachText) {
+  const TextStructureTokenized text_structure(
+      {{TokenInfo(3, "h\xc3\xa9llo"), TokenInfo(2, " "), TokenInfo(3, "w"),
+        TokenInfo(4, "\n")},
+       {TokenInfo(2, "  "), TokenInfo(3, "\xe2\x82\xac"), TokenInfo(3, "x"),
+        TokenInfo(4, "\n")},
+       {TokenInfo(3, "end"), TokenInfo(4, "\n")}});
+  const TextStructureView &data = text_structure.Data();
+  const absl::string_view contents = data.Contents();
+  const std::vector<absl::string_view> texts = {
+      contents.substr(15, 3), contents, contents.substr(1, 4),
+      contents.substr(3, 10), contents.substr(0, 0)};
+  const std::vector<LineColumnRange> ranges = data.GetRangesForTexts(texts);
+  ASSERT_EQ(ranges.size(), texts.size());
+  for (size_t i = 0; i < texts.size(); ++i) {
+    EXPECT_EQ(ranges[i], data.GetRangeForText(texts[i])) << texts[i];
+  }
+  EXPECT_TRUE(data.GetRangesForTexts({}).empty());
+}
+
+// Test that moving a view keeps its tokens, view and tree in place.
+TEST(TextStructureViewMoveTest, MoveConstruct) {
+  auto original = MakeTextStructureViewHelloWorld();
+  const TokenInfo *tokens_data = original->TokenStream().data();
+  const Symbol *tree = original->SyntaxTree().get();
+  const absl::string_view contents = original->Contents();
+
+  TextStructureView moved(std::move(*original));
+  EXPECT_EQ(moved.Contents(), contents);
+  EXPECT_EQ(moved.TokenStream().data(), tokens_data);
+  EXPECT_EQ(moved.SyntaxTree().get(), tree);
+  ASSERT_THAT(moved.GetTokenStreamView(), SizeIs(3));
+  EXPECT_EQ(moved.GetTokenStreamView().front(), moved.TokenStream().begin());
+  EXPECT_OK(moved.InternalConsistencyCheck());
+
+  EXPECT_TRUE(original->Contents().empty());
+  EXPECT_THAT(original->TokenStream(), IsEmpty());
+  EXPECT_THAT(original->GetTokenStreamView(), IsEmpty());
+  EXPECT_THAT(original->SyntaxTree(), IsNull());
+  EXPECT_OK(original->InternalConsistencyCheck());
+}
+
+TEST(TextStructureViewMoveTest, MoveAssign) {
+  auto original = MakeTextStructureViewHelloWorld();
+  const TokenInfo *tokens_data = original->TokenStream().data();
+  auto moved = MakeTextStructureViewWithNoLeaves();
+
+  *moved = std::move(*original);
+  EXPECT_EQ(moved->Contents(), "hello, world");
+  EXPECT_EQ(moved->TokenStream().data(), tokens_data);
+  EXPECT_THAT(moved->GetTokenStreamView(), SizeIs(3));
+  EXPECT_EQ(moved->FindTokenAt({0, 7}).text(), "world");
+  EXPECT_OK(moved->InternalConsistencyCheck());
+
+  EXPECT_THAT(original->TokenStream(), IsEmpty());
+  EXPECT_THAT(original->SyntaxTree(), IsNull());
+  EXPECT_OK(original->InternalConsistencyCheck());
+}
+
+// Test that a moved TextStructure still owns the text its tokens point into.
+TEST(TextStructureMoveTest, MoveConstruct) {
+  TextStructureTokenized text_structure(
+      {{TokenInfo(3, "hello"), TokenInfo(4, "\n")},
+       {TokenInfo(3, "world"), TokenInfo(4, "\n")}});
+  const absl::string_view contents = text_structure.Data().Contents();
+
+  const TextStructure moved(std::move(text_structure));
+  EXPECT_EQ(moved.Data().Contents().data(), contents.data());
+  EXPECT_THAT(moved.Data().TokenStream(), SizeIs(4));
+  EXPECT_OK(moved.InternalConsistencyCheck());
+
+  EXPECT_TRUE(text_structure.Data().Contents().empty());
+  EXPECT_OK(text_structure.InternalConsistencyCheck());
+}
+
+TEST(TextStructureMemoryUsageTest, CountsContents) {
+  const TextStructureTokenized text_structure(
+      {{TokenInfo(3, "hello"), TokenInfo(4, "\n")}});
+  const auto usage = text_structure.MemoryUsage();
+  EXPECT_EQ(usage.Components().at("contents"), 6);
+  EXPECT_EQ(usage.Total(), text_structure.Data().MemoryUsage().Total() + 6);
+}
+
 // Testing select public methods of TextStructureView.
 class TextStructureViewPublicTest : public ::testing::Test,
                                     public TextStructureView {
@@ -458,6 +642,21 @@ TEST_F(TextStructureViewPublicTest, FocusOnSubtreeSpanningSubstringFirstLeaf) {
 }
 
 // Test that ExpandSubtrees on an empty map changes nothing.
+TEST_F(TextStructureViewPublicTest, MemoryUsage) {
+  const auto components = [this] { return MemoryUsage().Components(); };
+  EXPECT_EQ(components().at("tokens"), tokens_.capacity() * sizeof(TokenInfo));
+  EXPECT_GE(components().at("syntax_tree"),
+            sizeof(SyntaxTreeNode) + 3 * sizeof(SyntaxTreeLeaf));
+  EXPECT_EQ(components().count("contents"), 0);
+  EXPECT_EQ(components().count("syntax_tree_index"), 0);
+
+  // Lazily built indices are counted once they exist.
+  EXPECT_EQ(GetSyntaxTreeIndex().size(), 4);
+  EXPECT_GT(components().at("syntax_tree_index"), 0);
+  EXPECT_GT(MemoryUsage().Total(), components().at("syntax_tree_index") +
+                                       components().at("syntax_tree"));
+}
+
 TEST_F(TextStructureViewPublicTest, ExpandSubtreesEmpty) {
   const auto expect_tree =
       Node(Leaf(tokens_[0]), Leaf(tokens_[1]), Leaf(tokens_[3]));
@@ -17,6 +17,8 @@
 #include <sstream>
 #include <string>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "common/text/token_info.h"
 #include "nlohmann/json.hpp"
 
@@ -38,4 +40,10 @@ nlohmann::json ToJson(const TokenInfo &token_info,
   return json;
 }
 
+void AppendCompactJson(const TokenInfo &token_info, absl::string_view base,
+                       std::string *out) {
+  absl::StrAppend(out, "[", token_info.token_enum(), ",",
+                  token_info.left(base), ",", token_info.right(base), "]");
+}
+
 }  // namespace verible
@@ -15,6 +15,9 @@
 #ifndef VERIBLE_COMMON_TEXT_TOKEN_INFO_JSON_H_
 #define VERIBLE_COMMON_TEXT_TOKEN_INFO_JSON_H_
 
+#include <string>
+
+#include "absl/strings/string_view.h"
 #include "common/text/token_info.h"
 #include "nlohmann/json.hpp"
 
@@ -25,6 +28,13 @@ nlohmann::json ToJson(const TokenInfo &token_info,
                       const TokenInfo::Context &context,
                       bool include_text = false);
 
+// Appends the compact JSON representation of TokenInfo to "out", without
+// building a JSON value: [<token enum>, <start>, <end>], with the offsets
+// relative to "base".  The text is left for consumers to slice from the
+// source.
+void AppendCompactJson(const TokenInfo &token_info, absl::string_view base,
+                       std::string *out);
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_TEXT_TOKEN_INFO_JSON_H_
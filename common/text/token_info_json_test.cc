@@ -15,6 +15,7 @@
 #include "common/text/token_info_json.h"
 
 #include <ostream>
+#include <string>
 
 #include "absl/strings/string_view.h"
 #include "common/text/constants.h"
@@ -84,5 +85,14 @@ TEST(TokenInfoToJsonTest, ToJsonWithTokenEnumTranslator) {
   })"));
 }
 
+TEST(TokenInfoToJsonTest, AppendCompactJson) {
+  constexpr absl::string_view base("basement cat");
+  std::string out("x");
+  AppendCompactJson(TokenInfo(7, base.substr(9, 3)), base, &out);
+  EXPECT_EQ(out, "x[7,9,12]");
+  EXPECT_EQ(nlohmann::json::parse(out.substr(1)),
+            nlohmann::json::parse("[7, 9, 12]"));
+}
+
 }  // namespace
 }  // namespace verible
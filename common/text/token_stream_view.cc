@@ -44,11 +44,25 @@ void FilterTokenStreamView(const TokenFilterPredicate &keep,
   }
 }
 
+void FilterTokenStreamView(const TokenFilterPredicate &keep,
+                           const TokenSequence &src, TokenStreamView *dest) {
+  dest->clear();
+  dest->reserve(src.size() / 2);  // Estimate size of filtered result.
+  for (auto iter = src.begin(); iter != src.end(); ++iter) {
+    if (keep(*iter)) {
+      dest->push_back(iter);
+    }
+  }
+}
+
 void FilterTokenStreamViewInPlace(const TokenFilterPredicate &keep,
                                   TokenStreamView *view) {
-  TokenStreamView temp;
-  FilterTokenStreamView(keep, *view, &temp);
-  view->swap(temp);  // old stream view deleted at end-of-scope
+  // Compacts the kept iterators to the front, preserving their order.
+  view->erase(std::remove_if(view->begin(), view->end(),
+                             [&keep](TokenSequence::const_iterator iter) {
+                               return !keep(*iter);
+                             }),
+              view->end());
 }
 
 static bool TokenLocationLess(const TokenSequence::const_iterator &token_iter,
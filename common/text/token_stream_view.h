@@ -55,7 +55,14 @@ void InitTokenStreamView(const TokenSequence &, TokenStreamView *);
 void FilterTokenStreamView(const TokenFilterPredicate &keep,
                            const TokenStreamView &src, TokenStreamView *dest);
 
-// Remove tokens from a TokenStreamView according to a predicate.
+// Populates a TokenStreamView with the iterators of the tokens of a
+// TokenSequence that satisfy 'keep'.  This is InitTokenStreamView() followed
+// by FilterTokenStreamViewInPlace(), in one pass.
+void FilterTokenStreamView(const TokenFilterPredicate &keep,
+                           const TokenSequence &src, TokenStreamView *dest);
+
+// Remove tokens from a TokenStreamView according to a predicate, without
+// reallocating it.
 void FilterTokenStreamViewInPlace(const TokenFilterPredicate &keep,
                                   TokenStreamView *);
 
@@ -59,13 +59,26 @@ TEST_F(TokenStreamViewTest, Filter) {
   EXPECT_EQ(0, view2.back()->token_enum());
 }
 
+TEST_F(TokenStreamViewTest, FilterSequence) {
+  TokenStreamView expected, view;
+  InitTokenStreamView(tokens_, &expected);
+  FilterTokenStreamViewInPlace(KeepEvenTokens, &expected);
+  FilterTokenStreamView(KeepEvenTokens, tokens_, &view);
+  EXPECT_EQ(view, expected);
+}
+
 TEST_F(TokenStreamViewTest, FilterInPlace) {
   TokenStreamView view;
   InitTokenStreamView(tokens_, &view);
+  const auto *const storage = view.data();
   FilterTokenStreamViewInPlace(KeepEvenTokens, &view);
   EXPECT_EQ(6, view.size());
   EXPECT_EQ(2, view.front()->token_enum());
   EXPECT_EQ(0, view.back()->token_enum());
+  for (size_t i = 1; i < view.size(); ++i) {
+    EXPECT_LT(view[i - 1], view[i]);  // order is preserved
+  }
+  EXPECT_EQ(view.data(), storage);  // not reallocated
 }
 
 // Helper class for testing Token range methods.
@@ -14,15 +14,57 @@
 
 #include "common/text/tree_context_visitor.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 #include "common/strings/display_utils.h"
+#include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/visitors.h"
+#include "common/util/casts.h"
 #include "common/util/logging.h"
 
 namespace verible {
 
+void WalkTree(const Symbol &root, SymbolVisitor *visitor,
+              SyntaxTreeContext *context) {
+  // The entered nodes, with the rank of their next child to walk.
+  struct Frame {
+    const SyntaxTreeNode *node;
+    size_t next_child;
+  };
+  std::vector<Frame> frames;
+  const auto enter = [&](const Symbol &symbol) {
+    if (symbol.Kind() == SymbolKind::kLeaf) {
+      visitor->Visit(down_cast<const SyntaxTreeLeaf &>(symbol));
+      return;
+    }
+    const auto &node = down_cast<const SyntaxTreeNode &>(symbol);
+    if (!visitor->EnterNode(node)) return;
+    if (context != nullptr) context->Push(&node);
+    frames.push_back({&node, 0});
+  };
+
+  enter(root);
+  while (!frames.empty()) {
+    Frame &frame = frames.back();
+    if (frame.next_child < frame.node->size()) {
+      const size_t rank = frame.next_child++;
+      const Symbol *child = (*frame.node)[rank].get();
+      visitor->EnterChild(rank, child);
+      if (child != nullptr) enter(*child);  // May invalidate 'frame'.
+      continue;
+    }
+    const SyntaxTreeNode &node = *frame.node;
+    frames.pop_back();
+    if (context != nullptr) context->Pop();
+    visitor->LeaveNode(node);
+  }
+}
+
 void TreeContextVisitor::Visit(const SyntaxTreeNode &node) {
   const SyntaxTreeContext::AutoPop p(&current_context_, &node);
   for (const auto &child : node.children()) {
@@ -63,24 +105,19 @@ SyntaxTreePath NextSiblingPath(const SyntaxTreePath &path) {
   return next;
 }
 
-static int CompareSyntaxTreePath(const SyntaxTreePath &a,
-                                 const SyntaxTreePath &b, int index) {
-  // a[index] ? b[index]
-  if (int(a.size()) > index && int(b.size()) > index) {
+int CompareSyntaxTreePath(const SyntaxTreePath &a, const SyntaxTreePath &b) {
+  const size_t common_size = std::min(a.size(), b.size());
+  for (size_t index = 0; index < common_size; ++index) {
+    // a[index] ? b[index]
     if (a[index] < b[index]) return -1;
     if (a[index] > b[index]) return 1;
-    if (a[index] == b[index]) return CompareSyntaxTreePath(a, b, index + 1);
   }
   // a[index] ? (out-of-bounds)
-  if (int(a.size()) > index) return (a[index] < 0) ? -1 : 1;
+  if (a.size() > common_size) return (a[common_size] < 0) ? -1 : 1;
   // (out-of-bounds) ? b[index]
-  if (int(b.size()) > index) return (0 > b[index]) ? 1 : -1;
+  if (b.size() > common_size) return (0 > b[common_size]) ? 1 : -1;
   // (out-of-bounds) == (out-of-bounds)
   return 0;
 }
 
-int CompareSyntaxTreePath(const SyntaxTreePath &a, const SyntaxTreePath &b) {
-  return CompareSyntaxTreePath(a, b, 0);
-}
-
 }  // namespace verible
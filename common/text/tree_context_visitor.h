@@ -15,20 +15,35 @@
 #ifndef VERIBLE_COMMON_TEXT_TREE_CONTEXT_VISITOR_H_
 #define VERIBLE_COMMON_TEXT_TREE_CONTEXT_VISITOR_H_
 
+#include <utility>
 #include <vector>
 
 #include "common/strings/display_utils.h"
+#include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
 #include "common/text/visitors.h"
 
 namespace verible {
 
+// Visits 'root' and all its descendants in pre-order like root.Accept(visitor),
+// but with an explicit stack, so that the depth of the tree is only limited by
+// memory.  Calls the visitor's EnterNode(), EnterChild() and LeaveNode() hooks
+// for nodes, and Visit() for leaves.  If 'context' is not nullptr, the
+// ancestors of each visited symbol are pushed onto it, as TreeContextVisitor
+// does: nodes are pushed after EnterNode() and popped before LeaveNode().
+void WalkTree(const Symbol &root, SymbolVisitor *visitor,
+              SyntaxTreeContext *context = nullptr);
+
 // This visitor traverses a tree and maintains a stack of context
 // that points to all ancestors at any given node.
 class TreeContextVisitor : public SymbolVisitor {
  public:
   TreeContextVisitor() = default;
 
+  // Walks 'root' with WalkTree(), keeping Context() up to date like Visit()
+  // does.  Only for subclasses that implement the hooks of WalkTree().
+  void Walk(const Symbol &root) { WalkTree(root, this, &current_context_); }
+
  protected:
   void Visit(const SyntaxTreeLeaf &leaf) override {}  // not yet final
   void Visit(const SyntaxTreeNode &node) override;    // not yet final
@@ -65,8 +80,9 @@ class SyntaxTreePath : public std::vector<int> {
  public:
   using std::vector<int>::vector;  // Import base class constructors
 
+  // Paths compare equal exactly when their elements do.
   bool operator==(const SyntaxTreePath &rhs) const {
-    return CompareSyntaxTreePath(*this, rhs) == 0;
+    return static_cast<const std::vector<int> &>(*this) == rhs;
   }
   bool operator<(const SyntaxTreePath &rhs) const {
     return CompareSyntaxTreePath(*this, rhs) < 0;
@@ -77,6 +93,13 @@ class SyntaxTreePath : public std::vector<int> {
   bool operator!=(const SyntaxTreePath &rhs) const { return !(*this == rhs); }
   bool operator<=(const SyntaxTreePath &rhs) const { return !(*this > rhs); }
   bool operator>=(const SyntaxTreePath &rhs) const { return !(*this < rhs); }
+
+  // Paths can be keys of hashed containers, e.g. absl::flat_hash_map.
+  template <typename H>
+  friend H AbslHashValue(H h, const SyntaxTreePath &path) {
+    return H::combine(std::move(h),
+                      static_cast<const std::vector<int> &>(path));
+  }
 };
 
 // This visitor traverses a tree and maintains a stack of offsets
@@ -18,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
@@ -145,6 +146,89 @@ TEST(TreeContextVisitorTest, FullTree) {
   TestContextRecorders(tree, expect);
 }
 
+// Records the same history as ContextRecorder, through the hooks of the
+// non-recursive walk, along with the tags of the nodes left.
+class WalkRecorder : public TreeContextVisitor {
+ public:
+  void Visit(const SyntaxTreeLeaf &leaf) final {
+    context_history_.push_back(ContextToTags(Context()));
+  }
+
+  bool EnterNode(const SyntaxTreeNode &node) final {
+    context_history_.push_back(ContextToTags(Context()));
+    return node.Tag().tag != skipped_tag_;
+  }
+
+  void EnterChild(int rank, const Symbol *child) final {
+    if (child == nullptr) ++null_children_;
+  }
+
+  void LeaveNode(const SyntaxTreeNode &node) final {
+    left_.push_back(node.Tag().tag);
+  }
+
+  std::vector<std::vector<int>> context_history_;
+  std::vector<int> left_;
+  int null_children_ = 0;
+  int skipped_tag_ = -1;
+};
+
+TEST(WalkTreeTest, SameContextsAsVisit) {
+  auto tree = TNode(3,                             //
+                    TNode(4,                       //
+                          XLeaf(99),               //
+                          TNode(1,                 //
+                                XLeaf(99),         //
+                                XLeaf(0))),        //
+                    XLeaf(5),                      //
+                    TNode(6,                       //
+                          TNode(2,                 //
+                                TNode(7,           //
+                                      XLeaf(99)),  //
+                                TNode(8))));
+  const std::vector<std::vector<int>> expect = {
+      {},  {3}, {3, 4}, {3, 4},    {3, 4, 1},    {3, 4, 1},
+      {3}, {3}, {3, 6}, {3, 6, 2}, {3, 6, 2, 7}, {3, 6, 2},
+  };
+  WalkRecorder r;
+  r.Walk(*tree);
+  EXPECT_THAT(r.context_history_, ElementsAreArray(expect));
+  EXPECT_THAT(r.left_, ElementsAreArray({1, 4, 7, 8, 2, 6, 3}));
+}
+
+TEST(WalkTreeTest, SkipsChildrenAndSeesNullptrs) {
+  auto tree = TNode(3, nullptr, TNode(4, XLeaf(5)), TNode(6, nullptr));
+  WalkRecorder r;
+  r.skipped_tag_ = 4;
+  r.Walk(*tree);
+  EXPECT_THAT(r.context_history_,
+              ElementsAreArray(std::vector<std::vector<int>>{{}, {3}, {3}}));
+  EXPECT_THAT(r.left_, ElementsAreArray({6, 3}));
+  EXPECT_EQ(r.null_children_, 2);
+}
+
+TEST(WalkTreeTest, DeepTree) {
+  // Records the contexts' sizes only, which keeps this test linear.
+  class DepthRecorder : public TreeContextVisitor {
+   public:
+    void Visit(const SyntaxTreeLeaf &leaf) final {
+      leaf_depth_ = Context().size();
+    }
+    void LeaveNode(const SyntaxTreeNode &node) final { ++left_; }
+
+    size_t leaf_depth_ = 0;
+    size_t left_ = 0;
+  };
+
+  constexpr size_t kDepth = 1000000;
+  SymbolPtr tree = XLeaf(1);
+  for (size_t i = 0; i < kDepth; ++i) tree = TNode(2, std::move(tree));
+  DepthRecorder r;
+  r.Walk(*tree);
+  EXPECT_EQ(r.leaf_depth_, kDepth);
+  EXPECT_EQ(r.left_, kDepth);
+}
+
 // Test class demonstrating visitation and path tracking
 class PathRecorder : public TreeContextPathVisitor {
  public:
@@ -423,5 +507,16 @@ TEST(SyntaxTreePathTest, LessThanAndGreaterThan) {
   }
 }
 
+TEST(SyntaxTreePathTest, Hash) {
+  const absl::flat_hash_set<SyntaxTreePath> paths = {
+      SyntaxTreePath{}, SyntaxTreePath{-1}, SyntaxTreePath{0},
+      SyntaxTreePath{0, 0}, SyntaxTreePath{1, 0, 2}};
+  EXPECT_EQ(paths.size(), 5);
+  EXPECT_TRUE(paths.contains(SyntaxTreePath{0, 0}));
+  EXPECT_TRUE(paths.contains(SyntaxTreePath{-1}));
+  EXPECT_FALSE(paths.contains(SyntaxTreePath{0, 0, 0}));
+  EXPECT_FALSE(paths.contains(SyntaxTreePath{1, 0}));
+}
+
 }  // namespace
 }  // namespace verible
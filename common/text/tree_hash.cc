@@ -0,0 +1,61 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/tree_hash.h"
+
+#include <cstddef>
+
+#include "absl/hash/hash.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/token_info.h"
+#include "common/util/casts.h"
+
+namespace verible {
+
+// Kinds of hashed items, which keep e.g. a leaf and a node with the same enum
+// apart.
+enum class HashedKind { kNull, kLeaf, kLeafEnumOnly, kNode };
+
+static size_t HashSymbol(const Symbol *symbol, const TreeHashOptions &options,
+                         const SubtreeHashReceiver *receiver) {
+  if (symbol == nullptr) return absl::HashOf(HashedKind::kNull);
+  if (symbol->Kind() == SymbolKind::kLeaf) {
+    const TokenInfo &token = down_cast<const SyntaxTreeLeaf *>(symbol)->get();
+    if (options.ignore_text && options.ignore_text(token)) {
+      return absl::HashOf(HashedKind::kLeafEnumOnly, token.token_enum());
+    }
+    return absl::HashOf(HashedKind::kLeaf, token.token_enum(), token.text());
+  }
+  const auto &node = *down_cast<const SyntaxTreeNode *>(symbol);
+  size_t hash =
+      absl::HashOf(HashedKind::kNode, node.Tag().tag, node.size());
+  for (const auto &child : node.children()) {
+    hash = absl::HashOf(hash, HashSymbol(child.get(), options, receiver));
+  }
+  if (receiver != nullptr) (*receiver)(node, hash);
+  return hash;
+}
+
+size_t HashTree(const Symbol *root, const TreeHashOptions &options) {
+  return HashSymbol(root, options, nullptr);
+}
+
+size_t HashSubtrees(const Symbol *root, const TreeHashOptions &options,
+                    const SubtreeHashReceiver &receiver) {
+  return HashSymbol(root, options, &receiver);
+}
+
+}  // namespace verible
@@ -0,0 +1,53 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Structural hashing of SyntaxTrees, to find equal subtrees without
+// comparing every pair of them.
+
+#ifndef VERIBLE_COMMON_TEXT_TREE_HASH_H_
+#define VERIBLE_COMMON_TEXT_TREE_HASH_H_
+
+#include <cstddef>
+#include <functional>
+
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/token_info.h"
+
+namespace verible {
+
+struct TreeHashOptions {
+  // If set, tokens for which this returns true are hashed by their enum only,
+  // e.g. to hash trees that only differ in identifiers the same.
+  std::function<bool(const TokenInfo &)> ignore_text;
+};
+
+// Returns a hash of the node tags, token enums and token texts of the tree at
+// 'root' (which may be nullptr).  Trees that are EqualTreesByEnumString() have
+// equal hashes.
+size_t HashTree(const Symbol *root, const TreeHashOptions &options = {});
+
+// Receives the HashTree() of a node.
+using SubtreeHashReceiver =
+    std::function<void(const SyntaxTreeNode &node, size_t hash)>;
+
+// Computes the HashTree() of every node under 'root' in one pass, and passes
+// each to 'receiver', children before their parents.  Returns the hash of
+// 'root'.
+size_t HashSubtrees(const Symbol *root, const TreeHashOptions &options,
+                    const SubtreeHashReceiver &receiver);
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_TREE_HASH_H_
@@ -0,0 +1,89 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");  // you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/text/tree_hash.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/token_info.h"
+#include "common/text/tree_builder_test_util.h"
+#include "common/text/tree_compare.h"
+#include "common/util/casts.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(HashTreeTest, EqualTreesHashEqual) {
+  SymbolPtr tree1 = TNode(1, Leaf(1, "a"), nullptr, TNode(2, Leaf(2, "b")));
+  SymbolPtr tree2 = TNode(1, Leaf(1, "a"), nullptr, TNode(2, Leaf(2, "b")));
+  ASSERT_TRUE(EqualTreesByEnumString(tree1.get(), tree2.get()));
+  EXPECT_EQ(HashTree(tree1.get()), HashTree(tree2.get()));
+  EXPECT_EQ(HashTree(nullptr), HashTree(nullptr));
+}
+
+TEST(HashTreeTest, DifferentTreesHashDifferent) {
+  SymbolPtr tree = TNode(1, Leaf(1, "a"), Leaf(2, "b"));
+  const std::vector<SymbolPtr> others = [] {
+    std::vector<SymbolPtr> trees;
+    trees.push_back(TNode(3, Leaf(1, "a"), Leaf(2, "b")));  // tag
+    trees.push_back(TNode(1, Leaf(1, "a"), Leaf(2, "c")));  // text
+    trees.push_back(TNode(1, Leaf(1, "a"), Leaf(4, "b")));  // enum
+    trees.push_back(TNode(1, Leaf(1, "a")));  // child count
+    trees.push_back(TNode(1, Leaf(1, "a"), nullptr));  // null child
+    trees.push_back(TNode(1, Leaf(2, "b"), Leaf(1, "a")));  // order
+    trees.push_back(TNode(1, TNode(1, Leaf(1, "a"), Leaf(2, "b"))));  // depth
+    return trees;
+  }();
+  for (const auto &other : others) {
+    EXPECT_NE(HashTree(tree.get()), HashTree(other.get()));
+  }
+}
+
+TEST(HashTreeTest, IgnoreText) {
+  SymbolPtr tree1 = TNode(1, Leaf(1, "foo"), Leaf(2, "+"));
+  SymbolPtr tree2 = TNode(1, Leaf(1, "bar"), Leaf(2, "+"));
+  SymbolPtr tree3 = TNode(1, Leaf(1, "bar"), Leaf(2, "-"));
+  TreeHashOptions options;
+  options.ignore_text = [](const TokenInfo &token) {
+    return token.token_enum() == 1;
+  };
+  EXPECT_NE(HashTree(tree1.get()), HashTree(tree2.get()));
+  EXPECT_EQ(HashTree(tree1.get(), options), HashTree(tree2.get(), options));
+  EXPECT_NE(HashTree(tree2.get(), options), HashTree(tree3.get(), options));
+}
+
+TEST(HashSubtreesTest, ReceivesEveryNodeBottomUp) {
+  SymbolPtr tree = TNode(1, TNode(2, Leaf(1, "a")), Leaf(2, "b"),
+                         TNode(2, Leaf(1, "a")));
+  std::vector<const SyntaxTreeNode *> nodes;
+  std::vector<size_t> hashes;
+  const size_t root_hash = HashSubtrees(
+      tree.get(), {}, [&](const SyntaxTreeNode &node, size_t hash) {
+        nodes.push_back(&node);
+        hashes.push_back(hash);
+      });
+  const auto &root = *down_cast<const SyntaxTreeNode *>(tree.get());
+  ASSERT_EQ(nodes.size(), 3);
+  EXPECT_EQ(nodes[0], root[0].get());
+  EXPECT_EQ(nodes[1], root[2].get());
+  EXPECT_EQ(nodes[2], &root);
+  EXPECT_EQ(hashes[0], hashes[1]);  // equal subtrees
+  EXPECT_EQ(hashes[2], root_hash);
+  EXPECT_EQ(root_hash, HashTree(tree.get()));
+}
+
+}  // namespace
+}  // namespace verible
@@ -28,6 +28,7 @@
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/token_info.h"
+#include "common/text/tree_context_visitor.h"
 #include "common/text/visitors.h"
 #include "common/util/casts.h"
 #include "common/util/iterator_adaptors.h"
@@ -413,6 +414,18 @@ void MutateLeaves(ConcreteSyntaxTree *tree, const LeafMutator &mutator) {
   }
 }
 
+SymbolPtr CopySyntaxTree(const Symbol &symbol) {
+  if (symbol.Kind() == SymbolKind::kLeaf) {
+    return std::make_unique<SyntaxTreeLeaf>(SymbolCastToLeaf(symbol).get());
+  }
+  const auto &node = SymbolCastToNode(symbol);
+  auto copy = std::make_unique<SyntaxTreeNode>(node.Tag().tag);
+  for (const auto &child : node.children()) {
+    copy->AppendChild(child == nullptr ? nullptr : CopySyntaxTree(*child));
+  }
+  return copy;
+}
+
 //
 // Implementation of printing functions
 //
@@ -432,27 +445,32 @@ void PrettyPrinter::Visit(const SyntaxTreeLeaf &leaf) {
 }
 
 void RawSymbolPrinter::Visit(const SyntaxTreeNode &node) {
+  const ValueSaver<int> rank_saver(&child_rank_, child_rank_);
+  WalkTree(node, this);
+}
+
+bool RawSymbolPrinter::EnterNode(const SyntaxTreeNode &node) {
   std::string tag_info;
   const int tag = node.Tag().tag;
   if (tag != 0) tag_info = absl::StrCat("(tag: ", tag, ") ");
 
   auto_indent() << "Node @" << child_rank_ << ' ' << tag_info << "{"
                 << std::endl;
+  indent_ += 2;
+  return true;
+}
 
-  {
-    const ValueSaver<int> value_saver(&indent_, indent_ + 2);
-    const ValueSaver<int> rank_saver(&child_rank_, 0);
-    for (const auto &child : node.children()) {
-      if (child) {
-        child->Accept(this);
-      } else if (print_null_nodes_) {
-        auto_indent() << "NULL @" << child_rank_ << std::endl;
-      }
-      // Note that nullptrs will appear as gaps in the child rank sequence.
-      // nullptr nodes in tail position are not shown.
-      ++child_rank_;
-    }
+void RawSymbolPrinter::EnterChild(int rank, const Symbol *child) {
+  // Note that nullptrs will appear as gaps in the child rank sequence.
+  // nullptr nodes in tail position are not shown.
+  child_rank_ = rank;
+  if (child == nullptr && print_null_nodes_) {
+    auto_indent() << "NULL @" << child_rank_ << std::endl;
   }
+}
+
+void RawSymbolPrinter::LeaveNode(const SyntaxTreeNode &node) {
+  indent_ -= 2;
   auto_indent() << "}" << std::endl;
 }
 
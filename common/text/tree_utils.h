@@ -294,6 +294,10 @@ using LeafMutator = std::function<void(TokenInfo *)>;
 // tree may not be null.
 void MutateLeaves(ConcreteSyntaxTree *tree, const LeafMutator &mutator);
 
+// Returns a deep copy of the tree rooted at "symbol".  Leaf tokens are copied
+// verbatim, so they continue to point into the same text as the original.
+SymbolPtr CopySyntaxTree(const Symbol &symbol);
+
 //
 // Set of tree printing functions
 //
@@ -308,7 +312,12 @@ class RawSymbolPrinter : public SymbolVisitor {
       : stream_(stream), print_null_nodes_(print_null_nodes) {}
 
   void Visit(const SyntaxTreeLeaf &) override;
-  void Visit(const SyntaxTreeNode &) override;
+  // Prints the subtree with WalkTree(), so that deep trees don't recurse.
+  void Visit(const SyntaxTreeNode &) final;
+
+  bool EnterNode(const SyntaxTreeNode &) override;
+  void EnterChild(int rank, const Symbol *child) override;
+  void LeaveNode(const SyntaxTreeNode &) override;
 
  protected:
   // Prints start of line with correct indentation.
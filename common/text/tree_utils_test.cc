@@ -1003,6 +1003,32 @@ TEST(MutateLeavesTest, NodeAndLeaves) {
   EXPECT_TRUE(EqualTreesByEnum(tree.get(), expect.get()));
 }
 
+// CopySyntaxTree tests
+
+TEST(CopySyntaxTreeTest, OneLeaf) {
+  SymbolPtr tree = XLeaf(3);
+  SymbolPtr copy = CopySyntaxTree(*tree);
+  EXPECT_NE(copy.get(), tree.get());
+  EXPECT_TRUE(EqualTreesByEnum(tree.get(), copy.get()));
+}
+
+TEST(CopySyntaxTreeTest, NodesLeavesAndNulls) {
+  SymbolPtr tree =
+      TNode(0, nullptr, TNode(8, XLeaf(0), TNode(4, XLeaf(1), nullptr)));
+  SymbolPtr copy = CopySyntaxTree(*tree);
+  EXPECT_TRUE(EqualTreesByEnum(tree.get(), copy.get()));
+  // The copy is independent of the original.
+  MutateLeaves(&copy, SetLeafEnum);
+  EXPECT_FALSE(EqualTreesByEnum(tree.get(), copy.get()));
+}
+
+TEST(CopySyntaxTreeTest, LeavesShareText) {
+  constexpr absl::string_view text("foo");
+  SymbolPtr tree = Node(Leaf(1, text));
+  SymbolPtr copy = CopySyntaxTree(*tree);
+  EXPECT_EQ(GetLeftmostLeaf(*copy)->get().text().data(), text.data());
+}
+
 // PruneSyntaxTreeAfterOffset tests
 
 // Test that a leafless root node is not pruned.
@@ -20,6 +20,7 @@
 namespace verible {
 
 // forward declaration to allow pointers in function prototypes
+class Symbol;
 class SyntaxTreeLeaf;
 class SyntaxTreeNode;
 
@@ -53,6 +54,16 @@ class SymbolVisitor {
   virtual ~SymbolVisitor() = default;
   virtual void Visit(const SyntaxTreeLeaf &leaf) = 0;
   virtual void Visit(const SyntaxTreeNode &node) = 0;
+
+  // Hooks of WalkTree() (see tree_context_visitor.h), which traverses trees of
+  // any depth with an explicit stack instead of recursion.  For each node, it
+  // calls EnterNode() instead of Visit().  Unless that returns false, it then
+  // calls EnterChild() with each child (nullptrs included) and its rank
+  // before walking that child, and LeaveNode() after the last one.  Leaves
+  // are still passed to Visit().
+  virtual bool EnterNode(const SyntaxTreeNode &node) { return true; }
+  virtual void EnterChild(int rank, const Symbol *child) {}
+  virtual void LeaveNode(const SyntaxTreeNode &node) {}
 };
 
 // MutableTreeVisitorRecursive is the non-const version of TreeVisitorRecursive.
@@ -17,6 +17,7 @@
 #include <string>
 #include <utility>
 
+#include "absl/flags/flag.h"
 #include "absl/flags/usage.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -29,6 +30,9 @@
 #include "common/util/subcommand.h"
 #include "common/util/user_interaction.h"
 
+ABSL_FLAG(int, jobs, 1,
+          "Number of files to patch in parallel with the 'apply' command.");
+
 using verible::SubcommandArgsRange;
 using verible::SubcommandEntry;
 
@@ -75,6 +79,22 @@ static absl::Status ApplyPick(const SubcommandArgsRange &args,
   return patch_set.PickApplyInPlace(ins, outs);
 }
 
+static absl::Status Apply(const SubcommandArgsRange &args, std::istream &ins,
+                          std::ostream &outs, std::ostream &errs) {
+  if (args.empty()) {
+    return absl::InvalidArgumentError(
+        "Missing patchfile argument.  Use '-' for stdin.");
+  }
+  const absl::string_view patchfile = args[0];
+  auto patch_contents_or = verible::file::GetContentAsString(patchfile);
+  if (!patch_contents_or.ok()) return patch_contents_or.status();
+
+  verible::PatchSet patch_set;
+  RETURN_IF_ERROR(patch_set.Parse(*patch_contents_or));
+
+  return patch_set.ApplyInPlace(absl::GetFlag(FLAGS_jobs));
+}
+
 static absl::Status StdinTest(const SubcommandArgsRange &args,
                               std::istream &ins, std::ostream &outs,
                               std::ostream &errs) {
@@ -151,6 +171,18 @@ equivalents like {p4,git,hg,cvs,svn} diff.
 Effect:
 Modifies patched files in-place, following user selections on which patch
 hunks to apply.
+)"}},
+
+    {"apply",  //
+     {&Apply,  //
+      R"(apply patchfile
+Input:
+'patchfile' is a unified-diff file from 'diff -u' or other version-controlled
+equivalents like {p4,git,hg,cvs,svn} diff.  Use '-' to read from stdin.
+
+Effect:
+Modifies patched files in-place, applying all hunks without prompting.
+Each file is replaced atomically.  Use --jobs to patch files in parallel.
 )"}},
 
     {"stdin-test",  //
@@ -499,5 +499,69 @@ diff -u --strip-trailing-cr "$MY_EXPECT_FILE" "$MY_INPUT_FILE".orig || {
 cp "$MY_INPUT_FILE".bkp "$MY_INPUT_FILE".orig
 chmod u+w "$MY_INPUT_FILE".orig
 
+################################################################################
+# Test 'apply' on a patch with two files.
+
+cat > "$MY_INPUT_FILE".second <<EOF
+one
+two
+three
+EOF
+
+cat > "$MY_INPUT_FILE".patch <<EOF
+--- $MY_INPUT_FILE.orig
++++ $MY_INPUT_FILE.formatted
+@@ -1,3 +1,2 @@
+ a
+-b
+ c
+--- $MY_INPUT_FILE.second
++++ $MY_INPUT_FILE.second-formatted
+@@ -1,3 +1,4 @@
+ one
++one-and-a-half
+ two
+ three
+EOF
+
+"$patch_tool" --jobs=2 apply "$MY_INPUT_FILE".patch > /dev/null
+
+status="$?"
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+a
+c
+d
+e
+f
+g
+h
+EOF
+
+diff -u --strip-trailing-cr "$MY_EXPECT_FILE" "$MY_INPUT_FILE".orig || {
+  echo "Expected these files to match, but got the above diff."
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+one
+one-and-a-half
+two
+three
+EOF
+
+diff -u --strip-trailing-cr "$MY_EXPECT_FILE" "$MY_INPUT_FILE".second || {
+  echo "Expected these files to match, but got the above diff."
+  exit 1
+}
+
+# Restore the original file for the next test.
+cp "$MY_INPUT_FILE".bkp "$MY_INPUT_FILE".orig
+chmod u+w "$MY_INPUT_FILE".orig
+
 ################################################################################
 echo "PASS"
@@ -15,6 +15,7 @@
 #include "common/util/file_util.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
@@ -22,6 +23,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -252,6 +254,38 @@ absl::Status SetContents(absl::string_view filename,
   return absl::OkStatus();
 }
 
+absl::Status SetContentsAtomically(absl::string_view filename,
+                                   absl::string_view content) {
+  static std::atomic<unsigned> temp_file_count{0};
+  std::error_code err;
+  fs::path target(std::string{filename});
+  if (fs::is_symlink(target, err)) {
+    target = fs::canonical(target, err);
+    if (err) return CreateErrorStatusFromErr(filename, err, "can't resolve.");
+  }
+  // Unique among threads and processes that write the same directory.
+  const std::string temp_file = absl::StrCat(
+      target.string(), ".", std::random_device()(), "-", temp_file_count++,
+      ".tmp");
+  if (auto status = SetContents(temp_file, content); !status.ok()) {
+    fs::remove(temp_file, err);
+    return status;
+  }
+  const fs::file_status target_status = fs::status(target, err);
+  if (!err) fs::permissions(temp_file, target_status.permissions(), err);
+  if (!err) fs::rename(temp_file, target, err);
+  if (err) {
+    std::error_code ignored;
+    fs::remove(temp_file, ignored);
+    if (err == std::errc::no_such_file_or_directory) {
+      // There was no file to replace yet.
+      return SetContents(filename, content);
+    }
+    return CreateErrorStatusFromErr(filename, err, "can't replace.");
+  }
+  return absl::OkStatus();
+}
+
 std::string JoinPath(absl::string_view base, absl::string_view name) {
   fs::path p = fs::path(std::string(base)) / fs::path(std::string(name));
   return p.lexically_normal().string();
@@ -86,6 +86,13 @@ absl::StatusOr<std::unique_ptr<MemBlock>> GetContentAsMemBlock(
 // Create file "filename" and store given content in it.
 absl::Status SetContents(absl::string_view filename, absl::string_view content);
 
+// Replace the content of file "filename" by writing a temporary file next to
+// it and renaming that over it, so that readers see either the old or the new
+// content, never a partially written file.  If "filename" exists, its
+// permissions are kept.  A symbolic link is followed, and its target replaced.
+absl::Status SetContentsAtomically(absl::string_view filename,
+                                   absl::string_view content);
+
 // Join directory + filename and lightly canonicalize.
 // The canonicalization step unifies ./ and ../ path elements lexically
 // without looking at the underlying file-system.
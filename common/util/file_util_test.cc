@@ -152,6 +152,43 @@ TEST(FileUtil, CreateDir) {
   EXPECT_EQ(test_content, *read_back_content_or);
 }
 
+TEST(FileUtil, SetContentsAtomically) {
+  const std::string test_dir =
+      file::JoinPath(testing::TempDir(), "atomic_write_dir");
+  ASSERT_OK(file::CreateDir(test_dir));
+  ScopedTestFile test_file(test_dir, "old content");
+#ifndef _WIN32
+  ASSERT_EQ(chmod(test_file.filename().data(), 0640), 0);
+#endif
+
+  EXPECT_OK(file::SetContentsAtomically(test_file.filename(), "new content"));
+  absl::StatusOr<std::string> read_back_content_or =
+      file::GetContentAsString(test_file.filename());
+  ASSERT_OK(read_back_content_or.status());
+  EXPECT_EQ(*read_back_content_or, "new content");
+
+#ifndef _WIN32
+  struct stat file_stat;
+  ASSERT_EQ(stat(test_file.filename().data(), &file_stat), 0);
+  EXPECT_EQ(file_stat.st_mode & 0777, 0640);
+#endif
+
+  // The temporary file has been renamed, it is not left behind.
+  auto dir_or = file::ListDir(test_dir);
+  ASSERT_OK(dir_or.status());
+  EXPECT_EQ(dir_or->files, std::vector<std::string>{test_file.filename()});
+}
+
+TEST(FileUtil, SetContentsAtomicallyCreatesFile) {
+  const std::string test_file =
+      file::JoinPath(testing::TempDir(), "atomic_write_new_file");
+  EXPECT_OK(file::SetContentsAtomically(test_file, "content"));
+  absl::StatusOr<std::string> read_back_content_or =
+      file::GetContentAsString(test_file);
+  ASSERT_OK(read_back_content_or.status());
+  EXPECT_EQ(*read_back_content_or, "content");
+}
+
 TEST(FileUtil, StatusErrorReporting) {
   absl::StatusOr<std::string> content_or;
 
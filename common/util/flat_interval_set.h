@@ -0,0 +1,170 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_FLAT_INTERVAL_SET_H_
+#define VERIBLE_COMMON_UTIL_FLAT_INTERVAL_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iosfwd>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "common/util/interval.h"
+#include "common/util/interval_set.h"
+#include "common/util/logging.h"
+
+namespace verible {
+
+// FlatIntervalSet is an immutable alternative to IntervalSet for sets that are
+// built once and then queried many times.  The disjoint, non-abutting [min,
+// max) intervals are kept sorted in a single vector.  It is built from all
+// intervals at once, sorting and merging them in one pass, instead of fusing
+// intervals one Add() at a time.
+template <typename T>
+class FlatIntervalSet {
+  using impl_type = std::vector<Interval<T>>;
+
+ public:
+  using value_type = Interval<T>;
+  using const_iterator = typename impl_type::const_iterator;
+  using size_type = typename impl_type::size_type;
+
+  FlatIntervalSet() = default;
+
+  // Takes intervals in any order; they may overlap, abut, or be empty.
+  explicit FlatIntervalSet(impl_type intervals)
+      : intervals_(std::move(intervals)) {
+    SortAndMerge();
+  }
+
+  FlatIntervalSet(std::initializer_list<Interval<T>> intervals)
+      : FlatIntervalSet(impl_type(intervals)) {}
+
+  // Copies the intervals of an IntervalSet, which are already disjoint.
+  explicit FlatIntervalSet(const IntervalSet<T> &iset) {
+    intervals_.reserve(iset.size());
+    for (const auto &interval : iset) {
+      intervals_.emplace_back(interval.first, interval.second);
+    }
+  }
+
+  const_iterator begin() const { return intervals_.begin(); }
+
+  const_iterator end() const { return intervals_.end(); }
+
+  // Returns the number of disjoint intervals that compose this set.
+  size_type size() const { return intervals_.size(); }
+
+  // Returns true if the set contains no intervals/values.
+  bool empty() const { return intervals_.empty(); }
+
+  bool operator==(const FlatIntervalSet<T> &other) const {
+    return intervals_ == other.intervals_;
+  }
+
+  bool operator!=(const FlatIntervalSet<T> &other) const {
+    return !(*this == other);
+  }
+
+  // Returns true if value is a member of an interval in the set.
+  // The binary search has a fixed number of steps for a given size, and
+  // each step is a conditional move rather than a branch.
+  bool Contains(const T &value) const {
+    if (intervals_.empty()) return false;
+    const Interval<T> *base = intervals_.data();
+    size_type length = intervals_.size();
+    // Find the last interval that starts at or before 'value'.
+    while (length > 1) {
+      const size_type half = length / 2;
+      base = (base[half].min <= value) ? base + half : base;
+      length -= half;
+    }
+    return base->contains(value);
+  }
+
+  // Answers Contains() for a non-decreasing sequence of values in one sweep
+  // through the intervals, i.e. in amortized constant time per query.
+  // A query for a lower value than the previous one is still answered
+  // correctly, but needs a binary search.  The set must outlive this object.
+  class SortedPointsQuery {
+   public:
+    explicit SortedPointsQuery(const FlatIntervalSet<T> &set)
+        : intervals_(set.intervals_), next_(intervals_.begin()) {}
+
+    bool Contains(const T &value) {
+      if (next_ != intervals_.begin() && value < std::prev(next_)->max) {
+        // Went back before the end of an interval that was passed.
+        next_ = std::upper_bound(
+            intervals_.begin(), intervals_.end(), value,
+            [](const T &v, const Interval<T> &i) { return v < i.max; });
+      }
+      // Skip the intervals that end at or before 'value'.
+      while (next_ != intervals_.end() && next_->max <= value) ++next_;
+      return next_ != intervals_.end() && next_->min <= value;
+    }
+
+    // Returns true if any value in [min, max) is contained.  The 'min' of
+    // successive queries is swept like the values of Contains().
+    bool Overlaps(const T &min, const T &max) {
+      if (!(min < max)) return false;
+      Contains(min);  // Positions next_ at the first interval ending after min.
+      return next_ != intervals_.end() && next_->min < max;
+    }
+
+   private:
+    const impl_type &intervals_;
+    // First interval that ends after the previously queried value.
+    const_iterator next_;
+  };
+
+ private:
+  void SortAndMerge() {
+    intervals_.erase(std::remove_if(intervals_.begin(), intervals_.end(),
+                                    [](const Interval<T> &interval) {
+                                      CHECK(interval.valid());
+                                      return interval.empty();
+                                    }),
+                     intervals_.end());
+    std::sort(intervals_.begin(), intervals_.end(),
+              [](const Interval<T> &a, const Interval<T> &b) {
+                return a.min < b.min;
+              });
+    // Fuse overlapping and abutting intervals in place.
+    auto merged = intervals_.begin();
+    for (auto iter = intervals_.begin(); iter != intervals_.end(); ++iter) {
+      if (merged != intervals_.begin() && iter->min <= std::prev(merged)->max) {
+        std::prev(merged)->max = std::max(std::prev(merged)->max, iter->max);
+      } else {
+        *merged++ = *iter;
+      }
+    }
+    intervals_.erase(merged, intervals_.end());
+  }
+
+  // Sorted by min, disjoint and not abutting.
+  impl_type intervals_;
+};
+
+template <typename T>
+std::ostream &operator<<(std::ostream &stream,
+                         const FlatIntervalSet<T> &iset) {
+  return FormatIntervals(stream, iset.begin(), iset.end());
+}
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_FLAT_INTERVAL_SET_H_
@@ -0,0 +1,126 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/util/flat_interval_set.h"
+
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "common/util/interval.h"
+#include "common/util/interval_set.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using ::testing::ElementsAre;
+
+using FlatSet = FlatIntervalSet<int>;
+
+TEST(FlatIntervalSetTest, Empty) {
+  const FlatSet iset;
+  EXPECT_TRUE(iset.empty());
+  EXPECT_EQ(iset.size(), 0);
+  EXPECT_FALSE(iset.Contains(0));
+  FlatSet::SortedPointsQuery query(iset);
+  EXPECT_FALSE(query.Contains(0));
+}
+
+TEST(FlatIntervalSetTest, SortsAndMerges) {
+  const FlatSet iset({{20, 25}, {3, 5}, {8, 8}, {4, 7}, {7, 9}, {1, 2},
+                      {21, 22}, {30, 31}});
+  EXPECT_THAT(iset, ElementsAre(Interval<int>(1, 2), Interval<int>(3, 9),
+                                Interval<int>(20, 25), Interval<int>(30, 31)));
+  std::ostringstream stream;
+  stream << iset;
+  EXPECT_EQ(stream.str(), "[1, 2), [3, 9), [20, 25), [30, 31)");
+}
+
+TEST(FlatIntervalSetTest, FromIntervalSet) {
+  const IntervalSet<int> iset{{5, 7}, {1, 3}, {3, 4}};
+  const FlatSet flat_set(iset);
+  EXPECT_EQ(flat_set, FlatSet({{1, 4}, {5, 7}}));
+  EXPECT_NE(flat_set, FlatSet({{1, 7}}));
+}
+
+TEST(FlatIntervalSetTest, Contains) {
+  const FlatSet iset{{1, 2}, {4, 7}, {9, 10}};
+  const std::vector<int> expected_members = {1, 4, 5, 6, 9};
+  std::vector<int> members;
+  for (int i = -1; i < 12; ++i) {
+    if (iset.Contains(i)) members.push_back(i);
+  }
+  EXPECT_EQ(members, expected_members);
+}
+
+TEST(FlatIntervalSetTest, SortedPointsQuery) {
+  const FlatSet iset{{1, 2}, {4, 7}, {9, 10}};
+  FlatSet::SortedPointsQuery query(iset);
+  EXPECT_FALSE(query.Contains(0));
+  EXPECT_TRUE(query.Contains(1));
+  EXPECT_TRUE(query.Contains(1));  // same value again
+  EXPECT_FALSE(query.Contains(3));
+  EXPECT_TRUE(query.Contains(6));
+  EXPECT_FALSE(query.Contains(7));
+  // Going back still works.
+  EXPECT_TRUE(query.Contains(5));
+  EXPECT_TRUE(query.Contains(1));
+  EXPECT_FALSE(query.Contains(2));
+  EXPECT_TRUE(query.Contains(9));
+  EXPECT_FALSE(query.Contains(100));
+  EXPECT_TRUE(query.Contains(4));
+}
+
+TEST(FlatIntervalSetTest, SortedPointsQueryOverlaps) {
+  const FlatSet iset{{1, 2}, {4, 7}, {9, 10}};
+  FlatSet::SortedPointsQuery query(iset);
+  EXPECT_FALSE(query.Overlaps(0, 1));
+  EXPECT_TRUE(query.Overlaps(0, 2));
+  EXPECT_FALSE(query.Overlaps(2, 4));
+  EXPECT_FALSE(query.Overlaps(5, 5));  // empty
+  EXPECT_TRUE(query.Overlaps(3, 12));
+  EXPECT_TRUE(query.Contains(6));  // mixed with point queries
+  EXPECT_FALSE(query.Overlaps(7, 9));
+  EXPECT_TRUE(query.Overlaps(6, 7));  // going back
+  EXPECT_FALSE(query.Overlaps(10, 100));
+}
+
+// Compares all queries against an IntervalSet built one interval at a time.
+TEST(FlatIntervalSetTest, MatchesIntervalSet) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> position(0, 1000);
+  std::uniform_int_distribution<int> length(0, 20);
+  for (int round = 0; round < 20; ++round) {
+    std::vector<Interval<int>> intervals;
+    IntervalSet<int> expected;
+    for (int i = 0; i < 50; ++i) {
+      const int min = position(generator);
+      const Interval<int> interval(min, min + length(generator));
+      intervals.push_back(interval);
+      expected.Add(interval);
+    }
+    const FlatSet iset(intervals);
+    EXPECT_EQ(iset, FlatSet(expected));
+    FlatSet::SortedPointsQuery query(iset);
+    for (int value = -1; value < 1030; ++value) {
+      EXPECT_EQ(iset.Contains(value), expected.Contains(value)) << value;
+      EXPECT_EQ(query.Contains(value), expected.Contains(value)) << value;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace verible
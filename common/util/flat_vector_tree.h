@@ -0,0 +1,249 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_FLAT_VECTOR_TREE_H_
+#define VERIBLE_COMMON_UTIL_FLAT_VECTOR_TREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/util/iterator_range.h"
+#include "common/util/logging.h"
+#include "common/util/vector_tree.h"
+
+namespace verible {
+
+// FlatVectorTree is a read-mostly alternative to VectorTree that stores all
+// nodes of a tree in a single array, in pre-order.  A node's first child
+// immediately follows it, and each child's next sibling follows that child's
+// subtree.  Links are stored as offsets relative to each node, so copying or
+// moving the array keeps the tree intact.
+//
+// Compared to VectorTree, traversal touches memory sequentially and the tree
+// is a single allocation, at the cost of a fixed shape: values can be
+// modified, but nodes can not be added or removed once the tree is built,
+// e.g. by flattening a finished VectorTree.
+//
+// Nodes fulfill the TreeNode concept of tree_operations.h (with Parent(),
+// Value() and NextSibling()), so read-only tree operations and the iterators
+// from vector_tree_iterators.h work on them:
+//
+//   const FlatVectorTree<Foo> flat_tree(foo_tree);
+//   for (const auto& node : VectorTreePreOrderTraversal(flat_tree.Root())) {
+//     ...
+//   }
+template <typename T>
+class FlatVectorTree {
+ public:
+  class Node;
+  using value_type = T;
+
+  // Range of the children of a node, which are not contiguous in memory.
+  template <typename NodeType>
+  class ChildrenRange {
+   public:
+    class iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using difference_type = std::ptrdiff_t;
+      using value_type = NodeType;
+      using pointer = NodeType*;
+      using reference = NodeType&;
+
+      iterator() = default;
+      explicit iterator(NodeType* node) : node_(node) {}
+
+      reference operator*() const { return *node_; }
+      pointer operator->() const { return node_; }
+      iterator& operator++() {
+        node_ += node_->subtree_size_;
+        return *this;
+      }
+      iterator operator++(int) {
+        iterator tmp = *this;
+        ++*this;
+        return tmp;
+      }
+      friend bool operator==(const iterator& a, const iterator& b) {
+        return a.node_ == b.node_;
+      }
+      friend bool operator!=(const iterator& a, const iterator& b) {
+        return a.node_ != b.node_;
+      }
+
+     private:
+      NodeType* node_ = nullptr;
+    };
+    using const_iterator = iterator;
+
+    explicit ChildrenRange(NodeType* parent) : parent_(parent) {}
+
+    iterator begin() const { return iterator(parent_ + 1); }
+    iterator end() const { return iterator(parent_ + parent_->subtree_size_); }
+
+    bool empty() const { return parent_->subtree_size_ == 1; }
+
+    // Linear in the number of children.
+    size_t size() const { return std::distance(begin(), end()); }
+
+    NodeType& front() const {
+      CHECK(!empty());
+      return parent_[1];
+    }
+    NodeType& back() const {
+      CHECK(!empty());
+      return parent_[parent_->last_child_offset_];
+    }
+
+   private:
+    NodeType* parent_;
+  };
+
+  class Node {
+   public:
+    T& Value() { return value_; }
+    const T& Value() const { return value_; }
+
+    Node* Parent() {
+      return parent_offset_ == 0 ? nullptr : this - parent_offset_;
+    }
+    const Node* Parent() const {
+      return parent_offset_ == 0 ? nullptr : this - parent_offset_;
+    }
+
+    ChildrenRange<Node> Children() { return ChildrenRange<Node>(this); }
+    ChildrenRange<const Node> Children() const {
+      return ChildrenRange<const Node>(this);
+    }
+
+    // Constant time, unlike finding the sibling through Parent()->Children().
+    Node* NextSibling() { return NextSiblingImpl(this); }
+    const Node* NextSibling() const { return NextSiblingImpl(this); }
+
+    // Number of nodes in the subtree rooted at this node, including itself.
+    size_t SubtreeSize() const { return subtree_size_; }
+
+   private:
+    friend class FlatVectorTree;
+    friend class ChildrenRange<Node>;
+    friend class ChildrenRange<const Node>;
+
+    template <typename... Args>
+    explicit Node(uint32_t parent_offset, Args&&... args)
+        : value_(std::forward<Args>(args)...), parent_offset_(parent_offset) {}
+
+    template <typename NodeType>
+    static NodeType* NextSiblingImpl(NodeType* node) {
+      if (node->parent_offset_ == 0) return nullptr;
+      NodeType* next = node + node->subtree_size_;
+      const auto* parent = node - node->parent_offset_;
+      return next == parent + parent->subtree_size_ ? nullptr : next;
+    }
+
+    T value_;
+
+    // Distances to other nodes, in number of nodes.  The first child, if
+    // any, is always the next node.
+    uint32_t parent_offset_;  // 0 for the root.
+    uint32_t subtree_size_ = 1;
+    uint32_t last_child_offset_ = 0;  // 0 for leaves.
+  };
+
+  using iterator = typename std::vector<Node>::iterator;
+  using const_iterator = typename std::vector<Node>::const_iterator;
+
+  // Creates an empty tree, without a root.
+  FlatVectorTree() = default;
+
+  // Copies the shape and values of any tree with Children() and Value().
+  template <typename SrcTree>
+  explicit FlatVectorTree(const SrcTree& tree) {
+    nodes_.reserve(CountNodes(tree));
+    AppendSubtree(tree, 0);
+  }
+
+  // Takes the values out of "tree", which is left in a valid but unspecified
+  // state.
+  explicit FlatVectorTree(VectorTree<T>&& tree) {
+    nodes_.reserve(CountNodes(tree));
+    AppendSubtree(std::move(tree), 0);
+  }
+
+  bool empty() const { return nodes_.empty(); }
+
+  // Number of nodes in the tree.
+  size_t size() const { return nodes_.size(); }
+
+  Node& Root() {
+    CHECK(!empty());
+    return nodes_.front();
+  }
+  const Node& Root() const {
+    CHECK(!empty());
+    return nodes_.front();
+  }
+
+  // All nodes, in pre-order.  This is the fastest way to visit all nodes
+  // when their order of visitation is all that matters.
+  iterator_range<iterator> PreOrderNodes() {
+    return make_range(nodes_.begin(), nodes_.end());
+  }
+  iterator_range<const_iterator> PreOrderNodes() const {
+    return make_range(nodes_.begin(), nodes_.end());
+  }
+
+ private:
+  template <typename SrcTree>
+  static size_t CountNodes(const SrcTree& tree) {
+    size_t count = 1;
+    for (const auto& child : tree.Children()) count += CountNodes(child);
+    return count;
+  }
+
+  // Appends a copy of "tree", or moves its values if it is an rvalue, and
+  // returns the position of the new subtree.
+  template <typename SrcTree>
+  size_t AppendSubtree(SrcTree&& tree, uint32_t parent_offset) {
+    constexpr bool kMoveValues = std::is_rvalue_reference_v<SrcTree&&>;
+    const size_t index = nodes_.size();
+    if constexpr (kMoveValues) {
+      nodes_.push_back(Node(parent_offset, std::move(tree.Value())));
+    } else {
+      nodes_.push_back(Node(parent_offset, tree.Value()));
+    }
+    size_t last_child = index;
+    for (auto&& child : tree.Children()) {
+      const uint32_t child_parent_offset = nodes_.size() - index;
+      if constexpr (kMoveValues) {
+        last_child = AppendSubtree(std::move(child), child_parent_offset);
+      } else {
+        last_child = AppendSubtree(child, child_parent_offset);
+      }
+    }
+    Node& node = nodes_[index];
+    node.last_child_offset_ = last_child - index;
+    node.subtree_size_ = nodes_.size() - index;
+    return index;
+  }
+
+  std::vector<Node> nodes_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_FLAT_VECTOR_TREE_H_
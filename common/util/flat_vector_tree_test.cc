@@ -0,0 +1,160 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/util/flat_vector_tree.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/tree_operations.h"
+#include "common/util/vector_tree.h"
+#include "common/util/vector_tree_iterators.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+using Tree = VectorTree<int>;
+using FlatTree = FlatVectorTree<int>;
+
+Tree MakeExampleTree() {
+  return Tree(0,                        //
+              Tree(1),                  //
+              Tree(2,                   //
+                   Tree(21),            //
+                   Tree(22, Tree(221)),  //
+                   Tree(23)),           //
+              Tree(3));
+}
+
+template <typename Range>
+std::vector<int> Values(Range &&nodes) {
+  std::vector<int> values;
+  for (const auto &node : nodes) values.push_back(node.Value());
+  return values;
+}
+
+TEST(FlatVectorTreeTest, Empty) {
+  const FlatTree tree;
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.size(), 0);
+  EXPECT_THAT(Values(tree.PreOrderNodes()), IsEmpty());
+}
+
+TEST(FlatVectorTreeTest, SingleNode) {
+  const FlatTree tree(Tree(7));
+  ASSERT_EQ(tree.size(), 1);
+  const auto &root = tree.Root();
+  EXPECT_EQ(root.Value(), 7);
+  EXPECT_EQ(root.Parent(), nullptr);
+  EXPECT_EQ(root.NextSibling(), nullptr);
+  EXPECT_TRUE(root.Children().empty());
+  EXPECT_TRUE(is_leaf(root));
+}
+
+TEST(FlatVectorTreeTest, SameStructureAndValues) {
+  const Tree tree = MakeExampleTree();
+  const FlatTree flat_tree(tree);
+  EXPECT_EQ(flat_tree.size(), 8);
+  const auto diff = DeepEqual(tree, flat_tree.Root());
+  EXPECT_EQ(diff.left, nullptr);
+  EXPECT_EQ(diff.right, nullptr);
+  EXPECT_THAT(Values(flat_tree.PreOrderNodes()),
+              ElementsAre(0, 1, 2, 21, 22, 221, 23, 3));
+}
+
+TEST(FlatVectorTreeTest, Links) {
+  const FlatTree tree(MakeExampleTree());
+  const auto &root = tree.Root();
+  EXPECT_THAT(Values(root.Children()), ElementsAre(1, 2, 3));
+  EXPECT_EQ(root.Children().size(), 3);
+  EXPECT_EQ(root.Children().front().Value(), 1);
+  EXPECT_EQ(root.Children().back().Value(), 3);
+  EXPECT_EQ(root.SubtreeSize(), 8);
+
+  const auto &node2 = *std::next(root.Children().begin());
+  EXPECT_EQ(node2.Value(), 2);
+  EXPECT_EQ(node2.Parent(), &root);
+  EXPECT_EQ(node2.SubtreeSize(), 5);
+  EXPECT_EQ(BirthRank(node2), 1);
+  EXPECT_EQ(NumAncestors(node2), 1);
+  EXPECT_THAT(Values(node2.Children()), ElementsAre(21, 22, 23));
+
+  const auto &node22 = *std::next(node2.Children().begin());
+  EXPECT_EQ(node22.Parent(), &node2);
+  EXPECT_EQ(NextSibling(node22)->Value(), 23);
+  EXPECT_EQ(PreviousSibling(node22)->Value(), 21);
+  EXPECT_EQ(NextLeaf(node22.Children().front())->Value(), 23);
+  EXPECT_EQ(PreviousLeaf(node22.Children().front())->Value(), 21);
+  EXPECT_EQ(&Root(node22.Children().front()), &root);
+
+  EXPECT_TRUE(IsLastChild(root.Children().back()));
+  EXPECT_EQ(NextSibling(root.Children().back()), nullptr);
+  EXPECT_TRUE(IsFirstChild(root.Children().front()));
+}
+
+TEST(FlatVectorTreeTest, Iterators) {
+  FlatTree tree(MakeExampleTree());
+  EXPECT_THAT(Values(VectorTreePreOrderTraversal(tree.Root())),
+              ElementsAre(0, 1, 2, 21, 22, 221, 23, 3));
+  EXPECT_THAT(Values(VectorTreePostOrderTraversal(tree.Root())),
+              ElementsAre(1, 21, 221, 22, 23, 2, 3, 0));
+  EXPECT_THAT(Values(VectorTreeLeavesTraversal(tree.Root())),
+              ElementsAre(1, 21, 221, 23, 3));
+
+  const FlatTree &const_tree = tree;
+  auto &subtree = *std::next(const_tree.Root().Children().begin());
+  EXPECT_THAT(Values(VectorTreePreOrderTraversal(subtree)),
+              ElementsAre(2, 21, 22, 221, 23));
+  EXPECT_THAT(Values(VectorTreeLeavesTraversal(subtree)),
+              ElementsAre(21, 221, 23));
+}
+
+TEST(FlatVectorTreeTest, ModifyValues) {
+  FlatTree tree(MakeExampleTree());
+  for (auto &node : VectorTreePreOrderTraversal(tree.Root())) {
+    node.Value() += 1000;
+  }
+  EXPECT_THAT(Values(tree.PreOrderNodes()),
+              ElementsAre(1000, 1001, 1002, 1021, 1022, 1221, 1023, 1003));
+}
+
+TEST(FlatVectorTreeTest, CopyAndMove) {
+  const FlatTree tree(MakeExampleTree());
+  const FlatTree copy(tree);
+  EXPECT_EQ(DeepEqual(tree.Root(), copy.Root()).left, nullptr);
+  const FlatTree moved = FlatTree(MakeExampleTree());
+  EXPECT_EQ(DeepEqual(tree.Root(), moved.Root()).left, nullptr);
+  EXPECT_EQ(moved.Root().Children().back().Parent(), &moved.Root());
+}
+
+TEST(FlatVectorTreeTest, MovesValuesOutOfVectorTree) {
+  using UniqueTree = VectorTree<std::unique_ptr<std::string>>;
+  UniqueTree tree(std::make_unique<std::string>("root"),
+                  UniqueTree(std::make_unique<std::string>("child")));
+  const FlatVectorTree<std::unique_ptr<std::string>> flat_tree(
+      std::move(tree));
+  ASSERT_EQ(flat_tree.size(), 2);
+  EXPECT_EQ(*flat_tree.Root().Value(), "root");
+  EXPECT_EQ(*flat_tree.Root().Children().front().Value(), "child");
+}
+
+}  // namespace
+}  // namespace verible
@@ -16,12 +16,14 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <iostream>
 #include <string>
 #include <vector>
 
 #include "absl/base/log_severity.h"
 #include "absl/debugging/failure_signal_handler.h"
 #include "absl/debugging/symbolize.h"
+#include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/flags/usage.h"
 #include "absl/flags/usage_config.h"
@@ -31,6 +33,12 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "common/util/generated_verible_build_version.h"
+#include "common/util/trace.h"
+
+ABSL_FLAG(std::string, trace_output, "",
+          "If set, record timed spans of the analysis phases, and write them "
+          "to this file at exit, in the Chrome trace event JSON format "
+          "(view with chrome://tracing or ui.perfetto.dev).");
 
 namespace verible {
 
@@ -104,6 +112,17 @@ std::vector<absl::string_view> InitCommandLine(
 #endif
 
   const auto positional_parameters = absl::ParseCommandLine(*argc, *argv);
+
+  if (!absl::GetFlag(FLAGS_trace_output).empty()) {
+    trace::SetEnabled(true);
+    std::atexit([]() {
+      const auto status =
+          trace::WriteChromeTraceFile(absl::GetFlag(FLAGS_trace_output));
+      if (!status.ok()) {
+        std::cerr << "--trace_output: " << status.message() << std::endl;
+      }
+    });
+  }
   return {positional_parameters.cbegin(), positional_parameters.cend()};
 }
 
@@ -439,7 +439,7 @@ class IntervalSet : private internal::IntervalSetImpl {
     // here, cumulative_size == sum_of_sizes().
 
     return [=]() {
-      static absl::BitGen gen;
+      thread_local absl::BitGen gen;  // generators may be used concurrently
       const size_t rand = absl::Uniform<size_t>(gen, 0, cumulative_size);
       // Convert effectively from uniform to weighted random, by interval size.
       // binary_search (upper_bound) is O(lg N) where N is the number
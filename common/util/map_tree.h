@@ -15,17 +15,116 @@
 #ifndef VERIBLE_COMMON_UTIL_MAP_TREE_H_
 #define VERIBLE_COMMON_UTIL_MAP_TREE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <list>
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "common/util/logging.h"
 #include "common/util/spacer.h"
 
 namespace verible {
 
+namespace map_tree_internal {
+
+// Map of HashMapTree subtrees, with the subset of the std::map interface
+// that BasicMapTree uses.  Key-value pairs are kept in a list, so that they
+// are iterator-stable and iterated in insertion order, and are found through
+// a flat hash map of their keys.
+template <typename K, typename T, typename Hash, typename Eq>
+class HashedSubtreesMap {
+  using list_type = std::list<std::pair<const K, T>>;
+
+ public:
+  using value_type = typename list_type::value_type;
+  using iterator = typename list_type::iterator;
+  using const_iterator = typename list_type::const_iterator;
+
+  HashedSubtreesMap() = default;
+
+  HashedSubtreesMap(const HashedSubtreesMap &other) : nodes_(other.nodes_) {
+    for (auto iter = nodes_.begin(); iter != nodes_.end(); ++iter) {
+      index_.emplace(iter->first, iter);
+    }
+  }
+
+  // Moving a std::list keeps its iterators valid.
+  HashedSubtreesMap(HashedSubtreesMap &&other) = default;
+
+  HashedSubtreesMap &operator=(const HashedSubtreesMap &) = delete;
+  HashedSubtreesMap &operator=(HashedSubtreesMap &&) = delete;
+
+  void swap(HashedSubtreesMap &other) noexcept {
+    nodes_.swap(other.nodes_);
+    index_.swap(other.index_);
+  }
+
+  template <typename KeyValue>
+  std::pair<iterator, bool> emplace(KeyValue &&key_value) {
+    const auto found = index_.find(key_value.first);
+    if (found != index_.end()) return {found->second, false};
+    nodes_.push_back(std::forward<KeyValue>(key_value));
+    const iterator inserted = std::prev(nodes_.end());
+    index_.emplace(inserted->first, inserted);
+    return {inserted, true};
+  }
+
+  iterator erase(iterator pos) {
+    index_.erase(pos->first);
+    return nodes_.erase(pos);
+  }
+
+  template <typename AnyKey>
+  iterator find(const AnyKey &key) {
+    const auto found = index_.find(key);
+    return found == index_.end() ? nodes_.end() : found->second;
+  }
+  template <typename AnyKey>
+  const_iterator find(const AnyKey &key) const {
+    const auto found = index_.find(key);
+    return found == index_.end() ? nodes_.end() : found->second;
+  }
+
+  iterator begin() { return nodes_.begin(); }
+  const_iterator begin() const { return nodes_.begin(); }
+  iterator end() { return nodes_.end(); }
+  const_iterator end() const { return nodes_.end(); }
+
+  bool empty() const { return nodes_.empty(); }
+  size_t size() const { return nodes_.size(); }
+
+ private:
+  list_type nodes_;
+  absl::flat_hash_map<K, iterator, Hash, Eq> index_;
+};
+
+}  // namespace map_tree_internal
+
+// Holds the subtrees of MapTree nodes in a std::map, for key-value
+// co-location and iterator stability.  (std::map rather than std::set allows
+// values to be mutable, while keys remain const.)
+template <typename KeyComp>
+struct OrderedSubtrees {
+  static constexpr bool kKeyOrdered = true;
+  template <typename K, typename Tree>
+  using map_type = std::map<K, Tree, KeyComp>;
+};
+
+// Holds the subtrees of HashMapTree nodes.
+template <typename Hash, typename Eq>
+struct HashedSubtrees {
+  static constexpr bool kKeyOrdered = false;
+  template <typename K, typename Tree>
+  using map_type = map_tree_internal::HashedSubtreesMap<K, Tree, Hash, Eq>;
+};
+
 // MapTree is a hierarchical tree representation of values, where branches are
 // associated with keys.
 // This is one implementation of a 'trie' or 'prefix tree' data structure.
@@ -38,10 +137,15 @@ namespace verible {
 //   KeyComp is the comparator for K for ordering.
 //     KeyComp can be a heterogenous lookup comparator (C++14).
 //
+// HashMapTree is the same, except that the children of a node are found by
+// hashing their keys (Hash and Eq), and visited in the order they were
+// inserted instead of in key-order.  Use it for large trees in which the
+// order of children does not matter; printing is still in key-order.
+//
 // Key-value pairs are co-located together, and are iterator-stable, meaning
 // that insertion/deletion operations do not invalidate existing iterators
 // or existing pointers to other nodes in the same family tree.
-// Insertion/deletion/search operations are O(lg N).
+// Insertion/deletion/search operations are O(lg N), O(1) for HashMapTree.
 //
 // Nodes maintain links to their parent (except the root node), so upwards
 // navigation toward the root is always possible.
@@ -71,15 +175,14 @@ namespace verible {
 // * File-system like structures, with string-like K.
 //   * Navigation through parent directories uses upward links.
 //
-template <typename K, typename V, typename KeyComp = std::less<K>>
-class MapTree {
-  using this_type = MapTree<K, V, KeyComp>;
+// Both are a BasicMapTree, which gets the type of the map holding the
+// subtrees of a node from 'Subtrees'.
+template <typename K, typename V, typename Subtrees>
+class BasicMapTree {
+  using this_type = BasicMapTree<K, V, Subtrees>;
 
   // Self-recursive type that holds subtrees.
-  // A std::map is chosen for key-value co-location and iterator stability.
-  // We chose std::map over std::set to allow values to be mutable, while keys
-  // remain const.
-  using subtrees_type = std::map<K, this_type, KeyComp>;
+  using subtrees_type = typename Subtrees::template map_type<K, this_type>;
 
  public:
   using key_type = K;
@@ -88,10 +191,10 @@ class MapTree {
   using iterator = typename subtrees_type::iterator;
   using const_iterator = typename subtrees_type::const_iterator;
 
-  MapTree() = default;
+  BasicMapTree() = default;
 
   // deep-copy, requires node_value_type to be copy-able.
-  MapTree(const MapTree &other)
+  BasicMapTree(const BasicMapTree &other)
       : node_value_(other.node_value_),
         subtrees_(other.subtrees_),
         // new copy is disconnected from original parent and is a new root
@@ -100,7 +203,7 @@ class MapTree {
   }
 
   // move (with relink)
-  MapTree(MapTree &&other) noexcept
+  BasicMapTree(BasicMapTree &&other) noexcept
       : node_value_(std::move(other.node_value_)),
         subtrees_(std::move(other.subtrees_)),
         // Retain existing parent.
@@ -109,8 +212,8 @@ class MapTree {
   }
 
   // TODO(fangism): implement assignments as needed
-  MapTree &operator=(const MapTree &) = delete;
-  MapTree &operator=(MapTree &&) = delete;
+  BasicMapTree &operator=(const BasicMapTree &) = delete;
+  BasicMapTree &operator=(BasicMapTree &&) = delete;
 
   // Recursively initialize trees (copy node value).
   // Example:
@@ -126,7 +229,7 @@ class MapTree {
   //               P{key6, M(value6)})}
   //   );
   template <typename... Args>
-  explicit MapTree(const node_value_type &v, Args &&...args)
+  explicit BasicMapTree(const node_value_type &v, Args &&...args)
       : node_value_(v), subtrees_() {
     EmplacePairs(std::forward<Args>(args)...);
   }
@@ -134,12 +237,12 @@ class MapTree {
   // Recursively initialize trees (move node value).
   // See example above, using node_value_type copy.
   template <typename... Args>
-  explicit MapTree(node_value_type &&v, Args &&...args)
+  explicit BasicMapTree(node_value_type &&v, Args &&...args)
       : node_value_(std::move(v)), subtrees_() {
     EmplacePairs(std::forward<Args>(args)...);
   }
 
-  ~MapTree() { CHECK(CheckIntegrity()); }
+  ~BasicMapTree() { CHECK(CheckIntegrity()); }
 
   void swap(this_type &other) noexcept {
     std::swap(node_value_, other.node_value_);
@@ -201,7 +304,11 @@ class MapTree {
   // TODO(fangism): TryEmplaceHint(), like map::emplace_hint.
 
   // Erasure
-  // TODO(fangism): void Erase(key);
+
+  // Removes the child subtree at 'pos', which must be a valid iterator to a
+  // child of this node.  Returns the iterator following the removed child.
+  // Iterators and references to other children remain valid.
+  iterator Erase(iterator pos) { return subtrees_.erase(pos); }
 
   // Iteration/Navigation
 
@@ -291,7 +398,7 @@ class MapTree {
   // Search
 
   // Returns an iterator located at 'key' or end() if not found.
-  // O(lg N), same as underlying map type.
+  // O(lg N) or O(1), same as underlying map type.
   template <typename AnyKey>
   iterator Find(AnyKey &&key) {
     // Forward to underlying map::find, enabling heterogenous lookup.
@@ -299,7 +406,7 @@ class MapTree {
   }
 
   // Returns a const_iterator located at 'key' or end() if not found.
-  // O(lg N), same as underlying map type.
+  // O(lg N) or O(1), same as underlying map type.
   template <typename AnyKey>
   const_iterator Find(AnyKey &&key) const {
     // Forward to underlying map::find, enabling heterogenous lookup.
@@ -317,7 +424,7 @@ class MapTree {
   // Note that keys can never be mutated.
 
   // Applies function 'f' to all nodes in this tree in a pre-order traversal.
-  // Children are visited in key-order.
+  // Children are visited in the order of iteration.
   void ApplyPreOrder(const std::function<void(const this_type &)> &f) const {
     f(*this);
     for (const auto &child : *this) {
@@ -342,7 +449,7 @@ class MapTree {
   }
 
   // Applies function 'f' to all nodes in this tree in a post-order traversal.
-  // Children are visited in key-order.
+  // Children are visited in the order of iteration.
   void ApplyPostOrder(const std::function<void(const this_type &)> &f) const {
     for (const auto &child : *this) {
       child.second.ApplyPostOrder(f);
@@ -371,7 +478,7 @@ class MapTree {
   // Printing and formatting
 
   // Pretty-print tree, using a custom node_value printer function.
-  // Keys are printed using operator<<.
+  // Keys are printed using operator<<, children in key-order.
   std::ostream &PrintTree(std::ostream &stream,
                           const std::function<std::ostream &(
                               std::ostream &, const node_value_type &,
@@ -383,9 +490,9 @@ class MapTree {
       stream << " }";
     } else {
       stream << '\n';
-      for (const auto &child : Children()) {
-        stream << Spacer(indent + 2) << child.first << ": ";
-        child.second.PrintTree(stream, printer, indent + 2) << '\n';
+      for (const key_value_type *child : ChildrenInKeyOrder()) {
+        stream << Spacer(indent + 2) << child->first << ": ";
+        child->second.PrintTree(stream, printer, indent + 2) << '\n';
       }
       stream << Spacer(indent) << '}';
     }
@@ -403,6 +510,20 @@ class MapTree {
   }
 
  private:  // methods
+  // Returns the children, sorted by key unless they already are.
+  std::vector<const key_value_type *> ChildrenInKeyOrder() const {
+    std::vector<const key_value_type *> children;
+    children.reserve(Children().size());
+    for (const auto &child : Children()) children.push_back(&child);
+    if (!Subtrees::kKeyOrdered) {
+      std::sort(children.begin(), children.end(),
+                [](const key_value_type *a, const key_value_type *b) {
+                  return a->first < b->first;
+                });
+    }
+    return children;
+  }
+
   // Establish parent-child links.
   void Relink() {
     for (auto &subtree : subtrees_) {
@@ -421,6 +542,13 @@ class MapTree {
   this_type *parent_ = nullptr;
 };
 
+template <typename K, typename V, typename KeyComp = std::less<K>>
+using MapTree = BasicMapTree<K, V, OrderedSubtrees<KeyComp>>;
+
+template <typename K, typename V, typename Hash = absl::Hash<K>,
+          typename Eq = std::equal_to<K>>
+using HashMapTree = BasicMapTree<K, V, HashedSubtrees<Hash, Eq>>;
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_UTIL_MAP_TREE_H_
@@ -193,6 +193,23 @@ TEST(MapTreeTest, EmplaceSecondKey) {
   EXPECT_EQ(m.Find(9), first_iter);  // iterator stability on insert
 }
 
+TEST(MapTreeTest, EraseChild) {
+  MapTreeTestType m("foo",                         //
+                    KV{3, MapTreeTestType("bar")},  //
+                    KV{5, MapTreeTestType("baz",    //
+                                          KV{1, MapTreeTestType("qux")})});
+  const auto kept = m.Find(3);
+  const auto next = m.Erase(m.Find(5));
+  EXPECT_EQ(next, m.end());
+  EXPECT_EQ(m.Children().size(), 1);
+  EXPECT_EQ(m.Find(5), m.end());
+  EXPECT_EQ(m.Find(3), kept);  // iterator stability on erase
+  EXPECT_EQ(kept->second.Parent(), &m);
+
+  EXPECT_EQ(m.Erase(kept), m.end());
+  EXPECT_TRUE(m.is_leaf());
+}
+
 TEST(MapTreeTest, InitializeMultipleChildrenWithDuplicateKey) {
   const MapTreeTestType m("foo",  //
                           KV{4, MapTreeTestType("bbb")},
@@ -555,5 +572,79 @@ TEST(MapTreeTest, PrintTreeTwoGenerationsUsingIndent) {
 })");
 }
 
+using HashMapTreeTestType = HashMapTree<int, std::string>;
+using HKV = HashMapTreeTestType::key_value_type;
+
+TEST(HashMapTreeTest, EmplaceFindErase) {
+  HashMapTreeTestType m("root");
+  for (const int key : {5, 3, 8, 1}) {
+    const auto p = m.TryEmplace(key, std::to_string(key));
+    EXPECT_TRUE(p.second);
+    EXPECT_EQ(p.first->second.Parent(), &m);
+    EXPECT_EQ(*p.first->second.Key(), key);
+  }
+  EXPECT_FALSE(m.TryEmplace(3, "again").second);
+  EXPECT_EQ(m.Find(3)->second.Value(), "3");  // kept the first one
+  EXPECT_EQ(m.Find(4), m.end());
+
+  const HashMapTreeTestType *eight = &m.Find(8)->second;
+  const auto next = m.Erase(m.Find(3));
+  EXPECT_EQ(next->first, 8);
+  EXPECT_EQ(m.Find(3), m.end());
+  EXPECT_EQ(&m.Find(8)->second, eight);  // address is stable
+
+  // Children are iterated in insertion order.
+  std::ostringstream stream;
+  for (const auto &child : m) stream << child.first << " ";
+  EXPECT_EQ(stream.str(), "5 8 1 ");
+}
+
+TEST(HashMapTreeTest, DeepCopy) {
+  const HashMapTreeTestType m(
+      "groot",  //
+      HKV{5, HashMapTreeTestType("pp", HKV{4, HashMapTreeTestType("ss")})},
+      HKV{3, HashMapTreeTestType("qq")});
+  const HashMapTreeTestType m_copy(m);
+  EXPECT_EQ(m_copy.Children().size(), 2);
+  const auto child = m_copy.Find(5);
+  ASSERT_NE(child, m_copy.end());
+  EXPECT_EQ(child->second.Parent(), &m_copy);
+  EXPECT_NE(&child->second, &m.Find(5)->second);
+  const auto grandchild = child->second.Find(4);
+  ASSERT_NE(grandchild, child->second.end());
+  EXPECT_EQ(grandchild->second.Value(), "ss");
+  EXPECT_EQ(grandchild->second.Root(), &m_copy);
+}
+
+TEST(HashMapTreeTest, Swap) {
+  HashMapTreeTestType m1("foo", HKV{4, HashMapTreeTestType("bbb")});
+  HashMapTreeTestType m2("bar", HKV{2, HashMapTreeTestType("aaaa")},
+                         HKV{1, HashMapTreeTestType("c")});
+  m1.swap(m2);
+  EXPECT_EQ(m1.Value(), "bar");
+  EXPECT_EQ(m1.Children().size(), 2);
+  EXPECT_EQ(m1.Find(2)->second.Parent(), &m1);
+  EXPECT_EQ(m1.Find(4), m1.end());
+  EXPECT_EQ(m2.Find(4)->second.Parent(), &m2);
+}
+
+TEST(HashMapTreeTest, PrintTreeInKeyOrder) {
+  const HashMapTreeTestType m(
+      "groot",  //
+      HKV{5, HashMapTreeTestType("pp", HKV{4, HashMapTreeTestType("ss")},
+                                 HKV{1, HashMapTreeTestType("tt")})},
+      HKV{3, HashMapTreeTestType("qq")});
+  std::ostringstream stream;
+  m.PrintTree(stream);
+  EXPECT_EQ(stream.str(),  //
+            "{ (groot)\n"
+            "  3: { (qq) }\n"
+            "  5: { (pp)\n"
+            "    1: { (tt) }\n"
+            "    4: { (ss) }\n"
+            "  }\n"
+            "}");
+}
+
 }  // namespace
 }  // namespace verible
@@ -0,0 +1,49 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/util/memory_usage.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace verible {
+
+void MemoryUsage::Add(absl::string_view component, size_t bytes) {
+  components_[std::string(component)] += bytes;
+}
+
+void MemoryUsage::Add(absl::string_view prefix, const MemoryUsage &other) {
+  for (const auto &[component, bytes] : other.components_) {
+    components_[absl::StrCat(prefix, component)] += bytes;
+  }
+}
+
+size_t MemoryUsage::Total() const {
+  size_t total = 0;
+  for (const auto &component : components_) total += component.second;
+  return total;
+}
+
+std::ostream &operator<<(std::ostream &stream, const MemoryUsage &usage) {
+  for (const auto &[component, bytes] : usage.Components()) {
+    stream << component << ": " << bytes << " bytes\n";
+  }
+  return stream << "total: " << usage.Total() << " bytes\n";
+}
+
+}  // namespace verible
@@ -0,0 +1,62 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_MEMORY_USAGE_H_
+#define VERIBLE_COMMON_UTIL_MEMORY_USAGE_H_
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace verible {
+
+// MemoryUsage is an estimate of the heap memory held by a data structure,
+// broken down into named components.  The estimates count the storage that
+// containers have reserved, not what the allocator spends on bookkeeping.
+class MemoryUsage {
+ public:
+  // Adds 'bytes' to 'component'.
+  void Add(absl::string_view component, size_t bytes);
+
+  // Adds all components of 'other', with 'prefix' prepended to their names.
+  void Add(absl::string_view prefix, const MemoryUsage &other);
+
+  // Returns the sum over all components.
+  size_t Total() const;
+
+  // Returns the bytes by component name.
+  const std::map<std::string, size_t> &Components() const {
+    return components_;
+  }
+
+ private:
+  std::map<std::string, size_t> components_;
+};
+
+// Prints one "component: bytes" line per component, followed by the total.
+std::ostream &operator<<(std::ostream &, const MemoryUsage &);
+
+// Returns the bytes reserved by 'v' for its elements.
+template <typename T>
+size_t VectorMemoryUsage(const std::vector<T> &v) {
+  return v.capacity() * sizeof(T);
+}
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_MEMORY_USAGE_H_
@@ -0,0 +1,72 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/util/memory_usage.h"
+
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(MemoryUsageTest, Empty) {
+  const MemoryUsage usage;
+  EXPECT_EQ(usage.Total(), 0);
+  EXPECT_TRUE(usage.Components().empty());
+  std::ostringstream stream;
+  stream << usage;
+  EXPECT_EQ(stream.str(), "total: 0 bytes\n");
+}
+
+TEST(MemoryUsageTest, AddAccumulatesPerComponent) {
+  MemoryUsage usage;
+  usage.Add("tokens", 100);
+  usage.Add("tree", 20);
+  usage.Add("tokens", 5);
+  EXPECT_EQ(usage.Total(), 125);
+  ASSERT_EQ(usage.Components().size(), 2);
+  EXPECT_EQ(usage.Components().at("tokens"), 105);
+  EXPECT_EQ(usage.Components().at("tree"), 20);
+}
+
+TEST(MemoryUsageTest, AddOtherWithPrefix) {
+  MemoryUsage inner;
+  inner.Add("tokens", 10);
+  inner.Add("tree", 20);
+  MemoryUsage outer;
+  outer.Add("contents", 7);
+  outer.Add("include.", inner);
+  outer.Add("include.", inner);
+  EXPECT_EQ(outer.Total(), 67);
+  std::ostringstream stream;
+  stream << outer;
+  EXPECT_EQ(stream.str(),
+            "contents: 7 bytes\n"
+            "include.tokens: 20 bytes\n"
+            "include.tree: 40 bytes\n"
+            "total: 67 bytes\n");
+}
+
+TEST(MemoryUsageTest, VectorMemoryUsageCountsCapacity) {
+  std::vector<int> v;
+  EXPECT_EQ(VectorMemoryUsage(v), 0);
+  v.reserve(10);
+  v.push_back(1);
+  EXPECT_EQ(VectorMemoryUsage(v), v.capacity() * sizeof(int));
+}
+
+}  // namespace
+}  // namespace verible
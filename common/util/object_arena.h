@@ -0,0 +1,93 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_OBJECT_ARENA_H_
+#define VERIBLE_COMMON_UTIL_OBJECT_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace verible {
+
+// ObjectArena creates objects of type T in large blocks of memory and releases
+// all of them at once when the arena is destroyed.  This suits graph-like
+// structures with many small nodes that share one lifetime, such as search
+// states that only point to their ancestors.
+//
+// Objects never move once created, so pointers to them remain valid for the
+// lifetime of the arena.  Objects can not be freed individually.
+template <typename T, size_t kBlockSize = 1024>
+class ObjectArena {
+  static_assert(kBlockSize > 0, "kBlockSize must be positive");
+
+ public:
+  ObjectArena() = default;
+
+  ObjectArena(const ObjectArena &) = delete;
+  ObjectArena &operator=(const ObjectArena &) = delete;
+
+  ~ObjectArena() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_t b = 0; b < blocks_.size(); ++b) {
+        const size_t count =
+            (b + 1 == blocks_.size()) ? used_in_last_block_ : kBlockSize;
+        for (size_t i = 0; i < count; ++i) {
+          std::launder(reinterpret_cast<T *>(&blocks_[b][i]))->~T();
+        }
+      }
+    }
+  }
+
+  // Constructs a new object in the arena, forwarding "args" to T's
+  // constructor, and returns a pointer to it.
+  template <typename... Args>
+  T *New(Args &&...args) {
+    if (blocks_.empty() || used_in_last_block_ == kBlockSize) {
+      blocks_.emplace_back(new Slot[kBlockSize]);
+      used_in_last_block_ = 0;
+    }
+    T *object = new (&blocks_.back()[used_in_last_block_])
+        T(std::forward<Args>(args)...);
+    ++used_in_last_block_;  // only after successful construction
+    return object;
+  }
+
+  // Returns the number of objects created in this arena.
+  size_t size() const {
+    return blocks_.empty() ? 0
+                           : (blocks_.size() - 1) * kBlockSize +
+                                 used_in_last_block_;
+  }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  // Uninitialized storage for one T.
+  struct Slot {
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  std::vector<std::unique_ptr<Slot[]>> blocks_;
+
+  // Number of constructed objects in blocks_.back().
+  size_t used_in_last_block_ = 0;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_OBJECT_ARENA_H_
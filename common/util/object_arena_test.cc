@@ -0,0 +1,68 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/util/object_arena.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+TEST(ObjectArenaTest, InitiallyEmpty) {
+  ObjectArena<int> arena;
+  EXPECT_TRUE(arena.empty());
+  EXPECT_EQ(arena.size(), 0);
+}
+
+TEST(ObjectArenaTest, ConstructsWithArguments) {
+  ObjectArena<std::string> arena;
+  const std::string *s = arena.New(3, 'x');
+  EXPECT_EQ(*s, "xxx");
+  EXPECT_EQ(arena.size(), 1);
+  EXPECT_FALSE(arena.empty());
+}
+
+TEST(ObjectArenaTest, AddressesStableAcrossBlocks) {
+  ObjectArena<int, 4> arena;
+  std::vector<int *> objects;
+  for (int i = 0; i < 10; ++i) {
+    objects.push_back(arena.New(i));
+  }
+  EXPECT_EQ(arena.size(), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(*objects[i], i);
+  }
+}
+
+struct DestructionCounter {
+  explicit DestructionCounter(int *counter) : counter(counter) {}
+  ~DestructionCounter() { ++*counter; }
+  int *counter;
+};
+
+TEST(ObjectArenaTest, DestroysAllObjects) {
+  int destroyed = 0;
+  {
+    ObjectArena<DestructionCounter, 3> arena;
+    for (int i = 0; i < 7; ++i) arena.New(&destroyed);
+    EXPECT_EQ(destroyed, 0);
+  }
+  EXPECT_EQ(destroyed, 7);
+}
+
+}  // namespace
+}  // namespace verible
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -91,15 +92,69 @@ class HeaderWriter {
   const char *begin_;
   char *pos_;
 };
+
+struct CompressResult {
+  uint32_t input_crc;
+  size_t input_size;
+  size_t output_size;
+};
+
+CompressResult CopyDataToOutput(const ByteSource &generator,
+                                const ByteSink &out) {
+  uint32_t crc = 0;
+  size_t processed_size = 0;
+  absl::string_view chunk;
+  while (!(chunk = generator()).empty()) {
+    crc = crc32(crc, reinterpret_cast<const uint8_t *>(chunk.data()),
+                chunk.size());
+    processed_size += chunk.size();
+    out(chunk);
+  }
+  return {crc, processed_size, processed_size};
+}
+
+// Assembles the compressed data in 'scratch_space' before writing it out.
+CompressResult CompressDataToOutput(int compression_level,
+                                    const ByteSource &generator,
+                                    const ByteSink &out, char *scratch_space,
+                                    size_t scratch_size) {
+  uint32_t crc = 0;
+  absl::string_view chunk;
+  z_stream stream;
+  memset(&stream, 0x00, sizeof(stream));
+
+  // Need negative window bits to tell zlib not to create a header.
+  deflateInit2(&stream, compression_level, Z_DEFLATED, -15 /*window bits*/,
+               9 /* memlevel*/, 0);
+
+  do {
+    chunk = generator();
+    const int flush_setting = chunk.empty() ? Z_FINISH : Z_NO_FLUSH;
+    if (!chunk.empty()) {
+      crc = crc32(crc, reinterpret_cast<const uint8_t *>(chunk.data()),
+                  chunk.size());
+    }
+    stream.avail_in = chunk.size();
+    // Nasty C-API without 'const' input.
+    stream.next_in =
+        reinterpret_cast<uint8_t *>(const_cast<char *>(chunk.data()));
+    do {
+      stream.avail_out = scratch_size;
+      stream.next_out = reinterpret_cast<uint8_t *>(scratch_space);
+      deflate(&stream, flush_setting);
+      const size_t output_size = scratch_size - stream.avail_out;
+      if (output_size) out({scratch_space, output_size});
+    } while (stream.avail_out == 0);
+  } while (!chunk.empty());
+
+  CompressResult result = {crc, stream.total_in, stream.total_out};
+  deflateEnd(&stream);
+  return result;
+}
 }  // namespace
 
 struct Encoder::Impl {
   static constexpr int16_t kPkZipVersion = 20;  // 2.0, pretty basic.
-  struct CompressResult {
-    uint32_t input_crc;
-    size_t input_size;
-    size_t output_size;
-  };
 
   Impl(int compression_level, ByteSink out)
       : compression_level_(std::clamp(compression_level, 0, 9)),
@@ -114,6 +169,30 @@ struct Encoder::Impl {
     if (is_finished_) return false;  // Can't add more files.
     if (!content_generator) return false;
 
+    const bool deflated = compression_level_ != 0;
+    return AddEntry(filename, deflated, [&]() {
+      return deflated ? CompressDataToOutput(compression_level_,
+                                             content_generator, out_,
+                                             scratch_space_,
+                                             sizeof(scratch_space_))
+                      : CopyDataToOutput(content_generator, out_);
+    });
+  }
+
+  bool AddCompressedFile(absl::string_view filename,
+                         const CompressedFile &file) {
+    if (is_finished_) return false;  // Can't add more files.
+
+    return AddEntry(filename, file.deflated, [&]() {
+      out_(file.data);
+      return CompressResult{file.crc, file.uncompressed_size,
+                            file.data.size()};
+    });
+  }
+
+  // Writes the headers of a file around the data that 'write_data' outputs.
+  bool AddEntry(absl::string_view filename, bool deflated,
+                const std::function<CompressResult()> &write_data) {
     ++file_count_;
     const size_t start_offset = output_file_offset_;
 
@@ -125,7 +204,7 @@ struct Encoder::Impl {
             .AddLiteral("PK\x03\x04")
             .AddInt16(kPkZipVersion)  // Minimum version needed
             .AddInt16(0x08)  // Flags. Sizes and CRC in data descriptor.
-            .AddInt16(compression_level_ == 0 ? 0 : 8)
+            .AddInt16(deflated ? 8 : 0)
             .AddInt16(mod_time)
             .AddInt16(mod_date)
             .AddInt32(0)  // CRC32. Known later.
@@ -138,9 +217,7 @@ struct Encoder::Impl {
     if (!success) return false;
 
     // Data output
-    const CompressResult compress_result =
-        compression_level_ == 0 ? CopyDataToOutput(content_generator)
-                                : CompressDataToOutput(content_generator);
+    const CompressResult compress_result = write_data();
 
     success =  // Assemble Data Descriptor after file with known CRC and size.
         HeaderWriter(scratch_space_)
@@ -155,7 +232,7 @@ struct Encoder::Impl {
         .AddInt16(kPkZipVersion)  // Our Version
         .AddInt16(kPkZipVersion)  // Readable by version
         .AddInt16(0x08)           // Flag
-        .AddInt16(compression_level_ == 0 ? 0 : 8)
+        .AddInt16(deflated ? 8 : 0)
         .AddInt16(mod_time)
         .AddInt16(mod_date)
         .AddInt32(compress_result.input_crc)
@@ -197,55 +274,6 @@ struct Encoder::Impl {
         .Write(out_);
   }
 
-  CompressResult CopyDataToOutput(const ByteSource &generator) {
-    uint32_t crc = 0;
-    size_t processed_size = 0;
-    absl::string_view chunk;
-    while (!(chunk = generator()).empty()) {
-      crc = crc32(crc, reinterpret_cast<const uint8_t *>(chunk.data()),
-                  chunk.size());
-      processed_size += chunk.size();
-      out_(chunk);
-    }
-    return {crc, processed_size, processed_size};
-  }
-
-  CompressResult CompressDataToOutput(const ByteSource &generator) {
-    uint32_t crc = 0;
-    absl::string_view chunk;
-    z_stream stream;
-    memset(&stream, 0x00, sizeof(stream));
-
-    // Need negative window bits to tell zlib not to create a header.
-    deflateInit2(&stream, compression_level_, Z_DEFLATED, -15 /*window bits*/,
-                 9 /* memlevel*/, 0);
-
-    const size_t kScratchSize = sizeof(scratch_space_);
-    do {
-      chunk = generator();
-      const int flush_setting = chunk.empty() ? Z_FINISH : Z_NO_FLUSH;
-      if (!chunk.empty()) {
-        crc = crc32(crc, reinterpret_cast<const uint8_t *>(chunk.data()),
-                    chunk.size());
-      }
-      stream.avail_in = chunk.size();
-      // Nasty C-API without 'const' input.
-      stream.next_in =
-          reinterpret_cast<uint8_t *>(const_cast<char *>(chunk.data()));
-      do {
-        stream.avail_out = kScratchSize;
-        stream.next_out = reinterpret_cast<uint8_t *>(scratch_space_);
-        deflate(&stream, flush_setting);
-        const size_t output_size = kScratchSize - stream.avail_out;
-        if (output_size) out_({scratch_space_, output_size});
-      } while (stream.avail_out == 0);
-    } while (!chunk.empty());
-
-    CompressResult result = {crc, stream.total_in, stream.total_out};
-    deflateEnd(&stream);
-    return result;
-  }
-
   const int compression_level_;
   const ByteSink delegate_write_;
   const ByteSink out_;
@@ -268,5 +296,34 @@ bool Encoder::AddFile(absl::string_view filename,
 }
 bool Encoder::Finish() { return impl_->Finish(); }
 
+CompressedFile Encoder::Compress(int compression_level,
+                                 const ByteSource &content_generator) {
+  CompressedFile file;
+  if (!content_generator) return file;
+  const ByteSink append = [&file](absl::string_view s) {
+    file.data.append(s.data(), s.size());
+    return true;
+  };
+  compression_level = std::clamp(compression_level, 0, 9);
+  file.deflated = compression_level != 0;
+  CompressResult result;
+  if (file.deflated) {
+    constexpr size_t kScratchSize = 1 << 16;
+    const std::unique_ptr<char[]> scratch_space(new char[kScratchSize]);
+    result = CompressDataToOutput(compression_level, content_generator, append,
+                                  scratch_space.get(), kScratchSize);
+  } else {
+    result = CopyDataToOutput(content_generator, append);
+  }
+  file.crc = result.input_crc;
+  file.uncompressed_size = result.input_size;
+  return file;
+}
+
+bool Encoder::AddCompressedFile(absl::string_view filename,
+                                const CompressedFile &file) {
+  return impl_->AddCompressedFile(filename, file);
+}
+
 }  // namespace zip
 }  // namespace verible
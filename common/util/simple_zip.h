@@ -16,8 +16,11 @@
 #ifndef VERIBLE_COMMON_UTIL_SIMPLE_ZIP_H_
 #define VERIBLE_COMMON_UTIL_SIMPLE_ZIP_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "absl/strings/string_view.h"
 
@@ -50,6 +53,14 @@ ByteSource MemoryByteSource(absl::string_view input);
 // (no other errors are reported. If you need error handling, write your own).
 ByteSource FileByteSource(const char *filename);
 
+// The content of a file, as it is stored in the zip file.
+struct CompressedFile {
+  uint32_t crc = 0;  // Of the uncompressed content.
+  size_t uncompressed_size = 0;
+  bool deflated = false;  // Otherwise, stored uncompressed.
+  std::string data;
+};
+
 // Encode a zip file. Call AddFile() 0..n times, then finalize with Finish()
 // No more files can be added after Finish().
 class Encoder {
@@ -64,6 +75,16 @@ class Encoder {
   // Add a file with given filename and content from the generator function.
   bool AddFile(absl::string_view filename, const ByteSource &content_generator);
 
+  // Compresses the content like AddFile() does with "compression_level".
+  // This does not need an Encoder, so files can be compressed concurrently,
+  // and then added in any order with AddCompressedFile().
+  static CompressedFile Compress(int compression_level,
+                                 const ByteSource &content_generator);
+
+  // Add a file with given filename and content from Compress().
+  bool AddCompressedFile(absl::string_view filename,
+                         const CompressedFile &file);
+
   // Finalize container.
   // After this, no new files can be added.
   // Note if your byte-sink is wrapping a file, you might need to close it
@@ -115,3 +115,33 @@ TEST(SimpleZip, ImplicitFinishOnDestruction) {
   EXPECT_EQ(CountSubstr("PK\x01\x02", result), 1);  // one per file in directory
   EXPECT_EQ(CountSubstr("PK\x05\x06", result), 1);  // directory footer
 }
+
+TEST(SimpleZip, AddCompressedFileLikeAddFile) {
+  for (const int compression_level : {0, 9}) {
+    std::string added;
+    std::string added_compressed;
+    {
+      verible::zip::Encoder zipper(
+          compression_level, [&added](absl::string_view out) {
+            added.append(out.begin(), out.end());
+            return true;
+          });
+      zipper.AddFile("essay.txt",
+                     verible::zip::MemoryByteSource("Hello world"));
+    }
+    {
+      verible::zip::Encoder zipper(
+          compression_level, [&added_compressed](absl::string_view out) {
+            added_compressed.append(out.begin(), out.end());
+            return true;
+          });
+      const verible::zip::CompressedFile file =
+          verible::zip::Encoder::Compress(
+              compression_level, verible::zip::MemoryByteSource("Hello world"));
+      EXPECT_EQ(file.deflated, compression_level != 0);
+      EXPECT_EQ(file.uncompressed_size, 11);
+      zipper.AddCompressedFile("essay.txt", file);
+    }
+    EXPECT_EQ(added_compressed, added) << compression_level;
+  }
+}
@@ -14,50 +14,166 @@
 
 #include "common/util/thread_pool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <utility>
 
 namespace verible {
+
+struct ThreadPool::Worker {
+  std::mutex lock;
+  std::deque<Task> tasks;  // Guarded by lock.
+  std::thread thread;
+};
+
+// The pool and worker index of the current thread, if it is a worker.
+static thread_local const ThreadPool *current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+
 ThreadPool::ThreadPool(int thread_count) {
   for (int i = 0; i < thread_count; ++i) {
-    threads_.push_back(new std::thread(&ThreadPool::Runner, this));
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Start the threads once all workers exist, as they steal from each other.
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->thread = std::thread(&ThreadPool::Runner, this, i);
   }
 }
 
 ThreadPool::~ThreadPool() {
   CancelAllWork();
-  for (auto *t : threads_) {
-    t->join();
-    delete t;
+  for (auto &worker : workers_) worker->thread.join();
+}
+
+void ThreadPool::Runner(size_t index) {
+  current_pool = this;
+  current_worker = index;
+  while (!exiting_) {
+    if (std::optional<Task> task = TakeTask(index)) {
+      (*task)();
+      continue;
+    }
+    std::unique_lock<std::mutex> l(lock_);
+    ++sleepers_;
+    cv_.wait(l, [this]() { return queued_ > 0 || exiting_; });
+    --sleepers_;
   }
 }
 
-void ThreadPool::Runner() {
-  std::function<void()> process_work_item;
-  for (;;) {
-    {
-      std::unique_lock<std::mutex> l(lock_);
-      cv_.wait(l, [this]() { return !work_queue_.empty() || exiting_; });
-      if (exiting_) return;
-      process_work_item = work_queue_.front();
-      work_queue_.pop_front();
+std::optional<ThreadPool::Task> ThreadPool::TakeTask(size_t index) {
+  std::optional<Task> task;
+  const auto take_queued = [&](Priority priority) {
+    if (queued_in_queues_ == 0) return false;
+    const std::lock_guard<std::mutex> l(lock_);
+    std::deque<Task> &queue = queues_[static_cast<int>(priority)];
+    if (queue.empty()) return false;
+    task.emplace(std::move(queue.front()));
+    queue.pop_front();
+    --queued_in_queues_;
+    return true;
+  };
+  const auto take_own = [&](Worker *worker, bool newest) {
+    const std::lock_guard<std::mutex> l(worker->lock);
+    if (worker->tasks.empty()) return false;
+    if (newest) {
+      task.emplace(std::move(worker->tasks.back()));
+      worker->tasks.pop_back();
+    } else {
+      task.emplace(std::move(worker->tasks.front()));
+      worker->tasks.pop_front();
     }
-    process_work_item();
+    return true;
+  };
+
+  bool found = take_queued(Priority::kHigh) ||
+               take_own(workers_[index].get(), /*newest=*/true) ||
+               take_queued(Priority::kNormal);
+  for (size_t i = 1; !found && i < workers_.size(); ++i) {
+    found = take_own(workers_[(index + i) % workers_.size()].get(),
+                     /*newest=*/false);
   }
+  found = found || take_queued(Priority::kLow);
+  if (found) --queued_;
+  return task;
 }
 
-void ThreadPool::EnqueueWork(const std::function<void()> &work) {
-  if (threads_.empty()) {
-    work();  // synchronous execution
+void ThreadPool::Enqueue(Task task, Priority priority) {
+  if (workers_.empty()) {
+    task();  // synchronous execution
     return;
   }
 
-  {
-    std::unique_lock<std::mutex> l(lock_);
-    work_queue_.emplace_back(work);
+  if (current_pool == this && priority == Priority::kNormal) {
+    Worker *const worker = workers_[current_worker].get();
+    const std::lock_guard<std::mutex> l(worker->lock);
+    worker->tasks.push_back(std::move(task));
+  } else {
+    const std::lock_guard<std::mutex> l(lock_);
+    queues_[static_cast<int>(priority)].push_back(std::move(task));
+    ++queued_in_queues_;
   }
-  cv_.notify_one();
+  // Workers register as sleepers before checking queued_ with lock_ held, so
+  // either this sees them, or they see the new task.
+  ++queued_;
+  if (sleepers_ > 0) {
+    const std::lock_guard<std::mutex> l(lock_);
+    cv_.notify_one();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)> &body,
+                             Priority priority) {
+  if (begin >= end) return;
+  grain = std::max<size_t>(grain, 1);
+  const size_t chunks = (end - begin + grain - 1) / grain;
+
+  // Shared with the helper tasks, some of which might only start when all
+  // chunks are done, and then just return.
+  struct State {
+    std::atomic<size_t> next_chunk = 0;
+    std::atomic<bool> failed = false;
+    std::mutex lock;
+    std::condition_variable all_done;
+    size_t done = 0;  // Guarded by lock, like error.
+    std::exception_ptr error;
+  };
+  const auto state = std::make_shared<State>();
+  // Only touches "body" while a chunk is not done, so while this waits.
+  const auto run_chunks = [state, begin, end, grain, chunks, &body]() {
+    size_t ran = 0;
+    for (size_t c; (c = state->next_chunk++) < chunks; ++ran) {
+      if (state->failed) continue;
+      const size_t sub_begin = begin + c * grain;
+      try {
+        body(sub_begin, std::min(end, sub_begin + grain));
+      } catch (...) {
+        const std::lock_guard<std::mutex> l(state->lock);
+        if (!state->error) state->error = std::current_exception();
+        state->failed = true;
+      }
+    }
+    if (ran == 0) return;
+    const std::lock_guard<std::mutex> l(state->lock);
+    state->done += ran;
+    if (state->done == chunks) state->all_done.notify_all();
+  };
+
+  const size_t helpers = std::min(workers_.size(), chunks - 1);
+  for (size_t i = 0; i < helpers; ++i) Enqueue(Task(run_chunks), priority);
+  run_chunks();
+
+  std::unique_lock<std::mutex> l(state->lock);
+  state->all_done.wait(l, [&]() { return state->done == chunks; });
+  if (state->error) std::rethrow_exception(state->error);
 }
 
 void ThreadPool::CancelAllWork() {
@@ -67,4 +183,31 @@ void ThreadPool::CancelAllWork() {
   }
   cv_.notify_all();
 }
+
+ThreadPool::TaskGroup::~TaskGroup() {
+  std::unique_lock<std::mutex> l(lock_);
+  done_.wait(l, [this]() { return pending_ == 0; });
+}
+
+bool ThreadPool::TaskGroup::AddTask() {
+  if (cancelled_) return false;
+  const std::lock_guard<std::mutex> l(lock_);
+  ++pending_;
+  return true;
+}
+
+void ThreadPool::TaskGroup::FinishTask(std::exception_ptr error) {
+  const std::lock_guard<std::mutex> l(lock_);
+  if (error && !error_) error_ = std::move(error);
+  if (--pending_ == 0) done_.notify_all();
+}
+
+void ThreadPool::TaskGroup::Wait() {
+  std::unique_lock<std::mutex> l(lock_);
+  done_.wait(l, [this]() { return pending_ == 0; });
+  if (std::exception_ptr error = std::exchange(error_, nullptr)) {
+    std::rethrow_exception(error);
+  }
+}
+
 }  // namespace verible
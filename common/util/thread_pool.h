@@ -15,64 +15,194 @@
 #ifndef VERIBLE_COMMON_UTIL_THREAD_POOL_H
 #define VERIBLE_COMMON_UTIL_THREAD_POOL_H
 
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <thread>
+#include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace verible {
 // Simple thread-pool.
 // Passing in functions, returning futures.
 //
+// Each thread has its own queue for the tasks that its tasks add, which it
+// runs newest first, and from which idle threads steal the oldest tasks.
+// Tasks added from other threads are queued by priority: queued tasks of a
+// higher priority are started before the others.
+//
 // Why not use std::async() ? That standard is so generic and vaguely
 // specified that in practice there is no implementation of a policy that
 // provides a thread-pool behavior with a guaranteed upper bound of cores used
 // on all platforms.
 class ThreadPool {
+  struct DeduceResult {};
+
  public:
+  // Scheduling lanes of the queued tasks.
+  enum class Priority {
+    kHigh,    // E.g. answering interactive requests.
+    kNormal,  // Default.
+    kLow,     // E.g. background indexing.
+  };
+
   // Create thread pool with "thread_count" threads.
   // If that count is zero, functions will be executed synchronously.
   explicit ThreadPool(int thread_count);
 
-  // Exit ASAP and leave remaining work in queue unfinished.
+  // Exit ASAP and leave remaining work in queue unfinished.  The futures
+  // of unfinished work report a std::future_error (broken promise).
   ~ThreadPool();
 
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
   // Add a function returning T, that is to be executed asynchronously.
-  // Return a std::future<T> with the eventual result.
+  // Return a std::future<T> with the eventual result.  T can be left out to
+  // use the result type of "f", which may be move-only.
   //
   // As a special case: if initialized with no threads, the function is
   // executed synchronously.
-  template <class T>
-  [[nodiscard]] std::future<T> ExecAsync(const std::function<T()> &f) {
-    auto *p = new std::promise<T>();
-    std::future<T> future_result = p->get_future();
-    // NOLINT, as clang-tidy assumes memory leak where is none.
-    auto promise_fulfiller = [p, f]() {  // NOLINT
-      try {
-        p->set_value(f());
-      } catch (...) {
-        p->set_exception(std::current_exception());
-      }
-      delete p;
-    };
-    EnqueueWork(promise_fulfiller);
+  template <class T = DeduceResult, class F>
+  [[nodiscard]] auto ExecAsync(F &&f, Priority priority = Priority::kNormal) {
+    using R = std::conditional_t<std::is_same_v<T, DeduceResult>,
+                                 std::invoke_result_t<std::decay_t<F> &>, T>;
+    std::promise<R> promise;
+    std::future<R> future_result = promise.get_future();
+    Enqueue(Task([promise = std::move(promise),
+                  f = std::forward<F>(f)]() mutable {
+              try {
+                if constexpr (std::is_void_v<R>) {
+                  f();
+                  promise.set_value();
+                } else {
+                  promise.set_value(f());
+                }
+              } catch (...) {
+                promise.set_exception(std::current_exception());
+              }
+            }),
+            priority);
     return future_result;
   }
 
+  // Calls "body" with consecutive sub-ranges [sub_begin, sub_end) of
+  // [begin, end), "grain" indices each (but the last), on the pool's threads
+  // and the calling thread, and returns once all of them are done.  If "body"
+  // throws, the sub-ranges not started yet are skipped, and the first
+  // exception is rethrown here.
+  void ParallelFor(size_t begin, size_t end, size_t grain,
+                   const std::function<void(size_t, size_t)> &body,
+                   Priority priority = Priority::kNormal);
+
+  // Tasks that are waited for, or cancelled, together.  The pool needs to
+  // outlive the group.  Don't Wait() from a task running on the same pool:
+  // all its threads might end up waiting.
+  class TaskGroup {
+   public:
+    explicit TaskGroup(ThreadPool *pool, Priority priority = Priority::kNormal)
+        : pool_(pool), priority_(priority) {}
+
+    // Waits for the tasks, ignoring their exceptions.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    // Adds "f" to the pool, unless the group is cancelled.
+    template <class F>
+    void Run(F &&f) {
+      if (!AddTask()) return;
+      pool_->Enqueue(Task([this, f = std::forward<F>(f)]() mutable {
+                       std::exception_ptr error;
+                       if (!cancelled()) {
+                         try {
+                           f();
+                         } catch (...) {
+                           error = std::current_exception();
+                         }
+                       }
+                       FinishTask(error);
+                     }),
+                     priority_);
+    }
+
+    // Blocks until all tasks are done or skipped.  Rethrows the first
+    // exception thrown by a task since the last Wait().
+    void Wait();
+
+    // Skips the tasks that did not start yet, and the ones added from now on.
+    // Running tasks can check cancelled() to return early.
+    void Cancel() { cancelled_ = true; }
+
+    bool cancelled() const { return cancelled_; }
+
+   private:
+    // Returns false if the group is cancelled, else counts a pending task.
+    bool AddTask();
+    void FinishTask(std::exception_ptr error);
+
+    ThreadPool *const pool_;
+    const Priority priority_;
+    std::atomic<bool> cancelled_ = false;
+    std::mutex lock_;
+    std::condition_variable done_;
+    int pending_ = 0;
+    std::exception_ptr error_;
+  };
+
  private:
-  void Runner();
+  // Move-only type-erased function, so that tasks can own their state.
+  class Task {
+   public:
+    template <class F,
+              class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    explicit Task(F &&f)
+        : impl_(std::make_unique<Impl<std::decay_t<F>>>(std::forward<F>(f))) {}
+
+    void operator()() { impl_->Run(); }
+
+   private:
+    struct Base {
+      virtual ~Base() = default;
+      virtual void Run() = 0;
+    };
+    template <class F>
+    struct Impl final : Base {
+      template <class G>
+      explicit Impl(G &&g) : f(std::forward<G>(g)) {}
+      void Run() final { f(); }
+      F f;
+    };
+    std::unique_ptr<Base> impl_;
+  };
+
+  struct Worker;
+
+  void Runner(size_t index);
+  std::optional<Task> TakeTask(size_t index);
+  void Enqueue(Task task, Priority priority);
   void CancelAllWork();
-  void EnqueueWork(const std::function<void()> &work);
 
-  std::vector<std::thread *> threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Tasks added from outside of the workers, by priority.  Guarded by lock_.
+  std::deque<Task> queues_[3];
+  std::atomic<int> queued_in_queues_ = 0;
+
+  // All queued tasks.  Workers wait on cv_ for them, holding lock_.
   std::mutex lock_;
   std::condition_variable cv_;
-  std::deque<std::function<void()>> work_queue_;
-  bool exiting_ = false;
+  std::atomic<int> queued_ = 0;
+  std::atomic<int> sleepers_ = 0;
+  std::atomic<bool> exiting_ = false;
 };
 
 }  // namespace verible
@@ -14,8 +14,12 @@
 
 #include "common/util/thread_pool.h"
 
+#include <atomic>
 #include <chrono>  // IWYU pragma: keep  for chrono_literals
 #include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <vector>
 
 #include "absl/time/clock.h"
@@ -89,5 +93,154 @@ TEST(ThreadPoolTest, ExceptionsArePropagated) {
   EXPECT_EQ(exception_count, kLoops);
 }
 
+TEST(ThreadPoolTest, MoveOnlyFunctionsAndResults) {
+  ThreadPool pool(2);
+  auto value = std::make_unique<int>(42);
+  std::future<std::unique_ptr<int>> result =
+      pool.ExecAsync([value = std::move(value)]() mutable {
+        PretendWork(10);
+        return std::move(value);
+      });
+  EXPECT_EQ(*result.get(), 42);
+
+  std::future<void> done = pool.ExecAsync([]() { PretendWork(10); });
+  done.get();
+}
+
+TEST(ThreadPoolTest, NestedWorkIsCompleted) {
+  constexpr int kOuter = 10;
+  constexpr int kInner = 10;
+  ThreadPool pool(3);
+  std::atomic<int> count = 0;
+  std::vector<std::future<int>> outer;
+  for (int i = 0; i < kOuter; ++i) {
+    outer.push_back(pool.ExecAsync([&]() {
+      // Tasks added from a worker are queued on that worker, and stolen
+      // by the others.
+      std::vector<std::future<void>> inner;
+      for (int j = 0; j < kInner; ++j) {
+        inner.push_back(pool.ExecAsync([&]() {
+          PretendWork(1);
+          ++count;
+        }));
+      }
+      return static_cast<int>(inner.size());
+    }));
+  }
+  for (auto &result : outer) EXPECT_EQ(result.get(), kInner);
+  // Inner tasks might still be running; the pool outlives them here.
+  while (count < kOuter * kInner) PretendWork(1);
+  EXPECT_EQ(count, kOuter * kInner);
+}
+
+TEST(ThreadPoolTest, HighPriorityWorkStartsFirst) {
+  ThreadPool pool(1);
+  // Keep the only thread busy, while queueing by priority.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  auto blocker = pool.ExecAsync([released]() { released.wait(); });
+
+  std::mutex order_lock;
+  std::vector<int> order;
+  std::vector<std::future<void>> results;
+  const auto record = [&](int value) {
+    return [&, value]() {
+      const std::lock_guard<std::mutex> l(order_lock);
+      order.push_back(value);
+    };
+  };
+  results.push_back(pool.ExecAsync(record(3), ThreadPool::Priority::kLow));
+  results.push_back(pool.ExecAsync(record(2), ThreadPool::Priority::kNormal));
+  results.push_back(pool.ExecAsync(record(1), ThreadPool::Priority::kHigh));
+  release.set_value();
+  blocker.get();
+  for (auto &result : results) result.get();
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(ThreadPoolTest, ParallelForCoversRange) {
+  for (const int threads : {0, 1, 4}) {
+    ThreadPool pool(threads);
+    std::vector<std::atomic<int>> visits(1000);
+    pool.ParallelFor(3, visits.size(), 7, [&](size_t begin, size_t end) {
+      EXPECT_LE(end - begin, 7);
+      for (size_t i = begin; i < end; ++i) ++visits[i];
+    });
+    for (size_t i = 0; i < visits.size(); ++i) {
+      EXPECT_EQ(visits[i], i < 3 ? 0 : 1) << i;
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForNestedInWorker) {
+  ThreadPool pool(2);
+  std::atomic<int> count = 0;
+  std::future<void> done = pool.ExecAsync([&]() {
+    pool.ParallelFor(0, 100, 1, [&](size_t, size_t) {
+      pool.ParallelFor(0, 10, 1, [&](size_t, size_t) { ++count; });
+    });
+  });
+  done.get();
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPoolTest, ParallelForPropagatesException) {
+  ThreadPool pool(3);
+  std::atomic<int> calls = 0;
+  EXPECT_THROW(pool.ParallelFor(0, 1000, 1,
+                                [&](size_t begin, size_t) {
+                                  ++calls;
+                                  if (begin == 10) {
+                                    throw std::runtime_error("failed");
+                                  }
+                                  PretendWork(1);
+                                }),
+               std::runtime_error);
+  EXPECT_LT(calls, 1000);  // Skipped the rest.
+}
+
+TEST(ThreadPoolTest, TaskGroupWaitsForTasks) {
+  for (const int threads : {0, 3}) {
+    ThreadPool pool(threads);
+    std::atomic<int> count = 0;
+    ThreadPool::TaskGroup group(&pool);
+    for (int i = 0; i < 20; ++i) {
+      group.Run([&]() {
+        PretendWork(2);
+        ++count;
+      });
+    }
+    group.Wait();
+    EXPECT_EQ(count, 20);
+
+    group.Run([]() { throw 1; });
+    EXPECT_THROW(group.Wait(), int);
+    group.Wait();  // The exception is only reported once.
+  }
+}
+
+TEST(ThreadPoolTest, TaskGroupCancelSkipsQueuedTasks) {
+  ThreadPool pool(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<int> count = 0;
+  {
+    ThreadPool::TaskGroup group(&pool);
+    group.Run([released, &count]() {
+      released.wait();
+      ++count;
+    });
+    for (int i = 0; i < 10; ++i) {
+      group.Run([&count]() { ++count; });
+    }
+    group.Cancel();
+    EXPECT_TRUE(group.cancelled());
+    group.Run([&count]() { ++count; });  // Not added anymore.
+    release.set_value();
+  }  // Waits for the group.
+  // Only the task that already ran when cancelling finished.
+  EXPECT_LE(count, 1);
+}
+
 }  // namespace
 }  // namespace verible
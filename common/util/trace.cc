@@ -0,0 +1,173 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/util/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace verible {
+namespace trace {
+
+namespace internal {
+std::atomic<bool> enabled{false};
+}  // namespace internal
+
+namespace {
+struct Span {
+  std::string name;
+  std::string category;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::duration duration;
+};
+
+// Spans recorded by one thread.  The lock is only contended while writing
+// the trace.
+struct ThreadSpans {
+  explicit ThreadSpans(int id) : thread_id(id) {}
+
+  const int thread_id;
+  std::mutex lock;
+  std::vector<Span> spans;
+};
+
+// Holds the spans of all threads, including exited ones.
+struct Registry {
+  std::mutex lock;
+  std::vector<std::unique_ptr<ThreadSpans>> threads;
+  std::chrono::steady_clock::time_point origin =
+      std::chrono::steady_clock::now();
+};
+
+Registry &GetRegistry() {
+  static auto *registry = new Registry();  // never destroyed, used at exit
+  return *registry;
+}
+
+ThreadSpans &CurrentThreadSpans() {
+  thread_local ThreadSpans *spans = nullptr;
+  if (spans == nullptr) {
+    Registry &registry = GetRegistry();
+    const std::lock_guard<std::mutex> lock(registry.lock);
+    registry.threads.push_back(
+        std::make_unique<ThreadSpans>(registry.threads.size() + 1));
+    spans = registry.threads.back().get();
+  }
+  return *spans;
+}
+
+void WriteJsonString(std::ostream &stream, absl::string_view text) {
+  stream << '"';
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      case '\n':
+        stream << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                 << static_cast<int>(c) << std::dec;
+        } else {
+          stream << c;
+        }
+    }
+  }
+  stream << '"';
+}
+
+int64_t Microseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+}  // namespace
+
+void SetEnabled(bool enabled) {
+  GetRegistry();  // fix the time origin no later than the first span
+  internal::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void RecordSpan(absl::string_view name, absl::string_view category,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::duration duration) {
+  ThreadSpans &thread_spans = CurrentThreadSpans();
+  const std::lock_guard<std::mutex> lock(thread_spans.lock);
+  thread_spans.spans.push_back(
+      {std::string(name), std::string(category), start, duration});
+}
+
+void Clear() {
+  Registry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.lock);
+  for (const auto &thread : registry.threads) {
+    const std::lock_guard<std::mutex> thread_lock(thread->lock);
+    thread->spans.clear();
+  }
+}
+
+void WriteChromeTrace(std::ostream &stream) {
+  Registry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.lock);
+  stream << "{\"traceEvents\":[";
+  const char *separator = "\n";
+  for (const auto &thread : registry.threads) {
+    const std::lock_guard<std::mutex> thread_lock(thread->lock);
+    for (const Span &span : thread->spans) {
+      stream << separator << "{\"name\":";
+      WriteJsonString(stream, span.name);
+      stream << ",\"cat\":";
+      WriteJsonString(stream, span.category);
+      stream << ",\"ph\":\"X\",\"ts\":"
+             << Microseconds(span.start - registry.origin)
+             << ",\"dur\":" << Microseconds(span.duration)
+             << ",\"pid\":1,\"tid\":" << thread->thread_id << "}";
+      separator = ",\n";
+    }
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+absl::Status WriteChromeTraceFile(absl::string_view filename) {
+  std::ofstream stream{std::string(filename)};
+  if (!stream.good()) {
+    return absl::NotFoundError(absl::StrCat(filename, ": can't open"));
+  }
+  WriteChromeTrace(stream);
+  stream.close();
+  if (!stream.good()) {
+    return absl::UnknownError(absl::StrCat(filename, ": can't write"));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace trace
+}  // namespace verible
@@ -0,0 +1,95 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_COMMON_UTIL_TRACE_H_
+#define VERIBLE_COMMON_UTIL_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace verible {
+namespace trace {
+
+namespace internal {
+extern std::atomic<bool> enabled;
+}  // namespace internal
+
+// Returns true if spans are being recorded.  This is cheap enough to check on
+// hot paths.
+inline bool Enabled() {
+  return internal::enabled.load(std::memory_order_relaxed);
+}
+
+// Starts or stops recording spans.  Already recorded spans are kept.
+void SetEnabled(bool enabled);
+
+// Records a span of 'duration' that started at 'start' on the calling thread.
+// Name and category are copied.
+void RecordSpan(absl::string_view name, absl::string_view category,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::duration duration);
+
+// Discards all recorded spans.
+void Clear();
+
+// Writes all recorded spans in the Chrome trace event JSON format, which can
+// be viewed with chrome://tracing or https://ui.perfetto.dev.
+void WriteChromeTrace(std::ostream &stream);
+
+// Same as above, to a file.
+absl::Status WriteChromeTraceFile(absl::string_view filename);
+
+}  // namespace trace
+
+// Records the lifetime of this object as a span, if tracing is enabled.
+// 'name' and 'category' only need to outlive this object.
+//
+// Usage:
+//   {
+//     const ScopedTrace trace("parse", "analysis");
+//     ... work to be measured ...
+//   }
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(absl::string_view name,
+                       absl::string_view category = "verible")
+      : name_(name), category_(category), active_(trace::Enabled()) {
+    if (active_) start_ = std::chrono::steady_clock::now();
+  }
+
+  ScopedTrace(const ScopedTrace &) = delete;
+  ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+  ~ScopedTrace() {
+    if (active_) {
+      trace::RecordSpan(name_, category_, start_,
+                        std::chrono::steady_clock::now() - start_);
+    }
+  }
+
+ private:
+  const absl::string_view name_;
+  const absl::string_view category_;
+  const bool active_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_TRACE_H_
@@ -0,0 +1,81 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "common/util/trace.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "absl/strings/match.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+static std::string ChromeTrace() {
+  std::ostringstream stream;
+  trace::WriteChromeTrace(stream);
+  return stream.str();
+}
+
+TEST(TraceTest, DisabledRecordsNothing) {
+  trace::Clear();
+  trace::SetEnabled(false);
+  { const ScopedTrace span("not-recorded"); }
+  EXPECT_EQ(ChromeTrace(),
+            "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+TEST(TraceTest, RecordsSpans) {
+  trace::Clear();
+  trace::SetEnabled(true);
+  {
+    const ScopedTrace outer("outer", "test");
+    const ScopedTrace inner("in\"ner");
+  }
+  trace::SetEnabled(false);
+  { const ScopedTrace span("not-recorded"); }
+
+  const std::string json = ChromeTrace();
+  EXPECT_TRUE(absl::StrContains(json, "{\"name\":\"outer\",\"cat\":\"test\","
+                                      "\"ph\":\"X\",\"ts\":"))
+      << json;
+  EXPECT_TRUE(absl::StrContains(json, "{\"name\":\"in\\\"ner\","
+                                      "\"cat\":\"verible\",\"ph\":\"X\""))
+      << json;
+  EXPECT_FALSE(absl::StrContains(json, "not-recorded")) << json;
+  trace::Clear();
+  EXPECT_FALSE(absl::StrContains(ChromeTrace(), "outer"));
+}
+
+TEST(TraceTest, RecordsSpansOfThreads) {
+  trace::Clear();
+  trace::SetEnabled(true);
+  std::thread thread([]() { const ScopedTrace span("thread-span"); });
+  thread.join();
+  trace::RecordSpan("explicit", "test", std::chrono::steady_clock::now(),
+                    std::chrono::milliseconds(2));
+  trace::SetEnabled(false);
+
+  const std::string json = ChromeTrace();
+  EXPECT_TRUE(absl::StrContains(json, "\"thread-span\"")) << json;
+  EXPECT_TRUE(absl::StrContains(json, "\"dur\":2000,")) << json;
+  trace::Clear();
+}
+
+}  // namespace
+}  // namespace verible
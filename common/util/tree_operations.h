@@ -45,6 +45,14 @@
 //   Types with this member can be detected by checking whether
 //   `TreeNodeTraits<T>::Value::available` is true.
 //
+// - `T* NextSibling()`:
+//   Returns pointer to the next sibling node or nullptr when the node is the
+//   last child or a tree root. Worth providing when `Children()` is not a
+//   random access container, in which case finding a sibling through the
+//   parent takes linear time.
+//   Types with this member can be detected by checking whether
+//   `TreeNodeTraits<T>::NextSibling::available` is true.
+//
 // - `subnodes_type` (typename):
 //   Container type which should be used for storing collections of detached
 //   child nodes.
@@ -126,6 +134,11 @@ template <typename Node,  //
           typename = std::void_t<TreeNodeChildrenTraits<Parent_>>>
 struct TreeNodeParentTraits : FeatureTraits {};
 
+// Defined when `Node` contains `NextSibling()` method.
+template <typename Node,  //
+          typename NextSibling_ = decltype(*std::declval<Node>().NextSibling())>
+struct TreeNodeNextSiblingTraits : FeatureTraits {};
+
 // BirthRank implementation details:
 
 // BirthRank implementation supporting any container.
@@ -182,6 +195,9 @@ struct TreeNodeTraits : FeatureTraits {
   using Value =
       detected_or_t<UnavailableFeatureTraits,
                     tree_operations_internal::TreeNodeValueTraits, Node>;
+  using NextSibling =
+      detected_or_t<UnavailableFeatureTraits,
+                    tree_operations_internal::TreeNodeNextSiblingTraits, Node>;
   using Children = Children_;
 };
 
@@ -205,7 +221,7 @@ template <class T, class Iterator,  //
 T& DescendPath(T& node, Iterator start, Iterator end) {
   auto* current_node = &node;
   for (auto iter = start; iter != end; ++iter) {
-    auto& children = current_node->Children();
+    auto&& children = current_node->Children();
     const std::size_t index = *iter;
     CHECK_LT(index, std::size(children));
     current_node = &*std::next(children.begin(), index);  // descend
@@ -483,6 +499,30 @@ bool IsLastChild(const T& node) {
   return &node.Parent()->Children().back() == &node;
 }
 
+// Returns the next sibling node if it exists, else nullptr.
+// The const-ness of the returned pointer matches the const-ness of the node
+// argumnent.
+//
+// Requires `Parent()` method in the node.
+template <class T,  //
+          std::enable_if_t<TreeNodeTraits<T>::Parent::available>* = nullptr>
+T* NextSibling(T& node) {
+  if constexpr (TreeNodeTraits<T>::NextSibling::available) {
+    return node.NextSibling();
+  } else {
+    if (node.Parent() == nullptr) {
+      return nullptr;
+    }
+    const size_t birth_rank = BirthRank(node);
+    const size_t next_rank = birth_rank + 1;
+    if (next_rank == std::size(node.Parent()->Children())) {
+      return nullptr;  // This is the last child of the Parent().
+    }
+    // More children follow this one.
+    return &*std::next(node.Parent()->Children().begin(), next_rank);
+  }
+}
+
 // Navigates to the next leaf (node without Children()) in the tree
 // (if it exists), else returns nullptr.
 // The const-ness of the returned pointer matches the const-ness of the node
@@ -499,12 +539,10 @@ T* NextLeaf(T& node) {
   }
 
   // Find the next sibling, if there is one.
-  auto& siblings = parent->Children();
-  const size_t birth_rank = BirthRank(node);
-  const size_t next_rank = birth_rank + 1;
-  if (next_rank != std::size(siblings)) {
+  auto* next_sibling = NextSibling(node);
+  if (next_sibling != nullptr) {
     // More children follow this one.
-    return &LeftmostDescendant(*std::next(siblings.begin(), next_rank));
+    return &LeftmostDescendant(*next_sibling);
   }
 
   // This is the last child of the group.
@@ -534,7 +572,7 @@ T* PreviousLeaf(T& node) {
   }
 
   // Find the next sibling, if there is one.
-  auto& siblings = parent->Children();
+  auto&& siblings = parent->Children();
   const size_t birth_rank = BirthRank(node);
   if (birth_rank > 0) {
     // More children precede this one.
@@ -552,26 +590,6 @@ T* PreviousLeaf(T& node) {
   return &RightmostDescendant(*prev_ancestor);
 }
 
-// Returns the next sibling node if it exists, else nullptr.
-// The const-ness of the returned pointer matches the const-ness of the node
-// argumnent.
-//
-// Requires `Parent()` method in the node.
-template <class T,  //
-          std::enable_if_t<TreeNodeTraits<T>::Parent::available>* = nullptr>
-T* NextSibling(T& node) {
-  if (node.Parent() == nullptr) {
-    return nullptr;
-  }
-  const size_t birth_rank = BirthRank(node);
-  const size_t next_rank = birth_rank + 1;
-  if (next_rank == std::size(node.Parent()->Children())) {
-    return nullptr;  // This is the last child of the Parent().
-  }
-  // More children follow this one.
-  return &*std::next(node.Parent()->Children().begin(), next_rank);
-}
-
 // Returns the previous sibling node if it exists, else nullptr.
 // The const-ness of the returned pointer matches the const-ness of the node
 // argumnent.
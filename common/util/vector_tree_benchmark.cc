@@ -0,0 +1,155 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares traversals of VectorTree and FlatVectorTree of the same shape.
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "common/util/flat_vector_tree.h"
+#include "common/util/tree_operations.h"
+#include "common/util/vector_tree.h"
+#include "common/util/vector_tree_iterators.h"
+
+namespace verible {
+namespace {
+
+using Tree = VectorTree<int64_t>;
+
+// Builds a complete tree of the given depth, with "fanout" children per node.
+Tree MakeTree(int depth, int fanout) {
+  Tree tree(depth);
+  if (depth > 0) {
+    tree.Children().reserve(fanout);
+    for (int i = 0; i < fanout; ++i) {
+      tree.Children().push_back(MakeTree(depth - 1, fanout));
+    }
+  }
+  return tree;
+}
+
+template <typename Node>
+int64_t SumPreOrder(Node &root) {
+  int64_t sum = 0;
+  for (const auto &node : VectorTreePreOrderTraversal(root)) {
+    sum += node.Value();
+  }
+  return sum;
+}
+
+template <typename Node>
+int64_t SumPostOrder(Node &root) {
+  int64_t sum = 0;
+  for (const auto &node : VectorTreePostOrderTraversal(root)) {
+    sum += node.Value();
+  }
+  return sum;
+}
+
+template <typename Node>
+int64_t SumLeaves(Node &root) {
+  int64_t sum = 0;
+  for (const auto &node : VectorTreeLeavesTraversal(root)) {
+    sum += node.Value();
+  }
+  return sum;
+}
+
+template <typename Node>
+int64_t SumApplyPreOrder(Node &root) {
+  int64_t sum = 0;
+  ApplyPreOrder(root, [&sum](const Node &node) { sum += node.Value(); });
+  return sum;
+}
+
+// The argument selects the fanout, the depth keeps the trees at about the
+// same size, between 100k and 300k nodes.
+int DepthForFanout(int fanout) {
+  switch (fanout) {
+    case 2:
+      return 17;
+    case 4:
+      return 9;
+    default:
+      return 4;
+  }
+}
+
+using FlatTree = FlatVectorTree<int64_t>;
+using FlatNode = FlatTree::Node;
+
+template <int64_t (*Sum)(const Tree &)>
+void BM_VectorTree(benchmark::State &state) {
+  const Tree tree = MakeTree(DepthForFanout(state.range(0)), state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Sum(tree));
+  }
+}
+
+template <int64_t (*Sum)(const FlatNode &)>
+void BM_FlatVectorTree(benchmark::State &state) {
+  const FlatTree tree(MakeTree(DepthForFanout(state.range(0)), state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Sum(tree.Root()));
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_VectorTree, SumPreOrder<const Tree>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_FlatVectorTree, SumPreOrder<const FlatNode>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_VectorTree, SumPostOrder<const Tree>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_FlatVectorTree, SumPostOrder<const FlatNode>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_VectorTree, SumLeaves<const Tree>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_FlatVectorTree, SumLeaves<const FlatNode>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_VectorTree, SumApplyPreOrder<const Tree>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+BENCHMARK_TEMPLATE(BM_FlatVectorTree, SumApplyPreOrder<const FlatNode>)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(20);
+
+// Visits the nodes of a FlatVectorTree in array order, which is pre-order.
+void BM_FlatVectorTreePreOrderNodes(benchmark::State &state) {
+  const FlatTree tree(MakeTree(DepthForFanout(state.range(0)), state.range(0)));
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto &node : tree.PreOrderNodes()) sum += node.Value();
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_FlatVectorTreePreOrderNodes)->Arg(2)->Arg(4)->Arg(20);
+
+}  // namespace
+}  // namespace verible
+
+BENCHMARK_MAIN();
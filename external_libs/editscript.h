@@ -61,6 +61,19 @@ struct Edit {
 };
 using Edits = std::vector<Edit>;
 
+/**
+ * Options that trade the minimality of the edit script for speed.
+ */
+struct DiffOptions {
+  /**
+   * Maximum number of edits (D in Myers' paper) explored when searching the
+   * middle snake of a span, or 0 for no limit.  Spans that need more are
+   * reported as entirely deleted and inserted: the result is still a valid,
+   * but not necessarily minimal, edit script.
+   */
+  int64_t max_cost = 0;
+};
+
 /**
  * Finds the differences between two vectors of tokens, returning edits
  * required to transform tokens1 into tokens2.
@@ -81,6 +94,15 @@ template <typename TokenIter>
 Edits GetTokenDiffs(TokenIter tokens1_begin, TokenIter tokens1_end,
                     TokenIter tokens2_begin, TokenIter tokens2_end);
 
+/**
+ * Same as above, with options.
+ * @param options Limits on the search, see DiffOptions.
+ */
+template <typename TokenIter>
+Edits GetTokenDiffs(TokenIter tokens1_begin, TokenIter tokens1_end,
+                    TokenIter tokens2_begin, TokenIter tokens2_end,
+                    const DiffOptions &options);
+
 //////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
 //////////////////////////////////////////////////////////////////////////////
@@ -180,7 +202,8 @@ template <typename TokenIter>
 class Diff {
  private:
   friend Edits GetTokenDiffs<>(TokenIter tokens1_begin, TokenIter tokens1_end,
-                               TokenIter tokens2_begin, TokenIter tokens2_end);
+                               TokenIter tokens2_begin, TokenIter tokens2_end,
+                               const DiffOptions &options);
 
   /**
    * Finds the differences between two vectors of tokens, returning edits
@@ -188,10 +211,13 @@ class Diff {
    * Every token in the combined document belongs to exactly one edit.
    * @param tokens1_begin Iterator pointing to start of tokens1.
    * @param tokens2_begin Iterator pointing to start of tokens2.
-   * @param edits Cumulative edits to transform tokens1 into tokens2 (inout).
+   * @param options Limits on the search.
    */
-  Diff(TokenIter tokens1_begin, TokenIter tokens2_begin)
-      : tokens1_begin_(tokens1_begin), tokens2_begin_(tokens2_begin) {}
+  Diff(TokenIter tokens1_begin, TokenIter tokens2_begin,
+       const DiffOptions &options)
+      : tokens1_begin_(tokens1_begin),
+        tokens2_begin_(tokens2_begin),
+        options_(options) {}
 
   /**
    * Find the differences between two vectors of tokens.
@@ -344,6 +370,10 @@ class Diff {
     const int64_t length1 = e1 - b1;
     const int64_t length2 = e2 - b2;
     const int64_t max_d = (length1 + length2 + 1) / 2;
+    // Giving up early reports no split points, like no commonality.
+    const int64_t d_limit = options_.max_cost > 0
+                                ? std::min(max_d, options_.max_cost)
+                                : max_d;
     const int64_t v_offset = max_d;
     const int64_t v_size = 2 * max_d;
     const int64_t w_size = 2 * v_size;
@@ -364,7 +394,7 @@ class Diff {
     int64_t k1end = 0;
     int64_t k2start = 0;
     int64_t k2end = 0;
-    for (int64_t d = 0; d < max_d; d++) {
+    for (int64_t d = 0; d < d_limit; d++) {
       // Walk the front path one step.
       for (int64_t k1 = -d + k1start; k1 <= d - k1end; k1 += 2) {
         const int64_t k1_offset = v_offset + k1;
@@ -465,7 +495,7 @@ class Diff {
       Generate(b1 + x1, e1, b2 + x2, e2, edits);
     } else {
       // No commonality at all (number of edits equals number of tokens),
-      // so just delete the old and insert the new.
+      // or too costly to find, so just delete the old and insert the new.
       AppendEdit(Operation::DELETE, b1, e1, edits);
       AppendEdit(Operation::INSERT, b2, e2, edits);
     }
@@ -474,14 +504,23 @@ class Diff {
  private:
   TokenIter tokens1_begin_;
   TokenIter tokens2_begin_;
+  const DiffOptions options_;
 };  // class Diff
 }  // namespace diff_impl
 
 template <typename TokenIter>
 inline Edits GetTokenDiffs(TokenIter tokens1_begin, TokenIter tokens1_end,
                            TokenIter tokens2_begin, TokenIter tokens2_end) {
+  return GetTokenDiffs(tokens1_begin, tokens1_end, tokens2_begin, tokens2_end,
+                       DiffOptions());
+}
+
+template <typename TokenIter>
+inline Edits GetTokenDiffs(TokenIter tokens1_begin, TokenIter tokens1_end,
+                           TokenIter tokens2_begin, TokenIter tokens2_end,
+                           const DiffOptions &options) {
   Edits token_edits;
-  diff_impl::Diff<TokenIter>(tokens1_begin, tokens2_begin)
+  diff_impl::Diff<TokenIter>(tokens1_begin, tokens2_begin, options)
       .Generate(0, std::distance(tokens1_begin, tokens1_end), 0,
                 std::distance(tokens2_begin, tokens2_end), &token_edits);
   return token_edits;  // efficient: uses named return value optimization
@@ -15,11 +15,13 @@
 #include "external_libs/editscript.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_join.h"
@@ -274,5 +276,59 @@ TEST(DiffTest, StrictSupersequence) {
   EXPECT_EQ(ToString(actual), ToString(expect));
 }
 
+// Returns the tokens1 and tokens2 that 'edits' transform, from 'tokens1' and
+// 'tokens2'.
+static std::pair<std::string, std::string> ApplyEdits(
+    const Edits &edits, absl::string_view tokens1, absl::string_view tokens2) {
+  std::pair<std::string, std::string> result;
+  for (const auto &edit : edits) {
+    const auto &tokens =
+        edit.operation == Operation::INSERT ? tokens2 : tokens1;
+    const absl::string_view range =
+        tokens.substr(edit.start, edit.end - edit.start);
+    if (edit.operation != Operation::INSERT) {
+      result.first.append(range.begin(), range.end());
+    }
+    if (edit.operation != Operation::DELETE) {
+      result.second.append(range.begin(), range.end());
+    }
+  }
+  return result;
+}
+
+static int64_t EditCost(const Edits &edits) {
+  int64_t cost = 0;
+  for (const auto &edit : edits) {
+    if (edit.operation != Operation::EQUALS) cost += edit.end - edit.start;
+  }
+  return cost;
+}
+
+TEST(DiffTest, MaxCost) {
+  const absl::string_view tokens1 = "the quick brown fox jumped over the dog";
+  const absl::string_view tokens2 = "a quick red fox jumps over the lazy cat";
+
+  const Edits minimal = GetTokenDiffs(tokens1.begin(), tokens1.end(),
+                                      tokens2.begin(), tokens2.end());
+  EXPECT_EQ(ApplyEdits(minimal, tokens1, tokens2),
+            std::make_pair(std::string(tokens1), std::string(tokens2)));
+
+  const int64_t minimal_cost = EditCost(minimal);
+  for (const int64_t max_cost : {20, 10, 5, 2, 1}) {
+    DiffOptions options;
+    options.max_cost = max_cost;
+    const Edits actual = GetTokenDiffs(tokens1.begin(), tokens1.end(),
+                                       tokens2.begin(), tokens2.end(), options);
+    // Still a valid edit script, but not necessarily minimal.
+    EXPECT_EQ(ApplyEdits(actual, tokens1, tokens2),
+              std::make_pair(std::string(tokens1), std::string(tokens2)))
+        << "max_cost: " << max_cost;
+    EXPECT_GE(EditCost(actual), minimal_cost) << "max_cost: " << max_cost;
+    if (max_cost == 1) {
+      EXPECT_GT(EditCost(actual), minimal_cost);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace diff
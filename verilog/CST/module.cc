@@ -14,21 +14,31 @@
 
 #include "verilog/CST/module.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "common/analysis/syntax_tree_search.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
+#include "common/text/syntax_tree_index.h"
 #include "common/text/token_info.h"
+#include "common/text/tree_compare.h"
+#include "common/text/tree_hash.h"
 #include "common/text/tree_utils.h"
 #include "common/util/logging.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
 #include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/parser/verilog_token_classifications.h"
+#include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 
+using verible::NodeTag;
 using verible::Symbol;
+using verible::SyntaxTreeIndex;
 using verible::SyntaxTreeNode;
 using verible::TokenInfo;
 
@@ -51,6 +61,77 @@ std::vector<verible::TreeSearchMatch> FindAllProgramDeclarations(
   return SearchSyntaxTree(root, NodekProgramDeclaration());
 }
 
+std::vector<verible::IndexedTreeSearchMatch> FindAllModuleDeclarations(
+    const SyntaxTreeIndex &index, const Symbol &root) {
+  return SearchIndexedSyntaxTree(
+      index, root, NodeTag(NodeEnum::kModuleDeclaration),
+      NodekModuleDeclaration());
+}
+
+std::vector<verible::IndexedTreeSearchMatch> FindAllModuleHeaders(
+    const SyntaxTreeIndex &index, const Symbol &root) {
+  return SearchIndexedSyntaxTree(index, root, NodeTag(NodeEnum::kModuleHeader),
+                                 NodekModuleHeader());
+}
+
+std::vector<verible::IndexedTreeSearchMatch> FindAllInterfaceDeclarations(
+    const SyntaxTreeIndex &index, const Symbol &root) {
+  return SearchIndexedSyntaxTree(
+      index, root, NodeTag(NodeEnum::kInterfaceDeclaration),
+      NodekInterfaceDeclaration());
+}
+
+std::vector<verible::IndexedTreeSearchMatch> FindAllProgramDeclarations(
+    const SyntaxTreeIndex &index, const Symbol &root) {
+  return SearchIndexedSyntaxTree(
+      index, root, NodeTag(NodeEnum::kProgramDeclaration),
+      NodekProgramDeclaration());
+}
+
+static bool IsIdentifierLikeToken(const TokenInfo &token) {
+  return IsIdentifierLike(verilog_tokentype(token.token_enum()));
+}
+
+std::vector<std::vector<const SyntaxTreeNode *>> GroupEqualModuleDeclarations(
+    const std::vector<const Symbol *> &roots, bool ignore_identifiers) {
+  verible::TreeHashOptions options;
+  verible::TokenComparator compare_tokens = verible::EqualByEnumString;
+  if (ignore_identifiers) {
+    options.ignore_text = IsIdentifierLikeToken;
+    compare_tokens = [](const TokenInfo &lhs, const TokenInfo &rhs) {
+      return lhs.token_enum() == rhs.token_enum() &&
+             (IsIdentifierLikeToken(lhs) || lhs.text() == rhs.text());
+    };
+  }
+
+  std::vector<std::vector<const SyntaxTreeNode *>> groups;
+  // Indices of the groups with the same hash, which are only candidates
+  // until their trees are compared.
+  absl::flat_hash_map<size_t, std::vector<size_t>> groups_by_hash;
+  for (const Symbol *root : roots) {
+    verible::HashSubtrees(
+        root, options, [&](const SyntaxTreeNode &node, size_t hash) {
+          if (node.Tag() != NodeTag(NodeEnum::kModuleDeclaration)) return;
+          std::vector<size_t> &candidates = groups_by_hash[hash];
+          for (const size_t group : candidates) {
+            if (verible::EqualTrees(groups[group].front(), &node,
+                                    compare_tokens)) {
+              groups[group].push_back(&node);
+              return;
+            }
+          }
+          candidates.push_back(groups.size());
+          groups.push_back({&node});
+        });
+  }
+  groups.erase(std::remove_if(groups.begin(), groups.end(),
+                              [](const std::vector<const SyntaxTreeNode *> &g) {
+                                return g.size() < 2;
+                              }),
+               groups.end());
+  return groups;
+}
+
 bool IsModuleOrInterfaceOrProgramDeclaration(
     const SyntaxTreeNode &declaration) {
   return declaration.MatchesTagAnyOf({NodeEnum::kModuleDeclaration,
@@ -24,6 +24,7 @@
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
+#include "common/text/syntax_tree_index.h"
 #include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
 #include "verilog/CST/verilog_nonterminals.h"
@@ -69,6 +70,28 @@ std::vector<verible::TreeSearchMatch> FindAllInterfaceDeclarations(
 std::vector<verible::TreeSearchMatch> FindAllProgramDeclarations(
     const verible::Symbol &root);
 
+// Like the above, but look up the declarations under 'root' in 'index', e.g.
+// TextStructureView::GetSyntaxTreeIndex(), instead of walking the tree.
+std::vector<verible::IndexedTreeSearchMatch> FindAllModuleDeclarations(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root);
+std::vector<verible::IndexedTreeSearchMatch> FindAllModuleHeaders(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root);
+std::vector<verible::IndexedTreeSearchMatch> FindAllInterfaceDeclarations(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root);
+std::vector<verible::IndexedTreeSearchMatch> FindAllProgramDeclarations(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root);
+
+// Groups the module declarations under all 'roots' (e.g. of several files)
+// that are equal trees, token enums and texts included, found by their
+// verible::HashTree() in one pass over each tree.  With 'ignore_identifiers',
+// identifier-like tokens are only compared by their enum, so that modules
+// which only differ in names are grouped too.  Analyses of one module of a
+// group, like lint results, then apply to the other ones.
+// Only returns groups of more than one module.
+std::vector<std::vector<const verible::SyntaxTreeNode *>>
+GroupEqualModuleDeclarations(const std::vector<const verible::Symbol *> &roots,
+                             bool ignore_identifiers);
+
 // Returns the full header of a module (params, ports, etc...).
 // Works also with interfaces and programs.
 const verible::SyntaxTreeNode *GetModuleHeader(const verible::Symbol &);
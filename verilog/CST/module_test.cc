@@ -27,6 +27,7 @@
 
 #include "common/analysis/syntax_tree_search.h"
 #include "common/analysis/syntax_tree_search_test_utils.h"
+#include "common/text/symbol.h"
 #include "common/text/text_structure.h"
 #include "common/util/logging.h"
 #include "gtest/gtest.h"
@@ -483,5 +484,43 @@ TEST(FindAllModuleHeadersTest, ClassNoMatch) {
   EXPECT_TRUE(module_headers.empty());
 }
 
+TEST(GroupEqualModuleDeclarationsTest, AcrossFiles) {
+  VerilogAnalyzer analyzer1(R"(
+module slice_a(input i, output o); assign o = i; endmodule
+module other; endmodule
+module slice_b(input i, output o); assign o = i; endmodule
+)",
+                            "");
+  VerilogAnalyzer analyzer2(R"(
+module slice_a(input i, output o); assign o = i; endmodule
+module slice_c(input i, output o); assign o = ~i; endmodule
+)",
+                            "");
+  ASSERT_OK(analyzer1.Analyze());
+  ASSERT_OK(analyzer2.Analyze());
+  const std::vector<const verible::Symbol *> roots{
+      analyzer1.Data().SyntaxTree().get(), analyzer2.Data().SyntaxTree().get()};
+  const auto modules1 = FindAllModuleDeclarations(*roots[0]);
+  const auto modules2 = FindAllModuleDeclarations(*roots[1]);
+  ASSERT_EQ(modules1.size(), 3);
+  ASSERT_EQ(modules2.size(), 2);
+
+  {  // Exact copies only.
+    const auto groups = GroupEqualModuleDeclarations(roots, false);
+    ASSERT_EQ(groups.size(), 1);
+    ASSERT_EQ(groups[0].size(), 2);
+    EXPECT_EQ(groups[0][0], modules1[0].match);
+    EXPECT_EQ(groups[0][1], modules2[0].match);
+  }
+  {  // Also modules that only differ in names.
+    const auto groups = GroupEqualModuleDeclarations(roots, true);
+    ASSERT_EQ(groups.size(), 1);
+    ASSERT_EQ(groups[0].size(), 3);
+    EXPECT_EQ(groups[0][0], modules1[0].match);
+    EXPECT_EQ(groups[0][1], modules1[2].match);
+    EXPECT_EQ(groups[0][2], modules2[0].match);
+  }
+}
+
 }  // namespace
 }  // namespace verilog
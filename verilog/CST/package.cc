@@ -20,6 +20,7 @@
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
+#include "common/text/syntax_tree_index.h"
 #include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
@@ -33,6 +34,13 @@ std::vector<verible::TreeSearchMatch> FindAllPackageDeclarations(
   return SearchSyntaxTree(root, NodekPackageDeclaration());
 }
 
+std::vector<verible::IndexedTreeSearchMatch> FindAllPackageDeclarations(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root) {
+  return SearchIndexedSyntaxTree(
+      index, root, verible::NodeTag(NodeEnum::kPackageDeclaration),
+      NodekPackageDeclaration());
+}
+
 std::vector<verible::TreeSearchMatch> FindAllPackageImportItems(
     const verible::Symbol &root) {
   return SearchSyntaxTree(root, NodekPackageImportItem());
@@ -24,6 +24,7 @@
 #include "common/text/concrete_syntax_leaf.h"  // IWYU pragma: export
 #include "common/text/concrete_syntax_tree.h"  // IWYU pragma: export
 #include "common/text/symbol.h"                // IWYU pragma: export
+#include "common/text/syntax_tree_index.h"
 #include "common/text/token_info.h"
 
 namespace verilog {
@@ -32,6 +33,11 @@ namespace verilog {
 std::vector<verible::TreeSearchMatch> FindAllPackageDeclarations(
     const verible::Symbol &);
 
+// Like the above, but look up the declarations under 'root' in 'index', e.g.
+// TextStructureView::GetSyntaxTreeIndex(), instead of walking the tree.
+std::vector<verible::IndexedTreeSearchMatch> FindAllPackageDeclarations(
+    const verible::SyntaxTreeIndex &index, const verible::Symbol &root);
+
 // Find all package imports items.
 std::vector<verible::TreeSearchMatch> FindAllPackageImportItems(
     const verible::Symbol &root);
@@ -15,14 +15,18 @@
 #include "verilog/CST/verilog_tree_json.h"
 
 #include <ostream>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/token_info.h"
 #include "common/text/token_info_json.h"
+#include "common/text/tree_context_visitor.h"
 #include "common/text/visitors.h"
 #include "common/util/value_saver.h"
 #include "nlohmann/json.hpp"
@@ -40,8 +44,13 @@ class VerilogTreeToJsonConverter : public verible::SymbolVisitor {
   explicit VerilogTreeToJsonConverter(absl::string_view base);
 
   void Visit(const verible::SyntaxTreeLeaf &) final;
+  // Converts the subtree with WalkTree(), so that deep trees don't recurse.
   void Visit(const verible::SyntaxTreeNode &) final;
 
+  bool EnterNode(const verible::SyntaxTreeNode &) final;
+  void EnterChild(int rank, const verible::Symbol *child) final;
+  void LeaveNode(const verible::SyntaxTreeNode &) final;
+
   json TakeJsonValue() { return std::move(json_); }
 
  protected:
@@ -54,6 +63,9 @@ class VerilogTreeToJsonConverter : public verible::SymbolVisitor {
   // Pointer to JSON value of currently visited symbol in its parent's
   // children list.
   json *value_;
+
+  // Children lists of the nodes being converted, innermost last.
+  std::vector<json *> children_stack_;
 };
 
 VerilogTreeToJsonConverter::VerilogTreeToJsonConverter(absl::string_view base)
@@ -78,19 +90,28 @@ void VerilogTreeToJsonConverter::Visit(const verible::SyntaxTreeLeaf &leaf) {
 }
 
 void VerilogTreeToJsonConverter::Visit(const verible::SyntaxTreeNode &node) {
+  const verible::ValueSaver<json *> value_saver(&value_, value_);
+  verible::WalkTree(node, this);
+}
+
+bool VerilogTreeToJsonConverter::EnterNode(
+    const verible::SyntaxTreeNode &node) {
   *value_ = json::object();
   (*value_)["tag"] = NodeEnumToString(static_cast<NodeEnum>(node.Tag().tag));
-  json &children = (*value_)["children"] = json::array();
-
-  {
-    const verible::ValueSaver<json *> value_saver(&value_, nullptr);
-    for (const auto &child : node.children()) {
-      value_ = &children.emplace_back(nullptr);
-      // nullptrs from children list are intentionally preserved in JSON as
-      // `null` values.
-      if (child) child->Accept(this);
-    }
-  }
+  children_stack_.push_back(&((*value_)["children"] = json::array()));
+  return true;
+}
+
+void VerilogTreeToJsonConverter::EnterChild(int rank,
+                                            const verible::Symbol *child) {
+  // nullptrs from children list are intentionally preserved in JSON as
+  // `null` values.
+  value_ = &children_stack_.back()->emplace_back(nullptr);
+}
+
+void VerilogTreeToJsonConverter::LeaveNode(
+    const verible::SyntaxTreeNode &node) {
+  children_stack_.pop_back();
 }
 
 json ConvertVerilogTreeToJson(const verible::Symbol &root,
@@ -100,4 +121,74 @@ json ConvertVerilogTreeToJson(const verible::Symbol &root,
   return converter.TakeJsonValue();
 }
 
+namespace {
+class CompactVerilogTreeJsonWriter : public verible::SymbolVisitor {
+ public:
+  CompactVerilogTreeJsonWriter(absl::string_view base, std::string *out,
+                               CompactJsonTags *tags)
+      : base_(base), out_(*out), tags_(*tags) {}
+
+  void Visit(const verible::SyntaxTreeLeaf &leaf) final {
+    tags_.tokens.insert(leaf.Tag().tag);
+    verible::AppendCompactJson(leaf.get(), base_, &out_);
+  }
+
+  void Visit(const verible::SyntaxTreeNode &node) final {
+    verible::WalkTree(node, this);
+  }
+
+  bool EnterNode(const verible::SyntaxTreeNode &node) final {
+    tags_.nodes.insert(node.Tag().tag);
+    absl::StrAppend(&out_, "{\"tag\":", node.Tag().tag, ",\"children\":[");
+    return true;
+  }
+
+  void EnterChild(int rank, const verible::Symbol *child) final {
+    if (rank > 0) out_.push_back(',');
+    if (child == nullptr) out_.append("null");
+  }
+
+  void LeaveNode(const verible::SyntaxTreeNode &node) final {
+    out_.append("]}");
+  }
+
+ private:
+  const absl::string_view base_;
+  std::string &out_;
+  CompactJsonTags &tags_;
+};
+
+// Appends the members "<tag>":"<name>" of a legend table.
+template <typename Namer>
+void AppendLegendTable(const std::set<int> &tags, const Namer &name,
+                       std::string *out) {
+  out->push_back('{');
+  for (const int tag : tags) {
+    if (out->back() != '{') out->push_back(',');
+    absl::StrAppend(out, "\"", tag, "\":", json(name(tag)).dump());
+  }
+  out->push_back('}');
+}
+}  // namespace
+
+void AppendCompactVerilogTreeJson(const verible::Symbol &root,
+                                  absl::string_view base, std::string *out,
+                                  CompactJsonTags *tags) {
+  CompactVerilogTreeJsonWriter writer(base, out, tags);
+  root.Accept(&writer);
+}
+
+void AppendCompactJsonLegend(const CompactJsonTags &tags, std::string *out) {
+  out->append("{\"nodes\":");
+  AppendLegendTable(
+      tags.nodes,
+      [](int tag) { return NodeEnumToString(static_cast<NodeEnum>(tag)); },
+      out);
+  out->append(",\"tokens\":");
+  AppendLegendTable(
+      tags.tokens,
+      [](int tag) { return std::string(TokenTypeToString(tag)); }, out);
+  out->push_back('}');
+}
+
 }  // namespace verilog
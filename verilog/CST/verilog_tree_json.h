@@ -15,6 +15,9 @@
 #ifndef VERIBLE_VERILOG_CST_VERILOG_TREE_JSON_H_
 #define VERIBLE_VERILOG_CST_VERILOG_TREE_JSON_H_
 
+#include <set>
+#include <string>
+
 #include "absl/strings/string_view.h"
 #include "common/text/symbol.h"
 #include "nlohmann/json.hpp"
@@ -25,6 +28,26 @@ namespace verilog {
 nlohmann::json ConvertVerilogTreeToJson(const verible::Symbol &root,
                                         absl::string_view base);
 
+// Numeric tags written in the compact JSON schema, to be named in its legend.
+struct CompactJsonTags {
+  std::set<int> nodes;   // NodeEnum
+  std::set<int> tokens;  // verilog_tokentype
+};
+
+// Appends the compact JSON representation of tree contained at root to
+// "out", writing the text directly instead of building a JSON value.  Nodes
+// are {"tag":<NodeEnum>,"children":[...]}, with absent children as null,
+// and leaves are [<token enum>,<start>,<end>] (see AppendCompactJson()),
+// without their text.  Records the tags used in "tags".
+void AppendCompactVerilogTreeJson(const verible::Symbol &root,
+                                  absl::string_view base, std::string *out,
+                                  CompactJsonTags *tags);
+
+// Appends the legend of the compact JSON schema for "tags":
+// {"nodes":{"<tag>":"<name>",...},"tokens":{"<tag>":"<name>",...}}, using the
+// names of the full schema.
+void AppendCompactJsonLegend(const CompactJsonTags &tags, std::string *out);
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_CST_VERILOG_TREE_JSON_H_
@@ -15,6 +15,7 @@
 #include "verilog/CST/verilog_tree_json.h"
 
 #include <memory>
+#include <string>
 
 #include "common/text/symbol.h"
 #include "common/util/logging.h"
@@ -67,5 +68,57 @@ TEST(VerilogTreeJsonTest, GeneratesGoodJsonTree) {
   EXPECT_EQ(tree_json, expected_json);
 }
 
+TEST(VerilogTreeJsonTest, GeneratesCompactJsonTreeAndLegend) {
+  const auto analyzer_ptr = std::make_unique<VerilogAnalyzer>(
+      "module foo;\nendmodule\n", "fake_file.sv");
+  const auto status = ABSL_DIE_IF_NULL(analyzer_ptr)->Analyze();
+  EXPECT_TRUE(status.ok()) << status.message();
+  const verible::SymbolPtr &tree_ptr = analyzer_ptr->SyntaxTree();
+  ASSERT_NE(tree_ptr, nullptr);
+
+  std::string tree_text;
+  CompactJsonTags tags;
+  AppendCompactVerilogTreeJson(*tree_ptr, analyzer_ptr->Data().Contents(),
+                               &tree_text, &tags);
+  std::string legend_text;
+  AppendCompactJsonLegend(tags, &legend_text);
+  const json tree_json = json::parse(tree_text);
+  const json legend = json::parse(legend_text);
+
+  // Names the tags through the legend, to compare with the full schema.
+  const auto node_name = [&legend](const json &node) {
+    return legend["nodes"][std::to_string(node["tag"].get<int>())];
+  };
+  const auto token_name = [&legend](const json &leaf) {
+    return legend["tokens"][std::to_string(leaf[0].get<int>())];
+  };
+
+  EXPECT_EQ(node_name(tree_json), "kDescriptionList");
+  const json &module = tree_json["children"][0];
+  EXPECT_EQ(node_name(module), "kModuleDeclaration");
+  ASSERT_EQ(module["children"].size(), 4);
+  EXPECT_EQ(module["children"][3], nullptr);
+
+  const json &header = module["children"][0];
+  EXPECT_EQ(node_name(header), "kModuleHeader");
+  ASSERT_EQ(header["children"].size(), 8);
+  EXPECT_EQ(token_name(header["children"][0]), "module");
+  EXPECT_EQ(header["children"][0][1], 0);
+  EXPECT_EQ(header["children"][0][2], 6);
+  EXPECT_EQ(header["children"][1], nullptr);
+  EXPECT_EQ(token_name(header["children"][2]), "SymbolIdentifier");
+  EXPECT_EQ(header["children"][2][1], 7);
+  EXPECT_EQ(header["children"][2][2], 10);
+  EXPECT_EQ(token_name(header["children"][7]), ";");
+
+  EXPECT_EQ(node_name(module["children"][1]), "kModuleItemList");
+  EXPECT_EQ(module["children"][1]["children"], json::array());
+  EXPECT_EQ(token_name(module["children"][2]), "endmodule");
+
+  // Only the tags used are in the legend.
+  EXPECT_EQ(legend["nodes"].size(), 4);
+  EXPECT_EQ(legend["tokens"].size(), 4);
+}
+
 }  // namespace
 }  // namespace verilog
@@ -27,7 +27,6 @@
 #include "common/text/symbol.h"
 #include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
-#include "common/util/value_saver.h"
 #include "verilog/CST/verilog_nonterminals.h"  // for NodeEnumToString
 #include "verilog/parser/verilog_parser.h"     // for verilog_symbol_name
 
@@ -46,23 +45,14 @@ void VerilogPrettyPrinter::Visit(const verible::SyntaxTreeLeaf &leaf) {
                 << verible::TokenWithContext{leaf.get(), context_} << std::endl;
 }
 
-void VerilogPrettyPrinter::Visit(const verible::SyntaxTreeNode &node) {
+bool VerilogPrettyPrinter::EnterNode(const verible::SyntaxTreeNode &node) {
   std::string tag_info = absl::StrCat(
       "(tag: ", NodeEnumToString(static_cast<NodeEnum>(node.Tag().tag)), ") ");
 
   auto_indent() << "Node @" << child_rank_ << ' ' << tag_info << "{"
                 << std::endl;
-
-  {
-    const verible::ValueSaver<int> value_saver(&indent_, indent_ + 2);
-    const verible::ValueSaver<int> rank_saver(&child_rank_, 0);
-    for (const auto &child : node.children()) {
-      // TODO(fangism): display nullptrs or child indices to show position.
-      if (child) child->Accept(this);
-      ++child_rank_;
-    }
-  }
-  auto_indent() << "}" << std::endl;
+  indent_ += 2;
+  return true;
 }
 
 void PrettyPrintVerilogTree(const verible::Symbol &root, absl::string_view base,
@@ -33,9 +33,7 @@ class VerilogPrettyPrinter : public verible::PrettyPrinter {
                                 absl::string_view base);
 
   void Visit(const verible::SyntaxTreeLeaf &) final;
-  void Visit(const verible::SyntaxTreeNode &) final;
-
-  // void Visit(verible::SyntaxTreeNode*) final;
+  bool EnterNode(const verible::SyntaxTreeNode &) final;
 };
 
 // Prints tree contained at root to stream
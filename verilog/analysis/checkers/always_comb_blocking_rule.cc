@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -58,6 +59,7 @@ const LintRuleDescriptor &AlwaysCombBlockingRule::GetDescriptor() {
       .desc =
           "Checks that there are no occurrences of "
           "non-blocking assignment in combinational logic.",
+      .item_local = true,
   };
   return d;
 }
@@ -68,6 +70,11 @@ static const Matcher &AlwaysCombMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+AlwaysCombBlockingRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kAlwaysStatement)};
+}
+
 void AlwaysCombBlockingRule::HandleSymbol(const verible::Symbol &symbol,
                                           const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -98,5 +105,10 @@ LintRuleStatus AlwaysCombBlockingRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool AlwaysCombBlockingRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
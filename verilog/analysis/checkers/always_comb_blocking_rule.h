@@ -16,6 +16,7 @@
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_ALWAYS_COMB_BLOCKING_RULE_H_
 
 #include <set>
+#include <vector>
 
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
@@ -32,11 +33,15 @@ class AlwaysCombBlockingRule : public verible::SyntaxTreeLintRule {
 
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   std::set<verible::LintViolation> violations_;
 };
@@ -29,6 +29,7 @@
 #include "common/text/tree_utils.h"
 #include "verilog/CST/statement.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -54,6 +55,7 @@ const LintRuleDescriptor &AlwaysCombRule::GetDescriptor() {
       .desc =
           "Checks that there are no occurrences of "
           "`always @*`. Use `always_comb` instead.",
+      .item_local = true,
   };
   return d;
 }
@@ -75,6 +77,10 @@ static const Matcher &AlwaysStarMatcherWithParentheses() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag> AlwaysCombRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kAlwaysStatement)};
+}
+
 void AlwaysCombRule::HandleSymbol(const verible::Symbol &symbol,
                                   const SyntaxTreeContext &context) {
   // Check for offending use of always @*
@@ -122,5 +128,10 @@ LintRuleStatus AlwaysCombRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool AlwaysCombRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
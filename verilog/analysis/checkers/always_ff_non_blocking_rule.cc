@@ -34,6 +34,7 @@
 #include "verilog/CST/verilog_matchers.h"
 #include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -62,6 +63,7 @@ const LintRuleDescriptor &AlwaysFFNonBlockingRule::GetDescriptor() {
           "locals in sequential logic.",
       .param = {{"catch_modifying_assignments", "false"},
                 {"waive_for_locals", "false"}},
+      .item_local = true,
   };
   return d;
 }
@@ -70,6 +72,15 @@ LintRuleStatus AlwaysFFNonBlockingRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool AlwaysFFNonBlockingRule::Reset() {
+  violations_.clear();
+  inside_ = 0;
+  scopes_ = {};
+  scopes_.push({-1, 0});
+  locals_.clear();
+  return true;
+}
+
 //- Configuration -----------------------------------------------------------
 absl::Status AlwaysFFNonBlockingRule::Configure(
     const absl::string_view configuration) {
@@ -97,9 +108,12 @@ void AlwaysFFNonBlockingRule::HandleSymbol(const verible::Symbol &symbol,
   if (context.IsInside(NodeEnum::kLoopHeader)) return;
 
   //- Check for blocking assignments of various kinds -----------------------
-  static const Matcher asgn_blocking_matcher{NodekNetVariableAssignment()};
-  static const Matcher asgn_modify_matcher{NodekAssignModifyStatement()};
-  static const Matcher asgn_incdec_matcher{NodekIncrementDecrementExpression()};
+  static constexpr auto asgn_blocking_matcher =
+      NodekNetVariableAssignment.Inline();
+  static constexpr auto asgn_modify_matcher =
+      NodekAssignModifyStatement.Inline();
+  static constexpr auto asgn_incdec_matcher =
+      NodekIncrementDecrementExpression.Inline();
   static const Matcher ident_matcher{NodekUnqualifiedId()};
 
   // Rule may be waived if complete lhs consists of local variables
@@ -138,7 +152,14 @@ void AlwaysFFNonBlockingRule::HandleSymbol(const verible::Symbol &symbol,
   bool waived = false;
   if (waive_for_locals_ && check_root) {
     waived = true;
-    for (const auto &var : SearchSyntaxTree(*check_root, ident_matcher)) {
+    const LintFileFacts *facts = LintFileFacts::Find(symbol, context);
+    const auto vars =
+        facts != nullptr
+            ? SearchSyntaxTree(facts->Index(), *check_root,
+                               verible::NodeTag(NodeEnum::kUnqualifiedId),
+                               ident_matcher)
+            : SearchSyntaxTree(*check_root, ident_matcher);
+    for (const auto &var : vars) {
       if (var.context.IsInside(NodeEnum::kDimensionScalar)) continue;
       if (var.context.IsInside(NodeEnum::kDimensionSlice)) continue;
       if (var.context.IsInside(NodeEnum::kHierarchyExtension)) continue;
@@ -165,9 +186,9 @@ void AlwaysFFNonBlockingRule::HandleSymbol(const verible::Symbol &symbol,
 
 bool AlwaysFFNonBlockingRule::InsideBlock(const verible::Symbol &symbol,
                                           const int depth) {
-  static const Matcher always_ff_matcher{
-      NodekAlwaysStatement(AlwaysFFKeyword())};
-  static const Matcher block_matcher{NodekBlockItemStatementList()};
+  static constexpr auto always_ff_matcher =
+      NodekAlwaysStatement.Inline(AlwaysFFKeyword.Inline());
+  static constexpr auto block_matcher = NodekBlockItemStatementList.Inline();
 
   // Discard state from branches already left
   if (depth <= inside_) inside_ = 0;
@@ -203,7 +224,7 @@ bool AlwaysFFNonBlockingRule::InsideBlock(const verible::Symbol &symbol,
 }  // InsideBlock()
 
 bool AlwaysFFNonBlockingRule::LocalDeclaration(const verible::Symbol &symbol) {
-  static const Matcher decl_matcher{NodekDataDeclaration()};
+  static constexpr auto decl_matcher = NodekDataDeclaration.Inline();
   static const Matcher var_matcher{NodekRegisterVariable()};
 
   verible::matcher::BoundSymbolManager symbol_man;
@@ -43,6 +43,8 @@ class AlwaysFFNonBlockingRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Detects entering and leaving relevant code inside always_ff
   bool InsideBlock(const verible::Symbol &symbol, int depth);
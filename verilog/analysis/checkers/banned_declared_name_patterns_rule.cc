@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/banned_declared_name_patterns_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
@@ -50,6 +51,12 @@ const LintRuleDescriptor &BannedDeclaredNamePatternsRule::GetDescriptor() {
   return d;
 }
 
+std::vector<verible::SymbolTag>
+BannedDeclaredNamePatternsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kModuleDeclaration),
+          verible::NodeTag(NodeEnum::kPackageDeclaration)};
+}
+
 void BannedDeclaredNamePatternsRule::HandleNode(
     const verible::SyntaxTreeNode &node,
     const verible::SyntaxTreeContext &context) {
@@ -85,5 +92,10 @@ LintRuleStatus BannedDeclaredNamePatternsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool BannedDeclaredNamePatternsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -16,10 +16,12 @@
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_BANNED_DECLARED_NAME_PATTERNS_RULE_H_
 
 #include <set>
+#include <vector>
 
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
 #include "verilog/analysis/descriptions.h"
@@ -34,11 +36,15 @@ class BannedDeclaredNamePatternsRule : public verible::SyntaxTreeLintRule {
 
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleNode(const verible::SyntaxTreeNode &node,
                   const verible::SyntaxTreeContext &context) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   std::set<verible::LintViolation> violations_;
 };
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/case_missing_default_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -51,10 +52,16 @@ const LintRuleDescriptor &CaseMissingDefaultRule::GetDescriptor() {
       .desc =
           "Checks that a default case-item is always defined unless the case "
           "statement has the `unique` qualifier.",
+      .item_local = true,
   };
   return d;
 }
 
+std::vector<verible::SymbolTag>
+CaseMissingDefaultRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kCaseStatement)};
+}
+
 void CaseMissingDefaultRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -82,5 +89,10 @@ LintRuleStatus CaseMissingDefaultRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool CaseMissingDefaultRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -16,6 +16,7 @@
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_CASE_MISSING_DEFAULT_RULE_H_
 
 #include <set>
+#include <vector>
 
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
@@ -34,11 +35,15 @@ class CaseMissingDefaultRule : public verible::SyntaxTreeLintRule {
 
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   std::set<verible::LintViolation> violations_;
 };
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/constraint_name_style_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
@@ -27,6 +28,7 @@
 #include "common/text/token_info.h"
 #include "verilog/CST/constraints.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -60,6 +62,11 @@ static const Matcher& ConstraintMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ConstraintNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kConstraintDeclaration)};
+}
+
 void ConstraintNameStyleRule::HandleSymbol(const verible::Symbol& symbol,
                                            const SyntaxTreeContext& context) {
   verible::matcher::BoundSymbolManager manager;
@@ -89,5 +96,10 @@ LintRuleStatus ConstraintNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ConstraintNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -18,6 +18,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -59,6 +60,7 @@ const LintRuleDescriptor &CreateObjectNameMatchRule::GetDescriptor() {
       .desc =
           "Checks that the 'name' argument of `type_id::create()` "
           "matches the name of the variable to which it is assigned.",
+      .item_local = true,
   };
   return d;
 }
@@ -175,6 +177,11 @@ static std::string FormatReason(absl::string_view decl_name,
       decl_name, ", got: ", name_text, ". ");
 }
 
+std::vector<verible::SymbolTag>
+CreateObjectNameMatchRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kNetVariableAssignment)};
+}
+
 void CreateObjectNameMatchRule::HandleSymbol(const verible::Symbol &symbol,
                                              const SyntaxTreeContext &context) {
   // Check for assignments that match the pattern.
@@ -211,5 +218,10 @@ LintRuleStatus CreateObjectNameMatchRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool CreateObjectNameMatchRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
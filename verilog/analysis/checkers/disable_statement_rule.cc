@@ -16,6 +16,7 @@
 
 #include <iterator>
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -56,6 +57,7 @@ const LintRuleDescriptor &DisableStatementNoLabelsRule::GetDescriptor() {
           "Checks that there are no occurrences of `disable some_label` "
           "if label is referring to a fork or other none sequential block "
           "label. Use `disable fork` instead.",
+      .item_local = true,
   };
   return d;
 }
@@ -66,6 +68,11 @@ static const Matcher &DisableMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+DisableStatementNoLabelsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kDisableStatement)};
+}
+
 void DisableStatementNoLabelsRule::HandleSymbol(
     const verible::Symbol &symbol, const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -120,5 +127,11 @@ void DisableStatementNoLabelsRule::HandleSymbol(
 LintRuleStatus DisableStatementNoLabelsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
+
+bool DisableStatementNoLabelsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
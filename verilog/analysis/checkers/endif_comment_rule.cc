@@ -160,5 +160,13 @@ LintRuleStatus EndifCommentRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool EndifCommentRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  last_endif_ = verible::TokenInfo::EOFToken();
+  conditional_scopes_ = {};
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -55,6 +55,8 @@ class EndifCommentRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // States of the internal token-based analysis.
   enum class State {
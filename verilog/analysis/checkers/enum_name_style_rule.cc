@@ -17,6 +17,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -31,7 +32,9 @@
 #include "re2/re2.h"
 #include "verilog/CST/type.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -77,16 +80,24 @@ std::string EnumNameStyleRule::CreateViolationMessage() {
                       "defined by regex pattern: ", style_regex_->pattern());
 }
 
+std::vector<verible::SymbolTag> EnumNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kTypeDeclaration)};
+}
+
 void EnumNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
                                      const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
   if (TypedefMatcher().Matches(symbol, &manager)) {
     // TODO: This can be changed to checking type of child (by index) when we
     // have consistent shape for all kTypeDeclaration nodes.
-    if (!FindAllEnumTypes(symbol).empty()) {
+    const LintFileFacts *facts = LintFileFacts::Find(symbol, context);
+    const bool is_enum = facts != nullptr
+                             ? facts->TypesDefinedIn(symbol).enum_type
+                             : !FindAllEnumTypes(symbol).empty();
+    if (is_enum) {
       const auto *identifier_leaf = GetIdentifierFromTypeDeclaration(symbol);
       const auto name = ABSL_DIE_IF_NULL(identifier_leaf)->get().text();
-      if (!RE2::FullMatch(name, *style_regex_)) {
+      if (!style_checker_.Matches(name, 0)) {
         violations_.insert(LintViolation(identifier_leaf->get(),
                                          CreateViolationMessage(), context));
       }
@@ -108,5 +119,10 @@ LintRuleStatus EnumNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool EnumNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -18,10 +18,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
+#include "common/analysis/name_style_checker.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
@@ -43,11 +45,15 @@ class EnumNameStyleRule : public verible::SyntaxTreeLintRule {
 
   std::string CreateViolationMessage();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(absl::string_view configuration) final;
 
  private:
@@ -55,6 +61,9 @@ class EnumNameStyleRule : public verible::SyntaxTreeLintRule {
 
   // A regex to check the style against
   std::unique_ptr<re2::RE2> style_regex_;
+
+  // Checks names against style_regex_.
+  verible::NameStyleChecker style_checker_{{&style_regex_}};
 };
 
 }  // namespace analysis
@@ -369,5 +369,14 @@ LintRuleStatus ExplicitBeginRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ExplicitBeginRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  condition_expr_level_ = 0;
+  constraint_expr_level_ = 0;
+  start_token_ = verible::TokenInfo::EOFToken();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
\ No newline at end of file
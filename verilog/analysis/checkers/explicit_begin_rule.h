@@ -43,6 +43,8 @@ class ExplicitBeginRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   bool HandleTokenStateMachine(const TokenInfo &token);
 
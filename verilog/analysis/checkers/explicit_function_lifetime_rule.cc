@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/explicit_function_lifetime_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -29,6 +30,7 @@
 #include "verilog/CST/functions.h"
 #include "verilog/CST/identifier.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -54,6 +56,7 @@ const LintRuleDescriptor &ExplicitFunctionLifetimeRule::GetDescriptor() {
       .desc =
           "Checks that every function declared outside of a class is "
           "declared with an explicit lifetime (static or automatic).",
+      .item_local = true,
   };
   return d;
 }
@@ -63,6 +66,11 @@ static const Matcher &FunctionMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ExplicitFunctionLifetimeRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kFunctionDeclaration)};
+}
+
 void ExplicitFunctionLifetimeRule::HandleSymbol(
     const verible::Symbol &symbol, const SyntaxTreeContext &context) {
   // Don't need to check for lifetime declaration if context is inside a class
@@ -89,5 +97,10 @@ LintRuleStatus ExplicitFunctionLifetimeRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ExplicitFunctionLifetimeRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
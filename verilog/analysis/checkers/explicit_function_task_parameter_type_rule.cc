@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/explicit_function_task_parameter_type_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -26,6 +27,7 @@
 #include "verilog/CST/port.h"
 #include "verilog/CST/type.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -51,6 +53,7 @@ ExplicitFunctionTaskParameterTypeRule::GetDescriptor() {
       .desc =
           "Checks that every function and task parameter is declared "
           "with an explicit storage type.",
+      .item_local = true,
   };
   return d;
 }
@@ -60,6 +63,11 @@ static const Matcher &PortMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ExplicitFunctionTaskParameterTypeRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kPortItem)};
+}
+
 void ExplicitFunctionTaskParameterTypeRule::HandleSymbol(
     const verible::Symbol &symbol, const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -76,5 +84,10 @@ LintRuleStatus ExplicitFunctionTaskParameterTypeRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ExplicitFunctionTaskParameterTypeRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
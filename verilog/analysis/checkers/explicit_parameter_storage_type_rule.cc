@@ -32,6 +32,7 @@
 #include "common/util/logging.h"
 #include "verilog/CST/parameters.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -58,6 +59,7 @@ const LintRuleDescriptor &ExplicitParameterStorageTypeRule::GetDescriptor() {
           "Checks that every `parameter` and `localparam` "
           "is declared with an explicit storage type.",
       .param = {{"exempt_type", "", "Set to `string` to exempt string types"}},
+      .item_local = true,
   };
   return d;
 }
@@ -78,6 +80,11 @@ static bool HasStringAssignment(const verible::Symbol &param_decl) {
          verilog_tokentype::TK_StringLiteral;
 }
 
+std::vector<verible::SymbolTag>
+ExplicitParameterStorageTypeRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kParamDeclaration)};
+}
+
 void ExplicitParameterStorageTypeRule::HandleSymbol(
     const verible::Symbol &symbol, const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -114,5 +121,10 @@ LintRuleStatus ExplicitParameterStorageTypeRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ExplicitParameterStorageTypeRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/explicit_task_lifetime_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -28,6 +29,7 @@
 #include "verilog/CST/identifier.h"
 #include "verilog/CST/tasks.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -53,6 +55,7 @@ const LintRuleDescriptor &ExplicitTaskLifetimeRule::GetDescriptor() {
       .desc =
           "Checks that every task declared outside of a class is declared "
           "with an explicit lifetime (static or automatic).",
+      .item_local = true,
   };
   return d;
 }
@@ -62,6 +65,11 @@ static const Matcher &TaskMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ExplicitTaskLifetimeRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kTaskDeclaration)};
+}
+
 void ExplicitTaskLifetimeRule::HandleSymbol(const verible::Symbol &symbol,
                                             const SyntaxTreeContext &context) {
   // Don't need to check for lifetime declaration if context is inside a class
@@ -88,5 +96,10 @@ LintRuleStatus ExplicitTaskLifetimeRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ExplicitTaskLifetimeRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
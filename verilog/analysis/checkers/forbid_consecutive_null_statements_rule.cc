@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -51,6 +52,11 @@ const LintRuleDescriptor &ForbidConsecutiveNullStatementsRule::GetDescriptor() {
   return d;
 }
 
+std::vector<verible::SymbolTag>
+ForbidConsecutiveNullStatementsRule::HandledSymbolTags() const {
+  return {verible::LeafTag(kAnyTag)};
+}
+
 void ForbidConsecutiveNullStatementsRule::HandleLeaf(
     const verible::SyntaxTreeLeaf &leaf, const SyntaxTreeContext &context) {
   if (context.IsInside(NodeEnum::kForSpec)) {
@@ -83,5 +89,11 @@ LintRuleStatus ForbidConsecutiveNullStatementsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbidConsecutiveNullStatementsRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
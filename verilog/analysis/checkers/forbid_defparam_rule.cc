@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/forbid_defparam_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -46,6 +47,7 @@ const LintRuleDescriptor &ForbidDefparamRule::GetDescriptor() {
       .name = "forbid-defparam",
       .topic = "module-instantiation",
       .desc = "Do not use defparam.",
+      .item_local = true,
   };
   return d;
 }
@@ -56,6 +58,10 @@ static const Matcher &OverrideMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag> ForbidDefparamRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kParameterOverride)};
+}
+
 void ForbidDefparamRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -75,5 +81,10 @@ verible::LintRuleStatus ForbidDefparamRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbidDefparamRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/forbid_negative_array_dim.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -47,6 +48,7 @@ const LintRuleDescriptor &ForbidNegativeArrayDim::GetDescriptor() {
       .name = "forbid-negative-array-dim",
       .topic = "forbid-negative-array-dim",
       .desc = "Check for negative constant literals inside array dimensions.",
+      .item_local = true,
   };
   return d;
 }
@@ -57,6 +59,11 @@ static const Matcher &UnaryPrefixExprMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ForbidNegativeArrayDim::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kUnaryPrefixExpression)};
+}
+
 void ForbidNegativeArrayDim::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   // This only works for simple unary expressions. They can't be nested inside
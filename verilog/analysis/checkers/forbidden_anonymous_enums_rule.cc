@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/forbidden_anonymous_enums_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -47,6 +48,7 @@ const LintRuleDescriptor &ForbiddenAnonymousEnumsRule::GetDescriptor() {
       .desc =
           "Checks that a Verilog `enum` declaration is named using "
           "`typedef`.",
+      .item_local = true,
   };
   return d;
 }
@@ -56,6 +58,11 @@ static const Matcher &EnumMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ForbiddenAnonymousEnumsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kEnumType)};
+}
+
 void ForbiddenAnonymousEnumsRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -73,5 +80,10 @@ LintRuleStatus ForbiddenAnonymousEnumsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbiddenAnonymousEnumsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/forbidden_anonymous_structs_unions_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -53,6 +54,7 @@ const LintRuleDescriptor &ForbiddenAnonymousStructsUnionsRule::GetDescriptor() {
           "named using `typedef`.",
       .param = {{"allow_anonymous_nested", "false",
                  "Allow nested structs/unions to be anonymous."}},
+      .item_local = true,
   };
   return d;
 }
@@ -91,6 +93,12 @@ bool ForbiddenAnonymousStructsUnionsRule::IsRuleMet(
          (allow_anonymous_nested_type_ && NestedInStructOrUnion(context));
 }
 
+std::vector<verible::SymbolTag>
+ForbiddenAnonymousStructsUnionsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kStructType),
+          verible::NodeTag(NodeEnum::kUnionType)};
+}
+
 void ForbiddenAnonymousStructsUnionsRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -105,5 +113,10 @@ LintRuleStatus ForbiddenAnonymousStructsUnionsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbiddenAnonymousStructsUnionsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
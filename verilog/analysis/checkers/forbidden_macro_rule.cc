@@ -17,6 +17,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/citation.h"
@@ -31,6 +32,7 @@
 #include "verilog/CST/verilog_matchers.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
+#include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 namespace analysis {
@@ -68,6 +70,10 @@ ForbiddenMacroRule::InvalidMacrosMap() {
   return *invalid_symbols;
 }
 
+std::vector<verible::SymbolTag> ForbiddenMacroRule::HandledSymbolTags() const {
+  return {verible::LeafTag(verilog_tokentype::MacroCallId)};
+}
+
 void ForbiddenMacroRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -88,6 +94,11 @@ verible::LintRuleStatus ForbiddenMacroRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbiddenMacroRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 /* static */ std::string ForbiddenMacroRule::FormatReason(
     const verible::SyntaxTreeLeaf &leaf) {
   const std::string function_name(leaf.get().text());
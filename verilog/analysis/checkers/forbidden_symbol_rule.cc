@@ -17,6 +17,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -30,6 +31,7 @@
 #include "verilog/CST/verilog_matchers.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
+#include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 namespace analysis {
@@ -48,6 +50,7 @@ const LintRuleDescriptor &ForbiddenSystemTaskFunctionRule::GetDescriptor() {
           "Checks that no forbidden system tasks or functions are used. These "
           "consist of the following functions: `$psprintf`, `$random`, and "
           "`$dist_*`. As well as non-LRM function `$srandom`.",
+      .item_local = true,
   };
   return d;
 }
@@ -76,6 +79,11 @@ ForbiddenSystemTaskFunctionRule::InvalidSymbolsMap() {
   return *invalid_symbols;
 }
 
+std::vector<verible::SymbolTag>
+ForbiddenSystemTaskFunctionRule::HandledSymbolTags() const {
+  return {verible::LeafTag(verilog_tokentype::SystemTFIdentifier)};
+}
+
 void ForbiddenSystemTaskFunctionRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -94,6 +102,11 @@ verible::LintRuleStatus ForbiddenSystemTaskFunctionRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ForbiddenSystemTaskFunctionRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 /* static */ std::string ForbiddenSystemTaskFunctionRule::FormatReason(
     const verible::SyntaxTreeLeaf &leaf) {
   const auto function_name = std::string(leaf.get().text());
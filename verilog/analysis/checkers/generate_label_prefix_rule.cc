@@ -14,6 +14,8 @@
 
 #include "verilog/analysis/checkers/generate_label_prefix_rule.h"
 
+#include <vector>
+
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -49,6 +51,7 @@ const LintRuleDescriptor &GenerateLabelPrefixRule::GetDescriptor() {
       .name = "generate-label-prefix",
       .topic = "generate-constructs",
       .desc = "Checks that every generate block label starts with g_ or gen_.",
+      .item_local = true,
   };
   return d;
 }
@@ -59,6 +62,11 @@ static const Matcher &BlockMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+GenerateLabelPrefixRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGenerateBlock)};
+}
+
 void GenerateLabelPrefixRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -96,5 +104,10 @@ verible::LintRuleStatus GenerateLabelPrefixRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool GenerateLabelPrefixRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
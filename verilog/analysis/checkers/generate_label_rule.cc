@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/generate_label_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -24,6 +25,7 @@
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -43,6 +45,7 @@ const LintRuleDescriptor &GenerateLabelRule::GetDescriptor() {
       .name = "generate-label",
       .topic = "generate-statements",
       .desc = "Checks that every generate block statement is labeled.",
+      .item_local = true,
   };
   return d;
 }
@@ -60,6 +63,10 @@ static const Matcher &BlockMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag> GenerateLabelRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGenerateBlock)};
+}
+
 void GenerateLabelRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -72,5 +79,10 @@ verible::LintRuleStatus GenerateLabelRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool GenerateLabelRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -14,25 +14,27 @@
 
 #include "verilog/analysis/checkers/instance_shadow_rule.h"
 
-#include <iterator>
+#include <algorithm>
+#include <cstddef>
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/citation.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/matcher/bound_symbol_manager.h"
 #include "common/analysis/matcher/matcher.h"
-#include "common/analysis/syntax_tree_search.h"
+#include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
-#include "common/util/iterator_adaptors.h"
-#include "verilog/CST/identifier.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
 #include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
+#include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 namespace analysis {
@@ -66,87 +68,104 @@ static const Matcher &InstanceShadowMatcher() {
   return matcher;
 }
 
-static bool isInAllowedNode(const SyntaxTreeContext &ctx) {
-  return ctx.IsInside(NodeEnum::kSeqBlock) ||
-         ctx.IsInside(NodeEnum::kGenvarDeclaration) ||
-         ctx.IsInside(NodeEnum::kReference);  // ||
-  //  ctx.IsInside(NodeEnum::kModportSimplePort);
+// Names declared in these nodes are only visible inside of them.
+static bool IsScope(NodeEnum tag) {
+  return tag == NodeEnum::kSeqBlock || tag == NodeEnum::kGenvarDeclaration;
+}
+
+// Names in these nodes are not declarations.
+static bool IsHidden(NodeEnum tag) {
+  return tag == NodeEnum::kReference ||
+         tag == NodeEnum::kModportSimplePort ||
+         tag == NodeEnum::kModportClockingPortsDeclaration;
+}
+
+InstanceShadowRule::InstanceShadowRule() : scopes_(1) {}
+
+std::vector<verible::SymbolTag> InstanceShadowRule::HandledSymbolTags() const {
+  return {verible::LeafTag(verilog_tokentype::SymbolIdentifier)};
+}
+
+void InstanceShadowRule::PopFrame() {
+  const Frame frame = frames_.back();
+  frames_.pop_back();
+  if (frame.is_hidden) --hidden_frames_;
+  if (frame.is_scope) {
+    scopes_.pop_back();
+  } else if (frame.has_declaration && !frames_.empty()) {
+    frames_.back().has_declaration = true;
+  }
+}
+
+void InstanceShadowRule::EnterContext(const SyntaxTreeContext &context) {
+  // Symbols are handled in tree order, so the ancestors of this symbol share
+  // a prefix with those of the previous one.  Frames beyond that prefix
+  // belong to subtrees that are done.
+  const auto ancestors = context.begin();
+  size_t common = std::min(frames_.size(), context.size());
+  while (common > 0 && frames_[common - 1].node != ancestors[common - 1]) {
+    --common;
+  }
+  while (frames_.size() > common) PopFrame();
+  for (size_t i = common; i < context.size(); ++i) {
+    const NodeEnum tag = NodeEnum(ancestors[i]->Tag().tag);
+    const Frame frame{ancestors[i], IsScope(tag), IsHidden(tag), false};
+    if (frame.is_scope) scopes_.emplace_back();
+    if (frame.is_hidden) ++hidden_frames_;
+    frames_.push_back(frame);
+  }
 }
 
 void InstanceShadowRule::HandleSymbol(const verible::Symbol &symbol,
                                       const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
-  bool omit_node = false;
   if (!InstanceShadowMatcher().Matches(symbol, &manager)) {
     return;
   }
-  const auto labels = FindAllSymbolIdentifierLeafs(symbol);
-  if (labels.empty()) return;
-  // if the considered symbol name is not a declaration
-  if (context.IsInside(NodeEnum::kReference)) return;
-
-  // if the considered symbol name is in a modport, discard it
-  if (context.IsInside(NodeEnum::kModportSimplePort) ||
-      context.IsInside(NodeEnum::kModportClockingPortsDeclaration)) {
-    return;
-  }
+  EnterContext(context);
+  // References and modport ports only use names that are declared elsewhere.
+  if (hidden_frames_ > 0) return;
 
+  const verible::TokenInfo &label = SymbolCastToLeaf(symbol).get();
+
+  // A name that follows another one in its parent or grandparent, such as the
+  // label of `endmodule : foo`, does not declare anything new.
   // TODO: don't latch on to K&R-Style form in which the same symbol shows
   // up twice.
-
-  const auto rcontext = reversed_view(context);
-  const auto *const rdirectParent = *std::next(rcontext.begin());
-  // we are looking for the potential labels that might overlap the considered
-  // declaration. We are searching all the labels within the visible scope
-  // until we find the node or we reach the top of the scope
-  for (const auto *node : rcontext) {
-    for (const verible::SymbolPtr &child : node->children()) {
-      if (child == nullptr) {
-        continue;
-      }
-      const auto overlappingLabels = FindAllSymbolIdentifierLeafs(*child);
-      for (const verible::TreeSearchMatch &omatch : overlappingLabels) {
-        const auto &overlappingLabel = SymbolCastToLeaf(*omatch.match);
-        // variable in different scopes or this is not a
-        // vulnerable declaration
-        if (isInAllowedNode(omatch.context)) {
-          omit_node = true;
-          break;
-        }
-        const auto &label = SymbolCastToLeaf(*labels[0].match);
-        // if found label has the same adress as considered label
-        // we found the same node so we don't
-        // want to look further
-        if (omatch.match == labels[0].match) {
-          omit_node = true;
-          break;
-        }
-        // if considered label is the last node
-        // this is the ending node with label
-        if (rdirectParent->back() == node->back()) {
-          return;
-        }
-
-        if (overlappingLabel.get().text() == label.get().text()) {
-          std::stringstream ss;
-          ss << "Symbol `" << overlappingLabel.get().text()
-             << "` is shadowing symbol `" << label.get().text()
-             << "` defined at @";
-          violations_.insert(LintViolation(symbol, ss.str(), context, {},
-                                           {overlappingLabel.get()}));
-          return;
-        }
-      }
-      if (omit_node) {
-        omit_node = false;
-        break;
-      }
+  const size_t depth = frames_.size();
+  const bool follows_declaration =
+      (depth >= 1 && frames_[depth - 1].has_declaration &&
+       !frames_[depth - 1].is_scope) ||
+      (depth >= 2 && frames_[depth - 2].has_declaration);
+  if (depth >= 1) frames_.back().has_declaration = true;
+
+  if (!follows_declaration) {
+    // Look for the name in the visible scopes, innermost first.
+    for (auto scope = scopes_.rbegin(); scope != scopes_.rend(); ++scope) {
+      const auto found = scope->find(label.text());
+      if (found == scope->end()) continue;
+      const verible::TokenInfo &overlapping_label = found->second;
+      std::stringstream ss;
+      ss << "Symbol `" << overlapping_label.text()
+         << "` is shadowing symbol `" << label.text() << "` defined at @";
+      violations_.insert(
+          LintViolation(symbol, ss.str(), context, {}, {overlapping_label}));
+      break;
     }
   }
+  scopes_.back().try_emplace(label.text(), label);
 }
 
 LintRuleStatus InstanceShadowRule::Report() const {
   return LintRuleStatus(violations_, Name(), GetStyleGuideCitation(kTopic));
 }
+
+bool InstanceShadowRule::Reset() {
+  violations_.clear();
+  frames_.clear();
+  hidden_frames_ = 0;
+  scopes_.assign(1, {});
+  return true;
+}
 }  // namespace analysis
 }  // namespace verilog
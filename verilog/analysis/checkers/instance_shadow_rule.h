@@ -16,12 +16,16 @@
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_INSTANCE_SHADOW_RULE_H_
 
 #include <set>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
+#include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
+#include "common/text/token_info.h"
 #include "verilog/analysis/descriptions.h"
 
 namespace verilog {
@@ -29,20 +33,31 @@ namespace analysis {
 
 // InstanceShadowRule determines if a variable name shadows an already
 // existing instance in that scope.
+//
+// Declarations are visited in one pass, keeping a stack of the ancestors of
+// the current symbol and, for every scope among them, the set of names
+// declared in it.  Each declaration is checked with one lookup per enclosing
+// scope.
 class InstanceShadowRule : public verible::SyntaxTreeLintRule {
  public:
   using rule_type = verible::SyntaxTreeLintRule;
   static absl::string_view Name();
 
+  InstanceShadowRule();
+
   // Returns the description of the rule implemented formatted for either the
   // helper flag or markdown depending on the parameter type.
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) override;
 
   verible::LintRuleStatus Report() const override;
 
+  bool Reset() override;
+
  private:
   // Link to style guide rule.
   static const char kTopic[];
@@ -50,7 +65,35 @@ class InstanceShadowRule : public verible::SyntaxTreeLintRule {
   // Diagnostic message.
   static const char kMessage[];
 
+  // An ancestor of the symbols handled so far.
+  struct Frame {
+    const verible::SyntaxTreeNode *node;
+    // True if names declared below this node are not visible outside of it.
+    bool is_scope;
+    // True if names below this node are not declarations, e.g. references.
+    bool is_hidden;
+    // True if a name was declared below this node, outside of nested scopes.
+    bool has_declaration;
+  };
+
+  // Updates frames_ and scopes_ to the ancestors in 'context'.
+  void EnterContext(const verible::SyntaxTreeContext &context);
+
+  // Removes the innermost frame, when its subtree is done.
+  void PopFrame();
+
   std::set<verible::LintViolation> violations_;
+
+  // Ancestors of the last handled symbol, outermost first.
+  std::vector<Frame> frames_;
+
+  // Number of frames_ that are hidden.
+  int hidden_frames_ = 0;
+
+  // First declaration of each name, per scope among frames_, outermost first.
+  // The first scope is the whole file.
+  std::vector<absl::flat_hash_map<absl::string_view, verible::TokenInfo>>
+      scopes_;
 };
 
 }  // namespace analysis
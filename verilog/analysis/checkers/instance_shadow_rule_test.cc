@@ -133,6 +133,15 @@ TEST(InstanceShadowingTest, FunctionFailures) {
           "end\n",
           "endmodule:foo;\n",
       },
+      {
+          "module foo;\n",
+          "initial begin\n",
+          "  int b;\n",
+          "end\n",
+          "int a;\n",
+          "int ", {kToken, "a"}, ";\n",
+          "endmodule:foo;\n",
+      },
       {
         "function automatic int foo (input bit in);\n",
         "  bit ", {kToken, "in"}, ";\n",
@@ -17,6 +17,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -32,6 +33,7 @@
 #include "verilog/CST/module.h"
 #include "verilog/CST/type.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -79,6 +81,11 @@ std::string InterfaceNameStyleRule::CreateViolationMessage() {
   return absl::StrCat("Interface name does not match the naming convention ",
                       "defined by regex pattern: ", style_regex_->pattern());
 }
+std::vector<verible::SymbolTag>
+InterfaceNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kInterfaceDeclaration)};
+}
+
 void InterfaceNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
                                           const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -88,7 +95,7 @@ void InterfaceNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
     identifier_token = GetInterfaceNameToken(symbol);
     name = identifier_token->text();
 
-    if (!RE2::FullMatch(name, *style_regex_)) {
+    if (!style_checker_.Matches(name, 0)) {
       violations_.insert(
           LintViolation(*identifier_token, CreateViolationMessage(), context));
     }
@@ -107,5 +114,10 @@ LintRuleStatus InterfaceNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool InterfaceNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
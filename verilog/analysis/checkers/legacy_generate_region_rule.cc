@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/legacy_generate_region_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -46,10 +47,16 @@ const LintRuleDescriptor &LegacyGenerateRegionRule::GetDescriptor() {
       .name = "legacy-generate-region",
       .topic = "generate-constructs",
       .desc = "Checks that there are no generate regions.",
+      .item_local = true,
   };
   return d;
 }
 
+std::vector<verible::SymbolTag>
+LegacyGenerateRegionRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGenerateRegion)};
+}
+
 void LegacyGenerateRegionRule::HandleNode(
     const verible::SyntaxTreeNode &node,
     const verible::SyntaxTreeContext &context) {
@@ -67,5 +74,10 @@ LintRuleStatus LegacyGenerateRegionRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool LegacyGenerateRegionRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
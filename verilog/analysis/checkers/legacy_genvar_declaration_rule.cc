@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/legacy_genvar_declaration_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -43,10 +44,16 @@ const LintRuleDescriptor &LegacyGenvarDeclarationRule::GetDescriptor() {
       .name = "legacy-genvar-declaration",
       .topic = "generate-constructs",
       .desc = "Checks that there are no separate `genvar` declarations.",
+      .item_local = true,
   };
   return d;
 }
 
+std::vector<verible::SymbolTag>
+LegacyGenvarDeclarationRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGenvarDeclaration)};
+}
+
 void LegacyGenvarDeclarationRule::HandleNode(
     const verible::SyntaxTreeNode &node,
     const verible::SyntaxTreeContext &context) {
@@ -64,5 +71,10 @@ LintRuleStatus LegacyGenvarDeclarationRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool LegacyGenvarDeclarationRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
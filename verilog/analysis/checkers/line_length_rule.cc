@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -24,7 +25,6 @@
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/strings/comment_utils.h"
-#include "common/strings/utf8.h"
 #include "common/text/config_utils.h"
 #include "common/text/constants.h"
 #include "common/text/text_structure.h"
@@ -164,22 +164,25 @@ static bool AllowLongLineException(TokenSequence::const_iterator token_begin,
 
 void LineLengthRule::Lint(const TextStructureView& text_structure,
                           absl::string_view) {
-  size_t lineno = 0;
-  for (const auto& line : text_structure.Lines()) {
-    const int observed_line_length = verible::utf8_len(line);
-    if (observed_line_length > line_length_limit_) {
-      const auto token_range = text_structure.TokenRangeOnLine(lineno);
-      // Recall that token_range is *unfiltered* and may contain non-essential
-      // whitespace 'tokens'.
-      if (!AllowLongLineException(token_range.begin(), token_range.end())) {
-        // Fake a token that marks the offending range of text.
-        TokenInfo token(TK_OTHER, line.substr(line_length_limit_));
-        const std::string msg = absl::StrCat(kMessage, line_length_limit_,
-                                             "; is: ", observed_line_length);
-        violations_.insert(LintViolation(token, msg));
-      }
+  // Widths are shared with other users of the text structure; only the lines
+  // exceeding the limit have their tokens inspected.
+  const std::vector<absl::string_view>& lines = text_structure.Lines();
+  const std::vector<int>& widths = text_structure.LineWidths();
+  for (size_t lineno = 0; lineno < lines.size(); ++lineno) {
+    const int observed_line_length = widths[lineno];
+    if (observed_line_length <= line_length_limit_) continue;
+    const auto token_range = text_structure.TokenRangeOnLine(lineno);
+    // Recall that token_range is *unfiltered* and may contain non-essential
+    // whitespace 'tokens'.
+    if (AllowLongLineException(token_range.begin(), token_range.end())) {
+      continue;
     }
-    ++lineno;
+    // Fake a token that marks the offending range of text.
+    const absl::string_view line = lines[lineno];
+    TokenInfo token(TK_OTHER, line.substr(line_length_limit_));
+    const std::string msg = absl::StrCat(kMessage, line_length_limit_,
+                                         "; is: ", observed_line_length);
+    violations_.insert(LintViolation(token, msg));
   }
 }
 
@@ -194,5 +197,10 @@ LintRuleStatus LineLengthRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool LineLengthRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -52,6 +52,8 @@ class LineLengthRule : public verible::TextStructureLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   int line_length_limit_ = kDefaultLineLength;
 
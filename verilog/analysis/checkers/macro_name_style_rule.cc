@@ -111,17 +111,17 @@ void MacroNameStyleRule::HandleToken(const TokenInfo &token) {
         case PP_Identifier: {
           if (absl::StartsWith(text, "uvm_")) {
             // Special case for uvm_* macros
-            if (!RE2::FullMatch(text, *style_lower_snake_case_regex_)) {
+            if (!style_checker_.Matches(text, kLowerSnakeCase)) {
               violations_.insert(LintViolation(token, kUVMLowerCaseMessage));
             }
           } else if (absl::StartsWith(text, "UVM_")) {
             // Special case for UVM_* macros
-            if (!RE2::FullMatch(text, *style_upper_snake_case_regex_)) {
+            if (!style_checker_.Matches(text, kUpperSnakeCase)) {
               violations_.insert(LintViolation(token, kUVMUpperCaseMessage));
             }
           } else {
             // General case for everything else
-            if (!RE2::FullMatch(text, *style_regex_)) {
+            if (!style_checker_.Matches(text, kStyle)) {
               violations_.insert(
                   LintViolation(token, CreateViolationMessage()));
             }
@@ -147,5 +147,11 @@ LintRuleStatus MacroNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool MacroNameStyleRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
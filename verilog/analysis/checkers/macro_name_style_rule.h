@@ -22,6 +22,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
+#include "common/analysis/name_style_checker.h"
 #include "common/analysis/token_stream_lint_rule.h"
 #include "common/text/token_info.h"
 #include "re2/re2.h"
@@ -47,6 +48,8 @@ class MacroNameStyleRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(absl::string_view configuration) final;
 
  private:
@@ -65,6 +68,12 @@ class MacroNameStyleRule : public verible::TokenStreamLintRule {
   std::unique_ptr<re2::RE2> style_regex_;
   std::unique_ptr<re2::RE2> style_lower_snake_case_regex_;
   std::unique_ptr<re2::RE2> style_upper_snake_case_regex_;
+
+  // Checks names against the above regexes, indexed by Style.
+  enum Style { kStyle, kLowerSnakeCase, kUpperSnakeCase };
+  verible::NameStyleChecker style_checker_{{&style_regex_,
+                                            &style_lower_snake_case_regex_,
+                                            &style_upper_snake_case_regex_}};
 };
 
 }  // namespace analysis
@@ -75,5 +75,11 @@ LintRuleStatus MacroStringConcatenationRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool MacroStringConcatenationRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
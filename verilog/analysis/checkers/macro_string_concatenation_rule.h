@@ -39,6 +39,8 @@ class MacroStringConcatenationRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // States of the internal token-based analysis.
   enum class State {
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/mismatched_labels_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -25,6 +26,7 @@
 #include "common/text/syntax_tree_context.h"
 #include "verilog/CST/seq_block.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -56,6 +58,11 @@ static const Matcher &BeginMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+MismatchedLabelsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kBegin)};
+}
+
 void MismatchedLabelsRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -91,5 +98,10 @@ verible::LintRuleStatus MismatchedLabelsRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool MismatchedLabelsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/module_begin_block_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -23,6 +24,7 @@
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -44,6 +46,7 @@ const LintRuleDescriptor &ModuleBeginBlockRule::GetDescriptor() {
       .desc =
           "Checks that there are no begin-end blocks declared at the module "
           "level.",
+      .item_local = true,
   };
   return d;
 }
@@ -54,6 +57,11 @@ static const Matcher &BlockMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ModuleBeginBlockRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kModuleBlock)};
+}
+
 void ModuleBeginBlockRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -66,5 +74,10 @@ verible::LintRuleStatus ModuleBeginBlockRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ModuleBeginBlockRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,7 +15,6 @@
 #include "verilog/analysis/checkers/module_filename_rule.h"
 
 #include <algorithm>
-#include <iterator>
 #include <memory>
 #include <set>
 #include <string>
@@ -35,8 +34,8 @@
 #include "common/util/file_util.h"
 #include "common/util/logging.h"
 #include "verilog/CST/module.h"
-#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -80,24 +79,13 @@ void ModuleFilenameRule::Lint(const TextStructureView &text_structure,
     return;
   }
 
-  const auto &tree = text_structure.SyntaxTree();
-  if (tree == nullptr) return;
-
-  // Find all module declarations.
-  auto module_matches = FindAllModuleDeclarations(*tree);
+  // Find all module declarations, except nested ones.
+  const auto facts = LintFileFacts::For(text_structure);
+  const std::vector<verible::IndexedTreeSearchMatch> &module_cleaned =
+      facts->OutermostModuleDeclarations();
 
   // If there are no modules in this source unit, suppress finding.
-  if (module_matches.empty()) return;
-
-  // Remove nested module declarations
-  std::vector<verible::TreeSearchMatch> module_cleaned;
-  module_cleaned.reserve(module_matches.size());
-  std::back_insert_iterator<std::vector<verible::TreeSearchMatch>> back_it(
-      module_cleaned);
-  std::remove_copy_if(module_matches.begin(), module_matches.end(), back_it,
-                      [](verible::TreeSearchMatch &m) {
-                        return m.context.IsInside(NodeEnum::kModuleDeclaration);
-                      });
+  if (module_cleaned.empty()) return;
 
   // See if any names match the stem of the filename.
   const absl::string_view basename = verible::file::Basename(filename);
@@ -115,7 +103,7 @@ void ModuleFilenameRule::Lint(const TextStructureView &text_structure,
 
   // If there is at least one module with a matching name, suppress finding.
   if (std::any_of(module_cleaned.begin(), module_cleaned.end(),
-                  [=](const verible::TreeSearchMatch &m) {
+                  [=](const verible::IndexedTreeSearchMatch &m) {
                     return ModuleNameMatches(*m.match, unitname);
                   })) {
     return;
@@ -150,6 +138,11 @@ LintRuleStatus ModuleFilenameRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ModuleFilenameRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 absl::Status ModuleFilenameRule::Configure(absl::string_view configuration) {
   using verible::config::SetBool;
   return verible::ParseNameValues(
@@ -41,6 +41,8 @@ class ModuleFilenameRule : public verible::TextStructureLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Ok to treat dashes as underscores.
   bool allow_dash_for_underscore_ = false;
@@ -18,11 +18,11 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/matcher/bound_symbol_manager.h"
-#include "common/analysis/matcher/matcher.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
@@ -41,7 +41,6 @@ namespace verilog {
 namespace analysis {
 
 using verible::down_cast;
-using verible::matcher::Matcher;
 
 // Register the linter rule
 VERILOG_REGISTER_LINT_RULE(ModuleParameterRule);
@@ -75,9 +74,9 @@ const LintRuleDescriptor &ModulePortRule::GetDescriptor() {
 // For example:
 //   foo bar (port1, port2);
 // Here, the node representing "port1, port2" will be bound to "list"
-static const Matcher &InstanceMatcher() {
-  static const Matcher matcher(
-      NodekGateInstance(GateInstanceHasPortList().Bind("list")));
+static const auto &InstanceMatcher() {
+  static constexpr auto matcher =
+      NodekGateInstance.Inline(GateInstanceHasPortList.Inline().Bind("list"));
   return matcher;
 }
 
@@ -85,9 +84,9 @@ static const Matcher &InstanceMatcher() {
 // For examples:
 //   foo #(1, 2) bar;
 // Here, the node representing "1, 2" will be bound to "list".
-static const Matcher &ParamsMatcher() {
-  static const Matcher matcher(NodekActualParameterList(
-      ActualParameterListHasPositionalParameterList().Bind("list")));
+static const auto &ParamsMatcher() {
+  static constexpr auto matcher = NodekActualParameterList.Inline(
+      ActualParameterListHasPositionalParameterList.Inline().Bind("list"));
   return matcher;
 }
 
@@ -112,6 +111,10 @@ static bool IsAnyPort(const verible::Symbol *symbol) {
 // ModuleParameterRule Implementation
 //
 
+std::vector<verible::SymbolTag> ModuleParameterRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kActualParameterList)};
+}
+
 void ModuleParameterRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   static constexpr absl::string_view kMessage =
@@ -150,6 +153,10 @@ verible::LintRuleStatus ModuleParameterRule::Report() const {
 // ModulePortRule Implementation
 //
 
+std::vector<verible::SymbolTag> ModulePortRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGateInstance)};
+}
+
 void ModulePortRule::HandleSymbol(const verible::Symbol &symbol,
                                   const verible::SyntaxTreeContext &context) {
   static constexpr absl::string_view kMessage =
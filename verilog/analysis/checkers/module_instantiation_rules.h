@@ -16,6 +16,7 @@
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_MODULE_INSTANTIATION_RULES_H_
 
 #include <set>
+#include <vector>
 
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
@@ -34,6 +35,8 @@ class ModuleParameterRule : public verible::SyntaxTreeLintRule {
   using rule_type = verible::SyntaxTreeLintRule;
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
   verible::LintRuleStatus Report() const final;
@@ -49,6 +52,8 @@ class ModulePortRule : public verible::SyntaxTreeLintRule {
   using rule_type = verible::SyntaxTreeLintRule;
   static const LintRuleDescriptor &GetDescriptor();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
   verible::LintRuleStatus Report() const final;
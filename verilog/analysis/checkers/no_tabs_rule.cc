@@ -60,5 +60,10 @@ LintRuleStatus NoTabsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool NoTabsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
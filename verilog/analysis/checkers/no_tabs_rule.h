@@ -15,6 +15,7 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_CHECKERS_NO_TABS_RULE_H_
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_NO_TABS_RULE_H_
 
+#include <cstdint>
 #include <set>
 
 #include "absl/strings/string_view.h"
@@ -34,10 +35,14 @@ class NoTabsRule : public verible::LineLintRule {
 
   NoTabsRule() = default;
 
+  uint32_t CandidateLineFeatures() const final { return kTab; }
+
   void HandleLine(absl::string_view line) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Collection of found violations.
   std::set<verible::LintViolation> violations_;
@@ -76,5 +76,10 @@ LintRuleStatus NoTrailingSpacesRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool NoTrailingSpacesRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -15,6 +15,7 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_CHECKERS_NO_TRAILING_SPACES_RULE_H_
 #define VERIBLE_VERILOG_ANALYSIS_CHECKERS_NO_TRAILING_SPACES_RULE_H_
 
+#include <cstdint>
 #include <set>
 
 #include "absl/strings/string_view.h"
@@ -34,10 +35,14 @@ class NoTrailingSpacesRule : public verible::LineLintRule {
 
   NoTrailingSpacesRule() = default;
 
+  uint32_t CandidateLineFeatures() const final { return kTrailingSpace; }
+
   void HandleLine(absl::string_view line) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Collection of found violations.
   std::set<verible::LintViolation> violations_;
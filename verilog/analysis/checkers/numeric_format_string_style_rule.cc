@@ -157,5 +157,10 @@ LintRuleStatus NumericFormatStringStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool NumericFormatStringStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -41,6 +41,8 @@ class NumericFormatStringStyleRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   void CheckAndReportViolation(const verible::TokenInfo &token, size_t position,
                                size_t length,
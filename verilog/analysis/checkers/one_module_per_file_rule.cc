@@ -14,8 +14,6 @@
 
 #include "verilog/analysis/checkers/one_module_per_file_rule.h"
 
-#include <algorithm>
-#include <iterator>
 #include <memory>
 #include <set>
 #include <vector>
@@ -27,8 +25,8 @@
 #include "common/text/text_structure.h"
 #include "common/util/logging.h"
 #include "verilog/CST/module.h"
-#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -54,23 +52,10 @@ const LintRuleDescriptor &OneModulePerFileRule::GetDescriptor() {
 
 void OneModulePerFileRule::Lint(const TextStructureView &text_structure,
                                 absl::string_view) {
-  const auto &tree = text_structure.SyntaxTree();
-  if (tree == nullptr) return;
-
-  auto module_matches = FindAllModuleDeclarations(*tree);
-  if (module_matches.empty()) {
-    return;
-  }
-
-  // Nested module declarations are allowed, remove those
-  std::vector<verible::TreeSearchMatch> module_cleaned;
-  module_cleaned.reserve(module_matches.size());
-  std::back_insert_iterator<std::vector<verible::TreeSearchMatch>> back_it(
-      module_cleaned);
-  std::remove_copy_if(module_matches.begin(), module_matches.end(), back_it,
-                      [](verible::TreeSearchMatch &m) {
-                        return m.context.IsInside(NodeEnum::kModuleDeclaration);
-                      });
+  // Nested module declarations are allowed, so only count the others.
+  const auto facts = LintFileFacts::For(text_structure);
+  const std::vector<verible::IndexedTreeSearchMatch> &module_cleaned =
+      facts->OutermostModuleDeclarations();
 
   if (module_cleaned.size() > 1) {
     // Report second module declaration
@@ -88,5 +73,10 @@ LintRuleStatus OneModulePerFileRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool OneModulePerFileRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -39,6 +39,8 @@ class OneModulePerFileRule : public verible::TextStructureLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Collection of found violations.
   std::set<verible::LintViolation> violations_;
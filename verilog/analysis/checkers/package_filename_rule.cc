@@ -32,6 +32,7 @@
 #include "common/util/file_util.h"
 #include "verilog/CST/package.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -70,11 +71,10 @@ void PackageFilenameRule::Lint(const TextStructureView &text_structure,
     return;
   }
 
-  const auto &tree = text_structure.SyntaxTree();
-  if (tree == nullptr) return;
-
   // Find all package declarations.
-  auto package_matches = FindAllPackageDeclarations(*tree);
+  const auto facts = LintFileFacts::For(text_structure);
+  const std::vector<verible::IndexedTreeSearchMatch> &package_matches =
+      facts->PackageDeclarations();
 
   // See if names match the stem of the filename.
   //
@@ -120,6 +120,11 @@ LintRuleStatus PackageFilenameRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool PackageFilenameRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 absl::Status PackageFilenameRule::Configure(absl::string_view configuration) {
   using verible::config::SetBool;
   return verible::ParseNameValues(
@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/packed_dimensions_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -29,6 +30,7 @@
 #include "verilog/CST/dimensions.h"
 #include "verilog/CST/expression.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -53,6 +55,7 @@ const LintRuleDescriptor &PackedDimensionsRule::GetDescriptor() {
       .desc =
           "Checks that packed dimension ranges are declare in little-endian "
           "(decreasing) order, e.g. `[N-1:0]`.",
+      .item_local = true,
   };
   return d;
 }
@@ -62,6 +65,11 @@ static const Matcher &DimensionRangeMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+PackedDimensionsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kDimensionRange)};
+}
+
 void PackedDimensionsRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   if (!ContextIsInsidePackedDimensions(context)) return;
@@ -92,5 +100,10 @@ LintRuleStatus PackedDimensionsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool PackedDimensionsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -33,6 +33,7 @@
 #include "re2/re2.h"
 #include "verilog/CST/parameters.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -102,6 +103,11 @@ std::string ParameterNameStyleRule::CreateParameterViolationMessage() {
       "defined by regex pattern: ", parameter_style_regex_->pattern());
 }
 
+std::vector<verible::SymbolTag>
+ParameterNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kParamDeclaration)};
+}
+
 void ParameterNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
                                           const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -116,14 +122,14 @@ void ParameterNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
       const auto name = id->text();
       switch (param_decl_token) {
         case TK_localparam:
-          if (!RE2::FullMatch(name, *localparam_style_regex_)) {
+          if (!style_checker_.Matches(name, kLocalparamStyle)) {
             violations_.insert(LintViolation(
                 *id, CreateLocalparamViolationMessage(), context));
           }
           break;
 
         case TK_parameter:
-          if (!RE2::FullMatch(name, *parameter_style_regex_)) {
+          if (!style_checker_.Matches(name, kParameterStyle)) {
             violations_.insert(
                 LintViolation(*id, CreateParameterViolationMessage(), context));
           }
@@ -240,5 +246,10 @@ LintRuleStatus ParameterNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ParameterNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
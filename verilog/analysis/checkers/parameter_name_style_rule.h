@@ -19,10 +19,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
+#include "common/analysis/name_style_checker.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
@@ -45,11 +47,15 @@ class ParameterNameStyleRule : public verible::SyntaxTreeLintRule {
   std::string CreateLocalparamViolationMessage();
   std::string CreateParameterViolationMessage();
 
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final;
+
   void HandleSymbol(const verible::Symbol &symbol,
                     const verible::SyntaxTreeContext &context) final;
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(absl::string_view configuration) final;
 
   const RE2 *localparam_style_regex() const {
@@ -76,6 +82,11 @@ class ParameterNameStyleRule : public verible::SyntaxTreeLintRule {
   // Regex's to check the style against
   std::unique_ptr<re2::RE2> localparam_style_regex_;
   std::unique_ptr<re2::RE2> parameter_style_regex_;
+
+  // Checks names against the above regexes, indexed by Style.
+  enum Style { kLocalparamStyle, kParameterStyle };
+  verible::NameStyleChecker style_checker_{
+      {&localparam_style_regex_, &parameter_style_regex_}};
 };
 
 }  // namespace analysis
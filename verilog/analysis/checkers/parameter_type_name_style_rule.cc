@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/parameter_type_name_style_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
@@ -27,6 +28,7 @@
 #include "common/text/token_info.h"
 #include "verilog/CST/parameters.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -61,6 +63,11 @@ static const Matcher& ParamDeclMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+ParameterTypeNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kParamDeclaration)};
+}
+
 void ParameterTypeNameStyleRule::HandleSymbol(
     const verible::Symbol& symbol, const SyntaxTreeContext& context) {
   verible::matcher::BoundSymbolManager manager;
@@ -82,5 +89,10 @@ LintRuleStatus ParameterTypeNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ParameterTypeNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -29,6 +30,7 @@
 #include "verilog/CST/verilog_matchers.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
+#include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 namespace analysis {
@@ -48,6 +50,7 @@ const LintRuleDescriptor &PlusargAssignmentRule::GetDescriptor() {
           absl::StrCat("Checks that plusargs are always assigned a value, by ",
                        "ensuring that plusargs are never accessed using the `",
                        kForbiddenFunctionName, "` system task."),
+      .item_local = true,
   };
   return d;
 }
@@ -57,6 +60,11 @@ static const Matcher &IdMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+PlusargAssignmentRule::HandledSymbolTags() const {
+  return {verible::LeafTag(verilog_tokentype::SystemTFIdentifier)};
+}
+
 void PlusargAssignmentRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -74,6 +82,11 @@ verible::LintRuleStatus PlusargAssignmentRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool PlusargAssignmentRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 /* static */ std::string PlusargAssignmentRule::FormatReason() {
   return absl::StrCat("Do not use ", kForbiddenFunctionName,
                       " to access plusargs, use ", kCorrectFunctionName,
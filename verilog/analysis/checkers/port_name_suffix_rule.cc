@@ -30,6 +30,7 @@
 #include "common/util/logging.h"
 #include "verilog/CST/port.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -96,6 +97,10 @@ bool PortNameSuffixRule::IsSuffixCorrect(absl::string_view suffix,
   return suffixes.at(direction).count(suffix) == 1;
 }
 
+std::vector<verible::SymbolTag> PortNameSuffixRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kPortDeclaration)};
+}
+
 void PortNameSuffixRule::HandleSymbol(const Symbol &symbol,
                                       const SyntaxTreeContext &context) {
   constexpr absl::string_view implicit_direction = "input";
@@ -127,5 +132,10 @@ LintRuleStatus PortNameSuffixRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool PortNameSuffixRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
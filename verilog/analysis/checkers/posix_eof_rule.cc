@@ -66,5 +66,10 @@ LintRuleStatus PosixEOFRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool PosixEOFRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
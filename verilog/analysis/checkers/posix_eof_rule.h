@@ -46,6 +46,8 @@ class PosixEOFRule : public verible::TextStructureLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   // Collection of found violations.
   std::set<verible::LintViolation> violations_;
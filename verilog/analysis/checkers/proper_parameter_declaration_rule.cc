@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/proper_parameter_declaration_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -28,6 +29,7 @@
 #include "verilog/CST/context_functions.h"
 #include "verilog/CST/parameters.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -142,6 +144,11 @@ void ProperParameterDeclarationRule::AddLocalparamViolation(
 }
 
 // TODO(kathuriac): Also check the 'interface' and 'program' constructs.
+std::vector<verible::SymbolTag>
+ProperParameterDeclarationRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kParamDeclaration)};
+}
+
 void ProperParameterDeclarationRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -181,5 +188,10 @@ LintRuleStatus ProperParameterDeclarationRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ProperParameterDeclarationRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -17,6 +17,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -35,6 +36,7 @@
 #include "verilog/CST/net.h"
 #include "verilog/CST/port.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -91,13 +93,19 @@ std::string SignalNameStyleRule::CreateViolationMessage() {
                       "defined by regex pattern: ", style_regex_->pattern());
 }
 
+std::vector<verible::SymbolTag> SignalNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kPortDeclaration),
+          verible::NodeTag(NodeEnum::kNetDeclaration),
+          verible::NodeTag(NodeEnum::kDataDeclaration)};
+}
+
 void SignalNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
                                        const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
   if (PortMatcher().Matches(symbol, &manager)) {
     const auto *identifier_leaf = GetIdentifierFromPortDeclaration(symbol);
     const auto name = ABSL_DIE_IF_NULL(identifier_leaf)->get().text();
-    if (!RE2::FullMatch(name, *style_regex_)) {
+    if (!style_checker_.Matches(name, 0)) {
       violations_.insert(LintViolation(identifier_leaf->get(),
                                        CreateViolationMessage(), context));
     }
@@ -105,7 +113,7 @@ void SignalNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
     const auto identifier_leaves = GetIdentifiersFromNetDeclaration(symbol);
     for (const auto *leaf : identifier_leaves) {
       const auto name = leaf->text();
-      if (!RE2::FullMatch(name, *style_regex_)) {
+      if (!style_checker_.Matches(name, 0)) {
         violations_.insert(
             LintViolation(*leaf, CreateViolationMessage(), context));
       }
@@ -114,7 +122,7 @@ void SignalNameStyleRule::HandleSymbol(const verible::Symbol &symbol,
     const auto identifier_leaves = GetIdentifiersFromDataDeclaration(symbol);
     for (const auto *leaf : identifier_leaves) {
       const auto name = leaf->text();
-      if (!RE2::FullMatch(name, *style_regex_)) {
+      if (!style_checker_.Matches(name, 0)) {
         violations_.insert(
             LintViolation(*leaf, CreateViolationMessage(), context));
       }
@@ -133,5 +141,10 @@ LintRuleStatus SignalNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool SignalNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
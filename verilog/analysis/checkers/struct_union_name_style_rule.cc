@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
@@ -33,7 +34,9 @@
 #include "common/util/logging.h"
 #include "verilog/CST/type.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
 namespace verilog {
@@ -68,14 +71,25 @@ static const Matcher& TypedefMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+StructUnionNameStyleRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kTypeDeclaration)};
+}
+
 void StructUnionNameStyleRule::HandleSymbol(const verible::Symbol& symbol,
                                             const SyntaxTreeContext& context) {
   verible::matcher::BoundSymbolManager manager;
   if (TypedefMatcher().Matches(symbol, &manager)) {
     // TODO: This can be changed to checking type of child (by index) when we
     // have consistent shape for all kTypeDeclaration nodes.
-    const bool is_struct = !FindAllStructTypes(symbol).empty();
-    if (!is_struct && FindAllUnionTypes(symbol).empty()) return;
+    const LintFileFacts* facts = LintFileFacts::Find(symbol, context);
+    const bool is_struct = facts != nullptr
+                               ? facts->TypesDefinedIn(symbol).struct_type
+                               : !FindAllStructTypes(symbol).empty();
+    const bool is_union = facts != nullptr
+                              ? facts->TypesDefinedIn(symbol).union_type
+                              : !FindAllUnionTypes(symbol).empty();
+    if (!is_struct && !is_union) return;
     const absl::string_view msg = is_struct ? kMessageStruct : kMessageUnion;
 
     const auto* identifier_leaf = GetIdentifierFromTypeDeclaration(symbol);
@@ -163,5 +177,10 @@ LintRuleStatus StructUnionNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool StructUnionNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -14,6 +14,8 @@
 
 #include "verilog/analysis/checkers/suggest_parentheses_rule.h"
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/text/concrete_syntax_tree.h"
@@ -47,10 +49,16 @@ const LintRuleDescriptor &SuggestParenthesesRule::GetDescriptor() {
       .desc =
           "Recommend extra parentheses around subexpressions where it "
           "helps readability.",
+      .item_local = true,
   };
   return d;
 }
 
+std::vector<verible::SymbolTag>
+SuggestParenthesesRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kConditionExpression)};
+}
+
 void SuggestParenthesesRule::HandleNode(
     const verible::SyntaxTreeNode &node,
     const verible::SyntaxTreeContext &context) {
@@ -86,5 +94,10 @@ LintRuleStatus SuggestParenthesesRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool SuggestParenthesesRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -14,11 +14,14 @@
 
 #include "verilog/analysis/checkers/suspicious_semicolon_rule.h"
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/matcher/bound_symbol_manager.h"
 #include "common/analysis/matcher/matcher.h"
 #include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
 #include "common/text/syntax_tree_context.h"
 #include "common/text/tree_utils.h"
 #include "verilog/CST/verilog_matchers.h"
@@ -42,7 +45,9 @@ const LintRuleDescriptor &SuspiciousSemicolon::GetDescriptor() {
       .topic = "bugprone",
       .desc =
           "Checks that there are no suspicious semicolons that might affect "
-          "code behaviour but escape quick visual inspection"};
+          "code behaviour but escape quick visual inspection",
+      .item_local = true,
+  };
   return d;
 }
 
@@ -51,6 +56,10 @@ static const Matcher &NullStatementMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag> SuspiciousSemicolon::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kNullStatement)};
+}
+
 void SuspiciousSemicolon::HandleNode(
     const verible::SyntaxTreeNode &node,
     const verible::SyntaxTreeContext &context) {
@@ -84,5 +93,10 @@ verible::LintRuleStatus SuspiciousSemicolon::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool SuspiciousSemicolon::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
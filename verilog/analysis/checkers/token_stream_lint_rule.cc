@@ -84,5 +84,10 @@ LintRuleStatus TokenStreamLintRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool TokenStreamLintRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
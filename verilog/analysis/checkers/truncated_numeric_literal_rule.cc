@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/numeric/int128.h"
 #include "absl/strings/numbers.h"
@@ -27,7 +28,6 @@
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/matcher/bound_symbol_manager.h"
-#include "common/analysis/matcher/matcher.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
@@ -35,6 +35,7 @@
 #include "common/text/token_info.h"
 #include "verilog/CST/numbers.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -47,7 +48,6 @@ using verible::LintViolation;
 using verible::SyntaxTreeContext;
 using verible::SyntaxTreeLeaf;
 using verible::SyntaxTreeNode;
-using verible::matcher::Matcher;
 
 VERILOG_REGISTER_LINT_RULE(TruncatedNumericLiteralRule);
 
@@ -58,14 +58,15 @@ const LintRuleDescriptor &TruncatedNumericLiteralRule::GetDescriptor() {
       .desc =
           "Checks that numeric literals are not longer than their stated "
           "bit-width to avoid undesired accidental truncation.",
+      .item_local = true,
   };
   return d;
 }
 
-static const Matcher &NumberMatcher() {
-  static const Matcher matcher(
-      NodekNumber(NumberHasConstantWidth().Bind("width"),
-                  NumberHasBasedLiteral().Bind("literal")));
+static const auto &NumberMatcher() {
+  static constexpr auto matcher =
+      NodekNumber.Inline(NumberHasConstantWidth.Inline().Bind("width"),
+                         NumberHasBasedLiteral.Inline().Bind("literal"));
   return matcher;
 }
 
@@ -148,6 +149,11 @@ static size_t GetBitWidthOfNumber(const BasedNumber &n, bool *is_lower_bound) {
   return 0;  // not reached.
 }
 
+std::vector<verible::SymbolTag>
+TruncatedNumericLiteralRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kNumber)};
+}
+
 void TruncatedNumericLiteralRule::HandleSymbol(
     const verible::Symbol &symbol, const SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -189,5 +195,10 @@ LintRuleStatus TruncatedNumericLiteralRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool TruncatedNumericLiteralRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
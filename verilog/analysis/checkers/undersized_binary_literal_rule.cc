@@ -26,7 +26,6 @@
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/matcher/bound_symbol_manager.h"
-#include "common/analysis/matcher/matcher.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/config_utils.h"
@@ -36,6 +35,7 @@
 #include "common/util/logging.h"
 #include "verilog/CST/numbers.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -49,7 +49,6 @@ using verible::LintViolation;
 using verible::SyntaxTreeContext;
 using verible::SyntaxTreeLeaf;
 using verible::SyntaxTreeNode;
-using verible::matcher::Matcher;
 
 // Register UndersizedBinaryLiteralRule
 VERILOG_REGISTER_LINT_RULE(UndersizedBinaryLiteralRule);
@@ -72,20 +71,27 @@ const LintRuleDescriptor& UndersizedBinaryLiteralRule::GetDescriptor() {
           {"autofix", "true",
            "Provide autofix suggestions, e.g. "
            "32'hAB provides suggested fix 32'h000000AB."},
-      }};
+      },
+      .item_local = true,
+  };
   return d;
 }
 
 // Broadly, start by matching all number nodes with a
 // constant width and based literal.
 
-static const Matcher& NumberMatcher() {
-  static const Matcher matcher(
-      NodekNumber(NumberHasConstantWidth().Bind("width"),
-                  NumberHasBasedLiteral().Bind("literal")));
+static const auto& NumberMatcher() {
+  static constexpr auto matcher =
+      NodekNumber.Inline(NumberHasConstantWidth.Inline().Bind("width"),
+                         NumberHasBasedLiteral.Inline().Bind("literal"));
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+UndersizedBinaryLiteralRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kNumber)};
+}
+
 void UndersizedBinaryLiteralRule::HandleSymbol(
     const verible::Symbol& symbol, const SyntaxTreeContext& context) {
   verible::matcher::BoundSymbolManager manager;
@@ -207,5 +213,10 @@ LintRuleStatus UndersizedBinaryLiteralRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool UndersizedBinaryLiteralRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
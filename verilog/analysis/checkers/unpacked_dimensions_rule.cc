@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/unpacked_dimensions_rule.h"
 
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -62,6 +63,7 @@ const LintRuleDescriptor &UnpackedDimensionsRule::GetDescriptor() {
           "big-endian order `[0:N-1]`, "
           "and when an unpacked dimension range is zero-based "
           "`[0:N-1]`, the size is declared as `[N]` instead.",
+      .item_local = true,
   };
   return d;
 }
@@ -71,6 +73,11 @@ static const Matcher &DimensionRangeMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+UnpackedDimensionsRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kDimensionRange)};
+}
+
 void UnpackedDimensionsRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   if (!ContextIsInsideUnpackedDimensions(context) ||
@@ -107,5 +114,10 @@ LintRuleStatus UnpackedDimensionsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool UnpackedDimensionsRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
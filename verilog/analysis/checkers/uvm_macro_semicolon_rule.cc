@@ -15,6 +15,7 @@
 #include "verilog/analysis/checkers/uvm_macro_semicolon_rule.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -76,6 +77,11 @@ static bool IsUvmMacroId(const verible::SyntaxTreeLeaf &leaf) {
   return false;
 }
 
+std::vector<verible::SymbolTag>
+UvmMacroSemicolonRule::HandledSymbolTags() const {
+  return {verible::LeafTag(kAnyTag)};
+}
+
 void UvmMacroSemicolonRule::HandleLeaf(
     const verible::SyntaxTreeLeaf &leaf,
     const verible::SyntaxTreeContext &context) {
@@ -116,5 +122,12 @@ verible::LintRuleStatus UvmMacroSemicolonRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool UvmMacroSemicolonRule::Reset() {
+  violations_.clear();
+  state_ = State::kNormal;
+  macro_id_ = verible::TokenInfo::EOFToken();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -27,6 +28,7 @@
 #include "common/text/syntax_tree_context.h"
 #include "common/text/tree_utils.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -49,6 +51,7 @@ const LintRuleDescriptor &V2001GenerateBeginRule::GetDescriptor() {
       .desc =
           "Checks that there are no generate-begin blocks inside a "
           "generate region.",
+      .item_local = true,
   };
   return d;
 }
@@ -59,6 +62,11 @@ static const Matcher &GenerateRegionMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag>
+V2001GenerateBeginRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kGenerateRegion)};
+}
+
 void V2001GenerateBeginRule::HandleSymbol(
     const verible::Symbol &symbol, const verible::SyntaxTreeContext &context) {
   verible::matcher::BoundSymbolManager manager;
@@ -74,5 +82,10 @@ verible::LintRuleStatus V2001GenerateBeginRule::Report() const {
   return verible::LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool V2001GenerateBeginRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/analysis/lint_rule_status.h"
@@ -30,6 +31,7 @@
 #include "common/text/tree_utils.h"
 #include "common/util/logging.h"
 #include "verilog/CST/verilog_matchers.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/descriptions.h"
 #include "verilog/analysis/lint_rule_registry.h"
 
@@ -53,6 +55,7 @@ const LintRuleDescriptor &VoidCastRule::GetDescriptor() {
       .desc =
           "Checks that void casts do not contain certain function/method "
           "calls. ",
+      .item_local = true,
   };
   return d;
 }
@@ -94,6 +97,10 @@ static const Matcher &RandomizeMatcher() {
   return matcher;
 }
 
+std::vector<verible::SymbolTag> VoidCastRule::HandledSymbolTags() const {
+  return {verible::NodeTag(NodeEnum::kVoidcast)};
+}
+
 void VoidCastRule::HandleSymbol(const verible::Symbol &symbol,
                                 const SyntaxTreeContext &context) {
   // Check for forbidden function names
@@ -126,6 +133,11 @@ LintRuleStatus VoidCastRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool VoidCastRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 /* static */ std::string VoidCastRule::FormatReason(
     const verible::SyntaxTreeLeaf &leaf) {
   return std::string(leaf.get().text()) +
@@ -14,11 +14,18 @@
 
 #include "verilog/analysis/dependencies.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/strings/display_utils.h"
+#include "common/strings/identifier_pool.h"
 #include "common/util/logging.h"
 #include "verilog/analysis/symbol_table.h"
 #include "verilog/analysis/verilog_project.h"
@@ -26,30 +33,47 @@
 namespace verilog {
 
 static FileDependencies::symbol_index_type CreateSymbolMapFromSymbolTable(
-    const SymbolTableNode &root, const VerilogProject *project) {
+    const SymbolTableNode &root, const VerilogProject *project,
+    const std::vector<FileDependencies::FileSymbols> &scanned_files) {
   VLOG(1) << __FUNCTION__ << ": collecting definitions";
   CHECK(project != nullptr)
       << "VerilogProject* is required for dependency analysis.";
-  FileDependencies::symbol_index_type symbols_index;
 
   using SymbolData = FileDependencies::SymbolData;
 
+  // Symbols are collected by the id of their name, and only sorted by name
+  // at the end, as there are many more references than distinct names.
+  verible::IdentifierPool symbol_ids;
+  std::vector<std::pair<absl::string_view, SymbolData>> symbols;
+  const auto symbol_data = [&symbol_ids,
+                            &symbols](absl::string_view name) -> SymbolData & {
+    const verible::IdentifierPool::Id id = symbol_ids.Intern(name);
+    if (id == symbols.size()) symbols.emplace_back(name, SymbolData());
+    return symbols[id].second;
+  };
+
   // Collect definers of root-level symbols.
   for (const SymbolTableNode::key_value_type &child : root) {
     const absl::string_view symbol_name(child.first);
     const VerilogSourceFile *file_origin = child.second.Value().file_origin;
     if (file_origin == nullptr) continue;
 
-    SymbolData &symbol_data(symbols_index[symbol_name]);
-    if (symbol_data.definer == nullptr) {
+    SymbolData &data(symbol_data(symbol_name));
+    if (data.definer == nullptr) {
       // Take the first definition, arbitrarily.
-      symbol_data.definer = file_origin;
+      data.definer = file_origin;
+    }
+  }
+  for (const FileDependencies::FileSymbols &scanned : scanned_files) {
+    for (const absl::string_view symbol_name : scanned.definitions) {
+      SymbolData &data(symbol_data(symbol_name));
+      if (data.definer == nullptr) data.definer = scanned.file;
     }
   }
 
   // Collect all unqualified and unresolved references from all scopes.
   VLOG(1) << __FUNCTION__ << ": collecting references";
-  root.ApplyPreOrder([&symbols_index, project](const SymbolTableNode &node) {
+  root.ApplyPreOrder([&symbol_data, project](const SymbolTableNode &node) {
     const SymbolInfo &symbol_info(node.Value());
     for (const DependentReferences &ref :
          symbol_info.local_references_to_bind) {
@@ -71,10 +95,40 @@ static FileDependencies::symbol_index_type CreateSymbolMapFromSymbolTable(
       }
 
       VLOG(2) << "  registering reference edge";
-      SymbolData &symbol_data(symbols_index[ref_id]);
-      symbol_data.referencers.insert(ref_file_origin);
+      symbol_data(ref_id).referencers.insert(ref_file_origin);
     }
   });
+
+  // Plain identifiers in scanned files only count as references to root-level
+  // symbols of the symbol table that are not design units, which scanning
+  // does not find.
+  const auto is_root_declaration = [&root](absl::string_view name) {
+    const auto found = root.Find(name);
+    if (found == root.end()) return false;
+    switch (found->second.Value().metatype) {
+      case SymbolMetaType::kModule:
+      case SymbolMetaType::kPackage:
+      case SymbolMetaType::kInterface:
+        return false;
+      default:
+        return true;
+    }
+  };
+  for (const FileDependencies::FileSymbols &scanned : scanned_files) {
+    for (const absl::string_view ref_id : scanned.references) {
+      symbol_data(ref_id).referencers.insert(scanned.file);
+    }
+    for (const absl::string_view ref_id : scanned.identifiers) {
+      if (is_root_declaration(ref_id)) {
+        symbol_data(ref_id).referencers.insert(scanned.file);
+      }
+    }
+  }
+
+  FileDependencies::symbol_index_type symbols_index;
+  for (auto &symbol : symbols) {
+    symbols_index.emplace(symbol.first, std::move(symbol.second));
+  }
   VLOG(1) << "end of " << __FUNCTION__;
   return symbols_index;  // move
 }
@@ -115,9 +169,11 @@ CreateFileDependenciesFromSymbolMap(
   return file_deps;  // move
 }
 
-FileDependencies::FileDependencies(const SymbolTable &symbol_table)
+FileDependencies::FileDependencies(
+    const SymbolTable &symbol_table,
+    const std::vector<FileSymbols> &scanned_files)
     : root_symbols_index(CreateSymbolMapFromSymbolTable(
-          symbol_table.Root(), symbol_table.Project())),
+          symbol_table.Root(), symbol_table.Project(), scanned_files)),
       file_deps(CreateFileDependenciesFromSymbolMap(root_symbols_index)) {
   // All the work is done by the initializers.
 }
@@ -149,8 +205,174 @@ std::ostream &FileDependencies::PrintGraph(std::ostream &stream) const {
   return stream;
 }
 
+FileDependencies::Schedule FileDependencies::ComputeSchedule(
+    const std::vector<node_type> &files) const {
+  // Number the files in path order.
+  std::set<node_type, FileCompare> file_set(files.begin(), files.end());
+  for (const auto &ref : file_deps) {
+    file_set.insert(ref.first);
+    for (const auto &def : ref.second) file_set.insert(def.first);
+  }
+  const std::vector<node_type> nodes(file_set.begin(), file_set.end());
+  std::map<node_type, size_t, FileCompare> ids;
+  for (const node_type file : nodes) ids.emplace(file, ids.size());
+  std::vector<std::vector<size_t>> edges(nodes.size());
+  for (const auto &ref : file_deps) {
+    std::vector<size_t> &ref_edges = edges[ids[ref.first]];
+    for (const auto &def : ref.second) ref_edges.push_back(ids[def.first]);
+  }
+
+  // Find the strongly connected components (Tarjan's algorithm).  Each is
+  // completed after all components it depends on, so they come out in
+  // dependency order.  An explicit stack of (node, next edge) replaces
+  // recursion, which could get deep in long dependency chains.
+  constexpr size_t kUnvisited = ~size_t{0};
+  std::vector<size_t> index(nodes.size(), kUnvisited);
+  std::vector<size_t> lowlink(nodes.size());
+  std::vector<bool> on_stack(nodes.size(), false);
+  std::vector<size_t> component_of(nodes.size());
+  std::vector<std::vector<size_t>> components;
+  std::vector<size_t> stack;
+  std::vector<std::pair<size_t, size_t>> call_stack;
+  size_t next_index = 0;
+  const auto visit = [&](size_t node) {
+    index[node] = lowlink[node] = next_index++;
+    stack.push_back(node);
+    on_stack[node] = true;
+    call_stack.emplace_back(node, 0);
+  };
+  for (size_t root = 0; root < nodes.size(); ++root) {
+    if (index[root] != kUnvisited) continue;
+    visit(root);
+    while (!call_stack.empty()) {
+      const size_t node = call_stack.back().first;
+      if (size_t &edge = call_stack.back().second; edge < edges[node].size()) {
+        const size_t next = edges[node][edge++];
+        if (index[next] == kUnvisited) {
+          visit(next);
+        } else if (on_stack[next]) {
+          lowlink[node] = std::min(lowlink[node], index[next]);
+        }
+        continue;
+      }
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        size_t &parent_lowlink = lowlink[call_stack.back().first];
+        parent_lowlink = std::min(parent_lowlink, lowlink[node]);
+      }
+      if (lowlink[node] != index[node]) continue;
+      std::vector<size_t> &members = components.emplace_back();
+      size_t member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        on_stack[member] = false;
+        component_of[member] = components.size() - 1;
+        members.push_back(member);
+      } while (member != node);
+      std::sort(members.begin(), members.end());
+    }
+  }
+
+  // Place each component one wave after the latest component it depends on,
+  // and find its heaviest chain of dependencies, weighted by (bytes, files),
+  // so that among equally heavy chains, the longest one wins.
+  using Weight = std::pair<size_t, size_t>;
+  std::vector<size_t> wave(components.size(), 0);
+  std::vector<Weight> chain_weight(components.size());
+  std::vector<size_t> chain_next(components.size(), kUnvisited);
+  for (size_t c = 0; c < components.size(); ++c) {
+    Weight weight(0, components[c].size());
+    for (const size_t member : components[c]) {
+      weight.first += nodes[member]->GetContent().size();
+      for (const size_t def : edges[member]) {
+        const size_t d = component_of[def];
+        if (d == c) continue;
+        wave[c] = std::max(wave[c], wave[d] + 1);
+        if (chain_next[c] == kUnvisited || chain_weight[d] > chain_weight[c]) {
+          chain_next[c] = d;
+          chain_weight[c] = chain_weight[d];
+        }
+      }
+    }
+    chain_weight[c].first += weight.first;
+    chain_weight[c].second += weight.second;
+  }
+
+  Schedule schedule;
+  size_t critical = kUnvisited;
+  for (size_t c = 0; c < components.size(); ++c) {
+    for (const size_t member : components[c]) {
+      schedule.order.push_back(nodes[member]);
+    }
+    if (components[c].size() > 1) {
+      std::vector<node_type> &cycle = schedule.cycles.emplace_back();
+      for (const size_t member : components[c]) {
+        cycle.push_back(nodes[member]);
+      }
+    }
+    if (critical == kUnvisited || chain_weight[c] > chain_weight[critical]) {
+      critical = c;
+    }
+  }
+  std::vector<std::vector<size_t>> wave_members;
+  for (size_t c = 0; c < components.size(); ++c) {
+    if (wave[c] >= wave_members.size()) wave_members.resize(wave[c] + 1);
+    wave_members[wave[c]].insert(wave_members[wave[c]].end(),
+                                 components[c].begin(), components[c].end());
+  }
+  for (std::vector<size_t> &members : wave_members) {
+    std::sort(members.begin(), members.end());
+    std::vector<node_type> &files_in_wave = schedule.waves.emplace_back();
+    for (const size_t member : members) files_in_wave.push_back(nodes[member]);
+  }
+  if (critical != kUnvisited) {
+    schedule.critical_path_bytes = chain_weight[critical].first;
+    for (size_t c = critical; c != kUnvisited; c = chain_next[c]) {
+      for (const size_t member : components[c]) {
+        schedule.critical_path.push_back(nodes[member]);
+      }
+    }
+    std::reverse(schedule.critical_path.begin(),
+                 schedule.critical_path.end());
+  }
+  return schedule;
+}
+
 std::ostream &operator<<(std::ostream &stream, const FileDependencies &deps) {
   return deps.PrintGraph(stream);
 }
 
+std::ostream &operator<<(std::ostream &stream,
+                         const FileDependencies::Schedule &schedule) {
+  const auto print_files =
+      [&stream](const std::vector<FileDependencies::node_type> &files,
+                absl::string_view separator) {
+        for (size_t i = 0; i < files.size(); ++i) {
+          if (i > 0) stream << separator;
+          stream << '"' << files[i]->ReferencedPath() << '"';
+        }
+      };
+  stream << "order:" << std::endl;
+  for (const FileDependencies::node_type file : schedule.order) {
+    stream << "  \"" << file->ReferencedPath() << '"' << std::endl;
+  }
+  stream << "waves:" << std::endl;
+  for (size_t i = 0; i < schedule.waves.size(); ++i) {
+    stream << "  " << i << ": ";
+    print_files(schedule.waves[i], " ");
+    stream << std::endl;
+  }
+  stream << "cycles:" << std::endl;
+  for (const auto &cycle : schedule.cycles) {
+    stream << "  ";
+    print_files(cycle, " ");
+    stream << std::endl;
+  }
+  stream << "critical path (" << schedule.critical_path_bytes
+         << " bytes): ";
+  print_files(schedule.critical_path, " -> ");
+  return stream << std::endl;
+}
+
 }  // namespace verilog
@@ -15,10 +15,12 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_DEPENDENCIES_H_
 #define VERIBLE_VERILOG_ANALYSIS_DEPENDENCIES_H_
 
+#include <cstddef>
 #include <functional>
 #include <iosfwd>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/strings/compare.h"
@@ -65,6 +67,25 @@ struct FileDependencies {
     std::set<const VerilogSourceFile *, FileCompare> referencers;
   };
 
+  // Root-level symbols that a file defines and references, when found without
+  // a symbol table, e.g. by ScanFileSymbols().
+  // string_views must be backed by memory that outlives this class's objects,
+  // like symbol_index_type keys.
+  struct FileSymbols {
+    node_type file = nullptr;
+
+    // Names of the design units (modules, interfaces, programs, packages)
+    // defined in the file.
+    std::vector<absl::string_view> definitions;
+
+    // Names used as a type, instantiated, or qualified with '::'.
+    std::vector<absl::string_view> references;
+
+    // All other identifiers, which could only refer to root-level
+    // declarations outside of design units, like $unit parameters.
+    std::vector<absl::string_view> identifiers;
+  };
+
   // Map of symbol name to definition and references (files).
   // string_view keys must be backed by memory that outlives this class's
   // objects.  Typically, this is owned by VerilogSourceFile inside
@@ -86,8 +107,11 @@ struct FileDependencies {
   // Extract dependency information from a symbol table.
   // The symbol table only needs to be built (.Build()), and need not be
   // Resolve()d.
+  // The symbols of 'scanned_files' are added to those of the symbol table,
+  // which then only needs to be built from the remaining files.
   // Once initialized, all data members are const.
-  explicit FileDependencies(const SymbolTable &symbol_table);
+  explicit FileDependencies(const SymbolTable &symbol_table,
+                            const std::vector<FileSymbols> &scanned_files = {});
 
   bool Empty() const;
 
@@ -99,11 +123,41 @@ struct FileDependencies {
 
   std::ostream &PrintGraph(std::ostream &) const;
 
+  // An order in which to process files, such that every file comes after the
+  // files that define the symbols it references.
+  struct Schedule {
+    // All files, each after the files it depends on.  Files in a cycle are
+    // adjacent, in path order.
+    std::vector<node_type> order;
+
+    // Groups of files that do not depend on each other: every file only
+    // depends on files in earlier waves, except for files in the same cycle,
+    // which are always in the same wave.
+    std::vector<std::vector<node_type>> waves;
+
+    // Groups of files that (transitively) depend on each other.
+    std::vector<std::vector<node_type>> cycles;
+
+    // The longest chain of dependencies, weighted by file size,
+    // starting from the file without dependencies.
+    std::vector<node_type> critical_path;
+
+    // Total size of the files on the critical path, in bytes.
+    size_t critical_path_bytes = 0;
+  };
+
+  // Returns a schedule of 'files' and of all files in the dependency graph.
+  // 'files' may contain files without any dependencies, which are otherwise
+  // unknown to this graph.
+  Schedule ComputeSchedule(const std::vector<node_type> &files = {}) const;
+
   // TODO: print unresolved references (no definition found)
 };
 
 std::ostream &operator<<(std::ostream &, const FileDependencies &);
 
+std::ostream &operator<<(std::ostream &, const FileDependencies::Schedule &);
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_ANALYSIS_DEPENDENCIES_H_
@@ -14,6 +14,7 @@
 
 #include "verilog/analysis/dependencies.h"
 
+#include <algorithm>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -31,6 +32,8 @@ namespace verilog {
 namespace {
 
 using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::UnorderedElementsAre;
 using verible::file::Basename;
 using verible::file::CreateDir;
 using verible::file::JoinPath;
@@ -362,5 +365,122 @@ TEST(FileDependenciesTest, ModuleDiamondDependencies) {
   }
 }
 
+TEST(FileDependenciesTest, ScheduleModuleDiamond) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include paths */});
+
+  ScopedTestFile mmm(sources_dir,
+                     "module mmm;\n"
+                     "  ppp ppp_i();\n"
+                     "  qqq qqq_i();\n"
+                     "endmodule\n");
+  const VerilogSourceFile *mmm_file =
+      *project.OpenTranslationUnit(Basename(mmm.filename()));
+
+  ScopedTestFile ppp(sources_dir,
+                     "module ppp;\n"
+                     "  rrr rrr_i();\n"
+                     "endmodule\n");
+  const VerilogSourceFile *ppp_file =
+      *project.OpenTranslationUnit(Basename(ppp.filename()));
+
+  // Larger than ppp, so it is on the critical path.
+  ScopedTestFile qqq(sources_dir,
+                     "module qqq;\n"
+                     "  rrr rrr_i();\n"
+                     "  rrr rrr_j();\n"
+                     "endmodule\n");
+  const VerilogSourceFile *qqq_file =
+      *project.OpenTranslationUnit(Basename(qqq.filename()));
+
+  ScopedTestFile rrr(sources_dir,
+                     "module rrr;\n"
+                     "  wire w;\n"
+                     "endmodule\n");
+  const VerilogSourceFile *rrr_file =
+      *project.OpenTranslationUnit(Basename(rrr.filename()));
+
+  // Not part of the dependency graph.
+  ScopedTestFile sss(sources_dir, "// nothing\n");
+  const VerilogSourceFile *sss_file =
+      *project.OpenTranslationUnit(Basename(sss.filename()));
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.Build(&build_diagnostics);
+  EXPECT_TRUE(build_diagnostics.empty());
+
+  const FileDependencies file_deps(symbol_table);
+  const FileDependencies::Schedule schedule =
+      file_deps.ComputeSchedule({sss_file});
+
+  ASSERT_EQ(schedule.order.size(), 5) << schedule;
+  EXPECT_THAT(schedule.waves,
+              ElementsAre(UnorderedElementsAre(rrr_file, sss_file),
+                          UnorderedElementsAre(ppp_file, qqq_file),
+                          ElementsAre(mmm_file)))
+      << schedule;
+  EXPECT_THAT(schedule.cycles, IsEmpty()) << schedule;
+  EXPECT_THAT(schedule.critical_path, ElementsAre(rrr_file, qqq_file, mmm_file))
+      << schedule;
+  EXPECT_EQ(schedule.critical_path_bytes, rrr_file->GetContent().size() +
+                                              qqq_file->GetContent().size() +
+                                              mmm_file->GetContent().size());
+
+  // Every file comes after its dependencies.
+  for (const auto &ref : file_deps.file_deps) {
+    const auto ref_pos =
+        std::find(schedule.order.begin(), schedule.order.end(), ref.first);
+    for (const auto &def : ref.second) {
+      EXPECT_LT(
+          std::find(schedule.order.begin(), schedule.order.end(), def.first),
+          ref_pos)
+          << schedule;
+    }
+  }
+}
+
+TEST(FileDependenciesTest, ScheduleCyclicDep) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include paths */});
+
+  ScopedTestFile tf1(sources_dir,
+                     "localparam int foo = 0;\n"
+                     "localparam int goo = bar;\n");
+  const VerilogSourceFile *file1 =
+      *project.OpenTranslationUnit(Basename(tf1.filename()));
+
+  ScopedTestFile tf2(sources_dir, "localparam int bar = foo - 2;\n");
+  const VerilogSourceFile *file2 =
+      *project.OpenTranslationUnit(Basename(tf2.filename()));
+
+  ScopedTestFile tf3(sources_dir, "localparam int baz = goo;\n");
+  const VerilogSourceFile *file3 =
+      *project.OpenTranslationUnit(Basename(tf3.filename()));
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.Build(&build_diagnostics);
+  EXPECT_TRUE(build_diagnostics.empty());
+
+  const FileDependencies file_deps(symbol_table);
+  const FileDependencies::Schedule schedule = file_deps.ComputeSchedule();
+
+  // The cycle is scheduled together, before the file that depends on it.
+  ASSERT_EQ(schedule.order.size(), 3) << schedule;
+  EXPECT_EQ(schedule.order.back(), file3) << schedule;
+  EXPECT_THAT(schedule.waves, ElementsAre(UnorderedElementsAre(file1, file2),
+                                          ElementsAre(file3)))
+      << schedule;
+  ASSERT_EQ(schedule.cycles.size(), 1) << schedule;
+  EXPECT_THAT(schedule.cycles[0], UnorderedElementsAre(file1, file2));
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,305 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/dependency_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "third_party/portable_endian/portable_endian.h"
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+
+// The index is a sequence of little-endian 32-bit words, followed by the
+// bytes of all names:
+//
+//   header:  magic, #files, #symbols, byte offsets of the file table, the
+//            symbol table, the lists and the names
+//   files:   per file (sorted by path): name offset, name length, and the
+//            lists of referenced symbols, of dependencies and of dependents
+//   symbols: per symbol (sorted by name): name offset, name length, the
+//            defining file (or kNone), and the list of referencing files
+//   lists:   per list: number of elements, then the elements, which are
+//            indices into the file or symbol table
+//
+// Name offsets are relative to the start of the names, and lists are given
+// by their word index in the lists.
+static constexpr uint32_t kMagic = 0x31494456;  // "VDI1"
+static constexpr size_t kHeaderSize = 7 * 4;
+static constexpr size_t kFileRecordSize = 5 * 4;
+static constexpr size_t kSymbolRecordSize = 4 * 4;
+static constexpr uint32_t kNone = ~uint32_t{0};
+
+static void AppendWord(uint32_t word, std::string *out) {
+  const uint32_t le = htole32(word);
+  out->append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+std::string SerializeDependencyIndex(const FileDependencies &deps) {
+  const FileDependencies::symbol_index_type &symbols = deps.root_symbols_index;
+
+  // Number the files in order of their paths.
+  std::set<const VerilogSourceFile *, FileDependencies::FileCompare> file_set;
+  for (const auto &symbol : symbols) {
+    if (symbol.second.definer != nullptr) {
+      file_set.insert(symbol.second.definer);
+    }
+    file_set.insert(symbol.second.referencers.begin(),
+                    symbol.second.referencers.end());
+  }
+  const std::vector<const VerilogSourceFile *> files(file_set.begin(),
+                                                       file_set.end());
+  absl::flat_hash_map<const VerilogSourceFile *, uint32_t> file_ids;
+  for (const VerilogSourceFile *file : files) {
+    file_ids.emplace(file, file_ids.size());
+  }
+
+  // All lists are sorted, as the files and symbols are visited in order.
+  std::vector<std::vector<uint32_t>> symbol_referencers(symbols.size());
+  std::vector<std::vector<uint32_t>> file_symbols(files.size());
+  uint32_t symbol_id = 0;
+  for (const auto &symbol : symbols) {
+    for (const VerilogSourceFile *referencer : symbol.second.referencers) {
+      if (referencer == symbol.second.definer) continue;
+      symbol_referencers[symbol_id].push_back(file_ids[referencer]);
+      file_symbols[file_ids[referencer]].push_back(symbol_id);
+    }
+    ++symbol_id;
+  }
+  std::vector<std::vector<uint32_t>> file_dependencies(files.size());
+  std::vector<std::vector<uint32_t>> file_dependents(files.size());
+  for (const auto &[referencer, definers] : deps.file_deps) {
+    for (const auto &definer : definers) {
+      file_dependencies[file_ids[referencer]].push_back(
+          file_ids[definer.first]);
+      file_dependents[file_ids[definer.first]].push_back(
+          file_ids[referencer]);
+    }
+  }
+
+  std::string lists;
+  const auto add_list = [&lists](const std::vector<uint32_t> &list) {
+    const uint32_t word = lists.size() / 4;
+    AppendWord(list.size(), &lists);
+    for (const uint32_t element : list) AppendWord(element, &lists);
+    return word;
+  };
+  std::string names;
+  const auto add_name = [&names](absl::string_view name, std::string *out) {
+    AppendWord(names.size(), out);
+    AppendWord(name.size(), out);
+    names.append(name.begin(), name.end());
+  };
+
+  std::string file_table;
+  for (size_t i = 0; i < files.size(); ++i) {
+    add_name(files[i]->ReferencedPath(), &file_table);
+    AppendWord(add_list(file_symbols[i]), &file_table);
+    AppendWord(add_list(file_dependencies[i]), &file_table);
+    AppendWord(add_list(file_dependents[i]), &file_table);
+  }
+  std::string symbol_table;
+  symbol_id = 0;
+  for (const auto &symbol : symbols) {
+    add_name(symbol.first, &symbol_table);
+    const VerilogSourceFile *definer = symbol.second.definer;
+    AppendWord(definer == nullptr ? kNone : file_ids[definer], &symbol_table);
+    AppendWord(add_list(symbol_referencers[symbol_id]), &symbol_table);
+    ++symbol_id;
+  }
+
+  std::string index;
+  const size_t symbols_offset = kHeaderSize + file_table.size();
+  const size_t lists_offset = symbols_offset + symbol_table.size();
+  AppendWord(kMagic, &index);
+  AppendWord(files.size(), &index);
+  AppendWord(symbols.size(), &index);
+  AppendWord(kHeaderSize, &index);
+  AppendWord(symbols_offset, &index);
+  AppendWord(lists_offset, &index);
+  AppendWord(lists_offset + lists.size(), &index);
+  index.append(file_table).append(symbol_table).append(lists).append(names);
+  return index;
+}
+
+uint32_t DependencyIndex::Word(size_t byte_offset) const {
+  uint32_t le;
+  memcpy(&le, data_.data() + byte_offset, sizeof(le));
+  return le32toh(le);
+}
+
+absl::string_view DependencyIndex::RecordName(size_t record_offset) const {
+  return data_.substr(strings_offset_ + Word(record_offset),
+                      Word(record_offset + 4));
+}
+
+std::optional<uint32_t> DependencyIndex::FindRecord(
+    size_t table_offset, size_t record_size, uint32_t count,
+    absl::string_view name) const {
+  uint32_t begin = 0;
+  uint32_t end = count;
+  while (begin < end) {
+    const uint32_t middle = begin + (end - begin) / 2;
+    if (RecordName(table_offset + middle * record_size) < name) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+  if (begin == count ||
+      RecordName(table_offset + begin * record_size) != name) {
+    return std::nullopt;
+  }
+  return begin;
+}
+
+std::vector<absl::string_view> DependencyIndex::ListNames(
+    uint32_t list, size_t table_offset, size_t record_size) const {
+  const size_t list_offset = lists_offset_ + size_t{list} * 4;
+  const uint32_t count = Word(list_offset);
+  std::vector<absl::string_view> names;
+  names.reserve(count);
+  for (uint32_t i = 1; i <= count; ++i) {
+    names.push_back(
+        RecordName(table_offset + Word(list_offset + i * 4) * record_size));
+  }
+  return names;
+}
+
+absl::StatusOr<DependencyIndex> DependencyIndex::Create(
+    absl::string_view data) {
+  const auto corrupt = [](absl::string_view what) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Corrupt dependency index: ", what));
+  };
+  DependencyIndex index(data);
+  if (data.size() < kHeaderSize || index.Word(0) != kMagic) {
+    return corrupt("no header");
+  }
+  index.num_files_ = index.Word(4);
+  index.num_symbols_ = index.Word(8);
+  index.files_offset_ = index.Word(12);
+  index.symbols_offset_ = index.Word(16);
+  index.lists_offset_ = index.Word(20);
+  index.strings_offset_ = index.Word(24);
+  const uint64_t files_size = uint64_t{index.num_files_} * kFileRecordSize;
+  const uint64_t symbols_size =
+      uint64_t{index.num_symbols_} * kSymbolRecordSize;
+  if (index.files_offset_ != kHeaderSize ||
+      index.symbols_offset_ != index.files_offset_ + files_size ||
+      index.lists_offset_ != index.symbols_offset_ + symbols_size ||
+      index.strings_offset_ < index.lists_offset_ ||
+      (index.strings_offset_ - index.lists_offset_) % 4 != 0 ||
+      index.strings_offset_ > data.size()) {
+    return corrupt("bad table offsets");
+  }
+
+  // Check every record once, so that queries need no checks.
+  const size_t names_size = data.size() - index.strings_offset_;
+  const size_t list_words = (index.strings_offset_ - index.lists_offset_) / 4;
+  const auto valid_name = [&](size_t record_offset) {
+    const uint64_t offset = index.Word(record_offset);
+    return offset + index.Word(record_offset + 4) <= names_size;
+  };
+  const auto valid_list = [&](uint32_t list, uint32_t num_elements) {
+    if (list >= list_words) return false;
+    const uint32_t count = index.Word(index.lists_offset_ + size_t{list} * 4);
+    if (uint64_t{list} + 1 + count > list_words) return false;
+    for (uint32_t i = 1; i <= count; ++i) {
+      const size_t element_offset = index.lists_offset_ + (list + i) * 4;
+      if (index.Word(element_offset) >= num_elements) return false;
+    }
+    return true;
+  };
+  for (uint32_t i = 0; i < index.num_files_; ++i) {
+    const size_t record = index.files_offset_ + i * kFileRecordSize;
+    if (!valid_name(record) ||
+        !valid_list(index.Word(record + 8), index.num_symbols_) ||
+        !valid_list(index.Word(record + 12), index.num_files_) ||
+        !valid_list(index.Word(record + 16), index.num_files_)) {
+      return corrupt("bad file record");
+    }
+  }
+  for (uint32_t i = 0; i < index.num_symbols_; ++i) {
+    const size_t record = index.symbols_offset_ + i * kSymbolRecordSize;
+    const uint32_t definer = index.Word(record + 8);
+    if (!valid_name(record) ||
+        (definer != kNone && definer >= index.num_files_) ||
+        !valid_list(index.Word(record + 12), index.num_files_)) {
+      return corrupt("bad symbol record");
+    }
+  }
+  return index;
+}
+
+std::optional<absl::string_view> DependencyIndex::DefinerOf(
+    absl::string_view symbol) const {
+  const std::optional<uint32_t> found =
+      FindRecord(symbols_offset_, kSymbolRecordSize, num_symbols_, symbol);
+  if (!found) return std::nullopt;
+  const uint32_t definer =
+      Word(symbols_offset_ + *found * kSymbolRecordSize + 8);
+  if (definer == kNone) return std::nullopt;
+  return RecordName(files_offset_ + definer * kFileRecordSize);
+}
+
+std::vector<absl::string_view> DependencyIndex::ReferencersOf(
+    absl::string_view symbol) const {
+  const std::optional<uint32_t> found =
+      FindRecord(symbols_offset_, kSymbolRecordSize, num_symbols_, symbol);
+  if (!found) return {};
+  return ListNames(Word(symbols_offset_ + *found * kSymbolRecordSize + 12),
+                   files_offset_, kFileRecordSize);
+}
+
+std::vector<absl::string_view> DependencyIndex::SymbolsReferencedBy(
+    absl::string_view file) const {
+  const std::optional<uint32_t> found =
+      FindRecord(files_offset_, kFileRecordSize, num_files_, file);
+  if (!found) return {};
+  return ListNames(Word(files_offset_ + *found * kFileRecordSize + 8),
+                   symbols_offset_, kSymbolRecordSize);
+}
+
+std::vector<absl::string_view> DependencyIndex::DependenciesOf(
+    absl::string_view file) const {
+  const std::optional<uint32_t> found =
+      FindRecord(files_offset_, kFileRecordSize, num_files_, file);
+  if (!found) return {};
+  return ListNames(Word(files_offset_ + *found * kFileRecordSize + 12),
+                   files_offset_, kFileRecordSize);
+}
+
+std::vector<absl::string_view> DependencyIndex::DependentsOf(
+    absl::string_view file) const {
+  const std::optional<uint32_t> found =
+      FindRecord(files_offset_, kFileRecordSize, num_files_, file);
+  if (!found) return {};
+  return ListNames(Word(files_offset_ + *found * kFileRecordSize + 16),
+                   files_offset_, kFileRecordSize);
+}
+
+}  // namespace verilog
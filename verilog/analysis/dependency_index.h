@@ -0,0 +1,96 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_INDEX_H_
+#define VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "verilog/analysis/dependencies.h"
+
+namespace verilog {
+
+// Returns a serialized index of the root-level symbols in 'deps': where each
+// is defined and referenced, which symbols each file references, and the
+// file dependency graph.  DependencyIndex can answer queries directly from
+// it, e.g. from a memory-mapped file, without parsing any source.
+std::string SerializeDependencyIndex(const FileDependencies &deps);
+
+// Read-only view of a serialized dependency index.
+// Files are named by their referenced path.  All returned lists are sorted,
+// and all string_views point into the index data.
+class DependencyIndex {
+ public:
+  // Returns an error if 'data' is not a complete index.
+  // 'data' must outlive the returned object.
+  static absl::StatusOr<DependencyIndex> Create(absl::string_view data);
+
+  // Returns the file that defines 'symbol', or nullopt if that is unknown.
+  std::optional<absl::string_view> DefinerOf(absl::string_view symbol) const;
+
+  // Returns the files that reference 'symbol', excluding the file that
+  // defines it.
+  std::vector<absl::string_view> ReferencersOf(absl::string_view symbol) const;
+
+  // Returns the symbols that 'file' references, excluding those that it
+  // defines itself.
+  std::vector<absl::string_view> SymbolsReferencedBy(
+      absl::string_view file) const;
+
+  // Returns the files that define symbols that 'file' references.
+  std::vector<absl::string_view> DependenciesOf(absl::string_view file) const;
+
+  // Returns the files that reference symbols that 'file' defines.
+  std::vector<absl::string_view> DependentsOf(absl::string_view file) const;
+
+ private:
+  explicit DependencyIndex(absl::string_view data) : data_(data) {}
+
+  // Returns the 32-bit word at 'byte_offset'.
+  uint32_t Word(size_t byte_offset) const;
+
+  // Returns the string of a file or symbol record.
+  absl::string_view RecordName(size_t record_offset) const;
+
+  // Returns the index of the record named 'name' in a table sorted by name,
+  // or nullopt.
+  std::optional<uint32_t> FindRecord(size_t table_offset, size_t record_size,
+                                     uint32_t count,
+                                     absl::string_view name) const;
+
+  // Returns the names of the records in the table at 'table_offset' that
+  // list number 'list' refers to.
+  std::vector<absl::string_view> ListNames(uint32_t list,
+                                           size_t table_offset,
+                                           size_t record_size) const;
+
+  absl::string_view data_;
+  uint32_t num_files_ = 0;
+  uint32_t num_symbols_ = 0;
+  size_t files_offset_ = 0;
+  size_t symbols_offset_ = 0;
+  size_t lists_offset_ = 0;
+  size_t strings_offset_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_INDEX_H_
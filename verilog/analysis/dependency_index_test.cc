@@ -0,0 +1,146 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/dependency_index.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/util/file_util.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/symbol_table.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::file::Basename;
+using verible::file::CreateDir;
+using verible::file::JoinPath;
+using verible::file::testing::ScopedTestFile;
+
+TEST(DependencyIndexTest, EmptyProject) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+  VerilogProject project(sources_dir, {/* no include paths */});
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.Build(&build_diagnostics);
+  EXPECT_TRUE(build_diagnostics.empty());
+
+  const std::string data =
+      SerializeDependencyIndex(FileDependencies(symbol_table));
+  const auto index = DependencyIndex::Create(data);
+  ASSERT_TRUE(index.ok()) << index.status();
+  EXPECT_FALSE(index->DefinerOf("mmm"));
+  EXPECT_THAT(index->ReferencersOf("mmm"), IsEmpty());
+  EXPECT_THAT(index->DependenciesOf("a.sv"), IsEmpty());
+}
+
+TEST(DependencyIndexTest, QueriesMatchFileDependencies) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include paths */});
+
+  ScopedTestFile tf1(sources_dir,
+                     "localparam int foo = 0;\n"
+                     "module mmm;\n"
+                     "endmodule\n");
+  const auto status_or_file1 =
+      project.OpenTranslationUnit(Basename(tf1.filename()));
+  const VerilogSourceFile *file1 = *status_or_file1;
+
+  ScopedTestFile tf2(sources_dir,
+                     "localparam int bar = foo - 2;\n"
+                     "module ppp;\n"
+                     "  mmm mmm_inst();\n"
+                     "  qqq qqq_inst();\n"
+                     "endmodule\n");
+  const auto status_or_file2 =
+      project.OpenTranslationUnit(Basename(tf2.filename()));
+  const VerilogSourceFile *file2 = *status_or_file2;
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.Build(&build_diagnostics);
+  EXPECT_TRUE(build_diagnostics.empty());
+
+  const std::string data =
+      SerializeDependencyIndex(FileDependencies(symbol_table));
+  const auto index = DependencyIndex::Create(data);
+  ASSERT_TRUE(index.ok()) << index.status();
+
+  const absl::string_view path1 = file1->ReferencedPath();
+  const absl::string_view path2 = file2->ReferencedPath();
+  EXPECT_EQ(index->DefinerOf("mmm"), path1);
+  EXPECT_EQ(index->DefinerOf("ppp"), path2);
+  EXPECT_FALSE(index->DefinerOf("qqq"));  // referenced, but never defined
+  EXPECT_FALSE(index->DefinerOf("nope"));
+
+  EXPECT_THAT(index->ReferencersOf("foo"), ElementsAre(path2));
+  EXPECT_THAT(index->ReferencersOf("mmm"), ElementsAre(path2));
+  EXPECT_THAT(index->ReferencersOf("qqq"), ElementsAre(path2));
+  EXPECT_THAT(index->ReferencersOf("ppp"), IsEmpty());
+
+  EXPECT_THAT(index->SymbolsReferencedBy(path1), IsEmpty());
+  EXPECT_THAT(index->SymbolsReferencedBy(path2),
+              ElementsAre("foo", "mmm", "qqq"));
+
+  EXPECT_THAT(index->DependenciesOf(path1), IsEmpty());
+  EXPECT_THAT(index->DependenciesOf(path2), ElementsAre(path1));
+  EXPECT_THAT(index->DependentsOf(path1), ElementsAre(path2));
+  EXPECT_THAT(index->DependentsOf(path2), IsEmpty());
+  EXPECT_THAT(index->DependentsOf("nope.sv"), IsEmpty());
+}
+
+TEST(DependencyIndexTest, RejectsCorruptData) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include paths */});
+  ScopedTestFile tf1(sources_dir, "localparam int zzz = 0;\n");
+  ASSERT_TRUE(project.OpenTranslationUnit(Basename(tf1.filename())).ok());
+  ScopedTestFile tf2(sources_dir, "localparam int yyy = zzz * 2;\n");
+  ASSERT_TRUE(project.OpenTranslationUnit(Basename(tf2.filename())).ok());
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.Build(&build_diagnostics);
+
+  const std::string data =
+      SerializeDependencyIndex(FileDependencies(symbol_table));
+  ASSERT_TRUE(DependencyIndex::Create(data).ok());
+
+  EXPECT_FALSE(DependencyIndex::Create("").ok());
+  EXPECT_FALSE(DependencyIndex::Create("not an index at all").ok());
+  // Every truncation cuts off either a table, a list or a name.
+  for (size_t size = 0; size < data.size(); ++size) {
+    EXPECT_FALSE(DependencyIndex::Create(data.substr(0, size)).ok()) << size;
+  }
+}
+
+}  // namespace
+}  // namespace verilog
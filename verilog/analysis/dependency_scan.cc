@@ -0,0 +1,169 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/dependency_scan.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "common/text/constants.h"
+#include "common/text/token_info.h"
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/verilog_project.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/parser/verilog_token_classifications.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+
+using verible::TK_EOF;
+using verible::TokenInfo;
+
+static bool IsIdentifier(int token_type) {
+  return token_type == verilog_tokentype::SymbolIdentifier ||
+         token_type == verilog_tokentype::EscapedIdentifier;
+}
+
+// Returns true for compiler directives that do not change the meaning of
+// the tokens that follow, which are ignored up to the end of their line.
+static bool IsHarmlessDirective(int token_type) {
+  switch (token_type) {
+    case verilog_tokentype::DR_timescale:
+    case verilog_tokentype::DR_resetall:
+    case verilog_tokentype::DR_celldefine:
+    case verilog_tokentype::DR_endcelldefine:
+    case verilog_tokentype::DR_default_nettype:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the sorted elements of 'names' that are not in 'definitions'.
+static std::vector<absl::string_view> SortedNames(
+    const absl::flat_hash_set<absl::string_view> &names,
+    const absl::flat_hash_set<absl::string_view> &definitions) {
+  std::vector<absl::string_view> result;
+  for (const absl::string_view name : names) {
+    if (!definitions.contains(name)) result.push_back(name);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::optional<FileDependencies::FileSymbols> ScanFileSymbols(
+    const VerilogSourceFile &file) {
+  // Collect the significant tokens, and give up on anything that would need
+  // preprocessing.
+  std::vector<TokenInfo> tokens;
+  VerilogLexer lexer(file.GetContent());
+  bool in_directive = false;
+  for (;;) {
+    const TokenInfo &token(lexer.DoNextToken());
+    if (token.isEOF()) break;
+    if (lexer.TokenIsError(token)) return std::nullopt;
+    const auto token_type = static_cast<verilog_tokentype>(token.token_enum());
+    if (token_type == verilog_tokentype::TK_NEWLINE) in_directive = false;
+    if (IsWhitespace(token_type) || IsComment(token_type) ||
+        token_type == verilog_tokentype::TK_LINE_CONT ||
+        token_type == verilog_tokentype::TK_ATTRIBUTE) {
+      continue;
+    }
+    if (IsHarmlessDirective(token_type)) in_directive = true;
+    if (in_directive) continue;
+    // All other directives, macros and macro calls start with '`'.
+    if (!token.text().empty() && token.text().front() == '`') {
+      return std::nullopt;
+    }
+    tokens.push_back(token);
+  }
+
+  const auto type_at = [&tokens](size_t i) {
+    return i < tokens.size() ? tokens[i].token_enum() : TK_EOF;
+  };
+  absl::flat_hash_set<absl::string_view> definitions;
+  absl::flat_hash_set<absl::string_view> references;
+  absl::flat_hash_set<absl::string_view> identifiers;
+  int depth = 0;  // of nested design units
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const int token_type = tokens[i].token_enum();
+    switch (token_type) {
+      case verilog_tokentype::TK_interface:
+        // Neither 'interface class' nor 'virtual interface' define one.
+        if (type_at(i + 1) == verilog_tokentype::TK_class ||
+            (i > 0 && type_at(i - 1) == verilog_tokentype::TK_virtual)) {
+          break;
+        }
+        [[fallthrough]];
+      case verilog_tokentype::TK_module:
+      case verilog_tokentype::TK_macromodule:
+      case verilog_tokentype::TK_program:
+      case verilog_tokentype::TK_package: {
+        if (depth++ > 0) continue;  // nested, not at the root
+        size_t name = i + 1;
+        while (type_at(name) == verilog_tokentype::TK_automatic ||
+               type_at(name) == verilog_tokentype::TK_static) {
+          ++name;
+        }
+        if (!IsIdentifier(type_at(name))) return std::nullopt;
+        definitions.insert(tokens[name].text());
+        i = name;
+        continue;
+      }
+      case verilog_tokentype::TK_endmodule:
+      case verilog_tokentype::TK_endinterface:
+      case verilog_tokentype::TK_endprogram:
+      case verilog_tokentype::TK_endpackage:
+        if (--depth < 0) return std::nullopt;
+        continue;
+      default:
+        break;
+    }
+    // Declarations outside of design units need a symbol table.
+    if (depth == 0) return std::nullopt;
+    if (!IsIdentifier(token_type)) continue;
+
+    // Skip ports, members and qualified names.
+    const int before = i > 0 ? type_at(i - 1) : TK_EOF;
+    if (before == '.' || before == verilog_tokentype::TK_SCOPE_RES) continue;
+
+    // Names used as a type are followed by the name of what they declare
+    // or instantiate, possibly after parameters or an interface modport.
+    const int after = type_at(i + 1);
+    if (after == verilog_tokentype::TK_SCOPE_RES || after == '#' ||
+        IsIdentifier(after) ||
+        (after == '.' && IsIdentifier(type_at(i + 2)) &&
+         IsIdentifier(type_at(i + 3)))) {
+      references.insert(tokens[i].text());
+    } else {
+      identifiers.insert(tokens[i].text());
+    }
+  }
+  if (depth != 0) return std::nullopt;
+
+  FileDependencies::FileSymbols symbols;
+  symbols.file = &file;
+  symbols.definitions.assign(definitions.begin(), definitions.end());
+  std::sort(symbols.definitions.begin(), symbols.definitions.end());
+  symbols.references = SortedNames(references, definitions);
+  symbols.identifiers = SortedNames(identifiers, definitions);
+  return symbols;
+}
+
+}  // namespace verilog
@@ -0,0 +1,41 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_SCAN_H_
+#define VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_SCAN_H_
+
+#include <optional>
+
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+
+// Finds the root-level symbols that an opened 'file' defines and references
+// from its tokens alone, much faster than parsing it into a symbol table.
+//
+// This only succeeds for files that consist of modules, interfaces, programs
+// and packages.  References are names used as a type (including module and
+// interface instantiations) or qualified with '::', like package imports.
+//
+// Returns nullopt where this would be ambiguous, and 'file' needs to be
+// parsed instead: with preprocessor directives or macros, with declarations
+// outside of design units, or with lexical errors.
+std::optional<FileDependencies::FileSymbols> ScanFileSymbols(
+    const VerilogSourceFile &file);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_DEPENDENCY_SCAN_H_
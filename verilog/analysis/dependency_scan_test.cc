@@ -0,0 +1,185 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/dependency_scan.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/util/file_util.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/symbol_table.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+namespace {
+
+using testing::Contains;
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::file::Basename;
+using verible::file::CreateDir;
+using verible::file::JoinPath;
+using verible::file::testing::ScopedTestFile;
+
+TEST(ScanFileSymbolsTest, DesignUnits) {
+  const InMemoryVerilogSourceFile file("a.sv",
+                                       "`timescale 1ns/1ps\n"
+                                       "package p_pkg;\n"
+                                       "  typedef logic [3:0] nibble_t;\n"
+                                       "endpackage\n"
+                                       "module automatic mmm\n"
+                                       "  import q_pkg::*;\n"
+                                       "  #(parameter int W = 1) (\n"
+                                       "    input word_t in,\n"
+                                       "    bus_if.sink bus\n"
+                                       ");\n"
+                                       "  p_pkg::nibble_t n;\n"
+                                       "  sub #(.W(W)) sub_i(.in(in));\n"
+                                       "  other other_i();\n"
+                                       "  assign n = in + bar;\n"
+                                       "endmodule\n"
+                                       "interface bus_if;\n"
+                                       "  modport sink();\n"
+                                       "endinterface\n");
+  const std::optional<FileDependencies::FileSymbols> symbols =
+      ScanFileSymbols(file);
+  ASSERT_TRUE(symbols.has_value());
+  EXPECT_EQ(symbols->file, &file);
+  EXPECT_THAT(symbols->definitions, ElementsAre("bus_if", "mmm", "p_pkg"));
+  // Excludes own definitions, like p_pkg and bus_if.
+  EXPECT_THAT(symbols->references,
+              ElementsAre("other", "q_pkg", "sub", "word_t"));
+  EXPECT_THAT(symbols->identifiers, Contains("bar"));
+}
+
+TEST(ScanFileSymbolsTest, Empty) {
+  const InMemoryVerilogSourceFile file("a.sv", "// nothing\n");
+  const std::optional<FileDependencies::FileSymbols> symbols =
+      ScanFileSymbols(file);
+  ASSERT_TRUE(symbols.has_value());
+  EXPECT_THAT(symbols->definitions, IsEmpty());
+  EXPECT_THAT(symbols->references, IsEmpty());
+}
+
+TEST(ScanFileSymbolsTest, NestedAndVirtualInterfacesAreNotDefinitions) {
+  const InMemoryVerilogSourceFile file("a.sv",
+                                       "package p_pkg;\n"
+                                       "  interface class ic;\n"
+                                       "  endclass\n"
+                                       "  class c;\n"
+                                       "    virtual interface bus_if vif;\n"
+                                       "  endclass\n"
+                                       "endpackage\n"
+                                       "module outer;\n"
+                                       "  module inner;\n"
+                                       "  endmodule\n"
+                                       "endmodule\n");
+  const std::optional<FileDependencies::FileSymbols> symbols =
+      ScanFileSymbols(file);
+  ASSERT_TRUE(symbols.has_value());
+  EXPECT_THAT(symbols->definitions, ElementsAre("outer", "p_pkg"));
+  EXPECT_THAT(symbols->references, Contains("bus_if"));
+}
+
+TEST(ScanFileSymbolsTest, AmbiguousFilesNeedParsing) {
+  constexpr absl::string_view kTestCases[] = {
+      // preprocessing
+      "`include \"defs.svh\"\n"
+      "module mmm;\n"
+      "endmodule\n",
+      "`define W 4\n",
+      "module mmm;\n"
+      "  `MACRO(x)\n"
+      "endmodule\n",
+      "`ifdef FOO\n"
+      "module mmm;\n"
+      "endmodule\n"
+      "`endif\n",
+      // declarations outside of design units
+      "localparam int foo = 1;\n",
+      "class ccc;\n"
+      "endclass\n",
+      "bind mmm ppp ppp_i();\n",
+      // unbalanced
+      "module mmm;\n",
+      "endmodule\n",
+      // no name
+      "module;\n"
+      "endmodule\n",
+  };
+  for (const absl::string_view code : kTestCases) {
+    const InMemoryVerilogSourceFile file("a.sv", code);
+    EXPECT_FALSE(ScanFileSymbols(file).has_value()) << code;
+  }
+}
+
+TEST(ScanFileSymbolsTest, CombinesWithSymbolTable) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include paths */});
+
+  // Needs a symbol table.
+  ScopedTestFile tf1(sources_dir, "localparam int foo = 1;\n");
+  const VerilogSourceFile *file1 =
+      *project.OpenTranslationUnit(Basename(tf1.filename()));
+  ASSERT_FALSE(ScanFileSymbols(*file1).has_value());
+
+  ScopedTestFile tf2(sources_dir,
+                     "module mmm;\n"
+                     "endmodule\n");
+  const VerilogSourceFile *file2 =
+      *project.OpenTranslationUnit(Basename(tf2.filename()));
+
+  ScopedTestFile tf3(sources_dir,
+                     "module ppp;\n"
+                     "  mmm mmm_i();\n"
+                     "  localparam int bar = foo + 1;\n"
+                     "endmodule\n");
+  const VerilogSourceFile *file3 =
+      *project.OpenTranslationUnit(Basename(tf3.filename()));
+
+  std::vector<FileDependencies::FileSymbols> scanned_files;
+  for (const VerilogSourceFile *file : {file2, file3}) {
+    std::optional<FileDependencies::FileSymbols> symbols =
+        ScanFileSymbols(*file);
+    ASSERT_TRUE(symbols.has_value()) << file->ReferencedPath();
+    scanned_files.push_back(*std::move(symbols));
+  }
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> build_diagnostics;
+  symbol_table.BuildSingleTranslationUnit(Basename(tf1.filename()),
+                                          &build_diagnostics);
+  EXPECT_TRUE(build_diagnostics.empty());
+
+  const FileDependencies file_deps(symbol_table, scanned_files);
+  ASSERT_EQ(file_deps.file_deps.size(), 1) << file_deps;
+  const auto found_ref = file_deps.file_deps.find(file3);
+  ASSERT_NE(found_ref, file_deps.file_deps.end()) << file_deps;
+  ASSERT_EQ(found_ref->second.size(), 2) << file_deps;
+  EXPECT_THAT(found_ref->second.find(file1)->second, ElementsAre("foo"));
+  EXPECT_THAT(found_ref->second.find(file2)->second, ElementsAre("mmm"));
+}
+
+}  // namespace
+}  // namespace verilog
@@ -40,6 +40,10 @@ struct LintRuleDescriptor {
   absl::string_view topic;  // section in style-guide
   std::string desc;         // Detailed description.
   std::vector<LintConfigParameterDescriptor> param;
+  // True for syntax tree rules whose violations within a top-level
+  // description (module, class, package, ...) only depend on that
+  // description, so that they remain valid while only others are edited.
+  bool item_local = false;
 };
 
 }  // namespace analysis
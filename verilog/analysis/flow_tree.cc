@@ -14,16 +14,38 @@
 
 #include "verilog/analysis/flow_tree.h"
 
+#include <cstddef>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/util/logging.h"
+#include "common/util/sha256.h"
 #include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 
+size_t FlowTree::Variant::size() const {
+  size_t size = 0;
+  for (const TokenRange &slice : slices) {
+    size += slice.end() - slice.begin();
+  }
+  return size;
+}
+
+verible::TokenSequence FlowTree::Variant::Tokens() const {
+  verible::TokenSequence tokens;
+  tokens.reserve(size());
+  for (const TokenRange &slice : slices) {
+    tokens.insert(tokens.end(), slice.begin(), slice.end());
+  }
+  return tokens;
+}
+
 // Adds edges within a conditonal block.
 // Such that the first edge represents the condition being true,
 // and the second edge represents the condition being false.
@@ -34,19 +56,19 @@ absl::Status FlowTree::AddBlockEdges(const ConditionalBlock &block) {
   // Handling `ifdef/ifndef.
 
   // Assuming the condition is true.
-  edges_[block.if_location].push_back(block.if_location + 1);
+  AddEdge(block.if_location, block.if_location + 1);
 
   // Assuming the condition is false.
   // Checking if there is an `elsif.
   if (contains_elsif) {
     // Add edge to the first `elsif in the block.
-    edges_[block.if_location].push_back(block.elsif_locations[0]);
+    AddEdge(block.if_location, block.elsif_locations[0]);
   } else if (contains_else) {
     // Checking if there is an `else.
-    edges_[block.if_location].push_back(block.else_location);
+    AddEdge(block.if_location, block.else_location);
   } else {
     // `endif exists.
-    edges_[block.if_location].push_back(block.endif_location);
+    AddEdge(block.if_location, block.endif_location);
   }
 
   // Handling `elsif.
@@ -54,22 +76,22 @@ absl::Status FlowTree::AddBlockEdges(const ConditionalBlock &block) {
     for (auto iter = block.elsif_locations.begin();
          iter != block.elsif_locations.end(); iter++) {
       // Assuming the condition is true.
-      edges_[*iter].push_back((*iter) + 1);
+      AddEdge(*iter, (*iter) + 1);
 
       // Assuming the condition is false.
       if (iter + 1 != block.elsif_locations.end()) {
-        edges_[*iter].push_back(*(iter + 1));
+        AddEdge(*iter, *(iter + 1));
       } else if (contains_else) {
-        edges_[*iter].push_back(block.else_location);
+        AddEdge(*iter, block.else_location);
       } else {
-        edges_[*iter].push_back(block.endif_location);
+        AddEdge(*iter, block.endif_location);
       }
     }
   }
 
   // Handling `else.
   if (contains_else) {
-    edges_[block.else_location].push_back(block.else_location + 1);
+    AddEdge(block.else_location, block.else_location + 1);
   }
 
   // For edges that are generated assuming the conditons are true,
@@ -83,14 +105,14 @@ absl::Status FlowTree::AddBlockEdges(const ConditionalBlock &block) {
   //    <group_of_lines>
   // `endif
   // Edge to be added: from <line_final> to `endif.
-  edges_[block.endif_location - 1].push_back(block.endif_location);
+  AddEdge(block.endif_location - 1, block.endif_location);
   if (contains_elsif) {
     for (auto iter : block.elsif_locations) {
-      edges_[iter - 1].push_back(block.endif_location);
+      AddEdge(iter - 1, block.endif_location);
     }
   }
   if (contains_else) {
-    edges_[block.else_location - 1].push_back(block.endif_location);
+    AddEdge(block.else_location - 1, block.endif_location);
   }
 
   // Connecting `endif to the next token directly (if not EOF).
@@ -99,12 +121,25 @@ absl::Status FlowTree::AddBlockEdges(const ConditionalBlock &block) {
       next_iter->token_enum() != PP_else &&
       next_iter->token_enum() != PP_elsif &&
       next_iter->token_enum() != PP_endif) {
-    edges_[block.endif_location].push_back(next_iter);
+    AddEdge(block.endif_location, next_iter);
   }
 
   return absl::OkStatus();
 }
 
+void FlowTree::AddEdge(TokenSequenceConstIterator from,
+                       TokenSequenceConstIterator to) {
+  added_edges_.emplace_back(from - source_sequence_.begin(),
+                            to - source_sequence_.begin());
+}
+
+absl::Span<const int> FlowTree::EdgesOf(TokenSequenceConstIterator node) const {
+  const int index = node - source_sequence_.begin();
+  return absl::MakeConstSpan(edge_targets_)
+      .subspan(edge_offsets_[index],
+               edge_offsets_[index + 1] - edge_offsets_[index]);
+}
+
 // Checks if the iterator is pointing to a conditional directive.
 bool FlowTree::IsConditional(TokenSequenceConstIterator iterator) {
   auto current_node = iterator->token_enum();
@@ -142,6 +177,11 @@ absl::Status FlowTree::AddMacroOfConditional(
   auto macro_identifier = macro_iterator->text();
   if (conditional_macro_id_.find(macro_identifier) ==
       conditional_macro_id_.end()) {
+    if (conditional_macros_counter_ == kMaxDistinctMacros) {
+      return absl::ResourceExhaustedError(
+          absl::StrCat("More than ", kMaxDistinctMacros,
+                       " distinct macros in conditionals."));
+    }
     conditional_macro_id_[macro_identifier] = conditional_macros_counter_;
     conditional_macros_.push_back(macro_iterator);
     conditional_macros_counter_++;
@@ -165,18 +205,21 @@ int FlowTree::GetMacroIDOfConditional(
 }
 
 // An API that provides a callback function to receive variants.
-absl::Status FlowTree::GenerateVariants(const VariantReceiver &receiver) {
+absl::Status FlowTree::GenerateVariants(const VariantReceiver &receiver,
+                                        bool distinct_only) {
   auto status = GenerateControlFlowTree();
   if (!status.ok()) {
     return status;
   }
+  if (source_sequence_.empty()) return absl::OkStatus();
+  distinct_only_ = distinct_only;
   return DepthFirstSearch(receiver, source_sequence_.begin());
 }
 
 // Constructs the control flow tree, which determines the edge from each node
-// (token index) to the next possible childs, And save edge_from_iterator in
-// edges_.
+// (token index) to the next possible childs, And indexes them by token.
 absl::Status FlowTree::GenerateControlFlowTree() {
+  added_edges_.clear();
   // Adding edges for if blocks.
   const TokenSequenceConstIterator non_location = source_sequence_.end();
 
@@ -190,6 +233,7 @@ absl::Status FlowTree::GenerateControlFlowTree() {
         case PP_ifndef: {
           if_blocks_.emplace_back(iter, non_location);
           auto status = AddMacroOfConditional(iter);
+          if (absl::IsResourceExhausted(status)) return status;
           if (!status.ok()) {
             return absl::InvalidArgumentError(
                 "ERROR: couldn't give a macro an ID.");
@@ -202,6 +246,7 @@ absl::Status FlowTree::GenerateControlFlowTree() {
           }
           if_blocks_.back().elsif_locations.push_back(iter);
           auto status = AddMacroOfConditional(iter);
+          if (absl::IsResourceExhausted(status)) return status;
           if (!status.ok()) {
             return absl::InvalidArgumentError(
                 "ERROR: couldn't give a macro an ID.");
@@ -237,7 +282,7 @@ absl::Status FlowTree::GenerateControlFlowTree() {
           next_iter->token_enum() != PP_else &&
           next_iter->token_enum() != PP_elsif &&
           next_iter->token_enum() != PP_endif) {
-        edges_[iter].push_back(next_iter);
+        AddEdge(iter, next_iter);
       }
     }
   }
@@ -247,99 +292,184 @@ absl::Status FlowTree::GenerateControlFlowTree() {
     return absl::InvalidArgumentError(
         "ERROR: Uncompleted conditional is found.");
   }
+  IndexEdges();
   return absl::OkStatus();
 }
 
+// Returns true for the tokens of directives, which variants don't contain.
+static bool IsDirective(int token_enum) {
+  return token_enum == PP_Identifier || token_enum == PP_ifndef ||
+         token_enum == PP_ifdef || token_enum == PP_define ||
+         token_enum == PP_define_body || token_enum == PP_elsif ||
+         token_enum == PP_else || token_enum == PP_endif;
+}
+
+// Counting-sorts added_edges_ by their source token, which keeps the childs
+// of every token in the order they were added.
+void FlowTree::IndexEdges() {
+  const int size = source_sequence_.size();
+  edge_offsets_.assign(size + 1, 0);
+  for (const auto &edge : added_edges_) {
+    ++edge_offsets_[edge.first + 1];
+  }
+  for (int i = 0; i < size; ++i) {
+    edge_offsets_[i + 1] += edge_offsets_[i];
+  }
+  edge_targets_.resize(added_edges_.size());
+  std::vector<int> next_slot(edge_offsets_.begin(), edge_offsets_.end() - 1);
+  for (const auto &[from, to] : added_edges_) {
+    edge_targets_[next_slot[from]++] = to;
+  }
+  added_edges_.clear();
+
+  // Runs end at the last token, directives and tokens with alternatives.
+  run_ends_.resize(size);
+  for (int i = size - 1; i >= 0; --i) {
+    const bool only_to_successor =
+        edge_offsets_[i + 1] - edge_offsets_[i] == 1 &&
+        edge_targets_[edge_offsets_[i]] == i + 1;
+    run_ends_[i] =
+        (i + 1 < size && only_to_successor &&
+         !IsDirective(source_sequence_[i].token_enum()))
+            ? run_ends_[i + 1]
+            : i;
+  }
+}
+
+void FlowTree::AppendToCurrentVariant(TokenSequenceConstIterator begin,
+                                      TokenSequenceConstIterator end) {
+  auto &slices = current_variant_.slices;
+  if (!slices.empty() && slices.back().end() == begin) {
+    slices.back() = TokenRange(slices.back().begin(), end);
+  } else {
+    slices.emplace_back(begin, end);
+  }
+}
+
+void FlowTree::ReceiveCurrentVariant(const VariantReceiver &receiver) {
+  if (distinct_only_) {
+    verible::Sha256Context context;
+    for (const TokenRange &slice : current_variant_.slices) {
+      for (const verible::TokenInfo &token : slice) {
+        // Lengths keep the concatenation unambiguous.
+        context.AddInput(absl::StrCat(token.token_enum(), ":",
+                                      token.text().length(), ":"));
+        context.AddInput(token.text());
+      }
+    }
+    if (!variant_digests_.insert(context.BuildAndReset()).second) return;
+  }
+  wants_more_ &= receiver(current_variant_);
+}
+
 // Traveses the control flow tree in a depth first manner, appending the visited
 // tokens to current_variant_, then provide the completed variant to the user
 // using a callback function (VariantReceiver).
+// Runs of tokens without alternatives are followed in a loop, so that the
+// recursion is only as deep as the conditionals are many.
 absl::Status FlowTree::DepthFirstSearch(
     const VariantReceiver &receiver, TokenSequenceConstIterator current_node) {
   if (!wants_more_) return absl::OkStatus();
 
-  // Skips directives so that current_variant_ doesn't contain any.
-  if (current_node->token_enum() != PP_Identifier &&
-      current_node->token_enum() != PP_ifndef &&
-      current_node->token_enum() != PP_ifdef &&
-      current_node->token_enum() != PP_define &&
-      current_node->token_enum() != PP_define_body &&
-      current_node->token_enum() != PP_elsif &&
-      current_node->token_enum() != PP_else &&
-      current_node->token_enum() != PP_endif) {
-    current_variant_.sequence.push_back(*current_node);
-  }
+  // To back track into other variants, the slices are restored on return.
+  auto &slices = current_variant_.slices;
+  const size_t initial_slices = slices.size();
+  const TokenSequenceConstIterator initial_end =
+      slices.empty() ? source_sequence_.end() : slices.back().end();
 
-  // Checks if the current token is a `ifdef/`ifndef/`elsif.
-  if (current_node->token_enum() == PP_ifdef ||
-      current_node->token_enum() == PP_ifndef ||
-      current_node->token_enum() == PP_elsif) {
-    int macro_id = GetMacroIDOfConditional(current_node);
-    bool negated = (current_node->token_enum() == PP_ifndef);
-    // Checks if this macro is already visited (either defined/undefined).
-    if (current_variant_.visited.test(macro_id)) {
-      bool assume_condition_is_true =
-          (negated ^ current_variant_.macros_mask.test(macro_id));
-      if (auto status = DepthFirstSearch(
-              receiver, edges_[current_node][!assume_condition_is_true]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
-      }
-    } else {
-      current_variant_.visited.flip(macro_id);
-      // This macro wans't visited before, then we can check both edges.
-      // Assume the condition is true.
-      if (negated) {
-        current_variant_.macros_mask.reset(macro_id);
-      } else {
-        current_variant_.macros_mask.set(macro_id);
-      }
-      if (auto status = DepthFirstSearch(receiver, edges_[current_node][0]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
-      }
+  while (true) {
+    // Appends the tokens up to the next one with alternatives at once.
+    const auto run_end =
+        source_sequence_.begin() +
+        run_ends_[current_node - source_sequence_.begin()];
+    if (run_end != current_node) {
+      AppendToCurrentVariant(current_node, run_end);
+      current_node = run_end;
+    }
+
+    // Skips directives so that current_variant_ doesn't contain any.
+    if (!IsDirective(current_node->token_enum())) {
+      AppendToCurrentVariant(current_node, current_node + 1);
+    }
 
-      // Assume the condition is false.
-      if (!negated) {
-        current_variant_.macros_mask.reset(macro_id);
+    // Checks if the current token is a `ifdef/`ifndef/`elsif.
+    if (current_node->token_enum() == PP_ifdef ||
+        current_node->token_enum() == PP_ifndef ||
+        current_node->token_enum() == PP_elsif) {
+      int macro_id = GetMacroIDOfConditional(current_node);
+      bool negated = (current_node->token_enum() == PP_ifndef);
+      const auto edges = EdgesOf(current_node);
+      const auto begin = source_sequence_.begin();
+      // Checks if this macro is already visited (either defined/undefined).
+      if (current_variant_.visited.test(macro_id)) {
+        bool assume_condition_is_true =
+            (negated ^ current_variant_.macros_mask.test(macro_id));
+        if (auto status =
+                DepthFirstSearch(receiver,
+                                 begin + edges[!assume_condition_is_true]);
+            !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
       } else {
-        current_variant_.macros_mask.set(macro_id);
-      }
-      if (auto status = DepthFirstSearch(receiver, edges_[current_node][1]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
+        current_variant_.visited.flip(macro_id);
+        // This macro wans't visited before, then we can check both edges.
+        // Assume the condition is true.
+        if (negated) {
+          current_variant_.macros_mask.reset(macro_id);
+        } else {
+          current_variant_.macros_mask.set(macro_id);
+        }
+        if (auto status = DepthFirstSearch(receiver, begin + edges[0]); !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
+
+        // Assume the condition is false.
+        if (!negated) {
+          current_variant_.macros_mask.reset(macro_id);
+        } else {
+          current_variant_.macros_mask.set(macro_id);
+        }
+        if (auto status = DepthFirstSearch(receiver, begin + edges[1]); !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
+        // Undo the change to allow for backtracking.
+        current_variant_.visited.flip(macro_id);
       }
-      // Undo the change to allow for backtracking.
-      current_variant_.visited.flip(macro_id);
+      break;
     }
-  } else {
-    // Do recursive search through every possible edge.
+
+    // If the current node is the last one, the completed current_variant_ is
+    // ready to be sent.
+    if (current_node == source_sequence_.end() - 1) {
+      ReceiveCurrentVariant(receiver);
+      break;
+    }
+
     // Expected to be only one edge in this case.
-    for (auto next_node : edges_[current_node]) {
-      if (auto status = FlowTree::DepthFirstSearch(receiver, next_node);
+    const auto edges = EdgesOf(current_node);
+    if (edges.size() == 1) {
+      current_node = source_sequence_.begin() + edges.front();
+      continue;
+    }
+    // Do recursive search through every possible edge.
+    for (const int next_node : edges) {
+      if (auto status = FlowTree::DepthFirstSearch(
+              receiver, source_sequence_.begin() + next_node);
           !status.ok()) {
         LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
         return status;
       }
     }
+    break;
   }
-  // If the current node is the last one, push the completed current_variant_
-  // then it is ready to be sent.
-  if (current_node == source_sequence_.end() - 1) {
-    wants_more_ &= receiver(current_variant_);
-  }
-  if (current_node->token_enum() != PP_Identifier &&
-      current_node->token_enum() != PP_ifndef &&
-      current_node->token_enum() != PP_ifdef &&
-      current_node->token_enum() != PP_define &&
-      current_node->token_enum() != PP_define_body &&
-      current_node->token_enum() != PP_elsif &&
-      current_node->token_enum() != PP_else &&
-      current_node->token_enum() != PP_endif) {
-    // Remove tokens to back track into other variants.
-    current_variant_.sequence.pop_back();
+
+  // Remove tokens to back track into other variants.
+  slices.resize(initial_slices);
+  if (!slices.empty()) {
+    slices.back() = TokenRange(slices.back().begin(), initial_end);
   }
   return absl::OkStatus();
 }
@@ -15,15 +15,21 @@
 #ifndef VERIBLE_VERILOG_FLOW_TREE_H_
 #define VERIBLE_VERILOG_FLOW_TREE_H_
 
+#include <array>
 #include <bitset>
+#include <cstdint>
 #include <functional>
 #include <map>
+#include <set>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/text/token_stream_view.h"
+#include "common/util/iterator_range.h"
+#include "common/util/sha256.h"
 
 namespace verilog {
 
@@ -39,6 +45,7 @@ class FlowTree {
  public:
   using BitSet = std::bitset<kMaxDistinctMacros>;
   using TokenSequenceConstIterator = verible::TokenSequence::const_iterator;
+  using TokenRange = verible::iterator_range<TokenSequenceConstIterator>;
 
   // "ConditionalBlock" saves locations of conditionals in a "TokenSequence".
   //  All locations should point inside this specific "TokenSequence".
@@ -48,8 +55,16 @@ class FlowTree {
   //  'source_sequence_.end()'.
 
   struct Variant {
-    // Contains the token sequence of the variant.
-    verible::TokenSequence sequence;
+    // The token sequence of the variant, as consecutive ranges of the source
+    // sequence, which the variant points into.  Variants only differ where
+    // conditionals are, so this does not copy tokens.
+    std::vector<TokenRange> slices;
+
+    // Returns the number of tokens in the variant.
+    size_t size() const;
+
+    // Returns a copy of the tokens of the variant.
+    verible::TokenSequence Tokens() const;
 
     // The i-th bit in "macros_mask" is 1 when the macro (with ID = i) is
     // assumed to be defined, otherwise it is assumed to be undefined.
@@ -79,8 +94,11 @@ class FlowTree {
   explicit FlowTree(verible::TokenSequence source_sequence)
       : source_sequence_(std::move(source_sequence)){};
 
-  // Generates all possible variants.
-  absl::Status GenerateVariants(const VariantReceiver &receiver);
+  // Generates all possible variants.  With 'distinct_only', skips variants
+  // whose tokens (enums and text) are the same as those of a variant
+  // generated before, e.g. ones that only differ in empty branches.
+  absl::Status GenerateVariants(const VariantReceiver &receiver,
+                                bool distinct_only = false);
 
   // Returns all the used macros in conditionals, ordered with the same ID as
   // used in BitSets.
@@ -103,23 +121,50 @@ class FlowTree {
     TokenSequenceConstIterator endif_location;
   };
 
-  // Constructs the control flow tree by adding the tree edges in edges_.
+  // Constructs the control flow tree by adding and indexing the tree edges.
   absl::Status GenerateControlFlowTree();
 
   // Traveses the tree in a depth first manner.
   absl::Status DepthFirstSearch(const VariantReceiver &receiver,
                                 TokenSequenceConstIterator current_node);
 
+  // Appends the tokens from 'begin' to 'end' to current_variant_.
+  void AppendToCurrentVariant(TokenSequenceConstIterator begin,
+                              TokenSequenceConstIterator end);
+
+  // Passes the completed current_variant_ to 'receiver', unless it is a
+  // repetition that distinct_only_ skips.
+  void ReceiveCurrentVariant(const VariantReceiver &receiver);
+
   // Checks if the iterator points to a conditonal directive (`ifdef/ifndef...).
   static bool IsConditional(TokenSequenceConstIterator iterator);
 
   // Adds all edges withing a conditional block.
   absl::Status AddBlockEdges(const ConditionalBlock &block);
 
+  // Adds an edge from the token at 'from' to the token at 'to'.
+  void AddEdge(TokenSequenceConstIterator from, TokenSequenceConstIterator to);
+
+  // Builds edge_offsets_, edge_targets_ and run_ends_ from added_edges_.
+  void IndexEdges();
+
+  // Returns the indices of the possible next childs of the token at 'node'.
+  absl::Span<const int> EdgesOf(TokenSequenceConstIterator node) const;
+
+  // The tree edges as (from, to) token indices, in the order they are added.
+  std::vector<std::pair<int, int>> added_edges_;
+
   // The tree edges which defines the possible next childs of each token in
-  // source_sequence_.
-  std::map<TokenSequenceConstIterator, std::vector<TokenSequenceConstIterator>>
-      edges_;
+  // source_sequence_, in compressed sparse row layout: the childs of the token
+  // at index i are edge_targets_[edge_offsets_[i]] up to
+  // edge_targets_[edge_offsets_[i + 1]], in the order they were added.
+  std::vector<int> edge_offsets_;
+  std::vector<int> edge_targets_;
+
+  // For the token at index i, the index of the first token, starting at i,
+  // that is a directive, the last token, or has other childs than its
+  // successor.  DepthFirstSearch() appends the tokens before it at once.
+  std::vector<int> run_ends_;
 
   // Extracts the conditional macro checked.
   static absl::Status MacroFollows(
@@ -141,6 +186,13 @@ class FlowTree {
   // Current variant being generated by DepthFirstSearch.
   Variant current_variant_;
 
+  // If true, only variants with distinct tokens are generated.
+  bool distinct_only_ = false;
+
+  // Digests of the tokens of the variants generated so far, if
+  // distinct_only_.
+  std::set<std::array<uint8_t, verible::kSha256HashSize>> variant_digests_;
+
   // A flag that determines if the VariantReceiver returned 'false'.
   // By default: it assumes VariantReceiver wants more variants.
   bool wants_more_ = true;
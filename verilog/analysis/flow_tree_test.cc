@@ -14,9 +14,11 @@
 
 #include "verilog/analysis/flow_tree.h"
 
+#include <string>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/text/token_stream_view.h"
 #include "gmock/gmock.h"
@@ -79,16 +81,16 @@ TEST(FlowTree, MultipleConditionalsSameMacro) {
   // First variant: A is defined.
   EXPECT_TRUE(variants[0].macros_mask.test(0));
   EXPECT_TRUE(variants[0].visited.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE_1");
-  EXPECT_THAT(variants[0].sequence[1].text(), "A_TRUE_2");
-  EXPECT_THAT(variants[0].sequence[2].text(), "A_TRUE_3");
+  EXPECT_THAT(variants[0].Tokens()[0].text(), "A_TRUE_1");
+  EXPECT_THAT(variants[0].Tokens()[1].text(), "A_TRUE_2");
+  EXPECT_THAT(variants[0].Tokens()[2].text(), "A_TRUE_3");
 
   // Second variant: A is undefined.
   EXPECT_FALSE(variants[1].macros_mask.test(0));
   EXPECT_TRUE(variants[1].visited.test(0));
-  EXPECT_THAT(variants[1].sequence[0].text(), "A_FALSE_1");
-  EXPECT_THAT(variants[1].sequence[1].text(), "A_FALSE_2");
-  EXPECT_THAT(variants[1].sequence[2].text(), "A_FALSE_3");
+  EXPECT_THAT(variants[1].Tokens()[0].text(), "A_FALSE_1");
+  EXPECT_THAT(variants[1].Tokens()[1].text(), "A_FALSE_2");
+  EXPECT_THAT(variants[1].Tokens()[2].text(), "A_FALSE_3");
 }
 
 TEST(FlowTree, UnmatchedElses) {
@@ -212,7 +214,7 @@ TEST(FlowTree, NestedConditionals) {
     EXPECT_TRUE(status.ok());
     EXPECT_EQ(variants.size(), 3);
     for (const auto& variant : variants) {
-      EXPECT_EQ(variant.sequence.size(), 1);
+      EXPECT_EQ(variant.size(), 1);
       if (variant.macros_mask.test(0) == 0) {
         // Check that if A is undefined, then B is not visited.
         EXPECT_FALSE(variant.visited.test(1));
@@ -259,19 +261,19 @@ TEST(FlowTree, MultipleElseIfs) {
 
   // A is defined.
   EXPECT_TRUE(variants[0].macros_mask.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE");
+  EXPECT_THAT(variants[0].Tokens()[0].text(), "A_TRUE");
 
   // B is defined.
   EXPECT_TRUE(variants[1].macros_mask.test(1));
-  EXPECT_THAT(variants[1].sequence[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[1].Tokens()[0].text(), "B_TRUE");
 
   // EMPTY is defined.
   EXPECT_TRUE(variants[2].macros_mask.test(2));
-  EXPECT_TRUE(variants[2].sequence.empty());
+  EXPECT_TRUE(variants[2].slices.empty());
 
   // C is defined.
   EXPECT_TRUE(variants[3].macros_mask.test(3));
-  EXPECT_THAT(variants[3].sequence[0].text(), "C_TRUE");
+  EXPECT_THAT(variants[3].Tokens()[0].text(), "C_TRUE");
 }
 
 TEST(FlowTree, SwappedNegatedIfs) {
@@ -304,15 +306,15 @@ TEST(FlowTree, SwappedNegatedIfs) {
   EXPECT_THAT(used_macros[0]->text(), "A");
   EXPECT_THAT(used_macros[1]->text(), "B");
 
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_FALSE");
-  EXPECT_THAT(variants[0].sequence[1].text(), "B_FALSE");
+  EXPECT_THAT(variants[0].Tokens()[0].text(), "A_FALSE");
+  EXPECT_THAT(variants[0].Tokens()[1].text(), "B_FALSE");
 
-  EXPECT_THAT(variants[1].sequence[0].text(), "A_FALSE");
+  EXPECT_THAT(variants[1].Tokens()[0].text(), "A_FALSE");
 
-  EXPECT_THAT(variants[2].sequence[0].text(), "B_TRUE");
-  EXPECT_THAT(variants[2].sequence[1].text(), "A_TRUE");
+  EXPECT_THAT(variants[2].Tokens()[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[2].Tokens()[1].text(), "A_TRUE");
 
-  EXPECT_THAT(variants[3].sequence[0].text(), "B_FALSE");
+  EXPECT_THAT(variants[3].Tokens()[0].text(), "B_FALSE");
 }
 
 TEST(FlowTree, CompleteConditional) {
@@ -345,15 +347,97 @@ TEST(FlowTree, CompleteConditional) {
   EXPECT_THAT(used_macros[2]->text(), "C");
 
   EXPECT_TRUE(variants[0].macros_mask.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE");
+  EXPECT_THAT(variants[0].Tokens()[0].text(), "A_TRUE");
 
   EXPECT_TRUE(variants[1].macros_mask.test(1));
-  EXPECT_THAT(variants[1].sequence[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[1].Tokens()[0].text(), "B_TRUE");
 
   EXPECT_TRUE(variants[2].macros_mask.test(2));
-  EXPECT_THAT(variants[2].sequence[0].text(), "C_TRUE");
+  EXPECT_THAT(variants[2].Tokens()[0].text(), "C_TRUE");
 
-  EXPECT_THAT(variants[3].sequence[0].text(), "ALL_FALSE");
+  EXPECT_THAT(variants[3].Tokens()[0].text(), "ALL_FALSE");
+}
+
+TEST(FlowTree, VariantsAreSlicesOfTheSource) {
+  const absl::string_view test_case =
+      R"(
+    BEFORE_1 BEFORE_2
+    `ifdef A
+      A_TRUE
+    `else
+      A_FALSE
+    `endif
+    AFTER)";
+
+  const verible::TokenSequence source = LexToSequence(test_case);
+  FlowTree tree_test(source);
+  std::vector<FlowTree::Variant> variants;
+  auto status =
+      tree_test.GenerateVariants([&variants](const FlowTree::Variant& variant) {
+        variants.push_back(variant);
+        return true;
+      });
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(variants.size(), 2);
+  // The tokens before the conditional are one slice, the rest another.
+  ASSERT_EQ(variants[0].slices.size(), 3);
+  EXPECT_EQ(variants[0].slices[0].end() - variants[0].slices[0].begin(), 2);
+  EXPECT_EQ(variants[0].size(), 4);
+  std::vector<absl::string_view> texts;
+  for (const auto& token : variants[1].Tokens()) texts.push_back(token.text());
+  EXPECT_THAT(texts,
+              testing::ElementsAre("BEFORE_1", "BEFORE_2", "A_FALSE", "AFTER"));
+}
+
+TEST(FlowTree, DistinctVariantsOnly) {
+  const absl::string_view test_case =
+      R"(
+    `ifdef A
+    `else
+    `endif
+    `ifdef B
+      B_TRUE
+    `else
+      B_TRUE
+    `endif
+    `ifdef C
+      C_TRUE
+    `endif)";
+
+  FlowTree all_tree(LexToSequence(test_case));
+  int all = 0;
+  EXPECT_TRUE(all_tree
+                  .GenerateVariants([&all](const FlowTree::Variant&) {
+                    ++all;
+                    return true;
+                  })
+                  .ok());
+  EXPECT_EQ(all, 8);
+
+  FlowTree distinct_tree(LexToSequence(test_case));
+  std::vector<FlowTree::Variant> variants;
+  EXPECT_TRUE(distinct_tree
+                  .GenerateVariants(
+                      [&variants](const FlowTree::Variant& variant) {
+                        variants.push_back(variant);
+                        return true;
+                      },
+                      /*distinct_only=*/true)
+                  .ok());
+  ASSERT_EQ(variants.size(), 2);
+  EXPECT_EQ(variants[0].size(), 2);
+  EXPECT_EQ(variants[1].size(), 1);
+}
+
+TEST(FlowTree, TooManyDistinctMacros) {
+  std::string test_case;
+  for (int i = 0; i <= 128; ++i) {
+    absl::StrAppend(&test_case, "`ifdef M", i, "\n x\n`endif\n");
+  }
+  FlowTree tree_test(LexToSequence(test_case));
+  const auto status =
+      tree_test.GenerateVariants([](const FlowTree::Variant&) { return true; });
+  EXPECT_TRUE(absl::IsResourceExhausted(status)) << status;
 }
 
 }  // namespace
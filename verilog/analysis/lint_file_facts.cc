@@ -0,0 +1,139 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/lint_file_facts.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/analysis/syntax_tree_search.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/syntax_tree_index.h"
+#include "common/text/text_structure.h"
+#include "verilog/CST/module.h"
+#include "verilog/CST/package.h"
+#include "verilog/CST/verilog_nonterminals.h"
+
+namespace verilog {
+
+using verible::IndexedTreeSearchMatch;
+using verible::Symbol;
+using verible::SyntaxTreeIndex;
+
+// The facts shared on this thread, while VerilogLinter analyzes a file.
+static std::shared_ptr<const LintFileFacts> &SharedFacts() {
+  static thread_local std::shared_ptr<const LintFileFacts> facts;
+  return facts;
+}
+
+LintFileFacts::LintFileFacts(const verible::TextStructureView &text_structure)
+    : text_structure_(text_structure) {}
+
+const std::vector<IndexedTreeSearchMatch> &LintFileFacts::ModuleDeclarations()
+    const {
+  if (!module_declarations_) {
+    const auto &tree = text_structure_.SyntaxTree();
+    module_declarations_ =
+        tree == nullptr ? std::vector<IndexedTreeSearchMatch>()
+                        : FindAllModuleDeclarations(Index(), *tree);
+  }
+  return *module_declarations_;
+}
+
+const std::vector<IndexedTreeSearchMatch> &
+LintFileFacts::OutermostModuleDeclarations() const {
+  if (!outermost_module_declarations_) {
+    auto &outermost = outermost_module_declarations_.emplace();
+    for (const IndexedTreeSearchMatch &module : ModuleDeclarations()) {
+      if (!module.context.IsInside(NodeEnum::kModuleDeclaration)) {
+        outermost.push_back(module);
+      }
+    }
+  }
+  return *outermost_module_declarations_;
+}
+
+const std::vector<IndexedTreeSearchMatch> &LintFileFacts::PackageDeclarations()
+    const {
+  if (!package_declarations_) {
+    const auto &tree = text_structure_.SyntaxTree();
+    package_declarations_ =
+        tree == nullptr ? std::vector<IndexedTreeSearchMatch>()
+                        : FindAllPackageDeclarations(Index(), *tree);
+  }
+  return *package_declarations_;
+}
+
+LintFileFacts::DefinedTypes LintFileFacts::TypesDefinedIn(
+    const Symbol &type_declaration) const {
+  if (!defined_types_) {
+    // Every type declaration around a data type defines it.
+    auto &defined_types = defined_types_.emplace();
+    const SyntaxTreeIndex &index = Index();
+    const auto mark_declarations = [&](NodeEnum type,
+                                       bool DefinedTypes::*defined) {
+      for (const uint32_t position : index.Find(verible::NodeTag(type))) {
+        for (uint32_t ancestor = index.ParentPosition(position);
+             ancestor != SyntaxTreeIndex::kNoPosition;
+             ancestor = index.ParentPosition(ancestor)) {
+          const Symbol &symbol = index.SymbolAt(ancestor);
+          if (NodeEnum(symbol.Tag().tag) == NodeEnum::kTypeDeclaration) {
+            defined_types[&symbol].*defined = true;
+          }
+        }
+      }
+    };
+    mark_declarations(NodeEnum::kEnumType, &DefinedTypes::enum_type);
+    mark_declarations(NodeEnum::kStructType, &DefinedTypes::struct_type);
+    mark_declarations(NodeEnum::kUnionType, &DefinedTypes::union_type);
+  }
+  const auto found = defined_types_->find(&type_declaration);
+  return found == defined_types_->end() ? DefinedTypes() : found->second;
+}
+
+std::shared_ptr<const LintFileFacts> LintFileFacts::For(
+    const verible::TextStructureView &text_structure) {
+  const std::shared_ptr<const LintFileFacts> &shared = SharedFacts();
+  if (shared != nullptr && &shared->TextStructure() == &text_structure) {
+    return shared;
+  }
+  return std::make_shared<const LintFileFacts>(text_structure);
+}
+
+const LintFileFacts *LintFileFacts::Find(
+    const Symbol &symbol, const verible::SyntaxTreeContext &context) {
+  const Symbol *root = context.empty() ? &symbol : *context.begin();
+  const std::shared_ptr<const LintFileFacts> &shared = SharedFacts();
+  if (shared == nullptr ||
+      shared->TextStructure().SyntaxTree().get() != root) {
+    return nullptr;
+  }
+  return shared.get();
+}
+
+LintFileFacts::SharedScope::SharedScope(
+    const verible::TextStructureView &text_structure)
+    : outer_(std::move(SharedFacts())) {
+  SharedFacts() = std::make_shared<const LintFileFacts>(text_structure);
+}
+
+LintFileFacts::SharedScope::~SharedScope() {
+  SharedFacts() = std::move(outer_);
+}
+
+}  // namespace verilog
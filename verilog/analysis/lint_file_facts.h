@@ -0,0 +1,123 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_LINT_FILE_FACTS_H_
+#define VERIBLE_VERILOG_ANALYSIS_LINT_FILE_FACTS_H_
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "common/analysis/syntax_tree_search.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/syntax_tree_index.h"
+#include "common/text/text_structure.h"
+
+namespace verilog {
+
+// LintFileFacts are facts about one file that several lint rules need, such
+// as all of its module declarations.  Each fact is computed the first time it
+// is asked for, so at most once per file, however many rules use it.
+//
+// While VerilogLinter analyzes a file, the facts of that file are shared with
+// all rules through For() and Find().  An instance is not thread-safe, but
+// every thread has its own shared facts.
+class LintFileFacts {
+ public:
+  // 'text_structure' must outlive this object, and its syntax tree must not
+  // change.
+  explicit LintFileFacts(const verible::TextStructureView &text_structure);
+
+  LintFileFacts(const LintFileFacts &) = delete;
+  LintFileFacts &operator=(const LintFileFacts &) = delete;
+
+  const verible::TextStructureView &TextStructure() const {
+    return text_structure_;
+  }
+
+  // Returns the index of the syntax tree, e.g. for SearchSyntaxTree().
+  const verible::SyntaxTreeIndex &Index() const {
+    return text_structure_.GetSyntaxTreeIndex();
+  }
+
+  // Returns all module declarations, in file order.
+  const std::vector<verible::IndexedTreeSearchMatch> &ModuleDeclarations()
+      const;
+
+  // Returns the module declarations that are not nested in another one.
+  const std::vector<verible::IndexedTreeSearchMatch> &
+  OutermostModuleDeclarations() const;
+
+  // Returns all package declarations, in file order.
+  const std::vector<verible::IndexedTreeSearchMatch> &PackageDeclarations()
+      const;
+
+  // Data types that are defined anywhere inside a type declaration.
+  struct DefinedTypes {
+    bool enum_type = false;
+    bool struct_type = false;
+    bool union_type = false;
+  };
+
+  // Returns the data types defined in 'type_declaration', a kTypeDeclaration
+  // node of the syntax tree.
+  DefinedTypes TypesDefinedIn(const verible::Symbol &type_declaration) const;
+
+  // Returns the facts that are shared while VerilogLinter analyzes
+  // 'text_structure' on this thread, or else new facts only for the caller.
+  static std::shared_ptr<const LintFileFacts> For(
+      const verible::TextStructureView &text_structure);
+
+  // Returns the shared facts of the file which contains 'symbol', with
+  // ancestors 'context', or nullptr if that file is not being analyzed by
+  // VerilogLinter on this thread.
+  static const LintFileFacts *Find(const verible::Symbol &symbol,
+                                   const verible::SyntaxTreeContext &context);
+
+  // Shares new facts of a file during the lifetime of this object, on this
+  // thread.
+  class SharedScope {
+   public:
+    explicit SharedScope(const verible::TextStructureView &text_structure);
+    ~SharedScope();
+
+    SharedScope(const SharedScope &) = delete;
+    SharedScope &operator=(const SharedScope &) = delete;
+
+   private:
+    // Facts that were shared before, restored at the end of this scope.
+    std::shared_ptr<const LintFileFacts> outer_;
+  };
+
+ private:
+  const verible::TextStructureView &text_structure_;
+
+  // Lazily computed facts.
+  mutable std::optional<std::vector<verible::IndexedTreeSearchMatch>>
+      module_declarations_;
+  mutable std::optional<std::vector<verible::IndexedTreeSearchMatch>>
+      outermost_module_declarations_;
+  mutable std::optional<std::vector<verible::IndexedTreeSearchMatch>>
+      package_declarations_;
+  mutable std::optional<
+      absl::flat_hash_map<const verible::Symbol *, DefinedTypes>>
+      defined_types_;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_LINT_FILE_FACTS_H_
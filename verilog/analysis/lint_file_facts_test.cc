@@ -0,0 +1,116 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/lint_file_facts.h"
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "common/text/symbol.h"
+#include "common/text/syntax_tree_context.h"
+#include "common/text/text_structure.h"
+#include "gtest/gtest.h"
+#include "verilog/CST/module.h"
+#include "verilog/CST/package.h"
+#include "verilog/CST/type.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+namespace {
+
+using verible::Symbol;
+
+TEST(LintFileFactsTest, Declarations) {
+  VerilogAnalyzer analyzer(
+      "module m; module inner; endmodule endmodule\n"
+      "package p; endpackage\n"
+      "module n; endmodule\n",
+      "<test>");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const LintFileFacts facts(analyzer.Data());
+
+  const auto &modules = facts.ModuleDeclarations();
+  ASSERT_EQ(modules.size(), 3);
+  const auto &outermost = facts.OutermostModuleDeclarations();
+  ASSERT_EQ(outermost.size(), 2);
+  EXPECT_EQ(GetModuleName(*outermost[0].match)->get().text(), "m");
+  EXPECT_EQ(GetModuleName(*outermost[1].match)->get().text(), "n");
+  // Facts are only computed once.
+  EXPECT_EQ(&facts.OutermostModuleDeclarations(), &outermost);
+
+  const auto &packages = facts.PackageDeclarations();
+  ASSERT_EQ(packages.size(), 1);
+  EXPECT_EQ(GetPackageNameToken(*packages[0].match)->text(), "p");
+}
+
+TEST(LintFileFactsTest, NoSyntaxTree) {
+  const verible::TextStructureView text_structure("");
+  const LintFileFacts facts(text_structure);
+  EXPECT_TRUE(facts.ModuleDeclarations().empty());
+  EXPECT_TRUE(facts.OutermostModuleDeclarations().empty());
+  EXPECT_TRUE(facts.PackageDeclarations().empty());
+}
+
+TEST(LintFileFactsTest, TypesDefinedIn) {
+  VerilogAnalyzer analyzer(
+      "typedef enum { A, B } e_t;\n"
+      "typedef struct { logic a; } s_t;\n"
+      "typedef union { logic a; } u_t;\n"
+      "typedef struct { enum { C } c; } se_t;\n"
+      "typedef logic [1:0] l_t;\n",
+      "<test>");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const LintFileFacts facts(analyzer.Data());
+
+  const auto declarations =
+      FindAllTypeDeclarations(*analyzer.Data().SyntaxTree());
+  ASSERT_EQ(declarations.size(), 5);
+  for (const auto &declaration : declarations) {
+    // The facts agree with searching each declaration.
+    const Symbol &symbol = *declaration.match;
+    const LintFileFacts::DefinedTypes types = facts.TypesDefinedIn(symbol);
+    EXPECT_EQ(types.enum_type, !FindAllEnumTypes(symbol).empty());
+    EXPECT_EQ(types.struct_type, !FindAllStructTypes(symbol).empty());
+    EXPECT_EQ(types.union_type, !FindAllUnionTypes(symbol).empty());
+  }
+  const LintFileFacts::DefinedTypes nested =
+      facts.TypesDefinedIn(*declarations[3].match);
+  EXPECT_TRUE(nested.enum_type);
+  EXPECT_TRUE(nested.struct_type);
+  EXPECT_FALSE(nested.union_type);
+}
+
+TEST(LintFileFactsTest, SharedWhileInScope) {
+  VerilogAnalyzer analyzer("module m; endmodule\n", "<test>");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const verible::TextStructureView &text_structure = analyzer.Data();
+  const Symbol &root = *text_structure.SyntaxTree();
+  const verible::SyntaxTreeContext no_context;
+
+  EXPECT_EQ(LintFileFacts::Find(root, no_context), nullptr);
+  const auto unshared = LintFileFacts::For(text_structure);
+  EXPECT_NE(unshared, LintFileFacts::For(text_structure));
+  {
+    const LintFileFacts::SharedScope scope(text_structure);
+    const LintFileFacts *shared = LintFileFacts::Find(root, no_context);
+    ASSERT_NE(shared, nullptr);
+    EXPECT_EQ(LintFileFacts::For(text_structure).get(), shared);
+    EXPECT_EQ(&shared->TextStructure(), &text_structure);
+  }
+  EXPECT_EQ(LintFileFacts::Find(root, no_context), nullptr);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -14,11 +14,19 @@
 
 #include "verilog/analysis/lint_rule_registry.h"
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/node_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "common/analysis/line_lint_rule.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/analysis/text_structure_lint_rule.h"
@@ -77,10 +85,18 @@ class LintRuleRegistry {
   // Registers a lint rule with the appropriate registry.
   static void Register(const LintDescriptionFun& descriptor,
                        const LintRuleGeneratorFun<RuleType>& creator) {
+    const LintRuleDescriptor described = descriptor();
     LintRuleInfo<RuleType> info;
     info.lint_rule_generator = creator;
     info.description = descriptor;
-    (*GetLintRuleRegistry<RuleType>())[descriptor().name] = info;
+    info.item_local = described.item_local;
+    (*GetLintRuleRegistry<RuleType>())[described.name] = info;
+  }
+
+  // Returns true if rule is registered and item-local.
+  static bool IsItemLocal(const LintRuleId& rule) {
+    const auto* info = FindOrNull(*GetLintRuleRegistry<RuleType>(), rule);
+    return info != nullptr && info->item_local;
   }
 
   // Returns the description of the specific rule, formatted for description
@@ -105,8 +121,163 @@ class LintRuleRegistry {
   LintRuleRegistry& operator=(const LintRuleRegistry&) = delete;
 };
 
+// Configured rule instances that are not in use, by rule name and
+// configuration.
+template <typename RuleType>
+class LintRulePool {
+ public:
+  // Allocated once, never freed, as instances return here until the end.
+  static LintRulePool* Get() {
+    static auto* pool = new LintRulePool();
+    return pool;
+  }
+
+  // Returns an idle instance, or nullptr if there is none.
+  std::unique_ptr<RuleType> Take(const LintRuleId& rule,
+                                 absl::string_view configuration) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found_rule = idle_.find(rule);
+    if (found_rule == idle_.end()) return nullptr;
+    const auto found = found_rule->second.find(configuration);
+    if (found == found_rule->second.end() || found->second.empty()) {
+      return nullptr;
+    }
+    std::unique_ptr<RuleType> instance = std::move(found->second.back());
+    found->second.pop_back();
+    return instance;
+  }
+
+  // Keeps "instance", which has been Reset(), for re-use.
+  void Put(const LintRuleId& rule, std::string configuration,
+           std::unique_ptr<RuleType> instance) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    idle_[rule][std::move(configuration)].push_back(std::move(instance));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<LintRuleId,
+           std::map<std::string, std::vector<std::unique_ptr<RuleType>>,
+                    std::less<>>>
+      idle_;
+};
+
+// Forwards to a rule instance from the pool, which it puts back into the pool
+// when deleted.  Specialized below for each RuleType.
+template <typename RuleType>
+class PooledLintRuleBase : public RuleType {
+ public:
+  PooledLintRuleBase(const LintRuleId& rule, absl::string_view configuration,
+                     std::unique_ptr<RuleType> instance)
+      : rule_(rule),
+        configuration_(configuration),
+        instance_(std::move(instance)) {}
+
+  ~PooledLintRuleBase() override {
+    if (instance_->Reset()) {
+      LintRulePool<RuleType>::Get()->Put(rule_, std::move(configuration_),
+                                         std::move(instance_));
+    }
+  }
+
+  absl::Status Configure(absl::string_view configuration) final {
+    absl::Status status = instance_->Configure(configuration);
+    if (status.ok()) configuration_ = std::string(configuration);
+    return status;
+  }
+
+  verible::LintRuleStatus Report() const final { return instance_->Report(); }
+
+  bool Reset() final { return instance_->Reset(); }
+
+ protected:
+  const LintRuleId rule_;
+  std::string configuration_;
+  std::unique_ptr<RuleType> instance_;
+};
+
+template <typename RuleType>
+class PooledLintRule;
+
+template <>
+class PooledLintRule<SyntaxTreeLintRule> final
+    : public PooledLintRuleBase<SyntaxTreeLintRule> {
+ public:
+  using PooledLintRuleBase::PooledLintRuleBase;
+
+  std::vector<verible::SymbolTag> HandledSymbolTags() const final {
+    return instance_->HandledSymbolTags();
+  }
+  void HandleLeaf(const verible::SyntaxTreeLeaf& leaf,
+                  const verible::SyntaxTreeContext& context) final {
+    instance_->HandleLeaf(leaf, context);
+  }
+  void HandleNode(const verible::SyntaxTreeNode& node,
+                  const verible::SyntaxTreeContext& context) final {
+    instance_->HandleNode(node, context);
+  }
+  void HandleSymbol(const verible::Symbol& symbol,
+                    const verible::SyntaxTreeContext& context) final {
+    instance_->HandleSymbol(symbol, context);
+  }
+};
+
+template <>
+class PooledLintRule<TokenStreamLintRule> final
+    : public PooledLintRuleBase<TokenStreamLintRule> {
+ public:
+  using PooledLintRuleBase::PooledLintRuleBase;
+
+  void HandleToken(const verible::TokenInfo& token) final {
+    instance_->HandleToken(token);
+  }
+};
+
+template <>
+class PooledLintRule<LineLintRule> final
+    : public PooledLintRuleBase<LineLintRule> {
+ public:
+  using PooledLintRuleBase::PooledLintRuleBase;
+
+  void HandleLine(absl::string_view line) final {
+    instance_->HandleLine(line);
+  }
+  void Finalize() final { instance_->Finalize(); }
+};
+
+template <>
+class PooledLintRule<TextStructureLintRule> final
+    : public PooledLintRuleBase<TextStructureLintRule> {
+ public:
+  using PooledLintRuleBase::PooledLintRuleBase;
+
+  void Lint(const verible::TextStructureView& text_structure,
+            absl::string_view filename) final {
+    instance_->Lint(text_structure, filename);
+  }
+};
+
 }  // namespace
 
+template <typename RuleType>
+absl::StatusOr<std::unique_ptr<RuleType>> CreatePooledLintRule(
+    const LintRuleId& rule_name, absl::string_view configuration) {
+  std::unique_ptr<RuleType> instance =
+      LintRulePool<RuleType>::Get()->Take(rule_name, configuration);
+  if (instance == nullptr) {
+    instance = LintRuleRegistry<RuleType>::CreateLintRule(rule_name);
+    if (instance == nullptr) return nullptr;
+    if (!configuration.empty()) {
+      if (absl::Status status = instance->Configure(configuration);
+          !status.ok()) {
+        return status;
+      }
+    }
+  }
+  return std::make_unique<PooledLintRule<RuleType>>(rule_name, configuration,
+                                                    std::move(instance));
+}
+
 template <typename RuleType>
 LintRuleRegisterer<RuleType>::LintRuleRegisterer(
     const LintDescriptionFun& descriptor,
@@ -132,6 +303,10 @@ std::unique_ptr<SyntaxTreeLintRule> CreateSyntaxTreeLintRule(
   return LintRuleRegistry<SyntaxTreeLintRule>::CreateLintRule(rule_name);
 }
 
+bool IsItemLocalSyntaxTreeRule(const LintRuleId& rule_name) {
+  return LintRuleRegistry<SyntaxTreeLintRule>::IsItemLocal(rule_name);
+}
+
 std::vector<LintRuleId> RegisteredTokenStreamRulesNames() {
   return LintRuleRegistry<TokenStreamLintRule>::GetRegisteredRulesNames();
 }
@@ -185,7 +360,16 @@ LintRuleDescriptionsMap GetAllRuleDescriptions() {
   return res;
 }
 
-// Explicit template class instantiations
+// Explicit template instantiations
+template absl::StatusOr<std::unique_ptr<LineLintRule>> CreatePooledLintRule(
+    const LintRuleId&, absl::string_view);
+template absl::StatusOr<std::unique_ptr<SyntaxTreeLintRule>>
+CreatePooledLintRule(const LintRuleId&, absl::string_view);
+template absl::StatusOr<std::unique_ptr<TextStructureLintRule>>
+CreatePooledLintRule(const LintRuleId&, absl::string_view);
+template absl::StatusOr<std::unique_ptr<TokenStreamLintRule>>
+CreatePooledLintRule(const LintRuleId&, absl::string_view);
+
 template class LintRuleRegisterer<LineLintRule>;
 template class LintRuleRegisterer<SyntaxTreeLintRule>;
 template class LintRuleRegisterer<TextStructureLintRule>;
@@ -34,6 +34,8 @@
 #include <set>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "common/analysis/line_lint_rule.h"
 #include "common/analysis/syntax_tree_lint_rule.h"
 #include "common/analysis/text_structure_lint_rule.h"
@@ -55,6 +57,7 @@ template <typename RuleType>
 struct LintRuleInfo {
   LintRuleGeneratorFun<RuleType> lint_rule_generator;
   LintDescriptionFun description;
+  bool item_local = false;  // See LintRuleDescriptor::item_local.
 };
 
 struct LintRuleDefaultConfig {
@@ -122,6 +125,10 @@ std::vector<LintRuleId> RegisteredSyntaxTreeRulesNames();
 std::unique_ptr<verible::SyntaxTreeLintRule> CreateSyntaxTreeLintRule(
     const LintRuleId& rule_name);
 
+// Returns true if rule_name refers to a syntax tree rule that is item-local
+// (see LintRuleDescriptor::item_local).
+bool IsItemLocalSyntaxTreeRule(const LintRuleId& rule_name);
+
 // Returns sequence of token stream rule names.
 std::vector<LintRuleId> RegisteredTokenStreamRulesNames();
 
@@ -143,6 +150,17 @@ std::vector<LintRuleId> RegisteredTextStructureRulesNames();
 std::unique_ptr<verible::TextStructureLintRule> CreateTextStructureLintRule(
     const LintRuleId& rule_name);
 
+// Returns an instance of the rule "rule_name" of RuleType, configured with
+// "configuration".  When possible, this re-uses an instance that analyzed
+// another file with the same configuration, and was deleted since (see
+// verible::LintRule::Reset()), which saves constructing and configuring it
+// again for every file.
+// Returns nullptr if there is no such rule of RuleType, and the error of
+// configuring it if that fails.
+template <typename RuleType>
+absl::StatusOr<std::unique_ptr<RuleType>> CreatePooledLintRule(
+    const LintRuleId& rule_name, absl::string_view configuration);
+
 // Returns set of all registered lint rule names.
 // When storing string_views to the lint rule keys, use the ones returned in
 // this set, because their lifetime is guaranteed by the registration process.
@@ -68,6 +68,7 @@ class TreeRule1 : public TreeRuleBase {
   }
 };
 
+// Accepts any configuration, and can be re-used.
 class TreeRule2 : public TreeRuleBase {
  public:
   using rule_type = SyntaxTreeLintRule;
@@ -75,11 +76,22 @@ class TreeRule2 : public TreeRuleBase {
     static const LintRuleDescriptor d{
         .name = "test-rule-2",
         .desc = "TreeRule2",
+        .item_local = true,
     };
     return d;
   }
+
+  absl::Status Configure(absl::string_view) final {
+    ++configure_count;
+    return absl::OkStatus();
+  }
+  bool Reset() final { return true; }
+
+  static int configure_count;
 };
 
+int TreeRule2::configure_count = 0;
+
 VERILOG_REGISTER_LINT_RULE(TreeRule1);
 VERILOG_REGISTER_LINT_RULE(TreeRule2);
 
@@ -93,6 +105,13 @@ TEST(LintRuleRegistryTest, ContainsTreeRuleFalse) {
   EXPECT_FALSE(IsRegisteredLintRule("invalid-id"));
 }
 
+// Verifies that item-locality is looked up from the rule descriptor.
+TEST(LintRuleRegistryTest, IsItemLocalSyntaxTreeRule) {
+  EXPECT_TRUE(IsItemLocalSyntaxTreeRule("test-rule-2"));
+  EXPECT_FALSE(IsItemLocalSyntaxTreeRule("test-rule-1"));
+  EXPECT_FALSE(IsItemLocalSyntaxTreeRule("invalid-id"));
+}
+
 // Verifies that a nonexistent syntax tree rule yields a nullptr.
 TEST(LintRuleRegistryTest, CreateTreeLintRuleInvalid) {
   EXPECT_EQ(CreateSyntaxTreeLintRule("invalid-id"), nullptr);
@@ -108,6 +127,47 @@ TEST(LintRuleRegistryTest, CreateTreeLintRuleValid) {
 #endif
 }
 
+// Verifies that deleted pooled rules are re-used if they can be reset.
+TEST(LintRuleRegistryTest, CreatePooledLintRuleReusesInstances) {
+  TreeRule2::configure_count = 0;
+  {
+    auto rule_or = CreatePooledLintRule<SyntaxTreeLintRule>("test-rule-2", "a");
+    ASSERT_TRUE(rule_or.ok());
+    EXPECT_NE(*rule_or, nullptr);
+  }
+  EXPECT_EQ(TreeRule2::configure_count, 1);
+
+  // The deleted instance is re-used without configuring it again.
+  auto reused_or = CreatePooledLintRule<SyntaxTreeLintRule>("test-rule-2", "a");
+  ASSERT_TRUE(reused_or.ok());
+  EXPECT_NE(*reused_or, nullptr);
+  EXPECT_EQ(TreeRule2::configure_count, 1);
+
+  // Instances in use, or with another configuration, are not re-used.
+  auto second_or = CreatePooledLintRule<SyntaxTreeLintRule>("test-rule-2", "a");
+  ASSERT_TRUE(second_or.ok());
+  EXPECT_EQ(TreeRule2::configure_count, 2);
+  auto other_or = CreatePooledLintRule<SyntaxTreeLintRule>("test-rule-2", "b");
+  ASSERT_TRUE(other_or.ok());
+  EXPECT_EQ(TreeRule2::configure_count, 3);
+}
+
+// Verifies that pooled rule creation reports unknown rules and invalid
+// configurations.
+TEST(LintRuleRegistryTest, CreatePooledLintRuleInvalid) {
+  auto unknown_or = CreatePooledLintRule<SyntaxTreeLintRule>("invalid-id", "");
+  ASSERT_TRUE(unknown_or.ok());
+  EXPECT_EQ(*unknown_or, nullptr);
+
+  auto other_type_or =
+      CreatePooledLintRule<TokenStreamLintRule>("test-rule-1", "");
+  ASSERT_TRUE(other_type_or.ok());
+  EXPECT_EQ(*other_type_or, nullptr);
+
+  EXPECT_FALSE(
+      CreatePooledLintRule<SyntaxTreeLintRule>("test-rule-1", "bad").ok());
+}
+
 // Verifies that GetAllRuleDescriptionsHelpFlag correctly gets the descriptions
 // for a SyntaxTreeLintRule.
 TEST(GetAllRuleDescriptions, SyntaxRuleValid) {
@@ -16,15 +16,22 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <future>
 #include <initializer_list>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <new>
+#include <set>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -33,6 +40,7 @@
 #include "absl/strings/strip.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "common/analysis/syntax_tree_search.h"
 #include "common/strings/display_utils.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
@@ -44,11 +52,16 @@
 #include "common/util/casts.h"
 #include "common/util/enum_flags.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
+#include "common/util/range.h"
 #include "common/util/spacer.h"
+#include "common/util/thread_pool.h"
+#include "common/util/trace.h"
 #include "common/util/tree_operations.h"
 #include "common/util/value_saver.h"
 #include "verilog/CST/class.h"
 #include "verilog/CST/declaration.h"
+#include "verilog/CST/dimensions.h"
 #include "verilog/CST/functions.h"
 #include "verilog/CST/macro.h"
 #include "verilog/CST/module.h"
@@ -182,6 +195,73 @@ static absl::Status DiagnoseMemberSymbolResolutionFailure(
 static const SymbolTableNode *LookupSymbolUpwards(
     const SymbolTableNode &context, absl::string_view symbol);
 
+// Returns the text from the first to the last of 'dimensions', or empty.
+static absl::string_view SpanOfDimensions(
+    const std::vector<verible::TreeSearchMatch> &dimensions) {
+  if (dimensions.empty()) return {};
+  const absl::string_view first = StringSpanOfSymbol(*dimensions.front().match);
+  const absl::string_view last = StringSpanOfSymbol(*dimensions.back().match);
+  return {first.data(), static_cast<size_t>(last.end() - first.begin())};
+}
+
+// Adds the port declared by 'port_node', a kPortDeclaration or
+// kModulePortDeclaration, to 'signature', unless it is already there.
+static void AddSignaturePort(const SyntaxTreeNode &port_node,
+                             ModuleSignature *signature) {
+  const bool in_header =
+      NodeEnum(port_node.Tag().tag) == NodeEnum::kPortDeclaration;
+  const SyntaxTreeLeaf *const direction =
+      in_header ? GetDirectionFromPortDeclaration(port_node)
+                : GetDirectionFromModulePortDeclaration(port_node);
+  const SyntaxTreeLeaf *const id =
+      in_header ? GetIdentifierFromPortDeclaration(port_node)
+                : GetIdentifierFromModulePortDeclaration(port_node);
+  if (direction == nullptr || id == nullptr) return;
+  const absl::string_view name = id->get().text();
+  if (!signature->port_index.try_emplace(name, signature->ports.size())
+           .second) {
+    return;
+  }
+  signature->ports.push_back({
+      .name = name,
+      .direction = direction->get().text(),
+      .packed_dimensions =
+          SpanOfDimensions(FindAllPackedDimensions(port_node)),
+      .unpacked_dimensions =
+          SpanOfDimensions(FindAllUnpackedDimensions(port_node)),
+      .declaration = &port_node,
+  });
+}
+
+// Collects the ports of 'module' from its header and body, and its
+// parameters from its (already built) 'scope'.
+static std::unique_ptr<const ModuleSignature> BuildModuleSignature(
+    const SyntaxTreeNode &module, const SymbolTableNode &scope) {
+  auto signature = std::make_unique<ModuleSignature>();
+  if (const SyntaxTreeNode *header_ports =
+          GetModulePortDeclarationList(module)) {
+    for (const verible::SymbolPtr &port : header_ports->children()) {
+      if (port == nullptr || port->Kind() != verible::SymbolKind::kNode) {
+        continue;
+      }
+      const SyntaxTreeNode &port_node = SymbolCastToNode(*port);
+      if (NodeEnum(port_node.Tag().tag) == NodeEnum::kPortDeclaration) {
+        AddSignaturePort(port_node, signature.get());
+      }
+    }
+  }
+  for (const auto &port : FindAllModulePortDeclarations(module)) {
+    AddSignaturePort(SymbolCastToNode(*port.match), signature.get());
+  }
+  for (const auto &[name, symbol] : scope) {
+    if (symbol.Value().metatype != SymbolMetaType::kParameter) continue;
+    signature->parameter_index.try_emplace(name,
+                                           signature->parameters.size());
+    signature->parameters.push_back(name);
+  }
+  return signature;
+}
+
 class SymbolTable::Builder : public TreeContextVisitor {
  public:
   Builder(const VerilogSourceFile &source, SymbolTable *symbol_table,
@@ -331,8 +411,11 @@ class SymbolTable::Builder : public TreeContextVisitor {
     explicit CaptureDependentReference(Builder *builder)
         : builder_(builder),
           saved_branch_point_(builder_->reference_branch_point_) {
-      // Push stack space to capture references.
-      builder_->reference_builders_.emplace(/* DependentReferences */);
+      // Push stack space to capture references.  Their roots are allocated
+      // in the scope that will own them.
+      auto &arena = builder_->current_scope_->Value().reference_arena;
+      if (arena == nullptr) arena = std::make_unique<ReferenceComponentArena>();
+      builder_->reference_builders_.emplace(arena.get());
       // Reset the branch point to start new named parameter/port chains
       // from the same context.
       builder_->reference_branch_point_ = nullptr;
@@ -344,8 +427,11 @@ class SymbolTable::Builder : public TreeContextVisitor {
       // Empty refs are non-actionable and must be excluded.
       DependentReferences &ref(Ref());
       if (!ref.Empty()) {
-        builder_->current_scope_->Value().local_references_to_bind.emplace_back(
-            std::move(ref));
+        SymbolTableNode &scope = *builder_->current_scope_;
+        auto &references = scope.Value().local_references_to_bind;
+        references.emplace_back(std::move(ref));
+        builder_->symbol_table_->AddReference(
+            scope, references.back().components.get());
       }
       builder_->reference_builders_.pop();
       builder_->reference_branch_point_ = saved_branch_point_;  // restore
@@ -1020,12 +1106,12 @@ class SymbolTable::Builder : public TreeContextVisitor {
                                                 SymbolMetaType metatype) {
     const auto [kv, did_emplace] = current_scope_->TryEmplace(
         name, SymbolInfo{metatype, source_, &element});
-    if (!did_emplace) {
-      if (kv->second.Value().is_port_identifier) {
-        kv->second.Value().supplement_definitions.push_back(name);
-      } else {
-        DiagnoseSymbolAlreadyExists(name, kv->second);
-      }
+    if (did_emplace) {
+      symbol_table_->AddDefinition(name);
+    } else if (kv->second.Value().is_port_identifier) {
+      kv->second.Value().supplement_definitions.push_back(name);
+    } else {
+      DiagnoseSymbolAlreadyExists(name, kv->second);
     }
     return &kv->second;  // scope of the new (or pre-existing symbol)
   }
@@ -1187,12 +1273,12 @@ class SymbolTable::Builder : public TreeContextVisitor {
                   // associate this instance with its declared type
                   *ABSL_DIE_IF_NULL(declaration_type_info_),  // copy
               });
-    if (!passed) {
-      if (kv->second.Value().is_port_identifier) {
-        CheckMultilinePortDeclarationCorrectness(&kv->second, name);
-      } else {
-        DiagnoseSymbolAlreadyExists(name, kv->second);
-      }
+    if (passed) {
+      symbol_table_->AddDefinition(name);
+    } else if (kv->second.Value().is_port_identifier) {
+      CheckMultilinePortDeclarationCorrectness(&kv->second, name);
+    } else {
+      DiagnoseSymbolAlreadyExists(name, kv->second);
     }
     VLOG(2) << "end of " << __FUNCTION__ << ": " << name;
     return kv->second;  // scope of the new (or pre-existing symbol)
@@ -1214,7 +1300,9 @@ class SymbolTable::Builder : public TreeContextVisitor {
                   *ABSL_DIE_IF_NULL(declaration_type_info_),  // copy
               });
     p.first->second.Value().is_port_identifier = true;
-    if (!p.second) {
+    if (p.second) {
+      symbol_table_->AddDefinition(name);
+    } else {
       // the symbol was already defined, add it to supplement_definitions
       CheckMultilinePortDeclarationCorrectness(&p.first->second, name);
     }
@@ -1237,8 +1325,13 @@ class SymbolTable::Builder : public TreeContextVisitor {
   void DeclareModule(const SyntaxTreeNode &module) {
     const SyntaxTreeLeaf *module_name = GetModuleName(module);
     if (!module_name) return;
-    DeclareScopedElementAndDescend(module, module_name->get().text(),
-                                   SymbolMetaType::kModule);
+    SymbolTableNode *module_scope = DeclareScopedElementAndDescend(
+        module, module_name->get().text(), SymbolMetaType::kModule);
+    // Of duplicate modules, the signature is of the one that was kept.
+    SymbolInfo &info = module_scope->Value();
+    if (info.syntax_origin == &module && info.module_signature == nullptr) {
+      info.module_signature = BuildModuleSignature(module, *module_scope);
+    }
   }
 
   absl::string_view GetScopeNameFromGenerateBody(const SyntaxTreeNode &body) {
@@ -1545,6 +1638,7 @@ class SymbolTable::Builder : public TreeContextVisitor {
       // If injection succeeded, then the outer_scope did not already contain a
       // forward declaration of the inner symbol to be defined.
       // Diagnose this non-fatally, but continue.
+      symbol_table_->AddDefinition(inner_key);
       diagnostics_.push_back(
           DiagnoseMemberSymbolResolutionFailure(inner_key, *outer_scope));
     } else {
@@ -1818,12 +1912,45 @@ ReferenceComponentNode *DependentReferences::LastTypeComponent() {
   return ReferenceLastTypeComponent(node);
 }
 
+ReferenceComponentArena::~ReferenceComponentArena() {
+  // The references that own the nodes must have been destroyed first.
+  CHECK_EQ(size(), 0u);
+}
+
+ReferenceComponentNode *ReferenceComponentArena::New(
+    const ReferenceComponent &component) {
+  Slot *slot;
+  if (free_.empty()) {
+    slot = &slots_.emplace_back();
+  } else {
+    slot = free_.back();
+    free_.pop_back();
+  }
+  return new (slot->bytes) ReferenceComponentNode(component);  // copy
+}
+
+void ReferenceComponentArena::Delete(ReferenceComponentNode *node) {
+  node->~ReferenceComponentNode();
+  free_.push_back(reinterpret_cast<Slot *>(node));
+}
+
+void ReferenceComponentNodeDeleter::operator()(
+    ReferenceComponentNode *node) const {
+  if (arena == nullptr) {
+    delete node;
+  } else {
+    arena->Delete(node);
+  }
+}
+
 ReferenceComponentNode *DependentReferences::PushReferenceComponent(
     const ReferenceComponent &component) {
   VLOG(3) << __FUNCTION__ << ", id: " << component.identifier;
   ReferenceComponentNode *new_child;
   if (Empty()) {
-    components = std::make_unique<ReferenceComponentNode>(component);  // copy
+    ReferenceComponentArena *arena = components.get_deleter().arena;
+    components.reset(arena == nullptr ? new ReferenceComponentNode(component)
+                                      : arena->New(component));  // copy
     new_child = components.get();
   } else {
     // Find the last node from which references can be grown.
@@ -2193,13 +2320,29 @@ void DeclarationTypeInfo::VerifySymbolTableRoot(
   }
 }
 
+absl::string_view AnonymousScopeNames::Add(absl::string_view name) {
+  static constexpr size_t kFirstBlockSize = 64;
+  static constexpr size_t kMaxBlockSize = 4096;
+  if (blocks_.empty() || block_used_ + name.length() > block_capacity_) {
+    block_capacity_ = std::max(
+        name.length(),
+        blocks_.empty() ? kFirstBlockSize
+                        : std::min(block_capacity_ * 2, kMaxBlockSize));
+    blocks_.push_back(std::make_unique<char[]>(block_capacity_));
+    block_used_ = 0;
+  }
+  char *const copy = blocks_.back().get() + block_used_;
+  std::copy(name.begin(), name.end(), copy);
+  block_used_ += name.length();
+  ++size_;
+  return {copy, name.length()};
+}
+
 absl::string_view SymbolInfo::CreateAnonymousScope(absl::string_view base) {
-  const size_t n = anonymous_scope_names.size();
-  anonymous_scope_names.emplace_back(std::make_unique<const std::string>(
-      // Starting with a non-alpha character guarantees it cannot collide with
-      // any user-given identifier.
-      absl::StrCat("%", "anon-", base, "-", n)));
-  return *anonymous_scope_names.back();
+  // Starting with a non-alpha character guarantees it cannot collide with
+  // any user-given identifier.
+  return anonymous_scope_names.Add(
+      absl::StrCat("%", "anon-", base, "-", anonymous_scope_names.size()));
 }
 
 std::ostream &operator<<(std::ostream &stream,
@@ -2231,6 +2374,14 @@ std::ostream &operator<<(std::ostream &stream,
   return stream << " }";
 }
 
+size_t ModuleSignature::MemoryUsage() const {
+  using IndexEntry = std::pair<absl::string_view, size_t>;
+  return sizeof(ModuleSignature) + ports.capacity() * sizeof(Port) +
+         parameters.capacity() * sizeof(absl::string_view) +
+         (port_index.capacity() + parameter_index.capacity()) *
+             (sizeof(IndexEntry) + 1);
+}
+
 void SymbolInfo::VerifySymbolTableRoot(const SymbolTableNode *root) const {
   declared_type.VerifySymbolTableRoot(root);
   for (const auto &local_ref : local_references_to_bind) {
@@ -2302,18 +2453,308 @@ void SymbolTable::CheckIntegrity() const {
       [=](const SymbolInfo &s) { s.VerifySymbolTableRoot(root); });
 }
 
+// Time spent resolving the references of scopes, by the file defining them.
+using FileResolveTimes =
+    absl::flat_hash_map<const VerilogSourceFile *, absl::Duration>;
+
+using FileTimesMap =
+    std::map<std::string, SymbolTable::Stats::FileTimes, std::less<>>;
+
+// Replaces the resolve times of all files with 'times'.
+static void SetResolveTimes(const FileResolveTimes &times,
+                            FileTimesMap *file_times) {
+  for (auto &file : *file_times) file.second.resolve = absl::ZeroDuration();
+  for (const auto &[file, time] : times) {
+    const absl::string_view path =
+        file == nullptr ? absl::string_view() : file->ReferencedPath();
+    (*file_times)[std::string(path)].resolve = time;
+  }
+}
+
 void SymbolTable::Resolve(std::vector<absl::Status> *diagnostics) {
+  const verible::ScopedTrace trace("resolve", "symbol-table");
   const absl::Time start = absl::Now();
-  symbol_table_root_.ApplyPreOrder(
-      [=](SymbolTableNode &node) { node.Value().Resolve(node, diagnostics); });
+  FileResolveTimes times;
+  symbol_table_root_.ApplyPreOrder([&](SymbolTableNode &node) {
+    SymbolInfo &info = node.Value();
+    if (info.local_references_to_bind.empty()) return;
+    const absl::Time scope_start = absl::Now();
+    info.Resolve(node, diagnostics);
+    times[info.file_origin] += absl::Now() - scope_start;
+  });
+  SetResolveTimes(times, &file_times_);
+  resolved_ = true;
+  changed_names_.clear();
+  new_references_.clear();
   VLOG(1) << "SymbolTable::Resolve took " << (absl::Now() - start);
 }
 
+// Returns the components that are a type of a declaration or a base class.
+// Resolving a reference may look at what these are resolved to.
+static absl::flat_hash_set<const ReferenceComponentNode *>
+CollectTypeReferences(const SymbolTableNode &root) {
+  absl::flat_hash_set<const ReferenceComponentNode *> type_references;
+  root.ApplyPreOrder([&type_references](const SymbolInfo &info) {
+    if (info.declared_type.user_defined_type) {
+      type_references.insert(info.declared_type.user_defined_type);
+    }
+    if (info.parent_type.user_defined_type) {
+      type_references.insert(info.parent_type.user_defined_type);
+    }
+  });
+  return type_references;
+}
+
+void SymbolTable::Resolve(std::vector<absl::Status> *diagnostics,
+                          int threads) {
+  const verible::ScopedTrace trace("resolve", "symbol-table");
+  const absl::Time start = absl::Now();
+  const absl::flat_hash_set<const ReferenceComponentNode *> type_references =
+      CollectTypeReferences(symbol_table_root_);
+  const auto has_type_reference = [&type_references](
+                                      const DependentReferences &ref) {
+    bool found = false;
+    verible::ApplyPreOrder(*ref.components,
+                           [&](const ReferenceComponentNode &node) {
+                             found |= type_references.contains(&node);
+                           });
+    return found;
+  };
+
+  // Resolve the types serially, and collect the other references by scope.
+  struct ScopeReferences {
+    const SymbolTableNode *scope;
+    std::vector<const DependentReferences *> references;
+  };
+  std::vector<ScopeReferences> scopes;
+  size_t num_references = 0;
+  FileResolveTimes times;
+  symbol_table_root_.ApplyPreOrder([&](const SymbolTableNode &node) {
+    ScopeReferences *scope = nullptr;
+    const absl::Time scope_start = absl::Now();
+    for (const DependentReferences &ref :
+         node.Value().local_references_to_bind) {
+      if (ref.Empty()) continue;
+      if (has_type_reference(ref)) {
+        ref.Resolve(node, diagnostics);
+        continue;
+      }
+      if (!scope) scope = &scopes.emplace_back(ScopeReferences{&node, {}});
+      scope->references.push_back(&ref);
+      ++num_references;
+    }
+    if (!node.Value().local_references_to_bind.empty()) {
+      times[node.Value().file_origin] += absl::Now() - scope_start;
+    }
+  });
+
+  // These only write to their own components, and only read the components
+  // of their own and the type references.  A few chunks per thread balance
+  // the load.
+  const size_t chunk_references = num_references / std::max(1, 4 * threads);
+  std::vector<std::pair<size_t, size_t>> chunks;  // Ranges of scopes.
+  for (size_t begin = 0; begin < scopes.size();) {
+    size_t end = begin;
+    for (size_t references = 0;
+         end < scopes.size() && references <= chunk_references; ++end) {
+      references += scopes[end].references.size();
+    }
+    chunks.emplace_back(begin, end);
+    begin = end;
+  }
+  std::vector<std::vector<absl::Status>> chunk_diagnostics(chunks.size());
+  std::vector<FileResolveTimes> chunk_times(chunks.size());
+  std::vector<std::future<bool>> chunks_done;
+  verible::ThreadPool pool(threads);
+  for (size_t c = 0; c < chunks.size(); ++c) {
+    chunks_done.push_back(pool.ExecAsync<bool>([&, c]() {
+      for (size_t i = chunks[c].first; i < chunks[c].second; ++i) {
+        const absl::Time scope_start = absl::Now();
+        for (const DependentReferences *ref : scopes[i].references) {
+          ref->Resolve(*scopes[i].scope, &chunk_diagnostics[c]);
+        }
+        chunk_times[c][scopes[i].scope->Value().file_origin] +=
+            absl::Now() - scope_start;
+      }
+      return true;
+    }));
+  }
+  for (auto &done : chunks_done) done.get();
+  for (auto &chunk : chunk_diagnostics) {
+    diagnostics->insert(diagnostics->end(), chunk.begin(), chunk.end());
+  }
+  // The times of all threads add up, like CPU time.
+  for (const auto &chunk : chunk_times) {
+    for (const auto &[file, time] : chunk) times[file] += time;
+  }
+  SetResolveTimes(times, &file_times_);
+  resolved_ = true;
+  changed_names_.clear();
+  new_references_.clear();
+  VLOG(1) << "SymbolTable::Resolve() on " << threads << " threads took "
+          << (absl::Now() - start);
+}
+
+// Returns true if any component of the reference tree 'node' is unbound.
+static bool AnyUnboundComponent(const ReferenceComponentNode &node) {
+  if (node.Value().resolved_symbol == nullptr) return true;
+  for (const auto &child : node.Children()) {
+    if (AnyUnboundComponent(child)) return true;
+  }
+  return false;
+}
+
+static void ResolveIndexedReference(const ReferenceNameIndex::Entry &ref,
+                                    std::vector<absl::Status> *diagnostics) {
+  ApplyPreOrder(*ref.components, [&](ReferenceComponentNode &node) {
+    ResolveReferenceComponentNode(&node, *ref.scope, diagnostics);
+  });
+}
+
+void SymbolTable::ResolveAffected(std::vector<absl::Status> *diagnostics) {
+  if (!resolved_) {
+    Resolve(diagnostics);
+    return;
+  }
+  const verible::ScopedTrace trace("resolve-affected", "symbol-table");
+  const absl::Time start = absl::Now();
+  absl::flat_hash_set<const ReferenceComponentNode *> visited;
+  std::vector<ReferenceNameIndex::Entry> affected;
+  for (const ReferenceNameIndex::Entry &ref : new_references_) {
+    if (visited.insert(ref.components).second) affected.push_back(ref);
+  }
+  for (const std::string &name : changed_names_) {
+    for (const ReferenceNameIndex::Entry &ref : reference_index_.Find(name)) {
+      if (!visited.insert(ref.components).second) continue;
+      // The reference may now resolve to another (e.g. closer) definition.
+      ApplyPreOrder(*ref.components, [](ReferenceComponentNode &node) {
+        node.Value().resolved_symbol = nullptr;
+      });
+      affected.push_back(ref);
+    }
+  }
+
+  // A member of a type can only be resolved once the type is, which may be
+  // referenced by a later reference, so what remains unbound is resolved
+  // once more, and only that pass is diagnosed.
+  std::vector<absl::Status> first_pass_diagnostics;
+  for (const ReferenceNameIndex::Entry &ref : affected) {
+    ResolveIndexedReference(ref, &first_pass_diagnostics);
+  }
+  for (const ReferenceNameIndex::Entry &ref : affected) {
+    if (AnyUnboundComponent(*ref.components)) {
+      ResolveIndexedReference(ref, diagnostics);
+    }
+  }
+  VLOG(1) << "SymbolTable::ResolveAffected() resolved " << affected.size()
+          << " references of " << changed_names_.size() << " changed names in "
+          << (absl::Now() - start);
+  changed_names_.clear();
+  new_references_.clear();
+}
+
 void SymbolTable::ResolveLocallyOnly() {
   symbol_table_root_.ApplyPreOrder(
       [=](SymbolTableNode &node) { node.Value().ResolveLocally(node); });
 }
 
+// Adds the components of the reference tree 'node' to 'stats', and the bytes
+// of their children's storage.  Returns false if any component is unbound.
+static bool AddReferenceComponentStats(const ReferenceComponentNode &node,
+                                       SymbolTable::Stats *stats) {
+  ++stats->components;
+  stats->reference_bytes +=
+      node.Children().capacity() * sizeof(ReferenceComponentNode);
+  bool resolved = node.Value().resolved_symbol != nullptr;
+  for (const auto &child : node.Children()) {
+    resolved &= AddReferenceComponentStats(child, stats);
+  }
+  return resolved;
+}
+
+SymbolTable::Stats SymbolTable::GetStats() const {
+  Stats stats;
+  symbol_table_root_.ApplyPreOrder([&stats](const SymbolInfo &info) {
+    Stats::MetatypeCounts &counts = stats.metatypes[info.metatype];
+    ++counts.nodes;
+    stats.symbol_info_bytes +=
+        sizeof(SymbolTableNode) +
+        info.supplement_definitions.capacity() * sizeof(absl::string_view);
+    if (info.module_signature != nullptr) {
+      stats.symbol_info_bytes += info.module_signature->MemoryUsage();
+    }
+
+    const auto &references = info.local_references_to_bind;
+    stats.reference_bytes +=
+        references.capacity() * sizeof(DependentReferences);
+    if (info.reference_arena != nullptr) {
+      stats.reference_bytes += sizeof(ReferenceComponentArena);
+    }
+    for (const auto &ref : references) {
+      if (ref.Empty()) continue;
+      ++stats.references;
+      ++counts.references;
+      if (ref.components->Children().empty()) {
+        ++stats.single_component_references;
+      }
+      stats.reference_bytes += sizeof(ReferenceComponentNode);  // the root
+      if (!AddReferenceComponentStats(*ref.components, &stats)) {
+        ++counts.unresolved_references;
+      }
+    }
+  });
+  stats.files = file_times_;
+  return stats;
+}
+
+verible::MemoryUsage SymbolTable::MemoryUsage() const {
+  const Stats stats = GetStats();
+  verible::MemoryUsage usage;
+  usage.Add("symbol_info", stats.symbol_info_bytes);
+  usage.Add("references", stats.reference_bytes);
+  usage.Add("reference_index", reference_index_.MemoryUsage());
+  usage.Add("macros",
+            macro_symbols_.size() * sizeof(MacroSymbolMap::value_type));
+  return usage;
+}
+
+std::ostream &operator<<(std::ostream &stream,
+                         const SymbolTable::Stats &stats) {
+  stream << "Symbol table nodes and references by metatype:" << std::endl;
+  for (const auto &[metatype, counts] : stats.metatypes) {
+    stream << "  " << metatype << ": " << counts.nodes << " nodes, "
+           << counts.references << " references, "
+           << counts.unresolved_references << " unresolved" << std::endl;
+  }
+  stream << "references: " << stats.references << std::endl
+         << "components: " << stats.components << std::endl
+         << "single-component references: "
+         << stats.single_component_references << std::endl
+         << "SymbolInfo bytes: " << stats.symbol_info_bytes << std::endl
+         << "reference bytes: " << stats.reference_bytes;
+  if (stats.references > 0) {
+    stream << " (" << stats.reference_bytes / stats.references
+           << " per reference)";
+  }
+  stream << std::endl;
+
+  // Slowest files first.
+  using FileTimes = std::pair<absl::string_view, SymbolTable::Stats::FileTimes>;
+  std::vector<FileTimes> files(stats.files.begin(), stats.files.end());
+  std::stable_sort(files.begin(), files.end(),
+                   [](const FileTimes &a, const FileTimes &b) {
+                     return a.second.build + a.second.resolve >
+                            b.second.build + b.second.resolve;
+                   });
+  stream << "Build and resolve time by file:" << std::endl;
+  for (const auto &[path, times] : files) {
+    stream << "  " << (path.empty() ? "(no file)" : path) << ": build "
+           << absl::FormatDuration(times.build) << ", resolve "
+           << absl::FormatDuration(times.resolve) << std::endl;
+  }
+  return stream;
+}
+
 std::ostream &SymbolTable::PrintSymbolDefinitions(std::ostream &stream) const {
   return symbol_table_root_.PrintTree(
       stream,
@@ -2333,7 +2774,8 @@ std::ostream &SymbolTable::PrintSymbolReferences(std::ostream &stream) const {
                                       });
 }
 
-static void ParseFileAndBuildSymbolTable(
+// Returns the time spent building, without parsing.
+static absl::Duration ParseFileAndBuildSymbolTable(
     VerilogSourceFile *source, SymbolTable *symbol_table,
     VerilogProject *project, std::vector<absl::Status> *diagnostics) {
   const auto parse_status = source->Parse();
@@ -2341,17 +2783,24 @@ static void ParseFileAndBuildSymbolTable(
   // Continue, in case syntax-error recovery left a partial syntax tree.
 
   // Amend symbol table by analyzing this translation unit.
+  const absl::Time start = absl::Now();
   const std::vector<absl::Status> statuses =
       BuildSymbolTable(*source, symbol_table, project);
+  const absl::Duration build_time = absl::Now() - start;
   // Forward diagnostics.
   diagnostics->insert(diagnostics->end(), statuses.begin(), statuses.end());
+  return build_time;
 }
 
-void SymbolTable::Build(std::vector<absl::Status> *diagnostics) {
+void SymbolTable::Build(std::vector<absl::Status> *diagnostics,
+                        int parse_threads) {
   const absl::Time start = absl::Now();
+  // Parse statuses are reported below, in file order.
+  if (parse_threads > 0) project_->ParseFiles(parse_threads);
   for (auto &translation_unit : *project_) {
-    ParseFileAndBuildSymbolTable(translation_unit.second.get(), this, project_,
-                                 diagnostics);
+    VerilogSourceFile *source = translation_unit.second.get();
+    file_times_[std::string(source->ReferencedPath())].build =
+        ParseFileAndBuildSymbolTable(source, this, project_, diagnostics);
   }
   VLOG(1) << "SymbolTable::Build() took " << (absl::Now() - start);
 }
@@ -2367,7 +2816,181 @@ void SymbolTable::BuildSingleTranslationUnit(
   }
   VerilogSourceFile *translation_unit = *translation_unit_or_status;
 
-  ParseFileAndBuildSymbolTable(translation_unit, this, project_, diagnostics);
+  file_times_[std::string(translation_unit->ReferencedPath())].build =
+      ParseFileAndBuildSymbolTable(translation_unit, this, project_,
+                                   diagnostics);
+}
+
+void ReferenceNameIndex::Add(const SymbolTableNode &scope,
+                             ReferenceComponentNode *components) {
+  ApplyPreOrder(*components, [&](const ReferenceComponentNode &node) {
+    std::vector<Entry> &entries = entries_[node.Value().identifier];
+    // Components of the same name are visited one after the other.
+    if (!entries.empty() && entries.back().components == components) return;
+    entries.push_back({&scope, components});
+  });
+}
+
+void ReferenceNameIndex::Remove(
+    const std::vector<const ReferenceComponentNode *> &references) {
+  absl::flat_hash_map<absl::string_view,
+                      absl::flat_hash_set<const ReferenceComponentNode *>>
+      removed_by_name;
+  for (const ReferenceComponentNode *components : references) {
+    ApplyPreOrder(*components, [&](const ReferenceComponentNode &node) {
+      removed_by_name[node.Value().identifier].insert(components);
+    });
+  }
+  for (const auto &[name, removed] : removed_by_name) {
+    const auto found = entries_.find(name);
+    if (found == entries_.end()) continue;
+    std::vector<Entry> &entries = found->second;
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&removed](const Entry &entry) {
+                                   return removed.contains(entry.components);
+                                 }),
+                  entries.end());
+    if (entries.empty()) entries_.erase(found);
+  }
+}
+
+const std::vector<ReferenceNameIndex::Entry> &ReferenceNameIndex::Find(
+    absl::string_view name) const {
+  static const std::vector<Entry> kNoEntries;
+  const auto found = entries_.find(name);
+  return found == entries_.end() ? kNoEntries : found->second;
+}
+
+size_t ReferenceNameIndex::MemoryUsage() const {
+  size_t bytes =
+      entries_.capacity() * (sizeof(decltype(entries_)::value_type) + 1);
+  for (const auto &[name, entries] : entries_) {
+    bytes += name.capacity() + entries.capacity() * sizeof(Entry);
+  }
+  return bytes;
+}
+
+void SymbolTable::AddReference(const SymbolTableNode &scope,
+                               ReferenceComponentNode *components) {
+  reference_index_.Add(scope, components);
+  if (resolved_) new_references_.push_back({&scope, components});
+}
+
+void SymbolTable::AddDefinition(absl::string_view name) {
+  if (resolved_) changed_names_.emplace(name);
+}
+
+using SymbolTableNodeSet = absl::flat_hash_set<const SymbolTableNode *>;
+
+// Removes the descendants of 'node' that are defined in 'file', and collects
+// all nodes of the removed subtrees in 'removed'.  Also removes the references
+// in the remaining nodes whose text lies in 'content'.  The roots of removed
+// references are passed to 'retract' before they are destroyed.
+using RetractReferences =
+    std::function<void(const std::vector<const ReferenceComponentNode *> &)>;
+static void RemoveFileSymbols(SymbolTableNode *node,
+                              const VerilogSourceFile &file,
+                              absl::string_view content,
+                              SymbolTableNodeSet *removed,
+                              const RetractReferences &retract) {
+  SymbolInfo &info = node->Value();
+  if (!content.empty()) {
+    const auto in_file = [content](absl::string_view text) {
+      return verible::IsSubRange(text, content);
+    };
+    std::vector<DependentReferences> kept_references;
+    std::vector<const ReferenceComponentNode *> retracted;
+    kept_references.reserve(info.local_references_to_bind.size());
+    for (auto &ref : info.local_references_to_bind) {
+      if (!ref.Empty() && in_file(ref.components->Value().identifier)) {
+        retracted.push_back(ref.components.get());
+        continue;
+      }
+      kept_references.push_back(std::move(ref));
+    }
+    if (!retracted.empty()) retract(retracted);
+    info.local_references_to_bind.swap(kept_references);
+
+    auto &definitions = info.supplement_definitions;
+    definitions.erase(
+        std::remove_if(definitions.begin(), definitions.end(), in_file),
+        definitions.end());
+  }
+
+  for (auto iter = node->begin(); iter != node->end();) {
+    SymbolTableNode &child = iter->second;
+    if (child.Value().file_origin == &file) {
+      std::vector<const ReferenceComponentNode *> retracted;
+      child.ApplyPreOrder([&](const SymbolTableNode &n) {
+        removed->insert(&n);
+        for (const auto &ref : n.Value().local_references_to_bind) {
+          if (!ref.Empty()) retracted.push_back(ref.components.get());
+        }
+      });
+      if (!retracted.empty()) retract(retracted);
+      iter = node->Erase(iter);
+    } else {
+      RemoveFileSymbols(&child, file, content, removed, retract);
+      ++iter;
+    }
+  }
+}
+
+// Unbinds the components of 'node' that were resolved to 'removed' symbols.
+// Components that depend on an unbound component are unbound as well.
+static void UnbindRemovedSymbols(ReferenceComponentNode *node,
+                                 const SymbolTableNodeSet &removed,
+                                 bool unbind) {
+  ReferenceComponent &component = node->Value();
+  unbind |= removed.contains(component.resolved_symbol);
+  if (unbind) component.resolved_symbol = nullptr;
+  for (auto &child : node->Children()) {
+    UnbindRemovedSymbols(&child, removed, unbind);
+  }
+}
+
+void SymbolTable::RemoveTranslationUnit(const VerilogSourceFile &file) {
+  const absl::Time start = absl::Now();
+  SymbolTableNodeSet removed;
+  absl::flat_hash_set<const ReferenceComponentNode *> retracted;
+  RemoveFileSymbols(
+      &symbol_table_root_, file, file.GetContent(), &removed,
+      [this, &retracted](
+          const std::vector<const ReferenceComponentNode *> &references) {
+        reference_index_.Remove(references);
+        if (!new_references_.empty()) {
+          retracted.insert(references.begin(), references.end());
+        }
+      });
+  if (auto found = file_times_.find(file.ReferencedPath());
+      found != file_times_.end()) {
+    file_times_.erase(found);
+  }
+  // Only references with a component named like a removed symbol can be
+  // bound to it.  The names are collected before the file's content, which
+  // they point into, goes away.
+  std::set<absl::string_view> removed_names;
+  for (const SymbolTableNode *node : removed) {
+    if (node->Key()) removed_names.insert(*node->Key());
+  }
+  for (absl::string_view name : removed_names) {
+    for (const ReferenceNameIndex::Entry &ref : reference_index_.Find(name)) {
+      UnbindRemovedSymbols(ref.components, removed, false);
+    }
+    if (resolved_) changed_names_.emplace(name);
+  }
+  if (!retracted.empty()) {
+    // References built since the last resolve may have been removed.
+    new_references_.erase(
+        std::remove_if(new_references_.begin(), new_references_.end(),
+                       [&retracted](const ReferenceNameIndex::Entry &ref) {
+                         return retracted.contains(ref.components);
+                       }),
+        new_references_.end());
+  }
+  VLOG(1) << "SymbolTable::RemoveTranslationUnit(" << file.ReferencedPath()
+          << ") removed " << removed.size() << " symbols in "
+          << (absl::Now() - start);
 }
 
 std::vector<absl::Status> BuildSymbolTable(const VerilogSourceFile &source,
@@ -2379,6 +3002,7 @@ std::vector<absl::Status> BuildSymbolTable(const VerilogSourceFile &source,
   const auto &syntax_tree = text_structure->SyntaxTree();
   if (syntax_tree == nullptr) return std::vector<absl::Status>();
 
+  const verible::ScopedTrace trace("build", "symbol-table");
   SymbolTable::Builder builder(source, symbol_table, project);
   syntax_tree->Accept(&builder);
   return builder.TakeDiagnostics();  // move
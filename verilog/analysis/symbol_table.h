@@ -16,6 +16,7 @@
 #define VERIBLE_VERILOG_ANALYSIS_SYMBOL_TABLE_H_
 
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <iosfwd>
 #include <map>
@@ -25,12 +26,15 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/strings/compare.h"
 #include "common/text/symbol.h"
 #include "common/util/map_tree.h"
+#include "common/util/memory_usage.h"
 #include "common/util/vector_tree.h"
 #include "verilog/analysis/verilog_project.h"
 
@@ -43,8 +47,9 @@ struct SymbolInfo;  // forward declaration, defined below
 // The string_view key carries positional information, it corresponds to a
 // substring owned by a VerilogSourceFile (which must outlive the symbol table),
 // and can be used to look up file origin and position within file.
-using SymbolTableNode =
-    verible::MapTree<absl::string_view, SymbolInfo, verible::StringViewCompare>;
+// Scopes are hashed, as they can be large (e.g. packages of parameters).
+// Their symbols are visited in the order they were added.
+using SymbolTableNode = verible::HashMapTree<absl::string_view, SymbolInfo>;
 
 std::ostream& SymbolTableNodeFullPath(std::ostream&, const SymbolTableNode&);
 
@@ -180,18 +185,97 @@ using ReferenceComponentMap =
 ReferenceComponentMap ReferenceComponentNodeMapView(
     const ReferenceComponentNode&);
 
+// Owns the root nodes of the reference trees of one scope, instead of one
+// heap allocation per reference: most references have a single component.
+// Further components are children of the root, stored in its vector.
+// Nodes have stable addresses, and the slots of deleted nodes are reused.
+class ReferenceComponentArena {
+ public:
+  ReferenceComponentArena() = default;
+  ~ReferenceComponentArena();
+
+  // no copy, no move: references point back to their arena.
+  ReferenceComponentArena(const ReferenceComponentArena&) = delete;
+  ReferenceComponentArena(ReferenceComponentArena&&) = delete;
+  ReferenceComponentArena& operator=(const ReferenceComponentArena&) = delete;
+  ReferenceComponentArena& operator=(ReferenceComponentArena&&) = delete;
+
+  // Returns a new root node holding a copy of 'component'.
+  ReferenceComponentNode* New(const ReferenceComponent& component);
+
+  // Releases a node returned by New() for reuse.
+  void Delete(ReferenceComponentNode* node);
+
+  // Returns the number of live nodes.
+  size_t size() const { return slots_.size() - free_.size(); }
+
+ private:
+  // Storage for one node, which is constructed by New() and destroyed by
+  // Delete(), as ReferenceComponent is not assignable.
+  struct alignas(ReferenceComponentNode) Slot {
+    unsigned char bytes[sizeof(ReferenceComponentNode)];
+  };
+
+  std::deque<Slot> slots_;
+
+  // Slots of deleted nodes, to be reused by New().
+  std::vector<Slot*> free_;
+};
+
+// Storage for the generated names of anonymous scopes, packed into blocks of
+// characters rather than one heap string per name, as generate-heavy designs
+// create many of them.  Names never move, even when this object is moved.
+class AnonymousScopeNames {
+ public:
+  AnonymousScopeNames() = default;
+
+  // move-only
+  AnonymousScopeNames(const AnonymousScopeNames&) = delete;
+  AnonymousScopeNames(AnonymousScopeNames&&) = default;
+  AnonymousScopeNames& operator=(const AnonymousScopeNames&) = delete;
+  AnonymousScopeNames& operator=(AnonymousScopeNames&&) = default;
+
+  // Returns a copy of 'name' owned by this object.
+  absl::string_view Add(absl::string_view name);
+
+  // Returns the number of names added.
+  size_t size() const { return size_; }
+
+ private:
+  // Blocks grow geometrically, so that scopes with few anonymous children
+  // stay small.
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t block_capacity_ = 0;  // of blocks_.back()
+  size_t block_used_ = 0;      // of blocks_.back()
+  size_t size_ = 0;
+};
+
+// Deletes reference trees owned by DependentReferences, and returns the
+// roots allocated in a ReferenceComponentArena to it.
+struct ReferenceComponentNodeDeleter {
+  void operator()(ReferenceComponentNode* node) const;
+
+  // If not nullptr, new roots are allocated here.
+  ReferenceComponentArena* arena = nullptr;
+};
+
 // Represents any (chained) qualified or unqualified reference.
 struct DependentReferences {
   // Sequence of identifiers in a chain like "a.b.c", or "x::y::z".
   // The first element always has ReferenceType::kUnqualified.
-  // This is wrapped in a unique_ptr to guarantee address stability on-move.
-  std::unique_ptr<ReferenceComponentNode> components;
+  // The root node is heap- or arena-allocated to guarantee address stability
+  // on-move.
+  std::unique_ptr<ReferenceComponentNode, ReferenceComponentNodeDeleter>
+      components;
 
  public:
   DependentReferences() = default;
   explicit DependentReferences(
       std::unique_ptr<ReferenceComponentNode> components)
-      : components(std::move(components)) {}
+      : components(components.release()) {}
+  // The root will be allocated in 'arena', which must outlive this.
+  explicit DependentReferences(ReferenceComponentArena* arena)
+      : components(nullptr, ReferenceComponentNodeDeleter{arena}) {}
   // move-only
   DependentReferences(const DependentReferences&) = delete;
   DependentReferences(DependentReferences&&) = default;
@@ -276,6 +360,45 @@ struct DeclarationTypeInfo {
 
 std::ostream& operator<<(std::ostream&, const DeclarationTypeInfo&);
 
+// The interface of a module that its instantiations connect to: its ports
+// and parameters, in declaration order.  This is built with the module's
+// symbol, once per version of a file, so that checking and expanding
+// instantiations does not search the module's syntax tree again.
+struct ModuleSignature {
+  struct Port {
+    absl::string_view name;
+    // "input", "output" or "inout".
+    absl::string_view direction;
+    // Text of the packed and unpacked dimensions, or empty.
+    absl::string_view packed_dimensions;
+    absl::string_view unpacked_dimensions;
+    // The kPortDeclaration (in the header) or kModulePortDeclaration (in the
+    // body) node.
+    const verible::Symbol* declaration;
+  };
+  std::vector<Port> ports;
+
+  // Names of the parameters, including localparams.
+  std::vector<absl::string_view> parameters;
+
+  // Index of each name in 'ports' and in 'parameters'.
+  absl::flat_hash_map<absl::string_view, size_t> port_index;
+  absl::flat_hash_map<absl::string_view, size_t> parameter_index;
+
+  // Returns the port named 'name', or nullptr.
+  const Port* FindPort(absl::string_view name) const {
+    const auto found = port_index.find(name);
+    return found == port_index.end() ? nullptr : &ports[found->second];
+  }
+
+  bool HasParameter(absl::string_view name) const {
+    return parameter_index.contains(name);
+  }
+
+  // Estimated bytes of the signature.
+  size_t MemoryUsage() const;
+};
+
 // This data type holds information about what each SystemVerilog symbol is.
 // An alternative implementation could be done using an abstract base class,
 // and subclasses for each element type.
@@ -314,11 +437,7 @@ struct SymbolInfo {
   // Collection of generated scope names that exists for the sake of persistent
   // string memory storage (since all other symbol table node keys rely on
   // string_views that belong the source file's string memory buffer).
-  // We cannot use std::string directly due to the move-ability requirements
-  // along with the possibility of short-string-optimization.
-  // std::vector is move-able on reallocation and unique_ptr guarantees
-  // move-stability.
-  std::vector<std::unique_ptr<const std::string>> anonymous_scope_names;
+  AnonymousScopeNames anonymous_scope_names;
 
   // TODO(fangism): symbol attributes
   // visibility: is this symbol (as a member of its parent) public?
@@ -336,6 +455,13 @@ struct SymbolInfo {
   // multiple inheritance.
   DeclarationTypeInfo parent_type;
 
+  // Storage for the roots of local_references_to_bind, which must outlive
+  // them.  This is allocated with the first reference.
+  std::unique_ptr<ReferenceComponentArena> reference_arena;
+
+  // For modules only: their ports and parameters.
+  std::unique_ptr<const ModuleSignature> module_signature;
+
   // Collection of references to resolve and bind that appear in the same
   // context. There is no sequential ordering dependency among these references,
   // theoretically, they could all be resolved in parallel.
@@ -423,6 +549,38 @@ struct SymbolInfo {
 using MacroSymbolMap =
     std::map<absl::string_view, SymbolInfo, verible::StringViewCompare>;
 
+// Index of references by the names that resolving them looks up, which are
+// the identifiers of their components.  When the definitions of some names
+// change, only the references found under these names can resolve
+// differently.
+class ReferenceNameIndex {
+ public:
+  // A reference, by the scope it resolves from and its root component.
+  struct Entry {
+    const SymbolTableNode* scope;
+    ReferenceComponentNode* components;
+  };
+
+  // Adds the reference rooted at 'components', which must be Remove()d
+  // before it is destroyed.
+  void Add(const SymbolTableNode& scope, ReferenceComponentNode* components);
+
+  // Removes the references rooted at 'references'.
+  void Remove(const std::vector<const ReferenceComponentNode*>& references);
+
+  // Returns the references with a component named 'name', in the order
+  // they were added.
+  const std::vector<Entry>& Find(absl::string_view name) const;
+
+  size_t NumNames() const { return entries_.size(); }
+
+  // Estimated bytes of the index.
+  size_t MemoryUsage() const;
+
+ private:
+  absl::flat_hash_map<std::string, std::vector<Entry>> entries_;
+};
+
 // SymbolTable maintains a named hierarchy of named symbols and scopes for
 // SystemVerilog.  This can be built up separately per translation unit,
 // or in a unified table across all translation units.
@@ -476,17 +634,55 @@ class SymbolTable {
   void BuildSingleTranslationUnit(absl::string_view referenced_file_name,
                                   std::vector<absl::Status>* diagnostics);
 
+  // Removes everything that was built from 'file': the symbols it defines
+  // (with their scopes) and the references it contributed to other scopes.
+  // References elsewhere that were bound to removed symbols become unbound
+  // again.  This must be called while 'file' still holds the content that the
+  // symbol table was built from.
+  // Building the updated file with BuildSingleTranslationUnit(), followed by
+  // ResolveAffected(), then only resolves the references that the change
+  // may affect, so a single changed file can be updated without rebuilding
+  // or resolving the whole table.
+  // Only the references with a component named like a removed symbol are
+  // looked at to unbind them.
+  void RemoveTranslationUnit(const VerilogSourceFile& file);
+
   // Construct symbol table definitions and references hierarchically, but do
   // not attempt to resolve the symbols.
   // The ordering of translation units processing is implementation defined,
   // and should not be relied upon, but this only maatters when there are
   // duplicate definitions among translation units.
-  void Build(std::vector<absl::Status>* diagnostics);
+  void Build(std::vector<absl::Status>* diagnostics) { Build(diagnostics, 0); }
+
+  // Like Build(), but first parses all files of the project concurrently on
+  // "parse_threads" threads.  The symbol table is still built serially in
+  // the project's file order, so the result does not depend on the number
+  // of threads.
+  void Build(std::vector<absl::Status>* diagnostics, int parse_threads);
 
   // Lookup all symbol references, and bind references where successful.
   // Only attempt to resolve after merging symbol tables.
   void Resolve(std::vector<absl::Status>* diagnostics);
 
+  // Like Resolve(), but resolves the references on "threads" threads, or in
+  // the calling thread if that is 0.  First, the references to the types of
+  // declarations and the base classes are resolved serially, as these are
+  // the only references that resolving other references depends on.  Then
+  // the remaining references are resolved concurrently, in chunks of scopes.
+  // Diagnostics are in that order, so neither they nor the resolved symbols
+  // depend on the number of threads.  As all types are resolved first, this
+  // can resolve references that Resolve() misses, as it resolves in order.
+  void Resolve(std::vector<absl::Status>* diagnostics, int threads);
+
+  // Like Resolve(), but after a complete Resolve() only resolves again the
+  // references that translation units built or removed since then may
+  // affect: their own references, and the references with a component named
+  // like a symbol they defined, which are unbound first, as they may now
+  // resolve to another definition.  Unresolved references elsewhere are not
+  // tried, nor diagnosed, again.  Without a complete Resolve() before, this
+  // is Resolve().
+  void ResolveAffected(std::vector<absl::Status>* diagnostics);
+
   // A "weaker" version of Resolve() that only attempts to resolve symbol
   // references to definitions belonging to the same scope as the reference
   // (without upward search).
@@ -496,6 +692,44 @@ class SymbolTable {
   // is intended.
   void ResolveLocallyOnly();
 
+  // Sizes of the symbol table and its references, and where the time to
+  // build and resolve it went, e.g. to find pathological files.
+  struct Stats {
+    struct MetatypeCounts {
+      size_t nodes = 0;
+      // References that appear in scopes of this metatype.
+      size_t references = 0;
+      // References with at least one unbound component.
+      size_t unresolved_references = 0;
+    };
+    std::map<SymbolMetaType, MetatypeCounts> metatypes;
+
+    size_t references = 0;
+    size_t components = 0;
+    // References that consist of a single identifier.
+    size_t single_component_references = 0;
+
+    // Estimates of the bytes held by the nodes' SymbolInfo, and by the
+    // references and their components.
+    size_t symbol_info_bytes = 0;
+    size_t reference_bytes = 0;
+
+    // Time of the last build of each file, which includes the files it
+    // includes, and of the last Resolve() of the scopes that each file
+    // defines.  Scopes without a file (like $root) are under "".
+    struct FileTimes {
+      absl::Duration build;
+      absl::Duration resolve;
+    };
+    std::map<std::string, FileTimes, std::less<>> files;
+  };
+  Stats GetStats() const;
+
+  // Returns the estimated bytes of GetStats() as components, with those of
+  // the macro definitions.  The project's files are not counted; see
+  // VerilogProject::MemoryUsage().
+  verible::MemoryUsage MemoryUsage() const;
+
   // Print only the information about symbols defined (no references).
   // This will print the results of Build().
   std::ostream& PrintSymbolDefinitions(std::ostream&) const;
@@ -512,6 +746,12 @@ class SymbolTable {
   // Verify internal structural and pointer consistency.
   void CheckIntegrity() const;
 
+  // The Builder reports each reference it adds to a scope, and the name of
+  // each symbol it adds, which are tracked for ResolveAffected().
+  void AddReference(const SymbolTableNode& scope,
+                    ReferenceComponentNode* components);
+  void AddDefinition(absl::string_view name);
+
  private:  // data
   // This owns all files used to construct the symbol table and therefore,
   // owns all string_views inside the symbol table and outlives objects of
@@ -531,8 +771,26 @@ class SymbolTable {
 
   // All macro definitions/references interact through this global namespace.
   MacroSymbolMap macro_symbols_;
+
+  // Timing for Stats::files, by referenced path.
+  std::map<std::string, Stats::FileTimes, std::less<>> file_times_;
+
+  // All references built into this table.
+  ReferenceNameIndex reference_index_;
+
+  // True after a complete Resolve(), from when the changes for
+  // ResolveAffected() are tracked.
+  bool resolved_ = false;
+
+  // Names of the symbols added or removed, and the references added, since
+  // the last Resolve() or ResolveAffected().
+  std::set<std::string, std::less<>> changed_names_;
+  std::vector<ReferenceNameIndex::Entry> new_references_;
 };
 
+// Prints the statistics in human-readable form.
+std::ostream& operator<<(std::ostream&, const SymbolTable::Stats&);
+
 // Construct a partial symbol table and bindings locations from a single source
 // file.  This does not actually resolve symbol references, there is an
 // opportunity to merge symbol tables across files before resolving references.
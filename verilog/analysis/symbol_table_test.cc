@@ -24,6 +24,7 @@
 
 #include "absl/base/attributes.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/text/tree_utils.h"
 #include "common/util/file_util.h"
@@ -256,6 +257,45 @@ TEST(DependentReferencesTest, PrintOnlyRootNodeUnresolved) {
   EXPECT_EQ(stream.str(), "{ (@foo -> <unresolved>) }");
 }
 
+TEST(DependentReferencesTest, ArenaAllocatedRootIsReused) {
+  ReferenceComponentArena arena;
+  const ReferenceComponent foo{
+      .identifier = "foo",
+      .ref_type = ReferenceType::kUnqualified,
+      .required_metatype = SymbolMetaType::kUnspecified,
+      .resolved_symbol = nullptr};
+  const ReferenceComponentNode *root;
+  {
+    DependentReferences dep_refs(&arena);
+    EXPECT_TRUE(dep_refs.Empty());
+    root = dep_refs.PushReferenceComponent(foo);
+    EXPECT_EQ(dep_refs.components.get(), root);
+    EXPECT_EQ(arena.size(), 1);
+  }
+  EXPECT_EQ(arena.size(), 0);
+
+  DependentReferences dep_refs(&arena);
+  EXPECT_EQ(dep_refs.PushReferenceComponent(foo), root);
+  EXPECT_EQ(arena.size(), 1);
+  std::ostringstream stream;
+  stream << dep_refs;
+  EXPECT_EQ(stream.str(), "{ (@foo -> <unresolved>) }");
+}
+
+TEST(SymbolInfoTest, AnonymousScopeNamesSurviveGrowthAndMove) {
+  SymbolInfo info;
+  std::vector<absl::string_view> names;
+  for (int i = 0; i < 1000; ++i) {
+    names.push_back(info.CreateAnonymousScope("generate"));
+  }
+  EXPECT_EQ(info.anonymous_scope_names.size(), 1000);
+  const SymbolInfo moved(std::move(info));
+  EXPECT_EQ(moved.anonymous_scope_names.size(), 1000);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(names[i], absl::StrCat("%anon-generate-", i));
+  }
+}
+
 TEST(DependentReferencesTest, PrintNonRootResolved) {
   // Synthesize a symbol table.
   using KV = SymbolTableNode::key_value_type;
@@ -736,6 +776,54 @@ TEST(BuildSymbolTableTest, ModuleDeclarationWithPorts) {
   }
 }
 
+TEST(BuildSymbolTableTest, ModuleSignatureFromHeaderAndBody) {
+  TestVerilogSourceFile src("foobar.sv",
+                            "module m #(parameter P = 1) (\n"
+                            "  input wire [3:0] a,\n"
+                            "  output reg b [2]\n"
+                            ");\n"
+                            "  localparam Q = 2;\n"
+                            "endmodule\n"
+                            "module n (c);\n"
+                            "  inout c;\n"
+                            "endmodule\n");
+  const auto status = src.Parse();
+  ASSERT_TRUE(status.ok()) << status.message();
+  SymbolTable symbol_table(nullptr);
+  const SymbolTableNode &root_symbol(symbol_table.Root());
+
+  const auto build_diagnostics = BuildSymbolTable(src, &symbol_table);
+  EXPECT_EMPTY_STATUSES(build_diagnostics);
+
+  MUST_ASSIGN_LOOKUP_SYMBOL(module_node, root_symbol, "m");
+  ASSERT_NE(module_node_info.module_signature, nullptr);
+  const ModuleSignature &signature(*module_node_info.module_signature);
+  ASSERT_EQ(signature.ports.size(), 2);
+  EXPECT_EQ(signature.ports[0].name, "a");
+  EXPECT_EQ(signature.ports[0].direction, "input");
+  EXPECT_EQ(signature.ports[0].packed_dimensions, "[3:0]");
+  EXPECT_EQ(signature.ports[1].name, "b");
+  EXPECT_EQ(signature.ports[1].direction, "output");
+  EXPECT_EQ(signature.ports[1].unpacked_dimensions, "[2]");
+
+  const ModuleSignature::Port *port = signature.FindPort("b");
+  ASSERT_NE(port, nullptr);
+  EXPECT_EQ(port->name, "b");
+  EXPECT_EQ(signature.FindPort("d"), nullptr);
+
+  EXPECT_TRUE(signature.HasParameter("P"));
+  EXPECT_TRUE(signature.HasParameter("Q"));
+  EXPECT_FALSE(signature.HasParameter("a"));
+
+  // Non-ANSI ports are declared in the body.
+  MUST_ASSIGN_LOOKUP_SYMBOL(n_node, root_symbol, "n");
+  ASSERT_NE(n_node_info.module_signature, nullptr);
+  const auto &n_ports(n_node_info.module_signature->ports);
+  ASSERT_EQ(n_ports.size(), 1);
+  EXPECT_EQ(n_ports[0].name, "c");
+  EXPECT_EQ(n_ports[0].direction, "inout");
+}
+
 TEST(BuildSymbolTableTest, ModuleDeclarationMultiple) {
   TestVerilogSourceFile src("foobar.sv",
                             "module m1;\nendmodule\n"
@@ -1276,6 +1364,95 @@ TEST(BuildSymbolTableTest, ModuleInstanceNamedPortConnection) {
   }
 }
 
+TEST(BuildSymbolTableTest, ModuleInstanceNamedPortConnectionResolveOnThreads) {
+  // Same as ModuleInstanceNamedPortConnection, but resolved on threads.
+  // The instance's type "m" is resolved before its named ports.
+  for (const int threads : {0, 1, 3}) {
+    TestVerilogSourceFile src("foobar.sv",
+                              "module rr;\n"
+                              "  wire c, d;\n"
+                              "  m m_inst(.clk(c), .q(d));"
+                              "endmodule\n"
+                              "module m (\n"
+                              "  input wire clk,\n"
+                              "  output reg q\n"
+                              ");\n"
+                              "endmodule\n");
+    const auto status = src.Parse();
+    ASSERT_TRUE(status.ok()) << status.message();
+    SymbolTable symbol_table(nullptr);
+    const SymbolTableNode &root_symbol(symbol_table.Root());
+
+    const auto build_diagnostics = BuildSymbolTable(src, &symbol_table);
+    EXPECT_EMPTY_STATUSES(build_diagnostics);
+
+    MUST_ASSIGN_LOOKUP_SYMBOL(m_node, root_symbol, "m");
+    MUST_ASSIGN_LOOKUP_SYMBOL(clk_node, m_node, "clk");
+    MUST_ASSIGN_LOOKUP_SYMBOL(q_node, m_node, "q");
+    MUST_ASSIGN_LOOKUP_SYMBOL(rr_node, root_symbol, "rr");
+    MUST_ASSIGN_LOOKUP_SYMBOL(c_node, rr_node, "c");
+    MUST_ASSIGN_LOOKUP_SYMBOL(d_node, rr_node, "d");
+
+    const auto ref_map(rr_node_info.LocalReferencesMapViewForTesting());
+    ASSIGN_MUST_FIND_EXACTLY_ONE_REF(c_ref, ref_map, "c");
+    ASSIGN_MUST_FIND_EXACTLY_ONE_REF(d_ref, ref_map, "d");
+    ASSIGN_MUST_FIND_EXACTLY_ONE_REF(m_inst_ref, ref_map, "m_inst");
+    const ReferenceComponentMap port_refs(
+        ReferenceComponentNodeMapView(*m_inst_ref->components));
+    ASSIGN_MUST_FIND(clk_ref, port_refs, "clk");
+    ASSIGN_MUST_FIND(q_ref, port_refs, "q");
+
+    std::vector<absl::Status> resolve_diagnostics;
+    symbol_table.Resolve(&resolve_diagnostics, threads);
+    EXPECT_EMPTY_STATUSES(resolve_diagnostics);
+
+    EXPECT_EQ(c_ref->LastLeaf()->Value().resolved_symbol, &c_node);
+    EXPECT_EQ(d_ref->LastLeaf()->Value().resolved_symbol, &d_node);
+    EXPECT_EQ(clk_ref->Value().resolved_symbol, &clk_node);
+    EXPECT_EQ(q_ref->Value().resolved_symbol, &q_node);
+  }
+}
+
+TEST(BuildSymbolTableTest, StatsCountNodesAndReferencesByMetatype) {
+  TestVerilogSourceFile src("foobar.sv",
+                            "module m;\n"
+                            "  wire a;\n"
+                            "  assign a = b;\n"
+                            "endmodule\n");
+  const auto status = src.Parse();
+  ASSERT_TRUE(status.ok()) << status.message();
+  SymbolTable symbol_table(nullptr);
+
+  const auto build_diagnostics = BuildSymbolTable(src, &symbol_table);
+  EXPECT_EMPTY_STATUSES(build_diagnostics);
+
+  std::vector<absl::Status> resolve_diagnostics;
+  symbol_table.Resolve(&resolve_diagnostics);  // "b" is undeclared
+  EXPECT_EQ(resolve_diagnostics.size(), 1);
+
+  const SymbolTable::Stats stats = symbol_table.GetStats();
+  EXPECT_EQ(stats.metatypes.at(SymbolMetaType::kRoot).nodes, 1);
+  const auto &module = stats.metatypes.at(SymbolMetaType::kModule);
+  EXPECT_EQ(module.nodes, 1);
+  EXPECT_EQ(module.references, 2);
+  EXPECT_EQ(module.unresolved_references, 1);
+  EXPECT_EQ(stats.metatypes.at(SymbolMetaType::kDataNetVariableInstance).nodes,
+            1);
+  EXPECT_EQ(stats.references, 2);
+  EXPECT_EQ(stats.components, 2);
+  EXPECT_EQ(stats.single_component_references, 2);
+  EXPECT_GT(stats.symbol_info_bytes, 0);
+  EXPECT_GT(stats.reference_bytes, 0);
+  // The module's scope has a file.
+  ASSERT_EQ(stats.files.size(), 1);
+  EXPECT_EQ(stats.files.begin()->first, "foobar.sv");
+
+  std::ostringstream stream;
+  stream << stats;
+  EXPECT_THAT(stream.str(),
+              HasSubstr("module: 1 nodes, 2 references, 1 unresolved"));
+}
+
 TEST(BuildSymbolTableTest,
      ModuleInstanceNamedPortConnectionResolveLocallyOnly) {
   // Similar to ModuleInstanceNamedPortConnection, but will not resolve
@@ -8239,6 +8416,143 @@ TEST(BuildSymbolTableTest, ModuleInstancesFromProjectOneFileAtATime) {
       &qq);
 }
 
+TEST(BuildSymbolTableTest, RemoveAndRebuildTranslationUnit) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include path */});
+
+  constexpr absl::string_view  //
+      pp_text(
+          "module pp;\n"
+          "endmodule\n"),
+      qq_text(
+          "module qq;\n"
+          "  pp pp_inst();\n"  // instance
+          "endmodule\n");
+  const ScopedTestFile pp_file(sources_dir, pp_text);
+  const ScopedTestFile qq_file(sources_dir, qq_text);
+  const std::string pp_name(Basename(pp_file.filename()));
+  const std::string qq_name(Basename(qq_file.filename()));
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> diagnostics;
+  for (const std::string &name : {pp_name, qq_name}) {
+    symbol_table.BuildSingleTranslationUnit(name, &diagnostics);
+  }
+  symbol_table.Resolve(&diagnostics);
+  EXPECT_EMPTY_STATUSES(diagnostics);
+
+  const SymbolTableNode &root_symbol(symbol_table.Root());
+  MUST_ASSIGN_LOOKUP_SYMBOL(qq, root_symbol, "qq");
+  MUST_ASSIGN_LOOKUP_SYMBOL(pp_inst, qq, "pp_inst");
+  const ReferenceComponent &pp_type(
+      pp_inst_info.declared_type.user_defined_type->Value());
+  {
+    MUST_ASSIGN_LOOKUP_SYMBOL(pp, root_symbol, "pp");
+    EXPECT_EQ(pp_type.resolved_symbol, &pp);
+  }
+
+  // Retract the file that defines "pp".
+  const VerilogSourceFile *pp_source = project.LookupRegisteredFile(pp_name);
+  ASSERT_NE(pp_source, nullptr);
+  symbol_table.RemoveTranslationUnit(*pp_source);
+  EXPECT_EQ(root_symbol.Find("pp"), root_symbol.end());
+  EXPECT_NE(root_symbol.Find("qq"), root_symbol.end());
+  EXPECT_EQ(pp_type.resolved_symbol, nullptr);
+  // References within "qq" remain.
+  EXPECT_EQ(qq_info.local_references_to_bind.size(), 2);
+
+  // Update the file and build it again.
+  ASSERT_TRUE(verible::file::SetContents(pp_file.filename(),
+                                         "module pp;\n"
+                                         "  wire w;\n"
+                                         "endmodule\n")
+                  .ok());
+  project.UpdateFileContents(pp_file.filename(), nullptr);
+  symbol_table.BuildSingleTranslationUnit(pp_name, &diagnostics);
+  symbol_table.Resolve(&diagnostics);
+  EXPECT_EMPTY_STATUSES(diagnostics);
+
+  MUST_ASSIGN_LOOKUP_SYMBOL(pp, root_symbol, "pp");
+  MUST_ASSIGN_LOOKUP_SYMBOL(w, pp, "w");
+  EXPECT_EQ(w_info.file_origin, project.LookupRegisteredFile(pp_name));
+  EXPECT_EQ(pp_type.resolved_symbol, &pp);
+}
+
+TEST(BuildSymbolTableTest, ResolveAffectedOnlyRevisitsChangedNames) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+
+  VerilogProject project(sources_dir, {/* no include path */});
+
+  constexpr absl::string_view  //
+      pp_text(
+          "module pp;\n"
+          "endmodule\n"),
+      qq_text(
+          "module qq;\n"
+          "  pp pp_inst();\n"  // instance
+          "  rr rr_inst();\n"  // not defined yet
+          "endmodule\n"),
+      ss_text(
+          "module ss;\n"
+          "  tt tt_inst();\n"  // never defined
+          "endmodule\n");
+  const ScopedTestFile pp_file(sources_dir, pp_text);
+  const ScopedTestFile qq_file(sources_dir, qq_text);
+  const ScopedTestFile ss_file(sources_dir, ss_text);
+  const std::string pp_name(Basename(pp_file.filename()));
+
+  SymbolTable symbol_table(&project);
+  std::vector<absl::Status> diagnostics;
+  for (const ScopedTestFile *file : {&pp_file, &qq_file, &ss_file}) {
+    symbol_table.BuildSingleTranslationUnit(Basename(file->filename()),
+                                            &diagnostics);
+  }
+  EXPECT_EMPTY_STATUSES(diagnostics);
+  symbol_table.Resolve(&diagnostics);
+  EXPECT_EQ(diagnostics.size(), 2);  // rr and tt
+
+  const SymbolTableNode &root_symbol(symbol_table.Root());
+  MUST_ASSIGN_LOOKUP_SYMBOL(qq, root_symbol, "qq");
+  MUST_ASSIGN_LOOKUP_SYMBOL(rr_inst, qq, "rr_inst");
+  const ReferenceComponent &rr_type(
+      rr_inst_info.declared_type.user_defined_type->Value());
+  EXPECT_EQ(rr_type.resolved_symbol, nullptr);
+
+  // Define "rr" in the file of "pp".
+  const VerilogSourceFile *pp_source = project.LookupRegisteredFile(pp_name);
+  ASSERT_NE(pp_source, nullptr);
+  symbol_table.RemoveTranslationUnit(*pp_source);
+  ASSERT_TRUE(verible::file::SetContents(pp_file.filename(),
+                                         "module pp;\n"
+                                         "endmodule\n"
+                                         "module rr;\n"
+                                         "endmodule\n")
+                  .ok());
+  project.UpdateFileContents(pp_file.filename(), nullptr);
+  diagnostics.clear();
+  symbol_table.BuildSingleTranslationUnit(pp_name, &diagnostics);
+  symbol_table.ResolveAffected(&diagnostics);
+  // The reference to "tt" is not affected, so it is not diagnosed again.
+  EXPECT_EMPTY_STATUSES(diagnostics);
+
+  MUST_ASSIGN_LOOKUP_SYMBOL(pp, root_symbol, "pp");
+  MUST_ASSIGN_LOOKUP_SYMBOL(rr, root_symbol, "rr");
+  MUST_ASSIGN_LOOKUP_SYMBOL(pp_inst, qq, "pp_inst");
+  EXPECT_EQ(
+      pp_inst_info.declared_type.user_defined_type->Value().resolved_symbol,
+      &pp);
+  EXPECT_EQ(rr_type.resolved_symbol, &rr);
+
+  // Nothing changed since.
+  symbol_table.ResolveAffected(&diagnostics);
+  EXPECT_EMPTY_STATUSES(diagnostics);
+}
+
 TEST(BuildSymbolTableTest, ModuleInstancesFromProjectMissingFile) {
   const auto tempdir = ::testing::TempDir();
   const std::string sources_dir = JoinPath(tempdir, __FUNCTION__);
@@ -17,33 +17,52 @@
 
 #include "verilog/analysis/verilog_analyzer.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
 #include "common/analysis/file_analyzer.h"
 #include "common/lexer/token_stream_adapter.h"
-#include "common/strings/comment_utils.h"
 #include "common/strings/mem_block.h"
+#include "common/strings/range.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/text_structure.h"
+#include "common/text/text_structure_binary.h"
 #include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
+#include "common/text/tree_utils.h"
 #include "common/text/visitors.h"
 #include "common/util/container_util.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
+#include "common/util/range.h"
 #include "common/util/status_macros.h"
+#include "common/util/trace.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/verilog_excerpt_parse.h"
+#include "verilog/analysis/verilog_linter_constants.h"
 #include "verilog/parser/verilog_lexer.h"
 #include "verilog/parser/verilog_lexical_context.h"
+#include "verilog/parser/verilog_parallel_parser.h"
 #include "verilog/parser/verilog_parser.h"
+#include "verilog/parser/verilog_shallow_parse.h"
 #include "verilog/parser/verilog_token_classifications.h"
 #include "verilog/parser/verilog_token_enum.h"
 #include "verilog/preprocessor/verilog_preprocess.h"
@@ -56,6 +75,7 @@ using verible::container::InsertKeyOrDie;
 
 absl::Status VerilogAnalyzer::Tokenize() {
   if (!tokenized_) {
+    const verible::ScopedTrace trace("lex", "analysis");
     VerilogLexer lexer{Data().Contents()};
     tokenized_ = true;
     lex_status_ = FileAnalyzer::Tokenize(&lexer);
@@ -63,19 +83,37 @@ absl::Status VerilogAnalyzer::Tokenize() {
   return lex_status_;
 }
 
+const std::vector<absl::string_view>&
+VerilogAnalyzer::CommentDirectiveTriggers() {
+  // The formatter's is formatter::kFormatterTrigger.
+  static const auto* const kTriggers = new std::vector<absl::string_view>{
+      kLinterTrigger, "verilog_format:", kParseDirectiveName};
+  return *kTriggers;
+}
+
+const verible::CommentDirectiveIndex& VerilogAnalyzer::CommentDirectives()
+    const {
+  std::call_once(comment_directives_once_, [this] {
+    comment_directives_ = verible::CommentDirectiveIndex(
+        Data().TokenStream(),
+        [](const TokenInfo& token) {
+          return IsComment(verilog_tokentype(token.token_enum()));
+        },
+        CommentDirectiveTriggers());
+  });
+  return comment_directives_;
+}
+
 absl::string_view VerilogAnalyzer::ScanParsingModeDirective(
     const TokenSequence& raw_tokens) {
   for (const auto& token : raw_tokens) {
     const auto vtoken_enum = verilog_tokentype(token.token_enum());
     if (IsComment(vtoken_enum)) {
-      const absl::string_view comment_text =
-          verible::StripCommentAndSpacePadding(token.text());
-      const std::vector<absl::string_view> comment_tokens =
-          absl::StrSplit(comment_text, ' ', absl::SkipEmpty());
-      if (comment_tokens.size() >= 2 &&
-          comment_tokens[0] == kParseDirectiveName) {
+      const auto directive =
+          verible::ParseCommentDirective(token, {kParseDirectiveName});
+      if (directive && !directive->args.empty()) {
         // First directive wins.
-        return comment_tokens[1];
+        return directive->args[0];
       }
       continue;
     }
@@ -126,30 +164,145 @@ static absl::string_view FailingTokenKeywordToParsingMode(
   return "";
 }
 
+std::string ParsingModeMemo::Find(absl::string_view filename) const {
+  const std::lock_guard<std::mutex> l(mutex_);
+  const auto found = modes_.find(filename);
+  return found == modes_.end() ? "" : found->second;
+}
+
+void ParsingModeMemo::Remember(absl::string_view filename,
+                               absl::string_view mode) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  if (mode.empty()) {
+    if (const auto found = modes_.find(filename); found != modes_.end()) {
+      modes_.erase(found);
+    }
+    return;
+  }
+  modes_[std::string(filename)] = std::string(mode);
+}
+
+// Appends "source_tokens", lexed from "source", to "tokens", pointing them at
+// the same characters of an equal string that starts at "rebase_begin".
+static void AppendRebasedTokens(const TokenSequence& source_tokens,
+                                absl::string_view source,
+                                const char* rebase_begin,
+                                TokenSequence* tokens) {
+  for (const TokenInfo& token : source_tokens) {
+    if (token.isEOF()) break;
+    tokens->push_back(token);
+    tokens->back().RebaseStringView(rebase_begin +
+                                    (token.text().data() - source.data()));
+  }
+}
+
+absl::Status VerilogAnalyzer::TokenizeWithExcerpt(
+    size_t excerpt_offset, absl::string_view excerpt,
+    const TokenSequence& excerpt_tokens) {
+  if (tokenized_) return lex_status_;
+  tokenized_ = true;
+  const absl::string_view contents = Data().Contents();
+  TokenSequence& tokens = MutableData().MutableTokenStream();
+  const auto save_error = [this](const TokenInfo& error_token) {
+    rejected_tokens_.push_back(verible::RejectedToken{
+        error_token, verible::AnalysisPhase::kLexPhase, ""});
+  };
+  VerilogLexer lexer{contents};
+  lex_status_ = verible::MakeTokenSequence(
+      &lexer, contents.substr(0, excerpt_offset), &tokens, save_error);
+  if (!lex_status_.ok()) return lex_status_;
+  tokens.pop_back();  // EOF of the text before the excerpt
+
+  AppendRebasedTokens(excerpt_tokens, excerpt,
+                      contents.data() + excerpt_offset, &tokens);
+
+  lex_status_ = verible::MakeTokenSequence(
+      &lexer, contents.substr(excerpt_offset + excerpt.length()), &tokens,
+      save_error);
+  if (!lex_status_.ok()) return lex_status_;
+  MutableData().CalculateFirstTokensPerLine();
+  verible::InitTokenStreamView(Data().TokenStream(),
+                               &MutableData().MutableTokenStreamView());
+  return lex_status_;
+}
+
+absl::Status VerilogAnalyzer::TokenizeWithPrefix(
+    absl::string_view prefix, const TokenSequence& prefix_tokens) {
+  if (tokenized_) return lex_status_;
+  tokenized_ = true;
+  const absl::string_view contents = Data().Contents();
+  TokenSequence& tokens = MutableData().MutableTokenStream();
+  AppendRebasedTokens(prefix_tokens, prefix, contents.data(), &tokens);
+
+  VerilogLexer lexer{contents};
+  lex_status_ = verible::MakeTokenSequence(
+      &lexer, contents.substr(prefix.length()), &tokens,
+      [this](const TokenInfo& error_token) {
+        rejected_tokens_.push_back(verible::RejectedToken{
+            error_token, verible::AnalysisPhase::kLexPhase, ""});
+      });
+  if (!lex_status_.ok()) return lex_status_;
+  MutableData().CalculateFirstTokensPerLine();
+  verible::InitTokenStreamView(Data().TokenStream(),
+                               &MutableData().MutableTokenStreamView());
+  return lex_status_;
+}
+
 std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::AnalyzeAutomaticMode(
     const std::shared_ptr<verible::MemBlock>& text, absl::string_view name,
-    const VerilogPreprocess::Config& preprocess_config) {
+    const VerilogPreprocess::Config& preprocess_config,
+    ParsingModeMemo* parsing_modes) {
+  return AnalyzeAutomaticMode(text, name, preprocess_config, nullptr,
+                              parsing_modes);
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::AnalyzeAutomaticMode(
+    const std::shared_ptr<verible::MemBlock>& text, absl::string_view name,
+    const VerilogPreprocess::Config& preprocess_config,
+    const TokenSequence* lexed_tokens, ParsingModeMemo* parsing_modes) {
   VLOG(2) << __FUNCTION__;
   auto analyzer =
       std::make_unique<VerilogAnalyzer>(text, name, preprocess_config);
   if (analyzer == nullptr) return analyzer;
   const absl::string_view text_base = analyzer->Data().Contents();
   // If there is any lexical error, stop right away.
-  const auto lex_status = analyzer->Tokenize();
+  const auto lex_status =
+      lexed_tokens != nullptr
+          ? analyzer->TokenizeWithExcerpt(0, text_base, *lexed_tokens)
+          : analyzer->Tokenize();
   if (!lex_status.ok()) return analyzer;
+  // Until analyzed, the analyzer's tokens are as lexed, and can be reused
+  // by the analyses in other modes.
+  if (lexed_tokens == nullptr) lexed_tokens = &analyzer->Data().TokenStream();
   const absl::string_view parse_mode =
       ScanParsingModeDirective(analyzer->Data().TokenStream());
   if (!parse_mode.empty()) {
     // Invoke alternate parser, and use its results.
-    // Slightly inefficient to lex text all over again, but this is
-    // acceptable for an exceptional code path (also see: #1519)
     VLOG(1) << "Analyzing using parse mode directive: " << parse_mode;
-    auto mode_analyzer = AnalyzeVerilogWithMode(text->AsStringView(), name,
-                                                parse_mode, preprocess_config);
+    auto mode_analyzer =
+        AnalyzeVerilogWithMode(text_base, name, parse_mode, preprocess_config,
+                               lexed_tokens);
     if (mode_analyzer != nullptr) return mode_analyzer;
     // Silently ignore any unknown parsing modes.
   }
 
+  if (parsing_modes != nullptr) {
+    const std::string remembered_mode = parsing_modes->Find(name);
+    if (!remembered_mode.empty()) {
+      VLOG(1) << "Analyzing using remembered parse mode: " << remembered_mode;
+      auto mode_analyzer = AnalyzeVerilogWithMode(
+          text_base, name, remembered_mode, preprocess_config, lexed_tokens);
+      if (mode_analyzer != nullptr && mode_analyzer->ParseStatus().ok()) {
+        return mode_analyzer;
+      }
+      parsing_modes->Remember(name, "");
+    }
+  }
+
+  // Analysis modifies the tokens; only tokens lexed separately can be reused
+  // by a retry.
+  if (lexed_tokens == &analyzer->Data().TokenStream()) lexed_tokens = nullptr;
+
   // In all other cases, continue to parse in normal mode.  (common path)
   const auto parse_status = analyzer->Analyze();
 
@@ -166,13 +319,17 @@ std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::AnalyzeAutomaticMode(
               verilog_tokentype(first_reject.token_info.token_enum()));
       VLOG(1) << "Retrying parsing in mode: \"" << retry_parse_mode << "\".";
       if (!retry_parse_mode.empty()) {
-        auto retry_analyzer = AnalyzeVerilogWithMode(
-            text->AsStringView(), name, retry_parse_mode, preprocess_config);
+        auto retry_analyzer =
+            AnalyzeVerilogWithMode(text_base, name, retry_parse_mode,
+                                   preprocess_config, lexed_tokens);
         const absl::string_view retry_text_base =
             retry_analyzer->Data().Contents();
         VLOG(1) << "Retrying to parse:\n" << retry_text_base;
         if (retry_analyzer->ParseStatus().ok()) {
           VLOG(1) << "Retrying parsing succeeded.";
+          if (parsing_modes != nullptr) {
+            parsing_modes->Remember(name, retry_parse_mode);
+          }
           // Retry mode succeeded, proceed with this analyzer's results.
           return retry_analyzer;
         }
@@ -208,38 +365,443 @@ std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::AnalyzeAutomaticMode(
                               name, preprocess_config);
 }
 
+// Returns true if any of "tokens" is one of "token_enums".
+static bool ContainsAnyTokenOf(const TokenSequence& tokens,
+                               std::initializer_list<int> token_enums) {
+  return std::any_of(tokens.begin(), tokens.end(),
+                     [&token_enums](const TokenInfo& token) {
+                       return std::find(token_enums.begin(), token_enums.end(),
+                                        token.token_enum()) !=
+                              token_enums.end();
+                     });
+}
+
 std::unique_ptr<VerilogAnalyzer>
-VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(absl::string_view text,
-                                                    absl::string_view name) {
-  std::unique_ptr<verilog::VerilogAnalyzer> parser;
+VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+    const std::shared_ptr<verible::MemBlock>& text, absl::string_view name,
+    const VerilogPreprocess::Config* first_attempt,
+    ParsingModeMemo* parsing_modes) {
+  // Lex once; every attempt starts from a copy of these tokens, because
+  // analysis modifies them.
+  VerilogAnalyzer lexed(text, name, {});
+  if (!lexed.Tokenize().ok()) {
+    // No preprocessor configuration gets past lexical errors.
+    return AnalyzeAutomaticMode(text, name, {}, parsing_modes);
+  }
+  const TokenSequence& tokens = lexed.Data().TokenStream();
+
+  // Without conditionals, filtering branches does not change the tokens to
+  // parse, and without macro calls, neither does expanding macros.
+  const bool has_conditionals = ContainsAnyTokenOf(
+      tokens, {PP_ifdef, PP_ifndef, PP_elsif, PP_else, PP_endif});
+  const bool has_macro_calls =
+      ContainsAnyTokenOf(tokens, {MacroIdentifier, MacroIdItem, MacroCallId});
+
+  std::vector<VerilogPreprocess::Config> attempts;
+  if (first_attempt != nullptr) attempts.push_back(*first_attempt);
   for (bool preprocess_expand_macros : {false, true}) {
-    bool expand_macro_status = false;
+    if (preprocess_expand_macros && !has_macro_calls) continue;
     for (bool preprocess_filter_branches : {false, true}) {
-      parser = verilog::VerilogAnalyzer::AnalyzeAutomaticMode(
-          text, name,
-          {.filter_branches = preprocess_filter_branches,
-           .expand_macros = preprocess_expand_macros});
-      if (parser && parser->LexStatus().ok() && parser->ParseStatus().ok()) {
-        expand_macro_status = true;
-        break;
+      if (preprocess_filter_branches && !has_conditionals) continue;
+      if (first_attempt != nullptr &&
+          first_attempt->filter_branches == preprocess_filter_branches &&
+          first_attempt->expand_macros == preprocess_expand_macros) {
+        continue;
       }
-      VLOG(1) << "Retry parsing with filter branches enabled";
+      attempts.push_back({.filter_branches = preprocess_filter_branches,
+                          .expand_macros = preprocess_expand_macros});
+    }
+  }
+
+  std::unique_ptr<verilog::VerilogAnalyzer> parser;
+  for (const VerilogPreprocess::Config& config : attempts) {
+    VLOG(1) << "Parsing with filter_branches=" << config.filter_branches
+            << " expand_macros=" << config.expand_macros;
+    parser = AnalyzeAutomaticMode(text, name, config, &tokens, parsing_modes);
+    if (parser && parser->LexStatus().ok() && parser->ParseStatus().ok()) {
+      break;
     }
-    if (expand_macro_status) break;
-    VLOG(1) << "Retry parsing with macro expanding enabled";
   }
   return parser;
 }
 
+std::unique_ptr<VerilogAnalyzer>
+VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+    absl::string_view text, absl::string_view name,
+    const VerilogPreprocess::Config* first_attempt) {
+  return AnalyzeAutomaticPreprocessFallback(
+      std::make_shared<verible::StringMemBlock>(text), name, first_attempt);
+}
+
+// Returns the index of the top-level description in "root" that encloses the
+// byte range [begin, end) of "text" such that the first and last byte of the
+// description are outside that range, or -1 if there is none.
+static int FindEnclosingDescription(const verible::Symbol& root,
+                                    absl::string_view text, size_t begin,
+                                    size_t end) {
+  if (root.Kind() != verible::SymbolKind::kNode) return -1;
+  const auto& descriptions = verible::SymbolCastToNode(root);
+  if (!descriptions.MatchesTag(NodeEnum::kDescriptionList)) return -1;
+  int index = 0;
+  for (const auto& description : descriptions.children()) {
+    if (description != nullptr) {
+      const absl::string_view span = verible::StringSpanOfSymbol(*description);
+      const size_t left = std::distance(text.begin(), span.begin());
+      const size_t right = left + span.length();
+      if (left < begin && end < right) return index;
+      if (begin < right) break;  // Edit is not within a single description.
+    }
+    ++index;
+  }
+  return -1;
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::ReanalyzeEditedDescription(
+    const VerilogAnalyzer& previous, absl::string_view text,
+    absl::string_view name) {
+  return ReanalyzeEditedDescription(
+      previous, std::make_shared<verible::StringMemBlock>(text), name);
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::ReanalyzeEditedDescription(
+    const VerilogAnalyzer& previous,
+    const std::shared_ptr<verible::MemBlock>& text_block,
+    absl::string_view name) {
+  const absl::string_view text = text_block->AsStringView();
+  const verible::TextStructureView& previous_data = previous.Data();
+  const absl::string_view previous_text = previous_data.Contents();
+  // Splicing is only equivalent to a full analysis if the previous analysis
+  // was a plain, successful top-level parse, and no macro definitions could
+  // influence the text that is re-parsed in isolation.
+  if (!previous.LexStatus().ok() || !previous.ParseStatus().ok() ||
+      previous.preprocess_config_.filter_branches ||
+      previous.preprocess_config_.expand_macros ||
+      previous.HasMacroDefinitions() ||
+      !previous.rejected_tokens_.empty() ||
+      previous_data.SyntaxTree() == nullptr ||
+      !ScanParsingModeDirective(previous_data.TokenStream()).empty()) {
+    return nullptr;
+  }
+
+  // Narrow the edit down to the range that differs between the texts.
+  const size_t common_length = std::min(previous_text.length(), text.length());
+  const size_t prefix_length =
+      std::mismatch(text.begin(), text.begin() + common_length,
+                    previous_text.begin())
+          .first -
+      text.begin();
+  const size_t suffix_length =
+      std::mismatch(text.rbegin(),
+                    text.rbegin() + (common_length - prefix_length),
+                    previous_text.rbegin())
+          .first -
+      text.rbegin();
+  const size_t previous_edit_end = previous_text.length() - suffix_length;
+
+  const int description_index =
+      FindEnclosingDescription(*previous_data.SyntaxTree(), previous_text,
+                               prefix_length, previous_edit_end);
+  if (description_index < 0) return nullptr;
+  const auto& previous_root =
+      verible::SymbolCastToNode(*previous_data.SyntaxTree());
+  const absl::string_view previous_description =
+      verible::StringSpanOfSymbol(*previous_root[description_index]);
+  const size_t description_begin =
+      std::distance(previous_text.begin(), previous_description.begin());
+  const size_t description_end =
+      description_begin + previous_description.length();
+  const size_t new_description_length =
+      previous_description.length() + text.length() - previous_text.length();
+  if (new_description_length > text.length() ||
+      absl::StrContains(text.substr(prefix_length, text.length() -
+                                                       suffix_length -
+                                                       prefix_length),
+                        kParseDirectiveName)) {
+    return nullptr;
+  }
+
+  // Re-lex and re-parse only the edited description, in place.
+  auto description_analyzer = std::make_unique<VerilogAnalyzer>(
+      std::make_shared<verible::SubMemBlock>(
+          text_block, text.substr(description_begin, new_description_length)),
+      name, previous.preprocess_config_);
+  if (!description_analyzer->Analyze().ok() ||
+      !description_analyzer->preprocessor_data_.macro_definitions.empty() ||
+      !description_analyzer->rejected_tokens_.empty()) {
+    return nullptr;
+  }
+  verible::TextStructureView& description_data =
+      description_analyzer->MutableData();
+  const absl::string_view description_text = description_data.Contents();
+  verible::ConcreteSyntaxTree& description_root =
+      description_data.MutableSyntaxTree();
+  if (description_root == nullptr ||
+      description_root->Kind() != verible::SymbolKind::kNode) {
+    return nullptr;
+  }
+  auto& new_descriptions = verible::SymbolCastToNode(*description_root);
+  if (!new_descriptions.MatchesTag(NodeEnum::kDescriptionList) ||
+      new_descriptions.size() != 1 || new_descriptions.front() == nullptr ||
+      verible::StringSpanOfSymbol(*new_descriptions.front()) !=
+          description_text) {
+    return nullptr;  // The edit split or merged descriptions.
+  }
+
+  auto analyzer = std::make_unique<VerilogAnalyzer>(
+      text_block, name, previous.preprocess_config_);
+  verible::TextStructureView& data = analyzer->MutableData();
+  const absl::string_view contents = data.Contents();
+  const int length_delta = text.length() - previous_text.length();
+  const auto rebase_previous_token = [=](TokenInfo* token) {
+    int offset = token->left(previous_text);
+    if (offset >= static_cast<int>(description_end)) offset += length_delta;
+    token->RebaseStringView(contents.begin() + offset);
+  };
+  const auto rebase_description_token = [=](TokenInfo* token) {
+    token->RebaseStringView(contents.begin() + description_begin +
+                            token->left(description_text));
+  };
+
+  // Splice the tokens: previous ones before and after the edited description
+  // and the re-lexed ones in place of it.  The token stream view is
+  // translated via indices, as iterators are only valid after the combined
+  // sequence has been finalized.
+  const TokenSequence& previous_tokens = previous_data.TokenStream();
+  const auto starts_before = [&previous_text](size_t offset) {
+    return [&previous_text, offset](const TokenInfo& token) {
+      return token.left(previous_text) < static_cast<int>(offset);
+    };
+  };
+  const auto description_tokens_begin =
+      std::partition_point(previous_tokens.begin(), previous_tokens.end(),
+                           starts_before(description_begin));
+  const auto description_tokens_end =
+      std::partition_point(description_tokens_begin, previous_tokens.end(),
+                           starts_before(description_end));
+  TokenSequence& new_description_tokens = description_data.MutableTokenStream();
+  if (!new_description_tokens.empty() &&
+      new_description_tokens.back().isEOF()) {
+    new_description_tokens.pop_back();
+  }
+  const size_t head_size =
+      std::distance(previous_tokens.begin(), description_tokens_begin);
+  const size_t previous_description_size =
+      std::distance(description_tokens_begin, description_tokens_end);
+  const size_t new_description_size = new_description_tokens.size();
+
+  TokenSequence& tokens = data.MutableTokenStream();
+  tokens.reserve(previous_tokens.size() - previous_description_size +
+                 new_description_size);
+  tokens.assign(previous_tokens.begin(), description_tokens_begin);
+  tokens.insert(tokens.end(), new_description_tokens.begin(),
+                new_description_tokens.end());
+  tokens.insert(tokens.end(), description_tokens_end, previous_tokens.end());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (i < head_size || i >= head_size + new_description_size) {
+      rebase_previous_token(&tokens[i]);
+    } else {
+      rebase_description_token(&tokens[i]);
+    }
+  }
+
+  std::vector<size_t> view_indices;
+  view_indices.reserve(previous_data.GetTokenStreamView().size() +
+                       description_data.GetTokenStreamView().size());
+  for (const auto& token_iter : previous_data.GetTokenStreamView()) {
+    const size_t index = std::distance(previous_tokens.begin(), token_iter);
+    if (index >= head_size) break;
+    view_indices.push_back(index);
+  }
+  for (const auto& token_iter : description_data.GetTokenStreamView()) {
+    const size_t index =
+        std::distance(new_description_tokens.cbegin(), token_iter);
+    if (index >= new_description_size) break;  // Skip the EOF token.
+    view_indices.push_back(head_size + index);
+  }
+  for (const auto& token_iter : previous_data.GetTokenStreamView()) {
+    const size_t index = std::distance(previous_tokens.begin(), token_iter);
+    if (index < head_size + previous_description_size) continue;
+    view_indices.push_back(index - previous_description_size +
+                           new_description_size);
+  }
+  verible::TokenStreamView& view = data.MutableTokenStreamView();
+  view.clear();
+  view.reserve(view_indices.size());
+  for (const size_t index : view_indices) {
+    view.push_back(tokens.cbegin() + index);
+  }
+
+  // Splice the syntax tree: copies of the unchanged descriptions, and the
+  // freshly parsed one (whose ownership is transferred).
+  auto root =
+      std::make_unique<verible::SyntaxTreeNode>(previous_root.Tag().tag);
+  int index = 0;
+  for (const auto& description : previous_root.children()) {
+    verible::SymbolPtr copy;
+    if (index == description_index) {
+      copy = std::move(new_descriptions.front());
+      verible::MutateLeaves(&copy, rebase_description_token);
+    } else if (description != nullptr) {
+      copy = verible::CopySyntaxTree(*description);
+      verible::MutateLeaves(&copy, rebase_previous_token);
+    }
+    root->AppendChild(std::move(copy));
+    ++index;
+  }
+  data.MutableSyntaxTree() = std::move(root);
+
+  analyzer->tokenized_ = true;
+  analyzer->max_used_stack_size_ =
+      std::max(previous.max_used_stack_size_,
+               description_analyzer->max_used_stack_size_);
+  analyzer->preprocessor_data_.preprocessed_token_stream =
+      data.GetTokenStreamView();
+
+  if (const absl::Status status = data.InternalConsistencyCheck();
+      !status.ok()) {
+    LOG(WARNING) << "Incremental analysis of " << name
+                 << " is inconsistent: " << status.message();
+    return nullptr;
+  }
+  return analyzer;
+}
+
+// Serialized analysis: these 32-bit little-endian words, followed by the
+// serialized text structure.
+static constexpr uint32_t kAnalysisMagic = 0x414e4156;  // "VANA"
+static constexpr uint32_t kAnalysisFormatVersion = 1;
+static constexpr size_t kAnalysisHeaderWords = 4;  // magic, version, flags,
+                                                   // max used stack size
+static constexpr uint32_t kFilterBranchesFlag = 1 << 0;
+static constexpr uint32_t kMacroDefinitionsFlag = 1 << 1;
+
+static void AppendWord(uint32_t word, std::string* out) {
+  for (int i = 0; i < 4; ++i) out->push_back((word >> (8 * i)) & 0xff);
+}
+
+static uint32_t WordAt(absl::string_view data, size_t index) {
+  uint32_t word = 0;
+  for (int i = 0; i < 4; ++i) {
+    word |= static_cast<uint32_t>(static_cast<uint8_t>(data[4 * index + i]))
+            << (8 * i);
+  }
+  return word;
+}
+
+verible::MemoryUsage VerilogAnalyzer::MemoryUsage() const {
+  verible::MemoryUsage usage;
+  if (text_structure_ != nullptr) usage = text_structure_->MemoryUsage();
+  usage.Add("rejected_tokens", verible::VectorMemoryUsage(rejected_tokens_));
+  const VerilogPreprocessData &data = preprocessor_data_;
+  usage.Add("preprocessed_tokens",
+            verible::VectorMemoryUsage(data.preprocessed_token_stream));
+  size_t macro_bytes =
+      verible::VectorMemoryUsage(data.lexed_macros_backup) +
+      data.macro_definitions.size() *
+          sizeof(VerilogPreprocessData::MacroDefinitionRegistry::value_type);
+  for (const auto &tokens : data.lexed_macros_backup) {
+    macro_bytes += verible::VectorMemoryUsage(tokens);
+  }
+  usage.Add("macros", macro_bytes);
+  for (const auto &included : data.included_text_structure) {
+    usage.Add("include.", included->MemoryUsage());
+  }
+  return usage;
+}
+
+absl::StatusOr<std::string> VerilogAnalyzer::SerializeAnalysis() const {
+  if (!tokenized_ || !lex_status_.ok() || !parse_status_.ok() ||
+      !rejected_tokens_.empty()) {
+    return absl::FailedPreconditionError("Only clean analyses are restorable.");
+  }
+  if (preprocess_config_.include_files || preprocess_config_.expand_macros) {
+    return absl::FailedPreconditionError(
+        "Analyses with included files or expanded macros are not restorable.");
+  }
+  if (shallow_parsing_) {
+    return absl::FailedPreconditionError(
+        "Shallow analyses are not restorable.");
+  }
+  const absl::StatusOr<std::string> text_structure =
+      verible::SerializeTextStructure(Data());
+  if (!text_structure.ok()) return text_structure.status();
+  std::string result;
+  result.reserve(4 * kAnalysisHeaderWords + text_structure->length());
+  AppendWord(kAnalysisMagic, &result);
+  AppendWord(kAnalysisFormatVersion, &result);
+  AppendWord((preprocess_config_.filter_branches ? kFilterBranchesFlag : 0) |
+                 (HasMacroDefinitions() ? kMacroDefinitionsFlag : 0),
+             &result);
+  AppendWord(max_used_stack_size_, &result);
+  result.append(*text_structure);
+  return result;
+}
+
+absl::StatusOr<std::unique_ptr<VerilogAnalyzer>>
+VerilogAnalyzer::RestoreAnalysis(std::shared_ptr<verible::MemBlock> text,
+                                 absl::string_view name,
+                                 absl::string_view serialized) {
+  if (serialized.length() < 4 * kAnalysisHeaderWords ||
+      WordAt(serialized, 0) != kAnalysisMagic ||
+      WordAt(serialized, 1) != kAnalysisFormatVersion) {
+    return absl::DataLossError("Not a serialized analysis.");
+  }
+  const uint32_t flags = WordAt(serialized, 2);
+  auto analyzer = std::make_unique<VerilogAnalyzer>(
+      std::move(text), name,
+      VerilogPreprocess::Config{
+          .filter_branches = (flags & kFilterBranchesFlag) != 0});
+  RETURN_IF_ERROR(verible::DeserializeTextStructure(
+      serialized.substr(4 * kAnalysisHeaderWords), &analyzer->MutableData()));
+  analyzer->tokenized_ = true;
+  analyzer->max_used_stack_size_ = WordAt(serialized, 3);
+  analyzer->restored_macro_definitions_ = (flags & kMacroDefinitionsFlag) != 0;
+  analyzer->preprocessor_data_.preprocessed_token_stream =
+      analyzer->Data().GetTokenStreamView();
+  return analyzer;
+}
+
 void VerilogAnalyzer::FilterTokensForSyntaxTree() {
   MutableData().FilterTokens(&VerilogLexer::KeepSyntaxTreeTokens);
 }
 
 void VerilogAnalyzer::ContextualizeTokens() {
+  const verible::ScopedTrace trace("contextualize", "analysis");
   LexicalContext context;
   context.TransformVerilogSymbols(MutableData().MakeTokenStreamReferenceView());
 }
 
+verible::TokenStreamView VerilogAnalyzer::ElideProceduralBodies() {
+  const absl::string_view contents = Data().Contents();
+  const verible::TokenStreamView& view = Data().GetTokenStreamView();
+  unparsed_bodies_.clear();
+  verible::TokenStreamView shallow_view;
+  shallow_view.reserve(view.size());
+  size_t next = 0;  // first index of 'view' not handled yet
+  for (const TokenIndexRange& body : FindProceduralBodies(view)) {
+    // Bodies from macro expansions or included files can't be analyzed from
+    // the text later, so they are parsed right away.
+    const absl::string_view first = view[body.begin]->text();
+    const absl::string_view last = view[body.end - 1]->text();
+    if (!verible::IsSubRange(first, contents) ||
+        !verible::IsSubRange(last, contents)) {
+      continue;
+    }
+    shallow_view.insert(shallow_view.end(), view.begin() + next,
+                        view.begin() + body.begin);
+    next = body.end;
+    unparsed_bodies_.push_back(
+        verible::make_string_view_range(first.begin(), last.end()));
+  }
+  shallow_view.insert(shallow_view.end(), view.begin() + next, view.end());
+  return shallow_view;
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogAnalyzer::AnalyzeUnparsedBody(
+    absl::string_view body) const {
+  return AnalyzeVerilogStatements(body, filename_, preprocess_config_);
+}
+
 // Analyzes Verilog code: lexer, filter, parser.
 // Result of parsing is stored in syntax_tree_ (if passed)
 // or rejected_token_ (if failed).
@@ -256,6 +818,7 @@ absl::Status VerilogAnalyzer::Analyze() {
   // pseudo-preprocess token stream.
   //   Not all analyses will want to preprocess.
   {
+    const verible::ScopedTrace trace("preprocess", "analysis");
     VerilogPreprocess preprocessor(preprocess_config_);
     preprocessor_data_ = preprocessor.ScanStream(Data().GetTokenStreamView());
     if (!preprocessor_data_.errors.empty()) {
@@ -287,11 +850,25 @@ absl::Status VerilogAnalyzer::Analyze() {
     // TODO(fangism): could we just move, swap, or directly reference?
   }
 
-  auto generator = MakeTokenViewer(Data().GetTokenStreamView());
-  VerilogParser parser(&generator, filename_);
-  parse_status_ = FileAnalyzer::Parse(&parser);
+  // A shallow parse sees the tokens without the procedural bodies; the
+  // token stream view of the text structure keeps all of them.
+  verible::TokenStreamView shallow_view;
+  if (shallow_parsing_) shallow_view = ElideProceduralBodies();
+  const verible::TokenStreamView& parse_view =
+      shallow_parsing_ ? shallow_view : Data().GetTokenStreamView();
+  {
+    const verible::ScopedTrace trace("parse", "analysis");
+    if (parse_threads_ > 1) {
+      VerilogParallelParser parser(parse_view, filename_, parse_threads_);
+      parse_status_ = FileAnalyzer::Parse(&parser);
+      max_used_stack_size_ = parser.MaxUsedStackSize();
+    } else {
+      VerilogParser parser(parse_view, filename_);
+      parse_status_ = FileAnalyzer::Parse(&parser);
+      max_used_stack_size_ = parser.MaxUsedStackSize();
+    }
+  }
   // Here would be appropriate for analyzing the syntax tree.
-  max_used_stack_size_ = parser.MaxUsedStackSize();
 
   // Expand macro arguments that are parseable as expressions.
   if (parse_status_.ok() && Data().SyntaxTree() != nullptr) {
@@ -324,16 +901,34 @@ class MacroCallArgExpander : public MutableTreeVisitorRecursive {
     const TokenInfo& token(leaf.get());
     if (token.token_enum() == MacroArg) {
       VLOG(3) << "MacroCallArgExpander: examining token: " << token;
+      const auto [seen, first_occurrence] =
+          analyzed_args_.try_emplace(token.text());
+      if (!first_occurrence) {
+        if (seen->second.first == nullptr) {
+          VLOG(3) << "Ignoring known parsing failure: " << token;
+          return;
+        }
+        std::unique_ptr<verible::TextStructure> copy =
+            CopyAnalysis(token.text(), &seen->second);
+        if (copy != nullptr) {
+          VLOG(3) << "  ... same text seen before, reusing its analysis.";
+          DeferExpansion(token, leaf_owner, std::move(copy));
+          return;
+        }
+      }
       // Attempt to parse text as an expression.
-      std::unique_ptr<VerilogAnalyzer> expr_analyzer = AnalyzeVerilogExpression(
+      // The same arguments recur across files, so these go through the
+      // shared excerpt parser that keeps earlier results.
+      ExcerptParser& excerpt_parser = SharedExcerptParser();
+      std::unique_ptr<VerilogAnalyzer> expr_analyzer = excerpt_parser.Analyze(
           token.text(), absl::StrCat(outer_filename_, ":<macro-arg-expander>"),
-          preprocess_config_);
+          "parse-as-expression", preprocess_config_);
       if (!expr_analyzer->ParseStatus().ok()) {
         // If that failed, try to parse text as a property.
-        expr_analyzer = AnalyzeVerilogPropertySpec(
+        expr_analyzer = excerpt_parser.Analyze(
             token.text(),
             absl::StrCat(outer_filename_, ":<macro-arg-expander-property>"),
-            preprocess_config_);
+            "parse-as-property-spec", preprocess_config_);
         if (!expr_analyzer->ParseStatus().ok()) {
           // If that failed: try to infer parsing mode from comments
           expr_analyzer = VerilogAnalyzer::AnalyzeAutomaticMode(
@@ -358,15 +953,10 @@ class MacroCallArgExpander : public MutableTreeVisitorRecursive {
         }
         CHECK_EQ(token_sequence.back().right(expr_analyzer->Data().Contents()),
                  token.text().length());
-        // Defer in-place expansion until all expansions have been collected
-        // (for efficiency, avoiding inserting into middle of a vector,
-        // and causing excessive reallocation).
-        TextStructureView::DeferredExpansion& analysis_slot =
-            InsertKeyOrDie(&subtrees_to_splice_, token.left(full_text_));
-        CHECK(analysis_slot.subanalysis.get() == nullptr)
-            << "Cannot expand the same location twice.  Token: " << token;
-        analysis_slot.expansion_point = leaf_owner;
-        analysis_slot.subanalysis = expr_analyzer->ReleaseTextStructure();
+        std::unique_ptr<verible::TextStructure> subanalysis =
+            expr_analyzer->ReleaseTextStructure();
+        if (first_occurrence) seen->second.first = subanalysis.get();
+        DeferExpansion(token, leaf_owner, std::move(subanalysis));
       } else {
         // Ignore parse failures.
         VLOG(3) << "Ignoring parsing failure: " << token;
@@ -380,17 +970,70 @@ class MacroCallArgExpander : public MutableTreeVisitorRecursive {
 
   // Process accumulated DeferredExpansions.
   void ExpandSubtrees(VerilogAnalyzer* analyzer) {
+    analyzed_args_.clear();  // first analyses are consumed below
     if (!subtrees_to_splice_.empty()) {
       analyzer->MutableData().ExpandSubtrees(&subtrees_to_splice_);
     }
   }
 
  private:
+  // Analysis of a macro argument text, shared by all arguments of that text.
+  struct ArgAnalysis {
+    // Analysis of the first argument, owned by subtrees_to_splice_, or
+    // nullptr if the text does not parse.
+    const verible::TextStructure* first = nullptr;
+    // Serialized form of 'first', made when the text occurs again.
+    std::string serialized;
+    // Set when 'first' cannot be serialized, e.g. because of tokens from
+    // expanded macros; such texts are analyzed each time.
+    bool analyze_each_time = false;
+  };
+
+  // Returns a new analysis of 'text', restored from the one of an earlier
+  // argument of the same text, or nullptr if that is not possible.
+  static std::unique_ptr<verible::TextStructure> CopyAnalysis(
+      absl::string_view text, ArgAnalysis* analysis) {
+    if (analysis->analyze_each_time) return nullptr;
+    if (analysis->serialized.empty()) {
+      absl::StatusOr<std::string> serialized =
+          verible::SerializeTextStructure(analysis->first->Data());
+      if (!serialized.ok()) {
+        VLOG(3) << "Cannot reuse analysis: " << serialized.status();
+        analysis->analyze_each_time = true;
+        return nullptr;
+      }
+      analysis->serialized = *std::move(serialized);
+    }
+    // Only takes a copy of 'text', does not lex or parse it.
+    VerilogAnalyzer copy(text, "<macro-arg-copy>");
+    const absl::Status status = verible::DeserializeTextStructure(
+        analysis->serialized, &copy.MutableData());
+    CHECK(status.ok()) << status;
+    return copy.ReleaseTextStructure();
+  }
+
+  // Defers in-place expansion until all expansions have been collected
+  // (for efficiency, avoiding inserting into middle of a vector,
+  // and causing excessive reallocation).
+  void DeferExpansion(const TokenInfo& token, SymbolPtr* leaf_owner,
+                      std::unique_ptr<verible::TextStructure> subanalysis) {
+    TextStructureView::DeferredExpansion& analysis_slot =
+        InsertKeyOrDie(&subtrees_to_splice_, token.left(full_text_));
+    CHECK(analysis_slot.subanalysis.get() == nullptr)
+        << "Cannot expand the same location twice.  Token: " << token;
+    analysis_slot.expansion_point = leaf_owner;
+    analysis_slot.subanalysis = std::move(subanalysis);
+  }
+
   // Deferred set of syntax tree nodes to expand.
   // Key: location.
   // Value: substring analysis results.
   TextStructureView::NodeExpansionMap subtrees_to_splice_;
 
+  // Argument texts seen so far, so that each distinct text, like UVM_LOW,
+  // is parsed only once.  Keys point into full_text_.
+  std::map<absl::string_view, ArgAnalysis> analyzed_args_;
+
   // Filename we're processing. Purely FYI.
   const absl::string_view outer_filename_;
 
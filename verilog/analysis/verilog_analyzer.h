@@ -16,18 +16,43 @@
 #define VERIBLE_VERILOG_ANALYSIS_VERILOG_ANALYZER_H_
 
 #include <cstddef>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
 #include "common/analysis/file_analyzer.h"
 #include "common/strings/mem_block.h"
 #include "common/text/token_stream_view.h"
+#include "common/util/memory_usage.h"
 #include "verilog/preprocessor/verilog_preprocess.h"
 
 namespace verilog {
 
+// ParsingModeMemo remembers the parsing mode that
+// VerilogAnalyzer::AnalyzeAutomaticMode() inferred for files that failed to
+// parse as a whole, so that analyzing them again, e.g. after an edit, starts
+// in that mode.  Keyed by file name, and safe to use from multiple threads.
+class ParsingModeMemo {
+ public:
+  // Returns the mode remembered for "filename", or an empty string.
+  std::string Find(absl::string_view filename) const;
+
+  // Remembers "mode" for "filename", or forgets it if "mode" is empty.
+  void Remember(absl::string_view filename, absl::string_view mode);
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, std::string, std::less<>> modes_;  // guarded by mutex_
+};
+
 // VerilogAnalyzer analyzes Verilog and SystemVerilog code syntax.
 class VerilogAnalyzer : public verible::FileAnalyzer {
  public:
@@ -54,6 +79,23 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
   // Lex-es the input text into tokens.
   absl::Status Tokenize() final;
 
+  // Like Tokenize(), but takes the tokens of the substring of the text at
+  // "excerpt_offset" from "excerpt_tokens", which were lexed from "excerpt",
+  // an equal string elsewhere, instead of lexing that substring again.
+  // Only valid if the text before the excerpt leaves the lexer in its initial
+  // state and the text after it starts with whitespace, so that the excerpt
+  // lexes the same on its own.
+  absl::Status TokenizeWithExcerpt(
+      size_t excerpt_offset, absl::string_view excerpt,
+      const verible::TokenSequence &excerpt_tokens);
+
+  // Like Tokenize(), but takes the tokens of the "prefix" that the text starts
+  // with from "prefix_tokens", which were lexed from an equal string
+  // elsewhere, and lexes only the rest of the text.
+  // Only valid if the prefix leaves the lexer in its initial state.
+  absl::Status TokenizeWithPrefix(absl::string_view prefix,
+                                  const verible::TokenSequence &prefix_tokens);
+
   // Create token stream view without comments and whitespace.
   // The retained tokens will become leaves of a concrete syntax tree.
   void FilterTokensForSyntaxTree();
@@ -69,11 +111,53 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
 
   size_t MaxUsedStackSize() const { return max_used_stack_size_; }
 
+  // Parse top-level descriptions (modules, packages, classes, ...) on up to
+  // "num_threads" threads in Analyze(), see VerilogParallelParser.  The
+  // result is the same as parsing the whole file at once; texts that can not
+  // be split safely are parsed that way.
+  void SetParseThreads(int num_threads) { parse_threads_ = num_threads; }
+
+  // Leave the bodies of functions, tasks and procedural blocks unparsed in
+  // Analyze(), see FindProceduralBodies().  The syntax tree still has all
+  // declarations, their headers and port lists, which is all that outlines,
+  // file dependencies and declaration lookups need, but the bodies in it are
+  // empty.  Consumers that need a body analyze it with AnalyzeUnparsedBody().
+  void SetShallowParsing(bool shallow) { shallow_parsing_ = shallow; }
+
+  // Texts of the bodies that a shallow Analyze() left unparsed, as substrings
+  // of Data().Contents(), in text order.
+  const std::vector<absl::string_view> &UnparsedBodies() const {
+    return unparsed_bodies_;
+  }
+
+  // Analyzes one of the UnparsedBodies() as statements, on demand.  The
+  // offsets of the returned analysis are relative to the start of "body".
+  std::unique_ptr<VerilogAnalyzer> AnalyzeUnparsedBody(
+      absl::string_view body) const;
+
+  // Tool directives in the comments of the analyzed text, for the linter's
+  // waivers, the formatter's controls and parsing modes; see
+  // CommentDirectiveTriggers().  Built on first use, from any thread, and
+  // valid as long as this analyzer.
+  const verible::CommentDirectiveIndex &CommentDirectives() const;
+
+  // Triggers of the comment directives that CommentDirectives() holds.
+  static const std::vector<absl::string_view> &CommentDirectiveTriggers();
+
+  // Preprocessor configuration that this analyzer used, e.g. the one that
+  // AnalyzeAutomaticPreprocessFallback() settled on.
+  const VerilogPreprocess::Config &PreprocessConfig() const {
+    return preprocess_config_;
+  }
+
   // Automatically analyze with the correct parsing mode, as detected
-  // by parser directive comments.
+  // by parser directive comments, or inferred from the first syntax error.
+  // If "parsing_modes" is not null, an inferred mode is remembered there, and
+  // tried first the next time the file "name" is analyzed.
   static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticMode(
       const std::shared_ptr<verible::MemBlock> &text, absl::string_view name,
-      const VerilogPreprocess::Config &preprocess_config);
+      const VerilogPreprocess::Config &preprocess_config,
+      ParsingModeMemo *parsing_modes = nullptr);
 
   static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticMode(
       absl::string_view text, absl::string_view name,
@@ -82,14 +166,62 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
   // Automatically analyze with correct parsing mode like AnalyzeAutomaticMode()
   // but attempt first with preprocessor disabled to get as complete as
   // possible parse tree; if this yields to syntax errors, fall back to
-  // enabling preprocess branches.
+  // enabling preprocess branches, then macro expansion.
+  // The text is lexed only once for all attempts, and attempts whose
+  // preprocessor configuration can not make a difference for the text are
+  // skipped.  If given, "first_attempt" is tried before all others, e.g. the
+  // PreprocessConfig() that succeeded for a previous version of the text.
+  // "parsing_modes" is passed on to AnalyzeAutomaticMode().
   static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticPreprocessFallback(
-      absl::string_view text, absl::string_view name);
+      const std::shared_ptr<verible::MemBlock> &text, absl::string_view name,
+      const VerilogPreprocess::Config *first_attempt = nullptr,
+      ParsingModeMemo *parsing_modes = nullptr);
+
+  static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticPreprocessFallback(
+      absl::string_view text, absl::string_view name,
+      const VerilogPreprocess::Config *first_attempt = nullptr);
+
+  // Analyzes "text", which is an edited version of the text that "previous"
+  // analyzed successfully, by re-lexing and re-parsing only the top-level
+  // description (module, class, package, ...) enclosing the edited region.
+  // The new description's tokens and subtree are spliced into copies of the
+  // previous token stream and syntax tree.
+  // Returns nullptr when the edit can not be handled this way, e.g. when it
+  // crosses description boundaries or when macro definitions are involved;
+  // callers should then analyze "text" from scratch.
+  static std::unique_ptr<VerilogAnalyzer> ReanalyzeEditedDescription(
+      const VerilogAnalyzer &previous,
+      const std::shared_ptr<verible::MemBlock> &text, absl::string_view name);
+
+  static std::unique_ptr<VerilogAnalyzer> ReanalyzeEditedDescription(
+      const VerilogAnalyzer &previous, absl::string_view text,
+      absl::string_view name);
+
+  // Serializes the results of a successful Analyze(), so that
+  // RestoreAnalysis() can recreate them without lexing and parsing again.
+  // Fails for analyses that can not be restored that way: those with
+  // errors, those with tokens from included files or expanded macros, and
+  // shallow ones.
+  absl::StatusOr<std::string> SerializeAnalysis() const;
+
+  // Creates an analyzer of "text" that holds the results that
+  // SerializeAnalysis() stored from an earlier analysis of the same text.
+  // Fails if "serialized" is corrupt or does not match "text".
+  // The preprocessor data of the restored analyzer is limited to the
+  // preprocessed token stream.
+  static absl::StatusOr<std::unique_ptr<VerilogAnalyzer>> RestoreAnalysis(
+      std::shared_ptr<verible::MemBlock> text, absl::string_view name,
+      absl::string_view serialized);
 
   const VerilogPreprocessData &PreprocessorData() const {
     return preprocessor_data_;
   }
 
+  // Returns the estimated number of bytes held by the text structure, the
+  // preprocessor's results and the rejected tokens.  Components of included
+  // files are prefixed with "include.".
+  verible::MemoryUsage MemoryUsage() const;
+
   // Maybe this belongs in a subclass like VerilogFileAnalyzer?
   // TODO(fangism): Retain a copy of the token stream transformer because it
   // may contain tokens backed by generated text.
@@ -109,11 +241,29 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
   static constexpr absl::string_view kParseDirectiveName = "verilog_syntax:";
 
  private:
+  // Like AnalyzeAutomaticMode(), but if "lexed_tokens" is not null, starts
+  // from these tokens, lexed from the same "text", instead of lexing it again.
+  static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticMode(
+      const std::shared_ptr<verible::MemBlock> &text, absl::string_view name,
+      const VerilogPreprocess::Config &preprocess_config,
+      const verible::TokenSequence *lexed_tokens,
+      ParsingModeMemo *parsing_modes);
+
   // Attempt to parse all macro arguments as expressions.  Where parsing as an
   // expession succeeds, substitute the leaf with a node with the expression's
   // syntax tree.  If parsing fails, leave the MacroArg token unexpanded.
   void ExpandMacroCallArgExpressions();
 
+  // Returns the token stream view without the procedural bodies that can be
+  // left unparsed, and sets unparsed_bodies_.
+  verible::TokenStreamView ElideProceduralBodies();
+
+  // True if the analyzed text defines macros.
+  bool HasMacroDefinitions() const {
+    return !preprocessor_data_.macro_definitions.empty() ||
+           restored_macro_definitions_;
+  }
+
   // Information about parser internals.
 
   // True if input text has already been lexed.
@@ -122,6 +272,21 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
   // Maximum symbol stack depth.
   size_t max_used_stack_size_ = 0;
 
+  // Threads to parse top-level descriptions with; see SetParseThreads().
+  int parse_threads_ = 1;
+
+  // See SetShallowParsing() and UnparsedBodies().
+  bool shallow_parsing_ = false;
+  std::vector<absl::string_view> unparsed_bodies_;
+
+  // See CommentDirectives().
+  mutable std::once_flag comment_directives_once_;
+  mutable verible::CommentDirectiveIndex comment_directives_;
+
+  // True if restored from an analysis of text with macro definitions, which
+  // are not part of the serialized analysis.
+  bool restored_macro_definitions_ = false;
+
   // Preprocessor.
   const VerilogPreprocess::Config preprocess_config_;
   VerilogPreprocessData preprocessor_data_;
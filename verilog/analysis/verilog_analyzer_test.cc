@@ -14,6 +14,8 @@
 
 #include "verilog/analysis/verilog_analyzer.h"
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,15 +23,18 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/file_analyzer.h"
 #include "common/strings/display_utils.h"
+#include "common/strings/mem_block.h"
 #include "common/text/concrete_syntax_leaf.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/symbol.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
 #include "common/text/token_info_test_util.h"
+#include "common/text/tree_compare.h"
 #include "common/text/tree_utils.h"
 #include "common/util/casts.h"
 #include "common/util/logging.h"
@@ -46,6 +51,7 @@
 namespace verilog {
 namespace {
 
+using testing::ElementsAre;
 using testing::SizeIs;
 using verible::AnalysisPhase;
 using verible::ConcreteSyntaxTree;
@@ -334,6 +340,65 @@ TEST(AnalyzeVerilogLibraryMapTest, ParsesLibraryInclude) {
   EXPECT_OK(ABSL_DIE_IF_NULL(analyzer_ptr)->ParseStatus());
 }
 
+TEST(ExcerptParserTest, UnknownMode) {
+  ExcerptParser parser;
+  EXPECT_EQ(parser.Analyze("a+b", "<file>", "parse-as-nothing",
+                           kDefaultPreprocess),
+            nullptr);
+}
+
+TEST(ExcerptParserTest, RestoresRepeatedExcerpt) {
+  ExcerptParser parser;
+  const std::unique_ptr<VerilogAnalyzer> first = parser.Analyze(
+      "a+(b*c)", "<file>", "parse-as-expression", kDefaultPreprocess);
+  ASSERT_OK(ABSL_DIE_IF_NULL(first)->ParseStatus());
+  const std::unique_ptr<VerilogAnalyzer> second = parser.Analyze(
+      "a+(b*c)", "<other>", "parse-as-expression", kDefaultPreprocess);
+  ASSERT_OK(ABSL_DIE_IF_NULL(second)->ParseStatus());
+  EXPECT_EQ(parser.GetStats().misses, 1);
+  EXPECT_EQ(parser.GetStats().hits, 1);
+
+  EXPECT_EQ(second->Data().Contents(), "a+(b*c)");
+  std::vector<absl::string_view> first_tokens, second_tokens;
+  for (const auto& token : first->Data().TokenStream()) {
+    first_tokens.push_back(token.text());
+  }
+  for (const auto& token : second->Data().TokenStream()) {
+    second_tokens.push_back(token.text());
+  }
+  EXPECT_EQ(first_tokens, second_tokens);
+  EXPECT_TRUE(verible::EqualTrees(first->SyntaxTree().get(),
+                                  second->SyntaxTree().get()));
+
+  // The same text in another mode is analyzed separately.
+  const std::unique_ptr<VerilogAnalyzer> statements = parser.Analyze(
+      "a+(b*c)", "<file>", "parse-as-statements", kDefaultPreprocess);
+  EXPECT_FALSE(ABSL_DIE_IF_NULL(statements)->ParseStatus().ok());
+  EXPECT_EQ(parser.GetStats().misses, 2);
+}
+
+TEST(ExcerptParserTest, DoesNotKeepFailures) {
+  ExcerptParser parser;
+  for (int i = 0; i < 2; ++i) {
+    const std::unique_ptr<VerilogAnalyzer> analyzer = parser.Analyze(
+        "(a+", "<file>", "parse-as-expression", kDefaultPreprocess);
+    EXPECT_FALSE(ABSL_DIE_IF_NULL(analyzer)->ParseStatus().ok());
+  }
+  EXPECT_EQ(parser.GetStats().misses, 2);
+  EXPECT_EQ(parser.GetStats().hits, 0);
+}
+
+TEST(ExcerptParserTest, DropsKeptAnalysesOverBudget) {
+  ExcerptParser parser(1);  // Too small for any analysis.
+  for (int i = 0; i < 2; ++i) {
+    const std::unique_ptr<VerilogAnalyzer> analyzer = parser.Analyze(
+        "a+b", "<file>", "parse-as-expression", kDefaultPreprocess);
+    EXPECT_OK(ABSL_DIE_IF_NULL(analyzer)->ParseStatus());
+  }
+  EXPECT_EQ(parser.GetStats().misses, 2);
+  EXPECT_EQ(parser.GetStats().hits, 0);
+}
+
 // The following tests verify that parser mode selection works.
 TEST(AnalyzeVerilogAutomaticMode, NormalModeEmptyText) {
   std::unique_ptr<VerilogAnalyzer> analyzer_ptr =
@@ -537,10 +602,106 @@ endmodule
     // Also, fallback should succeed with that.
     const auto with_fallback =
         VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(code, "<file>");
-    EXPECT_OK(should_succeed->ParseStatus());
+    EXPECT_OK(with_fallback->ParseStatus());
+    EXPECT_TRUE(with_fallback->PreprocessConfig().filter_branches);
+    EXPECT_FALSE(with_fallback->PreprocessConfig().expand_macros);
+
+    // Starting with the configuration that worked before skips the failing
+    // attempts, with the same result.
+    const auto remembered = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+        code, "<file>", &with_fallback->PreprocessConfig());
+    EXPECT_OK(remembered->ParseStatus());
+    EXPECT_TRUE(remembered->PreprocessConfig().filter_branches);
+  }
+}
+
+TEST(AnalyzeVerilogAutomaticMode, FallbackSkipsIneffectiveConfigurations) {
+  // Neither conditionals nor macro calls: only one configuration can make a
+  // difference, so that is the only one attempted.
+  const auto syntax_error = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+      "module foo(; endmodule\n", "<file>");
+  EXPECT_FALSE(syntax_error->ParseStatus().ok());
+  EXPECT_FALSE(syntax_error->PreprocessConfig().filter_branches);
+  EXPECT_FALSE(syntax_error->PreprocessConfig().expand_macros);
+
+  // Macro calls, but no conditionals.
+  const auto macro_call = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+      "module foo(; `bar endmodule\n", "<file>");
+  EXPECT_FALSE(macro_call->ParseStatus().ok());
+  EXPECT_FALSE(macro_call->PreprocessConfig().filter_branches);
+  EXPECT_TRUE(macro_call->PreprocessConfig().expand_macros);
+
+  // Lexical errors end the analysis right away.
+  const auto lex_error = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+      "`ifdef FOO\nmodule 321foo;\nendmodule\n`endif\n", "<file>");
+  EXPECT_FALSE(lex_error->LexStatus().ok());
+}
+
+// Expects that "actual" has the same tokens as "expected", at the same
+// offsets of their texts.
+static void ExpectSameTokens(const VerilogAnalyzer& actual,
+                             const VerilogAnalyzer& expected) {
+  const auto& actual_tokens = actual.Data().TokenStream();
+  const auto& expected_tokens = expected.Data().TokenStream();
+  ASSERT_EQ(actual_tokens.size(), expected_tokens.size());
+  for (size_t i = 0; i < actual_tokens.size(); ++i) {
+    EXPECT_EQ(actual_tokens[i].token_enum(), expected_tokens[i].token_enum());
+    EXPECT_EQ(actual_tokens[i].text(), expected_tokens[i].text());
+    EXPECT_EQ(actual_tokens[i].left(actual.Data().Contents()),
+              expected_tokens[i].left(expected.Data().Contents()));
+  }
+}
+
+TEST(AnalyzeVerilogAutomaticMode, ModeAnalysisReusesTokens) {
+  constexpr absl::string_view kDirective =
+      "// verilog_syntax: parse-as-module-body\n"
+      "wire w;\n"
+      "assign w = 1'b0;\n";
+  constexpr absl::string_view kInferred =
+      "always @(posedge clk) q <= d;\n"
+      "assign w = 1'b0;\n";
+  for (const absl::string_view code : {kDirective, kInferred}) {
+    const auto automatic = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+        code, "<file>");
+    const auto module_body =
+        AnalyzeVerilogModuleBody(code, "<file>", kDefaultPreprocess);
+    ASSERT_OK(automatic->ParseStatus()) << code;
+    ASSERT_OK(module_body->ParseStatus()) << code;
+    ExpectSameTokens(*automatic, *module_body);
+    EXPECT_TRUE(verible::EqualTrees(automatic->Data().SyntaxTree().get(),
+                                    module_body->Data().SyntaxTree().get()));
   }
 }
 
+TEST(AnalyzeVerilogAutomaticMode, RemembersInferredParsingMode) {
+  ParsingModeMemo memo;
+  const auto analyze = [&memo](absl::string_view code) {
+    return VerilogAnalyzer::AnalyzeAutomaticMode(
+        std::make_shared<verible::StringMemBlock>(code), "body.sv",
+        kDefaultPreprocess, &memo);
+  };
+  EXPECT_EQ(memo.Find("body.sv"), "");
+
+  constexpr absl::string_view kModuleBody = "always @(posedge clk) q <= d;\n";
+  const auto inferred = analyze(kModuleBody);
+  EXPECT_OK(inferred->ParseStatus());
+  EXPECT_EQ(memo.Find("body.sv"), "parse-as-module-body");
+  EXPECT_EQ(memo.Find("other.sv"), "");
+
+  // Starts in the remembered mode, with the same result.
+  const auto remembered = analyze(kModuleBody);
+  EXPECT_OK(remembered->ParseStatus());
+  EXPECT_TRUE(verible::EqualTrees(inferred->Data().SyntaxTree().get(),
+                                  remembered->Data().SyntaxTree().get()));
+  EXPECT_EQ(memo.Find("body.sv"), "parse-as-module-body");
+
+  // Content that does not parse in the remembered mode is analyzed as usual,
+  // and the mode is forgotten.
+  const auto top_level = analyze("package p;\nendpackage\n");
+  EXPECT_OK(top_level->ParseStatus());
+  EXPECT_EQ(memo.Find("body.sv"), "");
+}
+
 // Tests that automatic mode parsing can detect that some first failing
 // keywords will trigger (successful) re-parsing as a library map.
 TEST(AnalyzeVerilogAutomaticMode, InferredLibraryMapMode) {
@@ -848,6 +1009,272 @@ TEST(VerilogAnalyzerExpandsMacroArgsTest, MultipleMacroCalls) {
   }
 }
 
+// Test that macro args of the same text expand at each of their locations,
+// also when the text does not parse.
+TEST(VerilogAnalyzerExpandsMacroArgsTest, RepeatedArgs) {
+  const TokenInfoTestData test = {"`FOO(",
+                                  {SymbolIdentifier, "aa"},
+                                  ", ",
+                                  {MacroArg, "module"},
+                                  ", ",
+                                  {SymbolIdentifier, "aa"},
+                                  ")\n`BAR(",
+                                  {MacroArg, "module"},
+                                  ", ",
+                                  {SymbolIdentifier, "get_name"},
+                                  "(), ",
+                                  {SymbolIdentifier, "get_name"},
+                                  "(), ",
+                                  {SymbolIdentifier, "aa"},
+                                  ")\n"};
+  const auto analyzer =
+      std::make_unique<VerilogAnalyzer>(test.code, "<<inline>>");
+  EXPECT_OK(analyzer->Analyze());
+  const ConcreteSyntaxTree& tree = analyzer->SyntaxTree();
+  const auto search_tokens =
+      test.FindImportantTokens(analyzer->Data().Contents());
+  ASSERT_EQ(search_tokens.size(), 7);
+  for (const auto search_token : search_tokens) {
+    EXPECT_TRUE(TreeContainsToken(tree, search_token));
+  }
+}
+
+// Expects that "incremental" has the same tokens, token view and syntax tree
+// as a full analysis of the same text.
+static void ExpectSameAsFullAnalysis(const VerilogAnalyzer& incremental) {
+  const absl::string_view text = incremental.Data().Contents();
+  VerilogAnalyzer full(text, "<<inline>>");
+  ASSERT_OK(full.Analyze());
+  const absl::string_view full_text = full.Data().Contents();
+
+  const auto& tokens = incremental.Data().TokenStream();
+  const auto& full_tokens = full.Data().TokenStream();
+  ASSERT_EQ(tokens.size(), full_tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i].token_enum(), full_tokens[i].token_enum()) << i;
+    EXPECT_EQ(tokens[i].left(text), full_tokens[i].left(full_text)) << i;
+    EXPECT_EQ(tokens[i].text(), full_tokens[i].text()) << i;
+  }
+
+  const auto& view = incremental.Data().GetTokenStreamView();
+  const auto& full_view = full.Data().GetTokenStreamView();
+  ASSERT_EQ(view.size(), full_view.size());
+  for (size_t i = 0; i < view.size(); ++i) {
+    EXPECT_EQ(std::distance(tokens.begin(), view[i]),
+              std::distance(full_tokens.begin(), full_view[i]));
+  }
+
+  // Leaves must point to the same locations in their respective texts.
+  EXPECT_TRUE(verible::EqualTrees(
+      incremental.SyntaxTree().get(), full.SyntaxTree().get(),
+      [=](const TokenInfo& lhs, const TokenInfo& rhs) {
+        return lhs.token_enum() == rhs.token_enum() &&
+               lhs.text() == rhs.text() &&
+               lhs.left(text) == rhs.left(full_text);
+      }));
+}
+
+TEST(ReanalyzeEditedDescriptionTest, EditInsideModule) {
+  constexpr absl::string_view before =
+      "module a;\n  wire x;\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n"
+      "module c;\n  wire z;\nendmodule\n";
+  constexpr absl::string_view after =
+      "module a;\n  wire x;\nendmodule\n"
+      "module b;\n  wire [7:0] y, w;  // more\n  assign w = y;\nendmodule\n"
+      "module c;\n  wire z;\nendmodule\n";
+  VerilogAnalyzer previous(before, "<<inline>>");
+  ASSERT_OK(previous.Analyze());
+  const auto incremental = VerilogAnalyzer::ReanalyzeEditedDescription(
+      previous, after, "<<inline>>");
+  ASSERT_NE(incremental, nullptr);
+  EXPECT_OK(incremental->LexStatus());
+  EXPECT_OK(incremental->ParseStatus());
+  EXPECT_EQ(incremental->Data().Contents(), after);
+  ExpectSameAsFullAnalysis(*incremental);
+}
+
+TEST(ReanalyzeEditedDescriptionTest, DeletionInsideFirstAndLastDescription) {
+  constexpr absl::string_view before =
+      "package p;\n  localparam int N = 2;\nendpackage\n"
+      "class c;\n  int m;\n  int n;\nendclass\n";
+  constexpr absl::string_view first_edited =
+      "package p;\nendpackage\n"
+      "class c;\n  int m;\n  int n;\nendclass\n";
+  constexpr absl::string_view last_edited =
+      "package p;\n  localparam int N = 2;\nendpackage\n"
+      "class c;\n  int m;\nendclass\n";
+  for (const absl::string_view after : {first_edited, last_edited}) {
+    VerilogAnalyzer previous(before, "<<inline>>");
+    ASSERT_OK(previous.Analyze());
+    const auto incremental = VerilogAnalyzer::ReanalyzeEditedDescription(
+        previous, after, "<<inline>>");
+    ASSERT_NE(incremental, nullptr) << after;
+    ExpectSameAsFullAnalysis(*incremental);
+  }
+}
+
+TEST(ReanalyzeEditedDescriptionTest, ChainedEdits) {
+  std::unique_ptr<VerilogAnalyzer> analyzer =
+      std::make_unique<VerilogAnalyzer>(
+          "module a;\nendmodule\nmodule b;\nendmodule\n", "<<inline>>");
+  ASSERT_OK(analyzer->Analyze());
+  for (const absl::string_view text :
+       {"module a;\n  wire x;\nendmodule\nmodule b;\nendmodule\n",
+        "module a;\n  wire x;\nendmodule\n"
+        "module b;\n  wire y;\nendmodule\n",
+        "module a;\n  wire x1;\nendmodule\n"
+        "module b;\n  wire y;\nendmodule\n"}) {
+    auto next = VerilogAnalyzer::ReanalyzeEditedDescription(*analyzer, text,
+                                                            "<<inline>>");
+    ASSERT_NE(next, nullptr) << text;
+    ExpectSameAsFullAnalysis(*next);
+    analyzer = std::move(next);
+  }
+}
+
+TEST(ReanalyzeEditedDescriptionTest, FallsBackToFullAnalysis) {
+  constexpr absl::string_view before =
+      "module a;\n  wire x;\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n";
+  const absl::string_view unsupported_edits[] = {
+      // unchanged
+      before,
+      // edits crossing a description boundary
+      "module a;\n  wire x;\n  wire y;\nendmodule\n",
+      "module a;\n  wire x;\nendmodule\n\n"
+      "module b;\n  wire y;\nendmodule\n",
+      // edits of the first or last byte of a description
+      "module a;\n  wire x;\nendmodule : a\n"
+      "module b;\n  wire y;\nendmodule\n",
+      // edit that splits a description
+      "module a;\n  wire x;\nendmodule\nmodule a2;\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n",
+      // edit with syntax error
+      "module a;\n  wire wire;\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n",
+      // edit that opens a comment that is closed in a later description
+      "module a;\n  /* wire x;\nendmodule\n"
+      "module b;\n  wire y; */\nendmodule\n",
+      // edit that introduces a macro definition
+      "module a;\n  `define W wire\n  wire x;\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n",
+      // edit that introduces a parsing mode directive
+      "module a;\n  // verilog_syntax: parse-as-module-body\nendmodule\n"
+      "module b;\n  wire y;\nendmodule\n",
+  };
+  for (const absl::string_view after : unsupported_edits) {
+    VerilogAnalyzer previous(before, "<<inline>>");
+    ASSERT_OK(previous.Analyze());
+    EXPECT_EQ(VerilogAnalyzer::ReanalyzeEditedDescription(previous, after,
+                                                          "<<inline>>"),
+              nullptr)
+        << after;
+  }
+}
+
+TEST(ReanalyzeEditedDescriptionTest, RequiresPlainPreviousAnalysis) {
+  constexpr absl::string_view after = "module a;\n  wire x;\nendmodule\n";
+  {
+    VerilogAnalyzer previous("module a;\nendmodule\n", "<<inline>>");
+    // Not analyzed.
+    EXPECT_EQ(VerilogAnalyzer::ReanalyzeEditedDescription(previous, after,
+                                                          "<<inline>>"),
+              nullptr);
+  }
+  {
+    VerilogAnalyzer previous("module a;\nwire wire;\nendmodule\n",
+                             "<<inline>>");
+    EXPECT_FALSE(previous.Analyze().ok());
+    EXPECT_EQ(VerilogAnalyzer::ReanalyzeEditedDescription(previous, after,
+                                                          "<<inline>>"),
+              nullptr);
+  }
+  {
+    VerilogAnalyzer previous("`define W wire\nmodule a;\nendmodule\n",
+                             "<<inline>>");
+    ASSERT_OK(previous.Analyze());
+    EXPECT_EQ(VerilogAnalyzer::ReanalyzeEditedDescription(
+                  previous, "`define W wire\nmodule a;\n  `W x;\nendmodule\n",
+                  "<<inline>>"),
+              nullptr);
+  }
+}
+
+TEST(VerilogAnalyzerParseThreadsTest, SameAsSerialAnalysis) {
+  // Large enough for the descriptions to be parsed in several regions.
+  std::string text;
+  for (int i = 0; i < 300; ++i) {
+    absl::StrAppend(&text, "module m", i, "(input a);\n  wire [3:0] w", i,
+                    " = {a, a};\nendmodule : m", i, "\n",
+                    "class c", i, ";\n  int x;\nendclass\n");
+  }
+  VerilogAnalyzer analyzer(text, "<<inline>>");
+  analyzer.SetParseThreads(4);
+  ASSERT_OK(analyzer.Analyze());
+  ExpectSameAsFullAnalysis(analyzer);
+
+  // Syntax errors are reported as by a single parser.
+  const std::string bad_text =
+      absl::StrCat(text, "module bad; wire; endmodule\n", text);
+  VerilogAnalyzer serial(bad_text, "<<inline>>");
+  EXPECT_FALSE(serial.Analyze().ok());
+  VerilogAnalyzer failing(bad_text, "<<inline>>");
+  failing.SetParseThreads(4);
+  EXPECT_FALSE(failing.Analyze().ok());
+  ASSERT_EQ(failing.GetRejectedTokens().size(),
+            serial.GetRejectedTokens().size());
+  for (size_t i = 0; i < serial.GetRejectedTokens().size(); ++i) {
+    EXPECT_EQ(failing.GetRejectedTokens()[i].token_info,
+              serial.GetRejectedTokens()[i].token_info);
+  }
+}
+
+// Returns true if "tree" has a leaf with the text "text".
+bool TreeContainsText(const ConcreteSyntaxTree& tree, absl::string_view text) {
+  return FindFirstSubtree(tree.get(), [&](const Symbol& symbol) {
+           return symbol.Kind() == verible::SymbolKind::kLeaf &&
+                  down_cast<const SyntaxTreeLeaf*>(&symbol)->get().text() ==
+                      text;
+         }) != nullptr;
+}
+
+TEST(VerilogAnalyzerShallowParsingTest, BodiesAreLeftUnparsed) {
+  constexpr absl::string_view text =
+      "module m(input clk, output reg q);\n"
+      "  function automatic int inc(int a);\n"
+      "    return a + 1;\n"
+      "  endfunction\n"
+      "  always @(posedge clk) begin\n"
+      "    q <= inc(q);\n"
+      "  end\n"
+      "endmodule\n";
+  VerilogAnalyzer analyzer(text, "<<inline>>");
+  analyzer.SetShallowParsing(true);
+  ASSERT_OK(analyzer.Analyze());
+  EXPECT_THAT(analyzer.UnparsedBodies(),
+              ElementsAre("return a + 1;", "q <= inc(q);"));
+
+  // Headers and port lists are parsed, bodies are not.
+  EXPECT_TRUE(TreeContainsText(analyzer.SyntaxTree(), "clk"));
+  EXPECT_TRUE(TreeContainsText(analyzer.SyntaxTree(), "inc"));
+  EXPECT_FALSE(TreeContainsText(analyzer.SyntaxTree(), "return"));
+  EXPECT_FALSE(TreeContainsText(analyzer.SyntaxTree(), "<="));
+  // The token stream is complete.
+  VerilogAnalyzer full(text, "<<inline>>");
+  ASSERT_OK(full.Analyze());
+  EXPECT_EQ(analyzer.Data().GetTokenStreamView().size(),
+            full.Data().GetTokenStreamView().size());
+
+  // Bodies are parsed on demand.
+  const auto body = analyzer.AnalyzeUnparsedBody(analyzer.UnparsedBodies()[1]);
+  ASSERT_NE(body, nullptr);
+  EXPECT_OK(body->ParseStatus());
+  EXPECT_TRUE(TreeContainsText(body->SyntaxTree(), "<="));
+
+  EXPECT_FALSE(analyzer.SerializeAnalysis().ok());
+}
+
 // Helper class for testing internals.
 class VerilogAnalyzerInternalsTest : public testing::Test,
                                      public VerilogAnalyzer {
@@ -19,16 +19,20 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "common/lexer/token_stream_adapter.h"
 #include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
 #include "common/util/enum_flags.h"
 #include "common/util/logging.h"
+#include "external_libs/editscript.h"
 #include "verilog/parser/verilog_lexer.h"
 #include "verilog/parser/verilog_parser.h"  // for verilog_symbol_name()
 #include "verilog/parser/verilog_token_classifications.h"
@@ -108,6 +112,49 @@ DiffStatus VerilogLexicallyEquivalent(
       errstream);
 }
 
+// Computes a hash of the tokens of 'text' that are not removed by
+// 'remove_predicate', in a single lexing pass without saving tokens.
+// Unlexed tokens are hashed by their recursively lexed contents.
+// 'token_hash' must return equal values for tokens that the comparator of the
+// detailed comparison considers equal.
+// Returns false on lexical error.
+static bool HashVerilogTokens(
+    absl::string_view text,
+    const std::function<bool(const TokenInfo &)> &remove_predicate,
+    const std::function<size_t(const TokenInfo &)> &token_hash,
+    size_t *hash) {
+  VerilogLexer lexer(text);
+  for (;;) {
+    const TokenInfo &token = lexer.DoNextToken();
+    if (token.isEOF()) return true;
+    if (lexer.TokenIsError(token)) return false;
+    if (remove_predicate(token)) continue;
+    if (ShouldRecursivelyAnalyzeToken(token)) {
+      size_t sub_hash = 0;
+      if (!HashVerilogTokens(token.text(), remove_predicate, token_hash,
+                             &sub_hash)) {
+        return false;
+      }
+      *hash = absl::HashOf(*hash, token.token_enum(), sub_hash);
+    } else {
+      *hash = absl::HashOf(*hash, token_hash(token));
+    }
+  }
+}
+
+// Returns true if both texts hash equal, see HashVerilogTokens().
+// Lexical errors are left to be reported by the detailed comparison.
+static bool VerilogTokenHashesMatch(
+    absl::string_view left, absl::string_view right,
+    const std::function<bool(const TokenInfo &)> &remove_predicate,
+    const std::function<size_t(const TokenInfo &)> &token_hash) {
+  size_t left_hash = 0;
+  size_t right_hash = 0;
+  return HashVerilogTokens(left, remove_predicate, token_hash, &left_hash) &&
+         HashVerilogTokens(right, remove_predicate, token_hash, &right_hash) &&
+         left_hash == right_hash;
+}
+
 DiffStatus LexicallyEquivalent(
     absl::string_view left_text, absl::string_view right_text,
     const std::function<bool(absl::string_view, TokenSequence *)> &lexer,
@@ -140,13 +187,11 @@ DiffStatus LexicallyEquivalent(
 
   // Filter out ignored tokens from both token sequences.
   verible::TokenStreamView left_filtered, right_filtered;
-  verible::InitTokenStreamView(left_tokens, &left_filtered);
-  verible::InitTokenStreamView(right_tokens, &right_filtered);
   verible::TokenFilterPredicate keep_predicate = [&](const TokenInfo &t) {
     return !remove_predicate(t);
   };
-  verible::FilterTokenStreamViewInPlace(keep_predicate, &left_filtered);
-  verible::FilterTokenStreamViewInPlace(keep_predicate, &right_filtered);
+  verible::FilterTokenStreamView(keep_predicate, left_tokens, &left_filtered);
+  verible::FilterTokenStreamView(keep_predicate, right_tokens, &right_filtered);
 
   // Compare filtered views, starting with sizes.
   const size_t l_size = left_filtered.size();
@@ -242,25 +287,299 @@ DiffStatus LexicallyEquivalent(
   return DiffStatus::kDifferent;
 }
 
+static bool IsWhitespaceToken(const TokenInfo &t) {
+  return IsWhitespace(verilog_tokentype(t.token_enum()));
+}
+
+static bool FormatEquivalentTokens(const TokenInfo &l, const TokenInfo &r) {
+  // MacroCallCloseToEndLine should be considered equivalent to ')', as
+  // they are whitespace dependant
+  if (((r.token_enum() == verilog_tokentype::MacroCallCloseToEndLine) &&
+       (l.text() == ")")) ||
+      ((l.token_enum() == verilog_tokentype::MacroCallCloseToEndLine) &&
+       (r.text() == ")"))) {
+    return true;
+  }
+  return l.EquivalentWithoutLocation(r);
+}
+
+namespace {
+// Lexes a text on demand, and buffers the tokens that are not removed until
+// they are consumed.
+class TokenLookahead {
+ public:
+  TokenLookahead(absl::string_view text,
+                 const std::function<bool(const TokenInfo &)> &remove_predicate)
+      : lexer_(text),
+        remove_predicate_(remove_predicate),
+        eof_(TokenInfo::EOFToken(text)) {}
+
+  // Returns true if there are fewer than n+1 tokens left, because the end of
+  // the text or a lexical error was reached.
+  bool AtEnd(size_t n) {
+    Fill(n);
+    return n >= buffer_.size();
+  }
+
+  // Returns the n-th token after the consumed ones, or the EOF token.
+  const TokenInfo &Peek(size_t n) { return AtEnd(n) ? eof_ : buffer_[n]; }
+
+  // Consumes n tokens, which must have been peeked at.
+  void Consume(size_t n) {
+    buffer_.erase(buffer_.begin(), buffer_.begin() + n);
+    consumed_ += n;
+  }
+
+  // Number of tokens consumed so far.
+  size_t Consumed() const { return consumed_; }
+
+  // Returns the erroneous token, if lexing stopped at an error.
+  const TokenInfo *Error() const {
+    return has_error_ ? &error_token_ : nullptr;
+  }
+
+ private:
+  void Fill(size_t n) {
+    while (buffer_.size() <= n && !done_) {
+      const TokenInfo &token = lexer_.DoNextToken();
+      if (token.isEOF()) {
+        done_ = true;
+      } else if (lexer_.TokenIsError(token)) {
+        done_ = true;
+        has_error_ = true;
+        error_token_ = token;
+      } else if (!remove_predicate_(token)) {
+        buffer_.push_back(token);
+      }
+    }
+  }
+
+  VerilogLexer lexer_;
+  const std::function<bool(const TokenInfo &)> &remove_predicate_;
+  const TokenInfo eof_;
+  std::deque<TokenInfo> buffer_;
+  size_t consumed_ = 0;
+  bool done_ = false;
+  bool has_error_ = false;
+  TokenInfo error_token_ = TokenInfo::EOFToken();
+};
+
+// Token with the comparison used for the edit script of a window.
+struct ComparedToken {
+  const TokenInfo *token;
+  const std::function<bool(const TokenInfo &, const TokenInfo &)> *equal;
+
+  bool operator==(const ComparedToken &other) const {
+    return (*equal)(*token, *other.token);
+  }
+};
+}  // namespace
+
+// Reports the non-equal edits of 'edits' that start before the positions
+// 'left_stop' and 'right_stop' of the windows, as hunks.
+static void PrintWindowHunks(const diff::Edits &edits, size_t left_stop,
+                             size_t right_stop,
+                             const std::vector<TokenInfo> &left_window,
+                             const std::vector<TokenInfo> &right_window,
+                             size_t left_offset, size_t right_offset,
+                             std::ostream &stream) {
+  int64_t left_pos = 0;
+  int64_t right_pos = 0;
+  bool in_hunk = false;
+  for (const auto &edit : edits) {
+    if (edit.operation == diff::Operation::EQUALS) {
+      if (edit.start >= static_cast<int64_t>(left_stop)) break;
+      left_pos = edit.end;
+      right_pos += edit.end - edit.start;
+      in_hunk = false;
+      continue;
+    }
+    if (edit.operation == diff::Operation::DELETE &&
+        edit.start >= static_cast<int64_t>(left_stop)) {
+      break;
+    }
+    if (edit.operation == diff::Operation::INSERT &&
+        edit.start >= static_cast<int64_t>(right_stop)) {
+      break;
+    }
+    if (!in_hunk) {
+      stream << "@@ left token [" << left_offset + left_pos
+             << "], right token [" << right_offset + right_pos << "] @@"
+             << std::endl;
+      in_hunk = true;
+    }
+    const bool is_delete = edit.operation == diff::Operation::DELETE;
+    const auto &window = is_delete ? left_window : right_window;
+    for (int64_t i = edit.start; i < edit.end; ++i) {
+      stream << (is_delete ? "- " : "+ ");
+      VerilogTokenPrinter(window[i], stream);
+      stream << std::endl;
+    }
+    (is_delete ? left_pos : right_pos) = edit.end;
+  }
+}
+
+DiffStatus StreamingLexicallyEquivalent(
+    absl::string_view left_text, absl::string_view right_text,
+    const std::function<bool(const verible::TokenInfo &)> &remove_predicate,
+    const std::function<bool(const verible::TokenInfo &,
+                             const verible::TokenInfo &)> &equal_comparator,
+    const StreamingDiffOptions &options, std::ostream *errstream) {
+  VLOG(2) << __FUNCTION__;
+  TokenLookahead left(left_text, remove_predicate);
+  TokenLookahead right(right_text, remove_predicate);
+
+  // Compares two tokens like LexicallyEquivalent(), which also recursively
+  // compares unlexed tokens (these are bounded in size).
+  // Lexical errors inside unlexed tokens are saved to 'sub_status'.
+  DiffStatus sub_status = DiffStatus::kEquivalent;
+  const std::function<bool(const TokenInfo &, const TokenInfo &)>
+      token_comparator = [&](const TokenInfo &l, const TokenInfo &r) {
+        if (l.token_enum() != r.token_enum() &&
+            !((l.token_enum() == verilog_tokentype::MacroCallCloseToEndLine &&
+               r.text() == ")") ||
+              (r.token_enum() == verilog_tokentype::MacroCallCloseToEndLine &&
+               l.text() == ")"))) {
+          return false;
+        }
+        if (ShouldRecursivelyAnalyzeToken(l)) {
+          const DiffStatus status = VerilogLexicallyEquivalent(
+              l.text(), r.text(), remove_predicate, equal_comparator, nullptr);
+          if (status == DiffStatus::kLeftError ||
+              status == DiffStatus::kRightError) {
+            sub_status = status;
+          }
+          return status == DiffStatus::kEquivalent;
+        }
+        return equal_comparator(l, r);
+      };
+  const auto report_sub_error = [&](const TokenInfo &l, const TokenInfo &r) {
+    if (errstream != nullptr) {
+      *errstream << "Lexical error from "
+                 << (sub_status == DiffStatus::kLeftError ? "left" : "right")
+                 << " input text in: "
+                 << (sub_status == DiffStatus::kLeftError ? l : r) << std::endl;
+    }
+    return sub_status;
+  };
+
+  const size_t window_size = std::max(options.window_size, 1);
+  DiffStatus result = DiffStatus::kEquivalent;
+  for (;;) {
+    const bool left_end = left.AtEnd(0);
+    const bool right_end = right.AtEnd(0);
+    // Report lexical errors as higher precedence, once they are reached.
+    if (left_end && left.Error() != nullptr) {
+      if (errstream != nullptr) {
+        *errstream << "Lexical error from left input text at token ["
+                   << left.Consumed() << "]: " << *left.Error() << std::endl;
+      }
+      return DiffStatus::kLeftError;
+    }
+    if (right_end && right.Error() != nullptr) {
+      if (errstream != nullptr) {
+        *errstream << "Lexical error from right input text at token ["
+                   << right.Consumed() << "]: " << *right.Error() << std::endl;
+      }
+      return DiffStatus::kRightError;
+    }
+    if (left_end && right_end) break;
+    if (!left_end && !right_end) {
+      const TokenInfo &l = left.Peek(0);
+      const TokenInfo &r = right.Peek(0);
+      if (token_comparator(l, r)) {
+        left.Consume(1);
+        right.Consume(1);
+        continue;
+      }
+      if (sub_status != DiffStatus::kEquivalent) return report_sub_error(l, r);
+    }
+
+    // There is a difference.
+    result = DiffStatus::kDifferent;
+    if (options.stop_at_first_difference) {
+      if (errstream == nullptr) break;
+      if (left_end) {
+        *errstream << "First excess token in right sequence: "
+                   << right.Peek(0) << std::endl;
+      } else if (right_end) {
+        *errstream << "First excess token in left sequence: " << left.Peek(0)
+                   << std::endl;
+      } else {
+        *errstream << "First mismatched token [" << left.Consumed() << "]: ";
+        VerilogTokenPrinter(left.Peek(0), *errstream);
+        *errstream << " vs. ";
+        VerilogTokenPrinter(right.Peek(0), *errstream);
+        *errstream << std::endl;
+      }
+      break;
+    }
+
+    // Diff the next windows of both sides.
+    std::vector<TokenInfo> left_window, right_window;
+    for (size_t i = 0; i < window_size && !left.AtEnd(i); ++i) {
+      left_window.push_back(left.Peek(i));
+    }
+    for (size_t i = 0; i < window_size && !right.AtEnd(i); ++i) {
+      right_window.push_back(right.Peek(i));
+    }
+    std::vector<ComparedToken> left_compared, right_compared;
+    for (const auto &token : left_window) {
+      left_compared.push_back({&token, &token_comparator});
+    }
+    for (const auto &token : right_window) {
+      right_compared.push_back({&token, &token_comparator});
+    }
+    const diff::Edits edits =
+        diff::GetTokenDiffs(left_compared.cbegin(), left_compared.cend(),
+                            right_compared.cbegin(), right_compared.cend());
+    // Only lexical errors found while comparing in lockstep are reported.
+    sub_status = DiffStatus::kEquivalent;
+
+    // Resume after the last run of equal tokens, unless the windows reach the
+    // ends of both inputs.  Without equal tokens, skip both windows.
+    size_t left_stop = left_window.size();
+    size_t right_stop = right_window.size();
+    if (!left.AtEnd(left_stop) || !right.AtEnd(right_stop)) {
+      int64_t right_pos = 0;
+      for (const auto &edit : edits) {
+        if (edit.operation == diff::Operation::EQUALS) {
+          left_stop = edit.start;
+          right_stop = right_pos;
+        }
+        if (edit.operation != diff::Operation::DELETE) {
+          right_pos += edit.end - edit.start;
+        }
+      }
+    }
+    if (errstream != nullptr) {
+      PrintWindowHunks(edits, left_stop, right_stop, left_window, right_window,
+                       left.Consumed(), right.Consumed(), *errstream);
+    }
+    left.Consume(left_stop);
+    right.Consume(right_stop);
+  }
+  return result;
+}
+
+static size_t FormatTokenHash(const TokenInfo &t) {
+  // MacroCallCloseToEndLine is equivalent to ')', see FormatEquivalentTokens.
+  const int token_enum =
+      t.token_enum() == verilog_tokentype::MacroCallCloseToEndLine
+          ? ')'
+          : t.token_enum();
+  return absl::HashOf(token_enum, t.text());
+}
+
 DiffStatus FormatEquivalent(absl::string_view left, absl::string_view right,
                             std::ostream *errstream) {
-  return VerilogLexicallyEquivalent(
-      left, right,
-      [](const TokenInfo &t) {
-        return IsWhitespace(verilog_tokentype(t.token_enum()));
-      },
-      [=](const TokenInfo &l, const TokenInfo &r) {
-        // MacroCallCloseToEndLine should be considered equivalent to ')', as
-        // they are whitespace dependant
-        if (((r.token_enum() == verilog_tokentype::MacroCallCloseToEndLine) &&
-             (l.text() == ")")) ||
-            ((l.token_enum() == verilog_tokentype::MacroCallCloseToEndLine) &&
-             (r.text() == ")"))) {
-          return true;
-        }
-        return l.EquivalentWithoutLocation(r);
-      },
-      errstream);
+  // Most compared texts are equivalent: confirm that cheaply first.
+  if (VerilogTokenHashesMatch(left, right, IsWhitespaceToken,
+                              FormatTokenHash)) {
+    return DiffStatus::kEquivalent;
+  }
+  return VerilogLexicallyEquivalent(left, right, IsWhitespaceToken,
+                                    FormatEquivalentTokens, errstream);
 }
 
 static bool ObfuscationEquivalentTokens(const TokenInfo &l,
@@ -272,16 +591,45 @@ static bool ObfuscationEquivalentTokens(const TokenInfo &l,
   return l.EquivalentWithoutLocation(r);
 }
 
+static size_t ObfuscationTokenHash(const TokenInfo &t) {
+  if (IsIdentifierLike(verilog_tokentype(t.token_enum()))) {
+    return absl::HashOf(t.token_enum(), t.text().length());
+  }
+  return absl::HashOf(t.token_enum(), t.text());
+}
+
+static bool KeepAllTokens(const TokenInfo &) {
+  // Whitespaces are required to match exactly.
+  return false;
+}
+
 DiffStatus ObfuscationEquivalent(absl::string_view left,
                                  absl::string_view right,
                                  std::ostream *errstream) {
-  return VerilogLexicallyEquivalent(
-      left, right,
-      [](const TokenInfo &) {
-        // Whitespaces are required to match exactly.
-        return false;
-      },
-      ObfuscationEquivalentTokens, errstream);
+  if (VerilogTokenHashesMatch(left, right, KeepAllTokens,
+                              ObfuscationTokenHash)) {
+    return DiffStatus::kEquivalent;
+  }
+  return VerilogLexicallyEquivalent(left, right, KeepAllTokens,
+                                    ObfuscationEquivalentTokens, errstream);
+}
+
+DiffStatus StreamingFormatEquivalent(absl::string_view left,
+                                     absl::string_view right,
+                                     const StreamingDiffOptions &options,
+                                     std::ostream *errstream) {
+  return StreamingLexicallyEquivalent(left, right, IsWhitespaceToken,
+                                      FormatEquivalentTokens, options,
+                                      errstream);
+}
+
+DiffStatus StreamingObfuscationEquivalent(absl::string_view left,
+                                          absl::string_view right,
+                                          const StreamingDiffOptions &options,
+                                          std::ostream *errstream) {
+  return StreamingLexicallyEquivalent(left, right, KeepAllTokens,
+                                      ObfuscationEquivalentTokens, options,
+                                      errstream);
 }
 
 }  // namespace verilog
@@ -66,6 +66,27 @@ DiffStatus VerilogLexicallyEquivalent(
                              const verible::TokenInfo &)> &equal_comparator,
     std::ostream *errstream = nullptr);
 
+// Controls StreamingLexicallyEquivalent().
+struct StreamingDiffOptions {
+  // If true, stop at the first difference.  Otherwise, report every
+  // difference as a hunk of the edit script of the next 'window_size' tokens
+  // of both sides, and continue after the last run of equal tokens in it.
+  bool stop_at_first_difference = true;
+  int window_size = 1000;
+};
+
+// Like VerilogLexicallyEquivalent(), but lexes both texts in lockstep, one
+// token at a time, instead of lexing each into a full token sequence first.
+// Memory use only grows with 'options.window_size', not with the inputs.
+// Differences and errors are printed to errstream, if provided, as soon as
+// they are found.
+DiffStatus StreamingLexicallyEquivalent(
+    absl::string_view left, absl::string_view right,
+    const std::function<bool(const verible::TokenInfo &)> &remove_predicate,
+    const std::function<bool(const verible::TokenInfo &,
+                             const verible::TokenInfo &)> &equal_comparator,
+    const StreamingDiffOptions &options, std::ostream *errstream = nullptr);
+
 // Returns true if both token sequences are equivalent, ignoring whitespace.
 // If errstream is provided, print detailed error message to that stream.
 DiffStatus FormatEquivalent(absl::string_view left, absl::string_view right,
@@ -80,6 +101,17 @@ DiffStatus ObfuscationEquivalent(absl::string_view left,
                                  absl::string_view right,
                                  std::ostream *errstream = nullptr);
 
+// Streaming versions of FormatEquivalent() and ObfuscationEquivalent(), see
+// StreamingLexicallyEquivalent().
+DiffStatus StreamingFormatEquivalent(absl::string_view left,
+                                     absl::string_view right,
+                                     const StreamingDiffOptions &options,
+                                     std::ostream *errstream = nullptr);
+DiffStatus StreamingObfuscationEquivalent(absl::string_view left,
+                                          absl::string_view right,
+                                          const StreamingDiffOptions &options,
+                                          std::ostream *errstream = nullptr);
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_EQUIVALENCE_H_
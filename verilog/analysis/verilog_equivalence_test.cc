@@ -18,9 +18,12 @@
 #include <functional>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "gtest/gtest.h"
@@ -505,5 +508,135 @@ TEST(ObfuscationEquivalentTest, LexErrorOnRight) {
                                                            << errs.str();
 }
 
+static std::function<DiffStatus(absl::string_view, absl::string_view,
+                                 std::ostream *)>
+Streaming(const std::function<DiffStatus(
+              absl::string_view, absl::string_view,
+              const StreamingDiffOptions &, std::ostream *)> &func,
+          const StreamingDiffOptions &options = {}) {
+  return [=](absl::string_view left, absl::string_view right,
+             std::ostream *errstream) {
+    return func(left, right, options, errstream);
+  };
+}
+
+TEST(StreamingFormatEquivalentTest, SameAsFormatEquivalent) {
+  const std::vector<std::pair<const char *, const char *>> kTestCases = {
+      {"", ""},
+      {"", "    "},
+      {"module foo;endmodule", "module  foo ;\nendmodule\n"},
+      {"module foo;endmodule", "module bar;endmodule"},
+      {"module foo;endmodule", "module foo;"},
+      {"", "module"},
+      {"`FOO(a, b)", "`FOO(a,b)"},
+      {"`FOO(a, b)", "`FOO(a,c)"},
+      {"`define FOO a + b\n", "`define FOO a+b\n"},
+      {"/* c */ module", "/* d */ module"},
+  };
+  for (const auto &test : kTestCases) {
+    const DiffStatus expect = FormatEquivalent(test.first, test.second);
+    for (const bool stop : {true, false}) {
+      StreamingDiffOptions options;
+      options.stop_at_first_difference = stop;
+      ExpectCompareWithErrstream(Streaming(StreamingFormatEquivalent, options),
+                                 expect, test.first, test.second);
+    }
+  }
+}
+
+TEST(StreamingFormatEquivalentTest, DiagnosticFirstDifference) {
+  {
+    std::ostringstream errs;
+    ExpectCompareWithErrstream(Streaming(StreamingFormatEquivalent),
+                               DiffStatus::kDifferent, "module foo;\n",
+                               "module foo\n", &errs);
+    EXPECT_TRUE(absl::StrContains(errs.str(), "First mismatched token [2]:"))
+        << "full message:\n"
+        << errs.str();
+  }
+  {
+    std::ostringstream errs;
+    ExpectCompareWithErrstream(Streaming(StreamingFormatEquivalent),
+                               DiffStatus::kDifferent, "module ",
+                               "module extra_token", &errs);
+    EXPECT_TRUE(absl::StrContains(errs.str(),
+                                  "First excess token in right sequence: "))
+        << "full message:\n"
+        << errs.str();
+    EXPECT_TRUE(absl::StrContains(errs.str(), "extra_token"))
+        << "full message:\n"
+        << errs.str();
+  }
+}
+
+TEST(StreamingFormatEquivalentTest, ReportAllDifferences) {
+  constexpr absl::string_view kLeft =
+      "module foo; wire a; wire b; assign a = b; endmodule\n";
+  constexpr absl::string_view kRight =
+      "module bar; wire a; wire c; assign a = b; endmodule\n";
+  for (const int window_size : {1, 2, 3, 5, 1000}) {
+    StreamingDiffOptions options;
+    options.stop_at_first_difference = false;
+    options.window_size = window_size;
+    std::ostringstream errs;
+    EXPECT_EQ(StreamingFormatEquivalent(kLeft, kRight, options, &errs),
+              DiffStatus::kDifferent);
+    const std::string message = errs.str();
+    EXPECT_TRUE(
+        absl::StrContains(message, "@@ left token [1], right token [1] @@"))
+        << "window: " << window_size << ", full message:\n"
+        << message;
+    EXPECT_TRUE(
+        absl::StrContains(message, "@@ left token [7], right token [7] @@"))
+        << "window: " << window_size << ", full message:\n"
+        << message;
+    EXPECT_TRUE(absl::StrContains(message, "- (SymbolIdentifier) "))
+        << "full message:\n"
+        << message;
+    EXPECT_TRUE(absl::StrContains(message, "+ (SymbolIdentifier) "))
+        << "full message:\n"
+        << message;
+    for (const absl::string_view text : {"foo", "bar", "b", "c"}) {
+      EXPECT_TRUE(absl::StrContains(message, absl::StrCat("\"", text, "\"")))
+          << "missing: " << text << ", full message:\n"
+          << message;
+    }
+  }
+}
+
+TEST(StreamingFormatEquivalentTest, LexErrorOnLeft) {
+  std::ostringstream errs;
+  ExpectCompareWithErrstream(Streaming(StreamingFormatEquivalent),
+                             DiffStatus::kLeftError, "module 321foo;\n",
+                             "module foo;\n", &errs);
+  EXPECT_TRUE(absl::StrContains(errs.str(), "error from left input"))
+      << "full message:\n"
+      << errs.str();
+}
+
+TEST(StreamingFormatEquivalentTest, LexErrorOnLeftInMacroArg) {
+  std::ostringstream errs;
+  ExpectCompareWithErrstream(Streaming(StreamingFormatEquivalent),
+                             DiffStatus::kLeftError, "`FOO(321foo)\n",
+                             "`FOO(foo)\n", &errs);
+  EXPECT_TRUE(absl::StrContains(errs.str(), "error from left input"))
+      << "full message:\n"
+      << errs.str();
+}
+
+TEST(StreamingObfuscationEquivalentTest, Various) {
+  const std::vector<std::pair<const char *, const char *>> kTestCases = {
+      {"module foo;endmodule", "module bar;endmodule"},
+      {"module foo;endmodule", "module bar ;endmodule"},
+      {"module foo;endmodule", "module barr;endmodule"},
+      {"`FOO(a, b)", "`BAR(c, d)"},
+  };
+  for (const auto &test : kTestCases) {
+    ExpectCompareWithErrstream(Streaming(StreamingObfuscationEquivalent),
+                               ObfuscationEquivalent(test.first, test.second),
+                               test.first, test.second);
+  }
+}
+
 }  // namespace
 }  // namespace verilog
@@ -14,52 +14,133 @@
 
 #include "verilog/analysis/verilog_excerpt_parse.h"
 
-#include <functional>
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/strings/mem_block.h"
 #include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/container_util.h"
 #include "common/util/logging.h"
 #include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/parser/verilog_lexer.h"
 
-// TODO(hzeller): All these are constructing strings with prefix and postfix.
-// And often, these constructs are used in fallback situations in which we
-// couldn't parse something and try again in a different setting. That means
-// it generates a new string copy and forces full lexing again.
-//
-// Investigate if we can just take the original token stream and add tokens
-// in front and back (should work if these tokens don't bring the lexer into
-// a specific state)
+// TODO(hzeller): All these are constructing strings with prefix and postfix,
+// often in fallback situations in which we couldn't parse something and try
+// again in a different setting.  The prolog is lexed only once per context,
+// and AnalyzeVerilogWithMode() can reuse the tokens of the original text, but
+// the text and epilog are still lexed for each analysis.
 // https://github.com/chipsalliance/verible/issues/1519
 
 namespace verilog {
 
 using verible::container::FindOrNull;
 
+// Text that wraps around an excerpt to form a whole Verilog source.
+struct ExcerptContext {
+  absl::string_view prolog;
+  absl::string_view epilog;
+  // True if the lexer is in its initial state after the prolog, so that the
+  // excerpt lexes the same on its own as after the prolog.
+  bool excerpt_lexes_alone;
+};
+
+static constexpr ExcerptContext kPropertySpecContext{
+    "module foo;\nproperty p;\n", "\nendproperty;\nendmodule;\n", true};
+static constexpr ExcerptContext kStatementsContext{"function foo();\n",
+                                                   "\nendfunction\n", true};
+// $error in this context is an elaboration system task
+// The space before the ) is critical to accommodate escaped identifiers.
+// Without the space, lexing an escaped identifier would consume part
+// of the epilog text.
+// An expression can not start with the '*' that would join the prolog's '('.
+static constexpr ExcerptContext kExpressionContext{
+    "module foo;\nif (", " ) $error;\nendmodule\n", true};
+static constexpr ExcerptContext kModuleBodyContext{"module foo;\n",
+                                                   "\nendmodule\n", true};
+static constexpr ExcerptContext kClassBodyContext{"class foo;\n",
+                                                  "\nendclass\n", true};
+static constexpr ExcerptContext kPackageBodyContext{"package foo;\n",
+                                                    "\nendpackage\n", true};
+// The prolog/epilog strings come from verilog.lex as token enums:
+// PD_LIBRARY_SYNTAX_BEGIN and PD_LIBRARY_SYNTAX_END.
+// These are used in verilog.y to enclose the complete library_description
+// grammar rule.  The prolog switches the lexer to library map syntax.
+static constexpr ExcerptContext kLibraryMapContext{
+    "`____verible_verilog_library_begin____\n",
+    "\n`____verible_verilog_library_end____\n", false};
+
+// Returns the tokens of the prolog of "context", which are lexed only once.
+// Only valid for contexts whose excerpt lexes alone.
+static const verible::TokenSequence &PrologTokens(
+    const ExcerptContext &context) {
+  static const auto *prolog_tokens = [] {
+    auto *result =
+        new std::map<const ExcerptContext *, verible::TokenSequence>;
+    for (const ExcerptContext *each :
+         {&kPropertySpecContext, &kStatementsContext, &kExpressionContext,
+          &kModuleBodyContext, &kClassBodyContext, &kPackageBodyContext}) {
+      VerilogLexer lexer(each->prolog);
+      const absl::Status status = verible::MakeTokenSequence(
+          &lexer, each->prolog, &(*result)[each],
+          [](const verible::TokenInfo &) {});
+      CHECK(status.ok()) << "Failed to lex prolog: " << each->prolog;
+    }
+    return result;
+  }();
+  const verible::TokenSequence *tokens = FindOrNull(*prolog_tokens, &context);
+  CHECK(tokens != nullptr) << "No pre-lexed prolog for: " << context.prolog;
+  return *tokens;
+}
+
 // Function template to create any mini-parser for Verilog.
-// 'prolog' and 'epilog' are text that wrap around the 'text' argument to
+// The prolog and epilog of 'context' wrap around the 'text' argument to
 // form a whole Verilog source.
+// If not null, 'text_tokens' are the tokens lexed from 'text', which are
+// reused instead of lexing 'text' again where the context allows.
 // The returned analyzer's text structure will discard parsed information
 // about the prolog and epilog, leaving only the substructure of interest.
 static std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogConstruct(
-    absl::string_view prolog, absl::string_view text, absl::string_view epilog,
+    const ExcerptContext &context, absl::string_view text,
     absl::string_view filename,
-    const VerilogPreprocess::Config &preprocess_config) {
+    const VerilogPreprocess::Config &preprocess_config,
+    const verible::TokenSequence *text_tokens = nullptr) {
   VLOG(2) << __FUNCTION__;
+  const absl::string_view prolog = context.prolog;
+  const absl::string_view epilog = context.epilog;
   CHECK(epilog.empty() || absl::ascii_isspace(epilog[0]))
       << "epilog text must begin with a whitespace to prevent unintentional "
          "token-joining and escaped-identifier extension.";
-  const std::string analyze_text = absl::StrCat(prolog, text, epilog);
+  // Copied only once, straight into the block that the analyzer keeps.
+  std::shared_ptr<verible::MemBlock> analyze_block(
+      new verible::ChainMemBlock({prolog, text, epilog}));
+  const absl::string_view analyze_text = analyze_block->AsStringView();
   // Disable parser directive comments because a specific parser
   // is already being selected.
-  auto analyzer_ptr = std::make_unique<VerilogAnalyzer>(analyze_text, filename,
-                                                        preprocess_config);
+  auto analyzer_ptr = std::make_unique<VerilogAnalyzer>(
+      std::move(analyze_block), filename, preprocess_config);
+  if (context.excerpt_lexes_alone) {
+    if (text_tokens != nullptr) {
+      // Only the prolog and epilog need to be lexed.
+      (void)ABSL_DIE_IF_NULL(analyzer_ptr)
+          ->TokenizeWithExcerpt(prolog.length(), text, *text_tokens);
+    } else {
+      // The prolog was lexed before; only lex the text and epilog.
+      (void)ABSL_DIE_IF_NULL(analyzer_ptr)
+          ->TokenizeWithPrefix(prolog, PrologTokens(context));
+    }
+  }
 
   if (!ABSL_DIE_IF_NULL(analyzer_ptr)->Analyze().ok()) {
     VLOG(2) << __FUNCTION__ << ": Analyze() failed.  code:\n" << analyze_text;
@@ -81,82 +162,135 @@ static std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogConstruct(
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogPropertySpec(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("module foo;\nproperty p;\n", text,
-                                 "\nendproperty;\nendmodule;\n", filename,
+  return AnalyzeVerilogConstruct(kPropertySpecContext, text, filename,
                                  preprocess_config);
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogStatements(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("function foo();\n", text, "\nendfunction\n",
-                                 filename, preprocess_config);
+  return AnalyzeVerilogConstruct(kStatementsContext, text, filename,
+                                 preprocess_config);
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogExpression(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("module foo;\nif (", text,
-                                 " ) $error;\nendmodule\n", filename,
+  return AnalyzeVerilogConstruct(kExpressionContext, text, filename,
                                  preprocess_config);
-  // $error in this context is an elaboration system task
-  // The space before the ) is critical to accommodate escaped identifiers.
-  // Without the space, lexing an escaped identifier would consume part
-  // of the epilog text.
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogModuleBody(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("module foo;\n", text, "\nendmodule\n",
-                                 filename, preprocess_config);
+  return AnalyzeVerilogConstruct(kModuleBodyContext, text, filename,
+                                 preprocess_config);
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogClassBody(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("class foo;\n", text, "\nendclass\n", filename,
+  return AnalyzeVerilogConstruct(kClassBodyContext, text, filename,
                                  preprocess_config);
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogPackageBody(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  return AnalyzeVerilogConstruct("package foo;\n", text, "\nendpackage\n",
-                                 filename, preprocess_config);
+  return AnalyzeVerilogConstruct(kPackageBodyContext, text, filename,
+                                 preprocess_config);
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogLibraryMap(
     absl::string_view text, absl::string_view filename,
     const VerilogPreprocess::Config &preprocess_config) {
-  // The prolog/epilog strings come from verilog.lex as token enums:
-  // PD_LIBRARY_SYNTAX_BEGIN and PD_LIBRARY_SYNTAX_END.
-  // These are used in verilog.y to enclose the complete library_description
-  // grammar rule.
-  return AnalyzeVerilogConstruct(
-      "`____verible_verilog_library_begin____\n", text,
-      "\n`____verible_verilog_library_end____\n", filename, preprocess_config);
+  return AnalyzeVerilogConstruct(kLibraryMapContext, text, filename,
+                                 preprocess_config);
+}
+
+// Returns the context of parsing "mode", or nullptr if the mode is unknown.
+static const ExcerptContext *FindModeContext(absl::string_view mode) {
+  static const auto *context_map =
+      new std::map<absl::string_view, const ExcerptContext *>{
+          {"parse-as-statements", &kStatementsContext},
+          {"parse-as-expression", &kExpressionContext},
+          {"parse-as-module-body", &kModuleBodyContext},
+          {"parse-as-class-body", &kClassBodyContext},
+          {"parse-as-package-body", &kPackageBodyContext},
+          {"parse-as-property-spec", &kPropertySpecContext},
+          {"parse-as-library-map", &kLibraryMapContext},
+      };
+  const auto *context = FindOrNull(*context_map, mode);
+  return context ? *context : nullptr;
 }
 
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogWithMode(
+    absl::string_view text, absl::string_view filename, absl::string_view mode,
+    const VerilogPreprocess::Config &preprocess_config,
+    const verible::TokenSequence *text_tokens) {
+  const ExcerptContext *context = FindModeContext(mode);
+  if (!context) return nullptr;
+  return AnalyzeVerilogConstruct(*context, text, filename, preprocess_config,
+                                 text_tokens);
+}
+
+std::unique_ptr<VerilogAnalyzer> ExcerptParser::Analyze(
     absl::string_view text, absl::string_view filename, absl::string_view mode,
     const VerilogPreprocess::Config &preprocess_config) {
-  static const auto *func_map =
-      new std::map<absl::string_view,
-                   std::function<std::unique_ptr<VerilogAnalyzer>(
-                       absl::string_view, absl::string_view,
-                       const VerilogPreprocess::Config &)>>{
-          {"parse-as-statements", &AnalyzeVerilogStatements},
-          {"parse-as-expression", &AnalyzeVerilogExpression},
-          {"parse-as-module-body", &AnalyzeVerilogModuleBody},
-          {"parse-as-class-body", &AnalyzeVerilogClassBody},
-          {"parse-as-package-body", &AnalyzeVerilogPackageBody},
-          {"parse-as-property-spec", &AnalyzeVerilogPropertySpec},
-          {"parse-as-library-map", &AnalyzeVerilogLibraryMap},
-      };
-  const auto *func_ptr = FindOrNull(*func_map, mode);
-  if (!func_ptr) return nullptr;
-  return (*func_ptr)(text, filename, preprocess_config);
+  const ExcerptContext *context = FindModeContext(mode);
+  if (!context) return nullptr;
+  const std::string key =
+      absl::StrCat(mode, "\n", preprocess_config.filter_branches, "\n", text);
+  std::string serialized;
+  {
+    const std::lock_guard<std::mutex> l(mutex_);
+    if (const auto found = analyses_.find(key); found != analyses_.end()) {
+      serialized = found->second;
+    }
+  }
+  if (!serialized.empty()) {
+    auto restored = VerilogAnalyzer::RestoreAnalysis(
+        std::make_shared<verible::StringMemBlock>(text), filename,
+        serialized);
+    if (restored.ok()) {
+      const std::lock_guard<std::mutex> l(mutex_);
+      ++stats_.hits;
+      return *std::move(restored);
+    }
+  }
+
+  auto analyzer =
+      AnalyzeVerilogConstruct(*context, text, filename, preprocess_config);
+  const absl::StatusOr<std::string> result = analyzer->SerializeAnalysis();
+  const std::lock_guard<std::mutex> l(mutex_);
+  ++stats_.misses;
+  if (result.ok()) {
+    const size_t size = key.length() + result->length();
+    if (kept_bytes_ + size > max_bytes_) {
+      analyses_.clear();
+      kept_bytes_ = 0;
+    }
+    if (size <= max_bytes_ && analyses_.emplace(key, *result).second) {
+      kept_bytes_ += size;
+    }
+  }
+  return analyzer;
+}
+
+ExcerptParser::Stats ExcerptParser::GetStats() const {
+  const std::lock_guard<std::mutex> l(mutex_);
+  return stats_;
+}
+
+void ExcerptParser::Clear() {
+  const std::lock_guard<std::mutex> l(mutex_);
+  analyses_.clear();
+  kept_bytes_ = 0;
+}
+
+ExcerptParser &SharedExcerptParser() {
+  static auto *parser = new ExcerptParser();
+  return *parser;
 }
 
 }  // namespace verilog
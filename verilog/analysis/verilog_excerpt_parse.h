@@ -20,9 +20,16 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_EXCERPT_PARSE_H_
 #define VERIBLE_VERILOG_ANALYSIS_VERILOG_EXCERPT_PARSE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include "absl/strings/string_view.h"
+#include "common/text/token_stream_view.h"
 #include "verilog/analysis/verilog_analyzer.h"
 #include "verilog/preprocessor/verilog_preprocess.h"
 
@@ -72,9 +79,60 @@ std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogLibraryMap(
     const VerilogPreprocess::Config &preprocess_config);
 
 // Analyzes text in the selected parsing `mode`.
+// If not null, "text_tokens" are the tokens lexed from "text", which are
+// reused instead of lexing "text" again where the mode allows.
 std::unique_ptr<VerilogAnalyzer> AnalyzeVerilogWithMode(
     absl::string_view text, absl::string_view filename, absl::string_view mode,
-    const VerilogPreprocess::Config &preprocess_config);
+    const VerilogPreprocess::Config &preprocess_config,
+    const verible::TokenSequence *text_tokens = nullptr);
+
+// Analyzes excerpts like AnalyzeVerilogWithMode(), for callers that analyze
+// many small excerpts, often the same ones again, like macro call arguments.
+// Successful analyses are kept, keyed by mode, branch filtering and text, and
+// analyzing the same excerpt again restores the kept result (see
+// VerilogAnalyzer::RestoreAnalysis()) instead of lexing and parsing it.
+// When the kept results would exceed "max_bytes", all of them are dropped.
+// Failed analyses, and those with included files or expanded macros, are not
+// kept.  Safe to use from multiple threads.
+class ExcerptParser {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 16 << 20;
+
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+  };
+
+  explicit ExcerptParser(size_t max_bytes = kDefaultMaxBytes)
+      : max_bytes_(max_bytes) {}
+
+  ExcerptParser(const ExcerptParser &) = delete;
+  ExcerptParser &operator=(const ExcerptParser &) = delete;
+
+  // Returns the analysis of "text" in parsing "mode", or nullptr if the mode
+  // is unknown.
+  std::unique_ptr<VerilogAnalyzer> Analyze(
+      absl::string_view text, absl::string_view filename,
+      absl::string_view mode,
+      const VerilogPreprocess::Config &preprocess_config);
+
+  Stats GetStats() const;
+
+  // Drops all kept analyses.
+  void Clear();
+
+ private:
+  const size_t max_bytes_;
+
+  mutable std::mutex mutex_;
+  // Serialized analyses, by key.  Guarded by mutex_.
+  std::map<std::string, std::string, std::less<>> analyses_;
+  size_t kept_bytes_ = 0;  // Guarded by mutex_.
+  Stats stats_;            // Guarded by mutex_.
+};
+
+// Returns the process-wide ExcerptParser.
+ExcerptParser &SharedExcerptParser();
 
 }  // namespace verilog
 
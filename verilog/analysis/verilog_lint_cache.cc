@@ -0,0 +1,442 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/verilog_lint_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/text/token_info.h"
+#include "common/util/file_util.h"
+#include "common/util/logging.h"
+#include "common/util/range.h"
+#include "common/util/sha256.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+
+namespace verilog {
+
+namespace fs = std::filesystem;
+
+using verible::AutoFix;
+using verible::LintRuleStatus;
+using verible::LintViolation;
+using verible::ReplacementEdit;
+using verible::TokenInfo;
+
+// Part of the cache key.  Increment whenever the format of entries changes.
+static constexpr absl::string_view kLintCacheVersion = "1";
+
+static constexpr absl::string_view kEntrySuffix = ".vlc";
+
+// Entries: magic, length of the linted text (8 bytes), checksum of the
+// payload (8 bytes), followed by the payload from SerializeLintFileResult().
+static constexpr absl::string_view kEntryMagic = "VLC1";
+static constexpr size_t kEntryHeaderSize = 4 + 8 + 8;
+
+// Cache entries are checked for accidental corruption, so a simple
+// checksum is sufficient (FNV-1a).
+static uint64_t Checksum(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static void AppendUint64(uint64_t value, std::string *out) {
+  for (int i = 0; i < 8; ++i) out->push_back((value >> (8 * i)) & 0xff);
+}
+
+static void AppendString(absl::string_view value, std::string *out) {
+  AppendUint64(value.length(), out);
+  out->append(value.begin(), value.end());
+}
+
+// Appends the position of "text" in "contents", or clears "*fits" if it is
+// not in there (e.g. from a macro expansion).
+static void AppendRange(absl::string_view text, absl::string_view contents,
+                        std::string *out, bool *fits) {
+  if (!verible::IsSubRange(text, contents)) *fits = false;
+  AppendUint64(*fits ? text.begin() - contents.begin() : 0, out);
+  AppendUint64(text.length(), out);
+}
+
+static void AppendToken(const TokenInfo &token, absl::string_view contents,
+                        std::string *out, bool *fits) {
+  AppendUint64(static_cast<uint32_t>(token.token_enum()), out);
+  AppendRange(token.text(), contents, out, fits);
+}
+
+namespace {
+// Reads back what the Append*() functions wrote. Any read past the end of
+// the data, or of a range outside of the contents, fails all further reads.
+class PayloadReader {
+ public:
+  PayloadReader(absl::string_view data, absl::string_view contents)
+      : data_(data), contents_(contents) {}
+
+  bool ok() const { return ok_; }
+  bool AtEnd() const { return data_.empty(); }
+
+  uint64_t ReadUint64() {
+    if (data_.length() < 8) {
+      ok_ = false;
+      data_ = {};
+    }
+    if (!ok_) return 0;
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value |= static_cast<uint64_t>(static_cast<uint8_t>(data_[i]))
+               << (8 * i);
+    }
+    data_.remove_prefix(8);
+    return value;
+  }
+
+  // Reads a count of items, each of which takes at least "min_item_size"
+  // bytes, so that corrupt counts fail early.
+  uint64_t ReadCount(size_t min_item_size) {
+    const uint64_t count = ReadUint64();
+    if (count > data_.length() / min_item_size) ok_ = false;
+    return ok_ ? count : 0;
+  }
+
+  std::string ReadString() {
+    const uint64_t length = ReadCount(1);
+    if (!ok_) return "";
+    std::string value(data_.substr(0, length));
+    data_.remove_prefix(length);
+    return value;
+  }
+
+  absl::string_view ReadRange() {
+    const uint64_t offset = ReadUint64();
+    const uint64_t length = ReadUint64();
+    if (offset > contents_.length() || length > contents_.length() - offset) {
+      ok_ = false;
+    }
+    return ok_ ? contents_.substr(offset, length) : absl::string_view();
+  }
+
+  TokenInfo ReadToken() {
+    const int token_enum = static_cast<int32_t>(ReadUint64());
+    return TokenInfo(token_enum, ReadRange());
+  }
+
+ private:
+  absl::string_view data_;
+  const absl::string_view contents_;
+  bool ok_ = true;
+};
+}  // namespace
+
+absl::StatusOr<std::string> SerializeLintFileResult(
+    const LintFileResult &result, absl::string_view contents) {
+  std::string out;
+  bool fits = true;
+  out.push_back(result.syntax_errors ? 1 : 0);
+  AppendUint64(result.syntax_error_messages.size(), &out);
+  for (const std::string &message : result.syntax_error_messages) {
+    AppendString(message, &out);
+  }
+  AppendUint64(result.statuses.size(), &out);
+  for (const LintRuleStatus &status : result.statuses) {
+    AppendString(status.lint_rule_name, &out);
+    AppendString(status.url, &out);
+    AppendUint64(status.violations.size(), &out);
+    for (const LintViolation &violation : status.violations) {
+      AppendToken(violation.token, contents, &out, &fits);
+      AppendString(violation.reason, &out);
+      AppendUint64(violation.autofixes.size(), &out);
+      for (const AutoFix &autofix : violation.autofixes) {
+        AppendString(autofix.Description(), &out);
+        AppendUint64(autofix.Edits().size(), &out);
+        for (const ReplacementEdit &edit : autofix.Edits()) {
+          AppendRange(edit.fragment, contents, &out, &fits);
+          AppendString(edit.replacement, &out);
+        }
+      }
+      AppendUint64(violation.related_tokens.size(), &out);
+      for (const TokenInfo &token : violation.related_tokens) {
+        AppendToken(token, contents, &out, &fits);
+      }
+    }
+  }
+  if (!fits) {
+    return absl::FailedPreconditionError(
+        "Violations outside of the linted contents.");
+  }
+  return out;
+}
+
+bool RestoreLintFileResult(absl::string_view payload,
+                           absl::string_view contents, LintFileResult *result) {
+  *result = LintFileResult();
+  if (payload.empty()) return false;
+  result->syntax_errors = payload[0] != 0;
+  PayloadReader reader(payload.substr(1), contents);
+  for (uint64_t n = reader.ReadCount(8); n > 0; --n) {
+    result->syntax_error_messages.push_back(reader.ReadString());
+  }
+  for (uint64_t n = reader.ReadCount(24); n > 0; --n) {
+    result->rule_names.push_back(reader.ReadString());
+    LintRuleStatus status;
+    status.lint_rule_name = result->rule_names.back();
+    status.url = reader.ReadString();
+    for (uint64_t v = reader.ReadCount(48); v > 0; --v) {
+      const TokenInfo token = reader.ReadToken();
+      const std::string reason = reader.ReadString();
+      std::vector<AutoFix> autofixes;
+      for (uint64_t a = reader.ReadCount(16); a > 0; --a) {
+        const std::string description = reader.ReadString();
+        std::set<ReplacementEdit> edits;
+        for (uint64_t e = reader.ReadCount(24); e > 0; --e) {
+          const absl::string_view fragment = reader.ReadRange();
+          edits.emplace(fragment, reader.ReadString());
+        }
+        autofixes.emplace_back(description,
+                               std::initializer_list<ReplacementEdit>{});
+        autofixes.back().AddEdits(edits);
+      }
+      std::vector<TokenInfo> related_tokens;
+      for (uint64_t r = reader.ReadCount(24); r > 0; --r) {
+        related_tokens.push_back(reader.ReadToken());
+      }
+      status.violations.insert(
+          LintViolation(token, reason, autofixes, related_tokens));
+    }
+    result->statuses.push_back(std::move(status));
+  }
+  if (!reader.ok() || !reader.AtEnd()) {
+    *result = LintFileResult();
+    return false;
+  }
+  return true;
+}
+
+// Returns the payload of "entry", or an error if it is not plausibly the
+// entry of a text of "content_length" bytes.
+static absl::StatusOr<absl::string_view> EntryPayload(absl::string_view entry,
+                                                      size_t content_length) {
+  if (entry.length() < kEntryHeaderSize || entry.substr(0, 4) != kEntryMagic) {
+    return absl::DataLossError("Not a lint cache entry.");
+  }
+  PayloadReader header(entry.substr(4, 16), {});
+  if (header.ReadUint64() != content_length) {
+    return absl::DataLossError("Cached content length differs.");
+  }
+  const absl::string_view payload = entry.substr(kEntryHeaderSize);
+  if (header.ReadUint64() != Checksum(payload)) {
+    return absl::DataLossError("Checksum mismatch.");
+  }
+  return payload;
+}
+
+VerilogLintCache::VerilogLintCache(absl::string_view directory,
+                                   int64_t max_bytes,
+                                   absl::string_view tool_version)
+    : directory_(directory),
+      max_bytes_(max_bytes),
+      tool_version_(tool_version) {
+  if (absl::Status status = verible::file::CreateDir(directory_);
+      !status.ok()) {
+    LOG(WARNING) << "Can't create lint cache directory " << directory_ << ": "
+                 << status.message();
+  }
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator(directory_, error)) {
+    if (entry.path().extension().string() == kEntrySuffix) {
+      total_bytes_ += entry.file_size(error);
+    }
+  }
+}
+
+std::string VerilogLintCache::Key(absl::string_view filename,
+                                  absl::string_view contents,
+                                  const LinterConfiguration &config,
+                                  absl::string_view options) const {
+  verible::Sha256Context hash;
+  // Each part is prefixed with its length, to keep them apart.
+  const auto add = [&hash](absl::string_view part) {
+    hash.AddInput(absl::StrCat(part.length(), ":"));
+    hash.AddInput(part);
+  };
+  add(kLintCacheVersion);
+  add(tool_version_);
+  add(filename);
+  add(options);
+  RuleBundle rules;
+  config.GetRuleBundle(&rules);
+  add(rules.UnparseConfiguration('\n', false));
+  for (const absl::string_view waiver_file :
+       absl::StrSplit(config.external_waivers, ',', absl::SkipEmpty())) {
+    add(waiver_file);
+    const auto waivers = verible::file::GetContentAsString(waiver_file);
+    add(waivers.ok() ? *waivers : "");
+  }
+  add(contents);
+  std::string key;
+  for (const uint8_t byte : hash.BuildAndReset()) {
+    absl::StrAppend(&key, absl::Hex(byte, absl::kZeroPad2));
+  }
+  return key;
+}
+
+std::string VerilogLintCache::EntryPath(absl::string_view key) const {
+  return verible::file::JoinPath(directory_, absl::StrCat(key, kEntrySuffix));
+}
+
+bool VerilogLintCache::Lookup(absl::string_view key, absl::string_view contents,
+                              LintFileResult *result) {
+  const std::string path = EntryPath(key);
+  std::error_code error;
+  if (!fs::exists(path, error)) {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.misses;
+    return false;
+  }
+
+  absl::Status status = absl::OkStatus();
+  auto entry = verible::file::GetContentAsString(path);
+  if (entry.ok()) {
+    const auto payload = EntryPayload(*entry, contents.length());
+    if (!payload.ok()) {
+      status = payload.status();
+    } else if (!RestoreLintFileResult(*payload, contents, result)) {
+      status = absl::DataLossError("Malformed entry.");
+    }
+  } else {
+    status = entry.status();
+  }
+
+  if (!status.ok()) {
+    LOG(WARNING) << "Removing unusable lint cache entry " << path << ": "
+                 << status.message();
+    const int64_t size = fs::file_size(path, error);
+    const bool removed = fs::remove(path, error);
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.corrupt_entries;
+    ++stats_.misses;
+    if (removed && size > 0) total_bytes_ -= size;
+    return false;
+  }
+
+  // Mark as recently used for eviction.
+  fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+  std::lock_guard<std::mutex> l(mutex_);
+  ++stats_.hits;
+  return true;
+}
+
+void VerilogLintCache::Store(absl::string_view key, absl::string_view contents,
+                             const LintFileResult &result) {
+  const absl::StatusOr<std::string> payload =
+      SerializeLintFileResult(result, contents);
+  if (!payload.ok()) {
+    VLOG(1) << "Not caching lint result: " << payload.status().message();
+    return;
+  }
+  std::string entry;
+  entry.reserve(kEntryHeaderSize + payload->length());
+  entry.append(kEntryMagic.begin(), kEntryMagic.end());
+  AppendUint64(contents.length(), &entry);
+  AppendUint64(Checksum(*payload), &entry);
+  entry.append(*payload);
+
+  // Other processes might read the entry at the same time.
+  const std::string path = EntryPath(key);
+  const std::string temp_path =
+      absl::StrCat(path, ".", std::random_device()(), ".tmp");
+  std::error_code error;
+  if (absl::Status status = verible::file::SetContents(temp_path, entry);
+      !status.ok()) {
+    LOG(WARNING) << "Can't write lint cache entry: " << status.message();
+    return;
+  }
+  fs::rename(temp_path, path, error);
+  if (error) {
+    LOG(WARNING) << "Can't write lint cache entry " << path << ": "
+                 << error.message();
+    fs::remove(temp_path, error);
+    return;
+  }
+
+  bool evict;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.stores;
+    total_bytes_ += entry.length();
+    evict = total_bytes_ > max_bytes_;
+  }
+  // Make some room, so that not every following store needs to evict.
+  if (evict) Evict(max_bytes_ - max_bytes_ / 10);
+}
+
+void VerilogLintCache::Evict(int64_t target_bytes) {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type last_use;
+    int64_t size;
+  };
+  std::vector<Entry> entries;
+  int64_t total_bytes = 0;
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator(directory_, error)) {
+    if (entry.path().extension().string() != kEntrySuffix) continue;
+    const int64_t size = entry.file_size(error);
+    if (error) continue;
+    entries.push_back({entry.path(), entry.last_write_time(error), size});
+    total_bytes += size;
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) {
+              return a.last_use < b.last_use;
+            });
+  int64_t evictions = 0;
+  for (const Entry &entry : entries) {
+    if (total_bytes <= target_bytes) break;
+    if (fs::remove(entry.path, error)) {
+      total_bytes -= entry.size;
+      ++evictions;
+    }
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  stats_.evictions += evictions;
+  total_bytes_ = total_bytes;  // Also accounts for other processes.
+}
+
+VerilogLintCache::Stats VerilogLintCache::GetStats() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return stats_;
+}
+
+}  // namespace verilog
@@ -0,0 +1,128 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_CACHE_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+
+namespace verilog {
+
+// The outcome of linting one file, as reported by LintOneFile().
+struct LintFileResult {
+  // True if lexing or parsing failed.
+  bool syntax_errors = false;
+
+  // Messages about the syntax errors, if these were checked.
+  std::vector<std::string> syntax_error_messages;
+
+  // Statuses of all rules, with any waived violations removed.
+  std::vector<verible::LintRuleStatus> statuses;
+
+  // Storage of the lint_rule_name's of restored statuses.
+  std::deque<std::string> rule_names;
+};
+
+// VerilogLintCache keeps the lint results of files in a directory, so that
+// later tool invocations can report them for unchanged files without lexing,
+// parsing or linting them again.
+//
+// Entries are keyed by a hash of the file name and contents, the effective
+// lint configuration (including the contents of the external waiver files),
+// the options affecting the report, and the tool version. Violations are
+// stored by their offsets into the file contents, and restored pointing into
+// the same contents when looked up.
+//
+// Like VerilogParseCache, entries carry a checksum and are validated when
+// loaded, the least recently used ones are evicted beyond a size limit, and
+// the cache can be used from multiple threads and processes.
+class VerilogLintCache {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t stores = 0;
+    int64_t evictions = 0;
+    int64_t corrupt_entries = 0;
+  };
+
+  // Keeps cache entries in "directory", which is created if needed, and
+  // keeps their total size at about "max_bytes". Results of a different
+  // "tool_version" are never reused.
+  VerilogLintCache(absl::string_view directory, int64_t max_bytes,
+                   absl::string_view tool_version);
+
+  VerilogLintCache(const VerilogLintCache &) = delete;
+  VerilogLintCache &operator=(const VerilogLintCache &) = delete;
+
+  // Returns the key of the result of linting "contents" of "filename" with
+  // "config", where "options" describes everything else that the report
+  // depends on.
+  std::string Key(absl::string_view filename, absl::string_view contents,
+                  const LinterConfiguration &config,
+                  absl::string_view options) const;
+
+  // Restores the result stored for "key" into "result" and returns true, or
+  // returns false if there is none. The violations in "result" point into
+  // "contents", which must outlive them.
+  bool Lookup(absl::string_view key, absl::string_view contents,
+              LintFileResult *result);
+
+  // Stores "result" for "key", if all of its violations point into
+  // "contents".
+  void Store(absl::string_view key, absl::string_view contents,
+             const LintFileResult &result);
+
+  Stats GetStats() const;
+
+ private:
+  std::string EntryPath(absl::string_view key) const;
+
+  // Removes the least recently used entries until their total size is
+  // at most "target_bytes".
+  void Evict(int64_t target_bytes);
+
+  const std::string directory_;
+  const int64_t max_bytes_;
+  const std::string tool_version_;
+
+  mutable std::mutex mutex_;
+  Stats stats_;              // guarded by mutex_
+  int64_t total_bytes_ = 0;  // guarded by mutex_
+};
+
+// Serializes "result", or returns an error if not all of its violations
+// point into "contents".
+absl::StatusOr<std::string> SerializeLintFileResult(
+    const LintFileResult &result, absl::string_view contents);
+
+// Restores a result from SerializeLintFileResult() into "result", with the
+// violations pointing into "contents". Returns false if "payload" is
+// malformed or doesn't fit "contents".
+bool RestoreLintFileResult(absl::string_view payload,
+                           absl::string_view contents, LintFileResult *result);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_CACHE_H_
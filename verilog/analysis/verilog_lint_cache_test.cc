@@ -0,0 +1,231 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/analysis/verilog_lint_cache.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/text/token_info.h"
+#include "common/util/file_util.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+
+namespace verilog {
+namespace {
+
+namespace fs = std::filesystem;
+
+using verible::AutoFix;
+using verible::LintRuleStatus;
+using verible::LintViolation;
+using verible::TokenInfo;
+using verible::file::JoinPath;
+using verible::file::testing::RandomFileBasename;
+
+constexpr absl::string_view kContents = "module m;\twire w ;\nendmodule\n";
+
+// Returns a result with two rules' violations in kContents.
+LintFileResult MakeResult() {
+  LintFileResult result;
+  result.syntax_errors = true;
+  result.syntax_error_messages = {"file.sv:1:1: syntax error"};
+  const TokenInfo tab(1, kContents.substr(9, 1));
+  const TokenInfo space(2, kContents.substr(16, 1));
+  const TokenInfo wire(3, kContents.substr(10, 4));
+  result.statuses.push_back(LintRuleStatus(
+      {LintViolation(tab, "Use spaces, not tabs.")}, "no-tabs", "url1"));
+  result.statuses.push_back(LintRuleStatus(
+      {LintViolation(space, "Remove space.",
+                     {AutoFix("Remove it", {space, ""}),
+                      AutoFix("Replace it", {{space, "_"}, {tab, " "}})},
+                     {wire})},
+      "some-rule", ""));
+  result.statuses.push_back(LintRuleStatus({}, "clean-rule", "url3"));
+  return result;
+}
+
+void ExpectEqualResults(const LintFileResult &a, const LintFileResult &b) {
+  EXPECT_EQ(a.syntax_errors, b.syntax_errors);
+  EXPECT_EQ(a.syntax_error_messages, b.syntax_error_messages);
+  ASSERT_EQ(a.statuses.size(), b.statuses.size());
+  for (size_t i = 0; i < a.statuses.size(); ++i) {
+    const LintRuleStatus &sa = a.statuses[i];
+    const LintRuleStatus &sb = b.statuses[i];
+    EXPECT_EQ(sa.lint_rule_name, sb.lint_rule_name);
+    EXPECT_EQ(sa.url, sb.url);
+    ASSERT_EQ(sa.violations.size(), sb.violations.size());
+    auto vb = sb.violations.begin();
+    for (const LintViolation &va : sa.violations) {
+      EXPECT_TRUE(va.token == vb->token);
+      // Same position in the contents, not just the same text.
+      EXPECT_EQ(va.token.text().data(), vb->token.text().data());
+      EXPECT_EQ(va.reason, vb->reason);
+      ASSERT_EQ(va.autofixes.size(), vb->autofixes.size());
+      for (size_t f = 0; f < va.autofixes.size(); ++f) {
+        EXPECT_EQ(va.autofixes[f].Description(),
+                  vb->autofixes[f].Description());
+        EXPECT_EQ(va.autofixes[f].Apply(kContents),
+                  vb->autofixes[f].Apply(kContents));
+      }
+      ASSERT_EQ(va.related_tokens.size(), vb->related_tokens.size());
+      for (size_t t = 0; t < va.related_tokens.size(); ++t) {
+        EXPECT_TRUE(va.related_tokens[t] == vb->related_tokens[t]);
+      }
+      ++vb;
+    }
+  }
+}
+
+TEST(LintFileResultTest, SerializeAndRestore) {
+  const LintFileResult result = MakeResult();
+  const auto payload = SerializeLintFileResult(result, kContents);
+  ASSERT_TRUE(payload.ok()) << payload.status();
+  LintFileResult restored;
+  ASSERT_TRUE(RestoreLintFileResult(*payload, kContents, &restored));
+  ExpectEqualResults(result, restored);
+}
+
+TEST(LintFileResultTest, SerializeRejectsViolationsOutsideOfContents) {
+  static constexpr absl::string_view kExpanded = "expanded";
+  LintFileResult result;
+  result.statuses.push_back(
+      LintRuleStatus({LintViolation(TokenInfo(1, kExpanded), "Bad.")},
+                     "some-rule", ""));
+  EXPECT_FALSE(SerializeLintFileResult(result, kContents).ok());
+}
+
+TEST(LintFileResultTest, RestoreRejectsMalformedPayloads) {
+  const std::string payload = *SerializeLintFileResult(MakeResult(), kContents);
+  LintFileResult restored;
+  EXPECT_FALSE(RestoreLintFileResult("", kContents, &restored));
+  // Truncated.
+  for (size_t length = 1; length < payload.length(); length += 7) {
+    EXPECT_FALSE(RestoreLintFileResult(payload.substr(0, length), kContents,
+                                       &restored))
+        << length;
+  }
+  // Trailing garbage.
+  EXPECT_FALSE(RestoreLintFileResult(payload + "x", kContents, &restored));
+  // Violations outside of the contents.
+  EXPECT_FALSE(
+      RestoreLintFileResult(payload, kContents.substr(0, 12), &restored));
+  EXPECT_TRUE(restored.statuses.empty());
+}
+
+class VerilogLintCacheTest : public testing::Test {
+ protected:
+  VerilogLintCacheTest()
+      : directory_(JoinPath(::testing::TempDir(),
+                            RandomFileBasename("lint-cache"))) {}
+
+  ~VerilogLintCacheTest() override { fs::remove_all(directory_); }
+
+  const std::string directory_;
+};
+
+TEST_F(VerilogLintCacheTest, StoreAndLookup) {
+  VerilogLintCache cache(directory_, 1 << 20, "v1");
+  LinterConfiguration config;
+  const std::string key = cache.Key("file.sv", kContents, config, "");
+
+  LintFileResult result;
+  EXPECT_FALSE(cache.Lookup(key, kContents, &result));
+  cache.Store(key, kContents, MakeResult());
+  ASSERT_TRUE(cache.Lookup(key, kContents, &result));
+  ExpectEqualResults(MakeResult(), result);
+
+  // A later process finds the entry as well.
+  VerilogLintCache later_cache(directory_, 1 << 20, "v1");
+  ASSERT_TRUE(later_cache.Lookup(key, kContents, &result));
+  ExpectEqualResults(MakeResult(), result);
+
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.stores, 1);
+}
+
+TEST_F(VerilogLintCacheTest, KeyDependsOnAllInputs) {
+  const VerilogLintCache cache(directory_, 1 << 20, "v1");
+  const VerilogLintCache other_version(directory_, 1 << 20, "v2");
+  LinterConfiguration config;
+  LinterConfiguration other_config;
+  other_config.TurnOn("no-tabs");
+
+  const std::string key = cache.Key("file.sv", kContents, config, "");
+  EXPECT_EQ(key, cache.Key("file.sv", kContents, config, ""));
+  const std::set<std::string> keys = {
+      key,
+      cache.Key("other.sv", kContents, config, ""),
+      cache.Key("file.sv", "module m; endmodule\n", config, ""),
+      cache.Key("file.sv", kContents, other_config, ""),
+      cache.Key("file.sv", kContents, config, "check_syntax=0"),
+      other_version.Key("file.sv", kContents, config, ""),
+  };
+  EXPECT_EQ(keys.size(), 6);
+}
+
+TEST_F(VerilogLintCacheTest, KeyDependsOnWaiverContents) {
+  const VerilogLintCache cache(directory_, 1 << 20, "v1");
+  const std::string waiver_file =
+      JoinPath(directory_, "waivers.vbl");
+  LinterConfiguration config;
+  config.external_waivers = waiver_file;
+
+  ASSERT_TRUE(verible::file::SetContents(waiver_file, "waive a").ok());
+  const std::string key = cache.Key("file.sv", kContents, config, "");
+  ASSERT_TRUE(verible::file::SetContents(waiver_file, "waive b").ok());
+  EXPECT_NE(key, cache.Key("file.sv", kContents, config, ""));
+}
+
+TEST_F(VerilogLintCacheTest, CorruptEntriesAreRemoved) {
+  VerilogLintCache cache(directory_, 1 << 20, "v1");
+  const std::string key = cache.Key("file.sv", kContents, {}, "");
+  cache.Store(key, kContents, MakeResult());
+
+  const std::string path =
+      JoinPath(directory_, absl::StrCat(key, ".vlc"));
+  auto entry = verible::file::GetContentAsString(path);
+  ASSERT_TRUE(entry.ok());
+  (*entry)[entry->length() - 1] ^= 1;
+  ASSERT_TRUE(verible::file::SetContents(path, *entry).ok());
+
+  LintFileResult result;
+  EXPECT_FALSE(cache.Lookup(key, kContents, &result));
+  EXPECT_EQ(cache.GetStats().corrupt_entries, 1);
+  EXPECT_FALSE(fs::exists(path));
+}
+
+TEST_F(VerilogLintCacheTest, EvictsLeastRecentlyUsed) {
+  // Each entry is larger than the limit, so that every store evicts.
+  VerilogLintCache cache(directory_, 1, "v1");
+  const std::string first = cache.Key("first.sv", kContents, {}, "");
+  const std::string second = cache.Key("second.sv", kContents, {}, "");
+  cache.Store(first, kContents, MakeResult());
+  cache.Store(second, kContents, MakeResult());
+  LintFileResult result;
+  EXPECT_FALSE(cache.Lookup(first, kContents, &result));
+  EXPECT_GE(cache.GetStats().evictions, 1);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,296 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_lint_shard.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/strings/line_column_map.h"
+#include "verilog/analysis/verilog_lint_cache.h"
+
+namespace verilog {
+
+using verible::LintRuleStatus;
+using verible::LintViolationWithStatus;
+
+std::vector<int> AssignLintShards(const std::vector<absl::string_view> &names,
+                                  const std::vector<int64_t> &sizes,
+                                  int shard_count) {
+  std::vector<size_t> order(names.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (sizes[a] != sizes[b]) return sizes[a] > sizes[b];
+    return names[a] < names[b];
+  });
+  std::vector<int> shards(names.size(), 0);
+  std::vector<int64_t> shard_sizes(std::max(shard_count, 1), 0);
+  for (const size_t file : order) {
+    const auto smallest =
+        std::min_element(shard_sizes.begin(), shard_sizes.end());
+    shards[file] = smallest - shard_sizes.begin();
+    // Count empty files too, so that they are spread as well.
+    *smallest += std::max<int64_t>(sizes[file], 1);
+  }
+  return shards;
+}
+
+// Files: magic, format version (8 bytes), checksum of the rest (8 bytes),
+// followed by the header fields and entries.
+static constexpr absl::string_view kShardMagic = "VLSH";
+static constexpr size_t kShardHeaderSize = 4 + 8 + 8;
+
+// Shard files are checked for accidental corruption, so a simple checksum
+// is sufficient (FNV-1a).
+static uint64_t Checksum(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static void AppendUint64(uint64_t value, std::string *out) {
+  for (int i = 0; i < 8; ++i) out->push_back((value >> (8 * i)) & 0xff);
+}
+
+static void AppendString(absl::string_view value, std::string *out) {
+  AppendUint64(value.length(), out);
+  out->append(value.begin(), value.end());
+}
+
+namespace {
+// Reads back what the Append*() functions wrote. Any read past the end of
+// the data fails all further reads.
+class ShardReader {
+ public:
+  explicit ShardReader(absl::string_view data) : data_(data) {}
+
+  bool ok() const { return ok_; }
+  bool AtEnd() const { return data_.empty(); }
+
+  uint64_t ReadUint64() {
+    if (data_.length() < 8) {
+      ok_ = false;
+      data_ = {};
+    }
+    if (!ok_) return 0;
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value |= static_cast<uint64_t>(static_cast<uint8_t>(data_[i]))
+               << (8 * i);
+    }
+    data_.remove_prefix(8);
+    return value;
+  }
+
+  // Reads a count of items, each of which takes at least "min_item_size"
+  // bytes, so that corrupt counts fail early.
+  uint64_t ReadCount(size_t min_item_size) {
+    const uint64_t count = ReadUint64();
+    if (count > data_.length() / min_item_size) ok_ = false;
+    return ok_ ? count : 0;
+  }
+
+  std::string ReadString() {
+    const uint64_t length = ReadCount(1);
+    if (!ok_) return "";
+    std::string value(data_.substr(0, length));
+    data_.remove_prefix(length);
+    return value;
+  }
+
+ private:
+  absl::string_view data_;
+  bool ok_ = true;
+};
+}  // namespace
+
+std::string SerializeLintShard(const LintShard &shard) {
+  std::string body;
+  AppendUint64(shard.shard_index, &body);
+  AppendUint64(shard.shard_count, &body);
+  AppendUint64(shard.file_count, &body);
+  AppendString(shard.tool_version, &body);
+  AppendUint64(shard.entries.size(), &body);
+  for (const LintShardEntry &entry : shard.entries) {
+    AppendUint64(entry.index, &body);
+    AppendString(entry.filename, &body);
+    AppendUint64(static_cast<uint32_t>(entry.exit_status), &body);
+    AppendString(entry.output, &body);
+    AppendString(entry.errors, &body);
+    AppendString(entry.text, &body);
+    AppendString(entry.statuses, &body);
+  }
+
+  std::string out;
+  out.reserve(kShardHeaderSize + body.length());
+  out.append(kShardMagic.begin(), kShardMagic.end());
+  AppendUint64(kLintShardFormatVersion, &out);
+  AppendUint64(Checksum(body), &out);
+  out.append(body);
+  return out;
+}
+
+absl::StatusOr<LintShard> ParseLintShard(absl::string_view data) {
+  if (data.length() < kShardHeaderSize || data.substr(0, 4) != kShardMagic) {
+    return absl::InvalidArgumentError("Not a lint shard result file.");
+  }
+  ShardReader header(data.substr(4, 16));
+  const uint64_t version = header.ReadUint64();
+  if (version != kLintShardFormatVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Lint shard result format version ", version,
+                     " is not the supported ", kLintShardFormatVersion, "."));
+  }
+  const absl::string_view body = data.substr(kShardHeaderSize);
+  if (header.ReadUint64() != Checksum(body)) {
+    return absl::DataLossError("Lint shard result checksum mismatch.");
+  }
+
+  ShardReader reader(body);
+  LintShard shard;
+  shard.shard_index = static_cast<int>(reader.ReadUint64());
+  shard.shard_count = static_cast<int>(reader.ReadUint64());
+  shard.file_count = static_cast<int64_t>(reader.ReadUint64());
+  shard.tool_version = reader.ReadString();
+  for (uint64_t n = reader.ReadCount(64); n > 0; --n) {
+    LintShardEntry entry;
+    entry.index = static_cast<int64_t>(reader.ReadUint64());
+    entry.filename = reader.ReadString();
+    entry.exit_status = static_cast<int32_t>(reader.ReadUint64());
+    entry.output = reader.ReadString();
+    entry.errors = reader.ReadString();
+    entry.text = reader.ReadString();
+    entry.statuses = reader.ReadString();
+    shard.entries.push_back(std::move(entry));
+  }
+  if (!reader.ok() || !reader.AtEnd()) {
+    return absl::DataLossError("Malformed lint shard result file.");
+  }
+  return shard;
+}
+
+void LintShardRecorder::HandleViolations(
+    const std::vector<LintViolationWithStatus> &violations,
+    absl::string_view base, absl::string_view path,
+    const verible::LineColumnMap &line_map) {
+  // Regroup the violations by the status they came from.
+  LintFileResult result;
+  std::vector<const LintRuleStatus *> sources;
+  for (const LintViolationWithStatus &violation : violations) {
+    const size_t source =
+        std::find(sources.begin(), sources.end(), violation.status) -
+        sources.begin();
+    if (source == sources.size()) {
+      sources.push_back(violation.status);
+      result.statuses.push_back(LintRuleStatus(
+          {}, violation.status->lint_rule_name, violation.status->url));
+    }
+    result.statuses[source].violations.insert(*violation.violation);
+  }
+  absl::StatusOr<std::string> statuses =
+      SerializeLintFileResult(result, base);
+  if (!statuses.ok()) {
+    absl::StrAppend(&errors_, path, ": Can't record violations: ",
+                    statuses.status().message(), "\n");
+    return;
+  }
+  text_ = std::string(base);
+  statuses_ = *std::move(statuses);
+}
+
+void LintShardRecorder::TakeViolations(LintShardEntry *entry) {
+  entry->text = std::move(text_);
+  entry->statuses = std::move(statuses_);
+  entry->errors.append(errors_);
+  if (!errors_.empty()) entry->exit_status = std::max(entry->exit_status, 2);
+  text_.clear();
+  statuses_.clear();
+  errors_.clear();
+}
+
+absl::StatusOr<int> MergeLintShards(
+    const std::vector<LintShard> &shards, std::ostream *stream,
+    std::ostream *error_stream, verible::ViolationHandler *violation_handler) {
+  if (shards.empty()) return absl::InvalidArgumentError("No shards to merge.");
+  const LintShard &first = shards.front();
+  std::vector<bool> have_shard(std::max(first.shard_count, 0), false);
+  std::vector<const LintShardEntry *> entries(
+      std::max<int64_t>(first.file_count, 0), nullptr);
+  for (const LintShard &shard : shards) {
+    if (shard.shard_count != first.shard_count ||
+        shard.file_count != first.file_count ||
+        shard.tool_version != first.tool_version) {
+      return absl::InvalidArgumentError(
+          "Shards are from different runs or tool versions.");
+    }
+    if (shard.shard_index < 0 || shard.shard_index >= first.shard_count ||
+        have_shard[shard.shard_index]) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unexpected shard ", shard.shard_index, " of ",
+                       first.shard_count, "."));
+    }
+    have_shard[shard.shard_index] = true;
+    for (const LintShardEntry &entry : shard.entries) {
+      if (entry.index < 0 || entry.index >= first.file_count ||
+          entries[entry.index] != nullptr) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unexpected file ", entry.index, " in shard ", shard.shard_index));
+      }
+      entries[entry.index] = &entry;
+    }
+  }
+  const auto missing = std::find(have_shard.begin(), have_shard.end(), false);
+  if (missing != have_shard.end()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Missing shard ", missing - have_shard.begin(), " of ",
+        first.shard_count, "."));
+  }
+  if (std::find(entries.begin(), entries.end(), nullptr) != entries.end()) {
+    return absl::InvalidArgumentError("Shards don't cover all files.");
+  }
+
+  int exit_status = 0;
+  for (const LintShardEntry *entry : entries) {
+    *stream << entry->output << std::flush;
+    *error_stream << entry->errors << std::flush;
+    exit_status = std::max(entry->exit_status, exit_status);
+    if (entry->statuses.empty()) continue;
+    LintFileResult result;
+    if (!RestoreLintFileResult(entry->statuses, entry->text, &result)) {
+      return absl::DataLossError(
+          absl::StrCat("Malformed violations of ", entry->filename));
+    }
+    violation_handler->HandleViolations(
+        verible::SortedLintViolations(result.statuses), entry->text,
+        entry->filename);
+  }
+  return exit_status;
+}
+
+}  // namespace verilog
@@ -0,0 +1,117 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Support for linting a list of files in shards, e.g. on many machines, and
+// merging the shards' results into the report of linting all files at once.
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_SHARD_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_SHARD_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/strings/line_column_map.h"
+
+namespace verilog {
+
+// Returns the shard, in [0, shard_count), of each of the files that have the
+// given "names" and "sizes".  Files are assigned largest first to the shard
+// with the least total size so far, so that the shards take about the same
+// time.  The assignment only depends on the set of names and sizes, not on
+// their order, so every shard of a run computes the same one.
+std::vector<int> AssignLintShards(const std::vector<absl::string_view> &names,
+                                  const std::vector<int64_t> &sizes,
+                                  int shard_count);
+
+// What linting one file of a shard reported.
+struct LintShardEntry {
+  // Position of the file in the list of all files, which orders the merged
+  // report.
+  int64_t index = 0;
+  std::string filename;
+  int exit_status = 0;
+
+  // Messages destined for stdout (e.g. syntax errors) and stderr (e.g.
+  // configuration errors), besides the violations.
+  std::string output;
+  std::string errors;
+
+  // The text that the violations were reported in, and the statuses of the
+  // reported violations, serialized with SerializeLintFileResult().  Both are
+  // empty without violations.
+  std::string text;
+  std::string statuses;
+};
+
+// The result file of one shard.
+struct LintShard {
+  int shard_index = 0;
+  int shard_count = 1;
+  // Number of files in all shards.
+  int64_t file_count = 0;
+  // Identifies the tool and configuration; shards with different ones can't
+  // be merged.
+  std::string tool_version;
+  std::vector<LintShardEntry> entries;
+};
+
+// Version of the shard result file format, which includes the format of the
+// statuses.  Files of another version are rejected.
+inline constexpr int kLintShardFormatVersion = 1;
+
+std::string SerializeLintShard(const LintShard &shard);
+
+// Parses the result of SerializeLintShard(), or returns an error if "data" is
+// not a shard result file of this version.
+absl::StatusOr<LintShard> ParseLintShard(absl::string_view data);
+
+// ViolationHandler for one file of a shard, which keeps its violations for a
+// LintShardEntry instead of printing them.
+class LintShardRecorder : public verible::ViolationHandler {
+ public:
+  using ViolationHandler::HandleViolations;
+  void HandleViolations(
+      const std::vector<verible::LintViolationWithStatus> &violations,
+      absl::string_view base, absl::string_view path,
+      const verible::LineColumnMap &line_map) final;
+
+  // Moves the recorded violations into "entry", or appends an error to its
+  // errors if they could not be recorded.
+  void TakeViolations(LintShardEntry *entry);
+
+ private:
+  std::string text_;
+  std::string statuses_;
+  std::string errors_;
+};
+
+// Merges "shards", which must be all shards of one run, and reports their
+// entries in the order of the files of the run: messages go to "stream" and
+// "error_stream", violations to "violation_handler".  Returns the largest
+// exit status of the entries, or an error if the shards don't fit together.
+absl::StatusOr<int> MergeLintShards(const std::vector<LintShard> &shards,
+                                    std::ostream *stream,
+                                    std::ostream *error_stream,
+                                    verible::ViolationHandler *violation_handler);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_LINT_SHARD_H_
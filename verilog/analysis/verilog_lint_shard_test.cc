@@ -0,0 +1,195 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_lint_shard.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/text/token_info.h"
+#include "gtest/gtest.h"
+
+namespace verilog {
+namespace {
+
+using verible::LintRuleStatus;
+using verible::LintViolation;
+using verible::TokenInfo;
+
+TEST(AssignLintShardsTest, BalancesSizes) {
+  const std::vector<absl::string_view> names = {"a", "b", "c", "d", "e"};
+  const std::vector<int64_t> sizes = {10, 60, 20, 30, 40};
+  const std::vector<int> shards = AssignLintShards(names, sizes, 2);
+  ASSERT_EQ(shards.size(), names.size());
+  int64_t totals[2] = {0, 0};
+  for (size_t i = 0; i < names.size(); ++i) {
+    ASSERT_GE(shards[i], 0);
+    ASSERT_LT(shards[i], 2);
+    totals[shards[i]] += sizes[i];
+  }
+  EXPECT_EQ(totals[0], 80);
+  EXPECT_EQ(totals[1], 80);
+}
+
+TEST(AssignLintShardsTest, IndependentOfOrder) {
+  const std::vector<absl::string_view> names = {"a", "b", "c", "d"};
+  const std::vector<int64_t> sizes = {5, 5, 7, 1};
+  const std::vector<absl::string_view> reversed_names = {"d", "c", "b", "a"};
+  const std::vector<int64_t> reversed_sizes = {1, 7, 5, 5};
+  const std::vector<int> shards = AssignLintShards(names, sizes, 3);
+  const std::vector<int> reversed_shards =
+      AssignLintShards(reversed_names, reversed_sizes, 3);
+  for (size_t i = 0; i < names.size(); ++i) {
+    EXPECT_EQ(shards[i], reversed_shards[names.size() - 1 - i]) << names[i];
+  }
+}
+
+TEST(AssignLintShardsTest, MoreShardsThanFiles) {
+  const std::vector<int> shards = AssignLintShards({"a", "b"}, {0, 0}, 4);
+  EXPECT_NE(shards[0], shards[1]);
+}
+
+LintShard MakeShard() {
+  LintShard shard;
+  shard.shard_index = 1;
+  shard.shard_count = 2;
+  shard.file_count = 3;
+  shard.tool_version = "v1";
+  LintShardEntry entry;
+  entry.index = 2;
+  entry.filename = "c.sv";
+  entry.exit_status = 1;
+  entry.output = "c.sv:1:1: syntax error\n";
+  shard.entries.push_back(entry);
+  return shard;
+}
+
+TEST(LintShardTest, SerializeRoundTrip) {
+  const LintShard shard = MakeShard();
+  const absl::StatusOr<LintShard> parsed =
+      ParseLintShard(SerializeLintShard(shard));
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_EQ(parsed->shard_index, 1);
+  EXPECT_EQ(parsed->shard_count, 2);
+  EXPECT_EQ(parsed->file_count, 3);
+  EXPECT_EQ(parsed->tool_version, "v1");
+  ASSERT_EQ(parsed->entries.size(), 1);
+  EXPECT_EQ(parsed->entries[0].index, 2);
+  EXPECT_EQ(parsed->entries[0].filename, "c.sv");
+  EXPECT_EQ(parsed->entries[0].exit_status, 1);
+  EXPECT_EQ(parsed->entries[0].output, shard.entries[0].output);
+}
+
+TEST(LintShardTest, RejectsCorruptFiles) {
+  std::string data = SerializeLintShard(MakeShard());
+  EXPECT_FALSE(ParseLintShard("").ok());
+  EXPECT_FALSE(ParseLintShard(data.substr(0, data.length() - 1)).ok());
+  std::string other_version = data;
+  other_version[4] ^= 1;
+  EXPECT_FALSE(ParseLintShard(other_version).ok());
+  data.back() ^= 1;
+  EXPECT_FALSE(ParseLintShard(data).ok());
+}
+
+constexpr absl::string_view kText = "module m;\twire w;\nendmodule\n";
+
+// Returns the entry of linting kText as "a.sv", with a violation at the tab.
+LintShardEntry RecordViolations() {
+  LintShardRecorder recorder;
+  // The text and statuses go away after reporting, as in LintOneFile().
+  {
+    const std::string text(kText);
+    const LintRuleStatus status(
+        {LintViolation(TokenInfo(1, absl::string_view(text).substr(9, 1)),
+                       "Use spaces.")},
+        "no-tabs", "url");
+    recorder.HandleViolations(verible::SortedLintViolations({status}), text,
+                              "a.sv");
+  }
+  LintShardEntry entry;
+  entry.index = 0;
+  entry.filename = "a.sv";
+  entry.exit_status = 1;
+  recorder.TakeViolations(&entry);
+  return entry;
+}
+
+// Returns the report of linting kText as "a.sv" and "b.sv".
+std::string UnshardedReport() {
+  std::ostringstream report;
+  verible::ViolationPrinter printer(&report);
+  for (const absl::string_view filename : {"a.sv", "b.sv"}) {
+    const LintRuleStatus status(
+        {LintViolation(TokenInfo(1, kText.substr(9, 1)), "Use spaces.")},
+        "no-tabs", "url");
+    printer.HandleViolations(verible::SortedLintViolations({status}), kText,
+                             filename);
+  }
+  return report.str();
+}
+
+TEST(LintShardTest, MergeReportsInFileOrder) {
+  LintShard shard0;
+  shard0.shard_count = 2;
+  shard0.file_count = 2;
+  LintShard shard1 = shard0;
+  shard1.shard_index = 1;
+  shard1.entries.push_back(RecordViolations());
+  shard1.entries.back().index = 0;
+  shard0.entries.push_back(RecordViolations());
+  shard0.entries.back().index = 1;
+  shard0.entries.back().filename = "b.sv";
+
+  std::vector<LintShard> shards;
+  for (const LintShard &shard : {shard0, shard1}) {
+    const auto parsed = ParseLintShard(SerializeLintShard(shard));
+    ASSERT_TRUE(parsed.ok()) << parsed.status();
+    shards.push_back(*parsed);
+  }
+  std::ostringstream output, errors;
+  verible::ViolationPrinter printer(&errors);
+  const absl::StatusOr<int> exit_status =
+      MergeLintShards(shards, &output, &errors, &printer);
+  ASSERT_TRUE(exit_status.ok()) << exit_status.status();
+  EXPECT_EQ(*exit_status, 1);
+  EXPECT_EQ(output.str(), "");
+  EXPECT_EQ(errors.str(), UnshardedReport());
+}
+
+TEST(LintShardTest, MergeRejectsIncompleteShards) {
+  LintShard shard = MakeShard();
+  std::ostringstream output, errors;
+  verible::ViolationPrinter printer(&errors);
+  EXPECT_FALSE(MergeLintShards({}, &output, &errors, &printer).ok());
+  EXPECT_FALSE(MergeLintShards({shard}, &output, &errors, &printer).ok());
+  LintShard other = shard;
+  other.shard_index = 0;
+  other.tool_version = "v2";
+  EXPECT_FALSE(
+      MergeLintShards({shard, other}, &output, &errors, &printer).ok());
+  other.tool_version = shard.tool_version;
+  EXPECT_FALSE(MergeLintShards({shard, shard}, &output, &errors, &printer).ok());
+  // Files 0 and 1 are not in any shard.
+  EXPECT_FALSE(
+      MergeLintShards({shard, other}, &output, &errors, &printer).ok());
+}
+
+}  // namespace
+}  // namespace verilog
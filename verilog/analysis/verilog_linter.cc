@@ -14,17 +14,27 @@
 
 #include "verilog/analysis/verilog_linter.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <initializer_list>
 #include <iomanip>
 #include <ios>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -33,6 +43,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/analysis/citation.h"
+#include "common/analysis/fused_linter.h"
 #include "common/analysis/line_linter.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/lint_waiver.h"
@@ -41,17 +52,25 @@
 #include "common/analysis/token_stream_linter.h"
 #include "common/analysis/violation_handler.h"
 #include "common/strings/line_column_map.h"
+#include "common/strings/mem_block.h"
 #include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
+#include "common/text/tree_utils.h"
 #include "common/util/file_util.h"
 #include "common/util/logging.h"
+#include "common/util/range.h"
 #include "common/util/status_macros.h"
+#include "verilog/CST/verilog_nonterminals.h"
 #include "verilog/analysis/default_rules.h"
+#include "verilog/analysis/lint_file_facts.h"
 #include "verilog/analysis/lint_rule_registry.h"
 #include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_lint_cache.h"
 #include "verilog/analysis/verilog_linter_configuration.h"
 #include "verilog/analysis/verilog_linter_constants.h"
+#include "verilog/analysis/verilog_parse_cache.h"
 #include "verilog/parser/verilog_token_classifications.h"
 #include "verilog/parser/verilog_token_enum.h"
 
@@ -75,24 +94,19 @@ ABSL_FLAG(std::string, waiver_files, "",
 
 namespace verilog {
 
+using verible::AutoFix;
 using verible::LineColumnMap;
 using verible::LintRuleStatus;
+using verible::LintViolation;
 using verible::LintViolationWithStatus;
-using verible::LintWaiver;
+using verible::ReplacementEdit;
+using verible::Symbol;
 using verible::TextStructureView;
 using verible::TokenInfo;
 
-std::set<LintViolationWithStatus> GetSortedViolations(
+std::vector<LintViolationWithStatus> GetSortedViolations(
     const std::vector<LintRuleStatus> &statuses) {
-  std::set<LintViolationWithStatus> violations;
-
-  for (const auto &status : statuses) {
-    for (const auto &violation : status.violations) {
-      violations.insert(LintViolationWithStatus(&violation, &status));
-    }
-  }
-
-  return violations;
+  return verible::SortedLintViolations(statuses);
 }
 
 // Return code useful to be used in main:
@@ -102,14 +116,31 @@ std::set<LintViolationWithStatus> GetSortedViolations(
 int LintOneFile(std::ostream *stream, absl::string_view filename,
                 const LinterConfiguration &config,
                 verible::ViolationHandler *violation_handler, bool check_syntax,
-                bool parse_fatal, bool lint_fatal, bool show_context) {
-  const absl::StatusOr<std::string> content_or =
-      verible::file::GetContentAsString(filename);
+                bool parse_fatal, bool lint_fatal, bool show_context,
+                VerilogLintCache *cache) {
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> content_or =
+      verible::file::GetContentAsMemBlock(filename);
   if (!content_or.ok()) {
     LOG(ERROR) << "Can't read '" << filename
                << "': " << content_or.status().message();
     return 2;
   }
+  const std::shared_ptr<verible::MemBlock> content = *std::move(content_or);
+  const absl::string_view text = content->AsStringView();
+
+  // Unchanged files with the same configuration are reported from the cache,
+  // without analyzing them again.
+  std::string cache_key;
+  LintFileResult result;
+  bool cached = false;
+  if (cache != nullptr) {
+    cache_key =
+        cache->Key(filename, text, config,
+                   absl::StrCat("check_syntax=", check_syntax,
+                                ",parse_fatal=", parse_fatal,
+                                ",show_context=", show_context));
+    cached = cache->Lookup(cache_key, text, &result);
+  }
 
   // Lex and parse the contents of the file.
   // Attempt first to run without preprocessing to capture more information,
@@ -118,36 +149,52 @@ int LintOneFile(std::ostream *stream, absl::string_view filename,
   // TODO(hzeller): this behavior could be configurable, but then again this
   //   is something the user is expecting to work as best as possible (which
   //   is also why we use automatic mode).
-  const auto analyzer = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
-      *content_or, filename);
-  if (check_syntax) {
-    const auto lex_status = ABSL_DIE_IF_NULL(analyzer)->LexStatus();
-    const auto parse_status = analyzer->ParseStatus();
-    if (!lex_status.ok() || !parse_status.ok()) {
-      const std::vector<std::string> syntax_error_messages(
-          analyzer->LinterTokenErrorMessages(show_context));
-      for (const auto &message : syntax_error_messages) {
-        *stream << message << std::endl;
+  std::unique_ptr<VerilogAnalyzer> analyzer;
+  if (!cached) {
+    analyzer = AnalyzeWithParseCache(
+        content, filename, "automatic-preprocess-fallback", [&]() {
+          return VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(content,
+                                                                     filename);
+        });
+    if (check_syntax) {
+      const auto lex_status = ABSL_DIE_IF_NULL(analyzer)->LexStatus();
+      const auto parse_status = analyzer->ParseStatus();
+      if (!lex_status.ok() || !parse_status.ok()) {
+        result.syntax_errors = true;
+        result.syntax_error_messages =
+            analyzer->LinterTokenErrorMessages(show_context);
       }
-      if (parse_fatal) {
-        return 1;
-        // With syntax-error recovery, one can still continue to analyze a
-        // partial syntax tree.
+    }
+    // With syntax-error recovery, one can still continue to analyze a
+    // partial syntax tree.
+    if (!result.syntax_errors || !parse_fatal) {
+      // Analyze the parsed structure for lint violations.
+      auto linter_result =
+          VerilogLintTextStructure(filename, config, analyzer->Data(),
+                                   &analyzer->CommentDirectives());
+      if (!linter_result.ok()) {
+        // Something went wrong with running the lint analysis itself.
+        LOG(ERROR) << "Fatal error: " << linter_result.status().message();
+        return 2;
       }
+      result.statuses = *std::move(linter_result);
+    }
+    // Violations are cached by their offsets into the file contents.
+    if (cache != nullptr && analyzer->Data().Contents().data() == text.data()) {
+      cache->Store(cache_key, text, result);
     }
   }
 
-  // Analyze the parsed structure for lint violations.
-  const auto &text_structure = analyzer->Data();
-  const auto linter_result =
-      VerilogLintTextStructure(filename, config, text_structure);
-  if (!linter_result.ok()) {
-    // Something went wrong with running the lint analysis itself.
-    LOG(ERROR) << "Fatal error: " << linter_result.status().message();
-    return 2;
+  if (result.syntax_errors) {
+    for (const auto &message : result.syntax_error_messages) {
+      *stream << message << std::endl;
+    }
+    if (parse_fatal) {
+      return 1;
+    }
   }
 
-  const std::vector<LintRuleStatus> &linter_statuses = linter_result.value();
+  const std::vector<LintRuleStatus> &linter_statuses = result.statuses;
 
   size_t total_violations = 0;
   for (const auto &rule_status : linter_statuses) {
@@ -159,11 +206,16 @@ int LintOneFile(std::ostream *stream, absl::string_view filename,
   } else {
     VLOG(1) << "Lint Violations (" << total_violations << "): " << std::endl;
 
-    absl::string_view text_base = text_structure.Contents();
-
-    const std::set<LintViolationWithStatus> violations =
+    const std::vector<LintViolationWithStatus> violations =
         GetSortedViolations(linter_statuses);
-    violation_handler->HandleViolations(violations, text_base, filename);
+    // Reuse the lines of the analyzed text; cached results have none.
+    if (analyzer != nullptr) {
+      violation_handler->HandleViolations(
+          violations, analyzer->Data().Contents(), filename,
+          analyzer->Data().GetLineColumnMap());
+    } else {
+      violation_handler->HandleViolations(violations, text, filename);
+    }
     if (lint_fatal) {
       return 1;
     }
@@ -183,6 +235,55 @@ VerilogLinter::VerilogLinter()
           kLinterTrigger, kLinterWaiveLineCommand, kLinterWaiveStartCommand,
           kLinterWaiveStopCommand) {}
 
+namespace {
+// Parsed waivers, valid as long as the waiver file and active rules are the
+// same.
+struct CachedExternalWaivers {
+  std::filesystem::file_time_type mtime;
+  std::uintmax_t size;
+  std::set<absl::string_view> active_rules;
+  std::shared_ptr<const verible::ExternalLintWaivers> waivers;
+};
+}  // namespace
+
+// Returns the parsed waivers of "waiver_file", or nullptr if it can't be read.
+// The file is only read and parsed again if it changed since the last call,
+// so that linting many files, or the same file after every edit, shares the
+// work.
+static std::shared_ptr<const verible::ExternalLintWaivers> GetExternalWaivers(
+    const std::set<absl::string_view> &active_rules,
+    absl::string_view waiver_file) {
+  static std::mutex cache_mutex;
+  static auto *cache =
+      new std::map<std::string, CachedExternalWaivers, std::less<>>;
+
+  const std::filesystem::path path{std::string(waiver_file)};
+  std::error_code err;
+  const auto mtime = std::filesystem::last_write_time(path, err);
+  const std::uintmax_t size = err ? 0 : std::filesystem::file_size(path, err);
+  const bool cacheable = !err;
+  if (cacheable) {
+    const std::lock_guard<std::mutex> lock(cache_mutex);
+    const auto found = cache->find(waiver_file);
+    if (found != cache->end() && found->second.mtime == mtime &&
+        found->second.size == size &&
+        found->second.active_rules == active_rules) {
+      return found->second.waivers;
+    }
+  }
+
+  auto content_or = verible::file::GetContentAsString(waiver_file);
+  if (!content_or.ok()) return nullptr;
+  auto waivers = std::make_shared<const verible::ExternalLintWaivers>(
+      active_rules, waiver_file, *content_or);
+
+  if (cacheable) {
+    const std::lock_guard<std::mutex> lock(cache_mutex);
+    (*cache)[std::string(waiver_file)] = {mtime, size, active_rules, waivers};
+  }
+  return waivers;
+}
+
 absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
                                       absl::string_view lintee_filename) {
   if (VLOG_IS_ON(2)) {
@@ -205,20 +306,25 @@ absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
   for (auto &rule : *token_rules) {
     token_stream_linter_.AddRule(std::move(rule));
   }
-  auto syntax_rules = configuration.CreateSyntaxTreeRules();
+  std::vector<analysis::LintRuleId> syntax_rule_ids;
+  auto syntax_rules = configuration.CreateSyntaxTreeRules(&syntax_rule_ids);
   if (!syntax_rules.ok()) return syntax_rules.status();
-  for (auto &rule : *syntax_rules) {
-    syntax_tree_linter_.AddRule(std::move(rule));
+  for (size_t i = 0; i < syntax_rules->size(); ++i) {
+    const bool item_local =
+        analysis::IsItemLocalSyntaxTreeRule(syntax_rule_ids[i]);
+    if (item_local) item_local_rules_.insert(syntax_rule_ids[i]);
+    syntax_tree_linter_.AddRule(std::move((*syntax_rules)[i]), item_local);
   }
 
   absl::Status rc = absl::OkStatus();
+  const std::set<absl::string_view> active_rules =
+      configuration.ActiveRuleIds();
   for (const auto &waiver_file :
        absl::StrSplit(configuration.external_waivers, ',', absl::SkipEmpty())) {
-    auto content_or = verible::file::GetContentAsString(waiver_file);
-    if (!content_or.ok()) continue;  // Couldn't read lint file: ignore
-    auto status = lint_waiver_.ApplyExternalWaivers(
-        configuration.ActiveRuleIds(), lintee_filename, waiver_file,
-        *content_or);
+    auto waivers = GetExternalWaivers(active_rules, waiver_file);
+    if (waivers == nullptr) continue;  // Couldn't read lint file: ignore
+    auto status =
+        lint_waiver_.ApplyExternalWaivers(std::move(waivers), lintee_filename);
     if (!status.ok()) {
       rc.Update(status);
     }
@@ -229,54 +335,63 @@ absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
 
 void VerilogLinter::Lint(const TextStructureView &text_structure,
                          absl::string_view filename) {
+  // Facts about the file that several rules need are computed only once.
+  const LintFileFacts::SharedScope shared_facts(text_structure);
+
   // Collect all lint waivers in an initial pass.
-  lint_waiver_.ProcessTokenRangesByLine(text_structure);
+  lint_waiver_.ProcessTokenRangesByLine(text_structure, comment_directives_);
 
   // Analyze general text structure.
   text_structure_linter_.Lint(text_structure, filename);
 
-  // Analyze lines of text.
-  line_linter_.Lint(text_structure.Lines());
-
-  // Analyze token stream.
-  token_stream_linter_.Lint(text_structure.TokenStream());
+  // Analyze lines of text, token stream and syntax tree in one scan.
+  verible::FusedLint(text_structure, &line_linter_, &token_stream_linter_,
+                     &syntax_tree_linter_);
+}
 
-  // Analyze syntax tree.
-  const verible::ConcreteSyntaxTree &syntax_tree = text_structure.SyntaxTree();
-  if (syntax_tree != nullptr) {
-    syntax_tree_linter_.Lint(*syntax_tree);
-  }
+void VerilogLinter::Lint(const TextStructureView &text_structure,
+                         absl::string_view filename,
+                         verible::SyntaxTreeLinter::SubtreeFilter known) {
+  syntax_tree_linter_.SetKnownSubtrees(std::move(known));
+  Lint(text_structure, filename);
+  syntax_tree_linter_.SetKnownSubtrees(nullptr);
 }
 
 static void AppendLintRuleStatuses(
-    const std::vector<LintRuleStatus> &new_statuses,
+    std::vector<LintRuleStatus> new_statuses,
     const verible::LintWaiver &waivers, const LineColumnMap &line_map,
     absl::string_view text_base,
     std::vector<LintRuleStatus> *cumulative_statuses) {
-  for (const auto &status : new_statuses) {
-    cumulative_statuses->push_back(status);
-    const auto *waived_lines =
-        waivers.LookupLineNumberSet(status.lint_rule_name);
-    if (waived_lines) {
-      cumulative_statuses->back().WaiveViolations(
-          [&](const verible::LintViolation &violation) {
-            // Lookup the line number on which the offending token resides.
-            const size_t offset = violation.token.left(text_base);
-            const size_t line = line_map.LineAtOffset(offset);
-            // Check that line number against the set of waived lines.
-            const bool waived =
-                LintWaiver::LineNumberSetContains(*waived_lines, line);
-            VLOG(2) << "Violation of " << status.lint_rule_name
-                    << " rule on line " << line + 1
-                    << (waived ? " is waived." : " is not waived.");
-            return waived;
-          });
-    }
+  for (auto &new_status : new_statuses) {
+    LintRuleStatus &status =
+        cumulative_statuses->emplace_back(std::move(new_status));
+    waivers.WaiveViolations(line_map, text_base, &status);
   }
 }
 
 std::vector<LintRuleStatus> VerilogLinter::ReportStatus(
     const LineColumnMap &line_map, absl::string_view text_base) {
+  return ReportStatus(line_map, text_base, {}, nullptr);
+}
+
+std::vector<LintRuleStatus> VerilogLinter::ReportStatus(
+    const LineColumnMap &line_map, absl::string_view text_base,
+    const std::vector<LintRuleStatus> &known_violations,
+    std::vector<LintRuleStatus> *item_local_statuses) {
+  std::vector<LintRuleStatus> syntax_tree_statuses =
+      syntax_tree_linter_.ReportStatus();
+  for (LintRuleStatus &status : syntax_tree_statuses) {
+    if (item_local_rules_.count(status.lint_rule_name) == 0) continue;
+    for (const LintRuleStatus &known : known_violations) {
+      if (known.lint_rule_name != status.lint_rule_name) continue;
+      status.violations.insert(known.violations.begin(),
+                               known.violations.end());
+    }
+    if (item_local_statuses != nullptr) {
+      item_local_statuses->push_back(status);
+    }
+  }
+
   std::vector<LintRuleStatus> statuses;
   const verible::LintWaiver &waivers = lint_waiver_.GetLintWaiver();
   AppendLintRuleStatuses(line_linter_.ReportStatus(), waivers, line_map,
@@ -285,7 +400,7 @@ std::vector<LintRuleStatus> VerilogLinter::ReportStatus(
                          line_map, text_base, &statuses);
   AppendLintRuleStatuses(token_stream_linter_.ReportStatus(), waivers, line_map,
                          text_base, &statuses);
-  AppendLintRuleStatuses(syntax_tree_linter_.ReportStatus(), waivers, line_map,
+  AppendLintRuleStatuses(std::move(syntax_tree_statuses), waivers, line_map,
                          text_base, &statuses);
   return statuses;
 }
@@ -310,12 +425,14 @@ absl::StatusOr<LinterConfiguration> LinterConfigurationFromFlags(
 
 absl::StatusOr<std::vector<LintRuleStatus>> VerilogLintTextStructure(
     absl::string_view filename, const LinterConfiguration &config,
-    const TextStructureView &text_structure) {
+    const TextStructureView &text_structure,
+    const verible::CommentDirectiveIndex *comment_directives) {
   // Create the linter, add rules, and run it.
   VerilogLinter linter;
   if (absl::Status status = linter.Configure(config, filename); !status.ok()) {
     return status;
   }
+  linter.SetCommentDirectives(comment_directives);
 
   linter.Lint(text_structure, filename);
 
@@ -324,6 +441,198 @@ absl::StatusOr<std::vector<LintRuleStatus>> VerilogLintTextStructure(
   return linter.ReportStatus(text_structure.GetLineColumnMap(), text_base);
 }
 
+namespace {
+// A top-level description that is the same text in a previous and the current
+// version of a file.
+struct UnchangedDescription {
+  absl::string_view previous;
+  absl::string_view current;
+  const Symbol *symbol;  // In the current syntax tree.
+};
+}  // namespace
+
+// Returns the top-level descriptions of "previous" and "current" that are
+// within the unedited text at their beginning or end, ordered by position.
+static std::vector<UnchangedDescription> FindUnchangedDescriptions(
+    const TextStructureView &previous, const TextStructureView &current) {
+  const auto descriptions = [](const TextStructureView &text_structure)
+      -> const verible::SyntaxTreeNode * {
+    const Symbol *root = text_structure.SyntaxTree().get();
+    if (root == nullptr || root->Kind() != verible::SymbolKind::kNode) {
+      return nullptr;
+    }
+    const auto &node = verible::SymbolCastToNode(*root);
+    return node.MatchesTag(NodeEnum::kDescriptionList) ? &node : nullptr;
+  };
+  const verible::SyntaxTreeNode *previous_descriptions = descriptions(previous);
+  const verible::SyntaxTreeNode *current_descriptions = descriptions(current);
+  if (previous_descriptions == nullptr || current_descriptions == nullptr) {
+    return {};
+  }
+
+  const absl::string_view previous_text = previous.Contents();
+  const absl::string_view text = current.Contents();
+  const size_t common_length = std::min(previous_text.length(), text.length());
+  const size_t prefix_length =
+      std::mismatch(text.begin(), text.begin() + common_length,
+                    previous_text.begin())
+          .first -
+      text.begin();
+  const size_t suffix_length =
+      std::mismatch(text.rbegin(),
+                    text.rbegin() + (common_length - prefix_length),
+                    previous_text.rbegin())
+          .first -
+      text.rbegin();
+
+  std::map<absl::string_view::const_pointer, const Symbol *>
+      current_by_begin;
+  for (const auto &description : current_descriptions->children()) {
+    if (description == nullptr) continue;
+    const absl::string_view span = verible::StringSpanOfSymbol(*description);
+    if (verible::IsSubRange(span, text)) {
+      current_by_begin.emplace(span.begin(), description.get());
+    }
+  }
+
+  std::vector<UnchangedDescription> unchanged;
+  for (const auto &description : previous_descriptions->children()) {
+    if (description == nullptr) continue;
+    const absl::string_view span = verible::StringSpanOfSymbol(*description);
+    if (span.empty() || !verible::IsSubRange(span, previous_text)) continue;
+    const size_t begin = std::distance(previous_text.begin(), span.begin());
+    const size_t end = begin + span.length();
+    size_t current_begin;
+    if (end <= prefix_length) {
+      current_begin = begin;
+    } else if (begin >= previous_text.length() - suffix_length) {
+      current_begin = begin + text.length() - previous_text.length();
+    } else {
+      continue;  // Edited.
+    }
+    const auto found = current_by_begin.find(text.begin() + current_begin);
+    if (found == current_by_begin.end() ||
+        verible::StringSpanOfSymbol(*found->second).length() !=
+            span.length()) {
+      continue;  // Parsed differently.
+    }
+    unchanged.push_back(
+        {span, text.substr(current_begin, span.length()), found->second});
+  }
+  return unchanged;
+}
+
+// Returns the item-local violations of "previous" within "unchanged"
+// descriptions, moved to the current text, or nullopt if some of them also
+// refer to edited text. These violations have no syntax tree context.
+static std::optional<std::vector<LintRuleStatus>> CarryOverViolations(
+    const std::vector<LintRuleStatus> &previous,
+    const std::vector<UnchangedDescription> &unchanged) {
+  // Returns the unchanged description that contains "text", or nullptr.
+  const auto find =
+      [&unchanged](absl::string_view text) -> const UnchangedDescription * {
+    const auto after = std::upper_bound(
+        unchanged.begin(), unchanged.end(), text.begin(),
+        [](absl::string_view::const_pointer begin,
+           const UnchangedDescription &description) {
+          return begin < description.previous.begin();
+        });
+    if (after == unchanged.begin()) return nullptr;
+    const UnchangedDescription *description = &*std::prev(after);
+    return verible::IsSubRange(text, description->previous) ? description
+                                                           : nullptr;
+  };
+  const auto move = [](const UnchangedDescription &description,
+                       absl::string_view text) {
+    return description.current.substr(
+        std::distance(description.previous.begin(), text.begin()),
+        text.length());
+  };
+  const auto move_token =
+      [&](const TokenInfo &token) -> std::optional<TokenInfo> {
+    const UnchangedDescription *description = find(token.text());
+    if (description == nullptr) return std::nullopt;
+    TokenInfo moved(token);
+    moved.RebaseStringView(move(*description, token.text()).begin());
+    return moved;
+  };
+
+  std::vector<LintRuleStatus> carried;
+  for (const LintRuleStatus &status : previous) {
+    std::set<LintViolation> violations;
+    for (const LintViolation &violation : status.violations) {
+      const std::optional<TokenInfo> token = move_token(violation.token);
+      if (!token) continue;  // Found again, if still there.
+      std::vector<TokenInfo> related_tokens;
+      for (const TokenInfo &related : violation.related_tokens) {
+        const std::optional<TokenInfo> moved = move_token(related);
+        if (!moved) return std::nullopt;
+        related_tokens.push_back(*moved);
+      }
+      std::vector<AutoFix> autofixes;
+      for (const AutoFix &autofix : violation.autofixes) {
+        std::set<ReplacementEdit> edits;
+        for (const ReplacementEdit &edit : autofix.Edits()) {
+          const UnchangedDescription *description = find(edit.fragment);
+          if (description == nullptr) return std::nullopt;
+          edits.emplace(move(*description, edit.fragment), edit.replacement);
+        }
+        autofixes.emplace_back(autofix.Description(),
+                               std::initializer_list<ReplacementEdit>{});
+        autofixes.back().AddEdits(edits);
+      }
+      violations.insert(LintViolation(*token, violation.reason,
+                                               autofixes, related_tokens));
+    }
+    carried.emplace_back(violations, status.lint_rule_name, status.url);
+  }
+  return carried;
+}
+
+absl::StatusOr<VerilogLintResult> VerilogLintEditedTextStructure(
+    absl::string_view filename, const LinterConfiguration &config,
+    const TextStructureView &text_structure,
+    const TextStructureView *previous_text_structure,
+    const VerilogLintResult *previous,
+    const verible::CommentDirectiveIndex *comment_directives) {
+  VerilogLinter linter;
+  if (absl::Status status = linter.Configure(config, filename); !status.ok()) {
+    return status;
+  }
+  linter.SetCommentDirectives(comment_directives);
+
+  std::vector<LintRuleStatus> known_violations;
+  absl::flat_hash_set<const Symbol *> known_descriptions;
+  if (previous_text_structure != nullptr && previous != nullptr) {
+    const std::vector<UnchangedDescription> unchanged =
+        FindUnchangedDescriptions(*previous_text_structure, text_structure);
+    if (auto carried =
+            CarryOverViolations(previous->item_local_statuses, unchanged)) {
+      known_violations = *std::move(carried);
+      for (const UnchangedDescription &description : unchanged) {
+        known_descriptions.insert(description.symbol);
+      }
+    }
+  }
+  VLOG(1) << "Linting " << filename << " with " << known_descriptions.size()
+          << " unchanged top-level descriptions.";
+
+  if (known_descriptions.empty()) {
+    linter.Lint(text_structure, filename);
+  } else {
+    linter.Lint(text_structure, filename,
+                [&known_descriptions](const Symbol &description) {
+                  return known_descriptions.contains(&description);
+                });
+  }
+
+  VerilogLintResult result;
+  result.statuses = linter.ReportStatus(
+      text_structure.GetLineColumnMap(), text_structure.Contents(),
+      known_violations, &result.item_local_statuses);
+  return result;
+}
+
 absl::Status PrintRuleInfo(std::ostream *os,
                            const analysis::LintRuleDescriptionsMap &rule_map,
                            absl::string_view rule_name) {
@@ -23,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
 #include "common/analysis/line_linter.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/lint_waiver.h"
@@ -33,6 +34,7 @@
 #include "common/strings/line_column_map.h"
 #include "common/text/text_structure.h"
 #include "verilog/analysis/lint_rule_registry.h"
+#include "verilog/analysis/verilog_lint_cache.h"
 #include "verilog/analysis/verilog_linter_configuration.h"
 
 // Flag is declared for testing purposes (used e.g. in
@@ -42,8 +44,8 @@ ABSL_DECLARE_FLAG(bool, rules_config_search);
 namespace verilog {
 
 // Returns violations from multiple `LintRuleStatus`es sorted by position
-// of their occurrence in source code.
-std::set<verible::LintViolationWithStatus> GetSortedViolations(
+// of their occurrence in source code (see verible::SortedLintViolations()).
+std::vector<verible::LintViolationWithStatus> GetSortedViolations(
     const std::vector<verible::LintRuleStatus> &statuses);
 
 // Checks a single file for Verilog style lint violations.
@@ -57,6 +59,8 @@ std::set<verible::LintViolationWithStatus> GetSortedViolations(
 // If 'parse_fatal' is true, abort after encountering syntax errors, else
 // continue to analyze the salvaged code structure.
 // If 'lint_fatal' is true, exit nonzero on finding lint violations.
+// If 'cache' is given, results for unchanged files are reported from it, and
+// new results are stored in it.
 // Returns an exit_code like status where 0 means success, 1 means some
 // errors were found (syntax, lint), and anything else is a fatal error.
 //
@@ -66,7 +70,8 @@ std::set<verible::LintViolationWithStatus> GetSortedViolations(
 int LintOneFile(std::ostream *stream, absl::string_view filename,
                 const LinterConfiguration &config,
                 verible::ViolationHandler *violation_handler, bool check_syntax,
-                bool parse_fatal, bool lint_fatal, bool show_context = false);
+                bool parse_fatal, bool lint_fatal, bool show_context = false,
+                VerilogLintCache *cache = nullptr);
 
 // VerilogLinter analyzes a TextStructureView of Verilog source code.
 // This uses syntax-tree based analyses and lexical token-stream analyses.
@@ -78,14 +83,36 @@ class VerilogLinter {
   absl::Status Configure(const LinterConfiguration &configuration,
                          absl::string_view lintee_filename);
 
+  // Uses "directives", which index the comments of the text structure to be
+  // linted, for its waivers instead of parsing the comments again; see
+  // VerilogAnalyzer::CommentDirectives().  "directives" must outlive Lint().
+  void SetCommentDirectives(const verible::CommentDirectiveIndex *directives) {
+    comment_directives_ = directives;
+  }
+
   // Analyzes text structure.
   void Lint(const verible::TextStructureView &text_structure,
             absl::string_view filename);
 
+  // Like Lint(), but item-local syntax tree rules (see
+  // analysis::LintRuleDescriptor::item_local) skip the top-level descriptions
+  // for which "known" returns true.
+  void Lint(const verible::TextStructureView &text_structure,
+            absl::string_view filename,
+            verible::SyntaxTreeLinter::SubtreeFilter known);
+
   // Reports lint findings.
   std::vector<verible::LintRuleStatus> ReportStatus(
       const verible::LineColumnMap &, absl::string_view text_base);
 
+  // Like above, but adds "known_violations" to the findings of the item-local
+  // rules of the same name, and if not null, stores these findings before
+  // waiving in "item_local_statuses".
+  std::vector<verible::LintRuleStatus> ReportStatus(
+      const verible::LineColumnMap &, absl::string_view text_base,
+      const std::vector<verible::LintRuleStatus> &known_violations,
+      std::vector<verible::LintRuleStatus> *item_local_statuses);
+
  private:
   // Line based linter.
   verible::LineLinter line_linter_;
@@ -99,8 +126,14 @@ class VerilogLinter {
   // TextStructure-based linter.
   verible::TextStructureLinter text_structure_linter_;
 
+  // Names of the item-local syntax tree rules.
+  std::set<absl::string_view> item_local_rules_;
+
   // Tracks the set of waived lines per rule.
   verible::LintWaiverBuilder lint_waiver_;
+
+  // See SetCommentDirectives(); not owned, may be null.
+  const verible::CommentDirectiveIndex *comment_directives_ = nullptr;
 };
 
 // Creates a linter configuration from global flags.
@@ -126,12 +159,38 @@ absl::Status AppendLinterConfigurationFromFile(
 //   filename: (optional) name of input file, that can appear in logs.
 //   text_structure: contains the syntax tree that will be lint-analyzed.
 //   show_context: print additional line with vulnerable code
+//   comment_directives: (optional) see VerilogLinter::SetCommentDirectives().
 //
 // Returns:
 //   Vector of LintRuleStatuses on success, otherwise error code.
 absl::StatusOr<std::vector<verible::LintRuleStatus>> VerilogLintTextStructure(
     absl::string_view filename, const LinterConfiguration &config,
-    const verible::TextStructureView &text_structure);
+    const verible::TextStructureView &text_structure,
+    const verible::CommentDirectiveIndex *comment_directives = nullptr);
+
+// Lint findings for one version of a text, which allow linting an edited
+// version of it incrementally.
+struct VerilogLintResult {
+  // Violations of each rule, without the waived ones.
+  std::vector<verible::LintRuleStatus> statuses;
+
+  // Violations of each item-local rule (see
+  // analysis::LintRuleDescriptor::item_local), including the waived ones.
+  std::vector<verible::LintRuleStatus> item_local_statuses;
+};
+
+// Like VerilogLintTextStructure(), but if "previous" is not null, it holds the
+// findings for "previous_text_structure" with the same "config", of which
+// "text_structure" is an edited version.  Item-local rules then only analyze
+// the top-level descriptions that changed, and take over their violations in
+// the others from "previous".  All other rules analyze the whole text.
+// "comment_directives" is as for VerilogLintTextStructure().
+absl::StatusOr<VerilogLintResult> VerilogLintEditedTextStructure(
+    absl::string_view filename, const LinterConfiguration &config,
+    const verible::TextStructureView &text_structure,
+    const verible::TextStructureView *previous_text_structure = nullptr,
+    const VerilogLintResult *previous = nullptr,
+    const verible::CommentDirectiveIndex *comment_directives = nullptr);
 
 // Prints the rule, description and default_enabled.
 absl::Status PrintRuleInfo(std::ostream *,
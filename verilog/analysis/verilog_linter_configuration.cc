@@ -15,13 +15,17 @@
 #include "verilog/analysis/verilog_linter_configuration.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <system_error>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -272,88 +276,122 @@ void LinterConfiguration::GetRuleBundle(RuleBundle *rule_bundle) const {
   rule_bundle->rules = configuration_;
 }
 
-// Iterates through all rules that are mentioned and enabled
-// in the "config" map. Constructs instances using the
-// "factory"-function, and configures them if a configuration string is
-// available. Returns a vector of all successfully created instances.
+// Iterates through all rules of type T that are mentioned and enabled
+// in the "config" map.  Creates instances, configured with the configuration
+// string if there is any, re-using instances from previously linted files
+// when possible.  Returns a vector of all successfully created instances,
+// and their names in "rule_ids" if that is not null.
 //
 // T should be a descendant of verible::LintRule.
 template <typename T>
 static absl::StatusOr<std::vector<std::unique_ptr<T>>> CreateRules(
     const std::map<analysis::LintRuleId, RuleSetting> &config,
-    std::function<std::unique_ptr<T>(const analysis::LintRuleId &)> factory) {
+    std::vector<analysis::LintRuleId> *rule_ids = nullptr) {
   std::vector<std::unique_ptr<T>> rule_instances;
   for (const auto &rule_pair : config) {
     const RuleSetting &setting = rule_pair.second;
     if (!setting.enabled) continue;
 
-    std::unique_ptr<T> rule_ptr = factory(rule_pair.first);
-    if (rule_ptr == nullptr) continue;
-
-    if (!setting.configuration.empty()) {
-      if (absl::Status status = rule_ptr->Configure(setting.configuration);
-          !status.ok()) {
-        std::string error_msg =
-            absl::StrCat(rule_pair.first, " ", status.message());
-        return absl::InvalidArgumentError(error_msg);
-      }
+    absl::StatusOr<std::unique_ptr<T>> rule_or =
+        analysis::CreatePooledLintRule<T>(rule_pair.first,
+                                          setting.configuration);
+    if (!rule_or.ok()) {
+      std::string error_msg =
+          absl::StrCat(rule_pair.first, " ", rule_or.status().message());
+      return absl::InvalidArgumentError(error_msg);
     }
+    if (*rule_or == nullptr) continue;
 
-    rule_instances.push_back(std::move(rule_ptr));
+    rule_instances.push_back(*std::move(rule_or));
+    if (rule_ids != nullptr) rule_ids->push_back(rule_pair.first);
   }
   return rule_instances;
 }
 
 absl::StatusOr<std::vector<std::unique_ptr<SyntaxTreeLintRule>>>
-LinterConfiguration::CreateSyntaxTreeRules() const {
-  return CreateRules<SyntaxTreeLintRule>(configuration_,
-                                         analysis::CreateSyntaxTreeLintRule);
+LinterConfiguration::CreateSyntaxTreeRules(
+    std::vector<analysis::LintRuleId> *rule_ids) const {
+  return CreateRules<SyntaxTreeLintRule>(configuration_, rule_ids);
 }
 
 absl::StatusOr<std::vector<std::unique_ptr<TokenStreamLintRule>>>
 LinterConfiguration::CreateTokenStreamRules() const {
-  return CreateRules<TokenStreamLintRule>(configuration_,
-                                          analysis::CreateTokenStreamLintRule);
+  return CreateRules<TokenStreamLintRule>(configuration_);
 }
 
 absl::StatusOr<std::vector<std::unique_ptr<LineLintRule>>>
 LinterConfiguration::CreateLineRules() const {
-  return CreateRules<LineLintRule>(configuration_,
-                                   analysis::CreateLineLintRule);
+  return CreateRules<LineLintRule>(configuration_);
 }
 
 absl::StatusOr<std::vector<std::unique_ptr<TextStructureLintRule>>>
 LinterConfiguration::CreateTextStructureRules() const {
-  return CreateRules<TextStructureLintRule>(
-      configuration_, analysis::CreateTextStructureLintRule);
+  return CreateRules<TextStructureLintRule>(configuration_);
 }
 
 bool LinterConfiguration::operator==(const LinterConfiguration &config) const {
   return ActiveRuleIds() == config.ActiveRuleIds();
 }
 
-absl::Status LinterConfiguration::AppendFromFile(
+namespace {
+// Rules of a configuration file, valid as long as the file is unchanged.
+struct CachedRuleBundle {
+  std::filesystem::file_time_type mtime;
+  std::uintmax_t size;
+  RuleBundle rules;
+};
+}  // namespace
+
+// Returns the rules in "config_filename", which is only read and parsed again
+// if it changed since the last call.  That avoids re-parsing the same file
+// for every linted file and every edit in the language server.
+static absl::StatusOr<RuleBundle> ReadRuleBundle(
     absl::string_view config_filename) {
-  // Read local configuration file
-  std::string content;
+  static std::mutex cache_mutex;
+  static auto *cache = new std::map<std::string, CachedRuleBundle, std::less<>>;
+
+  const std::filesystem::path path{std::string(config_filename)};
+  std::error_code err;
+  const auto mtime = std::filesystem::last_write_time(path, err);
+  const std::uintmax_t size = err ? 0 : std::filesystem::file_size(path, err);
+  const bool cacheable = !err;
+  if (cacheable) {
+    const std::lock_guard<std::mutex> lock(cache_mutex);
+    const auto found = cache->find(config_filename);
+    if (found != cache->end() && found->second.mtime == mtime &&
+        found->second.size == size) {
+      return found->second.rules;
+    }
+  }
 
   absl::StatusOr<std::string> config_or =
       verible::file::GetContentAsString(config_filename);
-  if (config_or.ok()) {
-    RuleBundle local_rules_bundle;
-    std::string error;
-    local_rules_bundle.ParseConfiguration(*config_or, '\n', &error);
-    // Log warnings and errors
-    if (!error.empty()) {
-      std::cerr << "Using a partial version from " << config_filename
-                << ". Found the following issues: " << error << "\n";
-    }
+  if (!config_or.ok()) return config_or.status();
+
+  RuleBundle local_rules_bundle;
+  std::string error;
+  local_rules_bundle.ParseConfiguration(*config_or, '\n', &error);
+  // Log warnings and errors
+  if (!error.empty()) {
+    std::cerr << "Using a partial version from " << config_filename
+              << ". Found the following issues: " << error << "\n";
+  }
 
-    UseRuleBundle(local_rules_bundle);
-    return absl::OkStatus();
+  if (cacheable) {
+    const std::lock_guard<std::mutex> lock(cache_mutex);
+    (*cache)[std::string(config_filename)] = {mtime, size, local_rules_bundle};
   }
+  return local_rules_bundle;
+}
 
-  return config_or.status();
+absl::Status LinterConfiguration::AppendFromFile(
+    absl::string_view config_filename) {
+  // Read local configuration file
+  absl::StatusOr<RuleBundle> rules_or = ReadRuleBundle(config_filename);
+  if (!rules_or.ok()) return rules_or.status();
+
+  UseRuleBundle(*rules_or);
+  return absl::OkStatus();
 }
 
 absl::Status LinterConfiguration::ConfigureFromOptions(
@@ -223,9 +223,13 @@ class LinterConfiguration {
   // Return the keys of enabled lint rules, sorted.
   std::set<analysis::LintRuleId> ActiveRuleIds() const;
 
-  // Creates instances of every enabled syntax tree rule
+  // Creates instances of every enabled syntax tree rule.
+  // Like the functions below, this re-uses instances that analyzed earlier
+  // files, see analysis::CreatePooledLintRule().
+  // If not null, "rule_ids" receives the name of each created rule.
   absl::StatusOr<std::vector<std::unique_ptr<verible::SyntaxTreeLintRule>>>
-  CreateSyntaxTreeRules() const;
+  CreateSyntaxTreeRules(
+      std::vector<analysis::LintRuleId> *rule_ids = nullptr) const;
 
   // Creates instances of every enabled token stream rule
   absl::StatusOr<std::vector<std::unique_ptr<verible::TokenStreamLintRule>>>
@@ -46,6 +46,7 @@
 #include "gtest/gtest.h"
 #include "verilog/analysis/default_rules.h"
 #include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_lint_cache.h"
 #include "verilog/analysis/verilog_linter_configuration.h"
 
 namespace verilog {
@@ -191,6 +192,39 @@ TEST_F(LintOneFileTest, LintError) {
   }
 }
 
+TEST_F(LintOneFileTest, CachedResults) {
+  constexpr absl::string_view kTestCases[] = {
+      "task automatic foo;\n"
+      "  $psprintf(\"blah\");\n"  // forbidden function
+      "endtask\n",
+      "module 1;\n",  // syntax error
+      "module m;\nendmodule\n",
+  };
+  const std::string cache_dir = verible::file::JoinPath(
+      testing::TempDir(),
+      verible::file::testing::RandomFileBasename("lint-cache"));
+  VerilogLintCache cache(cache_dir, 1 << 20, "test");
+  for (const auto test_code : kTestCases) {
+    const ScopedTestFile temp_file(testing::TempDir(), test_code);
+    std::string outputs[2];
+    int exit_codes[2];
+    for (int run = 0; run < 2; ++run) {
+      std::ostringstream output;
+      ViolationPrinter violation_printer(&output);
+      exit_codes[run] =
+          LintOneFile(&output, temp_file.filename(), config_,
+                      &violation_printer, true, true, true, false, &cache);
+      outputs[run] = output.str();
+    }
+    // The second run is reported from the cache, just like the first.
+    EXPECT_EQ(exit_codes[0], exit_codes[1]);
+    EXPECT_EQ(outputs[0], outputs[1]);
+  }
+  const VerilogLintCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, std::size(kTestCases));
+  EXPECT_EQ(stats.stores, std::size(kTestCases));
+}
+
 class VerilogLinterTest : public DefaultLinterConfigTestFixture,
                           public testing::Test {
  public:
@@ -229,7 +263,7 @@ class VerilogLinterTest : public DefaultLinterConfigTestFixture,
     const absl::StatusOr<std::vector<verible::LintRuleStatus>> lint_result =
         VerilogLintTextStructure(filename, config_, text_structure);
     verilog::ViolationPrinter violation_printer(&diagnostics);
-    const std::set<verible::LintViolationWithStatus> violations =
+    const std::vector<verible::LintViolationWithStatus> violations =
         GetSortedViolations(lint_result.value());
     violation_printer.HandleViolations(violations, text_structure.Contents(),
                                        filename);
@@ -420,6 +454,76 @@ TEST_F(VerilogLinterTest, MultiByteUTF8CharactersAreOnlyCountedOnce) {
   EXPECT_EQ(diagnostics.second, "");
 }
 
+// Returns the rule name and offset of each violation in "statuses".
+static std::set<std::pair<std::string, int>> ViolationOffsets(
+    const std::vector<verible::LintRuleStatus> &statuses,
+    absl::string_view text) {
+  std::set<std::pair<std::string, int>> offsets;
+  for (const auto &status : statuses) {
+    for (const auto &violation : status.violations) {
+      offsets.emplace(status.lint_rule_name, violation.token.left(text));
+    }
+  }
+  return offsets;
+}
+
+TEST_F(VerilogLinterTest, EditedTextStructureMatchesFullLint) {
+  constexpr absl::string_view kVersions[] = {
+      "task automatic foo;\n"
+      "  $psprintf(\"a\");\n"
+      "endtask\n"
+      "task automatic bar;\n"
+      "  $display(\"b\");\n"
+      "endtask\n",
+      // Edit in the second task.
+      "task automatic foo;\n"
+      "  $psprintf(\"a\");\n"
+      "endtask\n"
+      "task automatic bar;\n"
+      "  $psprintf(\"b\");\n"
+      "endtask\n",
+      // Edit in the first task moves the second.
+      "task automatic foo;\n"
+      "  $display(\"aaa\");\n"
+      "endtask\n"
+      "task automatic bar;\n"
+      "  $psprintf(\"b\");\n"
+      "endtask\n",
+      // Waiver before the second task.
+      "task automatic foo;\n"
+      "  $display(\"aaa\");\n"
+      "endtask\n"
+      "// verilog_lint: waive-start invalid-system-task-function\n"
+      "task automatic bar;\n"
+      "  $psprintf(\"b\");\n"
+      "endtask\n",
+  };
+  std::unique_ptr<VerilogAnalyzer> previous_analyzer;
+  absl::StatusOr<VerilogLintResult> previous;
+  for (absl::string_view text : kVersions) {
+    auto analyzer = std::make_unique<VerilogAnalyzer>(text, "edited.sv");
+    ASSERT_TRUE(analyzer->Analyze().ok()) << text;
+    const auto incremental = VerilogLintEditedTextStructure(
+        "edited.sv", config_, analyzer->Data(),
+        previous_analyzer ? &previous_analyzer->Data() : nullptr,
+        previous_analyzer ? &*previous : nullptr);
+    ASSERT_TRUE(incremental.ok()) << incremental.status();
+    const auto full =
+        VerilogLintTextStructure("edited.sv", config_, analyzer->Data());
+    ASSERT_TRUE(full.ok()) << full.status();
+    EXPECT_EQ(ViolationOffsets(incremental->statuses, text),
+              ViolationOffsets(*full, text))
+        << text;
+    previous_analyzer = std::move(analyzer);
+    previous = incremental;
+  }
+  // The waived violation is still known to item-local rules.
+  EXPECT_EQ(ViolationOffsets(previous->statuses, kVersions[3]).size(), 0);
+  EXPECT_EQ(ViolationOffsets(previous->item_local_statuses, kVersions[3]),
+            (std::set<std::pair<std::string, int>>{
+                {"invalid-system-task-function", 127}}));
+}
+
 TEST(VerilogLinterDocumentationTest, AllRulesHelpDescriptions) {
   std::ostringstream stream;
   verilog::GetLintRuleDescriptionsHelpFlag(&stream, "all");
@@ -511,7 +615,7 @@ class ViolationFixerTest : public testing::Test {
     const absl::StatusOr<std::vector<verible::LintRuleStatus>> lint_result =
         VerilogLintTextStructure(temp_file.filename(), config_, text_structure);
 
-    const std::set<verible::LintViolationWithStatus> violations =
+    const std::vector<verible::LintViolationWithStatus> violations =
         GetSortedViolations(lint_result.value());
     violation_fixer->HandleViolations(violations, text_structure.Contents(),
                                       temp_file.filename());
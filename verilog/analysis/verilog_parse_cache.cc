@@ -0,0 +1,291 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_parse_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
+#include "common/util/file_util.h"
+#include "common/util/logging.h"
+#include "common/util/sha256.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+ABSL_FLAG(std::string, parse_cache_dir, "",
+          "If set, directory to cache the results of lexing and parsing in, "
+          "to only analyze files again that changed since an earlier run.");
+ABSL_FLAG(int64_t, parse_cache_max_mb, 1024,
+          "Maximum size of the --parse_cache_dir in megabytes; the least "
+          "recently used entries are removed beyond that.");
+
+namespace verilog {
+
+namespace fs = std::filesystem;
+
+// Part of the cache key.  Increment whenever lexer or parser change in ways
+// that change their results.  The number of node types changes with most
+// grammar updates and is included as well.
+static constexpr absl::string_view kParserVersion = "1";
+
+static constexpr absl::string_view kEntrySuffix = ".vpc";
+
+// Entries: magic, length of the analyzed text (8 bytes), checksum of the
+// payload (8 bytes), followed by the payload from SerializeAnalysis().
+static constexpr absl::string_view kEntryMagic = "VPC1";
+static constexpr size_t kEntryHeaderSize = 4 + 8 + 8;
+
+// Cache entries are checked for accidental corruption, so a simple
+// checksum is sufficient (FNV-1a).
+static uint64_t Checksum(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static void AppendUint64(uint64_t value, std::string *out) {
+  for (int i = 0; i < 8; ++i) out->push_back((value >> (8 * i)) & 0xff);
+}
+
+static uint64_t Uint64At(absl::string_view data, size_t pos) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+// Returns the payload of "entry", or an error if it is not plausibly the
+// entry of a text of "content_length" bytes.
+static absl::StatusOr<absl::string_view> EntryPayload(absl::string_view entry,
+                                                      size_t content_length) {
+  if (entry.length() < kEntryHeaderSize || entry.substr(0, 4) != kEntryMagic) {
+    return absl::DataLossError("Not a parse cache entry.");
+  }
+  if (Uint64At(entry, 4) != content_length) {
+    return absl::DataLossError("Cached content length differs.");
+  }
+  const absl::string_view payload = entry.substr(kEntryHeaderSize);
+  if (Uint64At(entry, 12) != Checksum(payload)) {
+    return absl::DataLossError("Checksum mismatch.");
+  }
+  return payload;
+}
+
+VerilogParseCache::VerilogParseCache(absl::string_view directory,
+                                     int64_t max_bytes)
+    : directory_(directory), max_bytes_(max_bytes) {
+  if (absl::Status status = verible::file::CreateDir(directory_);
+      !status.ok()) {
+    LOG(WARNING) << "Can't create parse cache directory " << directory_ << ": "
+                 << status.message();
+  }
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator(directory_, error)) {
+    if (entry.path().extension().string() == kEntrySuffix) {
+      total_bytes_ += entry.file_size(error);
+    }
+  }
+}
+
+std::string VerilogParseCache::EntryPath(
+    absl::string_view content, absl::string_view analysis_kind) const {
+  verible::Sha256Context hash;
+  hash.AddInput(absl::StrCat(kParserVersion, ".",
+                             static_cast<int>(NodeEnum::kInvalidTag), "/",
+                             analysis_kind, "/"));
+  hash.AddInput(content);
+  std::string name;
+  for (const uint8_t byte : hash.BuildAndReset()) {
+    absl::StrAppend(&name, absl::Hex(byte, absl::kZeroPad2));
+  }
+  return verible::file::JoinPath(directory_, absl::StrCat(name, kEntrySuffix));
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogParseCache::Lookup(
+    const std::shared_ptr<verible::MemBlock> &content,
+    absl::string_view filename, absl::string_view analysis_kind) {
+  const absl::string_view text = content->AsStringView();
+  const std::string path = EntryPath(text, analysis_kind);
+  std::error_code error;
+  if (!fs::exists(path, error)) {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  absl::StatusOr<std::unique_ptr<VerilogAnalyzer>> restored =
+      absl::NotFoundError("unreadable");
+  auto entry = verible::file::GetContentAsMemBlock(path);
+  if (entry.ok()) {
+    const auto payload = EntryPayload((*entry)->AsStringView(), text.length());
+    restored = payload.ok() ? VerilogAnalyzer::RestoreAnalysis(
+                                  content, filename, *payload)
+                            : payload.status();
+  } else {
+    restored = entry.status();
+  }
+
+  if (!restored.ok()) {
+    LOG(WARNING) << "Removing unusable parse cache entry " << path
+                 << " for " << filename << ": " << restored.status().message();
+    const int64_t size = fs::file_size(path, error);
+    const bool removed = fs::remove(path, error);
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.corrupt_entries;
+    ++stats_.misses;
+    if (removed && size > 0) total_bytes_ -= size;
+    return nullptr;
+  }
+
+  // Mark as recently used for eviction.
+  fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+  std::lock_guard<std::mutex> l(mutex_);
+  ++stats_.hits;
+  VLOG(1) << "Parse cache hit for " << filename << " (" << stats_.hits
+          << " hits, " << stats_.misses << " misses)";
+  return *std::move(restored);
+}
+
+void VerilogParseCache::Store(const VerilogAnalyzer &analyzer,
+                              absl::string_view analysis_kind) {
+  const absl::StatusOr<std::string> payload = analyzer.SerializeAnalysis();
+  if (!payload.ok()) {
+    VLOG(1) << "Not caching analysis of " << analyzer.Data().Contents().length()
+            << " bytes: " << payload.status().message();
+    return;
+  }
+  const absl::string_view text = analyzer.Data().Contents();
+  std::string entry;
+  entry.reserve(kEntryHeaderSize + payload->length());
+  entry.append(kEntryMagic.begin(), kEntryMagic.end());
+  AppendUint64(text.length(), &entry);
+  AppendUint64(Checksum(*payload), &entry);
+  entry.append(*payload);
+
+  // Other processes might read the entry at the same time.
+  const std::string path = EntryPath(text, analysis_kind);
+  const std::string temp_path =
+      absl::StrCat(path, ".", std::random_device()(), ".tmp");
+  std::error_code error;
+  if (absl::Status status = verible::file::SetContents(temp_path, entry);
+      !status.ok()) {
+    LOG(WARNING) << "Can't write parse cache entry: " << status.message();
+    return;
+  }
+  fs::rename(temp_path, path, error);
+  if (error) {
+    LOG(WARNING) << "Can't write parse cache entry " << path << ": "
+                 << error.message();
+    fs::remove(temp_path, error);
+    return;
+  }
+
+  bool evict;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.stores;
+    total_bytes_ += entry.length();
+    evict = total_bytes_ > max_bytes_;
+  }
+  // Make some room, so that not every following store needs to evict.
+  if (evict) Evict(max_bytes_ - max_bytes_ / 10);
+}
+
+void VerilogParseCache::Evict(int64_t target_bytes) {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type last_use;
+    int64_t size;
+  };
+  std::vector<Entry> entries;
+  int64_t total_bytes = 0;
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator(directory_, error)) {
+    if (entry.path().extension().string() != kEntrySuffix) continue;
+    const int64_t size = entry.file_size(error);
+    if (error) continue;
+    entries.push_back({entry.path(), entry.last_write_time(error), size});
+    total_bytes += size;
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) {
+              return a.last_use < b.last_use;
+            });
+  int64_t evictions = 0;
+  for (const Entry &entry : entries) {
+    if (total_bytes <= target_bytes) break;
+    if (fs::remove(entry.path, error)) {
+      total_bytes -= entry.size;
+      ++evictions;
+    }
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  stats_.evictions += evictions;
+  total_bytes_ = total_bytes;  // Also accounts for other processes.
+}
+
+std::unique_ptr<VerilogAnalyzer> VerilogParseCache::Analyze(
+    const std::shared_ptr<verible::MemBlock> &content,
+    absl::string_view filename, absl::string_view analysis_kind,
+    const AnalyzeFun &analyze) {
+  if (auto cached = Lookup(content, filename, analysis_kind)) return cached;
+  auto analyzer = analyze();
+  if (analyzer) Store(*analyzer, analysis_kind);
+  return analyzer;
+}
+
+VerilogParseCache::Stats VerilogParseCache::GetStats() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return stats_;
+}
+
+VerilogParseCache *ParseCacheFromFlags() {
+  static VerilogParseCache *const cache = []() -> VerilogParseCache * {
+    const std::string directory = absl::GetFlag(FLAGS_parse_cache_dir);
+    if (directory.empty()) return nullptr;
+    return new VerilogParseCache(
+        directory, absl::GetFlag(FLAGS_parse_cache_max_mb) * 1024 * 1024);
+  }();
+  return cache;
+}
+
+std::unique_ptr<VerilogAnalyzer> AnalyzeWithParseCache(
+    const std::shared_ptr<verible::MemBlock> &content,
+    absl::string_view filename, absl::string_view analysis_kind,
+    const VerilogParseCache::AnalyzeFun &analyze) {
+  VerilogParseCache *const cache = ParseCacheFromFlags();
+  if (cache == nullptr) return analyze();
+  return cache->Analyze(content, filename, analysis_kind, analyze);
+}
+
+}  // namespace verilog
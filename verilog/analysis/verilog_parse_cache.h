@@ -0,0 +1,113 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_PARSE_CACHE_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_PARSE_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+
+// VerilogParseCache keeps the results of successful analyses as files in a
+// directory, so that unchanged files don't need to be lexed and parsed again
+// by later tool invocations.
+//
+// Entries are keyed by a hash of the analyzed text, the parser version and
+// the kind of analysis, which names the procedure that produced the result
+// (e.g. plain Analyze() with a particular preprocessing configuration, or
+// AnalyzeAutomaticPreprocessFallback()).
+//
+// Entries carry a checksum and are validated when loaded; corrupt entries are
+// removed.  When the total size of the entries exceeds the configured limit,
+// the least recently used ones are evicted.
+//
+// Safe to use from multiple threads, and to share the directory between
+// processes: entries are written to a temporary file first and then renamed.
+class VerilogParseCache {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t stores = 0;
+    int64_t evictions = 0;
+    int64_t corrupt_entries = 0;
+  };
+
+  using AnalyzeFun = std::function<std::unique_ptr<VerilogAnalyzer>()>;
+
+  // Keeps cache entries in "directory", which is created if needed, and
+  // keeps their total size at about "max_bytes".
+  VerilogParseCache(absl::string_view directory, int64_t max_bytes);
+
+  VerilogParseCache(const VerilogParseCache &) = delete;
+  VerilogParseCache &operator=(const VerilogParseCache &) = delete;
+
+  // Returns the analysis of "content" that was stored for "analysis_kind",
+  // or nullptr if there is none.
+  std::unique_ptr<VerilogAnalyzer> Lookup(
+      const std::shared_ptr<verible::MemBlock> &content,
+      absl::string_view filename, absl::string_view analysis_kind);
+
+  // Stores the result of "analyzer" for "analysis_kind", if it is a
+  // successful analysis that can be restored (see
+  // VerilogAnalyzer::SerializeAnalysis()).
+  void Store(const VerilogAnalyzer &analyzer, absl::string_view analysis_kind);
+
+  // Returns the cached analysis of "content", or the result of "analyze",
+  // which is stored for next time.
+  std::unique_ptr<VerilogAnalyzer> Analyze(
+      const std::shared_ptr<verible::MemBlock> &content,
+      absl::string_view filename, absl::string_view analysis_kind,
+      const AnalyzeFun &analyze);
+
+  Stats GetStats() const;
+
+ private:
+  std::string EntryPath(absl::string_view content,
+                        absl::string_view analysis_kind) const;
+
+  // Removes the least recently used entries until their total size is
+  // at most "target_bytes".
+  void Evict(int64_t target_bytes);
+
+  const std::string directory_;
+  const int64_t max_bytes_;
+
+  mutable std::mutex mutex_;
+  Stats stats_;              // guarded by mutex_
+  int64_t total_bytes_ = 0;  // guarded by mutex_
+};
+
+// Returns the process-wide cache in --parse_cache_dir, or nullptr if that
+// flag is not set.
+VerilogParseCache *ParseCacheFromFlags();
+
+// Like VerilogParseCache::Analyze() with ParseCacheFromFlags(), but just
+// returns the result of "analyze" if there is no cache.
+std::unique_ptr<VerilogAnalyzer> AnalyzeWithParseCache(
+    const std::shared_ptr<verible::MemBlock> &content,
+    absl::string_view filename, absl::string_view analysis_kind,
+    const VerilogParseCache::AnalyzeFun &analyze);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_PARSE_CACHE_H_
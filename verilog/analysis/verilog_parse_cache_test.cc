@@ -0,0 +1,167 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_parse_cache.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
+#include "common/text/tree_compare.h"
+#include "common/util/file_util.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+namespace {
+
+namespace fs = std::filesystem;
+
+using verible::file::JoinPath;
+using verible::file::testing::RandomFileBasename;
+
+class VerilogParseCacheTest : public ::testing::Test {
+ protected:
+  VerilogParseCacheTest()
+      : directory_(JoinPath(::testing::TempDir(),
+                            RandomFileBasename("parse-cache"))) {}
+
+  ~VerilogParseCacheTest() override { fs::remove_all(directory_); }
+
+  std::vector<fs::path> Entries() const {
+    std::vector<fs::path> result;
+    for (const auto &entry : fs::directory_iterator(directory_)) {
+      result.push_back(entry.path());
+    }
+    return result;
+  }
+
+  const std::string directory_;
+};
+
+static std::shared_ptr<verible::MemBlock> Text(absl::string_view text) {
+  return std::make_shared<verible::StringMemBlock>(text);
+}
+
+// Counts the analyses that actually ran.
+static VerilogParseCache::AnalyzeFun CountingAnalyze(
+    const std::shared_ptr<verible::MemBlock> &text, int *count) {
+  return [text, count]() {
+    ++*count;
+    auto analyzer = std::make_unique<VerilogAnalyzer>(
+        text, "file.sv", VerilogPreprocess::Config());
+    analyzer->Analyze().IgnoreError();
+    return analyzer;
+  };
+}
+
+TEST_F(VerilogParseCacheTest, MissThenHit) {
+  VerilogParseCache cache(directory_, 1 << 20);
+  const auto text = Text("module m;\n  wire w;\nendmodule\n");
+  int analyses = 0;
+  const auto first =
+      cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  const auto second =
+      cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  EXPECT_EQ(analyses, 1);
+  ASSERT_NE(second, nullptr);
+  EXPECT_TRUE(second->LexStatus().ok());
+  EXPECT_TRUE(second->ParseStatus().ok());
+  EXPECT_EQ(first->Data().TokenStream(), second->Data().TokenStream());
+  EXPECT_TRUE(verible::EqualTrees(first->SyntaxTree().get(),
+                                  second->SyntaxTree().get()));
+
+  const VerilogParseCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.stores, 1);
+}
+
+TEST_F(VerilogParseCacheTest, KeyedByContentAndKind) {
+  VerilogParseCache cache(directory_, 1 << 20);
+  const auto text = Text("module m;\nendmodule\n");
+  const auto other_text = Text("module n;\nendmodule\n");
+  int analyses = 0;
+  cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  cache.Analyze(text, "file.sv", "other", CountingAnalyze(text, &analyses));
+  cache.Analyze(other_text, "file.sv", "test",
+                CountingAnalyze(other_text, &analyses));
+  EXPECT_EQ(analyses, 3);
+  EXPECT_EQ(cache.GetStats().hits, 0);
+  EXPECT_EQ(Entries().size(), 3);
+
+  // Entries are found by a later instance.
+  VerilogParseCache later_cache(directory_, 1 << 20);
+  EXPECT_NE(later_cache.Lookup(other_text, "file.sv", "test"), nullptr);
+}
+
+TEST_F(VerilogParseCacheTest, SyntaxErrorsAreNotStored) {
+  VerilogParseCache cache(directory_, 1 << 20);
+  const auto text = Text("module m;\n  wire 1;\nendmodule\n");
+  int analyses = 0;
+  const auto analyzer =
+      cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  ASSERT_NE(analyzer, nullptr);
+  EXPECT_FALSE(analyzer->ParseStatus().ok());
+  EXPECT_EQ(cache.GetStats().stores, 0);
+  EXPECT_TRUE(Entries().empty());
+}
+
+TEST_F(VerilogParseCacheTest, CorruptEntriesAreRemoved) {
+  VerilogParseCache cache(directory_, 1 << 20);
+  const auto text = Text("module m;\nendmodule\n");
+  int analyses = 0;
+  cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  ASSERT_EQ(Entries().size(), 1);
+
+  const std::string entry = Entries()[0].string();
+  auto content = verible::file::GetContentAsString(entry);
+  ASSERT_TRUE(content.ok());
+  content->back() ^= 1;
+  ASSERT_TRUE(verible::file::SetContents(entry, *content).ok());
+
+  EXPECT_EQ(cache.Lookup(text, "file.sv", "test"), nullptr);
+  EXPECT_EQ(cache.GetStats().corrupt_entries, 1);
+  EXPECT_TRUE(Entries().empty());
+
+  // Analyzed and stored again.
+  cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  EXPECT_EQ(analyses, 2);
+  EXPECT_NE(cache.Lookup(text, "file.sv", "test"), nullptr);
+}
+
+TEST_F(VerilogParseCacheTest, EvictsBeyondMaximumSize) {
+  // Small enough to only keep a few entries.
+  VerilogParseCache cache(directory_, 2000);
+  int analyses = 0;
+  for (int i = 0; i < 20; ++i) {
+    const auto text = Text(absl::StrCat("module m", i, ";\nendmodule\n"));
+    cache.Analyze(text, "file.sv", "test", CountingAnalyze(text, &analyses));
+  }
+  EXPECT_EQ(cache.GetStats().stores, 20);
+  EXPECT_GT(cache.GetStats().evictions, 0);
+  EXPECT_LT(Entries().size(), 20);
+
+  int64_t total_size = 0;
+  for (const fs::path &entry : Entries()) total_size += fs::file_size(entry);
+  EXPECT_LE(total_size, 2000);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -14,9 +14,13 @@
 
 #include "verilog/analysis/verilog_project.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -32,7 +36,10 @@
 #include "common/text/text_structure.h"
 #include "common/util/file_util.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
+#include "common/util/thread_pool.h"
 #include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_parse_cache.h"
 
 namespace verilog {
 
@@ -66,6 +73,29 @@ absl::string_view VerilogSourceFile::GetContent() const {
   return content_ ? content_->AsStringView() : "";
 }
 
+/*static*/ std::unique_ptr<VerilogAnalyzer> VerilogSourceFile::Analyze(
+    const std::shared_ptr<verible::MemBlock> &content,
+    absl::string_view resolved_path, absl::Status *status) {
+  // Lex, parse, populate underlying TextStructureView.  Only successful
+  // analyses are cached, so the status is only set by actual analysis.
+  const absl::Time start = absl::Now();
+  *status = absl::OkStatus();
+  std::unique_ptr<VerilogAnalyzer> result = AnalyzeWithParseCache(
+      content, resolved_path, "project-filter-branches", [&]() {
+        auto analyzer = std::make_unique<VerilogAnalyzer>(
+            content, resolved_path, kPreprocessConfig);
+        *status = analyzer->Analyze();
+        return analyzer;
+      });
+  const absl::Duration analyze_time = absl::Now() - start;
+  if (analyze_time > absl::Milliseconds(500)) {
+    LOG(WARNING) << "Slow Parse " << resolved_path << " took " << analyze_time;
+  } else {
+    VLOG(2) << "Parse " << resolved_path << " in " << analyze_time;
+  }
+  return result;
+}
+
 absl::Status VerilogSourceFile::Parse() {
   // Parsed state is cached.
   if (processing_state_ == ProcessingState::kParsed) return status_;
@@ -74,28 +104,46 @@ absl::Status VerilogSourceFile::Parse() {
   status_ = Open();
   if (!status_.ok()) return status_;
 
-  // Lex, parse, populate underlying TextStructureView.
-  analyzed_structure_ = std::make_unique<VerilogAnalyzer>(
-      content_, ResolvedPath(), kPreprocessConfig);
-
-  const absl::Time start = absl::Now();
-  status_ = analyzed_structure_->Analyze();
-  const absl::Duration analyze_time = absl::Now() - start;
-  if (analyze_time > absl::Milliseconds(500)) {
-    LOG(WARNING) << "Slow Parse " << ResolvedPath() << " took " << analyze_time;
-  } else {
-    VLOG(2) << "Parse " << ResolvedPath() << " in " << analyze_time;
-  }
-
+  analyzed_structure_ = Analyze(content_, ResolvedPath(), &status_);
   processing_state_ = ProcessingState::kParsed;
   return status_;
 }
 
+bool VerilogSourceFile::SetAnalysis(std::unique_ptr<VerilogAnalyzer> analyzed,
+                                    const absl::Status &status) {
+  if (processing_state_ != ProcessingState::kOpened) return false;
+  analyzed_structure_ = std::move(analyzed);
+  status_ = status;
+  processing_state_ = ProcessingState::kParsed;
+  return true;
+}
+
 const verible::TextStructureView *VerilogSourceFile::GetTextStructure() const {
   if (analyzed_structure_ == nullptr) return nullptr;
   return &analyzed_structure_->Data();
 }
 
+size_t VerilogSourceFile::TokenStreamMemoryUsage() const {
+  if (analyzed_structure_ == nullptr) return 0;
+  return analyzed_structure_->Data().TokenStreamMemoryUsage();
+}
+
+verible::MemoryUsage VerilogSourceFile::MemoryUsage() const {
+  if (analyzed_structure_ != nullptr) return analyzed_structure_->MemoryUsage();
+  verible::MemoryUsage usage;
+  // The analysis shares the contents, so they are only counted here before
+  // parsing.
+  if (content_ != nullptr) {
+    usage.Add("contents", content_->AsStringView().size());
+  }
+  return usage;
+}
+
+void VerilogSourceFile::ReleaseTokenStream() {
+  if (analyzed_structure_ == nullptr) return;
+  analyzed_structure_->MutableData().ReleaseTokenStream();
+}
+
 std::vector<std::string> VerilogSourceFile::ErrorMessages() const {
   std::vector<std::string> result;
   if (!analyzed_structure_) return result;
@@ -118,40 +166,47 @@ std::ostream &operator<<(std::ostream &stream,
   return stream;
 }
 
+std::vector<VerilogProject::ContentToFileIndex::ContentRange>::const_iterator
+VerilogProject::ContentToFileIndex::FirstRangeAfter(const char *address) const {
+  return std::upper_bound(
+      ranges_.begin(), ranges_.end(), address,
+      [](const char *a, const ContentRange &r) { return a < r.begin; });
+}
+
 void VerilogProject::ContentToFileIndex::Register(
     const VerilogSourceFile *file) {
   CHECK(file);
   const absl::string_view content = file->GetContent();
-  string_view_map_.must_emplace(content);
-  const auto map_inserted =
-      buffer_to_analyzer_map_.emplace(content.begin(), file);
-  CHECK(map_inserted.second);
+  const ContentRange range{content.data(), content.data() + content.size(),
+                           file};
+  const auto next = FirstRangeAfter(range.begin);
+  CHECK(next == ranges_.end() || range.end <= next->begin)
+      << "Overlapping file contents";
+  CHECK(next == ranges_.begin() || std::prev(next)->end <= range.begin)
+      << "Overlapping file contents";
+  ranges_.insert(next, range);
 }
 
 void VerilogProject::ContentToFileIndex::Unregister(
     const VerilogSourceFile *file) {
   CHECK(file);
-  const absl::string_view content = file->GetContent();
-  auto full_content_found = string_view_map_.find(content);
-  if (full_content_found != string_view_map_.end()) {
-    string_view_map_.erase(full_content_found);
-  }
-  buffer_to_analyzer_map_.erase(content.begin());
+  const auto next = FirstRangeAfter(file->GetContent().data());
+  if (next == ranges_.begin()) return;
+  const auto found = std::prev(next);
+  if (found->file == file) ranges_.erase(found);
 }
 
 const VerilogSourceFile *VerilogProject::ContentToFileIndex::Lookup(
     absl::string_view content_substring) const {
-  // Look for corresponding source text (superstring) buffer start.
-  const auto found_superstring = string_view_map_.find(content_substring);
-  if (found_superstring == string_view_map_.end()) return nullptr;
-  const absl::string_view::const_iterator buffer_start =
-      found_superstring->first;
-
-  // Reverse-lookup originating file based on buffer start.
-  const auto found_file = buffer_to_analyzer_map_.find(buffer_start);
-  if (found_file == buffer_to_analyzer_map_.end()) return nullptr;
-
-  return found_file->second;
+  // The last range starting at or before the substring is the only one
+  // that can contain it.
+  const auto next = FirstRangeAfter(content_substring.data());
+  if (next == ranges_.begin()) return nullptr;
+  const ContentRange &range = *std::prev(next);
+  if (content_substring.data() + content_substring.size() > range.end) {
+    return nullptr;
+  }
+  return range.file;
 }
 
 absl::StatusOr<VerilogSourceFile *> VerilogProject::OpenFile(
@@ -182,6 +237,30 @@ bool VerilogProject::RemoveByName(const std::string &filename) {
   return true;
 }
 
+std::vector<absl::Status> VerilogProject::ParseFiles(int threads) {
+  std::vector<VerilogSourceFile *> to_parse;
+  for (auto &file : files_) {
+    if (!file.second->is_parsed()) to_parse.push_back(file.second.get());
+  }
+  std::vector<absl::Status> results;
+  results.reserve(to_parse.size());
+  if (threads <= 0) {
+    for (VerilogSourceFile *file : to_parse) results.push_back(file->Parse());
+    return results;
+  }
+
+  // Files only modify their own state while parsing.
+  verible::ThreadPool pool(threads);
+  std::vector<std::future<absl::Status>> parsed;
+  parsed.reserve(to_parse.size());
+  for (VerilogSourceFile *file : to_parse) {
+    parsed.push_back(
+        pool.ExecAsync<absl::Status>([file]() { return file->Parse(); }));
+  }
+  for (auto &status : parsed) results.push_back(status.get());
+  return results;
+}
+
 // TODO: explain better in the header what happens with includes.
 bool VerilogProject::RemoveRegisteredFile(
     absl::string_view referenced_filename) {
@@ -212,7 +291,8 @@ std::string VerilogProject::GetRelativePathToSource(
 }
 
 void VerilogProject::UpdateFileContents(
-    absl::string_view path, const verilog::VerilogAnalyzer *parsed) {
+    absl::string_view path,
+    std::shared_ptr<const verilog::VerilogAnalyzer> parsed) {
   constexpr absl::string_view kCorpus = "";
   const std::string projectpath = GetRelativePathToSource(path);
 
@@ -221,8 +301,8 @@ void VerilogProject::UpdateFileContents(
   std::unique_ptr<VerilogSourceFile> source_file;
   bool do_register_content = true;
   if (parsed) {
-    source_file = std::make_unique<ParsedVerilogSourceFile>(projectpath, path,
-                                                            *parsed, kCorpus);
+    source_file = std::make_unique<ParsedVerilogSourceFile>(
+        projectpath, path, std::move(parsed), kCorpus);
   } else {
     source_file =
         std::make_unique<VerilogSourceFile>(projectpath, path, kCorpus);
@@ -302,6 +382,74 @@ absl::StatusOr<VerilogSourceFile *> VerilogProject::OpenTranslationUnit(
   return OpenFile(referenced_filename, resolved_filename, Corpus());
 }
 
+std::vector<absl::StatusOr<VerilogSourceFile *>>
+VerilogProject::OpenTranslationUnits(
+    const std::vector<std::string> &referenced_filenames, int threads) {
+  std::vector<absl::StatusOr<VerilogSourceFile *>> results;
+  results.reserve(referenced_filenames.size());
+  if (threads <= 0) {
+    for (const auto &referenced_filename : referenced_filenames) {
+      results.push_back(OpenTranslationUnit(referenced_filename));
+    }
+    return results;
+  }
+
+  // Only the calling thread modifies files_: register all new entries first,
+  // so that duplicates in the list refer to the same file.
+  const auto find_file = [this](absl::string_view name) -> VerilogSourceFile * {
+    const auto found = files_.find(name);
+    return found == files_.end() ? nullptr : found->second.get();
+  };
+  std::vector<VerilogSourceFile *> entries;
+  std::vector<VerilogSourceFile *> to_open;
+  entries.reserve(referenced_filenames.size());
+  for (const auto &referenced_filename : referenced_filenames) {
+    VerilogSourceFile *file = find_file(referenced_filename);
+    if (file == nullptr) {
+      const std::string resolved_filename =
+          verible::file::JoinPath(TranslationUnitRoot(), referenced_filename);
+      file = find_file(resolved_filename);
+      if (file == nullptr) {
+        file = files_
+                   .emplace(referenced_filename,
+                            std::make_unique<VerilogSourceFile>(
+                                referenced_filename, resolved_filename,
+                                Corpus()))
+                   .first->second.get();
+        to_open.push_back(file);
+      }
+    }
+    entries.push_back(file);
+  }
+
+  // Files only modify their own state while reading their contents.
+  {
+    verible::ThreadPool pool(threads);
+    std::vector<std::future<absl::Status>> opened;
+    opened.reserve(to_open.size());
+    for (VerilogSourceFile *file : to_open) {
+      opened.push_back(
+          pool.ExecAsync<absl::Status>([file]() { return file->Open(); }));
+    }
+    for (auto &status : opened) status.wait();
+  }
+
+  if (content_index_) {
+    for (VerilogSourceFile *file : to_open) {
+      if (file->Status().ok()) content_index_->Register(file);
+    }
+  }
+
+  for (VerilogSourceFile *file : entries) {
+    if (absl::Status status = file->Status(); !status.ok()) {
+      results.push_back(status);
+    } else {
+      results.push_back(file);
+    }
+  }
+  return results;
+}
+
 absl::Status VerilogProject::IncludeFileNotFoundError(
     absl::string_view referenced_filename) const {
   return absl::NotFoundError(
@@ -334,7 +482,7 @@ absl::StatusOr<VerilogSourceFile *> VerilogProject::OpenIncludedFile(
   for (const auto &include_path : include_paths_) {
     const std::string resolved =
         verible::file::JoinPath(include_path, referenced_filename);
-    if (verible::file::FileExists(resolved).ok()) {
+    if (IncludeDirectoryHasFile(resolved)) {
       VLOG(2) << referenced_filename << " in incdir '" << resolved << "'";
       return OpenFile(referenced_filename, resolved, Corpus());
     }
@@ -351,6 +499,24 @@ absl::StatusOr<VerilogSourceFile *> VerilogProject::OpenIncludedFile(
   return inserted.first->second->Status();
 }
 
+bool VerilogProject::IncludeDirectoryHasFile(absl::string_view resolved) {
+  const std::filesystem::path path(std::string{resolved});
+  const std::string directory = path.parent_path().string();
+  auto found = include_directory_files_.find(directory);
+  if (found == include_directory_files_.end()) {
+    // List each directory once, instead of checking every file in it.  A
+    // directory that can't be listed has no files.
+    std::set<std::string, std::less<>> files;
+    if (auto listing = verible::file::ListDir(directory); listing.ok()) {
+      for (const std::string &file : listing->files) {
+        files.emplace(verible::file::Basename(file));
+      }
+    }
+    found = include_directory_files_.emplace(directory, std::move(files)).first;
+  }
+  return found->second.find(path.filename().string()) != found->second.end();
+}
+
 void VerilogProject::AddVirtualFile(absl::string_view resolved_filename,
                                     absl::string_view content) {
   const auto inserted = files_.emplace(
@@ -366,6 +532,15 @@ void VerilogProject::AddVirtualFile(absl::string_view resolved_filename,
   }
 }
 
+verible::MemoryUsage VerilogProject::MemoryUsage() const {
+  verible::MemoryUsage usage;
+  for (const auto &file : files_) usage.Add("", file.second->MemoryUsage());
+  if (content_index_) {
+    usage.Add("content_index", content_index_->MemoryUsage());
+  }
+  return usage;
+}
+
 const VerilogSourceFile *VerilogProject::LookupFileOrigin(
     absl::string_view content_substring) const {
   CHECK(content_index_) << "LookupFileOrigin() not enabled in constructor";
@@ -16,10 +16,12 @@
 #define VERIBLE_VERILOG_ANALYSIS_VERILOG_PROJECT_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,8 +31,8 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "common/strings/mem_block.h"
-#include "common/strings/string_memory_map.h"
 #include "common/text/text_structure.h"
+#include "common/util/memory_usage.h"
 #include "verilog/analysis/verilog_analyzer.h"
 
 namespace verilog {
@@ -78,10 +80,43 @@ class VerilogSourceFile {
     return processing_state_ >= ProcessingState::kParsed;
   }
 
+  // Analyzes "content" of the file at "resolved_path" like Parse() does,
+  // but without touching any VerilogSourceFile, so that it can be done on
+  // another thread while the file is in use. Stores the analysis status in
+  // "status".
+  static std::unique_ptr<VerilogAnalyzer> Analyze(
+      const std::shared_ptr<verible::MemBlock> &content,
+      absl::string_view resolved_path, absl::Status *status);
+
+  // Returns the content loaded by Open(), or nullptr.
+  std::shared_ptr<verible::MemBlock> GetContentBlock() const {
+    return content_;
+  }
+
+  // Completes Parse() with the result of Analyze() on GetContentBlock().
+  // Returns false and drops the result if the file is not opened (and not
+  // parsed yet).
+  bool SetAnalysis(std::unique_ptr<VerilogAnalyzer> analyzed,
+                   const absl::Status &status);
+
   // After Parse(), text structure may contain other analyzed structural forms.
   // Before successful Parse(), this is not initialized and returns nullptr.
   virtual const verible::TextStructureView *GetTextStructure() const;
 
+  // Returns the estimated number of bytes that ReleaseTokenStream() would
+  // free.
+  size_t TokenStreamMemoryUsage() const;
+
+  // Returns the estimated number of bytes held by this file: its contents
+  // and, once parsed, its analysis (see VerilogAnalyzer::MemoryUsage()).
+  virtual verible::MemoryUsage MemoryUsage() const;
+
+  // Drops the token stream of the text structure owned by this file, see
+  // TextStructureView::ReleaseTokenStream().  The syntax tree and contents
+  // are kept.  Text structures shared with others, like the one of a
+  // ParsedVerilogSourceFile, are not affected.
+  void ReleaseTokenStream();
+
   // Returns the first non-Ok status if there is one, else OkStatus().
   absl::Status Status() const { return status_; }
 
@@ -207,10 +242,24 @@ class ParsedVerilogSourceFile final : public VerilogSourceFile {
                           absl::string_view resolved_path,
                           const verilog::VerilogAnalyzer &analyzer,
                           absl::string_view corpus = "")
+      : ParsedVerilogSourceFile(
+            referenced_path, resolved_path,
+            // Non-owning: aliases an empty shared pointer.
+            std::shared_ptr<const verilog::VerilogAnalyzer>(
+                std::shared_ptr<const verilog::VerilogAnalyzer>(), &analyzer),
+            corpus) {}
+
+  // Like above, but shares ownership of "analyzer", so that it is kept
+  // alive as long as this file is, e.g. with the editor buffer version
+  // that it was parsed from.
+  ParsedVerilogSourceFile(
+      absl::string_view referenced_path, absl::string_view resolved_path,
+      std::shared_ptr<const verilog::VerilogAnalyzer> analyzer,
+      absl::string_view corpus = "")
       : VerilogSourceFile(referenced_path, resolved_path, corpus),
-        not_owned_analyzer_(&analyzer) {
+        analyzer_(std::move(analyzer)) {
     processing_state_ = ProcessingState::kParsed;  // Advance to full parsed.
-    status_ = analyzer.ParseStatus();
+    status_ = analyzer_->ParseStatus();
   }
 
   // Do nothing (file contents already loaded)
@@ -221,18 +270,21 @@ class ParsedVerilogSourceFile final : public VerilogSourceFile {
 
   // Return TextStructureView provided previously in constructor
   const verible::TextStructureView *GetTextStructure() const final {
-    return &not_owned_analyzer_->Data();
+    return &analyzer_->Data();
   }
 
   // Return string-view content range of text structure.
   absl::string_view GetContent() const final {
-    return not_owned_analyzer_->Data().Contents();
+    return analyzer_->Data().Contents();
+  }
+
+  // Counts the shared analysis, even though it is also held elsewhere.
+  verible::MemoryUsage MemoryUsage() const final {
+    return analyzer_->MemoryUsage();
   }
 
  private:
-  // TODO: make some sort of owned/non-owned version so that we don't have
-  // two different types.
-  const verilog::VerilogAnalyzer *const not_owned_analyzer_;
+  const std::shared_ptr<const verilog::VerilogAnalyzer> analyzer_;
 };
 
 // VerilogProject represents a set of files as a cohesive unit of compilation.
@@ -287,6 +339,12 @@ class VerilogProject {
   absl::StatusOr<VerilogSourceFile *> OpenTranslationUnit(
       absl::string_view referenced_filename);
 
+  // Opens several translation units like OpenTranslationUnit(), reading their
+  // contents concurrently on "threads" threads, or in the calling thread if
+  // that is 0.  Returns the results in the order of "referenced_filenames".
+  std::vector<absl::StatusOr<VerilogSourceFile *>> OpenTranslationUnits(
+      const std::vector<std::string> &referenced_filenames, int threads);
+
   // Opens a file that was `included.
   // If the file was previously opened, that data is returned.
   absl::StatusOr<VerilogSourceFile *> OpenIncludedFile(
@@ -307,6 +365,11 @@ class VerilogProject {
   // the file was removed.
   bool RemoveRegisteredFile(absl::string_view referenced_filename);
 
+  // Parses all registered files that are not parsed yet, concurrently on
+  // "threads" threads, or in the calling thread if that is 0.  Returns the
+  // parse statuses in iteration order.
+  std::vector<absl::Status> ParseFiles(int threads);
+
   // Non-modifying variant of lookup.
   const VerilogSourceFile *LookupRegisteredFile(
       absl::string_view referenced_filename) const {
@@ -323,13 +386,14 @@ class VerilogProject {
 
   // Updates file from external source with an already parsed content.
   // (e.g. Language Server).
-  // "parsed" needs to be a VerilogAnalyzer that is valid until the given
-  // path is removed.
+  // The project shares ownership of "parsed" until the given path is
+  // updated again or removed, so the parse is not repeated for the project.
   // If "parsed" is nullptr, the old parsed file is removed and replaced
   // with a standard VerilogSourceFile, reading from a filesystem.
   // (TODO: this is a fairly specific functionality; make this composed).
-  void UpdateFileContents(absl::string_view path,
-                          const verilog::VerilogAnalyzer *parsed);
+  void UpdateFileContents(
+      absl::string_view path,
+      std::shared_ptr<const verilog::VerilogAnalyzer> parsed);
 
   // Adds include directory to the project
   void AddIncludePath(absl::string_view includepath) {
@@ -340,6 +404,15 @@ class VerilogProject {
     }
   }
 
+  // Returns the estimated number of bytes held by all files, summed per
+  // component, and by the index for LookupFileOrigin().
+  verible::MemoryUsage MemoryUsage() const;
+
+  // Forgets the cached listings of the include directories, e.g. after files
+  // were added or removed in them.  Included files that were already looked
+  // up keep their status.
+  void ClearIncludeDirectoryCache() { include_directory_files_.clear(); }
+
  private:
   absl::StatusOr<VerilogSourceFile *> OpenFile(
       absl::string_view referenced_filename,
@@ -358,6 +431,10 @@ class VerilogProject {
   absl::optional<absl::StatusOr<VerilogSourceFile *>> FindOpenedFile(
       absl::string_view filename) const;
 
+  // Tells whether the "resolved" path of an included file exists, from a
+  // cached listing of its directory.
+  bool IncludeDirectoryHasFile(absl::string_view resolved);
+
   // Attempt to remove file and metadata if it exists. Return 'true' on success.
   bool RemoveByName(const std::string &filename);
 
@@ -374,6 +451,12 @@ class VerilogProject {
   // These can be absolute, or relative to the process's working directory.
   std::vector<std::string> include_paths_;
 
+  // Names of the files in the directories searched for `included files,
+  // by directory path.  Listed on first use, so that looking up a name in
+  // many include directories does not check each of them on the filesystem.
+  std::map<std::string, std::set<std::string, std::less<>>, std::less<>>
+      include_directory_files_;
+
   // Set of opened files, keyed by referenced (not resolved) filename.
   NameToFileMap files_;
 
@@ -391,16 +474,26 @@ class VerilogProject {
     // corresponding file or nullptr if none of the files contains that range.
     const VerilogSourceFile *Lookup(absl::string_view content_substring) const;
 
+    // Returns the number of bytes held by the index.
+    size_t MemoryUsage() const {
+      return ranges_.capacity() * sizeof(ContentRange);
+    }
+
    private:
-    // Maps any string_view (substring) to its full source file text
-    // (superstring).
-    verible::StringViewSuperRangeMap string_view_map_;
-
-    // Maps start of text buffer to its corresponding analyzer object.
-    // key: the starting address of a string buffer belonging to an opened file.
-    //   This can come from the .begin() of any entry in string_view_map_.
-    std::map<absl::string_view::const_iterator, const VerilogSourceFile *>
-        buffer_to_analyzer_map_;
+    // Memory range of an indexed file's content.
+    struct ContentRange {
+      const char *begin;
+      const char *end;
+      const VerilogSourceFile *file;
+    };
+
+    // Returns the first range that starts after "address".
+    std::vector<ContentRange>::const_iterator FirstRangeAfter(
+        const char *address) const;
+
+    // Disjoint content ranges, sorted by their start address, so that a
+    // lookup is a single binary search over contiguous memory.
+    std::vector<ContentRange> ranges_;
   };
 
   std::optional<ContentToFileIndex> content_index_;
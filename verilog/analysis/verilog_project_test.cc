@@ -14,6 +14,7 @@
 
 #include "verilog/analysis/verilog_project.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -26,6 +27,7 @@
 #include "common/text/text_structure.h"
 #include "common/util/file_util.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
 #include "common/util/range.h"
 #include "gtest/gtest.h"
 #include "verilog/CST/module.h"
@@ -109,6 +111,41 @@ TEST(VerilogSourceFileTest, ParseValidFile) {
   EXPECT_EQ(&text_structure->SyntaxTree(), tree);
 }
 
+TEST(VerilogSourceFileTest, ReleaseTokenStream) {
+  constexpr absl::string_view text("localparam int p = 1;\n");
+  TempDirFile tf(text);
+  VerilogSourceFile file(Basename(tf.filename()), tf.filename(), "");
+  EXPECT_EQ(file.TokenStreamMemoryUsage(), 0);  // Not parsed yet.
+  EXPECT_TRUE(file.Parse().ok());
+  EXPECT_GT(file.TokenStreamMemoryUsage(), 0);
+
+  file.ReleaseTokenStream();
+  EXPECT_EQ(file.TokenStreamMemoryUsage(), 0);
+  const TextStructureView *text_structure =
+      ABSL_DIE_IF_NULL(file.GetTextStructure());
+  EXPECT_TRUE(text_structure->TokenStream().empty());
+  EXPECT_EQ(text_structure->Contents(), text);
+  EXPECT_NE(text_structure->SyntaxTree(), nullptr);
+}
+
+TEST(VerilogSourceFileTest, MemoryUsage) {
+  constexpr absl::string_view text("localparam int p = 1;\n");
+  TempDirFile tf(text);
+  VerilogSourceFile file(Basename(tf.filename()), tf.filename(), "");
+  EXPECT_EQ(file.MemoryUsage().Total(), 0);  // Not opened yet.
+  EXPECT_TRUE(file.Open().ok());
+  EXPECT_EQ(file.MemoryUsage().Total(), text.size());
+
+  EXPECT_TRUE(file.Parse().ok());
+  const verible::MemoryUsage usage = file.MemoryUsage();
+  EXPECT_EQ(usage.Components().at("contents"), text.size());
+  EXPECT_GT(usage.Components().at("tokens"), 0);
+  EXPECT_GT(usage.Components().at("syntax_tree"), 0);
+
+  file.ReleaseTokenStream();
+  EXPECT_EQ(file.MemoryUsage().Components().at("tokens"), 0);
+}
+
 TEST(VerilogSourceFileTest, ParseInvalidFile) {
   constexpr absl::string_view text("localparam 1 = p;\n");
   TempDirFile tf(text);
@@ -135,6 +172,41 @@ TEST(VerilogSourceFileTest, ParseInvalidFile) {
   EXPECT_EQ(&text_structure->SyntaxTree(), tree);
 }
 
+TEST(VerilogSourceFileTest, SetAnalysisFromElsewhere) {
+  constexpr absl::string_view text("localparam int p = 1;\n");
+  TempDirFile tf(text);
+  const absl::string_view basename(Basename(tf.filename()));
+  VerilogSourceFile file(basename, tf.filename(), "");
+
+  // Not opened yet, so there is nothing to analyze.
+  EXPECT_EQ(file.GetContentBlock(), nullptr);
+  EXPECT_FALSE(file.SetAnalysis(nullptr, absl::OkStatus()));
+
+  ASSERT_TRUE(file.Open().ok());
+  const std::shared_ptr<verible::MemBlock> content = file.GetContentBlock();
+  ASSERT_NE(content, nullptr);
+  absl::Status status;
+  std::unique_ptr<VerilogAnalyzer> analyzed =
+      VerilogSourceFile::Analyze(content, file.ResolvedPath(), &status);
+  EXPECT_TRUE(status.ok());
+  const VerilogAnalyzer *const expected = analyzed.get();
+  EXPECT_FALSE(file.is_parsed());
+
+  EXPECT_TRUE(file.SetAnalysis(std::move(analyzed), status));
+  EXPECT_TRUE(file.is_parsed());
+  EXPECT_TRUE(file.Status().ok());
+  EXPECT_EQ(file.GetTextStructure(), &expected->Data());
+  EXPECT_EQ(file.GetTextStructure()->Contents(), text);
+
+  // Parsing doesn't change anything, nor does another analysis.
+  EXPECT_TRUE(file.Parse().ok());
+  EXPECT_EQ(file.GetTextStructure(), &expected->Data());
+  EXPECT_FALSE(file.SetAnalysis(
+      VerilogSourceFile::Analyze(content, file.ResolvedPath(), &status),
+      status));
+  EXPECT_EQ(file.GetTextStructure(), &expected->Data());
+}
+
 TEST(VerilogSourceFileTest, StreamPrint) {
   constexpr absl::string_view text("localparam foo = bar;\n");
   TempDirFile tf(text);
@@ -286,6 +358,32 @@ TEST(VerilogProjectTest, NonexistentFileLookup) {
   }
 }
 
+TEST(VerilogProjectTest, MemoryUsageSumsFiles) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string project_root_dir = JoinPath(tempdir, "memory_usage");
+  EXPECT_TRUE(CreateDir(project_root_dir).ok());
+  VerilogProject project(project_root_dir, {});
+  constexpr absl::string_view text1("module foo;\nendmodule\n");
+  constexpr absl::string_view text2("module barbaz;\nendmodule\n");
+  const ScopedTestFile tf1(project_root_dir, text1);
+  const ScopedTestFile tf2(project_root_dir, text2);
+  ASSERT_TRUE(project.OpenTranslationUnit(Basename(tf1.filename())).ok());
+  ASSERT_TRUE(project.OpenTranslationUnit(Basename(tf2.filename())).ok());
+  for (const absl::Status &status : project.ParseFiles(0)) {
+    EXPECT_TRUE(status.ok()) << status;
+  }
+
+  const verible::MemoryUsage usage = project.MemoryUsage();
+  EXPECT_EQ(usage.Components().at("contents"), text1.size() + text2.size());
+  EXPECT_GT(usage.Components().at("content_index"), 0);
+  size_t files_total = 0;
+  for (const auto &file : project) {
+    files_total += file.second->MemoryUsage().Total();
+  }
+  EXPECT_EQ(usage.Total(),
+            files_total + usage.Components().at("content_index"));
+}
+
 TEST(VerilogProjectTest, UpdateFileContents) {
   // The update file content is used typically by the language server.
   // By default, we load a file from the filesystem unless we get it from the
@@ -308,9 +406,10 @@ TEST(VerilogProjectTest, UpdateFileContents) {
 
   // Push a local analyzed name under the name of the file.
   constexpr absl::string_view external_content("localparam int p = 1;\n");
-  std::unique_ptr<VerilogAnalyzer> analyzed_structure =
-      std::make_unique<VerilogAnalyzer>(external_content, "internal");
-  project.UpdateFileContents(tf.filename(), analyzed_structure.get());
+  std::shared_ptr<VerilogAnalyzer> analyzed_structure =
+      std::make_shared<VerilogAnalyzer>(external_content, "internal");
+  project.UpdateFileContents(tf.filename(), analyzed_structure);
+  analyzed_structure.reset();  // The project keeps it alive.
 
   // Look up the file and see that content is the external content
   from_file = *project.OpenTranslationUnit(reference_name);
@@ -352,9 +451,9 @@ TEST(VerilogProjectTest, UpdateFileContentsEmptyFile) {
 
   // Push a local analyzed name under the name of the file.
   constexpr absl::string_view external_content("localparam int p = 1;\n");
-  std::unique_ptr<VerilogAnalyzer> analyzed_structure =
-      std::make_unique<VerilogAnalyzer>(external_content, "internal");
-  project.UpdateFileContents(tf.filename(), analyzed_structure.get());
+  const auto analyzed_structure =
+      std::make_shared<VerilogAnalyzer>(external_content, "internal");
+  project.UpdateFileContents(tf.filename(), analyzed_structure);
 
   // Look up the file and see that content is the external content
   VerilogSourceFile *from_file;
@@ -373,10 +472,9 @@ TEST(VerilogProjectTest, UpdateFileContentsEmptyFile) {
       Basename(empty_file.filename());
 
   // Push the empty file into the project
-  std::unique_ptr<VerilogAnalyzer> analyzed_empty_structure =
-      std::make_unique<VerilogAnalyzer>(empty_file_content, "internal");
-  project.UpdateFileContents(empty_file.filename(),
-                             analyzed_empty_structure.get());
+  const auto analyzed_empty_structure =
+      std::make_shared<VerilogAnalyzer>(empty_file_content, "internal");
+  project.UpdateFileContents(empty_file.filename(), analyzed_empty_structure);
 
   // Check the content from the two files are present
   from_file = *project.OpenTranslationUnit(reference_name);
@@ -436,6 +534,12 @@ TEST(VerilogProjectTest, LookupFileOriginTest) {
             verilog_source_file);
   EXPECT_EQ(project.LookupFileOrigin(content2.substr(9, 4)),
             verilog_source_file2);
+  EXPECT_EQ(project.LookupFileOrigin(content2), verilog_source_file2);
+
+  // Ranges extending past a file's content are not from that file.
+  EXPECT_EQ(project.LookupFileOrigin(
+                absl::string_view(content1.data(), content1.size() + 1)),
+            nullptr);
 }
 
 TEST(VerilogProjectTest, LookupFileOriginTestMoreFiles) {
@@ -569,6 +673,39 @@ TEST(VerilogProjectTest, ValidIncludeFile) {
   EXPECT_FALSE(verilog_source_file->GetContent().empty());
 }
 
+TEST(VerilogProjectTest, IncludeFileInLaterIncludeDirectory) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, "srcs_many_incdirs");
+  const std::string includes_dir1 = JoinPath(tempdir, "includes1");
+  const std::string includes_dir2 = JoinPath(tempdir, "includes2");
+  const std::string includes_subdir = JoinPath(includes_dir2, "sub");
+  EXPECT_TRUE(CreateDir(sources_dir).ok());
+  EXPECT_TRUE(CreateDir(includes_dir1).ok());
+  EXPECT_TRUE(CreateDir(includes_dir2).ok());
+  EXPECT_TRUE(CreateDir(includes_subdir).ok());
+  VerilogProject project(sources_dir, {includes_dir1, includes_dir2});
+
+  const ScopedTestFile tf(includes_dir2, "`define FOO 1\n");
+  const auto status_or_file = project.OpenIncludedFile(Basename(tf.filename()));
+  ASSERT_TRUE(status_or_file.ok()) << status_or_file.status();
+  EXPECT_EQ((*status_or_file)->ResolvedPath(), tf.filename());
+
+  const ScopedTestFile sub_tf(includes_subdir, "`define BAR 1\n");
+  const std::string sub_name = JoinPath("sub", Basename(sub_tf.filename()));
+  const auto status_or_sub_file = project.OpenIncludedFile(sub_name);
+  ASSERT_TRUE(status_or_sub_file.ok()) << status_or_sub_file.status();
+  EXPECT_EQ((*status_or_sub_file)->ResolvedPath(), sub_tf.filename());
+
+  // Files created after their directory was listed are found once the
+  // listings are forgotten.
+  const ScopedTestFile new_tf(includes_dir1, "`define BAZ 1\n");
+  project.ClearIncludeDirectoryCache();
+  const auto status_or_new_file =
+      project.OpenIncludedFile(Basename(new_tf.filename()));
+  ASSERT_TRUE(status_or_new_file.ok()) << status_or_new_file.status();
+  EXPECT_EQ((*status_or_new_file)->ResolvedPath(), new_tf.filename());
+}
+
 TEST(VerilogProjectTest, OpenVirtualIncludeFile) {
   const auto tempdir = ::testing::TempDir();
   const std::string sources_dir = JoinPath(tempdir, "srcs");
@@ -677,5 +814,76 @@ TEST(VerilogProjectTest, AddVirtualFile) {
   EXPECT_EQ(stored_file->GetContent(), file_content);
 }
 
+TEST(VerilogProjectTest, ParseFilesConcurrently) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, "parse_files");
+  EXPECT_TRUE(CreateDir(sources_dir).ok());
+  VerilogProject project(sources_dir, {});
+
+  std::vector<std::unique_ptr<ScopedTestFile>> files;
+  for (int i = 0; i < 20; ++i) {
+    // Every third file has a syntax error.
+    files.push_back(std::make_unique<ScopedTestFile>(
+        sources_dir, absl::StrCat("module m", i, (i % 3 == 0) ? "(" : ";",
+                                  "\nendmodule\n")));
+    ASSERT_TRUE(
+        project.OpenTranslationUnit(Basename(files.back()->filename())).ok());
+  }
+
+  const std::vector<absl::Status> statuses = project.ParseFiles(4);
+  ASSERT_EQ(statuses.size(), files.size());
+  int index = 0;
+  for (const auto &file : project) {
+    EXPECT_TRUE(file.second->is_parsed());
+    EXPECT_EQ(statuses[index].ok(), file.second->Status().ok());
+    ++index;
+  }
+  EXPECT_EQ(std::count_if(statuses.begin(), statuses.end(),
+                          [](const absl::Status &s) { return !s.ok(); }),
+            7);
+
+  // Nothing left to parse.
+  EXPECT_TRUE(project.ParseFiles(4).empty());
+}
+
+TEST(VerilogProjectTest, OpenTranslationUnitsConcurrently) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir = JoinPath(tempdir, "open_files");
+  EXPECT_TRUE(CreateDir(sources_dir).ok());
+  VerilogProject project(sources_dir, {});
+
+  std::vector<std::unique_ptr<ScopedTestFile>> files;
+  std::vector<std::string> names;
+  for (int i = 0; i < 10; ++i) {
+    files.push_back(std::make_unique<ScopedTestFile>(
+        sources_dir, absl::StrCat("module m", i, ";\nendmodule\n")));
+    names.push_back(std::string(Basename(files.back()->filename())));
+  }
+  // One already opened, one missing and one duplicate file.
+  ASSERT_TRUE(project.OpenTranslationUnit(names[3]).ok());
+  names.insert(names.begin() + 5, "does-not-exist.sv");
+  names.push_back(names[0]);
+
+  const auto results = project.OpenTranslationUnits(names, 4);
+  ASSERT_EQ(results.size(), names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (i == 5) {
+      EXPECT_FALSE(results[i].ok());
+      continue;
+    }
+    ASSERT_TRUE(results[i].ok()) << results[i].status();
+    EXPECT_EQ((*results[i])->ReferencedPath(), names[i]);
+    EXPECT_EQ(project.LookupRegisteredFile(names[i]), *results[i]);
+    EXPECT_FALSE((*results[i])->GetContent().empty());
+  }
+  EXPECT_EQ(*results.front(), *results.back());
+
+  // Opened files are parsed like the others.
+  const std::vector<absl::Status> statuses = project.ParseFiles(4);
+  EXPECT_EQ(std::count_if(statuses.begin(), statuses.end(),
+                          [](const absl::Status &s) { return s.ok(); }),
+            10);
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,345 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_variant_linter.h"
+
+#include <cstddef>
+#include <future>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/file_util.h"
+#include "common/util/logging.h"
+#include "common/util/range.h"
+#include "common/util/thread_pool.h"
+#include "verilog/analysis/flow_tree.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/parser/verilog_token_enum.h"
+#include "verilog/preprocessor/verilog_preprocess.h"
+
+namespace verilog {
+
+using verible::LintRuleStatus;
+using verible::LintViolation;
+using verible::TokenInfo;
+
+namespace {
+
+// The conditional macros that a variant assumes to be defined, among the
+// ones it depends on.
+struct MacroConfiguration {
+  FlowTree::BitSet defined;
+  FlowTree::BitSet visited;
+};
+
+// A violation found in one variant, with tokens pointing into the linted
+// source instead of the variant.
+struct VariantViolation {
+  absl::string_view rule_name;
+  std::string url;
+  TokenInfo token = TokenInfo::EOFToken();
+  std::string reason;
+  std::vector<TokenInfo> related_tokens;
+};
+
+struct VariantFindings {
+  std::vector<VariantViolation> violations;
+  std::vector<std::string> syntax_error_messages;
+};
+
+}  // namespace
+
+// Returns 'content' with its conditional directives, and the branches that
+// 'defined' does not select, replaced by spaces.  Newlines are kept, so that
+// offsets as well as lines and columns are the same as in 'content'.
+// 'tokens' are the syntax tree tokens of 'content', which the conditionals
+// were checked to be balanced in.
+static std::string VariantText(absl::string_view content,
+                               const verible::TokenSequence &tokens,
+                               const std::map<absl::string_view, int> &ids,
+                               const FlowTree::BitSet &defined) {
+  std::string text(content);
+  const auto blank = [&text](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (text[i] != '\n') text[i] = ' ';
+    }
+  };
+  // Returns true if the macro named by tokens[index] is assumed defined.
+  const auto is_defined = [&tokens, &ids, &defined](size_t index) {
+    if (index >= tokens.size()) return false;
+    const auto found = ids.find(tokens[index].text());
+    return found != ids.end() && defined.test(found->second);
+  };
+
+  struct Block {
+    bool parent_selected;
+    bool taken;  // whether a branch before was selected
+  };
+  std::vector<Block> blocks;
+  bool selected = true;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const size_t begin = tokens[i].left(content);
+    bool directive = true;
+    switch (tokens[i].token_enum()) {
+      case PP_ifdef:
+      case PP_ifndef: {
+        const bool condition =
+            is_defined(i + 1) != (tokens[i].token_enum() == PP_ifndef);
+        blocks.push_back({selected, condition});
+        selected = selected && condition;
+        ++i;  // the macro name
+        break;
+      }
+      case PP_elsif: {
+        if (blocks.empty()) break;
+        Block &block = blocks.back();
+        const bool condition = !block.taken && is_defined(i + 1);
+        selected = block.parent_selected && condition;
+        block.taken = block.taken || condition;
+        ++i;  // the macro name
+        break;
+      }
+      case PP_else: {
+        if (blocks.empty()) break;
+        Block &block = blocks.back();
+        selected = block.parent_selected && !block.taken;
+        block.taken = true;
+        break;
+      }
+      case PP_endif: {
+        if (blocks.empty()) break;
+        selected = blocks.back().parent_selected;
+        blocks.pop_back();
+        break;
+      }
+      default:
+        directive = false;
+    }
+    const size_t end =
+        i < tokens.size() ? tokens[i].right(content) : content.length();
+    if (directive || !selected) blank(begin, end);
+    // Whitespace and comments up to the next token.
+    if (!selected) {
+      blank(end,
+            i + 1 < tokens.size() ? tokens[i + 1].left(content) : end);
+    }
+  }
+  return text;
+}
+
+// Returns a copy of 'token', of 'text', pointing at the same offset in
+// 'content'.
+static TokenInfo RebaseToken(const TokenInfo &token, absl::string_view text,
+                             absl::string_view content) {
+  if (!verible::IsSubRange(token.text(), text)) {
+    return TokenInfo(token.token_enum(), content.substr(0, 0));
+  }
+  return TokenInfo(token.token_enum(),
+                   content.substr(token.left(text), token.text().length()));
+}
+
+// Parses and lints 'text', a variant of 'content'.
+static absl::StatusOr<VariantFindings> LintVariant(
+    absl::string_view filename, absl::string_view content,
+    const std::string &text, const LinterConfiguration &config,
+    bool show_context) {
+  VariantFindings findings;
+  const auto analyzer = VerilogAnalyzer::AnalyzeAutomaticMode(
+      text, filename, VerilogPreprocess::Config());
+  if (!analyzer->LexStatus().ok() || !analyzer->ParseStatus().ok()) {
+    findings.syntax_error_messages =
+        analyzer->LinterTokenErrorMessages(show_context);
+  }
+  const auto statuses =
+      VerilogLintTextStructure(filename, config, analyzer->Data());
+  if (!statuses.ok()) return statuses.status();
+  for (const LintRuleStatus &status : *statuses) {
+    for (const LintViolation &violation : status.violations) {
+      VariantViolation &rebased = findings.violations.emplace_back();
+      rebased.rule_name = status.lint_rule_name;
+      rebased.url = status.url;
+      rebased.token = RebaseToken(violation.token, text, content);
+      rebased.reason = std::string(violation.reason);
+      for (const TokenInfo &related : violation.related_tokens) {
+        rebased.related_tokens.push_back(RebaseToken(related, text, content));
+      }
+    }
+  }
+  return findings;
+}
+
+// Returns e.g. "A,!B" for a configuration in which A is defined and B is not.
+static std::string ConfigurationName(
+    const MacroConfiguration &configuration,
+    const std::vector<std::string> &macros) {
+  std::vector<std::string> names;
+  for (size_t id = 0; id < macros.size(); ++id) {
+    if (!configuration.visited.test(id)) continue;
+    names.push_back(
+        absl::StrCat(configuration.defined.test(id) ? "" : "!", macros[id]));
+  }
+  return absl::StrJoin(names, ",");
+}
+
+absl::StatusOr<VariantLintResult> LintAllVariants(
+    absl::string_view filename, absl::string_view content,
+    const LinterConfiguration &config, int jobs, int max_variants,
+    bool show_context) {
+  verible::TokenSequence tokens;
+  VerilogLexer lexer(content);
+  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
+       lexer.DoNextToken()) {
+    if (VerilogLexer::KeepSyntaxTreeTokens(lexer.GetLastToken())) {
+      tokens.push_back(lexer.GetLastToken());
+    }
+  }
+
+  FlowTree flow_tree(tokens);
+  std::vector<MacroConfiguration> configurations;
+  const absl::Status status = flow_tree.GenerateVariants(
+      [&configurations, max_variants](const FlowTree::Variant &variant) {
+        configurations.push_back({variant.macros_mask, variant.visited});
+        return static_cast<int>(configurations.size()) < max_variants;
+      });
+  if (!status.ok()) return status;
+  // Sources without tokens have no variant, but are linted as they are.
+  if (configurations.empty()) configurations.emplace_back();
+
+  VariantLintResult result;
+  result.variants = configurations.size();
+  std::map<absl::string_view, int> ids;
+  for (const auto &macro : flow_tree.GetUsedMacros()) {
+    ids.emplace(macro->text(), result.conditional_macros.size());
+    result.conditional_macros.emplace_back(macro->text());
+  }
+
+  std::vector<std::future<absl::StatusOr<VariantFindings>>> futures;
+  {
+    verible::ThreadPool pool(jobs > 1 ? jobs : 0);
+    for (const MacroConfiguration &configuration : configurations) {
+      futures.push_back(pool.ExecAsync<absl::StatusOr<VariantFindings>>(
+          [&, defined = configuration.defined]() {
+            const std::string text = VariantText(content, tokens, ids, defined);
+            return LintVariant(filename, content, text, config, show_context);
+          }));
+    }
+    // Waits for all variants before the pool goes away.
+    for (auto &future : futures) future.wait();
+  }
+
+  // Violations are the same if they are of the same rule, at the same place,
+  // for the same reason.
+  struct MergedViolation {
+    VariantViolation violation;
+    std::vector<size_t> variants;
+  };
+  std::map<std::tuple<absl::string_view, int, std::string>, MergedViolation>
+      merged;
+  std::set<std::string> seen_syntax_errors;
+  for (size_t i = 0; i < futures.size(); ++i) {
+    absl::StatusOr<VariantFindings> findings = futures[i].get();
+    if (!findings.ok()) return findings.status();
+    for (std::string &message : findings->syntax_error_messages) {
+      if (seen_syntax_errors.insert(message).second) {
+        result.syntax_error_messages.push_back(std::move(message));
+      }
+    }
+    for (VariantViolation &violation : findings->violations) {
+      auto key = std::make_tuple(violation.rule_name,
+                                 violation.token.left(content),
+                                 violation.reason);
+      MergedViolation &entry = merged[std::move(key)];
+      if (entry.variants.empty()) entry.violation = std::move(violation);
+      entry.variants.push_back(i);
+    }
+  }
+
+  std::map<absl::string_view, size_t> status_index;
+  for (auto &[key, entry] : merged) {
+    VariantViolation &violation = entry.violation;
+    std::string reason = violation.reason;
+    if (entry.variants.size() < configurations.size()) {
+      std::vector<std::string> names;
+      for (const size_t i : entry.variants) {
+        names.push_back(
+            ConfigurationName(configurations[i], result.conditional_macros));
+      }
+      absl::StrAppend(&reason, " [in variants: ", absl::StrJoin(names, " | "),
+                      "]");
+    }
+    const auto [found, inserted] =
+        status_index.emplace(violation.rule_name, result.statuses.size());
+    if (inserted) {
+      result.statuses.emplace_back(std::set<LintViolation>(),
+                                   violation.rule_name, violation.url);
+    }
+    result.statuses[found->second].violations.emplace(
+        violation.token, reason, std::vector<verible::AutoFix>(),
+        violation.related_tokens);
+  }
+  return result;
+}
+
+int LintAllVariantsOfFile(std::ostream *stream, absl::string_view filename,
+                          const LinterConfiguration &config,
+                          verible::ViolationHandler *violation_handler,
+                          bool check_syntax, bool parse_fatal, bool lint_fatal,
+                          int jobs, int max_variants, bool show_context) {
+  const absl::StatusOr<std::string> content =
+      verible::file::GetContentAsString(filename);
+  if (!content.ok()) {
+    LOG(ERROR) << "Can't read '" << filename
+               << "': " << content.status().message();
+    return 2;
+  }
+  const auto result = LintAllVariants(filename, *content, config, jobs,
+                                      max_variants, show_context);
+  if (!result.ok()) {
+    LOG(ERROR) << "Fatal error: " << result.status().message();
+    return 2;
+  }
+  VLOG(1) << "Linted " << result->variants << " variants of " << filename;
+
+  if (check_syntax && !result->syntax_error_messages.empty()) {
+    for (const auto &message : result->syntax_error_messages) {
+      *stream << message << std::endl;
+    }
+    if (parse_fatal) return 1;
+  }
+
+  if (result->statuses.empty()) return 0;
+  violation_handler->HandleViolations(GetSortedViolations(result->statuses),
+                                      *content, filename);
+  return lint_fatal ? 1 : 0;
+}
+
+}  // namespace verilog
@@ -0,0 +1,71 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+
+namespace verilog {
+
+// Result of linting all `ifdef variants of a source.
+struct VariantLintResult {
+  // Number of variants that were linted.
+  int variants = 0;
+
+  // Macros that the conditionals of the source depend on, by ID as used in
+  // the masks of the variants.
+  std::vector<std::string> conditional_macros;
+
+  // One status per rule that found violations.  Each violation is reported
+  // once, however many variants it is found in, and its token points into the
+  // linted source.  Violations that are not found in every variant list the
+  // macro configurations they are found in, at the end of their reason.
+  std::vector<verible::LintRuleStatus> statuses;
+
+  // Syntax errors of the variants, with repetitions removed.
+  std::vector<std::string> syntax_error_messages;
+};
+
+// Lints every variant of 'content' that FlowTree generates from its `ifdef,
+// `ifndef, `elsif and `else directives, with up to 'jobs' variants analyzed
+// concurrently.  Each variant is the source with the directives and the
+// unselected branches blanked out, so that positions in it are the same as in
+// 'content', which has to outlive the result.  Stops after 'max_variants'
+// variants.
+absl::StatusOr<VariantLintResult> LintAllVariants(
+    absl::string_view filename, absl::string_view content,
+    const LinterConfiguration &config, int jobs, int max_variants,
+    bool show_context = false);
+
+// Like LintOneFile() (verilog_linter.h), for all variants of the file, as
+// linted by LintAllVariants().
+int LintAllVariantsOfFile(std::ostream *stream, absl::string_view filename,
+                          const LinterConfiguration &config,
+                          verible::ViolationHandler *violation_handler,
+                          bool check_syntax, bool parse_fatal, bool lint_fatal,
+                          int jobs, int max_variants,
+                          bool show_context = false);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
@@ -0,0 +1,160 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/analysis/verilog_variant_linter.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/util/file_util.h"
+#include "common/util/range.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using verible::LintViolationWithStatus;
+using verible::ViolationPrinter;
+using verible::file::testing::ScopedTestFile;
+
+class LintAllVariantsTest : public testing::Test {
+ public:
+  LintAllVariantsTest() { config_.UseRuleSet(RuleSet::kDefault); }
+
+ protected:
+  LinterConfiguration config_;
+};
+
+// Returns the reasons of the violations in 'result', in source order.
+static std::vector<std::string> Reasons(const VariantLintResult &result) {
+  std::vector<std::string> reasons;
+  for (const LintViolationWithStatus &violation :
+       GetSortedViolations(result.statuses)) {
+    reasons.emplace_back(violation.violation->reason);
+  }
+  return reasons;
+}
+
+TEST_F(LintAllVariantsTest, ReportsEachViolationOnce) {
+  constexpr absl::string_view kCode =
+      "task automatic foo;\n"
+      "`ifdef A\n"
+      "  $psprintf(\"a\");\n"
+      "`else\n"
+      "  $display(\"b\");\n"
+      "`endif\n"
+      "  $psprintf(\"c\");\n"
+      "endtask\n";
+  for (const int jobs : {1, 4}) {
+    const auto result = LintAllVariants("foo.sv", kCode, config_, jobs, 16);
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_EQ(result->variants, 2);
+    EXPECT_THAT(result->conditional_macros, ElementsAre("A"));
+    EXPECT_TRUE(result->syntax_error_messages.empty());
+    const std::vector<std::string> reasons = Reasons(*result);
+    ASSERT_EQ(reasons.size(), 2);
+    EXPECT_THAT(reasons[0], EndsWith(" [in variants: A]"));
+    EXPECT_THAT(reasons[1], ::testing::Not(HasSubstr("[in variants")));
+    // Violations point into the linted source.
+    for (const LintViolationWithStatus &violation :
+         GetSortedViolations(result->statuses)) {
+      const absl::string_view text = violation.violation->token.text();
+      EXPECT_TRUE(verible::IsSubRange(text, kCode));
+      EXPECT_EQ(text, "$psprintf");
+    }
+  }
+}
+
+TEST_F(LintAllVariantsTest, NestedConditionals) {
+  constexpr absl::string_view kCode =
+      "task automatic foo;\n"
+      "`ifdef A\n"
+      "`ifndef B\n"
+      "  $psprintf(\"a\");\n"
+      "`endif\n"
+      "`elsif C\n"
+      "  $psprintf(\"c\");\n"
+      "`endif\n"
+      "endtask\n";
+  const auto result = LintAllVariants("foo.sv", kCode, config_, 2, 16);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->variants, 4);
+  EXPECT_THAT(Reasons(*result),
+              ElementsAre(EndsWith(" [in variants: A,!B]"),
+                          EndsWith(" [in variants: !A,C]")));
+}
+
+TEST_F(LintAllVariantsTest, SyntaxErrorInOneVariant) {
+  constexpr absl::string_view kCode =
+      "module m;\n"
+      "`ifdef BROKEN\n"
+      "  wire;\n"
+      "`endif\n"
+      "endmodule\n";
+  const auto result = LintAllVariants("m.sv", kCode, config_, 1, 16);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->variants, 2);
+  ASSERT_EQ(result->syntax_error_messages.size(), 1);
+  EXPECT_THAT(result->syntax_error_messages[0], HasSubstr("m.sv:3:"));
+}
+
+TEST_F(LintAllVariantsTest, LimitsVariants) {
+  constexpr absl::string_view kCode =
+      "module m;\n"
+      "`ifdef A\n"
+      "`endif\n"
+      "`ifdef B\n"
+      "`endif\n"
+      "endmodule\n";
+  const auto result = LintAllVariants("m.sv", kCode, config_, 1, 3);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->variants, 3);
+}
+
+TEST_F(LintAllVariantsTest, UnbalancedConditionals) {
+  constexpr absl::string_view kCode = "module m;\n`ifdef A\nendmodule\n";
+  EXPECT_FALSE(LintAllVariants("m.sv", kCode, config_, 1, 16).ok());
+}
+
+TEST_F(LintAllVariantsTest, LintAllVariantsOfFile) {
+  const ScopedTestFile temp_file(testing::TempDir(),
+                                 "task automatic foo;\n"
+                                 "`ifdef A\n"
+                                 "  $psprintf(\"a\");\n"
+                                 "`endif\n"
+                                 "endtask\n");
+  std::ostringstream output;
+  ViolationPrinter violation_printer(&output);
+  EXPECT_EQ(LintAllVariantsOfFile(&output, temp_file.filename(), config_,
+                                  &violation_printer, true, true, true, 2, 16),
+            1);
+  EXPECT_THAT(output.str(), HasSubstr("[in variants: A]"));
+
+  EXPECT_EQ(LintAllVariantsOfFile(&output, "FileNotFound.sv", config_,
+                                  &violation_printer, true, true, true, 2, 16),
+            2);
+}
+
+}  // namespace
+}  // namespace verilog
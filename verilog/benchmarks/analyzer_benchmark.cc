@@ -0,0 +1,50 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures VerilogAnalyzer::Analyze() throughput: lexing, preprocessing,
+// parsing and syntax tree construction.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/benchmarks/benchmark_utils.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+static void BM_Analyze(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  for (auto _ : state) {
+    VerilogAnalyzer analyzer(text, "synthetic.sv");
+    const auto status = analyzer.Analyze();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(analyzer.Data().SyntaxTree());
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+BENCHMARK(BM_Analyze)->Apply(SyntheticDesignShapes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Shared setup for the benchmarks in this package: a common set of synthetic
+// design shapes and throughput counters.
+
+#ifndef VERIBLE_VERILOG_BENCHMARKS_BENCHMARK_UTILS_H_
+#define VERIBLE_VERILOG_BENCHMARKS_BENCHMARK_UTILS_H_
+
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+namespace verilog {
+namespace benchmarks {
+
+// Registers argument triples {modules, ports, nesting_depth} that scale each
+// dimension of the synthetic design separately.
+inline void SyntheticDesignShapes(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"modules", "ports", "depth"});
+  b->Args({1, 8, 2});
+  b->Args({16, 8, 2});
+  b->Args({128, 8, 2});
+  b->Args({16, 64, 2});
+  b->Args({16, 8, 16});
+}
+
+// Returns the design shape selected by SyntheticDesignShapes().
+inline SyntheticDesignParams DesignParamsFromState(
+    const benchmark::State &state) {
+  SyntheticDesignParams params;
+  params.modules = state.range(0);
+  params.ports = state.range(1);
+  params.nesting_depth = state.range(2);
+  return params;
+}
+
+// Reports bytes/second and tokens/second, assuming that every iteration
+// processed all of "text", which lexes into "num_tokens" tokens.
+inline void SetThroughputCounters(benchmark::State &state,
+                                  absl::string_view text, size_t num_tokens) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          text.size());
+  state.counters["tokens"] = benchmark::Counter(
+      num_tokens, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+}  // namespace benchmarks
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_BENCHMARKS_BENCHMARK_UTILS_H_
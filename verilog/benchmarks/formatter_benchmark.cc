@@ -0,0 +1,53 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures end-to-end FormatVerilog() throughput, which includes parsing.
+
+#include <sstream>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "verilog/benchmarks/benchmark_utils.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+#include "verilog/formatting/format_style.h"
+#include "verilog/formatting/formatter.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+static void BM_FormatVerilog(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  const formatter::FormatStyle style;
+  for (auto _ : state) {
+    std::ostringstream stream;
+    const auto status =
+        formatter::FormatVerilog(text, "synthetic.sv", style, stream);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(stream);
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+BENCHMARK(BM_FormatVerilog)->Apply(SyntheticDesignShapes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+BENCHMARK_MAIN();
@@ -0,0 +1,334 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays an editing session against the language server in-process and
+// reports the latency of the messages by method and the peak memory of the
+// process, to judge changes by their effect on editor responsiveness.
+//
+// Without --session, the session is scripted: a synthetic design is opened,
+// --typed_chars characters are typed into it one change at a time, then it
+// is queried with hover, definition and references requests, and saved.
+// With --session, the messages of a recorded session are replayed instead,
+// as the client sent them to the server's stdin, e.g. captured with
+//   tee session.lsp | verible-verilog-ls
+//
+// Each message is timed from its first read by the server until Step()
+// returns, so with --request_threads, the latencies of concurrent requests
+// are only the time to dispatch them; --server_stats also prints the
+// latencies recorded by the server when their responses are written.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/lsp/latency-histogram.h"
+#include "common/lsp/lsp-file-utils.h"
+#include "common/lsp/message-stream-splitter.h"
+#include "common/util/file_util.h"
+#include "common/util/init_command_line.h"
+#include "nlohmann/json.hpp"
+#include "verilog/benchmarks/synthetic_verilog.h"
+#include "verilog/tools/ls/verilog-language-server.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+ABSL_FLAG(std::string, session, "",
+          "Recorded session to replay: the messages sent by a client, each "
+          "with its Content-Length header.  If empty, replays the scripted "
+          "session configured by the flags below.");
+ABSL_FLAG(int, modules, 64, "Scripted session: modules of the opened file.");
+ABSL_FLAG(int, ports, 8, "Scripted session: ports of each module.");
+ABSL_FLAG(int, typed_chars, 500,
+          "Scripted session: characters typed, each its own change.");
+ABSL_FLAG(int, queries, 10,
+          "Scripted session: number of each of the hover, definition and "
+          "references requests after typing.");
+ABSL_FLAG(bool, per_message, false,
+          "Print the latency of each message, in the order replayed.");
+ABSL_FLAG(bool, server_stats, false,
+          "Print the statistics of the server at the end of the session.");
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+using nlohmann::json;
+
+// A line of text typed at the end of the first module, character by
+// character.
+constexpr absl::string_view kTypedLine = "  assign out_0 = r_0 & in_0;\n";
+
+// Returns a read function that consumes "*data".
+verible::lsp::MessageStreamSplitter::ReadFun ReadFrom(absl::string_view *data) {
+  return [data](char *buf, int size) -> int {
+    const int n = std::min<size_t>(size, data->size());
+    memcpy(buf, data->data(), n);
+    data->remove_prefix(n);
+    return n;
+  };
+}
+
+// Returns "body" with its header, as a client sends it.
+std::string Framed(absl::string_view body) {
+  return absl::StrCat("Content-Length: ", body.size(), "\r\n\r\n", body);
+}
+
+// Returns the zero-based {"line", "character"} of "offset" in "text".
+json Position(absl::string_view text, size_t offset) {
+  const absl::string_view head = text.substr(0, offset);
+  const size_t last_newline = head.rfind('\n');
+  const size_t character = last_newline == absl::string_view::npos
+                               ? offset
+                               : offset - last_newline - 1;
+  return {{"line", std::count(head.begin(), head.end(), '\n')},
+          {"character", character}};
+}
+
+json Request(json id, absl::string_view method, json params) {
+  return {{"jsonrpc", "2.0"},
+          {"id", std::move(id)},
+          {"method", method},
+          {"params", std::move(params)}};
+}
+
+json Notification(absl::string_view method, json params) {
+  return {
+      {"jsonrpc", "2.0"}, {"method", method}, {"params", std::move(params)}};
+}
+
+// Returns the messages of the scripted session, without the final shutdown.
+std::vector<std::string> ScriptedSession() {
+  SyntheticDesignParams params;
+  params.modules = std::max(absl::GetFlag(FLAGS_modules), 1);
+  params.ports = std::max(absl::GetFlag(FLAGS_ports), 1);
+  params.nesting_depth = 2;
+  std::string text = GenerateSyntheticVerilog(params);
+  const std::string uri = verible::lsp::PathToLSPUri("/replay/synthetic.sv");
+
+  std::vector<json> messages;
+  int id = 0;
+  messages.push_back(Request(++id, "initialize", json::object()));
+  messages.push_back(Notification("initialized", json::object()));
+  messages.push_back(Notification(
+      "textDocument/didOpen",
+      {{"textDocument",
+        {{"uri", uri},
+         {"languageId", "verilog"},
+         {"version", 1},
+         {"text", text}}}}));
+
+  size_t type_offset = text.find("endmodule");
+  int version = 1;
+  for (int i = 0; i < absl::GetFlag(FLAGS_typed_chars); ++i) {
+    const std::string typed(1, kTypedLine[i % kTypedLine.size()]);
+    const json position = Position(text, type_offset);
+    messages.push_back(Notification(
+        "textDocument/didChange",
+        {{"textDocument", {{"uri", uri}, {"version", ++version}}},
+         {"contentChanges",
+          {{{"range", {{"start", position}, {"end", position}}},
+            {"text", typed}}}}}));
+    text.insert(type_offset, typed);
+    type_offset += typed.size();
+  }
+
+  // Query the uses of a register in each module, spread over the file.
+  std::vector<size_t> targets;
+  for (size_t pos = text.find("r_0 <="); pos != std::string::npos;
+       pos = text.find("r_0 <=", pos + 1)) {
+    targets.push_back(pos);
+  }
+  const int queries = absl::GetFlag(FLAGS_queries);
+  for (int q = 0; q < queries && !targets.empty(); ++q) {
+    const size_t target = targets[q * targets.size() / queries];
+    const json position_params = {{"textDocument", {{"uri", uri}}},
+                                  {"position", Position(text, target)}};
+    messages.push_back(Request(++id, "textDocument/hover", position_params));
+    messages.push_back(
+        Request(++id, "textDocument/definition", position_params));
+    json references_params = position_params;
+    references_params["context"] = {{"includeDeclaration", true}};
+    messages.push_back(
+        Request(++id, "textDocument/references", references_params));
+  }
+  messages.push_back(
+      Notification("textDocument/didSave", {{"textDocument", {{"uri", uri}}}}));
+
+  std::vector<std::string> bodies;
+  bodies.reserve(messages.size());
+  for (const json &message : messages) bodies.push_back(message.dump());
+  return bodies;
+}
+
+// Returns the bodies of the messages recorded in "content".
+absl::StatusOr<std::vector<std::string>> RecordedSession(
+    absl::string_view content) {
+  std::vector<std::string> bodies;
+  verible::lsp::MessageStreamSplitter splitter;
+  splitter.SetMessageProcessor(
+      [&bodies](absl::string_view header, absl::string_view body) {
+        bodies.emplace_back(body);
+      });
+  const auto read_fun = ReadFrom(&content);
+  absl::Status status;
+  while (status.ok()) status = splitter.PullFrom(read_fun);
+  if (!absl::IsUnavailable(status)) return status;  // Anything but EOF.
+  return bodies;
+}
+
+// Returns the method of a message body, or "(response)" for responses to
+// requests sent by the server.
+std::string MethodOf(absl::string_view body) {
+  const json message = json::parse(body, nullptr, /*allow_exceptions=*/false);
+  if (message.is_object() && message.contains("method") &&
+      message["method"].is_string()) {
+    return message["method"];
+  }
+  return "(response)";
+}
+
+// Returns the peak resident memory of this process in bytes, or 0 if not
+// available.
+int64_t PeakResidentMemory() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss;  // bytes
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;  // kiB
+#endif
+#else
+  return 0;
+#endif
+}
+
+// Feeds the framed message "body" to "server" until it has read all of it.
+absl::Status Send(VerilogLanguageServer *server, absl::string_view body) {
+  const std::string framed = Framed(body);
+  absl::string_view remaining = framed;
+  const auto read_fun = ReadFrom(&remaining);
+  absl::Status status;
+  while (status.ok() && !remaining.empty()) {
+    status = server->Step(read_fun);
+  }
+  return status;
+}
+
+int Replay() {
+  std::vector<std::string> session;
+  if (const std::string path = absl::GetFlag(FLAGS_session); !path.empty()) {
+    const absl::StatusOr<std::string> content =
+        verible::file::GetContentAsString(path);
+    if (!content.ok()) {
+      std::cerr << path << ": " << content.status() << std::endl;
+      return 1;
+    }
+    absl::StatusOr<std::vector<std::string>> recorded =
+        RecordedSession(*content);
+    if (!recorded.ok()) {
+      std::cerr << path << ": " << recorded.status() << std::endl;
+      return 1;
+    }
+    session = *std::move(recorded);
+  } else {
+    session = ScriptedSession();
+  }
+
+  int64_t bytes_written = 0;
+  VerilogLanguageServer server([&bytes_written](absl::string_view response) {
+    bytes_written += response.size();
+  });
+
+  std::map<std::string, verible::lsp::LatencyHistogram> latencies;
+  const bool per_message = absl::GetFlag(FLAGS_per_message);
+  const absl::Time session_start = absl::Now();
+  int replayed = 0;
+  for (const std::string &body : session) {
+    const std::string method = MethodOf(body);
+    if (method == "shutdown" || method == "exit") break;
+    const absl::Time start = absl::Now();
+    if (const absl::Status status = Send(&server, body); !status.ok()) {
+      std::cerr << "Message " << replayed << " (" << method
+                << "): " << status << std::endl;
+      return 1;
+    }
+    const absl::Duration latency = absl::Now() - start;
+    latencies[method].Add(latency);
+    if (per_message) {
+      printf("%6d %-40s %s\n", replayed, method.c_str(),
+             absl::FormatDuration(latency).c_str());
+    }
+    ++replayed;
+  }
+
+  // Run() waits for the responses of concurrent requests after shutdown.
+  const std::string shutdown =
+      Framed(Request("replay-shutdown", "shutdown", nullptr).dump());
+  absl::string_view remaining = shutdown;
+  const absl::Status status = server.Run(ReadFrom(&remaining));
+  const absl::Duration session_time = absl::Now() - session_start;
+  if (!status.ok()) {
+    std::cerr << "shutdown: " << status << std::endl;
+    return 1;
+  }
+
+  printf("%-40s %6s %10s %10s %10s %10s %10s\n", "method", "count", "p50",
+         "p90", "p99", "max", "total");
+  for (const auto &[method, latency] : latencies) {
+    printf("%-40s %6d %10s %10s %10s %10s %10s\n", method.c_str(),
+           latency.count(), absl::FormatDuration(latency.Quantile(0.5)).c_str(),
+           absl::FormatDuration(latency.Quantile(0.9)).c_str(),
+           absl::FormatDuration(latency.Quantile(0.99)).c_str(),
+           absl::FormatDuration(latency.max()).c_str(),
+           absl::FormatDuration(latency.total()).c_str());
+  }
+  printf("%d messages in %s, %lld bytes of responses and notifications\n",
+         replayed, absl::FormatDuration(session_time).c_str(),
+         static_cast<long long>(bytes_written));
+  printf("peak resident memory: %lld kiB\n",
+         static_cast<long long>(PeakResidentMemory() / 1024));
+
+  if (absl::GetFlag(FLAGS_server_stats)) server.PrintStatistics();
+  return 0;
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+int main(int argc, char *argv[]) {
+  const std::string usage =
+      absl::StrCat("usage: ", argv[0], " [options]\n",
+                   "Replays an editing session against the language server "
+                   "and reports the latency of each method.");
+  verible::InitCommandLine(usage, &argc, &argv);
+  return verilog::benchmarks::Replay();
+}
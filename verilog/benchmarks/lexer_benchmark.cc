@@ -0,0 +1,56 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures VerilogLexer throughput.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/text/token_info.h"
+#include "verilog/benchmarks/benchmark_utils.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+#include "verilog/parser/verilog_lexer.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+static void LexAll(benchmark::State &state, const std::string &text) {
+  for (auto _ : state) {
+    VerilogLexer lexer(text);
+    for (const verible::TokenInfo *token = &lexer.DoNextToken();
+         !token->isEOF(); token = &lexer.DoNextToken()) {
+      benchmark::DoNotOptimize(token);
+    }
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+
+static void BM_Lex(benchmark::State &state) {
+  LexAll(state, GenerateSyntheticVerilog(DesignParamsFromState(state)));
+}
+BENCHMARK(BM_Lex)->Apply(SyntheticDesignShapes);
+
+// Netlists are dominated by identifiers, spaces and comments.
+static void BM_LexNetlist(benchmark::State &state) {
+  LexAll(state, GenerateSyntheticNetlist(state.range(0)));
+}
+BENCHMARK(BM_LexNetlist)->ArgName("cells")->Arg(1000)->Arg(100000);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures VerilogLintTextStructure() throughput with the default rule set
+// on already-parsed text, and the syntax tree rules' share of it.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "common/analysis/syntax_tree_linter.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/benchmarks/benchmark_utils.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+static void BM_LintTextStructure(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  VerilogAnalyzer analyzer(text, "synthetic.sv");
+  const auto parse_status = analyzer.Analyze();
+  if (!parse_status.ok()) {
+    state.SkipWithError(parse_status.ToString().c_str());
+    return;
+  }
+  LinterConfiguration config;
+  config.UseRuleSet(RuleSet::kDefault);
+  for (auto _ : state) {
+    const auto statuses =
+        VerilogLintTextStructure("synthetic.sv", config, analyzer.Data());
+    if (!statuses.ok()) {
+      state.SkipWithError(statuses.status().ToString().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(*statuses);
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+BENCHMARK(BM_LintTextStructure)->Apply(SyntheticDesignShapes);
+
+// Runs only the default syntax tree rules, in one SyntaxTreeLinter pass.
+// "s/MB" is the lint time per megabyte of source text.
+static void BM_LintSyntaxTree(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  VerilogAnalyzer analyzer(text, "synthetic.sv");
+  const auto parse_status = analyzer.Analyze();
+  if (!parse_status.ok()) {
+    state.SkipWithError(parse_status.ToString().c_str());
+    return;
+  }
+  LinterConfiguration config;
+  config.UseRuleSet(RuleSet::kDefault);
+  for (auto _ : state) {
+    // Rules accumulate violations, so every iteration starts with new ones.
+    auto rules = config.CreateSyntaxTreeRules();
+    if (!rules.ok()) {
+      state.SkipWithError(rules.status().ToString().c_str());
+      break;
+    }
+    verible::SyntaxTreeLinter linter;
+    for (auto &rule : *rules) linter.AddRule(std::move(rule));
+    linter.Lint(*analyzer.SyntaxTree());
+    benchmark::DoNotOptimize(linter.ReportStatus());
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+  state.counters["s/MB"] = benchmark::Counter(
+      text.size() / 1e6, benchmark::Counter::kIsIterationInvariantRate |
+                             benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_LintSyntaxTree)->Apply(SyntheticDesignShapes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+BENCHMARK_MAIN();
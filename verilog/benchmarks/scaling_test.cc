@@ -0,0 +1,181 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that lexing, parsing, formatting and linting scale linearly with
+// the size of pathological inputs: each stage is timed on inputs doubling
+// in size a few times, and the exponent of the fitted power law may not
+// approach quadratic growth.  Unlike the benchmarks, this is a test, so
+// that super-linear regressions are caught without comparing numbers.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+#include "verilog/formatting/format_style.h"
+#include "verilog/formatting/formatter.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+// Linear scaling gives an exponent of about 1 (less, while fixed costs
+// dominate), quadratic scaling one of 2.  The margin absorbs timing noise.
+constexpr double kMaxExponent = 1.5;
+
+// Number of times the input size is doubled.
+constexpr int kDoublings = 3;
+
+// Calls of a stage are repeated for at least kMinBatchTime per
+// measurement, and the fastest of kBatches measurements counts.
+constexpr absl::Duration kMinBatchTime = absl::Milliseconds(10);
+constexpr int kBatches = 3;
+
+// Size of the smallest input of each shape.  The largest ones are a few
+// ten kilobytes of text.
+int BaseSize(ScalingShape shape) {
+  switch (shape) {
+    case ScalingShape::kNestedBlocks:
+      return 32;
+    case ScalingShape::kNestedExpressions:
+      return 64;
+    case ScalingShape::kLongConcatenation:
+      return 256;
+    case ScalingShape::kManyModules:
+      return 8;
+    default:
+      return 128;
+  }
+}
+
+absl::Duration TimePerCall(const std::function<void()> &run) {
+  absl::Duration fastest = absl::InfiniteDuration();
+  for (int batch = 0; batch < kBatches; ++batch) {
+    int calls = 0;
+    const absl::Time start = absl::Now();
+    absl::Duration elapsed;
+    do {
+      run();
+      ++calls;
+      elapsed = absl::Now() - start;
+    } while (elapsed < kMinBatchTime);
+    fastest = std::min(fastest, elapsed / calls);
+  }
+  return fastest;
+}
+
+// Returns the least-squares slope of "y" over "x".
+double Slope(const std::vector<double> &x, const std::vector<double> &y) {
+  const double n = x.size();
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    sum_x += x[i];
+    sum_y += y[i];
+    sum_xx += x[i] * x[i];
+    sum_xy += x[i] * y[i];
+  }
+  return (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+}
+
+// Receives the input text, and its analysis for the stages after parsing.
+using Stage = std::function<void(const std::string &text,
+                                 const VerilogAnalyzer &analyzed)>;
+
+// Times "stage" on inputs of all shapes, and expects the time to grow with
+// an exponent of the input size of at most "max_exponent" of the shape.
+void ExpectLinearScaling(
+    absl::string_view stage_name, const Stage &stage,
+    const std::function<double(ScalingShape)> &max_exponent =
+        [](ScalingShape) { return kMaxExponent; }) {
+  for (const ScalingShape shape : kScalingShapes) {
+    std::vector<double> log_sizes;
+    std::vector<double> log_times;
+    std::string report;
+    for (int i = 0, size = BaseSize(shape); i <= kDoublings; ++i, size *= 2) {
+      const std::string text = GenerateScalingInput(shape, size);
+      VerilogAnalyzer analyzed(text, "scaling.sv");
+      ASSERT_TRUE(analyzed.Analyze().ok()) << ScalingShapeName(shape);
+      const absl::Duration time =
+          TimePerCall([&]() { stage(text, analyzed); });
+      log_sizes.push_back(std::log2(size));
+      log_times.push_back(std::log2(absl::ToDoubleMicroseconds(time)));
+      absl::StrAppend(&report, "\n  size ", size, " (", text.size(),
+                      " bytes): ", absl::FormatDuration(time));
+    }
+    const double exponent = Slope(log_sizes, log_times);
+    EXPECT_LE(exponent, max_exponent(shape))
+        << stage_name << " of " << ScalingShapeName(shape)
+        << " grows super-linearly, with exponent " << exponent << ":"
+        << report;
+  }
+}
+
+TEST(ScalingTest, Lex) {
+  ExpectLinearScaling("Lexing", [](const std::string &text,
+                                   const VerilogAnalyzer &) {
+    EXPECT_GT(CountVerilogTokens(text), 0);
+  });
+}
+
+TEST(ScalingTest, Parse) {
+  ExpectLinearScaling("Parsing", [](const std::string &text,
+                                    const VerilogAnalyzer &) {
+    VerilogAnalyzer analyzer(text, "scaling.sv");
+    EXPECT_TRUE(analyzer.Analyze().ok());
+  });
+}
+
+// Deeply nested blocks are indented by their depth, so the formatted text
+// itself grows quadratically with it.
+TEST(ScalingTest, Format) {
+  const formatter::FormatStyle style;
+  ExpectLinearScaling(
+      "Formatting",
+      [&style](const std::string &, const VerilogAnalyzer &analyzed) {
+        std::string formatted;
+        EXPECT_TRUE(formatter::FormatVerilog(analyzed.Data(), "scaling.sv",
+                                             style, &formatted)
+                        .ok());
+      },
+      [](ScalingShape shape) {
+        return shape == ScalingShape::kNestedBlocks ? 2.5 : kMaxExponent;
+      });
+}
+
+TEST(ScalingTest, Lint) {
+  LinterConfiguration config;
+  config.UseRuleSet(RuleSet::kDefault);
+  ExpectLinearScaling(
+      "Linting", [&config](const std::string &,
+                           const VerilogAnalyzer &analyzed) {
+        EXPECT_TRUE(
+            VerilogLintTextStructure("scaling.sv", config, analyzed.Data())
+                .ok());
+      });
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
@@ -0,0 +1,103 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures SymbolTable::Build() and SymbolTable::Resolve() throughput on
+// already-parsed files.  Each iteration uses a fresh project, whose setup is
+// excluded from the timing.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "benchmark/benchmark.h"
+#include "verilog/analysis/symbol_table.h"
+#include "verilog/analysis/verilog_project.h"
+#include "verilog/benchmarks/benchmark_utils.h"
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+constexpr char kFileName[] = "synthetic.sv";
+
+// Returns a project containing "text" as one parsed virtual file.
+static std::unique_ptr<VerilogProject> ParsedProject(const std::string &text) {
+  auto project =
+      std::make_unique<VerilogProject>(".", std::vector<std::string>{});
+  project->AddVirtualFile(kFileName, text);
+  const auto status = project->LookupRegisteredFile(kFileName)->Parse();
+  return status.ok() ? std::move(project) : nullptr;
+}
+
+static void BM_SymbolTableBuild(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto project = ParsedProject(text);
+    if (project == nullptr) {
+      state.SkipWithError("synthetic design failed to parse");
+      break;
+    }
+    std::vector<absl::Status> diagnostics;
+    auto symbol_table = std::make_unique<SymbolTable>(project.get());
+    state.ResumeTiming();
+
+    symbol_table->Build(&diagnostics);
+    benchmark::DoNotOptimize(symbol_table->Root());
+
+    state.PauseTiming();
+    symbol_table.reset();
+    project.reset();
+    state.ResumeTiming();
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+BENCHMARK(BM_SymbolTableBuild)->Apply(SyntheticDesignShapes);
+
+static void BM_SymbolTableResolve(benchmark::State &state) {
+  const std::string text =
+      GenerateSyntheticVerilog(DesignParamsFromState(state));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto project = ParsedProject(text);
+    if (project == nullptr) {
+      state.SkipWithError("synthetic design failed to parse");
+      break;
+    }
+    std::vector<absl::Status> diagnostics;
+    auto symbol_table = std::make_unique<SymbolTable>(project.get());
+    symbol_table->Build(&diagnostics);
+    state.ResumeTiming();
+
+    symbol_table->Resolve(&diagnostics);
+    benchmark::DoNotOptimize(symbol_table->Root());
+
+    state.PauseTiming();
+    symbol_table.reset();
+    project.reset();
+    state.ResumeTiming();
+  }
+  SetThroughputCounters(state, text, CountVerilogTokens(text));
+}
+BENCHMARK(BM_SymbolTableResolve)->Apply(SyntheticDesignShapes);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
+
+BENCHMARK_MAIN();
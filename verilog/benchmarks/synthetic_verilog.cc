@@ -0,0 +1,198 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+#include <cstddef>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "verilog/parser/verilog_lexer.h"
+
+namespace verilog {
+namespace benchmarks {
+
+static void AppendModule(const SyntheticDesignParams &params, int index,
+                         std::string *out) {
+  const std::string indent = "  ";
+  absl::StrAppend(out, "module m_", index, " #(\n", indent,
+                  "parameter int W = 8\n) (\n", indent, "input logic clk");
+  for (int p = 0; p < params.ports; ++p) {
+    absl::StrAppend(out, ",\n", indent, "input logic [W-1:0] in_", p);
+    absl::StrAppend(out, ",\n", indent, "output logic [W-1:0] out_", p);
+  }
+  absl::StrAppend(out, "\n);\n");
+
+  for (int p = 0; p < params.ports; ++p) {
+    absl::StrAppend(out, indent, "logic [W-1:0] r_", p, ";\n");
+  }
+
+  // Nested control flow in one sequential block.
+  absl::StrAppend(out, indent, "always_ff @(posedge clk) begin\n");
+  std::string block_indent = indent + indent;
+  for (int d = 0; d < params.nesting_depth; ++d) {
+    absl::StrAppend(out, block_indent, "if (in_0[", d % 8, "]) begin\n");
+    block_indent += indent;
+  }
+  for (int p = 0; p < params.ports; ++p) {
+    absl::StrAppend(out, block_indent, "r_", p, " <= in_", p, " + r_", p,
+                    ";\n");
+  }
+  for (int d = params.nesting_depth; d > 0; --d) {
+    block_indent.resize(block_indent.size() - indent.size());
+    absl::StrAppend(out, block_indent, "end\n");
+  }
+  absl::StrAppend(out, indent, "end\n");
+
+  for (int p = 0; p < params.ports; ++p) {
+    absl::StrAppend(out, indent, "assign out_", p, " = r_", p, ";\n");
+  }
+
+  // Instantiate the previous module to create cross-module references.
+  if (index > 0) {
+    absl::StrAppend(out, indent, "m_", index - 1, " #(.W(W)) u_m_", index - 1,
+                    " (\n", indent, indent, ".clk(clk)");
+    for (int p = 0; p < params.ports; ++p) {
+      absl::StrAppend(out, ",\n", indent, indent, ".in_", p, "(r_", p, ")");
+      absl::StrAppend(out, ",\n", indent, indent, ".out_", p, "()");
+    }
+    absl::StrAppend(out, "\n", indent, ");\n");
+  }
+  absl::StrAppend(out, "endmodule\n\n");
+}
+
+std::string GenerateSyntheticVerilog(const SyntheticDesignParams &params) {
+  std::string result;
+  for (int m = 0; m < params.modules; ++m) {
+    AppendModule(params, m, &result);
+  }
+  return result;
+}
+
+std::string GenerateSyntheticNetlist(int cells) {
+  std::string result =
+      "// Generated netlist\nmodule top (\n  CLK,\n  D,\n  Q\n);\n"
+      "  input CLK;\n  input D;\n  output Q;\n";
+  for (int c = 0; c < cells; ++c) {
+    absl::StrAppend(&result, "  wire n", c, ";\n");
+  }
+  for (int c = 0; c < cells; ++c) {
+    const int in = c == 0 ? 0 : c - 1;
+    absl::StrAppend(&result, "  // cell ", c, " of ", cells, "\n");
+    if (c % 4 == 3) {
+      absl::StrAppend(&result, "  DFFR_X1 U_REG_", c, " ( .D(n", in,
+                      "), .CK(CLK), .RN(D), .Q(n", c, ") );\n");
+    } else {
+      absl::StrAppend(&result, "  NAND2_X1 U", c, " ( .A1(n", in, "), .A2(D), ",
+                      ".ZN(n", c, ") );\n");
+    }
+  }
+  absl::StrAppend(&result, "  assign Q = n", cells > 0 ? cells - 1 : 0,
+                  ";\nendmodule\n");
+  return result;
+}
+
+absl::string_view ScalingShapeName(ScalingShape shape) {
+  switch (shape) {
+    case ScalingShape::kNestedBlocks:
+      return "nested blocks";
+    case ScalingShape::kNestedExpressions:
+      return "nested expressions";
+    case ScalingShape::kLongConcatenation:
+      return "long concatenation";
+    case ScalingShape::kLargeCase:
+      return "large case";
+    case ScalingShape::kManyDeclarations:
+      return "many declarations";
+    case ScalingShape::kManyModules:
+      return "many modules";
+  }
+  return "unknown";
+}
+
+std::string GenerateScalingInput(ScalingShape shape, int size) {
+  if (shape == ScalingShape::kManyModules) {
+    return GenerateSyntheticVerilog({size, 2, 1});
+  }
+  // The generated lines are not indented, so that deep nesting does not
+  // make the input itself grow faster than "size".
+  std::string result =
+      "module scaling (\n  input logic [7:0] a,\n  output logic [7:0] y\n"
+      ");\n";
+  switch (shape) {
+    case ScalingShape::kNestedBlocks:
+      absl::StrAppend(&result, "always_comb begin\n");
+      for (int i = 0; i < size; ++i) {
+        absl::StrAppend(&result, "if (a[", i % 8, "]) begin\n");
+      }
+      absl::StrAppend(&result, "y = a;\n");
+      for (int i = 0; i < size; ++i) absl::StrAppend(&result, "end\n");
+      absl::StrAppend(&result, "end\n");
+      break;
+    case ScalingShape::kNestedExpressions:
+      absl::StrAppend(&result, "assign y = ");
+      result.append(size, '(');
+      absl::StrAppend(&result, "a");
+      for (int i = 0; i < size; ++i) {
+        absl::StrAppend(&result, i % 2 ? " + a)" : " ^ a)");
+      }
+      absl::StrAppend(&result, ";\n");
+      break;
+    case ScalingShape::kLongConcatenation:
+      absl::StrAppend(&result, "assign y = {");
+      for (int i = 0; i < size; ++i) {
+        absl::StrAppend(&result, i == 0 ? "" : i % 8 ? ", " : ",\n", "a[",
+                        i % 8, "]");
+      }
+      absl::StrAppend(&result, "};\n");
+      break;
+    case ScalingShape::kLargeCase:
+      absl::StrAppend(&result, "always_comb begin\ncase (a)\n");
+      for (int i = 0; i < size; ++i) {
+        absl::StrAppend(&result, i, ": y = a + ", i % 256, ";\n");
+      }
+      absl::StrAppend(&result, "default: y = a;\nendcase\nend\n");
+      break;
+    case ScalingShape::kManyDeclarations:
+      for (int i = 0; i < size; ++i) {
+        absl::StrAppend(&result, "logic [7:0] v_", i, ";\n");
+        absl::StrAppend(&result, "assign v_", i, " = ",
+                        i == 0 ? std::string("a") : absl::StrCat("v_", i - 1),
+                        ";\n");
+        absl::StrAppend(&result, "cell u_", i, " (.in(v_", i, "));\n");
+      }
+      absl::StrAppend(&result, "assign y = v_", size > 0 ? size - 1 : 0,
+                      ";\n");
+      break;
+    case ScalingShape::kManyModules:
+      break;
+  }
+  absl::StrAppend(&result, "endmodule\n");
+  return result;
+}
+
+size_t CountVerilogTokens(absl::string_view text) {
+  VerilogLexer lexer(text);
+  size_t count = 0;
+  for (const verible::TokenInfo *token = &lexer.DoNextToken();
+       !token->isEOF(); token = &lexer.DoNextToken()) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace benchmarks
+}  // namespace verilog
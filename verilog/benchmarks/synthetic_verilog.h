@@ -0,0 +1,75 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_BENCHMARKS_SYNTHETIC_VERILOG_H_
+#define VERIBLE_VERILOG_BENCHMARKS_SYNTHETIC_VERILOG_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace verilog {
+namespace benchmarks {
+
+// Shape of a generated design.  The size of the generated text grows
+// linearly with each parameter.
+struct SyntheticDesignParams {
+  // Number of module definitions.  Each module instantiates the previous one.
+  int modules = 1;
+
+  // Number of input/output port pairs per module.
+  int ports = 4;
+
+  // Depth of nested if/begin blocks in each module's always_ff block.
+  int nesting_depth = 1;
+};
+
+// Returns syntactically valid SystemVerilog text shaped by "params".
+std::string GenerateSyntheticVerilog(const SyntheticDesignParams &params);
+
+// Returns a gate-level netlist module of "cells" standard cell instances,
+// like synthesis tools write: mostly identifiers, spaces and comments.
+std::string GenerateSyntheticNetlist(int cells);
+
+// Pathological shapes of input, for checking how the tools scale.
+enum class ScalingShape {
+  kNestedBlocks,       // if/begin blocks nested "size" deep.
+  kNestedExpressions,  // Parenthesized expressions nested "size" deep.
+  kLongConcatenation,  // One concatenation of "size" operands.
+  kLargeCase,          // One case statement with "size" items.
+  kManyDeclarations,   // "size" declarations and instances in one module.
+  kManyModules,        // "size" small modules.
+};
+
+inline constexpr ScalingShape kScalingShapes[] = {
+    ScalingShape::kNestedBlocks,      ScalingShape::kNestedExpressions,
+    ScalingShape::kLongConcatenation, ScalingShape::kLargeCase,
+    ScalingShape::kManyDeclarations,  ScalingShape::kManyModules,
+};
+
+absl::string_view ScalingShapeName(ScalingShape shape);
+
+// Returns syntactically valid SystemVerilog text of the given "shape",
+// whose length grows linearly with "size".
+std::string GenerateScalingInput(ScalingShape shape, int size);
+
+// Returns the number of tokens the VerilogLexer produces for "text",
+// excluding the EOF token.  Benchmarks use this to report tokens/second.
+size_t CountVerilogTokens(absl::string_view text);
+
+}  // namespace benchmarks
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_BENCHMARKS_SYNTHETIC_VERILOG_H_
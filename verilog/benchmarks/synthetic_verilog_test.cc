@@ -0,0 +1,94 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verilog/benchmarks/synthetic_verilog.h"
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+namespace benchmarks {
+namespace {
+
+TEST(GenerateSyntheticVerilogTest, EmptyDesign) {
+  SyntheticDesignParams params;
+  params.modules = 0;
+  EXPECT_EQ(GenerateSyntheticVerilog(params), "");
+}
+
+TEST(GenerateSyntheticVerilogTest, ScalesWithParameters) {
+  const SyntheticDesignParams small{2, 2, 1};
+  const SyntheticDesignParams more_modules{4, 2, 1};
+  const SyntheticDesignParams more_ports{2, 4, 1};
+  const SyntheticDesignParams deeper{2, 2, 4};
+  const size_t small_size = GenerateSyntheticVerilog(small).size();
+  EXPECT_GT(GenerateSyntheticVerilog(more_modules).size(), small_size);
+  EXPECT_GT(GenerateSyntheticVerilog(more_ports).size(), small_size);
+  EXPECT_GT(GenerateSyntheticVerilog(deeper).size(), small_size);
+}
+
+TEST(GenerateSyntheticVerilogTest, InstantiatesPreviousModule) {
+  const std::string text = GenerateSyntheticVerilog({3, 1, 1});
+  EXPECT_TRUE(absl::StrContains(text, "module m_2"));
+  EXPECT_TRUE(absl::StrContains(text, "m_1 #(.W(W)) u_m_1"));
+}
+
+TEST(GenerateSyntheticVerilogTest, ParsesWithoutErrors) {
+  for (const SyntheticDesignParams &params :
+       {SyntheticDesignParams{1, 1, 0}, SyntheticDesignParams{3, 5, 4},
+        SyntheticDesignParams{8, 16, 16}}) {
+    const std::string text = GenerateSyntheticVerilog(params);
+    VerilogAnalyzer analyzer(text, "synthetic.sv");
+    EXPECT_TRUE(analyzer.Analyze().ok()) << text;
+    EXPECT_GT(CountVerilogTokens(text), 0);
+  }
+}
+
+TEST(GenerateSyntheticNetlistTest, ParsesWithoutErrors) {
+  for (int cells : {0, 1, 10}) {
+    const std::string text = GenerateSyntheticNetlist(cells);
+    VerilogAnalyzer analyzer(text, "netlist.v");
+    EXPECT_TRUE(analyzer.Analyze().ok()) << text;
+  }
+  EXPECT_GT(GenerateSyntheticNetlist(10).size(),
+            GenerateSyntheticNetlist(5).size());
+}
+
+TEST(GenerateScalingInputTest, ParsesWithoutErrors) {
+  for (const ScalingShape shape : kScalingShapes) {
+    for (int size : {0, 1, 9}) {
+      const std::string text = GenerateScalingInput(shape, size);
+      VerilogAnalyzer analyzer(text, "scaling.sv");
+      EXPECT_TRUE(analyzer.Analyze().ok()) << ScalingShapeName(shape) << text;
+    }
+  }
+}
+
+TEST(GenerateScalingInputTest, GrowsLinearly) {
+  for (const ScalingShape shape : kScalingShapes) {
+    const size_t base = GenerateScalingInput(shape, 0).size();
+    const size_t single = GenerateScalingInput(shape, 100).size() - base;
+    const size_t twice = GenerateScalingInput(shape, 200).size() - base;
+    EXPECT_GT(single, 0) << ScalingShapeName(shape);
+    EXPECT_NEAR(twice, 2 * single, single / 4) << ScalingShapeName(shape);
+  }
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace verilog
@@ -0,0 +1,186 @@
+# Copyright 2017-2023 The Verible Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""ctypes bindings for ``libverible_verilog.so`` (see ../verible_verilog.h).
+
+Unlike verible_verilog_syntax.py, this parses in-process and reads the
+syntax tree straight from the library's arrays, without JSON in between.
+"""
+
+import ctypes
+import os
+from typing import Iterator, Optional
+
+_API_VERSION = 1
+
+REF_NULL = 0
+REF_LEAF = 1
+REF_NODE = 2
+_INDEX_MASK = (1 << 30) - 1
+
+
+class Token(ctypes.Structure):
+  _fields_ = [("token_enum", ctypes.c_int32),
+              ("left", ctypes.c_int64),
+              ("right", ctypes.c_int64)]
+
+
+class _Node(ctypes.Structure):
+  _fields_ = [("tag", ctypes.c_int32),
+              ("first_child", ctypes.c_uint32),
+              ("num_children", ctypes.c_uint32)]
+
+
+def _load_library(path: Optional[str]) -> ctypes.CDLL:
+  lib = ctypes.CDLL(path or os.environ.get("VERIBLE_VERILOG_LIB",
+                                           "libverible_verilog.so"))
+  size_p = ctypes.POINTER(ctypes.c_size_t)
+  lib.verible_verilog_api_version.restype = ctypes.c_int
+  lib.verible_verilog_analyze.argtypes = [ctypes.c_char_p, ctypes.c_size_t,
+                                          ctypes.c_char_p]
+  lib.verible_verilog_analyze.restype = ctypes.c_void_p
+  lib.verible_verilog_free.argtypes = [ctypes.c_void_p]
+  lib.verible_verilog_ok.argtypes = [ctypes.c_void_p]
+  lib.verible_verilog_error_message.argtypes = [ctypes.c_void_p]
+  lib.verible_verilog_error_message.restype = ctypes.c_char_p
+  for name, restype in (("text", ctypes.c_void_p),
+                        ("tokens", ctypes.POINTER(Token)),
+                        ("nodes", ctypes.POINTER(_Node)),
+                        ("children", ctypes.POINTER(ctypes.c_uint32))):
+    function = getattr(lib, "verible_verilog_" + name)
+    function.argtypes = [ctypes.c_void_p, size_p]
+    function.restype = restype
+  lib.verible_verilog_root.argtypes = [ctypes.c_void_p]
+  lib.verible_verilog_root.restype = ctypes.c_uint32
+  for name in ("token_enum_name", "node_tag_name"):
+    function = getattr(lib, "verible_verilog_" + name)
+    function.argtypes = [ctypes.c_int32, size_p]
+    function.restype = ctypes.c_void_p
+  if lib.verible_verilog_api_version() != _API_VERSION:
+    raise ImportError(f"{lib._name}: unsupported API version")
+  return lib
+
+
+_lib = None
+
+
+def _get_library() -> ctypes.CDLL:
+  global _lib
+  if _lib is None:
+    _lib = _load_library(None)
+  return _lib
+
+
+def _name(function, value: int) -> str:
+  length = ctypes.c_size_t()
+  address = function(value, ctypes.byref(length))
+  return ctypes.string_at(address, length.value).decode() if address else ""
+
+
+def token_enum_name(token_enum: int) -> str:
+  return _name(_get_library().verible_verilog_token_enum_name, token_enum)
+
+
+def node_tag_name(tag: int) -> str:
+  return _name(_get_library().verible_verilog_node_tag_name, tag)
+
+
+class Analysis:
+  """Tokens and syntax tree of a text.
+
+  Token and node data are views of the library's memory, valid as long as
+  this object is; use as a context manager or call close() to free them early.
+  """
+
+  def __init__(self, text: bytes, filename: str = ""):
+    lib = _get_library()
+    self._lib = lib
+    self._handle = lib.verible_verilog_analyze(text, len(text),
+                                               filename.encode())
+    if not self._handle:
+      raise MemoryError("verible_verilog_analyze")
+    count = ctypes.c_size_t()
+    text_address = lib.verible_verilog_text(self._handle, ctypes.byref(count))
+    self.text = (ctypes.c_char * count.value).from_address(text_address) \
+        if count.value else b""
+    self.tokens = self._array(lib.verible_verilog_tokens, Token)
+    self._nodes = self._array(lib.verible_verilog_nodes, _Node)
+    self._children = self._array(lib.verible_verilog_children,
+                                 ctypes.c_uint32)
+    self.root = lib.verible_verilog_root(self._handle)
+
+  def _array(self, function, element_type):
+    count = ctypes.c_size_t()
+    pointer = function(self._handle, ctypes.byref(count))
+    if not count.value:
+      return (element_type * 0)()
+    return ctypes.cast(pointer,
+                       ctypes.POINTER(element_type * count.value)).contents
+
+  def close(self) -> None:
+    if self._handle:
+      self.text = b""
+      self.tokens = self._nodes = self._children = ()
+      self._lib.verible_verilog_free(self._handle)
+      self._handle = None
+
+  def __enter__(self) -> "Analysis":
+    return self
+
+  def __exit__(self, *args) -> None:
+    self.close()
+
+  def __del__(self) -> None:
+    self.close()
+
+  @property
+  def ok(self) -> bool:
+    return bool(self._lib.verible_verilog_ok(self._handle))
+
+  @property
+  def error_message(self) -> str:
+    return self._lib.verible_verilog_error_message(self._handle).decode()
+
+  @staticmethod
+  def kind(ref: int) -> int:
+    return ref >> 30
+
+  @staticmethod
+  def index(ref: int) -> int:
+    return ref & _INDEX_MASK
+
+  def tag(self, node_ref: int) -> int:
+    return self._nodes[node_ref & _INDEX_MASK].tag
+
+  def children(self, node_ref: int) -> Iterator[int]:
+    node = self._nodes[node_ref & _INDEX_MASK]
+    return iter(self._children[node.first_child:
+                               node.first_child + node.num_children])
+
+  def token(self, leaf_ref: int) -> Token:
+    return self.tokens[leaf_ref & _INDEX_MASK]
+
+  def token_text(self, leaf_ref: int) -> bytes:
+    token = self.token(leaf_ref)
+    return self.text[token.left:token.right] if token.left >= 0 else b""
+
+  def preorder(self, ref: Optional[int] = None) -> Iterator[int]:
+    """Yields the non-null references of the (sub)tree, in preorder."""
+    to_visit = [self.root if ref is None else ref]
+    while to_visit:
+      ref = to_visit.pop()
+      if ref >> 30 == REF_NULL:
+        continue
+      yield ref
+      if ref >> 30 == REF_NODE:
+        to_visit.extend(reversed(list(self.children(ref))))
@@ -0,0 +1,201 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/c_api/verible_verilog.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/text/flat_syntax_tree.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/parser/verilog_token.h"
+#include "verilog/preprocessor/verilog_preprocess.h"
+
+using verible::FlatSyntaxTree;
+using verible::TextStructureView;
+using verible::TokenInfo;
+using verilog::VerilogAnalyzer;
+
+// The arrays handed out are filled once, when the text is analyzed.  Symbols
+// and TokenInfo are not laid out for foreign callers, so the tree is
+// flattened into the plain structs of the header instead.
+struct VeribleVerilogAnalysis {
+  std::unique_ptr<VerilogAnalyzer> analyzer;
+  std::string error_message;
+  std::vector<VeribleVerilogToken> tokens;
+  std::vector<VeribleVerilogNode> nodes;
+  std::vector<VeribleVerilogRef> children;
+  VeribleVerilogRef root = VERIBLE_VERILOG_REF_NULL;
+};
+
+namespace {
+
+VeribleVerilogToken ConvertToken(const TokenInfo &token,
+                                 absl::string_view text) {
+  VeribleVerilogToken result{token.token_enum(), -1, -1};
+  if (token.text().begin() >= text.begin() &&
+      token.text().end() <= text.end()) {
+    result.left = token.left(text);
+    result.right = token.right(text);
+  }
+  return result;
+}
+
+// Records the reference "ref", for tokens also the token itself, which may
+// be one of the tokens FlatSyntaxTree keeps past the end of the text's.
+VeribleVerilogRef ConvertRef(const FlatSyntaxTree &tree,
+                             FlatSyntaxTree::SymbolRef ref,
+                             absl::string_view text,
+                             VeribleVerilogAnalysis *analysis) {
+  if (ref.IsNull()) return VERIBLE_VERILOG_REF_NULL;
+  if (ref.IsNode()) return (VERIBLE_VERILOG_REF_NODE << 30) | ref.index();
+  if (ref.index() >= analysis->tokens.size()) {
+    analysis->tokens.resize(ref.index() + 1,
+                            VeribleVerilogToken{verible::TK_EOF, -1, -1});
+    analysis->tokens[ref.index()] = ConvertToken(tree.Token(ref), text);
+  }
+  return (VERIBLE_VERILOG_REF_LEAF << 30) | ref.index();
+}
+
+void FlattenAnalysis(VeribleVerilogAnalysis *analysis) {
+  const TextStructureView &data = analysis->analyzer->Data();
+  const absl::string_view text = data.Contents();
+  analysis->tokens.reserve(data.TokenStream().size());
+  for (const TokenInfo &token : data.TokenStream()) {
+    analysis->tokens.push_back(ConvertToken(token, text));
+  }
+
+  const FlatSyntaxTree tree =
+      FlatSyntaxTree::FromTree(data.SyntaxTree().get(), data.TokenStream());
+  analysis->nodes.reserve(tree.NumNodes());
+  for (size_t i = 0; i < tree.NumNodes(); ++i) {
+    const auto node = FlatSyntaxTree::SymbolRef::Node(i);
+    const auto children = tree.Children(node);
+    analysis->nodes.push_back(VeribleVerilogNode{
+        tree.Tag(node), static_cast<uint32_t>(analysis->children.size()),
+        static_cast<uint32_t>(
+            std::distance(children.begin(), children.end()))});
+    for (const auto child : children) {
+      analysis->children.push_back(ConvertRef(tree, child, text, analysis));
+    }
+  }
+  analysis->root = ConvertRef(tree, tree.Root(), text, analysis);
+}
+
+const std::vector<std::string> &NodeTagNames() {
+  static const auto *const names = [] {
+    auto *result = new std::vector<std::string>;
+    const int end = static_cast<int>(verilog::NodeEnum::kInvalidTag);
+    result->reserve(end);
+    for (int tag = 0; tag < end; ++tag) {
+      result->push_back(
+          verilog::NodeEnumToString(static_cast<verilog::NodeEnum>(tag)));
+    }
+    return result;
+  }();
+  return *names;
+}
+
+}  // namespace
+
+int verible_verilog_api_version(void) { return VERIBLE_VERILOG_API_VERSION; }
+
+VeribleVerilogAnalysis *verible_verilog_analyze(const char *text,
+                                                size_t length,
+                                                const char *filename) {
+  auto *analysis = new (std::nothrow) VeribleVerilogAnalysis;
+  if (analysis == nullptr) return nullptr;
+  analysis->analyzer = VerilogAnalyzer::AnalyzeAutomaticMode(
+      absl::string_view(text, length), filename ? filename : "",
+      verilog::VerilogPreprocess::Config());
+  const absl::Status lex_status = analysis->analyzer->LexStatus();
+  const absl::Status parse_status = analysis->analyzer->ParseStatus();
+  if (!lex_status.ok()) {
+    analysis->error_message = std::string(lex_status.message());
+  } else if (!parse_status.ok()) {
+    analysis->error_message = std::string(parse_status.message());
+  }
+  FlattenAnalysis(analysis);
+  return analysis;
+}
+
+void verible_verilog_free(VeribleVerilogAnalysis *analysis) {
+  delete analysis;
+}
+
+int verible_verilog_ok(const VeribleVerilogAnalysis *analysis) {
+  return analysis->analyzer->LexStatus().ok() &&
+         analysis->analyzer->ParseStatus().ok();
+}
+
+const char *verible_verilog_error_message(
+    const VeribleVerilogAnalysis *analysis) {
+  return analysis->error_message.c_str();
+}
+
+const char *verible_verilog_text(const VeribleVerilogAnalysis *analysis,
+                                 size_t *length) {
+  const absl::string_view text = analysis->analyzer->Data().Contents();
+  *length = text.length();
+  return text.data();
+}
+
+const VeribleVerilogToken *verible_verilog_tokens(
+    const VeribleVerilogAnalysis *analysis, size_t *count) {
+  *count = analysis->tokens.size();
+  return analysis->tokens.data();
+}
+
+const VeribleVerilogNode *verible_verilog_nodes(
+    const VeribleVerilogAnalysis *analysis, size_t *count) {
+  *count = analysis->nodes.size();
+  return analysis->nodes.data();
+}
+
+const VeribleVerilogRef *verible_verilog_children(
+    const VeribleVerilogAnalysis *analysis, size_t *count) {
+  *count = analysis->children.size();
+  return analysis->children.data();
+}
+
+VeribleVerilogRef verible_verilog_root(const VeribleVerilogAnalysis *analysis) {
+  return analysis->root;
+}
+
+const char *verible_verilog_token_enum_name(int32_t token_enum,
+                                            size_t *length) {
+  const absl::string_view name = verilog::TokenTypeToString(token_enum);
+  *length = name.length();
+  return name.data();
+}
+
+const char *verible_verilog_node_tag_name(int32_t tag, size_t *length) {
+  const std::vector<std::string> &names = NodeTagNames();
+  if (tag < 0 || static_cast<size_t>(tag) >= names.size()) {
+    *length = 0;
+    return "";
+  }
+  *length = names[tag].length();
+  return names[tag].data();
+}
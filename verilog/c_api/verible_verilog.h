@@ -0,0 +1,123 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// C interface to VerilogAnalyzer, for embedding Verible into other programs
+// and languages (see python/verible_verilog.py) without running
+// verible-verilog-syntax and parsing its JSON output.
+//
+// An analysis owns a copy of the text, its tokens and its syntax tree, which
+// are exposed as arrays of plain structs that stay valid, unchanged, until the
+// analysis is freed.  Callers index into them instead of copying.
+//
+// Functions are thread-safe as long as each analysis is only freed once
+// nothing else uses it.
+
+#ifndef VERIBLE_VERILOG_C_API_VERIBLE_VERILOG_H_
+#define VERIBLE_VERILOG_C_API_VERIBLE_VERILOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped on incompatible changes of this interface.
+#define VERIBLE_VERILOG_API_VERSION 1
+
+// Opaque result of verible_verilog_analyze().
+typedef struct VeribleVerilogAnalysis VeribleVerilogAnalysis;
+
+// Token of the analyzed text.
+typedef struct {
+  int32_t token_enum;  // verilog_tokentype
+  // Byte offsets of the token text in verible_verilog_text(), or -1 for
+  // tokens that are not in the text, e.g. from macro expansions.
+  int64_t left;
+  int64_t right;
+} VeribleVerilogToken;
+
+// Syntax tree node.
+typedef struct {
+  int32_t tag;  // verilog::NodeEnum
+  // Children are verible_verilog_children()[first_child] up to, excluding,
+  // [first_child + num_children].
+  uint32_t first_child;
+  uint32_t num_children;
+} VeribleVerilogNode;
+
+// References to children: the two highest bits tell the kind, the other bits
+// are the index of the token or node.
+typedef uint32_t VeribleVerilogRef;
+#define VERIBLE_VERILOG_REF_NULL 0u
+#define VERIBLE_VERILOG_REF_LEAF 1u
+#define VERIBLE_VERILOG_REF_NODE 2u
+#define VERIBLE_VERILOG_REF_KIND(ref) ((ref) >> 30)
+#define VERIBLE_VERILOG_REF_INDEX(ref) ((ref) & ((1u << 30) - 1))
+
+// Returns VERIBLE_VERILOG_API_VERSION of the library.
+int verible_verilog_api_version(void);
+
+// Lexes and parses 'length' bytes of 'text', with the parsing mode detected
+// from the text like verible-verilog-syntax does.  'filename' (may be NULL)
+// only appears in messages.  Returns NULL only if out of memory; syntax
+// errors are reported by verible_verilog_ok().
+VeribleVerilogAnalysis *verible_verilog_analyze(const char *text,
+                                                size_t length,
+                                                const char *filename);
+
+// Frees 'analysis' (may be NULL) and all arrays it returned.
+void verible_verilog_free(VeribleVerilogAnalysis *analysis);
+
+// Returns 1 if the text was lexed and parsed without errors, else 0.
+int verible_verilog_ok(const VeribleVerilogAnalysis *analysis);
+
+// Returns the NUL-terminated status message of the first failed step, or ""
+// if verible_verilog_ok().
+const char *verible_verilog_error_message(
+    const VeribleVerilogAnalysis *analysis);
+
+// Returns the analyzed text, and its length in '*length'.
+const char *verible_verilog_text(const VeribleVerilogAnalysis *analysis,
+                                 size_t *length);
+
+// Returns all tokens, including whitespace and comments, and their number
+// in '*count'.  Leaves of the syntax tree refer to these.
+const VeribleVerilogToken *verible_verilog_tokens(
+    const VeribleVerilogAnalysis *analysis, size_t *count);
+
+// Returns the syntax tree nodes and their number in '*count'.
+const VeribleVerilogNode *verible_verilog_nodes(
+    const VeribleVerilogAnalysis *analysis, size_t *count);
+
+// Returns the child references of all nodes, and their number in '*count'.
+const VeribleVerilogRef *verible_verilog_children(
+    const VeribleVerilogAnalysis *analysis, size_t *count);
+
+// Returns the root of the syntax tree, which is a null reference if there is
+// no tree.
+VeribleVerilogRef verible_verilog_root(const VeribleVerilogAnalysis *analysis);
+
+// Return the names of token enums and node tags as used in the JSON output of
+// verible-verilog-syntax, and their length in '*length'.  The names are not
+// NUL-terminated and stay valid for the life of the program.
+const char *verible_verilog_token_enum_name(int32_t token_enum,
+                                            size_t *length);
+const char *verible_verilog_node_tag_name(int32_t tag, size_t *length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VERIBLE_VERILOG_C_API_VERIBLE_VERILOG_H_
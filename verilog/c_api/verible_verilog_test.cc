@@ -0,0 +1,137 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/c_api/verible_verilog.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace {
+
+using verilog::NodeEnum;
+
+std::string NodeTagName(int tag) {
+  size_t length;
+  const char *name = verible_verilog_node_tag_name(tag, &length);
+  return std::string(name, length);
+}
+
+std::string TokenEnumName(int token_enum) {
+  size_t length;
+  const char *name = verible_verilog_token_enum_name(token_enum, &length);
+  return std::string(name, length);
+}
+
+TEST(VeribleVerilogTest, ApiVersion) {
+  EXPECT_EQ(verible_verilog_api_version(), VERIBLE_VERILOG_API_VERSION);
+}
+
+TEST(VeribleVerilogTest, FreeNull) { verible_verilog_free(nullptr); }
+
+TEST(VeribleVerilogTest, EmptyText) {
+  VeribleVerilogAnalysis *analysis = verible_verilog_analyze("", 0, nullptr);
+  ASSERT_NE(analysis, nullptr);
+  EXPECT_TRUE(verible_verilog_ok(analysis));
+  EXPECT_STREQ(verible_verilog_error_message(analysis), "");
+  size_t count;
+  verible_verilog_nodes(analysis, &count);
+  EXPECT_EQ(count, 0);
+  EXPECT_EQ(verible_verilog_root(analysis), VERIBLE_VERILOG_REF_NULL);
+  verible_verilog_free(analysis);
+}
+
+TEST(VeribleVerilogTest, ModuleTree) {
+  const char kText[] = "module m;\nendmodule\n";
+  VeribleVerilogAnalysis *analysis =
+      verible_verilog_analyze(kText, std::strlen(kText), "m.sv");
+  ASSERT_NE(analysis, nullptr);
+  EXPECT_TRUE(verible_verilog_ok(analysis));
+
+  size_t text_length;
+  const char *text = verible_verilog_text(analysis, &text_length);
+  EXPECT_EQ(std::string(text, text_length), kText);
+
+  size_t num_tokens, num_nodes, num_children;
+  const VeribleVerilogToken *tokens =
+      verible_verilog_tokens(analysis, &num_tokens);
+  const VeribleVerilogNode *nodes = verible_verilog_nodes(analysis, &num_nodes);
+  const VeribleVerilogRef *children =
+      verible_verilog_children(analysis, &num_children);
+
+  const VeribleVerilogRef root = verible_verilog_root(analysis);
+  ASSERT_EQ(VERIBLE_VERILOG_REF_KIND(root), VERIBLE_VERILOG_REF_NODE);
+  ASSERT_LT(VERIBLE_VERILOG_REF_INDEX(root), num_nodes);
+  EXPECT_EQ(nodes[VERIBLE_VERILOG_REF_INDEX(root)].tag,
+            static_cast<int>(NodeEnum::kDescriptionList));
+
+  // Every child reference is in range, and leaves are in the text.
+  for (size_t i = 0; i < num_nodes; ++i) {
+    ASSERT_LE(nodes[i].first_child + nodes[i].num_children, num_children);
+  }
+  for (size_t i = 0; i < num_children; ++i) {
+    const VeribleVerilogRef child = children[i];
+    const uint32_t index = VERIBLE_VERILOG_REF_INDEX(child);
+    switch (VERIBLE_VERILOG_REF_KIND(child)) {
+      case VERIBLE_VERILOG_REF_NODE:
+        EXPECT_LT(index, num_nodes);
+        break;
+      case VERIBLE_VERILOG_REF_LEAF:
+        ASSERT_LT(index, num_tokens);
+        ASSERT_GE(tokens[index].left, 0);
+        ASSERT_LE(tokens[index].right, static_cast<int64_t>(text_length));
+        break;
+      default:
+        break;
+    }
+  }
+
+  // The token sequence includes whitespace.
+  ASSERT_GE(num_tokens, 2);
+  EXPECT_EQ(TokenEnumName(tokens[0].token_enum), "module");
+  EXPECT_EQ(tokens[0].left, 0);
+  EXPECT_EQ(tokens[0].right, 6);
+  EXPECT_EQ(TokenEnumName(tokens[1].token_enum), "TK_SPACE");
+
+  verible_verilog_free(analysis);
+}
+
+TEST(VeribleVerilogTest, SyntaxError) {
+  const char kText[] = "module m(;\nendmodule\n";
+  VeribleVerilogAnalysis *analysis =
+      verible_verilog_analyze(kText, std::strlen(kText), "m.sv");
+  ASSERT_NE(analysis, nullptr);
+  EXPECT_FALSE(verible_verilog_ok(analysis));
+  EXPECT_STRNE(verible_verilog_error_message(analysis), "");
+  verible_verilog_free(analysis);
+}
+
+TEST(VeribleVerilogTest, NodeTagNames) {
+  EXPECT_EQ(NodeTagName(static_cast<int>(NodeEnum::kModuleDeclaration)),
+            "kModuleDeclaration");
+  EXPECT_EQ(NodeTagName(-1), "");
+  EXPECT_EQ(NodeTagName(static_cast<int>(NodeEnum::kInvalidTag)), "");
+}
+
+TEST(VeribleVerilogTest, TokenEnumNames) {
+  EXPECT_EQ(TokenEnumName(verilog_tokentype::SymbolIdentifier),
+            "SymbolIdentifier");
+}
+
+}  // namespace
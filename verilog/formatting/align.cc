@@ -1442,15 +1442,19 @@ static std::vector<AlignablePartitionGroup> ExtractAlignablePartitionGroups(
       group_extractor(full_range));
   std::vector<AlignablePartitionGroup> groups;
   groups.reserve(ranges.size());
+  const size_t max_rows = std::max(vstyle.max_alignment_group_rows, 0);
   for (const auto& range : ranges) {
     // Use the alignment scanner and policy that correspond to the
     // match_subtype.  This supports aligning a heterogenous collection of
     // alignable partition groups from the same parent partition (full_range).
-    groups.emplace_back(
-        FilterAlignablePartitions(range.range, ignore_group_predicate),
-        AlignmentColumnScannerSelector(vstyle, range.match_subtype),
-        AlignmentPolicySelector(vstyle, range.match_subtype));
-    if (groups.back().IsEmpty()) groups.pop_back();
+    // Groups that are too large are aligned in parts.
+    for (const auto& rows : verible::SplitAlignableRows(
+             FilterAlignablePartitions(range.range, ignore_group_predicate),
+             max_rows)) {
+      groups.emplace_back(
+          rows, AlignmentColumnScannerSelector(vstyle, range.match_subtype),
+          AlignmentPolicySelector(vstyle, range.match_subtype));
+    }
   }
   return groups;
 }
@@ -1540,10 +1544,11 @@ static std::vector<AlignablePartitionGroup> AlignDistItems(
       &IgnoreCommentsAndPreprocessingDirectives, full_range, vstyle);
 }
 
-void TabularAlignTokenPartitions(const FormatStyle& style,
-                                 absl::string_view full_text,
-                                 const ByteOffsetSet& disabled_byte_ranges,
-                                 TokenPartitionTree* partition_ptr) {
+void TabularAlignTokenPartitions(
+    const FormatStyle& style, absl::string_view full_text,
+    const ByteOffsetSet& disabled_byte_ranges,
+    TokenPartitionTree* partition_ptr,
+    std::vector<verible::AlignmentGroupSummary>* group_summaries) {
   VLOG(1) << __FUNCTION__;
   auto& partition = *partition_ptr;
   auto& uwline = partition.Value();
@@ -1586,7 +1591,7 @@ void TabularAlignTokenPartitions(const FormatStyle& style,
 
   verible::TabularAlignTokens(style.column_limit, full_text,
                               disabled_byte_ranges, extract_alignment_groups,
-                              &partition);
+                              &partition, group_summaries);
 
   VLOG(1) << "end of " << __FUNCTION__;
 }
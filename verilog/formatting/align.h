@@ -15,7 +15,10 @@
 #ifndef VERIBLE_VERILOG_FORMATTING_ALIGN_H_
 #define VERIBLE_VERILOG_FORMATTING_ALIGN_H_
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
+#include "common/formatting/align.h"
 #include "common/formatting/token_partition_tree.h"
 #include "common/strings/position.h"  // for ByteOffsetSet
 #include "verilog/formatting/format_style.h"
@@ -26,10 +29,12 @@ namespace formatter {
 // For certain Verilog language construct groups, vertically align some
 // tokens by inserting padding-spaces.
 // TODO(fangism): pass in disabled formatting ranges
+// If 'group_summaries' is not null, the aligned groups are described there.
 void TabularAlignTokenPartitions(
     const FormatStyle &style, absl::string_view full_text,
     const verible::ByteOffsetSet &disabled_byte_ranges,
-    verible::TokenPartitionTree *partition_ptr);
+    verible::TokenPartitionTree *partition_ptr,
+    std::vector<verible::AlignmentGroupSummary> *group_summaries = nullptr);
 
 }  // namespace formatter
 }  // namespace verilog
@@ -18,12 +18,11 @@
 #include <cstddef>
 #include <iostream>
 #include <iterator>
+#include <string>
 #include <vector>
 
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
-#include "absl/strings/strip.h"
-#include "common/strings/comment_utils.h"
+#include "common/analysis/comment_directives.h"
 #include "common/strings/display_utils.h"
 #include "common/strings/line_column_map.h"
 #include "common/strings/position.h"
@@ -31,7 +30,6 @@
 #include "common/text/token_stream_view.h"
 #include "common/util/logging.h"
 #include "common/util/range.h"
-#include "common/util/spacer.h"
 #include "verilog/parser/verilog_parser.h"
 #include "verilog/parser/verilog_token_classifications.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -44,8 +42,17 @@ using verible::EscapeString;
 
 ByteOffsetSet DisableFormattingRanges(absl::string_view text,
                                       const verible::TokenSequence &tokens) {
-  static constexpr absl::string_view kTrigger = "verilog_format:";
-  static const auto kDelimiters = absl::ByAnyChar(" \t");
+  const verible::CommentDirectiveIndex directives(
+      tokens,
+      [](const verible::TokenInfo &token) {
+        return IsComment(verilog_tokentype(token.token_enum()));
+      },
+      {kFormatterTrigger});
+  return DisableFormattingRanges(text, directives);
+}
+
+ByteOffsetSet DisableFormattingRanges(
+    absl::string_view text, const verible::CommentDirectiveIndex &directives) {
   static constexpr int kNullOffset = -1;
   const verible::TokenInfo::Context context(
       text,
@@ -54,36 +61,29 @@ ByteOffsetSet DisableFormattingRanges(absl::string_view text,
   // By default, no text ranges are formatter-disabled.
   int begin_disable_offset = kNullOffset;
   ByteOffsetSet disable_set;
-  for (const auto &token : tokens) {
+  for (const verible::CommentDirective *directive :
+       directives.WithTrigger(kFormatterTrigger)) {
+    const verible::TokenInfo &token = directive->comment;
     VLOG(2) << verible::TokenWithContext{token, context};
-    const auto vtoken_enum = verilog_tokentype(token.token_enum());
-    if (IsComment(vtoken_enum)) {
-      // Focus on the space-delimited tokens in the comment text.
-      auto commands = verible::StripCommentAndSpacePadding(token.text());
-      if (absl::ConsumePrefix(&commands, kTrigger)) {
-        const std::vector<absl::string_view> comment_tokens(
-            absl::StrSplit(commands, kDelimiters, absl::SkipEmpty()));
-        if (!comment_tokens.empty()) {
-          // "off" marks the start of a disabling range, at end of comment.
-          // "on" marks the end of disabling range, up to the end of comment.
-          if (comment_tokens.front() == "off") {
-            if (begin_disable_offset == kNullOffset) {
-              begin_disable_offset = token.right(text);
-              if (vtoken_enum == TK_EOL_COMMENT) {
-                ++begin_disable_offset;  // to cover the trailing '\n'
-              }
-            }  // else ignore
-          } else if (comment_tokens.front() == "on") {
-            if (begin_disable_offset != kNullOffset) {
-              const int end_disable_offset = token.right(text);
-              if (begin_disable_offset != end_disable_offset) {
-                disable_set.Add({begin_disable_offset, end_disable_offset});
-              }
-              begin_disable_offset = kNullOffset;
-            }  // else ignore
-          }
+    const std::vector<absl::string_view> &comment_tokens = directive->args;
+    if (comment_tokens.empty()) continue;
+    // "off" marks the start of a disabling range, at end of comment.
+    // "on" marks the end of disabling range, up to the end of comment.
+    if (comment_tokens.front() == "off") {
+      if (begin_disable_offset == kNullOffset) {
+        begin_disable_offset = token.right(text);
+        if (token.token_enum() == TK_EOL_COMMENT) {
+          ++begin_disable_offset;  // to cover the trailing '\n'
+        }
+      }  // else ignore
+    } else if (comment_tokens.front() == "on") {
+      if (begin_disable_offset != kNullOffset) {
+        const int end_disable_offset = token.right(text);
+        if (begin_disable_offset != end_disable_offset) {
+          disable_set.Add({begin_disable_offset, end_disable_offset});
         }
-      }
+        begin_disable_offset = kNullOffset;
+      }  // else ignore
     }
   }
   // If the disabling interval remains open, close it (to end-of-buffer).
@@ -121,7 +121,7 @@ static size_t NewlineCount(absl::string_view s) {
 void FormatWhitespaceWithDisabledByteRanges(
     absl::string_view text_base, absl::string_view space_text,
     const ByteOffsetSet &disabled_ranges, bool include_disabled_ranges,
-    std::ostream &stream) {
+    std::string *output) {
   VLOG(3) << __FUNCTION__;
   CHECK(verible::IsSubRange(space_text, text_base));
   const int start = std::distance(text_base.begin(), space_text.begin());
@@ -136,7 +136,7 @@ void FormatWhitespaceWithDisabledByteRanges(
   if (space_text.empty() && start != 0) {
     if (!disabled_ranges.Contains(start)) {
       VLOG(3) << "output: 1*\"\\n\" (empty space text)";
-      stream << '\n';
+      output->push_back('\n');
       return;
     }
   }
@@ -151,7 +151,7 @@ void FormatWhitespaceWithDisabledByteRanges(
       const absl::string_view disabled(
           text_base.substr(next_start, range.first - next_start));
       VLOG(3) << "output: \"" << EscapeString{disabled} << "\" (preserved)";
-      stream << disabled;
+      output->append(disabled.data(), disabled.size());
       total_enabled_newlines += NewlineCount(disabled);
     }
     {  // for enabled intervals, preserve only newlines
@@ -159,7 +159,7 @@ void FormatWhitespaceWithDisabledByteRanges(
           text_base.substr(range.first, range.second - range.first));
       const size_t newline_count = NewlineCount(enabled);
       VLOG(3) << "output: " << newline_count << "*\"\\n\" (formatted)";
-      stream << verible::Spacer(newline_count, '\n');
+      output->append(newline_count, '\n');
       partially_enabled = true;
       total_enabled_newlines += newline_count;
     }
@@ -171,15 +171,25 @@ void FormatWhitespaceWithDisabledByteRanges(
         text_base.substr(next_start, end - next_start));
     VLOG(3) << "output: \"" << EscapeString(final_disabled)
             << "\" (remaining disabled)";
-    stream << final_disabled;
+    output->append(final_disabled.data(), final_disabled.size());
     total_enabled_newlines += NewlineCount(final_disabled);
   }
   // Print at least one newline if some subrange was format-enabled.
   if (partially_enabled && total_enabled_newlines == 0 && start != 0) {
     VLOG(3) << "output: 1*\"\\n\"";
-    stream << '\n';
+    output->push_back('\n');
   }
 }
 
+void FormatWhitespaceWithDisabledByteRanges(
+    absl::string_view text_base, absl::string_view space_text,
+    const ByteOffsetSet &disabled_ranges, bool include_disabled_ranges,
+    std::ostream &stream) {
+  std::string output;
+  FormatWhitespaceWithDisabledByteRanges(text_base, space_text, disabled_ranges,
+                                         include_disabled_ranges, &output);
+  stream << output;
+}
+
 }  // namespace formatter
 }  // namespace verilog
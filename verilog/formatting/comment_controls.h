@@ -16,8 +16,10 @@
 #define VERIBLE_VERILOG_FORMATTING_COMMENT_CONTROLS_H_
 
 #include <ostream>
+#include <string>
 
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
 #include "common/strings/line_column_map.h"
 #include "common/strings/position.h"  // for ByteOffsetSet, LineNumberSet
 #include "common/text/token_stream_view.h"
@@ -25,11 +27,20 @@
 namespace verilog {
 namespace formatter {
 
+// Comments starting with this trigger control the formatter, as in
+// "// verilog_format: off".
+inline constexpr absl::string_view kFormatterTrigger = "verilog_format:";
+
 // Returns a representation of byte offsets where true (membership) means
 // formatting is disabled.
 verible::ByteOffsetSet DisableFormattingRanges(
     absl::string_view text, const verible::TokenSequence &tokens);
 
+// Same as above, but from the already parsed comment directives of the text,
+// which need to include those with kFormatterTrigger.
+verible::ByteOffsetSet DisableFormattingRanges(
+    absl::string_view text, const verible::CommentDirectiveIndex &directives);
+
 // TODO(fangism): Move these next functions into common/formatting.
 // Same with the above types.
 
@@ -50,6 +61,12 @@ void FormatWhitespaceWithDisabledByteRanges(
     const verible::ByteOffsetSet &disabled_ranges, bool include_disabled_ranges,
     std::ostream &stream);
 
+// Same as above, but the output is appended to 'output'.
+void FormatWhitespaceWithDisabledByteRanges(
+    absl::string_view text_base, absl::string_view space_text,
+    const verible::ByteOffsetSet &disabled_ranges, bool include_disabled_ranges,
+    std::string *output);
+
 }  // namespace formatter
 }  // namespace verilog
 
@@ -31,6 +31,7 @@ namespace verilog {
 namespace formatter {
 namespace {
 
+using ::testing::Contains;
 using ::testing::ElementsAre;
 using verible::ByteOffsetSet;
 using verible::ExpectedTokenInfo;
@@ -211,9 +212,21 @@ TEST(DisableFormattingRangesTest, FormatOffVarious) {
     const auto disable_ranges = DisableFormattingRanges(
         analyzer.Data().Contents(), analyzer.Data().TokenStream());
     EXPECT_EQ(disable_ranges, test.expected) << "code:\n" << test.code;
+
+    // Same from the analyzer's index of all tools' directives.
+    EXPECT_EQ(DisableFormattingRanges(analyzer.Data().Contents(),
+                                      analyzer.CommentDirectives()),
+              test.expected)
+        << "code:\n"
+        << test.code;
   }
 }
 
+TEST(DisableFormattingRangesTest, AnalyzerIndexesFormatterDirectives) {
+  EXPECT_THAT(VerilogAnalyzer::CommentDirectiveTriggers(),
+              Contains(kFormatterTrigger));
+}
+
 struct DisabledBytesTestCase {
   absl::string_view text;
   LineNumberSet enabled_lines;
@@ -95,6 +95,11 @@ struct FormatStyle : public verible::BasicFormatStyle {
   // Internal tests assume these are forced to kAlign.
   AlignmentPolicy distribution_items_alignment = AlignmentPolicy::kAlign;
 
+  // Alignment groups with more rows than this are split into several groups
+  // of about the same size, each aligned on its own, which bounds the cost of
+  // aligning very long lists.  0 means no limit.
+  int max_alignment_group_rows = 0;
+
   bool port_declarations_right_align_packed_dimensions = false;
   bool port_declarations_right_align_unpacked_dimensions = false;
 
@@ -91,6 +91,10 @@ ABSL_FLAG(bool, compact_indexing_and_selections, true,
 ABSL_FLAG(bool, wrap_end_else_clauses, false,
           "Split end and else keywords into separate lines");
 
+ABSL_FLAG(int, max_alignment_group_rows, 0,
+          "Split alignment groups with more rows than this into several "
+          "groups of about the same size, aligned separately (0: no limit).");
+
 ABSL_FLAG(bool, port_declarations_right_align_packed_dimensions, false,
           "If true, packed dimensions in contexts with enabled alignment are "
           "aligned to the right.");
@@ -133,6 +137,7 @@ void InitializeFromFlags(FormatStyle *style) {
   STYLE_FROM_FLAG(class_member_variable_alignment);
   STYLE_FROM_FLAG(case_items_alignment);
   STYLE_FROM_FLAG(distribution_items_alignment);
+  STYLE_FROM_FLAG(max_alignment_group_rows);
   STYLE_FROM_FLAG(port_declarations_right_align_packed_dimensions);
   STYLE_FROM_FLAG(port_declarations_right_align_unpacked_dimensions);
   STYLE_FROM_FLAG(try_wrap_long_lines);
@@ -17,18 +17,24 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "common/formatting/format_token.h"
 #include "common/formatting/layout_optimizer.h"
 #include "common/formatting/line_wrap_searcher.h"
@@ -37,18 +43,23 @@
 #include "common/formatting/verification.h"
 #include "common/strings/diff.h"
 #include "common/strings/line_column_map.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/strings/range.h"
 #include "common/text/symbol.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
 #include "common/text/tree_utils.h"
+#include "common/util/enum_flags.h"
 #include "common/util/expandable_tree_view.h"
+#include "common/util/flat_interval_set.h"
 #include "common/util/interval.h"
 #include "common/util/interval_set.h"
 #include "common/util/iterator_range.h"
 #include "common/util/logging.h"
 #include "common/util/spacer.h"
+#include "common/util/thread_pool.h"
+#include "common/util/trace.h"
 #include "common/util/tree_operations.h"
 #include "common/util/vector_tree.h"
 #include "common/util/vector_tree_iterators.h"
@@ -81,6 +92,32 @@ using verible::VectorTreeLeavesIterator;
 
 using partition_node_type = VectorTree<TreeViewNodeInfo<TokenPartitionTree>>;
 
+static const verible::EnumNameMap<VerificationLevel>&
+VerificationLevelStrings() {
+  static const verible::EnumNameMap<VerificationLevel>
+      kVerificationLevelStringMap({
+          {"full", VerificationLevel::kFull},
+          {"lexical", VerificationLevel::kLexical},
+      });
+  return kVerificationLevelStringMap;
+}
+
+std::ostream& operator<<(std::ostream& stream, VerificationLevel p) {
+  return VerificationLevelStrings().Unparse(p, stream);
+}
+
+bool AbslParseFlag(absl::string_view text, VerificationLevel* mode,
+                   std::string* error) {
+  return VerificationLevelStrings().Parse(text, mode, error,
+                                          "VerificationLevel");
+}
+
+std::string AbslUnparseFlag(const VerificationLevel& mode) {
+  std::ostringstream stream;
+  stream << mode;
+  return stream.str();
+}
+
 // Takes a TextStructureView and FormatStyle, and formats UnwrappedLines.
 class Formatter {
  public:
@@ -88,6 +125,9 @@ class Formatter {
             const FormatStyle& style)
       : text_structure_(text_structure), style_(style) {}
 
+  // Returns the formatted lines to the buffers they were taken from.
+  ~Formatter();
+
   // Formats the source code
   Status Format(const ExecutionControl&);
 
@@ -95,11 +135,25 @@ class Formatter {
 
   void SelectLines(const LineNumberSet& lines);
 
-  // Outputs all of the FormattedExcerpt lines to stream.
+  // Appends all of the FormattedExcerpt lines to "output", which is grown
+  // once to their exact size.
   // If "include_disabled" is false, does not contain the disabled ranges.
-  void Emit(bool include_disabled, std::ostream& stream) const;
+  void Emit(bool include_disabled, std::string* output) const;
+
+  // Returns true if Emit(true, ...) would output exactly "expected".
+  // The comparison stops at the first difference and does not build the
+  // output text.
+  bool EmitMatches(absl::string_view expected) const;
 
  private:
+  // Passes the output of Emit() to "sink" in pieces, as
+  // FormattedExcerpt::AppendFormattedText() does.  "disabled_ranges" are the
+  // disabled_ranges_, which are swept along with the output.
+  template <class Sink>
+  void EmitTo(bool include_disabled,
+              const verible::FlatIntervalSet<int>& disabled_ranges,
+              Sink* sink) const;
+
   // Contains structural information about the code to format, such as
   // TokenSequence from lexing, and ConcreteSyntaxTree from parsing
   const verible::TextStructureView& text_structure_;
@@ -112,19 +166,61 @@ class Formatter {
 
   // Set of formatted lines, populated by calling Format().
   std::vector<verible::FormattedExcerpt> formatted_lines_;
+
+  // The buffers of the last Format() call, which formatted_lines_ was taken
+  // from, or nullptr.
+  FormatterBuffers* buffers_ = nullptr;
 };
 
-// TODO(b/148482625): make this public/re-usable for general content comparison.
-Status VerifyFormatting(const verible::TextStructureView& text_structure,
-                        absl::string_view formatted_output,
-                        absl::string_view filename) {
-  // Verify that the formatted output creates the same lexical
-  // stream (filtered) as the original.  If any tokens were lost, fall back to
-  // printing the original source unformatted.
+struct FormatterBuffers::Arrays {
+  UnwrapperData unwrapper_data;
+  std::vector<UnwrappedLine> unwrapped_lines;
+  std::vector<verible::FormattedExcerpt> formatted_lines;
+};
+
+FormatterBuffers::FormatterBuffers() : arrays_(std::make_unique<Arrays>()) {}
+
+FormatterBuffers::~FormatterBuffers() = default;
+
+Formatter::~Formatter() {
+  if (buffers_ == nullptr) return;
+  formatted_lines_.clear();
+  buffers_->arrays_->formatted_lines.swap(formatted_lines_);
+}
+
+// Checks that "formatted_output" lexes into the same tokens as the original
+// text, ignoring whitespace.
+static Status VerifyLexicalEquivalence(absl::string_view original_text,
+                                       absl::string_view formatted_output) {
+  // Filter out only whitespaces and compare.
+  // First difference will be printed to cerr for debugging.
+  std::ostringstream errstream;
+  // Note: The original text structure contains a token stream that has
+  // already been transformed by the analyzer (e.g. expanded MacroArgs), so
+  // both texts are lexed again here.
+  // See analysis/verilog_equivalence.cc implementation.
+  if (verilog::FormatEquivalent(original_text, formatted_output, &errstream) !=
+      DiffStatus::kEquivalent) {
+    return absl::DataLossError(absl::StrCat(
+        "Formatted output is lexically different from the input.    "
+        "Please file a bug.  Details:\n",
+        errstream.str()));
+  }
+  return absl::OkStatus();
+}
+
+// Re-parses "formatted_output", and verifies that it creates the same lexical
+// stream (filtered) as "text_structure".  On success, returns the analysis of
+// "formatted_output", which the convergence check formats once more.
+static absl::StatusOr<std::unique_ptr<VerilogAnalyzer>> ReanalyzeFormatting(
+    const verible::TextStructureView& text_structure,
+    absl::string_view formatted_output, absl::string_view filename) {
+  // If any tokens were lost, fall back to printing the original source
+  // unformatted.
   // Note: We cannot just Tokenize() and compare because Analyze()
   // performs additional transformations like expanding MacroArgs to
   // expression subtrees.
-  const auto reanalyzer = VerilogAnalyzer::AnalyzeAutomaticMode(
+  auto reanalyzer = VerilogAnalyzer::AnalyzeAutomaticMode(
       formatted_output, filename, verilog::VerilogPreprocess::Config());
   const auto relex_status = ABSL_DIE_IF_NULL(reanalyzer)->LexStatus();
   const auto reparse_status = reanalyzer->ParseStatus();
@@ -140,74 +236,70 @@ Status VerifyFormatting(const verible::TextStructureView& text_structure,
     }
   }
 
-  {
-    // Filter out only whitespaces and compare.
-    // First difference will be printed to cerr for debugging.
-    std::ostringstream errstream;
-    // Note: text_structure.TokenStream() and reanalyzer->Data().TokenStream()
-    // contain already lexed tokens, so this comparison check is repeating the
-    // work done by the lexers.
-    // Should performance be a concern, we could pass in those tokens to
-    // avoid lexing twice, but for now, using plain strings as an interface
-    // to comparator functions is simpler and more intuitive.
-    // See analysis/verilog_equivalence.cc implementation.
-    if (verilog::FormatEquivalent(text_structure.Contents(), formatted_output,
-                                  &errstream) != DiffStatus::kEquivalent) {
-      return absl::DataLossError(absl::StrCat(
-          "Formatted output is lexically different from the input.    "
-          "Please file a bug.  Details:\n",
-          errstream.str()));
-    }
+  if (Status lexical_status = VerifyLexicalEquivalence(
+          text_structure.Contents(), formatted_output);
+      !lexical_status.ok()) {
+    return lexical_status;
   }
+  return reanalyzer;
+}
 
-  return absl::OkStatus();
+// TODO(b/148482625): make this public/re-usable for general content comparison.
+Status VerifyFormatting(const verible::TextStructureView& text_structure,
+                        absl::string_view formatted_output,
+                        absl::string_view filename) {
+  return ReanalyzeFormatting(text_structure, formatted_output, filename)
+      .status();
 }
 
-static Status ReformatVerilogIncrementally(absl::string_view original_text,
-                                           absl::string_view formatted_text,
-                                           absl::string_view filename,
-                                           const FormatStyle& style,
-                                           std::ostream& reformat_stream,
-                                           const ExecutionControl& control) {
-  // Differences from the first formatting.
-  const verible::LineDiffs formatting_diffs(original_text, formatted_text);
-  // Added lines will be re-applied to incremental re-formatting.
-  LineNumberSet formatted_lines(
-      verible::DiffEditsToAddedLineNumbers(formatting_diffs.edits));
-  // Even if no line were changed by formatting, need to make sure that
-  // reformatting does not accidentally reformat the whole file by
-  // adding an out-of-range lines interval.  This effectively disables
-  // re-formatting on the whole file unless line ranges are specified.
-  formatted_lines.Add(formatting_diffs.after_lines.size() + 1);
-  VLOG(1) << "formatted changed lines: " << formatted_lines;
-  return FormatVerilog(formatted_text, filename, style, reformat_stream,
-                       formatted_lines, control);
-}
-
-static Status ReformatVerilog(absl::string_view original_text,
-                              absl::string_view formatted_text,
-                              absl::string_view filename,
-                              const FormatStyle& style,
-                              std::ostream& reformat_stream,
-                              const LineNumberSet& lines,
-                              const ExecutionControl& control) {
-  // Disable reformat check to terminate recursion.
-  ExecutionControl convergence_control(control);
-  convergence_control.verify_convergence = false;
+// Formats the already parsed "formatted_structure" once more, and verifies
+// that this makes no further changes:
+//   format(format(text)) == format(text)
+// 'original_text' and 'lines' are those of the first formatting.
+static Status VerifyConvergence(
+    absl::string_view original_text,
+    const verible::TextStructureView& formatted_structure,
+    const FormatStyle& style, const LineNumberSet& lines,
+    const ExecutionControl& control) {
+  const absl::string_view formatted_text(formatted_structure.Contents());
+  LineNumberSet reformat_lines;
+  if (!lines.empty()) {
+    // Reformat incrementally.
+    // Differences from the first formatting.
+    const verible::LineDiffs formatting_diffs(original_text, formatted_text);
+    // Added lines will be re-applied to incremental re-formatting.
+    reformat_lines = LineNumberSet(
+        verible::DiffEditsToAddedLineNumbers(formatting_diffs.edits));
+    // Even if no line were changed by formatting, need to make sure that
+    // reformatting does not accidentally reformat the whole file by
+    // adding an out-of-range lines interval.  This effectively disables
+    // re-formatting on the whole file unless line ranges are specified.
+    reformat_lines.Add(formatting_diffs.after_lines.size() + 1);
+    VLOG(1) << "formatted changed lines: " << reformat_lines;
+  }
 
-  if (lines.empty()) {
-    // format whole file
-    return FormatVerilog(formatted_text, filename, style, reformat_stream,
-                         lines, convergence_control);
+  ExecutionControl reformat_control(control);
+  reformat_control.statistics = nullptr;
+  reformat_control.comment_directives = nullptr;  // of the original text
+  reformat_control.show_largest_alignment_groups = 0;
+  Formatter fmt(formatted_structure, style);
+  fmt.SelectLines(reformat_lines);
+  if (Status reformat_status = fmt.Format(reformat_control);
+      !reformat_status.ok()) {
+    return reformat_status;
   }
-  // reformat incrementally
-  return ReformatVerilogIncrementally(original_text, formatted_text, filename,
-                                      style, reformat_stream,
-                                      convergence_control);
+  if (fmt.EmitMatches(formatted_text)) return absl::OkStatus();
+
+  // Only render the re-formatted text to diagnose the difference.
+  std::string reformatted_text;
+  fmt.Emit(true, &reformatted_text);
+  return verible::ReformatMustMatch(original_text, lines, formatted_text,
+                                    reformatted_text);
 }
 
 static absl::StatusOr<std::unique_ptr<VerilogAnalyzer>> ParseWithStatus(
-    absl::string_view text, absl::string_view filename) {
+    const std::shared_ptr<verible::MemBlock>& text,
+    absl::string_view filename) {
   std::unique_ptr<VerilogAnalyzer> analyzer =
       VerilogAnalyzer::AnalyzeAutomaticMode(
           text, filename, verilog::VerilogPreprocess::Config());
@@ -230,11 +322,16 @@ static absl::StatusOr<std::unique_ptr<VerilogAnalyzer>> ParseWithStatus(
   return analyzer;
 }
 
-absl::Status FormatVerilog(const verible::TextStructureView& text_structure,
-                           absl::string_view filename, const FormatStyle& style,
-                           std::string* formatted_text,
-                           const verible::LineNumberSet& lines,
-                           const ExecutionControl& control) {
+// Formats "text_structure" into "formatted_text", and verifies the result at
+// the level selected in "control".  With full verification, "reanalyzer"
+// receives the parse of "formatted_text".
+static Status FormatAndVerify(const verible::TextStructureView& text_structure,
+                              absl::string_view filename,
+                              const FormatStyle& style,
+                              std::string* formatted_text,
+                              const verible::LineNumberSet& lines,
+                              const ExecutionControl& control,
+                              std::unique_ptr<VerilogAnalyzer>* reanalyzer) {
   Formatter fmt(text_structure, style);
   fmt.SelectLines(lines);
 
@@ -255,49 +352,71 @@ absl::Status FormatVerilog(const verible::TextStructureView& text_structure,
   }
 
   // Render formatted text to the output buffer.
-  std::ostringstream output_buffer;
-  fmt.Emit(true, output_buffer);
-  *formatted_text = output_buffer.str();
-
-  // For now, unconditionally verify.
-  if (Status verify_status =
-          VerifyFormatting(text_structure, *formatted_text, filename);
-      !verify_status.ok()) {
-    return verify_status;
+  formatted_text->clear();
+  fmt.Emit(true, formatted_text);
+
+  switch (control.verification) {
+    case VerificationLevel::kLexical:
+      if (Status verify_status = VerifyLexicalEquivalence(
+              text_structure.Contents(), *formatted_text);
+          !verify_status.ok()) {
+        return verify_status;
+      }
+      break;
+    case VerificationLevel::kFull: {
+      auto verified =
+          ReanalyzeFormatting(text_structure, *formatted_text, filename);
+      if (!verified.ok()) return verified.status();
+      *reanalyzer = std::move(*verified);
+      break;
+    }
   }
 
   return format_status;
 }
 
+absl::Status FormatVerilog(const verible::TextStructureView& text_structure,
+                           absl::string_view filename, const FormatStyle& style,
+                           std::string* formatted_text,
+                           const verible::LineNumberSet& lines,
+                           const ExecutionControl& control) {
+  std::unique_ptr<VerilogAnalyzer> reanalyzer;
+  return FormatAndVerify(text_structure, filename, style, formatted_text,
+                         lines, control, &reanalyzer);
+}
+
 Status FormatVerilog(absl::string_view text, absl::string_view filename,
                      const FormatStyle& style, std::ostream& formatted_stream,
                      const LineNumberSet& lines,
                      const ExecutionControl& control) {
+  return FormatVerilog(std::make_shared<verible::StringMemBlock>(text),
+                       filename, style, formatted_stream, lines, control);
+}
+
+Status FormatVerilog(const std::shared_ptr<verible::MemBlock>& text,
+                     absl::string_view filename, const FormatStyle& style,
+                     std::ostream& formatted_stream, const LineNumberSet& lines,
+                     const ExecutionControl& control) {
   const auto analyzer = ParseWithStatus(text, filename);
   if (!analyzer.ok()) return analyzer.status();
 
   const verible::TextStructureView& text_structure = analyzer->get()->Data();
   std::string formatted_text;
-  Status format_status = FormatVerilog(text_structure, filename, style,
-                                       &formatted_text, lines, control);
+  std::unique_ptr<VerilogAnalyzer> reanalyzer;
+  Status format_status =
+      FormatAndVerify(text_structure, filename, style, &formatted_text, lines,
+                      control, &reanalyzer);
   // Commit formatted text to the output stream independent of status.
   formatted_stream << formatted_text;
   if (!format_status.ok()) return format_status;
 
   // When formatting whole-file (no --lines are specified), ensure that
   // the formatting transformation is convergent after one iteration.
-  //   format(format(text)) == format(text)
-  if (control.verify_convergence) {
-    std::ostringstream reformat_stream;
-    if (auto reformat_status =
-            ReformatVerilog(text, formatted_text, filename, style,
-                            reformat_stream, lines, control);
-        !reformat_status.ok()) {
-      return reformat_status;
-    }
-    const std::string& reformatted_text(reformat_stream.str());
-    return verible::ReformatMustMatch(text, lines, formatted_text,
-                                      reformatted_text);
+  // This reuses the parse of the formatted text made for verification, so
+  // there is none at lexical-only verification.
+  if (control.verify_convergence && reanalyzer != nullptr) {
+    return VerifyConvergence(text->AsStringView(), reanalyzer->Data(), style,
+                             lines, control);
   }
   return format_status;
 }
@@ -323,9 +442,8 @@ absl::Status FormatVerilogRange(const verible::TextStructureView& structure,
     return absl::CancelledError("Halting for diagnostic operation.");
   }
 
-  std::ostringstream output_buffer;
-  fmt.Emit(false, output_buffer);
-  *formatted_text = output_buffer.str();
+  formatted_text->clear();
+  fmt.Emit(false, formatted_text);
 
   // The range-format can output a spurious newline in the beginning (#1150).
   // Whitespace handling needs some rework in the formatter, and it is not
@@ -355,7 +473,8 @@ absl::Status FormatVerilogRange(absl::string_view full_content,
                                 std::string* formatted_text,
                                 const verible::Interval<int>& line_range,
                                 const ExecutionControl& control) {
-  const auto analyzer = ParseWithStatus(full_content, filename);
+  const auto analyzer = ParseWithStatus(
+      std::make_shared<verible::StringMemBlock>(full_content), filename);
   if (!analyzer.ok()) return analyzer.status();
   return FormatVerilogRange(analyzer->get()->Data(), style, formatted_text,
                             line_range, control);
@@ -607,6 +726,33 @@ static void PrintLargestPartitions(
   stream << hline << std::endl;
 }
 
+static void PrintLargestAlignmentGroups(
+    std::ostream& stream,
+    std::vector<verible::AlignmentGroupSummary> group_summaries,
+    size_t max_groups, const verible::LineColumnMap& line_column_map,
+    absl::string_view base_text) {
+  stream << "Showing the " << max_groups
+         << " largest alignment groups:" << std::endl;
+  // Ties keep the order of the text.
+  std::stable_sort(group_summaries.begin(), group_summaries.end(),
+                   [](const verible::AlignmentGroupSummary& a,
+                      const verible::AlignmentGroupSummary& b) {
+                     return a.rows > b.rows;
+                   });
+  if (group_summaries.size() > max_groups) group_summaries.resize(max_groups);
+  for (const auto& group : group_summaries) {
+    stream << "[" << group.rows << " rows, " << group.tokens << " tokens";
+    if (!group.first_token_text.empty()) {
+      stream << ", starting at line:col "
+             << line_column_map.GetLineColAtOffset(
+                    base_text,
+                    std::distance(base_text.begin(),
+                                  group.first_token_text.begin()));
+    }
+    stream << "]" << std::endl;
+  }
+}
+
 std::ostream& ExecutionControl::Stream() const {
   return (stream != nullptr) ? *stream : std::cout;
 }
@@ -794,42 +940,216 @@ class ContinuationCommentAligner {
   int formatted_column_ = kInvalidColumn;
 };
 
+// Returns true if partitions with this policy are reshaped or aligned together
+// with their whole subtree.
+static bool FormatsSubpartitionsTogether(PartitionPolicyEnum policy) {
+  switch (policy) {
+    case PartitionPolicyEnum::kAppendFittingSubPartitions:
+    case PartitionPolicyEnum::kJuxtaposition:
+    case PartitionPolicyEnum::kStack:
+    case PartitionPolicyEnum::kWrap:
+    case PartitionPolicyEnum::kJuxtapositionOrIndentedStack:
+    case PartitionPolicyEnum::kTabularAlignment:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the smallest partition that must be formatted to produce the same
+// output for all format-enabled text as formatting the whole tree would.
+// Every token outside of it (including its preceding spaces) is
+// format-disabled.  Returns nullptr if no token is format-enabled.
+static TokenPartitionTree* FindFormattingRegion(
+    absl::string_view full_text, const ByteOffsetSet& disabled_ranges,
+    const std::vector<verible::PreFormatToken>& ftokens,
+    TokenPartitionTree* root) {
+  const auto is_enabled = [&](size_t index) {
+    const int begin =
+        index == 0 ? 0 : ftokens[index - 1].token->right(full_text);
+    return !disabled_ranges.Contains(
+        verible::Interval<int>{begin, ftokens[index].token->right(full_text)});
+  };
+  size_t first = 0;
+  while (first < ftokens.size() && !is_enabled(first)) ++first;
+  if (first == ftokens.size()) return nullptr;
+  size_t last = ftokens.size() - 1;
+  while (!is_enabled(last)) --last;
+
+  const auto leaf_containing = [&](size_t index) {
+    const auto token = ftokens.begin() + index;
+    TokenPartitionTree* node = root;
+    while (!is_leaf(*node)) {
+      auto& children = node->Children();
+      const auto child = std::find_if(
+          children.begin(), children.end(),
+          [token](const TokenPartitionTree& child) {
+            return child.Value().TokensRange().end() > token;
+          });
+      if (child == children.end()) break;
+      node = &*child;
+    }
+    return node;
+  };
+  TokenPartitionTree* region = verible::NearestCommonAncestor(
+      *leaf_containing(first), *leaf_containing(last));
+  if (region == nullptr) return nullptr;
+
+  // Reshaping and alignment of an ancestor can change any of its tokens.
+  for (auto* node = region->Parent(); node != nullptr; node = node->Parent()) {
+    if (FormatsSubpartitionsTogether(node->Value().PartitionPolicy())) {
+      region = node;
+    }
+  }
+  // Ancestors that span more tokens contain format-disabled ones and are
+  // always expanded, but one that spans the same tokens could be joined into
+  // a single line.  Aligned argument lists also look at their parent.
+  while (region->Parent() != nullptr) {
+    const auto tokens = region->Value().TokensRange();
+    const auto parent_tokens = region->Parent()->Value().TokensRange();
+    if (region->Value().PartitionPolicy() !=
+            PartitionPolicyEnum::kTabularAlignment &&
+        (parent_tokens.begin() != tokens.begin() ||
+         parent_tokens.end() != tokens.end())) {
+      break;
+    }
+    region = region->Parent();
+  }
+  return region;
+}
+
+// Returns the index range of the format tokens that are not entirely
+// format-disabled, widened by one token on each side: the first of them can
+// take its spacing from the annotation of the token before it, and the token
+// after the last of them starts a disabled range whose preserved spaces depend
+// on its break decision.  All other tokens print verbatim unless they are in
+// the formatting region.
+static std::pair<size_t, size_t> EnabledTokenIndexRange(
+    absl::string_view full_text, const ByteOffsetSet& disabled_ranges,
+    const std::vector<verible::PreFormatToken>& ftokens) {
+  const auto is_enabled = [&](size_t index) {
+    const auto& token = *ftokens[index].token;
+    return !disabled_ranges.Contains(verible::Interval<int>{
+        token.left(full_text), token.right(full_text)});
+  };
+  size_t first = 0;
+  while (first < ftokens.size() && !is_enabled(first)) ++first;
+  if (first == ftokens.size()) return {0, 0};
+  size_t last = ftokens.size() - 1;
+  while (!is_enabled(last)) --last;
+  return {first == 0 ? 0 : first - 1, std::min(last + 2, ftokens.size())};
+}
+
+// Appends lines that print all of (format-disabled) tokens verbatim, one per
+// line of original text.
+static void AppendPreservedLines(verible::FormatTokenRange tokens,
+                                 std::vector<UnwrappedLine>* lines) {
+  for (auto iter = tokens.begin(); iter != tokens.end(); ++iter) {
+    if (iter == tokens.begin() ||
+        absl::StrContains(
+            verible::make_string_view_range(std::prev(iter)->Text().end(),
+                                            iter->Text().begin()),
+            '\n')) {
+      lines->emplace_back(0, iter, PartitionPolicyEnum::kAlreadyFormatted);
+    }
+    lines->back().SpanNextToken();
+  }
+}
+
 Status Formatter::Format(const ExecutionControl& control) {
   const absl::string_view full_text(text_structure_.Contents());
   const auto& token_stream(text_structure_.TokenStream());
 
+  // The arrays of this pass live in control.buffers if given, so that they
+  // keep their storage for the next file.
+  FormatterBuffers::Arrays local_arrays;
+  FormatterBuffers::Arrays& arrays = control.buffers != nullptr
+                                         ? *control.buffers->arrays_
+                                         : local_arrays;
+  if (control.buffers != nullptr && buffers_ == nullptr) {
+    buffers_ = control.buffers;
+    formatted_lines_.swap(arrays.formatted_lines);
+    formatted_lines_.clear();
+  }
+
   // Initialize auxiliary data needed for TreeUnwrapper.
-  UnwrapperData unwrapper_data(token_stream);
+  UnwrapperData& unwrapper_data = arrays.unwrapper_data;
+  unwrapper_data.Reset(token_stream);
 
   // Partition input token stream into hierarchical set of UnwrappedLines.
   TreeUnwrapper tree_unwrapper(text_structure_, style_,
                                unwrapper_data.preformatted_tokens);
 
+  // Worker threads are shared by all steps of this pass that run
+  // concurrently.
+  std::unique_ptr<verible::ThreadPool> thread_pool;
+  if (control.line_wrap_search_threads > 1) {
+    thread_pool =
+        std::make_unique<verible::ThreadPool>(control.line_wrap_search_threads);
+  }
+
+  auto& ftokens = unwrapper_data.preformatted_tokens;
+  std::pair<size_t, size_t> annotated_tokens(0, ftokens.size());
+  if (!disabled_ranges_.empty()) {
+    annotated_tokens =
+        EnabledTokenIndexRange(full_text, disabled_ranges_, ftokens);
+  }
+
   const TokenPartitionTree* format_tokens_partitions = nullptr;
-  // TODO(fangism): The following block could be parallelized because
-  // full-partitioning does not depend on format annotations.
   {
+    // Finding the disabled ranges only reads the token stream and the syntax
+    // tree, so it can run while the format tokens are annotated.
+    const std::function<ByteOffsetSet()> find_disabled_ranges = [&]() {
+      // Determine ranges of disabling the formatter, based on comment
+      // controls.
+      ByteOffsetSet disabled_ranges(
+          control.comment_directives != nullptr
+              ? DisableFormattingRanges(full_text, *control.comment_directives)
+              : DisableFormattingRanges(full_text, token_stream));
+
+      // Find disabled formatting ranges for specific syntax tree node types.
+      // These are typically temporary workarounds for sections that users
+      // habitually prefer to format themselves.
+      if (const auto& root = text_structure_.SyntaxTree()) {
+        DisableSyntaxBasedRanges(&disabled_ranges, *root, style_, full_text);
+      }
+      return disabled_ranges;
+    };
+    std::future<ByteOffsetSet> disabled_ranges;
+    if (thread_pool != nullptr) {
+      disabled_ranges = thread_pool->ExecAsync(find_disabled_ranges);
+    }
+
     // Annotate inter-token information between all adjacent PreFormatTokens.
     // This must be done before any decisions about ExpandableTreeView
     // can be made because they depend on minimum-spacing, and must-break.
-    AnnotateFormattingInformation(style_, text_structure_,
-                                  &unwrapper_data.preformatted_tokens);
-
-    // Determine ranges of disabling the formatter, based on comment controls.
-    disabled_ranges_.Union(DisableFormattingRanges(full_text, token_stream));
-
-    // Find disabled formatting ranges for specific syntax tree node types.
-    // These are typically temporary workarounds for sections that users
-    // habitually prefer to format themselves.
-    if (const auto& root = text_structure_.SyntaxTree()) {
-      DisableSyntaxBasedRanges(&disabled_ranges_, *root, style_, full_text);
+    // When only some lines are enabled, the tokens away from them are
+    // annotated later, if they are formatted at all.
+    {
+      const verible::ScopedTrace trace("annotate", "format");
+      if (annotated_tokens.first == 0 &&
+          annotated_tokens.second == ftokens.size()) {
+        AnnotateFormattingInformation(style_, text_structure_, &ftokens);
+      } else {
+        verible::ConnectPreFormatTokensPreservedSpaceStarts(full_text.begin(),
+                                                            &ftokens);
+        AnnotateFormatTokenRange(style_, text_structure_,
+                                 annotated_tokens.first,
+                                 annotated_tokens.second, &ftokens);
+      }
     }
 
+    disabled_ranges_.Union(disabled_ranges.valid() ? disabled_ranges.get()
+                                                   : find_disabled_ranges());
+
     // Disable formatting ranges.
     verible::PreserveSpacesOnDisabledTokenRanges(
         &unwrapper_data.preformatted_tokens, disabled_ranges_, full_text);
 
     // Partition PreFormatTokens into candidate unwrapped lines.
+    // This has to wait for the annotations and disabled ranges, because
+    // some partitions are reshaped depending on must-wrap decisions.
+    const verible::ScopedTrace trace("unwrap", "format");
     format_tokens_partitions = tree_unwrapper.Unwrap();
   }
 
@@ -852,42 +1172,178 @@ Status Formatter::Format(const ExecutionControl& control) {
     }
   }
 
+  // When only some lines are formatted, the rest of the text is printed
+  // verbatim, so only the partition that spans the enabled lines needs to be
+  // reshaped, aligned and searched for line wraps.
+  TokenPartitionTree* region = tree_unwrapper.CurrentTokenPartition();
+  if (!disabled_ranges_.empty()) {
+    if (auto* enabled_region =
+            FindFormattingRegion(full_text, disabled_ranges_,
+                                 unwrapper_data.preformatted_tokens, region)) {
+      region = enabled_region;
+    }
+  }
+  {
+    // The rest of the region's tokens are format-disabled, but the passes
+    // below still look at their spacing.  Their break decisions were already
+    // final when the partitions were built.
+    const auto region_tokens = region->Value().TokensRange();
+    const size_t region_begin = region_tokens.begin() - ftokens.cbegin();
+    const size_t region_end = region_tokens.end() - ftokens.cbegin();
+    const auto annotate_disabled = [&](size_t begin, size_t end) {
+      if (begin >= end) return;
+      AnnotateFormatTokenRange(style_, text_structure_, begin, end, &ftokens);
+      for (size_t i = begin; i < end; ++i) {
+        ftokens[i].before.break_decision = verible::SpacingOptions::kPreserve;
+      }
+    };
+    annotate_disabled(region_begin,
+                      std::min(region_end, annotated_tokens.first));
+    annotate_disabled(std::max(region_begin, annotated_tokens.second),
+                      region_end);
+  }
+
   {  // In this pass, perform additional modifications to the partitions and
      // spacings.
-    tree_unwrapper.ApplyPreOrder([&](TokenPartitionTree& node) {
-      const auto& uwline = node.Value();
-      const auto partition_policy = uwline.PartitionPolicy();
-
-      switch (partition_policy) {
-        case PartitionPolicyEnum::kAppendFittingSubPartitions:
-          // Reshape partition tree with kAppendFittingSubPartitions policy
-          verible::ReshapeFittingSubpartitions(style_, &node);
-          break;
-        case PartitionPolicyEnum::kJuxtaposition:
-        case PartitionPolicyEnum::kStack:
-        case PartitionPolicyEnum::kWrap:
-        case PartitionPolicyEnum::kJuxtapositionOrIndentedStack:
-          verible::OptimizeTokenPartitionTree(style_, &node);
-          break;
-        case PartitionPolicyEnum::kTabularAlignment:
-          // TODO(b/145170750): Adjust inter-token spacing to achieve alignment,
-          // but leave partitioning intact.
-          // This relies on inter-token spacing having already been annotated.
-          TabularAlignTokenPartitions(style_, full_text, disabled_ranges_,
-                                      &node);
-          break;
-        default:
-          break;
+    const verible::ScopedTrace trace("align", "format");
+    const bool collect_alignment_groups =
+        control.show_largest_alignment_groups != 0;
+    // Reshapes or aligns one partition, leaving its subpartitions to later
+    // calls.
+    const auto shape_partition =
+        [&](TokenPartitionTree& node, verible::LayoutFunctionCache* cache,
+            std::vector<verible::AlignmentGroupSummary>* alignment_groups,
+            std::vector<std::string>* over_budget_partitions) {
+          const auto& uwline = node.Value();
+          const auto partition_policy = uwline.PartitionPolicy();
+
+          switch (partition_policy) {
+            case PartitionPolicyEnum::kAppendFittingSubPartitions:
+              // Reshape partition tree with kAppendFittingSubPartitions policy
+              verible::ReshapeFittingSubpartitions(style_, &node);
+              break;
+            case PartitionPolicyEnum::kJuxtaposition:
+            case PartitionPolicyEnum::kStack:
+            case PartitionPolicyEnum::kWrap:
+            case PartitionPolicyEnum::kJuxtapositionOrIndentedStack: {
+              // Reshaping replaces the partition.
+              const UnwrappedLine partition = uwline;
+              if (!verible::OptimizeTokenPartitionTree(
+                      style_, &node, cache, control.layout_optimizer_budget)) {
+                std::ostringstream printed;
+                printed << partition;
+                over_budget_partitions->push_back(printed.str());
+              }
+              break;
+            }
+            case PartitionPolicyEnum::kTabularAlignment:
+              // TODO(b/145170750): Adjust inter-token spacing to achieve
+              // alignment, but leave partitioning intact.
+              // This relies on inter-token spacing having already been
+              // annotated.
+              TabularAlignTokenPartitions(
+                  style_, full_text, disabled_ranges_, &node,
+                  collect_alignment_groups ? alignment_groups : nullptr);
+              break;
+            default:
+              break;
+          }
+        };
+
+    // Sibling partitions span disjoint ranges of tokens, and once their
+    // parent is shaped, each subtree is shaped without looking at the
+    // others.  So with worker threads, large partitions are shaped here, and
+    // their smaller subtrees are handed to the workers, each with its own
+    // layout cache and alignment summaries.  The pieces are kept in
+    // pre-order, so that the summaries come out in the serial order.
+    struct SubtreeShaping {
+      // All partitions span tokens of the same array, so layouts of repeated
+      // partitions are reused across the partitions of one piece.
+      verible::LayoutFunctionCache layout_cache;
+      std::vector<verible::AlignmentGroupSummary> alignment_groups;
+      std::vector<std::string> over_budget_partitions;
+      std::future<void> done;  // Invalid for the partitions shaped here.
+    };
+    std::deque<SubtreeShaping> pieces;
+    const auto shape_subtree = [&](TokenPartitionTree& subtree,
+                                   SubtreeShaping* piece) {
+      verible::ApplyPreOrder(subtree, [&](TokenPartitionTree& node) {
+        shape_partition(node, &piece->layout_cache, &piece->alignment_groups,
+                        &piece->over_budget_partitions);
+      });
+    };
+    if (thread_pool == nullptr) {
+      shape_subtree(*region, &pieces.emplace_back());
+    } else {
+      // Partitions with more tokens than this are split up further.
+      const size_t max_task_tokens =
+          region->Value().Size() / (4 * control.line_wrap_search_threads) + 1;
+      const std::function<void(TokenPartitionTree&)> split =
+          [&](TokenPartitionTree& node) {
+            if (pieces.empty() || pieces.back().done.valid()) {
+              pieces.emplace_back();
+            }
+            shape_partition(node, &pieces.back().layout_cache,
+                            &pieces.back().alignment_groups,
+                            &pieces.back().over_budget_partitions);
+            for (auto& child : node.Children()) {
+              if (child.Children().size() > 1 &&
+                  child.Value().Size() > max_task_tokens) {
+                split(child);
+                continue;
+              }
+              SubtreeShaping* piece = &pieces.emplace_back();
+              piece->done = thread_pool->ExecAsync(
+                  [&shape_subtree, &child, piece]() {
+                    shape_subtree(child, piece);
+                  });
+            }
+          };
+      split(*region);
+      for (auto& piece : pieces) {
+        if (piece.done.valid()) piece.done.get();
       }
-    });
+    }
+
+    int layout_cache_lookups = 0;
+    int layout_cache_hits = 0;
+    std::vector<verible::AlignmentGroupSummary> alignment_groups;
+    std::vector<std::string> over_budget_partitions;
+    for (auto& piece : pieces) {
+      layout_cache_lookups += piece.layout_cache.Lookups();
+      layout_cache_hits += piece.layout_cache.Hits();
+      alignment_groups.insert(alignment_groups.end(),
+                              piece.alignment_groups.begin(),
+                              piece.alignment_groups.end());
+      over_budget_partitions.insert(
+          over_budget_partitions.end(),
+          std::make_move_iterator(piece.over_budget_partitions.begin()),
+          std::make_move_iterator(piece.over_budget_partitions.end()));
+    }
+    if (collect_alignment_groups) {
+      PrintLargestAlignmentGroups(control.Stream(), std::move(alignment_groups),
+                                  control.show_largest_alignment_groups,
+                                  text_structure_.GetLineColumnMap(),
+                                  full_text);
+    }
+    VLOG(1) << "layout cache: " << layout_cache_hits << " hits of "
+            << layout_cache_lookups << " lookups";
+    if (control.statistics != nullptr) {
+      control.statistics->layout_cache_lookups += layout_cache_lookups;
+      control.statistics->layout_cache_hits += layout_cache_hits;
+      auto& statistics_partitions = control.statistics->over_budget_partitions;
+      statistics_partitions.insert(
+          statistics_partitions.end(),
+          std::make_move_iterator(over_budget_partitions.begin()),
+          std::make_move_iterator(over_budget_partitions.end()));
+    }
   }
 
   // Apply token spacing from partitions to tokens. This is permanent, so it
   // must be done after all reshaping is done.
   {
-    auto* root = tree_unwrapper.CurrentTokenPartition();
-    auto node_iter = VectorTreeLeavesIterator(&LeftmostDescendant(*root));
-    const auto end = ++VectorTreeLeavesIterator(&RightmostDescendant(*root));
+    auto node_iter = VectorTreeLeavesIterator(&LeftmostDescendant(*region));
+    const auto end = ++VectorTreeLeavesIterator(&RightmostDescendant(*region));
 
     // Iterate over leaves. kAlreadyFormatted partitions are either leaves
     // themselves or parents of leaf partitions with kInline policy.
@@ -913,18 +1369,57 @@ Status Formatter::Format(const ExecutionControl& control) {
   }
 
   // Produce sequence of independently operable UnwrappedLines.
-  const auto unwrapped_lines = MakeUnwrappedLinesWorklist(
-      style_, full_text, disabled_ranges_, *format_tokens_partitions,
-      &unwrapper_data.preformatted_tokens);
+  const auto region_tokens = region->Value().TokensRange();
+  std::vector<UnwrappedLine>& unwrapped_lines = arrays.unwrapped_lines;
+  unwrapped_lines.clear();
+  AppendPreservedLines(
+      verible::FormatTokenRange(ftokens.cbegin(), region_tokens.begin()),
+      &unwrapped_lines);
+  {
+    auto region_lines = MakeUnwrappedLinesWorklist(
+        style_, full_text, disabled_ranges_, *region,
+        &unwrapper_data.preformatted_tokens);
+    unwrapped_lines.insert(unwrapped_lines.end(), region_lines.begin(),
+                           region_lines.end());
+  }
+  if (region_tokens.end() != ftokens.cend()) {
+    unwrapped_lines.emplace_back(0, region_tokens.end(),
+                                 PartitionPolicyEnum::kAlreadyFormatted);
+    unwrapped_lines.back().SpanUpToToken(ftokens.cend());
+  }
 
   // For each UnwrappedLine: minimize total penalty of wrap/break decisions.
-  // TODO(fangism): This could be parallelized if results are written
-  // to their own 'slots'.
+  // The searches are independent of each other, so they can be started ahead
+  // of time on worker threads, each writing to its own slot.  Lines that
+  // consist of a single EOL comment might be continuation comments, whose
+  // formatting depends on the previous result, so they are searched lazily.
+  const verible::ScopedTrace search_trace("search", "format");
+  std::vector<std::future<std::vector<verible::FormattedExcerpt>>>
+      line_wrap_searches(unwrapped_lines.size());
+  if (thread_pool != nullptr) {
+    for (size_t i = 0; i < unwrapped_lines.size(); ++i) {
+      const UnwrappedLine& uwline = unwrapped_lines[i];
+      if (uwline.PartitionPolicy() == PartitionPolicyEnum::kAlreadyFormatted ||
+          (uwline.Size() == 1 && uwline.TokensRange().back().TokenEnum() ==
+                                     verilog_tokentype::TK_EOL_COMMENT)) {
+        continue;
+      }
+      line_wrap_searches[i] =
+          thread_pool->ExecAsync<std::vector<verible::FormattedExcerpt>>(
+              [&uwline, this, &control]() {
+                return verible::SearchLineWraps(
+                    uwline, style_, control.max_search_states,
+                    control.line_wrap_beam_width);
+              });
+    }
+  }
+
   std::vector<const UnwrappedLine*> partially_formatted_lines;
   formatted_lines_.reserve(unwrapped_lines.size());
   ContinuationCommentAligner continuation_comment_aligner(
       text_structure_.GetLineColumnMap(), text_structure_.Contents());
-  for (const auto& uwline : unwrapped_lines) {
+  for (size_t i = 0; i < unwrapped_lines.size(); ++i) {
+    const UnwrappedLine& uwline = unwrapped_lines[i];
     // TODO(fangism): Use different formatting strategies depending on
     // uwline.PartitionPolicy().
     if (continuation_comment_aligner.HandleLine(uwline, &formatted_lines_)) {
@@ -936,7 +1431,11 @@ Status Formatter::Format(const ExecutionControl& control) {
     } else {
       // In other case, default to searching for optimal line wrapping.
       const auto optimal_solutions =
-          verible::SearchLineWraps(uwline, style_, control.max_search_states);
+          line_wrap_searches[i].valid()
+              ? line_wrap_searches[i].get()
+              : verible::SearchLineWraps(uwline, style_,
+                                         control.max_search_states,
+                                         control.line_wrap_beam_width);
       if (control.show_equally_optimal_wrappings &&
           optimal_solutions.size() > 1) {
         verible::DisplayEquallyOptimalWrappings(control.Stream(), uwline,
@@ -968,16 +1467,39 @@ Status Formatter::Format(const ExecutionControl& control) {
   return absl::OkStatus();
 }
 
-void Formatter::Emit(bool include_disabled, std::ostream& stream) const {
+template <class Sink>
+void Formatter::EmitTo(bool include_disabled,
+                       const verible::FlatIntervalSet<int>& disabled_ranges,
+                       Sink* sink) const {
   const absl::string_view full_text(text_structure_.Contents());
-  std::function<bool(const verible::TokenInfo&)> include_token_p;
-  if (include_disabled) {
-    include_token_p = [](const verible::TokenInfo&) { return true; };
-  } else {
-    include_token_p = [this, &full_text](const verible::TokenInfo& tok) {
-      return !disabled_ranges_.Contains(tok.left(full_text));
-    };
-  }
+  // Tokens and whitespace are emitted in order, so the disabled ranges are
+  // all checked in a single sweep.
+  verible::FlatIntervalSet<int>::SortedPointsQuery disabled_query(
+      disabled_ranges);
+  const auto include_token_p = [&](const verible::TokenInfo& tok) {
+    return include_disabled || !disabled_query.Contains(tok.left(full_text));
+  };
+
+  std::string mixed_whitespace;  // reused buffer
+  const auto emit_whitespace = [&](absl::string_view whitespace) {
+    const int start = std::distance(full_text.begin(), whitespace.begin());
+    const int end = start + whitespace.length();
+    if (disabled_query.Overlaps(start, std::max(end, start + 1))) {
+      mixed_whitespace.clear();
+      FormatWhitespaceWithDisabledByteRanges(full_text, whitespace,
+                                             disabled_ranges_, include_disabled,
+                                             &mixed_whitespace);
+      sink->Append(mixed_whitespace);
+      return;
+    }
+    // Without disabled ranges, only the newlines are kept, and at least one
+    // unless at the start of the text.
+    const size_t newlines =
+        std::count(whitespace.begin(), whitespace.end(), '\n');
+    if (newlines > 0 || start != 0) {
+      sink->Append(verible::Spacer(std::max<size_t>(newlines, 1), '\n'));
+    }
+  };
 
   int position = 0;  // tracks with the position in the original full_text
   for (const verible::FormattedExcerpt& line : formatted_lines_) {
@@ -987,28 +1509,95 @@ void Formatter::Emit(bool include_disabled, std::ostream& stream) const {
     const auto front_offset =
         line.Tokens().empty() ? position
                               : line.Tokens().front().token->left(full_text);
-    const absl::string_view leading_whitespace(
-        full_text.substr(position, front_offset - position));
-    FormatWhitespaceWithDisabledByteRanges(full_text, leading_whitespace,
-                                           disabled_ranges_, include_disabled,
-                                           stream);
+    emit_whitespace(full_text.substr(position, front_offset - position));
 
     // When front of first token is format-disabled, the previous call will
     // already cover the space up to the front token, in which case,
     // the left-indentation for this line should be suppressed to avoid
     // being printed twice.
     if (!line.Tokens().empty()) {
-      line.FormattedText(stream, !disabled_ranges_.Contains(front_offset),
-                         include_token_p);
+      line.AppendFormattedText(sink, !disabled_query.Contains(front_offset),
+                               include_token_p);
       position = line.Tokens().back().token->right(full_text);
     }
   }
 
   // Handle trailing spaces after last token.
-  const absl::string_view trailing_whitespace(full_text.substr(position));
-  FormatWhitespaceWithDisabledByteRanges(full_text, trailing_whitespace,
-                                         disabled_ranges_, include_disabled,
-                                         stream);
+  emit_whitespace(full_text.substr(position));
+}
+
+namespace {
+// Sinks for Formatter::EmitTo().
+
+// Measures the output.
+class OutputSizeCounter {
+ public:
+  void Append(absl::string_view text) { size_ += text.size(); }
+  void Append(const verible::Spacer& spacer) { size_ += spacer.repeat; }
+
+  size_t Size() const { return size_; }
+
+ private:
+  size_t size_ = 0;
+};
+
+// Appends the output to a string.
+class OutputAppender {
+ public:
+  explicit OutputAppender(std::string* output) : output_(output) {}
+
+  void Append(absl::string_view text) {
+    output_->append(text.data(), text.size());
+  }
+  void Append(const verible::Spacer& spacer) {
+    output_->append(spacer.repeat, spacer.repeated_char);
+  }
+
+ private:
+  std::string* const output_;
+};
+
+// Compares the output with an expected text, instead of storing it.
+class OutputMatcher {
+ public:
+  explicit OutputMatcher(absl::string_view expected) : remaining_(expected) {}
+
+  // Returns true if exactly the expected text was output.
+  bool Matched() const { return matching_ && remaining_.empty(); }
+
+  void Append(absl::string_view text) {
+    if (!matching_) return;  // Ignore the rest of the output.
+    matching_ = absl::ConsumePrefix(&remaining_, text);
+  }
+  void Append(const verible::Spacer& spacer) {
+    if (!matching_) return;
+    matching_ = remaining_.size() >= spacer.repeat &&
+                remaining_.substr(0, spacer.repeat)
+                        .find_first_not_of(spacer.repeated_char) ==
+                    absl::string_view::npos;
+    if (matching_) remaining_.remove_prefix(spacer.repeat);
+  }
+
+ private:
+  absl::string_view remaining_;
+  bool matching_ = true;
+};
+}  // namespace
+
+void Formatter::Emit(bool include_disabled, std::string* output) const {
+  const verible::FlatIntervalSet<int> disabled_ranges(disabled_ranges_);
+  OutputSizeCounter counter;
+  EmitTo(include_disabled, disabled_ranges, &counter);
+  output->reserve(output->size() + counter.Size());
+  OutputAppender appender(output);
+  EmitTo(include_disabled, disabled_ranges, &appender);
+}
+
+bool Formatter::EmitMatches(absl::string_view expected) const {
+  const verible::FlatIntervalSet<int> disabled_ranges(disabled_ranges_);
+  OutputMatcher matcher(expected);
+  EmitTo(true, disabled_ranges, &matcher);
+  return matcher.Matched();
 }
 
 }  // namespace formatter
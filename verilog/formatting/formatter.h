@@ -16,10 +16,15 @@
 #define VERIBLE_VERILOG_FORMATTING_FORMATTER_H_
 
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/comment_directives.h"
+#include "common/formatting/layout_optimizer.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/text/text_structure.h"
 #include "common/util/interval.h"
@@ -28,6 +33,57 @@
 namespace verilog {
 namespace formatter {
 
+// How thoroughly the formatted output is checked against the input.
+enum class VerificationLevel {
+  // Re-parse the output and compare its tokens with those of the input.
+  // This is also the parse that the convergence check formats again.
+  kFull,
+  // Only compare the tokens of input and output, without parsing the output.
+  // There is no convergence check at this level.  Meant for trusted bulk
+  // reformatting where the cost of parsing matters.
+  kLexical,
+};
+
+std::ostream& operator<<(std::ostream&, VerificationLevel);
+
+bool AbslParseFlag(absl::string_view, VerificationLevel*, std::string*);
+
+std::string AbslUnparseFlag(const VerificationLevel&);
+
+// Counters collected while formatting, for diagnostics.
+struct FormatStatistics {
+  // Number of partitions whose optimal layout was looked up in the cache of
+  // layouts of identical partitions, and number of those found there.
+  int layout_cache_lookups = 0;
+  int layout_cache_hits = 0;
+
+  // Printed partitions that exceeded the layout optimizer budget, and were
+  // partly laid out greedily, in text order.
+  std::vector<std::string> over_budget_partitions;
+};
+
+class Formatter;
+
+// Storage of the per-file arrays of the formatter (format tokens, the
+// UnwrappedLines and the formatted excerpts), kept between formatting calls
+// so that formatting many files reuses it instead of allocating it anew for
+// each file.  The arrays are cleared at the start of each use.  Must not be
+// used by concurrent calls, e.g. keep one per thread.
+class FormatterBuffers {
+ public:
+  FormatterBuffers();
+  ~FormatterBuffers();
+
+  FormatterBuffers(const FormatterBuffers&) = delete;
+  FormatterBuffers& operator=(const FormatterBuffers&) = delete;
+
+ private:
+  friend class Formatter;
+  struct Arrays;
+
+  std::unique_ptr<Arrays> arrays_;
+};
+
 // Control over formatter's internal execution phases, mostly for debugging
 // and development.
 struct ExecutionControl {
@@ -35,6 +91,10 @@ struct ExecutionControl {
   // formatting.
   int show_largest_token_partitions = 0;
 
+  // When non-zero, diagnose the largest alignment groups (by rows) after
+  // aligning them, and continue formatting.
+  int show_largest_alignment_groups = 0;
+
   // If true, print the token partition tree, and halt without formatting.
   bool show_token_partition_tree = false;
 
@@ -50,11 +110,46 @@ struct ExecutionControl {
   // If this limit is exceeded, error out with a diagnostic message.
   int max_search_states = 10000;
 
+  // Resources that the layout optimization of one partition spends at most,
+  // like max_search_states for line wrap searches.  Beyond them, the rest of
+  // the partition is laid out greedily, which is reported in statistics.
+  verible::LayoutOptimizerBudget layout_optimizer_budget;
+
+  // If positive, line wrap searches only explore this many of the cheapest
+  // states before each token, which bounds their time at the expense of
+  // optimality.
+  int line_wrap_beam_width = 0;
+
+  // Number of threads used to search line wraps of independent
+  // UnwrappedLines concurrently.  The same threads find the format-disabled
+  // ranges while the format tokens are annotated, and reshape and align
+  // independent subtrees of the partition tree.  Values <= 1 run everything
+  // serially on the calling thread.  The result is the same regardless of
+  // this setting.
+  int line_wrap_search_threads = 0;
+
   // If true, and not running in incremental format mode with lines specified,
   // format the formatted output one more time to compare and check for
   // convergence: format(format(text)) == format(text).
   bool verify_convergence = true;
 
+  // Checks done on the formatted output.
+  VerificationLevel verification = VerificationLevel::kFull;
+
+  // If not null, counters of the formatting (not of the convergence check)
+  // are added to this.
+  FormatStatistics* statistics = nullptr;
+
+  // If not null, the directives of the comments of the TextStructureView to
+  // format, e.g. VerilogAnalyzer::CommentDirectives(), which then provide the
+  // formatter controls without scanning the comments again.  Only valid with
+  // the overloads taking a TextStructureView.
+  const verible::CommentDirectiveIndex* comment_directives = nullptr;
+
+  // If not null, the arrays of the formatting are kept in this, whose
+  // storage is then reused by later calls given the same buffers.
+  FormatterBuffers* buffers = nullptr;
+
   // Output stream for diagnostic feedback (not formatting output).
   // This is useful for seeing diagnostics without waiting for a Status
   // to be returned.
@@ -72,12 +167,20 @@ struct ExecutionControl {
 // 'lines' controls which lines have formattting explicitly enabled.
 // If this is empty, interpret as all lines enabled for formatting.
 // Does verification of the resulting format (re-parse and compare) and
-// convergence test (if enabled in "control")
+// convergence test (if enabled in "control").  The convergence test formats
+// the parse made for verification once more, so the text is parsed twice.
 absl::Status FormatVerilog(absl::string_view text, absl::string_view filename,
                            const FormatStyle& style,
                            std::ostream& formatted_stream,
                            const verible::LineNumberSet& lines = {},
                            const ExecutionControl& control = {});
+// Ditto, but parses "text" in place instead of copying it, e.g. a file
+// mapped into memory by verible::file::GetContentAsMemBlock().
+absl::Status FormatVerilog(const std::shared_ptr<verible::MemBlock>& text,
+                           absl::string_view filename, const FormatStyle& style,
+                           std::ostream& formatted_stream,
+                           const verible::LineNumberSet& lines = {},
+                           const ExecutionControl& control = {});
 // Ditto, but with TextStructureView as input and std::string as output.
 // This does verification of the resulting format, but _no_ convergence test.
 absl::Status FormatVerilog(const verible::TextStructureView& text_structure,
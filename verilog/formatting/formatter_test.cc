@@ -15513,6 +15513,50 @@ TEST(FormatterEndToEndTest, VerilogFormatTest) {
   }
 }
 
+// Tests that aligning and searching line wraps on multiple threads yields the
+// same results as doing it serially.
+TEST(FormatterEndToEndTest, ParallelLineWrapSearch) {
+  FormatStyle style;
+  style.column_limit = 40;
+  style.indentation_spaces = 2;
+  style.wrap_spaces = 4;
+  ExecutionControl control;
+  control.line_wrap_search_threads = 4;
+  for (const auto& test_case : kFormatterTestCases) {
+    std::ostringstream stream;
+    const auto status = FormatVerilog(test_case.input, "<filename>", style,
+                                      stream, {}, control);
+    EXPECT_OK(status) << status.message();
+    EXPECT_EQ(stream.str(), test_case.expected) << "code:\n" << test_case.input;
+  }
+}
+
+// Tests that lexical-only verification yields the same formatting.
+TEST(FormatterEndToEndTest, LexicalVerification) {
+  FormatStyle style;
+  style.column_limit = 40;
+  style.indentation_spaces = 2;
+  style.wrap_spaces = 4;
+  ExecutionControl control;
+  control.verification = VerificationLevel::kLexical;
+  for (const auto& test_case : kFormatterTestCases) {
+    std::ostringstream stream;
+    const auto status = FormatVerilog(test_case.input, "<filename>", style,
+                                      stream, {}, control);
+    EXPECT_OK(status) << status.message();
+    EXPECT_EQ(stream.str(), test_case.expected) << "code:\n" << test_case.input;
+  }
+}
+
+TEST(VerificationLevelTest, ParseFlag) {
+  VerificationLevel level = VerificationLevel::kFull;
+  std::string error;
+  EXPECT_TRUE(AbslParseFlag("lexical", &level, &error));
+  EXPECT_EQ(level, VerificationLevel::kLexical);
+  EXPECT_EQ(AbslUnparseFlag(level), "lexical");
+  EXPECT_FALSE(AbslParseFlag("none", &level, &error));
+}
+
 TEST(FormatterEndToEndTest, AutoInferAlignment) {
   static constexpr FormatterTestCase kTestCases[] = {
       {"", ""},
@@ -16909,6 +16953,41 @@ TEST(FormatterEndToEndTest, ModulePortDeclarationsIndentNotWrap) {
   }
 }
 
+TEST(FormatterEndToEndTest, MaxAlignmentGroupRows) {
+  static constexpr FormatterTestCase kTestCases[] = {
+      {// fits in one group
+       "module foo(input wire x, output reg yy);endmodule\n",
+       "module foo (\n"
+       "    input  wire x,\n"
+       "    output reg  yy\n"
+       ");\n"
+       "endmodule\n"},
+      {// split into two groups of two rows, aligned separately
+       "module foo(input wire x, output reg yy,\n"
+       "input wire xxx, output logic y);endmodule\n",
+       "module foo (\n"
+       "    input  wire x,\n"
+       "    output reg  yy,\n"
+       "    input  wire  xxx,\n"
+       "    output logic y\n"
+       ");\n"
+       "endmodule\n"},
+  };
+  FormatStyle style;
+  style.column_limit = 40;
+  style.indentation_spaces = 2;
+  style.wrap_spaces = 4;
+  style.max_alignment_group_rows = 2;
+  for (const auto& test_case : kTestCases) {
+    VLOG(1) << "code-to-format:\n" << test_case.input << "<EOF>";
+    std::ostringstream stream;
+    const auto status =
+        FormatVerilog(test_case.input, "<filename>", style, stream);
+    EXPECT_OK(status) << status.message();
+    EXPECT_EQ(stream.str(), test_case.expected) << "code:\n" << test_case.input;
+  }
+}
+
 TEST(FormatterEndToEndTest, NamedPortConnectionsIndentNotWrap) {
   static constexpr FormatterTestCase kTestCases[] = {
       {"", ""},
@@ -17364,6 +17443,53 @@ TEST(FormatterEndToEndTest, SelectLines) {
   }
 }
 
+// Tests that formatting only the lines that are not yet formatted gives the
+// same result as formatting the whole file.
+TEST(FormatterEndToEndTest, SelectLinesMatchesFullFormatting) {
+  const SelectLinesTestCase kTestCases[] = {
+      {"module m;\n"
+       "  assign a = 1;\n"
+       "endmodule\n"
+       "module   n ;\n"
+       "assign    b=2;\n"
+       "  endmodule\n",
+       {{4, 7}},
+       "module m;\n"
+       "  assign a = 1;\n"
+       "endmodule\n"
+       "module n;\n"
+       "  assign b = 2;\n"
+       "endmodule\n"},
+      {"module m;\n"
+       "  wire a;\n"
+       "  initial   begin\n"
+       "  x=y  ;\n"
+       "  end\n"
+       "endmodule\n",
+       {{3, 6}},
+       "module m;\n"
+       "  wire a;\n"
+       "  initial begin\n"
+       "    x = y;\n"
+       "  end\n"
+       "endmodule\n"},
+  };
+  FormatStyle style;
+  for (const auto& test_case : kTestCases) {
+    std::ostringstream full_stream;
+    EXPECT_OK(FormatVerilog(test_case.input, "<filename>", style, full_stream));
+    EXPECT_EQ(full_stream.str(), test_case.expected);
+
+    std::ostringstream stream;
+    const auto status = FormatVerilog(test_case.input, "<filename>", style,
+                                      stream, test_case.lines);
+    EXPECT_OK(status) << status.message();
+    EXPECT_EQ(stream.str(), full_stream.str())
+        << "code:\n"
+        << test_case.input << "\nlines: " << test_case.lines;
+  }
+}
+
 // These tests verify the mode where horizontal spacing is discarded while
 // vertical spacing is preserved.
 TEST(FormatterEndToEndTest, PreserveVSpacesOnly) {
@@ -17961,6 +18087,30 @@ TEST(FormatterEndToEndTest, DiagnosticLargestPartitions) {
   }
 }
 
+TEST(FormatterEndToEndTest, DiagnosticLargestAlignmentGroups) {
+  // Use a fixed style.
+  FormatStyle style;
+  style.column_limit = 40;
+  style.indentation_spaces = 2;
+  style.wrap_spaces = 4;
+  for (const auto& test_case : kFormatterTestCases) {
+    std::ostringstream stream, debug_stream;
+    ExecutionControl control;
+    control.stream = &debug_stream;
+    control.show_largest_alignment_groups = 2;
+    const auto status = FormatVerilog(test_case.input, "<filename>", style,
+                                      stream, kEnableAllLines, control);
+    // Unlike the other diagnostics, this one does not stop formatting.
+    EXPECT_OK(status) << status.message();
+    EXPECT_EQ(stream.str(), test_case.expected);
+    if (!debug_stream.str().empty()) {
+      EXPECT_TRUE(
+          absl::StartsWith(debug_stream.str(), "Showing the 2 largest"))
+          << "got: " << debug_stream.str();
+    }
+  }
+}
+
 TEST(FormatterEndToEndTest, DiagnosticEquallyOptimalWrappings) {
   // Use a fixed style.
   FormatStyle style;
@@ -18002,6 +18152,68 @@ TEST(FormatterEndToEndTest, UnfinishedLineWrapSearching) {
   EXPECT_TRUE(absl::StartsWith(status.message(), "***"));
 }
 
+// Test that exceeding the layout optimizer budget still formats the code,
+// and reports the partitions laid out greedily.
+TEST(FormatterEndToEndTest, ExceededLayoutOptimizerBudget) {
+  FormatStyle style;
+  style.column_limit = 40;
+  style.indentation_spaces = 2;
+  style.wrap_spaces = 4;
+
+  const absl::string_view code(
+      "module m;\n"
+      "`uvm_info(\"some_id\", $sformatf(\"a %d b %d\", aaaa, bbbb), "
+      "UVM_LOW)\n"
+      "endmodule\n");
+
+  std::ostringstream stream;
+  FormatStatistics statistics;
+  ExecutionControl control;
+  control.layout_optimizer_budget.max_knots = 1;
+  control.statistics = &statistics;
+  const auto status = FormatVerilog(code, "<filename>", style, stream,
+                                    kEnableAllLines, control);
+  EXPECT_OK(status) << status.message();
+  EXPECT_FALSE(statistics.over_budget_partitions.empty());
+
+  // Within the budget, nothing is reported.
+  std::ostringstream unlimited_stream;
+  FormatStatistics unlimited_statistics;
+  ExecutionControl unlimited_control;
+  unlimited_control.statistics = &unlimited_statistics;
+  EXPECT_OK(FormatVerilog(code, "<filename>", style, unlimited_stream,
+                          kEnableAllLines, unlimited_control));
+  EXPECT_TRUE(unlimited_statistics.over_budget_partitions.empty());
+}
+
+TEST(FormatterEndToEndTest, ReusedBuffersFormatLikeFreshOnes) {
+  const FormatStyle style;
+  const absl::string_view codes[] = {
+      "module m;\n"
+      "assign a = b + c;\n"
+      "always_ff @(posedge clk) begin x <= y; z <= w; end\n"
+      "endmodule\n",
+      "package p; localparam int P = 1; endpackage\n",
+      "",
+      "class c; function void f(int a, int b); endfunction endclass\n",
+  };
+
+  FormatterBuffers buffers;
+  ExecutionControl reusing_control;
+  reusing_control.buffers = &buffers;
+  for (int round = 0; round < 2; ++round) {
+    for (absl::string_view code : codes) {
+      std::ostringstream fresh_stream;
+      EXPECT_OK(FormatVerilog(code, "<filename>", style, fresh_stream,
+                              kEnableAllLines, ExecutionControl()));
+      std::ostringstream reusing_stream;
+      EXPECT_OK(FormatVerilog(code, "<filename>", style, reusing_stream,
+                              kEnableAllLines, reusing_control));
+      EXPECT_EQ(reusing_stream.str(), fresh_stream.str()) << code;
+    }
+  }
+}
+
 static constexpr FormatterTestCase kOnelineFormatBaselineTestCases[] = {
     // Reference - following test cases should not be affected by the switch
     {// Minimal useful case
@@ -15,6 +15,9 @@
 #include "verilog/formatting/token_annotator.h"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <utility>
 #include <vector>
@@ -127,6 +130,165 @@ static bool IsAnySemicolon(const PreFormatToken& ftoken) {
              verilog_tokentype::SemicolonEndOfAssertionVariableDeclarations;
 }
 
+// Token classes distinguished by the context-free spacing and line-break
+// rules below, which are compiled into tables indexed by the classes of the
+// left and right tokens.  Each token belongs to one class; where a token
+// could belong to more than one, the class used by the earlier rule wins.
+enum class LeftTokenClass : uint8_t {
+  kOther,
+  kEscapedIdentifier,
+  kLineContinuation,
+  kOpenGroup,
+  kScopeResolution,
+  kComma,
+  kSemicolon,
+  kReturn,
+  kColon,
+  kDefine,
+  kNumClasses,
+};
+
+enum class RightTokenClass : uint8_t {
+  kOther,
+  kLineContinuation,
+  kComment,
+  kCloseGroup,
+  kComma,
+  kSemicolon,
+  kNumClasses,
+};
+
+static LeftTokenClass ClassifyLeftToken(const PreFormatToken& ftoken) {
+  switch (ftoken.TokenEnum()) {
+    case EscapedIdentifier:
+      return LeftTokenClass::kEscapedIdentifier;
+    case TK_LINE_CONT:
+      return LeftTokenClass::kLineContinuation;
+    default:
+      break;
+  }
+  if (ftoken.format_token_enum == FTT::open_group) {
+    return LeftTokenClass::kOpenGroup;
+  }
+  switch (ftoken.TokenEnum()) {
+    case TK_SCOPE_RES:
+      return LeftTokenClass::kScopeResolution;
+    case ',':
+      return LeftTokenClass::kComma;
+    case ';':
+    case SemicolonEndOfAssertionVariableDeclarations:
+      return LeftTokenClass::kSemicolon;
+    case TK_return:
+      return LeftTokenClass::kReturn;
+    case ':':
+      return LeftTokenClass::kColon;
+    case PP_define:
+      return LeftTokenClass::kDefine;
+    default:
+      return LeftTokenClass::kOther;
+  }
+}
+
+static RightTokenClass ClassifyRightToken(const PreFormatToken& ftoken) {
+  if (ftoken.TokenEnum() == TK_LINE_CONT) {
+    return RightTokenClass::kLineContinuation;
+  }
+  if (IsComment(FormatTokenType(ftoken.format_token_enum))) {
+    return RightTokenClass::kComment;
+  }
+  if (ftoken.format_token_enum == FTT::close_group) {
+    return RightTokenClass::kCloseGroup;
+  }
+  switch (ftoken.TokenEnum()) {
+    case ',':
+      return RightTokenClass::kComma;
+    case ';':
+    case SemicolonEndOfAssertionVariableDeclarations:
+      return RightTokenClass::kSemicolon;
+    default:
+      return RightTokenClass::kOther;
+  }
+}
+
+template <typename T>
+using TokenClassTable =
+    std::array<std::array<WithReason<T>,
+                          static_cast<size_t>(RightTokenClass::kNumClasses)>,
+               static_cast<size_t>(LeftTokenClass::kNumClasses)>;
+
+// Builds a table of 'rule' applied to every combination of token classes.
+template <typename T, typename Rule>
+static constexpr TokenClassTable<T> MakeTokenClassTable(Rule rule) {
+  TokenClassTable<T> table{};
+  for (size_t l = 0; l < table.size(); ++l) {
+    for (size_t r = 0; r < table[l].size(); ++r) {
+      table[l][r] = rule(static_cast<LeftTokenClass>(l),
+                         static_cast<RightTokenClass>(r));
+    }
+  }
+  return table;
+}
+
+template <typename T>
+static const WithReason<T>& LookUp(const TokenClassTable<T>& table,
+                                   LeftTokenClass left, RightTokenClass right) {
+  return table[static_cast<size_t>(left)][static_cast<size_t>(right)];
+}
+
+// Spacing rules that take precedence over all context-sensitive ones.
+// kUnhandledSpacesRequired means that no rule applies.
+static constexpr auto kLeadingSpacingRules = MakeTokenClassTable<int>(
+    [](LeftTokenClass left, RightTokenClass right) -> WithReason<int> {
+      // Preserve space after escaped identifiers.
+      if (left == LeftTokenClass::kEscapedIdentifier) {
+        return {1, "Escaped identifiers must end with whitespace."};
+      }
+      if (right == RightTokenClass::kLineContinuation) {
+        return {0, "Add no spaces before \\ line continuation."};
+      }
+      if (left == LeftTokenClass::kLineContinuation) {
+        return {0, "Add no spaces after \\ line continuation."};
+      }
+      if (right == RightTokenClass::kComment) {
+        return {2, "Style: require 2+ spaces before comments"};
+        // TODO(fangism): Take this from FormatStyle.
+      }
+      if (left == LeftTokenClass::kOpenGroup ||
+          right == RightTokenClass::kCloseGroup) {
+        return {0,
+                "Prefer \"(foo)\" over \"( foo )\", \"[x]\" over \"[ x ]\", "
+                "and \"{y}\" over \"{ y }\"."};
+      }
+      return {kUnhandledSpacesRequired, ""};
+    });
+
+// Spacing rules for delimiters and list separators, which follow the unary
+// operator rule.  kUnhandledSpacesRequired means that no rule applies.
+static constexpr auto kDelimiterSpacingRules = MakeTokenClassTable<int>(
+    [](LeftTokenClass left, RightTokenClass right) -> WithReason<int> {
+      if (left == LeftTokenClass::kScopeResolution) {
+        return {0, R"(Prefer "::id" over ":: id", \"::*" over ":: *")"};
+      }
+      if (right == RightTokenClass::kComma) return {0, "No space before comma"};
+      if (left == LeftTokenClass::kComma) {
+        return {1, "Require space after comma"};
+      }
+      if (right == RightTokenClass::kSemicolon) {
+        if (left == LeftTokenClass::kColon) {
+          return {1,
+                  "Space between semicolon and colon, (e.g. \"default: ;\")"};
+        }
+        return {0, "No space before semicolon"};
+      }
+      if (left == LeftTokenClass::kSemicolon) {
+        return {1, "Require space after semicolon"};
+      }
+      if (left == LeftTokenClass::kReturn) {
+        return {1, "Space between return keyword and return value"};
+      }
+      return {kUnhandledSpacesRequired, ""};
+    });
+
 // Returns minimum number of spaces required between left and right token.
 // Returning kUnhandledSpacesRequired means the case was not explicitly
 // handled, and it is up to the caller to decide what to do when this happens.
@@ -137,29 +299,12 @@ static WithReason<int> SpacesRequiredBetween(
   VLOG(3) << "Spacing between " << verilog_symbol_name(left.TokenEnum())
           << " and " << verilog_symbol_name(right.TokenEnum());
   // Higher precedence rules should be handled earlier in this function.
-
-  // Preserve space after escaped identifiers.
-  if (left.TokenEnum() == EscapedIdentifier) {
-    return {1, "Escaped identifiers must end with whitespace."};
-  }
-
-  if (right.TokenEnum() == verilog_tokentype::TK_LINE_CONT) {
-    return {0, "Add no spaces before \\ line continuation."};
-  }
-  if (left.TokenEnum() == verilog_tokentype::TK_LINE_CONT) {
-    return {0, "Add no spaces after \\ line continuation."};
-  }
-
-  if (IsComment(FormatTokenType(right.format_token_enum))) {
-    return {2, "Style: require 2+ spaces before comments"};
-    // TODO(fangism): Take this from FormatStyle.
-  }
-
-  if (left.format_token_enum == FormatTokenType::open_group ||
-      right.format_token_enum == FormatTokenType::close_group) {
-    return {0,
-            "Prefer \"(foo)\" over \"( foo )\", \"[x]\" over \"[ x ]\", "
-            "and \"{y}\" over \"{ y }\"."};
+  const LeftTokenClass left_class = ClassifyLeftToken(left);
+  const RightTokenClass right_class = ClassifyRightToken(right);
+  if (const auto& leading =
+          LookUp(kLeadingSpacingRules, left_class, right_class);
+      leading.value != kUnhandledSpacesRequired) {
+    return leading;
   }
 
   // Unary operators (context-sensitive)
@@ -172,26 +317,11 @@ static WithReason<int> SpacesRequiredBetween(
     return {0, "Bind unary prefix operator close to its operand."};
   }
 
-  if (left.TokenEnum() == TK_SCOPE_RES) {
-    return {0, R"(Prefer "::id" over ":: id", \"::*" over ":: *")"};
-  }
-
   // Delimiters, list separators
-  if (right.TokenEnum() == ',') return {0, "No space before comma"};
-  if (left.TokenEnum() == ',') return {1, "Require space after comma"};
-
-  if (IsAnySemicolon(right)) {
-    if (left.TokenEnum() == ':') {
-      return {1, "Space between semicolon and colon, (e.g. \"default: ;\")"};
-    }
-    return {0, "No space before semicolon"};
-  }
-  if (IsAnySemicolon(left)) {
-    return {1, "Require space after semicolon"};
-  }
-
-  if (left.TokenEnum() == TK_return) {
-    return {1, "Space between return keyword and return value"};
+  if (const auto& delimiter =
+          LookUp(kDelimiterSpacingRules, left_class, right_class);
+      delimiter.value != kUnhandledSpacesRequired) {
+    return delimiter;
   }
 
   if (right_context.IsInsideFirst({NodeEnum::kStreamingConcatenation}, {}) &&
@@ -636,22 +766,17 @@ static WithReason<int> BreakPenaltyBetweenTokens(
 
 static int CommonAncestors(const SyntaxTreeContext& left,
                            const SyntaxTreeContext& right) {
-  // TODO(fangism): re-check of common ancestry is slow (linear-time),
-  // and could be avoided by memoizing the point of common ancestry between
-  // leaves *during* the traversal.
-  const auto* shorter = &left;
-  const auto* longer = &right;
-  // For C++11 compatibility, we use the 3-iterator form of std::mismatch().
-  if (shorter->size() > longer->size()) std::swap(shorter, longer);
-  const auto first_mismatches =
-      std::mismatch(shorter->begin(), shorter->end(), longer->begin());
-  const int short_common =
-      std::distance(shorter->begin(), first_mismatches.first);
-  const int long_common =
-      std::distance(longer->begin(), first_mismatches.second);
-  CHECK_GE(short_common, 0);
-  CHECK_EQ(short_common, long_common);
-  return short_common;
+  // Both contexts are paths from the same root, and consecutive tokens are
+  // usually siblings or cousins, so walk down from the deepest level they
+  // could share until reaching the lowest common ancestor.  Below it, the
+  // paths are identical, and above it, they are in disjoint subtrees.
+  size_t depth = std::min(left.size(), right.size());
+  const auto left_begin = left.begin();
+  const auto right_begin = right.begin();
+  while (depth > 0 && left_begin[depth - 1] != right_begin[depth - 1]) {
+    --depth;
+  }
+  return static_cast<int>(depth);
 }
 
 // Token-independent break penalty factor.
@@ -730,6 +855,27 @@ static WithReason<int> BreakPenaltyBetween(
   return {total_penalty, inter_token_penalty.reason};
 }
 
+// Line-break rules that only depend on the token classes, and follow the
+// context-sensitive rule for declared dimensions.
+// kUndecided means that no rule applies.
+static constexpr auto kLeadingBreakRules = MakeTokenClassTable<SpacingOptions>(
+    [](LeftTokenClass left,
+       RightTokenClass right) -> WithReason<SpacingOptions> {
+      if (right == RightTokenClass::kLineContinuation) {
+        return {SpacingOptions::kMustAppend,
+                "Keep \\ line continuation attached to its left neighbor."};
+      }
+      if (left == LeftTokenClass::kLineContinuation) {
+        return {SpacingOptions::kMustWrap,
+                "Keep \\ line continuation is always followed by \\n."};
+      }
+      if (left == LeftTokenClass::kDefine) {
+        return {SpacingOptions::kMustAppend,
+                "Keep `define and macro name together."};
+      }
+      return {SpacingOptions::kUndecided, ""};
+    });
+
 // Returns decision whether to break, not break, or evaluate both choices.
 static WithReason<SpacingOptions> BreakDecisionBetween(
     const FormatStyle& style, const PreFormatToken& left,
@@ -747,19 +893,10 @@ static WithReason<SpacingOptions> BreakDecisionBetween(
     }
   }
 
-  if (right.TokenEnum() == verilog_tokentype::TK_LINE_CONT) {
-    return {SpacingOptions::kMustAppend,
-            "Keep \\ line continuation attached to its left neighbor."};
-  }
-
-  if (left.TokenEnum() == verilog_tokentype::TK_LINE_CONT) {
-    return {SpacingOptions::kMustWrap,
-            "Keep \\ line continuation is always followed by \\n."};
-  }
-
-  if (left.TokenEnum() == PP_define) {
-    return {SpacingOptions::kMustAppend,
-            "Keep `define and macro name together."};
+  if (const auto& leading = LookUp(kLeadingBreakRules, ClassifyLeftToken(left),
+                                    ClassifyRightToken(right));
+      leading.value != SpacingOptions::kUndecided) {
+    return leading;
   }
   if (right.TokenEnum() == PP_define_body) {
     // TODO(b/141517267): reflow macro definition text with flexible
@@ -956,6 +1093,22 @@ void AnnotateFormattingInformation(
                                 text_structure.EOFToken(), format_tokens);
 }
 
+void AnnotateFormatTokenRange(
+    const FormatStyle& style, const verible::TextStructureView& text_structure,
+    size_t begin, size_t end,
+    std::vector<verible::PreFormatToken>* format_tokens) {
+  AnnotateFormatTokensUsingSyntaxContext(
+      text_structure.SyntaxTree().get(), text_structure.EOFToken(),
+      format_tokens->begin(), format_tokens->begin() + begin,
+      format_tokens->begin() + end,
+      [&style](const PreFormatToken& prev_token, PreFormatToken* curr_token,
+               const SyntaxTreeContext& prev_context,
+               const SyntaxTreeContext& current_context) {
+        AnnotateFormatToken(style, prev_token, curr_token, prev_context,
+                            current_context);
+      });
+}
+
 void AnnotateFormattingInformation(
     const FormatStyle& style, const char* buffer_start,
     const verible::Symbol* syntax_tree_root,
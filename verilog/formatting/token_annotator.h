@@ -15,6 +15,7 @@
 #ifndef VERIBLE_VERILOG_FORMATTING_TOKEN_ANNOTATOR_H_
 #define VERIBLE_VERILOG_FORMATTING_TOKEN_ANNOTATOR_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "common/formatting/format_token.h"
@@ -36,6 +37,14 @@ void AnnotateFormattingInformation(
     const FormatStyle &style, const verible::TextStructureView &text_structure,
     std::vector<verible::PreFormatToken> *format_tokens);
 
+// Annotates only the format tokens at indices [begin, end) the same way as
+// AnnotateFormattingInformation() would.  Unlike that, this does not set the
+// tokens' preserved space starts.
+void AnnotateFormatTokenRange(
+    const FormatStyle &style, const verible::TextStructureView &text_structure,
+    size_t begin, size_t end,
+    std::vector<verible::PreFormatToken> *format_tokens);
+
 // This interface is only provided for testing, without requiring a
 // TextStructureView.
 //   buffer_start: start of the text buffer that is being formatted.
@@ -123,15 +123,17 @@ static PreFormatToken CreateFormatToken(const TokenInfo& token) {
 }
 
 UnwrapperData::UnwrapperData(const verible::TokenSequence& tokens) {
+  Reset(tokens);
+}
+
+void UnwrapperData::Reset(const verible::TokenSequence& tokens) {
   // Create a TokenStreamView that removes spaces, but preserves comments.
-  {
-    verible::InitTokenStreamView(tokens, &tokens_view_no_whitespace);
-    verible::FilterTokenStreamViewInPlace(KeepNonWhitespace,
-                                          &tokens_view_no_whitespace);
-  }
+  verible::FilterTokenStreamView(KeepNonWhitespace, tokens,
+                                 &tokens_view_no_whitespace);
 
   // Create an array of PreFormatTokens.
   {
+    preformatted_tokens.clear();
     preformatted_tokens.reserve(tokens_view_no_whitespace.size());
     std::transform(tokens_view_no_whitespace.begin(),
                    tokens_view_no_whitespace.end(),
@@ -43,7 +43,12 @@ struct UnwrapperData {
   // Array of PreFormatTokens that will be partitioned into UnwrappedLines.
   std::vector<verible::PreFormatToken> preformatted_tokens;
 
+  UnwrapperData() = default;
   explicit UnwrapperData(const verible::TokenSequence&);
+
+  // Replaces the data with that of another token sequence, reusing the
+  // storage of the arrays.
+  void Reset(const verible::TokenSequence&);
 };
 
 enum class ContextHint;
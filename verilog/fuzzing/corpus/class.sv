@@ -0,0 +1,11 @@
+package p;
+  class base #(type T = int);
+    rand T items[$];
+    constraint c_size { items.size() inside {[1:4]}; }
+    function new();
+    endfunction
+    virtual task run();
+      foreach (items[i]) $display("%0d", items[i]);
+    endtask
+  endclass
+endpackage
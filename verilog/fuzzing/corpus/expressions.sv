@@ -0,0 +1,9 @@
+module e (input logic [7:0] a, b, output logic [15:0] y);
+  assign y = {a, b} ^ {8'h0, (a + b) * (a - b)} | {{8{a[7]}}, a & ~b};
+  always_comb begin
+    case (a)
+      8'd0, 8'd1: y = 16'(b);
+      default: y = a[0] ? {b, a} : (a << 2) >>> 1;
+    endcase
+  end
+endmodule
@@ -0,0 +1,13 @@
+`define WIDTH 8
+`define MAX(a, b) ((a) > (b) ? (a) : (b))
+`define REG(name, w) logic [w-1:0] name
+`ifdef SYNTHESIS
+`define ASSERT(x)
+`else
+`define ASSERT(x) assert (x)
+`endif
+module m;
+  `REG(r, `WIDTH);
+  assign r = `MAX(r, `WIDTH'(3));
+  initial `ASSERT(r != 0);
+endmodule
@@ -0,0 +1,63 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs a fuzz target on the inputs in the files, and the files in the
+// directories, given as arguments; the way libFuzzer runs it on a corpus,
+// but without libFuzzer.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "common/util/file_util.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static bool RunOnFile(const std::string &path) {
+  const absl::StatusOr<std::string> content =
+      verible::file::GetContentAsString(path);
+  if (!content.ok()) {
+    fprintf(stderr, "%s: %s\n", path.c_str(),
+            content.status().ToString().c_str());
+    return false;
+  }
+  LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(content->data()),
+                         content->size());
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int inputs = 0;
+  bool ok = true;
+  for (int i = 1; i < argc; ++i) {
+    std::error_code error;
+    if (!std::filesystem::is_directory(argv[i], error)) {
+      ok &= RunOnFile(argv[i]);
+      ++inputs;
+      continue;
+    }
+    for (const auto &entry : std::filesystem::directory_iterator(argv[i])) {
+      if (!entry.is_regular_file()) continue;
+      ok &= RunOnFile(entry.path().string());
+      ++inputs;
+    }
+  }
+  fprintf(stderr, "Ran %d inputs.\n", inputs);
+  return ok ? 0 : 1;
+}
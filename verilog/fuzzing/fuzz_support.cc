@@ -0,0 +1,52 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/fuzzing/fuzz_support.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace verilog {
+namespace fuzzing {
+
+absl::Duration FuzzTimeBudget() {
+  static const absl::Duration budget = []() {
+    const char *milliseconds = getenv("VERIBLE_FUZZ_TIME_BUDGET_MS");
+    if (milliseconds && atoi(milliseconds) > 0) {
+      return absl::Milliseconds(atoi(milliseconds));
+    }
+    return absl::Seconds(1);
+  }();
+  return budget;
+}
+
+ScopedTimeBudget::ScopedTimeBudget(absl::string_view stage)
+    : stage_(stage), start_(absl::Now()) {}
+
+ScopedTimeBudget::~ScopedTimeBudget() {
+  const absl::Duration elapsed = absl::Now() - start_;
+  if (elapsed <= FuzzTimeBudget()) return;
+  fprintf(stderr, "%.*s took %s, more than the budget of %s.\n",
+          static_cast<int>(stage_.size()), stage_.data(),
+          absl::FormatDuration(elapsed).c_str(),
+          absl::FormatDuration(FuzzTimeBudget()).c_str());
+  abort();
+}
+
+}  // namespace fuzzing
+}  // namespace verilog
@@ -0,0 +1,56 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_FUZZING_FUZZ_SUPPORT_H_
+#define VERIBLE_VERILOG_FUZZING_FUZZ_SUPPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace verilog {
+namespace fuzzing {
+
+// Returns the fuzz input as text.
+inline absl::string_view FuzzInputText(const uint8_t *data, size_t size) {
+  return {reinterpret_cast<const char *>(data), size};
+}
+
+// Returns the time one input may take, from $VERIBLE_FUZZ_TIME_BUDGET_MS,
+// one second by default.
+absl::Duration FuzzTimeBudget();
+
+// Aborts at the end of its scope if that took longer than FuzzTimeBudget(),
+// so that the fuzzer keeps, and can minimize, inputs that are slow to
+// process like crashing ones.  Hanging inputs are left to the time limit of
+// the fuzzer itself.
+class ScopedTimeBudget {
+ public:
+  explicit ScopedTimeBudget(absl::string_view stage);
+  ~ScopedTimeBudget();
+
+  ScopedTimeBudget(const ScopedTimeBudget &) = delete;
+  ScopedTimeBudget &operator=(const ScopedTimeBudget &) = delete;
+
+ private:
+  const absl::string_view stage_;
+  const absl::Time start_;
+};
+
+}  // namespace fuzzing
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_FUZZING_FUZZ_SUPPORT_H_
@@ -0,0 +1,35 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Formats the input with the default style; the line wrap search and the
+// layout optimizer are where inputs have taken minutes.
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+
+#include "verilog/formatting/format_style.h"
+#include "verilog/formatting/formatter.h"
+#include "verilog/fuzzing/fuzz_support.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  const verilog::fuzzing::ScopedTimeBudget budget("Formatting");
+  const verilog::formatter::FormatStyle style;
+  std::ostringstream formatted;
+  // Unparseable inputs and exceeded search limits are reported as errors.
+  (void)verilog::formatter::FormatVerilog(
+      verilog::fuzzing::FuzzInputText(data, size), "fuzz.sv", style,
+      formatted);
+  return 0;
+}
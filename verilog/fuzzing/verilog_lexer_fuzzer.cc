@@ -0,0 +1,29 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/text/token_info.h"
+#include "verilog/fuzzing/fuzz_support.h"
+#include "verilog/parser/verilog_lexer.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  const verilog::fuzzing::ScopedTimeBudget budget("Lexing");
+  verilog::VerilogLexer lexer(verilog::fuzzing::FuzzInputText(data, size));
+  for (const verible::TokenInfo *token = &lexer.DoNextToken();
+       !token->isEOF(); token = &lexer.DoNextToken()) {
+  }
+  return 0;
+}
@@ -0,0 +1,44 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Preprocesses the input with macro expansion, which relexes and
+// substitutes macro bodies, the way verible-verilog-preprocessor does.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "verilog/fuzzing/fuzz_support.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/preprocessor/verilog_preprocess.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  const verilog::fuzzing::ScopedTimeBudget budget("Preprocessing");
+  verilog::VerilogLexer lexer(verilog::fuzzing::FuzzInputText(data, size));
+  verible::TokenSequence tokens;
+  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
+       lexer.DoNextToken()) {
+    tokens.push_back(lexer.GetLastToken());
+  }
+  verible::TokenStreamView stream;
+  verible::InitTokenStreamView(tokens, &stream);
+
+  verilog::VerilogPreprocess::Config config;
+  config.filter_branches = true;
+  config.expand_macros = true;
+  verilog::VerilogPreprocess preprocessor(config);
+  preprocessor.ScanStream(stream);
+  return 0;
+}
@@ -87,6 +87,12 @@ static std::nullptr_t Recover() {
   return nullptr;
 }
 
+// Returns the end keyword that an 'error' rule resynchronized at.  When that
+// keyword was itself the rejected token, its value went to 'error'.
+static SymbolPtr RecoveredEnd(SymbolPtr& error, SymbolPtr& end) {
+  return end != nullptr ? std::move(end) : std::move(error);
+}
+
 // Transforms:
 // (sublist, separator), item -> sublist +separator +item
 // TODO(fangism): if generally useful, factor into concrete_syntax_tree.h
@@ -1061,6 +1067,30 @@ class_declaration
                           MakeTaggedNode(N::kClassHeader,
                                          $1, $2, $3, $4, $5, $6, $7, $8),
                           $9, $10, $11); }
+  /* error-recovery: keep the items before the error */
+  | TK_virtual_opt TK_class lifetime_opt GenericIdentifier
+    module_parameter_port_list_opt
+    class_declaration_extends_opt
+    implements_interface_list_opt ';'
+    class_items error TK_endclass
+    label_opt
+    { yyerrok;
+      $$ = MakeTaggedNode(N::kClassDeclaration,
+                          MakeTaggedNode(N::kClassHeader,
+                                         $1, $2, $3, $4, $5, $6, $7, $8),
+                          $9, RecoveredEnd($10, $11), $12); }
+  | TK_virtual_opt TK_class lifetime_opt GenericIdentifier
+    module_parameter_port_list_opt
+    class_declaration_extends_opt
+    implements_interface_list_opt ';'
+    error TK_endclass
+    label_opt
+    { yyerrok;
+      $$ = MakeTaggedNode(N::kClassDeclaration,
+                          MakeTaggedNode(N::kClassHeader,
+                                         $1, $2, $3, $4, $5, $6, $7, $8),
+                          MakeTaggedNode(N::kClassItems), RecoveredEnd($9, $10),
+                          $11); }
   ;
 class_constraint
   : constraint_prototype
@@ -2241,6 +2271,15 @@ description
    */
   | library_source
     { $$ = std::move($1); }
+  /* error-recovery: resynchronize at the end of the broken item */
+  | error module_end
+    { yyerrok; $$ = Recover(); }
+  | error TK_endclass
+    { yyerrok; $$ = Recover(); }
+  | error TK_endpackage
+    { yyerrok; $$ = Recover(); }
+  | error TK_endfunction
+    { yyerrok; $$ = Recover(); }
   ;
 description_list_opt
   : description_list
@@ -2394,6 +2433,28 @@ function_declaration
                                    ForwardChildren($3),  // expand type id pair
                                    MakeParenGroup($4, $5, $6),
                                    $7, nullptr, $8, $9, $10); }
+  /* error-recovery: keep the statements before the error */
+  | TK_function lifetime_opt
+    function_return_type_and_id '(' tf_port_list_opt ')' ';'
+    block_item_or_statement_or_null_list error
+    TK_endfunction endfunction_label_opt
+    { yyerrok;
+      $$ = MakeFunctionDeclaration(qualifier_placeholder, $1, $2,
+                                   ForwardChildren($3),  // expand type id pair
+                                   MakeParenGroup($4, $5, $6),
+                                   $7, nullptr, $8, RecoveredEnd($9, $10),
+                                   $11); }
+  | TK_function lifetime_opt
+    function_return_type_and_id '(' tf_port_list_opt ')' ';'
+    error
+    TK_endfunction endfunction_label_opt
+    { yyerrok;
+      $$ = MakeFunctionDeclaration(qualifier_placeholder, $1, $2,
+                                   ForwardChildren($3),  // expand type id pair
+                                   MakeParenGroup($4, $5, $6),
+                                   $7, nullptr,
+                                   MakeTaggedNode(N::kBlockItemStatementList),
+                                   RecoveredEnd($8, $9), $10); }
   | TK_function lifetime_opt
     function_return_type_and_id ';'
     function_item_list
@@ -2865,6 +2926,19 @@ package_declaration
     package_item_list_opt
     TK_endpackage label_opt
     { $$ = MakeTaggedNode(N::kPackageDeclaration, $1, $2, $3, $4, $5, $6, $7); }
+  /* error-recovery: keep the items before the error */
+  | TK_package lifetime_opt GenericIdentifier ';'
+    package_item_list error
+    TK_endpackage label_opt
+    { yyerrok;
+      $$ = MakeTaggedNode(N::kPackageDeclaration, $1, $2, $3, $4, $5,
+                          RecoveredEnd($6, $7), $8); }
+  | TK_package lifetime_opt GenericIdentifier ';'
+    error
+    TK_endpackage label_opt
+    { yyerrok;
+      $$ = MakeTaggedNode(N::kPackageDeclaration, $1, $2, $3, $4, nullptr,
+                          RecoveredEnd($5, $6), $7); }
   ;
 module_package_import_list_opt
   : package_import_list
@@ -5426,6 +5500,34 @@ module_or_interface_declaration
       $$ = MakeTaggedNode(node_enum,
                           MakeModuleHeader($1, $2, $3, $4, $5, $6, $7, $8),
                           $9, $10, $11); }
+  /* error-recovery: keep the items before the error */
+  | module_start lifetime_opt symbol_or_label
+    module_package_import_list_opt
+    module_parameter_port_list_opt
+    module_port_list_opt
+    module_attribute_foreign_opt ';'
+    module_item_list error
+    module_end
+    label_opt
+    { yyerrok;
+      const auto node_enum = DeclarationKeywordToNodeEnum(*$1);
+      $$ = MakeTaggedNode(node_enum,
+                          MakeModuleHeader($1, $2, $3, $4, $5, $6, $7, $8),
+                          $9, RecoveredEnd($10, $11), $12); }
+  | module_start lifetime_opt symbol_or_label
+    module_package_import_list_opt
+    module_parameter_port_list_opt
+    module_port_list_opt
+    module_attribute_foreign_opt ';'
+    error
+    module_end
+    label_opt
+    { yyerrok;
+      const auto node_enum = DeclarationKeywordToNodeEnum(*$1);
+      $$ = MakeTaggedNode(node_enum,
+                          MakeModuleHeader($1, $2, $3, $4, $5, $6, $7, $8),
+                          MakeTaggedNode(N::kModuleItemList),
+                          RecoveredEnd($9, $10), $11); }
   /* TODO(fangism): check that module_start and module_end match */
   /* TODO(fangism): extern {module,interface,program} declarations, ANSI and non-ANSI */
   ;
@@ -14,7 +14,12 @@
 
 #include "verilog/parser/verilog_lexer.h"
 
+#include <cstddef>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/text/token_info.h"
@@ -33,6 +38,66 @@ void VerilogLexer::Restart(absl::string_view code) {
   macro_arg_length_ = 0;
 }
 
+// Characters of {Space} in verilog.lex.
+static constexpr char kSpaceChars[] = " \t\f\b";
+
+// Characters of ({Letter}|{Digit}) in verilog.lex.
+static constexpr char kIdentifierChars[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_$0123456789";
+
+// Characters that all keywords consist of (e.g. bufif0, supply1).
+// Identifiers with any other character are never keywords.
+static constexpr char kKeywordChars[] = "abcdefghijklmnopqrstuvwxyz_01";
+
+// The fast paths below only cover tokens that the {Space}+, {Identifier} and
+// {EndOfLineCommentStart} rules in verilog.lex match in the INITIAL start
+// condition, and leave anything that another rule could match to yylex().
+// The scanning is done with strspn() and strcspn(), which are vectorized in
+// common C libraries, and which stop at the NUL characters that end flex's
+// buffered input.
+int VerilogLexer::FastScanToken() {
+  const char *const text = BufferedInput();
+  if (text == nullptr) return 0;
+  const char first = text[0];
+
+  if (first == ' ' || first == '\t') {
+    const size_t length = strspn(text, kSpaceChars);
+    if (text[length] == '\0') return 0;
+    ConsumeBufferedInput(length);
+    return TK_SPACE;
+  }
+
+  if ((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z') ||
+      first == '_') {
+    const size_t length = strspn(text, kIdentifierChars);
+    if (text[length] == '\0') return 0;
+    // Keywords, local:: and std::randomize are left to their rules.
+    if (strspn(text, kKeywordChars) >= length) return 0;
+    ConsumeBufferedInput(length);
+    return SymbolIdentifier;
+  }
+
+  if (first == '/' && text[1] == '/') {
+    const char *const content = text + 2;
+    // {PragmaProtected} starts like a comment.
+    if (strncmp(content + strspn(content, kSpaceChars), "pragma", 6) == 0) {
+      return 0;
+    }
+    // Like <IN_EOL_COMMENT>, stop before the line terminator, but include
+    // the \r of a \r\n.  Line continuations are left to yylex().
+    size_t length = 2 + strcspn(content, "\r\n\\");
+    if (text[length] == '\r') {
+      if (text[length + 1] == '\0') return 0;
+      if (text[length + 1] == '\n') ++length;
+    } else if (text[length] != '\n') {  // '\\' or '\0'
+      return 0;
+    }
+    ConsumeBufferedInput(length);
+    return TK_EOL_COMMENT;
+  }
+  return 0;
+}
+
 bool VerilogLexer::TokenIsError(const TokenInfo &token) const {
   // TODO(fangism): Distinguish different lexical errors by returning different
   // enums.
@@ -54,11 +119,47 @@ bool VerilogLexer::KeepSyntaxTreeTokens(const TokenInfo &t) {
   }
 }
 
+namespace {
+// Lexers are only kept for texts this short, so that the pool doesn't hold
+// on to large buffers. Pooled lexers are used for macro bodies and arguments.
+constexpr size_t kMaxPooledTextSize = 16 * 1024;
+
+// Few lexers are in use at the same time: one per nested macro expansion.
+constexpr size_t kMaxPooledLexers = 4;
+
+std::vector<std::unique_ptr<VerilogLexer>> &LexerPool() {
+  static thread_local std::vector<std::unique_ptr<VerilogLexer>> pool;
+  return pool;
+}
+}  // namespace
+
+void VerilogLexerReleaser::operator()(VerilogLexer *lexer) const {
+  std::unique_ptr<VerilogLexer> owned(lexer);
+  auto &pool = LexerPool();
+  if (reuse && pool.size() < kMaxPooledLexers) {
+    pool.push_back(std::move(owned));
+  }
+}
+
+PooledVerilogLexer AcquireVerilogLexer(absl::string_view code) {
+  if (code.size() > kMaxPooledTextSize) {
+    // Not returned to the pool, so that its large buffer is freed.
+    return PooledVerilogLexer(new VerilogLexer(code),
+                              VerilogLexerReleaser{false});
+  }
+  auto &pool = LexerPool();
+  if (pool.empty()) return PooledVerilogLexer(new VerilogLexer(code));
+  PooledVerilogLexer lexer(pool.back().release());
+  pool.pop_back();
+  lexer->Restart(code);
+  return lexer;
+}
+
 void RecursiveLexText(absl::string_view text,
                       const std::function<void(const TokenInfo &)> &func) {
-  VerilogLexer lexer(text);
+  const PooledVerilogLexer lexer = AcquireVerilogLexer(text);
   for (;;) {
-    const TokenInfo &subtoken(lexer.DoNextToken());
+    const TokenInfo &subtoken(lexer->DoNextToken());
     if (subtoken.isEOF()) break;
     func(subtoken);
   }
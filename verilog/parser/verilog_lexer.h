@@ -33,6 +33,7 @@
 // clang-format on
 
 #include <functional>
+#include <memory>
 
 #include "absl/strings/string_view.h"
 
@@ -53,10 +54,22 @@ class VerilogLexer : public verible::FlexLexerAdapter<verilogFlexLexer> {
   // Filter predicate that can be used for testing and parsing.
   static bool KeepSyntaxTreeTokens(const verible::TokenInfo &);
 
+  // Returns true if the lexer is between top-level tokens, in the same state
+  // as at the start of the input, i.e. the text lexed so far does not affect
+  // how the remaining text will be lexed.
+  bool InInitialState() const {
+    return InInitialStartCondition() && balance_ == 0;
+  }
+
  private:
   // Main lexing function. Will be defined by Flex.
   int yylex() final;
 
+  // Scans spaces, end-of-line comments and identifiers that cannot be
+  // keywords without the generated state machine, because these dominate
+  // large generated sources like netlists.
+  int FastScanToken() final;
+
   // These variables are controlled by the lexer code (verilog.lex).
 
   // for macro call argument lexing
@@ -71,6 +84,22 @@ class VerilogLexer : public verible::FlexLexerAdapter<verilogFlexLexer> {
   int macro_arg_length_ = 0;
 };
 
+// Returns a lexer to the pool of its thread instead of destroying it, unless
+// it is not to be reused.
+struct VerilogLexerReleaser {
+  void operator()(VerilogLexer *lexer) const;
+
+  bool reuse = true;
+};
+
+// A lexer borrowed from a thread-local pool.
+using PooledVerilogLexer = std::unique_ptr<VerilogLexer, VerilogLexerReleaser>;
+
+// Returns a lexer for 'code', reusing one released before on this thread if
+// possible. Many short texts, like macro bodies and arguments, are lexed
+// separately; reusing lexers avoids allocating flex's buffers each time.
+PooledVerilogLexer AcquireVerilogLexer(absl::string_view code);
+
 // Recursively lex the given 'text', and apply 'func' to each subtoken.
 void RecursiveLexText(
     absl::string_view text,
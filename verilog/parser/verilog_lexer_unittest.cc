@@ -15,10 +15,13 @@
 // Unit tests for VerilogLexer (from verilog.lex)
 #include "verilog/parser/verilog_lexer.h"
 
+#include <cstddef>
 #include <initializer_list>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/lexer/lexer_test_util.h"
 #include "common/text/token_info.h"
@@ -1369,6 +1372,30 @@ static std::initializer_list<SimpleTestData> kEvalStringLiteralTests = {
 };
 
 // tokens with special handling in lexer
+// Tokens after the first one may be scanned by VerilogLexer's fast paths.
+static std::initializer_list<LexerTestData> kFastPathTests = {
+    {';', {TK_SPACE, " \t "}, {SymbolIdentifier, "N123"}, ';'},
+    {';', {TK_SPACE, " "}, {SymbolIdentifier, "U_1$x"}, '.'},
+    {';', {TK_SPACE, " "}, {TK_wire, "wire"}, {TK_SPACE, " "}},
+    {';', {TK_SPACE, " "}, {TK_bufif0, "bufif0"}, '('},
+    {';',
+     {TK_SPACE, " "},
+     {TK_local_SCOPE, "local::"},
+     {SymbolIdentifier, "x"}},
+    {';', {TK_SPACE, " "}, {SymbolIdentifier, "Local"}, {TK_SCOPE_RES, "::"}},
+    {';',
+     {TK_EOL_COMMENT, "// foo bar"},
+     {TK_NEWLINE, "\n"},
+     {TK_EOL_COMMENT, "// baz\r"},
+     {TK_NEWLINE, "\n"},
+     {TK_EOL_COMMENT, "// qux"},
+     {TK_NEWLINE, "\r"},
+     {SymbolIdentifier, "Y"}},
+    {';', {TK_EOL_COMMENT, "//FOO"}, {TK_LINE_CONT, "\\"}, {TK_NEWLINE, "\n"}},
+    {';', {TK_EOL_COMMENT, "// a\\b"}, {TK_NEWLINE, "\n"}},
+    {';', {TK_SPACE, "  "}, {TK_EOL_COMMENT, "// foo"}},
+};
+
 static std::initializer_list<LexerTestData> kTrickyTests = {
     {{TK_COLON_DIV, ":/"}, {TK_SPACE, " "}},
     {{TK_COLON_DIV, ":/"}, {TK_DecNumber, "8"}},
@@ -2318,6 +2345,7 @@ TEST(VerilogLexerTest, TimeLiteral) {
   TestLexer(kTimeLiteralTests, TK_TimeLiteral);
 }
 TEST(VerilogLexerTest, Tricky) { TestLexer(kTrickyTests); }
+TEST(VerilogLexerTest, FastPaths) { TestLexer(kFastPathTests); }
 TEST(VerilogLexerTest, Sequence) { TestLexer(kSequenceTests); }
 TEST(VerilogLexerTest, StringLiteral) {
   TestLexer(kStringLiteralTests, TK_StringLiteral);
@@ -2356,6 +2384,36 @@ TEST(RecursiveLexTextTest, Basic) {
                           TokenInfo(';', text.substr(5, 1))));
 }
 
+// Flex buffers the input in blocks, which fast paths must not scan beyond.
+TEST(VerilogLexerTest, FastPathsAcrossBufferedBlocks) {
+  constexpr absl::string_view kLine =
+      "  AND2 U12 ( .A(n1), .Z(n$3) ); // c\r\n";
+  std::string text;
+  for (int i = 0; i < 2000; ++i) absl::StrAppend(&text, kLine);
+  VerilogLexer lexer(text);
+  std::vector<TokenInfo> tokens;
+  for (;;) {
+    const TokenInfo& token = lexer.DoNextToken();
+    if (token.isEOF()) break;
+    tokens.push_back(token);
+  }
+  VerilogLexer line_lexer(kLine);
+  std::vector<TokenInfo> line_tokens;
+  for (;;) {
+    const TokenInfo& token = line_lexer.DoNextToken();
+    if (token.isEOF()) break;
+    line_tokens.push_back(token);
+  }
+  ASSERT_EQ(tokens.size(), 2000 * line_tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const TokenInfo& expected = line_tokens[i % line_tokens.size()];
+    EXPECT_EQ(tokens[i].token_enum(), expected.token_enum()) << i;
+    EXPECT_EQ(tokens[i].text(), expected.text()) << i;
+    EXPECT_EQ(tokens[i].left(text) % kLine.length(), expected.left(kLine))
+        << i;
+  }
+}
+
 TEST(VerilogLexerTest, StrayNulCharacterHandledCorrectly) {
   {  // baseline
     FilteredVerilogLexer lexer(absl::string_view("foo bar baz", 11));
@@ -2376,5 +2434,46 @@ TEST(VerilogLexerTest, StrayNulCharacterHandledCorrectly) {
     EXPECT_TRUE(lexer.DoNextToken().isEOF());
   }
 }
+// Returns the texts of the remaining tokens of 'lexer'.
+std::vector<absl::string_view> LexedTexts(VerilogLexer *lexer) {
+  std::vector<absl::string_view> texts;
+  for (;;) {
+    const TokenInfo &token = lexer->DoNextToken();
+    if (token.isEOF()) break;
+    texts.push_back(token.text());
+  }
+  return texts;
+}
+
+TEST(VerilogLexerTest, RestartLexesNewTextLikeNewLexer) {
+  const std::string long_text(100000, ' ');
+  VerilogLexer lexer("`define FOO(a) a");
+  LexedTexts(&lexer);
+  // Inputs shorter and longer than the buffer allocated for the first text.
+  for (absl::string_view code :
+       {absl::string_view("a b"), absl::string_view("module m; endmodule"),
+        absl::string_view(long_text), absl::string_view("`FOO(x)\nx")}) {
+    lexer.Restart(code);
+    VerilogLexer fresh(code);
+    EXPECT_EQ(LexedTexts(&lexer), LexedTexts(&fresh)) << code.substr(0, 20);
+  }
+}
+
+TEST(VerilogLexerTest, PooledLexersAreReusedWhenReleased) {
+  VerilogLexer *first = nullptr;
+  {
+    const PooledVerilogLexer lexer = AcquireVerilogLexer("a b");
+    EXPECT_THAT(LexedTexts(lexer.get()), ElementsAre("a", " ", "b"));
+    first = lexer.get();
+    // Nested acquisitions get another lexer.
+    const PooledVerilogLexer nested = AcquireVerilogLexer("c");
+    EXPECT_NE(nested.get(), first);
+    EXPECT_THAT(LexedTexts(nested.get()), ElementsAre("c"));
+  }
+  // Released lexers are restarted with the new text.
+  const PooledVerilogLexer again = AcquireVerilogLexer("d e");
+  EXPECT_THAT(LexedTexts(again.get()), ElementsAre("d", " ", "e"));
+  EXPECT_EQ(again.get(), first);
+}
 }  // namespace
 }  // namespace verilog
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/logging.h"
 #include "verilog/parser/verilog_token_enum.h"
 
@@ -458,6 +459,36 @@ LexicalContext::LexicalContext()
           TK_sequence, TK_endsequence,
           SemicolonEndOfAssertionVariableDeclarations) {}
 
+void LexicalContext::TransformVerilogSymbols(
+    const verible::TokenStreamReferenceView& tokens_view) {
+  // Pre-scan for the keywords that can activate the optional trackers.
+  // Without them, those trackers would remain in their dormant state for
+  // every token, so they need not be updated at all.
+  constraint_trackers_enabled_ = false;
+  assertion_trackers_enabled_ = false;
+  for (auto iter : tokens_view) {
+    switch (iter->token_enum()) {
+      case TK_randomize:
+      case TK_constraint:
+        constraint_trackers_enabled_ = true;
+        break;
+      case TK_property:
+      case TK_sequence:
+        assertion_trackers_enabled_ = true;
+        break;
+      default:
+        break;
+    }
+    if (constraint_trackers_enabled_ && assertion_trackers_enabled_) break;
+  }
+
+  // TODO(fangism): Using a stream interface would further decouple the input
+  // iteration from output iteration.
+  for (auto iter : tokens_view) {
+    AdvanceToken(&*iter);
+  }
+}
+
 void LexicalContext::AdvanceToken(TokenInfo* token) {
   // Note: It might not always be possible to mutate a token as it is
   // encountered; it may have to be bookmarked to be returned to later after
@@ -468,8 +499,10 @@ void LexicalContext::AdvanceToken(TokenInfo* token) {
   UpdateState(*token);  // only modifies *this, not token
 
   // The following state machines require a mutable token reference:
-  property_declaration_tracker_.UpdateState(token);
-  sequence_declaration_tracker_.UpdateState(token);
+  if (assertion_trackers_enabled_) {
+    property_declaration_tracker_.UpdateState(token);
+    sequence_declaration_tracker_.UpdateState(token);
+  }
 
   // Maintain one token look-back.
   previous_token_ = token;
@@ -481,12 +514,14 @@ void LexicalContext::UpdateState(const TokenInfo& token) {
     // Handle begin/end-like keywords with optional labels.
     keyword_label_tracker_.UpdateState(token.token_enum());
 
-    // Parse randomize_call.
-    randomize_call_tracker_.UpdateState(token.token_enum());
+    if (constraint_trackers_enabled_) {
+      // Parse randomize_call.
+      randomize_call_tracker_.UpdateState(token.token_enum());
 
-    // Parse constraint declarations (but not extern prototypes).
-    if (!in_extern_declaration_) {
-      constraint_declaration_tracker_.UpdateState(token.token_enum());
+      // Parse constraint declarations (but not extern prototypes).
+      if (!in_extern_declaration_) {
+        constraint_declaration_tracker_.UpdateState(token.token_enum());
+      }
     }
   }
 
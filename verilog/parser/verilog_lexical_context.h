@@ -240,13 +240,7 @@ class LexicalContext {
   // Postcondition: tokens_view's tokens must not be tagged with (_TK_*)
   // enumerations.
   void TransformVerilogSymbols(
-      const verible::TokenStreamReferenceView &tokens_view) {
-    // TODO(fangism): Using a stream interface would further decouple the input
-    // iteration from output iteration.
-    for (auto iter : tokens_view) {
-      AdvanceToken(&*iter);
-    }
-  }
+      const verible::TokenStreamReferenceView &tokens_view);
 
  protected:  // Allow direct testing of some methods.
   // Reads a single token, and may alter it depending on internal state.
@@ -310,6 +304,13 @@ class LexicalContext {
 
   bool previous_token_finished_header_ = true;
 
+  // The randomize/constraint and property/sequence trackers stay dormant
+  // until they see their trigger keyword.  TransformVerilogSymbols() clears
+  // these when a pre-scan finds no such keyword, so that plain RTL skips
+  // those sub-state-machines entirely.
+  bool constraint_trackers_enabled_ = true;
+  bool assertion_trackers_enabled_ = true;
+
   // Nestable states need to be tracked with a stack.
 
   // Tracks if, for, case blocks.
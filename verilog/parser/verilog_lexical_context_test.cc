@@ -2241,5 +2241,35 @@ endfunction : rat
   ExpectTokenSequence({TK_endfunction, ':', SymbolIdentifier});
 }
 
+// Test that whole-stream transformation skips the trackers that have no
+// trigger keyword, while still disambiguating other tokens.
+TEST_F(LexicalContextTest, TransformPlainRtlDisablesOptionalTrackers) {
+  const char code[] = R"(
+task t();
+  -> e;
+endtask
+  )";
+  Tokenize(code);
+  TransformVerilogSymbols(token_refs_);
+  EXPECT_FALSE(constraint_trackers_enabled_);
+  EXPECT_FALSE(assertion_trackers_enabled_);
+  ExpectCurrentTokenEnum(token_refs_.begin() + 5, TK_TRIGGER);
+}
+
+TEST_F(LexicalContextTest, TransformRandomizeCallEnablesConstraintTrackers) {
+  const char code[] = R"(
+task wr();
+  s = m.randomize() with {
+    a -> b;
+  };
+endtask
+  )";
+  Tokenize(code);
+  TransformVerilogSymbols(token_refs_);
+  EXPECT_TRUE(constraint_trackers_enabled_);
+  EXPECT_FALSE(assertion_trackers_enabled_);
+  ExpectCurrentTokenEnum(token_refs_.begin() + 15, TK_CONSTRAINT_IMPLIES);
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,280 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_parallel_lexer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/util/thread_pool.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+
+using verible::TokenInfo;
+using verible::TokenSequence;
+
+static bool IsIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+std::vector<size_t> FindLexerSplitPoints(absl::string_view text,
+                                         size_t min_spacing) {
+  enum State {
+    kCode,
+    kEndOfLineComment,
+    kBlockComment,
+    kStringLiteral,
+    kAttribute,
+    kMacroDefinition,
+  };
+  std::vector<size_t> splits;
+  State state = kCode;
+  int macro_call_depth = 0;  // parentheses of macro call arguments
+  size_t next_split = min_spacing;
+  const size_t size = text.size();
+  for (size_t i = 0; i < size; ++i) {
+    const char c = text[i];
+    const char next = i + 1 < size ? text[i + 1] : '\0';
+    if (c == '\n') {
+      // Escaped newlines continue macro definitions and comments.
+      const bool continued =
+          (i >= 1 && text[i - 1] == '\\') ||
+          (i >= 2 && text[i - 1] == '\r' && text[i - 2] == '\\');
+      bool safe = false;
+      switch (state) {
+        case kEndOfLineComment:
+          if (continued) break;
+          state = kCode;
+          safe = macro_call_depth == 0;
+          break;
+        case kCode:
+          safe = !continued && macro_call_depth == 0;
+          break;
+        case kStringLiteral:
+          if (!continued) state = kCode;  // unterminated, a lexical error
+          break;
+        case kMacroDefinition:
+          // The end of the definition is left to yylex().
+          if (!continued) state = kCode;
+          break;
+        default:
+          break;
+      }
+      if (safe && i + 1 >= next_split && i + 1 < size) {
+        splits.push_back(i + 1);
+        next_split = i + 1 + min_spacing;
+      }
+      continue;
+    }
+    switch (state) {
+      case kCode:
+        switch (c) {
+          case '/':
+            if (next == '/') {
+              state = kEndOfLineComment;
+              ++i;
+            } else if (next == '*') {
+              state = kBlockComment;
+              ++i;
+            }
+            break;
+          case '"':
+            state = kStringLiteral;
+            break;
+          case '(':
+            if (macro_call_depth > 0) {
+              ++macro_call_depth;
+            } else if (next == '*' && i + 2 < size && text[i + 2] != ')') {
+              state = kAttribute;  // but not @(*)
+              ++i;
+            }
+            break;
+          case ')':
+            if (macro_call_depth > 0) --macro_call_depth;
+            break;
+          case '\\':
+            // Escaped identifiers end at whitespace, and may contain any of
+            // the characters above.
+            while (i + 1 < size && text[i + 1] != ' ' && text[i + 1] != '\t' &&
+                   text[i + 1] != '\n' && text[i + 1] != '\r') {
+              ++i;
+            }
+            break;
+          case '`': {
+            size_t end = i + 1;
+            while (end < size && IsIdentifierChar(text[end])) ++end;
+            const absl::string_view name = text.substr(i + 1, end - i - 1);
+            if (name == "define") {
+              state = kMacroDefinition;
+            } else if (!name.empty()) {
+              size_t open = end;
+              while (open < size && (text[open] == ' ' || text[open] == '\t')) {
+                ++open;
+              }
+              if (open < size && text[open] == '(') {
+                ++macro_call_depth;
+                end = open + 1;
+              }
+            }
+            i = end - 1;
+            break;
+          }
+          default:
+            break;
+        }
+        break;
+      case kBlockComment:
+        if (c == '*' && next == '/') {
+          state = kCode;
+          ++i;
+        }
+        break;
+      case kStringLiteral:
+        if (c == '\\') {
+          ++i;  // skip the escaped character (a newline is handled above)
+          if (i < size && text[i] == '\n') --i;
+        } else if (c == '"') {
+          state = kCode;
+        }
+        break;
+      case kAttribute:
+        if (c == '*' && next == ')') {
+          state = kCode;
+          ++i;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return splits;
+}
+
+namespace {
+// Tokens of one piece of the text, lexed on its own.
+struct LexedChunk {
+  TokenSequence tokens;
+  // True if the last token is an error token.
+  bool error = false;
+  // True if the piece ended on a newline, with the lexer in its initial state,
+  // so that the next piece can be lexed independently.
+  bool ends_in_initial_state = false;
+};
+}  // namespace
+
+// Lexes a piece of text that ends at a split point, up to (but not including)
+// the EOF token.
+static LexedChunk LexChunk(absl::string_view chunk) {
+  LexedChunk result;
+  VerilogLexer lexer(chunk);
+  const char *const chunk_end = chunk.data() + chunk.size();
+  while (true) {
+    const TokenInfo &token = lexer.DoNextToken();
+    if (token.isEOF()) break;
+    result.tokens.push_back(token);
+    if (lexer.TokenIsError(token)) {
+      result.error = true;
+      break;
+    }
+    if (token.text().data() + token.text().size() == chunk_end) {
+      result.ends_in_initial_state =
+          token.token_enum() == TK_NEWLINE && lexer.InInitialState();
+      break;
+    }
+  }
+  return result;
+}
+
+// Lexes the last piece of the text, including the EOF token.
+static LexedChunk LexLastChunk(absl::string_view chunk) {
+  LexedChunk result;
+  VerilogLexer lexer(chunk);
+  const auto status = verible::MakeTokenSequence(
+      &lexer, chunk, &result.tokens, [](const TokenInfo &) {});
+  result.error = !status.ok();
+  return result;
+}
+
+absl::Status ParallelLexVerilog(
+    absl::string_view text, int num_threads, TokenSequence *tokens,
+    const std::function<void(const TokenInfo &)> &error_token_handler,
+    size_t min_chunk_size) {
+  std::vector<size_t> splits;
+  if (num_threads > 1 && text.size() >= 2 * min_chunk_size) {
+    const size_t spacing = std::max(min_chunk_size, text.size() / num_threads);
+    splits = FindLexerSplitPoints(text, spacing);
+  }
+  if (splits.empty()) {
+    VerilogLexer lexer(text);
+    return verible::MakeTokenSequence(&lexer, text, tokens,
+                                      error_token_handler);
+  }
+
+  std::vector<LexedChunk> chunks;
+  {
+    verible::ThreadPool pool(std::min<int>(num_threads, splits.size() + 1));
+    std::vector<std::future<LexedChunk>> results;
+    results.reserve(splits.size() + 1);
+    size_t begin = 0;
+    for (const size_t end : splits) {
+      const absl::string_view chunk = text.substr(begin, end - begin);
+      results.push_back(
+          pool.ExecAsync<LexedChunk>([chunk]() { return LexChunk(chunk); }));
+      begin = end;
+    }
+    const absl::string_view last_chunk = text.substr(begin);
+    results.push_back(pool.ExecAsync<LexedChunk>(
+        [last_chunk]() { return LexLastChunk(last_chunk); }));
+    chunks.reserve(results.size());
+    for (auto &result : results) chunks.push_back(result.get());
+  }
+
+  size_t total_tokens = 0;
+  for (const auto &chunk : chunks) total_tokens += chunk.tokens.size();
+  tokens->reserve(tokens->size() + total_tokens);
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const LexedChunk &chunk = chunks[i];
+    const bool last = i == splits.size();
+    if (!last && !chunk.error && !chunk.ends_in_initial_state) {
+      // This piece cannot be joined with the next one, so lex the remaining
+      // text serially, starting from this piece, which began in the initial
+      // state.  The final EOF token points to the end of 'text'.
+      const absl::string_view rest = text.substr(i == 0 ? 0 : splits[i - 1]);
+      VerilogLexer lexer(rest);
+      return verible::MakeTokenSequence(&lexer, rest, tokens,
+                                        error_token_handler);
+    }
+    tokens->insert(tokens->end(), chunk.tokens.begin(), chunk.tokens.end());
+    if (chunk.error) {
+      // Stop-on-first-error, like MakeTokenSequence().
+      error_token_handler(tokens->back());
+      return absl::InvalidArgumentError("Lexical error.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace verilog
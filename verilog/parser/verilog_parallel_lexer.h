@@ -0,0 +1,64 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parallel lexing of large Verilog source files.
+//
+// The text is split at line boundaries where lexing can restart from the
+// lexer's initial state, and the pieces are lexed concurrently.  The
+// resulting token sequence is identical to that of lexing the whole text
+// with a single VerilogLexer.
+
+#ifndef VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_LEXER_H_
+#define VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_LEXER_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+
+namespace verilog {
+
+// Inputs smaller than this are not worth splitting.
+inline constexpr size_t kDefaultMinLexerChunkSize = 1 << 20;
+
+// Returns offsets into 'text' at which it may be split for lexing, spaced at
+// least 'min_spacing' bytes apart.  Each offset is just past a newline that a
+// quick scan finds outside of comments, string literals, attributes, macro
+// definitions, macro call arguments and escaped line continuations.
+// The scan is a heuristic: ParallelLexVerilog() still verifies every split.
+std::vector<size_t> FindLexerSplitPoints(absl::string_view text,
+                                         size_t min_spacing);
+
+// Lexes 'text' into 'tokens' (appending), with the same result and status as
+// verible::MakeTokenSequence() with a VerilogLexer: tokens up to and including
+// the first error token (reported to 'error_token_handler'), or up to and
+// including the EOF token.
+//
+// Inputs of at least 2 * 'min_chunk_size' bytes are split into up to
+// 'num_threads' pieces with FindLexerSplitPoints(), which are lexed
+// concurrently.  A piece is only accepted if the lexer ends it in its initial
+// state; at the first piece that does not, the remaining text is lexed
+// serially.
+absl::Status ParallelLexVerilog(
+    absl::string_view text, int num_threads, verible::TokenSequence *tokens,
+    const std::function<void(const verible::TokenInfo &)> &error_token_handler,
+    size_t min_chunk_size = kDefaultMinLexerChunkSize);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_LEXER_H_
@@ -0,0 +1,170 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_parallel_lexer.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/parser/verilog_lexer.h"
+
+namespace verilog {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::TokenInfo;
+using verible::TokenSequence;
+
+TEST(FindLexerSplitPointsTest, EmptyText) {
+  EXPECT_THAT(FindLexerSplitPoints("", 1), IsEmpty());
+}
+
+TEST(FindLexerSplitPointsTest, EveryLine) {
+  EXPECT_THAT(FindLexerSplitPoints("a\nb\nc\n", 1), ElementsAre(2, 4));
+}
+
+TEST(FindLexerSplitPointsTest, Spacing) {
+  EXPECT_THAT(FindLexerSplitPoints("a\nb\nc\nd\ne\n", 3), ElementsAre(4, 8));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsBlockComment) {
+  EXPECT_THAT(FindLexerSplitPoints("a /*\n*/ b\nc\n", 1), ElementsAre(10));
+}
+
+TEST(FindLexerSplitPointsTest, EndOfLineComment) {
+  EXPECT_THAT(FindLexerSplitPoints("// /*\na\n", 1), ElementsAre(6));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsLineContinuation) {
+  EXPECT_THAT(FindLexerSplitPoints("// a \\\nb\nc\n", 1), ElementsAre(9));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsStringLiteral) {
+  EXPECT_THAT(FindLexerSplitPoints("s = \"a\\\nb\";\nc\n", 1),
+              ElementsAre(12));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsAttribute) {
+  EXPECT_THAT(FindLexerSplitPoints("(* a,\nb *)\nc\n", 1), ElementsAre(11));
+}
+
+TEST(FindLexerSplitPointsTest, EventControlWildcardIsNotAttribute) {
+  EXPECT_THAT(FindLexerSplitPoints("@(*)\nc\n", 1), ElementsAre(5));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsMacroDefinition) {
+  EXPECT_THAT(FindLexerSplitPoints("`define A \\\n b\nc\nd\n", 1),
+              ElementsAre(17));
+}
+
+TEST(FindLexerSplitPointsTest, SkipsMacroCallArguments) {
+  EXPECT_THAT(FindLexerSplitPoints("`A(x,\n(y)\n)\nc\n", 1), ElementsAre(12));
+}
+
+TEST(FindLexerSplitPointsTest, EscapedIdentifier) {
+  EXPECT_THAT(FindLexerSplitPoints("\\a/*b \nc\n", 1), ElementsAre(7));
+}
+
+// Lexes 'text' serially, as the reference result.
+static absl::Status SerialLex(absl::string_view text, TokenSequence *tokens) {
+  VerilogLexer lexer(text);
+  return verible::MakeTokenSequence(&lexer, text, tokens,
+                                    [](const TokenInfo &) {});
+}
+
+// Expects tokens to be identical, including their text ranges.
+static void ExpectSameTokens(const TokenSequence &got,
+                             const TokenSequence &expect) {
+  ASSERT_EQ(got.size(), expect.size());
+  for (size_t i = 0; i < got.size(); ++i) {
+    EXPECT_EQ(got[i].token_enum(), expect[i].token_enum()) << " at " << i;
+    EXPECT_EQ(got[i].text().data(), expect[i].text().data()) << " at " << i;
+    EXPECT_EQ(got[i].text().size(), expect[i].text().size()) << " at " << i;
+  }
+}
+
+static void ExpectSameAsSerial(absl::string_view text) {
+  TokenSequence expect_tokens;
+  const absl::Status expect_status = SerialLex(text, &expect_tokens);
+  for (const int num_threads : {1, 2, 4, 16}) {
+    TokenSequence tokens;
+    int errors = 0;
+    const absl::Status status = ParallelLexVerilog(
+        text, num_threads, &tokens, [&](const TokenInfo &) { ++errors; },
+        /*min_chunk_size=*/1);
+    EXPECT_EQ(status.ok(), expect_status.ok()) << text;
+    EXPECT_EQ(errors, expect_status.ok() ? 0 : 1) << text;
+    ExpectSameTokens(tokens, expect_tokens);
+  }
+}
+
+TEST(ParallelLexVerilogTest, MatchesSerialLexing) {
+  constexpr absl::string_view kTestCases[] = {
+      "",
+      "\n",
+      "module m;\nendmodule\n",
+      "module m;\n  wire a;\n  assign a = b;\nendmodule",
+      "/* block\n comment */\nmodule m;\nendmodule\n",
+      "// comment\n// another \\\n continued\nwire w;\n",
+      "string s = \"line \\\n continued\";\nwire w;\n",
+      "(* attr,\n  other *)\nmodule m;\nendmodule\n",
+      "always @(*)\n  a = b;\n",
+      "`define FOO(a, b) \\\n  a + b\n`define BAR 1\nx = `FOO(1,\n 2);\n",
+      "`uvm_info(get_name(),\n  \"message\",\n  UVM_LOW)\nwire w;\n",
+      "primitive p(o, a);\n  output o;\n  input a;\n  table\n"
+      "    0 : 1;\n    1 : 0;\n  endtable\nendprimitive\n",
+      "covergroup cg;\n  coverpoint a {\n    bins b = {1};\n  }\nendgroup\n",
+      "wire \\esc/* ;\nwire w;\n",
+      "module m;\r\n  wire a;\r\nendmodule\r\n",
+      "module m;\n  wire a;\n  \x01\n  wire b;\nendmodule\n",
+  };
+  for (const auto text : kTestCases) {
+    ExpectSameAsSerial(text);
+  }
+}
+
+TEST(ParallelLexVerilogTest, LargeGeneratedText) {
+  std::string text;
+  for (int i = 0; i < 2000; ++i) {
+    absl::StrAppend(&text, "  assign w", i, " = a", i, " & b", i,
+                    ";  // net ", i, "\n");
+    if (i % 97 == 0) absl::StrAppend(&text, "  /* spans\n lines */\n");
+    if (i % 131 == 0) absl::StrAppend(&text, "  `MACRO(x,\n y)\n");
+  }
+  ExpectSameAsSerial(text);
+}
+
+TEST(ParallelLexVerilogTest, AppendsToExistingTokens) {
+  TokenSequence tokens(1, TokenInfo::EOFToken());
+  const absl::Status status = ParallelLexVerilog(
+      "wire a;\nwire b;\n", 2, &tokens, [](const TokenInfo &) {},
+      /*min_chunk_size=*/1);
+  EXPECT_TRUE(status.ok());
+  TokenSequence expect_tokens;
+  EXPECT_TRUE(SerialLex("wire a;\nwire b;\n", &expect_tokens).ok());
+  EXPECT_EQ(tokens.size(), expect_tokens.size() + 1);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,197 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_parallel_parser.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/symbol.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/text/tree_utils.h"
+#include "common/util/thread_pool.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/parser/verilog_parser.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+
+using verible::TokenInfo;
+using verible::TokenStreamView;
+
+static bool IsDescriptionStart(int token_enum) {
+  switch (token_enum) {
+    case TK_module:
+    case TK_macromodule:
+    case TK_package:
+    case TK_class:
+    case TK_virtual:  // virtual class
+    case TK_interface:
+    case TK_program:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::vector<size_t> FindParserSplitPoints(const TokenStreamView &token_view,
+                                          size_t min_spacing) {
+  std::vector<size_t> splits;
+  int depth = 0;     // of declarations
+  int pp_depth = 0;  // of conditional compilation blocks
+  size_t next_split = min_spacing;
+  const size_t size = token_view.size();
+  const auto token_enum_at = [&token_view, size](size_t i) {
+    return i < size ? token_view[i]->token_enum() : verible::TK_EOF;
+  };
+  for (size_t i = 0; i < size; ++i) {
+    switch (token_enum_at(i)) {
+      case PP_ifdef:
+      case PP_ifndef:
+        ++pp_depth;
+        break;
+      case PP_endif:
+        if (pp_depth > 0) --pp_depth;
+        break;
+      case TK_module:
+      case TK_macromodule:
+      case TK_package:
+      case TK_program:
+        ++depth;
+        break;
+      case TK_class:
+        // Forward declarations have no end.
+        if (i == 0 || token_enum_at(i - 1) != TK_typedef) ++depth;
+        break;
+      case TK_interface:
+        // Interface classes end with endclass; virtual interfaces are types.
+        if ((i == 0 || token_enum_at(i - 1) != TK_virtual) &&
+            token_enum_at(i + 1) != TK_class) {
+          ++depth;
+        }
+        break;
+      case TK_endmodule:
+      case TK_endpackage:
+      case TK_endclass:
+      case TK_endinterface:
+      case TK_endprogram: {
+        if (depth > 0) --depth;
+        if (depth > 0 || pp_depth > 0) break;
+        size_t end = i + 1;
+        if (token_enum_at(end) == ':') end += 2;  // label
+        if (end < size && end >= next_split &&
+            IsDescriptionStart(token_enum_at(end))) {
+          splits.push_back(end);
+          next_split = end + min_spacing;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return splits;
+}
+
+namespace {
+struct ParsedRegion {
+  absl::Status status;
+  verible::ConcreteSyntaxTree root;
+  size_t max_used_stack_size = 0;
+};
+
+ParsedRegion ParseRegion(const TokenStreamView &region,
+                         absl::string_view filename) {
+  VerilogParser parser(region, filename);
+  ParsedRegion result;
+  result.status = parser.Parse();
+  result.root = parser.TakeRoot();
+  result.max_used_stack_size = parser.MaxUsedStackSize();
+  return result;
+}
+}  // namespace
+
+absl::Status VerilogParallelParser::ParseSerially() {
+  VerilogParser parser(token_view_, filename_);
+  const absl::Status status = parser.Parse();
+  root_ = parser.TakeRoot();
+  rejected_tokens_ = parser.RejectedTokens();
+  max_used_stack_size_ = parser.MaxUsedStackSize();
+  parsed_regions_ = 1;
+  return status;
+}
+
+absl::Status VerilogParallelParser::Parse() {
+  const size_t size = token_view_.size();
+  if (num_threads_ <= 1 || size < 2 * min_chunk_tokens_) {
+    return ParseSerially();
+  }
+  // A few regions per thread balance regions of different sizes.
+  const size_t spacing = std::max(min_chunk_tokens_, size / (4 * num_threads_));
+  const std::vector<size_t> splits = FindParserSplitPoints(token_view_, spacing);
+  if (splits.empty()) return ParseSerially();
+
+  // The parsers refer to the region views until they are done.
+  std::vector<TokenStreamView> regions;
+  regions.reserve(splits.size() + 1);
+  size_t begin = 0;
+  for (const size_t end : splits) {
+    regions.emplace_back(token_view_.begin() + begin,
+                         token_view_.begin() + end);
+    begin = end;
+  }
+  regions.emplace_back(token_view_.begin() + begin, token_view_.end());
+
+  std::vector<ParsedRegion> parsed;
+  parsed.reserve(regions.size());
+  {
+    verible::ThreadPool pool(std::min<int>(num_threads_, regions.size()));
+    std::vector<std::future<ParsedRegion>> results;
+    results.reserve(regions.size());
+    for (const TokenStreamView &region : regions) {
+      results.push_back(pool.ExecAsync<ParsedRegion>(
+          [&region, this]() { return ParseRegion(region, filename_); }));
+    }
+    for (auto &result : results) parsed.push_back(result.get());
+  }
+
+  // Verify the split before stitching the descriptions together.
+  for (const ParsedRegion &region : parsed) {
+    if (!region.status.ok() || region.root == nullptr ||
+        region.root->Kind() != verible::SymbolKind::kNode ||
+        !verible::SymbolCastToNode(*region.root)
+             .MatchesTag(NodeEnum::kDescriptionList)) {
+      return ParseSerially();
+    }
+  }
+  root_ = verible::MakeTaggedNode(NodeEnum::kDescriptionList);
+  auto &descriptions = verible::SymbolCastToNode(*root_);
+  max_used_stack_size_ = 0;
+  for (ParsedRegion &region : parsed) {
+    descriptions.AppendChild(verible::ForwardChildren(region.root));
+    max_used_stack_size_ =
+        std::max(max_used_stack_size_, region.max_used_stack_size);
+  }
+  rejected_tokens_.clear();
+  parsed_regions_ = parsed.size();
+  return absl::OkStatus();
+}
+
+}  // namespace verilog
@@ -0,0 +1,103 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parallel parsing of the top-level descriptions of a single file.
+//
+// Once a file is lexed, filtered and contextualized, the top-level
+// module, package, class, interface and program declarations are parsed
+// independently of each other.  VerilogParallelParser splits the token
+// stream between such declarations and parses the regions concurrently,
+// stitching their descriptions together under one kDescriptionList root.
+
+#ifndef VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_PARSER_H_
+#define VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_PARSER_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/parser/parse.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+
+namespace verilog {
+
+// Regions with fewer tokens are not worth a parser instance of their own.
+inline constexpr size_t kDefaultMinParserChunkTokens = 2048;
+
+// Returns increasing indices into 'token_view' at which it can be split into
+// regions of whole top-level descriptions, at least 'min_spacing' tokens
+// apart.  Each index is just past the end keyword (and label) of a top-level
+// module, package, class, interface or program, outside of conditional
+// compilation blocks, and at the start of the next such declaration.
+// The scan only tracks keywords; VerilogParallelParser still verifies that
+// every region parses on its own.
+std::vector<size_t> FindParserSplitPoints(
+    const verible::TokenStreamView &token_view, size_t min_spacing);
+
+// Parses the tokens of 'token_view' with the same result as a VerilogParser.
+//
+// Views of at least 2 * 'min_chunk_tokens' tokens are split with
+// FindParserSplitPoints() into up to a few regions per thread, which are
+// parsed concurrently on up to 'num_threads' threads.  If any region fails to
+// parse, or does not parse into a list of descriptions, the split is not
+// trusted and the whole view is parsed again by a single parser, so that
+// errors and error recovery are the same as without splitting.
+class VerilogParallelParser : public verible::Parser {
+ public:
+  // 'token_view' and the tokens it points to have to outlive this object.
+  VerilogParallelParser(const verible::TokenStreamView &token_view,
+                        absl::string_view filename, int num_threads,
+                        size_t min_chunk_tokens = kDefaultMinParserChunkTokens)
+      : token_view_(token_view),
+        filename_(filename),
+        num_threads_(num_threads),
+        min_chunk_tokens_(min_chunk_tokens) {}
+
+  absl::Status Parse() final;
+
+  verible::ConcreteSyntaxTree TakeRoot() final { return std::move(root_); }
+
+  const std::vector<verible::TokenInfo> &RejectedTokens() const final {
+    return rejected_tokens_;
+  }
+
+  // Largest symbol stack depth of the parsers used.
+  size_t MaxUsedStackSize() const { return max_used_stack_size_; }
+
+  // Number of regions that the last Parse() parsed separately, 1 if it parsed
+  // the whole view at once.
+  size_t ParsedRegions() const { return parsed_regions_; }
+
+ private:
+  // Parses the whole view with a single parser.
+  absl::Status ParseSerially();
+
+  const verible::TokenStreamView &token_view_;
+  const absl::string_view filename_;
+  const int num_threads_;
+  const size_t min_chunk_tokens_;
+
+  verible::ConcreteSyntaxTree root_;
+  std::vector<verible::TokenInfo> rejected_tokens_;
+  size_t max_used_stack_size_ = 0;
+  size_t parsed_regions_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_PARSER_VERILOG_PARALLEL_PARSER_H_
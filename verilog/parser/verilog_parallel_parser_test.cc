@@ -0,0 +1,180 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_parallel_parser.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "common/text/tree_compare.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/parser/verilog_parser.h"
+
+namespace verilog {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::TokenInfo;
+using verible::TokenSequence;
+using verible::TokenStreamView;
+
+// Lexed text, and a view of the tokens that the parser sees.
+struct LexedText {
+  explicit LexedText(absl::string_view text) {
+    VerilogLexer lexer(text);
+    EXPECT_TRUE(verible::MakeTokenSequence(&lexer, text, &tokens,
+                                           [](const TokenInfo &) {})
+                    .ok());
+    verible::InitTokenStreamView(tokens, &view);
+    verible::FilterTokenStreamViewInPlace(&VerilogLexer::KeepSyntaxTreeTokens,
+                                          &view);
+  }
+
+  TokenSequence tokens;
+  TokenStreamView view;
+};
+
+std::vector<size_t> SplitPoints(absl::string_view text, size_t min_spacing) {
+  const LexedText lexed(text);
+  return FindParserSplitPoints(lexed.view, min_spacing);
+}
+
+TEST(FindParserSplitPointsTest, EmptyText) {
+  EXPECT_THAT(SplitPoints("", 1), IsEmpty());
+}
+
+TEST(FindParserSplitPointsTest, BetweenDeclarations) {
+  // Token indices:  0      1 2 3          4      5 6 7
+  EXPECT_THAT(SplitPoints("module a; endmodule module b; endmodule", 1),
+              ElementsAre(4));
+}
+
+TEST(FindParserSplitPointsTest, AfterLabel) {
+  EXPECT_THAT(SplitPoints("package p; endpackage : p\n"
+                          "class c; endclass\n"
+                          "interface i; endinterface\n",
+                          1),
+              ElementsAre(6, 10));
+}
+
+TEST(FindParserSplitPointsTest, Spacing) {
+  EXPECT_THAT(SplitPoints("module a; endmodule module b; endmodule\n"
+                          "module c; endmodule module d; endmodule\n",
+                          5),
+              ElementsAre(8));
+}
+
+TEST(FindParserSplitPointsTest, NotInsideDeclarations) {
+  EXPECT_THAT(SplitPoints("module a; module b; endmodule module c; endmodule\n"
+                          "endmodule\n",
+                          1),
+              IsEmpty());
+}
+
+TEST(FindParserSplitPointsTest, NotInsideConditionalCompilation) {
+  EXPECT_THAT(SplitPoints("`ifdef X\n"
+                          "module a; endmodule module b; endmodule\n"
+                          "`endif\n",
+                          1),
+              IsEmpty());
+}
+
+TEST(FindParserSplitPointsTest, NotBeforeOtherItems) {
+  EXPECT_THAT(SplitPoints("module a; endmodule import p::*; module b; "
+                          "endmodule",
+                          1),
+              IsEmpty());
+}
+
+TEST(FindParserSplitPointsTest, DeclarationsWithoutEnd) {
+  EXPECT_THAT(SplitPoints("module a;\n"
+                          "  typedef class c;\n"
+                          "  virtual interface i v;\n"
+                          "endmodule\n"
+                          "interface class ic; endclass\n"
+                          "module b; endmodule\n",
+                          1),
+              ElementsAre(13, 18));
+}
+
+// Returns the text of 'count' alternating modules and classes.
+std::string Declarations(int count) {
+  std::string text;
+  for (int i = 0; i < count; ++i) {
+    if (i % 2 == 0) {
+      absl::StrAppend(&text, "module m", i, "(input wire a);\n",
+                      "  assign b = a + ", i, ";\n", "endmodule : m", i, "\n");
+    } else {
+      absl::StrAppend(&text, "class c", i, ";\n", "  int x = ", i, ";\n",
+                      "endclass\n");
+    }
+  }
+  return text;
+}
+
+TEST(VerilogParallelParserTest, SameTreeAsSerialParser) {
+  const std::string text = Declarations(40);
+  const LexedText lexed(text);
+  VerilogParser serial(lexed.view, "serial.sv");
+  ASSERT_TRUE(serial.Parse().ok());
+  const verible::ConcreteSyntaxTree expected = serial.TakeRoot();
+
+  for (int num_threads : {1, 2, 4}) {
+    VerilogParallelParser parser(lexed.view, "parallel.sv", num_threads, 16);
+    ASSERT_TRUE(parser.Parse().ok());
+    EXPECT_THAT(parser.RejectedTokens(), IsEmpty());
+    if (num_threads > 1) {
+      EXPECT_GT(parser.ParsedRegions(), 1);
+    } else {
+      EXPECT_EQ(parser.ParsedRegions(), 1);
+    }
+    const verible::ConcreteSyntaxTree root = parser.TakeRoot();
+    EXPECT_TRUE(verible::EqualTrees(root.get(), expected.get()))
+        << num_threads;
+  }
+}
+
+TEST(VerilogParallelParserTest, SyntaxErrorsSameAsSerialParser) {
+  const std::string text =
+      absl::StrCat(Declarations(10), "module bad; wire; endmodule\n",
+                   Declarations(10));
+  const LexedText lexed(text);
+  VerilogParser serial(lexed.view, "serial.sv");
+  EXPECT_FALSE(serial.Parse().ok());
+
+  VerilogParallelParser parser(lexed.view, "parallel.sv", 4, 16);
+  EXPECT_FALSE(parser.Parse().ok());
+  // The whole text was parsed again by one parser.
+  EXPECT_EQ(parser.ParsedRegions(), 1);
+  ASSERT_EQ(parser.RejectedTokens().size(), serial.RejectedTokens().size());
+  for (size_t i = 0; i < serial.RejectedTokens().size(); ++i) {
+    EXPECT_EQ(parser.RejectedTokens()[i], serial.RejectedTokens()[i]);
+  }
+  const verible::ConcreteSyntaxTree root = parser.TakeRoot();
+  const verible::ConcreteSyntaxTree expected = serial.TakeRoot();
+  EXPECT_TRUE(verible::EqualTrees(root.get(), expected.get()));
+}
+
+}  // namespace
+}  // namespace verilog
@@ -6237,6 +6237,53 @@ static const verible::ErrorRecoveryTestCase kErrorRecoveryTests[] = {
      "endmodule\n",
      {NodeTag(kModuleDeclaration), NodeTag(kModuleItemList),
       NodeTag(kNetDeclaration)}},
+    // recovery at the end of the item being typed, before any ';'
+    {"module m;\n"
+     "  wire w;\n"
+     "  assign a =\n"  // unfinished, recover at endmodule
+     "endmodule\n"
+     "class c;\n"
+     "  int count;\n"
+     "endclass\n",
+     {NodeTag(kClassDeclaration), NodeTag(kClassItems),
+      NodeTag(kDataDeclaration)}},
+    {"module m;\n"
+     "  wire w;\n"  // kept in the partial module
+     "  assign a =\n"
+     "endmodule\n",
+     {NodeTag(kModuleDeclaration), NodeTag(kModuleItemList),
+      NodeTag(kNetDeclaration)}},
+    {"class c;\n"
+     "  int count\n"  // missing ';', recover at endclass
+     "endclass\n"
+     "module m;\n"
+     "  wire w;\n"
+     "endmodule\n",
+     {NodeTag(kModuleDeclaration), NodeTag(kModuleItemList),
+      NodeTag(kNetDeclaration)}},
+    {"package p;\n"
+     "  parameter int P =\n"  // recover at endpackage
+     "endpackage\n"
+     "module m;\n"
+     "  wire w;\n"
+     "endmodule\n",
+     {NodeTag(kModuleDeclaration), NodeTag(kModuleItemList),
+      NodeTag(kNetDeclaration)}},
+    {"function int f();\n"
+     "  return\n"  // recover at endfunction
+     "endfunction\n"
+     "module m;\n"
+     "  wire w;\n"
+     "endmodule\n",
+     {NodeTag(kModuleDeclaration), NodeTag(kModuleItemList),
+      NodeTag(kNetDeclaration)}},
+    {"module m(input a\n"  // unfinished header, recover at endmodule
+     "endmodule\n"
+     "class c;\n"
+     "  int count;\n"
+     "endclass\n",
+     {NodeTag(kClassDeclaration), NodeTag(kClassItems),
+      NodeTag(kDataDeclaration)}},
 };
 #undef NodeTag
 
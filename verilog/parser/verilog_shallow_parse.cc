@@ -0,0 +1,175 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_shallow_parse.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+
+namespace {
+// Token enums of a view, and verible::TK_EOF past its end.
+class TokenEnums {
+ public:
+  explicit TokenEnums(const verible::TokenStreamView &view) : view_(view) {}
+
+  int operator[](size_t i) const {
+    return i < view_.size() ? view_[i]->token_enum() : verible::TK_EOF;
+  }
+
+ private:
+  const verible::TokenStreamView &view_;
+};
+
+// Returns true if the subroutine keyword at 'i' starts a declaration with a
+// body, judging by the qualifiers before it.
+bool SubroutineHasBody(const TokenEnums &e, size_t i) {
+  for (size_t j = i; j > 0; --j) {
+    switch (e[j - 1]) {
+      case TK_virtual:
+      case TK_static:
+      case TK_protected:
+      case TK_local:
+        continue;  // qualifiers of methods with bodies
+      case TK_extern:
+      case TK_pure:
+      case TK_context:
+      case TK_forkjoin:
+      case TK_import:         // DPI imports, modport imports
+      case TK_export:         // DPI exports, modport exports
+      case TK_StringLiteral:  // "DPI-C"
+      case TK_with:           // covergroup sample() prototype
+        return false;
+      default:
+        return true;
+    }
+  }
+  return true;
+}
+
+// Finds the body of the function or task whose keyword is at 'i'.
+bool FindSubroutineBody(const TokenEnums &e, size_t i, TokenIndexRange *body) {
+  if (!SubroutineHasBody(e, i)) return false;
+  const int end_keyword = e[i] == TK_function ? TK_endfunction : TK_endtask;
+  int parens = 0;
+  size_t k = i + 1;
+  for (;; ++k) {
+    const int token = e[k];
+    if (token == verible::TK_EOF || token == end_keyword) return false;
+    if (token == '(') ++parens;
+    if (token == ')') --parens;
+    if (token == ';' && parens == 0) break;
+  }
+  // Non-ANSI subroutines declare their ports in the body.
+  if (e[k - 1] != ')') return false;
+  body->begin = k + 1;
+  for (k = body->begin;; ++k) {
+    const int token = e[k];
+    if (token == end_keyword) break;
+    if (token == verible::TK_EOF || token == TK_function || token == TK_task) {
+      return false;
+    }
+  }
+  body->end = k;
+  return true;
+}
+
+// Finds the statements of the first begin-end block of the procedural
+// construct whose keyword is at 'i'.
+bool FindBlockBody(const TokenEnums &e, size_t i, TokenIndexRange *body) {
+  int parens = 0;
+  size_t k = i + 1;
+  for (;; ++k) {
+    const int token = e[k];
+    if (token == TK_begin && parens == 0) break;
+    if (token == '(') ++parens;
+    if (token == ')') --parens;
+    if (token == verible::TK_EOF || token == TK_end ||
+        (token == ';' && parens == 0)) {
+      return false;
+    }
+  }
+  body->begin = e[k + 1] == ':' ? k + 3 : k + 1;  // after the label
+  int depth = 1;
+  for (k = body->begin;; ++k) {
+    const int token = e[k];
+    if (token == verible::TK_EOF) return false;
+    if (token == TK_begin) ++depth;
+    if (token == TK_end && --depth == 0) break;
+  }
+  body->end = k;
+  return true;
+}
+
+// Returns true if the conditional compilation directives in 'range' form
+// complete blocks.
+bool BalancedPreprocessing(const TokenEnums &e, const TokenIndexRange &range) {
+  int depth = 0;
+  for (size_t k = range.begin; k < range.end; ++k) {
+    switch (e[k]) {
+      case PP_ifdef:
+      case PP_ifndef:
+        ++depth;
+        break;
+      case PP_elsif:
+      case PP_else:
+        if (depth == 0) return false;
+        break;
+      case PP_endif:
+        if (--depth < 0) return false;
+        break;
+      default:
+        break;
+    }
+  }
+  return depth == 0;
+}
+}  // namespace
+
+std::vector<TokenIndexRange> FindProceduralBodies(
+    const verible::TokenStreamView &token_view) {
+  const TokenEnums e(token_view);
+  std::vector<TokenIndexRange> bodies;
+  for (size_t i = 0; i < token_view.size(); ++i) {
+    TokenIndexRange body;
+    bool found = false;
+    switch (e[i]) {
+      case TK_function:
+      case TK_task:
+        found = FindSubroutineBody(e, i, &body);
+        break;
+      case TK_always:
+      case TK_always_ff:
+      case TK_always_comb:
+      case TK_always_latch:
+      case TK_initial:
+      case TK_final:
+        found = FindBlockBody(e, i, &body);
+        break;
+      default:
+        break;
+    }
+    if (!found || !BalancedPreprocessing(e, body)) continue;
+    if (body.begin < body.end) bodies.push_back(body);
+    i = body.end;  // the end keyword
+  }
+  return bodies;
+}
+
+}  // namespace verilog
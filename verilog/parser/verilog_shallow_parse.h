@@ -0,0 +1,51 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Support for shallow parsing, which leaves the bodies of functions, tasks
+// and procedural blocks unparsed.  Without the tokens of these bodies, the
+// rest of the token stream still parses: declarations and their headers
+// and port lists keep their syntax tree, and the bodies become empty.
+
+#ifndef VERIBLE_VERILOG_PARSER_VERILOG_SHALLOW_PARSE_H_
+#define VERIBLE_VERILOG_PARSER_VERILOG_SHALLOW_PARSE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "common/text/token_stream_view.h"
+
+namespace verilog {
+
+// Range [begin, end) of indices into a token stream view.
+struct TokenIndexRange {
+  size_t begin;
+  size_t end;
+};
+
+// Returns the ranges of 'token_view' (as seen by the parser) that can be
+// removed without changing how the rest parses, in increasing order:
+//   - the body of a function or task with a port list in parentheses,
+//     between the ';' of its header and endfunction/endtask;
+//   - the statements of the first begin-end block of an always, initial or
+//     final construct, between 'begin' (and its label) and the matching
+//     'end'.
+// Subroutines without a body (extern, pure virtual, DPI imports, ...) and
+// non-ANSI subroutines, which declare their ports in the body, are skipped,
+// as are bodies with unbalanced conditional compilation directives.
+std::vector<TokenIndexRange> FindProceduralBodies(
+    const verible::TokenStreamView &token_view);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_PARSER_VERILOG_SHALLOW_PARSE_H_
@@ -0,0 +1,162 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/parser/verilog_shallow_parse.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/text/token_info.h"
+#include "common/text/token_stream_view.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/parser/verilog_lexer.h"
+#include "verilog/parser/verilog_parser.h"
+
+namespace verilog {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::TokenInfo;
+using verible::TokenSequence;
+using verible::TokenStreamView;
+
+// Lexed text, and a view of the tokens that the parser sees.
+struct LexedText {
+  explicit LexedText(absl::string_view text) {
+    VerilogLexer lexer(text);
+    EXPECT_TRUE(verible::MakeTokenSequence(&lexer, text, &tokens,
+                                           [](const TokenInfo &) {})
+                    .ok());
+    verible::InitTokenStreamView(tokens, &view);
+    verible::FilterTokenStreamViewInPlace(&VerilogLexer::KeepSyntaxTreeTokens,
+                                          &view);
+  }
+
+  TokenSequence tokens;
+  TokenStreamView view;
+};
+
+// Returns the bodies in 'text', with their tokens separated by spaces.
+std::vector<std::string> Bodies(absl::string_view text) {
+  const LexedText lexed(text);
+  std::vector<std::string> bodies;
+  for (const TokenIndexRange &range : FindProceduralBodies(lexed.view)) {
+    std::vector<absl::string_view> texts;
+    for (size_t i = range.begin; i < range.end; ++i) {
+      texts.push_back(lexed.view[i]->text());
+    }
+    bodies.push_back(absl::StrJoin(texts, " "));
+  }
+  return bodies;
+}
+
+TEST(FindProceduralBodiesTest, EmptyText) {
+  EXPECT_THAT(Bodies(""), IsEmpty());
+}
+
+TEST(FindProceduralBodiesTest, FunctionsAndTasks) {
+  EXPECT_THAT(Bodies("class c;\n"
+                     "  virtual function int f(int a);\n"
+                     "    return a;\n"
+                     "  endfunction\n"
+                     "  task automatic t();\n"
+                     "    #1 x = 0;\n"
+                     "  endtask : t\n"
+                     "  function void empty();\n"
+                     "  endfunction\n"
+                     "endclass\n"),
+              ElementsAre("return a ;", "# 1 x = 0 ;"));
+}
+
+TEST(FindProceduralBodiesTest, SubroutinesWithoutBodies) {
+  EXPECT_THAT(Bodies("class c;\n"
+                     "  extern function void f();\n"
+                     "  pure virtual task t();\n"
+                     "endclass\n"
+                     "import \"DPI-C\" context function int g(int a);\n"
+                     "module m;\n"
+                     "  covergroup cg with function sample(int a);\n"
+                     "  endgroup\n"
+                     "endmodule\n"),
+              IsEmpty());
+}
+
+TEST(FindProceduralBodiesTest, NonAnsiSubroutinesKeepTheirPorts) {
+  EXPECT_THAT(Bodies("module m;\n"
+                     "  function logic [$clog2(N)-1:0] f;\n"
+                     "    input a;\n"
+                     "    f = a;\n"
+                     "  endfunction\n"
+                     "endmodule\n"),
+              IsEmpty());
+}
+
+TEST(FindProceduralBodiesTest, ProceduralBlocks) {
+  EXPECT_THAT(Bodies("module m;\n"
+                     "  always @(posedge clk) begin : l\n"
+                     "    if (a) begin b <= c; end\n"
+                     "  end\n"
+                     "  always_comb y = a;\n"
+                     "  initial for (int i = 0; i < 2; ++i) begin x = i; end\n"
+                     "  final begin end\n"
+                     "endmodule\n"),
+              ElementsAre("if ( a ) begin b <= c ; end", "x = i ;"));
+}
+
+TEST(FindProceduralBodiesTest, UnbalancedConditionalCompilation) {
+  EXPECT_THAT(Bodies("module m;\n"
+                     "  initial begin\n"
+                     "`ifdef A\n"
+                     "    x = 1;\n"
+                     "  end\n"
+                     "`else\n"
+                     "  end\n"
+                     "`endif\n"
+                     "endmodule\n"),
+              IsEmpty());
+}
+
+TEST(FindProceduralBodiesTest, RemainingTokensParse) {
+  const LexedText lexed(
+      "module m(input clk);\n"
+      "  function automatic int f(int a);\n"
+      "    int b = a;\n"
+      "    return b;\n"
+      "  endfunction\n"
+      "  always_ff @(posedge clk) begin\n"
+      "    q <= f(d);\n"
+      "  end\n"
+      "endmodule\n");
+  const std::vector<TokenIndexRange> bodies = FindProceduralBodies(lexed.view);
+  ASSERT_EQ(bodies.size(), 2);
+  TokenStreamView shallow_view;
+  size_t next = 0;
+  for (const TokenIndexRange &body : bodies) {
+    shallow_view.insert(shallow_view.end(), lexed.view.begin() + next,
+                        lexed.view.begin() + body.begin);
+    next = body.end;
+  }
+  shallow_view.insert(shallow_view.end(), lexed.view.begin() + next,
+                      lexed.view.end());
+  VerilogParser parser(shallow_view, "shallow.sv");
+  EXPECT_TRUE(parser.Parse().ok());
+}
+
+}  // namespace
+}  // namespace verilog
@@ -14,185 +14,76 @@
 
 #include "verilog/parser/verilog_token_classifications.h"
 
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
 #include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
+namespace internal {
 
-bool IsWhitespace(verilog_tokentype token_type) {
-  return (token_type == verilog_tokentype::TK_SPACE ||
-          token_type == verilog_tokentype::TK_NEWLINE);
-}
-
-bool IsComment(verilog_tokentype token_type) {
-  return (token_type == verilog_tokentype::TK_COMMENT_BLOCK ||
-          token_type == verilog_tokentype::TK_EOL_COMMENT);
-}
+using TokenClassTable = std::array<uint16_t, kVerilogTokenClassesSize>;
 
-bool IsUnaryOperator(verilog_tokentype token_type) {
-  switch (static_cast<int>(token_type)) {
-    // See verilog/parser/verilog.y
-    // TODO(fangism): find a way to generate this function automatically
-    // from the yacc file, perhaps with extra annotations or metadata.
-    case '+':
-    case '-':
-    case '~':
-    case '&':
-    case '!':
-    case '|':
-    case '^':
-    case TK_NAND:
-    case TK_NOR:
-    case TK_NXOR:
-    case TK_INCR:
-    case TK_DECR:
-      return true;
-    default:
-      return false;
+// Adds 'token_class' to all 'tokens'.  A token beyond the table size fails
+// to compile, as the table is a constant expression.
+static constexpr void AddTokenClass(TokenClassTable *table,
+                                    std::initializer_list<int> tokens,
+                                    TokenClass token_class) {
+  for (const int token : tokens) {
+    (*table)[token] |= token_class;
   }
 }
 
-bool IsAssociativeOperator(verilog_tokentype op) {
-  switch (static_cast<int>(op)) {
-    case verilog_tokentype::TK_or:
-    case verilog_tokentype::TK_and:
-    case verilog_tokentype::TK_LAND:
-    case verilog_tokentype::TK_LOR:
-    case verilog_tokentype::TK_NXOR:
-    case '+':
-    case '*':
-    case '^':
-    case '|':
-    case '&':
-      return true;
-    default:
-      return false;
-  }
+static constexpr TokenClassTable BuildTokenClassTable() {
+  TokenClassTable table{};
+  AddTokenClass(&table, {TK_SPACE, TK_NEWLINE}, kWhitespace);
+  AddTokenClass(&table, {TK_COMMENT_BLOCK, TK_EOL_COMMENT}, kComment);
+  // See verilog/parser/verilog.y
+  // TODO(fangism): find a way to generate this list automatically
+  // from the yacc file, perhaps with extra annotations or metadata.
+  AddTokenClass(&table,
+                {'+', '-', '~', '&', '!', '|', '^', TK_NAND, TK_NOR, TK_NXOR,
+                 TK_INCR, TK_DECR},
+                kUnaryOperator);
+  AddTokenClass(&table,
+                {TK_or, TK_and, TK_LAND, TK_LOR, TK_NXOR, '+', '*', '^', '|',
+                 '&'},
+                kAssociativeOperator);
+  AddTokenClass(&table, {'?', ':'}, kTernaryOperator);
+  AddTokenClass(&table, {PP_ifdef, PP_ifndef, PP_elsif, PP_else, PP_endif},
+                kPreprocessorControlFlow);
+  AddTokenClass(&table,
+                {PP_include, PP_define, PP_ifdef, PP_ifndef, PP_else, PP_elsif,
+                 PP_endif, PP_undef},
+                kPreprocessorKeyword);
+  // Excludes macro call tokens.
+  AddTokenClass(&table,
+                {PP_Identifier, PP_include, PP_define, PP_define_body,
+                 PP_ifdef, PP_ifndef, PP_else, PP_elsif, PP_endif, PP_undef,
+                 PP_default_text},
+                kPreprocessorControlToken);
+  // TODO(fangism): join and join* keywords?
+  AddTokenClass(&table,
+                {TK_end, TK_endcase, TK_endgroup, TK_endpackage,
+                 TK_endgenerate, TK_endinterface, TK_endfunction, TK_endtask,
+                 TK_endproperty, TK_endclocking, TK_endclass, TK_endmodule},
+                kEndKeyword);
+  AddTokenClass(&table, {MacroArg, PP_define_body}, kUnlexed);
+  AddTokenClass(&table,
+                {SymbolIdentifier, PP_Identifier, MacroIdentifier, MacroIdItem,
+                 MacroCallId, SystemTFIdentifier, EscapedIdentifier,
+                 // specify block built-in functions
+                 TK_Srecrem, TK_Ssetuphold, TK_Speriod, TK_Shold, TK_Srecovery,
+                 TK_Sremoval, TK_Ssetup, TK_Sskew, TK_Stimeskew, TK_Swidth,
+                 // KeywordIdentifier tokens
+                 TK_access, TK_exclude, TK_flow, TK_from, TK_discrete,
+                 TK_sample, TK_infinite, TK_continuous},
+                kIdentifierLike);
+  return table;
 }
 
-bool IsTernaryOperator(verilog_tokentype token_type) {
-  switch (static_cast<int>(token_type)) {
-    case '?':
-    case ':':
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsPreprocessorControlFlow(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::PP_ifdef:
-    case verilog_tokentype::PP_ifndef:
-    case verilog_tokentype::PP_elsif:
-    case verilog_tokentype::PP_else:
-    case verilog_tokentype::PP_endif:
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsPreprocessorKeyword(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::PP_include:
-    case verilog_tokentype::PP_define:
-    case verilog_tokentype::PP_ifdef:
-    case verilog_tokentype::PP_ifndef:
-    case verilog_tokentype::PP_else:
-    case verilog_tokentype::PP_elsif:
-    case verilog_tokentype::PP_endif:
-    case verilog_tokentype::PP_undef:
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsPreprocessorControlToken(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::PP_Identifier:
-    case verilog_tokentype::PP_include:
-    case verilog_tokentype::PP_define:
-    case verilog_tokentype::PP_define_body:
-    case verilog_tokentype::PP_ifdef:
-    case verilog_tokentype::PP_ifndef:
-    case verilog_tokentype::PP_else:
-    case verilog_tokentype::PP_elsif:
-    case verilog_tokentype::PP_endif:
-    case verilog_tokentype::PP_undef:
-    case verilog_tokentype::PP_default_text:
-      // Excludes macro call tokens.
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsEndKeyword(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::TK_end:
-    case verilog_tokentype::TK_endcase:
-    case verilog_tokentype::TK_endgroup:
-    case verilog_tokentype::TK_endpackage:
-    case verilog_tokentype::TK_endgenerate:
-    case verilog_tokentype::TK_endinterface:
-    case verilog_tokentype::TK_endfunction:
-    case verilog_tokentype::TK_endtask:
-    case verilog_tokentype::TK_endproperty:
-    case verilog_tokentype::TK_endclocking:
-    case verilog_tokentype::TK_endclass:
-    case verilog_tokentype::TK_endmodule:
-      // TODO(fangism): join and join* keywords?
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsUnlexed(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::MacroArg:
-    case verilog_tokentype::PP_define_body:
-      return true;
-    default:
-      return false;
-  }
-}
-
-bool IsIdentifierLike(verilog_tokentype token_type) {
-  switch (token_type) {
-    case verilog_tokentype::SymbolIdentifier:
-    case verilog_tokentype::PP_Identifier:
-    case verilog_tokentype::MacroIdentifier:
-    case verilog_tokentype::MacroIdItem:
-    case verilog_tokentype::MacroCallId:
-    case verilog_tokentype::SystemTFIdentifier:
-    case verilog_tokentype::EscapedIdentifier:
-      // specify block built-in functions
-    case verilog_tokentype::TK_Srecrem:
-    case verilog_tokentype::TK_Ssetuphold:
-    case verilog_tokentype::TK_Speriod:
-    case verilog_tokentype::TK_Shold:
-    case verilog_tokentype::TK_Srecovery:
-    case verilog_tokentype::TK_Sremoval:
-    case verilog_tokentype::TK_Ssetup:
-    case verilog_tokentype::TK_Sskew:
-    case verilog_tokentype::TK_Stimeskew:
-    case verilog_tokentype::TK_Swidth:
-      // KeywordIdentifier tokens
-    case verilog_tokentype::TK_access:
-    case verilog_tokentype::TK_exclude:
-    case verilog_tokentype::TK_flow:
-    case verilog_tokentype::TK_from:
-    case verilog_tokentype::TK_discrete:
-    case verilog_tokentype::TK_sample:
-    case verilog_tokentype::TK_infinite:
-    case verilog_tokentype::TK_continuous:
-      return true;
-    default:
-      break;
-  }
-  return false;
-}
+constexpr TokenClassTable kVerilogTokenClasses = BuildTokenClassTable();
 
+}  // namespace internal
 }  // namespace verilog
@@ -15,44 +15,102 @@
 #ifndef VERIBLE_VERILOG_FORMATTING_VERILOG_TOKEN_CLASSIFICATIONS_H_
 #define VERIBLE_VERILOG_FORMATTING_VERILOG_TOKEN_CLASSIFICATIONS_H_
 
+#include <array>
+#include <cstdint>
+
 #include "verilog/parser/verilog_token_enum.h"
 
 namespace verilog {
 
+namespace internal {
+// Bit of each classification in kVerilogTokenClasses.
+enum TokenClass : uint16_t {
+  kWhitespace = 1 << 0,
+  kComment = 1 << 1,
+  kUnaryOperator = 1 << 2,
+  kAssociativeOperator = 1 << 3,
+  kTernaryOperator = 1 << 4,
+  kPreprocessorControlFlow = 1 << 5,
+  kPreprocessorKeyword = 1 << 6,
+  kPreprocessorControlToken = 1 << 7,
+  kEndKeyword = 1 << 8,
+  kUnlexed = 1 << 9,
+  kIdentifierLike = 1 << 10,
+};
+
+// Exceeds all token enums (bison numbers them from 258 on).
+inline constexpr int kVerilogTokenClassesSize = 1024;
+
+// Classification bits of every token enum, computed at compile time.
+extern const std::array<uint16_t, kVerilogTokenClassesSize>
+    kVerilogTokenClasses;
+
+inline bool HasTokenClass(verilog_tokentype token_type,
+                          TokenClass token_class) {
+  const auto index = static_cast<unsigned>(token_type);
+  return index < kVerilogTokenClassesSize &&
+         (kVerilogTokenClasses[index] & token_class) != 0;
+}
+}  // namespace internal
+
 // Returns true if the token type is whitespace (spaces, tabs, newlines).
-bool IsWhitespace(verilog_tokentype token_type);
+inline bool IsWhitespace(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kWhitespace);
+}
 
 // Returns true if the verilog_tokentype is a comment
-bool IsComment(verilog_tokentype token_type);
+inline bool IsComment(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kComment);
+}
 
 // Returns true if token enum *can* be a unary operator.
-bool IsUnaryOperator(verilog_tokentype);
+inline bool IsUnaryOperator(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kUnaryOperator);
+}
 
 // Returns true if operator is an associative binary operator.
-bool IsAssociativeOperator(verilog_tokentype);
+inline bool IsAssociativeOperator(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kAssociativeOperator);
+}
 
 // Returns true if token enum *can* be a ternary operator.
-bool IsTernaryOperator(verilog_tokentype);
+inline bool IsTernaryOperator(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kTernaryOperator);
+}
 
 // Returns true for `ifdef, `else, etc.
-bool IsPreprocessorControlFlow(verilog_tokentype);
+inline bool IsPreprocessorControlFlow(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type,
+                                 internal::kPreprocessorControlFlow);
+}
 
 // Returns true for `ifdef, `define, `include, `undef, etc.
-bool IsPreprocessorKeyword(verilog_tokentype);
+inline bool IsPreprocessorKeyword(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kPreprocessorKeyword);
+}
 
 // Returns true for any preprocessing token, not just control flow.
-bool IsPreprocessorControlToken(verilog_tokentype token_type);
+inline bool IsPreprocessorControlToken(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type,
+                                 internal::kPreprocessorControlToken);
+}
 
 // Returns true if token enum is 'end', 'endmodule', or 'end*'
-bool IsEndKeyword(verilog_tokentype);
+inline bool IsEndKeyword(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kEndKeyword);
+}
 
 // Returns true if token is unlexed text that can be further expanded.
-bool IsUnlexed(verilog_tokentype);
+inline bool IsUnlexed(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kUnlexed);
+}
 
 // Returns true if token is a type that corresponds to a user-written symbol
 // name.  Includes regular identifiers, system-task identifiers, macro
 // identifiers.
-bool IsIdentifierLike(verilog_tokentype);
+inline bool IsIdentifierLike(verilog_tokentype token_type) {
+  return internal::HasTokenClass(token_type, internal::kIdentifierLike);
+}
 
 // TODO(fangism): Identify specially lexed tokens that require a newline after.
 // e.g. MacroIdItem, TK_EOL_COMMENT, ...
@@ -0,0 +1,180 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/preprocessor/macro_database.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/text/macro_definition.h"
+#include "common/text/token_info.h"
+#include "common/util/file_util.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+
+using verible::MacroDefinition;
+using verible::MacroParameterInfo;
+using verible::TokenInfo;
+
+// First line of a database file.  Change when the format changes.
+static constexpr absl::string_view kDatabaseHeader =
+    "# verible-verilog-preprocessor macro database, version 1";
+
+// Lines of a database are tab-separated fields, the first of which is one of
+// these.  Parameters belong to the definition on the 'define' line before
+// them.  Tokens are stored as enum and C-escaped text:
+//
+//   define  name-token  callable(0/1)  definition-token
+//   param   name-token  default-value-token
+static constexpr absl::string_view kDefineTag = "define";
+static constexpr absl::string_view kParamTag = "param";
+
+// MacroDefinition does not expose its header token, which does not matter
+// for expansion.  Loaded definitions all get this one.
+static const TokenInfo &DefineHeaderToken() {
+  static const TokenInfo kDefineHeader(PP_define, "`define");
+  return kDefineHeader;
+}
+
+static void AppendToken(const TokenInfo &token, std::string *out) {
+  absl::StrAppend(out, "\t", token.token_enum(), "\t",
+                  absl::CEscape(token.text()));
+}
+
+TokenInfo MacroDatabase::OwnedToken(int token_enum, absl::string_view text) {
+  const TokenInfo eof = TokenInfo::EOFToken();
+  if (token_enum == eof.token_enum() && text.empty()) return eof;
+  strings_.emplace_back(text);
+  return TokenInfo(token_enum, strings_.back());
+}
+
+void MacroDatabase::Add(const MacroDefinition &definition) {
+  MacroDefinition copy(
+      DefineHeaderToken(),
+      OwnedToken(definition.NameToken().token_enum(), definition.Name()));
+  if (definition.IsCallable()) copy.SetCallable();
+  for (const MacroParameterInfo &parameter : definition.Parameters()) {
+    copy.AppendParameter(MacroParameterInfo(
+        OwnedToken(parameter.name.token_enum(), parameter.name.text()),
+        OwnedToken(parameter.default_value.token_enum(),
+                   parameter.default_value.text())));
+  }
+  const TokenInfo &text = definition.DefinitionText();
+  copy.SetDefinitionText(OwnedToken(text.token_enum(), text.text()));
+  definitions_.insert_or_assign(copy.Name(), copy);
+}
+
+std::string MacroDatabase::Serialize() const {
+  std::string content = absl::StrCat(kDatabaseHeader, "\n");
+  for (const auto &[name, definition] : definitions_) {
+    absl::StrAppend(&content, kDefineTag);
+    AppendToken(definition.NameToken(), &content);
+    absl::StrAppend(&content, "\t", definition.IsCallable() ? 1 : 0);
+    AppendToken(definition.DefinitionText(), &content);
+    content.push_back('\n');
+    for (const MacroParameterInfo &parameter : definition.Parameters()) {
+      absl::StrAppend(&content, kParamTag);
+      AppendToken(parameter.name, &content);
+      AppendToken(parameter.default_value, &content);
+      content.push_back('\n');
+    }
+  }
+  return content;
+}
+
+absl::Status MacroDatabase::Save(absl::string_view path) const {
+  return verible::file::SetContents(path, Serialize());
+}
+
+absl::StatusOr<std::unique_ptr<MacroDatabase>> MacroDatabase::Load(
+    absl::string_view path) {
+  const absl::StatusOr<std::string> content =
+      verible::file::GetContentAsString(path);
+  if (!content.ok()) return content.status();
+  return Parse(*content, path);
+}
+
+absl::StatusOr<std::unique_ptr<MacroDatabase>> MacroDatabase::Parse(
+    absl::string_view content, absl::string_view origin) {
+  auto database = std::make_unique<MacroDatabase>();
+  const std::vector<absl::string_view> lines =
+      absl::StrSplit(content, '\n', absl::SkipEmpty());
+  if (lines.empty() || lines.front() != kDatabaseHeader) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(origin, ": not a macro database of this version."));
+  }
+  // Definitions are complete once all their parameters are read.
+  std::unique_ptr<MacroDefinition> definition;
+  const auto flush = [&database, &definition]() {
+    if (definition == nullptr) return;
+    database->definitions_.insert_or_assign(definition->Name(), *definition);
+    definition.reset();
+  };
+  for (size_t i = 1; i < lines.size(); ++i) {
+    const std::vector<absl::string_view> fields =
+        absl::StrSplit(lines[i], '\t');
+    const auto malformed = [&origin, i]() {
+      return absl::InvalidArgumentError(
+          absl::StrCat(origin, ":", i + 1, ": malformed macro database line."));
+    };
+    // Reads the token at fields[index], fields[index + 1].
+    const auto token_at = [&database, &fields](size_t index,
+                                               TokenInfo *token) {
+      int token_enum;
+      std::string text;
+      if (!absl::SimpleAtoi(fields[index], &token_enum) ||
+          !absl::CUnescape(fields[index + 1], &text)) {
+        return false;
+      }
+      *token = database->OwnedToken(token_enum, text);
+      return true;
+    };
+    TokenInfo name = TokenInfo::EOFToken();
+    TokenInfo text = TokenInfo::EOFToken();
+    if (fields.front() == kDefineTag && fields.size() == 6) {
+      if (!token_at(1, &name) || (fields[3] != "0" && fields[3] != "1") ||
+          !token_at(4, &text)) {
+        return malformed();
+      }
+      flush();
+      definition = std::make_unique<MacroDefinition>(DefineHeaderToken(), name);
+      if (fields[3] == "1") definition->SetCallable();
+      definition->SetDefinitionText(text);
+    } else if (fields.front() == kParamTag && fields.size() == 5 &&
+               definition != nullptr) {
+      TokenInfo default_value = TokenInfo::EOFToken();
+      if (!token_at(1, &name) || !token_at(3, &default_value) ||
+          !definition->AppendParameter(
+              MacroParameterInfo(name, default_value))) {
+        return malformed();
+      }
+    } else {
+      return malformed();
+    }
+  }
+  flush();
+  return database;
+}
+
+}  // namespace verilog
@@ -0,0 +1,88 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_PREPROCESSOR_MACRO_DATABASE_H_
+#define VERIBLE_VERILOG_PREPROCESSOR_MACRO_DATABASE_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "common/text/macro_definition.h"
+#include "common/text/token_info.h"
+#include "verilog/preprocessor/verilog_preprocess.h"
+
+namespace verilog {
+
+// MacroDatabase is a snapshot of macro definitions, like precompiled headers
+// for the preprocessor: definitions collected once from defines files can be
+// saved and loaded by later runs, instead of preprocessing those files again.
+// The database owns the text of its definitions.
+//
+// usage:
+//   MacroDatabase database;
+//   for (const auto &[name, definition] : preprocess_data.macro_definitions) {
+//     database.Add(definition);
+//   }
+//   RETURN_IF_ERROR(database.Save(path));
+//   ...
+//   const auto loaded = MacroDatabase::Load(path);
+//   if (!loaded.ok()) return loaded.status();
+//   preprocessor.RegisterMacroDefinitions((*loaded)->Definitions());
+class MacroDatabase {
+ public:
+  using MacroDefinitionRegistry =
+      VerilogPreprocessData::MacroDefinitionRegistry;
+
+  MacroDatabase() = default;
+  MacroDatabase(const MacroDatabase &) = delete;
+  MacroDatabase &operator=(const MacroDatabase &) = delete;
+
+  // Reads a database written by Save().
+  static absl::StatusOr<std::unique_ptr<MacroDatabase>> Load(
+      absl::string_view path);
+
+  // Same as Load(), from the saved 'content'.  'origin' names the content in
+  // error messages.
+  static absl::StatusOr<std::unique_ptr<MacroDatabase>> Parse(
+      absl::string_view content, absl::string_view origin);
+
+  // Adds a copy of 'definition', replacing any definition of the same name.
+  void Add(const verible::MacroDefinition &definition);
+
+  // Returns the definitions by name.  They point into this database.
+  const MacroDefinitionRegistry &Definitions() const { return definitions_; }
+
+  // Returns the content that Save() writes.
+  std::string Serialize() const;
+
+  absl::Status Save(absl::string_view path) const;
+
+ private:
+  // Returns a token with a copy of 'text' owned by this database.
+  verible::TokenInfo OwnedToken(int token_enum, absl::string_view text);
+
+  // Text of the tokens of the definitions.  Elements of a deque are not
+  // moved when adding more.
+  std::deque<std::string> strings_;
+
+  MacroDefinitionRegistry definitions_;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_PREPROCESSOR_MACRO_DATABASE_H_
@@ -0,0 +1,142 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/preprocessor/macro_database.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/text/macro_definition.h"
+#include "common/text/token_info.h"
+#include "common/util/file_util.h"
+#include "gtest/gtest.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+namespace {
+
+using verible::MacroDefinition;
+using verible::MacroParameterInfo;
+using verible::TokenInfo;
+using verible::file::JoinPath;
+using verible::file::SetContents;
+
+static const TokenInfo kDefine(PP_define, "`define");
+
+// Expects 'actual' to define the same macro as 'expected'.
+static void ExpectSameDefinition(const MacroDefinition &actual,
+                                 const MacroDefinition &expected) {
+  EXPECT_EQ(actual.Name(), expected.Name());
+  EXPECT_TRUE(actual.NameToken().EquivalentWithoutLocation(
+      expected.NameToken()));
+  EXPECT_EQ(actual.IsCallable(), expected.IsCallable());
+  EXPECT_TRUE(actual.DefinitionText().EquivalentWithoutLocation(
+      expected.DefinitionText()));
+  ASSERT_EQ(actual.Parameters().size(), expected.Parameters().size());
+  for (size_t i = 0; i < expected.Parameters().size(); ++i) {
+    EXPECT_TRUE(actual.Parameters()[i].name.EquivalentWithoutLocation(
+        expected.Parameters()[i].name));
+    EXPECT_TRUE(actual.Parameters()[i].default_value.EquivalentWithoutLocation(
+        expected.Parameters()[i].default_value));
+  }
+}
+
+TEST(MacroDatabaseTest, SerializeAndParse) {
+  // The source text goes away after adding the definitions.
+  auto source = std::make_unique<std::string>("WIDTH 8 ADD a b 0 x+\ty\n");
+  const absl::string_view text(*source);
+  MacroDefinition plain(kDefine, TokenInfo(PP_Identifier, text.substr(0, 5)));
+  plain.SetDefinitionText(TokenInfo(PP_define_body, text.substr(6, 1)));
+  MacroDefinition callable(kDefine,
+                           TokenInfo(PP_Identifier, text.substr(8, 3)));
+  callable.SetCallable();
+  callable.AppendParameter(
+      MacroParameterInfo(TokenInfo(PP_Identifier, text.substr(12, 1))));
+  callable.AppendParameter(
+      MacroParameterInfo(TokenInfo(PP_Identifier, text.substr(14, 1)),
+                         TokenInfo(PP_default_text, text.substr(16, 1))));
+  callable.SetDefinitionText(TokenInfo(PP_define_body, text.substr(18)));
+
+  MacroDatabase database;
+  database.Add(plain);
+  database.Add(callable);
+  const std::string expected_plain_name(plain.Name());
+  source.reset();
+
+  const auto &definitions = database.Definitions();
+  ASSERT_EQ(definitions.size(), 2);
+  EXPECT_EQ(definitions.at("WIDTH").Name(), expected_plain_name);
+  EXPECT_EQ(definitions.at("ADD").DefinitionText().text(), "x+\ty\n");
+
+  const auto parsed = MacroDatabase::Parse(database.Serialize(), "db");
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  ASSERT_EQ((*parsed)->Definitions().size(), 2);
+  ExpectSameDefinition((*parsed)->Definitions().at("WIDTH"),
+                       definitions.at("WIDTH"));
+  ExpectSameDefinition((*parsed)->Definitions().at("ADD"),
+                       definitions.at("ADD"));
+  EXPECT_EQ((*parsed)->Serialize(), database.Serialize());
+}
+
+TEST(MacroDatabaseTest, AddReplacesDefinition) {
+  MacroDefinition first(kDefine, TokenInfo(PP_Identifier, "M"));
+  first.SetDefinitionText(TokenInfo(PP_define_body, "1"));
+  MacroDefinition second(kDefine, TokenInfo(PP_Identifier, "M"));
+  second.SetDefinitionText(TokenInfo(PP_define_body, "2"));
+  MacroDatabase database;
+  database.Add(first);
+  database.Add(second);
+  ASSERT_EQ(database.Definitions().size(), 1);
+  EXPECT_EQ(database.Definitions().at("M").DefinitionText().text(), "2");
+}
+
+TEST(MacroDatabaseTest, ParseMalformed) {
+  EXPECT_FALSE(MacroDatabase::Parse("", "db").ok());
+  EXPECT_FALSE(MacroDatabase::Parse("# some other file\n", "db").ok());
+  const std::string header(
+      "# verible-verilog-preprocessor macro database, version 1\n");
+  EXPECT_TRUE(MacroDatabase::Parse(header, "db").ok());
+  // Parameter without definition.
+  EXPECT_FALSE(MacroDatabase::Parse(header + "param\t1\ta\t0\t\n", "db").ok());
+  // Missing field.
+  EXPECT_FALSE(
+      MacroDatabase::Parse(header + "define\t1\tM\t0\t1\n", "db").ok());
+  // Not a number.
+  EXPECT_FALSE(
+      MacroDatabase::Parse(header + "define\tx\tM\t0\t1\t2\n", "db").ok());
+}
+
+TEST(MacroDatabaseTest, SaveAndLoad) {
+  MacroDefinition definition(kDefine, TokenInfo(PP_Identifier, "M"));
+  definition.SetDefinitionText(TokenInfo(PP_define_body, "\"quoted\"\\"));
+  MacroDatabase database;
+  database.Add(definition);
+
+  const std::string path = JoinPath(::testing::TempDir(), "macros.db");
+  ASSERT_TRUE(database.Save(path).ok());
+  const auto loaded = MacroDatabase::Load(path);
+  ASSERT_TRUE(loaded.ok()) << loaded.status();
+  ExpectSameDefinition((*loaded)->Definitions().at("M"), definition);
+
+  EXPECT_FALSE(
+      MacroDatabase::Load(JoinPath(::testing::TempDir(), "no_such.db")).ok());
+  const std::string malformed = JoinPath(::testing::TempDir(), "bad.db");
+  ASSERT_TRUE(SetContents(malformed, "something else\n").ok());
+  EXPECT_FALSE(MacroDatabase::Load(malformed).ok());
+}
+
+}  // namespace
+}  // namespace verilog
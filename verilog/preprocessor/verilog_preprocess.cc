@@ -14,10 +14,14 @@
 
 #include "verilog/preprocessor/verilog_preprocess.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,12 +32,14 @@
 #include "absl/strings/string_view.h"
 #include "common/lexer/token_generator.h"
 #include "common/lexer/token_stream_adapter.h"
+#include "common/strings/mem_block.h"
 #include "common/text/macro_definition.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
 #include "common/text/token_stream_view.h"
 #include "common/util/container_util.h"
 #include "common/util/logging.h"
+#include "common/util/sha256.h"
 #include "common/util/status_macros.h"
 #include "verilog/analysis/verilog_filelist.h"
 #include "verilog/parser/verilog_lexer.h"
@@ -47,10 +53,27 @@ using verible::TokenStreamView;
 using verible::container::FindOrNull;
 using verible::container::InsertOrUpdate;
 
+namespace {
+// Copies the content returned by "opener", whose lifetime is not known.
+VerilogPreprocess::BlockOpener CopyingBlockOpener(
+    VerilogPreprocess::FileOpener opener) {
+  if (!opener) return nullptr;
+  return [opener = std::move(opener)](absl::string_view filename)
+             -> absl::StatusOr<std::shared_ptr<verible::MemBlock>> {
+    absl::StatusOr<absl::string_view> content = opener(filename);
+    if (!content.ok()) return content.status();
+    return std::make_shared<verible::StringMemBlock>(*content);
+  };
+}
+}  // namespace
+
 VerilogPreprocess::VerilogPreprocess(const Config& config)
-    : VerilogPreprocess(config, nullptr) {}
+    : VerilogPreprocess(config, BlockOpener()) {}
 
 VerilogPreprocess::VerilogPreprocess(const Config& config, FileOpener opener)
+    : VerilogPreprocess(config, CopyingBlockOpener(std::move(opener))) {}
+
+VerilogPreprocess::VerilogPreprocess(const Config& config, BlockOpener opener)
     : config_(config), file_opener_(std::move(opener)) {
   // To avoid having to check at every place if the stack is empty, we always
   // place a toplevel 'conditional' that is always selected.
@@ -61,7 +84,7 @@ VerilogPreprocess::VerilogPreprocess(const Config& config, FileOpener opener)
 }
 
 TokenStreamView::const_iterator VerilogPreprocess::GenerateBypassWhiteSpaces(
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   auto iterator =
       generator();  // iterator should be pointing to a non-whitespace token;
   while (verilog::VerilogLexer::KeepSyntaxTreeTokens(**iterator) == 0) {
@@ -71,7 +94,7 @@ TokenStreamView::const_iterator VerilogPreprocess::GenerateBypassWhiteSpaces(
 }
 
 absl::StatusOr<TokenStreamView::const_iterator>
-VerilogPreprocess::ExtractMacroName(const StreamIteratorGenerator& generator) {
+VerilogPreprocess::ExtractMacroName(StreamIteratorGenerator& generator) {
   // Next token to expect is macro definition name.
   TokenStreamView::const_iterator token_iter =
       GenerateBypassWhiteSpaces(generator);
@@ -95,7 +118,7 @@ VerilogPreprocess::ExtractMacroName(const StreamIteratorGenerator& generator) {
 // Assumes that the last token of a definition is the un-lexed definition body.
 // Tokens are copied from the 'generator' into 'define_tokens'.
 absl::Status VerilogPreprocess::ConsumeMacroDefinition(
-    const StreamIteratorGenerator& generator, TokenStreamView* define_tokens) {
+    StreamIteratorGenerator& generator, TokenStreamView* define_tokens) {
   auto macro_name_extract = ExtractMacroName(generator);
   if (!macro_name_extract.ok()) {
     return macro_name_extract.status();
@@ -224,7 +247,7 @@ std::unique_ptr<VerilogPreprocessError> VerilogPreprocess::ParseMacroDefinition(
 // Parses a callable macro actual parameters, and saves it into a MacroCall
 absl::Status VerilogPreprocess::ConsumeAndParseMacroCall(
     TokenStreamView::const_iterator iter,
-    const StreamIteratorGenerator& generator, verible::MacroCall* macro_call,
+    StreamIteratorGenerator& generator, verible::MacroCall* macro_call,
     const verible::MacroDefinition& macro_definition) {
   // Parsing the macro .
   const absl::string_view macro_name_str = (*iter)->text().substr(1);
@@ -277,13 +300,12 @@ absl::Status VerilogPreprocess::ConsumeAndParseMacroCall(
   return absl::OkStatus();
 }
 
-// Responds to `define directives.  Macro definitions are parsed and saved
-// for use within the same file.
+// Expands the macro call at 'iter', appending the expanded tokens to 'out'.
 absl::Status VerilogPreprocess::HandleMacroIdentifier(
     const TokenStreamView::const_iterator
         iter  // points to `MACROIDENTIFIER token
     ,
-    const StreamIteratorGenerator& generator, bool forward = true) {
+    StreamIteratorGenerator& generator, TokenStreamView* out) {
   // Note: since this function is called we know that config_.expand_macros is
   // true.
 
@@ -299,20 +321,37 @@ absl::Status VerilogPreprocess::HandleMacroIdentifier(
         "Error expanding macro identifier, might not be defined before.");
   }
 
-  if (config_.expand_macros) {
-    verible::MacroCall macro_call;
-    RETURN_IF_ERROR(
-        ConsumeAndParseMacroCall(iter, generator, &macro_call, *found));
-    RETURN_IF_ERROR(ExpandMacro(macro_call, found));
-  }
-  auto& lexed = preprocess_data_.lexed_macros_backup.back();
-  if (!forward) return absl::OkStatus();
-  auto iter_generator = verible::MakeConstIteratorStreamer(lexed);
-  const auto it_end = lexed.end();
-  for (auto it = iter_generator(); it != it_end; it++) {
-    preprocess_data_.preprocessed_token_stream.push_back(it);
-  }
-  return absl::OkStatus();
+  if (!config_.expand_macros) return absl::OkStatus();
+  verible::MacroCall macro_call;
+  RETURN_IF_ERROR(
+      ConsumeAndParseMacroCall(iter, generator, &macro_call, *found));
+  if (config_.max_macro_depth > 0 && macro_depth_ >= config_.max_macro_depth) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("Macro expansion nests deeper than ",
+                     config_.max_macro_depth, " levels."));
+  }
+  auto& chunks = preprocess_data_.lexed_macros_backup;
+  const size_t chunks_before = chunks.size();
+  const size_t last_chunk_size = chunks.empty() ? 0 : chunks.back().size();
+  const size_t out_size = out->size();
+  ++macro_depth_;
+  const absl::Status status = ExpandMacro(macro_call, found, out);
+  --macro_depth_;
+  if (status.ok() || macro_depth_ > 0) return status;
+
+  // Nothing of a failed expansion is kept.
+  out->resize(out_size);
+  chunks.resize(chunks_before);
+  if (!chunks.empty()) {
+    chunks.back().erase(chunks.back().begin() + last_chunk_size,
+                        chunks.back().end());
+  }
+  // Errors of exceeded limits are reported at the outermost call.
+  if (absl::IsResourceExhausted(status)) {
+    preprocess_data_.errors.emplace_back(**iter,
+                                         std::string(status.message()));
+  }
+  return status;
 }
 
 // Stores a macro definition for later use.
@@ -322,38 +361,36 @@ void VerilogPreprocess::RegisterMacroDefinition(
   // definition if macro is re-defined.
   const bool inserted = InsertOrUpdate(&preprocess_data_.macro_definitions,
                                        definition.Name(), definition);
+  macro_bodies_.erase(definition.Name());
   if (inserted) return;
   preprocess_data_.warnings.emplace_back(definition.NameToken(),
                                          "Re-defining macro");
   // TODO(hzeller): multiline warning with 'previously defined here' location
 }
 
-// This function expands a text.
-// The expanded tokens are saved as a TokenSequence, stored at
-// preprocess_data_.lexed_macros_backup Can be accessed directly after expansion
-// as: preprocess_data_.lexed_macros_backup.back()
+// Lexes 'definition_text' and appends its tokens to 'out', expanding the
+// macro calls in it.
 absl::Status VerilogPreprocess::ExpandText(
-    const absl::string_view& definition_text) {
-  VerilogLexer lexer(definition_text);
+    const absl::string_view& definition_text, TokenStreamView* out) {
+  const PooledVerilogLexer lexer = AcquireVerilogLexer(definition_text);
   verible::TokenSequence lexed_sequence;
-  verible::TokenSequence expanded_lexed_sequence;
   // Populating the lexed token sequence.
-  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
-       lexer.DoNextToken()) {
-    lexed_sequence.push_back(lexer.GetLastToken());
+  for (lexer->DoNextToken(); !lexer->GetLastToken().isEOF();
+       lexer->DoNextToken()) {
+    lexed_sequence.push_back(lexer->GetLastToken());
   }
   verible::TokenStreamView lexed_streamview;
   // Initializing the lexed token stream view.
   InitTokenStreamView(lexed_sequence, &lexed_streamview);
 
-  auto iter_generator = verible::MakeConstIteratorStreamer(lexed_streamview);
+  StreamIteratorGenerator iter_generator(lexed_streamview);
   const auto end = lexed_streamview.end();
 
   // Token-pulling loop.
   for (auto iter = iter_generator(); iter != end; iter = iter_generator()) {
     auto& last_token = **iter;
     // TODO: handle lexical error
-    if (lexer.GetLastToken().token_enum() == TK_SPACE) {
+    if (lexer->GetLastToken().token_enum() == TK_SPACE) {
       continue;  // don't forward spaces
     }
     // If the expanded token is another macro identifier that needs to be
@@ -363,78 +400,121 @@ absl::Status VerilogPreprocess::ExpandText(
     if (last_token.token_enum() == MacroIdentifier ||
         last_token.token_enum() == MacroIdItem ||
         last_token.token_enum() == MacroCallId) {
-      RETURN_IF_ERROR(HandleMacroIdentifier(iter, iter_generator, false));
-      // merge the expanded macro tokens into 'expanded_lexed_sequence'
-      auto& expanded_child = preprocess_data_.lexed_macros_backup.back();
-      for (auto& u : expanded_child) expanded_lexed_sequence.push_back(u);
+      RETURN_IF_ERROR(HandleMacroIdentifier(iter, iter_generator, out));
       continue;
     }
-    expanded_lexed_sequence.push_back(last_token);
+    RETURN_IF_ERROR(EmitExpandedToken(last_token, out));
   }
-  preprocess_data_.lexed_macros_backup.emplace_back(expanded_lexed_sequence);
   return absl::OkStatus();
 }
 
+absl::Status VerilogPreprocess::EmitExpandedToken(
+    const verible::TokenInfo& token, TokenStreamView* out) {
+  if (config_.max_macro_tokens > 0 &&
+      expanded_macro_tokens_ >= config_.max_macro_tokens) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("Macro expansions produce more than ",
+                     config_.max_macro_tokens, " tokens."));
+  }
+  ++expanded_macro_tokens_;
+  auto& chunks = preprocess_data_.lexed_macros_backup;
+  if (chunks.empty() || chunks.back().size() == chunks.back().capacity()) {
+    // Chunks are never reallocated, so that 'out' can point into them.
+    // They grow geometrically, for few chunks in large expansions.
+    constexpr size_t kMinChunkSize = 256;
+    constexpr size_t kMaxChunkSize = 64 * 1024;
+    const size_t size =
+        chunks.empty() ? kMinChunkSize
+                       : std::min(2 * chunks.back().capacity(), kMaxChunkSize);
+    chunks.emplace_back().reserve(std::max(size, kMinChunkSize));
+  }
+  chunks.back().push_back(token);
+  out->push_back(chunks.back().end() - 1);
+  return absl::OkStatus();
+}
+
+static bool IsMacroReference(const verible::TokenInfo& token) {
+  return token.token_enum() == MacroIdentifier ||
+         token.token_enum() == MacroIdItem ||
+         token.token_enum() == MacroCallId;
+}
+
+VerilogPreprocess::MacroBodyTemplate VerilogPreprocess::LexMacroBody(
+    const MacroDefinition& definition) {
+  MacroBodyTemplate body;
+  const auto& parameters = definition.Parameters();
+  const PooledVerilogLexer lexer =
+      AcquireVerilogLexer(definition.DefinitionText().text());
+  for (lexer->DoNextToken(); !lexer->GetLastToken().isEOF();
+       lexer->DoNextToken()) {
+    const verible::TokenInfo& token = lexer->GetLastToken();
+    if (token.token_enum() == TK_SPACE) continue;  // spaces are not forwarded
+    int slot = -1;
+    if (definition.IsCallable() && !IsMacroReference(token)) {
+      // As with a substitution map, the last parameter of a name wins.
+      for (size_t i = 0; i < parameters.size(); ++i) {
+        if (parameters[i].name.text() == token.text()) slot = i;
+      }
+    }
+    body.tokens.push_back(token);
+    body.parameter_slots.push_back(slot);
+  }
+  return body;
+}
+
+const VerilogPreprocess::MacroBodyTemplate& VerilogPreprocess::GetMacroBody(
+    const MacroDefinition& definition) {
+  auto found = macro_bodies_.find(definition.Name());
+  if (found == macro_bodies_.end()) {
+    found = macro_bodies_.emplace(definition.Name(), LexMacroBody(definition))
+                .first;
+  }
+  return found->second;
+}
+
 // This method expands a callable macro call, that follows this form:
 // `MACRO([param1],[param2],...)
+// The expanded tokens, including those of nested macro calls, are appended
+// to 'out'.
 absl::Status VerilogPreprocess::ExpandMacro(
     const verible::MacroCall& macro_call,
-    const verible::MacroDefinition* macro_definition) {
+    const verible::MacroDefinition* macro_definition, TokenStreamView* out) {
   const auto& actual_parameters = macro_call.positional_arguments;
 
-  std::map<absl::string_view, verible::DefaultTokenInfo> subs_map;
+  std::vector<verible::DefaultTokenInfo> replacements;
   if (macro_definition->IsCallable()) {
-    RETURN_IF_ERROR(macro_definition->PopulateSubstitutionMap(actual_parameters,
-                                                              &subs_map));
+    RETURN_IF_ERROR(macro_definition->PopulateReplacements(actual_parameters,
+                                                           &replacements));
   }
 
-  VerilogLexer lexer(macro_definition->DefinitionText().text());
-  verible::TokenSequence lexed_sequence;
-  verible::TokenSequence expanded_lexed_sequence;
-  // Populating the lexed token sequence.
-  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
-       lexer.DoNextToken()) {
-    lexed_sequence.push_back(lexer.GetLastToken());
-  }
-  verible::TokenStreamView lexed_streamview;
-  // Initializing the lexed token stream view.
-  InitTokenStreamView(lexed_sequence, &lexed_streamview);
+  // Nested expansions may lex other bodies, which does not move this one.
+  const MacroBodyTemplate& body = GetMacroBody(*macro_definition);
+  verible::TokenStreamView body_streamview;
+  InitTokenStreamView(body.tokens, &body_streamview);
 
-  auto iter_generator = verible::MakeConstIteratorStreamer(lexed_streamview);
-  const auto end = lexed_streamview.end();
+  StreamIteratorGenerator iter_generator(body_streamview);
+  const auto end = body_streamview.end();
 
   // Token-pulling loop.
   for (auto iter = iter_generator(); iter != end; iter = iter_generator()) {
     // TODO: handle lexical error
     auto& last_token = **iter;
-    if (last_token.token_enum() == TK_SPACE) continue;  // don't forward spaces
     // If the expanded token is another macro identifier that needs to be
     // expanded.
     // TODO: this needs to be something like HandleTokenIterator, to claim that
     // it fully covers all cases.
-    if (last_token.token_enum() == MacroIdentifier ||
-        last_token.token_enum() == MacroIdItem ||
-        last_token.token_enum() == MacroCallId) {
-      RETURN_IF_ERROR(HandleMacroIdentifier(iter, iter_generator, false));
-      // merge the expanded macro tokens into 'expanded_lexed_sequence'
-      auto& expanded_child = preprocess_data_.lexed_macros_backup.back();
-      for (auto& u : expanded_child) expanded_lexed_sequence.push_back(u);
+    if (IsMacroReference(last_token)) {
+      RETURN_IF_ERROR(HandleMacroIdentifier(iter, iter_generator, out));
       continue;
     }
-    if (macro_definition->IsCallable()) {
-      // Check if the last token is a formal parameter
-      const auto* replacement = FindOrNull(subs_map, last_token.text());
-      if (replacement) {
-        RETURN_IF_ERROR(ExpandText(replacement->text()));
-        // merge the expanded macro tokens into 'expanded_lexed_sequence'
-        auto& expanded_child = preprocess_data_.lexed_macros_backup.back();
-        for (auto& u : expanded_child) expanded_lexed_sequence.push_back(u);
-        continue;
-      }
+    // Check if the last token is a formal parameter
+    const int slot = body.parameter_slots[*iter - body.tokens.begin()];
+    if (slot >= 0) {
+      RETURN_IF_ERROR(ExpandText(replacements[slot].text(), out));
+      continue;
     }
-    expanded_lexed_sequence.push_back(last_token);
+    RETURN_IF_ERROR(EmitExpandedToken(last_token, out));
   }
-  preprocess_data_.lexed_macros_backup.emplace_back(expanded_lexed_sequence);
   return absl::OkStatus();
 }
 
@@ -442,7 +522,7 @@ absl::Status VerilogPreprocess::ExpandMacro(
 // for use within the same file.
 absl::Status VerilogPreprocess::HandleDefine(
     const TokenStreamView::const_iterator iter,  // points to `define token
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   TokenStreamView define_tokens;
   define_tokens.push_back(*iter);
   RETURN_IF_ERROR(ConsumeMacroDefinition(generator, &define_tokens));
@@ -475,13 +555,14 @@ absl::Status VerilogPreprocess::HandleDefine(
 
 absl::Status VerilogPreprocess::HandleUndef(
     TokenStreamView::const_iterator undef_it,
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   auto macro_name_extract = ExtractMacroName(generator);
   if (!macro_name_extract.ok()) {
     return macro_name_extract.status();
   }
   const auto& macro_name = *macro_name_extract.value();
   preprocess_data_.macro_definitions.erase(macro_name->text());
+  macro_bodies_.erase(macro_name->text());
 
   // For now, forward all `undef tokens.
   if (conditional_block_.top().InSelectedBranch()) {
@@ -493,7 +574,7 @@ absl::Status VerilogPreprocess::HandleUndef(
 
 absl::Status VerilogPreprocess::HandleIf(
     const TokenStreamView::const_iterator ifpos,  // `ifdef, `ifndef, `elseif
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   if (!config_.filter_branches) {  // nothing to do.
     preprocess_data_.preprocessed_token_stream.push_back(*ifpos);
     return absl::OkStatus();
@@ -564,6 +645,46 @@ absl::Status VerilogPreprocess::HandleEndif(
   return absl::OkStatus();
 }
 
+// Returns the name of the macro that guards all of 'tokens' in the form
+//
+//   `ifndef GUARD
+//   `define GUARD
+//   ...
+//   `endif
+//
+// with only whitespace and comments outside, or an empty string.
+static absl::string_view FindIncludeGuard(
+    const verible::TokenSequence& tokens) {
+  std::vector<const verible::TokenInfo*> directives;
+  int depth = 0;
+  for (const verible::TokenInfo& token : tokens) {
+    if (!verilog::VerilogLexer::KeepSyntaxTreeTokens(token)) continue;
+    // Nothing may follow the `endif that closes the guard.
+    if (!directives.empty() && depth == 0) return "";
+    switch (token.token_enum()) {
+      case PP_ifdef:
+      case PP_ifndef:
+        ++depth;
+        break;
+      case PP_endif:
+        --depth;
+        break;
+      default:
+        break;
+    }
+    if (directives.size() < 4) directives.push_back(&token);
+  }
+  if (directives.size() < 4 || depth != 0) return "";
+  if (directives[0]->token_enum() != PP_ifndef ||
+      directives[1]->token_enum() != PP_Identifier ||
+      directives[2]->token_enum() != PP_define ||
+      directives[3]->token_enum() != PP_Identifier ||
+      directives[1]->text() != directives[3]->text()) {
+    return "";
+  }
+  return directives[1]->text();
+}
+
 // Handle `include directives.
 // TODO(karimtera):  An important future work would be to utilize
 // "VerilogProject::OpenIncludedFile()", which has more advantages over the way
@@ -580,7 +701,7 @@ absl::Status VerilogPreprocess::HandleEndif(
 
 absl::Status VerilogPreprocess::HandleInclude(
     TokenStreamView::const_iterator iter,
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   if (!file_opener_) {
     return absl::FailedPreconditionError("file_opener_ is not defined");
   }
@@ -609,39 +730,59 @@ absl::Status VerilogPreprocess::HandleInclude(
         **token_iter, std::string(status_or_file.status().message()));
     return status_or_file.status();
   }
-  const absl::string_view source_contents = *status_or_file;
+  const std::shared_ptr<verible::MemBlock>& source_block = *status_or_file;
+  const absl::string_view source_contents = source_block->AsStringView();
+
+  // Without a cache, the entry is only used for this inclusion.
+  std::unique_ptr<IncludeFileCache::Entry> uncached_entry;
+  IncludeFileCache::Entry* entry;
+  if (include_cache_ != nullptr) {
+    auto& cached_entry = include_cache_->entries_[IncludeCacheKey(
+        file_path.string(), source_contents)];
+    if (cached_entry == nullptr) {
+      cached_entry = std::make_unique<IncludeFileCache::Entry>();
+    }
+    entry = cached_entry.get();
+  } else {
+    uncached_entry = std::make_unique<IncludeFileCache::Entry>();
+    entry = uncached_entry.get();
+  }
+
+  if (entry->text_structure == nullptr) {
+    entry->text_structure.reset(new verible::TextStructure(source_block));
+    // Lexing the included file content into its token sequence.
+    verible::TokenSequence& included_sequence =
+        entry->text_structure->MutableData().MutableTokenStream();
+    verilog::VerilogLexer lexer(entry->text_structure->Data().Contents());
+    for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
+         lexer.DoNextToken()) {
+      included_sequence.push_back(lexer.GetLastToken());
+    }
+    entry->include_guard = std::string(FindIncludeGuard(included_sequence));
+  }
 
-  // Creating a new "VerilogPreprocess" object for the included file,
-  // With the same configuration and preprocessing info (defines, incdirs) as
-  // the main one.
-  // TODO(karimtera): Ideally modify the FileOpener to return
-  // absl::StatusOr<MemBlock> to avoid doing a second copy inside TextStructure.
-  verilog::VerilogPreprocess child_preprocessor(config_, file_opener_);
-  child_preprocessor.setPreprocessingInfo(preprocess_info_);
+  if (IsIncludeGuardDefined(entry->include_guard)) {
+    VLOG(2) << "Skipping guarded " << file_path;
+    return absl::OkStatus();
+  }
 
   // TODO(karimtera): limit number of nested includes, detect cycles? maybe.
-  preprocess_data_.included_text_structure.emplace_back(
-      new verible::TextStructure(source_contents));
-  verible::TextStructure& included_structure =
-      *preprocess_data_.included_text_structure.back();
-
-  // "included_sequence" should contain the lexed token sequence.
-  verible::TokenSequence& included_sequence =
-      included_structure.MutableData().MutableTokenStream();
-
-  // Lexing the included file content, and storing it in "included_sequence".
-  verilog::VerilogLexer lexer(included_structure.Data().Contents());
-  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
-       lexer.DoNextToken()) {
-    included_sequence.push_back(lexer.GetLastToken());
+  if (!entry->preprocessed) PreprocessIncludedFile(entry);
+  VerilogPreprocessData& child_preprocessed_data = entry->preprocess_data;
+
+  // Unless cached, the memory that the forwarded tokens and errors point into
+  // has to be kept alive by this preprocessor.
+  if (uncached_entry != nullptr) {
+    preprocess_data_.included_text_structure.push_back(
+        std::move(entry->text_structure));
+    for (auto& u : child_preprocessed_data.included_text_structure) {
+      preprocess_data_.included_text_structure.push_back(std::move(u));
+    }
+    for (auto& u : child_preprocessed_data.lexed_macros_backup) {
+      preprocess_data_.lexed_macros_backup.push_back(std::move(u));
+    }
   }
 
-  // Preprocessing the included file tokens.
-  verible::TokenStreamView lexed_streamview;
-  InitTokenStreamView(included_sequence, &lexed_streamview);
-  verilog::VerilogPreprocessData child_preprocessed_data =
-      child_preprocessor.ScanStream(lexed_streamview);
-
   // Check for errors while preprocessing the included file.
   if (!child_preprocessed_data.errors.empty()) {
     preprocess_data_.errors.insert(preprocess_data_.errors.end(),
@@ -651,11 +792,11 @@ absl::Status VerilogPreprocess::HandleInclude(
         "Error: the included file preprocessing has failed.");
   }
 
-  // Need to move the text structures of the child preprocessor to avoid
-  // destruction.
-  for (auto& u : child_preprocessed_data.included_text_structure) {
-    preprocess_data_.included_text_structure.push_back(std::move(u));
+  if (!entry->include_guard.empty()) {
+    included_guards_.insert(entry->include_guard);
   }
+  included_guards_.insert(entry->nested_include_guards.begin(),
+                          entry->nested_include_guards.end());
 
   // Forwarding the included preprocessed view.
   for (const auto& u : child_preprocessed_data.preprocessed_token_stream) {
@@ -665,11 +806,60 @@ absl::Status VerilogPreprocess::HandleInclude(
   return absl::OkStatus();
 }
 
+std::string VerilogPreprocess::IncludeCacheKey(
+    absl::string_view filename, absl::string_view contents) const {
+  std::string key = absl::StrCat(filename, "\n", verible::Sha256Hex(contents),
+                                 "\n", config_.filter_branches, " ",
+                                 config_.include_files, " ",
+                                 config_.expand_macros, " ",
+                                 config_.max_macro_depth, " ",
+                                 config_.max_macro_tokens, "\n");
+  for (const auto& define : preprocess_info_.defines) {
+    absl::StrAppend(&key, define.name, "=", define.value, "\n");
+  }
+  // Registered definitions outlive the cache, so they are told apart by
+  // address.
+  for (const auto* definitions : registered_definitions_) {
+    absl::StrAppend(&key, "registered ",
+                    absl::Hex(reinterpret_cast<uintptr_t>(definitions)), "\n");
+  }
+  return key;
+}
+
+void VerilogPreprocess::PreprocessIncludedFile(
+    IncludeFileCache::Entry* entry) const {
+  // Creating a new "VerilogPreprocess" object for the included file,
+  // With the same configuration and preprocessing info (defines, incdirs) as
+  // the main one.
+  verilog::VerilogPreprocess child_preprocessor(config_, file_opener_);
+  child_preprocessor.setPreprocessingInfo(preprocess_info_);
+  for (const auto* definitions : registered_definitions_) {
+    child_preprocessor.RegisterMacroDefinitions(*definitions);
+  }
+  child_preprocessor.SetIncludeFileCache(include_cache_);
+
+  // Preprocessing the included file tokens.
+  verible::TokenStreamView lexed_streamview;
+  InitTokenStreamView(entry->text_structure->Data().TokenStream(),
+                      &lexed_streamview);
+  entry->preprocess_data = child_preprocessor.ScanStream(lexed_streamview);
+  entry->nested_include_guards = std::move(child_preprocessor.included_guards_);
+  entry->preprocessed = true;
+}
+
+bool VerilogPreprocess::IsIncludeGuardDefined(
+    absl::string_view include_guard) const {
+  if (include_guard.empty() || !config_.filter_branches) return false;
+  const auto& defs = preprocess_data_.macro_definitions;
+  return included_guards_.find(include_guard) != included_guards_.end() ||
+         defs.find(include_guard) != defs.end();
+}
+
 // Interprets preprocessor tokens as directives that act on this preprocessor
 // object and possibly transform the input token stream.
 absl::Status VerilogPreprocess::HandleTokenIterator(
     TokenStreamView::const_iterator iter,
-    const StreamIteratorGenerator& generator) {
+    StreamIteratorGenerator& generator) {
   switch ((*iter)->token_enum()) {
     case PP_define:
       return HandleDefine(iter, generator);
@@ -690,7 +880,8 @@ absl::Status VerilogPreprocess::HandleTokenIterator(
   if (config_.expand_macros && ((*iter)->token_enum() == MacroIdentifier ||
                                 (*iter)->token_enum() == MacroIdItem ||
                                 (*iter)->token_enum() == MacroCallId)) {
-    return HandleMacroIdentifier(iter, generator);
+    return HandleMacroIdentifier(iter, generator,
+                                 &preprocess_data_.preprocessed_token_stream);
   }
 
   if (config_.include_files && (*iter)->token_enum() == PP_include) {
@@ -725,10 +916,18 @@ void VerilogPreprocess::setPreprocessingInfo(
   // We can directly access "preprocess_info_.include_dirs" whenever needed.
 }
 
+void VerilogPreprocess::RegisterMacroDefinitions(
+    const VerilogPreprocessData::MacroDefinitionRegistry& definitions) {
+  registered_definitions_.push_back(&definitions);
+  for (const auto& [name, definition] : definitions) {
+    RegisterMacroDefinition(definition);
+  }
+}
+
 VerilogPreprocessData VerilogPreprocess::ScanStream(
     const TokenStreamView& token_stream) {
   preprocess_data_.preprocessed_token_stream.reserve(token_stream.size());
-  auto iter_generator = verible::MakeConstIteratorStreamer(token_stream);
+  StreamIteratorGenerator iter_generator(token_stream);
   const auto end = token_stream.end();
   // Token-pulling loop.
   for (auto iter = iter_generator(); iter != end; iter = iter_generator()) {
@@ -35,9 +35,11 @@
 #ifndef VERIBLE_VERILOG_PREPROCESSOR_VERILOG_PREPROCESS_H_
 #define VERIBLE_VERILOG_PREPROCESSOR_VERILOG_PREPROCESS_H_
 
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <stack>
 #include <string>
 #include <vector>
@@ -45,6 +47,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "common/lexer/token_stream_adapter.h"
+#include "common/strings/mem_block.h"
 #include "common/text/macro_definition.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
@@ -74,6 +78,10 @@ struct VerilogPreprocessData {
 
   // Resulting token stream after preprocessing
   verible::TokenStreamView preprocessed_token_stream;
+
+  // Tokens of macro expansions, which the token stream points into, in
+  // append-only chunks that are never reallocated.  Each expanded token is
+  // stored once, however deeply the macro call that produced it was nested.
   std::vector<TokenSequence> lexed_macros_backup;
 
   // A backup memory that owns the content of the included files.
@@ -89,6 +97,43 @@ struct VerilogPreprocessData {
   std::vector<VerilogPreprocessError> warnings;
 };
 
+// IncludeFileCache keeps included files lexed and preprocessed, so that the
+// preprocessors of several translation units that include the same files do
+// that only once per file.  The result of preprocessing an included file
+// only depends on its content and on the preprocessor configuration and
+// preprocessing info, which are part of the key of each entry.
+// The token streams of preprocessors that use the cache point into it, so it
+// has to outlive their results.
+class IncludeFileCache {
+ public:
+  IncludeFileCache() = default;
+  IncludeFileCache(const IncludeFileCache&) = delete;
+  IncludeFileCache& operator=(const IncludeFileCache&) = delete;
+
+  // Number of included files that are cached.
+  size_t size() const { return entries_.size(); }
+
+ private:
+  friend class VerilogPreprocess;
+
+  struct Entry {
+    std::unique_ptr<verible::TextStructure> text_structure;
+
+    // Name of the macro that guards the whole file with `ifndef, if any.
+    std::string include_guard;
+
+    // Set once the file has been preprocessed.
+    bool preprocessed = false;
+    VerilogPreprocessData preprocess_data;
+
+    // Include guards of the files it includes, transitively.
+    std::set<std::string, std::less<>> nested_include_guards;
+  };
+
+  // Key: file name, content digest, configuration and defines.
+  std::map<std::string, std::unique_ptr<Entry>> entries_;
+};
+
 // VerilogPreprocess transforms a TokenStreamView.
 // The input stream view is expected to have been stripped of whitespace.
 class VerilogPreprocess {
@@ -99,6 +144,11 @@ class VerilogPreprocess {
  public:
   using FileOpener =
       std::function<absl::StatusOr<absl::string_view>(absl::string_view)>;
+  // Like a FileOpener, but returns the block holding the content, which the
+  // preprocessor then shares instead of copying the content of the file.
+  using BlockOpener =
+      std::function<absl::StatusOr<std::shared_ptr<verible::MemBlock>>(
+          absl::string_view)>;
   struct Config {
     // Filter out non-matching `ifdef and `ifndef branches depending on
     // which defines are set.
@@ -115,11 +165,20 @@ class VerilogPreprocess {
 
     // Expand macro definition bodies, this will relexes the macro body.
     bool expand_macros = false;
+
+    // Limits of macro expansion, so that recursive or exponentially growing
+    // macros cannot exhaust the stack, time or memory: how deeply macro
+    // calls may nest within expansions, and how many tokens the expansions
+    // of one preprocessed file may produce in total.  Exceeding either is
+    // reported as an error at the outermost macro call.  0: unlimited.
+    int max_macro_depth = 128;
+    size_t max_macro_tokens = 1 << 22;
     // TODO(hzeller): Provide a map of command-line provided +define+'s
   };
 
   explicit VerilogPreprocess(const Config& config);
   VerilogPreprocess(const Config& config, FileOpener opener);
+  VerilogPreprocess(const Config& config, BlockOpener opener);
 
   // Initialize preprocessing with safe default options
   // TODO(hzeller): remove this constructor once all places using the
@@ -138,39 +197,50 @@ class VerilogPreprocess {
   void setPreprocessingInfo(
       const verilog::FileList::PreprocessingInfo& preprocess_info);
 
+  // Registers 'definitions' as if they were defined before the token stream,
+  // e.g. ones loaded from a MacroDatabase.  Like the defines of the
+  // preprocessing info, they also apply to included files.  'definitions'
+  // has to outlive the result of ScanStream() and any IncludeFileCache used.
+  void RegisterMacroDefinitions(
+      const VerilogPreprocessData::MacroDefinitionRegistry& definitions);
+
+  // Shares lexed and preprocessed included files through 'cache' (not owned),
+  // which has to outlive the result of ScanStream().
+  void SetIncludeFileCache(IncludeFileCache* cache) { include_cache_ = cache; }
+
  private:
   using StreamIteratorGenerator =
-      std::function<TokenStreamView::const_iterator()>;
+      verible::ConstIteratorStreamer<TokenStreamView>;
 
   // Extract macro name after `define, `ifdef, `elsif ... and returns
   // iterator of macro name or a failure status.
   // Updates error messages on failure.
   absl::StatusOr<TokenStreamView::const_iterator> ExtractMacroName(
-      const StreamIteratorGenerator&);
+      StreamIteratorGenerator&);
 
   absl::Status HandleTokenIterator(TokenStreamView::const_iterator,
-                                   const StreamIteratorGenerator&);
+                                   StreamIteratorGenerator&);
   absl::Status HandleMacroIdentifier(TokenStreamView::const_iterator,
-                                     const StreamIteratorGenerator&,
-                                     bool forward);
+                                     StreamIteratorGenerator&,
+                                     TokenStreamView* out);
 
   absl::Status HandleDefine(TokenStreamView::const_iterator,
-                            const StreamIteratorGenerator&);
+                            StreamIteratorGenerator&);
   absl::Status HandleUndef(TokenStreamView::const_iterator,
-                           const StreamIteratorGenerator&);
+                           StreamIteratorGenerator&);
 
   absl::Status HandleIf(TokenStreamView::const_iterator ifpos,
-                        const StreamIteratorGenerator&);
+                        StreamIteratorGenerator&);
   absl::Status HandleElse(TokenStreamView::const_iterator else_pos);
   absl::Status HandleEndif(TokenStreamView::const_iterator endif_pos);
 
   static absl::Status ConsumeAndParseMacroCall(TokenStreamView::const_iterator,
-                                               const StreamIteratorGenerator&,
+                                               StreamIteratorGenerator&,
                                                verible::MacroCall*,
                                                const verible::MacroDefinition&);
 
   // The following functions return nullptr when there is no error:
-  absl::Status ConsumeMacroDefinition(const StreamIteratorGenerator&,
+  absl::Status ConsumeMacroDefinition(StreamIteratorGenerator&,
                                       TokenStreamView*);
 
   static std::unique_ptr<VerilogPreprocessError> ParseMacroDefinition(
@@ -179,16 +249,50 @@ class VerilogPreprocess {
   static std::unique_ptr<VerilogPreprocessError> ParseMacroParameter(
       TokenStreamView::const_iterator*, MacroParameterInfo*);
 
+  // The body of a macro definition, lexed once, so that expanding the macro
+  // only copies the tokens and substitutes the actual parameters.
+  struct MacroBodyTemplate {
+    // Tokens of the body, without spaces.  They point into the definition
+    // text.
+    verible::TokenSequence tokens;
+    // For each of 'tokens', the position of the formal parameter it refers
+    // to, or -1.
+    std::vector<int> parameter_slots;
+  };
+
+  static MacroBodyTemplate LexMacroBody(const MacroDefinition&);
+
+  // Returns the lexed body of a registered 'definition'.
+  const MacroBodyTemplate& GetMacroBody(const MacroDefinition& definition);
+
   void RegisterMacroDefinition(const MacroDefinition&);
-  absl::Status ExpandText(const absl::string_view&);
+  absl::Status ExpandText(const absl::string_view&, TokenStreamView* out);
   absl::Status ExpandMacro(const verible::MacroCall&,
-                           const verible::MacroDefinition*);
+                           const verible::MacroDefinition*,
+                           TokenStreamView* out);
+
+  // Stores a copy of 'token' in preprocess_data_.lexed_macros_backup and
+  // appends it to 'out'.  Fails if that exceeds config_.max_macro_tokens.
+  absl::Status EmitExpandedToken(const verible::TokenInfo& token,
+                                 TokenStreamView* out);
   absl::Status HandleInclude(TokenStreamView::const_iterator,
-                             const StreamIteratorGenerator&);
+                             StreamIteratorGenerator&);
+
+  // Returns the key of 'contents' of included file 'filename' in an
+  // IncludeFileCache.
+  std::string IncludeCacheKey(absl::string_view filename,
+                              absl::string_view contents) const;
+
+  // Preprocesses the included file of 'entry' with a child preprocessor.
+  void PreprocessIncludedFile(IncludeFileCache::Entry* entry) const;
+
+  // Returns true if a file guarded by 'include_guard' need not be included,
+  // as branches are filtered and the guard is already defined.
+  bool IsIncludeGuardDefined(absl::string_view include_guard) const;
 
   // Generate a const_iterator to a non-whitespace token.
   static TokenStreamView::const_iterator GenerateBypassWhiteSpaces(
-      const StreamIteratorGenerator&);
+      StreamIteratorGenerator&);
 
   const Config config_;
 
@@ -252,7 +356,27 @@ class VerilogPreprocess {
 
   // A pointer to a file opener function.
   // This is needed for opening new files while handling includes.
-  const FileOpener file_opener_ = nullptr;
+  const BlockOpener file_opener_ = nullptr;
+
+  // Shared included files, if not nullptr.
+  IncludeFileCache* include_cache_ = nullptr;
+
+  // Lexed bodies of the macro definitions expanded so far, by name.  Dropped
+  // when the macro is re-defined or undefined.
+  std::map<absl::string_view, MacroBodyTemplate> macro_bodies_;
+
+  // Nesting depth of the macro expansion in progress, and the number of
+  // tokens that all expansions produced, checked against the config_ limits.
+  int macro_depth_ = 0;
+  size_t expanded_macro_tokens_ = 0;
+
+  // Registered by RegisterMacroDefinitions(), not owned.
+  std::vector<const VerilogPreprocessData::MacroDefinitionRegistry*>
+      registered_definitions_;
+
+  // Include guards of the files included so far.  Each guard was defined by
+  // its file when it was included.
+  std::set<std::string, std::less<>> included_guards_;
 };
 
 }  // namespace verilog
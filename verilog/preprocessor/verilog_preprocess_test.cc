@@ -770,6 +770,29 @@ $display(5,,0,,"C");
 endmodule
 `undef MACRO)"},
 
+      {"[** Re-defined callable macro expands its latest body **]",
+       R"(
+`define ADD(a, b) a+b
+module foo;
+assign x = `ADD(1, 2);
+`define ADD(b, a) b-a
+assign y = `ADD(3, 4);
+`undef ADD
+`define ADD(c) c*c
+assign z = `ADD(5);
+endmodule)",
+       // ...equivalent to
+       R"(
+`define ADD(a, b) a+b
+module foo;
+assign x = 1+2;
+`define ADD(b, a) b-a
+assign y = 3-4;
+`undef ADD
+`define ADD(c) c*c
+assign z = 5*5;
+endmodule)"},
+
       {"[** Nested callable macros **]",
        R"(
 `define MACRO1(n) real x=n;
@@ -822,6 +845,90 @@ endmodule
   }
 }
 
+struct MacroLimitTest {
+  absl::string_view description;
+  absl::string_view input;
+  int max_macro_depth;
+  size_t max_macro_tokens;
+  int offset;  // of the reported macro call, or -1 if within the limits.
+  absl::string_view expected_error;
+};
+
+TEST(VerilogPreprocessTest, MacroExpansionLimits) {
+  constexpr absl::string_view kNested3 =
+      "`define A x\n"
+      "`define B `A\n"
+      "`define C `B\n"
+      "`C\n";
+  // Each level doubles the tokens of the one below.
+  constexpr absl::string_view kCascade =
+      "`define A0 x x\n"
+      "`define A1 `A0 `A0\n"
+      "`define A2 `A1 `A1\n"
+      "`define A3 `A2 `A2\n"
+      "`define A4 `A3 `A3\n"
+      "y `A4\n";
+  const MacroLimitTest test_cases[] = {
+      {"recursive macro", "`define R `R\nfoo `R\n", 128, 0, 17,
+       "Macro expansion nests deeper than 128 levels."},
+      {"mutually recursive macros",
+       "`define P(a) `Q(a)\n`define Q(a) `P(a)\n`P(1)\n", 50, 0, 38,
+       "Macro expansion nests deeper than 50 levels."},
+      {"depth at limit", kNested3, 3, 0, -1, ""},
+      {"depth over limit", kNested3, 2, 0, 38,
+       "Macro expansion nests deeper than 2 levels."},
+      {"tokens unlimited", kCascade, 0, 0, -1, ""},
+      // A4 yields 32 tokens.
+      {"tokens at limit", kCascade, 0, 32, -1, ""},
+      {"tokens over limit", kCascade, 0, 31, 93,
+       "Macro expansions produce more than 31 tokens."},
+  };
+  for (const auto &test : test_cases) {
+    PreprocessorTester tester(
+        test.input, VerilogPreprocess::Config({
+                        .expand_macros = true,
+                        .max_macro_depth = test.max_macro_depth,
+                        .max_macro_tokens = test.max_macro_tokens,
+                    }));
+    const auto &errors = tester.PreprocessorData().errors;
+    if (test.offset < 0) {
+      EXPECT_TRUE(errors.empty()) << test.description;
+      continue;
+    }
+    EXPECT_FALSE(tester.Status().ok()) << test.description;
+    ASSERT_EQ(errors.size(), 1) << test.description;
+    EXPECT_EQ(errors[0].error_message, test.expected_error)
+        << test.description;
+    EXPECT_EQ(errors[0].token_info.left(tester.Analyzer().Data().Contents()),
+              test.offset)
+        << test.description;
+    // Nothing of the failed expansion is kept.
+    EXPECT_TRUE(tester.PreprocessorData().lexed_macros_backup.empty())
+        << test.description;
+  }
+}
+
+TEST(VerilogPreprocessTest, NestedExpansionsStoreEachTokenOnce) {
+  PreprocessorTester tester(
+      "`define INNER x + 1\n"
+      "`define MIDDLE(b) (`INNER * b)\n"
+      "`define OUTER `MIDDLE(2) - `MIDDLE(y)\n"
+      "module m; assign z = `OUTER; endmodule\n",
+      VerilogPreprocess::Config({.expand_macros = true}));
+  EXPECT_TRUE(tester.Status().ok()) << tester.Status();
+  const VerilogPreprocessData &data = tester.PreprocessorData();
+  std::string expanded;
+  for (const auto &token : data.preprocessed_token_stream) {
+    absl::StrAppend(&expanded, token->text(), " ");
+  }
+  EXPECT_EQ(expanded,
+            "module m ; assign z = ( x + 1 * 2 ) - ( x + 1 * y ) ; "
+            "endmodule ");
+  size_t stored = 0;
+  for (const auto &chunk : data.lexed_macros_backup) stored += chunk.size();
+  EXPECT_EQ(stored, 15);
+}
+
 // TODO(karimtera): This test doesn't use "PreprocessorTester",
 // as there isn't a way to tell "VerilogAnalyzer" about external preprocessing
 // info. Typically, all tests should use "PreprocessorTester".
@@ -1037,5 +1144,104 @@ TEST(VerilogPreprocessTest,
       << error.error_message;
 }
 
+// Returns the text of the non-whitespace tokens of 'stream'.
+static std::vector<absl::string_view> SyntaxTokenTexts(
+    const verible::TokenStreamView &stream) {
+  std::vector<absl::string_view> texts;
+  for (const auto &token : stream) {
+    if (VerilogLexer::KeepSyntaxTreeTokens(*token)) {
+      texts.push_back(token->text());
+    }
+  }
+  return texts;
+}
+
+// Returns a file opener for the contents of 'files', by name.
+static FileOpener MakeFileOpener(
+    const std::map<std::string, std::string> &files) {
+  return [&files](absl::string_view filename)
+             -> absl::StatusOr<absl::string_view> {
+    const auto found = files.find(std::string(filename));
+    if (found == files.end()) {
+      return absl::NotFoundError(absl::StrCat(filename, " is not found"));
+    }
+    return absl::string_view(found->second);
+  };
+}
+
+TEST(VerilogPreprocessTest, GuardedIncludeIsIncludedOnce) {
+  const std::map<std::string, std::string> files = {
+      {"guarded.svh",
+       "// header\n`ifndef GUARDED_SVH\n`define GUARDED_SVH\n"
+       "wire w;\n`endif  // GUARDED_SVH\n"},
+      {"unguarded.svh", "`ifndef X\n`define X\n`endif\nwire u;\n"},
+  };
+  const std::string src_content =
+      "`include \"guarded.svh\"\n`include \"guarded.svh\"\n"
+      "`include \"unguarded.svh\"\n`include \"unguarded.svh\"\n";
+  for (const bool filter_branches : {false, true}) {
+    VerilogPreprocess tester(
+        VerilogPreprocess::Config(
+            {.filter_branches = filter_branches, .include_files = true}),
+        MakeFileOpener(files));
+    LexerTester src_lexer(src_content);
+    const auto &pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+    EXPECT_TRUE(pp_data.errors.empty());
+    const std::vector<absl::string_view> texts =
+        SyntaxTokenTexts(pp_data.preprocessed_token_stream);
+    // Without filtering branches, guards are not evaluated.
+    EXPECT_EQ(std::count(texts.begin(), texts.end(), "w"),
+              filter_branches ? 1 : 2);
+    EXPECT_EQ(std::count(texts.begin(), texts.end(), "u"), 2);
+  }
+}
+
+TEST(VerilogPreprocessTest, IncludeFileCacheSharedAcrossTranslationUnits) {
+  const std::map<std::string, std::string> files = {
+      {"defs.svh", "`ifndef DEFS_SVH\n`define DEFS_SVH\nwire d;\n`endif\n"},
+      {"pkg.svh", "`include \"defs.svh\"\nwire p;\n"},
+  };
+  const VerilogPreprocess::Config config(
+      {.filter_branches = true, .include_files = true});
+  IncludeFileCache cache;
+  std::vector<std::string> translation_units = {
+      "`include \"pkg.svh\"\nmodule a; endmodule\n",
+      "`include \"pkg.svh\"\n`include \"defs.svh\"\nmodule b; endmodule\n",
+  };
+  std::vector<std::vector<absl::string_view>> results;
+  for (const std::string &content : translation_units) {
+    VerilogPreprocess tester(config, MakeFileOpener(files));
+    tester.SetIncludeFileCache(&cache);
+    LexerTester src_lexer(content);
+    const auto pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+    EXPECT_TRUE(pp_data.errors.empty());
+    results.push_back(SyntaxTokenTexts(pp_data.preprocessed_token_stream));
+  }
+  EXPECT_EQ(cache.size(), 2);
+  const auto &first = results[0];
+  EXPECT_EQ(std::count(first.begin(), first.end(), "d"), 1);
+  EXPECT_EQ(std::count(first.begin(), first.end(), "p"), 1);
+  // defs.svh is skipped, as pkg.svh included it before.
+  const auto &second = results[1];
+  EXPECT_EQ(std::count(second.begin(), second.end(), "d"), 1);
+  EXPECT_EQ(std::count(second.begin(), second.end(), "p"), 1);
+
+  {  // Other defines are different cache entries.
+    VerilogPreprocess tester(config, MakeFileOpener(files));
+    FileList::PreprocessingInfo preprocessing_info;
+    preprocessing_info.defines.emplace_back("DEFS_SVH", "");
+    tester.setPreprocessingInfo(preprocessing_info);
+    tester.SetIncludeFileCache(&cache);
+    LexerTester src_lexer(translation_units[0]);
+    const auto pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+    EXPECT_TRUE(pp_data.errors.empty());
+    const std::vector<absl::string_view> texts =
+        SyntaxTokenTexts(pp_data.preprocessed_token_stream);
+    EXPECT_EQ(std::count(texts.begin(), texts.end(), "d"), 0);
+    EXPECT_EQ(std::count(texts.begin(), texts.end(), "p"), 1);
+    EXPECT_EQ(cache.size(), 4);
+  }
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,175 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// verilog_check checks the syntax, lint and formatting of Verilog files,
+// lexing and parsing each file only once for all three checks.
+//
+// Example usage:
+// verilog_check --jobs=8 files...
+//
+// Exit code:
+//   0: no syntax errors, lint violations or files that need formatting
+//   1: some of those were found
+//   2: a file could not be read or analyzed
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>  // IWYU pragma: keep  // for ostringstream
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_status.h"
+#include "common/analysis/violation_handler.h"
+#include "common/strings/mem_block.h"
+#include "common/text/text_structure.h"
+#include "common/util/file_util.h"
+#include "common/util/init_command_line.h"
+#include "common/util/logging.h"
+#include "common/util/thread_pool.h"
+#include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/formatting/format_style.h"
+#include "verilog/formatting/format_style_init.h"
+#include "verilog/formatting/formatter.h"
+#include "verilog/preprocessor/verilog_preprocess.h"
+
+ABSL_FLAG(bool, lint, true,
+          "If true, check files for lint violations, configured like "
+          "verible-verilog-lint.");
+ABSL_FLAG(bool, check_format, true,
+          "If true, report files that verible-verilog-format would change, "
+          "with the format style flags.");
+ABSL_FLAG(bool, show_diagnostic_context, false,
+          "prints an additional line on which the diagnostic was found, "
+          "followed by a line with a position marker");
+ABSL_FLAG(int, jobs, 1,
+          "Number of files checked in parallel. Output is still reported in "
+          "the order of the input files.");
+
+using verilog::VerilogAnalyzer;
+using verilog::formatter::FormatStyle;
+
+// Checks one file, writing all findings to "stream".
+// Returns the exit status for the file.
+static int CheckOneFile(absl::string_view filename, const FormatStyle &style,
+                        std::ostream *stream) {
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> content_or =
+      verible::file::GetContentAsMemBlock(filename);
+  if (!content_or.ok()) {
+    *stream << content_or.status().message() << std::endl;
+    return 2;
+  }
+  const std::shared_ptr<verible::MemBlock> content = *std::move(content_or);
+
+  // The same analysis as verible-verilog-syntax and verible-verilog-format
+  // do, shared by all checks.
+  const std::unique_ptr<VerilogAnalyzer> analyzer =
+      VerilogAnalyzer::AnalyzeAutomaticMode(
+          content, filename, verilog::VerilogPreprocess::Config());
+  if (!ABSL_DIE_IF_NULL(analyzer)->LexStatus().ok() ||
+      !analyzer->ParseStatus().ok()) {
+    for (const auto &message : analyzer->LinterTokenErrorMessages(
+             absl::GetFlag(FLAGS_show_diagnostic_context))) {
+      *stream << message << std::endl;
+    }
+    // Neither linting a salvaged syntax tree nor formatting is meaningful.
+    return 1;
+  }
+  const verible::TextStructureView &text_structure = analyzer->Data();
+
+  int exit_status = 0;
+  if (absl::GetFlag(FLAGS_lint)) {
+    const auto config = verilog::LinterConfigurationFromFlags(filename);
+    if (!config.ok()) {
+      *stream << config.status().message() << std::endl;
+      return 2;
+    }
+    const auto statuses =
+        verilog::VerilogLintTextStructure(filename, *config, text_structure);
+    if (!statuses.ok()) {
+      *stream << filename << ": " << statuses.status().message() << std::endl;
+      return 2;
+    }
+    const std::vector<verible::LintViolationWithStatus> violations =
+        verilog::GetSortedViolations(*statuses);
+    if (!violations.empty()) {
+      verible::ViolationPrinter printer(stream);
+      printer.HandleViolations(violations, text_structure.Contents(), filename,
+                               text_structure.GetLineColumnMap());
+      exit_status = 1;
+    }
+  }
+
+  if (absl::GetFlag(FLAGS_check_format)) {
+    std::string formatted_text;
+    const absl::Status format_status = verilog::formatter::FormatVerilog(
+        text_structure, filename, style, &formatted_text);
+    if (!format_status.ok()) {
+      // Like verible-verilog-format, which leaves such files unchanged.
+      *stream << filename << ": " << format_status.message() << std::endl;
+    } else if (formatted_text != text_structure.Contents()) {
+      *stream << filename << ": Needs formatting." << std::endl;
+      exit_status = 1;
+    }
+  }
+  return exit_status;
+}
+
+// Outcome of checking one file on a worker thread, to be reported in order.
+struct FileResult {
+  int exit_status = 0;
+  std::string output;
+};
+
+int main(int argc, char **argv) {
+  const auto usage =
+      absl::StrCat("usage: ", argv[0], " [options] <file> [<file>...]");
+  const auto args = verible::InitCommandLine(usage, &argc, &argv);
+
+  FormatStyle style;
+  verilog::formatter::InitializeFromFlags(&style);
+
+  // All positional arguments are file names.  Exclude program name.
+  const std::vector<absl::string_view> files(args.begin() + 1, args.end());
+
+  int exit_status = 0;
+  verible::ThreadPool pool(std::max(absl::GetFlag(FLAGS_jobs), 1));
+  std::vector<std::future<FileResult>> results;
+  results.reserve(files.size());
+  for (const absl::string_view filename : files) {
+    results.push_back(pool.ExecAsync<FileResult>([filename, &style]() {
+      std::ostringstream output;
+      FileResult result;
+      result.exit_status = CheckOneFile(filename, style, &output);
+      result.output = output.str();
+      return result;
+    }));
+  }
+  for (auto &future_result : results) {
+    const FileResult result = future_result.get();
+    std::cerr << result.output << std::flush;
+    exit_status = std::max(exit_status, result.exit_status);
+  }
+  return exit_status;
+}
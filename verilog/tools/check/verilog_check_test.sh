@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+# Copyright 2017-2020 The Verible Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Tests verible-verilog-check reporting syntax, lint and formatting findings.
+
+declare -r MY_CLEAN_FILE="${TEST_TMPDIR}/clean.sv"
+declare -r MY_UNFORMATTED_FILE="${TEST_TMPDIR}/unformatted.sv"
+declare -r MY_LINT_FILE="${TEST_TMPDIR}/lint.sv"
+declare -r MY_SYNTAX_FILE="${TEST_TMPDIR}/syntax.sv"
+declare -r MY_OUTPUT_FILE="${TEST_TMPDIR}/myoutput.txt"
+
+# Get tool from argument
+[[ "$#" == 1 ]] || {
+  echo "Expecting 1 positional argument, verible-verilog-check path."
+  exit 1
+}
+checker="$(rlocation ${TEST_WORKSPACE}/${1})"
+
+# Module names match the file names, as the module-filename rule checks.
+cat >${MY_CLEAN_FILE} <<EOF
+module clean;
+endmodule
+EOF
+
+cat >${MY_UNFORMATTED_FILE} <<EOF
+  module    unformatted   ;endmodule
+EOF
+
+# Trailing spaces are a lint violation, and are also removed by formatting.
+printf 'module lint;  \nendmodule\n' >${MY_LINT_FILE}
+
+cat >${MY_SYNTAX_FILE} <<EOF
+module 1syntax;
+endmodule
+EOF
+
+${checker} ${MY_CLEAN_FILE} 2> ${MY_OUTPUT_FILE} || exit 1
+[[ ! -s ${MY_OUTPUT_FILE} ]] || exit 2
+
+${checker} ${MY_UNFORMATTED_FILE} 2> ${MY_OUTPUT_FILE} && exit 3
+grep -q "unformatted.sv: Needs formatting." ${MY_OUTPUT_FILE} || exit 4
+
+${checker} --check_format=false ${MY_UNFORMATTED_FILE} 2> /dev/null || exit 5
+
+${checker} ${MY_LINT_FILE} 2> ${MY_OUTPUT_FILE} && exit 6
+grep -q "no-trailing-spaces" ${MY_OUTPUT_FILE} || exit 7
+grep -q "lint.sv: Needs formatting." ${MY_OUTPUT_FILE} || exit 8
+
+${checker} --lint=false --check_format=false ${MY_LINT_FILE} || exit 9
+
+${checker} ${MY_SYNTAX_FILE} 2> ${MY_OUTPUT_FILE} && exit 10
+grep -q "syntax error" ${MY_OUTPUT_FILE} || exit 11
+
+# Findings of several files are reported in the order of the files.
+${checker} --jobs=3 ${MY_SYNTAX_FILE} ${MY_CLEAN_FILE} ${MY_UNFORMATTED_FILE} \
+  2> ${MY_OUTPUT_FILE} && exit 12
+grep -q "clean.sv" ${MY_OUTPUT_FILE} && exit 13
+head -1 ${MY_OUTPUT_FILE} | grep -q "syntax.sv" || exit 14
+tail -1 ${MY_OUTPUT_FILE} | grep -q "unformatted.sv" || exit 15
+
+echo "PASS"
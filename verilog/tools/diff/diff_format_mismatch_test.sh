@@ -45,4 +45,13 @@ EOF
 "${difftool}" --mode=format "${MY_INPUT_FILE2}" "${MY_INPUT_FILE1}"
 [[ $? -eq 1 ]] || exit 2
 
+# streaming, stopping at the first difference
+"${difftool}" --mode=format --streaming "${MY_INPUT_FILE1}" "${MY_INPUT_FILE2}"
+[[ $? -eq 1 ]] || exit 3
+
+# streaming, reporting all differences
+"${difftool}" --mode=format --streaming --report_all_differences \
+  "${MY_INPUT_FILE1}" "${MY_INPUT_FILE2}"
+[[ $? -eq 1 ]] || exit 4
+
 echo "PASS"
@@ -30,6 +30,7 @@
 #include "absl/flags/flag.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
 #include "common/util/enum_flags.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
@@ -74,6 +75,19 @@ ABSL_FLAG(DiffMode, mode, DiffMode::kFormat,
     This is useful for verifying verilog_obfuscate output.
 )");
 
+ABSL_FLAG(bool, streaming, false,
+          "If true, lex both inputs in lockstep, and report differences as "
+          "soon as they are found, instead of lexing each input entirely "
+          "before comparing.  Memory use is bounded by --difference_window.");
+
+ABSL_FLAG(bool, report_all_differences, false,
+          "With --streaming: if true, report all differences as hunks of "
+          "added and removed tokens, instead of stopping at the first one.");
+
+ABSL_FLAG(int, difference_window, 1000,
+          "With --streaming --report_all_differences: number of tokens of "
+          "each input that are diffed at once to find the next hunks.");
+
 using EquivalenceFunctionType = std::function<verilog::DiffStatus(
     absl::string_view, absl::string_view, std::ostream *)>;
 
@@ -82,6 +96,16 @@ static const std::map<DiffMode, EquivalenceFunctionType> diff_func_map({
     {DiffMode::kObfuscate, verilog::ObfuscationEquivalent},
 });
 
+using StreamingEquivalenceFunctionType = std::function<verilog::DiffStatus(
+    absl::string_view, absl::string_view,
+    const verilog::StreamingDiffOptions &, std::ostream *)>;
+
+static const std::map<DiffMode, StreamingEquivalenceFunctionType>
+    streaming_diff_func_map({
+        {DiffMode::kFormat, verilog::StreamingFormatEquivalent},
+        {DiffMode::kObfuscate, verilog::StreamingObfuscationEquivalent},
+    });
+
 int main(int argc, char **argv) {
   const auto usage = absl::StrCat("usage: ", argv[0],
                                   " [options] file1 file2\n"
@@ -103,26 +127,45 @@ int main(int argc, char **argv) {
   }
 
   // Open both files.
-  const auto content1_or = verible::file::GetContentAsString(args[1]);
+  const auto content1_or = verible::file::GetContentAsMemBlock(args[1]);
   if (!content1_or.ok()) {
     std::cerr << args[1] << ": " << content1_or.status() << std::endl;
     return kUserErrorCode;
   }
-  const auto content2_or = verible::file::GetContentAsString(args[2]);
+  const auto content2_or = verible::file::GetContentAsMemBlock(args[2]);
   if (!content2_or.ok()) {
-    std::cerr << args[1] << ": " << content1_or.status() << std::endl;
+    std::cerr << args[2] << ": " << content2_or.status() << std::endl;
     return kUserErrorCode;
   }
 
   // Selection diff-ing function.
   const auto diff_mode = absl::GetFlag(FLAGS_mode);
-  const auto iter = diff_func_map.find(diff_mode);
-  CHECK(iter != diff_func_map.end());
-  const auto diff_func = iter->second;
 
   // Compare.
+  // In streaming mode, differences are printed directly as they are found,
+  // ahead of the summary line.
   std::ostringstream errstream;
-  const auto diff_status = diff_func(*content1_or, *content2_or, &errstream);
+  verilog::DiffStatus diff_status;
+  if (absl::GetFlag(FLAGS_streaming)) {
+    const auto iter = streaming_diff_func_map.find(diff_mode);
+    CHECK(iter != streaming_diff_func_map.end());
+    verilog::StreamingDiffOptions options;
+    options.stop_at_first_difference =
+        !absl::GetFlag(FLAGS_report_all_differences);
+    options.window_size = absl::GetFlag(FLAGS_difference_window);
+    if (options.window_size < 1) {
+      std::cerr << "--difference_window must be positive." << std::endl;
+      return kUserErrorCode;
+    }
+    diff_status = iter->second((*content1_or)->AsStringView(),
+                               (*content2_or)->AsStringView(), options,
+                               &std::cout);
+  } else {
+    const auto iter = diff_func_map.find(diff_mode);
+    CHECK(iter != diff_func_map.end());
+    diff_status = iter->second((*content1_or)->AsStringView(),
+                               (*content2_or)->AsStringView(), &errstream);
+  }
 
   // Signal result of comparison.
   switch (diff_status) {
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+# Copyright 2017-2020 The Verible Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Tests --files_from together with --jobs and --inplace.
+
+declare -r MY_FILE_LIST="${TEST_TMPDIR}/filelist.txt"
+declare -r MY_EXPECT_FILE="${TEST_TMPDIR}/myexpect.txt"
+declare -r MY_FORMATTED_FILE="${TEST_TMPDIR}/formatted.sv"
+
+# Get tool from argument
+[[ "$#" == 1 ]] || {
+  echo "Expecting 1 positional argument, verible-verilog-format path."
+  exit 1
+}
+formatter="$(rlocation ${TEST_WORKSPACE}/$1)"
+
+cat >${MY_EXPECT_FILE} <<EOF
+module m;
+endmodule
+EOF
+
+# Several files to overwrite in-place, listed in a file.
+: >${MY_FILE_LIST}
+for i in 1 2 3 4 5 ; do
+  cat >"${TEST_TMPDIR}/input${i}.sv" <<EOF
+  module    m   ;endmodule
+EOF
+  echo "${TEST_TMPDIR}/input${i}.sv" >>${MY_FILE_LIST}
+  echo >>${MY_FILE_LIST}   # Empty lines are ignored.
+done
+
+# An already formatted file is not rewritten.
+cp ${MY_EXPECT_FILE} ${MY_FORMATTED_FILE}
+touch -d "2000-01-01 00:00" ${MY_FORMATTED_FILE}
+
+# Run formatter.
+${formatter} --inplace --jobs=3 --files_from=${MY_FILE_LIST} \
+  ${MY_FORMATTED_FILE} || exit 1
+
+for i in 1 2 3 4 5 ; do
+  diff --strip-trailing-cr "${TEST_TMPDIR}/input${i}.sv" "${MY_EXPECT_FILE}" \
+    || exit 2
+done
+
+[[ "$(find ${MY_FORMATTED_FILE} -newer ${MY_EXPECT_FILE})" == "" ]] || {
+  echo "Expected ${MY_FORMATTED_FILE} to be left untouched."
+  exit 3
+}
+
+# No temporary files are left behind.
+[[ "$(find ${TEST_TMPDIR} -name '*.tmp')" == "" ]] || exit 4
+
+echo "PASS"
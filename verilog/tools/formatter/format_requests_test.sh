@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# Copyright 2017-2020 The Verible Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Tests --requests_from, formatting several requests read from stdin.
+
+declare -r MY_LINES_FILE="${TEST_TMPDIR}/lines.sv"
+declare -r MY_WHOLE_FILE="${TEST_TMPDIR}/whole.sv"
+declare -r MY_OUTPUT_FILE="${TEST_TMPDIR}/myoutput.txt"
+declare -r MY_EXPECT_FILE="${TEST_TMPDIR}/myexpect.txt"
+
+# Get tool from argument
+[[ "$#" == 1 ]] || {
+  echo "Expecting 1 positional argument, verible-verilog-format path."
+  exit 1
+}
+formatter="$(rlocation ${TEST_WORKSPACE}/${1})"
+
+cat >${MY_LINES_FILE} <<EOF
+   parameter   int  var_line_1  =  1  ;
+   parameter   int  var_line_2  =  2  ;
+   parameter   int  var_line_3  =  3  ;
+   parameter   int  var_line_4  =  4  ;
+EOF
+
+cat >${MY_WHOLE_FILE} <<EOF
+  module    m   ;endmodule
+EOF
+
+# Responses are in request order, each after a line with its exit code and
+# size in bytes.  The last file does not exist.
+cat >${MY_EXPECT_FILE} <<EOF
+0 140
+   parameter   int  var_line_1  =  1  ;
+parameter int var_line_2 = 2;
+parameter int var_line_3 = 3;
+   parameter   int  var_line_4  =  4  ;
+0 20
+module m;
+endmodule
+0 140
+parameter int var_line_1 = 1;
+   parameter   int  var_line_2  =  2  ;
+   parameter   int  var_line_3  =  3  ;
+parameter int var_line_4 = 4;
+1 0
+EOF
+
+# Run formatter.
+${formatter} --requests_from=- --jobs=2 > ${MY_OUTPUT_FILE} <<EOF
+${MY_LINES_FILE} 2-3
+${MY_WHOLE_FILE}
+
+${MY_LINES_FILE} 1,4
+${TEST_TMPDIR}/missing.sv
+EOF
+status="$?"
+[[ "${status}" == 1 ]] || {
+  echo "Expected exit code 1, but got ${status}."
+  exit 1
+}
+diff --strip-trailing-cr "${MY_OUTPUT_FILE}" "${MY_EXPECT_FILE}" || exit 2
+
+# Files are named by the requests, not by positional arguments.
+${formatter} --requests_from=- ${MY_WHOLE_FILE} < /dev/null && exit 3
+
+echo "PASS"
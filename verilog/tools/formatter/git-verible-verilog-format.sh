@@ -110,11 +110,11 @@ args=("${args[@]}" "$@")
 function verbose_command() {
   if [[ "$dry_run" = 1 ]] || [[ "$verbose" = 1 ]]
   then
-    msg "[command]: $@"
+    msg "[command]: $@" >&2
   fi
 
   [[ "$dry_run" = 1 ]] || "$@" || \
-    msg "Note: '$@' failed with status: $?"
+    msg "Note: '$@' failed with status: $?" >&2
 }
 
 # Switch to git root directory, so relative paths will be correct.
@@ -128,7 +128,7 @@ msg "Temporary files in: $tempdir"
 git add -u
 # Examine current differences for changed lines.
 # Strip the 'b/' from git diffs.
-# Format only changed lines for each file, one file at a time.
+# Format only changed lines for each file, all files in one formatter run.
 git diff -u --cached | \
   tee "$tempdir"/git-cached.diff | \
   "$patch_tool" changed-lines - | \
@@ -143,15 +143,17 @@ git diff -u --cached | \
     esac
 
     # If $lines is blank, that implies a new file (format entire file).
-    # Otherwise it is the argument to --lines.
-    lines_flag=()
-    [[ -z "$lines" ]] || lines_flag=("--lines=$lines")
-
-    # Format one file at a time.
-    format_command=("$formatter" --inplace "$filename" "${lines_flag[@]}" "${args[@]}")
-    verbose_command "${format_command[@]}"
-    # Ignore exit statuses and keep going.
-  done
+    # Otherwise these are the lines to format, as with --lines.
+    echo "$filename $lines"
+  done > "$tempdir"/format-requests.txt
+
+if [[ -s "$tempdir"/format-requests.txt ]]
+then
+  format_command=("$formatter" --inplace \
+    --requests_from="$tempdir"/format-requests.txt "${args[@]}")
+  # With --inplace, the responses only report each file's exit status.
+  verbose_command "${format_command[@]}" > "$tempdir"/format-responses.txt
+fi
 
 if [[ "$dry_run" = 0 ]]
 then
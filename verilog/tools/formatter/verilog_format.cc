@@ -22,24 +22,38 @@
 //   0: stdout output can be used to replace original file
 //   nonzero: stdout output (if any) should be discarded
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>  // IWYU pragma: keep  // for ostringstream
 #include <string>   // for string, allocator, etc
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/usage.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/position.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/interval_set.h"
-#include "common/util/iterator_range.h"
+#include "common/util/thread_pool.h"
 #include "verilog/formatting/format_style.h"
 #include "verilog/formatting/format_style_init.h"
 #include "verilog/formatting/formatter.h"
@@ -47,8 +61,11 @@
 using absl::StatusCode;
 using verible::LineNumberSet;
 using verilog::formatter::ExecutionControl;
+using verilog::formatter::FormatStatistics;
 using verilog::formatter::FormatStyle;
+using verilog::formatter::FormatterBuffers;
 using verilog::formatter::FormatVerilog;
+using verilog::formatter::VerificationLevel;
 
 // Pseudo-singleton, so that repeated flag occurrences accumulate values.
 //   --flag x --flag y yields [x, y]
@@ -92,6 +109,21 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, stdin_name, "<stdin>",
           "When using '-' to read from stdin, this gives an alternate name for "
           "diagnostic purposes.  Otherwise this is ignored.");
+ABSL_FLAG(std::string, files_from, "",
+          "Name of a file that lists the files to format, one per line, in "
+          "addition to the positional arguments.  Empty lines are ignored.");
+ABSL_FLAG(int, jobs, 1,
+          "Number of files formatted concurrently.  Messages and output of "
+          "each file are still printed in the order the files are given.");
+ABSL_FLAG(std::string, requests_from, "",
+          "Name of a file (or '-' for stdin) to read format requests from "
+          "until EOF, instead of taking files as arguments.  Each line is a "
+          "file name, optionally followed by line ranges in the syntax of "
+          "--lines, like 'verible-patch-tool changed-lines' prints.  Requests "
+          "are formatted with --jobs as they arrive, and each response is a "
+          "line '<status> <size>' followed by <size> bytes of output, in "
+          "request order.  <status> is the exit code of formatting only that "
+          "file.");
 ABSL_FLAG(LineRanges, lines, {},
           "Specific lines to format, 1-based, comma-separated, inclusive N-M "
           "ranges, N is short for N-N.  By default, left unspecified, "
@@ -105,12 +137,19 @@ ABSL_FLAG(bool, verify_convergence, true,
           "If true, and not incrementally formatting with --lines, "
           "verify that re-formatting the formatted output yields "
           "no further changes, i.e. formatting is convergent.");
+ABSL_FLAG(VerificationLevel, verification, VerificationLevel::kFull,
+          "How the formatted output is checked before it is emitted: "
+          "{full,lexical}. 'full' re-parses the output and compares tokens, "
+          "'lexical' only compares tokens and skips --verify_convergence.");
 
 ABSL_FLAG(bool, verbose, false, "Be more verbose.");
 
 ABSL_FLAG(int, show_largest_token_partitions, 0,
           "If > 0, print token partitioning and then "
           "exit without formatting output.");
+ABSL_FLAG(int, show_largest_alignment_groups, 0,
+          "If > 0, print the largest alignment groups (by rows) while "
+          "formatting.");
 ABSL_FLAG(bool, show_token_partition_tree, false,
           "If true, print diagnostics after token partitioning and then "
           "exit without formatting output.");
@@ -123,15 +162,36 @@ ABSL_FLAG(bool, show_equally_optimal_wrappings, false,
 ABSL_FLAG(int, max_search_states, 100000,
           "Limits the number of search states explored during "
           "line wrap optimization.");
-
-static std::ostream& FileMsg(absl::string_view filename) {
-  std::cerr << filename << ": ";
-  return std::cerr;
+ABSL_FLAG(int, max_layout_knots, 1000000,
+          "Limits the total number of knots of the layout functions computed "
+          "by layout optimization of one partition. Beyond it, the rest of "
+          "the partition is laid out greedily. Values <= 0 do not limit.");
+ABSL_FLAG(int, layout_time_limit_ms, 0,
+          "If positive, limits the time of layout optimization of one "
+          "partition, in milliseconds, beyond which the rest of the partition "
+          "is laid out greedily. The output then depends on the machine.");
+ABSL_FLAG(int, line_wrap_beam_width, 0,
+          "If positive, line wrap optimization only explores this many of "
+          "the cheapest states before each token, which bounds its time but "
+          "can give suboptimal results.");
+ABSL_FLAG(int, line_wrap_search_threads, 0,
+          "Number of threads used to search line wraps of independent "
+          "partitions concurrently. Values <= 1 search serially. "
+          "The output does not depend on this setting.");
+
+static std::ostream& FileMsg(std::ostream& messages,
+                             absl::string_view filename) {
+  messages << filename << ": ";
+  return messages;
 }
 
+// Formats one file, writing formatted text (unless --inplace) to "output" and
+// diagnostics to "messages".
 // TODO: Refactor and simplify
 static bool formatOneFile(absl::string_view filename,
                           const LineNumberSet& lines_to_format,
+                          const FormatStyle& format_style,
+                          std::ostream& output, std::ostream& messages,
                           bool* any_changes) {
   const bool inplace = absl::GetFlag(FLAGS_inplace);
   const bool check_changes_only = absl::GetFlag(FLAGS_verify);
@@ -140,35 +200,35 @@ static bool formatOneFile(absl::string_view filename,
   *any_changes = false;
 
   if (inplace && is_stdin) {
-    FileMsg(filename)
+    FileMsg(messages, filename)
         << "--inplace is incompatible with stdin.  Ignoring --inplace "
         << "and writing to stdout." << std::endl;
   }
 
   const auto diagnostic_filename = is_stdin ? stdin_name : filename;
 
-  // Read contents into memory first.
-  const absl::StatusOr<std::string> content_or =
-      verible::file::GetContentAsString(filename);
+  // Map contents into memory first.
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> content_or =
+      verible::file::GetContentAsMemBlock(filename);
   if (!content_or.ok()) {
     // Not using FileMsg(): file status already has filename attached.
-    std::cerr << content_or.status().message() << std::endl;
+    messages << content_or.status().message() << std::endl;
     return false;
   }
+  std::shared_ptr<verible::MemBlock> content = std::move(*content_or);
 
   // TODO(fangism): When requesting --inplace, verify that file
   // is write-able, and fail-early if it is not.
 
-  FormatStyle format_style;
-  verilog::formatter::InitializeFromFlags(&format_style);
-
   // Handle special debugging modes.
   ExecutionControl formatter_control;
   {
     // execution control flags
-    formatter_control.stream = &std::cout;  // for diagnostics only
+    formatter_control.stream = &output;  // for diagnostics only
     formatter_control.show_largest_token_partitions =
         absl::GetFlag(FLAGS_show_largest_token_partitions);
+    formatter_control.show_largest_alignment_groups =
+        absl::GetFlag(FLAGS_show_largest_alignment_groups);
     formatter_control.show_token_partition_tree =
         absl::GetFlag(FLAGS_show_token_partition_tree);
     formatter_control.show_inter_token_info =
@@ -177,34 +237,69 @@ static bool formatOneFile(absl::string_view filename,
         absl::GetFlag(FLAGS_show_equally_optimal_wrappings);
     formatter_control.max_search_states =
         absl::GetFlag(FLAGS_max_search_states);
+    formatter_control.layout_optimizer_budget.max_knots =
+        absl::GetFlag(FLAGS_max_layout_knots);
+    if (const int ms = absl::GetFlag(FLAGS_layout_time_limit_ms); ms > 0) {
+      formatter_control.layout_optimizer_budget.time_limit =
+          absl::Milliseconds(ms);
+    }
+    formatter_control.line_wrap_beam_width =
+        absl::GetFlag(FLAGS_line_wrap_beam_width);
+    formatter_control.line_wrap_search_threads =
+        absl::GetFlag(FLAGS_line_wrap_search_threads);
     formatter_control.verify_convergence =
         absl::GetFlag(FLAGS_verify_convergence);
+    formatter_control.verification = absl::GetFlag(FLAGS_verification);
   }
+  // Files formatted one after the other on the same thread reuse the storage
+  // of the formatter's arrays.
+  static thread_local FormatterBuffers formatter_buffers;
+  formatter_control.buffers = &formatter_buffers;
+  FormatStatistics statistics;
+  if (absl::GetFlag(FLAGS_verbose)) formatter_control.statistics = &statistics;
 
   std::ostringstream stream;
   const auto format_status =
-      FormatVerilog(*content_or, diagnostic_filename, format_style, stream,
+      FormatVerilog(content, diagnostic_filename, format_style, stream,
                     lines_to_format, formatter_control);
+  if (absl::GetFlag(FLAGS_verbose) && statistics.layout_cache_lookups > 0) {
+    FileMsg(messages, filename)
+        << "Reused layouts of " << statistics.layout_cache_hits << " of "
+        << statistics.layout_cache_lookups << " partitions ("
+        << (100 * statistics.layout_cache_hits /
+            statistics.layout_cache_lookups)
+        << "%)." << std::endl;
+  }
+  if (!statistics.over_budget_partitions.empty()) {
+    FileMsg(messages, filename)
+        << "*** Some token partitions exceeded the layout optimizer budget, "
+           "and were partly laid out greedily:"
+        << std::endl;
+    for (const std::string& partition : statistics.over_budget_partitions) {
+      messages << partition << std::endl;
+    }
+    messages << "*** end of greedily laid out partition list" << std::endl;
+  }
 
   const std::string& formatted_output(stream.str());
   if (!format_status.ok()) {
     if (!inplace) {
       // Fall back to printing original content regardless of error condition.
-      std::cout << *content_or;
+      output << content->AsStringView();
     }
     switch (format_status.code()) {
       case StatusCode::kCancelled:
       case StatusCode::kInvalidArgument:
-        FileMsg(filename) << format_status.message() << std::endl;
+        FileMsg(messages, filename) << format_status.message() << std::endl;
         break;
       case StatusCode::kDataLoss:
-        FileMsg(filename) << format_status.message()
-                          << "; problematic formatter output is\n"
-                          << formatted_output << "<<EOF>>" << std::endl;
+        FileMsg(messages, filename)
+            << format_status.message() << "; problematic formatter output is\n"
+            << formatted_output << "<<EOF>>" << std::endl;
         break;
       default:
-        FileMsg(filename) << format_status.message() << "[other error status]"
-                          << std::endl;
+        FileMsg(messages, filename)
+            << format_status.message() << "[other error status]" << std::endl;
         break;
     }
 
@@ -212,14 +307,17 @@ static bool formatOneFile(absl::string_view filename,
   }
 
   // Check if the output is the same as the input.
-  *any_changes = (*content_or != formatted_output);
+  *any_changes = (content->AsStringView() != formatted_output);
+  // The content might be mapped from the file that is about to be rewritten.
+  content.reset();
 
   // Don't output or write if --check is set.
   if (check_changes_only) {
     if (*any_changes) {
-      FileMsg(filename) << "Needs formatting." << std::endl;
+      FileMsg(messages, filename) << "Needs formatting." << std::endl;
     } else if (absl::GetFlag(FLAGS_verbose)) {
-      FileMsg(filename) << "Already formatted, no change." << std::endl;
+      FileMsg(messages, filename)
+          << "Already formatted, no change." << std::endl;
     }
   } else {
     // Safe to write out result, having passed above verification.
@@ -227,35 +325,194 @@ static bool formatOneFile(absl::string_view filename,
       // Don't write if the output is exactly as the input, so that we don't
       // mess with tools that look for timestamp changes (such as make).
       if (*any_changes) {
-        if (auto status =
-                verible::file::SetContents(filename, formatted_output);
+        if (auto status = verible::file::SetContentsAtomically(
+                filename, formatted_output);
             !status.ok()) {
-          FileMsg(filename) << "error writing result " << status << std::endl;
+          FileMsg(messages, filename)
+              << "error writing result " << status << std::endl;
           return false;
         }
       } else if (absl::GetFlag(FLAGS_verbose)) {
-        FileMsg(filename) << "Already formatted, no change." << std::endl;
+        FileMsg(messages, filename)
+            << "Already formatted, no change." << std::endl;
       }
     } else {
-      std::cout << formatted_output;
+      output << formatted_output;
     }
   }
 
   return true;
 }
 
+// Outcome of formatting one file on a worker thread, to be reported in order.
+struct FileResult {
+  bool success = false;
+  bool any_changes = false;
+  std::string output;
+  std::string messages;
+};
+
+// Appends the files listed in "list_file", one per line, to "filenames".
+static absl::Status ReadFileList(absl::string_view list_file,
+                                 std::vector<std::string>* filenames) {
+  absl::StatusOr<std::string> content_or =
+      verible::file::GetContentAsString(list_file);
+  if (!content_or.ok()) return content_or.status();
+  for (absl::string_view line : absl::StrSplit(*content_or, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!line.empty()) filenames->emplace_back(line);
+  }
+  return absl::OkStatus();
+}
+
+// Parses a format request: a file name, optionally followed by line ranges.
+static bool ParseFormatRequest(absl::string_view request,
+                               std::string* filename, LineNumberSet* lines,
+                               std::ostream& messages) {
+  const std::vector<absl::string_view> fields =
+      absl::StrSplit(request, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+  if (fields.empty()) return false;
+  *filename = std::string(fields.front());
+  if (*filename == "-") {
+    messages << "Format requests cannot read from stdin." << std::endl;
+    return false;
+  }
+  std::vector<absl::string_view> ranges;
+  for (auto field = fields.begin() + 1; field != fields.end(); ++field) {
+    for (absl::string_view range : absl::StrSplit(*field, ',')) {
+      ranges.push_back(range);
+    }
+  }
+  return verible::ParseInclusiveRanges(lines, ranges.begin(), ranges.end(),
+                                       &messages, '-');
+}
+
+// Formats the requests read from "requests", one per line, as they arrive.
+// Each response is written as soon as it and all earlier ones are done, so
+// that a client can keep this running and wait for one response at a time.
+// Returns the exit code for all requests together.
+static int ServeFormatRequests(std::istream& requests,
+                               const FormatStyle& format_style, int jobs) {
+  const bool check_changes_only = absl::GetFlag(FLAGS_verify);
+  const auto exit_code = [check_changes_only](const FileResult& result) {
+    if (check_changes_only) return result.any_changes ? 1 : 0;
+    return result.success ? 0 : 1;
+  };
+
+  verible::ThreadPool pool(std::max(jobs, 1));
+  std::mutex pending_mutex;
+  std::condition_variable pending_changed;
+  std::deque<std::future<FileResult>> pending;  // guarded by pending_mutex
+  bool end_of_requests = false;                 // guarded by pending_mutex
+
+  bool all_success = true;
+  bool any_changes = false;
+  std::thread responder([&]() {
+    while (true) {
+      std::future<FileResult> future_result;
+      {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        pending_changed.wait(
+            lock, [&]() { return end_of_requests || !pending.empty(); });
+        if (pending.empty()) return;
+        future_result = std::move(pending.front());
+        pending.pop_front();
+      }
+      const FileResult result = future_result.get();
+      std::cerr << result.messages << std::flush;
+      std::cout << exit_code(result) << ' ' << result.output.size() << '\n'
+                << result.output << std::flush;
+      all_success &= result.success;
+      any_changes |= result.any_changes;
+    }
+  });
+
+  std::string line;
+  while (std::getline(requests, line)) {
+    const absl::string_view request = absl::StripAsciiWhitespace(line);
+    if (request.empty()) continue;
+    const std::function<FileResult()> format_request =
+        [request = std::string(request), &format_style]() {
+          std::ostringstream output;
+          std::ostringstream messages;
+          FileResult result;
+          std::string filename;
+          LineNumberSet lines_to_format;
+          if (ParseFormatRequest(request, &filename, &lines_to_format,
+                                 messages)) {
+            result.success =
+                formatOneFile(filename, lines_to_format, format_style, output,
+                              messages, &result.any_changes);
+          } else {
+            messages << "Invalid format request: " << request << std::endl;
+          }
+          result.output = output.str();
+          result.messages = messages.str();
+          return result;
+        };
+    {
+      const std::lock_guard<std::mutex> lock(pending_mutex);
+      pending.push_back(pool.ExecAsync(format_request));
+    }
+    pending_changed.notify_one();
+  }
+  {
+    const std::lock_guard<std::mutex> lock(pending_mutex);
+    end_of_requests = true;
+  }
+  pending_changed.notify_one();
+  responder.join();
+
+  if (check_changes_only) return any_changes;
+  return all_success ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
   const auto usage = absl::StrCat("usage: ", argv[0],
                                   " [options] <file> [<file...>]\n"
                                   "To pipe from stdin, use '-' as <file>.");
   const auto file_args = verible::InitCommandLine(usage, &argc, &argv);
 
-  if (file_args.size() == 1) {
+  // The style is the same for all files.
+  FormatStyle format_style;
+  verilog::formatter::InitializeFromFlags(&format_style);
+
+  // All positional arguments are file names.  Exclude program name.
+  std::vector<std::string> filenames(file_args.begin() + 1, file_args.end());
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  const std::string requests_from = absl::GetFlag(FLAGS_requests_from);
+  if (!requests_from.empty()) {
+    if (!filenames.empty() || !absl::GetFlag(FLAGS_files_from).empty() ||
+        !LineRanges::values.empty()) {
+      std::cerr << "--requests_from does not take files or --lines; each "
+                   "request names them."
+                << std::endl;
+      return 1;
+    }
+    if (requests_from == "-") {
+      return ServeFormatRequests(std::cin, format_style, jobs);
+    }
+    std::ifstream requests(requests_from);
+    if (!requests) {
+      std::cerr << requests_from << ": cannot open format requests."
+                << std::endl;
+      return 1;
+    }
+    return ServeFormatRequests(requests, format_style, jobs);
+  }
+  const std::string files_from = absl::GetFlag(FLAGS_files_from);
+  if (!files_from.empty()) {
+    if (auto status = ReadFileList(files_from, &filenames); !status.ok()) {
+      std::cerr << status.message() << std::endl;
+      return 1;
+    }
+  }
+
+  if (filenames.empty()) {
     std::cerr << absl::ProgramUsageMessage() << std::endl;
     // TODO(hzeller): how can we append the output of --help here ?
     return 1;
   }
-
   // Parse LineRanges into a line set, to validate the --lines flag(s)
   LineNumberSet lines_to_format;
   if (!verible::ParseInclusiveRanges(
@@ -267,7 +524,7 @@ int main(int argc, char** argv) {
   }
 
   // Some sanity checks if multiple files are given.
-  if (file_args.size() > 2) {
+  if (filenames.size() > 1) {
     if (!lines_to_format.empty()) {
       std::cerr << "--lines only works for single files." << std::endl;
       return 1;
@@ -282,10 +539,41 @@ int main(int argc, char** argv) {
 
   bool all_success = true;
   bool any_changes = false;
-  // All positional arguments are file names.  Exclude program name.
-  for (const absl::string_view filename :
-       verible::make_range(file_args.begin() + 1, file_args.end())) {
-    all_success &= formatOneFile(filename, lines_to_format, &any_changes);
+  if (jobs <= 1 || filenames.size() == 1) {
+    for (const std::string& filename : filenames) {
+      bool file_changes = false;
+      all_success &= formatOneFile(filename, lines_to_format, format_style,
+                                   std::cout, std::cerr, &file_changes);
+      any_changes |= file_changes;
+    }
+  } else {
+    // Each file is formatted into its own buffers, which are printed in the
+    // original file order, so that the results don't interleave.
+    verible::ThreadPool pool(jobs);
+    std::vector<std::future<FileResult>> results;
+    results.reserve(filenames.size());
+    for (const std::string& filename : filenames) {
+      const std::function<FileResult()> format_file = [&filename,
+                                                       &lines_to_format,
+                                                       &format_style]() {
+        std::ostringstream output;
+        std::ostringstream messages;
+        FileResult result;
+        result.success = formatOneFile(filename, lines_to_format, format_style,
+                                       output, messages, &result.any_changes);
+        result.output = output.str();
+        result.messages = messages.str();
+        return result;
+      };
+      results.push_back(pool.ExecAsync(format_file));
+    }
+    for (auto& future_result : results) {
+      const FileResult result = future_result.get();
+      std::cerr << result.messages;
+      std::cout << result.output;
+      all_success &= result.success;
+      any_changes |= result.any_changes;
+    }
   }
 
   int ret_val = 0;
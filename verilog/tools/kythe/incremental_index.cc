@@ -0,0 +1,311 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/tools/kythe/incremental_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/util/file_util.h"
+#include "common/util/logging.h"
+#include "common/util/sha256.h"
+#include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/symbol_table.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+namespace kythe {
+
+// First line of a state file.  Change when the format or the meaning of the
+// digests changes, so that older states lead to a full index.
+static constexpr absl::string_view kStateHeader =
+    "# verible-verilog-kythe-extractor index state, version 1";
+
+// Lines of a state file are tab-separated fields, the first of which is one
+// of these.  Symbols belong to the translation unit on the 'unit' line
+// before them.
+static constexpr absl::string_view kUnitTag = "unit";
+static constexpr absl::string_view kDefinedTag = "def";
+static constexpr absl::string_view kReferencedTag = "ref";
+static constexpr absl::string_view kIncludeTag = "include";
+
+absl::StatusOr<KytheIndexState> KytheIndexState::Load(absl::string_view path) {
+  KytheIndexState state;
+  const absl::StatusOr<std::string> content =
+      verible::file::GetContentAsString(path);
+  if (!content.ok()) {
+    if (absl::IsNotFound(content.status())) return state;
+    return content.status();
+  }
+
+  const std::vector<absl::string_view> lines =
+      absl::StrSplit(*content, '\n', absl::SkipEmpty());
+  if (lines.empty() || lines.front() != kStateHeader) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(path, ": not an index state of this version."));
+  }
+  IndexedFileState *unit = nullptr;
+  for (size_t i = 1; i < lines.size(); ++i) {
+    const std::vector<absl::string_view> fields =
+        absl::StrSplit(lines[i], '\t');
+    const absl::string_view tag = fields.front();
+    if (tag == kUnitTag && fields.size() == 4) {
+      unit = &state.translation_units[std::string(fields[1])];
+      unit->content_digest = std::string(fields[2]);
+      unit->exports_digest = std::string(fields[3]);
+    } else if (tag == kDefinedTag && fields.size() == 2 && unit != nullptr) {
+      unit->defined_symbols.emplace(fields[1]);
+    } else if (tag == kReferencedTag && fields.size() == 2 && unit != nullptr) {
+      unit->referenced_symbols.emplace(fields[1]);
+    } else if (tag == kIncludeTag && fields.size() == 3) {
+      state.included_files[std::string(fields[1])] = std::string(fields[2]);
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat(path, ":", i + 1, ": malformed index state line."));
+    }
+  }
+  return state;
+}
+
+absl::Status KytheIndexState::Save(absl::string_view path) const {
+  std::string content = absl::StrCat(kStateHeader, "\n");
+  for (const auto &[name, unit] : translation_units) {
+    absl::StrAppend(&content, kUnitTag, "\t", name, "\t", unit.content_digest,
+                    "\t", unit.exports_digest, "\n");
+    for (const std::string &symbol : unit.defined_symbols) {
+      absl::StrAppend(&content, kDefinedTag, "\t", symbol, "\n");
+    }
+    for (const std::string &symbol : unit.referenced_symbols) {
+      absl::StrAppend(&content, kReferencedTag, "\t", symbol, "\n");
+    }
+  }
+  for (const auto &[path, digest] : included_files) {
+    absl::StrAppend(&content, kIncludeTag, "\t", path, "\t", digest, "\n");
+  }
+  return verible::file::SetContents(path, content);
+}
+
+// Appends the name and kind of 'symbol' to 'exports'.
+static void AppendExport(absl::string_view name, const SymbolInfo &symbol,
+                         std::string *exports) {
+  absl::StrAppend(exports, name, " ", SymbolMetaTypeAsString(symbol.metatype),
+                  "\n");
+}
+
+// Records the symbols that the 'analyzed' translation units define and refer
+// to, as found by the symbol table built from them.
+static void RecordSymbols(
+    const SymbolTable &symbol_table,
+    const std::map<const VerilogSourceFile *, IndexedFileState *> &analyzed) {
+  std::map<const VerilogSourceFile *, std::string> exports;
+  for (const auto &[name, node] : symbol_table.Root()) {
+    const SymbolInfo &symbol = node.Value();
+    const auto found = analyzed.find(symbol.file_origin);
+    if (found == analyzed.end()) continue;
+    found->second->defined_symbols.emplace(name);
+    std::string &file_exports = exports[symbol.file_origin];
+    AppendExport(name, symbol, &file_exports);
+    // Members are what qualified references (pkg::member, named ports, ...)
+    // from other files can refer to.
+    for (const auto &[member_name, member] : node) {
+      absl::StrAppend(&file_exports, "  ");
+      AppendExport(member_name, member.Value(), &file_exports);
+    }
+  }
+  for (const auto &[file, file_state] : analyzed) {
+    file_state->exports_digest = verible::Sha256Hex(exports[file]);
+  }
+
+  const FileDependencies dependencies(symbol_table);
+  for (const auto &[name, symbol_data] : dependencies.root_symbols_index) {
+    for (const VerilogSourceFile *referencer : symbol_data.referencers) {
+      const auto found = analyzed.find(referencer);
+      if (found != analyzed.end()) {
+        found->second->referenced_symbols.emplace(name);
+      }
+    }
+  }
+}
+
+KytheIndexState ComputeIndexState(VerilogProject *project,
+                                  const std::vector<std::string> &file_names,
+                                  const KytheIndexState &previous,
+                                  std::vector<absl::Status> *errors) {
+  VLOG(1) << __FUNCTION__;
+  KytheIndexState state;
+  // Files may include each other in ways that are only known by parsing,
+  // so if any included file changed, every translation unit is analyzed.
+  bool includes_unchanged = true;
+  for (const auto &[path, digest] : previous.included_files) {
+    const absl::StatusOr<std::string> content =
+        verible::file::GetContentAsString(path);
+    if (!content.ok()) {
+      includes_unchanged = false;
+      continue;
+    }
+    std::string current_digest = verible::Sha256Hex(*content);
+    if (current_digest != digest) includes_unchanged = false;
+    state.included_files[path] = std::move(current_digest);
+  }
+
+  SymbolTable symbol_table(project);
+  std::vector<absl::Status> diagnostics;
+  std::map<const VerilogSourceFile *, IndexedFileState *> analyzed;
+  for (const std::string &name : file_names) {
+    if (state.translation_units.find(name) != state.translation_units.end()) {
+      continue;  // listed more than once
+    }
+    const auto status_or_file = project->OpenTranslationUnit(name);
+    if (!status_or_file.ok()) {
+      errors->push_back(status_or_file.status());
+      continue;
+    }
+    const VerilogSourceFile *const file = *status_or_file;
+    IndexedFileState &file_state = state.translation_units[name];
+    file_state.content_digest = verible::Sha256Hex(file->GetContent());
+    const auto found = previous.translation_units.find(name);
+    if (includes_unchanged && found != previous.translation_units.end() &&
+        found->second.content_digest == file_state.content_digest) {
+      file_state = found->second;
+      project->RemoveRegisteredFile(name);
+      continue;
+    }
+    VLOG(1) << "Analyzing changed file " << name;
+    symbol_table.BuildSingleTranslationUnit(name, &diagnostics);
+    analyzed[file] = &file_state;
+  }
+  // Problems with the content are reported when extracting facts.
+  for (const absl::Status &diagnostic : diagnostics) {
+    VLOG(1) << diagnostic.message();
+  }
+  if (analyzed.empty()) return state;
+
+  RecordSymbols(symbol_table, analyzed);
+
+  // The files still registered besides the analyzed translation units were
+  // included from them.
+  for (const auto &[name, file] : *project) {
+    if (analyzed.find(file.get()) != analyzed.end()) continue;
+    if (!file->Status().ok()) continue;
+    state.included_files[std::string(file->ResolvedPath())] =
+        verible::Sha256Hex(file->GetContent());
+  }
+  VLOG(1) << "end of " << __FUNCTION__;
+  return state;
+}
+
+IncrementalIndexPlan PlanIncrementalIndex(
+    const std::vector<std::string> &file_names,
+    const KytheIndexState &previous, const KytheIndexState &current) {
+  IncrementalIndexPlan plan;
+  bool full_index = previous.translation_units.empty();
+  for (const auto &[path, digest] : previous.included_files) {
+    const auto found = current.included_files.find(path);
+    if (found == current.included_files.end() || found->second != digest) {
+      full_index = true;
+    }
+  }
+  if (full_index) {
+    for (const std::string &name : file_names) {
+      if (plan.files_to_emit.insert(name).second) {
+        plan.files_to_extract.push_back(name);
+      }
+    }
+    return plan;
+  }
+
+  // Symbols whose definitions changed in ways other files could see, or
+  // appeared or disappeared.
+  std::set<std::string> changed_symbols;
+  const auto add_defined = [&changed_symbols](const IndexedFileState *unit) {
+    if (unit == nullptr) return;
+    changed_symbols.insert(unit->defined_symbols.begin(),
+                           unit->defined_symbols.end());
+  };
+  for (const auto &[name, unit] : previous.translation_units) {
+    const auto found = current.translation_units.find(name);
+    if (found == current.translation_units.end()) {
+      add_defined(&unit);
+    } else if (found->second.exports_digest != unit.exports_digest) {
+      add_defined(&unit);
+      add_defined(&found->second);
+    }
+  }
+  for (const auto &[name, unit] : current.translation_units) {
+    if (previous.translation_units.find(name) ==
+        previous.translation_units.end()) {
+      add_defined(&unit);
+    }
+  }
+
+  // The first definition of each symbol, as is used by the extractor.
+  std::map<absl::string_view, absl::string_view> definers;
+  for (const std::string &name : file_names) {
+    const auto found = current.translation_units.find(name);
+    if (found == current.translation_units.end()) continue;
+    for (const std::string &symbol : found->second.defined_symbols) {
+      definers.emplace(symbol, name);
+    }
+  }
+
+  std::set<absl::string_view> to_extract;
+  std::vector<absl::string_view> to_visit;
+  for (const auto &[name, unit] : current.translation_units) {
+    const auto found = previous.translation_units.find(name);
+    const bool changed = found == previous.translation_units.end() ||
+                         found->second.content_digest != unit.content_digest;
+    const bool affected = std::any_of(
+        unit.referenced_symbols.begin(), unit.referenced_symbols.end(),
+        [&changed_symbols](const std::string &symbol) {
+          return changed_symbols.find(symbol) != changed_symbols.end();
+        });
+    if (!changed && !affected) continue;
+    plan.files_to_emit.insert(name);
+    to_extract.insert(name);
+    to_visit.push_back(name);
+  }
+
+  // Definitions that emitted files refer to need to be extracted as well.
+  while (!to_visit.empty()) {
+    const absl::string_view name = to_visit.back();
+    to_visit.pop_back();
+    const IndexedFileState &unit =
+        current.translation_units.find(std::string(name))->second;
+    for (const std::string &symbol : unit.referenced_symbols) {
+      const auto found = definers.find(symbol);
+      if (found == definers.end()) continue;
+      if (to_extract.insert(found->second).second) {
+        to_visit.push_back(found->second);
+      }
+    }
+  }
+
+  for (const std::string &name : file_names) {
+    if (to_extract.erase(name) > 0) plan.files_to_extract.push_back(name);
+  }
+  return plan;
+}
+
+}  // namespace kythe
+}  // namespace verilog
@@ -0,0 +1,95 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_TOOLS_KYTHE_INCREMENTAL_INDEX_H_
+#define VERIBLE_VERILOG_TOOLS_KYTHE_INCREMENTAL_INDEX_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+namespace kythe {
+
+// What an earlier indexing run recorded about one translation unit.
+struct IndexedFileState {
+  // Digest of the file's content.
+  std::string content_digest;
+
+  // Digest of the root-level symbols that the file defines, with their
+  // direct members: what other files can refer to.
+  std::string exports_digest;
+
+  // Root-level symbols defined in the file.
+  std::set<std::string> defined_symbols;
+
+  // Unqualified root-level symbols that the file refers to.
+  std::set<std::string> referenced_symbols;
+};
+
+// State of an index, kept between runs of the extractor so that later runs
+// only need to index what changed.
+struct KytheIndexState {
+  // Key: translation unit name, as listed in the file list.
+  std::map<std::string, IndexedFileState> translation_units;
+
+  // Key: resolved path of an included file, value: digest of its content.
+  std::map<std::string, std::string> included_files;
+
+  // Reads a state written by Save().  A missing file yields an empty state.
+  static absl::StatusOr<KytheIndexState> Load(absl::string_view path);
+
+  absl::Status Save(absl::string_view path) const;
+};
+
+// Computes the state of the translation units in 'file_names'.  Only
+// translation units whose content differs from 'previous' are parsed to find
+// their symbols (all of them if an included file changed), the state of the
+// others is taken from 'previous'.  'project' needs to provide file origin
+// lookup (for FileDependencies).
+// Files that can't be opened are reported in 'errors' and left out.
+KytheIndexState ComputeIndexState(VerilogProject *project,
+                                  const std::vector<std::string> &file_names,
+                                  const KytheIndexState &previous,
+                                  std::vector<absl::Status> *errors);
+
+// What needs to be done to bring an index up to date.
+struct IncrementalIndexPlan {
+  // Translation units whose facts need to be emitted: changed ones, and the
+  // ones that refer to symbols whose exports changed.
+  std::set<std::string> files_to_emit;
+
+  // Translation units to extract, in file list order: the ones to emit and
+  // the ones that define what these refer to (transitively), without which
+  // references could not be resolved.
+  std::vector<std::string> files_to_extract;
+};
+
+// Compares the 'current' state of the translation units in 'file_names' to
+// the 'previous' one.  Everything is indexed if there is no previous state or
+// an included file changed.
+IncrementalIndexPlan PlanIncrementalIndex(
+    const std::vector<std::string> &file_names,
+    const KytheIndexState &previous, const KytheIndexState &current);
+
+}  // namespace kythe
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_TOOLS_KYTHE_INCREMENTAL_INDEX_H_
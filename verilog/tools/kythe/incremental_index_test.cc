@@ -0,0 +1,198 @@
+// Copyright 2017-2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/tools/kythe/incremental_index.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "common/util/file_util.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_project.h"
+
+namespace verilog {
+namespace kythe {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using verible::file::CreateDir;
+using verible::file::JoinPath;
+using verible::file::SetContents;
+
+TEST(KytheIndexStateTest, SaveAndLoad) {
+  KytheIndexState state;
+  IndexedFileState &unit = state.translation_units["a.sv"];
+  unit.content_digest = "c0ffee";
+  unit.exports_digest = "beef";
+  unit.defined_symbols = {"m", "p"};
+  unit.referenced_symbols = {"q"};
+  state.translation_units["b.sv"].content_digest = "f00d";
+  state.included_files["/inc/defs.svh"] = "cafe";
+
+  const std::string path = JoinPath(::testing::TempDir(), "index_state");
+  ASSERT_TRUE(state.Save(path).ok());
+  const auto loaded = KytheIndexState::Load(path);
+  ASSERT_TRUE(loaded.ok()) << loaded.status();
+  ASSERT_EQ(loaded->translation_units.size(), 2);
+  const IndexedFileState &loaded_unit = loaded->translation_units.at("a.sv");
+  EXPECT_EQ(loaded_unit.content_digest, "c0ffee");
+  EXPECT_EQ(loaded_unit.exports_digest, "beef");
+  EXPECT_EQ(loaded_unit.defined_symbols, unit.defined_symbols);
+  EXPECT_EQ(loaded_unit.referenced_symbols, unit.referenced_symbols);
+  EXPECT_EQ(loaded->translation_units.at("b.sv").content_digest, "f00d");
+  EXPECT_EQ(loaded->included_files, state.included_files);
+}
+
+TEST(KytheIndexStateTest, LoadMissingOrMalformed) {
+  const std::string path = JoinPath(::testing::TempDir(), "no_such_state");
+  const auto missing = KytheIndexState::Load(path);
+  ASSERT_TRUE(missing.ok()) << missing.status();
+  EXPECT_THAT(missing->translation_units, IsEmpty());
+
+  const std::string malformed = JoinPath(::testing::TempDir(), "bad_state");
+  ASSERT_TRUE(SetContents(malformed, "something else\n").ok());
+  EXPECT_FALSE(KytheIndexState::Load(malformed).ok());
+}
+
+// Returns a state of one translation unit.
+static IndexedFileState Unit(absl::string_view content,
+                             absl::string_view exports,
+                             const std::set<std::string> &defined,
+                             const std::set<std::string> &referenced) {
+  return {std::string(content), std::string(exports), defined, referenced};
+}
+
+TEST(PlanIncrementalIndexTest, NoPreviousStateIndexesEverything) {
+  const std::vector<std::string> file_names = {"a.sv", "b.sv", "a.sv"};
+  KytheIndexState current;
+  current.translation_units["a.sv"] = Unit("1", "x", {"a"}, {});
+  current.translation_units["b.sv"] = Unit("2", "y", {"b"}, {"a"});
+  const IncrementalIndexPlan plan =
+      PlanIncrementalIndex(file_names, KytheIndexState(), current);
+  EXPECT_THAT(plan.files_to_extract, ElementsAre("a.sv", "b.sv"));
+  EXPECT_EQ(plan.files_to_emit, (std::set<std::string>{"a.sv", "b.sv"}));
+}
+
+TEST(PlanIncrementalIndexTest, OnlyChangedAndAffectedFiles) {
+  const std::vector<std::string> file_names = {"pkg.sv", "sub.sv", "top.sv",
+                                               "other.sv"};
+  KytheIndexState previous;
+  previous.translation_units["pkg.sv"] = Unit("1", "p1", {"pkg"}, {});
+  previous.translation_units["sub.sv"] = Unit("2", "s1", {"sub"}, {"pkg"});
+  previous.translation_units["top.sv"] = Unit("3", "t1", {"top"}, {"sub"});
+  previous.translation_units["other.sv"] = Unit("4", "o1", {"other"}, {});
+
+  {  // Nothing changed.
+    const IncrementalIndexPlan plan =
+        PlanIncrementalIndex(file_names, previous, previous);
+    EXPECT_THAT(plan.files_to_extract, IsEmpty());
+    EXPECT_THAT(plan.files_to_emit, IsEmpty());
+  }
+  {  // Content of sub.sv changed, but not what it exports.
+    KytheIndexState current = previous;
+    current.translation_units["sub.sv"].content_digest = "2'";
+    const IncrementalIndexPlan plan =
+        PlanIncrementalIndex(file_names, previous, current);
+    // pkg.sv is needed to resolve references.
+    EXPECT_THAT(plan.files_to_extract, ElementsAre("pkg.sv", "sub.sv"));
+    EXPECT_EQ(plan.files_to_emit, (std::set<std::string>{"sub.sv"}));
+  }
+  {  // Exports of sub.sv changed, so top.sv is affected.
+    KytheIndexState current = previous;
+    current.translation_units["sub.sv"].content_digest = "2'";
+    current.translation_units["sub.sv"].exports_digest = "s2";
+    const IncrementalIndexPlan plan =
+        PlanIncrementalIndex(file_names, previous, current);
+    EXPECT_THAT(plan.files_to_extract,
+                ElementsAre("pkg.sv", "sub.sv", "top.sv"));
+    EXPECT_EQ(plan.files_to_emit, (std::set<std::string>{"sub.sv", "top.sv"}));
+  }
+  {  // A changed include invalidates everything.
+    previous.included_files["defs.svh"] = "d1";
+    KytheIndexState current = previous;
+    current.included_files["defs.svh"] = "d2";
+    const IncrementalIndexPlan plan =
+        PlanIncrementalIndex(file_names, previous, current);
+    EXPECT_EQ(plan.files_to_extract, file_names);
+  }
+}
+
+TEST(ComputeIndexStateTest, AnalyzesChangedFiles) {
+  const std::string sources_dir =
+      JoinPath(::testing::TempDir(), "incremental_index_sources");
+  ASSERT_TRUE(CreateDir(sources_dir).ok());
+  const std::vector<std::string> file_names = {"sub.sv", "top.sv"};
+  ASSERT_TRUE(SetContents(JoinPath(sources_dir, "sub.sv"),
+                          "module sub;\nendmodule\n")
+                  .ok());
+  ASSERT_TRUE(SetContents(JoinPath(sources_dir, "top.sv"),
+                          "module top;\n  sub u();\nendmodule\n")
+                  .ok());
+
+  KytheIndexState first;
+  {
+    VerilogProject project(sources_dir, {});
+    std::vector<absl::Status> errors;
+    first = ComputeIndexState(&project, file_names, KytheIndexState(), &errors);
+    EXPECT_THAT(errors, IsEmpty());
+  }
+  ASSERT_EQ(first.translation_units.size(), 2);
+  EXPECT_EQ(first.translation_units["sub.sv"].defined_symbols,
+            (std::set<std::string>{"sub"}));
+  EXPECT_EQ(first.translation_units["top.sv"].defined_symbols,
+            (std::set<std::string>{"top"}));
+  EXPECT_EQ(first.translation_units["top.sv"].referenced_symbols.count("sub"),
+            1);
+
+  // A comment changes the content, not the exports.
+  ASSERT_TRUE(SetContents(JoinPath(sources_dir, "sub.sv"),
+                          "// sub\nmodule sub;\nendmodule\n")
+                  .ok());
+  KytheIndexState second;
+  {
+    VerilogProject project(sources_dir, {});
+    std::vector<absl::Status> errors;
+    second = ComputeIndexState(&project, file_names, first, &errors);
+  }
+  EXPECT_NE(second.translation_units["sub.sv"].content_digest,
+            first.translation_units["sub.sv"].content_digest);
+  EXPECT_EQ(second.translation_units["sub.sv"].exports_digest,
+            first.translation_units["sub.sv"].exports_digest);
+  EXPECT_EQ(PlanIncrementalIndex(file_names, first, second).files_to_emit,
+            (std::set<std::string>{"sub.sv"}));
+
+  // A new port changes the exports.
+  ASSERT_TRUE(SetContents(JoinPath(sources_dir, "sub.sv"),
+                          "module sub(input clk);\nendmodule\n")
+                  .ok());
+  KytheIndexState third;
+  {
+    VerilogProject project(sources_dir, {});
+    std::vector<absl::Status> errors;
+    third = ComputeIndexState(&project, file_names, second, &errors);
+  }
+  EXPECT_NE(third.translation_units["sub.sv"].exports_digest,
+            second.translation_units["sub.sv"].exports_digest);
+  EXPECT_EQ(PlanIncrementalIndex(file_names, second, third).files_to_emit,
+            (std::set<std::string>{"sub.sv", "top.sv"}));
+}
+
+}  // namespace
+}  // namespace kythe
+}  // namespace verilog
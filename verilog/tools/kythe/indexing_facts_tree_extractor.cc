@@ -14,7 +14,12 @@
 
 #include "verilog/tools/kythe/indexing_facts_tree_extractor.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <future>
 #include <iterator>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -30,6 +35,7 @@
 #include "common/text/tree_context_visitor.h"
 #include "common/text/tree_utils.h"
 #include "common/util/logging.h"
+#include "common/util/thread_pool.h"
 #include "common/util/tree_operations.h"
 #include "verilog/CST/class.h"
 #include "verilog/CST/declaration.h"
@@ -70,6 +76,10 @@ struct VerilogExtractionState {
   // Keep track of which files (translation units, includes) have been
   // extracted.
   std::set<const VerilogSourceFile *> extracted_files;
+  // Translation units that are being parsed ahead on other threads.  Included
+  // files must only be parsed once these are done.
+  std::map<const VerilogSourceFile *, std::shared_future<absl::Status>>
+      pending_parses;
 };
 
 // This class is used for traversing CST and extracting different indexing
@@ -346,23 +356,18 @@ IndexingFactNode ExtractFiles(absl::string_view file_list_path,
                               VerilogProject *project,
                               const std::vector<std::string> &file_names,
                               std::vector<absl::Status> *errors) {
-  VLOG(1) << __FUNCTION__;
-  // Open all of the translation units.
-  for (absl::string_view file_name : file_names) {
-    const auto status_or_file = project->OpenTranslationUnit(file_name);
-    if (!status_or_file.ok()) {
-      if (errors != nullptr) {
-        errors->push_back(status_or_file.status());
-      } else {
-        LOG(ERROR) << "Failed to open file " << file_name << ": "
-                   << status_or_file.status();
-      }
-    }
-    // For now, collect all diagnostics at the end.
-    // TODO(fangism): offer a mode to exit-early if there are file-not-found
-    // or read-permission issues (fail-fast, alert-user).
-  }
+  return ExtractFiles(file_list_path, project, file_names, 0, nullptr,
+                      /*keep_extracted_files=*/true, errors);
+}
 
+IndexingFactNode ExtractFiles(absl::string_view file_list_path,
+                              VerilogProject *project,
+                              const std::vector<std::string> &file_names,
+                              int parse_threads,
+                              const ExtractedFilesCallback &on_extracted,
+                              bool keep_extracted_files,
+                              std::vector<absl::Status> *errors) {
+  VLOG(1) << __FUNCTION__;
   // Create a node to hold the path and root of the ordered file list, group
   // all the files and acts as a ordered file list of these files.
   IndexingFactNode file_list_facts_tree(
@@ -372,25 +377,85 @@ IndexingFactNode ExtractFiles(absl::string_view file_list_path,
   VerilogExtractionState project_extraction_state{project};
 
   // pre-allocate file nodes with the number of translation units
-  file_list_facts_tree.Children().reserve(file_names.size());
-  for (absl::string_view file_name : file_names) {
-    auto *translation_unit = project->LookupRegisteredFile(file_name);
-    if (translation_unit == nullptr) continue;
-    const auto parse_status = translation_unit->Parse();
-    // status is also stored in translation_unit for later retrieval.
+  if (keep_extracted_files) {
+    file_list_facts_tree.Children().reserve(file_names.size());
+  }
+
+  // Translation units are opened and parsed a few files ahead of extraction,
+  // which only keeps the syntax trees of these in memory.
+  struct OpenedFile {
+    absl::string_view name;
+    VerilogSourceFile *file;
+    std::shared_future<absl::Status> parse_status;
+  };
+  verible::ThreadPool parse_pool(parse_threads);
+  const size_t max_opened_files = std::max(2 * parse_threads, 1);
+  std::deque<OpenedFile> opened_files;
+  auto next_file_name = file_names.begin();
+
+  while (!opened_files.empty() || next_file_name != file_names.end()) {
+    while (opened_files.size() < max_opened_files &&
+           next_file_name != file_names.end()) {
+      const absl::string_view file_name = *next_file_name;
+      const auto status_or_file = project->OpenTranslationUnit(file_name);
+      if (!status_or_file.ok()) {
+        if (errors != nullptr) {
+          errors->push_back(status_or_file.status());
+        } else {
+          LOG(ERROR) << "Failed to open file " << file_name << ": "
+                     << status_or_file.status();
+        }
+        // For now, collect all diagnostics at the end.
+        // TODO(fangism): offer a mode to exit-early if there are
+        // file-not-found or read-permission issues (fail-fast, alert-user).
+        ++next_file_name;
+        continue;
+      }
+      VerilogSourceFile *const translation_unit = *status_or_file;
+      // A file listed twice is only opened again after its previous
+      // extraction is done.
+      if (std::any_of(opened_files.begin(), opened_files.end(),
+                      [translation_unit](const OpenedFile &opened) {
+                        return opened.file == translation_unit;
+                      })) {
+        break;
+      }
+      ++next_file_name;
+      // status is also stored in translation_unit for later retrieval.
+      std::shared_future<absl::Status> parse_status =
+          parse_pool
+              .ExecAsync<absl::Status>(
+                  [translation_unit]() { return translation_unit->Parse(); })
+              .share();
+      project_extraction_state.pending_parses[translation_unit] = parse_status;
+      opened_files.push_back({file_name, translation_unit, parse_status});
+    }
+
+    const OpenedFile next = opened_files.front();
+    opened_files.pop_front();
+    const absl::Status parse_status = next.parse_status.get();
+    project_extraction_state.pending_parses.erase(next.file);
+    const size_t first_new_file = file_list_facts_tree.Children().size();
     if (parse_status.ok()) {
       file_list_facts_tree.Children().push_back(
-          BuildIndexingFactsTree(&file_list_facts_tree, *translation_unit,
+          BuildIndexingFactsTree(&file_list_facts_tree, *next.file,
                                  &project_extraction_state, errors));
     } else {
       if (errors != nullptr) {
         errors->push_back(parse_status);
       } else {
-        LOG(WARNING) << "Failed to parse file " << file_name << ": "
+        LOG(WARNING) << "Failed to parse file " << next.name << ": "
                      << parse_status;
       }
     }
-    project->RemoveRegisteredFile(file_name);
+    project->RemoveRegisteredFile(next.name);
+    if (on_extracted &&
+        file_list_facts_tree.Children().size() > first_new_file) {
+      on_extracted(file_list_facts_tree, first_new_file);
+    }
+    // Files already extracted are remembered in 'project_extraction_state',
+    // their facts trees aren't needed for the remaining ones.
+    if (!keep_extracted_files) file_list_facts_tree.Children().clear();
   }
   VLOG(1) << "end of " << __FUNCTION__;
   return file_list_facts_tree;
@@ -1833,7 +1898,13 @@ void IndexingFactsTreeExtractor::ExtractInclude(
       // If already extracted, skip re-extraction.
       VLOG(1) << "File was previously extracted.";
     } else {
-      // Parse included file and extract.
+      // Parse included file and extract.  If it is also a translation unit
+      // that is being parsed ahead, let that finish first.
+      if (const auto pending =
+              extraction_state_->pending_parses.find(included_file);
+          pending != extraction_state_->pending_parses.end()) {
+        pending->second.wait();
+      }
       const auto parse_status = included_file->Parse();
       if (parse_status.ok()) {
         file_list_facts_tree_->Children().push_back(BuildIndexingFactsTree(
@@ -15,6 +15,8 @@
 #ifndef VERIBLE_VERILOG_TOOLS_KYTHE_INDEXING_FACTS_TREE_EXTRACTOR_H_
 #define VERIBLE_VERILOG_TOOLS_KYTHE_INDEXING_FACTS_TREE_EXTRACTOR_H_
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -35,6 +37,29 @@ IndexingFactNode ExtractFiles(absl::string_view file_list_path,
                               const std::vector<std::string> &file_names,
                               std::vector<absl::Status> *errors = nullptr);
 
+// Called whenever the facts of another translation unit were extracted, with
+// the file list facts tree built so far.  Its children from 'first_new_file' on
+// are the new ones: the files that the translation unit includes for the first
+// time, followed by the translation unit itself.
+using ExtractedFilesCallback = std::function<void(
+    const IndexingFactNode &file_list, size_t first_new_file)>;
+
+// Like ExtractFiles(), but translation units are parsed ahead on
+// 'parse_threads' threads (or on the calling thread if 0) while earlier ones
+// are extracted, and 'on_extracted' is called as soon as each translation unit
+// is extracted, so that facts can be processed before all files are done.
+// Files are still extracted one at a time in file list order.
+// Unless 'keep_extracted_files', the facts trees of the files are dropped once
+// 'on_extracted' returns, so that only those of one translation unit are held
+// at a time, and the returned file list has no children.
+IndexingFactNode ExtractFiles(absl::string_view file_list_path,
+                              VerilogProject *project,
+                              const std::vector<std::string> &file_names,
+                              int parse_threads,
+                              const ExtractedFilesCallback &on_extracted,
+                              bool keep_extracted_files,
+                              std::vector<absl::Status> *errors = nullptr);
+
 }  // namespace kythe
 }  // namespace verilog
 
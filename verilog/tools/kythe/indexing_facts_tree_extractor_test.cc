@@ -14,7 +14,9 @@
 
 #include "verilog/tools/kythe/indexing_facts_tree_extractor.h"
 
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -5379,6 +5381,77 @@ TEST(FactsTreeExtractor, NestedStructFunctionPort) {
   EXPECT_EQ(result_pair.right, nullptr) << P(*result_pair.right);
 }
 
+TEST(FactsTreeExtractor, ParseAheadMatchesSerialExtraction) {
+  const std::string temp_dir = ::testing::TempDir();
+  std::vector<std::unique_ptr<ScopedTestFile>> files;
+  std::vector<std::string> file_names;
+  for (int i = 0; i < 5; ++i) {
+    files.push_back(std::make_unique<ScopedTestFile>(
+        temp_dir, absl::StrCat("module m", i, ";\nendmodule\n")));
+    file_names.emplace_back(verible::file::Basename(files.back()->filename()));
+  }
+  // A duplicate in the file list is only extracted once.
+  file_names.push_back(file_names.front());
+
+  VerilogProject serial_project(temp_dir, {});
+  std::vector<absl::Status> serial_errors;
+  const T serial_tree =
+      ExtractFiles(temp_dir, &serial_project, file_names, &serial_errors);
+
+  VerilogProject project(temp_dir, {});
+  std::vector<absl::Status> errors;
+  std::vector<size_t> extracted_counts;
+  const T tree = ExtractFiles(
+      temp_dir, &project, file_names, /*parse_threads=*/3,
+      [&extracted_counts](const IndexingFactNode &file_list,
+                          size_t first_new_file) {
+        EXPECT_EQ(first_new_file, extracted_counts.size());
+        extracted_counts.push_back(file_list.Children().size());
+      },
+      /*keep_extracted_files=*/true, &errors);
+
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(errors.size(), serial_errors.size());
+  ASSERT_EQ(tree.Children().size(), files.size());
+  ASSERT_EQ(serial_tree.Children().size(), files.size());
+  EXPECT_EQ(extracted_counts, (std::vector<size_t>{1, 2, 3, 4, 5}));
+  for (size_t i = 0; i < files.size(); ++i) {
+    EXPECT_EQ(tree.Children()[i].Value().Anchors()[0].Text(),
+              serial_tree.Children()[i].Value().Anchors()[0].Text());
+    EXPECT_EQ(tree.Children()[i].Children().size(),
+              serial_tree.Children()[i].Children().size());
+  }
+}
+
+TEST(FactsTreeExtractor, ExtractedFilesAreDroppedUnlessKept) {
+  const std::string temp_dir = ::testing::TempDir();
+  std::vector<std::unique_ptr<ScopedTestFile>> files;
+  std::vector<std::string> file_names;
+  for (int i = 0; i < 3; ++i) {
+    files.push_back(std::make_unique<ScopedTestFile>(
+        temp_dir, absl::StrCat("module m", i, ";\nendmodule\n")));
+    file_names.emplace_back(verible::file::Basename(files.back()->filename()));
+  }
+
+  VerilogProject project(temp_dir, {});
+  std::vector<absl::Status> errors;
+  std::vector<std::string> extracted_files;
+  const T tree = ExtractFiles(
+      temp_dir, &project, file_names, /*parse_threads=*/2,
+      [&extracted_files](const IndexingFactNode &file_list,
+                         size_t first_new_file) {
+        EXPECT_EQ(first_new_file, 0);
+        ASSERT_EQ(file_list.Children().size(), 1);
+        extracted_files.emplace_back(verible::file::Basename(
+            file_list.Children().front().Value().Anchors()[0].Text()));
+      },
+      /*keep_extracted_files=*/false, &errors);
+
+  EXPECT_TRUE(errors.empty());
+  EXPECT_TRUE(tree.Children().empty());
+  EXPECT_EQ(extracted_files, file_names);
+}
+
 }  // namespace
 }  // namespace kythe
 }  // namespace verilog
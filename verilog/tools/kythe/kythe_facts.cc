@@ -16,71 +16,141 @@
 
 #include <cstddef>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/hash/hash.h"
-#include "absl/log/check.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/identifier_pool.h"
 #include "common/util/spacer.h"
 
 namespace verilog {
 namespace kythe {
 namespace {
 
+// Names of all signatures.  Signatures may be created on any thread, so the
+// pool is locked.
+std::mutex signature_names_mutex;
+verible::IdentifierPool &SignatureNames() {
+  static auto *const pool = new verible::IdentifierPool();
+  return *pool;
+}
+
 // Returns a hash value produced by merging two hash values.
 size_t CombineHash(size_t existing, size_t addition) {
   // Taken from boost::hash_combine. Maybe replace with AbslHashValue::combine.
   return existing ^ (addition + 0x9e3779b9 + (existing << 6) + (existing >> 2));
 }
 
-// Returns a rolling hash (https://en.wikipedia.org/wiki/Rolling_hash) of the
-// signature names. NOTE: the first name (the file) is skipped and replaced with
-// 0.
-//
-// The rolling hash of a vector produces a vector of an equal size where each
-// element is a combined hash of all previous elements.
-// res[0] = 0  // Global scope hash
-// res[1] = hash(0, name[0])
-// res[2] = hash(0, name[0], name[1])
-// ...
-// res[N] = hash(0, name[0], name[1], ..., name[N])
-std::vector<size_t> RollingHash(const std::vector<absl::string_view> &names) {
-  if (names.size() <= 1) {
-    return {0};  // Global scope
+}  // namespace
+
+Signature::Signature(const Signature &parent, absl::string_view name) {
+  const Node &p = *parent.node_;
+  const verible::IdentifierPool::Id id = InternName(name);
+  // The outermost name (the file) doesn't take part in the rolling hash, so
+  // that the global scope hashes to 0 in every file.
+  node_ = std::make_shared<const Node>(
+      Node{.parent = parent.node_,
+           .name_id = id,
+           .depth = p.depth + 1,
+           .rolling_hash = CombineHash(p.rolling_hash, absl::HashOf(id)),
+           .root_id = p.root_id});
+}
+
+bool Signature::operator==(const Signature &other) const {
+  const Node *a = node_.get();
+  const Node *b = other.node_.get();
+  if (a->depth != b->depth || a->rolling_hash != b->rolling_hash) return false;
+  // Signatures derived from the same parent share its nodes, so the walk
+  // usually stops well before the root.
+  for (; a != b; a = a->parent.get(), b = b->parent.get()) {
+    if (a->name_id != b->name_id) return false;
+  }
+  return true;
+}
+
+verible::IdentifierPool::Id Signature::InternName(absl::string_view name) {
+  const std::lock_guard<std::mutex> l(signature_names_mutex);
+  return SignatureNames().Intern(name);
+}
+
+std::optional<verible::IdentifierPool::Id> Signature::FindNameId(
+    absl::string_view name) {
+  const std::lock_guard<std::mutex> l(signature_names_mutex);
+  return SignatureNames().Find(name);
+}
+
+std::vector<absl::string_view> Signature::Names() const {
+  const std::vector<verible::IdentifierPool::Id> ids = NameIds();
+  const std::lock_guard<std::mutex> l(signature_names_mutex);
+  std::vector<absl::string_view> names;
+  names.reserve(ids.size());
+  for (const verible::IdentifierPool::Id id : ids) {
+    names.push_back(SignatureNames().Name(id));
   }
+  return names;
+}
 
-  std::vector<size_t> hashes = {0};  // Prefix with the global scope
-  hashes.reserve(names.size());
-  size_t previous = 0;
-  // Start from 2nd element --> skip the filename.
-  for (size_t i = 1; i < names.size(); ++i) {
-    previous = CombineHash(previous, absl::HashOf(names[i]));
-    hashes.push_back(previous);
+std::vector<verible::IdentifierPool::Id> Signature::NameIds() const {
+  std::vector<verible::IdentifierPool::Id> ids(node_->depth);
+  auto slot = ids.rbegin();
+  for (const Node *node = node_.get(); node; node = node->parent.get()) {
+    *slot++ = node->name_id;
   }
-  CHECK_EQ(hashes.size(), names.size());
-  return hashes;
+  return ids;
 }
 
-}  // namespace
+absl::string_view Signature::Name() const { return NameOf(node_->name_id); }
+
+absl::string_view Signature::NameOf(verible::IdentifierPool::Id id) {
+  const std::lock_guard<std::mutex> l(signature_names_mutex);
+  return SignatureNames().Name(id);
+}
 
 std::string Signature::ToString() const {
   std::string signature;
-  for (absl::string_view name : names_) {
-    if (name.empty()) continue;
-    absl::StrAppend(&signature, name, "#");
-  }
+  AppendString(&signature);
   return signature;
 }
 
+void Signature::AppendString(std::string *out) const {
+  const std::lock_guard<std::mutex> l(signature_names_mutex);
+  AppendNames(*node_, out);
+}
+
+void Signature::AppendNames(const Node &node, std::string *out) {
+  if (node.parent) AppendNames(*node.parent, out);
+  const absl::string_view name = SignatureNames().Name(node.name_id);
+  if (!name.empty()) absl::StrAppend(out, name, "#");
+}
+
 std::string Signature::ToBase64() const {
   return absl::Base64Escape(ToString());
 }
 
+// The digest is the rolling hash (https://en.wikipedia.org/wiki/Rolling_hash)
+// of the ids of the signature names: a vector of an equal size where each
+// element is a combined hash of all previous elements. NOTE: the first name
+// (the file) is skipped and replaced with 0.
+// res[0] = 0  // Global scope hash
+// res[1] = hash(0, name[1])
+// res[2] = hash(0, name[1], name[2])
+// ...
+// res[N] = hash(0, name[1], name[2], ..., name[N])
+// Every node caches its element, so nothing is rehashed here.
 SignatureDigest Signature::Digest() const {
-  return SignatureDigest{.rolling_hash = RollingHash(Names())};
+  std::vector<size_t> hashes(node_->depth);
+  auto slot = hashes.rbegin();
+  for (const Node *node = node_.get(); node; node = node->parent.get()) {
+    *slot++ = node->rolling_hash;
+  }
+  return SignatureDigest{.rolling_hash = std::move(hashes)};
 }
 
 bool VName::operator==(const VName &other) const {
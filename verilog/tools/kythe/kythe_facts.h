@@ -17,10 +17,14 @@
 
 #include <cstddef>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "common/strings/identifier_pool.h"
 
 namespace verilog {
 namespace kythe {
@@ -44,41 +48,73 @@ struct SignatureDigest {
     return os;
   }
 };
+// The rolling hash already covers the whole scope, so only its last entry
+// (and the depth, like operator==) is hashed again.
 template <typename H>
 H AbslHashValue(H state, const SignatureDigest &d) {
-  return H::combine(std::move(state), d.rolling_hash);
+  return H::combine(std::move(state), d.rolling_hash.size(), d.Hash());
 }
 
 // Unique identifier for Kythe facts.
+// Names are interned in a pool shared by all signatures, so that signatures
+// are compared and hashed as integers.  A signature shares the names of its
+// parent, and derives its rolling hash from the parent's, so creating one is
+// O(1) however deep the scope.
 class Signature {
  public:
-  explicit Signature(absl::string_view name = "") : names_({name}) {}
+  explicit Signature(absl::string_view name = "")
+      : node_(std::make_shared<const Node>(Node{
+            .parent = nullptr, .name_id = InternName(name), .depth = 1})) {}
 
-  Signature(const Signature &parent, absl::string_view name)
-      : names_(parent.Names()) {
-    names_.push_back(name);
-  }
+  Signature(const Signature &parent, absl::string_view name);
 
-  bool operator==(const Signature &other) const {
-    return names_ == other.names_;
-  }
+  bool operator==(const Signature &other) const;
   bool operator!=(const Signature &other) const { return !(*this == other); }
 
   // Returns the signature concatenated as a string.
   std::string ToString() const;
 
+  // Appends ToString() to 'out', without a temporary string.
+  void AppendString(std::string *out) const;
+
   // Returns the signature concatenated as a string in base 64.
   std::string ToBase64() const;
 
-  const std::vector<absl::string_view> &Names() const { return names_; }
+  // Returns the names, outermost first. Their text is owned by the pool, and
+  // lives as long as the process.
+  std::vector<absl::string_view> Names() const;
+
+  // Returns the innermost name.
+  absl::string_view Name() const;
+
+  // Returns the ids of the names, outermost first.
+  std::vector<verible::IdentifierPool::Id> NameIds() const;
+
+  // Returns the id of the innermost name.
+  verible::IdentifierPool::Id NameId() const { return node_->name_id; }
+
+  // Returns the id of "name" if any signature was created with it.
+  static std::optional<verible::IdentifierPool::Id> FindNameId(
+      absl::string_view name);
+
+  // Returns the name with the given id.
+  static absl::string_view NameOf(verible::IdentifierPool::Id id);
 
   // Returns signature's short form for fast and lightweight comparision.
   SignatureDigest Digest() const;
 
+  template <typename H>
+  friend H AbslHashValue(H state, const Signature &v) {
+    return H::combine(std::move(state), v.node_->depth, v.node_->rolling_hash,
+                      v.node_->root_id);
+  }
+
  private:
-  // List that uniquely determines this signature and differentiates it from any
-  // other signature.
-  // This list represents the name of some signature in a scope.
+  static verible::IdentifierPool::Id InternName(absl::string_view name);
+
+  // One name of the list that uniquely determines this signature and
+  // differentiates it from any other signature, linked to the enclosing
+  // names.
   // e.g
   // class m;
   //    int x;
@@ -86,12 +122,20 @@ class Signature {
   //
   // for "m" ==> ["m"]
   // for "x" ==> ["m", "x"]
-  std::vector<absl::string_view> names_;
+  struct Node {
+    std::shared_ptr<const Node> parent;
+    verible::IdentifierPool::Id name_id;
+    size_t depth;  // Number of names up to this one.
+    // Rolling hash of the names up to this one, see Digest().
+    size_t rolling_hash = 0;
+    verible::IdentifierPool::Id root_id = name_id;  // Outermost name.
+  };
+  std::shared_ptr<const Node> node_;
+
+  // Appends the names up to 'node' to 'out', outermost first.  The name pool
+  // must be locked.
+  static void AppendNames(const Node &node, std::string *out);
 };
-template <typename H>
-H AbslHashValue(H state, const Signature &v) {
-  return H::combine(std::move(state), v.Names());
-}
 
 // Node vector name for kythe facts.
 struct VName {
@@ -238,6 +238,8 @@ class KytheFactsExtractor {
                   const VName &target);
 
   // Holds the hashes of the output Kythe facts and edges (for deduplication).
+  // This only lives for the extraction of one file, as the facts of different
+  // files are about their own anchors.
   absl::flat_hash_set<int64_t> seen_kythe_hashes_;
 
   // The full path of the current source file.
@@ -265,6 +267,42 @@ class KytheFactsExtractor {
   absl::node_hash_set<std::string> signature_locations_;
 };
 
+void KytheFactsStream::ExtractFile(const IndexingFactNode &file) {
+  scope_resolver_.SetCurrentScope(Signature(""));
+  const absl::Time extraction_start = absl::Now();
+  // 'file_path' is path-resolved.
+  const absl::string_view file_path(InternFilePath(GetFilePathFromRoot(file)));
+  VLOG(1) << "child file resolved path: " << file_path;
+
+  // Create facts and edges.
+  KytheFactsExtractor kythe_extractor(file_path, project_->Corpus(),
+                                      kythe_output_, &scope_resolver_);
+
+  // Output facts and edges.
+  kythe_extractor.ExtractFile(file);
+  LOG(INFO) << "Extracted Kythe facts of " << file_path << " in "
+            << (absl::Now() - extraction_start);
+}
+
+void KytheFactsStream::ResolveFile(const IndexingFactNode &file) {
+  // Discards all facts.
+  class NullOutput final : public KytheOutput {
+   public:
+    void Emit(const Fact &fact) final {}
+    void Emit(const Edge &edge) final {}
+  };
+  NullOutput null_output;
+  scope_resolver_.SetCurrentScope(Signature(""));
+  KytheFactsExtractor kythe_extractor(
+      InternFilePath(GetFilePathFromRoot(file)), project_->Corpus(),
+      &null_output, &scope_resolver_);
+  kythe_extractor.ExtractFile(file);
+}
+
+absl::string_view KytheFactsStream::InternFilePath(absl::string_view path) {
+  return *file_paths_.emplace(path).first;
+}
+
 void StreamKytheFactsEntries(KytheOutput *kythe_output,
                              const IndexingFactNode &file_list,
                              const VerilogProject &project) {
@@ -276,23 +314,10 @@ void StreamKytheFactsEntries(KytheOutput *kythe_output,
   // the symbols defined in each file.
 
   // Process each file in the original listed order.
-  ScopeResolver scope_resolver(Signature(""));
+  KytheFactsStream kythe_facts(kythe_output, project);
   for (const IndexingFactNode &root : file_list.Children()) {
-    scope_resolver.SetCurrentScope(Signature(""));
-    const absl::Time extraction_start = absl::Now();
     // 'root' corresponds to the fact tree for a particular file.
-    // 'file_path' is path-resolved.
-    const absl::string_view file_path(GetFilePathFromRoot(root));
-    VLOG(1) << "child file resolved path: " << file_path;
-
-    // Create facts and edges.
-    KytheFactsExtractor kythe_extractor(file_path, project.Corpus(),
-                                        kythe_output, &scope_resolver);
-
-    // Output facts and edges.
-    kythe_extractor.ExtractFile(root);
-    LOG(INFO) << "Extracted Kythe facts of " << file_path << " in "
-              << (absl::Now() - extraction_start);
+    kythe_facts.ExtractFile(root);
   }
 
   VLOG(1) << "end of " << __FUNCTION__;
@@ -1185,22 +1210,24 @@ void KytheFactsExtractor::CreateEdge(const VName &source_node,
   }
 }
 
-std::ostream &KytheFactsPrinter::PrintJsonStream(std::ostream &stream) const {
-  // TODO(fangism): Print function should not be doing extraction work.
-  class Printer final : public KytheOutput {
-   public:
-    explicit Printer(std::ostream &stream) : stream_(stream) {}
-    void Emit(const Fact &fact) final {
-      fact.FormatJSON(stream_, /*debug=*/false) << std::endl;
-    }
-    void Emit(const Edge &edge) final {
-      edge.FormatJSON(stream_, /*debug=*/false) << std::endl;
-    }
+void KytheJsonOutput::Separate() {
+  if (debug_ && add_comma_) stream_ << "," << std::endl;
+  add_comma_ = true;
+}
+
+void KytheJsonOutput::Emit(const Fact &fact) {
+  Separate();
+  fact.FormatJSON(stream_, debug_) << std::endl;
+}
 
-   private:
-    std::ostream &stream_;
-  } printer(stream);
+void KytheJsonOutput::Emit(const Edge &edge) {
+  Separate();
+  edge.FormatJSON(stream_, debug_) << std::endl;
+}
 
+std::ostream &KytheFactsPrinter::PrintJsonStream(std::ostream &stream) const {
+  // TODO(fangism): Print function should not be doing extraction work.
+  KytheJsonOutput printer(stream, /*debug=*/false);
   StreamKytheFactsEntries(&printer, file_list_facts_tree_, *project_);
 
   return stream;
@@ -1208,25 +1235,7 @@ std::ostream &KytheFactsPrinter::PrintJsonStream(std::ostream &stream) const {
 
 std::ostream &KytheFactsPrinter::PrintJson(std::ostream &stream) const {
   // TODO(fangism): Print function should not be doing extraction work.
-  class Printer final : public KytheOutput {
-   public:
-    explicit Printer(std::ostream &stream) : stream_(stream) {}
-    void Emit(const Fact &fact) final {
-      if (add_comma_) stream_ << "," << std::endl;
-      fact.FormatJSON(stream_, /*debug=*/true) << std::endl;
-      add_comma_ = true;
-    }
-    void Emit(const Edge &edge) final {
-      if (add_comma_) stream_ << "," << std::endl;
-      edge.FormatJSON(stream_, /*debug=*/true) << std::endl;
-      add_comma_ = true;
-    }
-
-   private:
-    std::ostream &stream_;
-    bool add_comma_ = false;
-  } printer(stream);
-
+  KytheJsonOutput printer(stream, /*debug=*/true);
   stream << "[";
   StreamKytheFactsEntries(&printer, file_list_facts_tree_, *project_);
   stream << "]" << std::endl;
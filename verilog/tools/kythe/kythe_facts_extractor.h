@@ -16,10 +16,15 @@
 #define VERIBLE_VERILOG_TOOLS_KYTHE_KYTHE_FACTS_EXTRACTOR_H_
 
 #include <iosfwd>
+#include <ostream>
+#include <string>
 
+#include "absl/container/node_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "verilog/analysis/verilog_project.h"
 #include "verilog/tools/kythe/indexing_facts_tree.h"
 #include "verilog/tools/kythe/kythe_facts.h"
+#include "verilog/tools/kythe/scope_resolver.h"
 
 namespace verilog {
 namespace kythe {
@@ -66,6 +71,56 @@ class KytheOutput {
   virtual ~KytheOutput() = default;
 };
 
+// Prints Kythe facts as JSON entries, one per line.  With 'debug', entries are
+// human-readable and separated by commas, to be enclosed in "[" and "]" as
+// one JSON array.
+class KytheJsonOutput final : public KytheOutput {
+ public:
+  KytheJsonOutput(std::ostream &stream, bool debug)
+      : stream_(stream), debug_(debug) {}
+
+  void Emit(const Fact &fact) final;
+  void Emit(const Edge &edge) final;
+
+ private:
+  void Separate();
+
+  std::ostream &stream_;
+  const bool debug_;
+  bool add_comma_ = false;
+};
+
+// Extracts Kythe facts of files one at a time, resolving references to the
+// definitions of all files extracted before.  Extracting all files of a file
+// list in order produces the same output as StreamKytheFactsEntries().
+class KytheFactsStream {
+ public:
+  KytheFactsStream(KytheOutput *kythe_output, const VerilogProject &project)
+      : kythe_output_(kythe_output),
+        project_(&project),
+        scope_resolver_(Signature("")) {}
+
+  // Extracts the facts of 'file', a node tagged with kFile.  The facts tree
+  // may be dropped afterwards: resolved definitions don't refer to its text.
+  void ExtractFile(const IndexingFactNode &file);
+
+  // Like ExtractFile(), but only records the definitions of 'file' for the
+  // files extracted later, without emitting any facts.
+  void ResolveFile(const IndexingFactNode &file);
+
+ private:
+  // Returns a copy of 'path' that lives as long as this object.
+  absl::string_view InternFilePath(absl::string_view path);
+
+  KytheOutput *const kythe_output_;
+  const VerilogProject *const project_;
+  ScopeResolver scope_resolver_;
+
+  // Backing store of the paths of the extracted files, which the VNames of
+  // their definitions refer to.
+  absl::node_hash_set<std::string> file_paths_;
+};
+
 // Extract facts across an entire project.
 // Extracts node tagged with kFileList where it iterates over every child node
 // tagged with kFile from the begining and extracts the facts for each file.
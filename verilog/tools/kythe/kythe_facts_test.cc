@@ -14,8 +14,11 @@
 
 #include "verilog/tools/kythe/kythe_facts.h"
 
+#include <cstddef>
 #include <sstream>
+#include <vector>
 
+#include "absl/hash/hash.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -60,6 +63,27 @@ TEST(SignatureTest, Equality) {
   }
 }
 
+TEST(SignatureTest, EqualityOfSeparatelyBuiltChains) {
+  const Signature file("file.sv");
+  const Signature m1(file, "m");
+  const Signature m2(Signature("file.sv"), "m");
+  EXPECT_EQ(Signature(m1, "x"), Signature(m2, "x"));
+  EXPECT_NE(Signature(m1, "x"), Signature(m2, "y"));
+  EXPECT_NE(Signature(m1, "x"), Signature(Signature(file, "n"), "x"));
+  EXPECT_EQ(absl::HashOf(Signature(m1, "x")), absl::HashOf(Signature(m2, "x")));
+}
+
+TEST(SignatureTest, DigestIgnoresFile) {
+  const Signature x1(Signature(Signature("a.sv"), "m"), "x");
+  const Signature x2(Signature(Signature("b.sv"), "m"), "x");
+  EXPECT_EQ(x1.Digest(), x2.Digest());
+  EXPECT_EQ(x1.Digest().rolling_hash.size(), 3);
+  EXPECT_EQ(x1.Digest().rolling_hash[0], 0);
+  EXPECT_EQ(Signature(x1, "y").Digest().rolling_hash[2],
+            x1.Digest().rolling_hash[2]);
+  EXPECT_EQ(Signature("a.sv").Digest().rolling_hash, std::vector<size_t>{0});
+}
+
 TEST(VNameTest, DefaultCtor) {
   const VName vname;
   std::ostringstream stream;
@@ -14,11 +14,15 @@
 
 #include "verilog/tools/kythe/kythe_proto_output.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/gzip_stream.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
-#include "third_party/proto/kythe/storage.pb.h"
 #include "verilog/tools/kythe/kythe_facts.h"
 
 namespace verilog {
@@ -26,56 +30,123 @@ namespace kythe {
 namespace {
 
 using ::google::protobuf::io::CodedOutputStream;
-using ::google::protobuf::io::FileOutputStream;
-using ::kythe::proto::Entry;
-
-// Returns the VName representation in Kythe's storage proto format.
-::kythe::proto::VName ConvertVnameToProto(const VName &vname) {
-  ::kythe::proto::VName proto_vname;
-  *proto_vname.mutable_signature() = vname.signature.ToString();
-  *proto_vname.mutable_corpus() = std::string{vname.corpus};
-  *proto_vname.mutable_root() = std::string{vname.root};
-  *proto_vname.mutable_path() = std::string{vname.path};
-  *proto_vname.mutable_language() = std::string{vname.language};
-  return proto_vname;
-}
+using ::google::protobuf::io::GzipOutputStream;
+
+// Field numbers of kythe.proto.VName.
+constexpr uint32_t kVNameSignature = 1;
+constexpr uint32_t kVNameCorpus = 2;
+constexpr uint32_t kVNameRoot = 3;
+constexpr uint32_t kVNamePath = 4;
+constexpr uint32_t kVNameLanguage = 5;
+
+// Field numbers of kythe.proto.Entry.
+constexpr uint32_t kEntrySource = 1;
+constexpr uint32_t kEntryEdgeKind = 2;
+constexpr uint32_t kEntryTarget = 3;
+constexpr uint32_t kEntryFactName = 4;
+constexpr uint32_t kEntryFactValue = 5;
 
-// Returns the Fact representation in Kythe's storage proto format.
-Entry ConvertEdgeToEntry(const Edge &edge) {
-  Entry entry;
-  entry.set_fact_name("/");
-  *entry.mutable_edge_kind() = std::string{edge.edge_name};
-  *entry.mutable_source() = ConvertVnameToProto(edge.source_node);
-  *entry.mutable_target() = ConvertVnameToProto(edge.target_node);
-  return entry;
+constexpr uint32_t kWireTypeLengthDelimited = 2;
+
+void AppendVarint(uint64_t value, std::string *out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
 }
 
-// Returns the Fact representation in Kythe's storage proto format.
-Entry ConvertFactToEntry(const Fact &fact) {
-  Entry entry;
-  *entry.mutable_fact_name() = std::string{fact.fact_name};
-  *entry.mutable_fact_value() = fact.fact_value;
-  *entry.mutable_source() = ConvertVnameToProto(fact.node_vname);
-  return entry;
+// Appends a string, bytes or message field.
+void AppendLengthDelimited(uint32_t field, absl::string_view value,
+                           std::string *out) {
+  AppendVarint((field << 3) | kWireTypeLengthDelimited, out);
+  AppendVarint(value.size(), out);
+  out->append(value.data(), value.size());
 }
 
-// Output entry to the stream.
-void OutputProto(const Entry &entry, FileOutputStream *stream) {
-  CodedOutputStream coded_stream(stream);
-  coded_stream.WriteVarint32(entry.ByteSizeLong());
-  entry.SerializeToCodedStream(&coded_stream);
+// Like AppendLengthDelimited(), but proto3 leaves empty strings out.
+void AppendString(uint32_t field, absl::string_view value, std::string *out) {
+  if (!value.empty()) AppendLengthDelimited(field, value, out);
 }
 
 }  // namespace
 
-KytheProtoOutput::KytheProtoOutput(int fd) : out_(fd) {}
-KytheProtoOutput::~KytheProtoOutput() { out_.Close(); }
+absl::string_view KytheEntryEncoder::Encode(const Fact &fact) {
+  entry_.clear();
+  AppendVName(kEntrySource, fact.node_vname);
+  AppendString(kEntryFactName, fact.fact_name, &entry_);
+  AppendString(kEntryFactValue, fact.fact_value, &entry_);
+  return entry_;
+}
+
+absl::string_view KytheEntryEncoder::Encode(const Edge &edge) {
+  entry_.clear();
+  AppendVName(kEntrySource, edge.source_node);
+  AppendString(kEntryEdgeKind, edge.edge_name, &entry_);
+  AppendVName(kEntryTarget, edge.target_node);
+  AppendString(kEntryFactName, "/", &entry_);
+  return entry_;
+}
+
+void KytheEntryEncoder::AppendVName(uint32_t field, const VName &vname) {
+  signature_.clear();
+  vname.signature.AppendString(&signature_);
+  vname_.clear();
+  AppendString(kVNameSignature, signature_, &vname_);
+  const absl::string_view tail = EncodedVNameTail(vname);
+  vname_.append(tail.data(), tail.size());
+  AppendLengthDelimited(field, vname_, &entry_);
+}
+
+absl::string_view KytheEntryEncoder::EncodedVNameTail(const VName &vname) {
+  for (const VNameTail &tail : vname_tails_) {
+    if (tail.path == vname.path && tail.corpus == vname.corpus &&
+        tail.root == vname.root && tail.language == vname.language) {
+      return tail.encoded;
+    }
+  }
+  VNameTail &tail = vname_tails_[next_vname_tail_];
+  next_vname_tail_ = (next_vname_tail_ + 1) % kVNameTailCacheSize;
+  tail.corpus.assign(vname.corpus.data(), vname.corpus.size());
+  tail.root.assign(vname.root.data(), vname.root.size());
+  tail.path.assign(vname.path.data(), vname.path.size());
+  tail.language.assign(vname.language.data(), vname.language.size());
+  tail.encoded.clear();
+  AppendString(kVNameCorpus, vname.corpus, &tail.encoded);
+  AppendString(kVNameRoot, vname.root, &tail.encoded);
+  AppendString(kVNamePath, vname.path, &tail.encoded);
+  AppendString(kVNameLanguage, vname.language, &tail.encoded);
+  return tail.encoded;
+}
+
+KytheProtoOutput::KytheProtoOutput(int fd, int flush_size, bool compress)
+    : file_out_(fd, flush_size) {
+  ::google::protobuf::io::ZeroCopyOutputStream *out = &file_out_;
+  if (compress) {
+    GzipOutputStream::Options options;
+    options.buffer_size = flush_size;
+    gzip_out_ = std::make_unique<GzipOutputStream>(&file_out_, options);
+    out = gzip_out_.get();
+  }
+  coded_out_ = std::make_unique<CodedOutputStream>(out);
+}
+
+KytheProtoOutput::~KytheProtoOutput() {
+  coded_out_.reset();  // Returns its unused buffer to the stream.
+  if (gzip_out_) gzip_out_->Close();
+  file_out_.Close();
+}
 
 void KytheProtoOutput::Emit(const Fact &fact) {
-  OutputProto(ConvertFactToEntry(fact), &out_);
+  OutputEntry(encoder_.Encode(fact));
 }
 void KytheProtoOutput::Emit(const Edge &edge) {
-  OutputProto(ConvertEdgeToEntry(edge), &out_);
+  OutputEntry(encoder_.Encode(edge));
+}
+
+void KytheProtoOutput::OutputEntry(absl::string_view entry) {
+  coded_out_->WriteVarint32(entry.size());
+  coded_out_->WriteRaw(entry.data(), entry.size());
 }
 
 }  // namespace kythe
@@ -15,6 +15,15 @@
 #ifndef VERIBLE_VERILOG_TOOLS_KYTHE_KYTHE_PROTO_OUTPUT_H_
 #define VERIBLE_VERILOG_TOOLS_KYTHE_KYTHE_PROTO_OUTPUT_H_
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/gzip_stream.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "verilog/tools/kythe/kythe_facts.h"
 #include "verilog/tools/kythe/kythe_facts_extractor.h"
@@ -22,9 +31,50 @@
 namespace verilog {
 namespace kythe {
 
+// Encodes Kythe facts and edges in the protobuf wire format of
+// kythe.proto.Entry (third_party/proto/kythe/storage.proto), without building
+// proto messages.  The encoded corpus, root, path and language of recent
+// VNames are cached, as these are the same for most entries of a file.
+class KytheEntryEncoder {
+ public:
+  // Returns the encoded entry, valid until the next call.
+  absl::string_view Encode(const Fact &fact);
+  absl::string_view Encode(const Edge &edge);
+
+ private:
+  // Appends 'vname' as the message field 'field' of the entry.
+  void AppendVName(uint32_t field, const VName &vname);
+
+  // Returns the encoded VName fields after the signature.
+  absl::string_view EncodedVNameTail(const VName &vname);
+
+  struct VNameTail {
+    std::string corpus;
+    std::string root;
+    std::string path;
+    std::string language;
+    std::string encoded;
+  };
+  static constexpr size_t kVNameTailCacheSize = 4;
+  std::array<VNameTail, kVNameTailCacheSize> vname_tails_;
+  size_t next_vname_tail_ = 0;  // Slot to replace on a cache miss.
+
+  // Reused for all entries, to keep the allocated buffers.
+  std::string signature_;
+  std::string vname_;
+  std::string entry_;
+};
+
+// Writes Kythe entries in Kythe's delimited stream format: each entry is
+// prefixed by its size as a varint.
 class KytheProtoOutput final : public KytheOutput {
  public:
-  explicit KytheProtoOutput(int output_fd);
+  static constexpr int kDefaultFlushSize = 1 << 16;
+
+  // Entries are buffered, and written to 'output_fd' in batches of
+  // 'flush_size' bytes.  If 'compress', the stream is gzip-compressed.
+  explicit KytheProtoOutput(int output_fd, int flush_size = kDefaultFlushSize,
+                            bool compress = false);
   ~KytheProtoOutput() final;
 
   // Output Kythe facts from the indexing data in proto format.
@@ -32,7 +82,18 @@ class KytheProtoOutput final : public KytheOutput {
   void Emit(const Edge &edge) final;
 
  private:
-  ::google::protobuf::io::FileOutputStream out_;
+  // Writes an encoded entry to the stream.
+  void OutputEntry(absl::string_view entry);
+
+  ::google::protobuf::io::FileOutputStream file_out_;
+
+  // Compresses into file_out_, if enabled.
+  std::unique_ptr<::google::protobuf::io::GzipOutputStream> gzip_out_;
+
+  // Writes to gzip_out_ or file_out_.
+  std::unique_ptr<::google::protobuf::io::CodedOutputStream> coded_out_;
+
+  KytheEntryEncoder encoder_;
 };
 
 }  // namespace kythe
@@ -0,0 +1,103 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verilog/tools/kythe/kythe_proto_output.h"
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "third_party/proto/kythe/storage.pb.h"
+#include "verilog/tools/kythe/kythe_facts.h"
+
+namespace verilog {
+namespace kythe {
+namespace {
+
+::kythe::proto::Entry Parse(absl::string_view encoded) {
+  ::kythe::proto::Entry entry;
+  EXPECT_TRUE(entry.ParseFromArray(encoded.data(), encoded.size()));
+  return entry;
+}
+
+TEST(KytheEntryEncoderTest, Fact) {
+  KytheEntryEncoder encoder;
+  const VName vname{.path = "dir/file.sv",
+                    .root = "",
+                    .signature = Signature(Signature("m"), "x"),
+                    .corpus = "corpus"};
+  const ::kythe::proto::Entry entry =
+      Parse(encoder.Encode(Fact(vname, "/kythe/node/kind", "variable")));
+  EXPECT_EQ(entry.source().signature(), "m#x#");
+  EXPECT_EQ(entry.source().corpus(), "corpus");
+  EXPECT_EQ(entry.source().root(), "");
+  EXPECT_EQ(entry.source().path(), "dir/file.sv");
+  EXPECT_EQ(entry.source().language(), kDefaultKytheLanguage);
+  EXPECT_EQ(entry.fact_name(), "/kythe/node/kind");
+  EXPECT_EQ(entry.fact_value(), "variable");
+  EXPECT_FALSE(entry.has_target());
+  EXPECT_EQ(entry.edge_kind(), "");
+}
+
+TEST(KytheEntryEncoderTest, Edge) {
+  KytheEntryEncoder encoder;
+  const VName source{.path = "a.sv",
+                     .root = "",
+                     .signature = Signature("@1:2"),
+                     .corpus = "corpus",
+                     .language = ""};
+  const VName target{.path = "b.sv",
+                     .root = "root",
+                     .signature = Signature("m"),
+                     .corpus = "corpus"};
+  const ::kythe::proto::Entry entry =
+      Parse(encoder.Encode(Edge(source, "/kythe/edge/ref", target)));
+  EXPECT_EQ(entry.source().signature(), "@1:2#");
+  EXPECT_EQ(entry.source().path(), "a.sv");
+  EXPECT_EQ(entry.source().language(), "");
+  EXPECT_EQ(entry.edge_kind(), "/kythe/edge/ref");
+  EXPECT_EQ(entry.target().signature(), "m#");
+  EXPECT_EQ(entry.target().root(), "root");
+  EXPECT_EQ(entry.target().path(), "b.sv");
+  EXPECT_EQ(entry.fact_name(), "/");
+  EXPECT_EQ(entry.fact_value(), "");
+}
+
+TEST(KytheEntryEncoderTest, MatchesProtoSerialization) {
+  KytheEntryEncoder encoder;
+  // More paths than cached VName tails, each used a few times.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 6; ++i) {
+      const std::string path = "file" + std::to_string(i) + ".sv";
+      const VName vname{.path = path,
+                        .root = "",
+                        .signature = Signature(Signature(path), "x"),
+                        .corpus = "corpus"};
+      ::kythe::proto::Entry expected;
+      expected.mutable_source()->set_signature(vname.signature.ToString());
+      expected.mutable_source()->set_corpus("corpus");
+      expected.mutable_source()->set_path(path);
+      expected.mutable_source()->set_language(
+          std::string(kDefaultKytheLanguage));
+      expected.set_fact_name("/kythe/node/kind");
+      expected.set_fact_value("variable");
+      EXPECT_EQ(encoder.Encode(Fact(vname, "/kythe/node/kind", "variable")),
+                expected.SerializeAsString());
+    }
+  }
+}
+
+}  // namespace
+}  // namespace kythe
+}  // namespace verilog
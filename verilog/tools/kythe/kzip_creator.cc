@@ -46,12 +46,24 @@ KzipCreator::KzipCreator(absl::string_view output_path)
   archive_.AddFile(kProtoUnitRoot, verible::zip::MemoryByteSource(""));
 }
 
+KzipCreator::PreparedSourceFile KzipCreator::PrepareSourceFile(
+    absl::string_view content) {
+  return {verible::Sha256Hex(content),
+          verible::zip::Encoder::Compress(
+              kKZipCompressionLevel, verible::zip::MemoryByteSource(content))};
+}
+
 std::string KzipCreator::AddSourceFile(absl::string_view path,
                                        absl::string_view content) {
-  std::string digest = verible::Sha256Hex(content);
-  const std::string archive_path = verible::file::JoinPath(kFileRoot, digest);
-  archive_.AddFile(archive_path, verible::zip::MemoryByteSource(content));
-  return digest;
+  return AddPreparedSourceFile(PrepareSourceFile(content));
+}
+
+const std::string &KzipCreator::AddPreparedSourceFile(
+    const PreparedSourceFile &file) {
+  const std::string archive_path =
+      verible::file::JoinPath(kFileRoot, file.digest);
+  archive_.AddCompressedFile(archive_path, file.compressed);
+  return file.digest;
 }
 
 absl::Status KzipCreator::AddCompilationUnit(
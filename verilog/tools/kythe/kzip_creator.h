@@ -34,9 +34,22 @@ class KzipCreator final {
   // Initializes the archive. Crashes if initialization fails.
   explicit KzipCreator(absl::string_view output_path);
 
+  // A source file that is digested and compressed, ready to be added.
+  struct PreparedSourceFile {
+    std::string digest;
+    verible::zip::CompressedFile compressed;
+  };
+
+  // Digests and compresses the content of a source file.  This can run on
+  // any thread, while the files are added in order on one.
+  static PreparedSourceFile PrepareSourceFile(absl::string_view content);
+
   // Adds source code file to the Kzip. Returns its digest.
   std::string AddSourceFile(absl::string_view path, absl::string_view content);
 
+  // Adds a source file from PrepareSourceFile(). Returns its digest.
+  const std::string &AddPreparedSourceFile(const PreparedSourceFile &file);
+
   // Adds compilation unit to the Kzip.
   absl::Status AddCompilationUnit(
       const ::kythe::proto::IndexedCompilation &unit);
@@ -14,6 +14,7 @@
 
 #include "verilog/tools/kythe/scope_resolver.h"
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <vector>
@@ -40,33 +41,35 @@ void ScopeResolver::SetCurrentScope(const Signature &scope) {
 }
 
 void ScopeResolver::RemoveDefinitionFromCurrentScope(const VName &vname) {
-  absl::string_view name = vname.signature.Names().back();
-  auto scopes = variable_to_scoped_vname_.find(name);
+  auto scopes = variable_to_scoped_vname_.find(vname.signature.NameId());
   if (scopes == variable_to_scoped_vname_.end()) {
-    VLOG(1) << "No definition for '" << name << "'. Nothing to remove.";
+    VLOG(1) << "No definition for '" << vname.signature.Name()
+            << "'. Nothing to remove.";
     return;
   }
-  SignatureDigest current_scope_digest = CurrentScopeDigest();
-  VLOG(2) << "Remove " << name << " from " << ScopeDebug(current_scope_digest);
+  const SignatureDigest &current_scope_digest = CurrentScopeDigest();
+  VLOG(2) << "Remove " << vname.signature.Name() << " from "
+          << ScopeDebug(current_scope_digest);
+  std::optional<VName> removed;
   for (auto iter = scopes->second.begin(); iter != scopes->second.end();
        ++iter) {
     if (iter->instantiation_scope == current_scope_digest) {
+      removed = iter->vname;
       scopes->second.erase(iter);
       break;
     }
   }
+  // Members are only listed with their entry above, so there is nothing to
+  // search for otherwise, which is the common case of a new definition.
+  if (!removed) return;
 
   auto current_scope_names = scope_to_vnames_.find(current_scope_digest);
   if (current_scope_names == scope_to_vnames_.end()) {
     return;
   }
   auto &vnames = current_scope_names->second;
-  for (auto iter = vnames.begin(); iter != vnames.end(); ++iter) {
-    if (*iter == vname) {
-      vnames.erase(iter);
-      break;
-    }
-  }
+  const auto found = std::find(vnames.begin(), vnames.end(), *removed);
+  if (found != vnames.end()) vnames.erase(found);
 }
 
 void ScopeResolver::AppendScopeToCurrentScope(
@@ -77,28 +80,33 @@ void ScopeResolver::AppendScopeToCurrentScope(
 void ScopeResolver::AppendScopeToScope(
     const SignatureDigest &source_scope,
     const SignatureDigest &destination_scope) {
-  auto scope_vnames = scope_to_vnames_.find(source_scope);
-  if (scope_vnames == scope_to_vnames_.end()) {
-    VLOG(2) << "Can't find scope " << ScopeDebug(source_scope)
-            << " to append it to the current scope";
-    return;
-  }
   if (source_scope == destination_scope) {
     // The source and destination scope are equal. Nothing to add.
     return;
   }
+  if (!scope_to_vnames_.contains(source_scope)) {
+    VLOG(2) << "Can't find scope " << ScopeDebug(source_scope)
+            << " to append it to the current scope";
+    return;
+  }
+  // Create the destination first, so that adding it does not move the
+  // source's members while they are iterated.
+  std::vector<VName> &destination_vnames = scope_to_vnames_[destination_scope];
+  const std::vector<VName> &source_vnames = scope_to_vnames_[source_scope];
 
-  for (const auto &vn : scope_vnames->second) {
+  for (const auto &vn : source_vnames) {
     const std::optional<ScopedVname> vn_type =
-        FindScopeAndDefinition(vn.signature.Names().back(), source_scope);
+        FindScopeAndDefinition(vn.signature.NameId(), source_scope);
     if (!vn_type) {
       continue;
     }
-    variable_to_scoped_vname_[vn.signature.Names().back()].insert(
-        ScopedVname{.type_scope = vn_type->type_scope,
-                    .instantiation_scope = destination_scope,
-                    .vname = vn});
-    scope_to_vnames_[destination_scope].insert(vn);
+    const bool inserted =
+        variable_to_scoped_vname_[vn.signature.NameId()]
+            .insert(ScopedVname{.type_scope = vn_type->type_scope,
+                                .instantiation_scope = destination_scope,
+                                .vname = vn})
+            .second;
+    if (inserted) destination_vnames.push_back(vn);
   }
 }
 
@@ -112,33 +120,50 @@ void ScopeResolver::AddDefinitionToCurrentScope(
   // updated information about types.
   RemoveDefinitionFromCurrentScope(new_member);
 
-  auto current_scope_digest = CurrentScopeDigest();
-  variable_to_scoped_vname_[new_member.signature.Names().back()].insert(
-      ScopedVname{.type_scope = type_scope,
-                  .instantiation_scope = current_scope_digest,
-                  .vname = new_member});
-  scope_to_vnames_[current_scope_digest].insert(new_member);
+  const SignatureDigest &current_scope_digest = CurrentScopeDigest();
+  const bool inserted =
+      variable_to_scoped_vname_[new_member.signature.NameId()]
+          .insert(ScopedVname{.type_scope = type_scope,
+                              .instantiation_scope = current_scope_digest,
+                              .vname = new_member})
+          .second;
+  if (inserted) scope_to_vnames_[current_scope_digest].push_back(new_member);
 }
 
 std::optional<ScopedVname> ScopeResolver::FindScopeAndDefinition(
     absl::string_view name, const SignatureDigest &scope_focus) {
-  VLOG(2) << "Find definition for '" << name << "' within scope "
-          << ScopeDebug(scope_focus);
-  auto scope = variable_to_scoped_vname_.find(name);
-  if (scope == variable_to_scoped_vname_.end()) {
+  // Names that no signature was created with have no definition.
+  const std::optional<verible::IdentifierPool::Id> name_id =
+      Signature::FindNameId(name);
+  if (!name_id) {
     VLOG(2) << "Failed to find definition for '" << name << "' within scope "
             << ScopeDebug(scope_focus) << " (unregistered name)";
     return {};
   }
+  return FindScopeAndDefinition(*name_id, scope_focus);
+}
+
+std::optional<ScopedVname> ScopeResolver::FindScopeAndDefinition(
+    verible::IdentifierPool::Id name_id, const SignatureDigest &scope_focus) {
+  VLOG(2) << "Find definition for '" << Signature::NameOf(name_id)
+          << "' within scope " << ScopeDebug(scope_focus);
+  auto scope = variable_to_scoped_vname_.find(name_id);
+  if (scope == variable_to_scoped_vname_.end()) {
+    VLOG(2) << "Failed to find definition for '" << Signature::NameOf(name_id)
+            << "' within scope " << ScopeDebug(scope_focus)
+            << " (unregistered name)";
+    return {};
+  }
   const ScopedVname *match = nullptr;
   for (auto &scope_member : scope->second) {
-    SignatureDigest digest = scope_member.instantiation_scope;
+    const SignatureDigest &digest = scope_member.instantiation_scope;
     if (scope_focus.rolling_hash.size() < digest.rolling_hash.size() ||
         (match != nullptr &&
          digest.rolling_hash.size() <
              match->instantiation_scope.rolling_hash.size())) {
       // Mismatch, or not interesting (worse match).
-      VLOG(2) << "Scope resolution mismatch for '" << name << "' at scope "
+      VLOG(2) << "Scope resolution mismatch for '"
+              << Signature::NameOf(name_id) << "' at scope "
               << ScopeDebug(digest);
       continue;
     }
@@ -148,12 +173,12 @@ std::optional<ScopedVname> ScopeResolver::FindScopeAndDefinition(
     }
   }
   if (match != nullptr) {
-    VLOG(2) << "Found definition for '" << name << "' within scope "
-            << ScopeDebug(scope_focus);
+    VLOG(2) << "Found definition for '" << Signature::NameOf(name_id)
+            << "' within scope " << ScopeDebug(scope_focus);
     return *match;
   }
-  VLOG(2) << "Failed to find definition for '" << name << "' within scope "
-          << ScopeDebug(scope_focus);
+  VLOG(2) << "Failed to find definition for '" << Signature::NameOf(name_id)
+          << "' within scope " << ScopeDebug(scope_focus);
   return {};
 }
 
@@ -162,9 +187,9 @@ std::optional<ScopedVname> ScopeResolver::FindScopeAndDefinition(
   return FindScopeAndDefinition(name, CurrentScopeDigest());
 }
 
-const absl::flat_hash_set<VName> &ScopeResolver::ListScopeMembers(
+const std::vector<VName> &ScopeResolver::ListScopeMembers(
     const SignatureDigest &scope_digest) const {
-  const static absl::flat_hash_set<VName> kEmptyMemberList;
+  static const std::vector<VName> kEmptyMemberList;
   auto scope = scope_to_vnames_.find(scope_digest);
   if (scope == scope_to_vnames_.end()) {
     return kEmptyMemberList;
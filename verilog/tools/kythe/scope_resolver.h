@@ -18,11 +18,12 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/identifier_pool.h"
 #include "verilog/tools/kythe/kythe_facts.h"
 
 namespace verilog {
@@ -45,7 +46,7 @@ struct ScopedVname {
 template <typename H>
 H AbslHashValue(H state, const ScopedVname &v) {
   return H::combine(std::move(state), v.type_scope, v.instantiation_scope,
-                    v.vname.signature.Digest());
+                    v.vname.signature);
 }
 
 // ScopeResolver enables resolving a symbol to its definition (to make it
@@ -99,6 +100,10 @@ class ScopeResolver {
   std::optional<ScopedVname> FindScopeAndDefinition(
       absl::string_view name, const SignatureDigest &scope);
 
+  // Like above, for the name with the given id (see Signature::NameId()).
+  std::optional<ScopedVname> FindScopeAndDefinition(
+      verible::IdentifierPool::Id name_id, const SignatureDigest &scope);
+
   static SignatureDigest GlobalScope() { return Signature("").Digest(); }
 
   // Adds the members of the given scope to the current scope.
@@ -118,7 +123,8 @@ class ScopeResolver {
   // Adds a definition without external type to the current scope.
   void AddDefinitionToCurrentScope(const VName &new_member);
 
-  const absl::flat_hash_set<VName> &ListScopeMembers(
+  // Returns the members of the given scope, in the order they were added.
+  const std::vector<VName> &ListScopeMembers(
       const SignatureDigest &scope_digest) const;
 
   // Returns human readable description of the scope.
@@ -133,13 +139,15 @@ class ScopeResolver {
   void EnableDebug() { enable_debug_ = true; }
 
  private:
-  // Mapping from the symbol name to all scopes where it's present.
-  absl::flat_hash_map<std::string, absl::flat_hash_set<ScopedVname>>
+  // Mapping from the interned symbol name (see Signature::NameId()) to all
+  // scopes where it's present.
+  absl::flat_hash_map<verible::IdentifierPool::Id,
+                      absl::flat_hash_set<ScopedVname>>
       variable_to_scoped_vname_;
 
-  // Mapping from scope to all its members. NOTE: requires pointer stability!
-  absl::node_hash_map<SignatureDigest, absl::flat_hash_set<VName>>
-      scope_to_vnames_;
+  // Mapping from scope to all its members.  A member is listed once per
+  // scope, like its entry in variable_to_scoped_vname_.
+  absl::flat_hash_map<SignatureDigest, std::vector<VName>> scope_to_vnames_;
 
   // Maps the scope to the human readable description. Available only when debug
   // is enabled.
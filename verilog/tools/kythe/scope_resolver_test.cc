@@ -188,6 +188,27 @@ TEST(ScopeResolverTests, AppendScope) {
   EXPECT_TRUE(def_in_current_scope_post_appending.has_value());
 }
 
+TEST(ScopeResolverTests, MembersAreListedOnce) {
+  ScopeResolver scope_resolver(signatures[5]);
+  scope_resolver.AddDefinitionToCurrentScope(vnames[0]);
+  scope_resolver.AddDefinitionToCurrentScope(vnames[1]);
+  // Redefining replaces the member.
+  scope_resolver.AddDefinitionToCurrentScope(vnames[0]);
+  EXPECT_THAT(scope_resolver.ListScopeMembers(signatures[5].Digest()),
+              UnorderedElementsAreArray({vnames[0], vnames[1]}));
+
+  // Appending the same scope again adds nothing.
+  scope_resolver.AppendScopeToScope(signatures[5].Digest(),
+                                    signatures[0].Digest());
+  scope_resolver.AppendScopeToScope(signatures[5].Digest(),
+                                    signatures[0].Digest());
+  EXPECT_THAT(scope_resolver.ListScopeMembers(signatures[0].Digest()),
+              UnorderedElementsAreArray({vnames[0], vnames[1]}));
+
+  EXPECT_FALSE(scope_resolver.FindScopeAndDefinition("never-interned-name")
+                   .has_value());
+}
+
 }  // namespace
 }  // namespace kythe
 }  // namespace verilog
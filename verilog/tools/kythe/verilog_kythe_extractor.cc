@@ -12,9 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -22,12 +26,14 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/util/enum_flags.h"
+#include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/logging.h"
 #include "common/util/tree_operations.h"  // IWYU pragma: keep
 #include "verilog/analysis/verilog_filelist.h"
 #include "verilog/analysis/verilog_project.h"
 #include "verilog/tools/kythe/indexing_facts_tree.h"
+#include "verilog/tools/kythe/incremental_index.h"
 #include "verilog/tools/kythe/indexing_facts_tree_extractor.h"
 #include "verilog/tools/kythe/kythe_facts.h"
 #include "verilog/tools/kythe/kythe_facts_extractor.h"
@@ -109,63 +115,103 @@ if "A.sv" exists in both "directory1" and "directory2" the one in "directory1" i
 ABSL_FLAG(std::string, verilog_project_name, "",
           "Verilog project name to use as Kythe corpus. Optional");
 
+ABSL_FLAG(int, parse_threads, 0,
+          "Number of threads that parse files ahead of extraction. "
+          "0 parses on the main thread. The output does not depend on it.");
+
+ABSL_FLAG(std::string, index_state_file, "",
+          "If set, only emits the facts of translation units that changed "
+          "since the run that wrote this file, and of those that refer to "
+          "symbols whose definitions changed.  The file records digests of "
+          "the indexed files and is created or updated on every run.");
+
+ABSL_FLAG(int, proto_flush_size,
+          verilog::kythe::KytheProtoOutput::kDefaultFlushSize,
+          "With --print_kythe_facts=proto, the number of bytes of entries to "
+          "buffer before writing them out.");
+
+ABSL_FLAG(bool, proto_compress, false,
+          "With --print_kythe_facts=proto, compress the output with gzip.");
+
 namespace verilog {
 namespace kythe {
 
-// Prints Kythe facts in proto format to stdout.
-static void PrintKytheFactsProtoEntries(
-    const IndexingFactNode &file_list_facts_tree, const VerilogProject &project,
-    int fd) {
-  KytheProtoOutput proto_output(fd);
-  StreamKytheFactsEntries(&proto_output, file_list_facts_tree, project);
-}
-
 // Just collect the facts, but don't print anything. Mostly useful for
 // debugging error checking or performance.
-static void KytheFactsNullPrinter(const IndexingFactNode &file_list_facts_tree,
-                                  const VerilogProject &project) {
-  class NullPrinter final : public KytheOutput {
-   public:
-    void Emit(const Fact &fact) final {}
-    void Emit(const Edge &edge) final {}
-  } printer;
-  StreamKytheFactsEntries(&printer, file_list_facts_tree, project);
-}
+class KytheNullOutput final : public KytheOutput {
+ public:
+  void Emit(const Fact &fact) final {}
+  void Emit(const Edge &edge) final {}
+};
 
+// Extracts the indexing facts of the files and streams the Kythe facts of each
+// translation unit as soon as it is extracted.  If 'files_to_emit' is not
+// nullptr, only the facts of translation units with these resolved paths (and
+// of the files they include) are emitted.
 static std::vector<absl::Status> ExtractTranslationUnits(
     absl::string_view file_list_path, VerilogProject *project,
-    const std::vector<std::string> &file_names) {
-  std::vector<absl::Status> errors;
-  const verilog::kythe::IndexingFactNode file_list_facts_tree(
-      verilog::kythe::ExtractFiles(file_list_path, project, file_names,
-                                   &errors));
-
-  // check for printextraction flag, and print extraction if on
-  if (absl::GetFlag(FLAGS_printextraction)) {
-    // Don't use std::cout unless KytheFactsPrinter uses another stream.
-    LOG(INFO) << file_list_facts_tree << std::endl;
-  }
-
-  // check how to output kythe facts.
-  switch (absl::GetFlag(FLAGS_print_kythe_facts)) {
+    const std::vector<std::string> &file_names,
+    const std::set<std::string> *files_to_emit) {
+  const PrintMode print_mode = absl::GetFlag(FLAGS_print_kythe_facts);
+  std::unique_ptr<KytheOutput> kythe_output;
+  switch (print_mode) {
     case PrintMode::kJSON:
-      std::cout << KytheFactsPrinter(file_list_facts_tree, *project)
-                << std::endl;
+      kythe_output = std::make_unique<KytheJsonOutput>(std::cout, false);
       break;
     case PrintMode::kJSONDebug:
-      std::cout << KytheFactsPrinter(file_list_facts_tree, *project,
-                                     /*debug=*/true)
-                << std::endl;
+      std::cout << "[";
+      kythe_output = std::make_unique<KytheJsonOutput>(std::cout, true);
       break;
     case PrintMode::kProto:
-      PrintKytheFactsProtoEntries(file_list_facts_tree, *project,
-                                  STDOUT_FILENO);
+      kythe_output = std::make_unique<KytheProtoOutput>(
+          STDOUT_FILENO, absl::GetFlag(FLAGS_proto_flush_size),
+          absl::GetFlag(FLAGS_proto_compress));
       break;
     case PrintMode::kNone:
-      KytheFactsNullPrinter(file_list_facts_tree, *project);
+      kythe_output = std::make_unique<KytheNullOutput>();
       break;
   }
 
+  std::vector<absl::Status> errors;
+  KytheFactsStream kythe_facts(kythe_output.get(), *project);
+  const IndexingFactNode file_list_facts_tree(ExtractFiles(
+      file_list_path, project, file_names, absl::GetFlag(FLAGS_parse_threads),
+      [&kythe_facts, files_to_emit](const IndexingFactNode &file_list,
+                                    size_t first_new_file) {
+        const auto &files = file_list.Children();
+        // The translation unit comes after the files it includes.
+        const bool emit =
+            files_to_emit == nullptr ||
+            files_to_emit->count(std::string(
+                files.back().Value().Anchors()[0].Text())) > 0;
+        for (size_t i = first_new_file; i < files.size(); ++i) {
+          if (emit) {
+            kythe_facts.ExtractFile(files[i]);
+          } else {
+            kythe_facts.ResolveFile(files[i]);
+          }
+        }
+      },
+      /*keep_extracted_files=*/absl::GetFlag(FLAGS_printextraction), &errors));
+  kythe_output.reset();  // Flush.
+
+  switch (print_mode) {
+    case PrintMode::kJSON:
+      std::cout << std::endl;
+      break;
+    case PrintMode::kJSONDebug:
+      std::cout << "]" << std::endl << std::endl;
+      break;
+    default:
+      break;
+  }
+
+  // check for printextraction flag, and print extraction if on
+  if (absl::GetFlag(FLAGS_printextraction)) {
+    // Don't use std::cout unless KytheFactsPrinter uses another stream.
+    LOG(INFO) << file_list_facts_tree << std::endl;
+  }
+
   return errors;
 }
 
@@ -211,9 +257,46 @@ Output: Produces Indexing Facts for kythe (http://kythe.io).
                                   absl::GetFlag(FLAGS_verilog_project_name),
                                   /*provide_lookup_file_origin=*/false);
 
+  // With an index state, only what changed since the last run is indexed.
+  const std::string index_state_file = absl::GetFlag(FLAGS_index_state_file);
+  std::vector<std::string> files_to_extract = file_paths;
+  std::set<std::string> files_to_emit;
+  verilog::kythe::KytheIndexState index_state;
+  if (!index_state_file.empty()) {
+    auto previous_state =
+        verilog::kythe::KytheIndexState::Load(index_state_file);
+    if (!previous_state.ok()) {
+      LOG(WARNING) << "Indexing everything, can't use previous index state: "
+                   << previous_state.status();
+      previous_state = verilog::kythe::KytheIndexState();
+    }
+    // Separate project, as file origin lookup is needed for dependencies.
+    verilog::VerilogProject state_project(
+        file_list_root, include_dir_paths,
+        absl::GetFlag(FLAGS_verilog_project_name),
+        /*provide_lookup_file_origin=*/true);
+    // Files that can't be opened are reported by the extraction.
+    std::vector<absl::Status> state_errors;
+    index_state = verilog::kythe::ComputeIndexState(
+        &state_project, file_paths, *previous_state, &state_errors);
+    verilog::kythe::IncrementalIndexPlan plan =
+        verilog::kythe::PlanIncrementalIndex(file_paths, *previous_state,
+                                             index_state);
+    LOG(INFO) << "Indexing " << plan.files_to_emit.size() << " of "
+              << index_state.translation_units.size()
+              << " translation units, extracting "
+              << plan.files_to_extract.size();
+    files_to_extract = std::move(plan.files_to_extract);
+    for (const std::string &name : plan.files_to_emit) {
+      files_to_emit.insert(
+          verible::file::JoinPath(project.TranslationUnitRoot(), name));
+    }
+  }
+
   const std::vector<absl::Status> errors(
-      verilog::kythe::ExtractTranslationUnits(file_list_path, &project,
-                                              file_paths));
+      verilog::kythe::ExtractTranslationUnits(
+          file_list_path, &project, files_to_extract,
+          index_state_file.empty() ? nullptr : &files_to_emit));
   if (!errors.empty()) {
     LOG(ERROR) << "Encountered some issues while indexing files (could result "
                   "in missing indexing data):"
@@ -225,5 +308,11 @@ Output: Produces Indexing Facts for kythe (http://kythe.io).
     // (bool) --index_files_fatal.  This can signal to user/caller that
     // something went wrong, and surface errors.
   }
+  if (!index_state_file.empty()) {
+    if (auto status = index_state.Save(index_state_file); !status.ok()) {
+      LOG(ERROR) << "Can't write index state: " << status;
+      return 1;
+    }
+  }
   return 0;
 }
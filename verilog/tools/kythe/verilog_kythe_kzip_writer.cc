@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <deque>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -22,6 +25,7 @@
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/logging.h"
+#include "common/util/thread_pool.h"
 #include "third_party/proto/kythe/analysis.pb.h"
 #include "verilog/analysis/verilog_filelist.h"
 #include "verilog/tools/kythe/kzip_creator.h"
@@ -38,6 +42,10 @@ ABSL_FLAG(std::string, corpus, "",
 
 ABSL_FLAG(std::string, output_path, "", "Path where to write the kzip.");
 
+ABSL_FLAG(int, threads, 0,
+          "Number of threads that read, digest and compress the source files. "
+          "0 does it on the main thread. The kzip does not depend on it.");
+
 ABSL_RETIRED_FLAG(
     std::string, filelist_root, ".",
     "The absolute location which we prepend to the files in the file "
@@ -108,14 +116,35 @@ Output: Produces Kythe KZip (https://kythe.io/docs/kythe-kzip.html).
   auto *filelist_input = unit->add_required_input();
   *filelist_input->mutable_info()->mutable_path() = "filelist";
   *filelist_input->mutable_info()->mutable_digest() = filelist_digest;
+
+  // Files are prepared concurrently, a few per thread ahead of the one that
+  // is added, and added in order.
+  using PreparedSourceFile = verilog::kythe::KzipCreator::PreparedSourceFile;
+  const int threads = absl::GetFlag(FLAGS_threads);
+  const size_t prepare_ahead = std::max(1, 4 * threads);
+  verible::ThreadPool pool(threads);
+  std::deque<std::future<absl::StatusOr<PreparedSourceFile>>> prepared;
+  size_t next_to_prepare = 0;
   for (const std::string &file_path : file_paths) {
-    auto content_or = verible::file::GetContentAsString(file_path);
-    if (!content_or.ok()) {
+    for (; next_to_prepare < file_paths.size() &&
+           prepared.size() < prepare_ahead;
+         ++next_to_prepare) {
+      const std::string &path = file_paths[next_to_prepare];
+      prepared.push_back(pool.ExecAsync<absl::StatusOr<PreparedSourceFile>>(
+          [&path]() -> absl::StatusOr<PreparedSourceFile> {
+            auto content_or = verible::file::GetContentAsString(path);
+            if (!content_or.ok()) return content_or.status();
+            return verilog::kythe::KzipCreator::PrepareSourceFile(*content_or);
+          }));
+    }
+    const absl::StatusOr<PreparedSourceFile> file_or = prepared.front().get();
+    prepared.pop_front();
+    if (!file_or.ok()) {
       LOG(ERROR) << "Failed to open " << file_path
-                 << ". Error: " << content_or.status();
+                 << ". Error: " << file_or.status();
       continue;
     }
-    const std::string digest = kzip.AddSourceFile(file_path, *content_or);
+    const std::string &digest = kzip.AddPreparedSourceFile(*file_or);
     auto *file_input = unit->add_required_input();
     *file_input->mutable_info()->mutable_path() = file_path;
     *file_input->mutable_info()->mutable_digest() = digest;
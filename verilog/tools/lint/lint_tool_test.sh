@@ -230,6 +230,30 @@ status="$?"
   exit 1
 }
 
+################################################################################
+echo "=== Test --jobs reports files in input order"
+
+TEST_FILE_A="${TEST_TMPDIR}/lint-error-a.sv"
+TEST_FILE_B="${TEST_TMPDIR}/lint-error-b.sv"
+cp "${TEST_FILE}" "${TEST_FILE_A}"
+cp "${TEST_FILE}" "${TEST_FILE_B}"
+
+"$lint_tool" --rules=no-tabs "$TEST_FILE_A" "$TEST_FILE_B" > /dev/null \
+    2> "${MY_OUTPUT_FILE}.serial"
+"$lint_tool" --rules=no-tabs --jobs=4 "$TEST_FILE_A" "$TEST_FILE_B" > /dev/null \
+    2> "${MY_OUTPUT_FILE}.parallel"
+
+status="$?"
+[[ $status == 1 ]] || {
+  echo "Expected exit code 1, but got $status"
+  exit 1
+}
+
+diff "${MY_OUTPUT_FILE}.serial" "${MY_OUTPUT_FILE}.parallel" || {
+  echo "Expected identical serial and parallel output."
+  exit 1
+}
+
 ################################################################################
 echo "=== Test module filename rule for stdin"
 
@@ -499,6 +523,34 @@ check_diff "${REFERENCE_TEST_FILE_3}" "${TEST_FILE_3}" "${DIFF_FILE_3}" \
 
 (( $failure )) && exit 1
 
+################################################################################
+echo "=== Test --autofix=inplace --jobs=3 (multiple source files)"
+
+# using the same files as above
+
+cp "${ORIGINAL_TEST_FILE}"   "${TEST_FILE}"
+cp "${ORIGINAL_TEST_FILE_2}" "${TEST_FILE_2}"
+cp "${ORIGINAL_TEST_FILE_3}" "${TEST_FILE_3}"
+
+"$lint_tool" --ruleset=none --rules_config="${RULES_CONFIG_FILE}" --autofix=inplace \
+    --jobs=3 "${TEST_FILE}" "${TEST_FILE_2}" "${TEST_FILE_3}" > /dev/null 2>&1
+
+failure=0
+
+check_diff "${REFERENCE_TEST_FILE}" "${TEST_FILE}" "${DIFF_FILE}" \
+    "${FILES_DIFFER_ERR_MESSAGE}"
+(( failure|="$?" ))
+
+check_diff "${REFERENCE_TEST_FILE_2}" "${TEST_FILE_2}" "${DIFF_FILE_2}" \
+    "${FILES_DIFFER_ERR_MESSAGE}"
+(( failure|="$?" ))
+
+check_diff "${REFERENCE_TEST_FILE_3}" "${TEST_FILE_3}" "${DIFF_FILE_3}" \
+    "${FILES_DIFFER_ERR_MESSAGE}"
+(( failure|="$?" ))
+
+(( $failure )) && exit 1
+
 ################################################################################
 echo "=== Test --autofix=no --autofix_output_file=somefilename"
 
@@ -1075,4 +1127,69 @@ check_diff "${REFERENCE_ALT_AUTO_FIX_2}" "${TEST_FILE}" "${DIFF_FILE}" \
 
 (( $failure )) && exit 1
 
+################################################################################
+echo "=== Test --persistent_worker"
+
+WORKER_REPORT="${TEST_TMPDIR}/worker-report.txt"
+WORKER_PARAMS="${TEST_TMPDIR}/worker-params.txt"
+TAB=$'\t'
+cat >"${TEST_FILE}" <<EOF
+module tabs;
+${TAB}logic a;
+endmodule
+EOF
+printf -- "--report=%s\n%s\n" "${WORKER_REPORT}" "${TEST_FILE}" \
+  > "${WORKER_PARAMS}"
+
+"$lint_tool" --ruleset=none --rules=no-tabs --persistent_worker \
+  > "$MY_OUTPUT_FILE" <<EOF
+{"arguments": ["@${WORKER_PARAMS}"], "requestId": 3}
+{"arguments": ["${TEST_FILE}"], "requestId": 4}
+EOF
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "Expected exit code 0, but got $status"
+  exit 1
+}
+
+# One response per request, in a line each.
+[[ "$(grep -c "" "$MY_OUTPUT_FILE")" == 2 ]] || {
+  echo "Expected two work responses. Got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+grep -q '"exitCode":1,"output":"","requestId":3' "$MY_OUTPUT_FILE" || {
+  echo "Expected a failed response with the output in the report. Got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+grep -q '"exitCode":1,"output":".*no-tabs.*","requestId":4' \
+  "$MY_OUTPUT_FILE" || {
+  echo "Expected a failed response with the output inline. Got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+grep -q "no-tabs" "${WORKER_REPORT}" || {
+  echo "Expected no-tabs violation in ${WORKER_REPORT}. Got:"
+  cat "${WORKER_REPORT}"
+  exit 1
+}
+
+# Without a worker, Bazel passes the parameter file on the command line.
+rm "${WORKER_REPORT}"
+"$lint_tool" --ruleset=none --rules=no-tabs "@${WORKER_PARAMS}" \
+  > /dev/null 2>&1
+
+status="$?"
+[[ $status == 1 ]] || {
+  echo "Expected exit code 1, but got $status"
+  exit 1
+}
+grep -q "no-tabs" "${WORKER_REPORT}" || {
+  echo "Expected no-tabs violation in ${WORKER_REPORT}. Got:"
+  cat "${WORKER_REPORT}"
+  exit 1
+}
+
 echo "PASS"
@@ -19,25 +19,39 @@
 // verilog_lint files...
 
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <sstream>  // IWYU pragma: keep  // for ostringstream
 #include <string>   // for string, allocator, etc
+#include <system_error>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "common/analysis/lint_rule_profile.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/analysis/violation_handler.h"
 #include "common/util/enum_flags.h"
+#include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
-#include "common/util/iterator_range.h"
 #include "common/util/logging.h"  // for operator<<, LOG, LogMessage, etc
+#include "common/util/thread_pool.h"
+#include "verilog/analysis/verilog_lint_cache.h"
+#include "verilog/analysis/verilog_lint_shard.h"
 #include "verilog/analysis/verilog_linter.h"
 #include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/analysis/verilog_variant_linter.h"
+#include "nlohmann/json.hpp"
 
 // From least to most disruptive
 enum class AutofixMode {
@@ -76,6 +90,37 @@ bool AbslParseFlag(absl::string_view text, AutofixMode *mode,
   return AutofixModeEnumStringMap().Parse(text, mode, error, "--autofix value");
 }
 
+enum class OutputFormat {
+  kText,       // One human-readable message per line
+  kJsonLines,  // One JSON object per line
+  kSarif,      // One SARIF log for all files
+};
+
+static const verible::EnumNameMap<OutputFormat> &OutputFormatEnumStringMap() {
+  static const verible::EnumNameMap<OutputFormat> kOutputFormatEnumStringMap({
+      {"text", OutputFormat::kText},
+      {"jsonl", OutputFormat::kJsonLines},
+      {"sarif", OutputFormat::kSarif},
+  });
+  return kOutputFormatEnumStringMap;
+}
+
+std::ostream &operator<<(std::ostream &stream, OutputFormat format) {
+  return OutputFormatEnumStringMap().Unparse(format, stream);
+}
+
+std::string AbslUnparseFlag(const OutputFormat &format) {
+  std::ostringstream stream;
+  OutputFormatEnumStringMap().Unparse(format, stream);
+  return stream.str();
+}
+
+bool AbslParseFlag(absl::string_view text, OutputFormat *format,
+                   std::string *error) {
+  return OutputFormatEnumStringMap().Parse(text, format, error,
+                                           "--output_format value");
+}
+
 // LINT.IfChange
 
 ABSL_FLAG(bool, check_syntax, true,
@@ -108,17 +153,358 @@ ABSL_FLAG(std::string, autofix_output_file, "",
           "File to write a patch with autofixes to if "
           "--autofix=patch or --autofix=patch-interactive "
           "or a waiver file if --autofix=generate-waiver");
+ABSL_FLAG(int, jobs, 1,
+          "Number of files to lint in parallel. Output is still reported in "
+          "the order of the input files. Autofix modes other than 'no' and "
+          "'inplace' always run serially.");
+ABSL_FLAG(bool, lint_variants, false,
+          "If true, lints every `ifdef/`ifndef configuration of each file, "
+          "as one variant per configuration. Each violation is reported once, "
+          "with the configurations it is found in. Variants of a file are "
+          "linted on --jobs threads, files one after the other.");
+ABSL_FLAG(int, max_variants, 64,
+          "Maximum number of variants of a file linted with --lint_variants.");
+ABSL_FLAG(bool, profile_rules, false,
+          "If true, measures the time, number of invocations and number of "
+          "violations of each lint rule across all files, and prints them "
+          "to stderr at the end, with a summary of the slowest rules.");
+ABSL_FLAG(int, profile_rules_top, 10,
+          "Number of the slowest rules summarized by --profile_rules.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If set, directory to cache lint results in, keyed by file contents, "
+          "lint configuration and tool version, so that unchanged files are "
+          "reported without analyzing them again. Not used with "
+          "--lint_variants.");
+ABSL_FLAG(int64_t, cache_max_mb, 256,
+          "Maximum size of the --cache_dir in megabytes; the least recently "
+          "used entries are removed beyond that.");
+
+ABSL_FLAG(OutputFormat, output_format, OutputFormat::kText,
+          "Format of the lint violations written to stderr with --autofix=no; "
+          "one of [text|jsonl|sarif]. 'jsonl' writes one JSON object per "
+          "violation and line, 'sarif' one SARIF 2.1.0 log for all files "
+          "after linting them serially.");
+
+ABSL_FLAG(int, shard_count, 1,
+          "Number of shards that the files are split into, by file size, to "
+          "lint them in separate runs, e.g. on separate machines. Each run "
+          "gets all files and lints those of its --shard_index.");
+ABSL_FLAG(int, shard_index, 0, "Shard to lint, in [0, --shard_count).");
+ABSL_FLAG(std::string, shard_output, "",
+          "If set, the results of the shard are written to this file instead "
+          "of being reported, to be reported together with the other shards' "
+          "by 'verible-verilog-lint merge <shard_output>...'.");
 
 // LINT.ThenChange(README.md)
+ABSL_FLAG(bool, persistent_worker, false,
+          "If true, run as a Bazel persistent worker: read JSON work requests "
+          "from stdin until EOF, and lint the files that each request's "
+          "arguments name with the flags given at startup, writing one JSON "
+          "work response per request to stdout. An argument "
+          "'--report=<file>' writes the request's output to <file>. "
+          "Arguments '@<file>' read further arguments from <file>, one per "
+          "line, also when not running as a worker.");
 
 using verilog::LinterConfiguration;
 
 // LintOneFile returns 0, 1, or 2
 static const int kAutofixErrorExitStatus = 3;
 
+// Returns the lint result cache in --cache_dir, or nullptr if that flag is
+// not set.
+static verilog::VerilogLintCache *LintCacheFromFlags() {
+  static verilog::VerilogLintCache *const cache =
+      []() -> verilog::VerilogLintCache * {
+    const std::string directory = absl::GetFlag(FLAGS_cache_dir);
+    if (directory.empty()) return nullptr;
+    return new verilog::VerilogLintCache(
+        directory, absl::GetFlag(FLAGS_cache_max_mb) * 1024 * 1024,
+        verible::GetRepositoryVersion());
+  }();
+  return cache;
+}
+
+// Returns the handler printing violations to "stream" in --output_format.
+static std::unique_ptr<verible::ViolationHandler> ViolationPrinterFromFlags(
+    std::ostream *stream) {
+  switch (absl::GetFlag(FLAGS_output_format)) {
+    case OutputFormat::kJsonLines:
+      return std::make_unique<verible::ViolationJsonLinesPrinter>(stream);
+    case OutputFormat::kSarif:
+      return std::make_unique<verible::ViolationSarifPrinter>(
+          stream, "verible-verilog-lint");
+    case OutputFormat::kText:
+      break;
+  }
+  return std::make_unique<verible::ViolationPrinter>(stream);
+}
+
+// Lints one file with the configuration that applies to it.
+// Syntax errors are written to "stream", configuration errors to
+// "error_stream" and lint violations are passed to "violation_handler".
+static int LintFileFromFlags(std::ostream *stream, std::ostream *error_stream,
+                             absl::string_view filename,
+                             verible::ViolationHandler *violation_handler) {
+  // Copy configuration, so that it can be locally modified per file.
+  auto config_status = verilog::LinterConfigurationFromFlags(filename);
+  if (!config_status.ok()) {
+    *error_stream << config_status.status().message() << std::endl;
+    return 1;
+  }
+  const LinterConfiguration &config = *config_status;
+
+  if (absl::GetFlag(FLAGS_lint_variants)) {
+    return verilog::LintAllVariantsOfFile(
+        stream, filename, config, violation_handler,
+        absl::GetFlag(FLAGS_check_syntax), absl::GetFlag(FLAGS_parse_fatal),
+        absl::GetFlag(FLAGS_lint_fatal), absl::GetFlag(FLAGS_jobs),
+        absl::GetFlag(FLAGS_max_variants),
+        absl::GetFlag(FLAGS_show_diagnostic_context));
+  }
+  return verilog::LintOneFile(
+      stream, filename, config, violation_handler,
+      absl::GetFlag(FLAGS_check_syntax), absl::GetFlag(FLAGS_parse_fatal),
+      absl::GetFlag(FLAGS_lint_fatal),
+      absl::GetFlag(FLAGS_show_diagnostic_context), LintCacheFromFlags());
+}
+
+// Result of linting one file on a worker thread: everything that would
+// have been printed is buffered until it is that file's turn to report.
+struct BufferedLintResult {
+  int exit_status = 0;
+  std::string output;  // destined for stdout
+  std::string errors;  // destined for stderr
+};
+
+// Creates the violation handler of one file, writing to the given stream.
+using ViolationHandlerFactory =
+    std::function<std::unique_ptr<verible::ViolationHandler>(std::ostream *)>;
+
+// Lints "files" on "jobs" threads, printing the results in input order.
+// Each file gets its own handler from "handler_factory", so this is only
+// used with handlers that keep no state between files: the printers, and
+// the batch fixer of --autofix=inplace.  The interactive fixers and
+// --output_format=sarif, which collects the violations of all files into one
+// log, always run serially.
+static int LintFilesInParallel(const std::vector<absl::string_view> &files,
+                               int jobs, std::ostream *stream,
+                               std::ostream *error_stream,
+                               const ViolationHandlerFactory &handler_factory =
+                                   ViolationPrinterFromFlags) {
+  verible::ThreadPool pool(jobs);
+  std::vector<std::future<BufferedLintResult>> results;
+  results.reserve(files.size());
+  for (const absl::string_view filename : files) {
+    results.push_back(
+        pool.ExecAsync<BufferedLintResult>([filename, &handler_factory]() {
+          std::ostringstream output;
+          std::ostringstream errors;
+          const std::unique_ptr<verible::ViolationHandler> violation_handler =
+              handler_factory(&errors);
+          BufferedLintResult result;
+          result.exit_status = LintFileFromFlags(&output, &errors, filename,
+                                                 violation_handler.get());
+          result.output = output.str();
+          result.errors = errors.str();
+          return result;
+        }));
+  }
+
+  int exit_status = 0;
+  for (auto &future_result : results) {
+    const BufferedLintResult result = future_result.get();
+    *stream << result.output << std::flush;
+    *error_stream << result.errors << std::flush;
+    exit_status = std::max(result.exit_status, exit_status);
+  }
+  return exit_status;
+}
+
+// Lints "files", which are at "file_indices" in the list of all "file_count"
+// files, as shard "shard_index" of "shard_count", and writes the shard's
+// result file to "shard_output".  Returns the exit status.
+static int LintShardToFile(const std::vector<absl::string_view> &files,
+                           const std::vector<int64_t> &file_indices,
+                           int shard_index, int shard_count,
+                           int64_t file_count,
+                           const std::string &shard_output) {
+  const auto lint_entry = [](absl::string_view filename, int64_t index) {
+    std::ostringstream output;
+    std::ostringstream errors;
+    verilog::LintShardRecorder recorder;
+    verilog::LintShardEntry entry;
+    entry.index = index;
+    entry.filename = std::string(filename);
+    entry.exit_status =
+        LintFileFromFlags(&output, &errors, filename, &recorder);
+    entry.output = output.str();
+    entry.errors = errors.str();
+    recorder.TakeViolations(&entry);
+    return entry;
+  };
+
+  verilog::LintShard shard;
+  shard.shard_index = shard_index;
+  shard.shard_count = shard_count;
+  shard.file_count = file_count;
+  shard.tool_version = verible::GetRepositoryVersion();
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  if (jobs > 1 && !absl::GetFlag(FLAGS_lint_variants)) {
+    verible::ThreadPool pool(jobs);
+    std::vector<std::future<verilog::LintShardEntry>> entries;
+    entries.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+      entries.push_back(pool.ExecAsync<verilog::LintShardEntry>(
+          [&, i]() { return lint_entry(files[i], file_indices[i]); }));
+    }
+    for (auto &entry : entries) shard.entries.push_back(entry.get());
+  } else {
+    for (size_t i = 0; i < files.size(); ++i) {
+      shard.entries.push_back(lint_entry(files[i], file_indices[i]));
+    }
+  }
+
+  int exit_status = 0;
+  for (const verilog::LintShardEntry &entry : shard.entries) {
+    exit_status = std::max(entry.exit_status, exit_status);
+  }
+  if (auto status = verible::file::SetContents(
+          shard_output, verilog::SerializeLintShard(shard));
+      !status.ok()) {
+    std::cerr << shard_output << ": " << status.message() << std::endl;
+    return 2;
+  }
+  return exit_status;
+}
+
+// Reports the results of all shards of a run, read from "shard_files", as
+// linting all files at once would have with "violation_handler".
+static int MergeShardFiles(const std::vector<absl::string_view> &shard_files,
+                           verible::ViolationHandler *violation_handler) {
+  std::vector<verilog::LintShard> shards;
+  for (const absl::string_view shard_file : shard_files) {
+    absl::StatusOr<std::string> content =
+        verible::file::GetContentAsString(shard_file);
+    absl::StatusOr<verilog::LintShard> shard =
+        content.ok() ? verilog::ParseLintShard(*content) : content.status();
+    if (!shard.ok()) {
+      std::cerr << shard_file << ": " << shard.status().message() << std::endl;
+      return 2;
+    }
+    shards.push_back(*std::move(shard));
+  }
+  const absl::StatusOr<int> exit_status = verilog::MergeLintShards(
+      shards, &std::cout, &std::cerr, violation_handler);
+  if (!exit_status.ok()) {
+    std::cerr << exit_status.status().message() << std::endl;
+    return 2;
+  }
+  return *exit_status;
+}
+
+// Lints the files of a request, which "arguments" name along with an
+// optional "--report=<file>" that redirects all output to <file>.  Without
+// one, everything is written to "stream".  Returns the exit status.
+static int LintRequest(const std::vector<std::string> &arguments,
+                       std::ostream *stream) {
+  std::string report_file;
+  std::vector<absl::string_view> files;
+  for (const std::string &argument : arguments) {
+    if (absl::StartsWith(argument, "--report=")) {
+      report_file = argument.substr(absl::string_view("--report=").size());
+    } else {
+      files.push_back(argument);
+    }
+  }
+
+  std::ostringstream report;
+  std::ostream *const output = report_file.empty() ? stream : &report;
+  int exit_status = 0;
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  if (jobs > 1 && absl::GetFlag(FLAGS_output_format) != OutputFormat::kSarif &&
+      !absl::GetFlag(FLAGS_lint_variants)) {
+    exit_status = LintFilesInParallel(files, jobs, output, output);
+  } else {
+    const std::unique_ptr<verible::ViolationHandler> violation_printer =
+        ViolationPrinterFromFlags(output);
+    for (const absl::string_view filename : files) {
+      exit_status = std::max(
+          LintFileFromFlags(output, output, filename, violation_printer.get()),
+          exit_status);
+    }
+    violation_printer->Finish();
+  }
+
+  if (!report_file.empty()) {
+    if (auto status = verible::file::SetContents(report_file, report.str());
+        !status.ok()) {
+      *stream << status.message() << std::endl;
+      return 2;
+    }
+  }
+  return exit_status;
+}
+
+// Appends "argument" to "arguments", or if it is '@<file>', the lines of
+// <file>.
+static absl::Status ExpandArgument(absl::string_view argument,
+                                   std::vector<std::string> *arguments) {
+  if (!absl::StartsWith(argument, "@")) {
+    arguments->emplace_back(argument);
+    return absl::OkStatus();
+  }
+  absl::StatusOr<std::string> content_or =
+      verible::file::GetContentAsString(argument.substr(1));
+  if (!content_or.ok()) return content_or.status();
+  for (absl::string_view line : absl::StrSplit(*content_or, '\n')) {
+    if (!line.empty()) arguments->emplace_back(line);
+  }
+  return absl::OkStatus();
+}
+
+// Serves Bazel persistent worker requests in the JSON protocol, one request
+// and response per line, until stdin is closed.  The linter and its rule
+// registry stay initialized across requests.
+static int RunPersistentWorker() {
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (line.empty()) continue;
+    const nlohmann::json request =
+        nlohmann::json::parse(line, nullptr, /*allow_exceptions=*/false);
+    if (!request.is_object()) {
+      std::cerr << "Invalid work request: " << line << std::endl;
+      return 1;
+    }
+    std::ostringstream output;
+    int exit_code = 0;
+    std::vector<std::string> arguments;
+    for (const auto &argument :
+         request.value("arguments", nlohmann::json::array())) {
+      if (!argument.is_string()) continue;
+      if (auto status = ExpandArgument(argument.get<std::string>(), &arguments);
+          !status.ok()) {
+        output << status.message() << std::endl;
+        exit_code = 2;
+      }
+    }
+    if (exit_code == 0) exit_code = LintRequest(arguments, &output);
+    const nlohmann::json response = {
+        {"exitCode", exit_code},
+        {"output", output.str()},
+        {"requestId", request.value("requestId", 0)},
+    };
+    // Diagnostic context lines quote the files, which need not be UTF-8.
+    std::cout << response.dump(-1, ' ', false,
+                               nlohmann::json::error_handler_t::replace)
+              << std::endl;
+  }
+  return 0;
+}
+
 int main(int argc, char **argv) {
   const auto usage =
-      absl::StrCat("usage: ", argv[0], " [options] <file> [<file>...]");
+      absl::StrCat("usage: ", argv[0], " [options] <file> [<file>...]\n",
+                   "       ", argv[0], " [options] merge <shard_output>...");
   const auto args = verible::InitCommandLine(usage, &argc, &argv);
 
   std::string help_flag = absl::GetFlag(FLAGS_help_rules);
@@ -166,17 +552,17 @@ int main(int argc, char **argv) {
     std::cerr << "--autofix_output_file has no effect for --autofix="
               << autofix_mode << std::endl;
   }
-
-  const verible::ViolationFixer::AnswerChooser applyAllFixes =
-      [](const verible::LintViolation &,
-         absl::string_view) -> verible::ViolationFixer::Answer {
-    return {verible::ViolationFixer::AnswerChoice::kApplyAll, 0};
-  };
+  const OutputFormat output_format = absl::GetFlag(FLAGS_output_format);
+  if (output_format != OutputFormat::kText &&
+      autofix_mode != AutofixMode::kNo) {
+    std::cerr << "--output_format=" << output_format
+              << " has no effect for --autofix=" << autofix_mode << std::endl;
+  }
 
   std::unique_ptr<verible::ViolationHandler> violation_handler;
   switch (autofix_mode) {
     case AutofixMode::kNo:
-      violation_handler.reset(new verible::ViolationPrinter(&std::cerr));
+      violation_handler = ViolationPrinterFromFlags(&std::cerr);
       break;
     case AutofixMode::kPatchInteractive:
       CHECK(autofix_output_stream);
@@ -185,15 +571,15 @@ int main(int argc, char **argv) {
       break;
     case AutofixMode::kPatch:
       CHECK(autofix_output_stream);
-      violation_handler.reset(new verible::ViolationFixer(
-          &std::cerr, autofix_output_stream, applyAllFixes));
+      violation_handler.reset(new verible::ViolationBatchFixer(
+          &std::cerr, autofix_output_stream));
       break;
     case AutofixMode::kInplaceInteractive:
       violation_handler.reset(new verible::ViolationFixer(&std::cerr, nullptr));
       break;
     case AutofixMode::kInplace:
       violation_handler.reset(
-          new verible::ViolationFixer(&std::cerr, nullptr, applyAllFixes));
+          new verible::ViolationBatchFixer(&std::cerr, nullptr));
       break;
     case AutofixMode::kGenerateWaiver:
       violation_handler.reset(new verible::ViolationWaiverPrinter(
@@ -216,25 +602,112 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  if (absl::GetFlag(FLAGS_persistent_worker)) {
+    if (autofix_mode != AutofixMode::kNo) {
+      std::cerr << "--persistent_worker only supports --autofix=no"
+                << std::endl;
+      return 1;
+    }
+    return RunPersistentWorker();
+  }
+
   // All positional arguments are file names.  Exclude program name.
-  for (const absl::string_view filename :
-       verible::make_range(args.begin() + 1, args.end())) {
-    // Copy configuration, so that it can be locally modified per file.
-    auto config_status = verilog::LinterConfigurationFromFlags(filename);
-    if (!config_status.ok()) {
-      std::cerr << config_status.status().message() << std::endl;
-      exit_status = 1;
-      continue;
+  std::vector<absl::string_view> files(args.begin() + 1, args.end());
+
+  if (!files.empty() && files.front() == "merge") {
+    if (autofix_mode != AutofixMode::kNo) {
+      std::cerr << "merge only supports --autofix=no" << std::endl;
+      return 1;
     }
-    const LinterConfiguration &config = *config_status;
+    const int merge_status = MergeShardFiles(
+        std::vector<absl::string_view>(files.begin() + 1, files.end()),
+        violation_handler.get());
+    violation_handler->Finish();
+    return std::max(merge_status, exit_status);
+  }
 
-    const int lint_status = verilog::LintOneFile(
-        &std::cout, filename, config, violation_handler.get(),
-        absl::GetFlag(FLAGS_check_syntax), absl::GetFlag(FLAGS_parse_fatal),
-        absl::GetFlag(FLAGS_lint_fatal),
-        absl::GetFlag(FLAGS_show_diagnostic_context));
-    exit_status = std::max(lint_status, exit_status);
-  }  // for each file
+  // Parameter files, as when a persistent worker rule runs without a worker.
+  if (autofix_mode == AutofixMode::kNo &&
+      std::any_of(files.begin(), files.end(), [](absl::string_view file) {
+        return absl::StartsWith(file, "@");
+      })) {
+    std::vector<std::string> arguments;
+    for (const absl::string_view file : files) {
+      if (auto status = ExpandArgument(file, &arguments); !status.ok()) {
+        std::cerr << status.message() << std::endl;
+        return 2;
+      }
+    }
+    return std::max(LintRequest(arguments, &std::cerr), exit_status);
+  }
 
+  const int shard_count = absl::GetFlag(FLAGS_shard_count);
+  const int shard_index = absl::GetFlag(FLAGS_shard_index);
+  const std::string shard_output = absl::GetFlag(FLAGS_shard_output);
+  if (shard_count < 1 || shard_index < 0 || shard_index >= shard_count) {
+    std::cerr << "--shard_index must be in [0, --shard_count)" << std::endl;
+    return 1;
+  }
+  if (!shard_output.empty() && autofix_mode != AutofixMode::kNo) {
+    std::cerr << "--shard_output only supports --autofix=no" << std::endl;
+    return 1;
+  }
+  std::vector<int64_t> file_indices;
+  if (shard_count > 1 || !shard_output.empty()) {
+    std::vector<int64_t> sizes;
+    sizes.reserve(files.size());
+    for (const absl::string_view file : files) {
+      std::error_code error;
+      const auto size = std::filesystem::file_size(std::string(file), error);
+      // Unreadable files are reported by the shard that gets them.
+      sizes.push_back(error ? 0 : static_cast<int64_t>(size));
+    }
+    const std::vector<int> shards =
+        verilog::AssignLintShards(files, sizes, shard_count);
+    std::vector<absl::string_view> shard_files;
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (shards[i] != shard_index) continue;
+      shard_files.push_back(files[i]);
+      file_indices.push_back(i);
+    }
+    if (!shard_output.empty()) {
+      return std::max(LintShardToFile(shard_files, file_indices, shard_index,
+                                      shard_count, files.size(), shard_output),
+                      exit_status);
+    }
+    files = std::move(shard_files);
+  }
+
+  const bool profile_rules = absl::GetFlag(FLAGS_profile_rules);
+  verible::lint_profile::SetEnabled(profile_rules);
+
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  if (jobs > 1 && autofix_mode == AutofixMode::kNo &&
+      output_format != OutputFormat::kSarif &&
+      !absl::GetFlag(FLAGS_lint_variants)) {
+    exit_status = std::max(
+        LintFilesInParallel(files, jobs, &std::cout, &std::cerr), exit_status);
+  } else if (jobs > 1 && autofix_mode == AutofixMode::kInplace &&
+             !absl::GetFlag(FLAGS_lint_variants)) {
+    // Files are fixed independently, each by its own batch fixer.
+    const ViolationHandlerFactory batch_fixer = [](std::ostream *stream) {
+      return std::make_unique<verible::ViolationBatchFixer>(stream, nullptr);
+    };
+    exit_status = std::max(
+        LintFilesInParallel(files, jobs, &std::cout, &std::cerr, batch_fixer),
+        exit_status);
+  } else {
+    for (const absl::string_view filename : files) {
+      const int lint_status = LintFileFromFlags(
+          &std::cout, &std::cerr, filename, violation_handler.get());
+      exit_status = std::max(lint_status, exit_status);
+    }  // for each file
+  }
+  violation_handler->Finish();
+
+  if (profile_rules) {
+    verible::lint_profile::PrintTotals(
+        std::cerr, std::max(absl::GetFlag(FLAGS_profile_rules_top), 0));
+  }
   return exit_status;
 }
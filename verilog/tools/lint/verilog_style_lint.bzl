@@ -131,7 +131,62 @@ def _syntax_test(name, srcs, expect_fail = None):
         data = srcs,
     )
 
-def _verilog_style_lint_report(name, srcs, flags = None):
+def _style_lint_report_worker_impl(ctx):
+    """Lints sources in an action that can run on a persistent worker.
+
+    The flags are the worker's startup arguments, so that actions with the
+    same flags share workers; the report and sources are passed in a
+    parameter file, as each work request's arguments.
+
+    Args:
+      ctx: Context of this rule invocation.
+
+    Returns:
+      report file.
+    """
+    startup_args = ctx.actions.args()
+    startup_args.add_all(ctx.attr.flags)
+    request_args = ctx.actions.args()
+    request_args.use_param_file("@%s", use_always = True)
+    request_args.set_param_file_format("multiline")
+    request_args.add(ctx.outputs.report, format = "--report=%s")
+    request_args.add_all(ctx.files.srcs)
+    ctx.actions.run(
+        executable = ctx.executable._linter,
+        arguments = [startup_args, request_args],
+        inputs = ctx.files.srcs,
+        outputs = [ctx.outputs.report],
+        mnemonic = "VerilogStyleLint",
+        progress_message = "Linting Verilog sources of %{label}",
+        execution_requirements = {
+            "requires-worker-protocol": "json",
+            "supports-workers": "1",
+        },
+    )
+    return [DefaultInfo(files = depset([ctx.outputs.report]))]
+
+_style_lint_report_worker = rule(
+    attrs = {
+        "flags": attr.string_list(),
+        "report": attr.output(mandatory = True),
+        "srcs": attr.label_list(
+            allow_files = True,
+            mandatory = True,
+        ),
+        "_linter": attr.label(
+            default = Label(_linter_tool),
+            executable = True,
+            cfg = "exec",
+        ),
+    },
+    implementation = _style_lint_report_worker_impl,
+)
+
+def _verilog_style_lint_report(
+        name,
+        srcs,
+        flags = None,
+        persistent_worker = False):
     """Rule for producing a lint report on a collection of sources.
 
     Args:
@@ -139,12 +194,23 @@ def _verilog_style_lint_report(name, srcs, flags = None):
       srcs: list of source files to scan (can use native.glob()).
       flags: list of flags for running the verilog_lint binary.
         Examples: --parse_fatal, --lint_fatal.
+      persistent_worker: if True, lint in an action that Bazel can run on a
+        persistent verilog_lint worker (--persistent_worker), which saves the
+        linter's startup for every report.
     """
     output = name + "-style_lint_report.txt"
 
     # ignore error status for the sake of generating full report
     use_flags = ["--noparse_fatal", "--nolint_fatal"] + (flags or [])
-    if srcs:
+    if srcs and persistent_worker:
+        _style_lint_report_worker(
+            name = name,
+            srcs = srcs,
+            # Bazel adds --persistent_worker when it starts a worker.
+            flags = use_flags,
+            report = output,
+        )
+    elif srcs:
         files_target = name + "_files"
 
         native.filegroup(
@@ -233,7 +299,12 @@ _verilog_style_lint_diagnostics_script = rule(
     implementation = _style_lint_test_diagnostics_impl,
 )
 
-def _verilog_style_lint_test(name, srcs, flags = None, expect_fail = None):
+def _verilog_style_lint_test(
+        name,
+        srcs,
+        flags = None,
+        expect_fail = None,
+        persistent_worker = False):
     """Macro for running Verilog style lint tests in the silo.
 
     Args:
@@ -242,6 +313,7 @@ def _verilog_style_lint_test(name, srcs, flags = None, expect_fail = None):
       flags: list of flags for running the verilog_lint binary.
              Note: --norules_config_search is used for each test.
       expect_fail: if True, expect to find errors (invert status).
+      persistent_worker: if True, lint on a persistent worker.
     """
     forced_flags = [
         "--norules_config_search",
@@ -250,6 +322,7 @@ def _verilog_style_lint_test(name, srcs, flags = None, expect_fail = None):
         name = name + "-report",
         srcs = srcs,
         flags = (flags or []) + forced_flags,
+        persistent_worker = persistent_worker,
     )
     _verilog_style_lint_diagnostics_script(
         name = name + "-script",
@@ -269,7 +342,8 @@ def _package_style_lint_test(
         name,
         subpackages = None,
         exclude = None,
-        expect_fail = False):
+        expect_fail = False,
+        persistent_worker = False):
     """Tests Verilog lint on sources inside the invoking directory.
 
     Args:
@@ -278,6 +352,7 @@ def _package_style_lint_test(
         TODO(fangism): can this be automated?
       exclude: list of files or patterns to exclude from checking.
       expect_fail: if True, expect to find errors (invert status).
+      persistent_worker: if True, lint on a persistent worker.
     """
     _verilog_style_lint_test(
         name = name + "-local",
@@ -288,6 +363,7 @@ def _package_style_lint_test(
             exclude = exclude or [],
         ),
         expect_fail = expect_fail,
+        persistent_worker = persistent_worker,
     )
     if subpackages:
         native.test_suite(
@@ -54,6 +54,7 @@
 #include "verilog/CST/type.h"
 #include "verilog/CST/verilog_matchers.h"  // IWYU pragma: keep
 #include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/analysis/symbol_table.h"
 #include "verilog/analysis/verilog_analyzer.h"
 #include "verilog/formatting/format_style.h"
 #include "verilog/formatting/format_style_init.h"
@@ -215,8 +216,17 @@ class AutoExpander {
   // Module information relevant to AUTO expansion
   class Module {
    public:
-    explicit Module(const Symbol &module)
+    // If given, the ports are taken from the module's 'signature' instead of
+    // searching its syntax tree for them.
+    explicit Module(const Symbol &module,
+                    const ModuleSignature *signature = nullptr)
         : symbol_(module), name_(GetModuleName(symbol_)->get().text()) {
+      if (signature) {
+        for (const ModuleSignature::Port &port : signature->ports) {
+          PutDeclaredPort(SymbolCastToNode(*port.declaration));
+        }
+        return;
+      }
       RetrieveModuleHeaderPorts();
       RetrieveModuleBodyPorts();
     }
@@ -349,17 +359,86 @@ class AutoExpander {
     Template::Map templates_;
   };
 
-  AutoExpander(const TextStructureView &text_structure,
-               SymbolTableHandler *symbol_table_handler)
-      : text_structure_(text_structure),
-        symbol_table_handler_(symbol_table_handler) {
+  // Module information of a buffer that does not depend on which AUTOs get
+  // expanded. It is gathered once per buffer version and shared by all
+  // expanders, each of which expands AUTOs in its own copy of the modules.
+  struct BufferAnalysis {
+    explicit BufferAnalysis(const TextStructureView &text_structure);
+
+    // A module instance and the name of its type
+    struct Instance {
+      absl::string_view type_id;
+      const verible::Symbol *symbol;
+    };
+
+    // Text structure of the analyzed buffer
+    const TextStructureView &text_structure;
+
+    // Modules of the buffer (module name -> module info), with their
+    // dependencies and AUTO_TEMPLATEs retrieved
+    absl::node_hash_map<absl::string_view, Module> modules;
+
+    // Modules of the buffer in the order their AUTOs are expanded in, so that
+    // dependencies come first, each with the instances it contains
+    std::vector<std::pair<const Module *, std::vector<Instance>>>
+        ordered_modules;
+  };
+
+  // Modules instantiated from other files, kept until their declaration
+  // changes
+  class ModuleCache {
+   public:
+    // Returns the module of the given declaration, only analyzing it again if
+    // the declaration's text changed since it was last analyzed. Its ports
+    // are then taken from 'signature' if given.
+    const Module &Get(const verible::Symbol &declaration,
+                      const ModuleSignature *signature = nullptr);
+
+   private:
+    // Upper bound on entries; declarations of changed files are not removed
+    // otherwise
+    static constexpr size_t kMaxEntries = 1024;
+
+    struct Entry {
+      // Span and copy of the text of the declaration the module was built
+      // from. The module refers to that span, so it is only reused while the
+      // span is the same and still holds the same text.
+      absl::string_view span;
+      std::string text;
+      std::unique_ptr<const Module> module;
+    };
+    absl::flat_hash_map<const verible::Symbol *, Entry> entries_;
+  };
+
+  AutoExpander(const BufferAnalysis &analysis,
+               SymbolTableHandler *symbol_table_handler,
+               ModuleCache *module_cache)
+      : text_structure_(analysis.text_structure),
+        symbol_table_handler_(symbol_table_handler),
+        analysis_(analysis),
+        module_cache_(module_cache),
+        modules_(analysis.modules) {
     expand_span_ = text_structure_.Contents();
   }
 
-  AutoExpander(const TextStructureView &text_structure,
+  AutoExpander(const BufferAnalysis &analysis,
                SymbolTableHandler *symbol_table_handler,
-               Interval<size_t> line_range)
-      : AutoExpander(text_structure, symbol_table_handler) {
+               ModuleCache *module_cache, Interval<size_t> line_range)
+      : AutoExpander(analysis, symbol_table_handler, module_cache) {
+    expand_span_ = SpanOfLines(text_structure_, line_range);
+  }
+
+  AutoExpander(const BufferAnalysis &analysis,
+               SymbolTableHandler *symbol_table_handler,
+               ModuleCache *module_cache,
+               const absl::flat_hash_set<AutoKind> &allowed_autos)
+      : AutoExpander(analysis, symbol_table_handler, module_cache) {
+    allowed_autos_ = allowed_autos;
+  }
+
+  // Returns the span of the given lines, clamped to the lines of the text
+  static absl::string_view SpanOfLines(const TextStructureView &text_structure,
+                                       Interval<size_t> line_range) {
     size_t min = line_range.min < text_structure.Lines().size()
                      ? line_range.min
                      : text_structure.Lines().size() - 1;
@@ -369,14 +448,7 @@ class AutoExpander {
     const auto begin = text_structure.Lines()[min].begin();
     const auto end = text_structure.Lines()[max].end();
     const size_t length = static_cast<size_t>(std::distance(begin, end));
-    expand_span_ = absl::string_view(begin, length);
-  }
-
-  AutoExpander(const TextStructureView &text_structure,
-               SymbolTableHandler *symbol_table_handler,
-               const absl::flat_hash_set<AutoKind> &allowed_autos)
-      : AutoExpander(text_structure, symbol_table_handler) {
-    allowed_autos_ = allowed_autos;
+    return absl::string_view(begin, length);
   }
 
   // Retrieves port names from a module declared before the given location
@@ -417,8 +489,8 @@ class AutoExpander {
   // Expands all AUTOs in the buffer
   std::vector<Expansion> Expand();
 
-  // Find kinds of AUTO used in the expand span
-  absl::flat_hash_set<AutoKind> FindAutoKinds();
+  // Find kinds of AUTO used in the given span
+  static absl::flat_hash_set<AutoKind> FindAutoKinds(absl::string_view span);
 
  private:
   // Matches the given regex and erases ports from the module that are in the
@@ -449,7 +521,14 @@ class AutoExpander {
   // Symbol table wrapper for the language server
   SymbolTableHandler *symbol_table_handler_;
 
-  // Gathered module information (module name -> module info)
+  // Shared analysis of the buffer
+  const BufferAnalysis &analysis_;
+
+  // Modules instantiated from other files
+  ModuleCache *module_cache_;
+
+  // Gathered module information (module name -> module info), starting with
+  // a copy of the analyzed modules of the buffer
   absl::node_hash_map<absl::string_view, Module> modules_;
 
   // Regex for finding any AUTOs
@@ -1222,8 +1301,10 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoinst(
     return std::nullopt;
   }
 
+  const SymbolTableNode *const type_node =
+      symbol_table_handler_->FindDefinitionNode(type_id);
   const Symbol *const type_def =
-      symbol_table_handler_->FindDefinitionSymbol(type_id);
+      type_node ? type_node->Value().syntax_origin : nullptr;
   if (!type_def) {
     LOG(ERROR) << "AUTOINST: No definition found for module type: " << type_id;
     return std::nullopt;
@@ -1235,7 +1316,9 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoinst(
     return std::nullopt;
   }
   if (!modules_.contains(type_id)) {
-    modules_.insert(std::make_pair(type_id, Module(*type_def)));
+    modules_.insert(std::make_pair(
+        type_id, module_cache_->Get(
+                     *type_def, type_node->Value().module_signature.get())));
   }
   const Module &inst_module = modules_.at(type_id);
 
@@ -1449,24 +1532,22 @@ auto SetUndeclaredPortLocations(AutoExpander::Module *module,
   };
 }
 
-std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
-  std::vector<Expansion> expansions;
-  if (!text_structure_.SyntaxTree()) {
-    LOG(ERROR)
-        << "Cannot perform AUTO expansion: failed to retrieve a syntax tree";
-    return {};
-  }
+AutoExpander::BufferAnalysis::BufferAnalysis(
+    const TextStructureView &text_structure)
+    : text_structure(text_structure) {
+  if (!text_structure.SyntaxTree()) return;
   std::vector<Module *> buffer_modules;  // Ordered list of all modules
                                          // in the buffer being modified
   for (const auto &mod_decl :
-       FindAllModuleDeclarations(*text_structure_.SyntaxTree())) {
+       FindAllModuleDeclarations(text_structure.GetSyntaxTreeIndex(),
+                                 *text_structure.SyntaxTree())) {
     Module module(*mod_decl.match);
     buffer_modules.push_back(
-        &modules_.insert(std::make_pair(module.Name(), std::move(module)))
+        &modules.insert(std::make_pair(module.Name(), std::move(module)))
              .first->second);
   }
   for (auto module : buffer_modules) {
-    module->RetrieveDependencies(modules_);
+    module->RetrieveDependencies(modules);
   }
   // Sort modules in the buffer based on a dependency graph, so that AUTOs are
   // expanded in order
@@ -1474,7 +1555,51 @@ std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
             [](const Module *left, const Module *right) {
               return right->DependsOn(left);
             });
+  ordered_modules.reserve(buffer_modules.size());
   for (Module *const module : buffer_modules) {
+    module->RetrieveAutoTemplates();
+    std::vector<Instance> instances;
+    for (const auto &data : FindAllDataDeclarations(module->Symbol())) {
+      const verible::Symbol *const type_id_node =
+          GetTypeIdentifierFromDataDeclaration(*data.match);
+      // Some data declarations do not have a type id, ignore those
+      if (!type_id_node) continue;
+      const absl::string_view type_id = StringSpanOfSymbol(*type_id_node);
+      for (const auto &instance : FindAllGateInstances(*data.match)) {
+        instances.push_back({type_id, instance.match});
+      }
+    }
+    ordered_modules.emplace_back(module, std::move(instances));
+  }
+}
+
+const AutoExpander::Module &AutoExpander::ModuleCache::Get(
+    const verible::Symbol &declaration, const ModuleSignature *signature) {
+  const absl::string_view span = StringSpanOfSymbol(declaration);
+  const auto found = entries_.find(&declaration);
+  if (found != entries_.end() && found->second.span.data() == span.data() &&
+      found->second.text == span) {
+    return *found->second.module;
+  }
+  if (found == entries_.end() && entries_.size() >= kMaxEntries) {
+    entries_.clear();
+  }
+  Entry &entry = entries_[&declaration];
+  entry.span = span;
+  entry.text = std::string(span);
+  entry.module = std::make_unique<const Module>(declaration, signature);
+  return *entry.module;
+}
+
+std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
+  std::vector<Expansion> expansions;
+  if (!text_structure_.SyntaxTree()) {
+    LOG(ERROR)
+        << "Cannot perform AUTO expansion: failed to retrieve a syntax tree";
+    return {};
+  }
+  for (const auto &[analyzed_module, instances] : analysis_.ordered_modules) {
+    Module *const module = &modules_.at(analyzed_module->Name());
     // Ports declared in AUTOINPUT/AUTOINOUT/AUTOOUTPUT must be removed from
     // the module, as they should be regenerated every time (in case they get
     // removed or their names change)
@@ -1485,18 +1610,10 @@ std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
     const auto autooutput_match =
         FindMatchAndErasePorts(module, AutoKind::kAutooutput, *autooutput_re_);
     // Do AUTOINST expansion
-    module->RetrieveAutoTemplates();
-    for (const auto &data : FindAllDataDeclarations(module->Symbol())) {
-      const Symbol *const type_id_node =
-          GetTypeIdentifierFromDataDeclaration(*data.match);
-      // Some data declarations do not have a type id, ignore those
-      if (!type_id_node) continue;
-      const absl::string_view type_id = StringSpanOfSymbol(*type_id_node);
-      for (const auto &instance : FindAllGateInstances(*data.match)) {
-        if (const auto expansion =
-                ExpandAutoinst(module, *instance.match, type_id)) {
-          expansions.push_back(*expansion);
-        }
+    for (const BufferAnalysis::Instance &instance : instances) {
+      if (const auto expansion =
+              ExpandAutoinst(module, *instance.symbol, instance.type_id)) {
+        expansions.push_back(*expansion);
       }
     }
     // Set AUTO port locations. This has to be done before any port expansions
@@ -1543,9 +1660,10 @@ std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
   return expansions;
 }
 
-absl::flat_hash_set<AutoKind> AutoExpander::FindAutoKinds() {
+absl::flat_hash_set<AutoKind> AutoExpander::FindAutoKinds(
+    absl::string_view span) {
   absl::flat_hash_set<AutoKind> kinds;
-  absl::string_view search_span = expand_span_;
+  absl::string_view search_span = span;
   absl::string_view auto_str;
   while (RE2::FindAndConsume(&search_span, *auto_re_, &auto_str)) {
     if (auto_str == "AUTOARG") {
@@ -1689,20 +1807,71 @@ std::vector<TextEdit> ConvertAutoExpansionsToFormattedTextEdits(
 
 }  // namespace
 
+struct AutoExpandCache::Impl {
+  // Returns the analysis of the given buffer, made again only if the buffer
+  // is not the version last analyzed for its URI
+  std::shared_ptr<const AutoExpander::BufferAnalysis> Analyze(
+      const std::shared_ptr<const ParsedBuffer> &buffer) {
+    // Drop the analyses of buffers no longer in use.
+    for (auto it = buffers.begin(); it != buffers.end();) {
+      if (it->second.buffer.expired()) {
+        buffers.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    BufferEntry &entry = buffers[buffer->uri()];
+    if (entry.buffer.lock() != buffer) {
+      entry.buffer = buffer;
+      entry.analysis = std::make_shared<const AutoExpander::BufferAnalysis>(
+          buffer->parser().Data());
+    }
+    return entry.analysis;
+  }
+
+  // The analysis refers to the buffer, so it is only used while the buffer
+  // is alive.
+  struct BufferEntry {
+    std::weak_ptr<const ParsedBuffer> buffer;
+    std::shared_ptr<const AutoExpander::BufferAnalysis> analysis;
+  };
+  absl::flat_hash_map<std::string, BufferEntry> buffers;  // By URI
+
+  AutoExpander::ModuleCache modules;
+};
+
+AutoExpandCache::AutoExpandCache() : impl_(std::make_unique<Impl>()) {}
+AutoExpandCache::~AutoExpandCache() = default;
+
 std::vector<CodeAction> GenerateAutoExpandCodeActions(
     SymbolTableHandler *symbol_table_handler,
-    const BufferTracker *const tracker, const CodeActionParams &p) {
+    const BufferTracker *const tracker, const CodeActionParams &p,
+    AutoExpandCache *cache) {
   Interval<size_t> line_range{static_cast<size_t>(p.range.start.line),
                               static_cast<size_t>(p.range.end.line)};
   if (!tracker) return {};
   const auto current = tracker->current();
   if (!current) return {};  // Can only expand if we have latest version
   const TextStructureView &text_structure = current->parser().Data();
-  AutoExpander range_expander(text_structure, symbol_table_handler, line_range);
-  const auto &auto_kinds = range_expander.FindAutoKinds();
+  const auto &auto_kinds = AutoExpander::FindAutoKinds(
+      AutoExpander::SpanOfLines(text_structure, line_range));
   if (auto_kinds.empty()) return {};
 
-  AutoExpander full_expander(text_structure, symbol_table_handler);
+  // All expanders share one analysis of the buffer and of the instantiated
+  // modules, kept for the next request if there is a cache.
+  std::shared_ptr<const AutoExpander::BufferAnalysis> analysis;
+  AutoExpander::ModuleCache request_modules;
+  AutoExpander::ModuleCache *modules = &request_modules;
+  if (cache) {
+    analysis = cache->impl_->Analyze(current);
+    modules = &cache->impl_->modules;
+  } else {
+    analysis = std::make_shared<const AutoExpander::BufferAnalysis>(
+        text_structure);
+  }
+  AutoExpander range_expander(*analysis, symbol_table_handler, modules,
+                              line_range);
+  AutoExpander full_expander(*analysis, symbol_table_handler, modules);
   const auto &expansions_full = full_expander.Expand();
   if (expansions_full.empty()) return {};
   std::vector<CodeAction> result;
@@ -1729,7 +1898,8 @@ std::vector<CodeAction> GenerateAutoExpandCodeActions(
                                 text_structure, expansions_range)}}},
   });
 
-  AutoExpander kind_expander(text_structure, symbol_table_handler, auto_kinds);
+  AutoExpander kind_expander(*analysis, symbol_table_handler, modules,
+                             auto_kinds);
   const auto &expansions_kind = kind_expander.Expand();
   if (expansions_kind.empty() ||
       expansions_kind.size() == expansions_range.size()) {
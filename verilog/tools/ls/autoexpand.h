@@ -16,6 +16,7 @@
 #ifndef VERILOG_TOOLS_LS_AUTOEXPAND_H
 #define VERILOG_TOOLS_LS_AUTOEXPAND_H
 
+#include <memory>
 #include <vector>
 
 #include "common/lsp/lsp-protocol.h"
@@ -25,10 +26,32 @@
 // Functions for Emacs' Verilog-Mode-style AUTO expansion.
 
 namespace verilog {
-// Generate AUTO expansion code actions for the given code action params
+// Analysis kept between AUTO expansion requests, which clients send on every
+// cursor move: the modules of the latest version of each buffer, and the
+// ports of modules instantiated from other files, which are only analyzed
+// again once their declaration changes.
+class AutoExpandCache {
+ public:
+  AutoExpandCache();
+  ~AutoExpandCache();
+
+  AutoExpandCache(const AutoExpandCache &) = delete;
+  AutoExpandCache &operator=(const AutoExpandCache &) = delete;
+
+ private:
+  friend std::vector<verible::lsp::CodeAction> GenerateAutoExpandCodeActions(
+      SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
+      const verible::lsp::CodeActionParams &p, AutoExpandCache *cache);
+
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+// Generate AUTO expansion code actions for the given code action params.
+// The analysis is shared by all actions, and kept in "cache" if given.
 std::vector<verible::lsp::CodeAction> GenerateAutoExpandCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p);
+    const verible::lsp::CodeActionParams &p, AutoExpandCache *cache = nullptr);
 
 }  // namespace verilog
 #endif  // VERILOG_TOOLS_LS_AUTOEXPAND_H
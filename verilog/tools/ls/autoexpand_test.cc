@@ -152,8 +152,9 @@ void TestTextEditsWithProject(
   // expansions. This handler also needs a Verilog project to work properly.
   SymbolTableHandler symbol_table_handler;
   symbol_table_handler.SetProject(proj);
-  symbol_table_handler.UpdateFileContent(TESTED_FILENAME,
-                                         &tracker.current()->parser());
+  symbol_table_handler.UpdateFileContent(
+      TESTED_FILENAME, std::shared_ptr<const VerilogAnalyzer>(
+                           tracker.current(), &tracker.current()->parser()));
   symbol_table_handler.BuildProjectSymbolTable();
   // Run the tested edit function
   std::vector<TextEdit> edits = run.edit_fn(&symbol_table_handler, &tracker);
@@ -3754,5 +3755,67 @@ endmodule
   );
 }
 
+// Code actions are the same with a cache, which follows buffer changes
+TEST(Autoexpand, CachedAnalysis) {
+  static constexpr absl::string_view kFilename = "<<tested-file>>";
+  static constexpr absl::string_view kText = R"(
+module foo (  /*AUTOARG*/);
+  /*AUTOINPUT*/
+  bar b (  /*AUTOINST*/);
+endmodule
+
+module bar (  /*AUTOARG*/);
+  input clk;
+endmodule
+)";
+  EditTextBuffer buffer(kText);
+  BufferTracker tracker;
+  tracker.Update(std::string(kFilename), buffer);
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(
+      std::make_shared<VerilogProject>(".", std::vector<std::string>()));
+  const auto update_symbol_table = [&]() {
+    symbol_table_handler.UpdateFileContent(
+        kFilename, std::shared_ptr<const VerilogAnalyzer>(
+                       tracker.current(), &tracker.current()->parser()));
+    symbol_table_handler.BuildProjectSymbolTable();
+  };
+  update_symbol_table();
+
+  const CodeActionParams p = {.textDocument = {tracker.current()->uri()},
+                              .range = {.start = {.line = 3},
+                                        .end = {.line = 3}}};
+  AutoExpandCache cache;
+  const nlohmann::json uncached =
+      GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p);
+  ASSERT_FALSE(uncached.empty());
+  EXPECT_EQ(
+      nlohmann::json(GenerateAutoExpandCodeActions(&symbol_table_handler,
+                                                   &tracker, p, &cache)),
+      uncached);
+  // The analysis is shared by subsequent requests for the same version.
+  EXPECT_EQ(
+      nlohmann::json(GenerateAutoExpandCodeActions(&symbol_table_handler,
+                                                   &tracker, p, &cache)),
+      uncached);
+
+  // A new version of the buffer is analyzed again.
+  buffer.ApplyChange(TextDocumentContentChangeEvent{
+      .range = {.start = {.line = 7, .character = 8},
+                .end = {.line = 7, .character = 11}},
+      .has_range = true,
+      .text = "rst"});
+  buffer.set_last_global_version(buffer.last_global_version() + 1);
+  tracker.Update(std::string(kFilename), buffer);
+  update_symbol_table();
+  const nlohmann::json changed =
+      GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p);
+  EXPECT_NE(changed, uncached);
+  EXPECT_EQ(
+      nlohmann::json(GenerateAutoExpandCodeActions(&symbol_table_handler,
+                                                   &tracker, p, &cache)),
+      changed);
+}
+
 }  // namespace
 }  // namespace verilog
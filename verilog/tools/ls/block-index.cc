@@ -0,0 +1,180 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verilog/tools/ls/block-index.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/strings/line_column_map.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/concrete_syntax_tree.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/text/tree_context_visitor.h"
+#include "common/text/visitors.h"
+#include "common/util/range.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+namespace {
+// Returns true for the constructs that have a begin and an end.
+bool IsBlock(const verible::SyntaxTreeNode &node) {
+  switch (static_cast<NodeEnum>(node.Tag().tag)) {
+    case NodeEnum::kModuleDeclaration:
+    case NodeEnum::kInterfaceDeclaration:
+    case NodeEnum::kProgramDeclaration:
+    case NodeEnum::kPackageDeclaration:
+    case NodeEnum::kClassDeclaration:
+    case NodeEnum::kConfigDeclaration:
+    case NodeEnum::kUdpPrimitive:
+    case NodeEnum::kFunctionDeclaration:
+    case NodeEnum::kTaskDeclaration:
+    case NodeEnum::kConstraintDeclaration:
+    case NodeEnum::kCovergroupDeclaration:
+    case NodeEnum::kClockingDeclaration:
+    case NodeEnum::kPropertyDeclaration:
+    case NodeEnum::kSequenceDeclaration:
+    case NodeEnum::kGenerateRegion:
+    case NodeEnum::kGenerateBlock:
+    case NodeEnum::kCaseGenerateConstruct:
+    case NodeEnum::kSeqBlock:
+    case NodeEnum::kParBlock:
+    case NodeEnum::kCaseStatement:
+    case NodeEnum::kRandCaseStatement:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Appends the blocks of a syntax tree in pre-order, tracking the first and
+// last leaf of each.
+class BlockCollector : public verible::SymbolVisitor {
+ public:
+  BlockCollector(const verible::TextStructureView &text,
+                 std::vector<BlockIndex::Block> *blocks)
+      : text_(text), blocks_(blocks) {}
+
+  void Visit(const verible::SyntaxTreeLeaf &leaf) final {
+    const absl::string_view token_text = leaf.get().text();
+    if (token_text.empty() ||
+        !verible::IsSubRange(token_text, text_.Contents())) {
+      return;
+    }
+    // The blocks still waiting for their first leaf are at the top.
+    for (auto it = open_.rbegin(); it != open_.rend() && it->begin == nullptr;
+         ++it) {
+      it->begin = token_text.begin();
+    }
+    last_end_ = token_text.end();
+  }
+
+  void Visit(const verible::SyntaxTreeNode &node) final {}
+
+  bool EnterNode(const verible::SyntaxTreeNode &node) final {
+    if (IsBlock(node)) {
+      open_.push_back({static_cast<int>(blocks_->size()), nullptr});
+      const int parent = open_.size() > 1 ? open_[open_.size() - 2].index : -1;
+      blocks_->push_back({{}, parent});
+    }
+    return true;
+  }
+
+  void LeaveNode(const verible::SyntaxTreeNode &node) final {
+    if (!IsBlock(node)) return;
+    const OpenBlock open = open_.back();
+    open_.pop_back();
+    if (open.begin == nullptr) {
+      // Without leaves, neither this block nor its children were kept.
+      blocks_->pop_back();
+      return;
+    }
+    (*blocks_)[open.index].range = text_.GetRangeForText(
+        absl::string_view(open.begin, last_end_ - open.begin));
+  }
+
+ private:
+  struct OpenBlock {
+    int index;          // into blocks_
+    const char *begin;  // of the first leaf, or nullptr
+  };
+
+  const verible::TextStructureView &text_;
+  std::vector<BlockIndex::Block> *const blocks_;
+  std::vector<OpenBlock> open_;
+  const char *last_end_ = nullptr;
+};
+}  // namespace
+
+BlockIndex::BlockIndex(const verible::TextStructureView &text) {
+  if (const auto &tree = text.SyntaxTree()) {
+    BlockCollector collector(text, &blocks_);
+    verible::WalkTree(*tree, &collector);
+  }
+
+  // Start of the current branch of each open conditional block.
+  std::vector<verible::LineColumn> open_branches;
+  for (const verible::TokenInfo &token : text.TokenStream()) {
+    switch (token.token_enum()) {
+      case PP_ifdef:
+      case PP_ifndef:
+        open_branches.push_back(text.GetRangeForToken(token).start);
+        break;
+      case PP_elsif:
+      case PP_else:
+      case PP_endif: {
+        if (open_branches.empty()) break;  // Unbalanced
+        const verible::LineColumn start = text.GetRangeForToken(token).start;
+        conditional_branches_.push_back({open_branches.back(), start});
+        if (token.token_enum() == PP_endif) {
+          open_branches.pop_back();
+        } else {
+          open_branches.back() = start;
+        }
+        break;
+      }
+      case TK_COMMENT_BLOCK: {
+        const verible::LineColumnRange range = text.GetRangeForToken(token);
+        if (range.end.line > range.start.line) {
+          multiline_comments_.push_back(range);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+std::vector<int> BlockIndex::EnclosingBlocks(
+    const verible::LineColumn &pos) const {
+  // Blocks containing "pos" start before it, and as blocks are nested, they
+  // all enclose the last block starting before "pos".
+  const auto last_started = std::upper_bound(
+      blocks_.begin(), blocks_.end(), pos,
+      [](const verible::LineColumn &p, const Block &b) {
+        return p < b.range.start;
+      });
+  std::vector<int> result;
+  for (int i = static_cast<int>(last_started - blocks_.begin()) - 1; i >= 0;
+       i = blocks_[i].parent) {
+    if (blocks_[i].range.PositionInRange(pos)) result.push_back(i);
+  }
+  return result;
+}
+}  // namespace verilog
@@ -0,0 +1,66 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_BLOCK_INDEX_H_INCLUDED
+#define VERILOG_TOOLS_LS_BLOCK_INDEX_H_INCLUDED
+
+#include <vector>
+
+#include "common/strings/line_column_map.h"
+#include "common/text/text_structure.h"
+
+namespace verilog {
+// Index of the constructs of a buffer that have a begin and an end, like
+// module/endmodule, begin/end, function/endfunction, generate regions and
+// `ifdef blocks, built once from the syntax tree and the token stream.
+// Lookups never walk the syntax tree again.
+class BlockIndex {
+ public:
+  // A syntactic construct, from its first to the end of its last token.
+  struct Block {
+    verible::LineColumnRange range;
+    int parent;  // Index of the enclosing block, or -1.
+  };
+
+  BlockIndex() = default;
+  explicit BlockIndex(const verible::TextStructureView &text);
+
+  // Syntactic blocks, ordered by their start. Enclosing blocks come before
+  // the blocks they contain.
+  const std::vector<Block> &blocks() const { return blocks_; }
+
+  // Branches of conditional compilation blocks: from an `ifdef, `ifndef,
+  // `elsif or `else to the start of the next directive of the same block.
+  const std::vector<verible::LineColumnRange> &conditional_branches() const {
+    return conditional_branches_;
+  }
+
+  // Comment blocks spanning more than one line.
+  const std::vector<verible::LineColumnRange> &multiline_comments() const {
+    return multiline_comments_;
+  }
+
+  // Returns the indices of the blocks containing "pos", innermost first.
+  // Takes logarithmic time in the number of blocks plus the nesting depth.
+  std::vector<int> EnclosingBlocks(const verible::LineColumn &pos) const;
+
+ private:
+  std::vector<Block> blocks_;
+  std::vector<verible::LineColumnRange> conditional_branches_;
+  std::vector<verible::LineColumnRange> multiline_comments_;
+};
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_BLOCK_INDEX_H_INCLUDED
@@ -0,0 +1,128 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verilog/tools/ls/block-index.h"
+
+#include <utility>
+#include <vector>
+
+#include "common/strings/line_column_map.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+namespace {
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+using verible::LineColumn;
+using verible::LineColumnRange;
+
+// Lines of the blocks, as {start line, end line}.
+std::vector<std::pair<int, int>> BlockLines(const BlockIndex &index) {
+  std::vector<std::pair<int, int>> lines;
+  for (const BlockIndex::Block &block : index.blocks()) {
+    lines.emplace_back(block.range.start.line, block.range.end.line);
+  }
+  return lines;
+}
+
+TEST(BlockIndexTest, EmptyText) {
+  VerilogAnalyzer analyzer("", "empty.sv");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const BlockIndex index(analyzer.Data());
+  EXPECT_THAT(index.blocks(), IsEmpty());
+  EXPECT_THAT(index.conditional_branches(), IsEmpty());
+  EXPECT_THAT(index.multiline_comments(), IsEmpty());
+  EXPECT_THAT(index.EnclosingBlocks({0, 0}), IsEmpty());
+}
+
+TEST(BlockIndexTest, NestedBlocks) {
+  VerilogAnalyzer analyzer(
+      "module m;\n"              // 0
+      "  initial begin\n"        // 1
+      "    x = 1;\n"             // 2
+      "  end\n"                  // 3
+      "  function void f;\n"     // 4
+      "  endfunction\n"          // 5
+      "endmodule\n"              // 6
+      "package p;\n"             // 7
+      "endpackage : p\n",        // 8
+      "nested.sv");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const BlockIndex index(analyzer.Data());
+  EXPECT_THAT(BlockLines(index), ElementsAre(std::make_pair(0, 6),  //
+                                             std::make_pair(1, 3),  //
+                                             std::make_pair(4, 5),  //
+                                             std::make_pair(7, 8)));
+  EXPECT_EQ(index.blocks()[0].parent, -1);
+  EXPECT_EQ(index.blocks()[1].parent, 0);
+  EXPECT_EQ(index.blocks()[2].parent, 0);
+  EXPECT_EQ(index.blocks()[3].parent, -1);
+
+  // The range ends after the last token, including the label.
+  EXPECT_EQ(index.blocks()[3].range,
+            (LineColumnRange{LineColumn{7, 0}, LineColumn{8, 14}}));
+
+  EXPECT_THAT(index.EnclosingBlocks({2, 4}), ElementsAre(1, 0));
+  EXPECT_THAT(index.EnclosingBlocks({4, 2}), ElementsAre(2, 0));
+  EXPECT_THAT(index.EnclosingBlocks({6, 3}), ElementsAre(0));
+  // After the function, before the end of the module.
+  EXPECT_THAT(index.EnclosingBlocks({5, 13}), ElementsAre(0));
+  EXPECT_THAT(index.EnclosingBlocks({8, 20}), IsEmpty());
+}
+
+TEST(BlockIndexTest, GenerateRegions) {
+  VerilogAnalyzer analyzer(
+      "module m;\n"                                  // 0
+      "  generate\n"                                 // 1
+      "    for (genvar i = 0; i < 2; ++i) begin\n"   // 2
+      "    end\n"                                    // 3
+      "  endgenerate\n"                              // 4
+      "endmodule\n",                                 // 5
+      "generate.sv");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const BlockIndex index(analyzer.Data());
+  EXPECT_THAT(BlockLines(index), ElementsAre(std::make_pair(0, 5),  //
+                                             std::make_pair(1, 4),  //
+                                             std::make_pair(2, 3)));
+  EXPECT_THAT(index.EnclosingBlocks({3, 5}), ElementsAre(2, 1, 0));
+}
+
+TEST(BlockIndexTest, ConditionalBranchesAndComments) {
+  VerilogAnalyzer analyzer(
+      "/* one\n"                // 0
+      "   two */\n"             // 1
+      "/* single line */\n"     // 2
+      "`ifdef A\n"              // 3
+      "`ifndef B\n"             // 4
+      "`endif\n"                // 5
+      "`elsif C\n"              // 6
+      "`else\n"                 // 7
+      "`endif\n",               // 8
+      "conditional.sv");
+  ASSERT_TRUE(analyzer.Analyze().ok());
+  const BlockIndex index(analyzer.Data());
+  EXPECT_THAT(index.multiline_comments(),
+              ElementsAre(LineColumnRange{{0, 0}, {1, 9}}));
+  EXPECT_THAT(index.conditional_branches(),
+              ElementsAre(LineColumnRange{{4, 0}, {5, 0}},  //
+                          LineColumnRange{{3, 0}, {6, 0}},  //
+                          LineColumnRange{{6, 0}, {7, 0}},  //
+                          LineColumnRange{{7, 0}, {8, 0}}));
+}
+}  // namespace
+}  // namespace verilog
@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -107,15 +108,18 @@ class FindBeginLabel : public TreeContextVisitor {
   bool finished_;
 };
 
+}  // namespace
+
 // Constructs a Hover message for the given location
 class HoverBuilder {
  public:
   HoverBuilder(SymbolTableHandler *symbol_table_handler,
                const BufferTrackerContainer &tracker_container,
-               const verible::lsp::HoverParams &params)
+               const verible::lsp::HoverParams &params, HoverCache *cache)
       : symbol_table_handler_(symbol_table_handler),
         tracker_container_(tracker_container),
-        params_(params) {}
+        params_(params),
+        cache_(cache) {}
 
   verible::lsp::Hover Build() {
     std::optional<verible::TokenInfo> token =
@@ -141,16 +145,39 @@ class HoverBuilder {
     if (!tracker) return;
     std::shared_ptr<const ParsedBuffer> parsedbuffer = tracker->current();
     if (!parsedbuffer) return;
+    if (cache_ == nullptr) {
+      response->contents.value = DescribeEndToken(*parsedbuffer, token);
+      return;
+    }
+    if (cache_->end_tokens_version_ != parsedbuffer->version() ||
+        cache_->end_tokens_uri_ != parsedbuffer->uri()) {
+      cache_->end_tokens_.clear();
+      cache_->end_tokens_uri_ = parsedbuffer->uri();
+      cache_->end_tokens_version_ = parsedbuffer->version();
+    }
+    const int offset =
+        token.left(parsedbuffer->parser().Data().Contents());
+    auto found = cache_->end_tokens_.find(offset);
+    if (found == cache_->end_tokens_.end()) {
+      found = cache_->end_tokens_
+                  .emplace(offset, DescribeEndToken(*parsedbuffer, token))
+                  .first;
+    }
+    response->contents.value = found->second;
+  }
+
+  // Returns the description of the end of a named block, or an empty string.
+  static std::string DescribeEndToken(const ParsedBuffer &parsedbuffer,
+                                      const verible::TokenInfo &token) {
     const verible::ConcreteSyntaxTree &tree =
-        parsedbuffer->parser().SyntaxTree();
-    if (!tree) return;
+        parsedbuffer.parser().SyntaxTree();
+    if (!tree) return {};
     FindBeginLabel search;
     absl::string_view label = search.LabelSearch(
         tree, token.text(), NodeEnum::kEnd, NodeEnum::kBegin);
-    if (label.empty()) return;
-    response->contents.value = "### End of block\n\n";
-    absl::StrAppend(&response->contents.value, "---\n\nName: ", label,
-                    "\n\n---");
+    if (label.empty()) return {};
+    return absl::StrCat("### End of block\n\n", "---\n\nName: ", label,
+                        "\n\n---");
   }
 
   void HoverInfoIdentifier(verible::lsp::Hover *response,
@@ -159,31 +186,52 @@ class HoverBuilder {
     const SymbolTableNode *node =
         symbol_table_handler_->FindDefinitionNode(symbol);
     if (!node) return;
-    const SymbolInfo &info = node->Value();
-    response->contents.value = absl::StrCat(
+    if (cache_ == nullptr) {
+      response->contents.value = DescribeDefinition(*node, symbol);
+      return;
+    }
+    // Looking up the node prepared the symbol table, so its generation is
+    // the current one.
+    if (cache_->generation_ != symbol_table_handler_->generation()) {
+      cache_->definitions_.clear();
+      cache_->generation_ = symbol_table_handler_->generation();
+    }
+    HoverCache::Description &description = cache_->definitions_[node];
+    if (description.contents.empty() || description.name != symbol) {
+      description.name = std::string(symbol);
+      description.contents = DescribeDefinition(*node, symbol);
+    }
+    response->contents.value = description.contents;
+  }
+
+  // Returns the description of the definition of 'symbol'.
+  static std::string DescribeDefinition(const SymbolTableNode &node,
+                                        absl::string_view symbol) {
+    const SymbolInfo &info = node.Value();
+    std::string contents = absl::StrCat(
         "### ", SymbolMetaTypeAsString(info.metatype), " ", symbol, "\n\n");
     if (!info.declared_type.syntax_origin && info.declared_type.implicit) {
-      absl::StrAppend(&response->contents.value,
-                      "---\n\nType: (implicit)\n\n---");
+      absl::StrAppend(&contents, "---\n\nType: (implicit)\n\n---");
     } else if (info.declared_type.syntax_origin) {
       absl::StrAppend(
-          &response->contents.value, "---\n\n", "Type: ",
+          &contents, "---\n\n", "Type: ",
           verible::StringSpanOfSymbol(*info.declared_type.syntax_origin),
           "\n\n---");
     }
+    return contents;
   }
 
   SymbolTableHandler *symbol_table_handler_;
   const BufferTrackerContainer &tracker_container_;
   const verible::lsp::HoverParams &params_;
+  HoverCache *const cache_;  // may be nullptr
 };
 
-}  // namespace
-
 verible::lsp::Hover CreateHoverInformation(
     SymbolTableHandler *symbol_table_handler,
-    const BufferTrackerContainer &tracker, const verible::lsp::HoverParams &p) {
-  HoverBuilder builder(symbol_table_handler, tracker, p);
+    const BufferTrackerContainer &tracker, const verible::lsp::HoverParams &p,
+    HoverCache *cache) {
+  HoverBuilder builder(symbol_table_handler, tracker, p, cache);
   return builder.Build();
 }
 
@@ -16,15 +16,51 @@
 #ifndef VERILOG_TOOLS_LS_HOVER_H_INCLUDED
 #define VERILOG_TOOLS_LS_HOVER_H_INCLUDED
 
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "common/lsp/lsp-protocol.h"
+#include "verilog/analysis/symbol_table.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 
 namespace verilog {
-// Provides hover information for given location
+// Hover contents kept between requests, which clients send on every mouse
+// move: the descriptions of definitions, as long as the symbol table is the
+// same, and the descriptions of the end tokens of the last hovered buffer
+// version.
+class HoverCache {
+ public:
+  HoverCache() = default;
+
+  HoverCache(const HoverCache &) = delete;
+  HoverCache &operator=(const HoverCache &) = delete;
+
+ private:
+  friend class HoverBuilder;
+
+  struct Description {
+    std::string name;  // As hovered; the description starts with it.
+    std::string contents;
+  };
+
+  // Valid for the SymbolTableHandler::generation() they were made in.
+  int64_t generation_ = -1;
+  absl::flat_hash_map<const SymbolTableNode *, Description> definitions_;
+
+  // By the offset of the token, valid for one version of one buffer.
+  std::string end_tokens_uri_;
+  int64_t end_tokens_version_ = -1;
+  absl::flat_hash_map<int, std::string> end_tokens_;
+};
+
+// Provides hover information for given location, reusing the contents kept
+// in "cache" if given.
 verible::lsp::Hover CreateHoverInformation(
     SymbolTableHandler *symbol_table_handler,
-    const BufferTrackerContainer &tracker, const verible::lsp::HoverParams &p);
+    const BufferTrackerContainer &tracker, const verible::lsp::HoverParams &p,
+    HoverCache *cache = nullptr);
 }  // namespace verilog
 
 #endif  // hover_h_INCLUDED
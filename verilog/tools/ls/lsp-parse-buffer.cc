@@ -17,25 +17,57 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/lsp/lsp-file-utils.h"
+#include "common/lsp/lsp-protocol.h"
 #include "common/lsp/lsp-text-buffer.h"
+#include "common/strings/line_column_map.h"
+#include "common/strings/mem_block.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
 #include "common/util/logging.h"
+#include "common/util/thread_pool.h"
+#include "nlohmann/json.hpp"
 #include "verilog/analysis/verilog_analyzer.h"
 #include "verilog/analysis/verilog_linter.h"
 #include "verilog/analysis/verilog_linter_configuration.h"
+#include "verilog/analysis/verilog_parse_cache.h"
+#include "verilog/parser/verilog_token_enum.h"
+#include "verilog/tools/ls/document-symbol-filler.h"
+#include "verilog/tools/ls/semantic-tokens.h"
+
+ABSL_FLAG(bool, incremental_parse, true,
+          "Re-parse only the edited module, class or package of a changed "
+          "buffer where possible, instead of the whole buffer.");
+ABSL_FLAG(bool, incremental_lint, true,
+          "Re-run item-local lint rules only on the edited modules, classes "
+          "or packages of a changed buffer, instead of the whole buffer.");
 
 namespace verilog {
-static absl::StatusOr<std::vector<verible::LintRuleStatus>> RunLinter(
-    absl::string_view filename, const verilog::VerilogAnalyzer &parser) {
+// Returns the rules configured by "config", for comparison.
+static std::string ConfiguredRules(const verilog::LinterConfiguration &config) {
+  verilog::RuleBundle rules;
+  config.GetRuleBundle(&rules);
+  return rules.UnparseConfiguration(',');
+}
+
+// Lints the analyzed "parser", only partially if "previous" was linted with
+// the same "rules".
+static absl::StatusOr<verilog::VerilogLintResult> RunLinter(
+    absl::string_view filename, const verilog::VerilogAnalyzer &parser,
+    const ParsedBuffer *previous, std::string *rules) {
   const auto &text_structure = parser.Data();
 
   verilog::LinterConfiguration config;
@@ -46,33 +78,138 @@ static absl::StatusOr<std::vector<verible::LintRuleStatus>> RunLinter(
   } else {
     LOG(ERROR) << from_flags.status().message() << std::endl;
   }
+  *rules = ConfiguredRules(config);
+
+  if (previous != nullptr && absl::GetFlag(FLAGS_incremental_lint) &&
+      previous->lint_rules() == *rules) {
+    return VerilogLintEditedTextStructure(
+        filename, config, text_structure, &previous->parser().Data(),
+        &previous->lint(), &parser.CommentDirectives());
+  }
+  return VerilogLintEditedTextStructure(filename, config, text_structure,
+                                        nullptr, nullptr,
+                                        &parser.CommentDirectives());
+}
 
-  return VerilogLintTextStructure(filename, config, text_structure);
+static std::unique_ptr<verilog::VerilogAnalyzer> AnalyzeContent(
+    absl::string_view uri, const std::shared_ptr<verible::MemBlock> &content,
+    const ParsedBuffer *previous, ParsingModeMemo *parsing_modes) {
+  if (previous != nullptr && absl::GetFlag(FLAGS_incremental_parse)) {
+    if (auto analyzer = verilog::VerilogAnalyzer::ReanalyzeEditedDescription(
+            previous->parser(), content, uri)) {
+      VLOG(1) << "Incrementally re-analyzed " << uri << std::endl;
+      return analyzer;
+    }
+  }
+  // Start with the preprocessor configuration that worked last time.
+  const verilog::VerilogPreprocess::Config *const first_attempt =
+      previous != nullptr ? &previous->parser().PreprocessConfig() : nullptr;
+  const auto analyze = [&]() {
+    return verilog::VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+        content, uri, first_attempt, parsing_modes);
+  };
+  // Only buffers newly opened, typically at startup, are worth looking up in
+  // the cache; edits would just fill it with intermediate versions.
+  if (previous == nullptr) {
+    return verilog::AnalyzeWithParseCache(content, uri,
+                                          "automatic-preprocess-fallback",
+                                          analyze);
+  }
+  return analyze();
 }
 
 ParsedBuffer::ParsedBuffer(int64_t version, absl::string_view uri,
                            absl::string_view content)
+    : ParsedBuffer(version, uri, content, nullptr) {}
+
+ParsedBuffer::ParsedBuffer(int64_t version, absl::string_view uri,
+                           absl::string_view content,
+                           const ParsedBuffer *previous)
+    : ParsedBuffer(version, uri,
+                   std::make_shared<verible::StringMemBlock>(content),
+                   previous) {}
+
+ParsedBuffer::ParsedBuffer(int64_t version, absl::string_view uri,
+                           std::shared_ptr<verible::MemBlock> content,
+                           const ParsedBuffer *previous,
+                           ParsingModeMemo *parsing_modes)
     : version_(version),
       uri_(uri),
-      parser_(verilog::VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
-          content, uri)) {
+      parser_([&]() {
+        const absl::Time start = absl::Now();
+        auto analyzer = AnalyzeContent(uri, content, previous, parsing_modes);
+        parse_time_ = absl::Now() - start;
+        return analyzer;
+      }()),
+      block_index_(parser_->Data()) {
   VLOG(1) << "Analyzed " << uri << " lex:" << parser_->LexStatus()
           << "; parser:" << parser_->ParseStatus() << std::endl;
+  const absl::Time lint_start = absl::Now();
   // TODO(hzeller): should we use a filename not URI ?
-  if (auto lint_result = RunLinter(uri, *parser_); lint_result.ok()) {
-    lint_statuses_ = std::move(lint_result.value());
+  if (auto lint_result = RunLinter(uri, *parser_, previous, &lint_rules_);
+      lint_result.ok()) {
+    lint_ = std::move(lint_result.value());
   }
+  lint_time_ = absl::Now() - lint_start;
+}
+
+const nlohmann::json &ParsedBuffer::document_outline(
+    bool kate_compatible_tags, bool include_variables) const {
+  const std::lock_guard<std::mutex> l(outline_mutex_);
+  std::optional<nlohmann::json> &outline =
+      outlines_[kate_compatible_tags][include_variables];
+  if (!outline) {
+    verible::lsp::DocumentSymbol toplevel;
+    const verible::TextStructureView &text_structure = parser_->Data();
+    DocumentSymbolFiller filler(kate_compatible_tags, include_variables,
+                                text_structure, &toplevel);
+    if (const auto &syntax_tree = text_structure.SyntaxTree()) {
+      syntax_tree->Accept(&filler);
+    }
+    // We cut down one level, not interested in toplevel file:
+    outline = std::move(toplevel.children);
+  }
+  return *outline;
+}
+
+const std::vector<verible::LineColumnRange> &
+ParsedBuffer::identifier_occurrences(absl::string_view name) const {
+  std::call_once(identifiers_indexed_, [this]() {
+    const verible::TextStructureView &text = parser_->Data();
+    for (const verible::TokenInfo &token : text.TokenStream()) {
+      if (token.token_enum() != SymbolIdentifier) continue;
+      identifier_occurrences_[token.text()].push_back(
+          text.GetRangeForToken(token));
+    }
+  });
+  static const std::vector<verible::LineColumnRange> kNone;
+  const auto found = identifier_occurrences_.find(name);
+  return found == identifier_occurrences_.end() ? kNone : found->second;
+}
+
+const std::vector<int> &ParsedBuffer::semantic_tokens() const {
+  std::call_once(semantic_tokens_encoded_, [this]() {
+    semantic_tokens_ = EncodeSemanticTokens(parser_->Data());
+  });
+  return semantic_tokens_;
 }
 
 void BufferTracker::Update(const std::string &uri,
-                           const verible::lsp::EditTextBuffer &txt) {
+                           const verible::lsp::EditTextBuffer &txt,
+                           ParsingModeMemo *parsing_modes) {
   if (current_ && current_->version() == txt.last_global_version()) {
     LOG(DFATAL) << "Testing: Forgot to update version number ?";
     return;  // Nothing to do (we don't really expect this to happen)
   }
-  txt.RequestContent([&txt, &uri, this](absl::string_view content) {
-    current_.reset(new ParsedBuffer(txt.last_global_version(), uri, content));
-  });
+  // The last good parse is the closest complete syntax tree to start an
+  // incremental re-parse from.
+  Update(std::make_shared<ParsedBuffer>(txt.last_global_version(), uri,
+                                       txt.ContentSnapshot(), last_good_.get(),
+                                       parsing_modes));
+}
+
+void BufferTracker::Update(std::shared_ptr<const ParsedBuffer> parsed) {
+  current_ = std::move(parsed);
   if (current_->parsed_successfully()) {
     last_good_ = current_;
   }
@@ -93,27 +230,108 @@ BufferTrackerContainer::GetSubscriptionCallback() {
         }
 
         if (txt) {
+          if (analysis_pool_ != nullptr) {
+            ScheduleAnalysis(uri, *txt);
+            return;
+          }
           const BufferTracker *tracker = Update(uri, *txt);
           // Updated current() and last_good(); Now inform our listeners.
-          for (const auto &change_listener : change_listeners_) {
-            change_listener(uri, tracker);
-          }
+          NotifyChangeListeners(uri, tracker);
         } else {
-          Remove(uri);
-          for (const auto &change_listener : change_listeners_) {
-            change_listener(uri, nullptr);
+          if (auto found = pending_analyses_.find(uri);
+              found != pending_analyses_.end()) {
+            found->second->closed = true;
+            pending_analyses_.erase(found);
           }
+          Remove(uri);
+          NotifyChangeListeners(uri, nullptr);
         }
       };
 }
 
+void BufferTrackerContainer::NotifyChangeListeners(
+    const std::string &uri, const BufferTracker *tracker) {
+  for (const auto &change_listener : change_listeners_) {
+    change_listener(uri, tracker);
+  }
+}
+
+void BufferTrackerContainer::AnalyzeInBackground(verible::ThreadPool *pool,
+                                                 std::mutex *mutex) {
+  analysis_pool_ = ABSL_DIE_IF_NULL(pool);
+  mutex_ = ABSL_DIE_IF_NULL(mutex);
+}
+
+void BufferTrackerContainer::WaitForBackgroundAnalyses() {
+  if (mutex_ == nullptr) return;
+  std::unique_lock<std::mutex> l(*mutex_);
+  jobs_done_.wait(l, [this]() { return active_jobs_ == 0; });
+}
+
+void BufferTrackerContainer::ScheduleAnalysis(
+    const std::string &uri, const verible::lsp::EditTextBuffer &txt) {
+  std::shared_ptr<PendingAnalysis> &pending = pending_analyses_[uri];
+  if (pending == nullptr) pending = std::make_shared<PendingAnalysis>();
+  // Replace whatever older content is still waiting; it is stale now.
+  pending->version = txt.last_global_version();
+  pending->content = txt.ContentSnapshot();
+  if (pending->job_scheduled) return;  // Running job will pick it up.
+
+  pending->job_scheduled = true;
+  ++active_jobs_;
+  (void)analysis_pool_->ExecAsync<bool>([this, uri, pending]() {
+    RunBackgroundAnalysis(uri, pending);
+    return true;
+  });
+}
+
+void BufferTrackerContainer::RunBackgroundAnalysis(
+    const std::string &uri, const std::shared_ptr<PendingAnalysis> &pending) {
+  std::unique_lock<std::mutex> l(*mutex_);
+  while (!pending->closed && pending->content != nullptr) {
+    const int64_t version = pending->version;
+    std::shared_ptr<verible::MemBlock> content = std::move(pending->content);
+    pending->content = nullptr;
+    std::shared_ptr<const ParsedBuffer> previous;
+    if (const BufferTracker *tracker = FindBufferTrackerOrNull(uri)) {
+      previous = tracker->last_good();
+    }
+
+    l.unlock();  // Parse and lint without blocking anyone else.
+    auto parsed = std::make_shared<ParsedBuffer>(
+        version, uri, std::move(content), previous.get(), &parsing_modes_);
+    l.lock();
+
+    if (pending->closed || pending->version != version) {
+      VLOG(1) << "Discarding stale analysis of " << uri << " version "
+              << version << std::endl;
+      continue;
+    }
+
+    // Keep the previous parse alive while the listeners are updated
+    // (see GetSubscriptionCallback()).
+    BufferTracker remember_previous;
+    auto inserted = buffers_.insert({uri, nullptr});
+    if (inserted.second) {
+      inserted.first->second.reset(new BufferTracker());
+    } else {
+      remember_previous = *inserted.first->second;
+    }
+    inserted.first->second->Update(std::move(parsed));
+    NotifyChangeListeners(uri, inserted.first->second.get());
+  }
+  pending->job_scheduled = false;
+  --active_jobs_;
+  jobs_done_.notify_all();
+}
+
 BufferTracker *BufferTrackerContainer::Update(
     const std::string &uri, const verible::lsp::EditTextBuffer &txt) {
   auto inserted = buffers_.insert({uri, nullptr});
   if (inserted.second) {
     inserted.first->second.reset(new BufferTracker());
   }
-  inserted.first->second->Update(uri, txt);
+  inserted.first->second->Update(uri, txt, &parsing_modes_);
   return inserted.first->second.get();
 }
 
@@ -16,18 +16,32 @@
 #ifndef VERILOG_TOOLS_LS_LSP_PARSE_BUFFER_H
 #define VERILOG_TOOLS_LS_LSP_PARSE_BUFFER_H
 
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/analysis/lint_rule_status.h"
 #include "common/lsp/lsp-text-buffer.h"
+#include "common/strings/line_column_map.h"
+#include "common/strings/mem_block.h"
 #include "common/util/logging.h"
+#include "nlohmann/json.hpp"
 #include "verilog/analysis/verilog_analyzer.h"
+#include "verilog/analysis/verilog_linter.h"
+#include "verilog/tools/ls/block-index.h"
+
+namespace verible {
+class ThreadPool;
+}  // namespace verible
 
 // ParseBuffer and BufferTrackerContainer are tracking fully parsed content
 // and are corresponding to verible::lsp::EditTextBuffer and
@@ -46,23 +60,85 @@ class ParsedBuffer {
   ParsedBuffer(int64_t version, absl::string_view uri,
                absl::string_view content);
 
+  // Like above, but if "previous" is not null, attempts to only re-parse and
+  // re-lint the part of "content" that changed relative to it (see
+  // --incremental_parse and --incremental_lint).
+  ParsedBuffer(int64_t version, absl::string_view uri,
+               absl::string_view content, const ParsedBuffer *previous);
+
+  // Like above, but analyzes "content" in place instead of a copy, e.g.
+  // a snapshot of an EditTextBuffer.
+  // If not null, "parsing_modes" remembers the parsing mode inferred for
+  // "uri" for the next analysis (see VerilogAnalyzer::AnalyzeAutomaticMode()).
+  ParsedBuffer(int64_t version, absl::string_view uri,
+               std::shared_ptr<verible::MemBlock> content,
+               const ParsedBuffer *previous,
+               ParsingModeMemo *parsing_modes = nullptr);
+
   bool parsed_successfully() const {
     return parser_->LexStatus().ok() && parser_->ParseStatus().ok();
   }
 
   const verilog::VerilogAnalyzer &parser() const { return *parser_; }
   const std::vector<verible::LintRuleStatus> &lint_result() const {
-    return lint_statuses_;
+    return lint_.statuses;
   }
 
+  // All lint findings, and the rules that produced them (see
+  // --incremental_lint).
+  const verilog::VerilogLintResult &lint() const { return lint_; }
+  const std::string &lint_rules() const { return lint_rules_; }
+
   int64_t version() const { return version_; }
+
+  // Time spent analyzing, i.e. lexing and parsing, and linting the buffer.
+  absl::Duration parse_time() const { return parse_time_; }
+  absl::Duration lint_time() const { return lint_time_; }
   const std::string &uri() const { return uri_; }
 
+  // Begin/end constructs of the buffer, indexed along with the analysis.
+  const BlockIndex &block_index() const { return block_index_; }
+
+  // The following are derived from the parse on first use and then kept, as
+  // clients request them over and over for the same version. They can be
+  // called concurrently.
+
+  // Returns the symbol outline of the buffer (see DocumentSymbolFiller).
+  const nlohmann::json &document_outline(bool kate_compatible_tags,
+                                         bool include_variables) const;
+
+  // Returns the ranges of all identifiers "name" in the token stream, in
+  // order.
+  const std::vector<verible::LineColumnRange> &identifier_occurrences(
+      absl::string_view name) const;
+
+  // Returns the semantic tokens of the buffer in the LSP relative encoding
+  // (see EncodeSemanticTokens()).
+  const std::vector<int> &semantic_tokens() const;
+
  private:
   const int64_t version_;
+  // Set while initializing parser_, so this is declared before it.
+  absl::Duration parse_time_;
+  absl::Duration lint_time_;
   const std::string uri_;
   const std::unique_ptr<verilog::VerilogAnalyzer> parser_;
-  std::vector<verible::LintRuleStatus> lint_statuses_;
+  verilog::VerilogLintResult lint_;
+  std::string lint_rules_;
+  BlockIndex block_index_;
+
+  // Outlines by their options, guarded by outline_mutex_.
+  mutable std::mutex outline_mutex_;
+  mutable std::optional<nlohmann::json> outlines_[2][2];
+
+  // Identifier ranges by name, built once.
+  mutable std::once_flag identifiers_indexed_;
+  mutable absl::flat_hash_map<absl::string_view,
+                              std::vector<verible::LineColumnRange>>
+      identifier_occurrences_;
+
+  mutable std::once_flag semantic_tokens_encoded_;
+  mutable std::vector<int> semantic_tokens_;
 };
 
 // A buffer tracker tracks of a single file EditTextBuffer content and stores
@@ -74,7 +150,13 @@ class BufferTracker {
  public:
   // Update with a changed text buffer from the LSP subsystem. Triggers
   // re-parsing and updating our current() and potentially last_good().
-  void Update(const std::string &uri, const verible::lsp::EditTextBuffer &txt);
+  // "parsing_modes" is passed on to the ParsedBuffer.
+  void Update(const std::string &uri, const verible::lsp::EditTextBuffer &txt,
+              ParsingModeMemo *parsing_modes = nullptr);
+
+  // Update with a buffer that has already been parsed, e.g. in the
+  // background. Updates current() and potentially last_good().
+  void Update(std::shared_ptr<const ParsedBuffer> parsed);
 
   // ---
   // Thread guarantee for the following functions.
@@ -143,7 +225,46 @@ class BufferTrackerContainer {
   // Given the URI, find the associated parse buffer if it exists.
   const BufferTracker *FindBufferTrackerOrNull(const std::string &uri) const;
 
+  // Analyze changed buffers on "pool" instead of synchronously in the
+  // subscription callback, so that the thread feeding changes is never
+  // blocked by parsing or linting.
+  // Edits that arrive while a buffer is waiting for or undergoing analysis
+  // are coalesced: only the latest version is analyzed next, and results of
+  // versions superseded in the meantime are discarded.
+  //
+  // "mutex" serializes access to this container: callers must hold it while
+  // invoking the subscription callback or accessing buffer trackers, and
+  // background analyses hold it while they publish their results through
+  // BufferTracker::current() and call the change listeners.
+  // "pool" and "mutex" must outlive this container.
+  void AnalyzeInBackground(verible::ThreadPool *pool, std::mutex *mutex);
+
+  // Block until all scheduled background analyses are done.
+  // Must be called without holding the mutex passed to AnalyzeInBackground().
+  void WaitForBackgroundAnalyses();
+
  private:
+  // Latest buffer content waiting to be analyzed in the background.
+  struct PendingAnalysis {
+    int64_t version = 0;
+    // Content not yet picked up for analysis, or nullptr.
+    std::shared_ptr<verible::MemBlock> content;
+    bool job_scheduled = false;  // analysis job queued or running
+    bool closed = false;         // buffer was removed in the meantime
+  };
+
+  // Inform all change listeners that "uri" got updated or removed (nullptr).
+  void NotifyChangeListeners(const std::string &uri,
+                             const BufferTracker *tracker);
+
+  // Remember the content of "txt" and make sure it will be analyzed.
+  void ScheduleAnalysis(const std::string &uri,
+                        const verible::lsp::EditTextBuffer &txt);
+
+  // Analyze the pending content of "uri" until there is no newer version.
+  void RunBackgroundAnalysis(const std::string &uri,
+                             const std::shared_ptr<PendingAnalysis> &pending);
+
   // Update internal state of the given "uri" with the content of the text
   // buffer. Return the buffer tracker.
   BufferTracker *Update(const std::string &uri,
@@ -154,6 +275,17 @@ class BufferTrackerContainer {
 
   std::vector<ChangeCallback> change_listeners_;
   std::unordered_map<std::string, std::unique_ptr<BufferTracker>> buffers_;
+
+  // Parsing modes inferred for the buffers, shared by all analyses.
+  ParsingModeMemo parsing_modes_;
+
+  // Background analysis state, guarded by *mutex_.
+  verible::ThreadPool *analysis_pool_ = nullptr;
+  std::mutex *mutex_ = nullptr;
+  std::unordered_map<std::string, std::shared_ptr<PendingAnalysis>>
+      pending_analyses_;
+  int active_jobs_ = 0;
+  std::condition_variable jobs_done_;
 };
 }  // namespace verilog
 #endif  // VERILOG_TOOLS_LS_LSP_PARSE_BUFFER_H
@@ -15,12 +15,19 @@
 #include "verilog/tools/ls/lsp-parse-buffer.h"
 
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 #include "common/lsp/lsp-text-buffer.h"
 #include "common/text/text_structure.h"
+#include "common/strings/line_column_map.h"
+#include "common/util/thread_pool.h"
 #include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
 
 namespace verilog {
 namespace {
@@ -47,6 +54,99 @@ TEST(BufferTraccker, ParseParseErrorDocument) {
   ASSERT_EQ(tracker.last_good().get(), nullptr);
 }
 
+TEST(ParsedBuffer, DerivedArtifactsAreComputedOnce) {
+  const ParsedBuffer buffer(1, "foo.sv",
+                            "module foo(input a);\n"
+                            "  wire b = a;\n"
+                            "endmodule\n");
+  const std::vector<verible::LineColumnRange> &a_ranges =
+      buffer.identifier_occurrences("a");
+  ASSERT_EQ(a_ranges.size(), 2);
+  EXPECT_EQ(a_ranges[0].start.line, 0);
+  EXPECT_EQ(a_ranges[0].start.column, 18);
+  EXPECT_EQ(a_ranges[1].start.line, 1);
+  EXPECT_EQ(a_ranges[1].start.column, 11);
+  EXPECT_EQ(a_ranges[1].end.column, 12);
+  EXPECT_EQ(&buffer.identifier_occurrences("a"), &a_ranges);
+  EXPECT_TRUE(buffer.identifier_occurrences("c").empty());
+  EXPECT_TRUE(buffer.identifier_occurrences("wire").empty());
+
+  const nlohmann::json &outline = buffer.document_outline(false, true);
+  ASSERT_EQ(outline.size(), 1);
+  EXPECT_EQ(outline[0]["name"], "foo");
+  EXPECT_EQ(&buffer.document_outline(false, true), &outline);
+  // Different options give a different outline.
+  EXPECT_NE(&buffer.document_outline(false, false), &outline);
+}
+
+TEST(BufferTraccker, IncrementalUpdate) {
+  BufferTracker tracker;
+  verible::lsp::EditTextBuffer document(
+      "module foo();\nendmodule\nmodule bar();\nendmodule\n");
+  document.set_last_global_version(1);
+  tracker.Update("foo.sv", document);
+  ASSERT_NE(tracker.last_good().get(), nullptr);
+  const auto first = tracker.current();
+
+  // Edit inside of the second module.
+  const verible::lsp::TextDocumentContentChangeEvent change = {
+      .range =
+          {
+              .start = {3, 0},
+              .end = {3, 0},
+          },
+      .has_range = true,
+      .text = "  wire w;\n",
+  };
+  ASSERT_TRUE(document.ApplyChange(change));
+  document.set_last_global_version(2);
+  tracker.Update("foo.sv", document);
+  ASSERT_NE(tracker.current().get(), first.get());
+  EXPECT_TRUE(tracker.current()->parsed_successfully());
+  EXPECT_EQ(tracker.last_good().get(), tracker.current().get());
+  EXPECT_EQ(
+      tracker.current()->parser().Data().Contents(),
+      "module foo();\nendmodule\nmodule bar();\n  wire w;\nendmodule\n");
+
+  // The previous buffer is not affected by the update.
+  EXPECT_EQ(first->parser().Data().Contents(),
+            "module foo();\nendmodule\nmodule bar();\nendmodule\n");
+  EXPECT_TRUE(first->parsed_successfully());
+}
+
+TEST(ParsedBuffer, IncrementalLintMatchesFullLint) {
+  const ParsedBuffer first(1, "foo.sv",
+                           "task automatic foo;\n"
+                           "  $psprintf(\"a\");\n"
+                           "endtask\n"
+                           "task automatic bar;\n"
+                           "endtask\n");
+  ASSERT_TRUE(first.parsed_successfully());
+  constexpr absl::string_view kEdited =
+      "task automatic foo;\n"
+      "  $psprintf(\"a\");\n"
+      "endtask\n"
+      "task automatic bar;\n"
+      "  $psprintf(\"b\");\n"
+      "endtask\n";
+  const ParsedBuffer incremental(2, "foo.sv", kEdited, &first);
+  const ParsedBuffer full(2, "foo.sv", kEdited);
+
+  // Returns the start of each violation, by rule.
+  const auto violations = [](const ParsedBuffer &buffer) {
+    std::vector<std::pair<std::string, int>> starts;
+    const absl::string_view text = buffer.parser().Data().Contents();
+    for (const auto &status : buffer.lint_result()) {
+      for (const auto &violation : status.violations) {
+        starts.emplace_back(status.lint_rule_name, violation.token.left(text));
+      }
+    }
+    return starts;
+  };
+  EXPECT_EQ(violations(incremental), violations(full));
+  EXPECT_EQ(violations(full).size(), 2);
+}
+
 TEST(BufferTrackerConatainer, PopulateBufferCollection) {
   BufferTrackerContainer container;
   auto feed_callback = container.GetSubscriptionCallback();
@@ -124,5 +224,70 @@ TEST(BufferTrackerConatainer, ParseUpdateNotification) {
   EXPECT_EQ(update_remove_count, 1);
 }
 
+TEST(BufferTrackerConatainer, BackgroundAnalysisCoalescesEdits) {
+  std::mutex mutex;
+  verible::ThreadPool pool(1);
+  BufferTrackerContainer container;
+  container.AnalyzeInBackground(&pool, &mutex);
+
+  std::vector<int64_t> published_versions;
+  container.AddChangeListener(
+      [&published_versions](const std::string &, const BufferTracker *tracker) {
+        ASSERT_NE(tracker, nullptr);
+        published_versions.push_back(tracker->current()->version());
+      });
+
+  auto feed_callback = container.GetSubscriptionCallback();
+  verible::lsp::EditTextBuffer doc("module foo(); endmodule");
+  {
+    // While we hold the lock, the analysis can not publish, so all of these
+    // edits are coalesced into one analysis of the latest version.
+    const std::lock_guard<std::mutex> l(mutex);
+    for (int64_t version = 1; version <= 5; ++version) {
+      doc.set_last_global_version(version);
+      feed_callback("foo.sv", &doc);
+    }
+    EXPECT_EQ(container.FindBufferTrackerOrNull("foo.sv"), nullptr);
+  }
+  container.WaitForBackgroundAnalyses();
+
+  const std::lock_guard<std::mutex> l(mutex);
+  const BufferTracker *tracker = container.FindBufferTrackerOrNull("foo.sv");
+  ASSERT_NE(tracker, nullptr);
+  ASSERT_NE(tracker->current(), nullptr);
+  EXPECT_EQ(tracker->current()->version(), 5);
+  EXPECT_EQ(tracker->last_good(), tracker->current());
+  EXPECT_EQ(published_versions, std::vector<int64_t>{5});
+}
+
+TEST(BufferTrackerConatainer, BackgroundAnalysisOfClosedBufferIsDropped) {
+  std::mutex mutex;
+  verible::ThreadPool pool(1);
+  BufferTrackerContainer container;
+  container.AnalyzeInBackground(&pool, &mutex);
+
+  int updates = 0;
+  int removals = 0;
+  container.AddChangeListener(
+      [&](const std::string &, const BufferTracker *tracker) {
+        ++(tracker ? updates : removals);
+      });
+
+  auto feed_callback = container.GetSubscriptionCallback();
+  verible::lsp::EditTextBuffer doc("module foo(); endmodule");
+  {
+    const std::lock_guard<std::mutex> l(mutex);
+    doc.set_last_global_version(1);
+    feed_callback("foo.sv", &doc);
+    feed_callback("foo.sv", nullptr);  // Closed before analysis finished.
+  }
+  container.WaitForBackgroundAnalyses();
+
+  const std::lock_guard<std::mutex> l(mutex);
+  EXPECT_EQ(container.FindBufferTrackerOrNull("foo.sv"), nullptr);
+  EXPECT_EQ(updates, 0);
+  EXPECT_EQ(removals, 1);
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,224 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verilog/tools/ls/semantic-tokens.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "common/lsp/lsp-protocol.h"
+#include "common/strings/line_column_map.h"
+#include "common/strings/utf8.h"
+#include "common/text/concrete_syntax_leaf.h"
+#include "common/text/text_structure.h"
+#include "common/text/token_info.h"
+#include "common/text/tree_context_visitor.h"
+#include "common/util/range.h"
+#include "external_libs/editscript.h"
+#include "verilog/CST/verilog_nonterminals.h"
+#include "verilog/formatting/verilog_token.h"
+#include "verilog/parser/verilog_token_classifications.h"
+#include "verilog/parser/verilog_token_enum.h"
+
+namespace verilog {
+namespace {
+constexpr int kIntsPerToken = 5;
+
+// Beyond this many token edits, a changed region is just replaced as a whole;
+// that is a larger, but still correct, delta found in linear time.
+constexpr int64_t kMaxDiffCost = 256;
+
+// Collects the identifiers whose type is decided by their place in the
+// syntax tree, keyed by the address of their text.
+class IdentifierClassifier : public verible::TreeContextVisitor {
+ public:
+  void Visit(const verible::SyntaxTreeLeaf &leaf) final {
+    const verible::TokenInfo &token = leaf.get();
+    if (token.token_enum() != SymbolIdentifier &&
+        token.token_enum() != EscapedIdentifier) {
+      return;
+    }
+    const verible::SyntaxTreeContext &context = Context();
+    if (context.DirectParentIsOneOf(
+            {NodeEnum::kModuleHeader, NodeEnum::kClassHeader})) {
+      types_[token.text().data()] = kSemanticClass;
+    } else if (context.DirectParentIs(NodeEnum::kPackageDeclaration)) {
+      types_[token.text().data()] = kSemanticNamespace;
+    } else if (context.DirectParentsAre(
+                   {NodeEnum::kUnqualifiedId, NodeEnum::kFunctionHeader}) ||
+               context.DirectParentsAre(
+                   {NodeEnum::kUnqualifiedId, NodeEnum::kTaskHeader})) {
+      types_[token.text().data()] = kSemanticFunction;
+    } else if (context.DirectParentIs(NodeEnum::kParamType) ||
+               context.DirectParentsAre(
+                   {NodeEnum::kUnqualifiedId, NodeEnum::kParamType})) {
+      types_[token.text().data()] = kSemanticParameter;
+    }
+  }
+
+  const absl::flat_hash_map<const char *, SemanticTokenType> &types() const {
+    return types_;
+  }
+
+ private:
+  absl::flat_hash_map<const char *, SemanticTokenType> types_;
+};
+
+// Returns the semantic type of "token", or -1 if it is not reported.
+int ClassifyToken(const verible::TokenInfo &token,
+                  const IdentifierClassifier &identifiers) {
+  const auto e = static_cast<verilog_tokentype>(token.token_enum());
+  if (IsComment(e)) return kSemanticComment;
+  switch (e) {
+    case MacroIdentifier:
+    case MacroCallId:
+    case MacroIdItem:
+    case PP_Identifier:
+      return kSemanticMacro;
+    case PP_define_body:
+      return -1;  // Arbitrary text, possibly many lines.
+    case SystemTFIdentifier:
+      return kSemanticFunction;
+    case SymbolIdentifier:
+    case EscapedIdentifier: {
+      const auto found = identifiers.types().find(token.text().data());
+      return found == identifiers.types().end() ? kSemanticVariable
+                                                : found->second;
+    }
+    default:
+      break;
+  }
+  switch (formatter::GetFormatTokenType(e)) {
+    case formatter::FormatTokenType::keyword:
+      return kSemanticKeyword;
+    case formatter::FormatTokenType::numeric_base:
+    case formatter::FormatTokenType::numeric_literal:
+      return kSemanticNumber;
+    case formatter::FormatTokenType::string_literal:
+      return kSemanticString;
+    default:
+      return -1;
+  }
+}
+}  // namespace
+
+const std::vector<std::string> &SemanticTokenTypeNames() {
+  // Same order as SemanticTokenType.
+  static const std::vector<std::string> kNames = {
+      "keyword", "comment",   "string",    "number",    "macro",
+      "function", "class",    "namespace", "parameter", "variable",
+  };
+  return kNames;
+}
+
+std::vector<int> EncodeSemanticTokens(const verible::TextStructureView &text) {
+  IdentifierClassifier identifiers;
+  if (text.SyntaxTree() != nullptr) identifiers.Walk(*text.SyntaxTree());
+
+  // Single-line pieces of the reported tokens, in text order.
+  struct Piece {
+    int length;  // in characters
+    int type;
+  };
+  const absl::string_view contents = text.Contents();
+  std::vector<Piece> pieces;
+  std::vector<int> offsets;
+  for (const verible::TokenInfo &token : text.TokenStream()) {
+    if (token.isEOF() || !verible::IsSubRange(token.text(), contents)) continue;
+    const int type = ClassifyToken(token, identifiers);
+    if (type < 0) continue;
+    absl::string_view rest = token.text();
+    while (!rest.empty()) {
+      const size_t eol = rest.find('\n');
+      absl::string_view line = rest.substr(0, eol);
+      rest = (eol == absl::string_view::npos) ? absl::string_view()
+                                              : rest.substr(eol + 1);
+      if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+      if (line.empty()) continue;
+      offsets.push_back(line.data() - contents.data());
+      pieces.push_back({verible::utf8_len(line), type});
+    }
+  }
+
+  const std::vector<verible::LineColumn> positions =
+      text.GetLineColumnMap().GetLineColAtSortedOffsets(contents, offsets);
+  std::vector<int> result;
+  result.reserve(pieces.size() * kIntsPerToken);
+  verible::LineColumn previous{0, 0};
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    const verible::LineColumn &pos = positions[i];
+    const int delta_line = pos.line - previous.line;
+    result.push_back(delta_line);
+    result.push_back(delta_line == 0 ? pos.column - previous.column
+                                     : pos.column);
+    result.push_back(pieces[i].length);
+    result.push_back(pieces[i].type);
+    result.push_back(0);  // No modifiers.
+    previous = pos;
+  }
+  return result;
+}
+
+std::vector<verible::lsp::SemanticTokensEdit> DiffSemanticTokens(
+    absl::Span<const int> previous, absl::Span<const int> current) {
+  // Compare whole tokens: with the relative encoding, tokens after an edit
+  // stay equal unless they are the first on the changed lines.
+  auto split_tokens = [](absl::Span<const int> data) {
+    std::vector<absl::Span<const int>> tokens;
+    tokens.reserve(data.size() / kIntsPerToken);
+    for (size_t i = 0; i + kIntsPerToken <= data.size(); i += kIntsPerToken) {
+      tokens.push_back(data.subspan(i, kIntsPerToken));
+    }
+    return tokens;
+  };
+  const std::vector<absl::Span<const int>> before = split_tokens(previous);
+  const std::vector<absl::Span<const int>> after = split_tokens(current);
+
+  diff::DiffOptions options;
+  options.max_cost = kMaxDiffCost;
+  const diff::Edits edits = diff::GetTokenDiffs(
+      before.begin(), before.end(), after.begin(), after.end(), options);
+
+  // Fuse each run of deletions and insertions into one edit.
+  std::vector<verible::lsp::SemanticTokensEdit> result;
+  bool in_run = false;
+  int64_t previous_position = 0;  // in tokens of "before"
+  for (const diff::Edit &edit : edits) {
+    if (edit.operation == diff::Operation::EQUALS) {
+      in_run = false;
+      previous_position = edit.end;
+      continue;
+    }
+    if (!in_run) {
+      result.push_back({});
+      result.back().start = previous_position * kIntsPerToken;
+      in_run = true;
+    }
+    verible::lsp::SemanticTokensEdit &fused = result.back();
+    if (edit.operation == diff::Operation::DELETE) {
+      fused.deleteCount += (edit.end - edit.start) * kIntsPerToken;
+      previous_position = edit.end;
+    } else {
+      const absl::Span<const int> inserted = current.subspan(
+          edit.start * kIntsPerToken, (edit.end - edit.start) * kIntsPerToken);
+      fused.data.insert(fused.data.end(), inserted.begin(), inserted.end());
+    }
+  }
+  return result;
+}
+}  // namespace verilog
@@ -0,0 +1,59 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_SEMANTIC_TOKENS_H_INCLUDED
+#define VERILOG_TOOLS_LS_SEMANTIC_TOKENS_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "common/lsp/lsp-protocol.h"
+#include "common/text/text_structure.h"
+
+namespace verilog {
+// Semantic token types reported to the client. The values are indices into
+// the legend returned by SemanticTokenTypeNames().
+enum SemanticTokenType : int {
+  kSemanticKeyword = 0,
+  kSemanticComment,
+  kSemanticString,
+  kSemanticNumber,
+  kSemanticMacro,
+  kSemanticFunction,
+  kSemanticClass,
+  kSemanticNamespace,
+  kSemanticParameter,
+  kSemanticVariable,
+};
+
+// Names of the SemanticTokenType values, as announced in the
+// semanticTokensProvider legend.
+const std::vector<std::string> &SemanticTokenTypeNames();
+
+// Classifies the tokens of "text" in a single pass over its token stream,
+// using the syntax tree (if any) to tell declared modules, classes, packages,
+// functions and parameters from other identifiers. Returns the LSP relative
+// encoding: five integers (delta line, delta start character, length, type,
+// modifiers) per token. Tokens spanning several lines are reported per line.
+std::vector<int> EncodeSemanticTokens(const verible::TextStructureView &text);
+
+// Returns the edits that turn the encoded tokens "previous" into "current",
+// comparing whole tokens. Edit offsets refer to "previous".
+std::vector<verible::lsp::SemanticTokensEdit> DiffSemanticTokens(
+    absl::Span<const int> previous, absl::Span<const int> current);
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_SEMANTIC_TOKENS_H_INCLUDED
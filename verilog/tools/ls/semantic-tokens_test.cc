@@ -0,0 +1,157 @@
+// Copyright 2023 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verilog/tools/ls/semantic-tokens.h"
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/lsp/lsp-protocol.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verilog/analysis/verilog_analyzer.h"
+
+namespace verilog {
+namespace {
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+
+std::vector<int> Encode(absl::string_view code) {
+  VerilogAnalyzer analyzer(code, "semantic-tokens.sv");
+  EXPECT_TRUE(analyzer.Analyze().ok());
+  return EncodeSemanticTokens(analyzer.Data());
+}
+
+// Applies "edits" to "data" as a client does.
+std::vector<int> ApplyEdits(
+    std::vector<int> data,
+    const std::vector<verible::lsp::SemanticTokensEdit> &edits) {
+  // Edits refer to the original data, so apply them back to front.
+  for (auto it = edits.rbegin(); it != edits.rend(); ++it) {
+    data.erase(data.begin() + it->start,
+               data.begin() + it->start + it->deleteCount);
+    data.insert(data.begin() + it->start, it->data.begin(), it->data.end());
+  }
+  return data;
+}
+
+TEST(SemanticTokensTest, LegendMatchesTypes) {
+  EXPECT_EQ(SemanticTokenTypeNames().size(), kSemanticVariable + 1);
+  EXPECT_EQ(SemanticTokenTypeNames()[kSemanticKeyword], "keyword");
+  EXPECT_EQ(SemanticTokenTypeNames()[kSemanticVariable], "variable");
+}
+
+TEST(SemanticTokensTest, EmptyText) { EXPECT_THAT(Encode(""), IsEmpty()); }
+
+TEST(SemanticTokensTest, RelativePositions) {
+  EXPECT_THAT(Encode("module m;\n"
+                     "  wire w;\n"
+                     "endmodule\n"),
+              ElementsAreArray(std::vector<int>{
+                  0, 0, 6, kSemanticKeyword,  0,  // module
+                  0, 7, 1, kSemanticClass,    0,  // m
+                  1, 2, 4, kSemanticKeyword,  0,  // wire
+                  0, 5, 1, kSemanticVariable, 0,  // w
+                  1, 0, 9, kSemanticKeyword,  0,  // endmodule
+              }));
+}
+
+TEST(SemanticTokensTest, DeclarationsFromSyntaxTree) {
+  const std::vector<int> data = Encode(
+      "package p;\n"
+      "  localparam int P = 8;\n"
+      "  function void f;\n"
+      "  endfunction\n"
+      "endpackage\n");
+  std::vector<int> types;
+  for (size_t i = 3; i < data.size(); i += 5) types.push_back(data[i]);
+  EXPECT_THAT(types, ElementsAre(kSemanticKeyword, kSemanticNamespace,   //
+                                 kSemanticKeyword, kSemanticKeyword,     //
+                                 kSemanticParameter, kSemanticNumber,    //
+                                 kSemanticKeyword, kSemanticKeyword,     //
+                                 kSemanticFunction, kSemanticKeyword,    //
+                                 kSemanticKeyword));
+}
+
+TEST(SemanticTokensTest, MultiLineTokensSplitPerLine) {
+  // Lengths are in characters, not bytes.
+  EXPECT_THAT(Encode("/* \xc3\xa4\n"
+                     "\n"
+                     "b */\n"),
+              ElementsAreArray(std::vector<int>{
+                  0, 0, 4, kSemanticComment, 0,  //
+                  2, 0, 4, kSemanticComment, 0,  //
+              }));
+}
+
+TEST(SemanticTokensTest, MacrosAndSystemCalls) {
+  const std::vector<int> data = Encode(
+      "`define FOO 1\n"
+      "module m;\n"
+      "  initial $display(`FOO);\n"
+      "endmodule\n");
+  std::vector<int> types;
+  for (size_t i = 3; i < data.size(); i += 5) types.push_back(data[i]);
+  EXPECT_THAT(types, ElementsAre(kSemanticKeyword, kSemanticMacro,      //
+                                 kSemanticKeyword, kSemanticClass,      //
+                                 kSemanticKeyword, kSemanticFunction,   //
+                                 kSemanticMacro, kSemanticKeyword));
+}
+
+TEST(SemanticTokensDiffTest, EqualDataHasNoEdits) {
+  const std::vector<int> data = {0, 0, 6, 0, 0, 0, 7, 1, 6, 0};
+  EXPECT_THAT(DiffSemanticTokens(data, data), IsEmpty());
+}
+
+TEST(SemanticTokensDiffTest, InsertedToken) {
+  const std::vector<int> before = {0, 0, 6, 0, 0, 1, 0, 9, 0, 0};
+  const std::vector<int> after = {0, 0, 6, 0, 0, 0, 7, 1, 6, 0,
+                                  1, 0, 9, 0, 0};
+  const auto edits = DiffSemanticTokens(before, after);
+  ASSERT_EQ(edits.size(), 1);
+  EXPECT_EQ(edits[0].start, 5);
+  EXPECT_EQ(edits[0].deleteCount, 0);
+  EXPECT_THAT(edits[0].data, ElementsAre(0, 7, 1, 6, 0));
+}
+
+TEST(SemanticTokensDiffTest, ReplacedAndDeletedTokens) {
+  const std::vector<int> before = {0, 0, 1, 0, 0,  //
+                                   0, 2, 1, 1, 0,  //
+                                   0, 2, 1, 2, 0,  //
+                                   0, 2, 1, 3, 0};
+  const std::vector<int> after = {0, 0, 1, 0, 0,  //
+                                  0, 2, 1, 9, 0,  //
+                                  0, 2, 1, 2, 0};
+  const auto edits = DiffSemanticTokens(before, after);
+  EXPECT_EQ(edits.size(), 2);
+  EXPECT_EQ(ApplyEdits(before, edits), after);
+}
+
+TEST(SemanticTokensDiffTest, ApplyingEditsRestoresCurrent) {
+  std::vector<int> before;
+  std::vector<int> after;
+  for (int i = 0; i < 1000; ++i) {
+    const std::vector<int> token = {1, i % 7, 3, i % 10, 0};
+    before.insert(before.end(), token.begin(), token.end());
+    if (i % 97 == 3) continue;  // deleted
+    if (i % 89 == 5) after.insert(after.end(), {0, 1, 2, 3, 0});  // inserted
+    after.insert(after.end(), token.begin(), token.end());
+  }
+  EXPECT_EQ(ApplyEdits(before, DiffSemanticTokens(before, after)), after);
+  EXPECT_EQ(ApplyEdits(after, DiffSemanticTokens(after, before)), before);
+}
+}  // namespace
+}  // namespace verilog
@@ -13,26 +13,36 @@
 // limitations under the License.
 //
 
+#include "common/util/memory_usage.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "common/lsp/lsp-file-utils.h"
+#include "common/lsp/lsp-protocol-enums.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/strings/line_column_map.h"
 #include "common/text/symbol.h"
@@ -42,6 +52,8 @@
 #include "common/util/iterator_adaptors.h"
 #include "common/util/logging.h"
 #include "common/util/range.h"
+#include "common/util/thread_pool.h"
+#include "common/util/tree_operations.h"
 #include "verilog/analysis/symbol_table.h"
 #include "verilog/analysis/verilog_analyzer.h"
 #include "verilog/analysis/verilog_filelist.h"
@@ -52,6 +64,16 @@
 ABSL_FLAG(std::string, file_list_path, "verible.filelist",
           "Name of the file with Verible FileList for the project");
 
+ABSL_FLAG(int, project_parse_threads, 0,
+          "If positive, open the file list and parse the project files on "
+          "this many threads when (re)building the project symbol table.");
+
+ABSL_FLAG(int, project_token_memory_budget_mb, 0,
+          "If positive, after building the project symbol table, drop the "
+          "token streams of project files not open in the editor, largest "
+          "first, until they take at most this many megabytes. The syntax "
+          "trees and contents that the symbol table refers to are kept.");
+
 using verible::lsp::LSPUriToPath;
 using verible::lsp::PathToLSPUri;
 
@@ -89,6 +111,106 @@ static void LogFullIfVLog(const std::vector<absl::Status> &statuses) {
   }
 }
 
+namespace {
+// Most symbols returned for a workspace/symbol request; the client is
+// expected to refine the query.
+constexpr size_t kMaxWorkspaceSymbols = 1000;
+
+// Minimum query length matched anywhere in the names, not just as prefix.
+constexpr size_t kTrigramLength = 3;
+
+// Accounts the time until the end of the scope to a kind of lookup.
+class ScopedLookupTimer {
+ public:
+  explicit ScopedLookupTimer(SymbolTableHandler::LookupStats *stats)
+      : stats_(stats), start_(absl::Now()) {}
+  ~ScopedLookupTimer() {
+    ++stats_->count;
+    stats_->total_time += absl::Now() - start_;
+  }
+
+ private:
+  SymbolTableHandler::LookupStats *const stats_;
+  const absl::Time start_;
+};
+}  // namespace
+
+// Returns the trigram of 'text' starting at 'pos'.
+static uint32_t TrigramAt(absl::string_view text, size_t pos) {
+  return static_cast<uint8_t>(text[pos]) << 16 |
+         static_cast<uint8_t>(text[pos + 1]) << 8 |
+         static_cast<uint8_t>(text[pos + 2]);
+}
+
+static int SymbolKindOf(const SymbolTableNode &node) {
+  using verible::lsp::SymbolKind;
+  switch (node.Value().metatype) {
+    case SymbolMetaType::kClass:
+    case SymbolMetaType::kTypeAlias:
+      return SymbolKind::kClass;
+    case SymbolMetaType::kModule:
+      return SymbolKind::kModule;
+    case SymbolMetaType::kGenerate:
+      return SymbolKind::kNamespace;
+    case SymbolMetaType::kPackage:
+      return SymbolKind::kPackage;
+    case SymbolMetaType::kParameter:
+      return SymbolKind::kConstant;
+    case SymbolMetaType::kFunction:
+    case SymbolMetaType::kTask: {
+      const SymbolTableNode *parent = node.Parent();
+      return parent && parent->Value().metatype == SymbolMetaType::kClass
+                 ? SymbolKind::kMethod
+                 : SymbolKind::kFunction;
+    }
+    case SymbolMetaType::kStruct:
+      return SymbolKind::kStruct;
+    case SymbolMetaType::kEnumType:
+      return SymbolKind::kEnum;
+    case SymbolMetaType::kEnumConstant:
+      return SymbolKind::kEnumMember;
+    case SymbolMetaType::kInterface:
+      return SymbolKind::kInterface;
+    default:
+      return SymbolKind::kVariable;
+  }
+}
+
+// Returns the edits replacing the "names" that are part of "text" with
+// "new_name", ordered by their location. Repeated or overlapping names are
+// only replaced once.
+static std::vector<verible::lsp::TextEdit> CreateRenameEdits(
+    const verible::TextStructureView &text,
+    std::vector<absl::string_view> names, const std::string &new_name) {
+  names.erase(std::remove_if(names.begin(), names.end(),
+                             [&text](absl::string_view name) {
+                               return !text.ContainsText(name);
+                             }),
+              names.end());
+  std::sort(names.begin(), names.end(),
+            [](absl::string_view a, absl::string_view b) {
+              return a.begin() < b.begin();
+            });
+
+  // Keeps the first of overlapping names.
+  size_t kept = 0;
+  for (const absl::string_view name : names) {
+    if (kept > 0 && name.begin() < names[kept - 1].end()) continue;
+    names[kept++] = name;
+  }
+  names.resize(kept);
+
+  std::vector<verible::lsp::TextEdit> edits;
+  edits.reserve(names.size());
+  for (const verible::LineColumnRange &range : text.GetRangesForTexts(names)) {
+    edits.push_back(verible::lsp::TextEdit{
+        .range = RangeFromLineColumn(range),
+        .newText = new_name,
+    });
+  }
+  return edits;
+}
+
 std::string FindFileList(absl::string_view current_dir) {
   // search for FileList file up the directory hierarchy
   std::string projectpath;
@@ -106,13 +228,16 @@ std::string FindFileList(absl::string_view current_dir) {
 
 void SymbolTableHandler::SetProject(
     const std::shared_ptr<VerilogProject> &project) {
+  index_queue_.clear();  // Files of the previous project.
   curr_project_ = project;
   ResetSymbolTable();
+  files_dirty_ = true;
   if (curr_project_) LoadProjectFileList(curr_project_->TranslationUnitRoot());
 }
 
 void SymbolTableHandler::ResetSymbolTable() {
   symbol_table_ = std::make_unique<SymbolTable>(curr_project_.get());
+  ++generation_;
 }
 
 void SymbolTableHandler::ParseProjectFiles() {
@@ -121,34 +246,162 @@ void SymbolTableHandler::ParseProjectFiles() {
   // Parse all files separate from SymbolTable::Build() to report parse duration
   VLOG(1) << "Parsing project files...";
   const absl::Time start = absl::Now();
-  std::vector<absl::Status> results;
-  for (auto &unit : *curr_project_) {
-    VerilogSourceFile *const verilog_file = unit.second.get();
-    if (verilog_file->is_parsed()) continue;
-    results.emplace_back(verilog_file->Parse());
-  }
+  const std::vector<absl::Status> results =
+      curr_project_->ParseFiles(absl::GetFlag(FLAGS_project_parse_threads));
   LogFullIfVLog(results);
 
   VLOG(1) << "VerilogSourceFile::Parse() for " << results.size()
           << " files: " << (absl::Now() - start);
 }
 
-std::vector<absl::Status> SymbolTableHandler::BuildProjectSymbolTable() {
+std::vector<absl::Status> SymbolTableHandler::BuildProjectSymbolTable(
+    bool resolve) {
   if (!curr_project_) {
     return {absl::UnavailableError("VerilogProject is not set")};
   }
+  const absl::Time start = absl::Now();
   ResetSymbolTable();
   ParseProjectFiles();
 
   std::vector<absl::Status> buildstatus;
   symbol_table_->Build(&buildstatus);
-  symbol_table_->Resolve(&buildstatus);
+  if (resolve) symbol_table_->Resolve(&buildstatus);
+  references_resolved_ = resolve;
   LogFullIfVLog(buildstatus);
+  BuildSymbolIndex();
+  ReleaseTokenStreamsOverBudget();
 
   files_dirty_ = false;
+  changed_files_.clear();
+  ++rebuild_stats_.full_count;
+  rebuild_stats_.full_time += absl::Now() - start;
   return buildstatus;
 }
 
+void SymbolTableHandler::ReleaseTokenStreamsOverBudget() {
+  const int budget_mb = absl::GetFlag(FLAGS_project_token_memory_budget_mb);
+  if (budget_mb <= 0 || !curr_project_) return;
+  const size_t budget = static_cast<size_t>(budget_mb) << 20;
+
+  // Files open in the editor share the editor's parse, which reports no
+  // usage here, so only the other project files are considered.
+  std::vector<std::pair<size_t, VerilogSourceFile *>> usages;
+  size_t total = 0;
+  for (const auto &[name, file] : *curr_project_) {
+    const size_t bytes = file->TokenStreamMemoryUsage();
+    if (bytes == 0) continue;
+    usages.emplace_back(bytes, file.get());
+    total += bytes;
+  }
+  if (total <= budget) return;
+
+  // Largest first, to keep the token streams of as many files as possible.
+  std::sort(usages.begin(), usages.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  int released = 0;
+  for (const auto &[bytes, file] : usages) {
+    if (total <= budget) break;
+    file->ReleaseTokenStream();
+    total -= bytes;
+    ++released;
+  }
+  VLOG(1) << "Released the token streams of " << released
+          << " project files, " << total << " bytes of tokens remain.";
+}
+
+verible::MemoryUsage SymbolTableHandler::GetMemoryUsage() const {
+  verible::MemoryUsage usage;
+  if (symbol_table_) usage.Add("symbol_table.", symbol_table_->MemoryUsage());
+  if (curr_project_) usage.Add("files.", curr_project_->MemoryUsage());
+  return usage;
+}
+
+int SymbolTableHandler::IndexInBackground(
+    verible::ThreadPool *pool, std::mutex *mutex,
+    const IndexProgressCallback &progress) {
+  if (!curr_project_) return 0;
+  index_pool_ = pool;
+  index_mutex_ = mutex;
+  index_progress_ = progress;
+  index_stopped_ = false;
+
+  // Start with an empty symbol table that is completed file by file.
+  ResetSymbolTable();
+  references_resolved_ = false;
+  files_dirty_ = false;
+  changed_files_.clear();
+  index_queue_.clear();
+  for (const auto &[name, file] : *curr_project_) {
+    if (file->is_parsed()) {
+      changed_files_.insert(name);
+    } else {
+      index_queue_.push_back(name);
+    }
+  }
+  index_total_ = index_queue_.size();
+  index_done_ = 0;
+  VLOG(1) << "Indexing " << index_total_ << " files in the background.";
+
+  // One job per file, each parsing the next one still queued then.
+  index_jobs_ += index_total_;
+  for (int i = 0; i < index_total_; ++i) {
+    (void)pool->ExecAsync<bool>([this]() { return IndexNextQueuedFile(); });
+  }
+  return index_total_;
+}
+
+bool SymbolTableHandler::IndexNextQueuedFile() {
+  std::unique_lock<std::mutex> l(*index_mutex_);
+  bool indexed = false;
+  if (!index_queue_.empty() && !index_stopped_) {
+    const std::string name = std::move(index_queue_.front());
+    index_queue_.pop_front();
+    indexed = ParseUnparsedFile(name, &l);
+    CountIndexedFile();
+  }
+  if (--index_jobs_ == 0) index_finished_.notify_all();
+  return indexed;
+}
+
+bool SymbolTableHandler::ParseUnparsedFile(const std::string &name,
+                                           std::unique_lock<std::mutex> *l) {
+  const VerilogSourceFile *file = curr_project_->LookupRegisteredFile(name);
+  const std::shared_ptr<verible::MemBlock> content =
+      file && !file->is_parsed() ? file->GetContentBlock() : nullptr;
+  if (!content) return false;
+  const std::string resolved_path(file->ResolvedPath());
+  absl::Status status;
+  l->unlock();  // Parse without blocking lookups.
+  std::unique_ptr<VerilogAnalyzer> analyzed =
+      VerilogSourceFile::Analyze(content, resolved_path, &status);
+  l->lock();
+  // In the meantime, the file might have been replaced or parsed.
+  VerilogSourceFile *current = curr_project_->LookupRegisteredFile(name);
+  const bool parsed = !index_stopped_ && current &&
+                      current->GetContentBlock() == content &&
+                      current->SetAnalysis(std::move(analyzed), status);
+  if (parsed && !files_dirty_) changed_files_.insert(name);
+  return parsed;
+}
+
+void SymbolTableHandler::CountIndexedFile() {
+  ++index_done_;
+  if (index_progress_ && !index_stopped_) {
+    index_progress_(index_done_, index_total_);
+  }
+}
+
+void SymbolTableHandler::WaitForBackgroundIndexing() {
+  if (!index_mutex_) return;
+  std::unique_lock<std::mutex> l(*index_mutex_);
+  index_finished_.wait(l, [this]() { return index_jobs_ == 0; });
+}
+
+void SymbolTableHandler::StopBackgroundIndexing() {
+  index_queue_.clear();
+  index_stopped_ = true;
+}
+
 bool SymbolTableHandler::LoadProjectFileList(absl::string_view current_dir) {
   VLOG(1) << __FUNCTION__;
   if (!curr_project_) return false;
@@ -195,15 +448,28 @@ bool SymbolTableHandler::LoadProjectFileList(absl::string_view current_dir) {
     curr_project_->AddIncludePath(incdir);
   }
 
+  // Files already in the project keep their part of the symbol table.
+  absl::flat_hash_set<const VerilogSourceFile *> known_files;
+  for (const auto &[name, file] : *curr_project_) {
+    known_files.insert(file.get());
+  }
+
   // Add files from file list to the project
   VLOG(1) << "Resolving " << filelist.file_paths.size() << " files.";
   int actually_opened = 0;
   const absl::Time start = absl::Now();
+  std::vector<std::string> canonicalized_paths;
+  canonicalized_paths.reserve(filelist.file_paths.size());
   for (const auto &file_in_project : filelist.file_paths) {
-    const std::string canonicalized =
-        std::filesystem::path(file_in_project).lexically_normal().string();
-    absl::StatusOr<VerilogSourceFile *> source =
-        curr_project_->OpenTranslationUnit(canonicalized);
+    canonicalized_paths.push_back(
+        std::filesystem::path(file_in_project).lexically_normal().string());
+  }
+  std::vector<absl::StatusOr<VerilogSourceFile *>> sources =
+      curr_project_->OpenTranslationUnits(
+          canonicalized_paths, absl::GetFlag(FLAGS_project_parse_threads));
+  for (size_t i = 0; i < canonicalized_paths.size(); ++i) {
+    const std::string &canonicalized = canonicalized_paths[i];
+    absl::StatusOr<VerilogSourceFile *> &source = sources[i];
     if (!source.ok()) source = curr_project_->OpenIncludedFile(canonicalized);
     if (!source.ok()) {
       VLOG(1) << "File included in " << filelist_path_
@@ -213,64 +479,173 @@ bool SymbolTableHandler::LoadProjectFileList(absl::string_view current_dir) {
     ++actually_opened;
   }
 
-  // It could be that we just (re-) opened all the exactly same files, so
-  // setting files_dirty_ here might overstate it. However, good conservative
-  // estimate.
-  files_dirty_ |= (actually_opened > 0);
+  // Only the files that were not in the project before need to be added to
+  // the symbol table.
+  int added = 0;
+  for (const auto &[name, file] : *curr_project_) {
+    if (known_files.contains(file.get())) continue;
+    ++added;
+    if (!files_dirty_) changed_files_.insert(name);
+  }
 
-  VLOG(1) << "Successfully opened " << actually_opened
-          << " files from file-list: " << (absl::Now() - start);
+  VLOG(1) << "Successfully opened " << actually_opened << " files from "
+          << "file-list, " << added << " new: " << (absl::Now() - start);
   return true;
 }
 
-const SymbolTableNode *ScanSymbolTreeForDefinitionReferenceComponents(
-    const ReferenceComponentNode *ref, absl::string_view symbol) {
-  if (verible::IsSubRange(symbol, ref->Value().identifier)) {
-    return ref->Value().resolved_symbol;
+void SymbolTableHandler::ClearIncludeDirectoryCache() {
+  if (curr_project_) curr_project_->ClearIncludeDirectoryCache();
+}
+
+void SymbolTableHandler::BuildSymbolIndex() {
+  const absl::Time start = absl::Now();
+  ++generation_;
+  definitions_by_location_.clear();
+  references_by_name_.clear();
+  references_by_location_.clear();
+  // Pre-order, so that the first entry for a location is the one that a
+  // search from the root would find.
+  symbol_table_->Root().ApplyPreOrder([this](const SymbolTableNode &node) {
+    const SymbolInfo &info = node.Value();
+    if (node.Key()) {
+      definitions_by_location_.try_emplace(
+          node.Key()->data(), DefinitionLocation{*node.Key(), &node});
+    }
+    for (const absl::string_view sdef : info.supplement_definitions) {
+      definitions_by_location_.try_emplace(sdef.data(),
+                                           DefinitionLocation{sdef, &node});
+    }
+    for (const auto &ref : info.local_references_to_bind) {
+      if (ref.Empty()) continue;
+      verible::ApplyPreOrder(
+          *ref.components,
+          [this, &node, &info, &ref](const ReferenceComponent &component) {
+            references_by_name_[component.identifier].push_back(
+                {&component, info.file_origin});
+            references_by_location_.try_emplace(
+                component.identifier.data(),
+                ReferenceLocation{&component, &ref, &node});
+            if (component.resolved_symbol) {
+              definitions_by_location_.try_emplace(
+                  component.identifier.data(),
+                  DefinitionLocation{component.identifier,
+                                     component.resolved_symbol});
+            }
+          });
+    }
+  });
+  BuildSymbolNameIndex();
+  VLOG(1) << "Indexed " << definitions_by_location_.size()
+          << " symbol locations, " << references_by_name_.size()
+          << " referenced names and " << symbols_by_name_.size()
+          << " symbol names: " << (absl::Now() - start);
+}
+
+void SymbolTableHandler::BuildSymbolNameIndex() {
+  symbols_by_name_.clear();
+  symbol_name_trigrams_.clear();
+  symbol_table_->Root().ApplyPreOrder([this](const SymbolTableNode &node) {
+    // Anonymous scopes have names starting with a non-identifier character.
+    if (!node.Key() || node.Key()->empty() || (*node.Key())[0] == '%') return;
+    symbols_by_name_.push_back({absl::AsciiStrToLower(*node.Key()), &node});
+  });
+  std::sort(symbols_by_name_.begin(), symbols_by_name_.end(),
+            [](const NamedSymbol &a, const NamedSymbol &b) {
+              return a.folded_name < b.folded_name;
+            });
+  for (uint32_t i = 0; i < symbols_by_name_.size(); ++i) {
+    const absl::string_view name = symbols_by_name_[i].folded_name;
+    for (size_t pos = 0; pos + kTrigramLength <= name.size(); ++pos) {
+      std::vector<uint32_t> &positions =
+          symbol_name_trigrams_[TrigramAt(name, pos)];
+      // Names are visited in order; only list a name once per trigram.
+      if (positions.empty() || positions.back() != i) positions.push_back(i);
+    }
   }
-  for (const auto &childref : ref->Children()) {
-    const SymbolTableNode *resolved =
-        ScanSymbolTreeForDefinitionReferenceComponents(&childref, symbol);
-    if (resolved) return resolved;
+}
+
+const SymbolTableNode *SymbolTableHandler::LookupDefinition(
+    absl::string_view symbol) {
+  const auto found = definitions_by_location_.find(symbol.data());
+  if (found == definitions_by_location_.end()) {
+    return ResolveReferenceAt(symbol);
   }
-  return nullptr;
+  const DefinitionLocation &definition = found->second;
+  // A definition's name is within the symbol, a reference contains it.
+  if (!verible::IsSubRange(definition.text, symbol) &&
+      !verible::IsSubRange(symbol, definition.text)) {
+    return nullptr;
+  }
+  return definition.node;
 }
 
-const SymbolTableNode *SymbolTableHandler::ScanSymbolTreeForDefinition(
-    const SymbolTableNode *context, absl::string_view symbol) {
-  if (!context) {
+const SymbolTableNode *SymbolTableHandler::ResolveReferenceAt(
+    absl::string_view symbol) {
+  const auto found = references_by_location_.find(symbol.data());
+  if (found == references_by_location_.end()) return nullptr;
+  const ReferenceLocation site = found->second;
+  const absl::string_view identifier = site.component->identifier;
+  if (!verible::IsSubRange(identifier, symbol) &&
+      !verible::IsSubRange(symbol, identifier)) {
     return nullptr;
   }
-  // TODO (glatosinski): reduce searched scope by utilizing information from
-  // syntax tree?
-  if (context->Key() && verible::IsSubRange(*context->Key(), symbol)) {
-    return context;
+  if (!site.component->resolved_symbol && !references_resolved_) {
+    // Resolving the reference tree only needs the definitions it names,
+    // unless it refers to members of types that are references themselves.
+    std::vector<absl::Status> diagnostics;
+    site.references->Resolve(*site.context, &diagnostics);
+    if (!site.component->resolved_symbol) ResolveAllReferences();
   }
-  for (const auto &sdef : context->Value().supplement_definitions) {
-    if (verible::IsSubRange(sdef, symbol)) {
-      return context;
-    }
+  const SymbolTableNode *resolved = site.component->resolved_symbol;
+  if (resolved) {
+    definitions_by_location_.try_emplace(
+        identifier.data(), DefinitionLocation{identifier, resolved});
   }
-  for (const auto &ref : context->Value().local_references_to_bind) {
-    if (ref.Empty()) continue;
-    const SymbolTableNode *resolved =
-        ScanSymbolTreeForDefinitionReferenceComponents(ref.components.get(),
-                                                       symbol);
-    if (resolved) return resolved;
-  }
-  for (const auto &child : context->Children()) {
-    const SymbolTableNode *res =
-        ScanSymbolTreeForDefinition(&child.second, symbol);
-    if (res) {
-      return res;
-    }
+  return resolved;
+}
+
+void SymbolTableHandler::ResolveAllReferences() {
+  const absl::Time start = absl::Now();
+  std::vector<absl::Status> diagnostics;
+  symbol_table_->Resolve(&diagnostics);
+  LogFullIfVLog(diagnostics);
+  references_resolved_ = true;
+  BuildSymbolIndex();
+  VLOG(1) << "Resolved all references: " << (absl::Now() - start);
+}
+
+void SymbolTableHandler::UpdateChangedFilesSymbolTable() {
+  const absl::Time start = absl::Now();
+  std::vector<absl::Status> buildstatus;
+  for (const std::string &path : changed_files_) {
+    symbol_table_->BuildSingleTranslationUnit(path, &buildstatus);
   }
-  return nullptr;
+  // Otherwise, the references are still resolved on demand.
+  if (references_resolved_) symbol_table_->ResolveAffected(&buildstatus);
+  LogFullIfVLog(buildstatus);
+  BuildSymbolIndex();
+  ReleaseTokenStreamsOverBudget();
+  const absl::Duration duration = absl::Now() - start;
+  VLOG(1) << "Updated symbol table for " << changed_files_.size()
+          << " changed files: " << duration;
+  ++rebuild_stats_.incremental_count;
+  rebuild_stats_.incremental_files += changed_files_.size();
+  rebuild_stats_.incremental_time += duration;
+  changed_files_.clear();
 }
 
 void SymbolTableHandler::Prepare() {
   LoadProjectFileList(curr_project_->TranslationUnitRoot());
-  if (files_dirty_) BuildProjectSymbolTable();
+  if (files_dirty_) {
+    BuildProjectSymbolTable(/*resolve=*/false);
+  } else if (!changed_files_.empty()) {
+    UpdateChangedFilesSymbolTable();
+  }
+}
+
+void SymbolTableHandler::PrepareResolved() {
+  Prepare();
+  if (!references_resolved_) ResolveAllReferences();
 }
 
 std::optional<verible::TokenInfo>
@@ -366,6 +741,7 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindDefinitionLocation(
     const verilog::BufferTrackerContainer &parsed_buffers) {
   // TODO add iterating over multiple definitions
   Prepare();
+  const ScopedLookupTimer timer(&lookup_stats_["definition"]);
   const std::string filepath = LSPUriToPath(params.textDocument.uri);
   std::string relativepath = curr_project_->GetRelativePathToSource(filepath);
   std::optional<verible::TokenInfo> token =
@@ -381,9 +757,7 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindDefinitionLocation(
     return {};
   }
 
-  const SymbolTableNode &root = symbol_table_->Root();
-
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
+  const SymbolTableNode *node = LookupDefinition(symbol);
   // Symbol not found
   if (!node) return {};
   std::vector<verible::lsp::Location> locations;
@@ -401,7 +775,8 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindDefinitionLocation(
 const SymbolTableNode *SymbolTableHandler::FindDefinitionNode(
     absl::string_view symbol) {
   Prepare();
-  return ScanSymbolTreeForDefinition(&symbol_table_->Root(), symbol);
+  const ScopedLookupTimer timer(&lookup_stats_["definition node"]);
+  return LookupDefinition(symbol);
 }
 
 const verible::Symbol *SymbolTableHandler::FindDefinitionSymbol(
@@ -411,21 +786,80 @@ const verible::Symbol *SymbolTableHandler::FindDefinitionSymbol(
   return nullptr;
 }
 
+std::vector<verible::lsp::SymbolInformation>
+SymbolTableHandler::FindWorkspaceSymbols(
+    const verible::lsp::WorkspaceSymbolParams &params) {
+  Prepare();
+  const ScopedLookupTimer timer(&lookup_stats_["workspace symbol"]);
+  const std::string query = absl::AsciiStrToLower(params.query);
+  std::vector<const NamedSymbol *> matches;
+  if (query.size() < kTrigramLength) {
+    auto it = std::lower_bound(
+        symbols_by_name_.begin(), symbols_by_name_.end(), query,
+        [](const NamedSymbol &symbol, absl::string_view prefix) {
+          return symbol.folded_name < prefix;
+        });
+    for (; it != symbols_by_name_.end(); ++it) {
+      if (matches.size() >= kMaxWorkspaceSymbols) break;
+      if (!absl::StartsWith(it->folded_name, query)) break;
+      matches.push_back(&*it);
+    }
+  } else {
+    // Matching names contain all trigrams of the query; only check the
+    // names containing the rarest one.
+    const std::vector<uint32_t> *candidates = nullptr;
+    for (size_t pos = 0; pos + kTrigramLength <= query.size(); ++pos) {
+      const auto found = symbol_name_trigrams_.find(TrigramAt(query, pos));
+      if (found == symbol_name_trigrams_.end()) return {};
+      if (!candidates || found->second.size() < candidates->size()) {
+        candidates = &found->second;
+      }
+    }
+    for (const uint32_t i : *candidates) {
+      if (matches.size() >= kMaxWorkspaceSymbols) break;
+      const NamedSymbol &symbol = symbols_by_name_[i];
+      if (absl::StrContains(symbol.folded_name, query)) {
+        matches.push_back(&symbol);
+      }
+    }
+  }
+
+  std::vector<verible::lsp::SymbolInformation> result;
+  result.reserve(matches.size());
+  for (const NamedSymbol *symbol : matches) {
+    const SymbolTableNode &node = *symbol->node;
+    std::optional<verible::lsp::Location> location =
+        GetLocationFromSymbolName(*node.Key(), node.Value().file_origin);
+    if (!location) continue;
+    verible::lsp::SymbolInformation &info = result.emplace_back();
+    info.name = std::string(*node.Key());
+    info.kind = SymbolKindOf(node);
+    info.location = std::move(*location);
+    const SymbolTableNode *parent = node.Parent();
+    if (parent && parent->Key() && !parent->Key()->empty() &&
+        (*parent->Key())[0] != '%') {
+      info.containerName = std::string(*parent->Key());
+      info.has_containerName = true;
+    }
+  }
+  return result;
+}
+
 std::vector<verible::lsp::Location> SymbolTableHandler::FindReferencesLocations(
     const verible::lsp::ReferenceParams &params,
     const verilog::BufferTrackerContainer &parsed_buffers) {
-  Prepare();
+  PrepareResolved();
   std::optional<verible::TokenInfo> token =
       GetTokenAtTextDocumentPosition(params, parsed_buffers);
   if (!token) return {};
   const absl::string_view symbol = token->text();
-  const SymbolTableNode &root = symbol_table_->Root();
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
+  const ScopedLookupTimer timer(&lookup_stats_["references"]);
+  const SymbolTableNode *node = LookupDefinition(symbol);
   if (!node) {
     return {};
   }
   std::vector<verible::lsp::Location> locations;
-  CollectReferences(&root, node, &locations);
+  CollectReferences(node, &locations);
   return locations;
 }
 
@@ -439,9 +873,7 @@ SymbolTableHandler::FindRenameableRangeAtCursor(
       GetTokenInfoAtTextDocumentPosition(params, parsed_buffers);
   if (symbol) {
     verible::TokenInfo token = symbol.value();
-    const SymbolTableNode &root = symbol_table_->Root();
-    const SymbolTableNode *node =
-        ScanSymbolTreeForDefinition(&root, token.text());
+    const SymbolTableNode *node = LookupDefinition(token.text());
     if (!node) return {};
     return RangeFromLineColumn(
         GetTokenRangeAtTextDocumentPosition(params, parsed_buffers));
@@ -453,84 +885,164 @@ verible::lsp::WorkspaceEdit
 SymbolTableHandler::FindRenameLocationsAndCreateEdits(
     const verible::lsp::RenameParams &params,
     const verilog::BufferTrackerContainer &parsed_buffers) {
-  Prepare();
+  PrepareResolved();
   std::optional<verible::TokenInfo> token =
       GetTokenAtTextDocumentPosition(params, parsed_buffers);
   if (!token) return {};
   absl::string_view symbol = token->text();
-  const SymbolTableNode &root = symbol_table_->Root();
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
-  if (!node) return {};
-  std::optional<verible::lsp::Location> location =
-      GetLocationFromSymbolName(*node->Key(), node->Value().file_origin);
-  if (!location) return {};
-  std::vector<verible::lsp::Location> locations;
-  locations.push_back(location.value());
-  std::vector<verible::lsp::TextEdit> textedits;
-  CollectReferences(&root, node, &locations);
-  if (locations.empty()) return {};
-  std::map<absl::string_view, std::vector<verible::lsp::TextEdit>>
-      file_edit_pairs;
-  for (const auto &loc : locations) {
-    file_edit_pairs[loc.uri].reserve(locations.size());
-  }
-  for (const auto &loc : locations) {
-    // TODO(jbylicki): Remove this band-aid fix once #1678 is merged - it should
-    // fix
-    //  duplicate definition/references appending in modules and remove the need
-    //  for adding the definition location above.
-    if (std::none_of(
-            file_edit_pairs[loc.uri].begin(), file_edit_pairs[loc.uri].end(),
-            [&loc](const verible::lsp::TextEdit &it) {
-              return loc.range.start.character == it.range.start.character &&
-                     loc.range.start.line == it.range.end.line;
-            })) {
-      file_edit_pairs[loc.uri].push_back(verible::lsp::TextEdit({
-          .range = loc.range,
-          .newText = params.newName,
-      }));
+  const ScopedLookupTimer timer(&lookup_stats_["rename"]);
+  const SymbolTableNode *node = LookupDefinition(symbol);
+  if (!node || !node->Key()) return {};
+
+  // The names to replace by the file they are in, starting with the
+  // definition, which needs to be found.
+  absl::flat_hash_map<const VerilogSourceFile *,
+                      std::vector<absl::string_view>>
+      names_by_file;
+  const auto add_name = [&](absl::string_view name,
+                            const VerilogSourceFile *file_origin) {
+    if (!file_origin) file_origin = curr_project_->LookupFileOrigin(name);
+    if (!file_origin) return false;
+    names_by_file[file_origin].push_back(name);
+    return true;
+  };
+  const VerilogSourceFile *definition_file = node->Value().file_origin;
+  if (!definition_file) {
+    definition_file = curr_project_->LookupFileOrigin(*node->Key());
+  }
+  if (!definition_file ||
+      !definition_file->GetTextStructure()->ContainsText(*node->Key())) {
+    return {};
+  }
+  add_name(*node->Key(), definition_file);
+  const auto found = references_by_name_.find(*node->Key());
+  if (found != references_by_name_.end()) {
+    for (const ReferenceSite &site : found->second) {
+      if (site.component->resolved_symbol != node) continue;
+      add_name(site.component->identifier, site.file_origin);
+    }
+  }
+
+  // Each file's edits only read that file, so they are created in parallel.
+  std::vector<std::pair<const VerilogSourceFile *,
+                        std::vector<absl::string_view>>>
+      files(std::make_move_iterator(names_by_file.begin()),
+            std::make_move_iterator(names_by_file.end()));
+  std::vector<std::vector<verible::lsp::TextEdit>> file_edits(files.size());
+  const auto create_edits = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      file_edits[i] = CreateRenameEdits(*files[i].first->GetTextStructure(),
+                                        std::move(files[i].second),
+                                        params.newName);
+    }
+  };
+  if (query_pool_) {
+    query_pool_->ParallelFor(0, files.size(), 1, create_edits,
+                             verible::ThreadPool::Priority::kHigh);
+  } else {
+    create_edits(0, files.size());
+  }
+
+  std::map<std::string, std::vector<verible::lsp::TextEdit>> changes;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (file_edits[i].empty()) continue;
+    std::vector<verible::lsp::TextEdit> &edits =
+        changes[PathToLSPUri(files[i].first->ResolvedPath())];
+    if (edits.empty()) {
+      edits = std::move(file_edits[i]);
+    } else {
+      edits.insert(edits.end(), file_edits[i].begin(), file_edits[i].end());
     }
   }
-  files_dirty_ = true;
   verible::lsp::WorkspaceEdit edit = verible::lsp::WorkspaceEdit{
       .changes = {},
   };
-  edit.changes = file_edit_pairs;
+  edit.changes = changes;
   return edit;
 }
-void SymbolTableHandler::CollectReferencesReferenceComponents(
-    const ReferenceComponentNode *ref, const SymbolTableNode *ref_origin,
+
+void SymbolTableHandler::CollectReferences(
     const SymbolTableNode *definition_node,
     std::vector<verible::lsp::Location> *references) {
-  if (ref->Value().resolved_symbol == definition_node) {
-    const auto loc = GetLocationFromSymbolName(ref->Value().identifier,
-                                               ref_origin->Value().file_origin);
+  if (!definition_node->Key()) return;
+  const auto found = references_by_name_.find(*definition_node->Key());
+  if (found == references_by_name_.end()) return;
+  for (const ReferenceSite &site : found->second) {
+    if (site.component->resolved_symbol != definition_node) continue;
+    const auto loc =
+        GetLocationFromSymbolName(site.component->identifier, site.file_origin);
     if (loc) references->push_back(*loc);
   }
-  for (const auto &childref : ref->Children()) {
-    CollectReferencesReferenceComponents(&childref, ref_origin, definition_node,
-                                         references);
-  }
 }
 
-void SymbolTableHandler::CollectReferences(
-    const SymbolTableNode *context, const SymbolTableNode *definition_node,
-    std::vector<verible::lsp::Location> *references) {
-  if (!context) return;
-  for (const auto &ref : context->Value().local_references_to_bind) {
-    if (ref.Empty()) continue;
-    CollectReferencesReferenceComponents(ref.components.get(), context,
-                                         definition_node, references);
+void SymbolTableHandler::UpdateFilesFromDisk(
+    const std::vector<std::string> &paths) {
+  if (!curr_project_) return;
+  // Files the project does not know, even as not found, stay unknown.
+  absl::flat_hash_set<absl::string_view> project_files;
+  for (const auto &[name, file] : *curr_project_) project_files.insert(name);
+  std::vector<std::string> reread;
+  for (const std::string &path : paths) {
+    std::string projectpath = curr_project_->GetRelativePathToSource(path);
+    if (!project_files.contains(projectpath)) continue;
+    // Retract the symbols of the previous content while it is still alive.
+    if (!files_dirty_) {
+      if (const VerilogSourceFile *previous =
+              curr_project_->LookupRegisteredFile(projectpath)) {
+        symbol_table_->RemoveTranslationUnit(*previous);
+      }
+    }
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+      project_files.erase(projectpath);  // Before the name is destroyed.
+      curr_project_->RemoveRegisteredFile(projectpath);
+      changed_files_.erase(projectpath);
+      continue;
+    }
+    curr_project_->UpdateFileContents(path, nullptr);
+    if (!files_dirty_) changed_files_.insert(projectpath);
+    reread.push_back(std::move(projectpath));
   }
-  for (const auto &child : context->Children()) {
-    CollectReferences(&child.second, definition_node, references);
+  VLOG(1) << "Re-read " << reread.size() << " files changed on disk.";
+
+  // Otherwise, they are parsed on the next lookup.
+  if (!index_pool_ || index_stopped_) return;
+  index_jobs_ += reread.size();
+  for (std::string &name : reread) {
+    (void)index_pool_->ExecAsync<bool>(
+        [this, name = std::move(name)]() {
+          std::unique_lock<std::mutex> l(*index_mutex_);
+          const bool parsed = !index_stopped_ && ParseUnparsedFile(name, &l);
+          if (--index_jobs_ == 0) index_finished_.notify_all();
+          return parsed;
+        },
+        verible::ThreadPool::Priority::kLow);
   }
 }
 
 void SymbolTableHandler::UpdateFileContent(
-    absl::string_view path, const verilog::VerilogAnalyzer *parsed) {
-  files_dirty_ = true;
-  curr_project_->UpdateFileContents(path, parsed);
+    absl::string_view path,
+    std::shared_ptr<const verilog::VerilogAnalyzer> parsed) {
+  if (!files_dirty_) {
+    // Retract the symbols of the previous content while it is still alive;
+    // the updated file is added back to the symbol table in Prepare().
+    std::string projectpath = curr_project_->GetRelativePathToSource(path);
+    if (const VerilogSourceFile *previous =
+            curr_project_->LookupRegisteredFile(projectpath)) {
+      symbol_table_->RemoveTranslationUnit(*previous);
+    }
+    changed_files_.insert(std::move(projectpath));
+  }
+  if (!index_queue_.empty()) {
+    const auto queued =
+        std::find(index_queue_.begin(), index_queue_.end(),
+                  curr_project_->GetRelativePathToSource(path));
+    if (queued != index_queue_.end()) {
+      index_queue_.erase(queued);
+      CountIndexedFile();
+    }
+  }
+  curr_project_->UpdateFileContents(path, std::move(parsed));
 }
 
 BufferTrackerContainer::ChangeCallback
@@ -543,10 +1055,16 @@ SymbolTableHandler::CreateBufferTrackerListener() {
       return;
     }
     // Note, if we actually got any result we must use it here to update
-    // the file content, as the old one will be deleted.
-    // So must use current() as last_good() might be nullptr.
-    UpdateFileContent(
-        path, buffer_tracker ? &buffer_tracker->current()->parser() : nullptr);
+    // the file content, so must use current() as last_good() might be
+    // nullptr. The project shares the editor's parse with the buffer, which
+    // keeps it alive for as long as either uses it.
+    std::shared_ptr<const VerilogAnalyzer> parsed;
+    if (buffer_tracker) {
+      std::shared_ptr<const ParsedBuffer> current = buffer_tracker->current();
+      parsed = std::shared_ptr<const VerilogAnalyzer>(current,
+                                                      &current->parser());
+    }
+    UpdateFileContent(path, std::move(parsed));
   };
 }
 
@@ -16,19 +16,30 @@
 #ifndef VERILOG_TOOLS_LS_SYMBOL_TABLE_HANDLER_H
 #define VERILOG_TOOLS_LS_SYMBOL_TABLE_HANDLER_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/strings/line_column_map.h"
 #include "common/text/symbol.h"
 #include "common/text/token_info.h"
+#include "common/util/memory_usage.h"
+#include "common/util/thread_pool.h"
 #include "verilog/analysis/symbol_table.h"
 #include "verilog/analysis/verilog_analyzer.h"
 #include "verilog/analysis/verilog_project.h"
@@ -54,6 +65,33 @@ class SymbolTableHandler {
   // Once the project's root is set, a new SymbolTable is created.
   void SetProject(const std::shared_ptr<VerilogProject> &project);
 
+  // Receives the number of files indexed so far and the number to index.
+  using IndexProgressCallback = std::function<void(int indexed, int total)>;
+
+  // Starts parsing the project files that are not parsed yet on "pool",
+  // instead of all at once on the first symbol lookup. Each parsed file is
+  // added to the symbol table on the next lookup. The indexing locks
+  // "mutex" whenever it accesses the handler, so from now on, all other
+  // calls need to be made with "mutex" locked, like this one. "progress"
+  // (may be nullptr) is called with "mutex" locked after each file.
+  // The "pool" needs to have threads, and outlive the indexing.
+  // Returns the number of files to index.
+  int IndexInBackground(verible::ThreadPool *pool, std::mutex *mutex,
+                         const IndexProgressCallback &progress);
+
+  // Generates the per-file parts of project-wide results, like the edits of
+  // a rename, on "pool" as well (may be nullptr). The "pool" needs to
+  // outlive the lookups.
+  void SetQueryPool(verible::ThreadPool *pool) { query_pool_ = pool; }
+
+  // Blocks until the files queued by IndexInBackground() are parsed.
+  // Call this with "mutex" unlocked.
+  void WaitForBackgroundIndexing();
+
+  // Drops the files still queued, and the files still being parsed once they
+  // are done. Call this with "mutex" locked.
+  void StopBackgroundIndexing();
+
   // Finds the definition for a symbol provided in the DefinitionParams
   // message delivered i.e. in textDocument/definition message.
   // Provides a list of locations with symbol's definitions.
@@ -82,6 +120,12 @@ class SymbolTableHandler {
       const verible::lsp::RenameParams &params,
       const verilog::BufferTrackerContainer &parsed_buffers);
 
+  // Finds the symbols of the project whose names contain the query of a
+  // workspace/symbol request, ignoring case. Short queries only match
+  // name prefixes.
+  std::vector<verible::lsp::SymbolInformation> FindWorkspaceSymbols(
+      const verible::lsp::WorkspaceSymbolParams &params);
+
   // Returns TokenInfo for token pointed by the LSP request based on
   // TextDocumentPositionParams. If text is not found, nullopt is returned.
   std::optional<verible::TokenInfo> GetTokenAtTextDocumentPosition(
@@ -89,12 +133,63 @@ class SymbolTableHandler {
       const verilog::BufferTrackerContainer &parsed_buffers) const;
 
   // Creates a symbol table for entire project (public: needed in unit-test)
-  std::vector<absl::Status> BuildProjectSymbolTable();
+  // Unless "resolve" is set, its references are only resolved once a lookup
+  // needs them.
+  std::vector<absl::Status> BuildProjectSymbolTable(bool resolve = true);
 
   // Provide new parsed content for the given path. If "content" is nullptr,
-  // opens the given file instead.
-  void UpdateFileContent(absl::string_view path,
-                         const verilog::VerilogAnalyzer *parsed);
+  // opens the given file instead. The file is not background-indexed anymore,
+  // as the editor's parse of it is used instead.
+  void UpdateFileContent(
+      absl::string_view path,
+      std::shared_ptr<const verilog::VerilogAnalyzer> parsed);
+
+  // Re-reads the project files at "paths" that changed on disk, and drops
+  // the ones that don't exist anymore. Paths not in the project are
+  // ignored. With IndexInBackground(), the files are parsed on its pool,
+  // otherwise on the next lookup; either way, only they are rebuilt.
+  // Files open in the editor should not be passed.
+  void UpdateFilesFromDisk(const std::vector<std::string> &paths);
+
+  // Forgets which files the project's include directories contain, after
+  // files were created or deleted on the filesystem.
+  void ClearIncludeDirectoryCache();
+
+  // Number and total duration of symbol lookups, by kind of request.
+  struct LookupStats {
+    int count = 0;
+    absl::Duration total_time;
+  };
+  const std::map<std::string, LookupStats> &GetLookupStats() const {
+    return lookup_stats_;
+  }
+
+  // Number and total duration of the symbol table builds from scratch, and
+  // of the updates that only rebuilt the changed files.
+  struct RebuildStats {
+    int full_count = 0;
+    absl::Duration full_time;
+    int incremental_count = 0;
+    int incremental_files = 0;  // Rebuilt in all updates.
+    absl::Duration incremental_time;
+  };
+  const RebuildStats &GetRebuildStats() const { return rebuild_stats_; }
+
+  // Changes whenever the symbol table is replaced or updated, so results
+  // derived from its nodes can be kept as long as it is the same.
+  int64_t generation() const { return generation_; }
+
+  // Returns the statistics of the project's symbol table, or nullopt if
+  // there is none yet.
+  std::optional<SymbolTable::Stats> GetSymbolTableStats() const {
+    if (!symbol_table_) return std::nullopt;
+    return symbol_table_->GetStats();
+  }
+
+  // Returns the estimated memory held by the symbol table, with components
+  // prefixed "symbol_table.", and by the project's files, including the
+  // analyses of open editor buffers, prefixed "files.".
+  verible::MemoryUsage GetMemoryUsage() const;
 
   // Create a listener to be wired up to a buffer tracker. Whenever we
   // there is a change in the editor, this will update our internal project.
@@ -104,6 +199,13 @@ class SymbolTableHandler {
   // prepares structures for symbol-based requests
   void Prepare();
 
+  // Like Prepare(), but also resolves all references of the symbol table,
+  // as needed to find the references of a symbol.
+  void PrepareResolved();
+
+  // Resolves the references not resolved yet, and indexes them.
+  void ResolveAllReferences();
+
   // Creates a new symbol table given the VerilogProject in setProject
   // method.
   void ResetSymbolTable();
@@ -128,22 +230,27 @@ class SymbolTableHandler {
   std::optional<verible::lsp::Location> GetLocationFromSymbolName(
       absl::string_view symbol_name, const VerilogSourceFile *file_origin);
 
-  // Scans the symbol table tree to find a given symbol.
-  // returns pointer to table node with the symbol on success, else nullptr.
-  const SymbolTableNode *ScanSymbolTreeForDefinition(
-      const SymbolTableNode *context, absl::string_view symbol);
+  // Rebuilds the lookup indices below from the symbol table.  Needs to be
+  // done whenever the symbol table changed.
+  void BuildSymbolIndex();
+
+  // Rebuilds symbols_by_name_ and symbol_name_trigrams_, as part of
+  // BuildSymbolIndex().
+  void BuildSymbolNameIndex();
+
+  // Returns the definition of the symbol that is defined or referenced at
+  // the location of 'symbol', which is a substring of a project file, or
+  // nullptr if there is none.  A reference not resolved yet is resolved
+  // with just its own reference tree.
+  const SymbolTableNode *LookupDefinition(absl::string_view symbol);
 
-  // Internal function for CollectReferences that iterates over
-  // ReferenceComponentNodes
-  void CollectReferencesReferenceComponents(
-      const ReferenceComponentNode *ref, const SymbolTableNode *ref_origin,
-      const SymbolTableNode *definition_node,
-      std::vector<verible::lsp::Location> *references);
+  // Returns the definition a reference at the location of 'symbol' is
+  // resolved to on demand, or nullptr if there is none.
+  const SymbolTableNode *ResolveReferenceAt(absl::string_view symbol);
 
   // Collects all references of a given symbol in the references
   // vector.
-  void CollectReferences(const SymbolTableNode *context,
-                         const SymbolTableNode *definition_node,
+  void CollectReferences(const SymbolTableNode *definition_node,
                          std::vector<verible::lsp::Location> *references);
 
   // Looks for verible.filelist file down in directory structure and loads
@@ -153,6 +260,27 @@ class SymbolTableHandler {
   // Parse all the files in the project.
   void ParseProjectFiles();
 
+  // Parses the next file from index_queue_, if any, on the pool passed to
+  // IndexInBackground(). Returns if the file's parse was used.
+  bool IndexNextQueuedFile();
+
+  // Parses the project file "name" with "l" on index_mutex_ unlocked, if it
+  // is not parsed yet. Returns if the parse was used.
+  bool ParseUnparsedFile(const std::string &name,
+                         std::unique_lock<std::mutex> *l);
+
+  // Accounts a file taken from index_queue_ and reports the progress.
+  void CountIndexedFile();
+
+  // Adds the changed_files_ back to the symbol table, after their previous
+  // content was removed in UpdateFileContent(), and resolves the references
+  // that are unbound by that.
+  void UpdateChangedFilesSymbolTable();
+
+  // Drops the token streams of project files, as limited by
+  // --project_token_memory_budget_mb.
+  void ReleaseTokenStreamsOverBudget();
+
   // Path to the filelist file for the project
   std::string filelist_path_;
 
@@ -163,6 +291,70 @@ class SymbolTableHandler {
   // tells that symbol table should be rebuilt due to changes in files
   bool files_dirty_ = true;
 
+  // Files that changed or were added since the symbol table was (re)built,
+  // if it is not dirty.  These only need to be built again.
+  std::set<std::string> changed_files_;
+
+  // Definitions, and the definitions that references are bound to, by the
+  // location of their name in the project's files.
+  struct DefinitionLocation {
+    absl::string_view text;
+    const SymbolTableNode *node;
+  };
+  absl::flat_hash_map<const char *, DefinitionLocation>
+      definitions_by_location_;
+
+  // All reference components by the referenced name.
+  struct ReferenceSite {
+    const ReferenceComponent *component;
+    const VerilogSourceFile *file_origin;  // of the referencing scope
+  };
+  absl::flat_hash_map<absl::string_view, std::vector<ReferenceSite>>
+      references_by_name_;
+
+  // All reference components by the location of their name, with the
+  // reference tree they are part of and the scope to resolve it from.
+  struct ReferenceLocation {
+    const ReferenceComponent *component;
+    const DependentReferences *references;
+    const SymbolTableNode *context;
+  };
+  absl::flat_hash_map<const char *, ReferenceLocation> references_by_location_;
+
+  // Tells that all references of the symbol table were attempted to be
+  // resolved, not just the ones looked up so far.
+  bool references_resolved_ = false;
+
+  // All named symbols sorted by their lower-case name, for prefix lookups.
+  struct NamedSymbol {
+    std::string folded_name;
+    const SymbolTableNode *node;
+  };
+  std::vector<NamedSymbol> symbols_by_name_;
+
+  // Positions in symbols_by_name_ of the names containing a trigram, for
+  // substring lookups.
+  absl::flat_hash_map<uint32_t, std::vector<uint32_t>> symbol_name_trigrams_;
+
+  std::map<std::string, LookupStats> lookup_stats_;
+  RebuildStats rebuild_stats_;
+
+  // Bumped by ResetSymbolTable() and BuildSymbolIndex().
+  int64_t generation_ = 0;
+
+  verible::ThreadPool *query_pool_ = nullptr;  // See SetQueryPool().
+
+  // State of IndexInBackground(), guarded by index_mutex_ once it is set.
+  std::mutex *index_mutex_ = nullptr;
+  verible::ThreadPool *index_pool_ = nullptr;
+  std::deque<std::string> index_queue_;  // Names of the files to parse.
+  IndexProgressCallback index_progress_;
+  int index_total_ = 0;
+  int index_done_ = 0;
+  int index_jobs_ = 0;  // Not finished IndexNextQueuedFile() calls.
+  bool index_stopped_ = false;
+  std::condition_variable index_finished_;
+
   // current VerilogProject for which the symbol table is created
   std::shared_ptr<VerilogProject> curr_project_;
   std::unique_ptr<SymbolTable> symbol_table_;
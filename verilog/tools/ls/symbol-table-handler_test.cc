@@ -14,18 +14,26 @@
 
 #include "verilog/tools/ls/symbol-table-handler.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/lsp/lsp-file-utils.h"
+#include "common/lsp/lsp-protocol-enums.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/lsp/lsp-text-buffer.h"
 #include "common/util/file_util.h"
+#include "common/util/thread_pool.h"
 #include "gtest/gtest.h"
 #include "verilog/analysis/verilog_project.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
@@ -129,6 +137,91 @@ TEST(SymbolTableHandlerTest, LoadFileList) {
   ASSERT_EQ(diagnostics.size(), 0);
 }
 
+TEST(SymbolTableHandlerTest, ExtendedFileListOnlyBuildsAddedFiles) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, "a.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+
+  std::shared_ptr<VerilogProject> project =
+      std::make_shared<VerilogProject>(sources_dir, std::vector<std::string>{});
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+
+  verible::lsp::WorkspaceSymbolParams params;
+  params.query = "b";
+  EXPECT_TRUE(symbol_table_handler.FindWorkspaceSymbols(params).empty());
+  EXPECT_EQ(symbol_table_handler.GetRebuildStats().full_count, 1);
+
+  // Make sure the file list is seen as modified.
+  const std::filesystem::file_time_type modified =
+      std::filesystem::last_write_time(filelist.filename());
+  ASSERT_TRUE(
+      verible::file::SetContents(filelist.filename(), "a.sv\nb.sv\n").ok());
+  std::filesystem::last_write_time(filelist.filename(),
+                                   modified + std::chrono::seconds(1));
+
+  const auto symbols = symbol_table_handler.FindWorkspaceSymbols(params);
+  ASSERT_EQ(symbols.size(), 1);
+  EXPECT_EQ(symbols[0].location.uri,
+            verible::lsp::PathToLSPUri(sources_dir + "/b.sv"));
+  const SymbolTableHandler::RebuildStats &stats =
+      symbol_table_handler.GetRebuildStats();
+  EXPECT_EQ(stats.full_count, 1);
+  EXPECT_EQ(stats.incremental_count, 1);
+  EXPECT_EQ(stats.incremental_files, 1);
+}
+
+TEST(SymbolTableHandlerTest, UpdateFilesFromDisk) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, "a.sv\nb.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const std::string b_path = verible::file::JoinPath(sources_dir, "b.sv");
+  ASSERT_TRUE(verible::file::SetContents(b_path, kSampleModuleB).ok());
+
+  std::shared_ptr<VerilogProject> project =
+      std::make_shared<VerilogProject>(sources_dir, std::vector<std::string>{});
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+
+  const auto find = [&](absl::string_view query) {
+    verible::lsp::WorkspaceSymbolParams params;
+    params.query = std::string(query);
+    return symbol_table_handler.FindWorkspaceSymbols(params).size();
+  };
+  EXPECT_EQ(find("b"), 1);
+  EXPECT_EQ(find("c"), 0);
+
+  // Only the changed file is rebuilt.
+  ASSERT_TRUE(
+      verible::file::SetContents(b_path, "module c;\nendmodule\n").ok());
+  symbol_table_handler.UpdateFilesFromDisk(
+      {b_path, verible::file::JoinPath(sources_dir, "unknown.sv")});
+  EXPECT_EQ(find("b"), 0);
+  EXPECT_EQ(find("c"), 1);
+  EXPECT_EQ(symbol_table_handler.GetRebuildStats().full_count, 1);
+  EXPECT_EQ(symbol_table_handler.GetRebuildStats().incremental_files, 1);
+
+  // Deleted files are dropped from the project.
+  ASSERT_EQ(std::remove(b_path.c_str()), 0);
+  symbol_table_handler.UpdateFilesFromDisk({b_path});
+  EXPECT_EQ(find("c"), 0);
+  EXPECT_EQ(find("a"), 1);
+}
+
 TEST(SymbolTableHandlerTest, FileListWithNonExistingFile) {
   const auto tempdir = ::testing::TempDir();
   const std::string sources_dir =
@@ -484,6 +577,311 @@ TEST(SymbolTableHandlerTest,
       1);
 }
 
+TEST(SymbolTableHandlerTest,
+     FindRenameLocationsAndCreateEditsOnQueryPoolTest) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  absl::string_view filelist_content =
+      "a.sv\n"
+      "b.sv\n";
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+  verible::lsp::RenameParams parameters;
+  parameters.textDocument.uri =
+      verible::lsp::PathToLSPUri(sources_dir + "/a.sv");
+  parameters.position.line = 1;
+  parameters.position.character = 11;
+  parameters.newName = "aaa";
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  verible::ThreadPool pool(2);
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+  symbol_table_handler.SetQueryPool(&pool);
+
+  verilog::BufferTrackerContainer parsed_buffers;
+  parsed_buffers.AddChangeListener(
+      symbol_table_handler.CreateBufferTrackerListener());
+  auto a_buffer = verible::lsp::EditTextBuffer(kSampleModuleA);
+  parsed_buffers.GetSubscriptionCallback()(parameters.textDocument.uri,
+                                           &a_buffer);
+  symbol_table_handler.BuildProjectSymbolTable();
+
+  verible::lsp::WorkspaceEdit edit_range =
+      symbol_table_handler.FindRenameLocationsAndCreateEdits(parameters,
+                                                             parsed_buffers);
+  // The edits of a file are ordered by their location.
+  const std::vector<verible::lsp::TextEdit> a_edits =
+      edit_range.changes[parameters.textDocument.uri];
+  ASSERT_EQ(a_edits.size(), 2);
+  EXPECT_EQ(a_edits[0].range.start.line, 1);
+  EXPECT_EQ(a_edits[0].range.start.character, 9);
+  EXPECT_EQ(a_edits[0].range.end.character, 13);
+  EXPECT_EQ(a_edits[1].range.start.line, 2);
+  EXPECT_EQ(a_edits[1].range.start.character, 16);
+  EXPECT_EQ(a_edits[1].newText, "aaa");
+  EXPECT_EQ(
+      edit_range.changes[verible::lsp::PathToLSPUri(sources_dir + "/b.sv")]
+          .size(),
+      1);
+}
+
+TEST(SymbolTableHandlerTest, FindDefinitionLocationAfterEditingDefiningFile) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  absl::string_view filelist_content =
+      "a.sv\n"
+      "b.sv\n";
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+  const std::string a_uri = verible::lsp::PathToLSPUri(sources_dir + "/a.sv");
+  const std::string b_uri = verible::lsp::PathToLSPUri(sources_dir + "/b.sv");
+
+  // The "var1" in "vara.var1" refers to the definition in module a.
+  verible::lsp::DefinitionParams parameters;
+  parameters.textDocument.uri = b_uri;
+  parameters.position.line = 4;
+  parameters.position.character = 15;
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+
+  verilog::BufferTrackerContainer parsed_buffers;
+  parsed_buffers.AddChangeListener(
+      symbol_table_handler.CreateBufferTrackerListener());
+
+  auto a_buffer = verible::lsp::EditTextBuffer(kSampleModuleA);
+  parsed_buffers.GetSubscriptionCallback()(a_uri, &a_buffer);
+  auto b_buffer = verible::lsp::EditTextBuffer(kSampleModuleB);
+  parsed_buffers.GetSubscriptionCallback()(b_uri, &b_buffer);
+  symbol_table_handler.BuildProjectSymbolTable();
+
+  std::vector<verible::lsp::Location> location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, a_uri);
+  EXPECT_EQ(location[0].range.start.line, 1);
+
+  // Move the definition down by a line in the editor.
+  auto edited_a_buffer =
+      verible::lsp::EditTextBuffer(absl::StrCat("\n", kSampleModuleA));
+  edited_a_buffer.set_last_global_version(2);
+  parsed_buffers.GetSubscriptionCallback()(a_uri, &edited_a_buffer);
+
+  location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, a_uri);
+  EXPECT_EQ(location[0].range.start.line, 2);
+
+  const auto &stats = symbol_table_handler.GetLookupStats();
+  const auto found = stats.find("definition");
+  ASSERT_NE(found, stats.end());
+  EXPECT_EQ(found->second.count, 2);
+}
+
+TEST(SymbolTableHandlerTest, FindDefinitionLocationInBackgroundIndex) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  absl::string_view filelist_content =
+      "a.sv\n"
+      "b.sv\n";
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+  const std::string a_uri = verible::lsp::PathToLSPUri(sources_dir + "/a.sv");
+  const std::string b_uri = verible::lsp::PathToLSPUri(sources_dir + "/b.sv");
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  SymbolTableHandler symbol_table_handler;
+  verilog::BufferTrackerContainer parsed_buffers;
+  parsed_buffers.AddChangeListener(
+      symbol_table_handler.CreateBufferTrackerListener());
+
+  std::mutex mutex;
+  verible::ThreadPool pool(2);
+  std::vector<std::pair<int, int>> progress;
+  {
+    const std::lock_guard<std::mutex> l(mutex);
+    symbol_table_handler.SetProject(project);
+    EXPECT_EQ(symbol_table_handler.IndexInBackground(
+                  &pool, &mutex,
+                  [&](int indexed, int total) {
+                    progress.emplace_back(indexed, total);
+                  }),
+              2);
+  }
+  symbol_table_handler.WaitForBackgroundIndexing();
+  ASSERT_EQ(progress.size(), 2);
+  EXPECT_EQ(progress.back(), std::make_pair(2, 2));
+
+  const std::lock_guard<std::mutex> l(mutex);
+  auto b_buffer = verible::lsp::EditTextBuffer(kSampleModuleB);
+  parsed_buffers.GetSubscriptionCallback()(b_uri, &b_buffer);
+
+  // The "var1" in "vara.var1" refers to the definition in module a.
+  verible::lsp::DefinitionParams parameters;
+  parameters.textDocument.uri = b_uri;
+  parameters.position.line = 4;
+  parameters.position.character = 15;
+  std::vector<verible::lsp::Location> location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, a_uri);
+  EXPECT_EQ(location[0].range.start.line, 1);
+}
+
+TEST(SymbolTableHandlerTest, FindDefinitionLocationResolvingOnDemand) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  absl::string_view filelist_content =
+      "a.sv\n"
+      "b.sv\n";
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+  const std::string a_uri = verible::lsp::PathToLSPUri(sources_dir + "/a.sv");
+  const std::string b_uri = verible::lsp::PathToLSPUri(sources_dir + "/b.sv");
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+  verilog::BufferTrackerContainer parsed_buffers;
+  parsed_buffers.AddChangeListener(
+      symbol_table_handler.CreateBufferTrackerListener());
+  auto b_buffer = verible::lsp::EditTextBuffer(kSampleModuleB);
+  parsed_buffers.GetSubscriptionCallback()(b_uri, &b_buffer);
+
+  // Only needs the reference itself resolved.
+  verible::lsp::DefinitionParams parameters;
+  parameters.textDocument.uri = b_uri;
+  parameters.position.line = 2;
+  parameters.position.character = 17;
+  std::vector<verible::lsp::Location> location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, b_uri);
+  EXPECT_EQ(location[0].range.start.line, 1);
+
+  // Needs the type of "vara" resolved too.
+  parameters.position.line = 4;
+  parameters.position.character = 15;
+  location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, a_uri);
+  EXPECT_EQ(location[0].range.start.line, 1);
+
+  // Looked up again from what was resolved.
+  location =
+      symbol_table_handler.FindDefinitionLocation(parameters, parsed_buffers);
+  ASSERT_EQ(location.size(), 1);
+  EXPECT_EQ(location[0].uri, a_uri);
+
+  // References need all of them resolved.
+  verible::lsp::ReferenceParams references;
+  references.textDocument.uri = b_uri;
+  references.position.line = 4;
+  references.position.character = 15;
+  const std::vector<verible::lsp::Location> found =
+      symbol_table_handler.FindReferencesLocations(references, parsed_buffers);
+  EXPECT_TRUE(std::any_of(found.begin(), found.end(),
+                          [&](const verible::lsp::Location &reference) {
+                            return reference.uri == b_uri &&
+                                   reference.range.start.line == 4;
+                          }));
+}
+
+TEST(SymbolTableHandlerTest, FindWorkspaceSymbols) {
+  const auto tempdir = ::testing::TempDir();
+  const std::string sources_dir =
+      verible::file::JoinPath(tempdir, __FUNCTION__);
+  ASSERT_TRUE(verible::file::CreateDir(sources_dir).ok());
+
+  absl::string_view filelist_content =
+      "a.sv\n"
+      "b.sv\n";
+
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+
+  const auto find = [&](absl::string_view query) {
+    verible::lsp::WorkspaceSymbolParams params;
+    params.query = std::string(query);
+    std::vector<std::string> found;
+    for (const verible::lsp::SymbolInformation &symbol :
+         symbol_table_handler.FindWorkspaceSymbols(params)) {
+      found.push_back(absl::StrCat(symbol.containerName, "::", symbol.name, "@",
+                                   symbol.location.range.start.line));
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+  };
+
+  // Short queries match prefixes, ignoring case.
+  EXPECT_EQ(find("A"), std::vector<std::string>({"::a@0"}));
+  EXPECT_EQ(find("va"), std::vector<std::string>({"a::var1@1", "a::var2@2",
+                                                  "b::var1@1", "b::var2@2",
+                                                  "b::vara@3"}));
+  // Longer ones anywhere in the name.
+  EXPECT_EQ(find("AR1"), std::vector<std::string>({"a::var1@1", "b::var1@1"}));
+  EXPECT_EQ(find("ara"), std::vector<std::string>({"b::vara@3"}));
+  EXPECT_TRUE(find("var3").empty());
+
+  verible::lsp::WorkspaceSymbolParams params;
+  params.query = "b";
+  const auto symbols = symbol_table_handler.FindWorkspaceSymbols(params);
+  ASSERT_EQ(symbols.size(), 1);
+  EXPECT_EQ(symbols[0].kind, verible::lsp::SymbolKind::kModule);
+  EXPECT_FALSE(symbols[0].has_containerName);
+  EXPECT_EQ(symbols[0].location.uri,
+            verible::lsp::PathToLSPUri(sources_dir + "/b.sv"));
+}
+
 TEST(SymbolTableHandlerTest, UpdateWithUnparseableEditorContentRegression) {
   const auto tempdir = ::testing::TempDir();
   const std::string sources_dir =
@@ -15,8 +15,13 @@
 
 #include "verilog/tools/ls/verible-lsp-adapter.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <iterator>
+#include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -27,6 +32,7 @@
 #include "common/lsp/lsp-protocol-operators.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/strings/line_column_map.h"
+#include "common/strings/range.h"
 #include "common/text/text_structure.h"
 #include "common/text/token_info.h"
 #include "common/util/interval.h"
@@ -38,17 +44,45 @@
 #include "verilog/formatting/formatter.h"
 #include "verilog/parser/verilog_token_enum.h"
 #include "verilog/tools/ls/autoexpand.h"
-#include "verilog/tools/ls/document-symbol-filler.h"
+#include "verilog/tools/ls/block-index.h"
+#include "verilog/tools/ls/lsp-conversion.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 
 namespace verilog {
+// Returns the range of each of the lint "violations" of "text", with all
+// their starts and ends resolved in one pass over the lines.
+static std::vector<verible::LineColumnRange> ViolationRanges(
+    const std::vector<verible::LintViolationWithStatus> &violations,
+    const verible::TextStructureView &text) {
+  const absl::string_view base = text.Contents();
+  std::vector<int> offsets;
+  offsets.reserve(2 * violations.size());
+  for (const verible::LintViolationWithStatus &v : violations) {
+    const verible::TokenInfo &token = v.violation->token;
+    // Like GetRangeForToken(), places artificial EOF tokens at the end.
+    if (token.isEOF()) {
+      offsets.insert(offsets.end(), 2, static_cast<int>(base.length()));
+    } else {
+      offsets.push_back(token.left(base));
+      offsets.push_back(token.right(base));
+    }
+  }
+  const std::vector<verible::LineColumn> positions =
+      text.GetLineColumnMap().GetLineColAtOffsets(base, offsets);
+  std::vector<verible::LineColumnRange> ranges;
+  ranges.reserve(violations.size());
+  for (size_t i = 0; i < positions.size(); i += 2) {
+    ranges.push_back({positions[i], positions[i + 1]});
+  }
+  return ranges;
+}
+
 // Convert our representation of a linter violation to a LSP-Diagnostic
 static verible::lsp::Diagnostic ViolationToDiagnostic(
     const verible::LintViolationWithStatus &v,
-    const verible::TextStructureView &text) {
+    const verible::LineColumnRange &range) {
   const verible::LintViolation &violation = *v.violation;
-  const verible::LineColumnRange range = text.GetRangeForToken(violation.token);
   const char *fix_msg = violation.autofixes.empty() ? "" : " (fix available)";
   return verible::lsp::Diagnostic{
       .range =
@@ -64,70 +98,104 @@ static verible::lsp::Diagnostic ViolationToDiagnostic(
   };
 }
 
+static verible::lsp::Diagnostic RejectedTokenToDiagnostic(
+    const verible::RejectedToken &rejected_token,
+    const verilog::VerilogAnalyzer &parser) {
+  verible::lsp::Diagnostic result;
+  parser.ExtractLinterTokenErrorDetail(
+      rejected_token,
+      [&result, &rejected_token](
+          const std::string &filename, verible::LineColumnRange range,
+          verible::ErrorSeverity severity, verible::AnalysisPhase phase,
+          absl::string_view token_text, absl::string_view context_line,
+          const std::string &msg) {
+        std::string message(AnalysisPhaseName(phase));
+        absl::StrAppend(&message, " ", ErrorSeverityDescription(severity));
+        if (rejected_token.token_info.isEOF()) {
+          absl::StrAppend(&message, " (unexpected EOF)");
+        } else {
+          absl::StrAppend(&message, " at \"", token_text, "\"");
+        }
+        if (!msg.empty()) {  // Note: msg is often empty and not useful.
+          absl::StrAppend(&message, " ", msg);
+        }
+        result = verible::lsp::Diagnostic{
+            .range{.start{.line = range.start.line,
+                          .character = range.start.column},
+                   .end{.line = range.end.line,  //
+                        .character = range.end.column}},
+            .severity = severity == verible::ErrorSeverity::kError
+                            ? verible::lsp::DiagnosticSeverity::kError
+                            : verible::lsp::DiagnosticSeverity::kWarning,
+            .has_severity = true,
+            .message = message,
+        };
+      });
+  return result;
+}
+
 std::vector<verible::lsp::Diagnostic> CreateDiagnostics(
-    const BufferTracker &tracker, int message_limit) {
+    const BufferTracker &tracker, int message_limit, int focus_line) {
   // Diagnostics should come from the latest state, including all the
   // syntax errors.
   const auto current = tracker.current();
   if (!current) return {};
+  const verible::TextStructureView &text = current->parser().Data();
   const auto &rejected_tokens = current->parser().GetRejectedTokens();
-  auto const &lint_violations =
+  const auto lint_violations =
       verilog::GetSortedViolations(current->lint_result());
-  std::vector<verible::lsp::Diagnostic> result;
-  int remaining = rejected_tokens.size() + lint_violations.size();
-
-  // TODO: files that generate a lot of messages will create a huge
-  // output. So we limit the messages here if "message_limit" is set.
-  //
-  // We might consider emitting them around the last known
-  // edit point in the document as this is what the user sees (if we get
-  // individual edits, not full files pushed).
-  //
+  const std::vector<verible::LineColumnRange> violation_ranges =
+      ViolationRanges(lint_violations, text);
+  const int total = rejected_tokens.size() + lint_violations.size();
+
+  // Indices of the diagnostics to emit; rejected tokens are numbered first,
+  // followed by the lint violations.
+  std::vector<int> selected;
+
   // TODO(hzeller): to limit repetition, maybe limit the number of messages
   // coming from the _same_ source if we have a "message_limit". So for
   // instance, don't complain on every single line not to use tabs as
   // indentation.
-  if (message_limit >= 0 && remaining > message_limit) {
-    remaining = message_limit;
-  }
-
-  result.reserve(remaining);
-  for (const auto &rejected_token : rejected_tokens) {
-    if (remaining-- <= 0) break;
-    current->parser().ExtractLinterTokenErrorDetail(
-        rejected_token,
-        [&result, &rejected_token](
-            const std::string &filename, verible::LineColumnRange range,
-            verible::ErrorSeverity severity, verible::AnalysisPhase phase,
-            absl::string_view token_text, absl::string_view context_line,
-            const std::string &msg) {
-          std::string message(AnalysisPhaseName(phase));
-          absl::StrAppend(&message, " ", ErrorSeverityDescription(severity));
-          if (rejected_token.token_info.isEOF()) {
-            absl::StrAppend(&message, " (unexpected EOF)");
-          } else {
-            absl::StrAppend(&message, " at \"", token_text, "\"");
-          }
-          if (!msg.empty()) {  // Note: msg is often empty and not useful.
-            absl::StrAppend(&message, " ", msg);
-          }
-          result.emplace_back(verible::lsp::Diagnostic{
-              .range{.start{.line = range.start.line,
-                            .character = range.start.column},
-                     .end{.line = range.end.line,  //
-                          .character = range.end.column}},
-              .severity = severity == verible::ErrorSeverity::kError
-                              ? verible::lsp::DiagnosticSeverity::kError
-                              : verible::lsp::DiagnosticSeverity::kWarning,
-              .has_severity = true,
-              .message = message,
-          });
-        });
+  if (message_limit >= 0 && total > message_limit && focus_line >= 0) {
+    // Files that generate a lot of messages will create a huge output, so
+    // only emit those closest to the given line, as this is what the user
+    // is looking at.
+    std::vector<std::pair<int, int>> by_distance;  // (distance, index)
+    by_distance.reserve(total);
+    auto add_candidate = [&](int line) {
+      by_distance.emplace_back(std::abs(line - focus_line), by_distance.size());
+    };
+    for (const auto &rejected : rejected_tokens) {
+      add_candidate(text.GetRangeForToken(rejected.token_info).start.line);
+    }
+    for (const auto &range : violation_ranges) add_candidate(range.start.line);
+    std::nth_element(by_distance.begin(), by_distance.begin() + message_limit,
+                     by_distance.end());
+    by_distance.resize(message_limit);
+    for (const auto &candidate : by_distance) {
+      selected.push_back(candidate.second);
+    }
+    std::sort(selected.begin(), selected.end());
+  } else {
+    const int count = (message_limit >= 0 && total > message_limit)
+                          ? message_limit
+                          : total;
+    selected.resize(count);
+    std::iota(selected.begin(), selected.end(), 0);
   }
 
-  for (const auto &v : lint_violations) {
-    if (remaining-- <= 0) break;
-    result.emplace_back(ViolationToDiagnostic(v, current->parser().Data()));
+  std::vector<verible::lsp::Diagnostic> result;
+  result.reserve(selected.size());
+  const int rejected_count = rejected_tokens.size();
+  for (const int index : selected) {
+    if (index < rejected_count) {
+      result.emplace_back(
+          RejectedTokenToDiagnostic(rejected_tokens[index], current->parser()));
+    } else {
+      result.emplace_back(
+          ViolationToDiagnostic(lint_violations[index - rejected_count],
+                                violation_ranges[index - rejected_count]));
+    }
   }
   return result;
 }
@@ -147,18 +215,27 @@ static std::vector<verible::lsp::TextEdit> AutofixToTextEdits(
   // TODO(hzeller): figure out if edits are stacking or are all based
   // on the same start status.
   const absl::string_view base = text.Contents();
+  // Edits are sorted and do not overlap, so all their positions are found in
+  // one pass.
+  std::vector<int> offsets;
+  offsets.reserve(2 * fix.Edits().size());
+  for (const verible::ReplacementEdit &edit : fix.Edits()) {
+    offsets.push_back(edit.fragment.begin() - base.begin());
+    offsets.push_back(edit.fragment.end() - base.begin());
+  }
+  const std::vector<verible::LineColumn> positions =
+      text.GetLineColumnMap().GetLineColAtSortedOffsets(base, offsets);
+  auto position = positions.begin();
   for (const verible::ReplacementEdit &edit : fix.Edits()) {
-    verible::LineColumn start =
-        text.GetLineColAtOffset(edit.fragment.begin() - base.begin());
-    verible::LineColumn end =
-        text.GetLineColAtOffset(edit.fragment.end() - base.begin());
+    const verible::LineColumn start = *position++;
+    const verible::LineColumn end = *position++;
     result.emplace_back(verible::lsp::TextEdit{
         .range =
             {
                 .start = {.line = start.line, .character = start.column},
                 .end = {.line = end.line, .character = end.column},
             },
-        .newText = edit.replacement,
+        .newText = std::string(edit.replacement),
     });
   }
   return result;
@@ -176,11 +253,14 @@ std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
   if (lint_violations.empty()) return result;
 
   const verible::TextStructureView &text = current->parser().Data();
+  const std::vector<verible::LineColumnRange> violation_ranges =
+      ViolationRanges(lint_violations, text);
 
-  for (const auto &v : lint_violations) {
+  for (size_t i = 0; i < lint_violations.size(); ++i) {
+    const verible::LintViolationWithStatus &v = lint_violations[i];
     const verible::LintViolation &violation = *v.violation;
     if (violation.autofixes.empty()) continue;
-    auto diagnostic = ViolationToDiagnostic(v, text);
+    auto diagnostic = ViolationToDiagnostic(v, violation_ranges[i]);
 
     // The editor usually has the cursor on a line or word, so we
     // only want to output edits that are relevant.
@@ -189,7 +269,7 @@ std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
     bool preferred_fix = true;
     for (const auto &fix : violation.autofixes) {
       result.emplace_back(verible::lsp::CodeAction{
-          .title = fix.Description(),
+          .title = std::string(fix.Description()),
           .kind = "quickfix",
           .diagnostics = {diagnostic},
           .isPreferred = preferred_fix,
@@ -207,7 +287,8 @@ std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
 
 std::vector<verible::lsp::CodeAction> GenerateCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p) {
+    const verible::lsp::CodeActionParams &p,
+    AutoExpandCache *autoexpand_cache) {
   std::vector<verible::lsp::CodeAction> result;
 
   if (!tracker) return result;
@@ -216,8 +297,8 @@ std::vector<verible::lsp::CodeAction> GenerateCodeActions(
 
   result = GenerateLinterCodeActions(tracker, p);
 
-  auto auto_expand =
-      GenerateAutoExpandCodeActions(symbol_table_handler, tracker, p);
+  auto auto_expand = GenerateAutoExpandCodeActions(
+      symbol_table_handler, tracker, p, autoexpand_cache);
   result.insert(result.end(), std::make_move_iterator(auto_expand.begin()),
                 make_move_iterator(auto_expand.end()));
 
@@ -232,14 +313,80 @@ nlohmann::json CreateDocumentSymbolOutline(
   const auto last_good = tracker->last_good();
   if (!last_good) return nlohmann::json::array();
 
-  verible::lsp::DocumentSymbol toplevel;
-  const auto &text_structure = last_good->parser().Data();
-  verilog::DocumentSymbolFiller filler(kate_compatible_tags, include_variables,
-                                       text_structure, &toplevel);
-  const auto &syntax_tree = text_structure.SyntaxTree();
-  syntax_tree->Accept(&filler);
-  // We cut down one level, not interested in toplevel file:
-  return toplevel.children;
+  return last_good->document_outline(kate_compatible_tags, include_variables);
+}
+
+std::vector<verible::lsp::FoldingRange> CreateFoldingRanges(
+    const BufferTracker *tracker, const verible::lsp::FoldingRangeParams &p) {
+  std::vector<verible::lsp::FoldingRange> result;
+  if (!tracker) return result;
+  const auto current = tracker->current();
+  if (!current) return result;
+  const BlockIndex &index = current->block_index();
+
+  // Ranges that end where the next part starts only fold the lines before.
+  const auto add_range = [&result](const verible::LineColumnRange &range,
+                                   bool fold_last_line, const char *kind) {
+    const int end_line = fold_last_line ? range.end.line : range.end.line - 1;
+    if (end_line <= range.start.line) return;
+    verible::lsp::FoldingRange folding{.startLine = range.start.line,
+                                       .endLine = end_line};
+    if (kind != nullptr) {
+      folding.kind = kind;
+      folding.has_kind = true;
+    }
+    result.push_back(std::move(folding));
+  };
+  result.reserve(index.blocks().size() + index.conditional_branches().size() +
+                 index.multiline_comments().size());
+  for (const BlockIndex::Block &block : index.blocks()) {
+    add_range(block.range, false, nullptr);
+  }
+  for (const verible::LineColumnRange &branch : index.conditional_branches()) {
+    add_range(branch, false, "region");
+  }
+  for (const verible::LineColumnRange &comment : index.multiline_comments()) {
+    add_range(comment, true, "comment");
+  }
+  return result;
+}
+
+nlohmann::json CreateSelectionRanges(
+    const BufferTracker *tracker, const verible::lsp::SelectionRangeParams &p) {
+  nlohmann::json result = nlohmann::json::array();
+  if (!tracker) return result;
+  const auto current = tracker->current();
+  if (!current) return result;
+  const verible::TextStructureView &text = current->parser().Data();
+  const BlockIndex &index = current->block_index();
+
+  for (const verible::lsp::Position &position : p.positions) {
+    const verible::LineColumn pos{position.line, position.character};
+    // Innermost first.
+    std::vector<verible::LineColumnRange> ranges;
+    const verible::TokenInfo token = text.FindTokenAt(pos);
+    if (!token.isEOF() && token.token_enum() != TK_SPACE &&
+        token.token_enum() != TK_NEWLINE) {
+      ranges.push_back(text.GetRangeForToken(token));
+    }
+    for (const int block : index.EnclosingBlocks(pos)) {
+      const verible::LineColumnRange &range = index.blocks()[block].range;
+      if (ranges.empty() || !(ranges.back() == range)) ranges.push_back(range);
+    }
+    if (ranges.empty()) ranges.push_back({pos, pos});
+
+    nlohmann::json selection;
+    for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+      verible::lsp::SelectionRange range{.range = RangeFromLineColumn(*it)};
+      if (!selection.is_null()) {
+        range.parent = std::move(selection);
+        range.has_parent = true;
+      }
+      selection = range;
+    }
+    result.push_back(std::move(selection));
+  }
+  return result;
 }
 
 std::vector<verible::lsp::DocumentHighlight> CreateHighlightRanges(
@@ -259,10 +406,10 @@ std::vector<verible::lsp::DocumentHighlight> CreateHighlightRanges(
   // Note, this is very simplistic as it does _not_ take scopes into account.
   // For that, we'd need the symbol table, but that implementation is not
   // complete yet.
-  for (const verible::TokenInfo &tok : text.TokenStream()) {
-    if (tok.token_enum() != cursor_token.token_enum()) continue;
-    if (tok.text() != cursor_token.text()) continue;
-    const verible::LineColumnRange range = text.GetRangeForToken(tok);
+  const std::vector<verible::LineColumnRange> &occurrences =
+      current->identifier_occurrences(cursor_token.text());
+  result.reserve(occurrences.size());
+  for (const verible::LineColumnRange &range : occurrences) {
     result.push_back(verible::lsp::DocumentHighlight{
         .range = {
             .start = {.line = range.start.line,
@@ -274,6 +421,18 @@ std::vector<verible::lsp::DocumentHighlight> CreateHighlightRanges(
   return result;
 }
 
+// Splits text into lines, each including its terminating newline, if any.
+static std::vector<absl::string_view> SplitLinesKeepingNewlines(
+    absl::string_view text) {
+  std::vector<absl::string_view> lines;
+  while (!text.empty()) {
+    const size_t length = std::min(text.find('\n'), text.size() - 1) + 1;
+    lines.push_back(text.substr(0, length));
+    text.remove_prefix(length);
+  }
+  return lines;
+}
+
 std::vector<verible::lsp::TextEdit> FormatRange(
     const BufferTracker *tracker,
     const verible::lsp::DocumentFormattingParams &p) {
@@ -287,6 +446,8 @@ std::vector<verible::lsp::TextEdit> FormatRange(
   const verible::TextStructureView &text = current->parser().Data();
   verilog::formatter::FormatStyle format_style;
   verilog::formatter::InitializeFromFlags(&format_style);
+  verilog::formatter::ExecutionControl control;
+  control.comment_directives = &current->parser().CommentDirectives();
 
   if (p.has_range) {
     // If the cursor is at the very beginning of last line, we don't include
@@ -296,20 +457,58 @@ std::vector<verible::lsp::TextEdit> FormatRange(
         p.range.start.line + 1,  // 1 index based
         p.range.end.line + 1 + last_line_include};
     std::string formatted_range;
-    if (!FormatVerilogRange(text, format_style, &formatted_range, format_lines)
+    if (!FormatVerilogRange(text, format_style, &formatted_range, format_lines,
+                            control)
              .ok()) {
       return result;
     }
+
+    // Only replace the lines that changed, so that editors keep the cursor
+    // and markers on all others.
+    const auto &text_lines = text.Lines();
+    const absl::string_view original_range = verible::make_string_view_range(
+        text_lines[format_lines.min - 1].begin(),
+        format_lines.max - 1 < static_cast<int>(text_lines.size())
+            ? text_lines[format_lines.max - 1].begin()
+            : text.Contents().end());
+    const auto original = SplitLinesKeepingNewlines(original_range);
+    const auto formatted = SplitLinesKeepingNewlines(formatted_range);
+    size_t common_prefix = 0;
+    while (common_prefix < original.size() &&
+           common_prefix < formatted.size() &&
+           original[common_prefix] == formatted[common_prefix]) {
+      ++common_prefix;
+    }
+    size_t common_suffix = 0;
+    while (common_prefix + common_suffix < original.size() &&
+           common_prefix + common_suffix < formatted.size() &&
+           original[original.size() - 1 - common_suffix] ==
+               formatted[formatted.size() - 1 - common_suffix]) {
+      ++common_suffix;
+    }
+    if (common_prefix + common_suffix == original.size() &&
+        common_prefix + common_suffix == formatted.size()) {
+      return result;  // Already formatted.
+    }
+    std::string new_text;
+    for (size_t i = common_prefix; i < formatted.size() - common_suffix; ++i) {
+      absl::StrAppend(&new_text, formatted[i]);
+    }
+    const int start_line = format_lines.min - 1 + common_prefix;
+    const int end_line =
+        format_lines.min - 1 + original.size() - common_suffix;
     result.push_back(verible::lsp::TextEdit{
         .range =
             {
-                .start = {.line = format_lines.min - 1, .character = 0},
-                .end = {.line = format_lines.max - 1, .character = 0},
+                .start = {.line = start_line, .character = 0},
+                .end = {.line = end_line, .character = 0},
             },
-        .newText = formatted_range});
+        .newText = new_text});
   } else {
     std::string newText;
-    if (!FormatVerilog(text, current->uri(), format_style, &newText).ok()) {
+    if (!FormatVerilog(text, current->uri(), format_style, &newText, {},
+                       control)
+             .ok()) {
       return result;
     }
     // Emit a single edit that replaces the full range the file covers.
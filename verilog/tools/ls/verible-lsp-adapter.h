@@ -20,6 +20,7 @@
 
 #include "common/lsp/lsp-protocol.h"
 #include "nlohmann/json.hpp"
+#include "verilog/tools/ls/autoexpand.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 
@@ -29,17 +30,23 @@ namespace verilog {
 
 // Given the output of the parser and a lint status, create a diagnostic
 // output to be sent in textDocument/publishDiagnostics notification.
+// If "message_limit" is non-negative, at most that many diagnostics are
+// created; if there are more and "focus_line" is non-negative, the ones
+// closest to that line (e.g. of the last edit) are chosen.
 std::vector<verible::lsp::Diagnostic> CreateDiagnostics(const BufferTracker &,
-                                                        int message_limit);
+                                                        int message_limit,
+                                                        int focus_line = -1);
 
 // Generate code actions from autofixes provided by the linter.
 std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
     const BufferTracker *tracker, const verible::lsp::CodeActionParams &p);
 
-// Generate all available code actions.
+// Generate all available code actions. The analysis for AUTO expansions is
+// kept in "autoexpand_cache" if given.
 std::vector<verible::lsp::CodeAction> GenerateCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p);
+    const verible::lsp::CodeActionParams &p,
+    AutoExpandCache *autoexpand_cache = nullptr);
 
 verible::lsp::FullDocumentDiagnosticReport GenerateDiagnosticReport(
     const BufferTracker *tracker,
@@ -62,6 +69,17 @@ std::vector<verible::lsp::DocumentHighlight> CreateHighlightRanges(
     const BufferTracker *tracker,
     const verible::lsp::DocumentHighlightParams &p);
 
+// Returns the foldable ranges of the document from its block index:
+// begin/end constructs (keeping their last line visible), branches of
+// conditional compilation and multi-line comments.
+std::vector<verible::lsp::FoldingRange> CreateFoldingRanges(
+    const BufferTracker *tracker, const verible::lsp::FoldingRangeParams &p);
+
+// Returns a SelectionRange per requested position: the token at the
+// position, with the constructs enclosing it as parents.
+nlohmann::json CreateSelectionRanges(
+    const BufferTracker *tracker, const verible::lsp::SelectionRangeParams &p);
+
 // Format given range (or whole document) and emit an edit.
 std::vector<verible::lsp::TextEdit> FormatRange(
     const BufferTracker *tracker,
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "common/util/memory_usage.h"
 #include "verilog/tools/ls/verilog-language-server.h"
 
 #include <cstdio>
@@ -19,47 +20,125 @@
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/lsp/lsp-file-utils.h"
+#include "common/lsp/lsp-protocol-operators.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/logging.h"
+#include "common/util/thread_pool.h"
 #include "nlohmann/json.hpp"
 #include "verilog/analysis/verilog_project.h"
 #include "verilog/tools/ls/hover.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
+#include "verilog/tools/ls/semantic-tokens.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 #include "verilog/tools/ls/verible-lsp-adapter.h"
 
 ABSL_FLAG(bool, variables_in_outline, true,
           "Variables should be included into the symbol outline");
 
+ABSL_FLAG(int, analysis_threads, 0,
+          "If positive, parse and lint changed buffers on this many "
+          "background threads, so that requests do not wait for analysis "
+          "of the latest edits. If 0, analyze synchronously on each change.");
+
+ABSL_FLAG(int, request_threads, 0,
+          "If positive, answer requests that only read a single document "
+          "(outline, highlight, diagnostics, formatting) on this many "
+          "threads, so that they don't delay following messages. "
+          "If 0, answer all requests synchronously.");
+
+ABSL_FLAG(int, index_threads, 0,
+          "If positive, parse all project files on this many background "
+          "threads right after initialization, reporting the progress to "
+          "the client, and create the edits of renames on them. "
+          "If 0, parse them on the first symbol lookup.");
+
+ABSL_FLAG(int, slow_request_threshold_ms, 1000,
+          "Log the requests and notifications taking at least this many "
+          "milliseconds, with the size of the buffer they refer to. "
+          "If 0, log none.");
+
 namespace verilog {
 
+// Token of the progress reported while indexing the project.
+static constexpr absl::string_view kIndexingProgressToken = "verible-indexing";
+
 VerilogLanguageServer::VerilogLanguageServer(const WriteFun &write_fun)
     : dispatcher_(write_fun), text_buffers_(&dispatcher_) {
   // All bodies the stream splitter extracts are pushed to the json dispatcher
   stream_splitter_.SetMessageProcessor(
       [this](absl::string_view header, absl::string_view body) {
+        const std::lock_guard<std::mutex> l(mutex_);
         return dispatcher_.DispatchMessage(body);
       });
 
   // Whenever the text changes in the editor, reparse affected code.
-  text_buffers_.SetChangeListener(parsed_buffers_.GetSubscriptionCallback());
+  text_buffers_.SetChangeListener(
+      [this, reparse = parsed_buffers_.GetSubscriptionCallback()](
+          const std::string &uri, const verible::lsp::EditTextBuffer *txt) {
+        // Remember where the user is editing to prioritize diagnostics there.
+        if (txt) {
+          diagnostics_state_[uri].last_edit_line = txt->last_edit_line();
+        } else {
+          diagnostics_state_.erase(uri);
+          semantic_tokens_state_.erase(uri);
+        }
+        {
+          const std::lock_guard<std::mutex> l(buffer_sizes_mutex_);
+          if (txt) {
+            buffer_sizes_[uri] = txt->document_length();
+          } else {
+            buffer_sizes_.erase(uri);
+          }
+        }
+        reparse(uri, txt);
+      });
+  if (const int threads = absl::GetFlag(FLAGS_analysis_threads); threads > 0) {
+    analysis_pool_ = std::make_unique<verible::ThreadPool>(threads);
+    parsed_buffers_.AnalyzeInBackground(analysis_pool_.get(), &mutex_);
+  }
+  if (const int threads = absl::GetFlag(FLAGS_index_threads); threads > 0) {
+    index_pool_ = std::make_unique<verible::ThreadPool>(threads);
+    symbol_table_handler_.SetQueryPool(index_pool_.get());
+  }
+  if (const int threads = absl::GetFlag(FLAGS_request_threads); threads > 0) {
+    request_pool_ = std::make_unique<verible::ThreadPool>(threads);
+    dispatcher_.SetExecutor(request_pool_.get());
+  }
 
   // Whenever there is a new parse result ready, use that as an opportunity
   // to send diagnostics to the client.
   parsed_buffers_.AddChangeListener(
       [this](const std::string &uri,
              const verilog::BufferTracker *buffer_tracker) {
-        if (buffer_tracker) SendDiagnostics(uri, *buffer_tracker);
+        if (!buffer_tracker) return;
+        if (const auto &current = buffer_tracker->current()) {
+          parse_times_.Add(current->parse_time());
+          lint_times_.Add(current->lint_time());
+        }
+        SendDiagnostics(uri, *buffer_tracker);
       });
+  if (const int threshold = absl::GetFlag(FLAGS_slow_request_threshold_ms);
+      threshold > 0) {
+    dispatcher_.SetSlowRequestHandler(
+        absl::Milliseconds(threshold),
+        [this](const std::string &method, const nlohmann::json &params,
+               absl::Duration duration) {
+          LogSlowRequest(method, params, duration);
+        });
+  }
   SetRequestHandlers();
 }
 
@@ -84,11 +163,23 @@ verible::lsp::InitializeResult VerilogLanguageServer::GetCapabilities() {
       {"documentRangeFormattingProvider", true},  // Format selection
       {"documentFormattingProvider", true},       // Full file format
       {"documentHighlightProvider", true},        // Highlight same symbol
+      {"foldingRangeProvider", true},             // Foldable blocks
+      {"selectionRangeProvider", true},           // Expand selection
       {"definitionProvider", true},               // Provide going to definition
       {"referencesProvider", true},               // Provide going to references
       // Hover enabled, but not yet offered to client until tested.
       {"hoverProvider", false},  // Hover info over cursor
       {"renameProvider", true},  // Provide symbol renaming
+      {"workspaceSymbolProvider", true},  // Search symbols in project
+      {"semanticTokensProvider",          // Highlighting from the parse
+       {
+           {"legend",
+            {
+                {"tokenTypes", SemanticTokenTypeNames()},
+                {"tokenModifiers", nlohmann::json::array()},
+            }},
+           {"full", {{"delta", true}}},
+       }},
       {"diagnosticProvider",     // Pull model of diagnostics.
        {
            {"interFileDependencies", false},
@@ -105,12 +196,38 @@ void VerilogLanguageServer::SetRequestHandlers() {
                                 [this](const nlohmann::json &params) {
                                   return InitializeRequestHandler(params);
                                 });
+  // The client got our capabilities, so we may send it requests now.
+  dispatcher_.AddNotificationHandler("initialized",
+                                     [this](const nlohmann::json &) {
+                                       WatchProjectFiles();
+                                       IndexProject();
+                                     });
 
-  dispatcher_.AddRequestHandler(  // Provide diagnostics on request
+  // Files changed on disk. Created or deleted files may change how an
+  // `include resolves, and the project files not open in the editor need
+  // to be read again.
+  dispatcher_.AddNotificationHandler(
+      "workspace/didChangeWatchedFiles",
+      [this](const verible::lsp::DidChangeWatchedFilesParams &p) {
+        symbol_table_handler_.ClearIncludeDirectoryCache();
+        std::vector<std::string> paths;
+        for (const verible::lsp::FileEvent &event : p.changes) {
+          if (parsed_buffers_.FindBufferTrackerOrNull(event.uri)) continue;
+          std::string path = verible::lsp::LSPUriToPath(event.uri);
+          if (!path.empty()) paths.push_back(std::move(path));
+        }
+        symbol_table_handler_.UpdateFilesFromDisk(paths);
+      });
+
+  // Requests that only read a single document are computed on a snapshot
+  // of its buffer tracker, concurrently if --request_threads is set.
+  dispatcher_.AddConcurrentRequestHandler(  // Provide diagnostics on request
       "textDocument/diagnostic",
       [this](const verible::lsp::DocumentDiagnosticParams &p) {
-        return verilog::GenerateDiagnosticReport(
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::GenerateDiagnosticReport(tracker.get(), p);
+        };
       });
 
   dispatcher_.AddRequestHandler(  // Provide autofixes
@@ -118,37 +235,64 @@ void VerilogLanguageServer::SetRequestHandlers() {
       [this](const verible::lsp::CodeActionParams &p) {
         return verilog::GenerateCodeActions(
             &symbol_table_handler_,
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p,
+            &autoexpand_cache_);
       });
 
-  dispatcher_.AddRequestHandler(  // Provide document outline/index
+  dispatcher_.AddConcurrentRequestHandler(  // Provide document outline/index
       "textDocument/documentSymbol",
       [this](const verible::lsp::DocumentSymbolParams &p) {
-        // The `false` sets the kate workaround to the set default, as it was
-        // not set here
-        return verilog::CreateDocumentSymbolOutline(
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p,
-            false, this->include_variables);
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri), p,
+                include_variables = include_variables]() -> nlohmann::json {
+          // The `false` sets the kate workaround to the set default, as it
+          // was not set here
+          return verilog::CreateDocumentSymbolOutline(tracker.get(), p, false,
+                                                      include_variables);
+        };
       });
 
-  dispatcher_.AddRequestHandler(  // Highlight related symbols under cursor
+  dispatcher_.AddConcurrentRequestHandler(  // Highlight related symbols
       "textDocument/documentHighlight",
       [this](const verible::lsp::DocumentHighlightParams &p) {
-        return verilog::CreateHighlightRanges(
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::CreateHighlightRanges(tracker.get(), p);
+        };
       });
 
-  dispatcher_.AddRequestHandler(  // format range of file
+  dispatcher_.AddConcurrentRequestHandler(  // Foldable blocks
+      "textDocument/foldingRange",
+      [this](const verible::lsp::FoldingRangeParams &p) {
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::CreateFoldingRanges(tracker.get(), p);
+        };
+      });
+
+  dispatcher_.AddConcurrentRequestHandler(  // Expand selection
+      "textDocument/selectionRange",
+      [this](const verible::lsp::SelectionRangeParams &p) {
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::CreateSelectionRanges(tracker.get(), p);
+        };
+      });
+
+  dispatcher_.AddConcurrentRequestHandler(  // format range of file
       "textDocument/rangeFormatting",
       [this](const verible::lsp::DocumentFormattingParams &p) {
-        return verilog::FormatRange(
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::FormatRange(tracker.get(), p);
+        };
       });
-  dispatcher_.AddRequestHandler(  // format entire file
+  dispatcher_.AddConcurrentRequestHandler(  // format entire file
       "textDocument/formatting",
       [this](const verible::lsp::DocumentFormattingParams &p) {
-        return verilog::FormatRange(
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+        return [tracker = SnapshotBufferTracker(p.textDocument.uri),
+                p]() -> nlohmann::json {
+          return verilog::FormatRange(tracker.get(), p);
+        };
       });
   dispatcher_.AddRequestHandler(  // go-to definition
       "textDocument/definition",
@@ -174,14 +318,35 @@ void VerilogLanguageServer::SetRequestHandlers() {
         return symbol_table_handler_.FindRenameLocationsAndCreateEdits(
             p, parsed_buffers_);
       });
+  dispatcher_.AddRequestHandler(  // search symbols by name
+      "workspace/symbol",
+      [this](const verible::lsp::WorkspaceSymbolParams &p) {
+        return symbol_table_handler_.FindWorkspaceSymbols(p);
+      });
+  dispatcher_.AddRequestHandler(  // Performance statistics of this session
+      "$/verible/stats",
+      [this](const nlohmann::json &) { return StatsResponse(); });
   dispatcher_.AddRequestHandler(
       "textDocument/hover", [this](const verible::lsp::HoverParams &p) {
         return CreateHoverInformation(&symbol_table_handler_, parsed_buffers_,
-                                      p);
+                                      p, &hover_cache_);
+      });
+  // Semantic tokens are diffed against the last ones sent, so these requests
+  // are handled in order.
+  dispatcher_.AddRequestHandler(
+      "textDocument/semanticTokens/full",
+      [this](const verible::lsp::SemanticTokensParams &p) {
+        return SemanticTokensResponse(p.textDocument.uri, nullptr);
+      });
+  dispatcher_.AddRequestHandler(
+      "textDocument/semanticTokens/full/delta",
+      [this](const verible::lsp::SemanticTokensDeltaParams &p) {
+        return SemanticTokensResponse(p.textDocument.uri, &p.previousResultId);
       });
   // The client sends a request to shut down. Use that to exit our loop.
   dispatcher_.AddRequestHandler("shutdown", [this](const nlohmann::json &) {
     shutdown_requested_ = true;
+    symbol_table_handler_.StopBackgroundIndexing();
     return nullptr;
   });
 }
@@ -196,9 +361,110 @@ absl::Status VerilogLanguageServer::Run(const ReadFun &read_fun) {
   while (status.ok() && !shutdown_requested_) {
     status = Step(read_fun);
   }
+  dispatcher_.WaitForPendingRequests();  // Send all responses before exiting.
   return status;
 }
 
+nlohmann::json VerilogLanguageServer::SemanticTokensResponse(
+    const std::string &uri, const std::string *previous_result_id) {
+  const BufferTracker *tracker = parsed_buffers_.FindBufferTrackerOrNull(uri);
+  if (tracker == nullptr || tracker->current() == nullptr) return nullptr;
+  const std::shared_ptr<const ParsedBuffer> current = tracker->current();
+  const std::vector<int> &data = current->semantic_tokens();
+
+  SemanticTokensState &state = semantic_tokens_state_[uri];
+  const bool send_delta = previous_result_id != nullptr &&
+                          !state.result_id.empty() &&
+                          *previous_result_id == state.result_id;
+  const std::string result_id = absl::StrCat(current->version());
+  nlohmann::json result;
+  if (send_delta) {
+    verible::lsp::SemanticTokensDelta delta;
+    delta.resultId = result_id;
+    delta.has_resultId = true;
+    delta.edits = DiffSemanticTokens(state.data, data);
+    result = delta;
+  } else {
+    verible::lsp::SemanticTokens tokens;
+    tokens.resultId = result_id;
+    tokens.has_resultId = true;
+    tokens.data = data;
+    result = tokens;
+  }
+  state.result_id = result_id;
+  state.data = data;
+  return result;
+}
+
+std::shared_ptr<const BufferTracker>
+VerilogLanguageServer::SnapshotBufferTracker(const std::string &uri) const {
+  const BufferTracker *tracker = parsed_buffers_.FindBufferTrackerOrNull(uri);
+  if (tracker == nullptr) return nullptr;
+  // The copy refers to the current ParsedBuffers, which are immutable, so it
+  // stays valid while the original tracker is updated with further edits.
+  return std::make_shared<const BufferTracker>(*tracker);
+}
+
+nlohmann::json VerilogLanguageServer::StatsResponse() const {
+  nlohmann::json requests = nlohmann::json::object();
+  for (const auto &[method, latency] : dispatcher_.GetLatencies()) {
+    requests[method] = latency.ToJson();
+  }
+  nlohmann::json lookups = nlohmann::json::object();
+  for (const auto &[kind, stats] : symbol_table_handler_.GetLookupStats()) {
+    lookups[kind] = {
+        {"count", stats.count},
+        {"total_ms", absl::ToDoubleMilliseconds(stats.total_time)},
+    };
+  }
+  const verilog::SymbolTableHandler::RebuildStats &rebuilds =
+      symbol_table_handler_.GetRebuildStats();
+  return {
+      {"requests", std::move(requests)},
+      {"analysis",
+       {
+           {"parse", parse_times_.ToJson()},
+           {"lint", lint_times_.ToJson()},
+       }},
+      {"symbol_table",
+       {
+           {"lookups", std::move(lookups)},
+           {"full_builds",
+            {
+                {"count", rebuilds.full_count},
+                {"total_ms", absl::ToDoubleMilliseconds(rebuilds.full_time)},
+            }},
+           {"incremental_builds",
+            {
+                {"count", rebuilds.incremental_count},
+                {"files", rebuilds.incremental_files},
+                {"total_ms",
+                 absl::ToDoubleMilliseconds(rebuilds.incremental_time)},
+            }},
+       }},
+  };
+}
+
+void VerilogLanguageServer::LogSlowRequest(const std::string &method,
+                                           const nlohmann::json &params,
+                                           absl::Duration duration) {
+  std::string uri;
+  if (const auto document = params.find("textDocument");
+      document != params.end() && document->is_object()) {
+    uri = document->value("uri", "");
+  }
+  int64_t size = -1;
+  if (!uri.empty()) {
+    const std::lock_guard<std::mutex> l(buffer_sizes_mutex_);
+    const auto found = buffer_sizes_.find(uri);
+    if (found != buffer_sizes_.end()) size = found->second;
+  }
+  LOG(WARNING) << "Slow '" << method << "' took "
+               << absl::FormatDuration(duration)
+               << (uri.empty() ? "" : absl::StrCat(" on ", uri))
+               << (size < 0 ? "" : absl::StrCat(" (", size, " bytes)"));
+}
+
 void VerilogLanguageServer::PrintStatistics() const {
   if (shutdown_requested_) {
     std::cerr << "Shutting down due to shutdown request." << std::endl;
@@ -211,6 +477,32 @@ void VerilogLanguageServer::PrintStatistics() const {
   for (const auto &stats : dispatcher_.GetStatCounters()) {
     fprintf(stderr, "%30s %9d\n", stats.first.c_str(), stats.second);
   }
+  for (const auto &[method, latency] : dispatcher_.GetLatencies()) {
+    fprintf(stderr, "%30s p50 %s, p90 %s, p99 %s, max %s\n", method.c_str(),
+            absl::FormatDuration(latency.Quantile(0.5)).c_str(),
+            absl::FormatDuration(latency.Quantile(0.9)).c_str(),
+            absl::FormatDuration(latency.Quantile(0.99)).c_str(),
+            absl::FormatDuration(latency.max()).c_str());
+  }
+  for (const auto &[kind, stats] : symbol_table_handler_.GetLookupStats()) {
+    fprintf(stderr, "%30s %9d lookups, %s total\n",
+            absl::StrCat("symbol ", kind).c_str(), stats.count,
+            absl::FormatDuration(stats.total_time).c_str());
+  }
+  const verilog::SymbolTableHandler::RebuildStats &rebuilds =
+      symbol_table_handler_.GetRebuildStats();
+  fprintf(stderr, "%30s %9d builds, %s total\n", "symbol table full",
+          rebuilds.full_count,
+          absl::FormatDuration(rebuilds.full_time).c_str());
+  fprintf(stderr, "%30s %9d builds, %d files, %s total\n",
+          "symbol table incremental", rebuilds.incremental_count,
+          rebuilds.incremental_files,
+          absl::FormatDuration(rebuilds.incremental_time).c_str());
+  if (const auto stats = symbol_table_handler_.GetSymbolTableStats()) {
+    std::cerr << *stats;
+  }
+  std::cerr << "Memory usage:" << std::endl
+            << symbol_table_handler_.GetMemoryUsage();
 }
 
 verible::lsp::InitializeResult VerilogLanguageServer::InitializeRequestHandler(
@@ -233,9 +525,66 @@ verible::lsp::InitializeResult VerilogLanguageServer::InitializeRequestHandler(
               << "from IDE. Assuming root='.'";
     ConfigureProject("");
   }
+  const nlohmann::json::json_pointer progress("/window/workDoneProgress");
+  client_supports_progress_ = p.capabilities.contains(progress) &&
+                              p.capabilities.at(progress) == true;
+  const nlohmann::json::json_pointer watch(
+      "/workspace/didChangeWatchedFiles/dynamicRegistration");
+  client_supports_file_watching_ =
+      p.capabilities.contains(watch) && p.capabilities.at(watch) == true;
   return GetCapabilities();
 }
 
+void VerilogLanguageServer::WatchProjectFiles() {
+  if (!client_supports_file_watching_) return;
+  const nlohmann::json registration = {
+      {"id", "verible-watched-files"},
+      {"method", "workspace/didChangeWatchedFiles"},
+      {"registerOptions",
+       {{"watchers", nlohmann::json::array({
+                         {{"globPattern", "**/*.{sv,svh,v,vh,svi}"}},
+                     })}}},
+  };
+  dispatcher_.SendRequest(
+      "client/registerCapability",
+      {{"registrations", nlohmann::json::array({registration})}});
+}
+
+void VerilogLanguageServer::IndexProject() {
+  if (!index_pool_) return;
+  verilog::SymbolTableHandler::IndexProgressCallback progress;
+  if (client_supports_progress_) {
+    dispatcher_.SendRequest("window/workDoneProgress/create",
+                            {{"token", kIndexingProgressToken}});
+    progress = [this](int indexed, int total) {
+      ReportIndexingProgress(indexed, total);
+    };
+  }
+  index_progress_percentage_ = -1;
+  const int total = symbol_table_handler_.IndexInBackground(
+      index_pool_.get(), &mutex_, progress);
+  if (progress && total > 0) progress(0, total);
+}
+
+void VerilogLanguageServer::ReportIndexingProgress(int indexed, int total) {
+  // Don't flood the client; only report each percent step.
+  const int percentage = 100 * indexed / total;
+  if (percentage == index_progress_percentage_) return;
+  index_progress_percentage_ = percentage;
+
+  nlohmann::json value;
+  if (indexed == 0) {
+    value = {{"kind", "begin"}, {"title", "Indexing"}, {"percentage", 0}};
+  } else if (indexed < total) {
+    value = {{"kind", "report"}, {"percentage", percentage}};
+  } else {
+    value = {{"kind", "end"}};
+  }
+  value["message"] = absl::StrCat(indexed, "/", total, " files");
+  dispatcher_.SendNotification(
+      "$/progress", {{"token", kIndexingProgressToken}, {"value", value}});
+}
+
 void VerilogLanguageServer::ConfigureProject(absl::string_view project_root) {
   LOG(INFO) << "Initializing with project-root '" << project_root << "'";
   std::string proj_root = {project_root.begin(), project_root.end()};
@@ -256,9 +605,7 @@ void VerilogLanguageServer::ConfigureProject(absl::string_view project_root) {
 
 void VerilogLanguageServer::SendDiagnostics(
     const std::string &uri, const verilog::BufferTracker &buffer_tracker) {
-  // TODO(hzeller): Cache result and rate-limit.
-  // This should not send anything if the diagnostics we're about to
-  // send would be exactly the same as last time.
+  // TODO(hzeller): Rate-limit.
   verible::lsp::PublishDiagnosticsParams params;
 
   // For the diagnostic notification (that we send somewhat unsolicited), we
@@ -266,10 +613,15 @@ void VerilogLanguageServer::SendDiagnostics(
   // textDocument/diagnostic RPC request, we send all of them.
   // Arbitrary limit here. Maybe set with flag ?
   static constexpr int kDiagnosticLimit = 500;
+  DiagnosticsState &state = diagnostics_state_[uri];
   params.uri = uri;
-  params.diagnostics =
-      verilog::CreateDiagnostics(buffer_tracker, kDiagnosticLimit);
+  params.diagnostics = verilog::CreateDiagnostics(
+      buffer_tracker, kDiagnosticLimit, state.last_edit_line);
+
+  // The client keeps showing what it got last time, so only send changes.
+  if (state.published && *state.published == params.diagnostics) return;
   dispatcher_.SendNotification("textDocument/publishDiagnostics", params);
+  state.published = std::move(params.diagnostics);
 }
 
 };  // namespace verilog
@@ -15,14 +15,26 @@
 #ifndef VERILOG_TOOLS_LS_LS_WRAPPER_H
 #define VERILOG_TOOLS_LS_LS_WRAPPER_H
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "common/lsp/json-rpc-dispatcher.h"
+#include "common/lsp/latency-histogram.h"
 #include "common/lsp/lsp-protocol.h"
 #include "common/lsp/lsp-text-buffer.h"
 #include "common/lsp/message-stream-splitter.h"
+#include "common/util/thread_pool.h"
+#include "nlohmann/json.hpp"
+#include "verilog/tools/ls/autoexpand.h"
+#include "verilog/tools/ls/hover.h"
 #include "verilog/tools/ls/lsp-parse-buffer.h"
 #include "verilog/tools/ls/symbol-table-handler.h"
 
@@ -70,6 +82,36 @@ class VerilogLanguageServer {
   // or directory containing verible.filelist
   void ConfigureProject(absl::string_view project_root);
 
+  // Asks the client to report changes of Verilog files and file lists, if it
+  // supports registering for them.
+  void WatchProjectFiles();
+
+  // With --index_threads, starts parsing the project in the background.
+  void IndexProject();
+
+  // Sends the "$/progress" of the background indexing to the client.
+  void ReportIndexingProgress(int indexed, int total);
+
+  // Returns a copy of the buffer tracker of "uri", or nullptr if there is
+  // none, for requests computed outside of the message dispatch.
+  std::shared_ptr<const BufferTracker> SnapshotBufferTracker(
+      const std::string &uri) const;
+
+  // Responds to textDocument/semanticTokens/full (if "previous_result_id" is
+  // nullptr) and .../full/delta: returns the edits relative to the previous
+  // result if the client still has it, the full tokens otherwise.
+  nlohmann::json SemanticTokensResponse(const std::string &uri,
+                                        const std::string *previous_result_id);
+
+  // Responds to $/verible/stats: the latencies of requests by method, the
+  // times spent analyzing buffers, and the symbol table lookups and builds.
+  nlohmann::json StatsResponse() const;
+
+  // Logs a request that took at least --slow_request_threshold_ms, with the
+  // size of the buffer it refers to.
+  void LogSlowRequest(const std::string &method, const nlohmann::json &params,
+                      absl::Duration duration);
+
   // Publish a diagnostic sent to the server.
   void SendDiagnostics(const std::string &uri,
                        const verilog::BufferTracker &buffer_tracker);
@@ -86,11 +128,65 @@ class VerilogLanguageServer {
   // Tracks changes in buffers from BufferCollection and parses their contents
   verilog::BufferTrackerContainer parsed_buffers_;
 
+  // Per open document: where it was last edited and what was last published.
+  struct DiagnosticsState {
+    int last_edit_line = -1;
+    std::optional<std::vector<verible::lsp::Diagnostic>> published;
+  };
+  std::unordered_map<std::string, DiagnosticsState> diagnostics_state_;
+
+  // Per open document: the semantic tokens last sent, to send deltas to.
+  struct SemanticTokensState {
+    std::string result_id;
+    std::vector<int> data;
+  };
+  std::unordered_map<std::string, SemanticTokensState> semantic_tokens_state_;
+
   // Handles requests relying on the symbol table
   verilog::SymbolTableHandler symbol_table_handler_;
 
+  // Module analysis kept between AUTO expansion code action requests
+  verilog::AutoExpandCache autoexpand_cache_;
+
+  // Descriptions kept between hover requests
+  verilog::HoverCache hover_cache_;
+
   // A flag for indicating "shutdown" request
   bool shutdown_requested_ = false;
+
+  // If the client accepts "$/progress" reports created by the server.
+  bool client_supports_progress_ = false;
+  int index_progress_percentage_ = -1;  // Last reported.
+
+  // If the client can watch files for workspace/didChangeWatchedFiles.
+  bool client_supports_file_watching_ = false;
+
+  // Serializes message dispatch with publishing of background analyses
+  // and indexing.
+  std::mutex mutex_;
+
+  // Times spent analyzing and linting each new version of a buffer.
+  verible::lsp::LatencyHistogram parse_times_;
+  verible::lsp::LatencyHistogram lint_times_;
+
+  // Sizes of the open buffers, for LogSlowRequest(), which may be called
+  // from request_pool_ without mutex_ locked.  Guarded by
+  // buffer_sizes_mutex_.
+  std::mutex buffer_sizes_mutex_;
+  std::unordered_map<std::string, int64_t> buffer_sizes_;
+
+  // Threads indexing the project if --index_threads > 0.
+  // Declared after everything the indexing uses, like the pools below.
+  std::unique_ptr<verible::ThreadPool> index_pool_;
+
+  // Threads analyzing changed buffers if --analysis_threads > 0.
+  // Declared after everything but request_pool_, so that running analyses
+  // finish before anything they use is destroyed.
+  std::unique_ptr<verible::ThreadPool> analysis_pool_;
+
+  // Threads answering concurrent requests if --request_threads > 0.
+  // Destroyed first, as running requests write responses via dispatcher_.
+  std::unique_ptr<verible::ThreadPool> request_pool_;
 };
 
 };      // namespace verilog
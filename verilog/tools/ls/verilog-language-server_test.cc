@@ -280,6 +280,49 @@ TEST_F(VerilogLanguageServerTest, LintErrorDetection) {
   EXPECT_EQ(diagnostic_of_fixed["params"]["diagnostics"].size(), 0);
 }
 
+// Diagnostics are only published again if they changed
+TEST_F(VerilogLanguageServerTest, UnchangedDiagnosticsAreNotPublishedAgain) {
+  const std::string lint_error =
+      DidOpenRequest("file://mini.sv", "module mini();\nendmodule");
+  ASSERT_OK(SendRequest(lint_error)) << "process file with linting error";
+  const json diagnostics = json::parse(GetResponse());
+  EXPECT_EQ(diagnostics["method"], "textDocument/publishDiagnostics");
+  EXPECT_EQ(diagnostics["params"]["diagnostics"].size(), 1);
+
+  // Replace the module name with itself: same content, same diagnostics.
+  const absl::string_view same_content =
+      R"({"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file://mini.sv"},"contentChanges":[{"range":{"start":{"character":7,"line":0},"end":{"character":11,"line":0}},"text":"mini"}]}})";
+  ASSERT_OK(SendRequest(same_content));
+  EXPECT_EQ(GetResponse(), "") << "Unchanged diagnostics published again";
+
+  // Fixing the lint error changes them.
+  const absl::string_view apply_fix =
+      R"({"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file://mini.sv"},"contentChanges":[{"range":{"start":{"character":9,"line":1},"end":{"character":9,"line":1}},"text":"\n"}]}})";
+  ASSERT_OK(SendRequest(apply_fix));
+  const json diagnostic_of_fixed = json::parse(GetResponse());
+  EXPECT_EQ(diagnostic_of_fixed["method"], "textDocument/publishDiagnostics");
+  EXPECT_EQ(diagnostic_of_fixed["params"]["diagnostics"].size(), 0);
+}
+
+// Performance statistics are reported by a custom request.
+TEST_F(VerilogLanguageServerTest, StatsRequest) {
+  ASSERT_OK(SendRequest(
+      DidOpenRequest("file://stats.sv", "module stats;\nendmodule\n")));
+  GetResponse();  // Diagnostics.
+
+  const json stats_request = {
+      {"jsonrpc", "2.0"}, {"id", 7}, {"method", "$/verible/stats"}};
+  ASSERT_OK(SendRequest(stats_request.dump()));
+  const json response = json::parse(GetResponse());
+  EXPECT_EQ(response["id"], 7);
+  const json &stats = response["result"];
+  EXPECT_EQ(stats["requests"]["textDocument/didOpen"]["count"], 1);
+  EXPECT_TRUE(stats["requests"]["initialize"].contains("p99_ms"));
+  EXPECT_EQ(stats["analysis"]["parse"]["count"], 1);
+  EXPECT_EQ(stats["analysis"]["lint"]["count"], 1);
+  EXPECT_TRUE(stats["symbol_table"].contains("full_builds"));
+}
+
 // Tests textDocument/documentSymbol request support; expect document outline.
 TEST_F(VerilogLanguageServerTest, DocumentSymbolRequestTest) {
   // Create file, absorb diagnostics
@@ -511,6 +554,94 @@ TEST_F(VerilogLanguageServerTest, SymbolHighlightingTest) {
   EXPECT_EQ(highlight_response2["result"].size(), 0);
 }
 
+// Tests textDocument/semanticTokens/full and .../full/delta requests
+TEST_F(VerilogLanguageServerTest, SemanticTokensFullAndDelta) {
+  const json capabilities =
+      json::parse(GetInitializeResponse())["result"]["capabilities"];
+  EXPECT_EQ(capabilities["semanticTokensProvider"]["full"]["delta"], true);
+
+  ASSERT_OK(SendRequest(
+      DidOpenRequest("file://tok.sv", "module tok;\nendmodule\n")));
+  GetResponse();  // Diagnostics
+
+  const absl::string_view full_request =
+      R"({"jsonrpc":"2.0", "id":30, "method":"textDocument/semanticTokens/full","params":{"textDocument":{"uri":"file://tok.sv"}}})";
+  ASSERT_OK(SendRequest(full_request));
+  const json full = json::parse(GetResponse());
+  EXPECT_EQ(full["id"], 30);
+  EXPECT_EQ(full["result"]["data"],
+            json::parse("[0,0,6,0,0, 0,7,3,6,0, 1,0,9,0,0]"));
+  const std::string result_id = full["result"]["resultId"];
+
+  // Insert a declaration in a line of its own.
+  const absl::string_view add_wire =
+      R"({"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file://tok.sv"},"contentChanges":[{"range":{"start":{"character":0,"line":1},"end":{"character":0,"line":1}},"text":"wire w;\n"}]}})";
+  ASSERT_OK(SendRequest(add_wire));
+  GetResponse();  // Diagnostics, if changed.
+
+  const json delta_request = {
+      {"jsonrpc", "2.0"},
+      {"id", 31},
+      {"method", "textDocument/semanticTokens/full/delta"},
+      {"params",
+       {{"textDocument", {{"uri", "file://tok.sv"}}},
+        {"previousResultId", result_id}}}};
+  ASSERT_OK(SendRequest(delta_request.dump()));
+  const json delta = json::parse(GetResponse());
+  EXPECT_EQ(delta["id"], 31);
+  EXPECT_NE(delta["result"]["resultId"], result_id);
+  ASSERT_EQ(delta["result"]["edits"].size(), 1);
+  EXPECT_EQ(delta["result"]["edits"][0],
+            json::parse(
+                R"({"start":10, "deleteCount":0, "data":[1,0,4,0,0, 0,5,1,9,0]})"));
+
+  // Without the previous result, the client gets all tokens again.
+  const absl::string_view stale_request =
+      R"({"jsonrpc":"2.0", "id":32, "method":"textDocument/semanticTokens/full/delta","params":{"textDocument":{"uri":"file://tok.sv"},"previousResultId":"stale"}})";
+  ASSERT_OK(SendRequest(stale_request));
+  const json stale = json::parse(GetResponse());
+  EXPECT_EQ(stale["id"], 32);
+  EXPECT_EQ(stale["result"]["data"].size(), 25);
+  EXPECT_FALSE(stale["result"].contains("edits"));
+}
+
+// Tests textDocument/foldingRange and textDocument/selectionRange requests
+TEST_F(VerilogLanguageServerTest, FoldingAndSelectionRanges) {
+  ASSERT_OK(SendRequest(DidOpenRequest("file://fold.sv",
+                                       "module fold;\n"
+                                       "  initial begin\n"
+                                       "    $display(1);\n"
+                                       "  end\n"
+                                       "endmodule\n")));
+  GetResponse();  // Diagnostics
+
+  const absl::string_view folding_request =
+      R"({"jsonrpc":"2.0", "id":40, "method":"textDocument/foldingRange","params":{"textDocument":{"uri":"file://fold.sv"}}})";
+  ASSERT_OK(SendRequest(folding_request));
+  const json folding = json::parse(GetResponse());
+  EXPECT_EQ(folding["id"], 40);
+  EXPECT_EQ(folding["result"], json::parse(R"([
+      {"startLine":0, "endLine":3},
+      {"startLine":1, "endLine":2}])"));
+
+  const absl::string_view selection_request =
+      R"({"jsonrpc":"2.0", "id":41, "method":"textDocument/selectionRange","params":{"textDocument":{"uri":"file://fold.sv"},"positions":[{"line":2,"character":6}]}})";
+  ASSERT_OK(SendRequest(selection_request));
+  const json selection = json::parse(GetResponse());
+  EXPECT_EQ(selection["id"], 41);
+  ASSERT_EQ(selection["result"].size(), 1);
+  const json &token = selection["result"][0];
+  EXPECT_EQ(token["range"], json::parse(R"({"start":{"line":2,"character":4},
+                                            "end":{"line":2,"character":12}})"));
+  EXPECT_EQ(token["parent"]["range"],
+            json::parse(R"({"start":{"line":1,"character":10},
+                            "end":{"line":3,"character":5}})"));
+  EXPECT_EQ(token["parent"]["parent"]["range"],
+            json::parse(R"({"start":{"line":0,"character":0},
+                            "end":{"line":4,"character":9}})"));
+  EXPECT_FALSE(token["parent"]["parent"].contains("parent"));
+}
+
 // Tests structure holding data for test textDocument/rangeFormatting requests
 struct FormattingRequestParams {
   FormattingRequestParams(int id, int start_line, int start_character,
@@ -610,6 +741,37 @@ TEST_F(VerilogLanguageServerTest, RangeFormattingTest) {
   }
 }
 
+// Checks that range formatting only replaces the lines that change
+TEST_F(VerilogLanguageServerTest, RangeFormattingMinimalEditTest) {
+  const std::string mini_module = DidOpenRequest(
+      "file://fmt.sv",
+      "module fmt ();\n  assign a = 1;\nassign b=2;\nendmodule\n");
+  ASSERT_OK(SendRequest(mini_module));
+
+  const json diagnostics = json::parse(GetResponse());
+  EXPECT_EQ(diagnostics["params"]["diagnostics"].size(), 0)
+      << "The test file has errors";
+
+  const FormattingRequestParams changed_params{
+      40, 1, 0, 3, 0, "  assign b = 2;\n", 2, 0, 3, 0};
+  ASSERT_OK(SendRequest(FormattingRequest("file://fmt.sv", changed_params)));
+  const json changed_response = json::parse(GetResponse());
+  EXPECT_EQ(changed_response["id"], 40) << "Invalid id";
+  ASSERT_EQ(changed_response["result"].size(), 1);
+  EXPECT_EQ(std::string(changed_response["result"][0]["newText"]),
+            changed_params.new_text);
+  EXPECT_EQ(changed_response["result"][0]["range"]["start"]["line"], 2);
+  EXPECT_EQ(changed_response["result"][0]["range"]["end"]["line"], 3);
+
+  const FormattingRequestParams unchanged_params{41, 1, 0, 2, 0, "", 0,
+                                                 0,  0, 0};
+  ASSERT_OK(SendRequest(FormattingRequest("file://fmt.sv", unchanged_params)));
+  const json unchanged_response = json::parse(GetResponse());
+  EXPECT_EQ(unchanged_response["id"], 41) << "Invalid id";
+  EXPECT_EQ(unchanged_response["result"].size(), 0)
+      << "Already formatted lines should not be edited";
+}
+
 // Runs test of entire document formatting with textDocument/formatting request
 TEST_F(VerilogLanguageServerTest, FormattingTest) {
   // Create sample file and make sure diagnostics do not have errors
@@ -783,6 +945,56 @@ endmodule
   ASSERT_TRUE(absl::StrContains(hover.contents.value, "reg [31:0]"));
 }
 
+// Checks that hovering again describes the symbol as changed by an edit
+TEST_F(VerilogLanguageServerSymbolTableTest, HoverAfterChangedDeclaration) {
+  absl::string_view filelist_content = "mod.v\n";
+  static constexpr absl::string_view  //
+      module_content(
+          R"(module mod(
+    input clk,
+    output reg [31:0] sum);
+  assign sum = 0;
+endmodule
+)");
+
+  const verible::file::testing::ScopedTestFile filelist(
+      root_dir, filelist_content, "verible.filelist");
+  const verible::file::testing::ScopedTestFile module(root_dir, module_content,
+                                                      "mod.v");
+  const std::string uri = "file://" + module.filename();
+
+  ASSERT_OK(SendRequest(DidOpenRequest(uri, module_content)));
+  GetResponse();
+
+  for (int id : {2, 3}) {
+    ASSERT_OK(SendRequest(HoverRequest(uri, id, /* line */ 3,
+                                       /* column */ 10)));
+    const json response = json::parse(GetResponse());
+    const verible::lsp::Hover hover = response["result"];
+    EXPECT_TRUE(absl::StrContains(hover.contents.value, "reg [31:0]"));
+  }
+
+  // Narrow the declaration from [31:0] to [7:0].
+  const json change = {
+      {"jsonrpc", "2.0"},
+      {"method", "textDocument/didChange"},
+      {"params",
+       {{"textDocument", {{"uri", uri}}},
+        {"contentChanges",
+         {{{"range",
+            {{"start", {{"line", 2}, {"character", 16}}},
+             {"end", {{"line", 2}, {"character", 18}}}}},
+           {"text", "7"}}}}}}};
+  ASSERT_OK(SendRequest(change.dump()));
+  GetResponse();  // Diagnostics, if changed.
+
+  ASSERT_OK(SendRequest(HoverRequest(uri, 4, /* line */ 3, /* column */ 10)));
+  const json response = json::parse(GetResponse());
+  const verible::lsp::Hover hover = response["result"];
+  EXPECT_TRUE(absl::StrContains(hover.contents.value, "reg [7:0]"))
+      << hover.contents.value;
+}
+
 // Checks if the hover appears on "end" token when block name is available
 TEST_F(VerilogLanguageServerSymbolTableTest, HoverOverEnd) {
   absl::string_view filelist_content = "mod.v\n";
@@ -271,5 +271,54 @@ for intact_name in ${intact_names[@]}; do
   }
 done
 
+###############################################################################
+echo "### Testing obfuscation of multiple files with a shared map"
+
+declare -r MY_OUTPUT_DIR="${TEST_TMPDIR}/outdir"
+
+cat >"${MY_INPUT_FILE}" <<EOF
+  module foo(input clk);
+  endmodule
+EOF
+
+cat >"${MY_INPUT_FILE2}" <<EOF
+  module bar;
+    foo   f(.clk(clk));
+  endmodule
+EOF
+
+echo "Run obfuscator on two files."
+"${obfuscator}" --jobs=2 --output_dir="${MY_OUTPUT_DIR}" \
+  --save_map="${MY_SAVEMAP_FILE}" "${MY_INPUT_FILE}" "${MY_INPUT_FILE2}"
+status="$?"
+[[ $status == 0 ]] || {
+  echo "Expected exit code 0, but got $status"
+  exit 1
+}
+
+for input in "${MY_INPUT_FILE}" "${MY_INPUT_FILE2}"; do
+  "${difftool}" --mode=obfuscate "${input}" "${MY_OUTPUT_DIR}/${input#/}" || exit 1
+done
+
+echo "Verify that both files use the same substitutions."
+for name in foo clk; do
+  [[ $(grep -c "^${name} " "${MY_SAVEMAP_FILE}") == 1 ]] || {
+    echo "Expected one mapping for name: ${name}"
+    cat "${MY_SAVEMAP_FILE}"
+    exit 1
+  }
+done
+"${obfuscator}" --decode --load_map="${MY_SAVEMAP_FILE}" \
+  < "${MY_OUTPUT_DIR}/${MY_INPUT_FILE2#/}" > "${MY_OUTPUT_FILE2}"
+diff --strip-trailing-cr -u "${MY_INPUT_FILE2}" "${MY_OUTPUT_FILE2}" || exit 1
+
+echo "Output directory is required."
+"${obfuscator}" "${MY_INPUT_FILE}"
+status="$?"
+[[ $status == 1 ]] || {
+  echo "Expected exit code 1, but got $status"
+  exit 1
+}
+
 ###############################################################################
 echo "PASS"
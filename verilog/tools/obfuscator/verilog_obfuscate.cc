@@ -14,29 +14,38 @@
 
 // verilog_obfuscate mangles verilog code by changing identifiers.
 // All whitespace and identifier lengths are preserved.
-// Output is written to stdout.
+// Output is written to stdout, or with file arguments, to files in
+// --output_dir.
 //
 // Example usage:
 // verilog_obfuscate [options] < file > output
 // cat files... | verilog_obfuscate [options] > output
+// verilog_obfuscate [options] --output_dir=dir files...
 
+#include <functional>
+#include <future>
 #include <iostream>
 #include <set>
-#include <sstream>  // IWYU pragma: keep  // for ostringstream
 #include <string>   // for string, allocator, etc
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "common/strings/mem_block.h"
 #include "common/strings/obfuscator.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
+#include "common/util/thread_pool.h"
 #include "verilog/analysis/extractors.h"
 #include "verilog/preprocessor/verilog_preprocess.h"
 #include "verilog/transform/obfuscate.h"
 
+using verible::ConcurrentIdentifierObfuscator;
 using verible::IdentifierObfuscator;
 
 ABSL_FLAG(                      //
@@ -62,6 +71,19 @@ ABSL_FLAG(                            //
 ABSL_FLAG(                                   //
     bool, preserve_builtin_functions, true,  //
     "If true, preserve built-in function names such as sin(), ceil()..");
+ABSL_FLAG(                        //
+    std::string, output_dir, "",  //
+    "Directory to write obfuscated files to, when files are given as "
+    "arguments.  Each file is written to the same relative path under this "
+    "directory, as soon as it is obfuscated.");
+ABSL_FLAG(                        //
+    std::string, files_from, "",  //
+    "Name of a file that lists files to obfuscate, one per line, in addition "
+    "to the positional arguments.  Empty lines are ignored.");
+ABSL_FLAG(           //
+    int, jobs, 1,    //
+    "Number of files obfuscated concurrently.  All files share one "
+    "translation map, which is saved once at the end with --save_map.");
 
 static constexpr absl::string_view kBuiltinFunctions[] = {
     "abs",  "acos", "acosh", "asin", "asinh", "atan",  "atan2", "atanh",
@@ -69,44 +91,209 @@ static constexpr absl::string_view kBuiltinFunctions[] = {
     "pow",  "sin",  "sinh",  "sqrt", "tan",   "tanh",
 };
 
-int main(int argc, char **argv) {
-  const auto usage = absl::StrCat("usage: ", argv[0],
-                                  " [options] < original > output\n"
-                                  R"(
-verilog_obfuscate mangles Verilog code by changing identifiers.
-All whitespaces and identifier lengths are preserved.
-Output is written to stdout.
-)");
-  const auto args = verible::InitCommandLine(usage, &argc, &argv);
-
-  // initially empty identifier map
-  IdentifierObfuscator subst(verilog::RandomEqualLengthSymbolIdentifier);
-
+// Pre-loads --load_map and the identifiers to preserve that do not depend on
+// the input, into "subst".  Returns false on error, after printing it.
+template <class ObfuscatorType>
+static bool InitializeSubstitutions(ObfuscatorType *subst) {
   // Set mode to encode or decode.
   const bool decode = absl::GetFlag(FLAGS_decode);
-  subst.set_decode_mode(decode);
+  subst->set_decode_mode(decode);
 
   const auto &load_map_file = absl::GetFlag(FLAGS_load_map);
-  const auto &save_map_file = absl::GetFlag(FLAGS_save_map);
   if (!load_map_file.empty()) {
     absl::StatusOr<std::string> load_map_content_or =
         verible::file::GetContentAsString(load_map_file);
     if (!load_map_content_or.ok()) {
       std::cerr << "Error reading --load_map file " << load_map_file << ": "
                 << load_map_content_or.status() << std::endl;
-      return 1;
+      return false;
     }
-    const absl::Status status = subst.load(*load_map_content_or);
+    const absl::Status status = subst->load(*load_map_content_or);
     if (!status.ok()) {
       std::cerr << "Error parsing --load_map file: " << load_map_file << '\n'
                 << status.message() << std::endl;
-      return 1;
+      return false;
     }
   } else if (decode) {
     std::cerr << "--load_map is required with --decode." << std::endl;
+    return false;
+  }
+
+  if (absl::GetFlag(FLAGS_preserve_builtin_functions)) {
+    for (const absl::string_view f : kBuiltinFunctions) {
+      subst->encode(f, f);
+    }
+  }
+  return true;
+}
+
+// Writes the translation map to --save_map, if requested.
+template <class ObfuscatorType>
+static bool SaveSubstitutions(const ObfuscatorType &subst) {
+  const auto &save_map_file = absl::GetFlag(FLAGS_save_map);
+  if (!absl::GetFlag(FLAGS_decode) && !save_map_file.empty()) {
+    if (!verible::file::SetContents(save_map_file, subst.save()).ok()) {
+      std::cerr << "Error writing --save_map file: " << save_map_file
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Appends the files listed in "list_file", one per line, to "filenames".
+static absl::Status ReadFileList(absl::string_view list_file,
+                                 std::vector<std::string> *filenames) {
+  absl::StatusOr<std::string> content_or =
+      verible::file::GetContentAsString(list_file);
+  if (!content_or.ok()) return content_or.status();
+  for (absl::string_view line : absl::StrSplit(*content_or, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!line.empty()) filenames->emplace_back(line);
+  }
+  return absl::OkStatus();
+}
+
+// Creates the directories leading to "path" that do not exist yet.
+static absl::Status CreateParentDirs(absl::string_view path) {
+  const absl::string_view dir = verible::file::Dirname(path);
+  if (dir.empty() || dir == path) return absl::OkStatus();
+  if (auto status = CreateParentDirs(dir); !status.ok()) return status;
+  return verible::file::CreateDir(dir);
+}
+
+// Obfuscates one file into --output_dir.  Returns error messages, if any.
+static std::string ObfuscateOneFile(const std::string &filename,
+                                    absl::string_view output_dir,
+                                    ConcurrentIdentifierObfuscator *subst) {
+  const auto content_or = verible::file::GetContentAsMemBlock(filename);
+  if (!content_or.ok()) {
+    return absl::StrCat(content_or.status().message(), "\n");
+  }
+  std::string output;
+  const auto status =
+      verilog::ObfuscateVerilogCode((*content_or)->AsStringView(), &output,
+                                    subst);
+  if (!status.ok()) {
+    return absl::StrCat(filename, ": ", status.message(), "\n");
+  }
+  const std::string output_file = verible::file::JoinPath(
+      output_dir, absl::StripPrefix(filename, "/"));
+  if (auto dir_status = CreateParentDirs(output_file); !dir_status.ok()) {
+    return absl::StrCat(dir_status.message(), "\n");
+  }
+  if (auto write_status = verible::file::SetContents(output_file, output);
+      !write_status.ok()) {
+    return absl::StrCat(output_file, ": ", write_status.message(), "\n");
+  }
+  return "";
+}
+
+// Obfuscates all "filenames" with one shared translation map, on --jobs
+// threads.  Returns the exit code.
+static int ObfuscateFiles(const std::vector<std::string> &filenames) {
+  const std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  if (output_dir.empty()) {
+    std::cerr << "--output_dir is required with file arguments." << std::endl;
     return 1;
   }
 
+  ConcurrentIdentifierObfuscator subst(
+      verilog::RandomEqualLengthSymbolIdentifier);
+  if (!InitializeSubstitutions(&subst)) return 1;
+
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  verible::ThreadPool pool(jobs > 1 ? jobs : 0);
+
+  // Interface names of all files have to be known before any is obfuscated,
+  // so that they are preserved consistently.
+  if (absl::GetFlag(FLAGS_preserve_interface)) {
+    using NamesOrStatus = absl::StatusOr<std::set<std::string>>;
+    std::vector<std::future<NamesOrStatus>> names;
+    names.reserve(filenames.size());
+    for (const auto &filename : filenames) {
+      names.push_back(
+          pool.ExecAsync<NamesOrStatus>([&filename]() -> NamesOrStatus {
+            const auto content_or =
+                verible::file::GetContentAsMemBlock(filename);
+            if (!content_or.ok()) return content_or.status();
+            std::set<std::string> preserved;
+            const auto status = verilog::analysis::CollectInterfaceNames(
+                (*content_or)->AsStringView(), &preserved,
+                verilog::VerilogPreprocess::Config());
+            if (!status.ok()) {
+              return absl::Status(
+                  status.code(),
+                  absl::StrCat(filename, ": ", status.message()));
+            }
+            return preserved;
+          }));
+    }
+    bool names_ok = true;
+    for (auto &file_names : names) {
+      const NamesOrStatus names_or = file_names.get();
+      if (!names_or.ok()) {
+        std::cerr << names_or.status().message() << std::endl;
+        names_ok = false;
+        continue;
+      }
+      for (const auto &preserved_name : *names_or) {
+        subst.encode(preserved_name, preserved_name);
+      }
+    }
+    if (!names_ok) return 1;
+  }
+
+  // Each file is written as soon as it is done; messages are printed in the
+  // order of the files.
+  std::vector<std::future<std::string>> messages;
+  messages.reserve(filenames.size());
+  for (const auto &filename : filenames) {
+    messages.push_back(pool.ExecAsync<std::string>(
+        [&filename, &output_dir, &subst]() {
+          return ObfuscateOneFile(filename, output_dir, &subst);
+        }));
+  }
+  int exit_code = 0;
+  for (auto &message : messages) {
+    const std::string text = message.get();
+    if (!text.empty()) {
+      std::cerr << text;
+      exit_code = 1;
+    }
+  }
+
+  if (!SaveSubstitutions(subst)) return 1;
+  return exit_code;
+}
+
+int main(int argc, char **argv) {
+  const auto usage = absl::StrCat("usage: ", argv[0],
+                                  " [options] < original > output\n"
+                                  "       ", argv[0],
+                                  " [options] --output_dir=DIR files...\n"
+                                  R"(
+verilog_obfuscate mangles Verilog code by changing identifiers.
+All whitespaces and identifier lengths are preserved.
+Output is written to stdout, or for files, to the same paths under DIR.
+)");
+  const auto args = verible::InitCommandLine(usage, &argc, &argv);
+
+  // All positional arguments are file names.  Exclude program name.
+  std::vector<std::string> filenames(args.begin() + 1, args.end());
+  const std::string files_from = absl::GetFlag(FLAGS_files_from);
+  if (!files_from.empty()) {
+    if (auto status = ReadFileList(files_from, &filenames); !status.ok()) {
+      std::cerr << status.message() << std::endl;
+      return 1;
+    }
+  }
+  if (!filenames.empty()) return ObfuscateFiles(filenames);
+
+  // initially empty identifier map
+  IdentifierObfuscator subst(verilog::RandomEqualLengthSymbolIdentifier);
+  if (!InitializeSubstitutions(&subst)) return 1;
+
   // Read from stdin.
   auto content_or = verible::file::GetContentAsString("-");
   if (!content_or.ok()) {
@@ -130,14 +317,8 @@ Output is written to stdout.
     }
   }
 
-  if (absl::GetFlag(FLAGS_preserve_builtin_functions)) {
-    for (const absl::string_view f : kBuiltinFunctions) {
-      subst.encode(f, f);
-    }
-  }
-
   // Encode/obfuscate.  Also verifies decode-ability.
-  std::ostringstream output;  // result buffer
+  std::string output;  // result buffer
   const auto status =
       verilog::ObfuscateVerilogCode(*content_or, &output, &subst);
   if (!status.ok()) {
@@ -145,15 +326,9 @@ Output is written to stdout.
     return 1;
   }
 
-  if (!decode && !save_map_file.empty()) {
-    if (!verible::file::SetContents(save_map_file, subst.save()).ok()) {
-      std::cerr << "Error writing --save_map file: " << save_map_file
-                << std::endl;
-      return 1;
-    }
-  }
+  if (!SaveSubstitutions(subst)) return 1;
 
   // Print obfuscated code.
-  std::cout << output.str();
+  std::cout << output;
   return 0;
 }
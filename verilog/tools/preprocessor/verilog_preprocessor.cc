@@ -12,7 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,24 +29,42 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
 #include "common/text/token_stream_view.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/status_macros.h"
 #include "common/util/subcommand.h"
+#include "common/util/thread_pool.h"
 #include "verilog/analysis/flow_tree.h"
 #include "verilog/analysis/verilog_filelist.h"
 #include "verilog/analysis/verilog_project.h"
 #include "verilog/parser/verilog_lexer.h"
+#include "verilog/preprocessor/macro_database.h"
 #include "verilog/preprocessor/verilog_preprocess.h"
 #include "verilog/transform/strip_comments.h"
 
 using verible::SubcommandArgsRange;
 using verible::SubcommandEntry;
-using FileOpener = verilog::VerilogPreprocess::FileOpener;
+using BlockOpener = verilog::VerilogPreprocess::BlockOpener;
 
 // TODO(karimtera): Add a boolean flag to configure the macro expansion.
 ABSL_FLAG(int, limit_variants, 20, "Maximum number of variants printed");
+ABSL_FLAG(bool, distinct_variants, false,
+          "If true, only prints variants whose tokens differ from those of "
+          "the variants printed before.");
+ABSL_FLAG(std::string, macro_db, "",
+          "Macro database, written by --save_macro_db, whose definitions are "
+          "defined before preprocessing each file.");
+ABSL_FLAG(std::string, save_macro_db, "",
+          "If set, saves the macros defined by the preprocessed files, and "
+          "not undefined again, to this macro database.");
+ABSL_FLAG(int, jobs, 1,
+          "Number of files to preprocess in parallel.  Each job opens and "
+          "preprocesses the included files once for all of its files.");
+ABSL_FLAG(std::string, output_dir, "",
+          "If set, writes each preprocessed file to a file of the same "
+          "basename in this directory instead of to stdout.");
 
 static absl::Status StripComments(const SubcommandArgsRange& args,
                                   std::istream&, std::ostream& outs,
@@ -57,8 +81,8 @@ static absl::Status StripComments(const SubcommandArgsRange& args,
         "Missing file argument.  Use '-' for stdin.");
   }
   const absl::string_view source_file = files[0];
-  absl::StatusOr<std::string> source_contents_or =
-      verible::file::GetContentAsString(source_file);
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> source_contents_or =
+      verible::file::GetContentAsMemBlock(source_file);
   if (!source_contents_or.ok()) {
     return source_contents_or.status();
   }
@@ -79,7 +103,8 @@ static absl::Status StripComments(const SubcommandArgsRange& args,
     return absl::InvalidArgumentError("Too many arguments.");
   }
 
-  verilog::StripVerilogComments(*source_contents_or, &outs, replace_char);
+  verilog::StripVerilogComments((*source_contents_or)->AsStringView(), &outs,
+                               replace_char);
 
   return absl::OkStatus();
 }
@@ -87,9 +112,11 @@ static absl::Status StripComments(const SubcommandArgsRange& args,
 static absl::Status PreprocessSingleFile(
     absl::string_view source_file,
     const verilog::FileList::PreprocessingInfo& preprocessing_info,
+    verilog::VerilogProject* project, verilog::IncludeFileCache* include_cache,
+    const verilog::MacroDatabase* macro_db, verilog::MacroDatabase* save_db,
     std::ostream& outs, std::ostream& message_stream) {
-  absl::StatusOr<std::string> source_contents_or =
-      verible::file::GetContentAsString(source_file);
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> source_contents_or =
+      verible::file::GetContentAsMemBlock(source_file);
   if (!source_contents_or.ok()) {
     message_stream << source_file << source_contents_or.status();
     return source_contents_or.status();
@@ -99,21 +126,29 @@ static absl::Status PreprocessSingleFile(
   config.include_files = true;
   config.expand_macros = true;
 
-  verilog::VerilogProject project(".", preprocessing_info.include_dirs);
-
-  FileOpener file_opener =
-      [&project](
-          absl::string_view filename) -> absl::StatusOr<absl::string_view> {
-    auto result = project.OpenIncludedFile(filename);
+  // The preprocessor shares the blocks of the included files with the
+  // project.
+  BlockOpener file_opener = [project](absl::string_view filename)
+      -> absl::StatusOr<std::shared_ptr<verible::MemBlock>> {
+    auto result = project->OpenIncludedFile(filename);
     if (!result.status().ok()) return result.status();
-    return (*result)->GetContent();
+    std::shared_ptr<verible::MemBlock> block = (*result)->GetContentBlock();
+    if (block == nullptr) {
+      block =
+          std::make_shared<verible::StringMemBlock>((*result)->GetContent());
+    }
+    return block;
   };
   verilog::VerilogPreprocess preprocessor(config, file_opener);
+  preprocessor.SetIncludeFileCache(include_cache);
 
   // Setting the preprocessing info (defines, and incdirs) in the preprocessor.
   preprocessor.setPreprocessingInfo(preprocessing_info);
+  if (macro_db != nullptr) {
+    preprocessor.RegisterMacroDefinitions(macro_db->Definitions());
+  }
 
-  verilog::VerilogLexer lexer(*source_contents_or);
+  verilog::VerilogLexer lexer((*source_contents_or)->AsStringView());
   verible::TokenSequence lexed_sequence;
   for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
        lexer.DoNextToken()) {
@@ -133,6 +168,12 @@ static absl::Status PreprocessSingleFile(
   if (!preprocessed_data.errors.empty()) {
     return absl::InvalidArgumentError("Error: The preprocessing has failed.");
   }
+  // The database copies the definitions before the source contents go away.
+  if (save_db != nullptr) {
+    for (const auto& [name, definition] : preprocessed_data.macro_definitions) {
+      save_db->Add(definition);
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -154,10 +195,93 @@ static absl::Status MultipleCU(const SubcommandArgsRange& args, std::istream&,
   if (files.empty()) {
     return absl::InvalidArgumentError("ERROR: Missing file argument.");
   }
-  for (const absl::string_view source_file : files) {
-    RETURN_IF_ERROR(PreprocessSingleFile(source_file, preprocessing_info, outs,
-                                         message_stream));
+  // Loaded definitions have to outlive the include caches.  They are only
+  // read, so all jobs share them.
+  std::unique_ptr<verilog::MacroDatabase> macro_db;
+  if (const std::string path = absl::GetFlag(FLAGS_macro_db); !path.empty()) {
+    auto loaded = verilog::MacroDatabase::Load(path);
+    if (!loaded.ok()) return loaded.status();
+    macro_db = std::move(*loaded);
+  }
+  const std::string save_path = absl::GetFlag(FLAGS_save_macro_db);
+
+  const std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  std::vector<std::string> output_paths;
+  if (!output_dir.empty()) {
+    RETURN_IF_ERROR(verible::file::CreateDir(output_dir));
+    std::set<absl::string_view> basenames;
+    for (const absl::string_view source_file : files) {
+      const absl::string_view basename = verible::file::Basename(source_file);
+      if (!basenames.insert(basename).second) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("ERROR: More than one file named '", basename,
+                         "' to write to --output_dir."));
+      }
+      output_paths.push_back(verible::file::JoinPath(output_dir, basename));
+    }
+  }
+
+  const int jobs = std::clamp<int>(absl::GetFlag(FLAGS_jobs), 1, files.size());
+  // A single job writing to stdout does so as it goes.
+  const bool write_directly = jobs == 1 && output_dir.empty();
+
+  // What is kept of each file until the files before it are written.
+  struct PreprocessedFile {
+    absl::Status status;
+    std::string output;  // Unless written directly or to --output_dir.
+    std::string messages;
+    verilog::MacroDatabase definitions;  // With --save_macro_db.
+  };
+  std::vector<PreprocessedFile> results(files.size());
+  std::atomic<size_t> next_file = 0;
+  std::atomic<bool> failed = false;
+
+  // Each job takes the next file until all are done, or one failed as the
+  // files after it are not written then.
+  auto preprocess_files = [&](size_t, size_t) {
+    // Included files are opened, lexed and preprocessed once per job.
+    verilog::VerilogProject project(".", preprocessing_info.include_dirs);
+    verilog::IncludeFileCache include_cache;
+    for (size_t i = next_file++; i < files.size() && !failed; i = next_file++) {
+      PreprocessedFile& result = results[i];
+      std::ostringstream output;
+      std::ostringstream messages;
+      result.status = PreprocessSingleFile(
+          files[i], preprocessing_info, &project, &include_cache,
+          macro_db.get(), save_path.empty() ? nullptr : &result.definitions,
+          write_directly ? outs : output,
+          write_directly ? message_stream : messages);
+      if (!output_dir.empty()) {
+        const absl::Status written =
+            verible::file::SetContents(output_paths[i], output.str());
+        if (result.status.ok()) result.status = written;
+      } else if (!write_directly) {
+        result.output = output.str();
+      }
+      result.messages = messages.str();
+      if (!result.status.ok()) failed = true;
+    }
+  };
+  if (jobs == 1) {
+    preprocess_files(0, 1);
+  } else {
+    // The calling thread is one of the jobs.
+    verible::ThreadPool pool(jobs - 1);
+    pool.ParallelFor(0, jobs, 1, preprocess_files);
+  }
+
+  // Writes the files in order, up to the first one that failed, as if they
+  // were preprocessed one after the other.
+  verilog::MacroDatabase save_db;
+  for (const PreprocessedFile& result : results) {
+    outs << result.output;
+    message_stream << result.messages;
+    if (!result.status.ok()) return result.status;
+    for (const auto& [name, definition] : result.definitions.Definitions()) {
+      save_db.Add(definition);
+    }
   }
+  if (!save_path.empty()) RETURN_IF_ERROR(save_db.Save(save_path));
   return absl::OkStatus();
 }
 
@@ -183,15 +307,15 @@ static absl::Status GenerateVariants(const SubcommandArgsRange& args,
         "ERROR: generate-variants only works on one file.");
   }
   const auto& source_file = files[0];
-  absl::StatusOr<std::string> source_contents_or =
-      verible::file::GetContentAsString(source_file);
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> source_contents_or =
+      verible::file::GetContentAsMemBlock(source_file);
   if (!source_contents_or.ok()) {
     message_stream << source_file << source_contents_or.status();
     return source_contents_or.status();
   }
 
   // Lexing the input SV source code.
-  verilog::VerilogLexer lexer(*source_contents_or);
+  verilog::VerilogLexer lexer((*source_contents_or)->AsStringView());
   verible::TokenSequence lexed_sequence;
   for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
        lexer.DoNextToken()) {
@@ -204,7 +328,7 @@ static absl::Status GenerateVariants(const SubcommandArgsRange& args,
   }
 
   // Control flow tree constructing.
-  verilog::FlowTree control_flow_tree(lexed_sequence);
+  verilog::FlowTree control_flow_tree(std::move(lexed_sequence));
   int counter = 0;
   return control_flow_tree.GenerateVariants(
       [limit_variants, &outs, &message_stream,
@@ -212,12 +336,15 @@ static absl::Status GenerateVariants(const SubcommandArgsRange& args,
         if (counter == limit_variants) return false;
         counter++;
         message_stream << "Variant number " << counter << ":\n";
-        for (auto token : variant.sequence) outs << token << '\n';
+        for (const auto& slice : variant.slices) {
+          for (const auto& token : slice) outs << token << '\n';
+        }
         // TODO(karimtera): Consider creating an output file per vairant,
         // Such that the files naming reflects which defines are
         // defined/undefined.
         return true;
-      });
+      },
+      absl::GetFlag(FLAGS_distinct_variants));
 }
 
 static const std::pair<absl::string_view, SubcommandEntry> kCommands[] = {
@@ -231,9 +358,16 @@ Inputs:
   other files (so multiple files will _not_ be treated as compilation unit).
   The +define+ and +include+ directives on the commandline are honored by
   the preprocessor.
+  '--macro_db' defines the macros of a database before each file.
+  '--save_macro_db' saves the macros defined by the files, after the ones
+  of '--macro_db', to a database that later runs can load with '--macro_db'
+  instead of preprocessing the defining files again.
+  '--jobs' preprocesses that many files in parallel.
 Output: (stdout)
   The preprocessed files content (same contents with directives interpreted)
-  will be written to stdout, concatenated.
+  will be written to stdout, concatenated in the order of the files.
+  With '--output_dir', each one is written to a file of the same basename in
+  that directory instead.
 )"}},
 
     {"strip-comments",
@@ -254,10 +388,12 @@ Output: (stdout)
 
     {"generate-variants",
      {&GenerateVariants,
-      R"(generate-variants file [-limit_variants number]
+      R"(generate-variants file [-limit_variants number] [-distinct_variants]
 Inputs:
   'file' is a Verilog or SystemVerilog source file.
   '-limit_variants' flag limits variants to 'number' (20 by default).
+  '-distinct_variants' flag skips variants with the same tokens as a variant
+  printed before.
 Output: (stdout)
    Generates every possible variant of `ifdef blocks considering the
    conditional directives.
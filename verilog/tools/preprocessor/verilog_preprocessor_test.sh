@@ -807,5 +807,93 @@ diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || {
   exit 1
 }
 
+################################################################################
+echo "=== Line:${LINENO} Test preprocess: several files with --jobs, in order"
+
+readonly MY_SECOND_INPUT_FILE="${TEST_TMPDIR}/mysecondinput.txt"
+
+cat > "$MY_INPUT_FILE" <<EOF
+\`include "${MY_RELATIVE_INCLUDED_FILE_1}"
+first
+EOF
+
+cat > "$MY_SECOND_INPUT_FILE" <<EOF
+\`include "${MY_RELATIVE_INCLUDED_FILE_1}"
+second
+EOF
+
+cat > "$MY_ABSOLUTE_INCLUDED_FILE_1" <<EOF
+included
+EOF
+
+cat > "$MY_EXPECT_FILE" <<EOF
+included
+
+first
+included
+
+second
+EOF
+
+"$preprocessor" preprocess --jobs=2 "$MY_INPUT_FILE" "$MY_SECOND_INPUT_FILE" \
+  +incdir+${MY_INCLUDED_FILE_PATH_1} > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || {
+  exit 1
+}
+
+################################################################################
+echo "=== Line:${LINENO} Test preprocess: --output_dir writes a file per input"
+
+readonly MY_OUTPUT_DIR="${TEST_TMPDIR}/preprocessed"
+
+"$preprocessor" preprocess --jobs=2 --output_dir="$MY_OUTPUT_DIR" \
+  "$MY_INPUT_FILE" "$MY_SECOND_INPUT_FILE" \
+  +incdir+${MY_INCLUDED_FILE_PATH_1} > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+
+[[ ! -s "$MY_OUTPUT_FILE" ]] || {
+  echo "Expected no output on stdout, but got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+included
+
+second
+EOF
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" \
+  "${MY_OUTPUT_DIR}/$(basename "$MY_SECOND_INPUT_FILE")" || {
+  exit 1
+}
+
+################################################################################
+echo "=== Line:${LINENO} Test preprocess: --output_dir rejects equal basenames"
+
+"$preprocessor" preprocess --output_dir="$MY_OUTPUT_DIR" \
+  "$MY_INPUT_FILE" "$MY_INPUT_FILE" > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+
+[[ $status == 1 ]] || {
+  "Expected exit code 1, but got $status"
+  exit 1
+}
+
 ################################################################################
 echo "PASS"
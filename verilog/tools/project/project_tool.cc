@@ -21,14 +21,20 @@
 #include "absl/flags/flag.h"
 #include "absl/flags/usage.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "common/strings/mem_block.h"
+#include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
 #include "common/util/logging.h"
+#include "common/util/memory_usage.h"
 #include "common/util/status_macros.h"
 #include "common/util/subcommand.h"
 #include "verilog/analysis/dependencies.h"
+#include "verilog/analysis/dependency_index.h"
+#include "verilog/analysis/dependency_scan.h"
 #include "verilog/analysis/symbol_table.h"
 #include "verilog/analysis/verilog_filelist.h"
 #include "verilog/analysis/verilog_project.h"
@@ -55,6 +61,23 @@ e.g --include_dir_paths directory1,directory2
 if "A.sv" exists in both "directory1" and "directory2" the one in "directory1" is the one we will use.
 )");
 
+ABSL_FLAG(int, parse_threads, 0,
+          "If positive, read and parse the files on this many threads "
+          "before building the symbol table.");
+
+ABSL_FLAG(int, resolve_threads, 0,
+          "If positive, resolve the symbol references on this many threads. "
+          "This resolves the types first, so it can resolve more references.");
+
+ABSL_FLAG(bool, scan_dependencies, false,
+          "For file-deps, file-schedule and export-index, find the symbols "
+          "of files from their tokens where that is unambiguous, and only "
+          "parse the remaining files.");
+
+ABSL_FLAG(std::string, index_path, "verible.index",
+          "The dependency index file written by export-index and read by "
+          "query-index.");
+
 using verible::SubcommandArgsRange;
 using verible::SubcommandEntry;
 
@@ -119,8 +142,9 @@ struct ProjectSymbols {
     // Error-out early if any files failed to open.
     project = std::make_unique<verilog::VerilogProject>(
         config.file_list_root, config.file_list.preprocessing.include_dirs);
-    for (const auto &file : config.file_list.file_paths) {
-      const auto open_status = project->OpenTranslationUnit(file);
+    const auto open_statuses = project->OpenTranslationUnits(
+        config.file_list.file_paths, absl::GetFlag(FLAGS_parse_threads));
+    for (const auto &open_status : open_statuses) {
       if (!open_status.ok()) return open_status.status();
     }
 
@@ -132,6 +156,10 @@ struct ProjectSymbols {
   // Builds symbol table.
   void Build(std::vector<absl::Status> *build_statuses) {
     VLOG(1) << __FUNCTION__;
+    // Parse statuses are reported by BuildSingleTranslationUnit().
+    if (const int threads = absl::GetFlag(FLAGS_parse_threads); threads > 0) {
+      project->ParseFiles(threads);
+    }
     // For now, ingest files in the order they were listed.
     // Without conflicting definitions in files, this order should not matter.
     for (const auto &file : config.file_list.file_paths) {
@@ -139,9 +167,40 @@ struct ProjectSymbols {
     }
   }
 
+  // Builds the symbol table for dependency analysis.
+  // With --scan_dependencies, returns the symbols of the files that could be
+  // scanned instead, and only builds the symbol table from the others.
+  std::vector<verilog::FileDependencies::FileSymbols> BuildForDependencies(
+      std::vector<absl::Status> *build_statuses) {
+    if (!absl::GetFlag(FLAGS_scan_dependencies)) {
+      Build(build_statuses);
+      return {};
+    }
+    VLOG(1) << __FUNCTION__;
+    std::vector<verilog::FileDependencies::FileSymbols> scanned_files;
+    for (const auto &file : config.file_list.file_paths) {
+      const verilog::VerilogSourceFile *source =
+          project->LookupRegisteredFile(file);
+      if (source != nullptr) {
+        if (auto symbols = verilog::ScanFileSymbols(*source)) {
+          scanned_files.push_back(*std::move(symbols));
+          continue;
+        }
+      }
+      symbol_table->BuildSingleTranslationUnit(file, build_statuses);
+    }
+    VLOG(1) << "scanned " << scanned_files.size() << " of "
+            << config.file_list.file_paths.size() << " files";
+    return scanned_files;
+  }
+
   // Resolves symbols.
   void Resolve(std::vector<absl::Status> *resolve_statuses) const {
-    symbol_table->Resolve(resolve_statuses);
+    if (const int threads = absl::GetFlag(FLAGS_resolve_threads); threads > 0) {
+      symbol_table->Resolve(resolve_statuses, threads);
+    } else {
+      symbol_table->Resolve(resolve_statuses);
+    }
   }
 };
 
@@ -215,7 +274,7 @@ static absl::Status ResolveAndShowSymbolReferences(
   return absl::OkStatus();
 }
 
-static absl::Status ShowFileDependencies(const SubcommandArgsRange &args,
+static absl::Status ShowSymbolTableStats(const SubcommandArgsRange &args,
                                          std::istream &ins, std::ostream &outs,
                                          std::ostream &errs) {
   VLOG(1) << __FUNCTION__;
@@ -231,6 +290,40 @@ static absl::Status ShowFileDependencies(const SubcommandArgsRange &args,
   std::vector<absl::Status> statuses;
   project_symbols.Build(&statuses);
 
+  // Resolve symbols.
+  project_symbols.Resolve(&statuses);
+
+  // Print.
+  outs << project_symbols.symbol_table->GetStats();
+  outs << "Symbol table memory usage:" << std::endl
+       << project_symbols.symbol_table->MemoryUsage();
+  outs << "Source file memory usage:" << std::endl
+       << project_symbols.project->MemoryUsage();
+
+  // Accumulate diagnostics.
+  if (!statuses.empty()) {
+    return absl::InvalidArgumentError(JoinStatusMessages(statuses));
+  }
+
+  return absl::OkStatus();
+}
+
+static absl::Status ShowFileDependencies(const SubcommandArgsRange &args,
+                                         std::istream &ins, std::ostream &outs,
+                                         std::ostream &errs) {
+  VLOG(1) << __FUNCTION__;
+  // Load configuration.
+  VerilogProjectConfig config;
+  RETURN_IF_ERROR(config.LoadFromCommandline(args));
+
+  // Load project and files.
+  ProjectSymbols project_symbols(config);
+  RETURN_IF_ERROR(project_symbols.Load());
+
+  // Build symbol table.
+  std::vector<absl::Status> statuses;
+  const auto scanned_files = project_symbols.BuildForDependencies(&statuses);
+
   // Accumulate diagnostics.
   if (!statuses.empty()) {
     return absl::InvalidArgumentError(JoinStatusMessages(statuses));
@@ -240,7 +333,8 @@ static absl::Status ShowFileDependencies(const SubcommandArgsRange &args,
   project_symbols.symbol_table->ResolveLocallyOnly();
 
   // Compute dependencies.
-  const verilog::FileDependencies deps(*project_symbols.symbol_table);
+  const verilog::FileDependencies deps(*project_symbols.symbol_table,
+                                      scanned_files);
 
   // Print.
   // TODO(hzeller): support various output options {human-readable,
@@ -250,6 +344,114 @@ static absl::Status ShowFileDependencies(const SubcommandArgsRange &args,
   return absl::OkStatus();
 }
 
+static absl::Status ShowFileSchedule(const SubcommandArgsRange &args,
+                                     std::istream &ins, std::ostream &outs,
+                                     std::ostream &errs) {
+  VLOG(1) << __FUNCTION__;
+  // Load configuration.
+  VerilogProjectConfig config;
+  RETURN_IF_ERROR(config.LoadFromCommandline(args));
+
+  // Load project and files.
+  ProjectSymbols project_symbols(config);
+  RETURN_IF_ERROR(project_symbols.Load());
+
+  // Build symbol table.
+  std::vector<absl::Status> statuses;
+  const auto scanned_files = project_symbols.BuildForDependencies(&statuses);
+
+  // Accumulate diagnostics.
+  if (!statuses.empty()) {
+    return absl::InvalidArgumentError(JoinStatusMessages(statuses));
+  }
+
+  // Partially resolve symbols.
+  project_symbols.symbol_table->ResolveLocallyOnly();
+
+  // Compute dependencies, and schedule all files, including those without
+  // any dependencies.
+  const verilog::FileDependencies deps(*project_symbols.symbol_table,
+                                      scanned_files);
+  std::vector<verilog::FileDependencies::node_type> files;
+  for (const auto &file : *project_symbols.project) {
+    files.push_back(file.second.get());
+  }
+  outs << deps.ComputeSchedule(files);
+  return absl::OkStatus();
+}
+
+static absl::Status ExportDependencyIndex(const SubcommandArgsRange &args,
+                                          std::istream &ins,
+                                          std::ostream &outs,
+                                          std::ostream &errs) {
+  VLOG(1) << __FUNCTION__;
+  // Load configuration.
+  VerilogProjectConfig config;
+  RETURN_IF_ERROR(config.LoadFromCommandline(args));
+
+  // Load project and files.
+  ProjectSymbols project_symbols(config);
+  RETURN_IF_ERROR(project_symbols.Load());
+
+  // Build symbol table.
+  std::vector<absl::Status> statuses;
+  const auto scanned_files = project_symbols.BuildForDependencies(&statuses);
+
+  // Accumulate diagnostics.
+  if (!statuses.empty()) {
+    return absl::InvalidArgumentError(JoinStatusMessages(statuses));
+  }
+
+  // Partially resolve symbols, like file-deps.
+  project_symbols.symbol_table->ResolveLocallyOnly();
+
+  // Compute dependencies, and write them out.
+  const verilog::FileDependencies deps(*project_symbols.symbol_table,
+                                      scanned_files);
+  return verible::file::SetContents(absl::GetFlag(FLAGS_index_path),
+                                    verilog::SerializeDependencyIndex(deps));
+}
+
+static absl::Status QueryDependencyIndex(const SubcommandArgsRange &args,
+                                         std::istream &ins,
+                                         std::ostream &outs,
+                                         std::ostream &errs) {
+  VLOG(1) << __FUNCTION__;
+  if (args.size() != 2) {
+    return absl::InvalidArgumentError("Expected a query and a name.");
+  }
+  const absl::string_view query = args[0];
+  const absl::string_view name = args[1];
+
+  // The index is memory-mapped, and queried in place.
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> content =
+      verible::file::GetContentAsMemBlock(absl::GetFlag(FLAGS_index_path));
+  if (!content.ok()) return content.status();
+  const absl::StatusOr<verilog::DependencyIndex> index =
+      verilog::DependencyIndex::Create((*content)->AsStringView());
+  if (!index.ok()) return index.status();
+
+  std::vector<absl::string_view> results;
+  if (query == "definer") {
+    if (auto definer = index->DefinerOf(name)) results.push_back(*definer);
+  } else if (query == "referencers") {
+    results = index->ReferencersOf(name);
+  } else if (query == "symbols") {
+    results = index->SymbolsReferencedBy(name);
+  } else if (query == "deps") {
+    results = index->DependenciesOf(name);
+  } else if (query == "dependents") {
+    results = index->DependentsOf(name);
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown query: ", query));
+  }
+  for (const absl::string_view result : results) {
+    outs << result << std::endl;
+  }
+  return absl::OkStatus();
+}
+
 static const std::pair<absl::string_view, SubcommandEntry> kCommands[] = {
     {"symbol-table-defs",        //
      {&BuildAndShowSymbolTable,  //
@@ -268,6 +470,19 @@ Project options, including source file list.
 Prints human-readable representation of symbol table references, after
 attempting to resolve symbols.
 
+Input:
+Project options, including source file list.
+)"}},
+    {"symbol-table-stats",    //
+     {&ShowSymbolTableStats,  //
+      R"(symbol-table-stats [project args]
+
+Prints the number of symbol table nodes and references by metatype, after
+attempting to resolve symbols, an estimate of the memory they use, and the
+time spent building and resolving each file.  Then prints the estimated
+memory held by the symbol table and by the analyses of the source files, by
+component.
+
 Input:
 Project options, including source file list.
 )"}},
@@ -281,6 +496,53 @@ Prints human-readable representation of inter-file dependencies, e.g.
 
 Input:
 Project options, including source file list.
+)"}},
+    {"file-schedule",     //
+     {&ShowFileSchedule,  //
+      R"(file-schedule [project args]
+
+Prints the files in an order in which every file comes after the files it
+depends on, groups of files ("waves") that could be processed in parallel
+after the previous waves, dependency cycles, and the critical path: the
+chain of dependencies with the most bytes of source, e.g.
+
+  order:
+    "b.sv"
+    "a.sv"
+  waves:
+    0: "b.sv"
+    1: "a.sv"
+  cycles:
+  critical path (1234 bytes): "b.sv" -> "a.sv"
+
+Files in a cycle are ordered together, in the same wave.
+
+Input:
+Project options, including source file list.
+)"}},
+    {"export-index",           //
+     {&ExportDependencyIndex,  //
+      R"(export-index [project args]
+
+Writes an index of the inter-file dependencies to --index_path, which
+query-index can answer queries from without parsing any source.
+
+Input:
+Project options, including source file list.
+)"}},
+    {"query-index",           //
+     {&QueryDependencyIndex,  //
+      R"(query-index QUERY NAME
+
+Prints the answer to a query of the index at --index_path, one per line.
+QUERY is one of:
+  definer      the file that defines the symbol NAME
+  referencers  the files that reference the symbol NAME
+  symbols      the symbols that the file NAME references from other files
+  deps         the files that the file NAME depends on
+  dependents   the files that depend on the file NAME
+
+Files are named as in the file list that the index was exported from.
 )"}},
     // TODO: project-wide transformations like RenameSymbol()
     // TODO: symbol table name-completion demo
@@ -348,5 +348,140 @@ EOF
 
 diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || { exit 1; }
 
+################################################################################
+echo "=== Show dependencies between two scanned files (modules)"
+
+"$project_tool" \
+  file-deps \
+  --scan_dependencies \
+  --file_list_path "$FILE_LIST_INPUT" \
+  --file_list_root "$(dirname "$MY_INPUT_FILE".A)" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+"myinput.txt.B" depends on "myinput.txt.A" for symbols { mm }
+EOF
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || { exit 1; }
+
+################################################################################
+echo "=== Show a schedule of two files (modules)"
+
+"$project_tool" \
+  file-schedule \
+  --file_list_path "$FILE_LIST_INPUT" \
+  --file_list_root "$(dirname "$MY_INPUT_FILE".A)" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  exit 1
+}
+
+CRITICAL_BYTES="$(( $(wc -c < "$MY_INPUT_FILE".A) + $(wc -c < "$MY_INPUT_FILE".B) ))"
+cat > "$MY_EXPECT_FILE" <<EOF
+order:
+  "myinput.txt.A"
+  "myinput.txt.B"
+waves:
+  0: "myinput.txt.A"
+  1: "myinput.txt.B"
+cycles:
+critical path (${CRITICAL_BYTES} bytes): "myinput.txt.A" -> "myinput.txt.B"
+EOF
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || { exit 1; }
+
+################################################################################
+echo "=== Show symbol table reference stats"
+
+"$project_tool" \
+  symbol-table-stats \
+  --file_list_path "$FILE_LIST_INPUT" \
+  --file_list_root "$(dirname "$MY_INPUT_FILE".A)" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  exit 1
+}
+
+grep -q "single-component references:" "$MY_OUTPUT_FILE" || {
+  echo "$LINENO: Expected \"single-component references:\" in $MY_OUTPUT_FILE but didn't find it.  Got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+
+################################################################################
+echo "=== Export and query a dependency index"
+
+INDEX_FILE="${TEST_TMPDIR}/verible.index"
+"$project_tool" \
+  export-index \
+  --file_list_path "$FILE_LIST_INPUT" \
+  --file_list_root "$(dirname "$MY_INPUT_FILE".A)" \
+  --index_path "$INDEX_FILE" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+
+"$project_tool" \
+  query-index definer mm \
+  --index_path "$INDEX_FILE" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+myinput.txt.A
+EOF
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || { exit 1; }
+
+"$project_tool" \
+  query-index dependents myinput.txt.A \
+  --index_path "$INDEX_FILE" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "$LINENO: Expected exit code 0, but got $status"
+  exit 1
+}
+
+cat > "$MY_EXPECT_FILE" <<EOF
+myinput.txt.B
+EOF
+
+diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || { exit 1; }
+
+"$project_tool" \
+  query-index nonsense mm \
+  --index_path "$INDEX_FILE" \
+  > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+[[ $status == 1 ]] || {
+  echo "$LINENO: Expected exit code 1, but got $status"
+  exit 1
+}
+
 ################################################################################
 echo "PASS"
@@ -19,8 +19,10 @@
 // verilog_syntax --verilog_trace_parser files...
 
 #include <algorithm>
+#include <cstddef>
+#include <deque>
 #include <functional>
-#include <iomanip>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <sstream>  // IWYU pragma: keep  // for ostringstream
@@ -30,19 +32,26 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "common/strings/mem_block.h"
 #include "common/text/concrete_syntax_tree.h"
 #include "common/text/parser_verifier.h"
 #include "common/text/text_structure.h"
+#include "common/text/text_structure_binary.h"
 #include "common/text/token_info.h"
 #include "common/text/token_info_json.h"
+#include "common/text/token_stream_view.h"
 #include "common/util/enum_flags.h"
 #include "common/util/file_util.h"
 #include "common/util/init_command_line.h"
-#include "common/util/iterator_range.h"
 #include "common/util/logging.h"  // for operator<<, LOG, LogMessage, etc
+#include "common/util/memory_usage.h"
+#include "common/util/thread_pool.h"
 #include "nlohmann/json.hpp"
 #include "verilog/CST/verilog_tree_json.h"
 #include "verilog/CST/verilog_tree_print.h"
@@ -98,6 +107,15 @@ ABSL_FLAG(
 ABSL_FLAG(
     bool, export_json, false,
     "Uses JSON for output. Intended to be used as an input for other tools.");
+ABSL_FLAG(bool, compact_json, false,
+          "With --export_json, uses a compact schema written without building "
+          "a JSON document: {\"files\": {<file>: ...}, \"legend\": ...}, "
+          "where nodes have numeric tags, tokens are [<tag>, <start>, <end>] "
+          "without their text, and the legend names the numeric tags.");
+ABSL_FLAG(std::string, export_binary, "",
+          "If set, directory to write the tokens and syntax tree of each "
+          "file to, as <basename>.vtsb in the binary format described in "
+          "common/text/text_structure_binary.h.");
 ABSL_FLAG(bool, printtree, false, "Whether or not to print the tree");
 ABSL_FLAG(bool, printtokens, false, "Prints all lexed and filtered tokens");
 ABSL_FLAG(bool, printrawtokens, false,
@@ -105,10 +123,24 @@ ABSL_FLAG(bool, printrawtokens, false,
 ABSL_FLAG(int, error_limit, 0,
           "Limit the number of syntax errors reported.  "
           "(0: unlimited)");
+ABSL_FLAG(int, jobs, 1,
+          "Number of files to analyze in parallel. Output is still written "
+          "in the order of the input files.");
+ABSL_FLAG(bool, verbose, false,
+          "Prints the time taken to analyze each file and the memory held "
+          "by its analysis to stderr, followed by a summary of the slowest "
+          "files.");
+ABSL_FLAG(int, slowest_files, 10,
+          "Number of slowest files to list at the end with --verbose.");
 ABSL_FLAG(
     bool, verifytree, false,
     "Verifies that all tokens are parsed into tree, prints unmatched tokens");
 
+ABSL_FLAG(bool, fast_exit, false,
+          "Skips tearing down each file's tokens and syntax tree once its "
+          "output has been produced, leaving the memory to be reclaimed at "
+          "process exit.  Saves time on very large inputs.");
+
 ABSL_FLAG(bool, show_diagnostic_context, false,
           "prints an additional "
           "line on which the diagnostic was found,"
@@ -123,7 +155,8 @@ using verilog::VerilogAnalyzer;
 static std::unique_ptr<VerilogAnalyzer> ParseWithLanguageMode(
     const std::shared_ptr<verible::MemBlock> &content,
     absl::string_view filename,
-    const verilog::VerilogPreprocess::Config &preprocess_config) {
+    const verilog::VerilogPreprocess::Config &preprocess_config,
+    std::ostream *error_stream) {
   switch (absl::GetFlag(FLAGS_lang)) {
     case LanguageMode::kAutoDetect:
       return VerilogAnalyzer::AnalyzeAutomaticMode(content, filename,
@@ -132,7 +165,7 @@ static std::unique_ptr<VerilogAnalyzer> ParseWithLanguageMode(
       auto analyzer = std::make_unique<VerilogAnalyzer>(content, filename,
                                                         preprocess_config);
       const auto status = ABSL_DIE_IF_NULL(analyzer)->Analyze();
-      if (!status.ok()) std::cerr << status.message() << std::endl;
+      if (!status.ok()) *error_stream << status.message() << std::endl;
       return analyzer;
     }
     case LanguageMode::kVerilogLibraryMap:
@@ -143,7 +176,8 @@ static std::unique_ptr<VerilogAnalyzer> ParseWithLanguageMode(
 }
 
 // Prints all tokens in view that are not matched in root.
-static void VerifyParseTree(const TextStructureView &text_structure) {
+static void VerifyParseTree(const TextStructureView &text_structure,
+                            std::ostream *stream) {
   const ConcreteSyntaxTree &root = text_structure.SyntaxTree();
   if (root == nullptr) return;
   // TODO(fangism): this seems like a good method for TextStructureView.
@@ -151,11 +185,11 @@ static void VerifyParseTree(const TextStructureView &text_structure) {
   auto unmatched = verifier.Verify();
 
   if (unmatched.empty()) {
-    std::cout << std::endl << "All tokens matched." << std::endl;
+    *stream << std::endl << "All tokens matched." << std::endl;
   } else {
-    std::cout << std::endl << "Unmatched Tokens:" << std::endl;
+    *stream << std::endl << "Unmatched Tokens:" << std::endl;
     for (const auto &token : unmatched) {
-      std::cout << token << std::endl;
+      *stream << token << std::endl;
     }
   }
 }
@@ -172,21 +206,68 @@ static bool ShouldIncludeTokenText(const verible::TokenInfo &token) {
   return verilog::IsIdentifierLike(tokentype) || (token.text() != type_str);
 }
 
+// Writes the binary serialization of "text_structure" of "filename" to
+// "directory".
+static absl::Status ExportBinary(const TextStructureView &text_structure,
+                                 absl::string_view filename,
+                                 absl::string_view directory) {
+  const absl::StatusOr<std::string> serialized =
+      verible::SerializeTextStructure(text_structure);
+  if (!serialized.ok()) return serialized.status();
+  if (absl::Status status = verible::file::CreateDir(directory);
+      !status.ok()) {
+    return status;
+  }
+  const absl::string_view basename = verible::file::IsStdin(filename)
+                                         ? "stdin"
+                                         : verible::file::Basename(filename);
+  return verible::file::SetContents(
+      verible::file::JoinPath(directory, absl::StrCat(basename, ".vtsb")),
+      *serialized);
+}
+
+// A file's output in the --compact_json schema, written as text.
+struct CompactFileJson {
+  std::string members;  // of the file's object, comma-separated
+  verilog::CompactJsonTags tags;
+
+  // Starts the member "name", to be followed by its value.
+  void AddKey(absl::string_view name) {
+    absl::StrAppend(&members, members.empty() ? "\"" : ",\"", name, "\":");
+  }
+
+  // Appends the array of "tokens".
+  template <typename Tokens, typename GetToken>
+  void AddTokens(absl::string_view name, const Tokens &tokens,
+                 const GetToken &get_token, absl::string_view base) {
+    AddKey(name);
+    members.push_back('[');
+    for (const auto &t : tokens) {
+      if (members.back() != '[') members.push_back(',');
+      const verible::TokenInfo &token = get_token(t);
+      tags.tokens.insert(token.token_enum());
+      verible::AppendCompactJson(token, base, &members);
+    }
+    members.push_back(']');
+  }
+};
+
+// Analyzes one file, writing the requested output to "stream" and errors to
+// "error_stream", or, with --export_json, the requested output to "json_out",
+// or to "compact_out" if not null.
 static int AnalyzeOneFile(
     const std::shared_ptr<verible::MemBlock> &content,
     absl::string_view filename,
     const verilog::VerilogPreprocess::Config &preprocess_config,
-    json *json_out) {
+    std::ostream *stream, std::ostream *error_stream, json *json_out,
+    CompactFileJson *compact_out) {
   int exit_status = 0;
-  const auto analyzer =
-      ParseWithLanguageMode(content, filename, preprocess_config);
+  auto analyzer = ParseWithLanguageMode(content, filename, preprocess_config,
+                                        error_stream);
   const auto lex_status = ABSL_DIE_IF_NULL(analyzer)->LexStatus();
   const auto parse_status = analyzer->ParseStatus();
 
   if (!lex_status.ok() || !parse_status.ok()) {
-    const std::vector<std::string> syntax_error_messages(
-        analyzer->LinterTokenErrorMessages(
-            absl::GetFlag(FLAGS_show_diagnostic_context)));
     const int error_limit = absl::GetFlag(FLAGS_error_limit);
     int error_count = 0;
     if (!absl::GetFlag(FLAGS_export_json)) {
@@ -194,10 +275,15 @@ static int AnalyzeOneFile(
           analyzer->LinterTokenErrorMessages(
               absl::GetFlag(FLAGS_show_diagnostic_context)));
       for (const auto &message : syntax_error_messages) {
-        std::cout << message << std::endl;
+        *stream << message << std::endl;
         ++error_count;
         if (error_limit != 0 && error_count >= error_limit) break;
       }
+    } else if (compact_out != nullptr) {
+      compact_out->AddKey("errors");
+      compact_out->members.append(
+          verilog::GetLinterTokenErrorsAsJson(analyzer.get(), error_limit)
+              .dump());
     } else {
       (*json_out)["errors"] =
           verilog::GetLinterTokenErrorsAsJson(analyzer.get(), error_limit);
@@ -221,10 +307,16 @@ static int AnalyzeOneFile(
   // Check for printtokens flag, print all filtered tokens if on.
   if (absl::GetFlag(FLAGS_printtokens)) {
     if (!absl::GetFlag(FLAGS_export_json)) {
-      std::cout << std::endl << "Lexed and filtered tokens:" << std::endl;
+      *stream << std::endl << "Lexed and filtered tokens:" << std::endl;
       for (const auto &t : analyzer->Data().GetTokenStreamView()) {
-        t->ToStream(std::cout, context) << std::endl;
+        t->ToStream(*stream, context) << std::endl;
       }
+    } else if (compact_out != nullptr) {
+      compact_out->AddTokens(
+          "tokens", analyzer->Data().GetTokenStreamView(),
+          [](const verible::TokenSequence::const_iterator &t)
+              -> const verible::TokenInfo & { return *t; },
+          context.base);
     } else {
       json &tokens = (*json_out)["tokens"] = json::array();
       const auto &token_stream = analyzer->Data().GetTokenStreamView();
@@ -238,10 +330,17 @@ static int AnalyzeOneFile(
   // Check for printrawtokens flag, print all tokens if on.
   if (absl::GetFlag(FLAGS_printrawtokens)) {
     if (!absl::GetFlag(FLAGS_export_json)) {
-      std::cout << std::endl << "All lexed tokens:" << std::endl;
+      *stream << std::endl << "All lexed tokens:" << std::endl;
       for (const auto &t : analyzer->Data().TokenStream()) {
-        t.ToStream(std::cout, context) << std::endl;
+        t.ToStream(*stream, context) << std::endl;
       }
+    } else if (compact_out != nullptr) {
+      compact_out->AddTokens(
+          "rawtokens", analyzer->Data().TokenStream(),
+          [](const verible::TokenInfo &t) -> const verible::TokenInfo & {
+            return t;
+          },
+          context.base);
     } else {
       json &tokens = (*json_out)["rawtokens"] = json::array();
       const auto &token_stream = analyzer->Data().TokenStream();
@@ -258,69 +357,246 @@ static int AnalyzeOneFile(
   // check for printtree flag, and print tree if on
   if (absl::GetFlag(FLAGS_printtree) && syntax_tree != nullptr) {
     if (!absl::GetFlag(FLAGS_export_json)) {
-      std::cout << std::endl
-                << "Parse Tree"
-                << (!parse_ok ? " (incomplete due to syntax errors):" : ":")
-                << std::endl;
+      *stream << std::endl
+              << "Parse Tree"
+              << (!parse_ok ? " (incomplete due to syntax errors):" : ":")
+              << std::endl;
       verilog::PrettyPrintVerilogTree(*syntax_tree, analyzer->Data().Contents(),
-                                      &std::cout);
+                                      stream);
+    } else if (compact_out != nullptr) {
+      compact_out->AddKey("tree");
+      verilog::AppendCompactVerilogTreeJson(
+          *syntax_tree, analyzer->Data().Contents(), &compact_out->members,
+          &compact_out->tags);
     } else {
       (*json_out)["tree"] = verilog::ConvertVerilogTreeToJson(
           *syntax_tree, analyzer->Data().Contents());
     }
   }
 
+  // Check for export_binary flag, write tokens and tree if set.
+  if (const std::string directory = absl::GetFlag(FLAGS_export_binary);
+      !directory.empty()) {
+    const absl::Status status =
+        ExportBinary(text_structure, filename, directory);
+    if (!status.ok()) {
+      *error_stream << filename << ": " << status.message() << std::endl;
+      exit_status = 1;
+    }
+  }
+
   // Check for verifytree, verify tree and print unmatched if on.
   if (absl::GetFlag(FLAGS_verifytree)) {
     if (!parse_ok) {
-      std::cout << std::endl
-                << "Note: verifytree will fail because syntax errors caused "
-                   "sections of text to be dropped during error-recovery."
-                << std::endl;
+      *stream << std::endl
+              << "Note: verifytree will fail because syntax errors caused "
+                 "sections of text to be dropped during error-recovery."
+              << std::endl;
     }
-    VerifyParseTree(text_structure);
+    VerifyParseTree(text_structure, stream);
+  }
+
+  if (absl::GetFlag(FLAGS_verbose)) {
+    *error_stream << filename << ": memory usage:" << std::endl
+                  << analyzer->MemoryUsage();
+  }
+
+  if (absl::GetFlag(FLAGS_fast_exit)) {
+    // Intentionally leaked: freeing a large syntax tree node by node costs
+    // more than letting the process exit reclaim it.
+    (void)analyzer.release();  // NOLINT(bugprone-unused-return-value)
   }
 
   return exit_status;
 }
 
+// Reads and analyzes one file.  With --export_json, returns the serialized
+// JSON value of the file in "file_json", indented to be a member of the
+// top-level object, and with --compact_json, adds the tags it uses to
+// "json_tags".
+static int AnalyzeFileFromFlags(absl::string_view filename,
+                                std::ostream *stream,
+                                std::ostream *error_stream,
+                                std::string *file_json,
+                                verilog::CompactJsonTags *json_tags) {
+  auto content_status = verible::file::GetContentAsMemBlock(filename);
+  if (!content_status.status().ok()) {
+    *error_stream << content_status.status().message() << std::endl;
+    return 1;
+  }
+  std::shared_ptr<verible::MemBlock> content = std::move(*content_status);
+
+  // TODO(hzeller): is there ever a situation in which we do not want
+  // to use the preprocessor ?
+  const verilog::VerilogPreprocess::Config preprocess_config{
+      .filter_branches = true,
+  };
+  json json_out;
+  CompactFileJson compact_out;
+  const bool compact_json = absl::GetFlag(FLAGS_compact_json);
+  const int exit_status =
+      AnalyzeOneFile(content, filename, preprocess_config, stream,
+                     error_stream, &json_out,
+                     compact_json ? &compact_out : nullptr);
+  if (!absl::GetFlag(FLAGS_export_json)) return exit_status;
+  if (compact_json) {
+    *file_json = absl::StrCat("{", compact_out.members, "}");
+    json_tags->nodes.merge(compact_out.tags.nodes);
+    json_tags->tokens.merge(compact_out.tags.tokens);
+  } else {
+    // Newlines only occur between values; the ones in strings are escaped.
+    *file_json = absl::StrReplaceAll(json_out.dump(2), {{"\n", "\n  "}});
+  }
+  return exit_status;
+}
+
+// Writes the --export_json object, which maps file names to their output,
+// one member at a time, so that each file is written as soon as it is
+// analyzed instead of collecting the whole corpus before writing it.
+class JsonObjectStreamWriter {
+ public:
+  explicit JsonObjectStreamWriter(std::ostream *stream) : stream_(*stream) {}
+
+  // Writes the member "filename" with the already serialized "file_json".
+  void AddMember(absl::string_view filename, absl::string_view file_json) {
+    stream_ << (empty_ ? "{\n  " : ",\n  ") << json(std::string(filename))
+            << ": " << file_json << std::flush;
+    empty_ = false;
+  }
+
+  // Closes the object.
+  void Finish() { stream_ << (empty_ ? "{}" : "\n}"); }
+
+ private:
+  std::ostream &stream_;
+  bool empty_ = true;
+};
+
+// Result of analyzing one file on a worker thread: everything that would
+// have been written is buffered until it is that file's turn to be written.
+struct BufferedFileResult {
+  int exit_status = 0;
+  std::string output;     // destined for stdout
+  std::string errors;     // destined for stderr
+  std::string file_json;  // member of the --export_json object
+  verilog::CompactJsonTags json_tags;  // used by file_json
+  absl::Duration time;    // spent analyzing
+};
+
+// With --verbose, reports the time taken by each file, and finally the
+// slowest ones, to help find pathological inputs.
+class FileTimes {
+ public:
+  explicit FileTimes(bool verbose) : verbose_(verbose) {}
+
+  void Add(absl::string_view filename, absl::Duration time) {
+    if (!verbose_) return;
+    std::cerr << filename << ": analyzed in " << time << std::endl;
+    times_.emplace_back(time, filename);
+  }
+
+  // Prints the 'count' slowest files.
+  void PrintSlowest(size_t count) {
+    if (!verbose_ || times_.empty()) return;
+    count = std::min(count, times_.size());
+    // Ties are broken by input order, to keep the output deterministic.
+    const auto slower = [](const Entry &a, const Entry &b) {
+      return a.first > b.first;
+    };
+    std::stable_sort(times_.begin(), times_.end(), slower);
+    absl::Duration total;
+    for (const Entry &entry : times_) total += entry.first;
+    std::cerr << "Analyzed " << times_.size() << " files in " << total
+              << ", slowest:" << std::endl;
+    for (size_t i = 0; i < count; ++i) {
+      std::cerr << "  " << times_[i].first << "\t" << times_[i].second
+                << std::endl;
+    }
+  }
+
+ private:
+  using Entry = std::pair<absl::Duration, absl::string_view>;
+  const bool verbose_;
+  std::vector<Entry> times_;
+};
+
 int main(int argc, char **argv) {
   const auto usage =
       absl::StrCat("usage: ", argv[0], " [options] <file> [<file>...]");
   const auto args = verible::InitCommandLine(usage, &argc, &argv);
 
-  json json_out;
+  const bool export_json = absl::GetFlag(FLAGS_export_json);
+  const bool compact_json = export_json && absl::GetFlag(FLAGS_compact_json);
+  if (compact_json) std::cout << "{\"files\": ";
+  JsonObjectStreamWriter json_writer(&std::cout);
+  verilog::CompactJsonTags json_tags;  // of all files
+  FileTimes file_times(absl::GetFlag(FLAGS_verbose));
 
   int exit_status = 0;
   // All positional arguments are file names.  Exclude program name.
-  for (absl::string_view filename :
-       verible::make_range(args.begin() + 1, args.end())) {
-    auto content_status = verible::file::GetContentAsMemBlock(filename);
-    if (!content_status.status().ok()) {
-      std::cerr << content_status.status().message() << std::endl;
-      exit_status = 1;
-      continue;
-    }
-    std::shared_ptr<verible::MemBlock> content = std::move(*content_status);
+  const std::vector<absl::string_view> files(args.begin() + 1, args.end());
 
-    // TODO(hzeller): is there ever a situation in which we do not want
-    // to use the preprocessor ?
-    const verilog::VerilogPreprocess::Config preprocess_config{
-        .filter_branches = true,
-    };
-    json file_json;
-    int file_status =
-        AnalyzeOneFile(content, filename, preprocess_config, &file_json);
-    exit_status = std::max(exit_status, file_status);
-    if (absl::GetFlag(FLAGS_export_json)) {
-      json_out[std::string{filename.begin(), filename.end()}] =
-          std::move(file_json);
+  const int jobs = absl::GetFlag(FLAGS_jobs);
+  if (jobs > 1) {
+    verible::ThreadPool pool(jobs);
+    // Only a few files are analyzed ahead of the one being written, so that
+    // a slow file doesn't make the buffered output of all others pile up.
+    const size_t max_pending = 4 * static_cast<size_t>(jobs);
+    std::deque<std::future<BufferedFileResult>> pending;
+    size_t next_file = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+      for (; next_file < files.size() && pending.size() < max_pending;
+           ++next_file) {
+        const absl::string_view filename = files[next_file];
+        pending.push_back(pool.ExecAsync<BufferedFileResult>([filename]() {
+          std::ostringstream output;
+          std::ostringstream errors;
+          BufferedFileResult result;
+          const absl::Time start = absl::Now();
+          result.exit_status =
+              AnalyzeFileFromFlags(filename, &output, &errors,
+                                   &result.file_json, &result.json_tags);
+          result.time = absl::Now() - start;
+          result.output = output.str();
+          result.errors = errors.str();
+          return result;
+        }));
+      }
+      BufferedFileResult result = pending.front().get();
+      pending.pop_front();
+      std::cout << result.output << std::flush;
+      std::cerr << result.errors << std::flush;
+      if (!result.file_json.empty()) {
+        json_writer.AddMember(files[i], result.file_json);
+      }
+      json_tags.nodes.merge(result.json_tags.nodes);
+      json_tags.tokens.merge(result.json_tags.tokens);
+      file_times.Add(files[i], result.time);
+      exit_status = std::max(exit_status, result.exit_status);
+    }
+  } else {
+    for (const absl::string_view filename : files) {
+      std::string file_json;
+      const absl::Time start = absl::Now();
+      const int file_status = AnalyzeFileFromFlags(
+          filename, &std::cout, &std::cerr, &file_json, &json_tags);
+      const absl::Duration time = absl::Now() - start;
+      if (!file_json.empty()) json_writer.AddMember(filename, file_json);
+      file_times.Add(filename, time);
+      exit_status = std::max(exit_status, file_status);
     }
   }
 
-  if (absl::GetFlag(FLAGS_export_json)) {
-    std::cout << std::setw(2) << json_out << std::endl;
+  if (export_json) {
+    json_writer.Finish();
+    if (compact_json) {
+      std::string legend;
+      verilog::AppendCompactJsonLegend(json_tags, &legend);
+      std::cout << ", \"legend\": " << legend << "}";
+    }
+    std::cout << std::endl;
   }
+  file_times.PrintSlowest(std::max(absl::GetFlag(FLAGS_slowest_files), 0));
 
   return exit_status;
 }
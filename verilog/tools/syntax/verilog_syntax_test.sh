@@ -428,6 +428,96 @@ EOF
 tr '\r\n' '\n' < $MY_OUTPUT_FILE | json_canonicalize > "${MY_OUTPUT_FILE}.1"
 diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "${MY_OUTPUT_FILE}.1" || { echo "stdout differs." ; exit 1 ;}
 
+################################################################################
+echo "=== Test --jobs --export_json writes files in input order"
+
+TEST_FILE_A="${TEST_TMPDIR}/jobs-a.sv"
+TEST_FILE_B="${TEST_TMPDIR}/jobs-b.sv"
+echo "module a; endmodule" > "$TEST_FILE_A"
+echo "module b; endmodule module" > "$TEST_FILE_B"
+
+"$syntax_checker" --printtree --export_json "$TEST_FILE_A" "$TEST_FILE_B" \
+    > "${MY_OUTPUT_FILE}.serial"
+"$syntax_checker" --printtree --export_json --jobs=4 \
+    "$TEST_FILE_A" "$TEST_FILE_B" > "${MY_OUTPUT_FILE}.parallel"
+
+status="$?"
+[[ $status == 1 ]] || {
+  echo "Expected exit code 1, but got $status"
+  exit 1
+}
+
+diff "${MY_OUTPUT_FILE}.serial" "${MY_OUTPUT_FILE}.parallel" || {
+  echo "Expected identical serial and parallel output."
+  exit 1
+}
+
+################################################################################
+echo "=== Test --printtokens --printtree --export_json --compact_json"
+
+"$syntax_checker" --printtokens --printtree --export_json --compact_json - \
+    > "$MY_OUTPUT_FILE" <<EOF
+module mm;
+endmodule
+EOF
+
+status="$?"
+[[ $status == 0 ]] || {
+  echo "Expected exit code 0, but got $status"
+  exit 1
+}
+
+# Token and node tags are generated numbers, so only the offsets and the
+# legend names are checked.
+grep -q '"tokens":\[\[[0-9]*,0,6\],\[[0-9]*,7,9\],\[[0-9]*,9,10\]' \
+    "$MY_OUTPUT_FILE" || {
+  echo "Expected compact tokens, but got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+}
+for name in '"module"' '"SymbolIdentifier"' '"kModuleDeclaration"'; do
+  grep -q "\"legend\": .*:${name}" "$MY_OUTPUT_FILE" || {
+    echo "Expected ${name} in the legend, but got:"
+    cat "$MY_OUTPUT_FILE"
+    exit 1
+  }
+done
+if grep -q '"text"' "$MY_OUTPUT_FILE"; then
+  echo "Expected no token text, but got:"
+  cat "$MY_OUTPUT_FILE"
+  exit 1
+fi
+
+################################################################################
+echo "=== Test --verbose reports file times on stderr only"
+
+"$syntax_checker" --export_json --verbose --slowest_files=1 --jobs=2 \
+    "$TEST_FILE_A" "$TEST_FILE_B" > "${MY_OUTPUT_FILE}.verbose" \
+    2> "${MY_OUTPUT_FILE}.verbose.err"
+
+"$syntax_checker" --export_json --jobs=2 "$TEST_FILE_A" "$TEST_FILE_B" \
+    > "${MY_OUTPUT_FILE}.quiet"
+
+diff "${MY_OUTPUT_FILE}.quiet" "${MY_OUTPUT_FILE}.verbose" || {
+  echo "Expected --verbose not to change stdout."
+  exit 1
+}
+
+grep -q "^${TEST_FILE_A}: analyzed in " "${MY_OUTPUT_FILE}.verbose.err" || {
+  echo "Expected the time of ${TEST_FILE_A} on stderr."
+  exit 1
+}
+
+grep -q "^Analyzed 2 files in .*, slowest:$" "${MY_OUTPUT_FILE}.verbose.err" || {
+  echo "Expected a summary of the slowest files on stderr."
+  exit 1
+}
+
+[[ $(grep -c "^  " "${MY_OUTPUT_FILE}.verbose.err") == 1 ]] || {
+  echo "Expected exactly one slowest file."
+  exit 1
+}
+
 ################################################################################
 echo "=== Test --verifytree"
 
@@ -442,6 +532,28 @@ status="$?"
   exit 1
 }
 
+################################################################################
+echo "=== Test --fast_exit"
+
+"$syntax_checker" --printtree - > "${MY_OUTPUT_FILE}.normal" <<EOF
+module mm;
+endmodule
+EOF
+"$syntax_checker" --printtree --fast_exit - > "${MY_OUTPUT_FILE}.fast" <<EOF
+module mm;
+endmodule
+EOF
+
+status="$?"
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+diff "${MY_OUTPUT_FILE}.normal" "${MY_OUTPUT_FILE}.fast" || {
+  echo "Expected identical output with --fast_exit."
+  exit 1
+}
+
 ################################################################################
 echo "=== Test --lang=sv,lib,auto on library file"
 
@@ -519,5 +631,24 @@ status="$?"
   "Expected exit code 0, but got $status"
   exit 1
 }
+################################################################################
+echo "=== Test --export_binary"
+
+MY_BINARY_DIR="${TEST_TMPDIR}/binary"
+"$syntax_checker" --export_binary="$MY_BINARY_DIR" - > "$MY_OUTPUT_FILE" <<EOF
+module m; endmodule
+EOF
+
+status="$?"
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+
+[[ "$(head -c 4 "${MY_BINARY_DIR}/stdin.vtsb")" == "VTSB" ]] || {
+  echo "Expected binary export in ${MY_BINARY_DIR}/stdin.vtsb"
+  exit 1
+}
+
 ################################################################################
 echo "PASS"
@@ -14,6 +14,8 @@
 
 #include "verilog/transform/obfuscate.h"
 
+#include <cstddef>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -50,9 +52,13 @@ std::string RandomEqualLengthSymbolIdentifier(absl::string_view in) {
 // TODO(fangism): single-char identifiers don't need to be obfuscated.
 // or use a shuffle/permutation to guarantee collision-free reversibility.
 
+// Translates identifiers to their replacements.
+using IdentifierTranslator =
+    std::function<absl::string_view(absl::string_view)>;
+
 static void ObfuscateVerilogCodeInternal(absl::string_view content,
-                                         std::ostream *output,
-                                         IdentifierObfuscator *subst) {
+                                         std::string *output,
+                                         const IdentifierTranslator &subst) {
   VLOG(1) << __FUNCTION__;
   verilog::VerilogLexer lexer(content);
   for (;;) {
@@ -61,12 +67,12 @@ static void ObfuscateVerilogCodeInternal(absl::string_view content,
     switch (token.token_enum()) {
       case verilog_tokentype::SymbolIdentifier:
       case verilog_tokentype::PP_Identifier:
-        *output << (*subst)(token.text());
+        absl::StrAppend(output, subst(token.text()));
         break;
         // Preserve all $ID calls, including system task/function calls, and VPI
         // calls
       case verilog_tokentype::SystemTFIdentifier:
-        *output << token.text();
+        absl::StrAppend(output, token.text());
         break;
         // The following identifier types start with a special character that
         // needs to be preserved.
@@ -74,7 +80,8 @@ static void ObfuscateVerilogCodeInternal(absl::string_view content,
       case verilog_tokentype::MacroCallId:
       case verilog_tokentype::MacroIdItem:
         // TODO(fangism): verilog_tokentype::EscapedIdentifier
-        *output << token.text()[0] << (*subst)(token.text().substr(1));
+        output->push_back(token.text()[0]);
+        absl::StrAppend(output, subst(token.text().substr(1)));
         break;
       // The following tokens are un-lexed, so they need to be lexed
       // recursively.
@@ -84,12 +91,19 @@ static void ObfuscateVerilogCodeInternal(absl::string_view content,
         break;
       default:
         // This also covers lexical error tokens.
-        *output << token.text();
+        absl::StrAppend(output, token.text());
     }
   }
   VLOG(1) << "end of " << __FUNCTION__;
 }
 
+static void ObfuscateVerilogCodeInternal(absl::string_view content,
+                                         std::string *output,
+                                         IdentifierObfuscator *subst) {
+  ObfuscateVerilogCodeInternal(
+      content, output, [subst](absl::string_view s) { return (*subst)(s); });
+}
+
 static absl::Status ObfuscationError(absl::string_view message,
                                      absl::string_view original,
                                      absl::string_view encoded) {
@@ -124,10 +138,11 @@ static absl::Status VerifyDecoding(absl::string_view original,
   RETURN_IF_ERROR(reverse_subst.load(saved_map));
 
   // Decode and compare.
-  std::ostringstream decoded_output;
+  std::string decoded_output;
+  decoded_output.reserve(encoded.size());
   ObfuscateVerilogCodeInternal(encoded, &decoded_output, &reverse_subst);
-  if (original != decoded_output.str()) {
-    return ReversibilityError(original, encoded, decoded_output.str());
+  if (original != decoded_output) {
+    return ReversibilityError(original, encoded, decoded_output);
   }
   return absl::OkStatus();
 }
@@ -158,19 +173,69 @@ static absl::Status VerifyEquivalence(absl::string_view original,
 }
 
 absl::Status ObfuscateVerilogCode(absl::string_view content,
-                                  std::ostream *output,
+                                  std::string *output,
                                   IdentifierObfuscator *subst) {
   VLOG(1) << __FUNCTION__;
-  std::ostringstream buffer;
-  ObfuscateVerilogCodeInternal(content, &buffer, subst);
+  const size_t start = output->size();
+  output->reserve(start + content.size());  // Lengths are preserved.
+  ObfuscateVerilogCodeInternal(content, output, subst);
+  const absl::string_view encoded = absl::string_view(*output).substr(start);
 
   // Always verify equivalence.
-  RETURN_IF_ERROR(VerifyEquivalence(content, buffer.str()));
+  auto status = VerifyEquivalence(content, encoded);
 
   // Always verify decoding.
-  RETURN_IF_ERROR(VerifyDecoding(content, buffer.str(), *subst));
+  if (status.ok()) status = VerifyDecoding(content, encoded, *subst);
+
+  if (!status.ok()) output->resize(start);
+  return status;
+}
+
+absl::Status ObfuscateVerilogCode(
+    absl::string_view content, std::string *output,
+    verible::ConcurrentIdentifierObfuscator *subst) {
+  VLOG(1) << __FUNCTION__;
+  const size_t start = output->size();
+  output->reserve(start + content.size());  // Lengths are preserved.
+  ObfuscateVerilogCodeInternal(
+      content, output, [subst](absl::string_view s) { return (*subst)(s); });
+  const absl::string_view encoded = absl::string_view(*output).substr(start);
+
+  // Always verify equivalence.
+  auto status = VerifyEquivalence(content, encoded);
+
+  // Always verify decoding, through the reverse map of the shared translation
+  // instead of a copy of all of it.
+  if (status.ok() && !subst->is_decoding()) {
+    std::string decoded_output;
+    decoded_output.reserve(encoded.size());
+    ObfuscateVerilogCodeInternal(
+        encoded, &decoded_output,
+        [subst](absl::string_view s) { return subst->decode(s); });
+    if (content != decoded_output) {
+      status = ReversibilityError(content, encoded, decoded_output);
+    }
+  }
+
+  if (!status.ok()) output->resize(start);
+  return status;
+}
+
+absl::Status ObfuscateVerilogCode(absl::string_view content,
+                                  std::ostream *output,
+                                  IdentifierObfuscator *subst) {
+  std::string encoded;
+  RETURN_IF_ERROR(ObfuscateVerilogCode(content, &encoded, subst));
+  output->write(encoded.data(), encoded.size());
+  return absl::OkStatus();
+}
 
-  *output << buffer.str();
+absl::Status ObfuscateVerilogCode(
+    absl::string_view content, std::ostream *output,
+    verible::ConcurrentIdentifierObfuscator *subst) {
+  std::string encoded;
+  RETURN_IF_ERROR(ObfuscateVerilogCode(content, &encoded, subst));
+  output->write(encoded.data(), encoded.size());
   return absl::OkStatus();
 }
 
@@ -38,6 +38,21 @@ absl::Status ObfuscateVerilogCode(absl::string_view content,
                                   std::ostream *output,
                                   verible::IdentifierObfuscator *subst);
 
+// Same as above, with a translation map that can be shared by concurrent
+// calls, e.g. to obfuscate many files consistently.
+absl::Status ObfuscateVerilogCode(
+    absl::string_view content, std::ostream *output,
+    verible::ConcurrentIdentifierObfuscator *subst);
+
+// Like the above, but append the obfuscated code to 'output' (unless there is
+// an error), which saves copying it from a stream buffer.
+absl::Status ObfuscateVerilogCode(absl::string_view content,
+                                  std::string *output,
+                                  verible::IdentifierObfuscator *subst);
+absl::Status ObfuscateVerilogCode(
+    absl::string_view content, std::string *output,
+    verible::ConcurrentIdentifierObfuscator *subst);
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_TRANSFORM_OBFUSCATE_H_
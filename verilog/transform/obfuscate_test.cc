@@ -125,5 +125,52 @@ TEST(ObfuscateVerilogCodeTest, InputLexicalError) {
   }
 }
 
+TEST(ObfuscateVerilogCodeTest, ConcurrentPreloadedSubstitutions) {
+  verible::ConcurrentIdentifierObfuscator ob(ExpectNeverToBeCalled);
+  ASSERT_TRUE(ob.encode("aaa", "AAA"));
+  ASSERT_TRUE(ob.encode("bbb", "BBB"));
+  const std::pair<absl::string_view, absl::string_view> kTestCases[] = {
+      {"", ""},
+      {"aaa bbb;\n", "AAA BBB;\n"},
+      {"`aaa(bbb, $aaa)\n", "`AAA(BBB, $aaa)\n"},
+      {"`define aaa bbb+aaa\n", "`define AAA BBB+AAA\n"},
+  };
+  for (const auto &test : kTestCases) {
+    std::ostringstream output;
+    const auto status = ObfuscateVerilogCode(test.first, &output, &ob);
+    EXPECT_TRUE(status.ok()) << "Unexpected error: " << status.message();
+    EXPECT_EQ(output.str(), test.second);
+  }
+
+  ob.set_decode_mode(true);
+  for (const auto &test : kTestCases) {
+    std::ostringstream output;
+    const auto status = ObfuscateVerilogCode(test.second, &output, &ob);
+    EXPECT_TRUE(status.ok()) << "Unexpected error: " << status.message();
+    EXPECT_EQ(output.str(), test.first);
+  }
+}
+
+TEST(ObfuscateVerilogCodeTest, AppendsToString) {
+  IdentifierObfuscator ob(ExpectNeverToBeCalled);
+  ob.encode("aaa", "AAA");
+  std::string output = "// header\n";
+  EXPECT_TRUE(ObfuscateVerilogCode("aaa;\n", &output, &ob).ok());
+  EXPECT_EQ(output, "// header\nAAA;\n");
+
+  // Nothing is appended on error.
+  const auto status = ObfuscateVerilogCode("789badid", &output, &ob);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(output, "// header\nAAA;\n");
+}
+
+TEST(ObfuscateVerilogCodeTest, ConcurrentInputLexicalError) {
+  verible::ConcurrentIdentifierObfuscator ob(RandomEqualLengthSymbolIdentifier);
+  std::ostringstream output;
+  const auto status = ObfuscateVerilogCode("`FOO(8911badid)\n", &output, &ob);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument)
+      << "message: " << status.message();
+}
+
 }  // namespace
 }  // namespace verilog
@@ -14,17 +14,15 @@
 
 #include "verilog/transform/strip_comments.h"
 
+#include <cstddef>
 #include <iostream>
-#include <vector>
+#include <string>
 
-#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "common/strings/comment_utils.h"
 #include "common/strings/range.h"
 #include "common/text/token_info.h"
-#include "common/util/iterator_range.h"
 #include "common/util/logging.h"
-#include "common/util/spacer.h"
 #include "verilog/parser/verilog_lexer.h"
 #include "verilog/parser/verilog_parser.h"
 #include "verilog/parser/verilog_token_enum.h"
@@ -32,27 +30,58 @@
 namespace verilog {
 
 using verible::make_string_view_range;
-using verible::Spacer;
 using verible::StripComment;
 using verible::TokenInfo;
 
+namespace {
+
+// Collects the output text, and writes it to the stream in large chunks,
+// which is much cheaper than writing each token to the stream.
+class ChunkedOutput {
+ public:
+  static constexpr size_t kChunkSize = 1 << 16;
+
+  explicit ChunkedOutput(std::ostream *stream) : stream_(*stream) {
+    buffer_.reserve(kChunkSize);
+  }
+  ~ChunkedOutput() { Flush(); }
+
+  void Append(absl::string_view text) {
+    buffer_.append(text.data(), text.size());
+    if (buffer_.size() >= kChunkSize) Flush();
+  }
+
+  void Append(size_t count, char c) {
+    buffer_.append(count, c);
+    if (buffer_.size() >= kChunkSize) Flush();
+  }
+
+ private:
+  void Flush() {
+    stream_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  std::ostream &stream_;
+  std::string buffer_;
+};
+
 // Replace non-newline characters with a single char, like <space>.
 // Tabs are considered non-newline characters.
-static void ReplaceNonNewlines(absl::string_view text, std::ostream *output,
-                               char replacement) {
-  if (text.empty()) return;
-  const std::vector<absl::string_view> lines(
-      absl::StrSplit(text, absl::ByChar('\n')));
-  // no newline before first element
-  *output << Spacer(lines.front().size(), replacement);
-  for (const auto &line : verible::make_range(lines.begin() + 1, lines.end())) {
-    *output << '\n' << Spacer(line.size(), replacement);
+void ReplaceNonNewlines(absl::string_view text, ChunkedOutput *output,
+                        char replacement) {
+  for (;;) {
+    const size_t newline = text.find('\n');
+    if (newline == absl::string_view::npos) break;
+    output->Append(newline, replacement);
+    output->Append(1, '\n');
+    text.remove_prefix(newline + 1);
   }
+  output->Append(text.size(), replacement);
 }
 
-void StripVerilogComments(absl::string_view content, std::ostream *output,
-                          char replacement) {
-  VLOG(1) << __FUNCTION__;
+void StripComments(absl::string_view content, ChunkedOutput *output,
+                   char replacement) {
   verilog::VerilogLexer lexer(content);
 
   const TokenInfo::Context context(content, [](std::ostream &stream, int e) {
@@ -74,14 +103,15 @@ void StripVerilogComments(absl::string_view content, std::ostream *output,
             break;
           case ' ':
             // The lexer guarantees the text does not contain '\n'.
-            *output << Spacer(text.length());
+            output->Append(text.length(), ' ');
             break;
           default: {
             // Retain the "//" but erase everything thereafter.
             const absl::string_view body(StripComment(text));
             const absl::string_view head(
                 make_string_view_range(text.begin(), body.begin()));
-            *output << head << Spacer(body.length(), replacement);
+            output->Append(head);
+            output->Append(body.length(), replacement);
             break;
           }
         }
@@ -92,7 +122,7 @@ void StripVerilogComments(absl::string_view content, std::ostream *output,
           case '\0':
             // Print one space to prevent accidental token fusion in
             // cases like: "a/**/b".
-            *output << ' ';
+            output->Append(1, ' ');
             break;
           case ' ':
             // Preserve newlines, but replace everything else with space.
@@ -106,9 +136,9 @@ void StripVerilogComments(absl::string_view content, std::ostream *output,
             const absl::string_view tail(
                 make_string_view_range(body.end(), text.end()));
 
-            *output << head;
+            output->Append(head);
             ReplaceNonNewlines(body, output, replacement);
-            *output << tail;
+            output->Append(tail);
             break;
           }
         }
@@ -117,13 +147,22 @@ void StripVerilogComments(absl::string_view content, std::ostream *output,
       // recursively.
       case verilog_tokentype::MacroArg:
       case verilog_tokentype::PP_define_body:
-        StripVerilogComments(text, output, replacement);
+        StripComments(text, output, replacement);
         break;
       default:
         // Preserve all other text, including lexical error tokens.
-        *output << text;
+        output->Append(text);
     }  // switch
   }
+}
+
+}  // namespace
+
+void StripVerilogComments(absl::string_view content, std::ostream *output,
+                          char replacement) {
+  VLOG(1) << __FUNCTION__;
+  ChunkedOutput chunked_output(output);
+  StripComments(content, &chunked_output, replacement);
   VLOG(1) << "end of " << __FUNCTION__;
 }
 
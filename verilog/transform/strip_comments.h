@@ -33,6 +33,8 @@ namespace verilog {
 //       This preserves byte offsets and line numbers of all unchanged text.
 //       This option is good for visibility.
 // All lexical errors are ignored.
+// The output is written in large chunks as the input is lexed, so that it
+// doesn't have to fit in memory a second time.
 void StripVerilogComments(absl::string_view content, std::ostream *output,
                           char replacement = '\0');
 
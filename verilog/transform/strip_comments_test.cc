@@ -15,7 +15,9 @@
 #include "verilog/transform/strip_comments.h"
 
 #include <sstream>
+#include <string>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 
@@ -325,5 +327,18 @@ TEST(StripVerilogCommentsTest, Various) {
   }
 }
 
+// Output is written in chunks; large inputs must come out whole.
+TEST(StripVerilogCommentsTest, LargeInput) {
+  std::string input;
+  std::string expected;
+  for (int i = 0; i < 10000; ++i) {
+    absl::StrAppend(&input, "wire w", i, "; // comment ", i, "\n/* x */\n");
+    absl::StrAppend(&expected, "wire w", i, "; \n \n");
+  }
+  std::ostringstream stream;
+  StripVerilogComments(input, &stream, '\0');
+  EXPECT_EQ(stream.str(), expected);
+}
+
 }  // namespace
 }  // namespace verilog